@@ -0,0 +1,25 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/async.cpp" "CMakeFiles/spdlog.dir/src/async.cpp.o" "gcc" "CMakeFiles/spdlog.dir/src/async.cpp.o.d"
+  "/root/repo/src/cfg.cpp" "CMakeFiles/spdlog.dir/src/cfg.cpp.o" "gcc" "CMakeFiles/spdlog.dir/src/cfg.cpp.o.d"
+  "/root/repo/src/color_sinks.cpp" "CMakeFiles/spdlog.dir/src/color_sinks.cpp.o" "gcc" "CMakeFiles/spdlog.dir/src/color_sinks.cpp.o.d"
+  "/root/repo/src/file_sinks.cpp" "CMakeFiles/spdlog.dir/src/file_sinks.cpp.o" "gcc" "CMakeFiles/spdlog.dir/src/file_sinks.cpp.o.d"
+  "/root/repo/src/fmt.cpp" "CMakeFiles/spdlog.dir/src/fmt.cpp.o" "gcc" "CMakeFiles/spdlog.dir/src/fmt.cpp.o.d"
+  "/root/repo/src/spdlog.cpp" "CMakeFiles/spdlog.dir/src/spdlog.cpp.o" "gcc" "CMakeFiles/spdlog.dir/src/spdlog.cpp.o.d"
+  "/root/repo/src/stdout_sinks.cpp" "CMakeFiles/spdlog.dir/src/stdout_sinks.cpp.o" "gcc" "CMakeFiles/spdlog.dir/src/stdout_sinks.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
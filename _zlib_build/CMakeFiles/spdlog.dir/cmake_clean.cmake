@@ -0,0 +1,23 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/spdlog.dir/src/async.cpp.o"
+  "CMakeFiles/spdlog.dir/src/async.cpp.o.d"
+  "CMakeFiles/spdlog.dir/src/cfg.cpp.o"
+  "CMakeFiles/spdlog.dir/src/cfg.cpp.o.d"
+  "CMakeFiles/spdlog.dir/src/color_sinks.cpp.o"
+  "CMakeFiles/spdlog.dir/src/color_sinks.cpp.o.d"
+  "CMakeFiles/spdlog.dir/src/file_sinks.cpp.o"
+  "CMakeFiles/spdlog.dir/src/file_sinks.cpp.o.d"
+  "CMakeFiles/spdlog.dir/src/fmt.cpp.o"
+  "CMakeFiles/spdlog.dir/src/fmt.cpp.o.d"
+  "CMakeFiles/spdlog.dir/src/spdlog.cpp.o"
+  "CMakeFiles/spdlog.dir/src/spdlog.cpp.o.d"
+  "CMakeFiles/spdlog.dir/src/stdout_sinks.cpp.o"
+  "CMakeFiles/spdlog.dir/src/stdout_sinks.cpp.o.d"
+  "libspdlog.a"
+  "libspdlog.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/spdlog.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
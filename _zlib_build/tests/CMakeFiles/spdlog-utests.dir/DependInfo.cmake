@@ -0,0 +1,64 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/tests/main.cpp" "tests/CMakeFiles/spdlog-utests.dir/main.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/main.cpp.o.d"
+  "/root/repo/tests/test_allocations.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_allocations.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_allocations.cpp.o.d"
+  "/root/repo/tests/test_arrow_file_sink.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_arrow_file_sink.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_arrow_file_sink.cpp.o.d"
+  "/root/repo/tests/test_async.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_async.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_async.cpp.o.d"
+  "/root/repo/tests/test_async_sink.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_async_sink.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_async_sink.cpp.o.d"
+  "/root/repo/tests/test_backtrace.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_backtrace.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_backtrace.cpp.o.d"
+  "/root/repo/tests/test_call_sites.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_call_sites.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_call_sites.cpp.o.d"
+  "/root/repo/tests/test_cfg.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_cfg.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_cfg.cpp.o.d"
+  "/root/repo/tests/test_create_dir.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_create_dir.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_create_dir.cpp.o.d"
+  "/root/repo/tests/test_daily_logger.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_daily_logger.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_daily_logger.cpp.o.d"
+  "/root/repo/tests/test_dup_filter.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_dup_filter.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_dup_filter.cpp.o.d"
+  "/root/repo/tests/test_errors.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_errors.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_errors.cpp.o.d"
+  "/root/repo/tests/test_eventlog.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_eventlog.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_eventlog.cpp.o.d"
+  "/root/repo/tests/test_file_helper.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_file_helper.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_file_helper.cpp.o.d"
+  "/root/repo/tests/test_file_logging.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_file_logging.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_file_logging.cpp.o.d"
+  "/root/repo/tests/test_filter_sink.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_filter_sink.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_filter_sink.cpp.o.d"
+  "/root/repo/tests/test_flight_recorder.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_flight_recorder.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_flight_recorder.cpp.o.d"
+  "/root/repo/tests/test_fmt_helper.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_fmt_helper.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_fmt_helper.cpp.o.d"
+  "/root/repo/tests/test_http_bulk_sink.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_http_bulk_sink.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_http_bulk_sink.cpp.o.d"
+  "/root/repo/tests/test_intern_table.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_intern_table.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_intern_table.cpp.o.d"
+  "/root/repo/tests/test_json_formatter.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_json_formatter.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_json_formatter.cpp.o.d"
+  "/root/repo/tests/test_level_router_sink.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_level_router_sink.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_level_router_sink.cpp.o.d"
+  "/root/repo/tests/test_log_batch.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_log_batch.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_log_batch.cpp.o.d"
+  "/root/repo/tests/test_macros.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_macros.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_macros.cpp.o.d"
+  "/root/repo/tests/test_misc.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_misc.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_misc.cpp.o.d"
+  "/root/repo/tests/test_mpmc_q.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_mpmc_q.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_mpmc_q.cpp.o.d"
+  "/root/repo/tests/test_nonblocking_fd_sink.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_nonblocking_fd_sink.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_nonblocking_fd_sink.cpp.o.d"
+  "/root/repo/tests/test_otlp_sink.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_otlp_sink.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_otlp_sink.cpp.o.d"
+  "/root/repo/tests/test_pattern_formatter.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_pattern_formatter.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_pattern_formatter.cpp.o.d"
+  "/root/repo/tests/test_rate_limit_sink.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_rate_limit_sink.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_rate_limit_sink.cpp.o.d"
+  "/root/repo/tests/test_raw_ringbuffer_sink.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_raw_ringbuffer_sink.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_raw_ringbuffer_sink.cpp.o.d"
+  "/root/repo/tests/test_redact_sink.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_redact_sink.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_redact_sink.cpp.o.d"
+  "/root/repo/tests/test_registry.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_registry.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_registry.cpp.o.d"
+  "/root/repo/tests/test_sharded_file_sink.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_sharded_file_sink.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_sharded_file_sink.cpp.o.d"
+  "/root/repo/tests/test_shm_ringbuffer_sink.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_shm_ringbuffer_sink.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_shm_ringbuffer_sink.cpp.o.d"
+  "/root/repo/tests/test_static_logger.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_static_logger.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_static_logger.cpp.o.d"
+  "/root/repo/tests/test_stdout_api.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_stdout_api.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_stdout_api.cpp.o.d"
+  "/root/repo/tests/test_stopwatch.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_stopwatch.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_stopwatch.cpp.o.d"
+  "/root/repo/tests/test_syslog.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_syslog.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_syslog.cpp.o.d"
+  "/root/repo/tests/test_tail_sampling.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_tail_sampling.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_tail_sampling.cpp.o.d"
+  "/root/repo/tests/test_time_point.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_time_point.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_time_point.cpp.o.d"
+  "/root/repo/tests/test_timer_wheel.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_timer_wheel.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_timer_wheel.cpp.o.d"
+  "/root/repo/tests/test_udp_sink.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_udp_sink.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_udp_sink.cpp.o.d"
+  "/root/repo/tests/test_unix_socket_sink.cpp" "tests/CMakeFiles/spdlog-utests.dir/test_unix_socket_sink.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/test_unix_socket_sink.cpp.o.d"
+  "/root/repo/tests/utils.cpp" "tests/CMakeFiles/spdlog-utests.dir/utils.cpp.o" "gcc" "tests/CMakeFiles/spdlog-utests.dir/utils.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_zlib_build/CMakeFiles/spdlog.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,99 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/spdlog-utests.dir/main.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/main.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_allocations.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_allocations.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_arrow_file_sink.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_arrow_file_sink.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_async.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_async.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_async_sink.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_async_sink.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_backtrace.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_backtrace.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_call_sites.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_call_sites.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_cfg.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_cfg.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_create_dir.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_create_dir.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_daily_logger.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_daily_logger.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_dup_filter.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_dup_filter.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_errors.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_errors.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_eventlog.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_eventlog.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_file_helper.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_file_helper.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_file_logging.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_file_logging.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_filter_sink.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_filter_sink.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_flight_recorder.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_flight_recorder.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_fmt_helper.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_fmt_helper.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_http_bulk_sink.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_http_bulk_sink.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_intern_table.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_intern_table.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_json_formatter.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_json_formatter.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_level_router_sink.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_level_router_sink.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_log_batch.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_log_batch.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_macros.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_macros.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_misc.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_misc.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_mpmc_q.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_mpmc_q.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_nonblocking_fd_sink.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_nonblocking_fd_sink.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_otlp_sink.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_otlp_sink.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_pattern_formatter.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_pattern_formatter.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_rate_limit_sink.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_rate_limit_sink.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_raw_ringbuffer_sink.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_raw_ringbuffer_sink.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_redact_sink.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_redact_sink.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_registry.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_registry.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_sharded_file_sink.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_sharded_file_sink.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_shm_ringbuffer_sink.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_shm_ringbuffer_sink.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_static_logger.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_static_logger.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_stdout_api.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_stdout_api.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_stopwatch.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_stopwatch.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_syslog.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_syslog.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_tail_sampling.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_tail_sampling.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_time_point.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_time_point.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_timer_wheel.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_timer_wheel.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_udp_sink.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_udp_sink.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/test_unix_socket_sink.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/test_unix_socket_sink.cpp.o.d"
+  "CMakeFiles/spdlog-utests.dir/utils.cpp.o"
+  "CMakeFiles/spdlog-utests.dir/utils.cpp.o.d"
+  "spdlog-utests"
+  "spdlog-utests.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/spdlog-utests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,8 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/tests
+# Build directory: /root/repo/_zlib_build/tests
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(spdlog-utests "/root/repo/_zlib_build/tests/spdlog-utests")
+set_tests_properties(spdlog-utests PROPERTIES  RUN_SERIAL "ON" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;85;add_test;/root/repo/tests/CMakeLists.txt;91;spdlog_prepare_test;/root/repo/tests/CMakeLists.txt;0;")
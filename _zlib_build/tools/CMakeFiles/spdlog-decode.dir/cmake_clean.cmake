@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/spdlog-decode.dir/spdlog-decode.cpp.o"
+  "CMakeFiles/spdlog-decode.dir/spdlog-decode.cpp.o.d"
+  "spdlog-decode"
+  "spdlog-decode.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/spdlog-decode.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/spdlog-merge.dir/spdlog-merge.cpp.o"
+  "CMakeFiles/spdlog-merge.dir/spdlog-merge.cpp.o.d"
+  "spdlog-merge"
+  "spdlog-merge.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/spdlog-merge.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
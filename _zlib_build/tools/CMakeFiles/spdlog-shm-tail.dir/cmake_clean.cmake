@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/spdlog-shm-tail.dir/spdlog-shm-tail.cpp.o"
+  "CMakeFiles/spdlog-shm-tail.dir/spdlog-shm-tail.cpp.o.d"
+  "spdlog-shm-tail"
+  "spdlog-shm-tail.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/spdlog-shm-tail.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
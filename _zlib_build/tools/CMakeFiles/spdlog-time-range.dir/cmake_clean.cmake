@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/spdlog-time-range.dir/spdlog-time-range.cpp.o"
+  "CMakeFiles/spdlog-time-range.dir/spdlog-time-range.cpp.o.d"
+  "spdlog-time-range"
+  "spdlog-time-range.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/spdlog-time-range.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,65 @@
+//
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+#pragma once
+
+// Heap allocation counting for the benchmarks.
+// Replaces the global operator new/delete of the executable: include it in one source file per benchmark.
+//
+//     auto before = alloc_hooks::allocations();
+//     ... log n messages ...
+//     auto allocs_per_msg = alloc_hooks::per_message(before, n);
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace alloc_hooks {
+
+// allocations of every thread so far
+inline std::atomic<size_t> &allocations_counter()
+{
+    static std::atomic<size_t> counter{0};
+    return counter;
+}
+
+inline size_t allocations()
+{
+    return allocations_counter().load(std::memory_order_relaxed);
+}
+
+// allocations per message since "before" (a previous allocations())
+inline double per_message(size_t before, size_t messages)
+{
+    return messages == 0 ? 0.0 : static_cast<double>(allocations() - before) / static_cast<double>(messages);
+}
+
+} // namespace alloc_hooks
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+// gcc sees free() called on what the replaced operator new returned
+#    pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void *operator new(size_t size)
+{
+    alloc_hooks::allocations_counter().fetch_add(1, std::memory_order_relaxed);
+    if (void *ptr = std::malloc(size == 0 ? 1 : size))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
@@ -16,6 +16,7 @@
 #    include "spdlog/fmt/bundled/format.h"
 #endif
 
+#include "alloc_hooks.h"
 #include "utils.h"
 #include <atomic>
 #include <iostream>
@@ -161,6 +162,7 @@ void bench_mt(int howmany, std::shared_ptr<spdlog::logger> logger, int thread_co
 {
     using std::chrono::high_resolution_clock;
     vector<thread> threads;
+    auto allocations_before = alloc_hooks::allocations();
     auto start = high_resolution_clock::now();
 
     int msgs_per_thread = howmany / thread_count;
@@ -180,5 +182,6 @@ void bench_mt(int howmany, std::shared_ptr<spdlog::logger> logger, int thread_co
 
     auto delta = high_resolution_clock::now() - start;
     auto delta_d = duration_cast<duration<double>>(delta).count();
-    spdlog::info("Elapsed: {} secs\t {:L}/sec", delta_d, int(howmany / delta_d));
+    auto allocs_per_msg = alloc_hooks::per_message(allocations_before, static_cast<size_t>(howmany));
+    spdlog::info("Elapsed: {} secs\t {:L}/sec\t {:.2f} allocs/msg", delta_d, int(howmany / delta_d), allocs_per_msg);
 }
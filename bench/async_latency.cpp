@@ -0,0 +1,259 @@
+//
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+//
+// async_latency.cpp : latency of the async loggers under a fixed load, free of coordinated omission
+//
+// The logging threads issue their calls on a fixed schedule (rate / threads calls per second each), and the
+// latency of a call is measured from the time it was scheduled at, not from the time it was made: a call
+// stalled by a full queue delays the calls after it, and their wait is counted too - unlike back to back
+// calls (latency.cpp), which just measure fewer calls while stalled.
+//
+// For each queue backend, wait strategy and overflow policy, prints the percentiles of:
+//   response - from the scheduled time to the return of the log call
+//   service  - from the start to the return of the log call
+//   e2e      - from the log call to the sink, through the thread pool queue and worker
+//
+//   async_latency [rate msgs/sec] [threads] [seconds] [queue size] [name filter]
+//   async_latency 1000000 4 2 8192 arena/busy_spin
+//
+
+#include "spdlog/spdlog.h"
+#include "spdlog/async.h"
+#include "spdlog/sinks/base_sink.h"
+
+#include "hdr_histogram.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using bench_clock = std::chrono::steady_clock;
+
+// records the time the messages took from the log call to the sink
+class e2e_latency_sink : public spdlog::sinks::base_sink<std::mutex>
+{
+public:
+    hdr_histogram histogram()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return histogram_;
+    }
+
+protected:
+    void sink_it_(const spdlog::details::log_msg &msg) override
+    {
+        histogram_.record(std::chrono::duration_cast<std::chrono::nanoseconds>(spdlog::log_clock::now() - msg.time).count());
+    }
+
+    void flush_() override {}
+
+private:
+    hdr_histogram histogram_;
+};
+
+struct bench_config
+{
+    std::string name;
+    spdlog::details::thread_pool_options options;
+    spdlog::async_overflow_policy policy;
+};
+
+struct bench_args
+{
+    double rate = 200000; // calls per second, all threads together
+    size_t threads = 4;
+    double seconds = 1;
+    size_t queue_size = 8192;
+    std::string filter;
+};
+
+struct thread_result
+{
+    hdr_histogram response;
+    hdr_histogram service;
+    uint64_t calls = 0;
+};
+
+// log on schedule until end, recording after warmup_end
+void load_thread(spdlog::async_logger &logger, bench_clock::time_point first_call, bench_clock::duration interval,
+    bench_clock::time_point warmup_end, bench_clock::time_point end, thread_result &result)
+{
+    for (uint64_t i = 0;; i++)
+    {
+        auto scheduled = first_call + interval * static_cast<bench_clock::rep>(i);
+        if (scheduled >= end)
+        {
+            break;
+        }
+        // spin: sleeping would oversleep the schedule by the timer slack
+        auto start = bench_clock::now();
+        while (start < scheduled)
+        {
+            std::this_thread::yield();
+            start = bench_clock::now();
+        }
+        logger.info("Hello logger: msg number {} from the latency bench..........", i);
+        auto done = bench_clock::now();
+        if (scheduled >= warmup_end)
+        {
+            result.response.record(std::chrono::duration_cast<std::chrono::nanoseconds>(done - scheduled).count());
+            result.service.record(std::chrono::duration_cast<std::chrono::nanoseconds>(done - start).count());
+        }
+        result.calls++;
+    }
+}
+
+void print_histogram(const char *what, const hdr_histogram &histogram)
+{
+    spdlog::info("  {:<9} p50 {:>9} p90 {:>9} p99 {:>9} p99.9 {:>9} p99.99 {:>9} max {:>10} ns", what, histogram.percentile(50),
+        histogram.percentile(90), histogram.percentile(99), histogram.percentile(99.9), histogram.percentile(99.99), histogram.max());
+}
+
+void run(const bench_config &config, const bench_args &args)
+{
+    auto tp = std::make_shared<spdlog::details::thread_pool>(args.queue_size, 1, config.options);
+    auto sink = std::make_shared<e2e_latency_sink>();
+    auto logger = std::make_shared<spdlog::async_logger>("async_latency", sink, tp, config.policy);
+
+    // each thread calls at rate / threads, the threads offset to spread the calls evenly
+    auto interval = std::chrono::duration_cast<bench_clock::duration>(
+        std::chrono::duration<double>(static_cast<double>(args.threads) / args.rate));
+    auto start = bench_clock::now() + std::chrono::milliseconds(10);
+    auto duration = std::chrono::duration_cast<bench_clock::duration>(std::chrono::duration<double>(args.seconds));
+    auto warmup_end = start + duration / 10;
+    auto end = start + duration;
+
+    std::vector<thread_result> results(args.threads);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < args.threads; t++)
+    {
+        auto first_call = start + interval * static_cast<bench_clock::rep>(t) / static_cast<bench_clock::rep>(args.threads);
+        threads.emplace_back(load_thread, std::ref(*logger), first_call, interval, warmup_end, end, std::ref(results[t]));
+    }
+    for (auto &t : threads)
+    {
+        t.join();
+    }
+    // the pool processes what is left before its worker exits
+    logger.reset();
+    tp.reset();
+
+    thread_result total;
+    for (auto &result : results)
+    {
+        total.response.merge(result.response);
+        total.service.merge(result.service);
+        total.calls += result.calls;
+    }
+    auto e2e = sink->histogram();
+    // the overrun or discarded messages never reach the sink (the discard reports of the logger do)
+    auto lost = total.calls > e2e.count() ? total.calls - e2e.count() : 0;
+    spdlog::info("{} - {} calls, {} lost", config.name, total.calls, lost);
+    print_histogram("response", total.response);
+    print_histogram("service", total.service);
+    print_histogram("e2e", e2e);
+}
+
+const char *backend_name(spdlog::details::async_queue_backend backend)
+{
+    switch (backend)
+    {
+    case spdlog::details::async_queue_backend::lock_free:
+        return "lock_free";
+    case spdlog::details::async_queue_backend::per_thread_lanes:
+        return "per_thread_lanes";
+    case spdlog::details::async_queue_backend::arena:
+        return "arena";
+    default:
+        return "blocking";
+    }
+}
+
+const char *wait_strategy_name(spdlog::details::async_wait_strategy strategy)
+{
+    switch (strategy)
+    {
+    case spdlog::details::async_wait_strategy::spin_yield_park:
+        return "spin_yield_park";
+    case spdlog::details::async_wait_strategy::busy_spin:
+        return "busy_spin";
+    default:
+        return "blocking";
+    }
+}
+
+const char *policy_name(spdlog::async_overflow_policy policy)
+{
+    switch (policy)
+    {
+    case spdlog::async_overflow_policy::overrun_oldest:
+        return "overrun_oldest";
+    case spdlog::async_overflow_policy::discard_new:
+        return "discard_new";
+    case spdlog::async_overflow_policy::block_for:
+        return "block_for";
+    default:
+        return "block";
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    using spdlog::async_overflow_policy;
+    using spdlog::details::async_queue_backend;
+    using spdlog::details::async_wait_strategy;
+
+    bench_args args;
+    if (argc > 1)
+        args.rate = std::atof(argv[1]);
+    if (argc > 2)
+        args.threads = static_cast<size_t>(std::atoi(argv[2]));
+    if (argc > 3)
+        args.seconds = std::atof(argv[3]);
+    if (argc > 4)
+        args.queue_size = static_cast<size_t>(std::atoi(argv[4]));
+    if (argc > 5)
+        args.filter = argv[5];
+    if (args.rate <= 0 || args.threads == 0 || args.seconds <= 0 || args.queue_size == 0)
+    {
+        spdlog::error("Usage: {} [rate msgs/sec] [threads] [seconds] [queue size] [name filter]", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    spdlog::set_pattern("%v");
+    spdlog::info("{} calls/sec from {} threads, {} secs (10% warmup), queue of {}", args.rate, args.threads, args.seconds, args.queue_size);
+
+    const async_queue_backend backends[] = {
+        async_queue_backend::blocking, async_queue_backend::lock_free, async_queue_backend::per_thread_lanes, async_queue_backend::arena};
+    const async_wait_strategy strategies[] = {
+        async_wait_strategy::blocking, async_wait_strategy::spin_yield_park, async_wait_strategy::busy_spin};
+    const async_overflow_policy policies[] = {
+        async_overflow_policy::block, async_overflow_policy::overrun_oldest, async_overflow_policy::discard_new};
+
+    for (auto backend : backends)
+    {
+        for (auto strategy : strategies)
+        {
+            for (auto policy : policies)
+            {
+                bench_config config;
+                config.name = std::string(backend_name(backend)) + "/" + wait_strategy_name(strategy) + "/" + policy_name(policy);
+                if (config.name.find(args.filter) == std::string::npos)
+                {
+                    continue;
+                }
+                config.options.queue_backend = backend;
+                config.options.wait_strategy = strategy;
+                config.policy = policy;
+                run(config, args);
+            }
+        }
+    }
+}
@@ -8,6 +8,7 @@
 //
 #include "spdlog/spdlog.h"
 #include "spdlog/sinks/basic_file_sink.h"
+#include "spdlog/sinks/binary_file_sink.h"
 #include "spdlog/sinks/daily_file_sink.h"
 #include "spdlog/sinks/null_sink.h"
 #include "spdlog/sinks/rotating_file_sink.h"
@@ -18,6 +19,7 @@
 #    include "spdlog/fmt/bundled/format.h"
 #endif
 
+#include "alloc_hooks.h"
 #include "utils.h"
 #include <atomic>
 #include <cstdlib> // EXIT_FAILURE
@@ -46,6 +48,8 @@ void bench_threaded_logging(size_t threads, int iters)
     auto basic_mt_tracing = spdlog::basic_logger_mt("basic_mt/backtrace-on", "logs/basic_mt.log", true);
     basic_mt_tracing->enable_backtrace(32);
     bench_mt(iters, std::move(basic_mt_tracing), threads);
+    auto basic_mt_buffered = spdlog::basic_logger_mt("basic_mt/write-buffer", "logs/basic_mt.log", true, 1024 * 1024);
+    bench_mt(iters, std::move(basic_mt_buffered), threads);
 
     spdlog::info("");
     auto rotating_mt = spdlog::rotating_logger_mt("rotating_mt", "logs/rotating_mt.log", file_size, rotating_files);
@@ -83,6 +87,12 @@ void bench_single_threaded(int iters)
     auto basic_st_tracing = spdlog::basic_logger_st("basic_st/backtrace-on", "logs/basic_st.log", true);
     bench(iters, std::move(basic_st_tracing));
 
+    auto basic_st_buffered = spdlog::basic_logger_st("basic_st/write-buffer", "logs/basic_st.log", true, 1024 * 1024);
+    bench(iters, std::move(basic_st_buffered));
+
+    auto binary_st = spdlog::binary_logger_st("binary_st", "logs/binary_st.log", true);
+    bench(iters, std::move(binary_st));
+
     spdlog::info("");
     auto rotating_st = spdlog::rotating_logger_st("rotating_st", "logs/rotating_st.log", file_size, rotating_files);
     bench(iters, std::move(rotating_st));
@@ -149,6 +159,7 @@ void bench(int howmany, std::shared_ptr<spdlog::logger> log)
     using std::chrono::duration_cast;
     using std::chrono::high_resolution_clock;
 
+    auto allocations_before = alloc_hooks::allocations();
     auto start = high_resolution_clock::now();
     for (auto i = 0; i < howmany; ++i)
     {
@@ -157,9 +168,10 @@ void bench(int howmany, std::shared_ptr<spdlog::logger> log)
 
     auto delta = high_resolution_clock::now() - start;
     auto delta_d = duration_cast<duration<double>>(delta).count();
+    auto allocs_per_msg = alloc_hooks::per_message(allocations_before, static_cast<size_t>(howmany));
 
-    spdlog::info(
-        fmt::format(std::locale("en_US.UTF-8"), "{:<30} Elapsed: {:0.2f} secs {:>16L}/sec", log->name(), delta_d, int(howmany / delta_d)));
+    spdlog::info(fmt::format(std::locale("en_US.UTF-8"), "{:<30} Elapsed: {:0.2f} secs {:>16L}/sec {:>8.2f} allocs/msg", log->name(),
+        delta_d, int(howmany / delta_d), allocs_per_msg));
     spdlog::drop(log->name());
 }
 
@@ -171,6 +183,7 @@ void bench_mt(int howmany, std::shared_ptr<spdlog::logger> log, size_t thread_co
 
     std::vector<std::thread> threads;
     threads.reserve(thread_count);
+    auto allocations_before = alloc_hooks::allocations();
     auto start = high_resolution_clock::now();
     for (size_t t = 0; t < thread_count; ++t)
     {
@@ -189,8 +202,10 @@ void bench_mt(int howmany, std::shared_ptr<spdlog::logger> log, size_t thread_co
 
     auto delta = high_resolution_clock::now() - start;
     auto delta_d = duration_cast<duration<double>>(delta).count();
-    spdlog::info(
-        fmt::format(std::locale("en_US.UTF-8"), "{:<30} Elapsed: {:0.2f} secs {:>16L}/sec", log->name(), delta_d, int(howmany / delta_d)));
+    // the thread creations included
+    auto allocs_per_msg = alloc_hooks::per_message(allocations_before, static_cast<size_t>(howmany));
+    spdlog::info(fmt::format(std::locale("en_US.UTF-8"), "{:<30} Elapsed: {:0.2f} secs {:>16L}/sec {:>8.2f} allocs/msg", log->name(),
+        delta_d, int(howmany / delta_d), allocs_per_msg));
     spdlog::drop(log->name());
 }
 
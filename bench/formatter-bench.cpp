@@ -4,9 +4,17 @@
 //
 
 #include "benchmark/benchmark.h"
+#include "alloc_hooks.h"
 
 #include "spdlog/spdlog.h"
 #include "spdlog/pattern_formatter.h"
+#include "spdlog/json_formatter.h"
+#include "spdlog/details/fmt_helper.h"
+
+void report_allocations(benchmark::State &state, size_t allocations_before)
+{
+    state.counters["allocs/msg"] = alloc_hooks::per_message(allocations_before, static_cast<size_t>(state.iterations()));
+}
 
 void bench_formatter(benchmark::State &state, std::string pattern)
 {
@@ -18,16 +26,87 @@ void bench_formatter(benchmark::State &state, std::string pattern)
     spdlog::source_loc source_loc{"a/b/c/d/myfile.cpp", 123, "some_func()"};
     spdlog::details::log_msg msg(source_loc, logger_name, spdlog::level::info, text);
 
+    auto allocations_before = alloc_hooks::allocations();
     for (auto _ : state)
     {
         dest.clear();
         formatter->format(msg, dest);
         benchmark::DoNotOptimize(dest);
     }
+    report_allocations(state, allocations_before);
+}
+
+// messages of two seconds interleaved, as seen by an async worker around a second boundary
+void bench_formatter_alternating_seconds(benchmark::State &state, std::string pattern)
+{
+    auto formatter = spdlog::details::make_unique<spdlog::pattern_formatter>(pattern);
+    spdlog::memory_buf_t dest;
+    std::string logger_name = "logger-name";
+    const char *text = "Hello. This is some message with length of 80                                   ";
+
+    spdlog::source_loc source_loc{"a/b/c/d/myfile.cpp", 123, "some_func()"};
+    spdlog::details::log_msg msg(source_loc, logger_name, spdlog::level::info, text);
+    auto first_time = msg.time;
+    auto second_time = msg.time + std::chrono::seconds(1);
+
+    bool first = true;
+    auto allocations_before = alloc_hooks::allocations();
+    for (auto _ : state)
+    {
+        msg.time = first ? first_time : second_time;
+        first = !first;
+        dest.clear();
+        formatter->format(msg, dest);
+        benchmark::DoNotOptimize(dest);
+    }
+    report_allocations(state, allocations_before);
+}
+
+void bench_json_formatter(benchmark::State &state)
+{
+    spdlog::json_formatter formatter(spdlog::pattern_time_type::local, "\n", spdlog::json_formatter::fields{{"service", "bench"}});
+    spdlog::memory_buf_t dest;
+    std::string logger_name = "logger-name";
+    const char *text = "Hello. This is some message with length of 80                                   ";
+
+    spdlog::source_loc source_loc{"a/b/c/d/myfile.cpp", 123, "some_func()"};
+    spdlog::details::log_msg msg(source_loc, logger_name, spdlog::level::info, text);
+
+    auto allocations_before = alloc_hooks::allocations();
+    for (auto _ : state)
+    {
+        dest.clear();
+        formatter.format(msg, dest);
+        benchmark::DoNotOptimize(dest);
+    }
+    report_allocations(state, allocations_before);
+}
+
+// the zero padded sub second fields (%e/%f/%F) and thread id/pid renderers
+template<void (*Render)(size_t, spdlog::memory_buf_t &)>
+void bench_digits(benchmark::State &state, size_t modulo)
+{
+    spdlog::memory_buf_t dest;
+    size_t n = 0;
+    for (auto _ : state)
+    {
+        dest.clear();
+        Render(n % modulo, dest);
+        benchmark::DoNotOptimize(dest);
+        n += 7919;
+    }
 }
 
 void bench_formatters()
 {
+    benchmark::RegisterBenchmark("json", &bench_json_formatter);
+
+    // digit renderers
+    benchmark::RegisterBenchmark("pad3", &bench_digits<&spdlog::details::fmt_helper::pad3<size_t>>, 1000);
+    benchmark::RegisterBenchmark("pad6", &bench_digits<&spdlog::details::fmt_helper::pad6<size_t>>, 1000000);
+    benchmark::RegisterBenchmark("pad9", &bench_digits<&spdlog::details::fmt_helper::pad9<size_t>>, 1000000000);
+    benchmark::RegisterBenchmark("append_int", &bench_digits<&spdlog::details::fmt_helper::append_int<size_t>>, 1000000);
+
     // basic patterns(single flag)
     std::string all_flags = "+vtPnlLaAbBcCYDmdHIMSefFprRTXzEisg@luioO%";
     std::vector<std::string> basic_patterns;
@@ -36,8 +115,9 @@ void bench_formatters()
         auto pattern = std::string("%") + flag;
         benchmark::RegisterBenchmark(pattern.c_str(), &bench_formatter, pattern);
 
-        //        pattern = std::string("%16") + flag;
-        //        benchmark::RegisterBenchmark(pattern.c_str(), &bench_formatter, pattern);
+        // padded flags are formatted by their flag formatters - compare with the inlined/cached unpadded ones
+        pattern = std::string("%16") + flag;
+        benchmark::RegisterBenchmark(pattern.c_str(), &bench_formatter, pattern);
         //
         //        // bench center padding
         //        pattern = std::string("%=16") + flag;
@@ -49,11 +129,17 @@ void bench_formatters()
         "[%D %X] [%l] [%n] %v",
         "[%Y-%m-%d %H:%M:%S.%e] [%l] [%n] %v",
         "[%Y-%m-%d %H:%M:%S.%e] [%l] [%n] [%t] %v",
+        "[%Y-%m-%d %H:%M:%S.%e] [%n] [%l] %v",
+        "%+",
     };
     for (auto &pattern : patterns)
     {
         benchmark::RegisterBenchmark(pattern.c_str(), &bench_formatter, pattern)->Iterations(2500000);
     }
+
+    std::string pattern = "[%Y-%m-%d %H:%M:%S.%e] [%n] [%l] %v";
+    benchmark::RegisterBenchmark((pattern + " - alternating seconds").c_str(), &bench_formatter_alternating_seconds, pattern)
+        ->Iterations(2500000);
 }
 
 int main(int argc, char *argv[])
@@ -0,0 +1,109 @@
+//
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+#pragma once
+
+// Latency histogram with a bounded relative error (HdrHistogram style).
+// Values below 2^sub_bucket_bits are counted exactly, the others in buckets of 2^(sub_bucket_bits - 1)
+// sub buckets per power of two - less than 1.6% error with 7 bits - so any range of values fits in a few
+// thousand counters. Not thread safe: record into one histogram per thread and merge them.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class hdr_histogram
+{
+public:
+    static const int sub_bucket_bits = 7;
+
+    hdr_histogram()
+        : counts_(index_of(UINT64_MAX) + 1)
+    {}
+
+    void record(int64_t value)
+    {
+        auto v = value < 0 ? 0 : static_cast<uint64_t>(value);
+        counts_[index_of(v)]++;
+        total_++;
+        max_ = (std::max)(max_, v);
+    }
+
+    void merge(const hdr_histogram &other)
+    {
+        for (size_t i = 0; i < counts_.size(); i++)
+        {
+            counts_[i] += other.counts_[i];
+        }
+        total_ += other.total_;
+        max_ = (std::max)(max_, other.max_);
+    }
+
+    uint64_t count() const
+    {
+        return total_;
+    }
+
+    uint64_t max() const
+    {
+        return max_;
+    }
+
+    // the highest value of the bucket holding the given percentile (0 - 100)
+    uint64_t percentile(double p) const
+    {
+        if (total_ == 0)
+        {
+            return 0;
+        }
+        auto rank = static_cast<uint64_t>(p / 100.0 * static_cast<double>(total_) + 0.5);
+        rank = (std::min)((std::max)(rank, uint64_t(1)), total_);
+        uint64_t seen = 0;
+        for (size_t i = 0; i < counts_.size(); i++)
+        {
+            seen += counts_[i];
+            if (seen >= rank)
+            {
+                return (std::min)(highest_value_at(i), max_);
+            }
+        }
+        return max_;
+    }
+
+private:
+    static const uint64_t sub_buckets = uint64_t(1) << sub_bucket_bits;
+    static const uint64_t half_sub_buckets = sub_buckets / 2;
+
+    std::vector<uint64_t> counts_;
+    uint64_t total_ = 0;
+    uint64_t max_ = 0;
+
+    static size_t index_of(uint64_t value)
+    {
+        if (value < sub_buckets)
+        {
+            return static_cast<size_t>(value);
+        }
+        int shift = 1;
+        while ((value >> shift) >= sub_buckets)
+        {
+            shift++;
+        }
+        auto sub_bucket = value >> shift; // in [half_sub_buckets, sub_buckets)
+        return static_cast<size_t>(static_cast<uint64_t>(shift + 1) * half_sub_buckets + sub_bucket - half_sub_buckets);
+    }
+
+    static uint64_t highest_value_at(size_t index)
+    {
+        if (index < sub_buckets)
+        {
+            return index;
+        }
+        auto shift = index / half_sub_buckets - 1;
+        auto sub_bucket = index % half_sub_buckets + half_sub_buckets;
+        return ((sub_bucket + 1) << shift) - 1;
+    }
+};
@@ -8,6 +8,7 @@
 //
 
 #include "benchmark/benchmark.h"
+#include "alloc_hooks.h"
 
 #include "spdlog/spdlog.h"
 #include "spdlog/async.h"
@@ -16,6 +17,14 @@
 #include "spdlog/sinks/null_sink.h"
 #include "spdlog/sinks/rotating_file_sink.h"
 
+// heap allocations per message of every thread (the async workers included), averaged over the benchmark threads
+void report_allocations(benchmark::State &state, size_t allocations_before)
+{
+    auto messages = static_cast<size_t>(state.iterations()) * static_cast<size_t>(state.threads());
+    auto allocs_per_msg = alloc_hooks::per_message(allocations_before, messages);
+    state.counters["allocs/msg"] = benchmark::Counter(allocs_per_msg, benchmark::Counter::kAvgThreads);
+}
+
 void bench_c_string(benchmark::State &state, std::shared_ptr<spdlog::logger> logger)
 {
     const char *msg = "Lorem ipsum dolor sit amet, consectetur adipiscing elit. Vestibulum pharetra metus cursus "
@@ -24,29 +33,35 @@ void bench_c_string(benchmark::State &state, std::shared_ptr<spdlog::logger> log
                       "augue pretium, nec scelerisque est maximus. Nullam convallis, sem nec blandit maximus, nisi turpis ornare "
                       "nisl, sit amet volutpat neque massa eu odio. Maecenas malesuada quam ex, posuere congue nibh turpis duis.";
 
+    auto allocations_before = alloc_hooks::allocations();
     for (auto _ : state)
     {
         logger->info(msg);
     }
+    report_allocations(state, allocations_before);
 }
 
 void bench_logger(benchmark::State &state, std::shared_ptr<spdlog::logger> logger)
 {
     int i = 0;
+    auto allocations_before = alloc_hooks::allocations();
     for (auto _ : state)
     {
         logger->info("Hello logger: msg number {}...............", ++i);
     }
+    report_allocations(state, allocations_before);
 }
 
 void bench_logger_fmt_string(benchmark::State &state, std::shared_ptr<spdlog::logger> logger)
 {
     int i = 0;
+    auto allocations_before = alloc_hooks::allocations();
     for (auto _ : state)
     {
         logger->info(FMT_STRING("Hello logger: msg number {}..............."), ++i);
         ;
     }
+    report_allocations(state, allocations_before);
 }
 
 void bench_disabled_macro(benchmark::State &state, std::shared_ptr<spdlog::logger> logger)
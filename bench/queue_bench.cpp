@@ -0,0 +1,224 @@
+//
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+//
+// queue_bench.cpp : the async queue backends in isolation, without a thread pool, logger or sink
+//
+// For each backend and capacity, 1 to 64 producer threads enqueue (blocking when full) messages of a given
+// payload size, drained by one consumer thread. Besides the throughput (items/s, bytes/s - making the items
+// included), each benchmark reports the latency of an enqueue (p50/p99/p999, in ns) and, where perf counters
+// are available (linux, perf_event_paranoid <= 2), the cache misses per enqueue of the producers.
+//
+//   queue_bench --benchmark_filter=lock_free
+//   queue_bench --benchmark_filter=capacity:1024/ --benchmark_counters_tabular=true
+//
+// A new backend is benchmarked by adding it to the backends table in main().
+//
+
+#include "benchmark/benchmark.h"
+
+#include "spdlog/spdlog.h"
+#include "spdlog/async.h"
+#include "spdlog/details/mpmc_arena_q.h"
+#include "spdlog/details/mpmc_blocking_q.h"
+#include "spdlog/details/mpmc_lockfree_q.h"
+#include "spdlog/details/spsc_lanes_q.h"
+
+#include "hdr_histogram.h"
+
+#ifdef __linux__
+#    include <linux/perf_event.h>
+#    include <sys/ioctl.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using bench_clock = std::chrono::steady_clock;
+using spdlog::details::async_msg;
+using queue_type = spdlog::details::async_queue<async_msg>;
+
+const size_t payload_sizes[] = {16, 256, 4096};
+const size_t capacities[] = {1024, 65536};
+const int max_producers = 64;
+
+// the cache misses of the calling thread, from perf_event_open (-1 if not available)
+class cache_miss_counter
+{
+public:
+    cache_miss_counter()
+    {
+#ifdef __linux__
+        perf_event_attr attr{};
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        if (fd_ != -1)
+        {
+            ::ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+            ::ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    cache_miss_counter(const cache_miss_counter &) = delete;
+    cache_miss_counter &operator=(const cache_miss_counter &) = delete;
+
+    ~cache_miss_counter()
+    {
+#ifdef __linux__
+        if (fd_ != -1)
+        {
+            ::close(fd_);
+        }
+#endif
+    }
+
+    int64_t read()
+    {
+#ifdef __linux__
+        uint64_t count = 0;
+        if (fd_ != -1 && ::read(fd_, &count, sizeof(count)) == static_cast<ssize_t>(sizeof(count)))
+        {
+            return static_cast<int64_t>(count);
+        }
+#endif
+        return -1;
+    }
+
+private:
+    int fd_ = -1;
+};
+
+// the queue of a benchmark run and its consumer, created by the first producer thread
+struct queue_run
+{
+    std::unique_ptr<queue_type> q;
+    std::atomic<bool> stop{false};
+    std::thread consumer;
+
+    explicit queue_run(std::unique_ptr<queue_type> queue)
+        : q{std::move(queue)}
+    {
+        consumer = std::thread([this] {
+            std::vector<async_msg> popped(64);
+            while (!stop.load(std::memory_order_relaxed))
+            {
+                q->dequeue_bulk_for(popped.data(), popped.size(), std::chrono::milliseconds(10));
+            }
+        });
+    }
+
+    ~queue_run()
+    {
+        stop = true;
+        consumer.join();
+    }
+};
+
+struct queue_bench
+{
+    std::function<std::unique_ptr<queue_type>(size_t capacity)> make_queue;
+    size_t capacity;
+    std::unique_ptr<queue_run> run; // while running
+};
+
+void bench_queue(benchmark::State &state, queue_bench *bench)
+{
+    if (state.thread_index() == 0)
+    {
+        bench->run.reset(new queue_run(bench->make_queue(bench->capacity)));
+    }
+    const std::string payload(static_cast<size_t>(state.range(0)), 'x');
+    spdlog::details::log_msg msg("queue_bench", spdlog::level::info, payload);
+    hdr_histogram latencies;
+    cache_miss_counter cache_misses;
+    int64_t misses_before = -1;
+
+    for (auto _ : state)
+    {
+        // made as by the loggers (counted in the throughput, not in the latency of the enqueue)
+        async_msg item(static_cast<spdlog::async_logger *>(nullptr), spdlog::details::async_msg_type::log, msg);
+        if (misses_before == -1)
+        {
+            // not counting the setup (after the threads started)
+            misses_before = cache_misses.read();
+        }
+        auto start = bench_clock::now();
+        bench->run->q->enqueue(std::move(item));
+        latencies.record(std::chrono::duration_cast<std::chrono::nanoseconds>(bench_clock::now() - start).count());
+    }
+    auto misses_after = cache_misses.read();
+    if (state.thread_index() == 0)
+    {
+        bench->run.reset();
+    }
+
+    auto items = static_cast<int64_t>(state.iterations());
+    state.SetItemsProcessed(items);
+    state.SetBytesProcessed(items * static_cast<int64_t>(payload.size()));
+    auto per_thread = benchmark::Counter::kAvgThreads;
+    state.counters["p50_ns"] = benchmark::Counter(static_cast<double>(latencies.percentile(50)), per_thread);
+    state.counters["p99_ns"] = benchmark::Counter(static_cast<double>(latencies.percentile(99)), per_thread);
+    state.counters["p999_ns"] = benchmark::Counter(static_cast<double>(latencies.percentile(99.9)), per_thread);
+    if (misses_before != -1 && misses_after != -1 && items > 0)
+    {
+        state.counters["cache_misses/op"] =
+            benchmark::Counter(static_cast<double>(misses_after - misses_before) / static_cast<double>(items), per_thread);
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    using namespace spdlog::details;
+
+    benchmark::Initialize(&argc, argv);
+
+    // sized like the thread pool does (see thread_pool::make_queue_())
+    std::vector<std::pair<std::string, std::function<std::unique_ptr<queue_type>(size_t)>>> backends = {
+        {"blocking", [](size_t capacity) { return std::unique_ptr<queue_type>(new mpmc_blocking_queue<async_msg>(capacity)); }},
+        {"lock_free", [](size_t capacity) { return std::unique_ptr<queue_type>(new mpmc_lockfree_queue<async_msg>(capacity)); }},
+        {"per_thread_lanes",
+            [](size_t capacity) {
+                return std::unique_ptr<queue_type>(new spsc_lanes_queue<async_msg, async_msg_time_order>(capacity));
+            }},
+        {"arena",
+            [](size_t capacity) {
+                return std::unique_ptr<queue_type>(new mpmc_arena_queue<async_msg, async_msg_arena_codec>(capacity * 128));
+            }},
+    };
+
+    std::vector<std::unique_ptr<queue_bench>> benches;
+    for (auto &backend : backends)
+    {
+        for (auto capacity : capacities)
+        {
+            benches.emplace_back(new queue_bench{backend.second, capacity, nullptr});
+            auto name = backend.first + "/capacity:" + std::to_string(capacity);
+            auto *bench = benchmark::RegisterBenchmark(name.c_str(), bench_queue, benches.back().get());
+            for (auto payload_size : payload_sizes)
+            {
+                bench->Arg(static_cast<int64_t>(payload_size));
+            }
+            bench->ArgName("payload")->ThreadRange(1, max_producers)->UseRealTime();
+        }
+    }
+    benchmark::RunSpecifiedBenchmarks();
+}
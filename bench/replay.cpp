@@ -0,0 +1,756 @@
+//
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+//
+// replay.cpp : replays a captured log through a logger / sink configuration, with its mix of sizes, levels,
+// loggers and bursts
+//
+// The capture is a binary log (see sinks/binary_file_sink.h) or a text log, its lines parsed with the pattern
+// they were written with (--pattern, "%+" by default): the flags Y m d H M S e f F T n l L t v are read, the
+// other ones skipped, a line not matching the pattern is a continuation of the previous message. The messages
+// are logged at their recorded pace (scaled by --speed, 0: as fast as possible) by --threads threads: the
+// messages of a captured thread are logged by the same thread, in order. A logger is made per captured logger
+// name (or a single one, --single-logger), all writing to the --sink sinks.
+//
+// Prints the throughput, the latency of the log calls - from the call (service) and, when paced, from the time
+// it was scheduled at (response) - and for the async loggers the dropped, discarded and blocked messages.
+//
+//   replay logs/app.log --queue 8192 --policy overrun_oldest --speed 10
+//   replay logs/app.bin --speed 0 --sink file:logs/replay.log --sink tcp:127.0.0.1:9000 --queue 65536 --workers 2
+//
+// Options:
+//   --pattern <pattern>       pattern of the text capture's lines ("%+")
+//   --speed <x>               x times the recorded pace, 0: as fast as possible (1)
+//   --threads <n>             replaying threads (the captured ones, at most 16)
+//   --single-logger           one logger for all the messages instead of one per captured logger name
+//   --level <level>           level of the loggers (trace)
+//   --sink <sink>             null, file:<path>, rotating:<path>:<max size>:<max files>, tcp:<host>:<port> (null)
+//   --format <pattern>        pattern of the sinks (the default one)
+//   --queue <size>            async loggers with a queue of this size (0: sync loggers) (0)
+//   --workers <n>             threads of the async pool (1)
+//   --policy <policy>         block, overrun_oldest or discard_new (block)
+//   --backend <backend>       blocking, lock_free, per_thread_lanes or arena (blocking)
+//
+
+#include "spdlog/spdlog.h"
+#include "spdlog/async.h"
+#include "spdlog/details/binary_log.h"
+#include "spdlog/details/binary_log_reader.h"
+#include "spdlog/sinks/basic_file_sink.h"
+#include "spdlog/sinks/null_sink.h"
+#include "spdlog/sinks/rotating_file_sink.h"
+#include "spdlog/sinks/tcp_sink.h"
+
+#include "hdr_histogram.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using bench_clock = std::chrono::steady_clock;
+
+struct captured_msg
+{
+    int64_t time_ns; // since the epoch, 0 if not captured
+    size_t logger;   // index in capture::loggers
+    spdlog::level::level_enum level;
+    size_t thread; // index in capture::threads
+    size_t payload_begin;
+    size_t payload_size;
+};
+
+struct capture
+{
+    std::vector<captured_msg> msgs;
+    std::string payloads; // of all the messages, one after the other
+    std::vector<std::string> loggers;
+    std::vector<size_t> threads; // the captured thread ids
+
+    size_t logger_index(spdlog::string_view_t name)
+    {
+        return index_of_(logger_indexes_, loggers, std::string(name.data(), name.size()));
+    }
+
+    size_t thread_index(size_t thread_id)
+    {
+        return index_of_(thread_indexes_, threads, thread_id);
+    }
+
+    void add(int64_t time_ns, size_t logger, spdlog::level::level_enum level, size_t thread, spdlog::string_view_t payload)
+    {
+        msgs.push_back(captured_msg{time_ns, logger, level, thread, payloads.size(), payload.size()});
+        payloads.append(payload.data(), payload.size());
+    }
+
+    // a line of a multi-line message
+    void append_line(const std::string &line)
+    {
+        payloads.push_back('\n');
+        payloads.append(line.data(), line.size());
+        msgs.back().payload_size += line.size() + 1;
+    }
+
+    spdlog::string_view_t payload(const captured_msg &msg) const
+    {
+        return spdlog::string_view_t(payloads.data() + msg.payload_begin, msg.payload_size);
+    }
+
+private:
+    std::unordered_map<std::string, size_t> logger_indexes_;
+    std::unordered_map<size_t, size_t> thread_indexes_;
+
+    template<typename Map, typename T>
+    static size_t index_of_(Map &indexes, std::vector<T> &values, const T &value)
+    {
+        auto it = indexes.find(value);
+        if (it != indexes.end())
+        {
+            return it->second;
+        }
+        values.push_back(value);
+        indexes.emplace(value, values.size() - 1);
+        return values.size() - 1;
+    }
+};
+
+void read_binary_capture(const std::string &filename, capture &result)
+{
+    spdlog::details::binary_log_reader reader(filename);
+    spdlog::details::log_msg msg;
+    while (reader.read(msg))
+    {
+        auto time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(msg.time.time_since_epoch()).count();
+        result.add(time_ns, result.logger_index(msg.logger_name), msg.level, result.thread_index(msg.thread_id), msg.payload);
+    }
+}
+
+// parses the lines written with a pattern: a list of literal texts and flags
+class line_parser
+{
+public:
+    explicit line_parser(const std::string &pattern)
+    {
+        compile_(pattern == "%+" ? "[%Y-%m-%d %H:%M:%S.%e] [%n] [%l] %v" : pattern);
+    }
+
+    // false if the line doesn't match the pattern
+    bool parse(const std::string &line, capture &result) const
+    {
+        std::tm date{};
+        date.tm_mday = 1;
+        date.tm_isdst = -1;
+        bool has_date = false;
+        int64_t sub_second_ns = 0;
+        spdlog::string_view_t logger_name, payload;
+        std::string text;
+        auto level = spdlog::level::info;
+        size_t thread_id = 0;
+
+        size_t pos = 0;
+        for (size_t i = 0; i < tokens_.size(); i++)
+        {
+            auto &token = tokens_[i];
+            if (token.flag == 0)
+            {
+                if (line.compare(pos, token.text.size(), token.text) != 0)
+                {
+                    return false;
+                }
+                pos += token.text.size();
+                continue;
+            }
+            int digits = digits_of_(token.flag);
+            if (digits > 0)
+            {
+                int value = 0;
+                if (!number_(line, pos, digits, value))
+                {
+                    return false;
+                }
+                has_date = true;
+                set_field_(token.flag, value, date, sub_second_ns);
+                continue;
+            }
+            // a text field: up to the next literal (the end of the line for the last field)
+            size_t end = line.size();
+            if (i + 1 < tokens_.size() && tokens_[i + 1].flag == 0)
+            {
+                end = line.find(tokens_[i + 1].text, pos);
+                if (end == std::string::npos)
+                {
+                    return false;
+                }
+            }
+            auto field = spdlog::string_view_t(line.data() + pos, end - pos);
+            pos = end;
+            switch (token.flag)
+            {
+            case 'n':
+                logger_name = trim_(field);
+                break;
+            case 'l':
+                text = to_string_(trim_(field));
+                level = spdlog::level::from_str(text);
+                break;
+            case 'L':
+                level = short_level_(trim_(field));
+                break;
+            case 't':
+                text = to_string_(trim_(field));
+                thread_id = static_cast<size_t>(std::strtoull(text.c_str(), nullptr, 10));
+                break;
+            case 'v':
+                payload = field;
+                break;
+            default:
+                break;
+            }
+        }
+        if (pos != line.size())
+        {
+            return false;
+        }
+
+        int64_t time_ns = 0;
+        if (has_date)
+        {
+            time_ns = static_cast<int64_t>(std::mktime(&date)) * 1000000000 + sub_second_ns;
+        }
+        result.add(time_ns, result.logger_index(logger_name), level, result.thread_index(thread_id), payload);
+        return true;
+    }
+
+private:
+    struct token
+    {
+        char flag; // 0: literal text
+        std::string text;
+    };
+    std::vector<token> tokens_;
+
+    void compile_(const std::string &pattern)
+    {
+        std::string literal;
+        for (size_t i = 0; i < pattern.size(); i++)
+        {
+            if (pattern[i] != '%' || i + 1 == pattern.size())
+            {
+                literal.push_back(pattern[i]);
+                continue;
+            }
+            // padding spec (e.g. %-8l), ignored: the fields are trimmed
+            i++;
+            while (i + 1 < pattern.size() && (pattern[i] == '-' || pattern[i] == '=' || pattern[i] == '!' || std::isdigit(static_cast<unsigned char>(pattern[i]))))
+            {
+                i++;
+            }
+            char flag = pattern[i];
+            if (flag == '%')
+            {
+                literal.push_back('%');
+                continue;
+            }
+            if (flag == '^' || flag == '$') // color range
+            {
+                continue;
+            }
+            if (flag == 'T')
+            {
+                compile_(std::string("%H:%M:%S"));
+                continue;
+            }
+            push_literal_(literal);
+            tokens_.push_back(token{flag, std::string()});
+        }
+        push_literal_(literal);
+    }
+
+    void push_literal_(std::string &literal)
+    {
+        if (literal.empty())
+        {
+            return;
+        }
+        if (!tokens_.empty() && tokens_.back().flag == 0)
+        {
+            tokens_.back().text += literal;
+        }
+        else
+        {
+            tokens_.push_back(token{0, literal});
+        }
+        literal.clear();
+    }
+
+    static int digits_of_(char flag)
+    {
+        switch (flag)
+        {
+        case 'Y':
+            return 4;
+        case 'm':
+        case 'd':
+        case 'H':
+        case 'M':
+        case 'S':
+            return 2;
+        case 'e':
+            return 3;
+        case 'f':
+            return 6;
+        case 'F':
+            return 9;
+        default:
+            return 0;
+        }
+    }
+
+    static bool number_(const std::string &line, size_t &pos, int digits, int &value)
+    {
+        for (int i = 0; i < digits; i++, pos++)
+        {
+            if (pos >= line.size() || !std::isdigit(static_cast<unsigned char>(line[pos])))
+            {
+                return false;
+            }
+            value = value * 10 + (line[pos] - '0');
+        }
+        return true;
+    }
+
+    static void set_field_(char flag, int value, std::tm &date, int64_t &sub_second_ns)
+    {
+        switch (flag)
+        {
+        case 'Y':
+            date.tm_year = value - 1900;
+            break;
+        case 'm':
+            date.tm_mon = value - 1;
+            break;
+        case 'd':
+            date.tm_mday = value;
+            break;
+        case 'H':
+            date.tm_hour = value;
+            break;
+        case 'M':
+            date.tm_min = value;
+            break;
+        case 'S':
+            date.tm_sec = value;
+            break;
+        case 'e':
+            sub_second_ns = int64_t(value) * 1000000;
+            break;
+        case 'f':
+            sub_second_ns = int64_t(value) * 1000;
+            break;
+        default:
+            sub_second_ns = value;
+            break;
+        }
+    }
+
+    static spdlog::string_view_t trim_(spdlog::string_view_t text)
+    {
+        const char *begin = text.data();
+        const char *end = begin + text.size();
+        while (begin < end && *begin == ' ')
+        {
+            begin++;
+        }
+        while (end > begin && end[-1] == ' ')
+        {
+            end--;
+        }
+        return spdlog::string_view_t(begin, static_cast<size_t>(end - begin));
+    }
+
+    static std::string to_string_(spdlog::string_view_t text)
+    {
+        return std::string(text.data(), text.size());
+    }
+
+    static spdlog::level::level_enum short_level_(spdlog::string_view_t text)
+    {
+        for (int l = spdlog::level::trace; l < spdlog::level::off; l++)
+        {
+            auto level = static_cast<spdlog::level::level_enum>(l);
+            if (to_string_(text) == spdlog::level::to_short_c_str(level))
+            {
+                return level;
+            }
+        }
+        return spdlog::level::info;
+    }
+};
+
+void read_text_capture(const std::string &filename, const std::string &pattern, capture &result)
+{
+    std::ifstream in(filename, std::ios::binary);
+    if (!in)
+    {
+        spdlog::throw_spdlog_ex("cannot open " + filename);
+    }
+    line_parser parser(pattern);
+    std::string line;
+    size_t skipped = 0;
+    while (std::getline(in, line))
+    {
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.pop_back();
+        }
+        if (parser.parse(line, result))
+        {
+            continue;
+        }
+        if (result.msgs.empty())
+        {
+            skipped++;
+        }
+        else
+        {
+            result.append_line(line);
+        }
+    }
+    if (skipped > 0)
+    {
+        spdlog::warn("{} lines before the first one matching the pattern skipped", skipped);
+    }
+}
+
+bool is_binary_capture(const std::string &filename)
+{
+    char magic[sizeof(spdlog::details::binary_log::magic)] = {};
+    std::ifstream in(filename, std::ios::binary);
+    return in.read(magic, sizeof(magic)) && std::memcmp(magic, spdlog::details::binary_log::magic, sizeof(magic)) == 0;
+}
+
+struct replay_args
+{
+    std::string filename;
+    std::string pattern = "%+";
+    double speed = 1;
+    size_t threads = 0;
+    bool single_logger = false;
+    spdlog::level::level_enum level = spdlog::level::trace;
+    std::vector<std::string> sinks;
+    std::string format;
+    size_t queue_size = 0;
+    size_t workers = 1;
+    spdlog::async_overflow_policy policy = spdlog::async_overflow_policy::block;
+    spdlog::details::async_queue_backend backend = spdlog::details::async_queue_backend::blocking;
+};
+
+std::vector<std::string> split(const std::string &text, char separator)
+{
+    std::vector<std::string> parts;
+    size_t start = 0;
+    for (;;)
+    {
+        auto end = text.find(separator, start);
+        parts.push_back(text.substr(start, end == std::string::npos ? std::string::npos : end - start));
+        if (end == std::string::npos)
+        {
+            return parts;
+        }
+        start = end + 1;
+    }
+}
+
+spdlog::sink_ptr make_sink(const std::string &spec)
+{
+    auto parts = split(spec, ':');
+    if (parts[0] == "null" && parts.size() == 1)
+    {
+        return std::make_shared<spdlog::sinks::null_sink_mt>();
+    }
+    if (parts[0] == "file" && parts.size() == 2)
+    {
+        return std::make_shared<spdlog::sinks::basic_file_sink_mt>(parts[1], true);
+    }
+    if (parts[0] == "rotating" && parts.size() == 4)
+    {
+        return std::make_shared<spdlog::sinks::rotating_file_sink_mt>(
+            parts[1], std::strtoull(parts[2].c_str(), nullptr, 10), std::strtoull(parts[3].c_str(), nullptr, 10));
+    }
+    if (parts[0] == "tcp" && parts.size() == 3)
+    {
+        return std::make_shared<spdlog::sinks::tcp_sink_mt>(spdlog::sinks::tcp_sink_config(parts[1], std::atoi(parts[2].c_str())));
+    }
+    spdlog::throw_spdlog_ex("unknown sink: " + spec);
+}
+
+bool parse_args(int argc, char *argv[], replay_args &args)
+{
+    if (argc < 2)
+    {
+        return false;
+    }
+    args.filename = argv[1];
+    for (int i = 2; i < argc; i++)
+    {
+        std::string option = argv[i];
+        if (option == "--single-logger")
+        {
+            args.single_logger = true;
+            continue;
+        }
+        if (i + 1 == argc)
+        {
+            return false;
+        }
+        std::string value = argv[++i];
+        if (option == "--pattern")
+            args.pattern = value;
+        else if (option == "--speed")
+            args.speed = std::atof(value.c_str());
+        else if (option == "--threads")
+            args.threads = static_cast<size_t>(std::atoi(value.c_str()));
+        else if (option == "--level")
+            args.level = spdlog::level::from_str(value);
+        else if (option == "--sink")
+            args.sinks.push_back(value);
+        else if (option == "--format")
+            args.format = value;
+        else if (option == "--queue")
+            args.queue_size = static_cast<size_t>(std::atoi(value.c_str()));
+        else if (option == "--workers")
+            args.workers = static_cast<size_t>(std::atoi(value.c_str()));
+        else if (option == "--policy")
+        {
+            if (value == "block")
+                args.policy = spdlog::async_overflow_policy::block;
+            else if (value == "overrun_oldest")
+                args.policy = spdlog::async_overflow_policy::overrun_oldest;
+            else if (value == "discard_new")
+                args.policy = spdlog::async_overflow_policy::discard_new;
+            else
+                return false;
+        }
+        else if (option == "--backend")
+        {
+            if (value == "blocking")
+                args.backend = spdlog::details::async_queue_backend::blocking;
+            else if (value == "lock_free")
+                args.backend = spdlog::details::async_queue_backend::lock_free;
+            else if (value == "per_thread_lanes")
+                args.backend = spdlog::details::async_queue_backend::per_thread_lanes;
+            else if (value == "arena")
+                args.backend = spdlog::details::async_queue_backend::arena;
+            else
+                return false;
+        }
+        else
+            return false;
+    }
+    return args.speed >= 0 && args.workers > 0;
+}
+
+struct thread_result
+{
+    hdr_histogram response;
+    hdr_histogram service;
+    uint64_t calls = 0;
+};
+
+// log the messages of the thread on their schedule (start + their time since the first message / speed)
+void replay_thread(const capture &captured, const std::vector<const captured_msg *> &msgs,
+    const std::vector<std::shared_ptr<spdlog::logger>> &loggers, int64_t first_time_ns, double speed, bench_clock::time_point start,
+    thread_result &result)
+{
+    for (auto *msg : msgs)
+    {
+        auto scheduled = start;
+        if (speed > 0)
+        {
+            scheduled += std::chrono::duration_cast<bench_clock::duration>(
+                std::chrono::duration<double, std::nano>(static_cast<double>(msg->time_ns - first_time_ns) / speed));
+        }
+        auto now = bench_clock::now();
+        if (scheduled - now > std::chrono::milliseconds(1))
+        {
+            std::this_thread::sleep_until(scheduled - std::chrono::microseconds(500));
+        }
+        // spin the rest: sleeping would oversleep the schedule by the timer slack
+        auto call = bench_clock::now();
+        while (call < scheduled)
+        {
+            std::this_thread::yield();
+            call = bench_clock::now();
+        }
+        loggers[msg->logger]->log(spdlog::source_loc{}, msg->level, captured.payload(*msg));
+        auto done = bench_clock::now();
+        if (speed > 0)
+        {
+            result.response.record(std::chrono::duration_cast<std::chrono::nanoseconds>(done - scheduled).count());
+        }
+        result.service.record(std::chrono::duration_cast<std::chrono::nanoseconds>(done - call).count());
+        result.calls++;
+    }
+}
+
+void print_histogram(const char *what, const hdr_histogram &histogram)
+{
+    spdlog::info("  {:<9} p50 {:>9} p90 {:>9} p99 {:>9} p99.9 {:>9} p99.99 {:>9} max {:>10} ns", what, histogram.percentile(50),
+        histogram.percentile(90), histogram.percentile(99), histogram.percentile(99.9), histogram.percentile(99.99), histogram.max());
+}
+
+int main(int argc, char *argv[])
+{
+    replay_args args;
+    if (!parse_args(argc, argv, args))
+    {
+        std::fprintf(stderr,
+            "Usage: %s <log file> [--pattern <pattern>] [--speed <x>] [--threads <n>] [--single-logger] [--level <level>]\n"
+            "    [--sink null|file:<path>|rotating:<path>:<max size>:<max files>|tcp:<host>:<port>]... [--format <pattern>]\n"
+            "    [--queue <size>] [--workers <n>] [--policy block|overrun_oldest|discard_new]\n"
+            "    [--backend blocking|lock_free|per_thread_lanes|arena]\n",
+            argv[0]);
+        return EXIT_FAILURE;
+    }
+    spdlog::set_pattern("%v");
+
+    try
+    {
+        capture captured;
+        if (is_binary_capture(args.filename))
+        {
+            read_binary_capture(args.filename, captured);
+        }
+        else
+        {
+            read_text_capture(args.filename, args.pattern, captured);
+        }
+        if (captured.msgs.empty())
+        {
+            spdlog::error("no message in {}", args.filename);
+            return EXIT_FAILURE;
+        }
+
+        std::vector<spdlog::sink_ptr> sinks;
+        for (auto &spec : args.sinks)
+        {
+            sinks.push_back(make_sink(spec));
+        }
+        if (sinks.empty())
+        {
+            sinks.push_back(std::make_shared<spdlog::sinks::null_sink_mt>());
+        }
+        if (!args.format.empty())
+        {
+            for (auto &sink : sinks)
+            {
+                sink->set_pattern(args.format);
+            }
+        }
+
+        std::shared_ptr<spdlog::details::thread_pool> tp;
+        if (args.queue_size > 0)
+        {
+            spdlog::details::thread_pool_options options;
+            options.queue_backend = args.backend;
+            options.collect_stats = true;
+            tp = std::make_shared<spdlog::details::thread_pool>(args.queue_size, args.workers, options);
+        }
+        std::vector<std::shared_ptr<spdlog::logger>> loggers;
+        for (size_t i = 0; i < (args.single_logger ? 1 : captured.loggers.size()); i++)
+        {
+            auto name = args.single_logger ? std::string("replay") : captured.loggers[i];
+            std::shared_ptr<spdlog::logger> logger;
+            if (tp)
+            {
+                logger = std::make_shared<spdlog::async_logger>(name, sinks.begin(), sinks.end(), tp, args.policy);
+            }
+            else
+            {
+                logger = std::make_shared<spdlog::logger>(name, sinks.begin(), sinks.end());
+            }
+            logger->set_level(args.level);
+            loggers.push_back(std::move(logger));
+        }
+        if (args.single_logger)
+        {
+            loggers.resize(captured.loggers.size(), loggers[0]);
+        }
+
+        // the messages of a captured thread go to the same replaying thread
+        auto n_threads = args.threads > 0 ? args.threads : (std::min)(captured.threads.size(), size_t(16));
+        std::vector<std::vector<const captured_msg *>> thread_msgs(n_threads);
+        int64_t first_time_ns = captured.msgs[0].time_ns;
+        uint64_t payload_bytes = 0;
+        for (auto &msg : captured.msgs)
+        {
+            thread_msgs[msg.thread % n_threads].push_back(&msg);
+            first_time_ns = (std::min)(first_time_ns, msg.time_ns);
+            payload_bytes += msg.payload_size;
+        }
+        auto recorded_ns = captured.msgs.back().time_ns - first_time_ns;
+        spdlog::info("{}: {} messages, {} loggers, {} threads, {:.3f} secs recorded - replayed by {} threads at {}", args.filename,
+            captured.msgs.size(), captured.loggers.size(), captured.threads.size(), static_cast<double>(recorded_ns) / 1e9, n_threads,
+            args.speed > 0 ? fmt::format("{}x speed", args.speed) : std::string("full speed"));
+
+        std::vector<thread_result> results(n_threads);
+        std::vector<std::thread> threads;
+        auto start = bench_clock::now() + std::chrono::milliseconds(10);
+        for (size_t t = 0; t < n_threads; t++)
+        {
+            threads.emplace_back(replay_thread, std::cref(captured), std::cref(thread_msgs[t]), std::cref(loggers), first_time_ns, args.speed,
+                start, std::ref(results[t]));
+        }
+        for (auto &t : threads)
+        {
+            t.join();
+        }
+        auto calls_done = bench_clock::now();
+        for (auto &logger : loggers)
+        {
+            logger->flush();
+        }
+        auto flushed = bench_clock::now();
+
+        thread_result total;
+        for (auto &result : results)
+        {
+            total.response.merge(result.response);
+            total.service.merge(result.service);
+            total.calls += result.calls;
+        }
+        auto seconds = std::chrono::duration<double>(calls_done - start).count();
+        spdlog::info("{} calls in {:.3f} secs ({:.3f} secs until flushed): {:.0f} msgs/sec, {:.2f} MB/sec of payloads", total.calls, seconds,
+            std::chrono::duration<double>(flushed - start).count(), static_cast<double>(total.calls) / seconds,
+            static_cast<double>(payload_bytes) / seconds / 1e6);
+        if (args.speed > 0)
+        {
+            print_histogram("response", total.response);
+        }
+        print_histogram("service", total.service);
+        if (tp)
+        {
+            auto stats = tp->stats();
+            spdlog::info("async: {} dropped (overrun), {} discarded, {} blocked ({} ms blocked), queue high water mark {}", stats.dropped,
+                stats.discarded, stats.blocked, std::chrono::duration_cast<std::chrono::milliseconds>(stats.blocked_time).count(),
+                stats.high_water_mark);
+        }
+    }
+    catch (const spdlog::spdlog_ex &ex)
+    {
+        spdlog::error("{}", ex.what());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,154 @@
+//
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+//
+// rotation_bench.cpp : the stalls of the log calls around file rotations
+//
+// The rotating file sink rotates every max_file_size bytes, the daily and hourly sinks every
+// messages_per_period messages: their messages are stamped by a fake clock moving a day (or an hour) ahead
+// every messages_per_period messages. Each sink keeps max_files files, so the rotations delete files too.
+// Each runs with the rotation done in the logging thread and in the background (background_rotation).
+//
+// Besides the throughput, each benchmark reports the latency of a log call over all the threads
+// (p50/p99/p999 and the worst case, in ns): the rotations show in the tail.
+//
+//   rotation_bench --benchmark_filter=daily
+//   rotation_bench --benchmark_counters_tabular=true
+//
+
+#include "benchmark/benchmark.h"
+
+#include "spdlog/spdlog.h"
+#include "spdlog/sinks/daily_file_sink.h"
+#include "spdlog/sinks/hourly_file_sink.h"
+#include "spdlog/sinks/rotating_file_sink.h"
+
+#include "hdr_histogram.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using bench_clock = std::chrono::steady_clock;
+
+const size_t payload_size = 128;
+const size_t max_file_size = 64 * 1024;
+const size_t messages_per_period = 1000;
+const uint16_t max_files = 3;
+
+// stamps the messages, moving a period ahead every messages_per_period messages (of all the threads)
+class fake_clock
+{
+public:
+    explicit fake_clock(std::chrono::hours period)
+        : period_{period}
+        , start_{spdlog::log_clock::now()}
+    {}
+
+    spdlog::log_clock::time_point now()
+    {
+        auto n = messages_.fetch_add(1, std::memory_order_relaxed);
+        return start_ + period_ * static_cast<int64_t>(n / messages_per_period);
+    }
+
+private:
+    std::chrono::hours period_;
+    spdlog::log_clock::time_point start_;
+    std::atomic<uint64_t> messages_{0};
+};
+
+struct rotation_case
+{
+    std::shared_ptr<spdlog::logger> logger;
+    std::unique_ptr<fake_clock> clock; // null: the system clock (size based rotation)
+
+    // the latencies of the threads of a run, merged by the last one done
+    std::mutex mutex;
+    hdr_histogram latencies;
+    int threads_done = 0;
+};
+
+void bench_rotation(benchmark::State &state, rotation_case *bench)
+{
+    const std::string payload(payload_size, 'x');
+    hdr_histogram latencies;
+    for (auto _ : state)
+    {
+        auto start = bench_clock::now();
+        if (bench->clock)
+        {
+            bench->logger->log(bench->clock->now(), spdlog::source_loc{}, spdlog::level::info, payload);
+        }
+        else
+        {
+            bench->logger->info(payload);
+        }
+        latencies.record(std::chrono::duration_cast<std::chrono::nanoseconds>(bench_clock::now() - start).count());
+    }
+
+    auto items = static_cast<int64_t>(state.iterations());
+    state.SetItemsProcessed(items);
+    state.SetBytesProcessed(items * static_cast<int64_t>(payload.size()));
+
+    // the worst case is over all the threads: reported (once) from the merged latencies
+    std::lock_guard<std::mutex> lock(bench->mutex);
+    bench->latencies.merge(latencies);
+    if (++bench->threads_done < state.threads())
+    {
+        return;
+    }
+    state.counters["p50_ns"] = static_cast<double>(bench->latencies.percentile(50));
+    state.counters["p99_ns"] = static_cast<double>(bench->latencies.percentile(99));
+    state.counters["p999_ns"] = static_cast<double>(bench->latencies.percentile(99.9));
+    state.counters["max_ns"] = static_cast<double>(bench->latencies.max());
+    bench->latencies = hdr_histogram();
+    bench->threads_done = 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    using namespace spdlog::sinks;
+
+    int max_threads = static_cast<int>(std::max(2u, std::thread::hardware_concurrency()));
+    spdlog::set_automatic_registration(false);
+    benchmark::Initialize(&argc, argv);
+
+    std::vector<std::unique_ptr<rotation_case>> cases;
+    auto add_case = [&](const std::string &name, spdlog::sink_ptr sink, std::chrono::hours period) {
+        cases.emplace_back(new rotation_case);
+        cases.back()->logger = std::make_shared<spdlog::logger>(name, std::move(sink));
+        if (period.count() > 0)
+        {
+            cases.back()->clock.reset(new fake_clock(period));
+        }
+        auto *bench = benchmark::RegisterBenchmark(name.c_str(), bench_rotation, cases.back().get());
+        bench->ThreadRange(1, max_threads)->UseRealTime();
+    };
+
+    const std::chrono::hours size_based{0};
+    for (bool background : {false, true})
+    {
+        std::string mode = background ? "background" : "sync";
+        std::string dir = "logs/rotation_bench/";
+        add_case("rotating/" + mode,
+            std::make_shared<rotating_file_sink_mt>(dir + "rotating_" + mode + ".log", max_file_size, max_files, false, 0, false, background),
+            size_based);
+        add_case("daily/" + mode,
+            std::make_shared<daily_file_sink_mt>(dir + "daily_" + mode + ".log", 0, 0, false, max_files, 0, false, false, background),
+            std::chrono::hours(24));
+        add_case("hourly/" + mode, std::make_shared<hourly_file_sink_mt>(dir + "hourly_" + mode + ".log", false, max_files, false, background),
+            std::chrono::hours(1));
+    }
+    benchmark::RunSpecifiedBenchmarks();
+}
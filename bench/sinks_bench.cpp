@@ -0,0 +1,331 @@
+//
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+//
+// sinks_bench.cpp : the sinks that can run locally, synchronous and asynchronous
+//
+// Sweeps the payload size and the number of logging threads for every sink, and the queue size
+// and overflow policy of the async loggers. Besides the throughput (items/s, bytes/s), each
+// benchmark reports the latency of a log call (p50/p99/p999, in ns) and the heap allocations per message
+// (of every thread, the async workers included).
+//
+//   sinks_bench --benchmark_filter=async/null
+//   sinks_bench --benchmark_filter=tcp --benchmark_counters_tabular=true
+//
+
+#include "benchmark/benchmark.h"
+#include "alloc_hooks.h"
+
+#include "spdlog/spdlog.h"
+#include "spdlog/async.h"
+#include "spdlog/sinks/ansicolor_sink.h"
+#include "spdlog/sinks/dist_sink.h"
+#include "spdlog/sinks/dup_filter_sink.h"
+#include "spdlog/sinks/null_sink.h"
+#include "spdlog/sinks/ostream_sink.h"
+#include "spdlog/sinks/rate_limit_sink.h"
+#include "spdlog/sinks/ringbuffer_sink.h"
+
+#ifndef _WIN32
+#    include "spdlog/sinks/syslog_sink.h"
+#    include "spdlog/sinks/tcp_sink.h"
+#    include "spdlog/sinks/udp_sink.h"
+#    include "spdlog/sinks/unix_socket_sink.h"
+
+#    include <arpa/inet.h>
+#    include <netinet/in.h>
+#    include <sys/socket.h>
+#    include <sys/un.h>
+#    include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using bench_clock = std::chrono::steady_clock;
+
+// latency samples kept per benchmark thread
+const size_t max_latency_samples = 1 << 20;
+const size_t payload_sizes[] = {16, 256, 4096};
+const size_t queue_sizes[] = {8192, 131072};
+
+// discard everything written to it (the ostream_sink target)
+class null_streambuf : public std::streambuf
+{
+protected:
+    std::streamsize xsputn(const char *, std::streamsize n) override
+    {
+        return n;
+    }
+
+    int_type overflow(int_type c) override
+    {
+        return traits_type::not_eof(c);
+    }
+};
+
+null_streambuf null_buf;
+std::ostream null_ostream(&null_buf);
+
+int64_t percentile(std::vector<int64_t> &samples, double p)
+{
+    if (samples.empty())
+    {
+        return 0;
+    }
+    auto nth = samples.begin() + static_cast<std::ptrdiff_t>(p * static_cast<double>(samples.size() - 1));
+    std::nth_element(samples.begin(), nth, samples.end());
+    return *nth;
+}
+
+void bench_sink(benchmark::State &state, std::shared_ptr<spdlog::logger> logger)
+{
+    const std::string payload(static_cast<size_t>(state.range(0)), 'x');
+    std::vector<int64_t> samples;
+    samples.reserve(max_latency_samples);
+    int i = 0;
+
+    auto allocations_before = alloc_hooks::allocations();
+    for (auto _ : state)
+    {
+        auto start = bench_clock::now();
+        logger->info("msg {}: {}", ++i, payload);
+        auto elapsed = bench_clock::now() - start;
+        if (samples.size() < max_latency_samples)
+        {
+            samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        }
+    }
+    // the messages queued by an async logger are part of the run
+    logger->flush();
+    auto items = static_cast<int64_t>(state.iterations());
+    auto allocs_per_msg = alloc_hooks::per_message(allocations_before, static_cast<size_t>(items * state.threads()));
+    state.SetItemsProcessed(items);
+    state.SetBytesProcessed(items * static_cast<int64_t>(payload.size()));
+    // averaged over the threads (they all count the allocations of every thread)
+    auto per_thread = benchmark::Counter::kAvgThreads;
+    state.counters["p50_ns"] = benchmark::Counter(static_cast<double>(percentile(samples, 0.5)), per_thread);
+    state.counters["p99_ns"] = benchmark::Counter(static_cast<double>(percentile(samples, 0.99)), per_thread);
+    state.counters["p999_ns"] = benchmark::Counter(static_cast<double>(percentile(samples, 0.999)), per_thread);
+    state.counters["allocs/msg"] = benchmark::Counter(allocs_per_msg, per_thread);
+}
+
+void register_sink(const std::string &name, spdlog::sink_ptr sink, int max_threads)
+{
+    auto logger = std::make_shared<spdlog::logger>(name, std::move(sink));
+    auto *bench = benchmark::RegisterBenchmark(("sync/" + name).c_str(), bench_sink, logger);
+    for (auto payload_size : payload_sizes)
+    {
+        bench->Arg(static_cast<int64_t>(payload_size));
+    }
+    bench->ArgName("payload")->ThreadRange(1, max_threads)->UseRealTime();
+}
+
+const char *policy_name(spdlog::async_overflow_policy policy)
+{
+    switch (policy)
+    {
+    case spdlog::async_overflow_policy::block:
+        return "block";
+    case spdlog::async_overflow_policy::overrun_oldest:
+        return "overrun_oldest";
+    case spdlog::async_overflow_policy::discard_new:
+        return "discard_new";
+    default:
+        return "block_for";
+    }
+}
+
+// the thread pools must outlive the async loggers (they only keep a weak_ptr)
+std::vector<std::shared_ptr<spdlog::details::thread_pool>> thread_pools;
+
+void register_async_sink(const std::string &name, spdlog::sink_ptr sink, int max_threads)
+{
+    const spdlog::async_overflow_policy policies[] = {
+        spdlog::async_overflow_policy::block, spdlog::async_overflow_policy::overrun_oldest, spdlog::async_overflow_policy::discard_new};
+    for (auto queue_size : queue_sizes)
+    {
+        for (auto policy : policies)
+        {
+            auto tp = std::make_shared<spdlog::details::thread_pool>(queue_size, 1);
+            thread_pools.push_back(tp);
+            auto logger = std::make_shared<spdlog::async_logger>(name, sink, tp, policy);
+            auto bench_name = "async/" + name + "/queue:" + std::to_string(queue_size) + "/" + policy_name(policy);
+            auto *bench = benchmark::RegisterBenchmark(bench_name.c_str(), bench_sink, logger);
+            for (auto payload_size : payload_sizes)
+            {
+                bench->Arg(static_cast<int64_t>(payload_size));
+            }
+            bench->ArgName("payload")->ThreadRange(1, max_threads)->UseRealTime();
+        }
+    }
+}
+
+#ifndef _WIN32
+// a local server reading (and dropping) everything sent to it by the network sinks
+class drain_server
+{
+public:
+    drain_server(int domain, int type, const sockaddr *addr, socklen_t addr_len)
+    {
+        fd_ = ::socket(domain, type, 0);
+        if (fd_ == -1 || ::bind(fd_, addr, addr_len) != 0 || (type == SOCK_STREAM && ::listen(fd_, 1) != 0))
+        {
+            std::perror("drain_server");
+            std::exit(EXIT_FAILURE);
+        }
+        thread_ = std::thread([this, type] {
+            int conn = type == SOCK_STREAM ? ::accept(fd_, nullptr, nullptr) : fd_;
+            if (type == SOCK_STREAM)
+            {
+                conn_.store(conn);
+            }
+            char buf[64 * 1024];
+            while (conn != -1 && ::recv(conn, buf, sizeof(buf), 0) > 0) {}
+        });
+    }
+
+    drain_server(const drain_server &) = delete;
+    drain_server &operator=(const drain_server &) = delete;
+
+    ~drain_server()
+    {
+        ::shutdown(fd_, SHUT_RDWR);
+        int conn = conn_.load();
+        if (conn != -1)
+        {
+            ::shutdown(conn, SHUT_RDWR);
+        }
+        thread_.join();
+        if (conn != -1)
+        {
+            ::close(conn);
+        }
+        ::close(fd_);
+    }
+
+    int port() const
+    {
+        sockaddr_in addr{};
+        socklen_t addr_len = sizeof(addr);
+        ::getsockname(fd_, reinterpret_cast<sockaddr *>(&addr), &addr_len);
+        return ntohs(addr.sin_port);
+    }
+
+private:
+    int fd_ = -1;
+    std::atomic<int> conn_{-1};
+    std::thread thread_;
+};
+
+std::unique_ptr<drain_server> loopback_server(int type)
+{
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    return std::unique_ptr<drain_server>(new drain_server(AF_INET, type, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)));
+}
+
+std::unique_ptr<drain_server> unix_datagram_server(const std::string &path)
+{
+    ::unlink(path.c_str());
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path.c_str());
+    return std::unique_ptr<drain_server>(new drain_server(AF_UNIX, SOCK_DGRAM, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)));
+}
+#endif
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    using namespace spdlog::sinks;
+
+    int max_threads = static_cast<int>(std::max(2u, std::thread::hardware_concurrency()));
+    spdlog::set_automatic_registration(false);
+    benchmark::Initialize(&argc, argv);
+
+    std::unique_ptr<FILE, int (*)(FILE *)> dev_null(std::fopen("/dev/null", "w"), std::fclose);
+    if (!dev_null)
+    {
+        std::perror("/dev/null");
+        return EXIT_FAILURE;
+    }
+
+    auto dist = std::make_shared<dist_sink_mt>();
+    dist->add_sink(std::make_shared<null_sink_mt>());
+    dist->add_sink(std::make_shared<null_sink_mt>());
+    auto dist_parallel = std::make_shared<dist_sink_parallel>();
+    dist_parallel->add_sink(std::make_shared<null_sink_mt>());
+    dist_parallel->add_sink(std::make_shared<null_sink_mt>());
+    // every message is a duplicate of the previous one but its counter: none is filtered
+    auto dup_filter = std::make_shared<dup_filter_sink_mt>(std::chrono::seconds(5));
+    dup_filter->add_sink(std::make_shared<null_sink_mt>());
+    // a bucket that never runs out
+    auto rate_limit = std::make_shared<rate_limit_sink_mt>(1e12, 1000000);
+    rate_limit->add_sink(std::make_shared<null_sink_mt>());
+
+    std::vector<std::pair<std::string, spdlog::sink_ptr>> sinks = {
+        {"null", std::make_shared<null_sink_mt>()},
+        {"ostream", std::make_shared<ostream_sink_mt>(null_ostream)},
+        {"ringbuffer", std::make_shared<ringbuffer_sink_mt>(4096)},
+        {"dup_filter", dup_filter},
+        {"dist", dist},
+        {"dist_parallel", dist_parallel},
+        {"rate_limit", rate_limit},
+        {"ansicolor", std::make_shared<ansicolor_sink<spdlog::details::console_mutex>>(dev_null.get(), spdlog::color_mode::always)},
+    };
+
+#ifndef _WIN32
+    auto tcp_server = loopback_server(SOCK_STREAM);
+    auto udp_server = loopback_server(SOCK_DGRAM);
+    const std::string syslog_path = "sinks_bench_syslog.sock";
+    const std::string unix_path = "sinks_bench_unix.sock";
+    auto syslog_server = unix_datagram_server(syslog_path);
+    auto unix_server = unix_datagram_server(unix_path);
+
+    syslog_socket_config syslog_config;
+    syslog_config.socket_path = syslog_path;
+    sinks.emplace_back("tcp", std::make_shared<tcp_sink_mt>(tcp_sink_config("127.0.0.1", tcp_server->port())));
+    sinks.emplace_back("udp", std::make_shared<udp_sink_mt>(udp_sink_config("127.0.0.1", udp_server->port())));
+    sinks.emplace_back("syslog", std::make_shared<syslog_sink_mt>("sinks_bench", 0, LOG_USER, true, syslog_config));
+    sinks.emplace_back("unix_socket", std::make_shared<unix_socket_sink_mt>(unix_socket_sink_config(unix_path)));
+#endif
+
+    for (auto &sink : sinks)
+    {
+        register_sink(sink.first, sink.second, max_threads);
+    }
+    for (auto &sink : sinks)
+    {
+        register_async_sink(sink.first, sink.second, max_threads);
+    }
+    benchmark::RunSpecifiedBenchmarks();
+
+    // the sinks write to the servers until the loggers are gone
+    benchmark::ClearRegisteredBenchmarks();
+    thread_pools.clear();
+    sinks.clear();
+    dist.reset();
+    dist_parallel.reset();
+    dup_filter.reset();
+    rate_limit.reset();
+#ifndef _WIN32
+    ::unlink(syslog_path.c_str());
+    ::unlink(unix_path.c_str());
+#endif
+}
@@ -0,0 +1,234 @@
+//
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+//
+// startup_bench.cpp : the cost of setting up many loggers, and the memory they take
+//
+// lifecycle/loggers:N/sinks:M - makes N loggers sharing M sinks, then times (in ns per logger) each step:
+//   create     - constructing the loggers
+//   initialize - spdlog::initialize_loggers(): registering them, with the global formatter (cloned for each
+//                sink), level and flush level
+//   set_levels - registry::set_levels() with a level for each of them, as loaded from a config
+//   pattern    - spdlog::set_pattern(): a formatter clone per logger and sink
+//   drop       - spdlog::drop_all()
+//
+// footprint/... - resident memory (and heap allocations) taken by a logger, a sink and an async queue slot of each
+// backend: the growth of the process RSS over many of them, after returning the free heap pages to the system
+// (glibc). RSS is read from /proc/self/statm: linux only, the other platforms report the allocations only.
+//
+//   startup_bench --benchmark_filter=lifecycle
+//   startup_bench --benchmark_filter=footprint --benchmark_counters_tabular=true
+//
+
+#include "benchmark/benchmark.h"
+#include "alloc_hooks.h"
+
+#include "spdlog/spdlog.h"
+#include "spdlog/async.h"
+#include "spdlog/sinks/null_sink.h"
+
+#if defined(__linux__)
+#    include <malloc.h>
+#    include <unistd.h>
+#endif
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+using bench_clock = std::chrono::steady_clock;
+
+const int64_t logger_counts[] = {100, 1000, 10000};
+const int64_t sink_counts[] = {1, 4};
+// enough of each for the page granularity of the RSS not to matter
+const size_t footprint_loggers = 20000;
+const size_t footprint_sinks = 20000;
+const size_t footprint_queue_slots = 1 << 20;
+
+// resident bytes of the process, 0 if not known
+size_t resident_bytes()
+{
+#if defined(__linux__)
+    std::unique_ptr<FILE, int (*)(FILE *)> statm(std::fopen("/proc/self/statm", "r"), std::fclose);
+    unsigned long size = 0;
+    unsigned long resident = 0;
+    if (statm && std::fscanf(statm.get(), "%lu %lu", &size, &resident) == 2)
+    {
+        return static_cast<size_t>(resident) * static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    }
+#endif
+    return 0;
+}
+
+// the resident bytes once the free heap pages are given back, so that the memory freed by the previous
+// benchmarks is not reused unnoticed
+size_t trimmed_resident_bytes()
+{
+#if defined(__GLIBC__)
+    ::malloc_trim(0);
+#endif
+    return resident_bytes();
+}
+
+double nanos_per(bench_clock::duration d, size_t n)
+{
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count()) / static_cast<double>(n);
+}
+
+void bench_lifecycle(benchmark::State &state)
+{
+    auto n_loggers = static_cast<size_t>(state.range(0));
+    auto n_sinks = static_cast<size_t>(state.range(1));
+    std::vector<spdlog::sink_ptr> sinks;
+    for (size_t i = 0; i < n_sinks; i++)
+    {
+        sinks.push_back(std::make_shared<spdlog::sinks::null_sink_mt>());
+    }
+    std::vector<std::string> names;
+    spdlog::details::registry::log_levels levels;
+    for (size_t i = 0; i < n_loggers; i++)
+    {
+        names.push_back("logger_" + std::to_string(i));
+        levels[names.back()] = spdlog::level::warn;
+    }
+
+    bench_clock::duration create{}, initialize{}, set_levels{}, pattern{}, drop{};
+    for (auto _ : state)
+    {
+        auto t0 = bench_clock::now();
+        std::vector<std::shared_ptr<spdlog::logger>> loggers;
+        loggers.reserve(n_loggers);
+        for (auto &name : names)
+        {
+            loggers.push_back(std::make_shared<spdlog::logger>(name, sinks.begin(), sinks.end()));
+        }
+        auto t1 = bench_clock::now();
+        spdlog::initialize_loggers(std::move(loggers));
+        auto t2 = bench_clock::now();
+        spdlog::details::registry::instance().set_levels(levels, nullptr);
+        auto t3 = bench_clock::now();
+        spdlog::set_pattern("[%H:%M:%S.%e] [%n] [%l] %v");
+        auto t4 = bench_clock::now();
+        spdlog::drop_all();
+        auto t5 = bench_clock::now();
+        create += t1 - t0;
+        initialize += t2 - t1;
+        set_levels += t3 - t2;
+        pattern += t4 - t3;
+        drop += t5 - t4;
+    }
+
+    auto per_logger = static_cast<size_t>(state.iterations()) * n_loggers;
+    state.counters["create_ns"] = nanos_per(create, per_logger);
+    state.counters["initialize_ns"] = nanos_per(initialize, per_logger);
+    state.counters["set_levels_ns"] = nanos_per(set_levels, per_logger);
+    state.counters["pattern_ns"] = nanos_per(pattern, per_logger);
+    state.counters["drop_ns"] = nanos_per(drop, per_logger);
+    state.SetItemsProcessed(static_cast<int64_t>(per_logger));
+}
+
+void report_footprint(benchmark::State &state, size_t rss_before, size_t allocations_before, size_t n)
+{
+    auto rss_after = resident_bytes();
+    if (rss_before != 0 && rss_after != 0)
+    {
+        auto grown = rss_after > rss_before ? rss_after - rss_before : 0;
+        state.counters["rss_bytes"] = static_cast<double>(grown) / static_cast<double>(n);
+    }
+    state.counters["allocs"] = alloc_hooks::per_message(allocations_before, n);
+}
+
+// registered loggers sharing one sink
+void bench_logger_footprint(benchmark::State &state)
+{
+    auto sink = std::make_shared<spdlog::sinks::null_sink_mt>();
+    for (auto _ : state)
+    {
+        std::vector<std::shared_ptr<spdlog::logger>> loggers;
+        loggers.reserve(footprint_loggers);
+        auto rss_before = trimmed_resident_bytes();
+        auto allocations_before = alloc_hooks::allocations();
+        for (size_t i = 0; i < footprint_loggers; i++)
+        {
+            loggers.push_back(std::make_shared<spdlog::logger>("logger_" + std::to_string(i), sink));
+        }
+        spdlog::initialize_loggers(std::move(loggers));
+        report_footprint(state, rss_before, allocations_before, footprint_loggers);
+        spdlog::drop_all();
+    }
+}
+
+void bench_sink_footprint(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        std::vector<spdlog::sink_ptr> sinks;
+        sinks.reserve(footprint_sinks);
+        auto rss_before = trimmed_resident_bytes();
+        auto allocations_before = alloc_hooks::allocations();
+        for (size_t i = 0; i < footprint_sinks; i++)
+        {
+            sinks.push_back(std::make_shared<spdlog::sinks::null_sink_mt>());
+        }
+        report_footprint(state, rss_before, allocations_before, footprint_sinks);
+    }
+}
+
+// the queue of a thread pool, once every slot has been used (the pages of the queue are touched lazily)
+void bench_queue_footprint(benchmark::State &state, spdlog::details::async_queue_backend backend)
+{
+    spdlog::details::thread_pool_options options;
+    options.queue_backend = backend;
+    for (auto _ : state)
+    {
+        auto rss_before = trimmed_resident_bytes();
+        auto allocations_before = alloc_hooks::allocations();
+        auto tp = std::make_shared<spdlog::details::thread_pool>(footprint_queue_slots, 1, options);
+        auto logger =
+            std::make_shared<spdlog::async_logger>("queue", std::make_shared<spdlog::sinks::null_sink_st>(), tp, spdlog::async_overflow_policy::block);
+        for (size_t i = 0; i < footprint_queue_slots; i++)
+        {
+            logger->info("message {}", i);
+        }
+        logger->flush();
+        report_footprint(state, rss_before, allocations_before, footprint_queue_slots);
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    benchmark::Initialize(&argc, argv);
+
+    // first, while the heap is small
+    benchmark::RegisterBenchmark("footprint/logger", bench_logger_footprint)->Iterations(1);
+    benchmark::RegisterBenchmark("footprint/sink", bench_sink_footprint)->Iterations(1);
+    const std::pair<const char *, spdlog::details::async_queue_backend> backends[] = {
+        {"footprint/queue_slot/blocking", spdlog::details::async_queue_backend::blocking},
+        {"footprint/queue_slot/lock_free", spdlog::details::async_queue_backend::lock_free},
+        {"footprint/queue_slot/per_thread_lanes", spdlog::details::async_queue_backend::per_thread_lanes},
+        {"footprint/queue_slot/arena", spdlog::details::async_queue_backend::arena},
+    };
+    for (auto &backend : backends)
+    {
+        benchmark::RegisterBenchmark(backend.first, bench_queue_footprint, backend.second)->Iterations(1)->UseRealTime();
+    }
+
+    auto *lifecycle = benchmark::RegisterBenchmark("lifecycle", bench_lifecycle);
+    for (auto n_loggers : logger_counts)
+    {
+        for (auto n_sinks : sink_counts)
+        {
+            lifecycle->Args({n_loggers, n_sinks});
+        }
+    }
+    lifecycle->ArgNames({"loggers", "sinks"})->Unit(benchmark::kMicrosecond);
+    benchmark::RunSpecifiedBenchmarks();
+}
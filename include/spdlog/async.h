@@ -72,6 +72,13 @@ inline std::shared_ptr<spdlog::logger> create_async_nb(std::string logger_name,
     return async_factory_nonblock::create<Sink>(std::move(logger_name), std::forward<SinkArgs>(sink_args)...);
 }
 
+// set global thread pool with the given options (e.g. lock-free queue backend).
+inline void init_thread_pool(size_t q_size, size_t thread_count, const details::thread_pool_options &options)
+{
+    auto tp = std::make_shared<details::thread_pool>(q_size, thread_count, options);
+    details::registry::instance().set_tp(std::move(tp));
+}
+
 // set global thread pool.
 inline void init_thread_pool(size_t q_size, size_t thread_count, std::function<void()> on_thread_start)
 {
@@ -8,10 +8,16 @@
 #endif
 
 #include <spdlog/sinks/sink.h>
+#include <spdlog/details/payload_cap.h>
+#include <spdlog/details/prepared_batch.h>
 #include <spdlog/details/thread_pool.h>
 
+#include <algorithm>
+#include <cstring>
+#include <functional>
 #include <memory>
 #include <string>
+#include <type_traits>
 
 SPDLOG_INLINE spdlog::async_logger::async_logger(
     std::string logger_name, sinks_init_list sinks_list, std::weak_ptr<details::thread_pool> tp, async_overflow_policy overflow_policy)
@@ -23,9 +29,57 @@ SPDLOG_INLINE spdlog::async_logger::async_logger(
     : async_logger(std::move(logger_name), {std::move(single_sink)}, std::move(tp), overflow_policy)
 {}
 
-// send the log message to the thread pool
+SPDLOG_INLINE spdlog::async_logger::async_logger(const async_logger &other)
+    : std::enable_shared_from_this<async_logger>()
+    , logger(other)
+    , thread_pool_(other.thread_pool_)
+    , overflow_policy_(other.overflow_policy_)
+    , block_timeout_(other.block_timeout_)
+    , processors_(other.processors_)
+{
+    init_();
+}
+
+SPDLOG_INLINE spdlog::async_logger::~async_logger()
+{
+    // its timer calls flush_()
+    flush_controller_.reset();
+    if (!attached_)
+    {
+        return;
+    }
+    SPDLOG_TRY
+    {
+        pinned_pool_->detach_logger(this);
+    }
+    SPDLOG_CATCH_STD
+}
+
+SPDLOG_INLINE void spdlog::async_logger::init_()
+{
+    // the time orders the messages of the shards and measures the queue latency
+    required_msg_fields_ = details::msg_fields::time;
+    shard_hint_.store(std::hash<std::string>{}(name_), std::memory_order_relaxed);
+    auto pool_ptr = thread_pool_.lock();
+    // the arena queues take the messages formatted straight into their records
+    in_place_format_ = pool_ptr && pool_ptr->formats_in_place();
+    if (pool_ptr && pool_ptr->pins_loggers())
+    {
+        pool_ptr->attach_logger(this);
+        attached_ = true;
+        pinned_pool_ = std::move(pool_ptr);
+    }
+}
+
+// send the log message to the thread pool.
+// an attached logger posts to its pinned pool: no refcount update on the way.
 SPDLOG_INLINE void spdlog::async_logger::sink_it_(const details::log_msg &msg)
 {
+    if (attached_)
+    {
+        pinned_pool_->post_log(this, msg, overflow_policy_);
+        return;
+    }
     // 因为是 weak_ptr，所以在使用之前需要先使用 .lock 转换为 shared_ptr 智能指针
     if (auto pool_ptr = thread_pool_.lock())
     {
@@ -37,9 +91,64 @@ SPDLOG_INLINE void spdlog::async_logger::sink_it_(const details::log_msg &msg)
     }
 }
 
+SPDLOG_INLINE bool spdlog::async_logger::sink_deferred_(
+    const details::log_msg &msg, details::deferred_format_fn format_fn, const void *args, size_t args_size)
+{
+    string_view_t format_args(static_cast<const char *>(args), args_size);
+    if (attached_)
+    {
+        pinned_pool_->post_deferred_log(nullptr, this, msg, format_fn, format_args, overflow_policy_);
+        return true;
+    }
+    if (auto pool_ptr = thread_pool_.lock())
+    {
+        pool_ptr->post_deferred_log(shared_from_this(), this, msg, format_fn, format_args, overflow_policy_);
+    }
+    else
+    {
+        throw_spdlog_ex("async log: thread pool doesn't exist anymore");
+    }
+    return true;
+}
+
+SPDLOG_INLINE bool spdlog::async_logger::sink_in_place_(const details::log_msg &msg, fmt::format_args args, size_t &formatted_size)
+{
+    if (attached_)
+    {
+        return pinned_pool_->post_formatted_log(details::async_logger_ptr{}, this, msg, args, overflow_policy_, formatted_size);
+    }
+    if (auto pool_ptr = thread_pool_.lock())
+    {
+        return pool_ptr->post_formatted_log(shared_from_this(), this, msg, args, overflow_policy_, formatted_size);
+    }
+    throw_spdlog_ex("async log: thread pool doesn't exist anymore");
+}
+
+SPDLOG_INLINE void spdlog::async_logger::sink_lines_(const details::log_msg &msg, string_view_t lines)
+{
+    if (attached_)
+    {
+        pinned_pool_->post_log_batch(details::async_logger_ptr{}, this, msg, lines, overflow_policy_);
+        return;
+    }
+    if (auto pool_ptr = thread_pool_.lock())
+    {
+        pool_ptr->post_log_batch(shared_from_this(), this, msg, lines, overflow_policy_);
+    }
+    else
+    {
+        throw_spdlog_ex("async log: thread pool doesn't exist anymore");
+    }
+}
+
 // send flush request to the thread pool
 SPDLOG_INLINE void spdlog::async_logger::flush_()
 {
+    if (attached_)
+    {
+        pinned_pool_->post_flush(this, overflow_policy_);
+        return;
+    }
     if (auto pool_ptr = thread_pool_.lock())
     {
         pool_ptr->post_flush(shared_from_this(), overflow_policy_);
@@ -50,44 +159,399 @@ SPDLOG_INLINE void spdlog::async_logger::flush_()
     }
 }
 
+// the loggers of a thread pool are flushed by a single message (see thread_pool::post_flush_batch())
+SPDLOG_INLINE void spdlog::async_logger::flush_batched_(std::vector<details::flush_batch> &batches)
+{
+    auto pool_ptr = attached_ ? pinned_pool_ : thread_pool_.lock();
+    if (!pool_ptr)
+    {
+        flush_();
+        return;
+    }
+    auto it = std::find_if(batches.begin(), batches.end(),
+        [&](const details::flush_batch &batch) { return batch.post == &post_flush_batch_ && batch.owner == pool_ptr; });
+    if (it == batches.end())
+    {
+        batches.push_back(details::flush_batch{std::move(pool_ptr), {}, &post_flush_batch_, &abandon_flush_batch_});
+        it = batches.end() - 1;
+    }
+    it->loggers.push_back(this);
+}
+
+// with the worker threads of the pool
+SPDLOG_INLINE std::future<void> spdlog::async_logger::post_flush_batch_(const details::flush_batch &batch, size_t)
+{
+    std::vector<details::async_logger_ptr> loggers;
+    loggers.reserve(batch.loggers.size());
+    for (auto *l : batch.loggers)
+    {
+        loggers.push_back(static_cast<async_logger *>(l)->shared_from_this());
+    }
+    return std::static_pointer_cast<details::thread_pool>(batch.owner)->post_flush_batch(loggers);
+}
+
+SPDLOG_INLINE void spdlog::async_logger::abandon_flush_batch_(const details::flush_batch &batch)
+{
+    std::static_pointer_cast<details::thread_pool>(batch.owner)->discard_queued();
+}
+
+SPDLOG_INLINE std::future<void> spdlog::async_logger::flush_async()
+{
+    if (attached_)
+    {
+        return pinned_pool_->post_flush_async(details::async_logger_ptr{}, this);
+    }
+    if (auto pool_ptr = thread_pool_.lock())
+    {
+        return pool_ptr->post_flush_async(shared_from_this(), this);
+    }
+    throw_spdlog_ex("async flush: thread pool doesn't exist anymore");
+}
+
+SPDLOG_INLINE void spdlog::async_logger::flush_async(std::function<void()> on_flushed)
+{
+    if (attached_)
+    {
+        pinned_pool_->post_flush_async(details::async_logger_ptr{}, this, std::move(on_flushed));
+        return;
+    }
+    if (auto pool_ptr = thread_pool_.lock())
+    {
+        pool_ptr->post_flush_async(shared_from_this(), this, std::move(on_flushed));
+        return;
+    }
+    throw_spdlog_ex("async flush: thread pool doesn't exist anymore");
+}
+
+SPDLOG_INLINE void spdlog::async_logger::when_queue_has_room(std::function<void(bool)> on_room)
+{
+    if (attached_)
+    {
+        pinned_pool_->when_queue_has_room(*this, std::move(on_room));
+        return;
+    }
+    if (auto pool_ptr = thread_pool_.lock())
+    {
+        pool_ptr->when_queue_has_room(*this, std::move(on_room));
+        return;
+    }
+    throw_spdlog_ex("async log: thread pool doesn't exist anymore");
+}
+
 //
 // backend functions - called from the thread pool to do the actual job
 //
 SPDLOG_INLINE void spdlog::async_logger::backend_sink_it_(const details::log_msg &msg)
 {
+    if (!processors_.empty())
+    {
+        auto processed = msg;
+        if (process_(&processed, 1) == 0)
+        {
+            return;
+        }
+        log_to_sinks_(processed);
+        if (flush_due_(processed))
+        {
+            backend_flush_();
+        }
+        return;
+    }
+    log_to_sinks_(msg);
+
+    if (flush_due_(msg))
+    {
+        backend_flush_();
+    }
+}
+
+// format the message with its captured args, then sink it
+SPDLOG_INLINE void spdlog::async_logger::backend_sink_deferred_(const details::async_msg &incoming_msg)
+{
+    SPDLOG_TRY
+    {
+        // copy the args to properly aligned storage
+        std::aligned_storage<SPDLOG_DEFERRED_ARGS_SIZE, alignof(std::max_align_t)>::type args;
+        auto format_args = incoming_msg.extra();
+        std::memcpy(&args, format_args.data(), format_args.size());
+
+        details::scoped_buffer scoped_buf;
+        auto &buf = scoped_buf.get();
+        details::profile_timer timer;
+        incoming_msg.format_fn(buf, incoming_msg.payload, &args);
+        auto max_payload = max_payload_bytes_.load(std::memory_order_relaxed);
+        if (max_payload != 0 && buf.size() > max_payload)
+        {
+            details::mark_truncated(buf, max_payload);
+            truncated_.fetch_add(1, std::memory_order_relaxed);
+        }
+        profile_.on_formatted(buf.size(), timer);
+        details::log_msg formatted(incoming_msg);
+        formatted.payload = string_view_t(buf.data(), buf.size());
+        formatted.payload_id = 0;
+        backend_sink_it_(formatted);
+    }
+    SPDLOG_LOGGER_CATCH()
+}
+
+SPDLOG_INLINE void spdlog::async_logger::backend_sink_lines_(const details::async_msg &incoming_msg)
+{
+    SPDLOG_TRY
+    {
+        std::vector<details::log_msg> msgs;
+        details::log_lines_to_msgs(incoming_msg, incoming_msg.extra(), msgs);
+        backend_sink_batch_(msgs.data(), msgs.size());
+    }
+    SPDLOG_LOGGER_CATCH()
+}
+
+// pass a batch of consecutive messages of this logger to each sink at once
+SPDLOG_INLINE void spdlog::async_logger::backend_sink_batch_(details::log_msg *msgs, size_t n_msgs)
+{
+    n_msgs = process_(msgs, n_msgs);
+    if (n_msgs == 0)
+    {
+        return;
+    }
+    details::profile_timer timer;
     for (auto &sink : sinks_)
     {
-        if (sink->should_log(msg.level))
+        SPDLOG_TRY
+        {
+            sink->log_batch(msgs, n_msgs);
+        }
+        SPDLOG_LOGGER_CATCH()
+    }
+    profile_.on_dispatched(timer);
+
+    bool flush = false;
+    for (size_t i = 0; i < n_msgs; i++)
+    {
+        flush = flush_due_(msgs[i]) || flush;
+    }
+    if (flush)
+    {
+        backend_flush_();
+    }
+}
+
+SPDLOG_INLINE bool spdlog::async_logger::backend_prepare_(const details::async_msg &incoming_msg, details::prepared_batch &batch, size_t index)
+{
+    // the processors see the messages in order
+    if (!processors_.empty())
+    {
+        return false;
+    }
+    auto &prepared = batch.msgs[index];
+    details::log_msg msg(incoming_msg);
+    prepared.first_text = batch.texts.size();
+    bool ready = false;
+    SPDLOG_TRY
+    {
+        if (incoming_msg.format_fn != nullptr)
         {
-            SPDLOG_TRY
+            std::aligned_storage<SPDLOG_DEFERRED_ARGS_SIZE, alignof(std::max_align_t)>::type args;
+            auto format_args = incoming_msg.extra();
+            std::memcpy(&args, format_args.data(), format_args.size());
+            details::scoped_buffer scoped_buf;
+            auto &buf = scoped_buf.get();
+            details::profile_timer timer;
+            incoming_msg.format_fn(buf, incoming_msg.payload, &args);
+            auto max_payload = max_payload_bytes_.load(std::memory_order_relaxed);
+            if (max_payload != 0 && buf.size() > max_payload)
             {
-                sink->log(msg);
+                details::mark_truncated(buf, max_payload);
+                truncated_.fetch_add(1, std::memory_order_relaxed);
             }
-            SPDLOG_LOGGER_CATCH()
+            profile_.on_formatted(buf.size(), timer);
+            prepared.has_payload = true;
+            prepared.payload_begin = batch.text.size();
+            prepared.payload_size = buf.size();
+            batch.text.append(buf.data(), buf.data() + buf.size());
         }
+        // batch.text moves as it grows: the sinks format from a copy of the payload
+        details::scoped_buffer scoped_payload;
+        if (prepared.has_payload)
+        {
+            auto &payload = scoped_payload.get();
+            payload.append(batch.text.data() + prepared.payload_begin, batch.text.data() + prepared.payload_begin + prepared.payload_size);
+            msg.payload = string_view_t(payload.data(), payload.size());
+            msg.payload_id = 0;
+        }
+        for (size_t i = 0; i < sinks_.size(); i++)
+        {
+            auto begin = batch.text.size();
+            if (sinks_[i]->should_log(msg.level) && sinks_[i]->format_ahead(msg, batch.text))
+            {
+                // the color range is given in the whole buffer
+                bool colored = msg.color_range_end > msg.color_range_start;
+                batch.texts.push_back(details::prepared_batch::sink_text{i, begin, batch.text.size() - begin,
+                    colored ? msg.color_range_start - begin : 0, colored ? msg.color_range_end - begin : 0});
+            }
+        }
+        prepared.n_texts = batch.texts.size() - prepared.first_text;
+        ready = true;
+    }
+    SPDLOG_CATCH_STD
+    if (!ready)
+    {
+        // formatted again in turn, which reports the error
+        batch.texts.resize(prepared.first_text);
+        prepared = details::prepared_batch::message{};
+        return false;
     }
+    prepared.ready = true;
+    return true;
+}
 
-    if (should_flush_(msg))
+SPDLOG_INLINE void spdlog::async_logger::backend_sink_prepared_(
+    const details::async_msg &incoming_msg, const details::prepared_batch &batch, size_t index)
+{
+    const auto &prepared = batch.msgs[index];
+    details::log_msg msg(incoming_msg);
+    if (prepared.has_payload)
+    {
+        msg.payload = batch.view(prepared.payload_begin, prepared.payload_size);
+        msg.payload_id = 0;
+    }
+    details::profile_timer timer;
+    size_t next_text = prepared.first_text;
+    size_t end_text = prepared.first_text + prepared.n_texts;
+    for (size_t i = 0; i < sinks_.size(); i++)
+    {
+        auto &sink = sinks_[i];
+        bool has_text = next_text < end_text && batch.texts[next_text].sink == i;
+        const details::prepared_batch::sink_text *text = has_text ? &batch.texts[next_text++] : nullptr;
+        if (!sink->should_log(msg.level))
+        {
+            sink->profile_counters().on_filtered();
+            continue;
+        }
+        SPDLOG_TRY
+        {
+            if (text != nullptr)
+            {
+                msg.color_range_start = text->color_range_start;
+                msg.color_range_end = text->color_range_end;
+                sink->log_formatted(msg, batch.view(text->begin, text->size));
+            }
+            else
+            {
+                sink->log(msg);
+            }
+        }
+        SPDLOG_LOGGER_CATCH()
+    }
+    profile_.on_dispatched(timer);
+    if (flush_due_(msg))
     {
         backend_flush_();
     }
 }
 
-SPDLOG_INLINE void spdlog::async_logger::backend_flush_()
+SPDLOG_INLINE size_t spdlog::async_logger::process_(details::log_msg *msgs, size_t n_msgs)
+{
+    SPDLOG_TRY
+    {
+        for (auto &stage : processors_)
+        {
+            if (n_msgs == 0)
+            {
+                break;
+            }
+            n_msgs = (std::min)(stage->process(msgs, n_msgs), n_msgs);
+        }
+        return n_msgs;
+    }
+    SPDLOG_LOGGER_CATCH()
+    return 0;
+}
+
+SPDLOG_INLINE void spdlog::async_logger::backend_flush_(std::vector<const sinks::sink *> *flushed)
 {
+    details::profile_timer timer;
+    on_flush_();
     for (auto &sink : sinks_)
     {
+        if (flushed != nullptr)
+        {
+            if (std::find(flushed->begin(), flushed->end(), sink.get()) != flushed->end())
+            {
+                continue;
+            }
+            flushed->push_back(sink.get());
+        }
         SPDLOG_TRY
         {
             sink->flush();
         }
         SPDLOG_LOGGER_CATCH()
     }
+    profile_.on_flushed(timer);
+}
+
+SPDLOG_INLINE void spdlog::async_logger::backend_report_discarded_(size_t n_msgs)
+{
+    SPDLOG_TRY
+    {
+        auto payload = fmt::format("{} messages dropped from logger {}", n_msgs, name_);
+        details::log_msg msg(name_, level::warn, payload);
+        backend_sink_it_(msg);
+    }
+    SPDLOG_LOGGER_CATCH()
+}
+
+SPDLOG_INLINE void spdlog::async_logger::set_deferred_formatting(bool enabled)
+{
+    deferred_format_.store(enabled, std::memory_order_relaxed);
+}
+
+SPDLOG_INLINE void spdlog::async_logger::set_processors(std::vector<std::shared_ptr<processor>> processors)
+{
+    processors_ = std::move(processors);
+    for (auto &stage : processors_)
+    {
+        required_msg_fields_ |= stage->required_fields();
+    }
+}
+
+SPDLOG_INLINE void spdlog::async_logger::set_shard(size_t shard)
+{
+    shard_hint_.store(shard, std::memory_order_relaxed);
+}
+
+SPDLOG_INLINE void spdlog::async_logger::set_order_insensitive(bool enabled)
+{
+    order_insensitive_ = enabled;
+}
+
+SPDLOG_INLINE void spdlog::async_logger::set_block_timeout(std::chrono::nanoseconds timeout)
+{
+    block_timeout_ = timeout;
+}
+
+SPDLOG_INLINE double spdlog::async_logger::load_factor() const
+{
+    if (attached_)
+    {
+        return pinned_pool_->load_factor(*this);
+    }
+    if (auto pool_ptr = thread_pool_.lock())
+    {
+        return pool_ptr->load_factor(*this);
+    }
+    return 0;
+}
+
+SPDLOG_INLINE spdlog::details::async_stats spdlog::async_logger::stats() const
+{
+    return stats_.snapshot();
 }
 
 SPDLOG_INLINE std::shared_ptr<spdlog::logger> spdlog::async_logger::clone(std::string new_name)
 {
     auto cloned = std::make_shared<spdlog::async_logger>(*this);
     cloned->name_ = std::move(new_name);
+    cloned->shard_hint_.store(std::hash<std::string>{}(cloned->name_), std::memory_order_relaxed);
     return cloned;
 }
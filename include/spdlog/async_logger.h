@@ -15,6 +15,23 @@
 // destructing..
 
 #include <spdlog/logger.h>
+#include <spdlog/processor.h>
+#include <spdlog/details/async_stats.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <vector>
+
+// the awaitable flush and queue room (C++20 coroutines)
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#    if __has_include(<coroutine>)
+#        include <coroutine>
+#        define SPDLOG_COROUTINES
+#    endif
+#endif
 
 namespace spdlog {
 
@@ -22,13 +39,24 @@ namespace spdlog {
 enum class async_overflow_policy
 {
     block,         // Block until message can be enqueued
-    overrun_oldest // Discard oldest message in the queue if full when trying to
-                   // add new item.
+    overrun_oldest, // Discard oldest message in the queue if full when trying to
+                    // add new item.
+    discard_new,    // Discard the new message if the queue is full. the number of
+                    // discarded messages is logged once the queue drains.
+    block_for,      // Block until message can be enqueued, for up to the logger's
+                    // block timeout (see async_logger::set_block_timeout()). then
+                    // discard it like discard_new.
+    spill           // Write the message to the pool's spill file if the queue is full
+                    // (see thread_pool_options::spill_file), replayed in order by the
+                    // workers once they caught up. block while the spill file is full
+                    // too, or like block if the pool has none.
 };
 
 namespace details {
 class thread_pool;
-}
+struct async_msg;
+struct prepared_batch;
+} // namespace details
 
 class SPDLOG_API async_logger final : public std::enable_shared_from_this<async_logger>, public logger
 {
@@ -41,7 +69,9 @@ public:
         : logger(std::move(logger_name), begin, end)
         , thread_pool_(std::move(tp))
         , overflow_policy_(overflow_policy)
-    {}
+    {
+        init_();
+    }
 
     async_logger(std::string logger_name, sinks_init_list sinks_list, std::weak_ptr<details::thread_pool> tp,
         async_overflow_policy overflow_policy = async_overflow_policy::block);
@@ -49,19 +79,166 @@ public:
     async_logger(std::string logger_name, sink_ptr single_sink, std::weak_ptr<details::thread_pool> tp,
         async_overflow_policy overflow_policy = async_overflow_policy::block);
 
+    async_logger(const async_logger &other);
+
+    // detach from the thread pool (if attached), waiting for the queued messages to be processed
+    ~async_logger() override;
+
     std::shared_ptr<logger> clone(std::string new_name) override;
 
+    // post a flush request, whose future is fulfilled once the messages logged before were written and the
+    // sinks flushed by the thread pool (see thread_pool::post_flush_async()).
+    std::future<void> flush_async();
+    // same, calling on_flushed on the worker that flushed instead of fulfilling a future: it must not block it.
+    void flush_async(std::function<void()> on_flushed);
+
+    // call on_room(true) once the queue of the thread pool has room for this logger's messages (see
+    // thread_pool::when_queue_has_room()) - to wait for it without blocking before logging with the block policy.
+    void when_queue_has_room(std::function<void(bool)> on_room);
+
+#ifdef SPDLOG_COROUTINES
+    // co_await logger->flush_awaitable(): resumed on the worker once the messages logged before were written and
+    // the sinks flushed. the coroutine runs on the worker until it suspends again: it should hop to its own
+    // executor before any long or blocking work (logging with the block policy included).
+    struct flush_awaiter
+    {
+        async_logger *logger;
+
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            logger->flush_async([handle] { handle.resume(); });
+        }
+        void await_resume() const noexcept {}
+    };
+    flush_awaiter flush_awaitable()
+    {
+        return flush_awaiter{this};
+    }
+
+    // co_await logger->queue_room(): suspends while the queue is full (instead of blocking in the next log call),
+    // resumed on a worker once it has room - with true, or false if the thread pool was destroyed. another
+    // producer may fill the queue again before the coroutine logs.
+    struct room_awaiter
+    {
+        async_logger *logger;
+        bool has_room = true;
+        // set to 1 by the callback, to 2 once suspended: the last one resumes
+        std::atomic<int> state{0};
+
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+        bool await_suspend(std::coroutine_handle<> handle)
+        {
+            logger->when_queue_has_room([this, handle](bool room) {
+                has_room = room;
+                if (state.exchange(1) == 2)
+                {
+                    handle.resume();
+                }
+            });
+            // not suspended if called back already (e.g. there was room)
+            return state.exchange(2) != 1;
+        }
+        bool await_resume() const noexcept
+        {
+            return has_room;
+        }
+    };
+    room_awaiter queue_room()
+    {
+        return room_awaiter{this};
+    }
+#endif
+
+    // format messages on the thread pool workers instead of the calling thread.
+    // applies to messages whose format args are all arithmetic types - others (and all messages while
+    // backtrace is enabled) are still formatted by the caller. format errors are reported by the worker.
+    // can be toggled while other threads log.
+    void set_deferred_formatting(bool enabled);
+
+    // post to the given shard (modulo the number of shards) of a sharded thread pool,
+    // instead of the one picked by the logger name hash. the messages logged before may still be
+    // processed after the ones logged after on another shard.
+    void set_shard(size_t shard);
+
+    // let the workers of the other shards of a thread pool with thread_pool_options::work_stealing set
+    // process this logger's messages: they are then processed in any order, its sinks must be thread safe.
+    // should be called before logging.
+    void set_order_insensitive(bool enabled);
+
+    // the stages processing the messages on the thread pool workers before the sinks, in order (see
+    // spdlog/processor.h). should be called before logging.
+    void set_processors(std::vector<std::shared_ptr<processor>> processors);
+
+    // max time to wait for room in the queue with the block_for overflow policy (default: 50us)
+    void set_block_timeout(std::chrono::nanoseconds timeout);
+
+    // the load factor (0 to 1) of the queue this logger posts to, lock free (see thread_pool::load_factor()):
+    // e.g. to drop optional messages before the queue is full. 0 if the thread pool doesn't exist anymore.
+    double load_factor() const;
+
+    // lock-free snapshot of this logger's counters, collected by thread pools with
+    // thread_pool_options::collect_stats set. dropped is not tracked per logger, and
+    // high_water_mark is the max number of the logger's messages in flight.
+    details::async_stats stats() const;
+
 protected:
     void sink_it_(const details::log_msg &msg) override;
     void flush_() override;
+    void flush_batched_(std::vector<details::flush_batch> &batches) override;
+    bool sink_deferred_(const details::log_msg &msg, details::deferred_format_fn format_fn, const void *args, size_t args_size) override;
+    bool sink_in_place_(const details::log_msg &msg, fmt::format_args args, size_t &formatted_size) override;
+    // queue the lines as a single message
+    void sink_lines_(const details::log_msg &msg, string_view_t lines) override;
     void backend_sink_it_(const details::log_msg &incoming_log_msg);
-    void backend_flush_();
+    void backend_sink_deferred_(const details::async_msg &incoming_msg);
+    // sink the lines of a log_batch message as one batch
+    void backend_sink_lines_(const details::async_msg &incoming_msg);
+    // the processors may change the messages in place
+    void backend_sink_batch_(details::log_msg *msgs, size_t n_msgs);
+    // make message index of the batch ready to be written (see details::prepared_batch) out of the workers' turn:
+    // format its deferred payload and the texts of the sinks formatting ahead. false if it must be sunk as usual
+    // (processors, or a format error to report in turn).
+    bool backend_prepare_(const details::async_msg &incoming_msg, details::prepared_batch &batch, size_t index);
+    // write a message made ready by backend_prepare_()
+    void backend_sink_prepared_(const details::async_msg &incoming_msg, const details::prepared_batch &batch, size_t index);
+    // flushed: if given, the sinks in it are skipped and the ones flushed are added to it
+    void backend_flush_(std::vector<const sinks::sink *> *flushed = nullptr);
+    // log the number of messages discarded by the discard_new/block_for policies since the last report
+    void backend_report_discarded_(size_t n_msgs);
 
 private:
     // weak_ptr ：只使用对象，并不管理对象的生命周期，并且不会增加引用计数。使用之前需要先用 .lock 接口转换为 shared_ptr 智能指针
     // 线程池的生命周期是由 registry 来管理的
     std::weak_ptr<details::thread_pool> thread_pool_;
     async_overflow_policy overflow_policy_;
+    // attached to a thread pool with thread_pool_options::pin_loggers set
+    bool attached_ = false;
+    // the pool of an attached logger, kept alive until the logger is detached: the log calls post to it
+    // without locking thread_pool_ (no refcount update per message)
+    std::shared_ptr<details::thread_pool> pinned_pool_;
+    // thread pool shard selector
+    std::atomic<size_t> shard_hint_{0};
+    bool order_insensitive_ = false;
+    details::async_stats_counters stats_;
+    std::chrono::nanoseconds block_timeout_{std::chrono::microseconds(50)};
+    // messages discarded by the discard_new/block_for policies and not reported yet
+    std::atomic<size_t> discarded_{0};
+    std::vector<std::shared_ptr<processor>> processors_;
+
+    // attach to the thread pool if needed
+    void init_();
+    // run the batch through the processors, return the number of messages left
+    size_t process_(details::log_msg *msgs, size_t n_msgs);
+    // post() and abandon() of the flush batches of the async loggers
+    static std::future<void> post_flush_batch_(const details::flush_batch &batch, size_t threads);
+    static void abandon_flush_batch_(const details::flush_batch &batch);
 };
 } // namespace spdlog
 
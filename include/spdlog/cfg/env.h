@@ -22,6 +22,12 @@
 
 // turn off all logging except for logger1 and logger2:
 // export SPDLOG_LEVEL="off,logger1=debug,logger2=info"
+//
+// log 1 in 100 of the trace/debug messages of logger1 (see logger::set_sample_rate):
+// export SPDLOG_LEVEL="info,logger1=debug/100"
+//
+// set the level of "net" and of its descendants ("net.http", "net.http.client"..), unless they have their own:
+// export SPDLOG_LEVEL="info,net=debug,net.http.client=warn"
 
 namespace spdlog {
 namespace cfg {
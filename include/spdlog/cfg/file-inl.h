@@ -0,0 +1,175 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/cfg/file.h>
+#endif
+
+#include <spdlog/cfg/helpers.h>
+#include <spdlog/details/os.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+
+#ifndef _WIN32
+#    include <signal.h>
+#endif
+
+namespace spdlog {
+namespace cfg {
+namespace helpers {
+
+SPDLOG_INLINE std::string file_levels_string(const std::string &content)
+{
+    std::string levels;
+    size_t line_start = 0;
+    while (line_start < content.size())
+    {
+        auto line_end = content.find('\n', line_start);
+        if (line_end == std::string::npos)
+        {
+            line_end = content.size();
+        }
+        auto entries_end = std::min(content.find('#', line_start), line_end);
+        auto line = content.substr(line_start, entries_end - line_start);
+        auto first = line.find_first_not_of(" \t\r");
+        if (first != std::string::npos)
+        {
+            auto last = line.find_last_not_of(" \t\r");
+            if (!levels.empty())
+            {
+                levels += ',';
+            }
+            levels.append(line, first, last - first + 1);
+        }
+        line_start = line_end + 1;
+    }
+    return levels;
+}
+
+SPDLOG_INLINE bool read_levels_file(const filename_t &filename, std::string &content)
+{
+    std::FILE *fd;
+    if (details::os::fopen_s(&fd, filename, SPDLOG_FILENAME_T("rb")))
+    {
+        return false;
+    }
+    content.clear();
+    char buf[512];
+    size_t n;
+    while ((n = std::fread(buf, 1, sizeof(buf), fd)) > 0)
+    {
+        content.append(buf, n);
+    }
+    bool ok = std::ferror(fd) == 0;
+    std::fclose(fd);
+    return ok;
+}
+
+inline std::atomic<unsigned> &sighups_()
+{
+    static std::atomic<unsigned> sighups{0};
+    return sighups;
+}
+
+#ifndef _WIN32
+inline void on_sighup_(int)
+{
+    sighups_().fetch_add(1, std::memory_order_relaxed);
+}
+#endif
+
+SPDLOG_INLINE void watch_sighup()
+{
+#ifndef _WIN32
+    static std::once_flag installed;
+    std::call_once(installed, [] {
+        // constructed before the handler can run
+        (void)sighups_();
+        struct sigaction action;
+        std::memset(&action, 0, sizeof(action));
+        action.sa_handler = on_sighup_;
+        sigemptyset(&action.sa_mask);
+        action.sa_flags = SA_RESTART;
+        ::sigaction(SIGHUP, &action, nullptr);
+    });
+#endif
+}
+
+SPDLOG_INLINE unsigned sighup_count() SPDLOG_NOEXCEPT
+{
+    return sighups_().load(std::memory_order_relaxed);
+}
+
+} // namespace helpers
+
+SPDLOG_INLINE bool load_file_levels(const filename_t &filename)
+{
+    std::string content;
+    if (!helpers::read_levels_file(filename, content))
+    {
+        return false;
+    }
+    helpers::load_levels(helpers::file_levels_string(content));
+    return true;
+}
+
+SPDLOG_INLINE file_levels_watcher::file_levels_watcher(filename_t filename, std::chrono::nanoseconds interval, bool reload_on_sighup)
+    : filename_(std::move(filename))
+    , reload_on_sighup_(reload_on_sighup)
+{
+    if (reload_on_sighup_)
+    {
+        helpers::watch_sighup();
+        sighups_seen_ = helpers::sighup_count();
+    }
+    reload();
+    worker_ = details::make_unique<details::periodic_worker>(
+        [this] {
+            bool force = false;
+            if (reload_on_sighup_)
+            {
+                auto sighups = helpers::sighup_count();
+                force = sighups != sighups_seen_;
+                sighups_seen_ = sighups;
+            }
+            reload(force);
+        },
+        interval);
+}
+
+SPDLOG_INLINE file_levels_watcher::~file_levels_watcher() = default;
+
+SPDLOG_INLINE void file_levels_watcher::reload(bool force)
+{
+    std::string content;
+    if (!helpers::read_levels_file(filename_, content))
+    {
+        return; // keep the current levels (e.g. while the file is being replaced)
+    }
+    auto levels = helpers::file_levels_string(content);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (loaded_ && !force && levels == last_levels_)
+    {
+        return;
+    }
+    helpers::load_levels(levels);
+    last_levels_ = std::move(levels);
+    loaded_ = true;
+    reloads_++;
+}
+
+SPDLOG_INLINE size_t file_levels_watcher::reloads() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return reloads_;
+}
+
+} // namespace cfg
+} // namespace spdlog
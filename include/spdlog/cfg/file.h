@@ -0,0 +1,84 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <spdlog/common.h>
+#include <spdlog/details/periodic_worker.h>
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+
+//
+// Load the log levels from a file, and reload them while the program runs when the file changes
+// (or on SIGHUP), e.g. to turn on debug for a single component in production without a restart.
+//
+// The file takes the syntax of SPDLOG_LEVEL (see env.h), one or more entries per line, the text
+// after a '#' being ignored:
+//
+//   # levels.cfg
+//   info
+//   net=debug
+//   net.http.client=warn
+//
+//   spdlog::cfg::file_levels_watcher watcher("levels.cfg");
+//
+// The levels are applied by the registry (see registry::set_levels()), which only stores each
+// logger's atomic level: the log calls never wait for a reload. Removing an entry doesn't reset the
+// level it set, write the new level instead (e.g. "info").
+//
+
+namespace spdlog {
+namespace cfg {
+
+// load the levels of the file. returns false if the file can't be read.
+SPDLOG_API bool load_file_levels(const filename_t &filename);
+
+class SPDLOG_API file_levels_watcher
+{
+public:
+    // load the levels of the file, then reload them when its content changes, read every
+    // interval on the shared timer thread (see details/periodic_worker.h). with reload_on_sighup,
+    // SIGHUP triggers a reload at the next interval even if the content is unchanged (posix only).
+    explicit file_levels_watcher(
+        filename_t filename, std::chrono::nanoseconds interval = std::chrono::seconds(1), bool reload_on_sighup = false);
+    file_levels_watcher(const file_levels_watcher &) = delete;
+    file_levels_watcher &operator=(const file_levels_watcher &) = delete;
+    ~file_levels_watcher();
+
+    // reload the levels now if the content of the file changed, or if force
+    void reload(bool force = false);
+
+    // the number of times the levels were loaded
+    size_t reloads() const;
+
+private:
+    filename_t filename_;
+    bool reload_on_sighup_;
+    mutable std::mutex mutex_;
+    std::string last_levels_;
+    bool loaded_ = false;
+    size_t reloads_ = 0;
+    unsigned sighups_seen_ = 0;
+    // last, so that the timer is cancelled first on destruction
+    std::unique_ptr<details::periodic_worker> worker_;
+};
+
+namespace helpers {
+// the levels of the file content, as a single SPDLOG_LEVEL string ("info,net=debug")
+SPDLOG_API std::string file_levels_string(const std::string &content);
+// read the file (false if it can't be read)
+SPDLOG_API bool read_levels_file(const filename_t &filename, std::string &content);
+// count the SIGHUPs received from now on (installs a handler once, that only increments the count)
+SPDLOG_API void watch_sighup();
+SPDLOG_API unsigned sighup_count() SPDLOG_NOEXCEPT;
+} // namespace helpers
+
+} // namespace cfg
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "file-inl.h"
+#endif
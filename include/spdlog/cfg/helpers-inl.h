@@ -91,6 +91,18 @@ inline std::unordered_map<std::string, std::string> extract_key_vals_(const std:
     return rv;
 }
 
+// "100" => 100. 1 (no sampling) if not a positive number
+inline uint32_t parse_sample_rate_(std::string str)
+{
+    trim_(str);
+    if (str.empty() || str.size() > 9 || str.find_first_not_of("0123456789") != std::string::npos)
+    {
+        return 1;
+    }
+    auto rate = static_cast<uint32_t>(std::stoul(str));
+    return rate == 0 ? 1 : rate;
+}
+
 SPDLOG_INLINE void load_levels(const std::string &input)
 {
     if (input.empty() || input.size() > 512)
@@ -100,13 +112,24 @@ SPDLOG_INLINE void load_levels(const std::string &input)
 
     auto key_vals = extract_key_vals_(input);
     std::unordered_map<std::string, level::level_enum> levels;
+    std::unordered_map<std::string, uint32_t> sample_rates;
     level::level_enum global_level = level::info;
+    uint32_t global_sample_rate = 1;
     bool global_level_found = false;
 
     for (auto &name_level : key_vals)
     {
         auto &logger_name = name_level.first;
         auto level_name = to_lower_(name_level.second);
+        // "debug/100": keep 1 in 100 trace/debug messages
+        uint32_t sample_rate = 1;
+        auto rate_pos = level_name.find('/');
+        if (rate_pos != std::string::npos)
+        {
+            sample_rate = parse_sample_rate_(level_name.substr(rate_pos + 1));
+            level_name.erase(rate_pos);
+            trim_(level_name);
+        }
         auto level = level::from_str(level_name);
         // ignore unrecognized level names
         if (level == level::off && level_name != "off")
@@ -117,14 +140,17 @@ SPDLOG_INLINE void load_levels(const std::string &input)
         {
             global_level_found = true;
             global_level = level;
+            global_sample_rate = sample_rate;
         }
         else
         {
             levels[logger_name] = level;
+            sample_rates[logger_name] = sample_rate;
         }
     }
 
     details::registry::instance().set_levels(std::move(levels), global_level_found ? &global_level : nullptr);
+    details::registry::instance().set_sample_rates(std::move(sample_rates), global_level_found ? &global_sample_rate : nullptr);
 }
 
 } // namespace helpers
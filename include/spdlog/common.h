@@ -8,6 +8,7 @@
 
 #include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <initializer_list>
 #include <memory>
 #include <exception>
@@ -45,6 +46,10 @@
 #    define SPDLOG_FMT_RUNTIME(format_string) format_string
 #endif
 
+#ifdef SPDLOG_FMT_COMPILE
+#    include <spdlog/fmt/compile.h>
+#endif
+
 // visual studio upto 2013 does not support noexcept nor constexpr
 #if defined(_MSC_VER) && (_MSC_VER < 1900)
 #    define SPDLOG_NOEXCEPT _NOEXCEPT
@@ -73,6 +78,30 @@
 #    define SPDLOG_FUNCTION static_cast<const char *>(__FUNCTION__)
 #endif
 
+// folder separator
+#if !defined(SPDLOG_FOLDER_SEPS)
+#    ifdef _WIN32
+#        define SPDLOG_FOLDER_SEPS "\\/"
+#    else
+#        define SPDLOG_FOLDER_SEPS "/"
+#    endif
+#endif
+
+// the source_loc of the calling line, with the length of __FILE__ and the offset of its basename
+// computed at compile time (the formatters then need no strlen / strrchr)
+#if defined(_MSC_VER) && (_MSC_VER < 1900)
+#    define SPDLOG_SOURCE_LOC spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION}
+#else
+#    define SPDLOG_SOURCE_LOC                                                                                                              \
+        spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION, sizeof(__FILE__) - 1,                                                      \
+            std::integral_constant<size_t, spdlog::details::basename_offset(__FILE__, 0, sizeof(__FILE__) - 1)>::value}
+#endif
+
+// size used to keep frequently written atomics on separate cache lines
+#ifndef SPDLOG_CACHE_LINE_SIZE
+#    define SPDLOG_CACHE_LINE_SIZE 64
+#endif
+
 #ifdef SPDLOG_NO_EXCEPTIONS
 #    define SPDLOG_TRY
 #    define SPDLOG_THROW(ex)                                                                                                               \
@@ -127,15 +156,21 @@ struct is_convertible_to_basic_format_string
           std::is_convertible<T, fmt::basic_string_view<Char>>::value || std::is_same<remove_cvref_t<T>, fmt::basic_runtime<Char>>::value>
 {};
 
-#ifdef SPDLOG_WCHAR_TO_UTF8_SUPPORT
-#    ifndef _WIN32
-#        error SPDLOG_WCHAR_TO_UTF8_SUPPORT only supported on windows
-#    endif // _WIN32
-#endif     // SPDLOG_WCHAR_TO_UTF8_SUPPORT
+#ifdef SPDLOG_FMT_COMPILE
+// FMT_COMPILE("..") (see logger::log_compiled_())
+template<class T>
+struct is_compiled_format_string : fmt::detail::is_compiled_string<remove_cvref_t<T>>
+{};
+#else
+template<class T>
+struct is_compiled_format_string : std::false_type
+{};
+#endif
 
 template<class T>
-struct is_convertible_to_any_format_string : std::integral_constant<bool, is_convertible_to_basic_format_string<T, char>::value ||
-                                                                              is_convertible_to_basic_format_string<T, wchar_t>::value>
+struct is_convertible_to_any_format_string
+    : std::integral_constant<bool, is_convertible_to_basic_format_string<T, char>::value ||
+                                       is_convertible_to_basic_format_string<T, wchar_t>::value || is_compiled_format_string<T>::value>
 {};
 
 #if defined(SPDLOG_NO_ATOMIC_LEVELS)
@@ -156,9 +191,9 @@ using level_t = std::atomic<int>;
 #    define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_INFO
 #endif
 
-// Log level enum
+// Log level enum (the underlying type is fixed so that spdlog/fwd.h can declare it)
 namespace level {
-enum level_enum
+enum level_enum : int
 {
     trace = SPDLOG_LEVEL_TRACE,
     debug = SPDLOG_LEVEL_DEBUG,
@@ -210,6 +245,16 @@ enum class color_mode
     never
 };
 
+//
+// Output buffering of the console sinks (see set_buffering()).
+//
+enum class console_buffering
+{
+    line,      // write and flush each message
+    automatic, // buffer when not writing to a terminal (e.g. a pipe read by a log agent)
+    always
+};
+
 //
 // Pattern time - specific time getting to use for pattern_formatter.
 // local time by default
@@ -246,16 +291,183 @@ struct source_loc
         , funcname{funcname_in}
     {}
 
+    // filename_size_in is the length of filename and basename_offset_in that of its basename (see SPDLOG_SOURCE_LOC).
+    // Left unknown (0) if too long for the fields.
+    SPDLOG_CONSTEXPR source_loc(
+        const char *filename_in, int line_in, const char *funcname_in, size_t filename_size_in, size_t basename_offset_in)
+        : filename{filename_in}
+        , line{line_in}
+        , filename_size{static_cast<uint16_t>(filename_size_in <= 0xffff ? filename_size_in : 0)}
+        , basename_offset{static_cast<uint16_t>(filename_size_in <= 0xffff ? basename_offset_in : 0)}
+        , funcname{funcname_in}
+    {}
+
     SPDLOG_CONSTEXPR bool empty() const SPDLOG_NOEXCEPT
     {
         return line == 0;
     }
+
+    string_view_t filename_view() const
+    {
+        return filename_size != 0 ? string_view_t(filename, filename_size) : string_view_t(filename);
+    }
+
     const char *filename{nullptr};
     int line{0};
+    // if not 0, the length of filename and the offset of its basename in it
+    uint16_t filename_size{0};
+    uint16_t basename_offset{0};
     const char *funcname{nullptr};
 };
 
+// W3C trace context ids (trace id and span id) of a log message, captured from the logging
+// thread (see spdlog::set_trace_context). All zero if none.
+struct trace_context
+{
+    uint8_t trace_id[16];
+    uint8_t span_id[8];
+
+    bool empty() const SPDLOG_NOEXCEPT
+    {
+        uint8_t bits = 0;
+        for (auto b : trace_id)
+        {
+            bits |= b;
+        }
+        for (auto b : span_id)
+        {
+            bits |= b;
+        }
+        return bits == 0;
+    }
+};
+
+// typed key/value of a structured log message, e.g.
+// logger->info("order filled", spdlog::kv("id", id), spdlog::kv("px", px));
+// the key and string values are not copied, they must stay valid during the log call.
+struct field
+{
+    enum class value_type
+    {
+        string,
+        signed_int,
+        unsigned_int,
+        floating,
+        boolean
+    };
+
+    field()
+        : int_value(0)
+    {}
+
+    field(string_view_t key_in, string_view_t value)
+        : key(key_in)
+        , type(value_type::string)
+        , string_value(value)
+        , int_value(0)
+    {}
+
+    field(string_view_t key_in, const char *value)
+        : field(key_in, string_view_t(value))
+    {}
+
+    field(string_view_t key_in, bool value)
+        : key(key_in)
+        , type(value_type::boolean)
+        , bool_value(value)
+    {}
+
+    template<typename T, typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value, int>::type = 0>
+    field(string_view_t key_in, T value)
+        : key(key_in)
+        , type(value_type::signed_int)
+        , int_value(static_cast<long long>(value))
+    {}
+
+    template<typename T,
+        typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value && !std::is_same<T, bool>::value, int>::type = 0>
+    field(string_view_t key_in, T value)
+        : key(key_in)
+        , type(value_type::unsigned_int)
+        , uint_value(static_cast<unsigned long long>(value))
+    {}
+
+    template<typename T, typename std::enable_if<std::is_floating_point<T>::value, int>::type = 0>
+    field(string_view_t key_in, T value)
+        : key(key_in)
+        , type(value_type::floating)
+        , double_value(static_cast<double>(value))
+    {}
+
+    string_view_t key;
+    value_type type{value_type::string};
+    string_view_t string_value; // set for value_type::string only
+    union
+    {
+        long long int_value;
+        unsigned long long uint_value;
+        double double_value;
+        bool bool_value;
+    };
+};
+
+template<typename T>
+inline field kv(string_view_t key, const T &value)
+{
+    return field(key, value);
+}
+
+// when a logger flushes its sinks (see logger::set_flush_policy()).
+// the flushes not done inline are done by the shared timer thread (see details/timer_wheel.h).
+struct flush_policy
+{
+    // flush after each message at or above this level (as logger::flush_on())
+    level::level_enum level{level::off};
+    // if > 0, coalesce the flushes by level: at most one per min_interval, the others are deferred to its end
+    std::chrono::milliseconds min_interval{0};
+    // if > 0, flush once the payloads logged since the last flush exceed max_pending_bytes
+    size_t max_pending_bytes{0};
+    // if > 0, flush the pending messages once nothing was logged during idle (checked every idle)
+    std::chrono::milliseconds idle{0};
+};
+
 namespace details {
+// true if all of the given types are fields (and there is at least one)
+template<typename... Ts>
+struct are_fields : std::false_type
+{};
+
+template<typename T>
+struct are_fields<T> : std::is_same<typename std::decay<T>::type, field>
+{};
+
+template<typename T, typename... Ts>
+struct are_fields<T, Ts...> : std::integral_constant<bool, are_fields<T>::value && are_fields<Ts...>::value>
+{};
+
+SPDLOG_CONSTEXPR inline bool is_folder_sep(char c, const char *seps)
+{
+    return *seps != '\0' && (c == *seps || is_folder_sep(c, seps + 1));
+}
+
+SPDLOG_CONSTEXPR inline size_t basename_offset(const char *path, size_t begin, size_t end);
+
+SPDLOG_CONSTEXPR inline size_t basename_offset_(const char *path, size_t begin, size_t mid, size_t right_offset)
+{
+    return right_offset != mid ? right_offset : basename_offset(path, begin, mid);
+}
+
+// the offset of the basename of path[begin, end) - past its last folder separator, or begin if none.
+// Usable in constant expressions: halves the range at each step, so the recursion depth (limited by
+// the compilers) is logarithmic in the length of the path.
+SPDLOG_CONSTEXPR inline size_t basename_offset(const char *path, size_t begin, size_t end)
+{
+    return end - begin == 0   ? begin
+           : end - begin == 1 ? (is_folder_sep(path[begin], SPDLOG_FOLDER_SEPS) ? end : begin)
+                              : basename_offset_(path, begin, begin + (end - begin) / 2,
+                                    basename_offset(path, begin + (end - begin) / 2, end));
+}
+
 // make_unique support for pre c++14
 
 #if __cplusplus >= 201402L // C++14 and beyond
@@ -0,0 +1,133 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/crash_dump.h>
+#endif
+
+#include <spdlog/details/crash_dump.h>
+
+#include <array>
+#include <atomic>
+#include <csignal>
+#include <cstring>
+#include <mutex>
+
+namespace spdlog {
+namespace details {
+namespace crash_dump_helpers {
+
+SPDLOG_CONSTEXPR size_t max_signal = 65;
+
+struct handler_state
+{
+    std::mutex mutex; // enable and disable
+    std::atomic<int> fd{-1};
+    std::atomic<bool> dumping{false};
+    std::array<bool, max_signal> installed{};
+#ifdef _WIN32
+    std::array<void (*)(int), max_signal> previous{};
+#else
+    std::array<struct sigaction, max_signal> previous{};
+#endif
+};
+
+inline handler_state &state()
+{
+    static handler_state instance;
+    return instance;
+}
+
+inline void restore(handler_state &s, int sig)
+{
+#ifdef _WIN32
+    std::signal(sig, s.previous[static_cast<size_t>(sig)]);
+#else
+    ::sigaction(sig, &s.previous[static_cast<size_t>(sig)], nullptr);
+#endif
+}
+
+// dump once, then let the previous handler (or the default action) deal with the signal
+inline void on_signal(int sig)
+{
+    auto &s = state();
+    if (!s.dumping.exchange(true))
+    {
+        auto fd = s.fd.load();
+        if (fd >= 0)
+        {
+            write_crash_dump(fd);
+        }
+    }
+    restore(s, sig);
+    std::raise(sig);
+}
+
+} // namespace crash_dump_helpers
+} // namespace details
+
+SPDLOG_INLINE void enable_crash_dump(int fd)
+{
+#ifdef _WIN32
+    enable_crash_dump(fd, {SIGSEGV, SIGABRT, SIGFPE, SIGILL});
+#else
+    enable_crash_dump(fd, {SIGSEGV, SIGABRT, SIGBUS, SIGFPE, SIGILL});
+#endif
+}
+
+SPDLOG_INLINE void enable_crash_dump(int fd, const std::vector<int> &signals)
+{
+    using namespace details::crash_dump_helpers;
+    // the handler reads them: initialized before
+    details::crash_dump_sources::instance();
+    auto &s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.fd.store(fd);
+    s.dumping.store(false);
+    for (auto sig : signals)
+    {
+        if (sig <= 0 || static_cast<size_t>(sig) >= max_signal || s.installed[static_cast<size_t>(sig)])
+        {
+            continue;
+        }
+        auto index = static_cast<size_t>(sig);
+#ifdef _WIN32
+        s.previous[index] = std::signal(sig, on_signal);
+#else
+        struct sigaction action;
+        std::memset(&action, 0, sizeof(action));
+        action.sa_handler = on_signal;
+        sigemptyset(&action.sa_mask);
+        action.sa_flags = SA_ONSTACK;
+        ::sigaction(sig, &action, &s.previous[index]);
+#endif
+        s.installed[index] = true;
+    }
+}
+
+SPDLOG_INLINE void disable_crash_dump()
+{
+    using namespace details::crash_dump_helpers;
+    auto &s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    for (size_t sig = 0; sig < max_signal; sig++)
+    {
+        if (s.installed[sig])
+        {
+            restore(s, static_cast<int>(sig));
+            s.installed[sig] = false;
+        }
+    }
+    s.fd.store(-1);
+}
+
+SPDLOG_INLINE void write_crash_dump(int fd) SPDLOG_NOEXCEPT
+{
+    details::crash_writer writer(fd);
+    writer.write("spdlog crash dump\n");
+    details::crash_dump_sources::instance().dump(writer);
+}
+
+} // namespace spdlog
@@ -0,0 +1,39 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Emergency dump of the messages not logged yet when the process crashes: the messages still
+// queued in the thread pools with the lock free queue backend, and the backtraces of the loggers
+// (see logger::enable_backtrace), written unformatted to a preopened file descriptor:
+//
+//   int fd = ::open("crash.log", O_WRONLY | O_CREAT | O_APPEND, 0644);
+//   spdlog::enable_crash_dump(fd);  // on SIGSEGV, SIGABRT, SIGBUS, SIGFPE or SIGILL
+//
+// The signal handler calls only async-signal-safe functions: it reads the queues and the
+// backtraces without locks or allocations, writes them with write(2), then restores the previous
+// handler of the signal and raises it again. It's a best effort - the messages being written by
+// other threads meanwhile may be skipped. The other queue backends need a lock to be read (or
+// decoding) and are not dumped, nor are the buffers of the sinks.
+
+#include <spdlog/common.h>
+
+#include <vector>
+
+namespace spdlog {
+
+// install the crash handler of SIGSEGV, SIGABRT, SIGBUS (not on windows), SIGFPE and SIGILL
+SPDLOG_API void enable_crash_dump(int fd);
+SPDLOG_API void enable_crash_dump(int fd, const std::vector<int> &signals);
+
+// restore the previous handlers
+SPDLOG_API void disable_crash_dump();
+
+// write the dump now, calling only async-signal-safe functions (e.g. from a handler of your own)
+SPDLOG_API void write_crash_dump(int fd) SPDLOG_NOEXCEPT;
+
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "crash_dump-inl.h"
+#endif
@@ -0,0 +1,153 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/details/append_file.h>
+#endif
+
+#include <spdlog/details/os.h>
+
+#include <cerrno>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace spdlog {
+namespace details {
+
+SPDLOG_INLINE append_file::~append_file()
+{
+    close();
+    if (lock_fd_ != -1)
+    {
+        ::close(lock_fd_);
+    }
+}
+
+SPDLOG_INLINE void append_file::open(const filename_t &fname, bool truncate)
+{
+    close();
+    if (lock_fd_ != -1 && fname != filename_)
+    {
+        ::close(lock_fd_);
+        lock_fd_ = -1;
+    }
+    filename_ = fname;
+    os::create_dir(os::dir_name(fname));
+    int flags = O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC;
+    if (truncate)
+    {
+        flags |= O_TRUNC;
+    }
+    fd_ = ::open(fname.c_str(), flags, 0644);
+    if (fd_ == -1)
+    {
+        throw_error_("Failed opening file ", errno);
+    }
+}
+
+SPDLOG_INLINE void append_file::reopen()
+{
+    if (filename_.empty())
+    {
+        throw_spdlog_ex("Failed re opening file - was not opened before");
+    }
+    this->open(filename_, false);
+}
+
+SPDLOG_INLINE void append_file::close()
+{
+    if (fd_ != -1)
+    {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+SPDLOG_INLINE void append_file::write(string_view_t data)
+{
+    auto *p = data.data();
+    auto left = data.size();
+    while (left > 0)
+    {
+        auto n = ::write(fd_, p, left);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            throw_error_("Failed writing to file ", errno);
+        }
+        p += n;
+        left -= static_cast<size_t>(n);
+    }
+}
+
+SPDLOG_INLINE size_t append_file::size() const
+{
+    struct stat st;
+    if (fd_ == -1 || ::fstat(fd_, &st) != 0)
+    {
+        throw_spdlog_ex("Failed getting the size of file " + os::filename_to_str(filename_), errno);
+    }
+    return static_cast<size_t>(st.st_size);
+}
+
+SPDLOG_INLINE bool append_file::replaced() const
+{
+    struct stat open_st;
+    struct stat path_st;
+    if (fd_ == -1 || ::fstat(fd_, &open_st) != 0)
+    {
+        return true;
+    }
+    if (::stat(filename_.c_str(), &path_st) != 0)
+    {
+        return true; // removed
+    }
+    return open_st.st_ino != path_st.st_ino || open_st.st_dev != path_st.st_dev;
+}
+
+SPDLOG_INLINE const filename_t &append_file::filename() const
+{
+    return filename_;
+}
+
+SPDLOG_INLINE void append_file::lock()
+{
+    if (lock_fd_ == -1)
+    {
+        auto lock_filename = filename_ + ".lock";
+        lock_fd_ = ::open(lock_filename.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (lock_fd_ == -1)
+        {
+            throw_spdlog_ex("Failed opening lock file " + os::filename_to_str(lock_filename), errno);
+        }
+    }
+    while (::flock(lock_fd_, LOCK_EX) != 0)
+    {
+        if (errno != EINTR)
+        {
+            throw_error_("Failed locking file ", errno);
+        }
+    }
+}
+
+SPDLOG_INLINE void append_file::unlock()
+{
+    (void)::flock(lock_fd_, LOCK_UN);
+}
+
+SPDLOG_INLINE void append_file::throw_error_(const std::string &what, int last_errno)
+{
+    throw_spdlog_ex(what + os::filename_to_str(filename_), last_errno);
+}
+
+} // namespace details
+} // namespace spdlog
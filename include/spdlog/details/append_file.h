@@ -0,0 +1,59 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// File shared by several processes (posix): opened with O_APPEND, and each write is a single write(2),
+// so the kernel appends it at once at the end of the file - the records of the processes don't interleave.
+//
+// The processes coordinate the changes of the file (rotation) by an exclusive advisory lock (flock) of
+// "<filename>.lock", and find out that another one replaced the file by comparing the inode at the
+// path with the open one (replaced()).
+//
+// Throw spdlog_ex exception on errors.
+// Not thread safe - the sinks serialize the access to it.
+
+#include <spdlog/common.h>
+
+namespace spdlog {
+namespace details {
+
+class SPDLOG_API append_file
+{
+public:
+    append_file() = default;
+    append_file(const append_file &) = delete;
+    append_file &operator=(const append_file &) = delete;
+    ~append_file();
+
+    void open(const filename_t &fname, bool truncate = false);
+    // open the file at the path again (e.g. replaced by another process)
+    void reopen();
+    void close();
+    // append data with one write(2) - only interrupted writes are split
+    void write(string_view_t data);
+
+    // the size of the open file, with the writes of all the processes
+    size_t size() const;
+    // true if the open file is not the one at the path anymore (renamed or removed)
+    bool replaced() const;
+    const filename_t &filename() const;
+
+    // lock()/unlock() the lock file, across the processes (BasicLockable)
+    void lock();
+    void unlock();
+
+private:
+    filename_t filename_;
+    int fd_{-1};
+    int lock_fd_{-1};
+
+    [[noreturn]] void throw_error_(const std::string &what, int last_errno);
+};
+
+} // namespace details
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "append_file-inl.h"
+#endif
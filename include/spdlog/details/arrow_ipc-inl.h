@@ -0,0 +1,525 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/details/arrow_ipc.h>
+#endif
+
+#include <spdlog/common.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <string>
+
+namespace spdlog {
+namespace details {
+namespace arrow_ipc {
+
+// the flatbuffers schema of the metadata (Schema.fbs, Message.fbs, File.fbs of the arrow format)
+namespace fbs {
+static const int16_t metadata_version_v5 = 4;
+// MessageHeader union
+static const uint8_t header_schema = 1;
+static const uint8_t header_dictionary_batch = 2;
+static const uint8_t header_record_batch = 3;
+// Type union
+static const uint8_t type_int = 2;
+static const uint8_t type_utf8 = 5;
+static const uint8_t type_timestamp = 10;
+static const int16_t time_unit_nanosecond = 3;
+
+static const int64_t level_dictionary_id = 0;
+static const int64_t logger_dictionary_id = 1;
+} // namespace fbs
+
+inline bool is_little_endian()
+{
+    const uint16_t one = 1;
+    char first;
+    std::memcpy(&first, &one, 1);
+    return first == 1;
+}
+
+//
+// log_columns
+//
+SPDLOG_INLINE size_t log_columns::bytes() const
+{
+    return size() * (sizeof(int64_t) + sizeof(int8_t) + sizeof(int32_t) + sizeof(uint64_t) + sizeof(int32_t)) + message_data.size();
+}
+
+SPDLOG_INLINE void log_columns::append(const log_msg &msg, int32_t logger_index)
+{
+    time.push_back(static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(msg.time.time_since_epoch()).count()));
+    level.push_back(static_cast<int8_t>(msg.level));
+    logger.push_back(logger_index);
+    thread.push_back(static_cast<uint64_t>(msg.thread_id));
+    message_data.append(msg.payload.data(), msg.payload.size());
+    message_offsets.push_back(static_cast<int32_t>(message_data.size()));
+}
+
+SPDLOG_INLINE void log_columns::clear()
+{
+    time.clear();
+    level.clear();
+    logger.clear();
+    thread.clear();
+    message_offsets.resize(1);
+    message_data.clear();
+}
+
+//
+// flatbuffer_builder
+//
+SPDLOG_INLINE uint32_t flatbuffer_builder::size() const
+{
+    return static_cast<uint32_t>(reversed_.size());
+}
+
+SPDLOG_INLINE uint32_t flatbuffer_builder::create_string(string_view_t value)
+{
+    prealign_(value.size() + 1, 4);
+    reversed_.push_back('\0');
+    push_bytes_(value.data(), value.size());
+    push_(value.size(), 4);
+    return size();
+}
+
+SPDLOG_INLINE uint32_t flatbuffer_builder::create_struct_vector(const std::string &bytes, size_t count)
+{
+    prealign_(bytes.size(), 8);
+    push_bytes_(bytes.data(), bytes.size());
+    push_(count, 4);
+    return size();
+}
+
+SPDLOG_INLINE uint32_t flatbuffer_builder::create_offset_vector(const std::vector<uint32_t> &objects)
+{
+    prealign_(objects.size() * 4, 4);
+    for (auto it = objects.rbegin(); it != objects.rend(); ++it)
+    {
+        push_offset_(*it);
+    }
+    push_(objects.size(), 4);
+    return size();
+}
+
+SPDLOG_INLINE void flatbuffer_builder::start_table()
+{
+    fields_.clear();
+    table_start_ = size();
+}
+
+SPDLOG_INLINE void flatbuffer_builder::add_int8(uint16_t id, int8_t value)
+{
+    push_(static_cast<uint8_t>(value), 1);
+    add_field_(id);
+}
+
+SPDLOG_INLINE void flatbuffer_builder::add_int16(uint16_t id, int16_t value)
+{
+    push_(static_cast<uint16_t>(value), 2);
+    add_field_(id);
+}
+
+SPDLOG_INLINE void flatbuffer_builder::add_int32(uint16_t id, int32_t value)
+{
+    push_(static_cast<uint32_t>(value), 4);
+    add_field_(id);
+}
+
+SPDLOG_INLINE void flatbuffer_builder::add_int64(uint16_t id, int64_t value)
+{
+    push_(static_cast<uint64_t>(value), 8);
+    add_field_(id);
+}
+
+SPDLOG_INLINE void flatbuffer_builder::add_offset(uint16_t id, uint32_t object)
+{
+    push_offset_(object);
+    add_field_(id);
+}
+
+// the table is preceded by its vtable: vtable size, table size, then the offset of each field in the table (0 if absent).
+// the table starts with the (signed) distance to its vtable.
+SPDLOG_INLINE uint32_t flatbuffer_builder::end_table()
+{
+    push_(0, 4);
+    auto table = size();
+    size_t n_slots = 0;
+    for (auto &field : fields_)
+    {
+        n_slots = (std::max)(n_slots, static_cast<size_t>(field.id) + 1);
+    }
+    std::vector<uint16_t> slots(n_slots, 0);
+    for (auto &field : fields_)
+    {
+        slots[field.id] = static_cast<uint16_t>(table - field.position);
+    }
+    for (auto it = slots.rbegin(); it != slots.rend(); ++it)
+    {
+        push_(*it, 2);
+    }
+    push_(table - table_start_, 2);
+    push_(4 + 2 * n_slots, 2);
+    auto vtable_distance = size() - table;
+    for (size_t i = 0; i < 4; i++)
+    {
+        reversed_[table - 1 - i] = static_cast<char>(vtable_distance >> (8 * i));
+    }
+    fields_.clear();
+    return table;
+}
+
+SPDLOG_INLINE void flatbuffer_builder::finish(uint32_t root, memory_buf_t &dest)
+{
+    prealign_(4, 8);
+    push_offset_(root);
+    for (auto it = reversed_.rbegin(); it != reversed_.rend(); ++it)
+    {
+        dest.push_back(*it);
+    }
+    reversed_.clear();
+}
+
+SPDLOG_INLINE void flatbuffer_builder::pad_(size_t n)
+{
+    reversed_.append(n, '\0');
+}
+
+SPDLOG_INLINE void flatbuffer_builder::prealign_(size_t len, size_t alignment)
+{
+    pad_((alignment - (size() + len) % alignment) % alignment);
+}
+
+// little endian
+SPDLOG_INLINE void flatbuffer_builder::push_(uint64_t value, size_t size)
+{
+    prealign_(size, size);
+    for (size_t i = size; i-- > 0;)
+    {
+        reversed_.push_back(static_cast<char>(value >> (8 * i)));
+    }
+}
+
+SPDLOG_INLINE void flatbuffer_builder::push_bytes_(const char *data, size_t size)
+{
+    for (size_t i = size; i-- > 0;)
+    {
+        reversed_.push_back(data[i]);
+    }
+}
+
+// an offset is the distance from its position to the object, which is further in the buffer
+SPDLOG_INLINE void flatbuffer_builder::push_offset_(uint32_t object)
+{
+    prealign_(4, 4);
+    push_(size() + 4 - object, 4);
+}
+
+SPDLOG_INLINE void flatbuffer_builder::add_field_(uint16_t id)
+{
+    fields_.push_back(field_slot{id, size()});
+}
+
+//
+// file_writer
+//
+SPDLOG_INLINE void file_writer::open(const filename_t &filename)
+{
+    file_.open(filename, true);
+    open_ = true;
+    size_ = 0;
+    dictionaries_.clear();
+    record_batches_.clear();
+    const char header[8] = {magic[0], magic[1], magic[2], magic[3], magic[4], magic[5], 0, 0};
+    write_(string_view_t(header, sizeof(header)));
+
+    flatbuffer_builder builder;
+    auto schema = add_schema_(builder);
+    body_.clear();
+    write_message_(builder, fbs::header_schema, schema);
+}
+
+SPDLOG_INLINE void file_writer::write_batch(const log_columns &columns)
+{
+    auto n = columns.size();
+    if (n == 0)
+    {
+        return;
+    }
+    body_.clear();
+    nodes_.clear();
+    buffers_.clear();
+    // no validity bitmaps (no nulls): empty buffers
+    add_node_(static_cast<int64_t>(n));
+    add_buffer_(nullptr, 0);
+    add_buffer_(columns.time.data(), n * sizeof(int64_t));
+    add_node_(static_cast<int64_t>(n));
+    add_buffer_(nullptr, 0);
+    add_buffer_(columns.level.data(), n * sizeof(int8_t));
+    add_node_(static_cast<int64_t>(n));
+    add_buffer_(nullptr, 0);
+    add_buffer_(columns.logger.data(), n * sizeof(int32_t));
+    add_node_(static_cast<int64_t>(n));
+    add_buffer_(nullptr, 0);
+    add_buffer_(columns.thread.data(), n * sizeof(uint64_t));
+    add_node_(static_cast<int64_t>(n));
+    add_buffer_(nullptr, 0);
+    add_buffer_(columns.message_offsets.data(), (n + 1) * sizeof(int32_t));
+    add_buffer_(columns.message_data.data(), columns.message_data.size());
+
+    flatbuffer_builder builder;
+    auto record_batch = add_record_batch_(builder, static_cast<int64_t>(n));
+    record_batches_.push_back(write_message_(builder, fbs::header_record_batch, record_batch));
+}
+
+SPDLOG_INLINE void file_writer::close(const std::vector<std::string> &logger_names)
+{
+    if (!open_)
+    {
+        return;
+    }
+    std::vector<string_view_t> values;
+    for (int level = 0; level < level::n_levels; level++)
+    {
+        values.push_back(level::to_string_view(static_cast<level::level_enum>(level)));
+    }
+    write_dictionary_(fbs::level_dictionary_id, values);
+    values.clear();
+    for (auto &name : logger_names)
+    {
+        values.emplace_back(name);
+    }
+    write_dictionary_(fbs::logger_dictionary_id, values);
+
+    // end of stream
+    const char eos[8] = {'\xff', '\xff', '\xff', '\xff', 0, 0, 0, 0};
+    write_(string_view_t(eos, sizeof(eos)));
+
+    // Footer: version (0), schema (1), dictionaries (2), recordBatches (3)
+    // Block: offset (int64), metaDataLength (int32, padded to 8), bodyLength (int64)
+    auto blocks_bytes = [](const std::vector<block> &blocks) {
+        std::string bytes;
+        for (auto &b : blocks)
+        {
+            const int64_t fields[3] = {b.offset, b.metadata_length, b.body_length};
+            for (auto field : fields)
+            {
+                for (size_t i = 0; i < 8; i++)
+                {
+                    bytes.push_back(static_cast<char>(static_cast<uint64_t>(field) >> (8 * i)));
+                }
+            }
+        }
+        return bytes;
+    };
+    flatbuffer_builder builder;
+    auto schema = add_schema_(builder);
+    auto dictionaries = builder.create_struct_vector(blocks_bytes(dictionaries_), dictionaries_.size());
+    auto record_batches = builder.create_struct_vector(blocks_bytes(record_batches_), record_batches_.size());
+    builder.start_table();
+    builder.add_offset(3, record_batches);
+    builder.add_offset(2, dictionaries);
+    builder.add_offset(1, schema);
+    builder.add_int16(0, fbs::metadata_version_v5);
+    auto footer = builder.end_table();
+    metadata_.clear();
+    builder.finish(footer, metadata_);
+    write_(string_view_t(metadata_.data(), metadata_.size()));
+    const auto footer_size = static_cast<uint32_t>(metadata_.size());
+    const char trailer[10] = {static_cast<char>(footer_size), static_cast<char>(footer_size >> 8), static_cast<char>(footer_size >> 16),
+        static_cast<char>(footer_size >> 24), magic[0], magic[1], magic[2], magic[3], magic[4], magic[5]};
+    write_(string_view_t(trailer, sizeof(trailer)));
+    file_.close();
+    open_ = false;
+}
+
+SPDLOG_INLINE void file_writer::flush()
+{
+    if (open_)
+    {
+        file_.flush();
+    }
+}
+
+SPDLOG_INLINE bool file_writer::is_open() const
+{
+    return open_;
+}
+
+SPDLOG_INLINE size_t file_writer::size() const
+{
+    return size_;
+}
+
+SPDLOG_INLINE const filename_t &file_writer::filename() const
+{
+    return file_.filename();
+}
+
+SPDLOG_INLINE void file_writer::write_(string_view_t data)
+{
+    file_.write(data);
+    size_ += data.size();
+}
+
+// Schema: endianness (0), fields (1)
+// Field: name (0), nullable (1), type_type (2), type (3), dictionary (4), children (5)
+SPDLOG_INLINE uint32_t file_writer::add_schema_(flatbuffer_builder &builder)
+{
+    auto int_type = [&builder](int32_t bit_width, bool is_signed) {
+        builder.start_table();
+        builder.add_int32(0, bit_width);
+        builder.add_int8(1, is_signed ? 1 : 0);
+        return builder.end_table();
+    };
+    auto utf8_type = [&builder] {
+        builder.start_table();
+        return builder.end_table();
+    };
+    // DictionaryEncoding: id (0), indexType (1), isOrdered (2)
+    auto dictionary = [&builder, &int_type](int64_t id, int32_t index_bit_width) {
+        auto index_type = int_type(index_bit_width, true);
+        builder.start_table();
+        builder.add_int64(0, id);
+        builder.add_offset(1, index_type);
+        return builder.end_table();
+    };
+    auto field = [&builder](string_view_t name, uint8_t type_type, uint32_t type, uint32_t dictionary_encoding) {
+        auto name_string = builder.create_string(name);
+        auto children = builder.create_offset_vector({});
+        builder.start_table();
+        builder.add_offset(0, name_string);
+        builder.add_offset(3, type);
+        if (dictionary_encoding != 0)
+        {
+            builder.add_offset(4, dictionary_encoding);
+        }
+        builder.add_offset(5, children);
+        builder.add_int8(1, 0); // not nullable
+        builder.add_int8(2, static_cast<int8_t>(type_type));
+        return builder.end_table();
+    };
+
+    std::vector<uint32_t> fields;
+    // Timestamp: unit (0), timezone (1)
+    auto timezone = builder.create_string("UTC");
+    builder.start_table();
+    builder.add_offset(1, timezone);
+    builder.add_int16(0, fbs::time_unit_nanosecond);
+    auto timestamp_type = builder.end_table();
+    fields.push_back(field("time", fbs::type_timestamp, timestamp_type, 0));
+
+    auto level_dictionary = dictionary(fbs::level_dictionary_id, 8);
+    fields.push_back(field("level", fbs::type_utf8, utf8_type(), level_dictionary));
+    auto logger_dictionary = dictionary(fbs::logger_dictionary_id, 32);
+    fields.push_back(field("logger", fbs::type_utf8, utf8_type(), logger_dictionary));
+    fields.push_back(field("thread", fbs::type_int, int_type(64, false), 0));
+    fields.push_back(field("message", fbs::type_utf8, utf8_type(), 0));
+
+    auto fields_vector = builder.create_offset_vector(fields);
+    builder.start_table();
+    builder.add_offset(1, fields_vector);
+    builder.add_int16(0, is_little_endian() ? 0 : 1); // the body buffers are in the native byte order
+    return builder.end_table();
+}
+
+// a body buffer, padded to 8 bytes. Buffer: offset (int64), length (int64) in the body
+SPDLOG_INLINE void file_writer::add_buffer_(const void *data, size_t size)
+{
+    const int64_t fields[2] = {static_cast<int64_t>(body_.size()), static_cast<int64_t>(size)};
+    for (auto field : fields)
+    {
+        for (size_t i = 0; i < 8; i++)
+        {
+            buffers_.push_back(static_cast<char>(static_cast<uint64_t>(field) >> (8 * i)));
+        }
+    }
+    if (size > 0)
+    {
+        body_.append(static_cast<const char *>(data), size);
+        body_.append((8 - size % 8) % 8, '\0');
+    }
+}
+
+// FieldNode: length (int64), null_count (int64)
+SPDLOG_INLINE void file_writer::add_node_(int64_t length)
+{
+    for (size_t i = 0; i < 8; i++)
+    {
+        nodes_.push_back(static_cast<char>(static_cast<uint64_t>(length) >> (8 * i)));
+    }
+    nodes_.append(8, '\0');
+}
+
+// RecordBatch: length (0), nodes (1), buffers (2)
+SPDLOG_INLINE uint32_t file_writer::add_record_batch_(flatbuffer_builder &builder, int64_t length)
+{
+    auto nodes = builder.create_struct_vector(nodes_, nodes_.size() / 16);
+    auto buffers = builder.create_struct_vector(buffers_, buffers_.size() / 16);
+    builder.start_table();
+    builder.add_int64(0, length);
+    builder.add_offset(1, nodes);
+    builder.add_offset(2, buffers);
+    return builder.end_table();
+}
+
+// DictionaryBatch: id (0), data (1) - a record batch of the utf8 values
+SPDLOG_INLINE void file_writer::write_dictionary_(int64_t id, const std::vector<string_view_t> &values)
+{
+    std::vector<int32_t> offsets{0};
+    std::string data;
+    for (auto &value : values)
+    {
+        data.append(value.data(), value.size());
+        offsets.push_back(static_cast<int32_t>(data.size()));
+    }
+    body_.clear();
+    nodes_.clear();
+    buffers_.clear();
+    add_node_(static_cast<int64_t>(values.size()));
+    add_buffer_(nullptr, 0);
+    add_buffer_(offsets.data(), offsets.size() * sizeof(int32_t));
+    add_buffer_(data.data(), data.size());
+
+    flatbuffer_builder builder;
+    auto record_batch = add_record_batch_(builder, static_cast<int64_t>(values.size()));
+    builder.start_table();
+    builder.add_int64(0, id);
+    builder.add_offset(1, record_batch);
+    auto dictionary_batch = builder.end_table();
+    dictionaries_.push_back(write_message_(builder, fbs::header_dictionary_batch, dictionary_batch));
+}
+
+// encapsulated message: 0xffffffff, int32 metadata size, Message flatbuffer (padded to 8), body.
+// Message: version (0), header_type (1), header (2), bodyLength (3)
+SPDLOG_INLINE file_writer::block file_writer::write_message_(flatbuffer_builder &builder, uint8_t header_type, uint32_t header)
+{
+    builder.start_table();
+    builder.add_int64(3, static_cast<int64_t>(body_.size()));
+    builder.add_offset(2, header);
+    builder.add_int16(0, fbs::metadata_version_v5);
+    builder.add_int8(1, static_cast<int8_t>(header_type));
+    auto message = builder.end_table();
+
+    metadata_.clear();
+    metadata_.resize(8);
+    builder.finish(message, metadata_);
+    const auto flatbuffer_size = static_cast<uint32_t>(metadata_.size() - 8);
+    const char prefix[8] = {'\xff', '\xff', '\xff', '\xff', static_cast<char>(flatbuffer_size), static_cast<char>(flatbuffer_size >> 8),
+        static_cast<char>(flatbuffer_size >> 16), static_cast<char>(flatbuffer_size >> 24)};
+    std::copy(prefix, prefix + sizeof(prefix), metadata_.data());
+
+    block message_block{static_cast<int64_t>(size_), static_cast<int32_t>(metadata_.size()), static_cast<int64_t>(body_.size())};
+    write_(string_view_t(metadata_.data(), metadata_.size()));
+    write_(string_view_t(body_.data(), body_.size()));
+    return message_block;
+}
+
+} // namespace arrow_ipc
+} // namespace details
+} // namespace spdlog
@@ -0,0 +1,149 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Arrow IPC file format of log messages (written by arrow_file_sink), readable by pyarrow, DuckDB, Spark..
+// See https://arrow.apache.org/docs/format/Columnar.html#ipc-file-format
+//
+// Schema (no nulls):
+//   time     timestamp[ns, tz=UTC]
+//   level    dictionary<values=utf8, indices=int8>   - the level names, indexed by level_enum
+//   logger   dictionary<values=utf8, indices=int32>  - the logger names
+//   thread   uint64
+//   message  utf8
+//
+// file := "ARROW1\0\0" schema record_batch* dictionary(level) dictionary(logger) eos footer int32(footer size) "ARROW1"
+// The dictionaries are written last, once all the logger names of the file are known: the readers find them
+// (as the record batches) by the footer. So a file is readable once closed.
+// The flatbuffers of the metadata are written in place by flatbuffer_builder (no flatbuffers library).
+
+#include <spdlog/common.h>
+#include <spdlog/details/file_helper.h>
+#include <spdlog/details/log_msg.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace spdlog {
+namespace details {
+namespace arrow_ipc {
+
+static const char magic[] = {'A', 'R', 'R', 'O', 'W', '1'};
+
+// the columns of a batch of messages
+struct SPDLOG_API log_columns
+{
+    std::vector<int64_t> time; // ns since epoch
+    std::vector<int8_t> level;
+    std::vector<int32_t> logger; // index in the logger names of the file
+    std::vector<uint64_t> thread;
+    std::vector<int32_t> message_offsets{0}; // of each message in message_data, and its end
+    std::string message_data;
+
+    size_t size() const
+    {
+        return time.size();
+    }
+
+    // approximate size of the batch in the file
+    size_t bytes() const;
+    void append(const log_msg &msg, int32_t logger_index);
+    void clear();
+};
+
+// Minimal flatbuffers builder: the buffer is built back to front, as by the flatbuffers library, the objects
+// referenced first. Offsets are the distances of the objects from the end of the buffer (size() once added).
+// A single table can be in construction at a time.
+class SPDLOG_API flatbuffer_builder
+{
+public:
+    uint32_t size() const;
+    uint32_t create_string(string_view_t value);
+    // a vector of structs of 8 bytes aligned fields
+    uint32_t create_struct_vector(const std::string &bytes, size_t count);
+    uint32_t create_offset_vector(const std::vector<uint32_t> &objects);
+
+    void start_table();
+    void add_int8(uint16_t id, int8_t value);
+    void add_int16(uint16_t id, int16_t value);
+    void add_int32(uint16_t id, int32_t value);
+    void add_int64(uint16_t id, int64_t value);
+    void add_offset(uint16_t id, uint32_t object);
+    uint32_t end_table();
+
+    // append the buffer with the given root table to dest. its size is a multiple of 8.
+    void finish(uint32_t root, memory_buf_t &dest);
+
+private:
+    std::string reversed_; // the buffer, last byte first
+    struct field_slot
+    {
+        uint16_t id;
+        uint32_t position;
+    };
+    std::vector<field_slot> fields_;
+    uint32_t table_start_{0};
+
+    void pad_(size_t n);
+    // pad so that the size is aligned once len bytes are added
+    void prealign_(size_t len, size_t alignment);
+    void push_(uint64_t value, size_t size);
+    void push_bytes_(const char *data, size_t size);
+    void push_offset_(uint32_t object);
+    void add_field_(uint16_t id);
+};
+
+// Throw spdlog_ex on errors.
+// Not thread safe.
+class SPDLOG_API file_writer
+{
+public:
+    // create (truncate) the file and write its schema
+    void open(const filename_t &filename);
+    void write_batch(const log_columns &columns);
+    // write the dictionaries and the footer, and close the file. a no-op if not open.
+    void close(const std::vector<std::string> &logger_names);
+    void flush();
+    bool is_open() const;
+    size_t size() const;
+    const filename_t &filename() const;
+
+private:
+    struct block
+    {
+        int64_t offset;
+        int32_t metadata_length;
+        int64_t body_length;
+    };
+
+    file_helper file_;
+    bool open_{false};
+    size_t size_{0}; // written - the file may buffer it
+    std::vector<block> dictionaries_;
+    std::vector<block> record_batches_;
+    // reused by the messages
+    memory_buf_t metadata_;
+    std::string body_;
+    std::string nodes_;
+    std::string buffers_;
+
+    void write_(string_view_t data);
+    static uint32_t add_schema_(flatbuffer_builder &builder);
+    void add_buffer_(const void *data, size_t size);
+    void add_node_(int64_t length);
+    // the RecordBatch of the nodes_ and buffers_ added
+    uint32_t add_record_batch_(flatbuffer_builder &builder, int64_t length);
+    void write_dictionary_(int64_t id, const std::vector<string_view_t> &values);
+    // write the message of the given header and the body_, return its block
+    block write_message_(flatbuffer_builder &builder, uint8_t header_type, uint32_t header);
+};
+
+} // namespace arrow_ipc
+} // namespace details
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "arrow_ipc-inl.h"
+#endif
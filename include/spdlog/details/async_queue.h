@@ -0,0 +1,101 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Interface of the bounded queues that can be used by the thread_pool.
+// enqueue(..) - will block until room found to put the new message.
+// enqueue_for(..) - will block until room found or timeout have passed.
+// enqueue_nowait(..) - will overrun the oldest message if no room left (never one that
+// async_queue_item<T>::overrunnable(..) rejects).
+// try_enqueue(..) - will return immediately with false if no room left.
+// dequeue_for(..) - will block until the queue is not empty or timeout have
+// passed.
+// dequeue_bulk_for(..) - same as dequeue_for(..), but moves out up to max_items
+// items at once.
+// try_dequeue_bulk(..) - moves out up to max_items items, never waits.
+
+#include <spdlog/common.h>
+
+#include <chrono>
+#include <cstddef>
+
+namespace spdlog {
+namespace details {
+
+// tells the queues whether an item may be overrun by enqueue_nowait(..). the queues skip the items it rejects
+// (e.g. the control messages of the thread pool, waited for by their senders) and overrun a newer one instead,
+// or, if none, wait for room.
+template<typename T>
+struct async_queue_item
+{
+    static bool overrunnable(const T &)
+    {
+        return true;
+    }
+};
+
+template<typename T>
+class async_queue
+{
+public:
+    using item_type = T;
+
+    virtual ~async_queue() = default;
+
+    // try to enqueue and block if no room left
+    virtual void enqueue(T &&item) = 0;
+
+    // try to enqueue and block up to timeout if no room left.
+    // Return true, if succeeded enqueue item (the item is moved only then), false otherwise
+    virtual bool enqueue_for(T &&item, std::chrono::nanoseconds timeout) = 0;
+
+    // enqueue immediately. overrun the oldest overrunnable message in the queue if no room left
+    // (or wait for room if none is).
+    // Return the number of overrun messages.
+    virtual size_t enqueue_nowait(T &&item) = 0;
+
+    // enqueue if there is room. never blocks.
+    // the item is moved only if the enqueue succeeded.
+    virtual bool try_enqueue(T &&item) = 0;
+
+    // try to dequeue item. if no item found. wait upto timeout and try again
+    // Return true, if succeeded dequeue item, false otherwise
+    virtual bool dequeue_for(T &popped_item, std::chrono::milliseconds wait_duration) = 0;
+
+    // try to dequeue up to max_items items into the given array. if no item found. wait upto timeout and try again
+    // Return the number of dequeued items (0 if timeout passed).
+    virtual size_t dequeue_bulk_for(T *popped_items, size_t max_items, std::chrono::milliseconds wait_duration) = 0;
+
+    // dequeue up to max_items items into the given array if any available. never waits for items.
+    // Return the number of dequeued items.
+    virtual size_t try_dequeue_bulk(T *popped_items, size_t max_items) = 0;
+
+    virtual size_t overrun_counter() = 0;
+
+    virtual size_t size() = 0;
+
+    // the fraction of the capacity taken (0 to 1), read without taking a lock - approximate while
+    // items are enqueued or dequeued. the per thread lanes: the lane of the calling thread.
+    virtual double load_factor() = 0;
+
+    // held across fork() by the fork safe thread pools (no item is being enqueued in the child then).
+    // no-op for the lock free queues.
+    virtual void lock_for_fork() {}
+    // child is true in the forked process, where the threads that waited on the queue do not exist
+    virtual void unlock_after_fork(bool child)
+    {
+        (void)child;
+    }
+
+    // call fn on the items queued, without dequeuing them - lock free and async-signal-safe, for
+    // the crash dump (a best effort: the items being enqueued or dequeued meanwhile are skipped).
+    // no-op for the queues that need a lock to be read.
+    virtual void foreach_queued_unsafe(void (*fn)(const T &item, void *context), void *context) const SPDLOG_NOEXCEPT
+    {
+        (void)fn;
+        (void)context;
+    }
+};
+} // namespace details
+} // namespace spdlog
@@ -0,0 +1,153 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Counters of the async thread pool (and of each async logger), updated with
+// relaxed atomics so taking a snapshot never locks the queues.
+
+#include <spdlog/common.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+
+namespace spdlog {
+namespace details {
+
+// bucket i of the latency histogram counts latencies below 2^i microseconds (the last one - all the rest)
+SPDLOG_CONSTEXPR size_t async_latency_buckets = 24;
+
+struct async_stats
+{
+    size_t enqueued = 0;
+    size_t dequeued = 0;
+    size_t dropped = 0;        // overrun by newer messages (pool only)
+    size_t discarded = 0;      // new messages not enqueued by the discard_new policy
+    size_t blocked = 0;        // enqueue calls that waited for room in the queue
+    size_t timeouts = 0;       // waits of the block_for policy that timed out (their messages are counted as discarded too)
+    std::chrono::nanoseconds blocked_time{0};
+    size_t high_water_mark = 0; // max number of messages in the queue (pool only)
+    // pool only, counted whatever collect_stats: the running workers, and those added and retired by an elastic pool
+    size_t workers = 0;
+    size_t workers_added = 0;
+    size_t workers_retired = 0;
+    // pool only, counted whatever collect_stats: the messages stolen from the shared queue of another shard
+    size_t stolen = 0;
+    // pool only, counted whatever collect_stats: the messages written to the spill file (see thread_pool_options::spill_file)
+    size_t spilled = 0;
+    // time from log_msg::time until the message was handed to the sinks
+    std::array<size_t, async_latency_buckets> latency_histogram{};
+};
+
+class async_stats_counters
+{
+public:
+    void on_enqueued(size_t dropped)
+    {
+        auto enqueued = enqueued_.fetch_add(1, std::memory_order_relaxed) + 1;
+        if (dropped > 0)
+        {
+            dropped_.fetch_add(dropped, std::memory_order_relaxed);
+        }
+        auto out = dequeued_.load(std::memory_order_relaxed) + dropped_.load(std::memory_order_relaxed);
+        auto depth = enqueued > out ? enqueued - out : 0;
+        auto high_water_mark = high_water_mark_.load(std::memory_order_relaxed);
+        while (depth > high_water_mark && !high_water_mark_.compare_exchange_weak(high_water_mark, depth, std::memory_order_relaxed)) {}
+    }
+
+    void on_blocked(std::chrono::nanoseconds waited)
+    {
+        blocked_.fetch_add(1, std::memory_order_relaxed);
+        blocked_ns_.fetch_add(static_cast<size_t>(waited.count()), std::memory_order_relaxed);
+    }
+
+    void on_discarded()
+    {
+        discarded_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void on_timeout()
+    {
+        timeouts_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void on_dequeued(size_t n_items)
+    {
+        dequeued_.fetch_add(n_items, std::memory_order_relaxed);
+    }
+
+    void on_sunk(log_clock::time_point msg_time, log_clock::time_point now)
+    {
+        auto micros = std::chrono::duration_cast<std::chrono::microseconds>(now - msg_time).count();
+        size_t bucket = 0;
+        while (bucket < async_latency_buckets - 1 && micros >= (static_cast<decltype(micros)>(1) << bucket))
+        {
+            bucket++;
+        }
+        latency_[bucket].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void on_worker_added()
+    {
+        workers_added_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void on_worker_retired()
+    {
+        workers_retired_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void on_stolen(size_t n_msgs)
+    {
+        stolen_.fetch_add(n_msgs, std::memory_order_relaxed);
+    }
+
+    void on_spilled()
+    {
+        spilled_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    async_stats snapshot() const
+    {
+        async_stats stats;
+        stats.enqueued = enqueued_.load(std::memory_order_relaxed);
+        stats.dequeued = dequeued_.load(std::memory_order_relaxed);
+        stats.dropped = dropped_.load(std::memory_order_relaxed);
+        stats.discarded = discarded_.load(std::memory_order_relaxed);
+        stats.blocked = blocked_.load(std::memory_order_relaxed);
+        stats.timeouts = timeouts_.load(std::memory_order_relaxed);
+        stats.blocked_time = std::chrono::nanoseconds(blocked_ns_.load(std::memory_order_relaxed));
+        stats.high_water_mark = high_water_mark_.load(std::memory_order_relaxed);
+        stats.workers_added = workers_added_.load(std::memory_order_relaxed);
+        stats.workers_retired = workers_retired_.load(std::memory_order_relaxed);
+        stats.stolen = stolen_.load(std::memory_order_relaxed);
+        stats.spilled = spilled_.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < async_latency_buckets; i++)
+        {
+            stats.latency_histogram[i] = latency_[i].load(std::memory_order_relaxed);
+        }
+        return stats;
+    }
+
+private:
+    // producer side
+    std::atomic<size_t> enqueued_{0};
+    std::atomic<size_t> dropped_{0};
+    std::atomic<size_t> discarded_{0};
+    std::atomic<size_t> blocked_{0};
+    std::atomic<size_t> timeouts_{0};
+    std::atomic<size_t> blocked_ns_{0};
+    std::atomic<size_t> high_water_mark_{0};
+    std::atomic<size_t> workers_added_{0};
+    std::atomic<size_t> workers_retired_{0};
+    std::atomic<size_t> stolen_{0};
+    std::atomic<size_t> spilled_{0};
+    // consumer side
+    char padding_[SPDLOG_CACHE_LINE_SIZE];
+    std::atomic<size_t> dequeued_{0};
+    std::array<std::atomic<size_t>, async_latency_buckets> latency_{};
+};
+
+} // namespace details
+} // namespace spdlog
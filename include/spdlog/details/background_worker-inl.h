@@ -0,0 +1,97 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/details/background_worker.h>
+#endif
+
+namespace spdlog {
+namespace details {
+
+SPDLOG_INLINE background_worker::background_worker()
+    : worker_thread_(&background_worker::worker_loop_, this)
+{}
+
+SPDLOG_INLINE background_worker::~background_worker()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        active_ = false;
+    }
+    cv_.notify_one();
+    worker_thread_.join();
+}
+
+SPDLOG_INLINE void background_worker::post(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+    }
+    cv_.notify_one();
+}
+
+SPDLOG_INLINE void background_worker::wait_idle()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_cv_.wait(lock, [this] { return tasks_.empty() && !running_task_; });
+}
+
+SPDLOG_INLINE std::string background_worker::take_error()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string error;
+    error.swap(error_);
+    return error;
+}
+
+SPDLOG_INLINE void background_worker::worker_loop_()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;)
+    {
+        cv_.wait(lock, [this] { return !tasks_.empty() || !active_; });
+        if (tasks_.empty())
+        {
+            return; // active_ == false and nothing left to do
+        }
+        auto task = std::move(tasks_.front());
+        tasks_.pop_front();
+        running_task_ = true;
+        lock.unlock();
+#ifdef SPDLOG_NO_EXCEPTIONS
+        task();
+#else
+        std::string error;
+        try
+        {
+            task();
+        }
+        catch (const std::exception &ex)
+        {
+            error = ex.what();
+        }
+        catch (...)
+        {
+            error = "Unknown exception in background task";
+        }
+#endif
+        lock.lock();
+        running_task_ = false;
+#ifndef SPDLOG_NO_EXCEPTIONS
+        if (!error.empty() && error_.empty())
+        {
+            error_ = std::move(error);
+        }
+#endif
+        if (tasks_.empty())
+        {
+            idle_cv_.notify_all();
+        }
+    }
+}
+
+} // namespace details
+} // namespace spdlog
@@ -0,0 +1,60 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// background worker thread - executes the posted tasks one by one, in order.
+// used by the file sinks to take slow file operations (renaming, deleting..) off the logging threads.
+//
+// RAII over the owned thread:
+//    creates the thread on construction.
+//    runs the tasks left and joins the thread on destruction.
+//
+// The exceptions thrown by the tasks are kept (the first one) until taken by take_error().
+
+#include <spdlog/common.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace spdlog {
+namespace details {
+
+class SPDLOG_API background_worker
+{
+public:
+    background_worker();
+    background_worker(const background_worker &) = delete;
+    background_worker &operator=(const background_worker &) = delete;
+    // run the tasks left, stop the worker thread and join it
+    ~background_worker();
+
+    void post(std::function<void()> task);
+    // wait for the tasks posted so far to complete
+    void wait_idle();
+    // return the error of the first failed task since the last call (empty if none)
+    std::string take_error();
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::condition_variable idle_cv_;
+    std::deque<std::function<void()>> tasks_;
+    bool running_task_{false};
+    bool active_{true};
+    std::string error_;
+    std::thread worker_thread_;
+
+    void worker_loop_();
+};
+
+} // namespace details
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "background_worker-inl.h"
+#endif
@@ -6,35 +6,123 @@
 #ifndef SPDLOG_HEADER_ONLY
 #    include <spdlog/details/backtracer.h>
 #endif
+
+#include <spdlog/details/os.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
 namespace spdlog {
 namespace details {
+SPDLOG_INLINE void backtracer::slot::lock()
+{
+    while (busy.exchange(true, std::memory_order_acquire))
+    {
+        os::cpu_relax();
+    }
+}
+
+SPDLOG_INLINE void backtracer::slot::unlock()
+{
+    busy.store(false, std::memory_order_release);
+}
+
+SPDLOG_INLINE const backtracer::ring *backtracer::rings::find(size_t thread_id) const
+{
+    if (!per_thread)
+    {
+        return all.front().get();
+    }
+    auto it = std::lower_bound(
+        all.begin(), all.end(), thread_id, [](const std::shared_ptr<ring> &r, size_t id) { return r->thread_id < id; });
+    return it != all.end() && (*it)->thread_id == thread_id ? it->get() : nullptr;
+}
+
 SPDLOG_INLINE backtracer::backtracer(const backtracer &other)
 {
     std::lock_guard<std::mutex> lock(other.mutex_);
+    if (other.rings_)
+    {
+        rcu_ptr<rings>::read_guard other_rings(*other.rings_);
+        if (other_rings.get() != nullptr)
+        {
+            // only this thread uses the new rings yet
+            memory_scope scope(memory_);
+            auto copy = details::make_unique<rings>(other_rings->size, other_rings->per_thread);
+            for (auto &other_messages : other_rings->all)
+            {
+                // retired along with the original
+                auto messages = std::make_shared<ring>(
+                    other_messages->slots.size(), other_messages->thread_id, other_messages->retired_flag);
+                auto *target = messages.get();
+                foreach_(*other_messages, false, 0, [target](const log_msg &msg) { push_(*target, log_msg_buffer{msg}, nullptr); });
+                copy->all.push_back(std::move(messages));
+            }
+            rings_ = details::make_unique<rcu_ptr<rings>>(std::move(copy));
+            add_crash_dump_source_();
+        }
+    }
     enabled_ = other.enabled();
-    messages_ = other.messages_;
 }
 
 SPDLOG_INLINE backtracer::backtracer(backtracer &&other) SPDLOG_NOEXCEPT
 {
     std::lock_guard<std::mutex> lock(other.mutex_);
     enabled_ = other.enabled();
-    messages_ = std::move(other.messages_);
+    rings_ = std::move(other.rings_);
+    memory_ = std::move(other.memory_);
+    other.enabled_ = false;
+    SPDLOG_TRY
+    {
+        add_crash_dump_source_();
+    }
+    SPDLOG_CATCH_STD
+}
+
+SPDLOG_INLINE backtracer::~backtracer()
+{
+    if (crash_dump_source_)
+    {
+        crash_dump_sources::instance().remove(this);
+    }
 }
 
 SPDLOG_INLINE backtracer &backtracer::operator=(backtracer other)
 {
     std::lock_guard<std::mutex> lock(mutex_);
     enabled_ = other.enabled();
-    messages_ = std::move(other.messages_);
+    rings_.swap(other.rings_);
+    memory_.swap(other.memory_);
+    add_crash_dump_source_();
     return *this;
 }
 
-SPDLOG_INLINE void backtracer::enable(size_t size)
+SPDLOG_INLINE void backtracer::enable(size_t size, bool per_thread)
 {
     std::lock_guard<std::mutex> lock{mutex_};
-    enabled_.store(true, std::memory_order_relaxed);
-    messages_ = circular_q<log_msg_buffer>{size};
+    std::unique_ptr<rings> messages;
+    if (size > 0)
+    {
+        messages = details::make_unique<rings>(size, per_thread);
+        if (!per_thread)
+        {
+            messages->all.push_back(make_ring_(size, 0));
+        }
+    }
+    if (rings_)
+    {
+        // wait for the writers still using the previous rings
+        rings_->publish(std::move(messages));
+    }
+    else
+    {
+        rings_ = details::make_unique<rcu_ptr<rings>>(std::move(messages));
+        add_crash_dump_source_();
+    }
+    // release: the writers that see it enabled see rings_
+    enabled_.store(true, std::memory_order_release);
 }
 
 SPDLOG_INLINE void backtracer::disable()
@@ -45,24 +133,319 @@ SPDLOG_INLINE void backtracer::disable()
 
 SPDLOG_INLINE bool backtracer::enabled() const
 {
-    return enabled_.load(std::memory_order_relaxed);
+    return enabled_.load(std::memory_order_acquire);
 }
 
 SPDLOG_INLINE void backtracer::push_back(const log_msg &msg)
+{
+    push_back(msg, nullptr, string_view_t{});
+}
+
+SPDLOG_INLINE void backtracer::push_back(const log_msg &msg, deferred_format_fn format_fn, string_view_t format_args)
+{
+    if (!enabled())
+    {
+        return;
+    }
+    // copy the message before locking the slot
+    memory_scope scope(memory_);
+    log_msg_buffer buffer{msg, format_args};
+    auto thread_id = os::thread_id();
+    {
+        rcu_ptr<rings>::read_guard messages(*rings_);
+        if (messages.get() == nullptr)
+        {
+            return;
+        }
+        auto *target = messages->find(thread_id);
+        if (target != nullptr && !target->retired())
+        {
+            push_(*target, std::move(buffer), format_fn);
+            return;
+        }
+    }
+    // first message of this thread (or the ring is of an exited thread with the same id)
+    add_thread_ring_(thread_id);
+    rcu_ptr<rings>::read_guard messages(*rings_);
+    auto *target = messages.get() != nullptr ? messages->find(thread_id) : nullptr;
+    if (target != nullptr)
+    {
+        push_(*target, std::move(buffer), format_fn);
+    }
+}
+
+SPDLOG_INLINE size_t backtracer::memory_used() const
 {
     std::lock_guard<std::mutex> lock{mutex_};
-    messages_.push_back(log_msg_buffer{msg});
+    return memory_ ? memory_->used() : 0;
+}
+
+SPDLOG_INLINE std::shared_ptr<backtracer::ring> backtracer::make_ring_(size_t size, size_t thread_id)
+{
+    return std::make_shared<ring>(size, thread_id, std::make_shared<std::atomic<bool>>(false));
+}
+
+SPDLOG_INLINE void backtracer::add_thread_ring_(size_t thread_id)
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    std::unique_ptr<rings> added;
+    std::vector<log_msg_buffer> exited_messages;
+    {
+        rcu_ptr<rings>::read_guard current(*rings_);
+        if (current.get() == nullptr || !current->per_thread)
+        {
+            return;
+        }
+        auto *existing = current->find(thread_id);
+        if (existing != nullptr && !existing->retired())
+        {
+            return;
+        }
+        // the live rings are shared by the copy: the messages written meanwhile are kept
+        added = details::make_unique<rings>(current->size, true);
+        memory_scope scope(memory_);
+        for (auto &r : current->all)
+        {
+            if (!r->retired())
+            {
+                added->all.push_back(r);
+                continue;
+            }
+            // no more writers: its messages are moved to the ring of the exited threads
+            foreach_(*r, true, 0, [&exited_messages](const log_msg &msg) { exited_messages.emplace_back(msg); });
+        }
+    }
+    // the ring of the exited threads has the id 0, first in order
+    auto by_id = [](const std::shared_ptr<ring> &r, size_t id) { return r->thread_id < id; };
+    if (!exited_messages.empty())
+    {
+        if (added->all.empty() || added->all.front()->thread_id != 0)
+        {
+            added->all.insert(added->all.begin(), make_ring_(added->size, 0));
+        }
+        auto &exited = *added->all.front();
+        std::stable_sort(exited_messages.begin(), exited_messages.end(),
+            [](const log_msg_buffer &a, const log_msg_buffer &b) { return a.time < b.time; });
+        // only the last ones fit
+        auto first = exited_messages.size() > added->size ? exited_messages.size() - added->size : 0;
+        for (auto i = first; i < exited_messages.size(); i++)
+        {
+            push_(exited, std::move(exited_messages[i]), nullptr);
+        }
+    }
+    auto it = std::lower_bound(added->all.begin(), added->all.end(), thread_id, by_id);
+    // without thread ids, all the threads share the ring of id 0
+    if (it == added->all.end() || (*it)->thread_id != thread_id)
+    {
+        auto messages = make_ring_(added->size, thread_id);
+#ifndef SPDLOG_NO_TLS
+        // past the ring_owner: kept until the next enable()
+        if (!ring_owner_destroyed_())
+        {
+            ring_owner_().add(messages->retired_flag);
+        }
+#endif
+        added->all.insert(it, std::move(messages));
+    }
+    rings_->publish(std::move(added));
 }
 
+#ifndef SPDLOG_NO_TLS
+SPDLOG_INLINE void backtracer::ring_owner::add(const std::shared_ptr<std::atomic<bool>> &flag)
+{
+    // forget the rings freed since (with their backtracer)
+    retired_flags.erase(std::remove_if(retired_flags.begin(), retired_flags.end(),
+                            [](const std::shared_ptr<std::atomic<bool>> &f) { return f.use_count() == 1; }),
+        retired_flags.end());
+    retired_flags.push_back(flag);
+}
+
+SPDLOG_INLINE backtracer::ring_owner::~ring_owner()
+{
+    ring_owner_destroyed_() = true;
+    for (auto &flag : retired_flags)
+    {
+        flag->store(true, std::memory_order_release);
+    }
+}
+
+SPDLOG_INLINE backtracer::ring_owner &backtracer::ring_owner_()
+{
+    static thread_local ring_owner owner;
+    return owner;
+}
+
+SPDLOG_INLINE bool &backtracer::ring_owner_destroyed_()
+{
+    static thread_local bool destroyed = false;
+    return destroyed;
+}
+#endif
+
 // pop all items in the q and apply the given fun on each of them.
-SPDLOG_INLINE void backtracer::foreach_pop(std::function<void(const details::log_msg &)> fun)
+SPDLOG_INLINE void backtracer::foreach_pop(foreach_fn fun)
+{
+    foreach_pop_(0, fun);
+}
+
+SPDLOG_INLINE void backtracer::foreach_pop_thread(foreach_fn fun)
+{
+    foreach_pop_(os::thread_id(), fun);
+}
+
+SPDLOG_INLINE void backtracer::foreach_pop_(size_t thread_id, const foreach_fn &fun)
 {
     std::lock_guard<std::mutex> lock{mutex_};
-    while (!messages_.empty())
+    if (!rings_)
+    {
+        return;
+    }
+    rcu_ptr<rings>::read_guard messages(*rings_);
+    if (messages.get() == nullptr)
+    {
+        return;
+    }
+    if (!messages->per_thread)
+    {
+        foreach_(*messages->all.front(), true, thread_id, fun);
+        return;
+    }
+    if (thread_id != 0)
+    {
+        auto *thread_messages = messages->find(thread_id);
+        if (thread_messages != nullptr)
+        {
+            foreach_(*thread_messages, true, 0, fun);
+        }
+        return;
+    }
+    // each ring is in order, merge them by time
+    std::vector<log_msg_buffer> merged;
+    for (auto &thread_messages : messages->all)
+    {
+        foreach_(*thread_messages, true, 0, [&merged](const log_msg &msg) { merged.emplace_back(msg); });
+    }
+    std::stable_sort(
+        merged.begin(), merged.end(), [](const log_msg_buffer &a, const log_msg_buffer &b) { return a.time < b.time; });
+    for (auto &msg : merged)
+    {
+        fun(msg);
+    }
+}
+
+SPDLOG_INLINE void backtracer::push_(const ring &messages, log_msg_buffer buffer, deferred_format_fn format_fn)
+{
+    auto ticket = messages.head.fetch_add(1, std::memory_order_relaxed);
+    auto &target = messages.slots[ticket % messages.slots.size()];
+    target.lock();
+    // unless a writer of the next lap was faster
+    if (!target.filled || target.ticket < ticket)
+    {
+        target.msg = std::move(buffer);
+        target.format_fn = format_fn;
+        target.ticket = ticket;
+        target.filled = true;
+    }
+    target.unlock();
+}
+
+SPDLOG_INLINE void backtracer::add_crash_dump_source_()
+{
+    if (rings_ && !crash_dump_source_)
+    {
+        crash_dump_sources::instance().add(this, crash_dump_);
+        crash_dump_source_ = true;
+    }
+}
+
+// Like foreach_(), without locking mutex_ nor waiting for the slots being written (skipped).
+// The deferred messages are written unformatted.
+SPDLOG_INLINE void backtracer::crash_dump_(const void *tracer, crash_writer &writer)
+{
+    auto *self = static_cast<const backtracer *>(tracer);
+    auto *current = self->rings_.get();
+    if (current == nullptr || !self->enabled())
+    {
+        return;
+    }
+    rcu_ptr<rings>::read_guard messages(*current);
+    if (messages.get() == nullptr)
+    {
+        return;
+    }
+    for (auto &r : messages->all)
+    {
+        auto head = r->head.load(std::memory_order_acquire);
+        auto size = r->slots.size();
+        auto first = head > size ? (std::max)(r->tail, head - size) : r->tail;
+        for (auto ticket = first; ticket < head; ticket++)
+        {
+            auto &source = r->slots[ticket % size];
+            if (source.busy.exchange(true, std::memory_order_acquire))
+            {
+                continue;
+            }
+            if (source.filled && source.ticket == ticket)
+            {
+                writer.write_msg(source.msg);
+            }
+            source.unlock();
+        }
+    }
+}
+
+// The messages still being written are skipped: they are older than the ones dumped after them,
+// and will be overwritten.
+SPDLOG_INLINE void backtracer::foreach_(const ring &messages, bool pop, size_t thread_id, const foreach_fn &fun)
+{
+    auto head = messages.head.load(std::memory_order_acquire);
+    auto size = messages.slots.size();
+    auto first = head > size ? (std::max)(messages.tail, head - size) : messages.tail;
+    for (auto ticket = first; ticket < head; ticket++)
+    {
+        auto &source = messages.slots[ticket % size];
+        log_msg_buffer msg;
+        deferred_format_fn format_fn = nullptr;
+        source.lock();
+        bool found = source.filled && source.ticket == ticket && (thread_id == 0 || source.msg.thread_id == thread_id);
+        if (found)
+        {
+            format_fn = source.format_fn;
+            if (pop)
+            {
+                msg = std::move(source.msg);
+                source.filled = false;
+            }
+            else
+            {
+                msg = source.msg;
+            }
+        }
+        source.unlock();
+        if (!found)
+        {
+            continue;
+        }
+        if (format_fn == nullptr)
+        {
+            fun(msg);
+            continue;
+        }
+        // copy the args to properly aligned storage
+        std::aligned_storage<SPDLOG_DEFERRED_ARGS_SIZE, alignof(std::max_align_t)>::type args;
+        auto format_args = msg.extra();
+        std::memcpy(&args, format_args.data(), format_args.size());
+        memory_buf_t buf;
+        format_fn(buf, msg.payload, &args);
+        log_msg formatted(msg);
+        formatted.payload = string_view_t(buf.data(), buf.size());
+        formatted.payload_id = 0;
+        fun(formatted);
+    }
+    // the messages of other threads are left in place, until dumped or overwritten
+    if (pop && thread_id == 0)
     {
-        auto &front_msg = messages_.front();
-        fun(front_msg);
-        messages_.pop_front();
+        messages.tail = head;
     }
 }
 } // namespace details
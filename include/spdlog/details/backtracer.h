@@ -3,38 +3,148 @@
 
 #pragma once
 
+#include <spdlog/details/crash_dump.h>
+#include <spdlog/details/deferred_format.h>
 #include <spdlog/details/log_msg_buffer.h>
-#include <spdlog/details/circular_q.h>
+#include <spdlog/details/memory_account.h>
+#include <spdlog/details/rcu_ptr.h>
 
 #include <atomic>
+#include <memory>
 #include <mutex>
 #include <functional>
+#include <vector>
 
 // Store log messages in circular buffer.
 // Useful for storing debug data in case of error/warning happens.
+//
+// push_back() takes no shared lock: it claims the next slot of the ring with an atomic ticket,
+// and locks only that slot (a spin lock, contended only if a writer laps another one).
+// The rings are replaced by enable(), and pinned by the writers meanwhile (see rcu_ptr.h).
+// Messages can be stored unformatted, with their captured args (see deferred_format.h):
+// they are formatted only if dumped.
+//
+// With per_thread, each thread that logs gets its own ring of the given size (added on its first message),
+// so that the noisiest threads don't evict the messages of the others. foreach_pop() merges them by time.
+// The ring of an exited thread is retired, and reclaimed when the next thread adds its own: its messages
+// not dumped yet are moved to a single ring of the exited threads (with SPDLOG_NO_TLS the rings are
+// kept until the next enable()).
 
 namespace spdlog {
 namespace details {
 class SPDLOG_API backtracer
 {
-    mutable std::mutex mutex_;
+    struct slot
+    {
+        std::atomic<bool> busy{false};
+        bool filled{false};
+        size_t ticket{0};
+        log_msg_buffer msg;
+        deferred_format_fn format_fn{nullptr}; // set if msg's payload is the format string of the args in msg.extra()
+
+        void lock();
+        void unlock();
+    };
+
+    struct ring
+    {
+        ring(size_t size, size_t the_thread_id, std::shared_ptr<std::atomic<bool>> the_retired_flag)
+            : slots(size)
+            , thread_id(the_thread_id)
+            , retired_flag(std::move(the_retired_flag))
+        {}
+
+        bool retired() const
+        {
+            return retired_flag->load(std::memory_order_acquire);
+        }
+
+        mutable std::vector<slot> slots;
+        mutable std::atomic<size_t> head{0}; // the next ticket
+        mutable size_t tail{0};              // the first ticket not dumped yet, guarded by mutex_
+        size_t thread_id;                    // the owner of a per thread ring
+        // set by the owner thread on exit (see ring_owner), shared by the copies of the ring
+        std::shared_ptr<std::atomic<bool>> retired_flag;
+    };
+
+    // the rings of an enable() call
+    struct rings
+    {
+        rings(size_t the_size, bool the_per_thread)
+            : size(the_size)
+            , per_thread(the_per_thread)
+        {}
+
+        // the ring the given thread writes to, or nullptr if it has none yet
+        const ring *find(size_t thread_id) const;
+
+        size_t size;
+        bool per_thread;
+        std::vector<std::shared_ptr<ring>> all; // a single one, or one per thread sorted by thread id
+    };
+
+    using foreach_fn = std::function<void(const details::log_msg &)>;
+
+#ifndef SPDLOG_NO_TLS
+    // the rings of the calling thread, in any backtracer: retired when the thread exits
+    struct ring_owner
+    {
+        std::vector<std::shared_ptr<std::atomic<bool>>> retired_flags;
+
+        void add(const std::shared_ptr<std::atomic<bool>> &flag);
+        ~ring_owner();
+    };
+
+    static ring_owner &ring_owner_();
+    // trivially destructible: still valid in the thread local destructors run after the ring_owner
+    static bool &ring_owner_destroyed_();
+#endif
+
+    mutable std::mutex mutex_; // enable(), disable(), foreach_pop(), new thread rings and copies
     std::atomic<bool> enabled_{false};
-    circular_q<log_msg_buffer> messages_;
+    // created by the first enable()
+    std::unique_ptr<rcu_ptr<rings>> rings_;
+    bool crash_dump_source_ = false; // added to the crash dump sources along with rings_
+    // the storage allocated by the messages stored (see memory_account.h), moved along with rings_
+    std::shared_ptr<memory_account> memory_ = std::make_shared<memory_account>();
+
+    // create the ring of the given thread, and reclaim the retired ones.
+    // called without mutex_ and outside of read guards.
+    void add_thread_ring_(size_t thread_id);
+    static std::shared_ptr<ring> make_ring_(size_t size, size_t thread_id);
+    void foreach_pop_(size_t thread_id, const foreach_fn &fun);
+
+    // the messages of the given ring not dumped yet, oldest first (only of the given thread if != 0).
+    // called with mutex_ locked.
+    static void foreach_(const ring &messages, bool pop, size_t thread_id, const foreach_fn &fun);
+    static void push_(const ring &messages, log_msg_buffer buffer, deferred_format_fn format_fn);
+    // called with mutex_ locked
+    void add_crash_dump_source_();
+    // write the messages not dumped yet (see crash_dump.h)
+    static void crash_dump_(const void *tracer, crash_writer &writer);
 
 public:
     backtracer() = default;
     backtracer(const backtracer &other);
+    ~backtracer();
 
     backtracer(backtracer &&other) SPDLOG_NOEXCEPT;
     backtracer &operator=(backtracer other);
 
-    void enable(size_t size);
+    void enable(size_t size, bool per_thread = false);
     void disable();
     bool enabled() const;
     void push_back(const log_msg &msg);
+    // store the message unformatted: its payload is the format string of the given args
+    void push_back(const log_msg &msg, deferred_format_fn format_fn, string_view_t format_args);
+
+    // bytes allocated by the stored messages beyond their slots
+    size_t memory_used() const;
 
-    // pop all items in the q and apply the given fun on each of them.
-    void foreach_pop(std::function<void(const details::log_msg &)> fun);
+    // pop all items in the q and apply the given fun on each of them (merged by time if per thread).
+    void foreach_pop(foreach_fn fun);
+    // same, only for the messages of the calling thread
+    void foreach_pop_thread(foreach_fn fun);
 };
 
 } // namespace details
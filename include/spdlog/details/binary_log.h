@@ -0,0 +1,155 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Binary log file format (written by binary_file_sink, read by binary_log_reader):
+//
+// file    := magic session*
+// session := record(session) record*    (appending to an existing file starts a new session)
+// record  := varint(size of type + body) type body
+//
+// Records (all integers are varints, signed ones zigzag encoded):
+//   session    - version, start time (ns since epoch). resets the string and thread tables.
+//   string_def - length, bytes. defines the next string id of the session, starting at 0.
+//   thread_def - thread id. defines the next thread index of the session, starting at 0.
+//   message    - time delta from the previous message (ns, signed), level, thread index,
+//                logger name string id, source file string id + 1 (0 if no source location),
+//                [line, function name string id], payload, number of fields, fields,
+//                [trace id (16 bytes), span id (8 bytes)] if the message has a trace context.
+//
+// The payload is either a string id (interned messages, whose text is constant) or
+// inline bytes: varint(string id << 1 | 1) or varint(length << 1) bytes.
+// A field is: key string id, value type, value - length + bytes for strings, varints for
+// ints, 8 bytes (little endian bits) for doubles, 1 byte for bools.
+// Readers ignore the bytes past the end of the message record they know of (the trace context for older ones).
+
+#include <spdlog/common.h>
+
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <unordered_map>
+
+namespace spdlog {
+namespace details {
+namespace binary_log {
+
+static const char magic[] = {'S', 'P', 'D', 'L', 'O', 'G', 'B', 'L'};
+static const unsigned char version = 1;
+
+enum class record_type : unsigned char
+{
+    session = 0,
+    string_def = 1,
+    thread_def = 2,
+    message = 3
+};
+
+inline void put_varint(uint64_t value, memory_buf_t &dest)
+{
+    while (value >= 0x80)
+    {
+        dest.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    dest.push_back(static_cast<char>(value));
+}
+
+inline uint64_t zigzag(int64_t value)
+{
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t unzigzag(uint64_t value)
+{
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+// read a varint from [pos, end). return false if truncated or too long.
+inline bool get_varint(const char *&pos, const char *end, uint64_t &value)
+{
+    value = 0;
+    for (unsigned int shift = 0; pos < end && shift < 64; shift += 7)
+    {
+        auto byte = static_cast<unsigned char>(*pos++);
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline void put_double(double value, memory_buf_t &dest)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    for (int i = 0; i < 8; i++)
+    {
+        dest.push_back(static_cast<char>((bits >> (i * 8)) & 0xff));
+    }
+}
+
+inline double get_double(const char *src)
+{
+    uint64_t bits = 0;
+    for (int i = 0; i < 8; i++)
+    {
+        bits |= static_cast<uint64_t>(static_cast<unsigned char>(src[i])) << (i * 8);
+    }
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// interned strings of the current session (writer side)
+class string_table
+{
+public:
+    // return the id of the given string. added is set if it was not in the table yet.
+    uint64_t id(string_view_t str, bool &added)
+    {
+        auto it = ids_.find(str);
+        if (it != ids_.end())
+        {
+            added = false;
+            return it->second;
+        }
+        strings_.emplace_back(str.data(), str.size());
+        auto new_id = static_cast<uint64_t>(ids_.size());
+        ids_.emplace(string_view_t(strings_.back()), new_id);
+        added = true;
+        return new_id;
+    }
+
+    void clear()
+    {
+        ids_.clear();
+        strings_.clear();
+    }
+
+private:
+    struct hasher
+    {
+        size_t operator()(string_view_t str) const SPDLOG_NOEXCEPT
+        {
+            // FNV-1a
+            uint64_t hash = 14695981039346656037ULL;
+            for (auto c : str)
+            {
+                hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+            }
+            return static_cast<size_t>(hash);
+        }
+    };
+
+    std::deque<std::string> strings_; // the keys of ids_ point here (deque keeps them in place)
+    std::unordered_map<string_view_t, uint64_t, hasher> ids_;
+};
+
+} // namespace binary_log
+} // namespace details
+} // namespace spdlog
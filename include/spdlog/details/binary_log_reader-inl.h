@@ -0,0 +1,258 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/details/binary_log_reader.h>
+#endif
+
+#include <spdlog/common.h>
+#include <spdlog/details/os.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <string>
+
+namespace spdlog {
+namespace details {
+
+SPDLOG_INLINE binary_log_reader::binary_log_reader(const filename_t &filename)
+    : filename_(filename)
+{
+    if (os::fopen_s(&fd_, filename, SPDLOG_FILENAME_T("rb")))
+    {
+        throw_spdlog_ex("Failed opening file " + os::filename_to_str(filename_) + " for reading", errno);
+    }
+    if (!fill_(sizeof(binary_log::magic)) || std::memcmp(buffer_.data(), binary_log::magic, sizeof(binary_log::magic)) != 0)
+    {
+        std::fclose(fd_);
+        fd_ = nullptr;
+        throw_spdlog_ex("Not a binary log file: " + os::filename_to_str(filename_));
+    }
+    pos_ = sizeof(binary_log::magic);
+}
+
+SPDLOG_INLINE binary_log_reader::~binary_log_reader()
+{
+    if (fd_ != nullptr)
+    {
+        std::fclose(fd_);
+    }
+}
+
+SPDLOG_INLINE bool binary_log_reader::read(log_msg &msg)
+{
+    using namespace binary_log;
+    for (;;)
+    {
+        // record size (at most 10 bytes)
+        fill_(10);
+        const char *pos = buffer_.data() + pos_;
+        const char *end = buffer_.data() + buffer_.size();
+        if (pos == end)
+        {
+            return false;
+        }
+        uint64_t record_size;
+        if (!get_varint(pos, end, record_size))
+        {
+            return false; // truncated
+        }
+        auto header_size = static_cast<size_t>(pos - (buffer_.data() + pos_));
+        if (record_size == 0 || !fill_(header_size + record_size))
+        {
+            return false; // truncated
+        }
+
+        const char *record = buffer_.data() + pos_ + header_size;
+        const char *record_end = record + record_size;
+        pos_ += header_size + record_size;
+        auto type = static_cast<record_type>(*record++);
+        switch (type)
+        {
+        case record_type::session:
+            read_session_(record, record_end);
+            break;
+        case record_type::string_def:
+            strings_.emplace_back(record, record_end);
+            break;
+        case record_type::thread_def: {
+            uint64_t thread_id;
+            if (!get_varint(record, record_end, thread_id))
+            {
+                throw_corrupted_();
+            }
+            threads_.push_back(static_cast<size_t>(thread_id));
+            break;
+        }
+        case record_type::message:
+            read_message_(record, record_end, msg);
+            return true;
+        default: // unknown record type (written by a newer version) - skip it
+            break;
+        }
+    }
+}
+
+SPDLOG_INLINE bool binary_log_reader::fill_(size_t n)
+{
+    if (buffer_.size() - pos_ >= n)
+    {
+        return true;
+    }
+    // move the unread bytes to the front and read more
+    buffer_.erase(buffer_.begin(), buffer_.begin() + static_cast<std::ptrdiff_t>(pos_));
+    pos_ = 0;
+    const size_t chunk_size = 64 * 1024;
+    while (!eof_ && buffer_.size() < n)
+    {
+        auto old_size = buffer_.size();
+        buffer_.resize(old_size + std::max(chunk_size, n - old_size));
+        auto n_read = std::fread(buffer_.data() + old_size, 1, buffer_.size() - old_size, fd_);
+        buffer_.resize(old_size + n_read);
+        if (n_read == 0)
+        {
+            eof_ = true;
+        }
+    }
+    return buffer_.size() >= n;
+}
+
+SPDLOG_INLINE void binary_log_reader::read_session_(const char *pos, const char *end)
+{
+    if (pos == end)
+    {
+        throw_corrupted_();
+    }
+    auto file_version = static_cast<unsigned char>(*pos++);
+    if (file_version != binary_log::version)
+    {
+        throw_spdlog_ex("Unsupported binary log version " + std::to_string(file_version) + " in " + os::filename_to_str(filename_));
+    }
+    uint64_t start_time;
+    if (!binary_log::get_varint(pos, end, start_time))
+    {
+        throw_corrupted_();
+    }
+    strings_.clear();
+    threads_.clear();
+    last_time_ = binary_log::unzigzag(start_time);
+}
+
+SPDLOG_INLINE void binary_log_reader::read_message_(const char *pos, const char *end, log_msg &msg)
+{
+    using namespace binary_log;
+    auto next = [&pos, end, this]() {
+        uint64_t value;
+        if (!get_varint(pos, end, value))
+        {
+            throw_corrupted_();
+        }
+        return value;
+    };
+    auto next_bytes = [&pos, end, this](size_t n) {
+        if (static_cast<size_t>(end - pos) < n)
+        {
+            throw_corrupted_();
+        }
+        string_view_t bytes(pos, n);
+        pos += n;
+        return bytes;
+    };
+
+    msg = log_msg();
+    last_time_ += unzigzag(next());
+    msg.time = log_clock::time_point(std::chrono::duration_cast<log_clock::duration>(std::chrono::nanoseconds(last_time_)));
+    auto lvl = static_cast<unsigned char>(*next_bytes(1).data());
+    msg.level = lvl < level::n_levels ? static_cast<level::level_enum>(lvl) : level::off;
+
+    auto thread_index = next();
+    if (thread_index >= threads_.size())
+    {
+        throw_corrupted_();
+    }
+    msg.thread_id = threads_[static_cast<size_t>(thread_index)];
+    msg.logger_name = string_(next());
+
+    auto filename_id = next();
+    if (filename_id != 0)
+    {
+        auto &filename = string_(filename_id - 1);
+        auto line = static_cast<int>(unzigzag(next()));
+        auto basename = basename_offset(filename.c_str(), 0, filename.size());
+        msg.source = source_loc{filename.c_str(), line, string_(next()).c_str(), filename.size(), basename};
+    }
+
+    auto payload = next();
+    if (payload & 1)
+    {
+        msg.payload = string_(payload >> 1);
+    }
+    else
+    {
+        msg.payload = next_bytes(static_cast<size_t>(payload >> 1));
+    }
+
+    auto n_fields = next();
+    if (n_fields > static_cast<uint64_t>(end - pos))
+    {
+        throw_corrupted_();
+    }
+    fields_.resize(static_cast<size_t>(n_fields));
+    for (auto &f : fields_)
+    {
+        f = field();
+        f.key = string_(next());
+        f.type = static_cast<field::value_type>(*next_bytes(1).data());
+        switch (f.type)
+        {
+        case field::value_type::string:
+            f.string_value = next_bytes(static_cast<size_t>(next()));
+            break;
+        case field::value_type::signed_int:
+            f.int_value = static_cast<long long>(unzigzag(next()));
+            break;
+        case field::value_type::unsigned_int:
+            f.uint_value = static_cast<unsigned long long>(next());
+            break;
+        case field::value_type::floating:
+            f.double_value = get_double(next_bytes(8).data());
+            break;
+        case field::value_type::boolean:
+            f.bool_value = *next_bytes(1).data() != 0;
+            break;
+        default:
+            throw_corrupted_();
+        }
+    }
+    msg.fields = fields_.empty() ? nullptr : fields_.data();
+    msg.n_fields = fields_.size();
+
+    if (pos != end)
+    {
+        auto trace_id = next_bytes(sizeof(msg.trace.trace_id));
+        auto span_id = next_bytes(sizeof(msg.trace.span_id));
+        std::memcpy(msg.trace.trace_id, trace_id.data(), trace_id.size());
+        std::memcpy(msg.trace.span_id, span_id.data(), span_id.size());
+    }
+}
+
+SPDLOG_INLINE const std::string &binary_log_reader::string_(uint64_t id) const
+{
+    if (id >= strings_.size())
+    {
+        throw_corrupted_();
+    }
+    return strings_[static_cast<size_t>(id)];
+}
+
+SPDLOG_INLINE void binary_log_reader::throw_corrupted_() const
+{
+    throw_spdlog_ex("Corrupted binary log file: " + os::filename_to_str(filename_));
+}
+
+} // namespace details
+} // namespace spdlog
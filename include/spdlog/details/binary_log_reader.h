@@ -0,0 +1,67 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <spdlog/common.h>
+#include <spdlog/details/binary_log.h>
+#include <spdlog/details/log_msg.h>
+
+#include <cstdio>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace spdlog {
+namespace details {
+
+// Reads back the messages of a file written by binary_file_sink, e.g.
+//
+// binary_log_reader reader("logs/app.bin");
+// log_msg msg;
+// while (reader.read(msg))
+// {
+//     formatter.format(msg, dest);
+// }
+//
+// Throw spdlog_ex exception if the file cannot be opened or is not a binary log.
+// A truncated last record (e.g. the writer was killed) ends the file.
+class SPDLOG_API binary_log_reader
+{
+public:
+    explicit binary_log_reader(const filename_t &filename);
+    ~binary_log_reader();
+
+    binary_log_reader(const binary_log_reader &) = delete;
+    binary_log_reader &operator=(const binary_log_reader &) = delete;
+
+    // read the next message. its strings are valid until the next call.
+    // return false at the end of the file.
+    bool read(log_msg &msg);
+
+private:
+    std::FILE *fd_{nullptr};
+    filename_t filename_;
+    std::vector<char> buffer_;
+    size_t pos_{0};
+    bool eof_{false};
+
+    std::deque<std::string> strings_; // deque - the c strings of source locations stay in place
+    std::vector<size_t> threads_;
+    int64_t last_time_{0};
+    std::vector<field> fields_;
+
+    // make sure n bytes are buffered from pos_. return false if the file ends before.
+    bool fill_(size_t n);
+    void read_session_(const char *pos, const char *end);
+    void read_message_(const char *pos, const char *end, log_msg &msg);
+    const std::string &string_(uint64_t id) const;
+    [[noreturn]] void throw_corrupted_() const;
+};
+
+} // namespace details
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "binary_log_reader-inl.h"
+#endif
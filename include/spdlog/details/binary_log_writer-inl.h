@@ -0,0 +1,190 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/details/binary_log_writer.h>
+#endif
+
+#include <spdlog/details/fmt_helper.h>
+#include <spdlog/details/os.h>
+
+#include <chrono>
+#include <iterator>
+
+namespace spdlog {
+namespace details {
+
+SPDLOG_INLINE void binary_log_writer::start_file(memory_buf_t &dest)
+{
+    dest.append(std::begin(binary_log::magic), std::end(binary_log::magic));
+}
+
+SPDLOG_INLINE void binary_log_writer::start_session(memory_buf_t &dest)
+{
+    using namespace binary_log;
+    last_time_ = std::chrono::duration_cast<std::chrono::nanoseconds>(os::now().time_since_epoch()).count();
+    body_.clear();
+    body_.push_back(static_cast<char>(version));
+    put_varint(zigzag(last_time_), body_);
+    append_record_(record_type::session, fmt_helper::to_string_view(body_), dest);
+}
+
+SPDLOG_INLINE void binary_log_writer::encode(const log_msg &msg, memory_buf_t &dest)
+{
+    using namespace binary_log;
+
+    // the ids first, as they might add definitions before the message
+    auto thread_index = thread_index_(msg.thread_id, dest);
+    if (!has_last_logger_name_ || msg.logger_name != string_view_t(last_logger_name_))
+    {
+        last_logger_name_id_ = string_id_(msg.logger_name, dest);
+        last_logger_name_.assign(msg.logger_name.data(), msg.logger_name.size());
+        has_last_logger_name_ = true;
+    }
+    auto logger_name_id = last_logger_name_id_;
+    uint64_t filename_id = 0;
+    uint64_t funcname_id = 0;
+    if (!msg.source.empty())
+    {
+        filename_id = string_id_(msg.source.filename_view(), dest) + 1;
+        funcname_id = string_id_(msg.source.funcname != nullptr ? msg.source.funcname : "", dest);
+    }
+    // the text of constant (interned) messages is written once, the others inline: the table would grow with
+    // every distinct runtime text
+    bool intern_payload = msg.payload_id != 0;
+    uint64_t payload_id = 0;
+    if (intern_payload)
+    {
+        payload_id = interned_string_id_(msg, dest);
+    }
+    for (size_t i = 0; i < msg.n_fields; i++)
+    {
+        string_id_(msg.fields[i].key, dest);
+    }
+
+    body_.clear();
+    auto time = std::chrono::duration_cast<std::chrono::nanoseconds>(msg.time.time_since_epoch()).count();
+    put_varint(zigzag(static_cast<int64_t>(time) - last_time_), body_);
+    last_time_ = static_cast<int64_t>(time);
+    body_.push_back(static_cast<char>(msg.level));
+    put_varint(thread_index, body_);
+    put_varint(logger_name_id, body_);
+    put_varint(filename_id, body_);
+    if (filename_id != 0)
+    {
+        put_varint(zigzag(msg.source.line), body_);
+        put_varint(funcname_id, body_);
+    }
+
+    if (intern_payload)
+    {
+        put_varint(payload_id << 1 | 1, body_);
+    }
+    else
+    {
+        put_varint(static_cast<uint64_t>(msg.payload.size()) << 1, body_);
+        fmt_helper::append_string_view(msg.payload, body_);
+    }
+
+    put_varint(msg.n_fields, body_);
+    for (size_t i = 0; i < msg.n_fields; i++)
+    {
+        const auto &f = msg.fields[i];
+        bool added;
+        put_varint(strings_.id(f.key, added), body_);
+        body_.push_back(static_cast<char>(f.type));
+        switch (f.type)
+        {
+        case field::value_type::string:
+            put_varint(f.string_value.size(), body_);
+            fmt_helper::append_string_view(f.string_value, body_);
+            break;
+        case field::value_type::signed_int:
+            put_varint(zigzag(f.int_value), body_);
+            break;
+        case field::value_type::unsigned_int:
+            put_varint(f.uint_value, body_);
+            break;
+        case field::value_type::floating:
+            put_double(f.double_value, body_);
+            break;
+        case field::value_type::boolean:
+            body_.push_back(f.bool_value ? '\1' : '\0');
+            break;
+        }
+    }
+    if (!msg.trace.empty())
+    {
+        const auto *context = reinterpret_cast<const char *>(&msg.trace);
+        body_.append(context, context + sizeof(msg.trace.trace_id) + sizeof(msg.trace.span_id));
+    }
+    append_record_(record_type::message, fmt_helper::to_string_view(body_), dest);
+}
+
+// return the id of the given string, defining it first if new
+SPDLOG_INLINE uint64_t binary_log_writer::string_id_(string_view_t str, memory_buf_t &dest)
+{
+    bool added;
+    auto id = strings_.id(str, added);
+    if (added)
+    {
+        append_record_(binary_log::record_type::string_def, str, dest);
+    }
+    return id;
+}
+
+// return the string id of an interned payload - by its intern table id, without hashing the text
+SPDLOG_INLINE uint64_t binary_log_writer::interned_string_id_(const log_msg &msg, memory_buf_t &dest)
+{
+    if (msg.payload_id >= interned_ids_.size())
+    {
+        interned_ids_.resize(msg.payload_id + 1, 0);
+    }
+    auto &id = interned_ids_[msg.payload_id];
+    if (id == 0)
+    {
+        id = string_id_(msg.payload, dest) + 1;
+    }
+    return id - 1;
+}
+
+// return the index of the given thread id, defining it first if new
+SPDLOG_INLINE uint64_t binary_log_writer::thread_index_(size_t thread_id, memory_buf_t &dest)
+{
+    using namespace binary_log;
+    if (has_last_thread_ && thread_id == last_thread_id_)
+    {
+        return last_thread_index_;
+    }
+
+    auto it = threads_.find(thread_id);
+    uint64_t index;
+    if (it != threads_.end())
+    {
+        index = it->second;
+    }
+    else
+    {
+        index = threads_.size();
+        threads_.emplace(thread_id, index);
+        memory_buf_t body;
+        put_varint(thread_id, body);
+        append_record_(record_type::thread_def, fmt_helper::to_string_view(body), dest);
+    }
+    has_last_thread_ = true;
+    last_thread_id_ = thread_id;
+    last_thread_index_ = index;
+    return index;
+}
+
+SPDLOG_INLINE void binary_log_writer::append_record_(binary_log::record_type type, string_view_t body, memory_buf_t &dest)
+{
+    binary_log::put_varint(body.size() + 1, dest);
+    dest.push_back(static_cast<char>(type));
+    fmt_helper::append_string_view(body, dest);
+}
+
+} // namespace details
+} // namespace spdlog
@@ -0,0 +1,54 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Encoder of the binary log records (see binary_log.h): keeps the string and thread tables of a session.
+// Used by binary_file_sink and by the dumps of the flight recorder, which can't depend on the sinks.
+
+#include <spdlog/common.h>
+#include <spdlog/details/binary_log.h>
+#include <spdlog/details/log_msg.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace spdlog {
+namespace details {
+
+class SPDLOG_API binary_log_writer
+{
+public:
+    // append the magic, for a new file
+    static void start_file(memory_buf_t &dest);
+    // append a session record: starts the tables of the writer
+    void start_session(memory_buf_t &dest);
+    // append the message record, after the definitions of its new strings and thread
+    void encode(const log_msg &msg, memory_buf_t &dest);
+
+private:
+    binary_log::string_table strings_;
+    std::vector<uint64_t> interned_ids_; // string id + 1 (0 if not defined yet) by intern table id
+    std::unordered_map<size_t, uint64_t> threads_;
+    size_t last_thread_id_{0};
+    uint64_t last_thread_index_{0};
+    bool has_last_thread_{false};
+    std::string last_logger_name_;
+    uint64_t last_logger_name_id_{0};
+    bool has_last_logger_name_{false};
+    int64_t last_time_{0};
+    memory_buf_t body_;
+
+    uint64_t string_id_(string_view_t str, memory_buf_t &dest);
+    uint64_t interned_string_id_(const log_msg &msg, memory_buf_t &dest);
+    uint64_t thread_index_(size_t thread_id, memory_buf_t &dest);
+    static void append_record_(binary_log::record_type type, string_view_t body, memory_buf_t &dest);
+};
+
+} // namespace details
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "binary_log_writer-inl.h"
+#endif
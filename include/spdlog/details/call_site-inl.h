@@ -0,0 +1,268 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/details/call_site.h>
+#endif
+
+#include <spdlog/logger.h>
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace spdlog {
+namespace details {
+
+// the registered call sites, and the set_enabled()/set_logger_enabled() calls in order
+// (applied to the call sites reached later)
+struct call_sites
+{
+    struct rule
+    {
+        std::string filename; // empty for a logger rule
+        int line;
+        std::string logger_name;
+        bool enabled;
+    };
+
+    std::mutex mutex;
+    std::vector<call_site *> sites;
+    std::vector<rule> rules;
+    std::atomic<bool> has_logger_rules{false};
+    bool any_logger_enabled{false}; // a logger rule enables call sites: the opt-in keys must be on
+
+    static call_sites &instance()
+    {
+        static call_sites s_instance;
+        return s_instance;
+    }
+};
+
+SPDLOG_INLINE void call_site::invalidate_all() SPDLOG_NOEXCEPT
+{
+    // release: the checks that see the new generation see the change that bumped it
+    generation_().fetch_add(1, std::memory_order_acq_rel);
+}
+
+SPDLOG_INLINE void call_site::set_enabled(const std::string &filename, int line, bool enabled)
+{
+    auto &registry = call_sites::instance();
+    {
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.rules.push_back(call_sites::rule{filename, line, std::string(), enabled});
+        for (auto *site : registry.sites)
+        {
+            if (site->matches_(filename, line))
+            {
+                site->enabled_.store(enabled, std::memory_order_relaxed);
+                site->update_key_(registry.any_logger_enabled);
+            }
+        }
+    }
+    invalidate_all();
+}
+
+SPDLOG_INLINE void call_site::set_logger_enabled(const std::string &logger_name, bool enabled)
+{
+    auto &registry = call_sites::instance();
+    {
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.rules.push_back(call_sites::rule{std::string(), 0, logger_name, enabled});
+        registry.has_logger_rules.store(true);
+        if (enabled && !registry.any_logger_enabled)
+        {
+            registry.any_logger_enabled = true;
+            for (auto *site : registry.sites)
+            {
+                site->update_key_(true);
+            }
+        }
+    }
+    invalidate_all();
+}
+
+SPDLOG_INLINE bool call_site::check_(const logger *target, level::level_enum lvl, call_site_cache *cache)
+{
+    if (!registered_.load(std::memory_order_acquire))
+    {
+        register_();
+    }
+    auto &generation = generation_();
+    // before reading the state it stands for
+    auto seen_generation = generation.load(std::memory_order_acquire);
+    bool site_enabled = enabled_.load(std::memory_order_relaxed);
+    auto &registry = call_sites::instance();
+    if (registry.has_logger_rules.load() && target != nullptr)
+    {
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        site_enabled = !opt_in_;
+        for (const auto &rule : registry.rules)
+        {
+            bool rule_matches = rule.logger_name.empty() ? matches_(rule.filename, rule.line) : rule.logger_name == target->name();
+            if (rule_matches)
+            {
+                site_enabled = rule.enabled;
+            }
+        }
+    }
+    // no logger: let the call fail as it did before the cache
+    bool result = site_enabled && (target == nullptr || target->should_log(lvl) || target->should_backtrace());
+    if (cache != nullptr)
+    {
+        cache->generation = &generation;
+        cache->seen_generation = seen_generation;
+        cache->cached_logger = target;
+        cache->cached_level = lvl;
+        cache->enabled = result;
+    }
+    return result;
+}
+
+SPDLOG_INLINE bool call_site::check_key_()
+{
+    if (!registered_.load(std::memory_order_acquire))
+    {
+        register_();
+    }
+    return key_.load(std::memory_order_relaxed) == key_on;
+}
+
+SPDLOG_INLINE void call_site::register_()
+{
+    auto &registry = call_sites::instance();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    if (registered_.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+    for (const auto &rule : registry.rules)
+    {
+        if (!rule.filename.empty() && matches_(rule.filename, rule.line))
+        {
+            enabled_.store(rule.enabled, std::memory_order_relaxed);
+        }
+    }
+    update_key_(registry.any_logger_enabled);
+    registry.sites.push_back(this);
+    registered_.store(true, std::memory_order_release);
+}
+
+// called with the registry mutex locked
+SPDLOG_INLINE void call_site::update_key_(bool any_logger_enabled)
+{
+    if (!opt_in_ || enabled_.load(std::memory_order_relaxed) || any_logger_enabled)
+    {
+        key_.store(key_on, std::memory_order_relaxed);
+    }
+    else
+    {
+        key_.store(key_off, std::memory_order_relaxed);
+    }
+}
+
+// "src/net/server.cpp" matches "server.cpp" and "net/server.cpp", not "ver.cpp"
+SPDLOG_INLINE bool call_site::matches_(const std::string &filename, int line) const
+{
+    if (line > 0 && line != line_)
+    {
+        return false;
+    }
+    string_view_t site_filename(filename_);
+    if (filename.empty() || filename.size() > site_filename.size())
+    {
+        return false;
+    }
+    auto start = site_filename.size() - filename.size();
+    if (string_view_t(site_filename.data() + start, filename.size()) != string_view_t(filename))
+    {
+        return false;
+    }
+    return start == 0 || site_filename.data()[start - 1] == '/' || site_filename.data()[start - 1] == '\\';
+}
+
+SPDLOG_INLINE std::atomic<uint32_t> &call_site::generation_() SPDLOG_NOEXCEPT
+{
+    static std::atomic<uint32_t> s_generation{0};
+    return s_generation;
+}
+
+#ifdef SPDLOG_CALL_SITE_STATS
+SPDLOG_INLINE std::vector<call_site_stats> call_site::top(size_t n)
+{
+    std::vector<call_site_stats> stats;
+    {
+        auto &registry = call_sites::instance();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        for (auto *site : registry.sites)
+        {
+            auto messages = site->messages_.load(std::memory_order_relaxed);
+            call_site_stats site_stats{site->filename_, site->line_, messages, site->bytes_.load(std::memory_order_relaxed)};
+            for (auto *cache = site->counted_caches_; cache != nullptr; cache = cache->next_counted)
+            {
+                site_stats.messages += cache->messages.load(std::memory_order_relaxed);
+                site_stats.bytes += cache->bytes.load(std::memory_order_relaxed);
+            }
+            if (site_stats.messages > 0)
+            {
+                stats.push_back(site_stats);
+            }
+        }
+    }
+    auto by_volume = [](const call_site_stats &a, const call_site_stats &b) {
+        return a.bytes != b.bytes ? a.bytes > b.bytes : a.messages > b.messages;
+    };
+    if (n < stats.size())
+    {
+        std::partial_sort(stats.begin(), stats.begin() + static_cast<std::ptrdiff_t>(n), stats.end(), by_volume);
+        stats.resize(n);
+    }
+    else
+    {
+        std::sort(stats.begin(), stats.end(), by_volume);
+    }
+    return stats;
+}
+
+SPDLOG_INLINE void call_site::register_cache_(call_site_cache *cache)
+{
+    auto &registry = call_sites::instance();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    cache->counted_site = this;
+    cache->next_counted = counted_caches_;
+    counted_caches_ = cache;
+}
+
+// the thread of cache exits: keep its counts
+SPDLOG_INLINE void call_site::retire_cache_(call_site_cache *cache) SPDLOG_NOEXCEPT
+{
+    auto &registry = call_sites::instance();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    auto *site = cache->counted_site;
+    site->messages_.fetch_add(cache->messages.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    site->bytes_.fetch_add(cache->bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    for (auto **link = &site->counted_caches_; *link != nullptr; link = &(*link)->next_counted)
+    {
+        if (*link == cache)
+        {
+            *link = cache->next_counted;
+            break;
+        }
+    }
+}
+
+SPDLOG_INLINE call_site_cache *&call_site_count::current_() SPDLOG_NOEXCEPT
+{
+#    ifndef SPDLOG_NO_TLS
+    static thread_local call_site_cache *current = nullptr;
+#    else
+    static call_site_cache *current = nullptr; // never set: no thread states to count in
+#    endif
+    return current;
+}
+#endif
+
+} // namespace details
+} // namespace spdlog
@@ -0,0 +1,252 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Call sites of the SPDLOG_LOGGER_CALL macros (SPDLOG_INFO(..), SPDLOG_LOGGER_DEBUG(..) ..).
+//
+// Each call site caches, per thread, whether it is enabled for the last logger and level it was called with.
+// The cache is invalidated by a global generation counter, bumped whenever a logger's level could change
+// (set_level() of the loggers and sinks, enable_backtrace(), cfg::load_env_levels() ..): a disabled call costs
+// a thread local read and a predicted branch, without building its source_loc and arguments.
+// Call sites can also be disabled at runtime, by source file and line (see spdlog::set_call_site_enabled())
+// or by logger name (see spdlog::set_logger_call_sites_enabled()).
+//
+// Opt-in call sites (SPDLOG_LOGGER_CALL_OPT_IN, and SPDLOG_TRACE/SPDLOG_DEBUG with SPDLOG_OPT_IN_DEBUG_SITES)
+// are off until enabled that way. They check a static key first - a single relaxed load of a byte, updated
+// eagerly when the rules change - so a disabled one costs a load and a predicted branch, even for the default
+// logger which is not pinned then. Once enabled, they still log only if the logger's level allows it.
+//
+// With SPDLOG_CALL_SITE_STATS, each call site counts the messages it logs and their payload bytes, for
+// spdlog::top_call_sites(). The counts are kept per thread, in the thread's state of the call site: a count is
+// a relaxed increment of a counter written by that thread only. The counts of a thread are folded into the
+// call site's when it exits.
+
+#include <spdlog/common.h>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#ifdef SPDLOG_CALL_SITE_STATS
+#    include <vector>
+#endif
+
+namespace spdlog {
+class logger;
+
+#ifdef SPDLOG_CALL_SITE_STATS
+// the volume logged by a call site so far (see spdlog::top_call_sites())
+struct call_site_stats
+{
+    const char *filename;
+    int line;
+    uint64_t messages;
+    uint64_t bytes; // of the payloads
+};
+#endif
+
+namespace details {
+class call_site;
+
+// per thread state of a call site
+struct call_site_cache
+{
+    const std::atomic<uint32_t> *generation{nullptr}; // set by the first check of the thread
+    uint32_t seen_generation{0};
+    const logger *cached_logger{nullptr};
+    level::level_enum cached_level{level::off};
+    bool enabled{false};
+
+#ifdef SPDLOG_CALL_SITE_STATS
+    // the counts of the thread, written by it only. registered with the call site by the first count.
+    call_site *counted_site{nullptr};
+    call_site_cache *next_counted{nullptr}; // the other threads' states of the call site
+    std::atomic<uint64_t> messages{0};
+    std::atomic<uint64_t> bytes{0};
+
+    call_site_cache() = default;
+    call_site_cache(const call_site_cache &) = delete;
+    call_site_cache &operator=(const call_site_cache &) = delete;
+    ~call_site_cache();
+#endif
+};
+
+class SPDLOG_API call_site
+{
+public:
+    constexpr call_site(const char *filename, int line, bool opt_in = false)
+        : filename_(filename)
+        , line_(line)
+        , opt_in_(opt_in)
+        , enabled_(!opt_in)
+    {}
+    call_site(const call_site &) = delete;
+    call_site &operator=(const call_site &) = delete;
+
+    // true if a message of the given level logged here with the given logger would be processed by it.
+    // cache is the thread's state of this call site, or nullptr (SPDLOG_NO_TLS).
+    bool enabled(const logger *target, level::level_enum lvl, call_site_cache *cache)
+    {
+        if (cache != nullptr && cache->generation != nullptr && cache->cached_logger == target && cache->cached_level == lvl &&
+            cache->generation->load(std::memory_order_relaxed) == cache->seen_generation)
+        {
+            return cache->enabled;
+        }
+        return check_(target, lvl, cache);
+    }
+
+    // the static key of an opt-in call site: false until enabled by set_enabled() or set_logger_enabled().
+    bool key()
+    {
+        auto key = key_.load(std::memory_order_relaxed);
+        if (key == key_off)
+        {
+            return false;
+        }
+        return key == key_on || check_key_();
+    }
+
+    // invalidate the caches of all the call sites
+    static void invalidate_all() SPDLOG_NOEXCEPT;
+
+    // enable/disable the call sites of the given source file (matched against the end of __FILE__),
+    // at the given line or at all lines if line <= 0. Applies to the call sites not reached yet too.
+    static void set_enabled(const std::string &filename, int line, bool enabled);
+
+    // enable/disable the call sites when called with the given logger. Applies after the previous
+    // set_enabled()/set_logger_enabled() calls: the last matching one wins.
+    static void set_logger_enabled(const std::string &logger_name, bool enabled);
+
+#ifdef SPDLOG_CALL_SITE_STATS
+    // the n call sites which logged the most bytes so far (then the most messages), reached or not
+    static std::vector<call_site_stats> top(size_t n);
+#endif
+
+private:
+#ifdef SPDLOG_CALL_SITE_STATS
+    friend class call_site_count;
+    friend struct call_site_cache;
+
+    void register_cache_(call_site_cache *cache);
+    static void retire_cache_(call_site_cache *cache) SPDLOG_NOEXCEPT;
+#endif
+
+    static const uint8_t key_off = 0;
+    static const uint8_t key_on = 1;
+    static const uint8_t key_unchecked = 2; // not registered yet
+
+    bool check_(const logger *target, level::level_enum lvl, call_site_cache *cache);
+    bool check_key_();
+    void register_();
+    void update_key_(bool any_logger_enabled);
+    bool matches_(const std::string &filename, int line) const;
+    static std::atomic<uint32_t> &generation_() SPDLOG_NOEXCEPT;
+
+    const char *filename_;
+    int line_;
+    bool opt_in_;
+    std::atomic<bool> enabled_; // by the set_enabled() rules
+    std::atomic<bool> registered_{false};
+    std::atomic<uint8_t> key_{key_unchecked};
+#ifdef SPDLOG_CALL_SITE_STATS
+    // the counts of the exited threads (or of all with SPDLOG_NO_TLS), and the states of the running ones
+    std::atomic<uint64_t> messages_{0};
+    std::atomic<uint64_t> bytes_{0};
+    call_site_cache *counted_caches_{nullptr}; // with the registry mutex
+#endif
+};
+
+#ifdef SPDLOG_CALL_SITE_STATS
+inline call_site_cache::~call_site_cache()
+{
+    if (counted_site != nullptr)
+    {
+        call_site::retire_cache_(this);
+    }
+}
+
+// counts a call of a site, and the payload it logs (see count_payload()), for the scope of the call.
+// cache is the thread's state of the call site, or nullptr (SPDLOG_NO_TLS: the payloads are not counted).
+class SPDLOG_API call_site_count
+{
+public:
+    call_site_count(call_site &site, call_site_cache *cache)
+        : cache_(cache)
+    {
+        if (cache == nullptr)
+        {
+            site.messages_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        if (cache->counted_site == nullptr)
+        {
+            site.register_cache_(cache);
+        }
+        cache->messages.store(cache->messages.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        previous_ = current_();
+        current_() = cache;
+    }
+
+    call_site_count(const call_site_count &) = delete;
+    call_site_count &operator=(const call_site_count &) = delete;
+
+    ~call_site_count()
+    {
+        if (cache_ != nullptr)
+        {
+            current_() = previous_;
+        }
+    }
+
+    // add to the bytes of the call counted by this thread, if any. called by the logger.
+    static void count_payload(size_t size)
+    {
+        auto *cache = current_();
+        if (cache != nullptr)
+        {
+            cache->bytes.store(cache->bytes.load(std::memory_order_relaxed) + size, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    call_site_cache *cache_;
+    call_site_cache *previous_ = nullptr; // the outer counted call of the thread, if any
+    // the call counted by this thread (out of line: one for all the modules)
+    static call_site_cache *&current_() SPDLOG_NOEXCEPT;
+};
+#endif
+
+// the SPDLOG_MODULE_LEVEL check of the macros: a constant for the constant levels, so that the optimizer drops
+// the calls below the module level (their call sites, arguments and format strings)
+constexpr bool module_allows(level::level_enum lvl, int module_level)
+{
+    return static_cast<int>(lvl) >= module_level;
+}
+
+// the logger pointed by the logger argument of the macros (raw pointer, shared_ptr, pinned_logger ..)
+template<typename T>
+const logger *call_site_logger(const T &target)
+{
+    return &*target;
+}
+
+} // namespace details
+} // namespace spdlog
+
+#ifndef SPDLOG_NO_TLS
+#    define SPDLOG_CALL_SITE_CACHE(name)                                                                                                   \
+        static thread_local spdlog::details::call_site_cache name##_tls_;                                                                  \
+        spdlog::details::call_site_cache *name = &name##_tls_
+#else
+#    define SPDLOG_CALL_SITE_CACHE(name) spdlog::details::call_site_cache *name = nullptr
+#endif
+
+#ifdef SPDLOG_CALL_SITE_STATS
+#    define SPDLOG_CALL_SITE_COUNT(site, cache) spdlog::details::call_site_count spdlog_call_site_count_(site, cache)
+#else
+#    define SPDLOG_CALL_SITE_COUNT(site, cache) (void)0
+#endif
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "call_site-inl.h"
+#endif
@@ -0,0 +1,57 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Throttles of the SPDLOG_LOGGER_CALL_EVERY_N / SPDLOG_LOGGER_CALL_EVERY_MS macros (SPDLOG_INFO_EVERY_N(..) ..).
+// One per call site, checked after the level and before the message is formatted (or its arguments evaluated):
+// a throttled call costs an atomic increment (every_n) or a clock read (every_interval).
+
+#include <spdlog/common.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+
+namespace spdlog {
+namespace details {
+
+// let through the 1st call, then one call out of n
+class every_n_throttle
+{
+public:
+    bool allow(uint64_t n)
+    {
+        return n <= 1 || count_.fetch_add(1, std::memory_order_relaxed) % n == 0;
+    }
+
+private:
+    std::atomic<uint64_t> count_{0};
+};
+
+// let through the 1st call, then at most one call per interval
+class every_interval_throttle
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    bool allow(std::chrono::nanoseconds interval)
+    {
+        auto now = clock::now().time_since_epoch().count();
+        auto next = next_.load(std::memory_order_relaxed);
+        if (now < next)
+        {
+            return false;
+        }
+        // a single thread wins the slot
+        auto step = std::chrono::duration_cast<clock::duration>(interval).count();
+        return next_.compare_exchange_strong(next, now + step, std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<clock::rep> next_{(std::numeric_limits<clock::rep>::min)()};
+};
+
+} // namespace details
+} // namespace spdlog
@@ -4,19 +4,29 @@
 // circular q view of std::vector.
 #pragma once
 
+#include <spdlog/common.h>
+#include <spdlog/details/page_memory.h>
+
 #include <vector>
 #include <cassert>
 
 namespace spdlog {
 namespace details {
+// the storage is rounded up to a power of two, indexed by masking free running positions, and the
+// producer and consumer positions sit on cache lines of their own.
 template<typename T>
 class circular_q
 {
     size_t max_items_ = 0;
-    typename std::vector<T>::size_type head_ = 0;
-    typename std::vector<T>::size_type tail_ = 0;
+    size_t mask_ = 0;
+    std::vector<T, page_allocator<T>> v_;
+    char padding0_[SPDLOG_CACHE_LINE_SIZE];
+    // producer side
+    size_t tail_ = 0;
     size_t overrun_counter_ = 0;
-    std::vector<T> v_;
+    char padding1_[SPDLOG_CACHE_LINE_SIZE];
+    // consumer side
+    size_t head_ = 0;
 
 public:
     using value_type = T;
@@ -24,10 +34,14 @@ public:
     // empty ctor - create a disabled queue with no elements allocated at all
     circular_q() = default;
 
-    explicit circular_q(size_t max_items)
-        : max_items_(max_items + 1) // one item is reserved as marker for full q
-        , v_(max_items_)
-    {}
+    // the storage is allocated per pages (see page_memory.h)
+    explicit circular_q(size_t max_items, const page_options &pages = page_options())
+        : max_items_(max_items)
+        , mask_(round_up_pow2_(max_items) - 1)
+        , v_(page_allocator<T>(pages))
+    {
+        v_.resize(mask_ + 1);
+    }
 
     circular_q(const circular_q &) = default;
     circular_q &operator=(const circular_q &) = default;
@@ -48,16 +62,19 @@ public:
     // push back, overrun (oldest) item if no room left
     void push_back(T &&item)
     {
-        if (max_items_ > 0)
+        if (!v_.empty())
         {
-            v_[tail_] = std::move(item);
-            tail_ = (tail_ + 1) % max_items_;
-
-            if (tail_ == head_) // overrun last item if full
+            if (full()) // overrun last item if full
             {
-                head_ = (head_ + 1) % max_items_;
                 ++overrun_counter_;
+                if (max_items_ == 0)
+                {
+                    return;
+                }
+                ++head_;
             }
+            v_[tail_ & mask_] = std::move(item);
+            ++tail_;
         }
     }
 
@@ -65,25 +82,18 @@ public:
     // If there are no elements in the container, the behavior is undefined.
     const T &front() const
     {
-        return v_[head_];
+        return v_[head_ & mask_];
     }
 
     T &front()
     {
-        return v_[head_];
+        return v_[head_ & mask_];
     }
 
     // Return number of elements actually stored
     size_t size() const
     {
-        if (tail_ >= head_)
-        {
-            return tail_ - head_;
-        }
-        else
-        {
-            return max_items_ - (head_ - tail_);
-        }
+        return tail_ - head_;
     }
 
     // Return const reference to item by index.
@@ -91,14 +101,27 @@ public:
     const T &at(size_t i) const
     {
         assert(i < size());
-        return v_[(head_ + i) % max_items_];
+        return v_[(head_ + i) & mask_];
     }
 
     // Pop item from front.
     // If there are no elements in the container, the behavior is undefined.
     void pop_front()
     {
-        head_ = (head_ + 1) % max_items_;
+        ++head_;
+    }
+
+    // Drop the item at index i, moving the items before it one place ahead, counted as an overrun.
+    // If index is out of range 0…size()-1, the behavior is undefined.
+    void overrun_at(size_t i)
+    {
+        assert(i < size());
+        for (size_t j = i; j > 0; j--)
+        {
+            v_[(head_ + j) & mask_] = std::move(v_[(head_ + j - 1) & mask_]);
+        }
+        ++head_;
+        ++overrun_counter_;
     }
 
     bool empty() const
@@ -108,12 +131,7 @@ public:
 
     bool full() const
     {
-        // head is ahead of the tail by 1
-        if (max_items_ > 0)
-        {
-            return ((tail_ + 1) % max_items_) == head_;
-        }
-        return false;
+        return !v_.empty() && size() == max_items_;
     }
 
     size_t overrun_counter() const
@@ -126,16 +144,29 @@ private:
     void copy_moveable(circular_q &&other) SPDLOG_NOEXCEPT
     {
         max_items_ = other.max_items_;
+        mask_ = other.mask_;
         head_ = other.head_;
         tail_ = other.tail_;
         overrun_counter_ = other.overrun_counter_;
         v_ = std::move(other.v_);
+        other.v_.clear();
 
         // put &&other in disabled, but valid state
         other.max_items_ = 0;
+        other.mask_ = 0;
         other.head_ = other.tail_ = 0;
         other.overrun_counter_ = 0;
     }
+
+    static size_t round_up_pow2_(size_t n)
+    {
+        size_t rounded = 1;
+        while (rounded < n)
+        {
+            rounded <<= 1;
+        }
+        return rounded;
+    }
 };
 } // namespace details
 } // namespace spdlog
@@ -0,0 +1,126 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Escaping of the control chars of a payload, so that it stays on one line (the %V pattern flag): \n, \r and \t
+// become "\\n", "\\r" and "\\t", the other control chars (below 0x20, and 0x7f) "\\x" and two hex digits.
+// The other bytes (utf-8 included) are kept as is. The text is scanned for control chars 16 bytes at a time with
+// SSE2 or NEON, 8 at a time otherwise: the runs without any are appended in one go.
+
+#include <spdlog/common.h>
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    include <emmintrin.h>
+#    define SPDLOG_ESCAPE_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#    include <arm_neon.h>
+#    define SPDLOG_ESCAPE_NEON
+#endif
+
+namespace spdlog {
+namespace details {
+
+inline bool is_control_char(unsigned char c)
+{
+    return c < 0x20 || c == 0x7f;
+}
+
+// index of the first control char of data[0, size), size if none
+inline size_t find_control_char(const char *data, size_t size)
+{
+    size_t i = 0;
+#if defined(SPDLOG_ESCAPE_SSE2)
+    const __m128i max_control = _mm_set1_epi8(0x1f);
+    const __m128i del = _mm_set1_epi8(0x7f);
+    for (; i + 16 <= size; i += 16)
+    {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        // unsigned bytes <= 0x1f: min(bytes, 0x1f) == bytes
+        __m128i control = _mm_or_si128(_mm_cmpeq_epi8(_mm_min_epu8(bytes, max_control), bytes), _mm_cmpeq_epi8(bytes, del));
+        if (_mm_movemask_epi8(control) != 0)
+        {
+            break;
+        }
+    }
+#elif defined(SPDLOG_ESCAPE_NEON)
+    const uint8x16_t min_printable = vdupq_n_u8(0x20);
+    const uint8x16_t del = vdupq_n_u8(0x7f);
+    for (; i + 16 <= size; i += 16)
+    {
+        uint8x16_t bytes = vld1q_u8(reinterpret_cast<const uint8_t *>(data + i));
+        uint8x16_t control = vorrq_u8(vcltq_u8(bytes, min_printable), vceqq_u8(bytes, del));
+        if (vmaxvq_u8(control) != 0)
+        {
+            break;
+        }
+    }
+#endif
+    // the tail, or the chunk with the hit
+    const uint64_t ones = 0x0101010101010101ULL;
+    const uint64_t highs = 0x8080808080808080ULL;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+    {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        uint64_t del_bytes = word ^ (ones * 0x7f);
+        if ((((word - ones * 0x20) & ~word) | ((del_bytes - ones) & ~del_bytes)) & highs)
+        {
+            break;
+        }
+    }
+    for (; i < size; i++)
+    {
+        if (is_control_char(static_cast<unsigned char>(data[i])))
+        {
+            return i;
+        }
+    }
+    return size;
+}
+
+inline void append_escaped_control(unsigned char c, memory_buf_t &dest)
+{
+    switch (c)
+    {
+    case '\n':
+        dest.append("\\n", "\\n" + 2);
+        break;
+    case '\r':
+        dest.append("\\r", "\\r" + 2);
+        break;
+    case '\t':
+        dest.append("\\t", "\\t" + 2);
+        break;
+    default: {
+        static const char hex_digits[] = "0123456789abcdef";
+        const char escaped[] = {'\\', 'x', hex_digits[c >> 4], hex_digits[c & 0xf]};
+        dest.append(escaped, escaped + sizeof(escaped));
+        break;
+    }
+    }
+}
+
+inline void escape_control_chars(string_view_t text, memory_buf_t &dest)
+{
+    const char *data = text.data();
+    const size_t size = text.size();
+    size_t start = 0;
+    for (;;)
+    {
+        size_t hit = start + find_control_char(data + start, size - start);
+        dest.append(data + start, data + hit);
+        if (hit == size)
+        {
+            return;
+        }
+        append_escaped_control(static_cast<unsigned char>(data[hit]), dest);
+        start = hit + 1;
+    }
+}
+
+} // namespace details
+} // namespace spdlog
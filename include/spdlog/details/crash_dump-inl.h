@@ -0,0 +1,146 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/details/crash_dump.h>
+#endif
+
+#include <chrono>
+#include <cstring>
+
+#ifdef _WIN32
+#    include <io.h> // for _write
+#else
+#    include <unistd.h>
+#endif
+
+namespace spdlog {
+namespace details {
+
+SPDLOG_INLINE crash_writer::crash_writer(int fd) SPDLOG_NOEXCEPT : fd_(fd) {}
+
+SPDLOG_INLINE crash_writer::~crash_writer()
+{
+    flush();
+}
+
+SPDLOG_INLINE void crash_writer::write(string_view_t text) SPDLOG_NOEXCEPT
+{
+    const char *data = text.data();
+    size_t remaining = text.size();
+    while (remaining > 0)
+    {
+        if (size_ == sizeof(buf_))
+        {
+            flush();
+        }
+        size_t n = remaining < sizeof(buf_) - size_ ? remaining : sizeof(buf_) - size_;
+        std::memcpy(buf_ + size_, data, n);
+        size_ += n;
+        data += n;
+        remaining -= n;
+    }
+}
+
+SPDLOG_INLINE void crash_writer::write_uint(uint64_t value) SPDLOG_NOEXCEPT
+{
+    char digits[20];
+    size_t n = 0;
+    do
+    {
+        digits[sizeof(digits) - 1 - n++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    write(string_view_t(digits + sizeof(digits) - n, n));
+}
+
+SPDLOG_INLINE void crash_writer::write_msg(const log_msg &msg) SPDLOG_NOEXCEPT
+{
+    auto since_epoch = std::chrono::duration_cast<std::chrono::nanoseconds>(msg.time.time_since_epoch()).count();
+    auto ns = static_cast<uint64_t>(since_epoch < 0 ? 0 : since_epoch);
+    write_uint(ns / 1000000000);
+    write(".");
+    auto fraction = ns % 1000000000;
+    for (uint64_t scale = 100000000; scale > fraction && scale > 1; scale /= 10)
+    {
+        write("0");
+    }
+    write_uint(fraction);
+    write(" [");
+    write(msg.logger_name);
+    write("] [");
+    write(level::to_string_view(msg.level));
+    write("] ");
+    write(msg.payload);
+    write("\n");
+}
+
+SPDLOG_INLINE void crash_writer::flush() SPDLOG_NOEXCEPT
+{
+    const char *data = buf_;
+    while (size_ > 0)
+    {
+#ifdef _WIN32
+        auto written = ::_write(fd_, data, static_cast<unsigned int>(size_));
+#else
+        auto written = ::write(fd_, data, size_);
+#endif
+        if (written <= 0)
+        {
+            break;
+        }
+        data += written;
+        size_ -= static_cast<size_t>(written);
+    }
+    size_ = 0;
+}
+
+SPDLOG_INLINE crash_dump_sources &crash_dump_sources::instance()
+{
+    static crash_dump_sources sources;
+    return sources;
+}
+
+SPDLOG_INLINE void crash_dump_sources::add(const void *object, crash_dump_fn fn)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto &s : sources_)
+    {
+        if (s.object.load(std::memory_order_relaxed) == nullptr)
+        {
+            s.fn.store(fn, std::memory_order_relaxed);
+            s.object.store(object, std::memory_order_release);
+            return;
+        }
+    }
+}
+
+SPDLOG_INLINE void crash_dump_sources::remove(const void *object)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto &s : sources_)
+    {
+        if (s.object.load(std::memory_order_relaxed) == object)
+        {
+            s.object.store(nullptr, std::memory_order_release);
+            return;
+        }
+    }
+}
+
+SPDLOG_INLINE void crash_dump_sources::dump(crash_writer &writer) const SPDLOG_NOEXCEPT
+{
+    for (auto &s : sources_)
+    {
+        auto *object = s.object.load(std::memory_order_acquire);
+        if (object != nullptr)
+        {
+            s.fn.load(std::memory_order_relaxed)(object, writer);
+        }
+    }
+}
+
+} // namespace details
+} // namespace spdlog
@@ -0,0 +1,77 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Building blocks of the crash dump (see spdlog/crash_dump.h), usable from a signal handler:
+// crash_writer buffers its output on the stack and writes it with write(2), and the sources
+// of the dump are kept in a fixed table of atomics, read without locks.
+
+#include <spdlog/common.h>
+#include <spdlog/details/log_msg.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+namespace spdlog {
+namespace details {
+
+// writes log messages to a file descriptor, calling only async-signal-safe functions
+class SPDLOG_API crash_writer
+{
+public:
+    explicit crash_writer(int fd) SPDLOG_NOEXCEPT;
+    ~crash_writer();
+
+    crash_writer(const crash_writer &) = delete;
+    crash_writer &operator=(const crash_writer &) = delete;
+
+    void write(string_view_t text) SPDLOG_NOEXCEPT;
+    void write_uint(uint64_t value) SPDLOG_NOEXCEPT;
+    // "<seconds since epoch>.<nanoseconds> [<logger name>] [<level>] <payload>\n", the payload
+    // unformatted if the message is formatted later (deferred, see deferred_format.h)
+    void write_msg(const log_msg &msg) SPDLOG_NOEXCEPT;
+    void flush() SPDLOG_NOEXCEPT;
+
+private:
+    int fd_;
+    size_t size_ = 0;
+    char buf_[1024];
+};
+
+// a source of the crash dump: fn writes the messages object holds
+using crash_dump_fn = void (*)(const void *object, crash_writer &writer);
+
+class SPDLOG_API crash_dump_sources
+{
+public:
+    static const size_t max_sources = 256;
+
+    static crash_dump_sources &instance();
+
+    // ignored past max_sources
+    void add(const void *object, crash_dump_fn fn);
+    void remove(const void *object);
+
+    // lock free (the sources removed meanwhile may still be written)
+    void dump(crash_writer &writer) const SPDLOG_NOEXCEPT;
+
+private:
+    struct source
+    {
+        std::atomic<const void *> object{nullptr};
+        std::atomic<crash_dump_fn> fn{nullptr};
+    };
+
+    std::mutex mutex_; // add() and remove()
+    std::array<source, max_sources> sources_;
+};
+
+} // namespace details
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "crash_dump-inl.h"
+#endif
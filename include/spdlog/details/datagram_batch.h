@@ -0,0 +1,87 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Formatted messages packed into datagrams of up to max_size bytes, stored back to back in a single buffer.
+// Used by the datagram sinks (udp, unix socket) to send a batch of datagrams with a single system call.
+
+#include <spdlog/common.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace spdlog {
+namespace details {
+
+class datagram_batch
+{
+public:
+    explicit datagram_batch(size_t max_size)
+        : max_size_((std::max)(max_size, size_t(1)))
+    {}
+
+    // append to the last datagram if it fits, else start a new one. longer messages are truncated.
+    void append(const char *data, size_t size)
+    {
+        size = (std::min)(size, max_size_);
+        if (needs_new_datagram(size))
+        {
+            ends_.push_back(buffer_.size());
+        }
+        buffer_.append(data, data + size);
+        ends_.back() = buffer_.size();
+    }
+
+    // append as a datagram of its own (truncated to max_size)
+    void append_datagram(const char *data, size_t size)
+    {
+        size = (std::min)(size, max_size_);
+        buffer_.append(data, data + size);
+        ends_.push_back(buffer_.size());
+    }
+
+    // true if appending this many bytes would start a new datagram
+    bool needs_new_datagram(size_t size) const
+    {
+        size = (std::min)(size, max_size_);
+        auto n_datagrams = ends_.size();
+        auto begin = n_datagrams < 2 ? size_t(0) : ends_[n_datagrams - 2];
+        return n_datagrams == 0 || buffer_.size() - begin + size > max_size_;
+    }
+
+    const char *data() const
+    {
+        return buffer_.data();
+    }
+
+    // where each datagram ends in data()
+    const size_t *ends() const
+    {
+        return ends_.data();
+    }
+
+    size_t size() const
+    {
+        return ends_.size();
+    }
+
+    bool empty() const
+    {
+        return ends_.empty();
+    }
+
+    void clear()
+    {
+        buffer_.clear();
+        ends_.clear();
+    }
+
+private:
+    size_t max_size_;
+    memory_buf_t buffer_;
+    std::vector<size_t> ends_;
+};
+
+} // namespace details
+} // namespace spdlog
@@ -0,0 +1,55 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Support for formatting a message later (e.g. on the async thread pool) instead of
+// on the calling thread.
+// Only arguments that fmt stores by value (arithmetic types) are eligible, so the
+// captured arguments can be copied around as plain bytes and stay valid after the
+// caller returns. Messages with any other argument type are formatted eagerly.
+
+#include <spdlog/common.h>
+
+#include <type_traits>
+#include <utility>
+
+#ifndef SPDLOG_DEFERRED_ARGS_SIZE
+#    define SPDLOG_DEFERRED_ARGS_SIZE 128
+#endif
+
+namespace spdlog {
+namespace details {
+
+// format the captured arguments with the given format string into dest
+using deferred_format_fn = void (*)(memory_buf_t &dest, string_view_t fmt, const void *args);
+
+template<typename... Ts>
+struct all_arithmetic : std::true_type
+{};
+
+template<typename T, typename... Ts>
+struct all_arithmetic<T, Ts...>
+    : std::integral_constant<bool, std::is_arithmetic<remove_cvref_t<T>>::value && all_arithmetic<Ts...>::value>
+{};
+
+template<typename... Args>
+struct deferred_format
+{
+    // fmt's argument store - holds the argument values themselves for arithmetic types
+    using store_type = decltype(fmt::make_format_args(std::declval<Args &>()...));
+
+    static SPDLOG_CONSTEXPR bool eligible = all_arithmetic<Args...>::value && std::is_trivially_copyable<store_type>::value &&
+                                            sizeof(store_type) <= SPDLOG_DEFERRED_ARGS_SIZE;
+
+    static void format(memory_buf_t &dest, string_view_t fmt, const void *args)
+    {
+        fmt::detail::vformat_to(dest, fmt, fmt::format_args(*static_cast<const store_type *>(args)));
+    }
+};
+
+template<typename... Args>
+SPDLOG_CONSTEXPR bool deferred_format<Args...>::eligible;
+
+} // namespace details
+} // namespace spdlog
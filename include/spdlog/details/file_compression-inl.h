@@ -0,0 +1,164 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/details/file_compression.h>
+#endif
+
+#include <spdlog/details/os.h>
+
+#include <cstdio>
+
+#ifdef SPDLOG_ZLIB
+#    include <cerrno>
+#    include <vector>
+#    include <zlib.h>
+#endif
+
+namespace spdlog {
+namespace details {
+namespace file_compression {
+
+SPDLOG_INLINE bool supported() SPDLOG_NOEXCEPT
+{
+#ifdef SPDLOG_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+SPDLOG_INLINE filename_t compressed_filename(const filename_t &filename)
+{
+    return filename + SPDLOG_FILENAME_T(".gz");
+}
+
+#ifdef SPDLOG_ZLIB
+// RAII over the files and the zlib stream of compress_file(). The target is removed unless completed.
+struct gzip_state
+{
+    std::FILE *src{nullptr};
+    std::FILE *target{nullptr};
+    filename_t target_filename;
+    z_stream stream{};
+    bool stream_initialized{false};
+
+    ~gzip_state()
+    {
+        if (stream_initialized)
+        {
+            deflateEnd(&stream);
+        }
+        if (src != nullptr)
+        {
+            std::fclose(src);
+        }
+        if (target != nullptr)
+        {
+            std::fclose(target);
+            (void)os::remove(target_filename);
+        }
+    }
+};
+#endif
+
+SPDLOG_INLINE void compress_file(const filename_t &filename)
+{
+#ifdef SPDLOG_ZLIB
+    gzip_state state;
+    auto &target_filename = state.target_filename;
+    target_filename = compressed_filename(filename);
+    if (os::fopen_s(&state.src, filename, SPDLOG_FILENAME_T("rb")))
+    {
+        throw_spdlog_ex("Failed opening file " + os::filename_to_str(filename) + " for reading", errno);
+    }
+    if (os::fopen_s(&state.target, target_filename, SPDLOG_FILENAME_T("wb")))
+    {
+        throw_spdlog_ex("Failed opening file " + os::filename_to_str(target_filename) + " for writing", errno);
+    }
+    // window bits + 16: gzip header and trailer, readable by gzip/zcat
+    if (deflateInit2(&state.stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+        throw_spdlog_ex("Failed initializing zlib");
+    }
+    state.stream_initialized = true;
+
+    std::vector<unsigned char> in(64 * 1024);
+    std::vector<unsigned char> out(64 * 1024);
+    int flush = Z_NO_FLUSH;
+    while (flush != Z_FINISH)
+    {
+        auto n_read = std::fread(in.data(), 1, in.size(), state.src);
+        if (std::ferror(state.src))
+        {
+            throw_spdlog_ex("Failed reading file " + os::filename_to_str(filename), errno);
+        }
+        flush = std::feof(state.src) ? Z_FINISH : Z_NO_FLUSH;
+        state.stream.next_in = in.data();
+        state.stream.avail_in = static_cast<uInt>(n_read);
+        do
+        {
+            state.stream.next_out = out.data();
+            state.stream.avail_out = static_cast<uInt>(out.size());
+            deflate(&state.stream, flush); // no bad return value with valid buffers
+            auto n_out = out.size() - state.stream.avail_out;
+            if (std::fwrite(out.data(), 1, n_out, state.target) != n_out)
+            {
+                throw_spdlog_ex("Failed writing to file " + os::filename_to_str(target_filename), errno);
+            }
+        } while (state.stream.avail_out == 0);
+    }
+
+    auto *target = state.target;
+    state.target = nullptr;
+    if (std::fclose(target) != 0)
+    {
+        (void)os::remove(target_filename);
+        throw_spdlog_ex("Failed writing to file " + os::filename_to_str(target_filename), errno);
+    }
+    std::fclose(state.src);
+    state.src = nullptr;
+    if (os::remove(filename) != 0)
+    {
+        throw_spdlog_ex("Failed removing file " + os::filename_to_str(filename), errno);
+    }
+#else
+    throw_spdlog_ex("Failed compressing file " + os::filename_to_str(filename) + ": spdlog was built without SPDLOG_ZLIB");
+#endif
+}
+
+SPDLOG_INLINE void compress_buffer(string_view_t data, memory_buf_t &out)
+{
+#ifdef SPDLOG_ZLIB
+    z_stream stream{};
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+        throw_spdlog_ex("Failed initializing zlib");
+    }
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    auto offset = out.size();
+    out.resize(offset + deflateBound(&stream, static_cast<uLong>(data.size())));
+    stream.next_out = reinterpret_cast<Bytef *>(out.data() + offset);
+    stream.avail_out = static_cast<uInt>(out.size() - offset);
+    // a single call: the output is bounded by deflateBound()
+    auto result = deflate(&stream, Z_FINISH);
+    out.resize(offset + stream.total_out);
+    deflateEnd(&stream);
+    if (result != Z_STREAM_END)
+    {
+        out.resize(offset);
+        throw_spdlog_ex("Failed compressing buffer");
+    }
+#else
+    (void)data;
+    (void)out;
+    throw_spdlog_ex("Failed compressing buffer: spdlog was built without SPDLOG_ZLIB");
+#endif
+}
+
+} // namespace file_compression
+} // namespace details
+} // namespace spdlog
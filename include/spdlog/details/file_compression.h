@@ -0,0 +1,35 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// gzip compression of closed log files, used by the rotating file sinks (SPDLOG_ZLIB).
+// The sinks run it on their background worker - never on the logging threads.
+// compress_buffer() gzips a buffer in memory (e.g. the requests of the otlp sink).
+
+#include <spdlog/common.h>
+
+namespace spdlog {
+namespace details {
+namespace file_compression {
+
+// false if spdlog was built without SPDLOG_ZLIB
+SPDLOG_API bool supported() SPDLOG_NOEXCEPT;
+
+// "logs/mylog.txt" => "logs/mylog.txt.gz"
+SPDLOG_API filename_t compressed_filename(const filename_t &filename);
+
+// compress the given file to compressed_filename(filename) and remove it.
+// Throw spdlog_ex on failure (the file is kept then).
+SPDLOG_API void compress_file(const filename_t &filename);
+
+// append the gzip of data to out. Throw spdlog_ex on failure or without SPDLOG_ZLIB.
+SPDLOG_API void compress_buffer(string_view_t data, memory_buf_t &out);
+
+} // namespace file_compression
+} // namespace details
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "file_compression-inl.h"
+#endif
@@ -7,19 +7,45 @@
 #    include <spdlog/details/file_helper.h>
 #endif
 
+#include <spdlog/details/background_worker.h>
+#include <spdlog/details/file_syncer.h>
+#include <spdlog/details/frame_compressor.h>
 #include <spdlog/details/os.h>
+#include <spdlog/details/time_index.h>
 #include <spdlog/common.h>
 
+#ifdef SPDLOG_IO_URING
+#    include <spdlog/details/uring_file_writer.h>
+#endif
+
 #include <cerrno>
 #include <chrono>
 #include <cstdio>
 #include <string>
 #include <thread>
 #include <tuple>
+#include <utility>
 
 namespace spdlog {
 namespace details {
 
+SPDLOG_INLINE file_helper::file_helper(size_t write_buffer_size, bool drop_page_cache)
+    : write_buffer_size_(write_buffer_size)
+    , drop_page_cache_(drop_page_cache)
+{
+    if (write_buffer_size_ > 0)
+    {
+#ifdef SPDLOG_IO_URING
+        uring_writer_ = uring_file_writer::create(write_buffer_size_);
+        if (uring_writer_)
+        {
+            return;
+        }
+#endif
+        write_buffer_.reserve(write_buffer_size_);
+    }
+}
+
 SPDLOG_INLINE file_helper::~file_helper()
 {
     close();
@@ -29,7 +55,370 @@ SPDLOG_INLINE void file_helper::open(const filename_t &fname, bool truncate)
 {
     close();
     filename_ = fname;
+    auto *fd = open_file_(fname, truncate);
+    if (fd == nullptr)
+    {
+        throw_spdlog_ex("Failed opening file " + os::filename_to_str(filename_) + " for writing", errno);
+    }
+    attach_(fd);
+}
+
+SPDLOG_INLINE void file_helper::reopen(bool truncate)
+{
+    if (filename_.empty())
+    {
+        throw_spdlog_ex("Failed re opening file - was not opened before");
+    }
+    this->open(filename_, truncate);
+}
+
+SPDLOG_INLINE void file_helper::open_in_background(const filename_t &fname, bool truncate, size_t max_pending)
+{
+    // one at a time
+    complete_open_(true);
+    auto *previous = detach_();
+    filename_ = fname;
+    if (!open_worker_)
+    {
+        open_worker_ = details::make_unique<background_worker>();
+    }
+    opening_ = true;
+    open_done_.store(false, std::memory_order_relaxed);
+    pending_.clear();
+    max_pending_ = max_pending;
+    open_worker_->post([this, previous, fname, truncate] {
+        if (previous != nullptr)
+        {
+            std::fclose(previous);
+        }
+        opened_fd_ = open_file_(fname, truncate);
+        open_errno_ = errno;
+        open_done_.store(true, std::memory_order_release);
+    });
+}
+
+SPDLOG_INLINE void file_helper::reopen_in_background(bool truncate, size_t max_pending)
+{
+    if (filename_.empty())
+    {
+        throw_spdlog_ex("Failed re opening file - was not opened before");
+    }
+    open_in_background(filename_, truncate, max_pending);
+}
+
+SPDLOG_INLINE void file_helper::flush()
+{
+    complete_open_(false);
+    if (opening_ || durability_ == file_durability::none)
+    {
+        return; // nothing written yet
+    }
+    if (compressor_)
+    {
+        finish_frame_();
+    }
+    write_buffer_to_file_();
+    std::fflush(fd_);
+    if (durability_ == file_durability::sync)
+    {
+        auto err = os::sync_file_data(::fileno(fd_));
+        if (err != 0)
+        {
+            throw_spdlog_ex("Failed syncing file " + os::filename_to_str(filename_), err);
+        }
+    }
+    else if (durability_ == file_durability::group_commit)
+    {
+        syncer_->request();
+    }
+}
+
+SPDLOG_INLINE void file_helper::close()
+{
+    SPDLOG_TRY
+    {
+        complete_open_(true);
+    }
+    SPDLOG_CATCH_STD
+    auto *fd = detach_();
+    if (fd != nullptr)
+    {
+        std::fclose(fd);
+    }
+}
+
+SPDLOG_INLINE void file_helper::write(const memory_buf_t &buf)
+{
+    write(string_view_t(buf.data(), buf.size()));
+}
+
+SPDLOG_INLINE void file_helper::write(string_view_t data)
+{
+    if (opening_)
+    {
+        complete_open_(false);
+        if (opening_)
+        {
+            if (pending_.size() + data.size() <= max_pending_)
+            {
+                pending_.append(data.data(), data.data() + data.size());
+            }
+            return;
+        }
+    }
+    if (compressor_)
+    {
+        compressed_.clear();
+        compressor_->write(data, compressed_);
+        if (compressed_.size() > 0)
+        {
+            write_data_(string_view_t(compressed_.data(), compressed_.size()));
+        }
+        return;
+    }
+    write_data_(data);
+}
+
+SPDLOG_INLINE void file_helper::write(const string_view_t *parts, size_t n_parts)
+{
+    constexpr size_t max_parts = 8;
+    size_t size = 0;
+    for (size_t i = 0; i < n_parts; i++)
+    {
+        size += parts[i].size();
+    }
+    bool gather = !opening_ && fd_ != nullptr && !compressor_ && n_parts < max_parts;
+#ifdef SPDLOG_IO_URING
+    gather = gather && !uring_writer_;
+#endif
+    if (!gather || (write_buffer_size_ > 0 && write_buffer_.size() + size <= write_buffer_size_))
+    {
+        for (size_t i = 0; i < n_parts; i++)
+        {
+            write(parts[i]);
+        }
+        return;
+    }
+    count_written_(size);
+    // the buffered data first, in the same call
+    string_view_t gathered[max_parts];
+    size_t n_gathered = 0;
+    if (write_buffer_.size() > 0)
+    {
+        gathered[n_gathered++] = string_view_t(write_buffer_.data(), write_buffer_.size());
+    }
+    for (size_t i = 0; i < n_parts; i++)
+    {
+        gathered[n_gathered++] = parts[i];
+    }
+    if (std::fflush(fd_) != 0)
+    {
+        throw_spdlog_ex("Failed writing to file " + os::filename_to_str(filename_), errno);
+    }
+    auto err = os::write_gather(::fileno(fd_), gathered, n_gathered);
+    // cleared either way - the data is not written twice if the write fails
+    write_buffer_.clear();
+    if (err != 0)
+    {
+        throw_spdlog_ex("Failed writing to file " + os::filename_to_str(filename_), err);
+    }
+}
+
+SPDLOG_INLINE void file_helper::count_written_(size_t size)
+{
+    if (drop_page_cache_ && !no_page_cache_)
+    {
+        // counted before writing: the pages are dropped after size more bytes at most
+        written_since_drop_ += size;
+        if (written_since_drop_ >= page_cache_drop_interval)
+        {
+            drop_written_pages_();
+        }
+    }
+}
+
+SPDLOG_INLINE void file_helper::write_data_(string_view_t data)
+{
+    count_written_(data.size());
+#ifdef SPDLOG_IO_URING
+    if (uring_writer_)
+    {
+        auto err = uring_writer_->write(data.data(), data.size());
+        if (err != 0)
+        {
+            throw_spdlog_ex("Failed writing to file " + os::filename_to_str(filename_), err);
+        }
+        return;
+    }
+#endif
+    if (write_buffer_size_ == 0)
+    {
+        write_file_(data.data(), data.size());
+        return;
+    }
+    if (write_buffer_.size() + data.size() > write_buffer_size_)
+    {
+        write_buffer_to_file_();
+    }
+    // data that doesn't fit in the buffer at all is written as is
+    if (data.size() >= write_buffer_size_)
+    {
+        write_file_(data.data(), data.size());
+        return;
+    }
+    write_buffer_.append(data.data(), data.data() + data.size());
+}
+
+SPDLOG_INLINE size_t file_helper::size() const
+{
+    if (opening_)
+    {
+        const_cast<file_helper *>(this)->complete_open_(true);
+    }
+    if (fd_ == nullptr)
+    {
+        throw_spdlog_ex("Cannot use size() on closed file " + os::filename_to_str(filename_));
+    }
+#ifdef SPDLOG_IO_URING
+    if (uring_writer_)
+    {
+        // the write in progress first - it is in the file or not
+        uring_writer_->wait();
+        return os::filesize(fd_) + uring_writer_->buffered_size();
+    }
+#endif
+    return os::filesize(fd_) + write_buffer_.size();
+}
+
+SPDLOG_INLINE const filename_t &file_helper::filename() const
+{
+    return filename_;
+}
+
+SPDLOG_INLINE size_t file_helper::write_buffer_size() const
+{
+    return write_buffer_size_;
+}
+
+SPDLOG_INLINE bool file_helper::drop_page_cache() const
+{
+    return drop_page_cache_;
+}
+
+SPDLOG_INLINE void file_helper::preallocate(size_t size)
+{
+    if (fd_ != nullptr && size > 0)
+    {
+        os::preallocate(fd_, size);
+    }
+}
+
+SPDLOG_INLINE void file_helper::set_durability(file_durability durability, std::shared_ptr<file_syncer> syncer)
+{
+    if (durability == file_durability::group_commit && !syncer)
+    {
+        throw_spdlog_ex("file_helper: group_commit durability requires a syncer");
+    }
+    durability_ = durability;
+    syncer_ = durability == file_durability::group_commit ? std::move(syncer) : nullptr;
+    if (syncer_ && fd_ != nullptr)
+    {
+        syncer_->set_file(::fileno(fd_));
+    }
+}
+
+SPDLOG_INLINE file_durability file_helper::durability() const
+{
+    return durability_;
+}
+
+SPDLOG_INLINE void file_helper::set_compression(size_t frame_size)
+{
+    if (frame_size == compression_frame_size())
+    {
+        return;
+    }
+    if (compressor_ && fd_ != nullptr)
+    {
+        finish_frame_();
+        compressor_->close();
+    }
+    compressor_.reset();
+    if (frame_size > 0)
+    {
+        auto compressor = details::make_unique<frame_compressor>(frame_size);
+        if (fd_ != nullptr)
+        {
+            compressor->open(filename_, size());
+        }
+        compressor_ = std::move(compressor);
+    }
+}
+
+SPDLOG_INLINE size_t file_helper::compression_frame_size() const
+{
+    return compressor_ ? compressor_->frame_size() : 0;
+}
+
+SPDLOG_INLINE size_t file_helper::data_size() const
+{
+    if (!compressor_)
+    {
+        return size();
+    }
+    if (opening_)
+    {
+        const_cast<file_helper *>(this)->complete_open_(true);
+    }
+    return compressor_->data_size();
+}
+
+SPDLOG_INLINE void file_helper::swap(file_helper &other) SPDLOG_NOEXCEPT
+{
+    // the background opens refer to their helper
+    SPDLOG_TRY
+    {
+        complete_open_(true);
+    }
+    SPDLOG_CATCH_STD
+    SPDLOG_TRY
+    {
+        other.complete_open_(true);
+    }
+    SPDLOG_CATCH_STD
+    using std::swap;
+    swap(fd_, other.fd_);
+    swap(filename_, other.filename_);
+    swap(write_buffer_size_, other.write_buffer_size_);
+    swap(write_buffer_, other.write_buffer_);
+#ifdef SPDLOG_IO_URING
+    swap(uring_writer_, other.uring_writer_);
+#endif
+    swap(drop_page_cache_, other.drop_page_cache_);
+    swap(no_page_cache_, other.no_page_cache_);
+    swap(written_since_drop_, other.written_since_drop_);
+    swap(writeback_start_, other.writeback_start_);
+    swap(writeback_end_, other.writeback_end_);
+    swap(durability_, other.durability_);
+    swap(syncer_, other.syncer_);
+    swap(compressor_, other.compressor_);
+    swap(compressed_, other.compressed_);
+}
+
+SPDLOG_INLINE void file_helper::rename_sidecars(const filename_t &log_filename, const filename_t &new_log_filename) SPDLOG_NOEXCEPT
+{
+    time_index::rename(log_filename, new_log_filename);
+    frame_compressor::rename(log_filename, new_log_filename);
+}
+
+SPDLOG_INLINE void file_helper::remove_sidecars(const filename_t &log_filename) SPDLOG_NOEXCEPT
+{
+    time_index::remove(log_filename);
+    frame_compressor::remove(log_filename);
+}
 
+SPDLOG_INLINE std::FILE *file_helper::open_file_(const filename_t &fname, bool truncate) const
+{
     auto *mode = SPDLOG_FILENAME_T("ab");
     auto *trunc_mode = SPDLOG_FILENAME_T("wb");
 
@@ -50,62 +439,174 @@ SPDLOG_INLINE void file_helper::open(const filename_t &fname, bool truncate)
             }
             std::fclose(tmp);
         }
-        if (!os::fopen_s(&fd_, fname, mode))
+        std::FILE *fd;
+        if (!os::fopen_s(&fd, fname, mode))
         {
-            return;
+            return fd;
         }
 
         details::os::sleep_for_millis(open_interval_);
     }
+    return nullptr;
+}
 
-    throw_spdlog_ex("Failed opening file " + os::filename_to_str(filename_) + " for writing", errno);
+SPDLOG_INLINE std::FILE *file_helper::detach_()
+{
+    auto *fd = fd_;
+    if (fd != nullptr)
+    {
+        // like fclose(), drop the buffered data if it can't be written
+        if (compressor_)
+        {
+            SPDLOG_TRY
+            {
+                finish_frame_();
+            }
+            SPDLOG_CATCH_STD
+            compressor_->close();
+        }
+        SPDLOG_TRY
+        {
+            write_buffer_to_file_();
+        }
+        SPDLOG_CATCH_STD
+        write_buffer_.clear();
+        if (drop_page_cache_ && !no_page_cache_)
+        {
+            SPDLOG_TRY
+            {
+                drop_written_pages_();
+            }
+            SPDLOG_CATCH_STD
+        }
+        // complete in the file before closing it elsewhere (e.g. compressed by a rotation)
+        std::fflush(fd);
+        if (durability_ == file_durability::group_commit || durability_ == file_durability::sync)
+        {
+            (void)os::sync_file_data(::fileno(fd));
+        }
+        fd_ = nullptr;
+    }
+    return fd;
 }
 
-SPDLOG_INLINE void file_helper::reopen(bool truncate)
+SPDLOG_INLINE void file_helper::attach_(std::FILE *fd)
 {
-    if (filename_.empty())
+    fd_ = fd;
+    if (write_buffer_size_ > 0)
     {
-        throw_spdlog_ex("Failed re opening file - was not opened before");
+        // the write buffer replaces the stdio one
+        std::setvbuf(fd_, nullptr, _IONBF, 0);
+    }
+#ifdef SPDLOG_IO_URING
+    if (uring_writer_)
+    {
+        uring_writer_->set_fd(::fileno(fd_));
+    }
+#endif
+    if (drop_page_cache_)
+    {
+        no_page_cache_ = os::set_no_page_cache(fd_);
+        written_since_drop_ = 0;
+        writeback_start_ = writeback_end_ = os::filesize(fd_);
+    }
+    if (syncer_)
+    {
+        syncer_->set_file(::fileno(fd_));
+    }
+    if (compressor_)
+    {
+        compressor_->open(filename_, os::filesize(fd_));
     }
-    this->open(filename_, truncate);
 }
 
-SPDLOG_INLINE void file_helper::flush()
+SPDLOG_INLINE void file_helper::complete_open_(bool wait)
 {
-    std::fflush(fd_);
+    if (!opening_)
+    {
+        return;
+    }
+    if (wait)
+    {
+        open_worker_->wait_idle();
+    }
+    else if (!open_done_.load(std::memory_order_acquire))
+    {
+        return;
+    }
+    opening_ = false;
+    auto *fd = opened_fd_;
+    opened_fd_ = nullptr;
+    if (fd == nullptr)
+    {
+        pending_.clear();
+        throw_spdlog_ex("Failed opening file " + os::filename_to_str(filename_) + " for writing", open_errno_);
+    }
+    attach_(fd);
+    if (pending_.size() > 0)
+    {
+        memory_buf_t pending;
+        std::swap(pending, pending_);
+        write(pending);
+    }
 }
 
-SPDLOG_INLINE void file_helper::close()
+SPDLOG_INLINE void file_helper::finish_frame_()
 {
-    if (fd_ != nullptr)
+    compressed_.clear();
+    compressor_->finish_frame(compressed_);
+    if (compressed_.size() > 0)
     {
-        std::fclose(fd_);
-        fd_ = nullptr;
+        write_data_(string_view_t(compressed_.data(), compressed_.size()));
     }
 }
 
-SPDLOG_INLINE void file_helper::write(const memory_buf_t &buf)
+SPDLOG_INLINE void file_helper::write_file_(const char *data, size_t size)
 {
-    size_t msg_size = buf.size();
-    auto data = buf.data();
-    if (std::fwrite(data, 1, msg_size, fd_) != msg_size)
+    if (std::fwrite(data, 1, size, fd_) != size)
     {
         throw_spdlog_ex("Failed writing to file " + os::filename_to_str(filename_), errno);
     }
 }
 
-SPDLOG_INLINE size_t file_helper::size() const
+SPDLOG_INLINE void file_helper::write_buffer_to_file_()
 {
-    if (fd_ == nullptr)
+#ifdef SPDLOG_IO_URING
+    if (uring_writer_)
     {
-        throw_spdlog_ex("Cannot use size() on closed file " + os::filename_to_str(filename_));
+        auto err = uring_writer_->flush();
+        if (err != 0)
+        {
+            throw_spdlog_ex("Failed writing to file " + os::filename_to_str(filename_), err);
+        }
+        return;
+    }
+#endif
+    if (write_buffer_.size() > 0)
+    {
+        // cleared first - the data is not written twice if the write fails
+        auto size = write_buffer_.size();
+        write_buffer_.clear();
+        write_file_(write_buffer_.data(), size);
     }
-    return os::filesize(fd_);
 }
 
-SPDLOG_INLINE const filename_t &file_helper::filename() const
+// start the writeback of the data written since the last call (what reached the file - not the buffered data),
+// and drop the range started last time: its writeback is usually complete, so waiting for it is short.
+SPDLOG_INLINE void file_helper::drop_written_pages_()
 {
-    return filename_;
+    written_since_drop_ = 0;
+    auto end = os::filesize(fd_);
+    if (end < writeback_end_)
+    {
+        // truncated by someone else
+        writeback_start_ = writeback_end_ = end;
+        return;
+    }
+    os::start_writeback(fd_, writeback_end_, end - writeback_end_);
+    os::drop_page_cache(fd_, writeback_start_, writeback_end_ - writeback_start_);
+    writeback_start_ = writeback_end_;
+    writeback_end_ = end;
 }
 
 //
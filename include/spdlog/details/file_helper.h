@@ -4,31 +4,99 @@
 #pragma once
 
 #include <spdlog/common.h>
+
+#include <atomic>
+#include <memory>
 #include <tuple>
 
 namespace spdlog {
+
+// what flush() of the file sinks guarantees
+enum class file_durability
+{
+    none,         // nothing: the data reaches the file when the buffers fill up and on close
+    page_cache,   // the data is written to the file (the page cache), lost if the system crashes - the default
+    group_commit, // the data is on disk: the concurrent flushes wait for one sync per interval (see details/file_syncer.h)
+    sync          // the data is on disk: each flush syncs the file
+};
+
 namespace details {
+#ifdef SPDLOG_IO_URING
+class uring_file_writer;
+#endif
+class background_worker;
+class file_syncer;
+class frame_compressor;
 
 // Helper class for file sinks.
 // When failing to open a file, retry several times(5) with a delay interval(10 ms).
 // Throw spdlog_ex exception on errors.
+//
+// With a write buffer size, writes are collected in a buffer of that size (the file itself is
+// unbuffered) and written to the file at once when it fills up, on flush() and on close().
+// The sinks serialize the access to the file, so no locking per message is needed.
+// With SPDLOG_IO_URING (linux), the buffers are written in the background through io_uring
+// (see uring_file_writer.h), or as above if the kernel doesn't support it.
+//
+// With drop_page_cache, the data written is kept out of the page cache, so large logs don't evict
+// the cache of the application: F_NOCACHE on osx, elsewhere (linux) the writeback of each
+// page_cache_drop_interval bytes is started (sync_file_range) and the previous ones are dropped (fadvise).
+//
+// open_in_background() closes the current file and opens the next one (with the retries) on a background thread
+// of the helper, so a slow file system doesn't stall the logging thread: the writes meanwhile are kept in memory,
+// up to max_pending bytes (the next ones are dropped), and written out by the first write after the open completed.
+// A failed open is thrown by that write (or flush).
+//
+// The durability sets what flush() does (see file_durability). With group_commit, flush() requests the sync
+// of the given file_syncer, the sink waits for it. With group_commit and sync, the files are synced on close too.
+//
+// With a compression frame size (SPDLOG_ZLIB), the data is gzipped in independent frames of that size, written
+// to the file when full and on flush() (see frame_compressor.h) - the write buffer then holds compressed data.
 
 class SPDLOG_API file_helper
 {
 public:
-    explicit file_helper() = default;
+    static constexpr size_t page_cache_drop_interval = 1024 * 1024;
+
+    explicit file_helper(size_t write_buffer_size = 0, bool drop_page_cache = false);
 
     file_helper(const file_helper &) = delete;
     file_helper &operator=(const file_helper &) = delete;
     ~file_helper();
 
+    static constexpr size_t default_max_pending = 1024 * 1024;
+
     void open(const filename_t &fname, bool truncate = false);
     void reopen(bool truncate);
+    void open_in_background(const filename_t &fname, bool truncate = false, size_t max_pending = default_max_pending);
+    void reopen_in_background(bool truncate, size_t max_pending = default_max_pending);
     void flush();
     void close();
     void write(const memory_buf_t &buf);
+    void write(string_view_t data);
+    // write the parts as one record, in a single writev with the buffered data when they don't fit in the
+    // write buffer (see os::write_gather()) - the large payloads aren't copied then
+    void write(const string_view_t *parts, size_t n_parts);
     size_t size() const;
     const filename_t &filename() const;
+    size_t write_buffer_size() const;
+    bool drop_page_cache() const;
+    // reserve disk space for the first size bytes of the file (see os::preallocate)
+    void preallocate(size_t size);
+    // the syncer is required by group_commit
+    void set_durability(file_durability durability, std::shared_ptr<file_syncer> syncer = nullptr);
+    file_durability durability() const;
+    // compress the data written from now on (see frame_compressor.h), 0 to stop. throw without SPDLOG_ZLIB
+    void set_compression(size_t frame_size);
+    size_t compression_frame_size() const;
+    // the size of the uncompressed data written to the file - size() if not compressed
+    size_t data_size() const;
+    // exchange the files (and the settings) of the two helpers
+    void swap(file_helper &other) SPDLOG_NOEXCEPT;
+
+    // move / remove the sidecar files of a log file, if any: its time index and frame table
+    static void rename_sidecars(const filename_t &log_filename, const filename_t &new_log_filename) SPDLOG_NOEXCEPT;
+    static void remove_sidecars(const filename_t &log_filename) SPDLOG_NOEXCEPT;
 
     //
     // return file path and its extension:
@@ -50,6 +118,45 @@ private:
     const unsigned int open_interval_ = 10;
     std::FILE *fd_{nullptr};
     filename_t filename_;
+    size_t write_buffer_size_;
+    memory_buf_t write_buffer_;
+#ifdef SPDLOG_IO_URING
+    std::unique_ptr<uring_file_writer> uring_writer_;
+#endif
+    bool drop_page_cache_;
+    bool no_page_cache_{false}; // set for the whole file, nothing to drop
+    size_t written_since_drop_{0};
+    // the range being written back, dropped from the cache on the next interval
+    size_t writeback_start_{0};
+    size_t writeback_end_{0};
+    // background open: the result is published by open_done_
+    std::unique_ptr<background_worker> open_worker_;
+    bool opening_{false};
+    std::atomic<bool> open_done_{false};
+    std::FILE *opened_fd_{nullptr};
+    int open_errno_{0};
+    memory_buf_t pending_;
+    size_t max_pending_{0};
+    file_durability durability_{file_durability::page_cache};
+    std::shared_ptr<file_syncer> syncer_;
+    std::unique_ptr<frame_compressor> compressor_;
+    memory_buf_t compressed_;
+
+    // open with the retries, nullptr if failed (errno set)
+    std::FILE *open_file_(const filename_t &fname, bool truncate) const;
+    // write out the buffers of the file and release it, without closing it
+    std::FILE *detach_();
+    void attach_(std::FILE *fd);
+    // take the file opened in the background if done (or waiting for it) - throw if it failed
+    void complete_open_(bool wait);
+    // write data as is, through the buffers
+    void write_data_(string_view_t data);
+    // count the bytes about to be written, dropping the written pages at each page_cache_drop_interval
+    void count_written_(size_t size);
+    void finish_frame_();
+    void write_file_(const char *data, size_t size);
+    void write_buffer_to_file_();
+    void drop_written_pages_();
 };
 } // namespace details
 } // namespace spdlog
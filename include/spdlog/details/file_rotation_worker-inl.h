@@ -0,0 +1,169 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/details/file_rotation_worker.h>
+#endif
+
+#include <spdlog/details/file_compression.h>
+#include <spdlog/details/os.h>
+
+#include <cerrno>
+
+namespace spdlog {
+namespace details {
+
+SPDLOG_INLINE file_rotation_worker::file_rotation_worker(bool compress)
+    : compress_(compress)
+{}
+
+SPDLOG_INLINE file_rotation_worker::~file_rotation_worker()
+{
+    worker_.wait_idle();
+    SPDLOG_TRY
+    {
+        discard_(std::move(prepared_));
+    }
+    SPDLOG_CATCH_STD
+}
+
+SPDLOG_INLINE void file_rotation_worker::prepare(const filename_t &filename, bool truncate, const file_helper &settings)
+{
+    auto write_buffer_size = settings.write_buffer_size();
+    auto drop_page_cache = settings.drop_page_cache();
+    auto compression_frame_size = settings.compression_frame_size();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        wanted_ = filename;
+    }
+    worker_.post([this, filename, truncate, write_buffer_size, drop_page_cache, compression_frame_size] {
+        std::unique_ptr<file_helper> previous;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            previous = std::move(prepared_);
+            // not wanted anymore (opened in place or replaced) - opening it could truncate the file in use
+            if (wanted_ != filename)
+            {
+                previous.swap(prepared_);
+                return;
+            }
+            opening_ = true;
+        }
+        // done opening, even if it failed
+        struct opening_guard
+        {
+            file_rotation_worker *worker;
+            ~opening_guard()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(worker->mutex_);
+                    worker->opening_ = false;
+                }
+                worker->opened_cv_.notify_all();
+            }
+        } guard{this};
+        discard_(std::move(previous));
+
+        auto file = details::make_unique<file_helper>(write_buffer_size, drop_page_cache);
+        file->set_compression(compression_frame_size);
+        file->open(filename, truncate);
+        file->preallocate(last_size_);
+        std::lock_guard<std::mutex> lock(mutex_);
+        prepared_ = std::move(file);
+    });
+}
+
+SPDLOG_INLINE std::unique_ptr<file_helper> file_rotation_worker::take_prepared(const filename_t &filename)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    opened_cv_.wait(lock, [this] { return !opening_; });
+    wanted_.clear();
+    if (prepared_ && prepared_->filename() == filename)
+    {
+        return std::move(prepared_);
+    }
+    return nullptr;
+}
+
+SPDLOG_INLINE void file_rotation_worker::retire(std::unique_ptr<file_helper> file)
+{
+    // std::function needs a copyable callable
+    std::shared_ptr<file_helper> retired(std::move(file));
+    worker_.post([this, retired] {
+        retired->flush();
+        last_size_ = retired->size();
+        auto filename = retired->filename();
+        retired->close();
+        auto size = last_size_;
+        if (compress_)
+        {
+            file_compression::compress_file(filename);
+            auto compressed = file_compression::compressed_filename(filename);
+            file_helper::rename_sidecars(filename, compressed);
+            filename = compressed;
+            size = os::path_size(filename);
+        }
+        if (retention_)
+        {
+            retention_->add_newest(size, filename);
+            retention_->remove_excess();
+        }
+    });
+}
+
+SPDLOG_INLINE void file_rotation_worker::remove(const filename_t &filename)
+{
+    worker_.post([this, filename] {
+        if (retention_)
+        {
+            retention_->remove(filename);
+            retention_->remove(file_compression::compressed_filename(filename));
+        }
+        file_helper::remove_sidecars(filename);
+        file_helper::remove_sidecars(file_compression::compressed_filename(filename));
+        if (os::remove_if_exists(filename) != 0 || os::remove_if_exists(file_compression::compressed_filename(filename)) != 0)
+        {
+            throw_spdlog_ex("Failed removing file " + os::filename_to_str(filename), errno);
+        }
+    });
+}
+
+SPDLOG_INLINE void file_rotation_worker::set_retention(std::unique_ptr<size_retention> retention)
+{
+    // std::function needs a copyable callable
+    std::shared_ptr<size_retention> shared(std::move(retention));
+    worker_.post([this, shared] {
+        retention_ = details::make_unique<size_retention>(std::move(*shared));
+        retention_->remove_excess();
+    });
+}
+
+SPDLOG_INLINE void file_rotation_worker::throw_error()
+{
+    auto error = worker_.take_error();
+    if (!error.empty())
+    {
+        throw_spdlog_ex(error);
+    }
+}
+
+// close a prepared file that will not be used, and remove it if it was created for nothing
+SPDLOG_INLINE void file_rotation_worker::discard_(std::unique_ptr<file_helper> file)
+{
+    if (!file)
+    {
+        return;
+    }
+    auto filename = file->filename();
+    bool empty = file->size() == 0;
+    file->close();
+    if (empty)
+    {
+        (void)os::remove(filename);
+    }
+}
+
+} // namespace details
+} // namespace spdlog
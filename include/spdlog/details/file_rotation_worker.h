@@ -0,0 +1,74 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Background file work of the time based rotating sinks (daily_file_sink, hourly_file_sink),
+// so that the logging threads don't wait for the file system at the rotation time:
+//    the file of the next period is created (and its disk space reserved, see os::preallocate) ahead of time.
+//    the previous file is closed, compressed if needed (see file_compression.h), and the old ones deleted.
+//
+// The tasks run in order on a background_worker. Their errors are reported by throw_error().
+
+#include <spdlog/common.h>
+#include <spdlog/details/background_worker.h>
+#include <spdlog/details/file_helper.h>
+#include <spdlog/details/size_retention.h>
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+namespace spdlog {
+namespace details {
+
+class SPDLOG_API file_rotation_worker
+{
+public:
+    explicit file_rotation_worker(bool compress);
+    file_rotation_worker(const file_rotation_worker &) = delete;
+    file_rotation_worker &operator=(const file_rotation_worker &) = delete;
+    // run the tasks left, and remove the prepared file if it was not used
+    ~file_rotation_worker();
+
+    // open the given file in the background for the next rotation, with the settings of the given helper.
+    // the disk space of the last retired file is reserved for it.
+    void prepare(const filename_t &filename, bool truncate, const file_helper &settings);
+
+    // the prepared file if it is the given one, nullptr otherwise (to open it in place).
+    // if it is being opened, wait for it - if not opened yet, it won't be.
+    std::unique_ptr<file_helper> take_prepared(const filename_t &filename);
+
+    // close the given file in the background, and compress it if enabled.
+    void retire(std::unique_ptr<file_helper> file);
+
+    // delete the given file (and its compressed version) in the background
+    void remove(const filename_t &filename);
+
+    // track the retired files in retention (holding the existing ones) and delete the oldest ones over its budget
+    void set_retention(std::unique_ptr<size_retention> retention);
+
+    // throw spdlog_ex with the error of the first failed task since the last call, if any
+    void throw_error();
+
+private:
+    bool compress_;
+    std::mutex mutex_;
+    std::condition_variable opened_cv_;
+    filename_t wanted_; // the file to prepare - cleared if not needed anymore
+    bool opening_{false};
+    std::unique_ptr<file_helper> prepared_;
+    size_t last_size_{0}; // of the last retired file, used by the worker only
+    std::unique_ptr<size_retention> retention_; // used by the worker only
+    // last - its tasks use the members above
+    background_worker worker_;
+
+    static void discard_(std::unique_ptr<file_helper> file);
+};
+
+} // namespace details
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "file_rotation_worker-inl.h"
+#endif
@@ -0,0 +1,121 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/details/file_syncer.h>
+#endif
+
+#include <spdlog/details/os.h>
+
+namespace spdlog {
+namespace details {
+
+SPDLOG_INLINE file_syncer::file_syncer(std::chrono::milliseconds interval)
+    : interval_(interval)
+    , thread_(&file_syncer::loop_, this)
+{}
+
+SPDLOG_INLINE file_syncer::~file_syncer()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        active_ = false;
+    }
+    request_cv_.notify_one();
+    thread_.join();
+    if (fd_ >= 0)
+    {
+        os::close_fd(fd_);
+    }
+}
+
+SPDLOG_INLINE void file_syncer::set_file(int fd)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    synced_cv_.wait(lock, [this] { return !syncing_; });
+    if (requested_ > synced_)
+    {
+        sync_locked_(requested_);
+    }
+    if (fd_ >= 0)
+    {
+        os::close_fd(fd_);
+    }
+    fd_ = fd >= 0 ? os::dup_fd(fd) : -1;
+}
+
+SPDLOG_INLINE void file_syncer::request()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        requested_++;
+    }
+    request_cv_.notify_one();
+}
+
+SPDLOG_INLINE void file_syncer::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto target = requested_;
+    synced_cv_.wait(lock, [this, target] { return synced_ >= target; });
+    if (error_ != 0 && target > error_from_ && target <= error_to_)
+    {
+        throw_spdlog_ex("Failed syncing file to disk", error_);
+    }
+}
+
+SPDLOG_INLINE void file_syncer::loop_()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;)
+    {
+        request_cv_.wait(lock, [this] { return !active_ || requested_ > synced_; });
+        if (requested_ == synced_)
+        {
+            return; // stopped
+        }
+        // the requests coming during the interval since the last sync are served by the same one
+        request_cv_.wait_until(lock, last_sync_ + interval_, [this] { return !active_; });
+        if (requested_ == synced_)
+        {
+            continue; // synced by set_file() meanwhile
+        }
+        auto target = requested_;
+        auto fd = fd_;
+        syncing_ = true;
+        lock.unlock();
+        int err = fd >= 0 ? os::sync_file_data(fd) : 0;
+        lock.lock();
+        syncing_ = false;
+        last_sync_ = clock::now();
+        set_synced_(target, err);
+    }
+}
+
+SPDLOG_INLINE void file_syncer::sync_locked_(uint64_t target)
+{
+    int err = fd_ >= 0 ? os::sync_file_data(fd_) : 0;
+    last_sync_ = clock::now();
+    set_synced_(target, err);
+}
+
+SPDLOG_INLINE void file_syncer::set_synced_(uint64_t target, int err)
+{
+    if (target > synced_)
+    {
+        if (err != 0)
+        {
+            error_ = err;
+            error_from_ = synced_;
+            error_to_ = target;
+        }
+        synced_ = target;
+    }
+    // the waiters, and set_file() waiting for the end of the sync
+    synced_cv_.notify_all();
+}
+
+} // namespace details
+} // namespace spdlog
@@ -0,0 +1,72 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Group commit of the flushes of a file sink (file_durability::group_commit), the way the database logs do it:
+// the flushes only request a sync of the file, a thread of the syncer makes one sync (os::sync_file_data) for
+// all the requests made meanwhile - at most one per interval - and wakes their waiters together.
+//
+// The file_helper requests the syncs under the sink lock (flush()) and sets the file synced (set_file()).
+// The sink waits for them after releasing its lock (base_sink::after_flush_()), so the threads flushing
+// meanwhile are served by the same sync.
+
+#include <spdlog/common.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+namespace spdlog {
+namespace details {
+
+class SPDLOG_API file_syncer
+{
+public:
+    explicit file_syncer(std::chrono::milliseconds interval);
+    file_syncer(const file_syncer &) = delete;
+    file_syncer &operator=(const file_syncer &) = delete;
+    // sync the requests left, stop the thread and join it
+    ~file_syncer();
+
+    // the file synced from now on (a duplicate of fd is kept), -1 for none. the requests left are synced
+    // first to the previous file.
+    void set_file(int fd);
+    // request a sync of the data written so far
+    void request();
+    // wait for the requests made so far to be synced. throw spdlog_ex if their sync failed.
+    void wait();
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    const std::chrono::milliseconds interval_;
+    std::mutex mutex_;
+    std::condition_variable request_cv_;
+    std::condition_variable synced_cv_;
+    int fd_{-1};
+    bool syncing_{false};
+    bool active_{true};
+    uint64_t requested_{0};
+    uint64_t synced_{0};
+    // the last failed sync: of the requests in (error_from_, error_to_]
+    int error_{0};
+    uint64_t error_from_{0};
+    uint64_t error_to_{0};
+    clock::time_point last_sync_;
+    std::thread thread_;
+
+    void loop_();
+    // sync fd_ for the requests up to target - called with the lock held
+    void sync_locked_(uint64_t target);
+    void set_synced_(uint64_t target, int err);
+};
+
+} // namespace details
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "file_syncer-inl.h"
+#endif
@@ -0,0 +1,325 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/details/flight_recorder.h>
+#endif
+
+#include <spdlog/details/binary_log_writer.h>
+#include <spdlog/details/file_helper.h>
+#include <spdlog/details/os.h>
+#include <spdlog/details/scoped_buffer.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <utility>
+
+namespace spdlog {
+namespace details {
+namespace flight_record {
+
+struct header
+{
+    uint32_t size; // of the whole record
+    int64_t time;  // ns since epoch
+    uint16_t logger_name_size;
+    uint8_t level;
+    uint8_t interned; // the payload is static, at payload_address
+    uint32_t payload_size;
+    source_loc source;
+    const char *payload_address;
+};
+
+// longest logger names and payloads kept
+static const size_t max_logger_name = 0xffff;
+
+} // namespace flight_record
+
+SPDLOG_INLINE flight_ring::flight_ring(size_t capacity, size_t thread_id)
+    : thread_id_(thread_id)
+{
+    size_t rounded = 4096;
+    while (rounded < capacity)
+    {
+        rounded <<= 1;
+    }
+    buffer_.resize(rounded);
+    mask_ = rounded - 1;
+}
+
+SPDLOG_INLINE void flight_ring::write(const char *record, size_t size) SPDLOG_NOEXCEPT
+{
+    if (size > buffer_.size())
+    {
+        return;
+    }
+    auto head = head_.load(std::memory_order_relaxed);
+    if (head + size - writer_tail_ > buffer_.size())
+    {
+        while (head + size - writer_tail_ > buffer_.size())
+        {
+            writer_tail_ += size_at_(writer_tail_);
+        }
+        // the new tail is visible before the overwritten bytes
+        tail_.store(writer_tail_, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+    copy_in_(head, record, size);
+    head_.store(head + size, std::memory_order_release);
+}
+
+SPDLOG_INLINE void flight_ring::read(std::vector<char> &dest) const
+{
+    auto head = head_.load(std::memory_order_acquire);
+    std::vector<char> copy(buffer_);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    auto tail = tail_.load(std::memory_order_relaxed);
+    // overwritten meanwhile up to the tail - or all of it
+    for (auto pos = tail; pos < head && head - tail <= copy.size();)
+    {
+        uint32_t size;
+        for (size_t i = 0; i < sizeof(size); i++)
+        {
+            reinterpret_cast<char *>(&size)[i] = copy[(pos + i) & mask_];
+        }
+        if (size < sizeof(flight_record::header) || pos + size > head)
+        {
+            break;
+        }
+        for (uint64_t i = 0; i < size; i++)
+        {
+            dest.push_back(copy[(pos + i) & mask_]);
+        }
+        pos += size;
+    }
+}
+
+SPDLOG_INLINE void flight_ring::copy_in_(uint64_t pos, const char *src, size_t size) SPDLOG_NOEXCEPT
+{
+    auto index = static_cast<size_t>(pos & mask_);
+    auto first = std::min(size, buffer_.size() - index);
+    std::memcpy(buffer_.data() + index, src, first);
+    std::memcpy(buffer_.data(), src + first, size - first);
+}
+
+SPDLOG_INLINE uint32_t flight_ring::size_at_(uint64_t pos) const SPDLOG_NOEXCEPT
+{
+    uint32_t size;
+    for (size_t i = 0; i < sizeof(size); i++)
+    {
+        reinterpret_cast<char *>(&size)[i] = buffer_[(pos + i) & mask_];
+    }
+    return size;
+}
+
+SPDLOG_INLINE flight_recorder &flight_recorder::instance()
+{
+    static flight_recorder recorder;
+    return recorder;
+}
+
+SPDLOG_INLINE void flight_recorder::enable(const filename_t &dump_file, level::level_enum record_level, size_t ring_size)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    rings_.clear();
+    ring_size_ = ring_size;
+    dump_file_ = dump_file;
+    generation_.fetch_add(1, std::memory_order_release);
+    flight_record_level().store(record_level, std::memory_order_relaxed);
+}
+
+SPDLOG_INLINE void flight_recorder::disable()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    flight_record_level().store(level::off, std::memory_order_relaxed);
+    generation_.fetch_add(1, std::memory_order_release);
+    rings_.clear();
+}
+
+SPDLOG_INLINE void flight_recorder::set_dump_level(level::level_enum dump_level)
+{
+    dump_level_.store(dump_level, std::memory_order_relaxed);
+}
+
+SPDLOG_INLINE void flight_recorder::record(const log_msg &msg)
+{
+#ifndef SPDLOG_NO_TLS
+    auto *ring = thread_ring_();
+    if (ring == nullptr)
+    {
+        return;
+    }
+
+    flight_record::header header{};
+    // the time is not read by the sinks of the loggers dropping the message
+    auto time = msg.time == log_clock::time_point{} ? os::now() : msg.time;
+    header.time = static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count());
+    header.logger_name_size = static_cast<uint16_t>(std::min(msg.logger_name.size(), flight_record::max_logger_name));
+    header.level = static_cast<uint8_t>(msg.level);
+    header.source = msg.source;
+    header.interned = msg.payload_id != 0 ? 1 : 0;
+    // a record takes at most a quarter of the ring
+    auto max_payload = ring->capacity() / 4;
+    header.payload_size = static_cast<uint32_t>(std::min(msg.payload.size(), max_payload));
+    header.payload_address = header.interned ? msg.payload.data() : nullptr;
+    size_t size = sizeof(header) + header.logger_name_size + (header.interned ? 0 : header.payload_size);
+    header.size = static_cast<uint32_t>(size);
+
+    scoped_buffer scoped_buf;
+    auto &buf = scoped_buf.get();
+    buf.resize(size);
+    std::memcpy(buf.data(), &header, sizeof(header));
+    std::memcpy(buf.data() + sizeof(header), msg.logger_name.data(), header.logger_name_size);
+    if (!header.interned)
+    {
+        std::memcpy(buf.data() + sizeof(header) + header.logger_name_size, msg.payload.data(), header.payload_size);
+    }
+    ring->write(buf.data(), size);
+
+    if (msg.level >= dump_level_.load(std::memory_order_relaxed) && msg.level != level::off)
+    {
+        SPDLOG_TRY
+        {
+            dump();
+        }
+        SPDLOG_CATCH_STD
+    }
+#else
+    (void)msg;
+#endif
+}
+
+SPDLOG_INLINE std::vector<log_msg> flight_recorder::snapshot(std::vector<char> &storage) const
+{
+    storage.clear();
+    // the end of the records of each thread in storage, and its id
+    std::vector<std::pair<size_t, size_t>> threads;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto &ring : rings_)
+        {
+            ring->read(storage);
+            threads.emplace_back(storage.size(), ring->thread_id());
+        }
+    }
+
+    std::vector<log_msg> msgs;
+    auto thread = threads.begin();
+    for (size_t pos = 0; pos + sizeof(flight_record::header) <= storage.size();)
+    {
+        while (pos >= thread->first)
+        {
+            ++thread;
+        }
+        flight_record::header header;
+        std::memcpy(&header, storage.data() + pos, sizeof(header));
+        const char *strings = storage.data() + pos + sizeof(header);
+        log_msg msg;
+        msg.time = log_clock::time_point(
+            std::chrono::duration_cast<log_clock::duration>(std::chrono::nanoseconds(header.time)));
+        msg.level = static_cast<level::level_enum>(header.level);
+        msg.source = header.source;
+        msg.thread_id = thread->second;
+        msg.logger_name = string_view_t(strings, header.logger_name_size);
+        msg.payload = header.interned ? string_view_t(header.payload_address, header.payload_size)
+                                      : string_view_t(strings + header.logger_name_size, header.payload_size);
+        msgs.push_back(msg);
+        pos += header.size;
+    }
+    std::stable_sort(msgs.begin(), msgs.end(), [](const log_msg &a, const log_msg &b) { return a.time < b.time; });
+    return msgs;
+}
+
+SPDLOG_INLINE size_t flight_recorder::dump()
+{
+    filename_t filename;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        filename = dump_file_;
+    }
+    return dump(filename);
+}
+
+SPDLOG_INLINE size_t flight_recorder::dump(const filename_t &filename)
+{
+    std::lock_guard<std::mutex> dump_lock(dump_mutex_);
+    std::vector<char> storage;
+    auto msgs = snapshot(storage);
+    // a binary log file (see binary_file_sink)
+    memory_buf_t encoded;
+    binary_log_writer::start_file(encoded);
+    binary_log_writer writer;
+    writer.start_session(encoded);
+    for (const auto &msg : msgs)
+    {
+        writer.encode(msg, encoded);
+    }
+    file_helper file;
+    file.open(filename, true);
+    file.write(encoded);
+    file.flush();
+    return msgs.size();
+}
+
+// the ring of the calling thread for the current recording, created on its first message
+SPDLOG_INLINE flight_ring *flight_recorder::thread_ring_()
+{
+#ifndef SPDLOG_NO_TLS
+    struct thread_ring
+    {
+        std::shared_ptr<flight_ring> ring;
+        uint64_t generation{0};
+
+        ~thread_ring()
+        {
+            if (ring)
+            {
+                ring->orphaned.store(true, std::memory_order_relaxed);
+            }
+        }
+    };
+    static thread_local thread_ring current;
+
+    auto generation = generation_.load(std::memory_order_acquire);
+    if (current.generation == generation)
+    {
+        return current.ring.get();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (flight_record_level().load(std::memory_order_relaxed) == level::off)
+    {
+        return nullptr;
+    }
+    // keep the rings of the exited threads, up to as many as the running ones
+    size_t n_orphaned = 0;
+    for (auto &ring : rings_)
+    {
+        n_orphaned += ring->orphaned.load(std::memory_order_relaxed) ? 1 : 0;
+    }
+    for (auto it = rings_.begin(); it != rings_.end() && n_orphaned * 2 > rings_.size();)
+    {
+        if ((*it)->orphaned.load(std::memory_order_relaxed))
+        {
+            it = rings_.erase(it);
+            n_orphaned--;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    current.ring = std::make_shared<flight_ring>(ring_size_, os::thread_id());
+    current.generation = generation_.load(std::memory_order_relaxed);
+    rings_.push_back(current.ring);
+    return current.ring.get();
+#else
+    return nullptr;
+#endif
+}
+
+} // namespace details
+} // namespace spdlog
@@ -0,0 +1,125 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// The process wide flight recorder (see spdlog/flight_recorder.h): each thread writes the messages
+// of all the loggers from the record level up to a ring of its own, lock free, as compact binary records.
+//
+// record := header logger_name [payload]
+// header := size, time, logger name size, level, payload flags, payload size, source_loc, interned payload address
+//
+// The strings of the source locations and the interned payloads are static: only their addresses are kept.
+
+#include <spdlog/common.h>
+#include <spdlog/details/log_msg.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace spdlog {
+namespace details {
+
+// the ring of a thread: written by its thread only, read by any thread without locks.
+// The writer moves the tail past the records it is about to overwrite before writing them, the
+// reader copies the buffer then reads the tail: the records it copied from the tail up are intact.
+class SPDLOG_API flight_ring
+{
+public:
+    // capacity is rounded up to a power of two
+    flight_ring(size_t capacity, size_t thread_id);
+    flight_ring(const flight_ring &) = delete;
+    flight_ring &operator=(const flight_ring &) = delete;
+
+    // write the record (its size first, as a uint32_t), evicting the oldest ones. dropped if longer than capacity.
+    void write(const char *record, size_t size) SPDLOG_NOEXCEPT;
+
+    // append the intact records, oldest first
+    void read(std::vector<char> &dest) const;
+
+    size_t capacity() const
+    {
+        return buffer_.size();
+    }
+
+    size_t thread_id() const
+    {
+        return thread_id_;
+    }
+
+    // its thread exited
+    std::atomic<bool> orphaned{false};
+
+private:
+    std::vector<char> buffer_;
+    size_t mask_;
+    size_t thread_id_;
+    std::atomic<uint64_t> head_{0}; // positions since the start, the buffer index is position & mask_
+    std::atomic<uint64_t> tail_{0};
+    uint64_t writer_tail_{0};
+
+    void copy_in_(uint64_t pos, const char *src, size_t size) SPDLOG_NOEXCEPT;
+    uint32_t size_at_(uint64_t pos) const SPDLOG_NOEXCEPT;
+};
+
+class SPDLOG_API flight_recorder
+{
+public:
+    static flight_recorder &instance();
+
+    // the rings of the previous recording are dropped
+    void enable(const filename_t &dump_file, level::level_enum record_level, size_t ring_size);
+    void disable();
+
+    // dump to the dump file when recording a message of this level or above (level::off: never)
+    void set_dump_level(level::level_enum dump_level);
+
+    // write msg to the ring of the calling thread, and dump if at the dump level
+    void record(const log_msg &msg);
+
+    // the recorded messages, oldest first. their strings point into storage.
+    std::vector<log_msg> snapshot(std::vector<char> &storage) const;
+
+    // write the recorded messages to a binary log file (see binary_file_sink). return their count.
+    size_t dump();
+    size_t dump(const filename_t &filename);
+
+private:
+    flight_recorder() = default;
+
+    mutable std::mutex mutex_;
+    std::vector<std::shared_ptr<flight_ring>> rings_;
+    std::atomic<uint64_t> generation_{0};
+    size_t ring_size_{0};
+    filename_t dump_file_;
+    std::atomic<int> dump_level_{level::critical};
+    std::mutex dump_mutex_; // one dump at a time
+
+    flight_ring *thread_ring_();
+};
+
+// the level messages are recorded from, level::off if the recorder is disabled
+inline std::atomic<int> &flight_record_level() SPDLOG_NOEXCEPT
+{
+    static std::atomic<int> record_level{level::off};
+    return record_level;
+}
+
+// true if the flight recorder records the messages of this level, whatever the levels of the loggers
+inline bool flight_records(level::level_enum lvl) SPDLOG_NOEXCEPT
+{
+#ifndef SPDLOG_NO_TLS
+    return lvl >= flight_record_level().load(std::memory_order_relaxed) && lvl != level::off;
+#else
+    (void)lvl;
+    return false;
+#endif
+}
+
+} // namespace details
+} // namespace spdlog
+
+// header only: flight_recorder-inl.h is included by logger.h, it needs the complete logger
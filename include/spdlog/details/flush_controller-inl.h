@@ -0,0 +1,104 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/details/flush_controller.h>
+#endif
+
+#include <algorithm>
+
+namespace spdlog {
+namespace details {
+
+SPDLOG_INLINE flush_controller::flush_controller(const flush_policy &policy, flush_fn flush_fun, void *target)
+    : policy_(policy)
+    , flush_fun_(flush_fun)
+    , target_(target)
+{
+    // the deferred flushes are done at most a period late
+    std::chrono::milliseconds period{0};
+    for (auto interval : {policy.min_interval, policy.idle})
+    {
+        if (interval > std::chrono::milliseconds::zero())
+        {
+            period = period > std::chrono::milliseconds::zero() ? (std::min)(period, interval) : interval;
+        }
+    }
+    if (period > std::chrono::milliseconds::zero())
+    {
+        timer_ = details::make_unique<periodic_worker>([this] { on_timer_(); }, period);
+    }
+}
+
+SPDLOG_INLINE bool flush_controller::needed(const flush_policy &policy)
+{
+    return policy.min_interval > std::chrono::milliseconds::zero() || policy.max_pending_bytes > 0 ||
+           policy.idle > std::chrono::milliseconds::zero();
+}
+
+SPDLOG_INLINE bool flush_controller::on_message(const log_msg &msg, bool level_flush)
+{
+    auto time = msg.time.time_since_epoch().count();
+    if (!pending_.load(std::memory_order_relaxed))
+    {
+        pending_.store(true, std::memory_order_relaxed);
+    }
+    if (policy_.idle > std::chrono::milliseconds::zero())
+    {
+        last_message_.store(time, std::memory_order_relaxed);
+    }
+    if (policy_.max_pending_bytes > 0 &&
+        pending_bytes_.fetch_add(msg.payload.size(), std::memory_order_relaxed) + msg.payload.size() >= policy_.max_pending_bytes)
+    {
+        return true;
+    }
+    if (!level_flush)
+    {
+        return false;
+    }
+    auto min_interval = std::chrono::duration_cast<log_clock::duration>(policy_.min_interval).count();
+    if (min_interval == 0 || time - last_flush_.load(std::memory_order_relaxed) >= min_interval)
+    {
+        return true;
+    }
+    level_pending_.store(true, std::memory_order_relaxed);
+    return false;
+}
+
+SPDLOG_INLINE void flush_controller::on_flush()
+{
+    pending_.store(false, std::memory_order_relaxed);
+    level_pending_.store(false, std::memory_order_relaxed);
+    pending_bytes_.store(0, std::memory_order_relaxed);
+    last_flush_.store(log_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+}
+
+SPDLOG_INLINE void flush_controller::rebind(void *target) SPDLOG_NOEXCEPT
+{
+    std::lock_guard<std::mutex> lock(target_mutex_);
+    target_ = target;
+}
+
+SPDLOG_INLINE void flush_controller::on_timer_()
+{
+    auto now = log_clock::now().time_since_epoch().count();
+    auto min_interval = std::chrono::duration_cast<log_clock::duration>(policy_.min_interval).count();
+    auto idle = std::chrono::duration_cast<log_clock::duration>(policy_.idle).count();
+    bool coalesced_due =
+        level_pending_.load(std::memory_order_relaxed) && now - last_flush_.load(std::memory_order_relaxed) >= min_interval;
+    bool idle_due =
+        idle > 0 && pending_.load(std::memory_order_relaxed) && now - last_message_.load(std::memory_order_relaxed) >= idle;
+    if (coalesced_due || idle_due)
+    {
+        std::lock_guard<std::mutex> lock(target_mutex_);
+        if (target_ != nullptr)
+        {
+            flush_fun_(target_);
+        }
+    }
+}
+
+} // namespace details
+} // namespace spdlog
@@ -0,0 +1,72 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Applies the parts of a flush_policy beyond the flush level for a logger:
+// tells after each message whether to flush now, and does the deferred flushes (coalesced or on idle)
+// with a periodic timer on the shared timer wheel.
+
+#include <spdlog/common.h>
+#include <spdlog/details/log_msg.h>
+#include <spdlog/details/periodic_worker.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+namespace spdlog {
+namespace details {
+
+class SPDLOG_API flush_controller
+{
+public:
+    using flush_fn = void (*)(void *target);
+
+    // flush_fun(target) is called by the timer thread for the deferred flushes (none while target is null)
+    flush_controller(const flush_policy &policy, flush_fn flush_fun, void *target);
+    flush_controller(const flush_controller &) = delete;
+    flush_controller &operator=(const flush_controller &) = delete;
+
+    // true if the policy needs a controller (more than a flush level)
+    static bool needed(const flush_policy &policy);
+
+    // called after the message was sunk, level_flush telling if its level asks for a flush.
+    // return true if the caller should flush now.
+    bool on_message(const log_msg &msg, bool level_flush);
+
+    // called before each flush of the logger (for any reason): the pending messages are flushed
+    void on_flush();
+
+    // the deferred flushes are of the given target from now on (waits for the one in progress)
+    void rebind(void *target) SPDLOG_NOEXCEPT;
+
+    const flush_policy &policy() const
+    {
+        return policy_;
+    }
+
+private:
+    using time_rep = log_clock::duration::rep;
+
+    void on_timer_();
+
+    flush_policy policy_;
+    flush_fn flush_fun_;
+    std::mutex target_mutex_; // held by the deferred flushes
+    void *target_;
+    std::atomic<bool> pending_{false};       // messages logged since the last flush
+    std::atomic<bool> level_pending_{false}; // a flush by level was deferred
+    std::atomic<size_t> pending_bytes_{0};
+    std::atomic<time_rep> last_message_{0};
+    std::atomic<time_rep> last_flush_{0};
+    // last: stopped first on destruction
+    std::unique_ptr<periodic_worker> timer_;
+};
+
+} // namespace details
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "flush_controller-inl.h"
+#endif
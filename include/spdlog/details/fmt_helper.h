@@ -3,10 +3,12 @@
 #pragma once
 
 #include <chrono>
+#include <cstring>
 #include <type_traits>
 #include <iterator>
 #include <spdlog/fmt/fmt.h>
 #include <spdlog/common.h>
+#include <spdlog/details/log_msg.h>
 
 // Some fmt helpers to efficiently format and pad ints and strings
 namespace spdlog {
@@ -59,6 +61,44 @@ inline void pad2(int n, memory_buf_t &dest)
     }
 }
 
+// "00" to "99" - the two digits of the given value (0-99)
+inline const char *two_digits(size_t value)
+{
+    static const char digits[] = "0001020304050607080910111213141516171819"
+                                 "2021222324252627282930313233343536373839"
+                                 "4041424344454647484950515253545556575859"
+                                 "6061626364656667686970717273747576777879"
+                                 "8081828384858687888990919293949596979899";
+    return &digits[value * 2];
+}
+
+// write exactly Width digits of n (zero padded, n must be below 10^Width) to out,
+// two digits at a time.
+template<unsigned int Width, typename T>
+inline void write_fixed_digits(T n, char *out)
+{
+    char *p = out + Width;
+    for (unsigned int i = 0; i < Width / 2; i++)
+    {
+        p -= 2;
+        std::memcpy(p, two_digits(static_cast<size_t>(n % 100)), 2);
+        n /= 100;
+    }
+    if (Width % 2 != 0)
+    {
+        *--p = static_cast<char>('0' + n);
+    }
+}
+
+// append n zero padded to Width digits, in a single append
+template<unsigned int Width, typename T>
+inline void append_fixed_digits(T n, memory_buf_t &dest)
+{
+    char buf[Width];
+    write_fixed_digits<Width>(n, buf);
+    dest.append(buf, buf + Width);
+}
+
 template<typename T>
 inline void pad_uint(T n, unsigned int width, memory_buf_t &dest)
 {
@@ -90,13 +130,84 @@ inline void pad3(T n, memory_buf_t &dest)
 template<typename T>
 inline void pad6(T n, memory_buf_t &dest)
 {
-    pad_uint(n, 6, dest);
+    static_assert(std::is_unsigned<T>::value, "pad6 must get unsigned T");
+    if (n < 1000000)
+    {
+        append_fixed_digits<6>(n, dest);
+    }
+    else
+    {
+        append_int(n, dest);
+    }
 }
 
 template<typename T>
 inline void pad9(T n, memory_buf_t &dest)
 {
-    pad_uint(n, 9, dest);
+    static_assert(std::is_unsigned<T>::value, "pad9 must get unsigned T");
+    if (n < 1000000000)
+    {
+        append_fixed_digits<9>(n, dest);
+    }
+    else
+    {
+        append_int(n, dest);
+    }
+}
+
+// append the value of the given key/value field (strings are not quoted)
+inline void append_field_value(const field &f, memory_buf_t &dest)
+{
+    switch (f.type)
+    {
+    case field::value_type::string:
+        append_string_view(f.string_value, dest);
+        break;
+    case field::value_type::signed_int:
+        append_int(f.int_value, dest);
+        break;
+    case field::value_type::unsigned_int:
+        append_int(f.uint_value, dest);
+        break;
+    case field::value_type::floating:
+        fmt::format_to(std::back_inserter(dest), SPDLOG_FMT_RUNTIME("{}"), f.double_value);
+        break;
+    case field::value_type::boolean:
+        append_string_view(f.bool_value ? "true" : "false", dest);
+        break;
+    }
+}
+
+// append the given fields as "key=value key=value"
+inline void append_fields(const field *fields, size_t n_fields, memory_buf_t &dest)
+{
+    for (size_t i = 0; i < n_fields; i++)
+    {
+        if (i > 0)
+        {
+            dest.push_back(' ');
+        }
+        append_string_view(fields[i].key, dest);
+        dest.push_back('=');
+        append_field_value(fields[i], dest);
+    }
+}
+
+// append the fields of the given message as "key=value key=value"
+inline void append_fields(const log_msg &msg, memory_buf_t &dest)
+{
+    append_fields(msg.fields, msg.n_fields, dest);
+}
+
+// append the given bytes as lowercase hex digits
+inline void append_hex(const uint8_t *bytes, size_t n, memory_buf_t &dest)
+{
+    static const char digits[] = "0123456789abcdef";
+    for (size_t i = 0; i < n; i++)
+    {
+        dest.push_back(digits[bytes[i] >> 4]);
+        dest.push_back(digits[bytes[i] & 0x0f]);
+    }
 }
 
 // return fraction of a second of the given time_point.
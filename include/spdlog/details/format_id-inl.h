@@ -0,0 +1,34 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/details/format_id.h>
+#endif
+
+#include <mutex>
+#include <unordered_map>
+
+namespace spdlog {
+namespace details {
+
+SPDLOG_INLINE size_t make_format_id(const std::string &signature)
+{
+    // never freed - formatters may still be created while the process exits
+    static auto *ids = new std::unordered_map<std::string, size_t>();
+    static auto *ids_mutex = new std::mutex();
+
+    std::lock_guard<std::mutex> lock(*ids_mutex);
+    auto it = ids->find(signature);
+    if (it != ids->end())
+    {
+        return it->second;
+    }
+    auto id = ids->size() + 1;
+    ids->emplace(signature, id);
+    return id;
+}
+
+} // namespace details
+} // namespace spdlog
@@ -0,0 +1,23 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <spdlog/common.h>
+
+#include <string>
+
+namespace spdlog {
+namespace details {
+
+// Return the id of the given formatter configuration (see formatter::format_id()), registering
+// it on first use. The signature must describe everything the output depends on - e.g. the
+// formatter kind, pattern, time type and eol. Formatters with the same signature share the id.
+SPDLOG_API size_t make_format_id(const std::string &signature);
+
+} // namespace details
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "format_id-inl.h"
+#endif
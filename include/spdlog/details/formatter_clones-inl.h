@@ -0,0 +1,93 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/details/formatter_clones.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+#include <vector>
+
+namespace spdlog {
+namespace details {
+namespace formatter_clones {
+
+#ifndef SPDLOG_NO_TLS
+struct clone_entry
+{
+    const void *owner;
+    uint64_t generation;
+    std::unique_ptr<formatter> clone;
+};
+
+// most recently used last
+inline std::vector<clone_entry> &thread_clones()
+{
+    static thread_local std::vector<clone_entry> clones;
+    return clones;
+}
+#endif
+
+SPDLOG_INLINE uint64_t new_generation() SPDLOG_NOEXCEPT
+{
+    static std::atomic<uint64_t> last{0};
+    return last.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+SPDLOG_INLINE formatter *find(const void *owner, uint64_t generation) SPDLOG_NOEXCEPT
+{
+#ifndef SPDLOG_NO_TLS
+    auto &clones = thread_clones();
+    auto n = clones.size();
+    if (n > 0 && clones[n - 1].owner == owner && clones[n - 1].generation == generation)
+    {
+        return clones[n - 1].clone.get(); // the usual case: one sink per thread or the same again
+    }
+    for (size_t i = 0; i + 1 < n; i++)
+    {
+        if (clones[i].owner == owner && clones[i].generation == generation)
+        {
+            std::rotate(clones.begin() + static_cast<std::ptrdiff_t>(i), clones.begin() + static_cast<std::ptrdiff_t>(i + 1), clones.end());
+            return clones[n - 1].clone.get();
+        }
+    }
+#else
+    (void)owner;
+    (void)generation;
+#endif
+    return nullptr;
+}
+
+SPDLOG_INLINE formatter *add(const void *owner, uint64_t generation, std::unique_ptr<formatter> clone)
+{
+#ifndef SPDLOG_NO_TLS
+    auto &clones = thread_clones();
+    // the previous generations of the owner are stale
+    for (size_t i = clones.size(); i > 0; i--)
+    {
+        if (clones[i - 1].owner == owner)
+        {
+            clones.erase(clones.begin() + static_cast<std::ptrdiff_t>(i - 1));
+        }
+    }
+    if (clones.size() >= SPDLOG_FORMATTER_CLONES_PER_THREAD)
+    {
+        clones.erase(clones.begin());
+    }
+    clones.push_back(clone_entry{owner, generation, std::move(clone)});
+    return clones.back().clone.get();
+#else
+    (void)owner;
+    (void)generation;
+    (void)clone;
+    return nullptr;
+#endif
+}
+
+} // namespace formatter_clones
+} // namespace details
+} // namespace spdlog
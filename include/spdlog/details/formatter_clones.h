@@ -0,0 +1,45 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Clones of the sink formatters per thread, to format outside the sink locks (see base_sink::set_parallel_format()).
+//
+// The formatters keep state between messages (e.g. the cached time), so the threads can't share one: each
+// thread keeps its own clone per owner (the sink) and generation. A sink takes a new generation at each
+// change of its formatter, and the generations are never reused - the clones of a destroyed sink, or of
+// its previous formatters, are never picked up again. They are dropped as the thread uses the formatters of
+// other sinks (least recently used first, past SPDLOG_FORMATTER_CLONES_PER_THREAD) or exits.
+//
+// Not available with SPDLOG_NO_TLS: nothing is kept, the sinks format under their lock.
+
+#include <spdlog/common.h>
+#include <spdlog/formatter.h>
+
+#include <cstdint>
+#include <memory>
+
+#ifndef SPDLOG_FORMATTER_CLONES_PER_THREAD
+#    define SPDLOG_FORMATTER_CLONES_PER_THREAD 8
+#endif
+
+namespace spdlog {
+namespace details {
+namespace formatter_clones {
+
+// a generation never returned before
+SPDLOG_API uint64_t new_generation() SPDLOG_NOEXCEPT;
+
+// the clone of the calling thread for owner and generation, nullptr if none
+SPDLOG_API formatter *find(const void *owner, uint64_t generation) SPDLOG_NOEXCEPT;
+
+// keep the clone for the calling thread and return it (nullptr with SPDLOG_NO_TLS)
+SPDLOG_API formatter *add(const void *owner, uint64_t generation, std::unique_ptr<formatter> clone);
+
+} // namespace formatter_clones
+} // namespace details
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "formatter_clones-inl.h"
+#endif
@@ -0,0 +1,319 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/details/frame_compressor.h>
+#endif
+
+#include <spdlog/details/os.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifdef SPDLOG_ZLIB
+#    include <zlib.h>
+#endif
+
+namespace spdlog {
+namespace details {
+
+struct frame_compressor::stream
+{
+#ifdef SPDLOG_ZLIB
+    z_stream z{};
+
+    ~stream()
+    {
+        deflateEnd(&z);
+    }
+#endif
+};
+
+#ifdef SPDLOG_ZLIB
+namespace frame_compression {
+// RAII over the log file and the zlib stream of read_range()
+struct inflate_state
+{
+    std::FILE *fd{nullptr};
+    z_stream z{};
+    bool initialized{false};
+
+    ~inflate_state()
+    {
+        if (initialized)
+        {
+            inflateEnd(&z);
+        }
+        if (fd != nullptr)
+        {
+            std::fclose(fd);
+        }
+    }
+};
+} // namespace frame_compression
+#endif
+
+SPDLOG_INLINE frame_compressor::frame_compressor(size_t frame_size)
+    : frame_size_(frame_size)
+{
+#ifdef SPDLOG_ZLIB
+    if (frame_size_ == 0)
+    {
+        throw_spdlog_ex("frame_compressor: frame size must be > 0");
+    }
+    stream_ = details::make_unique<stream>();
+    // window bits + 16: gzip header and trailer - a member per frame
+    if (deflateInit2(&stream_->z, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+        throw_spdlog_ex("Failed initializing zlib");
+    }
+    frame_data_.reserve(frame_size_);
+#else
+    throw_spdlog_ex("frame_compressor: compression requires spdlog built with SPDLOG_ZLIB");
+#endif
+}
+
+SPDLOG_INLINE frame_compressor::~frame_compressor()
+{
+    close();
+}
+
+SPDLOG_INLINE void frame_compressor::open(const filename_t &log_filename, size_t log_size)
+{
+    close();
+    filename_ = frames_filename(log_filename);
+    auto frames = log_size > 0 ? read_frames(log_filename) : std::vector<frame>();
+    if (os::fopen_s(&fd_, filename_, log_size == 0 ? SPDLOG_FILENAME_T("wb") : SPDLOG_FILENAME_T("ab")))
+    {
+        fd_ = nullptr;
+        throw_spdlog_ex("Failed opening file " + os::filename_to_str(filename_) + " for writing", errno);
+    }
+    offset_ = log_size;
+    data_offset_ = 0;
+    frame_data_.clear();
+    if (!frames.empty())
+    {
+        data_offset_ = frames.back().data_offset + frames.back().data_size;
+    }
+    else if (log_size > 0)
+    {
+        // written uncompressed
+        add_frame_(frame{0, 0, static_cast<uint64_t>(log_size), stored_frame});
+        data_offset_ = log_size;
+    }
+}
+
+SPDLOG_INLINE void frame_compressor::close()
+{
+    frame_data_.clear();
+    if (fd_ != nullptr)
+    {
+        std::fclose(fd_);
+        fd_ = nullptr;
+    }
+}
+
+SPDLOG_INLINE void frame_compressor::write(string_view_t data, memory_buf_t &out)
+{
+    auto *p = data.data();
+    auto left = data.size();
+    while (left > 0)
+    {
+        // whole frames are compressed in place
+        if (frame_data_.size() == 0 && left >= frame_size_)
+        {
+            compress_(p, frame_size_, out);
+            p += frame_size_;
+            left -= frame_size_;
+            continue;
+        }
+        auto n = (std::min)(left, frame_size_ - frame_data_.size());
+        frame_data_.append(p, p + n);
+        p += n;
+        left -= n;
+        if (frame_data_.size() == frame_size_)
+        {
+            finish_frame(out);
+        }
+    }
+}
+
+SPDLOG_INLINE void frame_compressor::finish_frame(memory_buf_t &out)
+{
+    if (frame_data_.size() == 0)
+    {
+        return;
+    }
+    // cleared first - the data is not compressed twice if it fails
+    auto size = frame_data_.size();
+    frame_data_.clear();
+    compress_(frame_data_.data(), size, out);
+}
+
+SPDLOG_INLINE size_t frame_compressor::data_size() const
+{
+    return static_cast<size_t>(data_offset_) + frame_data_.size();
+}
+
+SPDLOG_INLINE size_t frame_compressor::frame_size() const
+{
+    return frame_size_;
+}
+
+SPDLOG_INLINE filename_t frame_compressor::frames_filename(const filename_t &log_filename)
+{
+    return log_filename + SPDLOG_FILENAME_T(".frames");
+}
+
+SPDLOG_INLINE void frame_compressor::rename(const filename_t &log_filename, const filename_t &new_log_filename) SPDLOG_NOEXCEPT
+{
+    auto target = frames_filename(new_log_filename);
+    (void)os::remove_if_exists(target);
+    auto src = frames_filename(log_filename);
+    if (os::path_exists(src))
+    {
+        (void)os::rename(src, target);
+    }
+}
+
+SPDLOG_INLINE void frame_compressor::remove(const filename_t &log_filename) SPDLOG_NOEXCEPT
+{
+    (void)os::remove_if_exists(frames_filename(log_filename));
+}
+
+SPDLOG_INLINE std::vector<frame_compressor::frame> frame_compressor::read_frames(const filename_t &log_filename)
+{
+    std::vector<frame> frames;
+    std::FILE *fd;
+    if (os::fopen_s(&fd, frames_filename(log_filename), SPDLOG_FILENAME_T("rb")))
+    {
+        return frames;
+    }
+    frames.resize(os::filesize(fd) / sizeof(frame));
+    // an entry being written is left out
+    auto n = std::fread(frames.data(), sizeof(frame), frames.size(), fd);
+    std::fclose(fd);
+    frames.resize(n);
+    return frames;
+}
+
+SPDLOG_INLINE void frame_compressor::read_range(const filename_t &log_filename, size_t begin, size_t end, memory_buf_t &dest)
+{
+#ifdef SPDLOG_ZLIB
+    auto frames = read_frames(log_filename);
+    frame_compression::inflate_state state;
+    if (os::fopen_s(&state.fd, log_filename, SPDLOG_FILENAME_T("rb")))
+    {
+        state.fd = nullptr;
+        throw_spdlog_ex("Failed opening file " + os::filename_to_str(log_filename) + " for reading", errno);
+    }
+    if (inflateInit2(&state.z, 15 + 16) != Z_OK)
+    {
+        throw_spdlog_ex("Failed initializing zlib");
+    }
+    state.initialized = true;
+    auto file_size = static_cast<uint64_t>(os::filesize(state.fd));
+    std::vector<unsigned char> in;
+    memory_buf_t data;
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+        const auto &f = frames[i];
+        if (f.data_offset + f.data_size <= begin)
+        {
+            continue;
+        }
+        if (f.data_offset >= end)
+        {
+            break;
+        }
+        // a frame listed before being written is incomplete in the file
+        auto frame_end = i + 1 < frames.size() ? frames[i + 1].offset : file_size;
+        if (frame_end > file_size || frame_end <= f.offset)
+        {
+            break;
+        }
+        in.resize(static_cast<size_t>(frame_end - f.offset));
+        if (std::fseek(state.fd, static_cast<long>(f.offset), SEEK_SET) != 0 || std::fread(in.data(), 1, in.size(), state.fd) != in.size())
+        {
+            throw_spdlog_ex("Failed reading file " + os::filename_to_str(log_filename), errno);
+        }
+        data.resize(static_cast<size_t>(f.data_size));
+        if ((f.flags & stored_frame) != 0)
+        {
+            if (in.size() < data.size())
+            {
+                break;
+            }
+            std::memcpy(data.data(), in.data(), data.size());
+        }
+        else
+        {
+            inflateReset(&state.z);
+            state.z.next_in = in.data();
+            state.z.avail_in = static_cast<uInt>(in.size());
+            state.z.next_out = reinterpret_cast<Bytef *>(data.data());
+            state.z.avail_out = static_cast<uInt>(data.size());
+            if (inflate(&state.z, Z_FINISH) != Z_STREAM_END || state.z.avail_out != 0)
+            {
+                break; // being written
+            }
+        }
+        auto from = static_cast<size_t>((std::max)(static_cast<uint64_t>(begin), f.data_offset) - f.data_offset);
+        auto to = static_cast<size_t>((std::min)(static_cast<uint64_t>(end), f.data_offset + f.data_size) - f.data_offset);
+        dest.append(data.data() + from, data.data() + to);
+    }
+#else
+    (void)begin;
+    (void)end;
+    (void)dest;
+    throw_spdlog_ex("Failed reading file " + os::filename_to_str(log_filename) + ": spdlog was built without SPDLOG_ZLIB");
+#endif
+}
+
+SPDLOG_INLINE void frame_compressor::compress_(const char *data, size_t size, memory_buf_t &out)
+{
+#ifdef SPDLOG_ZLIB
+    auto &z = stream_->z;
+    deflateReset(&z);
+    auto start = out.size();
+    auto bound = static_cast<size_t>(deflateBound(&z, static_cast<uLong>(size)));
+    out.resize(start + bound);
+    z.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+    z.avail_in = static_cast<uInt>(size);
+    z.next_out = reinterpret_cast<Bytef *>(out.data() + start);
+    z.avail_out = static_cast<uInt>(bound);
+    if (deflate(&z, Z_FINISH) != Z_STREAM_END)
+    {
+        out.resize(start);
+        throw_spdlog_ex("Failed compressing to file " + os::filename_to_str(filename_));
+    }
+    auto compressed = bound - z.avail_out;
+    out.resize(start + compressed);
+    add_frame_(frame{offset_, data_offset_, static_cast<uint64_t>(size), 0});
+    offset_ += compressed;
+    data_offset_ += size;
+#else
+    (void)data;
+    (void)size;
+    (void)out;
+#endif
+}
+
+SPDLOG_INLINE void frame_compressor::add_frame_(const frame &f)
+{
+    if (fd_ == nullptr)
+    {
+        return;
+    }
+    // flushed as written: the readers see the frames of the log file being written
+    if (std::fwrite(&f, sizeof(f), 1, fd_) != 1 || std::fflush(fd_) != 0)
+    {
+        throw_spdlog_ex("Failed writing to file " + os::filename_to_str(filename_), errno);
+    }
+}
+
+} // namespace details
+} // namespace spdlog
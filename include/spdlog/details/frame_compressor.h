@@ -0,0 +1,98 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Streaming gzip compression of a log file being written (SPDLOG_ZLIB), see file_helper::set_compression().
+//
+// The log data is compressed in independent frames of frame_size bytes: each frame is a complete gzip
+// member, written when full and on flush. Concatenated members are a valid gzip file - zcat reads the
+// whole file, even while it is written (up to the last complete frame).
+//
+// The frames are listed in the sidecar file "<log file>.frames": an entry per frame (offset in the log
+// file, offset and size of its data in the uncompressed log), native byte order. read_range() decompresses
+// only the frames of a range of the uncompressed log - e.g. found in the time index (see time_index.h).
+//
+// The data of a file written before its compression was enabled is kept as is, in a stored frame
+// (the file is not readable by zcat then).
+//
+// Throw spdlog_ex exception on errors.
+// Not thread safe - the file helper serializes the access to it.
+
+#include <spdlog/common.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+namespace spdlog {
+namespace details {
+
+class SPDLOG_API frame_compressor
+{
+public:
+    static constexpr size_t default_frame_size = 64 * 1024;
+
+    struct frame
+    {
+        uint64_t offset;      // in the log file
+        uint64_t data_offset; // in the uncompressed log
+        uint64_t data_size;
+        uint64_t flags;
+    };
+
+    static const uint64_t stored_frame = 1; // not compressed
+
+    // throw if spdlog was built without SPDLOG_ZLIB
+    explicit frame_compressor(size_t frame_size = default_frame_size);
+    frame_compressor(const frame_compressor &) = delete;
+    frame_compressor &operator=(const frame_compressor &) = delete;
+    ~frame_compressor();
+
+    // compress the data written to the log file from its current size on. the frame table of an empty
+    // log file is truncated.
+    void open(const filename_t &log_filename, size_t log_size);
+    // the current frame is dropped - complete it first
+    void close();
+    // compress data, the frames completed are appended to out - to write to the log file
+    void write(string_view_t data, memory_buf_t &out);
+    // complete the current frame (if any data) into out
+    void finish_frame(memory_buf_t &out);
+    // of the uncompressed log, the current frame included
+    size_t data_size() const;
+    size_t frame_size() const;
+
+    // "logs/mylog.txt" => "logs/mylog.txt.frames"
+    static filename_t frames_filename(const filename_t &log_filename);
+    // move / remove the frame table of a log file, if any
+    static void rename(const filename_t &log_filename, const filename_t &new_log_filename) SPDLOG_NOEXCEPT;
+    static void remove(const filename_t &log_filename) SPDLOG_NOEXCEPT;
+
+    // the frames of the log file (none if it is not compressed)
+    static std::vector<frame> read_frames(const filename_t &log_filename);
+    // append the uncompressed log data [begin, end) of the compressed log file to dest - end = SIZE_MAX for
+    // the end of the file. only the frames of the range are read. a frame being written is left out.
+    static void read_range(const filename_t &log_filename, size_t begin, size_t end, memory_buf_t &dest);
+
+private:
+    struct stream;
+
+    size_t frame_size_;
+    std::unique_ptr<stream> stream_;
+    memory_buf_t frame_data_;
+    std::FILE *fd_{nullptr};
+    filename_t filename_;
+    uint64_t offset_{0};      // of the next frame in the log file
+    uint64_t data_offset_{0}; // of the current frame in the uncompressed log
+
+    void compress_(const char *data, size_t size, memory_buf_t &out);
+    void add_frame_(const frame &f);
+};
+
+} // namespace details
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "frame_compressor-inl.h"
+#endif
@@ -0,0 +1,109 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Hex encoding of byte runs, for spdlog::to_hex (see fmt/bin_to_hex.h).
+// 16 bytes at a time with SSE2 or NEON, the tail (and other cpus) through a byte pair table.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    include <emmintrin.h>
+#    define SPDLOG_HEX_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#    include <arm_neon.h>
+#    define SPDLOG_HEX_NEON
+#endif
+
+namespace spdlog {
+namespace details {
+namespace hex {
+
+// the two hex chars of each byte value
+struct pair_table
+{
+    char chars[256][2];
+
+    explicit pair_table(const char *digits)
+    {
+        for (int i = 0; i < 256; i++)
+        {
+            chars[i][0] = digits[i >> 4];
+            chars[i][1] = digits[i & 0x0f];
+        }
+    }
+};
+
+inline const pair_table &pairs(bool upper)
+{
+    static const pair_table lower_table("0123456789abcdef");
+    static const pair_table upper_table("0123456789ABCDEF");
+    return upper ? upper_table : lower_table;
+}
+
+// write the 2 * n hex chars of src to dest
+inline void encode(const unsigned char *src, size_t n, char *dest, bool upper)
+{
+    size_t i = 0;
+#if defined(SPDLOG_HEX_SSE2)
+    // nibble + '0', plus the distance to 'a' (or 'A') past 9
+    const __m128i mask = _mm_set1_epi8(0x0f);
+    const __m128i nine = _mm_set1_epi8(9);
+    const __m128i zero = _mm_set1_epi8('0');
+    const __m128i alpha = _mm_set1_epi8(static_cast<char>(upper ? 'A' - '0' - 10 : 'a' - '0' - 10));
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        __m128i hi = _mm_and_si128(_mm_srli_epi16(bytes, 4), mask);
+        __m128i lo = _mm_and_si128(bytes, mask);
+        hi = _mm_add_epi8(_mm_add_epi8(hi, zero), _mm_and_si128(_mm_cmpgt_epi8(hi, nine), alpha));
+        lo = _mm_add_epi8(_mm_add_epi8(lo, zero), _mm_and_si128(_mm_cmpgt_epi8(lo, nine), alpha));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dest + 2 * i), _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dest + 2 * i + 16), _mm_unpackhi_epi8(hi, lo));
+    }
+#elif defined(SPDLOG_HEX_NEON)
+    const uint8x16_t mask = vdupq_n_u8(0x0f);
+    const uint8x16_t nine = vdupq_n_u8(9);
+    const uint8x16_t zero = vdupq_n_u8('0');
+    const uint8x16_t alpha = vdupq_n_u8(static_cast<uint8_t>(upper ? 'A' - '0' - 10 : 'a' - '0' - 10));
+    for (; i + 16 <= n; i += 16)
+    {
+        uint8x16_t bytes = vld1q_u8(src + i);
+        uint8x16_t hi = vshrq_n_u8(bytes, 4);
+        uint8x16_t lo = vandq_u8(bytes, mask);
+        hi = vaddq_u8(vaddq_u8(hi, zero), vandq_u8(vcgtq_u8(hi, nine), alpha));
+        lo = vaddq_u8(vaddq_u8(lo, zero), vandq_u8(vcgtq_u8(lo, nine), alpha));
+        uint8x16x2_t chars = vzipq_u8(hi, lo);
+        vst1q_u8(reinterpret_cast<uint8_t *>(dest + 2 * i), chars.val[0]);
+        vst1q_u8(reinterpret_cast<uint8_t *>(dest + 2 * i + 16), chars.val[1]);
+    }
+#endif
+    const auto &table = pairs(upper);
+    for (; i < n; i++)
+    {
+        std::memcpy(dest + 2 * i, table.chars[src[i]], 2);
+    }
+}
+
+// write the hex chars of src to dest, separated by delimiter (3 * n - 1 chars, n > 0).
+// dest must have room for 3 * n chars: each byte is written as one 4 bytes store of its chars
+// followed by the delimiter, the next byte overwriting the last of them.
+inline void encode_delimited(const unsigned char *src, size_t n, char *dest, char delimiter, bool upper)
+{
+    const auto &table = pairs(upper);
+    dest[0] = table.chars[src[0]][0];
+    dest[1] = table.chars[src[0]][1];
+    char *out = dest + 2;
+    for (size_t i = 1; i < n; i++, out += 3)
+    {
+        char chars[4] = {delimiter, table.chars[src[i]][0], table.chars[src[i]][1], delimiter};
+        std::memcpy(out, chars, 4);
+    }
+}
+
+} // namespace hex
+} // namespace details
+} // namespace spdlog
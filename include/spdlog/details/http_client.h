@@ -0,0 +1,135 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Minimal HTTP/1.1 client posting requests to a collector (otlp_sink, http_bulk_sink).
+// Plain http over a kept-alive tcp connection, reconnected when needed. The bodies of the responses are skipped.
+// Not thread safe - used by the background thread of a sink only.
+
+#include <spdlog/common.h>
+#ifdef _WIN32
+#    include <spdlog/details/tcp_client-windows.h>
+#else
+#    include <spdlog/details/tcp_client.h>
+#endif
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace spdlog {
+namespace details {
+
+class http_client
+{
+public:
+    using headers = std::vector<std::pair<std::string, std::string>>;
+
+    http_client(std::string host, int port)
+        : host_{std::move(host)}
+        , port_{port}
+    {}
+
+    // POST the body to path, return the http status of the response - 0 if none (failed to connect or to send,
+    // timeout). Never throws. content_encoding is omitted if empty.
+    int post(const std::string &path, string_view_t content_type, string_view_t content_encoding, const headers &extra_headers,
+        const memory_buf_t &body, std::chrono::milliseconds timeout)
+    {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        SPDLOG_TRY
+        {
+            if (!client_.is_connected())
+            {
+                client_.connect(host_, port_);
+            }
+            memory_buf_t request;
+            fmt::format_to(std::back_inserter(request), "POST {} HTTP/1.1\r\nHost: {}:{}\r\nContent-Type: {}\r\nContent-Length: {}\r\n", path,
+                host_, port_, content_type, body.size());
+            if (content_encoding.size() > 0)
+            {
+                fmt::format_to(std::back_inserter(request), "Content-Encoding: {}\r\n", content_encoding);
+            }
+            for (auto &header : extra_headers)
+            {
+                fmt::format_to(std::back_inserter(request), "{}: {}\r\n", header.first, header.second);
+            }
+            fmt::format_to(std::back_inserter(request), "\r\n");
+            if (send_all_(request.data(), request.size(), deadline) && send_all_(body.data(), body.size(), deadline))
+            {
+                return read_response_(deadline);
+            }
+        }
+        SPDLOG_CATCH_STD
+        client_.close();
+        return 0;
+    }
+
+private:
+    bool send_all_(const char *data, size_t size, std::chrono::steady_clock::time_point deadline)
+    {
+        size_t sent = 0;
+        while (sent < size)
+        {
+            if (std::chrono::steady_clock::now() >= deadline)
+            {
+                return false;
+            }
+            sent += client_.send_some(data + sent, size - sent, 100);
+        }
+        return true;
+    }
+
+    // read the response (its body is skipped). the connection is kept alive if the response has a length.
+    int read_response_(std::chrono::steady_clock::time_point deadline)
+    {
+        std::string response;
+        char chunk[4096];
+        size_t headers_end;
+        while ((headers_end = response.find("\r\n\r\n")) == std::string::npos)
+        {
+            if (std::chrono::steady_clock::now() >= deadline)
+            {
+                client_.close();
+                return 0;
+            }
+            response.append(chunk, client_.recv_some(chunk, sizeof(chunk), 100));
+        }
+        auto response_headers = response.substr(0, headers_end + 2);
+        std::transform(response_headers.begin(), response_headers.end(), response_headers.begin(),
+            [](char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+        auto status_pos = response_headers.find(' ');
+        int status = status_pos != std::string::npos ? std::atoi(response_headers.c_str() + status_pos + 1) : 0;
+
+        auto length_pos = response_headers.find("\r\ncontent-length:");
+        if (length_pos == std::string::npos || response_headers.find("\r\nconnection: close") != std::string::npos)
+        {
+            client_.close();
+            return status;
+        }
+        auto length = static_cast<size_t>(std::strtoull(response_headers.c_str() + length_pos + 17, nullptr, 10));
+        auto received = response.size() - headers_end - 4;
+        while (received < length)
+        {
+            if (std::chrono::steady_clock::now() >= deadline)
+            {
+                client_.close();
+                return status;
+            }
+            received += client_.recv_some(chunk, (std::min)(sizeof(chunk), length - received), 100);
+        }
+        return status;
+    }
+
+    std::string host_;
+    int port_;
+    tcp_client client_;
+};
+
+} // namespace details
+} // namespace spdlog
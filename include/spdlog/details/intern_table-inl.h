@@ -0,0 +1,95 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/details/intern_table.h>
+#endif
+
+#include <cstring>
+
+namespace spdlog {
+namespace details {
+
+SPDLOG_INLINE intern_table &intern_table::instance()
+{
+    static intern_table *s_instance = new intern_table();
+    return *s_instance;
+}
+
+SPDLOG_INLINE uint32_t intern_table::intern(string_view_t text)
+{
+    if (text.size() > max_fragment_size || text.data() == nullptr)
+    {
+        return 0;
+    }
+
+    // open addressing by the (pointer) key, linear probing
+    auto hash = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(text.data())) * 0x9E3779B97F4A7C15ULL;
+    auto index = static_cast<size_t>(hash >> 32) % capacity;
+    const entry *fresh = nullptr; // copied once, published in the first free slot
+    uint32_t id = 0;
+    for (size_t probe = 0; probe < max_probes; probe++, index = (index + 1) % capacity)
+    {
+        auto &s = slots_[index];
+        const entry *e = s.value.load(std::memory_order_acquire);
+        if (e == nullptr)
+        {
+            if (fresh == nullptr)
+            {
+                fresh = make_entry_(text);
+            }
+            if (s.value.compare_exchange_strong(e, fresh, std::memory_order_acq_rel, std::memory_order_acquire))
+            {
+                size_.fetch_add(1, std::memory_order_relaxed);
+                return static_cast<uint32_t>(index + 1);
+            }
+            // e is the entry published by another thread in the meantime
+        }
+        if (e->key != text.data())
+        {
+            continue;
+        }
+
+        // same address - check it's the same text
+        if (e->size == text.size() && std::memcmp(e->text, text.data(), text.size()) == 0)
+        {
+            id = static_cast<uint32_t>(index + 1);
+        }
+        break;
+    }
+    free_entry_(fresh);
+    return id;
+}
+
+SPDLOG_INLINE string_view_t intern_table::fragment(uint32_t id) const
+{
+    const auto *e = slots_[id - 1].value.load(std::memory_order_acquire);
+    return string_view_t{e->text, e->size};
+}
+
+SPDLOG_INLINE const intern_table::entry *intern_table::make_entry_(string_view_t text)
+{
+    auto *copy = new char[text.size() + 1];
+    std::memcpy(copy, text.data(), text.size());
+    copy[text.size()] = '\0';
+    return new entry{text.data(), copy, text.size()};
+}
+
+SPDLOG_INLINE void intern_table::free_entry_(const entry *e)
+{
+    if (e != nullptr)
+    {
+        delete[] e->text;
+        delete e;
+    }
+}
+
+SPDLOG_INLINE size_t intern_table::size() const
+{
+    return size_.load(std::memory_order_relaxed);
+}
+
+} // namespace details
+} // namespace spdlog
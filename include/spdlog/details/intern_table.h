@@ -0,0 +1,84 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <spdlog/common.h>
+
+#include <atomic>
+#include <cstdint>
+
+namespace spdlog {
+namespace details {
+
+// Process wide table of interned text fragments (the format strings of the log calls),
+// keyed by their address.
+//
+// The table keeps its own copy of each fragment, and a lookup checks the text against it,
+// so a fragment whose address is reused for different text (e.g. fmt::runtime() of a temporary)
+// is simply not interned. Messages whose payload is an interned fragment carry its id (see
+// log_msg::payload_id) and point at the copy in the table, which lives as long as the process:
+// copies of the message (async queue, backtrace) don't need to copy the text, and sinks can
+// compare or index messages by id.
+//
+// Lookups and insertions are lock free: an entry is copied before it is published in its slot,
+// so a lookup never waits for an insertion, and a copy that lost the race for a slot is freed.
+// A fragment is looked up in at most max_probes slots, so lookups stay short when the table fills up.
+// The table and its copies are never freed, so messages still queued while the process
+// exits (e.g. flushed by the registry's destruction) keep valid payloads.
+//
+// Only the fragments of literals should be interned (see logger::intern_payload_()): each distinct
+// address takes a slot for good.
+class SPDLOG_API intern_table
+{
+public:
+    static const size_t capacity = 4096;
+    // longer fragments are not interned
+    static const size_t max_fragment_size = 1024;
+    // fragments not found or inserted within this many slots (from their hash) are not interned
+    static const size_t max_probes = 16;
+
+    static intern_table &instance();
+
+    intern_table() = default;
+    intern_table(const intern_table &) = delete;
+    intern_table &operator=(const intern_table &) = delete;
+
+    // return the id (1..capacity) of the fragment at the given address, interning it if needed.
+    // return 0 if it is not interned (no free slot within max_probes, fragment too long, or address
+    // reused for other text).
+    uint32_t intern(string_view_t text);
+
+    // return the interned copy of the given id (as returned by intern()).
+    string_view_t fragment(uint32_t id) const;
+
+    // number of interned fragments
+    size_t size() const;
+
+private:
+    // immutable once published
+    struct entry
+    {
+        const char *key;  // the address the fragment was interned with
+        const char *text; // the copy
+        size_t size;
+    };
+
+    struct slot
+    {
+        std::atomic<const entry *> value{nullptr};
+    };
+
+    static const entry *make_entry_(string_view_t text);
+    static void free_entry_(const entry *e);
+
+    slot slots_[capacity];
+    std::atomic<size_t> size_{0};
+};
+
+} // namespace details
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "intern_table-inl.h"
+#endif
@@ -0,0 +1,56 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <spdlog/common.h>
+#include <spdlog/details/log_msg.h>
+
+#include <cstring>
+#include <vector>
+
+namespace spdlog {
+namespace details {
+
+// A line of the messages logged at once by logger::log_lines() (see spdlog/log_batch.h).
+// the texts of the lines are back to back: each one takes the next size bytes.
+struct log_line
+{
+    size_t size;
+    log_clock::time_point time;
+};
+
+// call f with the message of each line, sharing the other fields of msg - whose payload is the text of the lines.
+// lines holds the log_line entries, possibly unaligned (e.g. kept in a queued message). allocates nothing.
+template<typename F>
+inline void foreach_log_line(const log_msg &msg, string_view_t lines, F f)
+{
+    log_msg line_msg(msg);
+    line_msg.payload_id = 0;
+    size_t offset = 0;
+    for (size_t pos = 0; pos + sizeof(log_line) <= lines.size(); pos += sizeof(log_line))
+    {
+        log_line line;
+        std::memcpy(&line, lines.data() + pos, sizeof(log_line));
+        line_msg.time = line.time;
+        line_msg.payload = string_view_t(msg.payload.data() + offset, line.size);
+        offset += line.size;
+        f(line_msg);
+    }
+}
+
+inline string_view_t log_lines_view(const log_line *lines, size_t n_lines)
+{
+    return string_view_t(reinterpret_cast<const char *>(lines), n_lines * sizeof(log_line));
+}
+
+// the messages of the lines, to pass them to sink::log_batch()
+inline void log_lines_to_msgs(const log_msg &msg, string_view_t lines, std::vector<log_msg> &msgs)
+{
+    msgs.clear();
+    msgs.reserve(lines.size() / sizeof(log_line));
+    foreach_log_line(msg, lines, [&msgs](const log_msg &line_msg) { msgs.push_back(line_msg); });
+}
+
+} // namespace details
+} // namespace spdlog
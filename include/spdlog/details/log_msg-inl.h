@@ -7,6 +7,7 @@
 #    include <spdlog/details/log_msg.h>
 #endif
 
+#include <spdlog/details/mdc.h>
 #include <spdlog/details/os.h>
 
 namespace spdlog {
@@ -22,16 +23,63 @@ SPDLOG_INLINE log_msg::log_msg(spdlog::log_clock::time_point log_time, spdlog::s
 #endif
     , source(loc)
     , payload(msg)
-{}
+#ifndef SPDLOG_NO_TLS
+    , trace(thread_trace_context())
+#endif
+{
+#ifndef SPDLOG_NO_TLS
+    const auto &mdc = thread_mdc();
+    mdc_fields = mdc.fields();
+    n_mdc_fields = mdc.size();
+#endif
+}
 
 SPDLOG_INLINE log_msg::log_msg(
     spdlog::source_loc loc, string_view_t a_logger_name, spdlog::level::level_enum lvl, spdlog::string_view_t msg)
     : log_msg(os::now(), loc, a_logger_name, lvl, msg)
 {}
 
+SPDLOG_INLINE log_msg::log_msg(
+    spdlog::source_loc loc, string_view_t a_logger_name, spdlog::level::level_enum lvl, spdlog::string_view_t msg, unsigned captured)
+    : logger_name(a_logger_name)
+    , level(lvl)
+    , source(loc)
+    , payload(msg)
+{
+    if (captured & msg_fields::time)
+    {
+        time = os::now();
+    }
+#ifndef SPDLOG_NO_THREAD_ID
+    if (captured & msg_fields::thread_id)
+    {
+        thread_id = os::thread_id();
+    }
+#endif
+#ifndef SPDLOG_NO_TLS
+    if (captured & msg_fields::context)
+    {
+        trace = thread_trace_context();
+        const auto &mdc = thread_mdc();
+        mdc_fields = mdc.fields();
+        n_mdc_fields = mdc.size();
+    }
+#endif
+}
+
 SPDLOG_INLINE log_msg::log_msg(string_view_t a_logger_name, spdlog::level::level_enum lvl, spdlog::string_view_t msg)
     : log_msg(os::now(), source_loc{}, a_logger_name, lvl, msg)
 {}
 
+SPDLOG_INLINE trace_context &thread_trace_context()
+{
+#ifndef SPDLOG_NO_TLS
+    static thread_local trace_context context{};
+#else
+    static trace_context context{}; // not stamped on the messages
+#endif
+    return context;
+}
+
 } // namespace details
 } // namespace spdlog
@@ -8,11 +8,28 @@
 
 namespace spdlog {
 namespace details {
+
+// the log_msg fields that cost something to capture when a message is created: a message is
+// created with the fields read by the formatters and sinks of its logger only, the others are left
+// empty (see formatter::required_fields() and sinks::sink::required_fields())
+namespace msg_fields {
+enum : unsigned
+{
+    none = 0,
+    time = 1,
+    thread_id = 2,
+    context = 4, // the trace context and mdc fields of the thread (thread locals)
+    all = time | thread_id | context
+};
+} // namespace msg_fields
+
 struct SPDLOG_API log_msg
 {
     log_msg() = default;
     log_msg(log_clock::time_point log_time, source_loc loc, string_view_t logger_name, level::level_enum lvl, string_view_t msg);
     log_msg(source_loc loc, string_view_t logger_name, level::level_enum lvl, string_view_t msg);
+    // capture only the given msg_fields
+    log_msg(source_loc loc, string_view_t logger_name, level::level_enum lvl, string_view_t msg, unsigned captured);
     log_msg(string_view_t logger_name, level::level_enum lvl, string_view_t msg);
     log_msg(const log_msg &other) = default;
     log_msg &operator=(const log_msg &other) = default;
@@ -28,7 +45,26 @@ struct SPDLOG_API log_msg
 
     source_loc source;
     string_view_t payload;
+    // id of the interned fragment the payload points to (see intern_table), 0 if not interned
+    uint32_t payload_id{0};
+
+    // key/value fields of structured log messages (see logger::log(loc, lvl, msg, fields..))
+    const field *fields{nullptr};
+    size_t n_fields{0};
+
+    // 1 in sample_rate messages of its logger and level were logged (see logger::set_sample_rate)
+    uint32_t sample_rate{1};
+
+    // the trace context of the logging thread when the message was created
+    trace_context trace{};
+
+    // the mapped diagnostic context of the logging thread (see spdlog/mdc.h)
+    const field *mdc_fields{nullptr};
+    size_t n_mdc_fields{0};
 };
+
+// the trace context stamped on the messages created by the calling thread (none with SPDLOG_NO_TLS)
+SPDLOG_API trace_context &thread_trace_context();
 } // namespace details
 } // namespace spdlog
 
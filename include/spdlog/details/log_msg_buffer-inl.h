@@ -13,20 +13,52 @@ namespace details {
 SPDLOG_INLINE log_msg_buffer::log_msg_buffer(const log_msg &orig_msg)
     : log_msg{orig_msg}
 {
+    fit_budget(orig_msg);
     buffer.append(logger_name.begin(), logger_name.end());
-    buffer.append(payload.begin(), payload.end());
+    if (payload_id == 0)
+    {
+        buffer.append(payload.begin(), payload.end());
+    }
+    copy_fields(orig_msg);
+    update_string_views();
+}
+
+SPDLOG_INLINE log_msg_buffer::log_msg_buffer(const log_msg &orig_msg, string_view_t extra, bool reference_name)
+    : log_msg{orig_msg}
+    , logger_name_referenced{reference_name}
+{
+    if (extra.size() == 0)
+    {
+        fit_budget(orig_msg);
+    }
+    if (!logger_name_referenced)
+    {
+        buffer.append(logger_name.begin(), logger_name.end());
+    }
+    if (payload_id == 0)
+    {
+        buffer.append(payload.begin(), payload.end());
+    }
+    copy_fields(orig_msg);
+    buffer.append(extra.begin(), extra.end());
     update_string_views();
 }
 
 SPDLOG_INLINE log_msg_buffer::log_msg_buffer(const log_msg_buffer &other)
     : log_msg{other}
+    , fields_buffer{other.fields_buffer}
+    , fields_text_size{other.fields_text_size}
+    , logger_name_referenced{other.logger_name_referenced}
 {
-    buffer.append(logger_name.begin(), logger_name.end());
-    buffer.append(payload.begin(), payload.end());
+    buffer.append(other.buffer.data(), other.buffer.data() + other.buffer.size());
     update_string_views();
 }
 
-SPDLOG_INLINE log_msg_buffer::log_msg_buffer(log_msg_buffer &&other) SPDLOG_NOEXCEPT : log_msg{other}, buffer{std::move(other.buffer)}
+SPDLOG_INLINE log_msg_buffer::log_msg_buffer(log_msg_buffer &&other) SPDLOG_NOEXCEPT : log_msg{other},
+                                                                                       buffer{std::move(other.buffer)},
+                                                                                       fields_buffer{std::move(other.fields_buffer)},
+                                                                                       fields_text_size{other.fields_text_size},
+                                                                                       logger_name_referenced{other.logger_name_referenced}
 {
     update_string_views();
 }
@@ -36,6 +68,9 @@ SPDLOG_INLINE log_msg_buffer &log_msg_buffer::operator=(const log_msg_buffer &ot
     log_msg::operator=(other);
     buffer.clear();
     buffer.append(other.buffer.data(), other.buffer.data() + other.buffer.size());
+    fields_buffer = other.fields_buffer;
+    fields_text_size = other.fields_text_size;
+    logger_name_referenced = other.logger_name_referenced;
     update_string_views();
     return *this;
 }
@@ -44,14 +79,90 @@ SPDLOG_INLINE log_msg_buffer &log_msg_buffer::operator=(log_msg_buffer &&other)
 {
     log_msg::operator=(other);
     buffer = std::move(other.buffer);
+    fields_buffer = std::move(other.fields_buffer);
+    fields_text_size = other.fields_text_size;
+    logger_name_referenced = other.logger_name_referenced;
     update_string_views();
     return *this;
 }
 
+SPDLOG_INLINE string_view_t log_msg_buffer::extra() const
+{
+    auto strings_size = buffered_name_size() + buffered_payload_size() + fields_text_size;
+    return string_view_t{buffer.data() + strings_size, buffer.size() - strings_size};
+}
+
+SPDLOG_INLINE size_t log_msg_buffer::buffered_name_size() const
+{
+    return logger_name_referenced ? 0 : logger_name.size();
+}
+
+SPDLOG_INLINE size_t log_msg_buffer::buffered_payload_size() const
+{
+    return payload_id == 0 ? payload.size() : 0;
+}
+
+// cut the payload to the room left in the inline buffer, if storing it would spill past the memory budget
+SPDLOG_INLINE void log_msg_buffer::fit_budget(const log_msg &orig_msg)
+{
+    if (payload_id != 0)
+    {
+        return;
+    }
+    auto other_size = buffered_name_size();
+    for (size_t i = 0; i < orig_msg.n_fields; i++)
+    {
+        other_size += orig_msg.fields[i].key.size() + orig_msg.fields[i].string_value.size();
+    }
+    for (size_t i = 0; i < orig_msg.n_mdc_fields; i++)
+    {
+        other_size += orig_msg.mdc_fields[i].key.size() + orig_msg.mdc_fields[i].string_value.size();
+    }
+    auto size = other_size + payload.size();
+    if (size <= SPDLOG_MSG_BUFFER_SIZE || !memory_account::over_budget(size))
+    {
+        return;
+    }
+    auto room = other_size < SPDLOG_MSG_BUFFER_SIZE ? SPDLOG_MSG_BUFFER_SIZE - other_size : 0;
+    payload = string_view_t{payload.data(), room};
+    memory_account::count_truncated();
+}
+
+// the fields, then the mdc fields
+SPDLOG_INLINE void log_msg_buffer::copy_fields(const log_msg &orig_msg)
+{
+    fields_buffer.assign(orig_msg.fields, orig_msg.fields + orig_msg.n_fields);
+    fields_buffer.insert(fields_buffer.end(), orig_msg.mdc_fields, orig_msg.mdc_fields + orig_msg.n_mdc_fields);
+    fields_text_size = 0;
+    for (const auto &f : fields_buffer)
+    {
+        buffer.append(f.key.begin(), f.key.end());
+        buffer.append(f.string_value.begin(), f.string_value.end());
+        fields_text_size += f.key.size() + f.string_value.size();
+    }
+}
+
 SPDLOG_INLINE void log_msg_buffer::update_string_views()
 {
-    logger_name = string_view_t{buffer.data(), logger_name.size()};
-    payload = string_view_t{buffer.data() + logger_name.size(), payload.size()};
+    if (!logger_name_referenced)
+    {
+        logger_name = string_view_t{buffer.data(), logger_name.size()};
+    }
+    if (payload_id == 0)
+    {
+        payload = string_view_t{buffer.data() + buffered_name_size(), payload.size()};
+    }
+
+    auto *data = buffer.data() + buffered_name_size() + buffered_payload_size();
+    for (auto &f : fields_buffer)
+    {
+        f.key = string_view_t{data, f.key.size()};
+        data += f.key.size();
+        f.string_value = string_view_t{data, f.string_value.size()};
+        data += f.string_value.size();
+    }
+    fields = n_fields > 0 ? fields_buffer.data() : nullptr;
+    mdc_fields = n_mdc_fields > 0 ? fields_buffer.data() + n_fields : nullptr;
 }
 
 } // namespace details
@@ -4,25 +4,55 @@
 #pragma once
 
 #include <spdlog/details/log_msg.h>
+#include <spdlog/details/memory_account.h>
+
+#include <vector>
+
+// Inline capacity of the stored messages (async queues, backtracer, ringbuffer sink), independently of the
+// formatting buffers' (memory_buf_t). Longer messages allocate their storage (counted, see memory_account.h).
+#ifndef SPDLOG_MSG_BUFFER_SIZE
+#    define SPDLOG_MSG_BUFFER_SIZE 250
+#endif
 
 namespace spdlog {
 namespace details {
 
+using msg_storage_buf_t = fmt::basic_memory_buffer<char, SPDLOG_MSG_BUFFER_SIZE, counting_allocator<char>>;
+
 // Extend log_msg with internal buffer to store its payload.
 // This is needed since log_msg holds string_views that points to stack data.
+// Interned payloads (payload_id != 0) are static and not copied, nor is the logger name if
+// referenced (the logger then has to outlive the message, e.g. queued by an async logger).
+// Over the memory budget, the payload is cut to fit the inline buffer (unless it is a format string).
 
 class SPDLOG_API log_msg_buffer : public log_msg
 {
-    memory_buf_t buffer;
+    msg_storage_buf_t buffer;
+    // copies of the fields and mdc fields, their keys and string values are kept in the buffer after the payload
+    std::vector<field, counting_allocator<field>> fields_buffer;
+    size_t fields_text_size{0};
+    bool logger_name_referenced{false};
+    size_t buffered_name_size() const;
+    size_t buffered_payload_size() const;
+    void fit_budget(const log_msg &orig_msg);
+    void copy_fields(const log_msg &orig_msg);
     void update_string_views();
 
 public:
     log_msg_buffer() = default;
     explicit log_msg_buffer(const log_msg &orig_msg);
+    // keep extra bytes (e.g. deferred format args) after the message's strings
+    log_msg_buffer(const log_msg &orig_msg, string_view_t extra, bool reference_name = false);
     log_msg_buffer(const log_msg_buffer &other);
     log_msg_buffer(log_msg_buffer &&other) SPDLOG_NOEXCEPT;
     log_msg_buffer &operator=(const log_msg_buffer &other);
     log_msg_buffer &operator=(log_msg_buffer &&other) SPDLOG_NOEXCEPT;
+
+    string_view_t extra() const;
+    bool references_logger_name() const
+    {
+        return logger_name_referenced;
+    }
 };
 
 } // namespace details
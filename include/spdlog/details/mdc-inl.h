@@ -0,0 +1,97 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/details/mdc.h>
+#endif
+
+namespace spdlog {
+namespace details {
+
+SPDLOG_INLINE void mdc_map::put(const field &f)
+{
+    auto index = index_of_(f.key);
+    if (index == fields_.size())
+    {
+        strings_.push_back(strings{std::string(f.key.data(), f.key.size()), std::string()});
+        fields_.push_back(f);
+    }
+    else
+    {
+        fields_[index] = f;
+    }
+    if (f.type == field::value_type::string)
+    {
+        strings_[index].value.assign(f.string_value.data(), f.string_value.size());
+    }
+    else
+    {
+        strings_[index].value.clear();
+    }
+    update_views_();
+}
+
+SPDLOG_INLINE bool mdc_map::remove(string_view_t key)
+{
+    auto index = index_of_(key);
+    if (index == fields_.size())
+    {
+        return false;
+    }
+    strings_.erase(strings_.begin() + static_cast<std::ptrdiff_t>(index));
+    fields_.erase(fields_.begin() + static_cast<std::ptrdiff_t>(index));
+    update_views_();
+    return true;
+}
+
+SPDLOG_INLINE void mdc_map::clear()
+{
+    strings_.clear();
+    fields_.clear();
+}
+
+SPDLOG_INLINE const field *mdc_map::find(string_view_t key) const
+{
+    auto index = index_of_(key);
+    return index == fields_.size() ? nullptr : &fields_[index];
+}
+
+SPDLOG_INLINE size_t mdc_map::index_of_(string_view_t key) const
+{
+    for (size_t i = 0; i < fields_.size(); i++)
+    {
+        if (fields_[i].key == key)
+        {
+            return i;
+        }
+    }
+    return fields_.size();
+}
+
+// the strings may have moved (short ones are stored inline)
+SPDLOG_INLINE void mdc_map::update_views_()
+{
+    for (size_t i = 0; i < fields_.size(); i++)
+    {
+        fields_[i].key = strings_[i].key;
+        if (fields_[i].type == field::value_type::string)
+        {
+            fields_[i].string_value = strings_[i].value;
+        }
+    }
+}
+
+SPDLOG_INLINE mdc_map &thread_mdc()
+{
+#ifndef SPDLOG_NO_TLS
+    static thread_local mdc_map mdc;
+#else
+    static mdc_map mdc; // not stamped on the messages
+#endif
+    return mdc;
+}
+
+} // namespace details
+} // namespace spdlog
@@ -0,0 +1,63 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Mapped diagnostic context of a thread (see spdlog/mdc.h): the key/values stamped on the messages it logs.
+//
+// A flat vector of fields in insertion order, whose keys and string values point to strings owned by the map,
+// so a message only takes a pointer to them (log_msg::mdc_fields) - they're copied only with the message
+// (log_msg_buffer, the async queues). The views are rebuilt on each update, which are few compared to the
+// messages logged.
+
+#include <spdlog/common.h>
+
+#include <string>
+#include <vector>
+
+namespace spdlog {
+namespace details {
+
+class SPDLOG_API mdc_map
+{
+public:
+    // add the given field, or replace the value of its key
+    void put(const field &f);
+    // return false if the key wasn't found
+    bool remove(string_view_t key);
+    void clear();
+    // null if not found
+    const field *find(string_view_t key) const;
+
+    const field *fields() const
+    {
+        return fields_.empty() ? nullptr : fields_.data();
+    }
+
+    size_t size() const
+    {
+        return fields_.size();
+    }
+
+private:
+    struct strings
+    {
+        std::string key;
+        std::string value; // of the string fields
+    };
+    std::vector<strings> strings_;
+    std::vector<field> fields_;
+
+    size_t index_of_(string_view_t key) const;
+    void update_views_();
+};
+
+// the context of the calling thread (not stamped on the messages with SPDLOG_NO_TLS)
+SPDLOG_API mdc_map &thread_mdc();
+
+} // namespace details
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "mdc-inl.h"
+#endif
@@ -0,0 +1,135 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/details/memory_account.h>
+#endif
+
+#include <new>
+
+namespace spdlog {
+namespace details {
+
+SPDLOG_INLINE void memory_account::add(size_t bytes) SPDLOG_NOEXCEPT
+{
+    auto used = used_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    auto peak = peak_.load(std::memory_order_relaxed);
+    while (used > peak && !peak_.compare_exchange_weak(peak, used, std::memory_order_relaxed)) {}
+}
+
+SPDLOG_INLINE void memory_account::sub(size_t bytes) SPDLOG_NOEXCEPT
+{
+    used_.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+SPDLOG_INLINE size_t memory_account::used() const SPDLOG_NOEXCEPT
+{
+    return used_.load(std::memory_order_relaxed);
+}
+
+SPDLOG_INLINE size_t memory_account::peak() const SPDLOG_NOEXCEPT
+{
+    return peak_.load(std::memory_order_relaxed);
+}
+
+SPDLOG_INLINE memory_account &memory_account::global()
+{
+    static memory_account account;
+    return account;
+}
+
+SPDLOG_INLINE void memory_account::set_budget(size_t bytes)
+{
+    budget_().store(bytes, std::memory_order_relaxed);
+}
+
+SPDLOG_INLINE size_t memory_account::budget()
+{
+    return budget_().load(std::memory_order_relaxed);
+}
+
+SPDLOG_INLINE bool memory_account::over_budget(size_t bytes)
+{
+    auto limit = budget();
+    return limit != 0 && global().used() + bytes > limit;
+}
+
+SPDLOG_INLINE void memory_account::count_truncated() SPDLOG_NOEXCEPT
+{
+    truncated_().fetch_add(1, std::memory_order_relaxed);
+}
+
+SPDLOG_INLINE size_t memory_account::truncated_messages()
+{
+    return truncated_().load(std::memory_order_relaxed);
+}
+
+SPDLOG_INLINE std::atomic<size_t> &memory_account::budget_()
+{
+    static std::atomic<size_t> budget{0};
+    return budget;
+}
+
+SPDLOG_INLINE std::atomic<size_t> &memory_account::truncated_()
+{
+    static std::atomic<size_t> truncated{0};
+    return truncated;
+}
+
+SPDLOG_INLINE memory_scope::memory_scope(const std::shared_ptr<memory_account> &account) SPDLOG_NOEXCEPT : previous_(current_())
+{
+    current_() = &account;
+}
+
+SPDLOG_INLINE memory_scope::~memory_scope()
+{
+    current_() = previous_;
+}
+
+SPDLOG_INLINE const std::shared_ptr<memory_account> *memory_scope::current() SPDLOG_NOEXCEPT
+{
+    return current_();
+}
+
+SPDLOG_INLINE const std::shared_ptr<memory_account> *&memory_scope::current_() SPDLOG_NOEXCEPT
+{
+#ifndef SPDLOG_NO_TLS
+    static thread_local const std::shared_ptr<memory_account> *current = nullptr;
+#else
+    static const std::shared_ptr<memory_account> *current = nullptr; // never set: only the global account is charged
+#endif
+    return current;
+}
+
+SPDLOG_INLINE void *allocate_counted(size_t size)
+{
+    using account_ptr = std::shared_ptr<memory_account>;
+    auto *raw = static_cast<char *>(::operator new(counted_header_size + size));
+    auto *scope_account = memory_scope::current();
+    auto *account = new (raw) account_ptr(scope_account != nullptr ? *scope_account : account_ptr{});
+    memory_account::global().add(size);
+    if (*account)
+    {
+        (*account)->add(size);
+    }
+    return raw + counted_header_size;
+}
+
+SPDLOG_INLINE void deallocate_counted(void *p, size_t size) SPDLOG_NOEXCEPT
+{
+    using account_ptr = std::shared_ptr<memory_account>;
+    auto *raw = static_cast<char *>(p) - counted_header_size;
+    auto *account = reinterpret_cast<account_ptr *>(raw);
+    if (*account)
+    {
+        (*account)->sub(size);
+    }
+    memory_account::global().sub(size);
+    account->~account_ptr();
+    ::operator delete(raw);
+}
+
+} // namespace details
+} // namespace spdlog
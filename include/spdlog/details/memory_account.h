@@ -0,0 +1,125 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Accounting of the memory held by the stored messages (async queues, backtracer rings, ringbuffer sink):
+// the storage a message allocates beyond its slot - a payload longer than SPDLOG_MSG_BUFFER_SIZE, its fields -
+// comes from counting_allocator, which charges the global account and the account of the owner storing it
+// (set by a memory_scope around the copy). The allocation keeps its account: it is released from it wherever the
+// message was moved to. The slots themselves are fixed by the capacities and not counted.
+//
+// With a budget set (spdlog::set_memory_budget()), the messages that would spill past it are cut to fit their
+// slot instead (counted by truncated_messages()), so that a burst of long messages doesn't grow the RSS without
+// limit. Without thread locals (SPDLOG_NO_TLS) only the global account is charged.
+
+#include <spdlog/common.h>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+namespace spdlog {
+namespace details {
+
+class SPDLOG_API memory_account
+{
+public:
+    memory_account() = default;
+    memory_account(const memory_account &) = delete;
+    memory_account &operator=(const memory_account &) = delete;
+
+    void add(size_t bytes) SPDLOG_NOEXCEPT;
+    void sub(size_t bytes) SPDLOG_NOEXCEPT;
+    // bytes allocated now, and at most so far
+    size_t used() const SPDLOG_NOEXCEPT;
+    size_t peak() const SPDLOG_NOEXCEPT;
+
+    // all the stored messages, whoever owns them
+    static memory_account &global();
+    // limit of the global account in bytes (0: unlimited, the default)
+    static void set_budget(size_t bytes);
+    static size_t budget();
+    // whether allocating the given bytes more would exceed the budget
+    static bool over_budget(size_t bytes);
+    static void count_truncated() SPDLOG_NOEXCEPT;
+    static size_t truncated_messages();
+
+private:
+    std::atomic<size_t> used_{0};
+    std::atomic<size_t> peak_{0};
+    static std::atomic<size_t> &budget_();
+    static std::atomic<size_t> &truncated_();
+};
+
+// charge the allocations of the calling thread to the given account (may be null) during its lifetime
+class SPDLOG_API memory_scope
+{
+public:
+    explicit memory_scope(const std::shared_ptr<memory_account> &account) SPDLOG_NOEXCEPT;
+    memory_scope(const memory_scope &) = delete;
+    memory_scope &operator=(const memory_scope &) = delete;
+    ~memory_scope();
+
+    // the account of the innermost scope of the calling thread, or nullptr
+    static const std::shared_ptr<memory_account> *current() SPDLOG_NOEXCEPT;
+
+private:
+    const std::shared_ptr<memory_account> *previous_;
+    static const std::shared_ptr<memory_account> *&current_() SPDLOG_NOEXCEPT;
+};
+
+// the header of the counted allocations: their account, keeping the data aligned
+static const size_t counted_header_size =
+    (sizeof(std::shared_ptr<memory_account>) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+
+// size bytes charged to the global account and the current scope's (kept in a header before them)
+SPDLOG_API void *allocate_counted(size_t size);
+// free what allocate_counted(size) returned, from the accounts it was charged to
+SPDLOG_API void deallocate_counted(void *p, size_t size) SPDLOG_NOEXCEPT;
+
+// allocator of the message buffers
+template<typename T>
+class counting_allocator
+{
+public:
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+    using is_always_equal = std::true_type;
+
+    counting_allocator() = default;
+
+    template<typename U>
+    counting_allocator(const counting_allocator<U> &) SPDLOG_NOEXCEPT
+    {}
+
+    T *allocate(size_t n)
+    {
+        return static_cast<T *>(allocate_counted(n * sizeof(T)));
+    }
+
+    void deallocate(T *p, size_t n) SPDLOG_NOEXCEPT
+    {
+        deallocate_counted(p, n * sizeof(T));
+    }
+};
+
+template<typename T, typename U>
+bool operator==(const counting_allocator<T> &, const counting_allocator<U> &)
+{
+    return true;
+}
+
+template<typename T, typename U>
+bool operator!=(const counting_allocator<T> &, const counting_allocator<U> &)
+{
+    return false;
+}
+
+} // namespace details
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "memory_account-inl.h"
+#endif
@@ -0,0 +1,202 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/details/mmap_file.h>
+#endif
+
+#include <spdlog/details/os.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace spdlog {
+namespace details {
+
+SPDLOG_INLINE mmap_file::mmap_file(size_t chunk_size)
+    : chunk_size_(chunk_size)
+    , page_size_(static_cast<size_t>(::sysconf(_SC_PAGESIZE)))
+{
+    if (chunk_size_ == 0)
+    {
+        throw_spdlog_ex("mmap_file: chunk size must be positive");
+    }
+}
+
+SPDLOG_INLINE mmap_file::~mmap_file()
+{
+    close();
+}
+
+SPDLOG_INLINE void mmap_file::open(const filename_t &fname, bool truncate)
+{
+    close();
+    filename_ = fname;
+    os::create_dir(os::dir_name(fname));
+    int flags = O_RDWR | O_CREAT | O_CLOEXEC;
+    if (truncate)
+    {
+        flags |= O_TRUNC;
+    }
+    fd_ = ::open(fname.c_str(), flags, 0644);
+    if (fd_ == -1)
+    {
+        throw_error_("Failed opening file ", errno);
+    }
+
+    struct stat st;
+    if (::fstat(fd_, &st) != 0)
+    {
+        throw_error_("Failed getting the size of file ", errno);
+    }
+    file_size_ = static_cast<size_t>(st.st_size);
+    // continue after the data written - the zero filled tail left by a crash is overwritten
+    committed_.store(find_committed_size_(file_size_), std::memory_order_release);
+}
+
+SPDLOG_INLINE void mmap_file::reopen(bool truncate)
+{
+    if (filename_.empty())
+    {
+        throw_spdlog_ex("Failed re opening file - was not opened before");
+    }
+    this->open(filename_, truncate);
+}
+
+SPDLOG_INLINE void mmap_file::close()
+{
+    if (fd_ == -1)
+    {
+        return;
+    }
+    unmap_();
+    // like fclose(), errors are ignored here - the data is in the page cache already.
+    (void)::ftruncate(fd_, static_cast<off_t>(committed_.load(std::memory_order_relaxed)));
+    ::close(fd_);
+    fd_ = -1;
+    file_size_ = 0;
+}
+
+SPDLOG_INLINE void mmap_file::write(string_view_t data)
+{
+    auto committed = committed_.load(std::memory_order_relaxed);
+    if (map_ == nullptr || committed - map_offset_ + data.size() > map_size_)
+    {
+        remap_(data.size());
+    }
+    std::memcpy(map_ + (committed - map_offset_), data.data(), data.size());
+    committed_.store(committed + data.size(), std::memory_order_release);
+}
+
+SPDLOG_INLINE void mmap_file::flush()
+{
+    if (map_ != nullptr && ::msync(map_, map_size_, MS_ASYNC) != 0)
+    {
+        throw_error_("Failed flushing file ", errno);
+    }
+}
+
+SPDLOG_INLINE size_t mmap_file::size() const
+{
+    return committed_.load(std::memory_order_acquire);
+}
+
+SPDLOG_INLINE const filename_t &mmap_file::filename() const
+{
+    return filename_;
+}
+
+SPDLOG_INLINE size_t mmap_file::chunk_size() const
+{
+    return chunk_size_;
+}
+
+SPDLOG_INLINE void mmap_file::remap_(size_t min_size)
+{
+    if (fd_ == -1)
+    {
+        throw_spdlog_ex("Cannot write to closed file " + os::filename_to_str(filename_));
+    }
+    unmap_();
+
+    auto committed = committed_.load(std::memory_order_relaxed);
+    auto map_offset = committed & ~(page_size_ - 1);
+    auto map_size = std::max(chunk_size_, committed - map_offset + min_size);
+    map_size = (map_size + page_size_ - 1) & ~(page_size_ - 1);
+
+    auto end = map_offset + map_size;
+    if (end > file_size_)
+    {
+        // the blocks are allocated up front - no SIGBUS when the disk fills up while writing to the mapping
+        int err = -1;
+#ifdef __linux__
+        err = ::fallocate(fd_, 0, static_cast<off_t>(file_size_), static_cast<off_t>(end - file_size_)) == 0 ? 0 : errno;
+#endif
+        if (err != 0 && ::ftruncate(fd_, static_cast<off_t>(end)) != 0)
+        {
+            throw_error_("Failed extending file ", errno);
+        }
+        file_size_ = end;
+    }
+
+    auto *p = ::mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, static_cast<off_t>(map_offset));
+    if (p == MAP_FAILED)
+    {
+        throw_error_("Failed mapping file ", errno);
+    }
+    map_ = static_cast<char *>(p);
+    map_offset_ = map_offset;
+    map_size_ = map_size;
+}
+
+SPDLOG_INLINE void mmap_file::unmap_()
+{
+    if (map_ != nullptr)
+    {
+        ::munmap(map_, map_size_);
+        map_ = nullptr;
+        map_size_ = 0;
+    }
+}
+
+// the size of the file without its zero filled tail (left if the process crashed before truncating it)
+SPDLOG_INLINE size_t mmap_file::find_committed_size_(size_t file_size)
+{
+    char buf[4096];
+    auto end = file_size;
+    while (end > 0)
+    {
+        auto n = std::min(end, sizeof(buf));
+        auto n_read = ::pread(fd_, buf, n, static_cast<off_t>(end - n));
+        if (n_read != static_cast<ssize_t>(n))
+        {
+            throw_error_("Failed reading file ", errno);
+        }
+        for (auto i = n; i > 0; --i)
+        {
+            if (buf[i - 1] != '\0')
+            {
+                return end - n + i;
+            }
+        }
+        end -= n;
+    }
+    return 0;
+}
+
+SPDLOG_INLINE void mmap_file::throw_error_(const std::string &what, int last_errno)
+{
+    throw_spdlog_ex(what + os::filename_to_str(filename_), last_errno);
+}
+
+} // namespace details
+} // namespace spdlog
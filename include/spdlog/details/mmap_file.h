@@ -0,0 +1,71 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Append-only memory mapped file (posix).
+// The file is extended in large chunks (fallocate on linux, ftruncate otherwise) and the current
+// chunk is mapped, so a write is a memcpy into the mapping - no system call per message.
+// The mapped pages are shared with the kernel page cache: the data written survives a crash of the
+// process. The size of the data written (the commit offset) is published with a release store, and
+// the file is truncated to it on close. If the process crashed, the file keeps the zero filled tail of
+// its last chunk - it is removed when the file is opened again.
+//
+// Throw spdlog_ex exception on errors.
+// Not thread safe - the sinks serialize the access to it.
+
+#include <spdlog/common.h>
+
+#include <atomic>
+
+namespace spdlog {
+namespace details {
+
+class SPDLOG_API mmap_file
+{
+public:
+    static constexpr size_t default_chunk_size = 8 * 1024 * 1024;
+
+    explicit mmap_file(size_t chunk_size = default_chunk_size);
+
+    mmap_file(const mmap_file &) = delete;
+    mmap_file &operator=(const mmap_file &) = delete;
+    ~mmap_file();
+
+    void open(const filename_t &fname, bool truncate = false);
+    void reopen(bool truncate);
+    // truncate the file to the committed size and unmap it
+    void close();
+    void write(string_view_t data);
+    // ask the kernel to start writing the dirty pages (msync(MS_ASYNC)) - the data is already visible to readers
+    void flush();
+
+    // the committed size - safe to read from any thread
+    size_t size() const;
+    const filename_t &filename() const;
+    size_t chunk_size() const;
+
+private:
+    size_t chunk_size_;
+    size_t page_size_;
+    filename_t filename_;
+    int fd_{-1};
+    char *map_{nullptr};
+    size_t map_offset_{0}; // file offset of the mapping (page aligned)
+    size_t map_size_{0};
+    size_t file_size_{0}; // allocated size
+    std::atomic<size_t> committed_{0};
+
+    // map a window starting at the page containing the committed offset, with room for at least min_size bytes
+    void remap_(size_t min_size);
+    void unmap_();
+    size_t find_committed_size_(size_t file_size);
+    [[noreturn]] void throw_error_(const std::string &what, int last_errno);
+};
+
+} // namespace details
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "mmap_file-inl.h"
+#endif
@@ -0,0 +1,549 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// multi producer-multi consumer blocking queue of variable length records stored
+// in one contiguous byte arena.
+// Each record takes exactly its encoded size (rounded up to the records alignment),
+// so short messages do not pin a full slot and long ones are not allocated on the heap.
+//
+// enqueue(..) / enqueue_record(.., false) - will block until room found to put the new record.
+// enqueue_for(..) / enqueue_record_for(..) - will block until room found or timeout have passed.
+// enqueue_nowait(..) / enqueue_record(.., true) - will overrun the oldest records if no room left.
+// try_enqueue(..) / try_enqueue_record(..) - will return immediately with false if no room left.
+// dequeue_for(..) - will block until the queue is not empty or timeout have passed.
+// dequeue_bulk_for(..) / try_dequeue_bulk(..) - move out up to max_items items at once
+// (the latter never waits).
+//
+// Records can also be written in two phases, out of the queue lock (e.g. to format a message straight
+// into the arena): reserve_record(..) / try_reserve_record(..) / reserve_record_for(..) take room for
+// up to the given size and return where to write the record, then commit_record(..) publishes it, or
+// cancel_record(..) drops it (nothing constructed in it). The consumers stop at the oldest record
+// not committed yet, and it is never overrun: enqueue_nowait(..) waits for its commit if it needs its room.
+// Neither are the records the codec tells not to be overrun: enqueue_nowait(..) waits for the consumers to
+// take them if they are the oldest.
+//
+// Codec converts items (or any other record source type it supports) to bytes and back:
+//   static size_t encoded_size(const Src &src);     // bytes needed to encode src
+//   static void encode(char *dest, Src &&src);      // write src at dest
+//   static void decode(char *src, T &item);         // move the record at src into item and destroy it
+//   static void discard(char *src);                 // destroy the record at src
+//   static bool overrunnable(const char *src);      // false if the record at src must not be overrun
+// Records are aligned to alignof(std::max_align_t), so codecs may construct objects in place.
+
+#include <spdlog/common.h>
+#include <spdlog/details/async_queue.h>
+#include <spdlog/details/page_memory.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+
+namespace spdlog {
+namespace details {
+
+template<typename T, typename Codec>
+class mpmc_arena_queue : public async_queue<T>
+{
+public:
+    using item_type = T;
+    explicit mpmc_arena_queue(size_t arena_size, const page_options &pages = page_options())
+        : capacity_(align_(arena_size))
+        , arena_(capacity_, pages)
+    {}
+
+    mpmc_arena_queue(const mpmc_arena_queue &) = delete;
+    mpmc_arena_queue &operator=(const mpmc_arena_queue &) = delete;
+
+    ~mpmc_arena_queue() override
+    {
+        while (count_ > 0 && head_state_() != record_state::reserved)
+        {
+            drop_head_();
+        }
+    }
+
+    // try to enqueue and block if no room left
+    void enqueue(T &&item) override
+    {
+        enqueue_record(std::move(item), false);
+    }
+
+    // try to enqueue and block up to timeout if no room left
+    bool enqueue_for(T &&item, std::chrono::nanoseconds timeout) override
+    {
+        return enqueue_record_for(std::move(item), timeout);
+    }
+
+    // enqueue immediately. overrun oldest records in the queue if no room left.
+    size_t enqueue_nowait(T &&item) override
+    {
+        return enqueue_record(std::move(item), true);
+    }
+
+    // enqueue if there is room. never blocks.
+    bool try_enqueue(T &&item) override
+    {
+        return try_enqueue_record(std::move(item));
+    }
+
+    // encode the given source directly into the arena.
+    // throws spdlog_ex if the record can never fit in the arena.
+    // Return the number of overrun records.
+    template<typename Src>
+    size_t enqueue_record(Src &&src, bool overrun_oldest)
+    {
+        const size_t record_size = checked_record_size_(src);
+        size_t overrun = 0;
+        bool notify;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            char *record = reserve_(record_size);
+            while (record == nullptr)
+            {
+                if (overrun_oldest && head_overrunnable_())
+                {
+                    if (drop_head_())
+                    {
+                        overrun_counter_++;
+                        overrun++;
+                    }
+                }
+                else
+                {
+                    producers_waiting_++;
+                    pop_cv_.wait(lock);
+                    producers_waiting_--;
+                }
+                record = reserve_(record_size);
+            }
+            *reinterpret_cast<record_header *>(record) = record_header{record_size, record_state::committed};
+            Codec::encode(record + header_size_(), std::forward<Src>(src));
+            count_++;
+            notify = consumers_waiting_ > 0;
+        }
+        if (notify)
+        {
+            push_cv_.notify_one();
+        }
+        return overrun;
+    }
+
+    // encode the given source into the arena, waiting up to timeout for room.
+    // src is consumed only if the enqueue succeeded.
+    template<typename Src>
+    bool enqueue_record_for(Src &&src, std::chrono::nanoseconds timeout)
+    {
+        const size_t record_size = checked_record_size_(src);
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        bool notify;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            char *record = reserve_(record_size);
+            while (record == nullptr)
+            {
+                producers_waiting_++;
+                auto status = pop_cv_.wait_until(lock, deadline);
+                producers_waiting_--;
+                record = reserve_(record_size);
+                if (record == nullptr && status == std::cv_status::timeout)
+                {
+                    return false;
+                }
+            }
+            *reinterpret_cast<record_header *>(record) = record_header{record_size, record_state::committed};
+            Codec::encode(record + header_size_(), std::forward<Src>(src));
+            count_++;
+            notify = consumers_waiting_ > 0;
+        }
+        if (notify)
+        {
+            push_cv_.notify_one();
+        }
+        return true;
+    }
+
+    // encode the given source into the arena if there is room. never blocks.
+    // src is consumed only if the enqueue succeeded.
+    // once a record did not fit, fails fast without taking the lock until records are dequeued.
+    template<typename Src>
+    bool try_enqueue_record(Src &&src)
+    {
+        const size_t record_size = checked_record_size_(src);
+        if (full_.load(std::memory_order_relaxed))
+        {
+            return false;
+        }
+        bool notify;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            char *record = reserve_(record_size);
+            if (record == nullptr)
+            {
+                full_.store(true, std::memory_order_relaxed);
+                return false;
+            }
+            *reinterpret_cast<record_header *>(record) = record_header{record_size, record_state::committed};
+            Codec::encode(record + header_size_(), std::forward<Src>(src));
+            count_++;
+            notify = consumers_waiting_ > 0;
+        }
+        if (notify)
+        {
+            push_cv_.notify_one();
+        }
+        return true;
+    }
+
+    // reserve room for a record of up to encoded_size bytes, blocking until there is.
+    // return where to write the record, to pass to commit_record() or cancel_record().
+    // throws spdlog_ex if the record can never fit in the arena.
+    char *reserve_record(size_t encoded_size)
+    {
+        const size_t record_size = checked_size_(encoded_size);
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        char *record = reserve_(record_size);
+        while (record == nullptr)
+        {
+            producers_waiting_++;
+            pop_cv_.wait(lock);
+            producers_waiting_--;
+            record = reserve_(record_size);
+        }
+        return start_record_(record, record_size);
+    }
+
+    // reserve room if there is. never blocks. return nullptr if no room left.
+    char *try_reserve_record(size_t encoded_size)
+    {
+        const size_t record_size = checked_size_(encoded_size);
+        if (full_.load(std::memory_order_relaxed))
+        {
+            return nullptr;
+        }
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        char *record = reserve_(record_size);
+        if (record == nullptr)
+        {
+            full_.store(true, std::memory_order_relaxed);
+            return nullptr;
+        }
+        return start_record_(record, record_size);
+    }
+
+    // reserve room, waiting up to timeout for it. return nullptr on timeout.
+    char *reserve_record_for(size_t encoded_size, std::chrono::nanoseconds timeout)
+    {
+        const size_t record_size = checked_size_(encoded_size);
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        char *record = reserve_(record_size);
+        while (record == nullptr)
+        {
+            producers_waiting_++;
+            auto status = pop_cv_.wait_until(lock, deadline);
+            producers_waiting_--;
+            record = reserve_(record_size);
+            if (record == nullptr && status == std::cv_status::timeout)
+            {
+                return nullptr;
+            }
+        }
+        return start_record_(record, record_size);
+    }
+
+    // publish the record written at data (returned by one of the reserve functions)
+    void commit_record(char *data)
+    {
+        end_record_(data, record_state::committed);
+    }
+
+    // drop the reserved record at data, in which nothing was constructed
+    void cancel_record(char *data)
+    {
+        end_record_(data, record_state::cancelled);
+    }
+
+    // try to dequeue item. if no item found. wait upto timeout and try again
+    // Return true, if succeeded dequeue item, false otherwise
+    bool dequeue_for(T &popped_item, std::chrono::milliseconds wait_duration) override
+    {
+        return dequeue_bulk_for(&popped_item, 1, wait_duration) == 1;
+    }
+
+    // try to dequeue up to max_items under a single lock.
+    size_t dequeue_bulk_for(T *popped_items, size_t max_items, std::chrono::milliseconds wait_duration) override
+    {
+        size_t n_items = 0;
+        bool notify;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            if (!ready_())
+            {
+                consumers_waiting_++;
+                bool ready = push_cv_.wait_for(lock, wait_duration, [this] { return this->ready_(); });
+                consumers_waiting_--;
+                if (!ready)
+                {
+                    return 0;
+                }
+            }
+            n_items = pop_bulk_(popped_items, max_items);
+            notify = producers_waiting_ > 0;
+        }
+        if (notify)
+        {
+            pop_cv_.notify_all();
+        }
+        return n_items;
+    }
+
+    // dequeue up to max_items under a single lock if available. never waits.
+    size_t try_dequeue_bulk(T *popped_items, size_t max_items) override
+    {
+        size_t n_items = 0;
+        bool notify;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            n_items = pop_bulk_(popped_items, max_items);
+            // cancelled records may have been released too
+            notify = producers_waiting_ > 0;
+        }
+        if (notify)
+        {
+            pop_cv_.notify_all();
+        }
+        return n_items;
+    }
+
+    size_t overrun_counter() override
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        return overrun_counter_;
+    }
+
+    // number of records in the queue
+    size_t size() override
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        return count_;
+    }
+
+    // the bytes taken by the records
+    double load_factor() override
+    {
+        return static_cast<double>(used_.load(std::memory_order_relaxed)) / static_cast<double>(capacity_);
+    }
+
+    // arena size in bytes
+    size_t capacity() const
+    {
+        return capacity_;
+    }
+
+    // the largest encoded size of a record
+    size_t max_record_size() const
+    {
+        return capacity_ - header_size_();
+    }
+
+    // bytes currently taken by the records (including the unused tail of the arena when wrapped)
+    size_t used_bytes()
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        return count_ == 0 ? 0 : span_();
+    }
+
+private:
+    enum class record_state : size_t
+    {
+        reserved,  // being written out of the lock
+        committed, // holds an encoded record
+        cancelled  // holds nothing
+    };
+
+    struct record_header
+    {
+        size_t size; // whole record size, header included
+        record_state state;
+    };
+
+    static size_t align_(size_t n)
+    {
+        const size_t alignment = alignof(std::max_align_t);
+        return (n + alignment - 1) / alignment * alignment;
+    }
+
+    static size_t header_size_()
+    {
+        return align_(sizeof(record_header));
+    }
+
+    template<typename Src>
+    size_t checked_record_size_(const Src &src) const
+    {
+        return checked_size_(Codec::encoded_size(src));
+    }
+
+    size_t checked_size_(size_t encoded_size) const
+    {
+        const size_t record_size = align_(header_size_() + encoded_size);
+        if (record_size > capacity_)
+        {
+            throw_spdlog_ex("mpmc_arena_queue: record is larger than the arena");
+        }
+        return record_size;
+    }
+
+    // count the reserved record. must be called under the queue lock.
+    char *start_record_(char *record, size_t record_size)
+    {
+        *reinterpret_cast<record_header *>(record) = record_header{record_size, record_state::reserved};
+        count_++;
+        return record + header_size_();
+    }
+
+    void end_record_(char *data, record_state state)
+    {
+        bool notify;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            reinterpret_cast<record_header *>(data - header_size_())->state = state;
+            // the consumers may wait for this record (at the head), the producers for its room
+            notify = consumers_waiting_ > 0 || producers_waiting_ > 0;
+        }
+        if (notify)
+        {
+            push_cv_.notify_one();
+            pop_cv_.notify_all();
+        }
+    }
+
+    record_state head_state_()
+    {
+        return reinterpret_cast<record_header *>(arena_.data() + head_)->state;
+    }
+
+    // true if the oldest record can be overrun. must be called under the queue lock.
+    bool head_overrunnable_()
+    {
+        auto state = head_state_();
+        return state == record_state::cancelled || (state == record_state::committed && Codec::overrunnable(record_data_(head_)));
+    }
+
+    // true if the oldest record can be dequeued. must be called under the queue lock.
+    bool ready_()
+    {
+        return count_ > 0 && head_state_() != record_state::reserved;
+    }
+
+    // release the oldest record (committed or cancelled). return true if it held one.
+    // must be called under the queue lock.
+    bool drop_head_()
+    {
+        bool committed = head_state_() == record_state::committed;
+        if (committed)
+        {
+            Codec::discard(record_data_(head_));
+        }
+        pop_record_();
+        return committed;
+    }
+
+    char *record_data_(size_t offset)
+    {
+        return arena_.data() + offset + header_size_();
+    }
+
+    // find room for n contiguous bytes. must be called under the queue lock.
+    // the records occupy [head_, tail_) or, once wrapped, [head_, wrap_end_) and [0, tail_).
+    char *reserve_(size_t n)
+    {
+        if (count_ == 0)
+        {
+            head_ = tail_ = 0;
+            wrapped_ = false;
+        }
+
+        size_t pos;
+        if (!wrapped_ && capacity_ - tail_ >= n)
+        {
+            pos = tail_;
+        }
+        else if (!wrapped_ && head_ >= n)
+        {
+            wrapped_ = true;
+            wrap_end_ = tail_;
+            pos = 0;
+        }
+        else if (wrapped_ && head_ - tail_ >= n)
+        {
+            pos = tail_;
+        }
+        else
+        {
+            return nullptr;
+        }
+        tail_ = pos + n;
+        used_.store(span_(), std::memory_order_relaxed);
+        return arena_.data() + pos;
+    }
+
+    // the bytes from head_ to tail_. must be called under the queue lock.
+    size_t span_() const
+    {
+        return wrapped_ ? (wrap_end_ - head_) + tail_ : tail_ - head_;
+    }
+
+    // release the oldest record. must be called under the queue lock.
+    void pop_record_()
+    {
+        head_ += reinterpret_cast<record_header *>(arena_.data() + head_)->size;
+        count_--;
+        full_.store(false, std::memory_order_relaxed);
+        if (wrapped_ && head_ == wrap_end_)
+        {
+            head_ = 0;
+            wrapped_ = false;
+        }
+        used_.store(count_ == 0 ? 0 : span_(), std::memory_order_relaxed);
+    }
+
+    // move up to max_items from the queue. must be called under the queue lock.
+    size_t pop_bulk_(T *popped_items, size_t max_items)
+    {
+        size_t n_items = 0;
+        while (n_items < max_items && ready_())
+        {
+            if (head_state_() == record_state::committed)
+            {
+                Codec::decode(record_data_(head_), popped_items[n_items++]);
+            }
+            pop_record_();
+        }
+        return n_items;
+    }
+
+    const size_t capacity_;
+    page_array<char> arena_;
+    size_t head_ = 0;
+    size_t tail_ = 0;
+    size_t wrap_end_ = 0;
+    bool wrapped_ = false;
+    size_t count_ = 0;
+    size_t overrun_counter_ = 0;
+    // set when a try_enqueue_record did not fit, cleared when a record is released
+    std::atomic<bool> full_{false};
+    // mirrors used_bytes(), for load_factor
+    std::atomic<size_t> used_{0};
+    size_t producers_waiting_ = 0;
+    size_t consumers_waiting_ = 0;
+    std::mutex queue_mutex_;
+    std::condition_variable push_cv_;
+    std::condition_variable pop_cv_;
+};
+} // namespace details
+} // namespace spdlog
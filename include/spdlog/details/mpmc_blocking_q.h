@@ -5,121 +5,422 @@
 
 // multi producer-multi consumer blocking queue.
 // enqueue(..) - will block until room found to put the new message.
-// enqueue_nowait(..) - will return immediately with false if no room left in
+// enqueue_for(..) - will block until room found or timeout have passed.
+// enqueue_nowait(..) - will overrun the oldest message if no room left in
+// the queue (the oldest overrunnable one, see async_queue_item).
+// try_enqueue(..) - will return immediately with false if no room left in
 // the queue.
 // dequeue_for(..) - will block until the queue is not empty or timeout have
 // passed.
+// Producers and consumers signal each other only if the other side is waiting.
 
+#include <spdlog/details/async_queue.h>
 #include <spdlog/details/circular_q.h>
 
+#include <atomic>
 #include <condition_variable>
 #include <mutex>
+#include <new>
 
 namespace spdlog {
 namespace details {
 
 template<typename T>
-class mpmc_blocking_queue
+class mpmc_blocking_queue : public async_queue<T>
 {
 public:
     using item_type = T;
-    explicit mpmc_blocking_queue(size_t max_items)
-        : q_(max_items)
+    explicit mpmc_blocking_queue(size_t max_items, const page_options &pages = page_options())
+        : max_items_(max_items)
+        , q_(max_items, pages)
     {}
 
 #ifndef __MINGW32__
     // try to enqueue and block if no room left
-    void enqueue(T &&item)
+    void enqueue(T &&item) override
     {
+        bool notify;
         {
             std::unique_lock<std::mutex> lock(queue_mutex_);
-            pop_cv_.wait(lock, [this] { return !this->q_.full(); });
-            q_.push_back(std::move(item));
+            wait_not_full_(lock);
+            push_(std::move(item));
+            notify = consumers_waiting_ > 0;
+        }
+        if (notify)
+        {
+            push_cv_.notify_one();
         }
-        push_cv_.notify_one();
+    }
+
+    // try to enqueue and block up to timeout if no room left
+    bool enqueue_for(T &&item, std::chrono::nanoseconds timeout) override
+    {
+        bool notify;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            if (!wait_not_full_for_(lock, timeout))
+            {
+                return false;
+            }
+            push_(std::move(item));
+            notify = consumers_waiting_ > 0;
+        }
+        if (notify)
+        {
+            push_cv_.notify_one();
+        }
+        return true;
     }
 
     // enqueue immediately. overrun oldest message in the queue if no room left.
-    void enqueue_nowait(T &&item)
+    size_t enqueue_nowait(T &&item) override
     {
+        bool notify;
+        size_t overrun;
         {
             std::unique_lock<std::mutex> lock(queue_mutex_);
-            q_.push_back(std::move(item));
+            overrun = overrun_oldest_(lock);
+            push_(std::move(item));
+            notify = consumers_waiting_ > 0;
         }
-        push_cv_.notify_one();
+        if (notify)
+        {
+            push_cv_.notify_one();
+        }
+        return overrun;
+    }
+
+    // enqueue if there is room. never blocks.
+    // fails fast without taking the lock while the queue is known to be full.
+    bool try_enqueue(T &&item) override
+    {
+        if (full_.load(std::memory_order_relaxed))
+        {
+            return false;
+        }
+        bool notify;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            if (q_.full())
+            {
+                return false;
+            }
+            push_(std::move(item));
+            notify = consumers_waiting_ > 0;
+        }
+        if (notify)
+        {
+            push_cv_.notify_one();
+        }
+        return true;
     }
 
     // try to dequeue item. if no item found. wait upto timeout and try again
     // Return true, if succeeded dequeue item, false otherwise
-    bool dequeue_for(T &popped_item, std::chrono::milliseconds wait_duration)
+    bool dequeue_for(T &popped_item, std::chrono::milliseconds wait_duration) override
     {
+        bool notify;
         {
             std::unique_lock<std::mutex> lock(queue_mutex_);
-            if (!push_cv_.wait_for(lock, wait_duration, [this] { return !this->q_.empty(); }))
+            if (!wait_not_empty_(lock, wait_duration))
             {
                 return false;
             }
-            popped_item = std::move(q_.front());
-            q_.pop_front();
+            pop_bulk_(&popped_item, 1);
+            notify = producers_waiting_ > 0;
+        }
+        if (notify)
+        {
+            pop_cv_.notify_one();
         }
-        pop_cv_.notify_one();
         return true;
     }
 
+    // try to dequeue up to max_items under a single lock.
+    size_t dequeue_bulk_for(T *popped_items, size_t max_items, std::chrono::milliseconds wait_duration) override
+    {
+        size_t n_items = 0;
+        bool notify;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            if (!wait_not_empty_(lock, wait_duration))
+            {
+                return 0;
+            }
+            n_items = pop_bulk_(popped_items, max_items);
+            notify = producers_waiting_ > 0;
+        }
+        if (notify)
+        {
+            pop_cv_.notify_all();
+        }
+        return n_items;
+    }
+
+    // dequeue up to max_items under a single lock if available. never waits.
+    size_t try_dequeue_bulk(T *popped_items, size_t max_items) override
+    {
+        size_t n_items = 0;
+        bool notify;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            n_items = pop_bulk_(popped_items, max_items);
+            notify = n_items > 0 && producers_waiting_ > 0;
+        }
+        if (notify)
+        {
+            pop_cv_.notify_all();
+        }
+        return n_items;
+    }
+
 #else
     // apparently mingw deadlocks if the mutex is released before cv.notify_one(),
     // so release the mutex at the very end each function.
 
     // try to enqueue and block if no room left
-    void enqueue(T &&item)
+    void enqueue(T &&item) override
     {
         std::unique_lock<std::mutex> lock(queue_mutex_);
-        pop_cv_.wait(lock, [this] { return !this->q_.full(); });
-        q_.push_back(std::move(item));
-        push_cv_.notify_one();
+        wait_not_full_(lock);
+        push_(std::move(item));
+        if (consumers_waiting_ > 0)
+        {
+            push_cv_.notify_one();
+        }
+    }
+
+    // try to enqueue and block up to timeout if no room left
+    bool enqueue_for(T &&item, std::chrono::nanoseconds timeout) override
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        if (!wait_not_full_for_(lock, timeout))
+        {
+            return false;
+        }
+        push_(std::move(item));
+        if (consumers_waiting_ > 0)
+        {
+            push_cv_.notify_one();
+        }
+        return true;
     }
 
     // enqueue immediately. overrun oldest message in the queue if no room left.
-    void enqueue_nowait(T &&item)
+    size_t enqueue_nowait(T &&item) override
     {
         std::unique_lock<std::mutex> lock(queue_mutex_);
-        q_.push_back(std::move(item));
-        push_cv_.notify_one();
+        size_t overrun = overrun_oldest_(lock);
+        push_(std::move(item));
+        if (consumers_waiting_ > 0)
+        {
+            push_cv_.notify_one();
+        }
+        return overrun;
+    }
+
+    // enqueue if there is room. never blocks.
+    // fails fast without taking the lock while the queue is known to be full.
+    bool try_enqueue(T &&item) override
+    {
+        if (full_.load(std::memory_order_relaxed))
+        {
+            return false;
+        }
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        if (q_.full())
+        {
+            return false;
+        }
+        push_(std::move(item));
+        if (consumers_waiting_ > 0)
+        {
+            push_cv_.notify_one();
+        }
+        return true;
     }
 
     // try to dequeue item. if no item found. wait upto timeout and try again
     // Return true, if succeeded dequeue item, false otherwise
-    bool dequeue_for(T &popped_item, std::chrono::milliseconds wait_duration)
+    bool dequeue_for(T &popped_item, std::chrono::milliseconds wait_duration) override
     {
         std::unique_lock<std::mutex> lock(queue_mutex_);
-        if (!push_cv_.wait_for(lock, wait_duration, [this] { return !this->q_.empty(); }))
+        if (!wait_not_empty_(lock, wait_duration))
         {
             return false;
         }
-        popped_item = std::move(q_.front());
-        q_.pop_front();
-        pop_cv_.notify_one();
+        pop_bulk_(&popped_item, 1);
+        if (producers_waiting_ > 0)
+        {
+            pop_cv_.notify_one();
+        }
         return true;
     }
 
+    // try to dequeue up to max_items under a single lock.
+    size_t dequeue_bulk_for(T *popped_items, size_t max_items, std::chrono::milliseconds wait_duration) override
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        if (!wait_not_empty_(lock, wait_duration))
+        {
+            return 0;
+        }
+        auto n_items = pop_bulk_(popped_items, max_items);
+        if (producers_waiting_ > 0)
+        {
+            pop_cv_.notify_all();
+        }
+        return n_items;
+    }
+
+    // dequeue up to max_items under a single lock if available. never waits.
+    size_t try_dequeue_bulk(T *popped_items, size_t max_items) override
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        auto n_items = pop_bulk_(popped_items, max_items);
+        if (n_items > 0 && producers_waiting_ > 0)
+        {
+            pop_cv_.notify_all();
+        }
+        return n_items;
+    }
+
 #endif
 
-    size_t overrun_counter()
+    size_t overrun_counter() override
     {
         std::unique_lock<std::mutex> lock(queue_mutex_);
         return q_.overrun_counter();
     }
 
-    size_t size()
+    size_t size() override
     {
         std::unique_lock<std::mutex> lock(queue_mutex_);
         return q_.size();
     }
 
+    double load_factor() override
+    {
+        return max_items_ == 0 ? 1.0 : static_cast<double>(size_.load(std::memory_order_relaxed)) / static_cast<double>(max_items_);
+    }
+
+    void lock_for_fork() override
+    {
+        queue_mutex_.lock();
+    }
+
+    void unlock_after_fork(bool child) override
+    {
+        if (child)
+        {
+            // the waiters of the parent are gone: forget them, and re-initialize the condition
+            // variables (their state may still count them)
+            producers_waiting_ = 0;
+            consumers_waiting_ = 0;
+            new (&push_cv_) std::condition_variable();
+            new (&pop_cv_) std::condition_variable();
+        }
+        queue_mutex_.unlock();
+    }
+
 private:
+    // the waiting counters are guarded by the queue mutex, so the other side
+    // signals the condition variables only if someone actually sleeps on them.
+    void wait_not_full_(std::unique_lock<std::mutex> &lock)
+    {
+        if (!q_.full())
+        {
+            return;
+        }
+        producers_waiting_++;
+        pop_cv_.wait(lock, [this] { return !this->q_.full(); });
+        producers_waiting_--;
+    }
+
+    bool wait_not_full_for_(std::unique_lock<std::mutex> &lock, std::chrono::nanoseconds timeout)
+    {
+        if (!q_.full())
+        {
+            return true;
+        }
+        producers_waiting_++;
+        bool ready = pop_cv_.wait_for(lock, timeout, [this] { return !this->q_.full(); });
+        producers_waiting_--;
+        return ready;
+    }
+
+    // make room for an item by overrunning the oldest overrunnable one, or wait for room if none is.
+    // Return the number of overrun items. must be called under the queue lock.
+    size_t overrun_oldest_(std::unique_lock<std::mutex> &lock)
+    {
+        if (!q_.full())
+        {
+            return 0;
+        }
+        if (q_.empty())
+        {
+            // no room at all: the item is overrun by push_()
+            return 1;
+        }
+        for (size_t i = 0; i < q_.size(); i++)
+        {
+            if (async_queue_item<T>::overrunnable(q_.at(i)))
+            {
+                q_.overrun_at(i);
+                return 1;
+            }
+        }
+        wait_not_full_(lock);
+        return 0;
+    }
+
+    bool wait_not_empty_(std::unique_lock<std::mutex> &lock, std::chrono::milliseconds wait_duration)
+    {
+        if (!q_.empty())
+        {
+            return true;
+        }
+        consumers_waiting_++;
+        bool ready = push_cv_.wait_for(lock, wait_duration, [this] { return !this->q_.empty(); });
+        consumers_waiting_--;
+        return ready;
+    }
+
+    // must be called under the queue lock.
+    void push_(T &&item)
+    {
+        q_.push_back(std::move(item));
+        full_.store(q_.full(), std::memory_order_relaxed);
+        size_.store(q_.size(), std::memory_order_relaxed);
+    }
+
+    // move up to max_items from the queue. must be called under the queue lock.
+    size_t pop_bulk_(T *popped_items, size_t max_items)
+    {
+        size_t n_items = 0;
+        while (n_items < max_items && !q_.empty())
+        {
+            popped_items[n_items++] = std::move(q_.front());
+            q_.pop_front();
+        }
+        if (n_items > 0)
+        {
+            full_.store(false, std::memory_order_relaxed);
+            size_.store(q_.size(), std::memory_order_relaxed);
+        }
+        return n_items;
+    }
+
     std::mutex queue_mutex_;
     std::condition_variable push_cv_;
     std::condition_variable pop_cv_;
+    size_t producers_waiting_ = 0;
+    size_t consumers_waiting_ = 0;
+    // mirrors q_.full(), so try_enqueue can fail without taking the lock
+    std::atomic<bool> full_{false};
+    // mirrors q_.size(), for load_factor
+    std::atomic<size_t> size_{0};
+    size_t max_items_;
     spdlog::details::circular_q<T> q_;
 };
 } // namespace details
@@ -0,0 +1,359 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// multi producer-multi consumer bounded lock-free queue.
+// Based on Dmitry Vyukov's bounded mpmc queue: each slot carries a sequence
+// number that tells producers and consumers whether the slot is free or ready,
+// so enqueue/dequeue only need a single CAS on the shared head/tail position.
+//
+// enqueue(..) - will block until room found to put the new message.
+// enqueue_for(..) - will block until room found or timeout have passed.
+// enqueue_nowait(..) - will overrun the oldest message if no room left (the oldest overrunnable one,
+// see async_queue_item).
+// dequeue_for(..) - will block until the queue is not empty or timeout have
+// passed.
+// dequeue_bulk_for(..) - same as dequeue_for(..), but moves out up to max_items
+// items at once.
+// try_dequeue_bulk(..) - moves out up to max_items items, never waits.
+//
+// The mutex and condition variables are used only to park threads when the
+// queue is empty (consumers) or full (producers), and are notified only if
+// someone is actually waiting on them.
+// The capacity is rounded up to the next power of 2.
+
+#include <spdlog/common.h>
+#include <spdlog/details/async_queue.h>
+#include <spdlog/details/page_memory.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+namespace spdlog {
+namespace details {
+
+template<typename T>
+class mpmc_lockfree_queue : public async_queue<T>
+{
+public:
+    using item_type = T;
+    explicit mpmc_lockfree_queue(size_t max_items, const page_options &pages = page_options())
+        : capacity_(round_up_pow2_(max_items))
+        , mask_(capacity_ - 1)
+        , cells_(capacity_, pages)
+    {
+        for (size_t i = 0; i < capacity_; i++)
+        {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    mpmc_lockfree_queue(const mpmc_lockfree_queue &) = delete;
+    mpmc_lockfree_queue &operator=(const mpmc_lockfree_queue &) = delete;
+
+    // try to enqueue and block if no room left
+    void enqueue(T &&item) override
+    {
+        while (!push_(std::move(item)))
+        {
+            std::unique_lock<std::mutex> lock(wait_mutex_);
+            producers_waiting_.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            pop_cv_.wait(lock, [this] { return this->can_enqueue_(); });
+            producers_waiting_.fetch_sub(1);
+        }
+        notify_consumers_();
+    }
+
+    // try to enqueue and block up to timeout if no room left
+    bool enqueue_for(T &&item, std::chrono::nanoseconds timeout) override
+    {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (!push_(std::move(item)))
+        {
+            std::unique_lock<std::mutex> lock(wait_mutex_);
+            producers_waiting_.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            bool ready = pop_cv_.wait_until(lock, deadline, [this] { return this->can_enqueue_(); });
+            producers_waiting_.fetch_sub(1);
+            if (!ready)
+            {
+                return false;
+            }
+        }
+        notify_consumers_();
+        return true;
+    }
+
+    // enqueue immediately. overrun oldest message in the queue if no room left.
+    // the messages not overrunnable (see async_queue_item) are queued again, behind the newer ones, and if
+    // the queue holds nothing else, waits for room.
+    size_t enqueue_nowait(T &&item) override
+    {
+        size_t overrun = 0;
+        size_t requeued = 0;
+        while (!push_(std::move(item)))
+        {
+            T oldest;
+            if (!try_dequeue(oldest))
+            {
+                continue;
+            }
+            if (async_queue_item<T>::overrunnable(oldest))
+            {
+                overrun_counter_.fetch_add(1, std::memory_order_relaxed);
+                overrun++;
+                continue;
+            }
+            enqueue(std::move(oldest));
+            if (++requeued == capacity_)
+            {
+                enqueue(std::move(item));
+                return overrun;
+            }
+        }
+        notify_consumers_();
+        return overrun;
+    }
+
+    // try to dequeue item. if no item found. wait upto timeout and try again
+    // Return true, if succeeded dequeue item, false otherwise
+    bool dequeue_for(T &popped_item, std::chrono::milliseconds wait_duration) override
+    {
+        auto deadline = std::chrono::steady_clock::now() + wait_duration;
+        while (!try_dequeue(popped_item))
+        {
+            std::unique_lock<std::mutex> lock(wait_mutex_);
+            consumers_waiting_.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            bool ready = push_cv_.wait_until(lock, deadline, [this] { return this->can_dequeue_(); });
+            consumers_waiting_.fetch_sub(1);
+            if (!ready)
+            {
+                return false;
+            }
+        }
+        notify_producers_();
+        return true;
+    }
+
+    // try to dequeue up to max_items. waits only for the first item.
+    size_t dequeue_bulk_for(T *popped_items, size_t max_items, std::chrono::milliseconds wait_duration) override
+    {
+        if (max_items == 0 || !dequeue_for(popped_items[0], wait_duration))
+        {
+            return 0;
+        }
+        size_t n_items = 1;
+        while (n_items < max_items && try_dequeue(popped_items[n_items]))
+        {
+            n_items++;
+        }
+        notify_producers_();
+        return n_items;
+    }
+
+    // dequeue up to max_items if available. never waits.
+    size_t try_dequeue_bulk(T *popped_items, size_t max_items) override
+    {
+        size_t n_items = 0;
+        while (n_items < max_items && try_dequeue(popped_items[n_items]))
+        {
+            n_items++;
+        }
+        if (n_items > 0)
+        {
+            notify_producers_();
+        }
+        return n_items;
+    }
+
+    // enqueue if there is room. never blocks.
+    // the item is moved only if the enqueue succeeded.
+    bool try_enqueue(T &&item) override
+    {
+        if (!push_(std::move(item)))
+        {
+            return false;
+        }
+        notify_consumers_();
+        return true;
+    }
+
+    // dequeue if not empty. never blocks.
+    bool try_dequeue(T &popped_item)
+    {
+        size_t pos = dequeue_pos_.value.load(std::memory_order_relaxed);
+        cell *c;
+        for (;;)
+        {
+            c = &cells_[pos & mask_];
+            size_t seq = c->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0)
+            {
+                if (dequeue_pos_.value.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false; // empty
+            }
+            else
+            {
+                pos = dequeue_pos_.value.load(std::memory_order_relaxed);
+            }
+        }
+        popped_item = std::move(c->data);
+        c->sequence.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t overrun_counter() override
+    {
+        return overrun_counter_.load(std::memory_order_relaxed);
+    }
+
+    // approximate number of items in the queue (exact if no concurrent operations)
+    size_t size() override
+    {
+        auto head = dequeue_pos_.value.load(std::memory_order_acquire);
+        auto tail = enqueue_pos_.value.load(std::memory_order_acquire);
+        if (tail <= head)
+        {
+            return 0;
+        }
+        return tail - head > capacity_ ? capacity_ : tail - head;
+    }
+
+    double load_factor() override
+    {
+        return static_cast<double>(size()) / static_cast<double>(capacity_);
+    }
+
+    size_t capacity() const
+    {
+        return capacity_;
+    }
+
+    // the cells between the dequeue and enqueue positions, if their sequence tells they are ready
+    void foreach_queued_unsafe(void (*fn)(const T &item, void *context), void *context) const SPDLOG_NOEXCEPT override
+    {
+        auto pos = dequeue_pos_.value.load(std::memory_order_acquire);
+        auto end = enqueue_pos_.value.load(std::memory_order_acquire);
+        for (; pos < end && end - pos <= capacity_; pos++)
+        {
+            auto &c = cells_[pos & mask_];
+            if (c.sequence.load(std::memory_order_acquire) == pos + 1)
+            {
+                fn(c.data, context);
+            }
+        }
+    }
+
+private:
+    struct cell
+    {
+        std::atomic<size_t> sequence{0};
+        T data;
+    };
+
+    struct padded_pos
+    {
+        std::atomic<size_t> value{0};
+        char padding[SPDLOG_CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)];
+    };
+
+    const size_t capacity_;
+    const size_t mask_;
+    page_array<cell> cells_;
+    char padding0_[SPDLOG_CACHE_LINE_SIZE];
+    padded_pos enqueue_pos_;
+    padded_pos dequeue_pos_;
+    std::atomic<size_t> overrun_counter_{0};
+    std::atomic<size_t> producers_waiting_{0};
+    std::atomic<size_t> consumers_waiting_{0};
+    std::mutex wait_mutex_;
+    std::condition_variable push_cv_;
+    std::condition_variable pop_cv_;
+
+    static size_t round_up_pow2_(size_t n)
+    {
+        size_t rv = 2;
+        while (rv < n)
+        {
+            rv <<= 1;
+        }
+        return rv;
+    }
+
+    // the item is moved only if the push succeeded. does not notify the consumers.
+    bool push_(T &&item)
+    {
+        size_t pos = enqueue_pos_.value.load(std::memory_order_relaxed);
+        cell *c;
+        for (;;)
+        {
+            c = &cells_[pos & mask_];
+            size_t seq = c->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0)
+            {
+                if (enqueue_pos_.value.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false; // full
+            }
+            else
+            {
+                pos = enqueue_pos_.value.load(std::memory_order_relaxed);
+            }
+        }
+        c->data = std::move(item);
+        c->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool can_enqueue_() const
+    {
+        auto pos = enqueue_pos_.value.load(std::memory_order_relaxed);
+        return cells_[pos & mask_].sequence.load(std::memory_order_acquire) == pos;
+    }
+
+    bool can_dequeue_() const
+    {
+        auto pos = dequeue_pos_.value.load(std::memory_order_relaxed);
+        return cells_[pos & mask_].sequence.load(std::memory_order_acquire) == pos + 1;
+    }
+
+    void notify_consumers_()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (consumers_waiting_.load(std::memory_order_relaxed) > 0)
+        {
+            std::lock_guard<std::mutex> lock(wait_mutex_);
+            push_cv_.notify_one();
+        }
+    }
+
+    void notify_producers_()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (producers_waiting_.load(std::memory_order_relaxed) > 0)
+        {
+            std::lock_guard<std::mutex> lock(wait_mutex_);
+            pop_cv_.notify_all();
+        }
+    }
+};
+} // namespace details
+} // namespace spdlog
@@ -0,0 +1,194 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/details/msg_ring.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace spdlog {
+namespace details {
+
+SPDLOG_INLINE msg_ring::msg_ring(size_t capacity, const page_options &pages)
+    : capacity_(round_up_pow2_(capacity))
+    , records_(static_cast<size_t>(capacity_), pages)
+{
+    // no stale tag can pass for a committed record
+    std::memset(records_.data(), 0, records_.size());
+}
+
+SPDLOG_INLINE void msg_ring::write(const log_msg &msg) SPDLOG_NOEXCEPT
+{
+    auto max_strings = capacity_ / 4 - alignment - sizeof(entry);
+    entry e{};
+    e.time = static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(msg.time.time_since_epoch()).count());
+    e.thread_id = msg.thread_id;
+    e.source = msg.source;
+    e.trace = msg.trace;
+    e.logger_name_size = static_cast<uint32_t>((std::min)(static_cast<uint64_t>(msg.logger_name.size()), max_strings));
+    e.payload_size = static_cast<uint32_t>((std::min)(static_cast<uint64_t>(msg.payload.size()), max_strings - e.logger_name_size));
+    e.payload_id = msg.payload_id;
+    e.sample_rate = msg.sample_rate;
+    e.level = static_cast<int32_t>(msg.level);
+    auto size = sizeof(entry) + e.logger_name_size + e.payload_size;
+    auto record_size = record_size_(size);
+    for (;;)
+    {
+        auto pos = reserved_.fetch_add(record_size);
+        auto offset = pos & (capacity_ - 1);
+        if (offset + record_size <= capacity_)
+        {
+            auto *record = record_at_(pos);
+            record->size = static_cast<uint32_t>(size);
+            record->flags = 0;
+            auto *dest = reinterpret_cast<char *>(record + 1);
+            std::memcpy(dest, &e, sizeof(entry));
+            std::memcpy(dest + sizeof(entry), msg.logger_name.data(), e.logger_name_size);
+            std::memcpy(dest + sizeof(entry) + e.logger_name_size, msg.payload.data(), e.payload_size);
+            record->tag.store(pos + 1, std::memory_order_release);
+            return;
+        }
+        // would wrap: pad the end of the ring and what was reserved after it, then reserve again
+        auto first_part = capacity_ - offset;
+        write_padding_(pos, first_part);
+        write_padding_(pos + first_part, record_size - first_part);
+    }
+}
+
+SPDLOG_INLINE bool msg_ring::read(uint64_t &pos, uint64_t end, memory_buf_t &storage, log_msg &msg) const
+{
+    for (;;)
+    {
+        auto reserved = reserved_.load(std::memory_order_acquire);
+        if (pos + capacity_ < reserved)
+        {
+            pos = next_record_(reserved - capacity_); // lapped
+        }
+        if (pos >= (std::min)(end, reserved))
+        {
+            return false;
+        }
+        auto *record = record_at_(pos);
+        if (record->tag.load(std::memory_order_acquire) != pos + 1)
+        {
+            pos = next_record_(pos + alignment); // being written
+            continue;
+        }
+        uint64_t size = record->size;
+        auto flags = record->flags;
+        auto record_size = record_size_(size);
+        if ((pos & (capacity_ - 1)) + record_size > capacity_ || ((flags & padding_flag) == 0 && size < sizeof(entry)))
+        {
+            pos = next_record_(pos + alignment); // garbage (overwritten while reading the header)
+            continue;
+        }
+        storage.clear();
+        if ((flags & padding_flag) == 0)
+        {
+            auto *payload = reinterpret_cast<const char *>(record + 1);
+            storage.append(payload, payload + size);
+        }
+        // the writers reserve before writing: if nothing was reserved over the record meanwhile, it is intact
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (pos + capacity_ < reserved_.load(std::memory_order_relaxed))
+        {
+            continue;
+        }
+        pos += record_size;
+        if ((flags & padding_flag) != 0)
+        {
+            continue;
+        }
+
+        entry e;
+        std::memcpy(&e, storage.data(), sizeof(entry));
+        if (sizeof(entry) + e.logger_name_size + e.payload_size != size)
+        {
+            continue;
+        }
+        const char *strings = storage.data() + sizeof(entry);
+        msg = log_msg();
+        msg.time = log_clock::time_point(std::chrono::duration_cast<log_clock::duration>(std::chrono::nanoseconds(e.time)));
+        msg.thread_id = static_cast<size_t>(e.thread_id);
+        msg.source = e.source;
+        msg.trace = e.trace;
+        msg.logger_name = string_view_t(strings, e.logger_name_size);
+        msg.payload = string_view_t(strings + e.logger_name_size, e.payload_size);
+        msg.payload_id = e.payload_id;
+        msg.sample_rate = e.sample_rate;
+        msg.level = static_cast<level::level_enum>(e.level);
+        return true;
+    }
+}
+
+SPDLOG_INLINE uint64_t msg_ring::oldest_position() const
+{
+    auto reserved = write_position();
+    return next_record_(reserved > capacity_ ? reserved - capacity_ : 0);
+}
+
+SPDLOG_INLINE uint64_t msg_ring::write_position() const
+{
+    return reserved_.load(std::memory_order_acquire);
+}
+
+SPDLOG_INLINE size_t msg_ring::capacity() const
+{
+    return static_cast<size_t>(capacity_);
+}
+
+SPDLOG_INLINE uint64_t msg_ring::round_up_pow2_(size_t n)
+{
+    // room for a few records of the longest logger names
+    uint64_t rounded = 4096;
+    while (rounded < n)
+    {
+        rounded <<= 1;
+    }
+    return rounded;
+}
+
+SPDLOG_INLINE uint64_t msg_ring::record_size_(uint64_t size)
+{
+    return alignment + (size + alignment - 1) / alignment * alignment;
+}
+
+// the first committed record at or after pos (the write position if none)
+SPDLOG_INLINE uint64_t msg_ring::next_record_(uint64_t pos) const
+{
+    pos = (pos + alignment - 1) / alignment * alignment;
+    auto reserved = reserved_.load(std::memory_order_acquire);
+    if (pos + capacity_ < reserved)
+    {
+        pos = reserved - capacity_;
+    }
+    for (; pos < reserved; pos += alignment)
+    {
+        if (record_at_(pos)->tag.load(std::memory_order_acquire) == pos + 1)
+        {
+            return pos;
+        }
+    }
+    return reserved;
+}
+
+SPDLOG_INLINE msg_ring::record_header *msg_ring::record_at_(uint64_t pos) const
+{
+    return reinterpret_cast<record_header *>(const_cast<char *>(records_.data()) + (pos & (capacity_ - 1)));
+}
+
+SPDLOG_INLINE void msg_ring::write_padding_(uint64_t pos, uint64_t size) SPDLOG_NOEXCEPT
+{
+    auto *record = record_at_(pos);
+    record->size = static_cast<uint32_t>(size - alignment);
+    record->flags = padding_flag;
+    record->tag.store(pos + 1, std::memory_order_release);
+}
+
+} // namespace details
+} // namespace spdlog
@@ -0,0 +1,91 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// In process ring of the raw log messages, as compact variable length records in one contiguous buffer
+// (see sinks/raw_ringbuffer_sink.h).
+//
+// Same scheme as shm_ring: any number of writers reserve their records with a single atomic fetch_add,
+// copy the message in place and publish it by storing the record position in its header (release) - no
+// lock, no allocation. The writers overwrite the oldest records; the readers check after copying a
+// record that it was not overwritten meanwhile.
+//
+// record := header (tag = position + 1 once committed, size, flags) entry logger_name payload [padding to 16 bytes]
+//
+// The source locations are static strings: only their addresses are kept. The structured and mdc fields are not.
+
+#include <spdlog/common.h>
+#include <spdlog/details/log_msg.h>
+#include <spdlog/details/page_memory.h>
+
+#include <atomic>
+#include <cstdint>
+
+namespace spdlog {
+namespace details {
+
+class SPDLOG_API msg_ring
+{
+public:
+    // capacity in bytes, rounded up to a power of two. the buffer is allocated per pages.
+    explicit msg_ring(size_t capacity, const page_options &pages = page_options());
+    msg_ring(const msg_ring &) = delete;
+    msg_ring &operator=(const msg_ring &) = delete;
+
+    // append the message. payloads longer than about capacity / 4 are truncated.
+    void write(const log_msg &msg) SPDLOG_NOEXCEPT;
+
+    // read the first intact record at or after pos and before end into msg - its strings point into
+    // storage - and move pos after it. return false if there is none.
+    // if pos was overwritten meanwhile, start from the oldest record left.
+    bool read(uint64_t &pos, uint64_t end, memory_buf_t &storage, log_msg &msg) const;
+
+    // the oldest record left
+    uint64_t oldest_position() const;
+    uint64_t write_position() const;
+    size_t capacity() const;
+
+private:
+    struct record_header
+    {
+        std::atomic<uint64_t> tag; // position + 1 once committed
+        uint32_t size;             // of the entry and its strings
+        uint32_t flags;
+    };
+
+    struct entry
+    {
+        int64_t time; // ns since epoch
+        uint64_t thread_id;
+        source_loc source;
+        trace_context trace;
+        uint32_t logger_name_size;
+        uint32_t payload_size;
+        uint32_t payload_id;
+        uint32_t sample_rate;
+        int32_t level;
+    };
+
+    static const uint32_t padding_flag = 1;
+    static const size_t alignment = sizeof(record_header);
+
+    const uint64_t capacity_;
+    page_array<char> records_;
+    char padding0_[SPDLOG_CACHE_LINE_SIZE];
+    std::atomic<uint64_t> reserved_{0}; // the end of the reserved records
+    char padding1_[SPDLOG_CACHE_LINE_SIZE - sizeof(std::atomic<uint64_t>)];
+
+    static uint64_t round_up_pow2_(size_t n);
+    static uint64_t record_size_(uint64_t size);
+    uint64_t next_record_(uint64_t pos) const;
+    record_header *record_at_(uint64_t pos) const;
+    void write_padding_(uint64_t pos, uint64_t size) SPDLOG_NOEXCEPT;
+};
+
+} // namespace details
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "msg_ring-inl.h"
+#endif
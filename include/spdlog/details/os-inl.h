@@ -8,16 +8,28 @@
 #endif
 
 #include <spdlog/common.h>
+#ifdef SPDLOG_CLOCK_TSC
+#    include <spdlog/details/tsc_clock.h>
+#endif
+#if defined(SPDLOG_WCHAR_TO_UTF8_SUPPORT) || defined(SPDLOG_WCHAR_FILENAMES)
+#    include <spdlog/details/utf_convert.h>
+#    include <limits>
+#endif
 
 #include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
 #include <chrono>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
+#include <mutex>
 #include <string>
 #include <thread>
 #include <array>
+#include <unordered_map>
 #include <sys/stat.h>
 #include <sys/types.h>
 
@@ -31,19 +43,20 @@
 #        include <share.h>
 #    endif
 
-#    if defined(SPDLOG_WCHAR_TO_UTF8_SUPPORT) || defined(SPDLOG_WCHAR_FILENAMES)
-#        include <limits>
-#    endif
-
 #    include <direct.h> // for _mkdir/_wmkdir
 
 #else // unix
 
 #    include <fcntl.h>
+#    include <pthread.h> // for pthread_atfork
+#    include <sys/uio.h> // for writev
 #    include <unistd.h>
 
 #    ifdef __linux__
 #        include <sys/syscall.h> //Use gettid() syscall under linux to get thread id
+#        include <pthread.h>      // for pthread_setaffinity_np/pthread_setname_np
+#        include <sched.h>
+#        include <sys/resource.h> // for setpriority
 
 #    elif defined(_AIX)
 #        include <pthread.h> // for pthread_getthreadid_np
@@ -54,6 +67,9 @@
 #    elif defined(__NetBSD__)
 #        include <lwp.h> // for _lwp_self
 
+#    elif defined(__APPLE__)
+#        include <pthread.h> // for pthread_setname_np
+
 #    elif defined(__sun)
 #        include <thread.h> // for thr_self
 #    endif
@@ -77,6 +93,9 @@ SPDLOG_INLINE spdlog::log_clock::time_point now() SPDLOG_NOEXCEPT
     return std::chrono::time_point<log_clock, typename log_clock::duration>(
         std::chrono::duration_cast<typename log_clock::duration>(std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec)));
 
+#elif defined SPDLOG_CLOCK_TSC
+    return tsc_clock::instance().now();
+
 #else
     return log_clock::now();
 #endif
@@ -119,7 +138,54 @@ SPDLOG_INLINE std::tm gmtime() SPDLOG_NOEXCEPT
     return gmtime(now_t);
 }
 
-// fopen_s on non windows for writing
+// the days-from-civil algorithms of H. Hinnant (http://howardhinnant.github.io/date_algorithms.html),
+// with march-based years: leap days at the end of the year
+SPDLOG_INLINE std::tm civil_time(std::time_t time_tt, long utc_offset) SPDLOG_NOEXCEPT
+{
+    auto t = static_cast<int64_t>(time_tt) + utc_offset;
+    auto days = (t >= 0 ? t : t - 86399) / 86400;
+    auto secs_of_day = t - days * 86400;
+    auto z = days + 719468;
+    auto era = (z >= 0 ? z : z - 146096) / 146097;
+    auto doe = z - era * 146097;                                          // [0, 146096]
+    auto yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;     // [0, 399]
+    auto doy = doe - (365 * yoe + yoe / 4 - yoe / 100);                   // [0, 365], from march 1st
+    auto mp = (5 * doy + 2) / 153;                                        // [0, 11], from march
+    auto year = yoe + era * 400 + (mp >= 10 ? 1 : 0);
+    bool leap = year % 4 == 0 && (year % 100 != 0 || year % 400 == 0);
+
+    std::tm tm;
+    std::memset(&tm, 0, sizeof(tm));
+    tm.tm_sec = static_cast<int>(secs_of_day % 60);
+    tm.tm_min = static_cast<int>(secs_of_day / 60 % 60);
+    tm.tm_hour = static_cast<int>(secs_of_day / 3600);
+    tm.tm_mday = static_cast<int>(doy - (153 * mp + 2) / 5 + 1);
+    tm.tm_mon = static_cast<int>(mp < 10 ? mp + 2 : mp - 10);
+    tm.tm_year = static_cast<int>(year - 1900);
+    tm.tm_wday = static_cast<int>((days % 7 + 11) % 7); // 1970-01-01 was a thursday
+    // march 1st is the 59th day (the 60th of leap years)
+    tm.tm_yday = static_cast<int>(mp < 10 ? doy + 59 + (leap ? 1 : 0) : doy - 306);
+    tm.tm_isdst = 0;
+#if !defined(_WIN32) && !defined(sun) && !defined(__sun) && !defined(_AIX) && (defined(_BSD_SOURCE) || defined(_GNU_SOURCE))
+    tm.tm_gmtoff = utc_offset;
+#endif
+    return tm;
+}
+
+SPDLOG_INLINE std::time_t civil_seconds(const std::tm &tm) SPDLOG_NOEXCEPT
+{
+    int64_t year = static_cast<int64_t>(tm.tm_year) + 1900;
+    int64_t month = tm.tm_mon + 1;
+    year -= month <= 2 ? 1 : 0;
+    auto era = (year >= 0 ? year : year - 399) / 400;
+    auto yoe = year - era * 400;
+    auto doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + tm.tm_mday - 1;
+    auto doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    auto days = era * 146097 + doe - 719468;
+    return static_cast<std::time_t>(days * 86400 + tm.tm_hour * 3600 + tm.tm_min * 60 + tm.tm_sec);
+}
+
+// fopen_s on non windows for writing (or reading with "rb")
 SPDLOG_INLINE bool fopen_s(FILE **fp, const filename_t &filename, const filename_t &mode)
 {
 #ifdef _WIN32
@@ -141,8 +207,8 @@ SPDLOG_INLINE bool fopen_s(FILE **fp, const filename_t &filename, const filename
 #    endif
 #else // unix
 #    if defined(SPDLOG_PREVENT_CHILD_FD)
-    const int mode_flag = mode == SPDLOG_FILENAME_T("ab") ? O_APPEND : O_TRUNC;
-    const int fd = ::open((filename.c_str()), O_CREAT | O_WRONLY | O_CLOEXEC | mode_flag, mode_t(0644));
+    const int mode_flag = mode[0] == 'r' ? O_RDONLY : O_CREAT | O_WRONLY | (mode == SPDLOG_FILENAME_T("ab") ? O_APPEND : O_TRUNC);
+    const int fd = ::open((filename.c_str()), O_CLOEXEC | mode_flag, mode_t(0644));
     if (fd == -1)
     {
         return false;
@@ -199,6 +265,29 @@ SPDLOG_INLINE bool path_exists(const filename_t &filename) SPDLOG_NOEXCEPT
 #endif
 }
 
+SPDLOG_INLINE size_t path_size(const filename_t &filename) SPDLOG_NOEXCEPT
+{
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA data;
+#    ifdef SPDLOG_WCHAR_FILENAMES
+    if (!::GetFileAttributesExW(filename.c_str(), GetFileExInfoStandard, &data))
+#    else
+    if (!::GetFileAttributesExA(filename.c_str(), GetFileExInfoStandard, &data))
+#    endif
+    {
+        return 0;
+    }
+    return static_cast<size_t>((static_cast<uint64_t>(data.nFileSizeHigh) << 32) | data.nFileSizeLow);
+#else
+    struct stat buffer;
+    if (::stat(filename.c_str(), &buffer) != 0)
+    {
+        return 0;
+    }
+    return static_cast<size_t>(buffer.st_size);
+#endif
+}
+
 #ifdef _MSC_VER
 // avoid warning about unreachable statement at the end of filesize()
 #    pragma warning(push)
@@ -259,6 +348,146 @@ SPDLOG_INLINE size_t filesize(FILE *f)
 #    pragma warning(pop)
 #endif
 
+SPDLOG_INLINE bool set_no_page_cache(FILE *f) SPDLOG_NOEXCEPT
+{
+#if defined(__APPLE__) && defined(F_NOCACHE)
+    return ::fcntl(::fileno(f), F_NOCACHE, 1) != -1;
+#else
+    (void)f;
+    return false;
+#endif
+}
+
+SPDLOG_INLINE void start_writeback(FILE *f, size_t offset, size_t size) SPDLOG_NOEXCEPT
+{
+#if defined(__linux__) && defined(SYNC_FILE_RANGE_WRITE)
+    (void)::sync_file_range(::fileno(f), static_cast<off_t>(offset), static_cast<off_t>(size), SYNC_FILE_RANGE_WRITE);
+#else
+    (void)f;
+    (void)offset;
+    (void)size;
+#endif
+}
+
+SPDLOG_INLINE void drop_page_cache(FILE *f, size_t offset, size_t size) SPDLOG_NOEXCEPT
+{
+#if defined(_WIN32) || defined(__APPLE__) || !defined(POSIX_FADV_DONTNEED)
+    (void)f;
+    (void)offset;
+    (void)size;
+#else
+#    if defined(__linux__) && defined(SYNC_FILE_RANGE_WRITE)
+    (void)::sync_file_range(::fileno(f), static_cast<off_t>(offset), static_cast<off_t>(size),
+        SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+#    endif
+    (void)::posix_fadvise(::fileno(f), static_cast<off_t>(offset), static_cast<off_t>(size), POSIX_FADV_DONTNEED);
+#endif
+}
+
+SPDLOG_INLINE void preallocate(FILE *f, size_t size) SPDLOG_NOEXCEPT
+{
+#if defined(__linux__) && defined(FALLOC_FL_KEEP_SIZE)
+    (void)::fallocate(::fileno(f), FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(size));
+#else
+    (void)f;
+    (void)size;
+#endif
+}
+
+SPDLOG_INLINE int sync_file_data(int fd) SPDLOG_NOEXCEPT
+{
+#if defined(_WIN32)
+    return ::_commit(fd) == 0 ? 0 : errno;
+#elif defined(__APPLE__) && defined(F_FULLFSYNC)
+    // fsync only reaches the drive cache on osx
+    if (::fcntl(fd, F_FULLFSYNC) != -1 || ::fsync(fd) == 0)
+    {
+        return 0;
+    }
+    return errno;
+#elif defined(__linux__)
+    return ::fdatasync(fd) == 0 ? 0 : errno;
+#else
+    return ::fsync(fd) == 0 ? 0 : errno;
+#endif
+}
+
+SPDLOG_INLINE int write_gather(int fd, const string_view_t *parts, size_t n_parts) SPDLOG_NOEXCEPT
+{
+#ifdef _WIN32
+    for (size_t i = 0; i < n_parts; i++)
+    {
+        const char *data = parts[i].data();
+        size_t size = parts[i].size();
+        while (size > 0)
+        {
+            auto chunk = static_cast<unsigned int>((std::min)(size, static_cast<size_t>(INT_MAX)));
+            auto written = ::_write(fd, data, chunk);
+            if (written < 0)
+            {
+                return errno;
+            }
+            data += written;
+            size -= static_cast<size_t>(written);
+        }
+    }
+    return 0;
+#else
+    constexpr size_t max_iov = 16;
+    iovec iov[max_iov];
+    size_t part = 0;
+    size_t offset = 0; // written of parts[part]
+    while (part < n_parts)
+    {
+        int n_iov = 0;
+        for (size_t i = part; i < n_parts && n_iov < static_cast<int>(max_iov); i++)
+        {
+            size_t skip = i == part ? offset : 0;
+            iov[n_iov].iov_base = const_cast<char *>(parts[i].data() + skip);
+            iov[n_iov].iov_len = parts[i].size() - skip;
+            n_iov++;
+        }
+        auto written = ::writev(fd, iov, n_iov);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return errno;
+        }
+        // skip the parts written, resume in the part written partially
+        auto left = static_cast<size_t>(written);
+        while (part < n_parts && left >= parts[part].size() - offset)
+        {
+            left -= parts[part].size() - offset;
+            offset = 0;
+            part++;
+        }
+        offset += left;
+    }
+    return 0;
+#endif
+}
+
+SPDLOG_INLINE int dup_fd(int fd) SPDLOG_NOEXCEPT
+{
+#ifdef _WIN32
+    return ::_dup(fd);
+#else
+    return ::dup(fd);
+#endif
+}
+
+SPDLOG_INLINE void close_fd(int fd) SPDLOG_NOEXCEPT
+{
+#ifdef _WIN32
+    (void)::_close(fd);
+#else
+    (void)::close(fd);
+#endif
+}
+
 // Return utc offset in minutes or throw spdlog_ex on failure
 SPDLOG_INLINE int utc_minutes_offset(const std::tm &tm)
 {
@@ -353,17 +582,146 @@ SPDLOG_INLINE size_t _thread_id() SPDLOG_NOEXCEPT
 #endif
 }
 
+// the names recorded for thread_name(), by thread id
+struct thread_names
+{
+    std::mutex mutex;
+    std::unordered_map<size_t, std::string> names;
+    std::atomic<uint32_t> generation{0};
+
+    void set(size_t tid, std::string name)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        names[tid] = std::move(name);
+        generation.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void erase(size_t tid)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (names.erase(tid) > 0)
+        {
+            generation.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+};
+
+SPDLOG_INLINE thread_names &thread_names_registry()
+{
+    // never destroyed: the threads unregister their names when they exit, possibly after the static destructors
+    static auto *registry = new thread_names();
+    return *registry;
+}
+
+// the name of the calling thread from the system (empty if not supported)
+SPDLOG_INLINE std::string system_thread_name()
+{
+#if (defined(__linux__) && !defined(__ANDROID__)) || defined(__APPLE__)
+    char name[64] = {};
+    if (::pthread_getname_np(::pthread_self(), name, sizeof(name)) == 0)
+    {
+        return name;
+    }
+#endif
+    return std::string();
+}
+
+#if !defined(SPDLOG_NO_TLS)
+// the ids of a thread, read once - its name recorded meanwhile, and unrecorded when it exits
+struct thread_block
+{
+    thread_ids ids;
+    thread_block();
+    ~thread_block();
+};
+
+SPDLOG_INLINE thread_block &this_thread_block() SPDLOG_NOEXCEPT
+{
+    static thread_local thread_block block;
+    return block;
+}
+
+// a forked child continues in a new thread, alone: its block is then refreshed by a pthread_atfork handler
+// (registered along with the first block), and its name is the only one kept, under the new id. the names
+// are locked during the fork, so that they are consistent in the child.
+SPDLOG_INLINE void on_fork_child()
+{
+    thread_names_registry().mutex.unlock();
+    auto &ids = this_thread_block().ids;
+    auto old_id = ids.thread_id;
+    ids.thread_id = _thread_id();
+    ids.pid = pid();
+    auto name = thread_name(old_id);
+    auto &registry = thread_names_registry();
+    {
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.names.clear();
+    }
+    registry.set(ids.thread_id, name.empty() ? system_thread_name() : std::move(name));
+}
+
+SPDLOG_INLINE thread_block::thread_block()
+{
+#    ifndef _WIN32
+    static const int registered = ::pthread_atfork(
+        [] { thread_names_registry().mutex.lock(); }, [] { thread_names_registry().mutex.unlock(); }, on_fork_child);
+    (void)registered;
+#    endif
+    ids.thread_id = _thread_id();
+    ids.pid = pid();
+    SPDLOG_TRY
+    {
+        auto name = system_thread_name();
+        if (!name.empty())
+        {
+            thread_names_registry().set(ids.thread_id, std::move(name));
+        }
+    }
+    SPDLOG_CATCH_STD
+}
+
+SPDLOG_INLINE thread_block::~thread_block()
+{
+    SPDLOG_TRY
+    {
+        thread_names_registry().erase(ids.thread_id);
+    }
+    SPDLOG_CATCH_STD
+}
+#endif
+
 // Return current thread id as size_t (from thread local storage)
 SPDLOG_INLINE size_t thread_id() SPDLOG_NOEXCEPT
 {
 #if defined(SPDLOG_NO_TLS)
     return _thread_id();
 #else // cache thread id in tls
-    static thread_local const size_t tid = _thread_id();
-    return tid;
+    return this_thread_block().ids.thread_id;
 #endif
 }
 
+SPDLOG_INLINE thread_ids current_thread_ids() SPDLOG_NOEXCEPT
+{
+#if defined(SPDLOG_NO_TLS)
+    return thread_ids{_thread_id(), pid()};
+#else
+    return this_thread_block().ids;
+#endif
+}
+
+SPDLOG_INLINE std::string thread_name(size_t thread_id)
+{
+    auto &registry = thread_names_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    auto it = registry.names.find(thread_id);
+    return it != registry.names.end() ? it->second : std::string();
+}
+
+SPDLOG_INLINE uint32_t thread_names_generation() SPDLOG_NOEXCEPT
+{
+    return thread_names_registry().generation.load(std::memory_order_relaxed);
+}
+
 // This is avoid msvc issue in sleep_for that happens if the clock changes.
 // See https://github.com/gabime/spdlog/issues/609
 SPDLOG_INLINE void sleep_for_millis(unsigned int milliseconds) SPDLOG_NOEXCEPT
@@ -375,6 +733,162 @@ SPDLOG_INLINE void sleep_for_millis(unsigned int milliseconds) SPDLOG_NOEXCEPT
 #endif
 }
 
+SPDLOG_INLINE void cpu_relax() SPDLOG_NOEXCEPT
+{
+#if defined(_WIN32)
+    YieldProcessor();
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__i386__) || defined(__x86_64__))
+    __builtin_ia32_pause();
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#endif
+}
+
+SPDLOG_INLINE bool set_thread_affinity(const std::vector<size_t> &cpus) SPDLOG_NOEXCEPT
+{
+    if (cpus.empty())
+    {
+        return false;
+    }
+#if defined(_WIN32)
+    DWORD_PTR mask = 0;
+    for (auto cpu : cpus)
+    {
+        if (cpu >= sizeof(DWORD_PTR) * 8)
+        {
+            return false;
+        }
+        mask |= static_cast<DWORD_PTR>(1) << cpu;
+    }
+    return ::SetThreadAffinityMask(::GetCurrentThread(), mask) != 0;
+#elif defined(__linux__) && !defined(__ANDROID__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (auto cpu : cpus)
+    {
+        if (cpu >= CPU_SETSIZE)
+        {
+            return false;
+        }
+        CPU_SET(cpu, &set);
+    }
+    return ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+#ifdef __linux__
+// read a sysfs list of cpus or nodes, e.g. "0-3,8,10-11"
+SPDLOG_INLINE std::vector<size_t> read_sysfs_list(const std::string &path)
+{
+    std::vector<size_t> ids;
+    std::FILE *fp = std::fopen(path.c_str(), "r");
+    if (fp == nullptr)
+    {
+        return ids;
+    }
+    unsigned long first, last;
+    int n;
+    while ((n = std::fscanf(fp, "%lu-%lu", &first, &last)) >= 1)
+    {
+        if (n == 1)
+        {
+            last = first;
+        }
+        for (auto id = first; id <= last; id++)
+        {
+            ids.push_back(static_cast<size_t>(id));
+        }
+        if (std::fgetc(fp) != ',')
+        {
+            break;
+        }
+    }
+    std::fclose(fp);
+    return ids;
+}
+#endif
+
+SPDLOG_INLINE std::vector<size_t> numa_node_cpus(int node)
+{
+#ifdef __linux__
+    return read_sysfs_list(fmt::format("/sys/devices/system/node/node{}/cpulist", node));
+#else
+    (void)node;
+    return std::vector<size_t>{};
+#endif
+}
+
+SPDLOG_INLINE std::vector<int> numa_nodes()
+{
+    std::vector<int> nodes;
+#ifdef __linux__
+    for (auto node : read_sysfs_list("/sys/devices/system/node/online"))
+    {
+        nodes.push_back(static_cast<int>(node));
+    }
+#endif
+    return nodes;
+}
+
+SPDLOG_INLINE int current_cpu() SPDLOG_NOEXCEPT
+{
+#if defined(__linux__) && !defined(__ANDROID__)
+    return ::sched_getcpu();
+#elif defined(_WIN32)
+    return static_cast<int>(::GetCurrentProcessorNumber());
+#else
+    return -1;
+#endif
+}
+
+SPDLOG_INLINE void set_thread_name(const std::string &name) SPDLOG_NOEXCEPT
+{
+#if defined(__linux__) && !defined(__ANDROID__)
+    char truncated[16] = {};
+    name.copy(truncated, sizeof(truncated) - 1);
+    ::pthread_setname_np(::pthread_self(), truncated);
+#elif defined(__APPLE__)
+    ::pthread_setname_np(name.c_str());
+#endif
+    SPDLOG_TRY
+    {
+        thread_names_registry().set(thread_id(), name);
+    }
+    SPDLOG_CATCH_STD
+}
+
+SPDLOG_INLINE bool set_thread_nice(int nice) SPDLOG_NOEXCEPT
+{
+#if defined(_WIN32)
+    int priority = THREAD_PRIORITY_NORMAL;
+    if (nice <= -15)
+    {
+        priority = THREAD_PRIORITY_HIGHEST;
+    }
+    else if (nice < 0)
+    {
+        priority = THREAD_PRIORITY_ABOVE_NORMAL;
+    }
+    else if (nice >= 15)
+    {
+        priority = THREAD_PRIORITY_LOWEST;
+    }
+    else if (nice > 0)
+    {
+        priority = THREAD_PRIORITY_BELOW_NORMAL;
+    }
+    return ::SetThreadPriority(::GetCurrentThread(), priority) != 0;
+#elif defined(__linux__)
+    // on linux the nice value is per thread
+    return ::setpriority(PRIO_PROCESS, static_cast<id_t>(_thread_id()), nice) == 0;
+#else
+    (void)nice;
+    return false;
+#endif
+}
+
 // wchar support for windows file names (SPDLOG_WCHAR_FILENAMES must be defined)
 #if defined(_WIN32) && defined(SPDLOG_WCHAR_FILENAMES)
 SPDLOG_INLINE std::string filename_to_str(const filename_t &filename)
@@ -400,6 +914,11 @@ SPDLOG_INLINE int pid() SPDLOG_NOEXCEPT
 #endif
 }
 
+SPDLOG_INLINE int cached_pid() SPDLOG_NOEXCEPT
+{
+    return current_thread_ids().pid;
+}
+
 // Determine if the terminal supports colors
 // Based on: https://github.com/agauniyal/rang/
 SPDLOG_INLINE bool is_color_terminal() SPDLOG_NOEXCEPT
@@ -443,77 +962,31 @@ SPDLOG_INLINE bool in_terminal(FILE *file) SPDLOG_NOEXCEPT
 #endif
 }
 
-#if (defined(SPDLOG_WCHAR_TO_UTF8_SUPPORT) || defined(SPDLOG_WCHAR_FILENAMES)) && defined(_WIN32)
+#if defined(SPDLOG_WCHAR_TO_UTF8_SUPPORT) || defined(SPDLOG_WCHAR_FILENAMES)
 SPDLOG_INLINE void wstr_to_utf8buf(wstring_view_t wstr, memory_buf_t &target)
 {
-    if (wstr.size() > static_cast<size_t>((std::numeric_limits<int>::max)()) / 2 - 1)
+    if (wstr.size() > (std::numeric_limits<size_t>::max)() / utf::max_utf8_per_wchar)
     {
         throw_spdlog_ex("UTF-16 string is too big to be converted to UTF-8");
     }
 
-    int wstr_size = static_cast<int>(wstr.size());
-    if (wstr_size == 0)
-    {
-        target.resize(0);
-        return;
-    }
-
-    int result_size = static_cast<int>(target.capacity());
-    if ((wstr_size + 1) * 2 > result_size)
-    {
-        result_size = ::WideCharToMultiByte(CP_UTF8, 0, wstr.data(), wstr_size, NULL, 0, NULL, NULL);
-    }
-
-    if (result_size > 0)
-    {
-        target.resize(result_size);
-        result_size = ::WideCharToMultiByte(CP_UTF8, 0, wstr.data(), wstr_size, target.data(), result_size, NULL, NULL);
-
-        if (result_size > 0)
-        {
-            target.resize(result_size);
-            return;
-        }
-    }
-
-    throw_spdlog_ex(fmt::format("WideCharToMultiByte failed. Last error: {}", ::GetLastError()));
+    // converted in place, in a single pass
+    target.resize(wstr.size() * utf::max_utf8_per_wchar);
+    target.resize(utf::wide_to_utf8(wstr.data(), wstr.size(), target.data()));
 }
 
 SPDLOG_INLINE void utf8_to_wstrbuf(string_view_t str, wmemory_buf_t &target)
 {
-    if (str.size() > static_cast<size_t>((std::numeric_limits<int>::max)()) - 1)
-    {
-        throw_spdlog_ex("UTF-8 string is too big to be converted to UTF-16");
-    }
-
-    int str_size = static_cast<int>(str.size());
-    if (str_size == 0)
+    target.resize(str.size());
+    size_t result_size = 0;
+    if (!utf::utf8_to_wide(str.data(), str.size(), target.data(), result_size))
     {
         target.resize(0);
-        return;
-    }
-
-    int result_size = static_cast<int>(target.capacity());
-    if (str_size + 1 > result_size)
-    {
-        result_size = ::MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, str.data(), str_size, NULL, 0);
+        throw_spdlog_ex("invalid UTF-8 string, cannot be converted to UTF-16");
     }
-
-    if (result_size > 0)
-    {
-        target.resize(result_size);
-        result_size = ::MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, str.data(), str_size, target.data(), result_size);
-
-        if (result_size > 0)
-        {
-            target.resize(result_size);
-            return;
-        }
-    }
-
-    throw_spdlog_ex(fmt::format("MultiByteToWideChar failed. Last error: {}", ::GetLastError()));
+    target.resize(result_size);
 }
-#endif // (defined(SPDLOG_WCHAR_TO_UTF8_SUPPORT) || defined(SPDLOG_WCHAR_FILENAMES)) && defined(_WIN32)
+#endif // defined(SPDLOG_WCHAR_TO_UTF8_SUPPORT) || defined(SPDLOG_WCHAR_FILENAMES)
 
 // return true on success
 static SPDLOG_INLINE bool mkdir_(const filename_t &path)
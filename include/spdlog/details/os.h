@@ -5,6 +5,7 @@
 
 #include <spdlog/common.h>
 #include <ctime> // std::time_t
+#include <vector>
 
 namespace spdlog {
 namespace details {
@@ -20,6 +21,13 @@ SPDLOG_API std::tm gmtime(const std::time_t &time_tt) SPDLOG_NOEXCEPT;
 
 SPDLOG_API std::tm gmtime() SPDLOG_NOEXCEPT;
 
+// gmtime() of time_tt + utc_offset seconds in integer arithmetic (no lock, nor system call),
+// stamped with the given utc offset where std::tm has tm_gmtoff. tm_isdst is 0.
+SPDLOG_API std::tm civil_time(std::time_t time_tt, long utc_offset = 0) SPDLOG_NOEXCEPT;
+
+// the inverse of civil_time(): the seconds since epoch of the fields of tm, read as UTC (timegm())
+SPDLOG_API std::time_t civil_seconds(const std::tm &tm) SPDLOG_NOEXCEPT;
+
 // eol definition
 #if !defined(SPDLOG_EOL)
 #    ifdef _WIN32
@@ -31,19 +39,11 @@ SPDLOG_API std::tm gmtime() SPDLOG_NOEXCEPT;
 
 SPDLOG_CONSTEXPR static const char *default_eol = SPDLOG_EOL;
 
-// folder separator
-#if !defined(SPDLOG_FOLDER_SEPS)
-#    ifdef _WIN32
-#        define SPDLOG_FOLDER_SEPS "\\/"
-#    else
-#        define SPDLOG_FOLDER_SEPS "/"
-#    endif
-#endif
-
+// folder separator (SPDLOG_FOLDER_SEPS defaults in common.h)
 SPDLOG_CONSTEXPR static const char folder_seps[] = SPDLOG_FOLDER_SEPS;
 SPDLOG_CONSTEXPR static const filename_t::value_type folder_seps_filename[] = SPDLOG_FILENAME_T(SPDLOG_FOLDER_SEPS);
 
-// fopen_s on non windows for writing
+// fopen_s on non windows for writing (or reading with "rb")
 SPDLOG_API bool fopen_s(FILE **fp, const filename_t &filename, const filename_t &mode);
 
 // Remove filename. return 0 on success
@@ -61,6 +61,37 @@ SPDLOG_API bool path_exists(const filename_t &filename) SPDLOG_NOEXCEPT;
 // Return file size according to open FILE* object
 SPDLOG_API size_t filesize(FILE *f);
 
+// Return the size of the given file, 0 if it doesn't exist
+SPDLOG_API size_t path_size(const filename_t &filename) SPDLOG_NOEXCEPT;
+
+// Keep the data written to the given file out of the page cache where the system supports it
+// for the whole file (F_NOCACHE on osx). Return false if not supported - use drop_page_cache() then.
+SPDLOG_API bool set_no_page_cache(FILE *f) SPDLOG_NOEXCEPT;
+
+// Start writing the given range of the file to disk, without waiting (linux). No-op where not supported.
+SPDLOG_API void start_writeback(FILE *f, size_t offset, size_t size) SPDLOG_NOEXCEPT;
+
+// Drop the given range of the file from the page cache (posix_fadvise(POSIX_FADV_DONTNEED)).
+// Dirty pages can't be dropped: on linux, the writeback of the range is waited for first.
+// No-op where not supported.
+SPDLOG_API void drop_page_cache(FILE *f, size_t offset, size_t size) SPDLOG_NOEXCEPT;
+
+// Reserve disk space for the first size bytes of the file without changing its size (linux).
+// No-op where not supported.
+SPDLOG_API void preallocate(FILE *f, size_t size) SPDLOG_NOEXCEPT;
+
+// Write the data of the file (and the metadata needed to read it back) to disk: fdatasync (linux),
+// F_FULLFSYNC (osx, falling back to fsync), fsync elsewhere, _commit on windows. Return 0 or the errno.
+SPDLOG_API int sync_file_data(int fd) SPDLOG_NOEXCEPT;
+
+// Write all the parts to the file descriptor, in order: writev (several parts per call), _write of each part on
+// windows. Return 0 or the errno.
+SPDLOG_API int write_gather(int fd, const string_view_t *parts, size_t n_parts) SPDLOG_NOEXCEPT;
+
+// dup() / close() of a file descriptor. dup_fd returns -1 on failure.
+SPDLOG_API int dup_fd(int fd) SPDLOG_NOEXCEPT;
+SPDLOG_API void close_fd(int fd) SPDLOG_NOEXCEPT;
+
 // Return utc offset in minutes or throw spdlog_ex on failure
 SPDLOG_API int utc_minutes_offset(const std::tm &tm = details::os::localtime());
 
@@ -72,14 +103,58 @@ SPDLOG_API size_t _thread_id() SPDLOG_NOEXCEPT;
 // Return current thread id as size_t (from thread local storage)
 SPDLOG_API size_t thread_id() SPDLOG_NOEXCEPT;
 
+// The ids of the calling thread and of its process, read once per thread (thread local storage) and refreshed
+// in the forked children by a pthread_atfork handler - from the system on each call with SPDLOG_NO_TLS.
+struct thread_ids
+{
+    size_t thread_id;
+    int pid;
+};
+SPDLOG_API thread_ids current_thread_ids() SPDLOG_NOEXCEPT;
+
+// The name of a thread of this process: as set by set_thread_name(), or as it was when the thread first read its
+// ids (linux and osx). Empty if unknown or if the thread exited.
+SPDLOG_API std::string thread_name(size_t thread_id);
+
+// Changes with each name recorded for thread_name() - to cache the names until then.
+SPDLOG_API uint32_t thread_names_generation() SPDLOG_NOEXCEPT;
+
 // This is avoid msvc issue in sleep_for that happens if the clock changes.
 // See https://github.com/gabime/spdlog/issues/609
 SPDLOG_API void sleep_for_millis(unsigned int milliseconds) SPDLOG_NOEXCEPT;
 
+// Hint the cpu that the caller is in a spin-wait loop (pause instruction where available)
+SPDLOG_API void cpu_relax() SPDLOG_NOEXCEPT;
+
+// Restrict the calling thread to the given cpus.
+// Return true if succeeded (false if failed or not supported on this platform).
+SPDLOG_API bool set_thread_affinity(const std::vector<size_t> &cpus) SPDLOG_NOEXCEPT;
+
+// Return the cpus of the given NUMA node (empty if not found or not supported on this platform)
+SPDLOG_API std::vector<size_t> numa_node_cpus(int node);
+
+// Return the online NUMA nodes (empty if not supported on this platform)
+SPDLOG_API std::vector<int> numa_nodes();
+
+// Return the cpu the calling thread runs on (-1 if not supported on this platform). A vDSO call on linux.
+SPDLOG_API int current_cpu() SPDLOG_NOEXCEPT;
+
+// Name the calling thread (truncated to 15 chars on linux), and record it for thread_name(). The system name is
+// not set where not supported.
+SPDLOG_API void set_thread_name(const std::string &name) SPDLOG_NOEXCEPT;
+
+// Set the nice value (-20..19, lower is higher priority) of the calling thread.
+// On windows it is mapped to the closest thread priority.
+// Return true if succeeded (false if failed or not supported on this platform).
+SPDLOG_API bool set_thread_nice(int nice) SPDLOG_NOEXCEPT;
+
 SPDLOG_API std::string filename_to_str(const filename_t &filename);
 
 SPDLOG_API int pid() SPDLOG_NOEXCEPT;
 
+// Return the process id (from thread local storage, see current_thread_ids())
+SPDLOG_API int cached_pid() SPDLOG_NOEXCEPT;
+
 // Determine if the terminal supports colors
 // Source: https://github.com/agauniyal/rang/
 SPDLOG_API bool is_color_terminal() SPDLOG_NOEXCEPT;
@@ -88,7 +163,8 @@ SPDLOG_API bool is_color_terminal() SPDLOG_NOEXCEPT;
 // Source: https://github.com/agauniyal/rang/
 SPDLOG_API bool in_terminal(FILE *file) SPDLOG_NOEXCEPT;
 
-#if (defined(SPDLOG_WCHAR_TO_UTF8_SUPPORT) || defined(SPDLOG_WCHAR_FILENAMES)) && defined(_WIN32)
+// utf8 conversion of wchar_t strings (UTF-16 on windows, UTF-32 elsewhere), see details/utf_convert.h
+#if defined(SPDLOG_WCHAR_TO_UTF8_SUPPORT) || defined(SPDLOG_WCHAR_FILENAMES)
 SPDLOG_API void wstr_to_utf8buf(wstring_view_t wstr, memory_buf_t &target);
 
 SPDLOG_API void utf8_to_wstrbuf(string_view_t str, wmemory_buf_t &target);
@@ -0,0 +1,230 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Protobuf encoding of the OpenTelemetry logs (opentelemetry/proto/logs/v1/logs.proto), for the otlp sink.
+// Written straight into memory buffers, without the protobuf library: only the few messages of a log export.
+//
+// LogRecord of a log_msg:
+//   time_unix_nano (1)             msg.time
+//   observed_time_unix_nano (11)   when the sink got the message
+//   severity_number (2)            trace 1, debug 5, info 9, warn 13, error 17, critical 21
+//   severity_text (3)              the spdlog level name
+//   body (5)                       the payload as a string
+//   attributes (6)                 thread.id, code.filepath, code.lineno, code.function, the fields and mdc fields
+//   trace_id (9), span_id (10)     the trace context, if any
+// The logger name is the name of the instrumentation scope of its records.
+
+#include <spdlog/common.h>
+#include <spdlog/details/log_msg.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+
+namespace spdlog {
+namespace details {
+namespace otlp {
+
+enum class wire_type : uint8_t
+{
+    varint = 0,
+    fixed64 = 1,
+    length_delimited = 2,
+    fixed32 = 5
+};
+
+inline size_t varint_size(uint64_t value)
+{
+    size_t size = 1;
+    while (value >= 0x80)
+    {
+        value >>= 7;
+        size++;
+    }
+    return size;
+}
+
+inline void put_varint(memory_buf_t &out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+// the field numbers used are below 16: their tags are a single byte
+inline void put_tag(memory_buf_t &out, uint32_t field_number, wire_type type)
+{
+    out.push_back(static_cast<char>((field_number << 3) | static_cast<uint32_t>(type)));
+}
+
+// size of a length delimited field holding size bytes
+inline size_t field_size(size_t size)
+{
+    return 1 + varint_size(size) + size;
+}
+
+inline void put_length(memory_buf_t &out, uint32_t field_number, size_t size)
+{
+    put_tag(out, field_number, wire_type::length_delimited);
+    put_varint(out, size);
+}
+
+inline void put_bytes(memory_buf_t &out, uint32_t field_number, const void *data, size_t size)
+{
+    put_length(out, field_number, size);
+    auto *bytes = static_cast<const char *>(data);
+    out.append(bytes, bytes + size);
+}
+
+inline void put_string(memory_buf_t &out, uint32_t field_number, string_view_t value)
+{
+    put_bytes(out, field_number, value.data(), value.size());
+}
+
+inline void put_varint_field(memory_buf_t &out, uint32_t field_number, uint64_t value)
+{
+    put_tag(out, field_number, wire_type::varint);
+    put_varint(out, value);
+}
+
+inline void put_fixed64(memory_buf_t &out, uint32_t field_number, uint64_t value)
+{
+    put_tag(out, field_number, wire_type::fixed64);
+    for (int i = 0; i < 8; i++)
+    {
+        out.push_back(static_cast<char>(value >> (8 * i))); // little endian
+    }
+}
+
+// AnyValue: string_value (1), bool_value (2), int_value (3), double_value (4)
+inline size_t any_value_size(const field &value)
+{
+    switch (value.type)
+    {
+    case field::value_type::string:
+        return field_size(value.string_value.size());
+    case field::value_type::signed_int:
+        return 1 + varint_size(static_cast<uint64_t>(value.int_value));
+    case field::value_type::unsigned_int:
+        return 1 + varint_size(static_cast<uint64_t>(value.uint_value));
+    case field::value_type::floating:
+        return 1 + 8;
+    default:
+        return 1 + 1;
+    }
+}
+
+inline void put_any_value(memory_buf_t &out, const field &value)
+{
+    switch (value.type)
+    {
+    case field::value_type::string:
+        put_string(out, 1, value.string_value);
+        break;
+    case field::value_type::signed_int:
+        put_varint_field(out, 3, static_cast<uint64_t>(value.int_value));
+        break;
+    case field::value_type::unsigned_int:
+        put_varint_field(out, 3, static_cast<uint64_t>(value.uint_value)); // int64 on the wire
+        break;
+    case field::value_type::floating: {
+        uint64_t bits;
+        std::memcpy(&bits, &value.double_value, sizeof(bits));
+        put_fixed64(out, 4, bits);
+        break;
+    }
+    default:
+        put_varint_field(out, 2, value.bool_value ? 1 : 0);
+        break;
+    }
+}
+
+// KeyValue: key (1), value (2)
+inline size_t key_value_size(const field &attribute)
+{
+    return field_size(attribute.key.size()) + field_size(any_value_size(attribute));
+}
+
+inline void put_attribute(memory_buf_t &out, uint32_t field_number, const field &attribute)
+{
+    auto value_size = any_value_size(attribute);
+    put_length(out, field_number, key_value_size(attribute));
+    put_string(out, 1, attribute.key);
+    put_length(out, 2, value_size);
+    put_any_value(out, attribute);
+}
+
+inline uint32_t severity_number(level::level_enum lvl)
+{
+    switch (lvl)
+    {
+    case level::trace:
+        return 1;
+    case level::debug:
+        return 5;
+    case level::info:
+        return 9;
+    case level::warn:
+        return 13;
+    case level::err:
+        return 17;
+    case level::critical:
+        return 21;
+    default:
+        return 0; // unspecified
+    }
+}
+
+inline uint64_t unix_nanos(log_clock::time_point time)
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count());
+}
+
+// the fields of the LogRecord of msg (without its own tag and length)
+inline void encode_log_record(const log_msg &msg, log_clock::time_point observed_time, memory_buf_t &out)
+{
+    put_fixed64(out, 1, unix_nanos(msg.time));
+    put_fixed64(out, 11, unix_nanos(observed_time));
+    auto severity = severity_number(msg.level);
+    if (severity != 0)
+    {
+        put_varint_field(out, 2, severity);
+    }
+    put_string(out, 3, level::to_string_view(msg.level));
+    put_length(out, 5, field_size(msg.payload.size()));
+    put_string(out, 1, msg.payload);
+
+    put_attribute(out, 6, field("thread.id", msg.thread_id));
+    if (!msg.source.empty())
+    {
+        put_attribute(out, 6, field("code.filepath", msg.source.filename));
+        put_attribute(out, 6, field("code.lineno", msg.source.line));
+        if (msg.source.funcname != nullptr)
+        {
+            put_attribute(out, 6, field("code.function", msg.source.funcname));
+        }
+    }
+    for (size_t i = 0; i < msg.n_fields; i++)
+    {
+        put_attribute(out, 6, msg.fields[i]);
+    }
+    for (size_t i = 0; i < msg.n_mdc_fields; i++)
+    {
+        put_attribute(out, 6, msg.mdc_fields[i]);
+    }
+
+    if (!msg.trace.empty())
+    {
+        put_bytes(out, 9, msg.trace.trace_id, sizeof(msg.trace.trace_id));
+        put_bytes(out, 10, msg.trace.span_id, sizeof(msg.trace.span_id));
+    }
+}
+
+} // namespace otlp
+} // namespace details
+} // namespace spdlog
@@ -0,0 +1,170 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/details/page_memory.h>
+#endif
+
+#include <spdlog/details/os.h>
+
+#include <cerrno>
+
+#ifdef _WIN32
+#    include <spdlog/details/windows_include.h>
+#else
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <unistd.h>
+#endif
+
+namespace spdlog {
+namespace details {
+namespace page_memory {
+
+static const size_t huge_page_size = size_t{2} * 1024 * 1024;
+
+inline size_t page_size()
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    ::GetSystemInfo(&info);
+    return static_cast<size_t>(info.dwPageSize);
+#else
+    return static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+#endif
+}
+
+// the size of the mapping: whole (huge) pages
+inline size_t mapped_size(size_t size, const page_options &options)
+{
+    size_t page = options.huge_pages && options.file.empty() ? huge_page_size : page_size();
+    return (size + page - 1) / page * page;
+}
+
+#ifndef _WIN32
+// a shared mapping of the whole file, sized (and its blocks allocated) to mapped bytes
+inline void *map_file(const filename_t &file, size_t mapped)
+{
+    os::create_dir(os::dir_name(file));
+    int fd = ::open(file.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd == -1)
+    {
+        throw_spdlog_ex("allocate_pages: failed opening " + os::filename_to_str(file), errno);
+    }
+    int err = -1;
+#    ifdef __linux__
+    // no SIGBUS on a full disk when the pages are written back
+    err = ::fallocate(fd, 0, 0, static_cast<off_t>(mapped)) == 0 ? 0 : errno;
+#    endif
+    if (err != 0 && ::ftruncate(fd, static_cast<off_t>(mapped)) != 0)
+    {
+        err = errno;
+        ::close(fd);
+        (void)::unlink(file.c_str());
+        throw_spdlog_ex("allocate_pages: failed sizing " + os::filename_to_str(file), err);
+    }
+    void *p = ::mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    err = errno;
+    ::close(fd);
+    if (p == MAP_FAILED)
+    {
+        (void)::unlink(file.c_str());
+        throw_spdlog_ex("allocate_pages: mmap of " + os::filename_to_str(file) + " failed", err);
+    }
+    return p;
+}
+#endif
+
+} // namespace page_memory
+
+SPDLOG_INLINE void *allocate_pages(size_t size, const page_options &options)
+{
+    if (!options.any())
+    {
+        return ::operator new(size);
+    }
+    size_t mapped = page_memory::mapped_size(size == 0 ? 1 : size, options);
+#ifdef _WIN32
+    if (!options.file.empty())
+    {
+        throw_spdlog_ex("allocate_pages: file backed pages are not supported on windows");
+    }
+    void *p = ::VirtualAlloc(nullptr, mapped, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+    if (p == nullptr)
+    {
+        throw_spdlog_ex("allocate_pages: VirtualAlloc failed", static_cast<int>(::GetLastError()));
+    }
+    if (options.lock)
+    {
+        (void)::VirtualLock(p, mapped);
+    }
+#else
+    void *p = MAP_FAILED;
+    if (!options.file.empty())
+    {
+        p = page_memory::map_file(options.file, mapped);
+    }
+#    ifdef MAP_HUGETLB
+    else if (options.huge_pages)
+    {
+        p = ::mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    }
+#    endif
+    if (p == MAP_FAILED)
+    {
+        p = ::mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED)
+        {
+            throw_spdlog_ex("allocate_pages: mmap failed", errno);
+        }
+#    ifdef MADV_HUGEPAGE
+        if (options.huge_pages)
+        {
+            (void)::madvise(p, mapped, MADV_HUGEPAGE);
+        }
+#    endif
+    }
+    if (options.lock)
+    {
+        // faults in the pages as well
+        (void)::mlock(p, mapped);
+    }
+#endif
+    if (options.prefault)
+    {
+        auto *bytes = static_cast<volatile char *>(p);
+        for (size_t offset = 0, step = page_memory::page_size(); offset < mapped; offset += step)
+        {
+            bytes[offset] = 0;
+        }
+    }
+    return p;
+}
+
+SPDLOG_INLINE void free_pages(void *p, size_t size, const page_options &options) SPDLOG_NOEXCEPT
+{
+    if (p == nullptr)
+    {
+        return;
+    }
+    if (!options.any())
+    {
+        ::operator delete(p);
+        return;
+    }
+#ifdef _WIN32
+    (void)size;
+    ::VirtualFree(p, 0, MEM_RELEASE);
+#else
+    ::munmap(p, page_memory::mapped_size(size == 0 ? 1 : size, options));
+    if (!options.file.empty())
+    {
+        (void)::unlink(options.file.c_str());
+    }
+#endif
+}
+
+} // namespace details
+} // namespace spdlog
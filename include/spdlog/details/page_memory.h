@@ -0,0 +1,171 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Storage of the queues mapped straight from the OS: optionally on huge pages, prefaulted and locked in RAM,
+// so that no slot takes a page fault (or a TLB miss per 4 KiB) when it is first used.
+
+#include <spdlog/common.h>
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace spdlog {
+namespace details {
+
+struct page_options
+{
+    // map huge pages (MAP_HUGETLB, size rounded up to 2 MiB), falling back to transparent huge pages
+    // (madvise) when none are reserved. linux only, ignored elsewhere.
+    bool huge_pages = false;
+    // touch every page at allocation
+    bool prefault = false;
+    // lock the pages in RAM (mlock / VirtualLock). best effort: limited by RLIMIT_MEMLOCK
+    bool lock = false;
+    // back the pages by this file (created or truncated, and removed when the pages are freed) instead of
+    // anonymous memory: a shared mapping whose blocks are allocated up front, so the pages the kernel writes
+    // back cost no RAM or swap. huge_pages is then ignored. posix only: throws spdlog_ex on windows.
+    filename_t file;
+
+    bool any() const
+    {
+        return huge_pages || prefault || lock || !file.empty();
+    }
+};
+
+inline bool operator==(const page_options &a, const page_options &b)
+{
+    return a.huge_pages == b.huge_pages && a.prefault == b.prefault && a.lock == b.lock && a.file == b.file;
+}
+
+inline bool operator!=(const page_options &a, const page_options &b)
+{
+    return !(a == b);
+}
+
+// size bytes, by operator new if no option is set. throws spdlog_ex if the mapping failed.
+SPDLOG_API void *allocate_pages(size_t size, const page_options &options);
+// free what allocate_pages(size, options) returned
+SPDLOG_API void free_pages(void *p, size_t size, const page_options &options) SPDLOG_NOEXCEPT;
+
+// allocator of the std containers
+template<typename T>
+class page_allocator
+{
+public:
+    using value_type = T;
+    // the containers moved or copied keep the pages they were allocated with
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    page_allocator() = default;
+
+    explicit page_allocator(const page_options &options)
+        : options_(options)
+    {}
+
+    template<typename U>
+    page_allocator(const page_allocator<U> &other) SPDLOG_NOEXCEPT : options_(other.options())
+    {}
+
+    T *allocate(size_t n)
+    {
+        return static_cast<T *>(allocate_pages(n * sizeof(T), options_));
+    }
+
+    void deallocate(T *p, size_t n) SPDLOG_NOEXCEPT
+    {
+        free_pages(p, n * sizeof(T), options_);
+    }
+
+    const page_options &options() const
+    {
+        return options_;
+    }
+
+private:
+    page_options options_;
+};
+
+template<typename T, typename U>
+bool operator==(const page_allocator<T> &a, const page_allocator<U> &b)
+{
+    return a.options() == b.options();
+}
+
+template<typename T, typename U>
+bool operator!=(const page_allocator<T> &a, const page_allocator<U> &b)
+{
+    return !(a == b);
+}
+
+// fixed size array of default constructed T, for the elements that can't be moved (e.g. atomics).
+// T's default constructor must not throw.
+template<typename T>
+class page_array
+{
+public:
+    page_array(size_t size, const page_options &options)
+        : size_(size)
+        , options_(options)
+        , data_(static_cast<T *>(allocate_pages(size * sizeof(T), options)))
+    {
+        for (size_t i = 0; i < size_; i++)
+        {
+            new (data_ + i) T;
+        }
+    }
+
+    page_array(const page_array &) = delete;
+    page_array &operator=(const page_array &) = delete;
+
+    ~page_array()
+    {
+        for (size_t i = size_; i > 0; i--)
+        {
+            data_[i - 1].~T();
+        }
+        free_pages(data_, size_ * sizeof(T), options_);
+    }
+
+    T &operator[](size_t i)
+    {
+        return data_[i];
+    }
+
+    const T &operator[](size_t i) const
+    {
+        return data_[i];
+    }
+
+    T *data()
+    {
+        return data_;
+    }
+
+    const T *data() const
+    {
+        return data_;
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+private:
+    size_t size_;
+    page_options options_;
+    T *data_;
+};
+
+} // namespace details
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "page_memory-inl.h"
+#endif
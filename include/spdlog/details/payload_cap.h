@@ -0,0 +1,56 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Capping of the message payloads (see logger::set_max_payload_bytes()): a payload over the cap is cut to the cap
+// minus the size of SPDLOG_TRUNCATION_MARKER (at a utf-8 character boundary), and ends with the marker.
+
+#include <spdlog/common.h>
+
+#include <algorithm>
+
+#ifndef SPDLOG_TRUNCATION_MARKER
+#    define SPDLOG_TRUNCATION_MARKER "...[truncated]"
+#endif
+
+namespace spdlog {
+namespace details {
+
+// cut buf, holding more than max_bytes, to max_bytes ending with the marker
+inline void mark_truncated(memory_buf_t &buf, size_t max_bytes)
+{
+    string_view_t marker(SPDLOG_TRUNCATION_MARKER);
+    size_t cut = max_bytes > marker.size() ? max_bytes - marker.size() : 0;
+    while (cut > 0 && (static_cast<unsigned char>(buf.data()[cut]) & 0xC0) == 0x80)
+    {
+        cut--;
+    }
+    buf.resize(cut);
+    buf.append(marker.data(), marker.data() + (std::min)(marker.size(), max_bytes));
+}
+
+// format into buf up to max_bytes: the output beyond them is counted, not stored, so that the buffer grows with
+// the output only, never past the cap whatever the size of the args. return true if truncated.
+inline bool vformat_capped(memory_buf_t &buf, string_view_t fmt, fmt::format_args args, size_t max_bytes)
+{
+    buf.clear();
+    auto result = fmt::vformat_to_n(fmt::appender(buf), max_bytes + 1, fmt, args);
+    if (result.size <= max_bytes)
+    {
+        return false;
+    }
+    mark_truncated(buf, max_bytes);
+    return true;
+}
+
+// copy the first bytes of a payload over the cap to buf, ending with the marker
+inline void copy_capped(string_view_t payload, size_t max_bytes, memory_buf_t &buf)
+{
+    buf.clear();
+    buf.append(payload.data(), payload.data() + max_bytes + 1);
+    mark_truncated(buf, max_bytes);
+}
+
+} // namespace details
+} // namespace spdlog
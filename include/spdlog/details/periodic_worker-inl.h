@@ -10,38 +10,21 @@
 namespace spdlog {
 namespace details {
 
-SPDLOG_INLINE periodic_worker::periodic_worker(const std::function<void()> &callback_fun, std::chrono::seconds interval)
+SPDLOG_INLINE periodic_worker::periodic_worker(const std::function<void()> &callback_fun, std::chrono::nanoseconds interval)
 {
-    active_ = (interval > std::chrono::seconds::zero());
-    if (!active_)
+    if (interval <= std::chrono::nanoseconds::zero())
     {
         return;
     }
-
-    worker_thread_ = std::thread([this, callback_fun, interval]() {
-        for (;;)
-        {
-            std::unique_lock<std::mutex> lock(this->mutex_);
-            if (this->cv_.wait_for(lock, interval, [this] { return !this->active_; }))
-            {
-                return; // active_ == false, so exit this thread
-            }
-            callback_fun();
-        }
-    });
+    wheel_ = timer_wheel::instance();
+    timer_id_ = wheel_->schedule_every(callback_fun, interval);
 }
 
-// stop the worker thread and join it
 SPDLOG_INLINE periodic_worker::~periodic_worker()
 {
-    if (worker_thread_.joinable())
+    if (wheel_)
     {
-        {
-            std::lock_guard<std::mutex> lock(mutex_);
-            active_ = false;
-        }
-        cv_.notify_one();
-        worker_thread_.join();
+        wheel_->cancel(timer_id_);
     }
 }
 
@@ -3,34 +3,35 @@
 
 #pragma once
 
-// periodic worker thread - periodically executes the given callback function.
+// periodic worker - periodically executes the given callback function on the shared timer wheel thread
+// (see timer_wheel.h).
 //
-// RAII over the owned thread:
-//    creates the thread on construction.
-//    stops and joins the thread on destruction (if the thread is executing a callback, wait for it to finish first).
+// RAII over the timer:
+//    schedules the callback on construction.
+//    cancels it on destruction (if the callback is executing, wait for it to finish first).
+
+#include <spdlog/common.h>
+#include <spdlog/details/timer_wheel.h>
 
 #include <chrono>
-#include <condition_variable>
 #include <functional>
-#include <mutex>
-#include <thread>
+#include <memory>
 namespace spdlog {
 namespace details {
 
 class SPDLOG_API periodic_worker
 {
 public:
-    periodic_worker(const std::function<void()> &callback_fun, std::chrono::seconds interval);
+    // callback_fun is not called if interval isn't positive
+    periodic_worker(const std::function<void()> &callback_fun, std::chrono::nanoseconds interval);
     periodic_worker(const periodic_worker &) = delete;
     periodic_worker &operator=(const periodic_worker &) = delete;
-    // stop the worker thread and join it
+    // cancel the timer
     ~periodic_worker();
 
 private:
-    bool active_;
-    std::thread worker_thread_;
-    std::mutex mutex_;
-    std::condition_variable cv_;
+    std::shared_ptr<timer_wheel> wheel_;
+    timer_wheel::timer_id timer_id_{0};
 };
 } // namespace details
 } // namespace spdlog
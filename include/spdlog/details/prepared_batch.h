@@ -0,0 +1,64 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// The messages of a batch made ready by a worker of an ordered thread pool (see thread_pool_options::ordered_workers)
+// before its turn to write them: the payloads of the deferred messages and the text of each sink formatting ahead
+// (see sinks::sink::format_ahead()), in one buffer. The texts are referenced by offset, the buffer grows while
+// they are added.
+
+#include <spdlog/common.h>
+
+#include <vector>
+
+namespace spdlog {
+namespace details {
+
+struct prepared_batch
+{
+    struct sink_text
+    {
+        size_t sink; // index in the logger's sinks
+        size_t begin;
+        size_t size;
+        size_t color_range_start;
+        size_t color_range_end;
+    };
+
+    struct message
+    {
+        bool ready = false;
+        // the payload formatted by the worker (deferred messages), if has_payload
+        bool has_payload = false;
+        size_t payload_begin = 0;
+        size_t payload_size = 0;
+        // the texts of the sinks, in the order of the sinks
+        size_t first_text = 0;
+        size_t n_texts = 0;
+    };
+
+    memory_buf_t text;
+    std::vector<sink_text> texts;
+    std::vector<message> msgs;
+
+    void reset(size_t n_msgs)
+    {
+        text.clear();
+        texts.clear();
+        msgs.assign(n_msgs, message{});
+    }
+
+    bool ready(size_t i) const
+    {
+        return i < msgs.size() && msgs[i].ready;
+    }
+
+    string_view_t view(size_t begin, size_t size) const
+    {
+        return string_view_t(text.data() + begin, size);
+    }
+};
+
+} // namespace details
+} // namespace spdlog
@@ -0,0 +1,193 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Self profiling counters of the loggers and sinks (see logger::profile_stats() and
+// sink::profile_stats()), compiled out unless SPDLOG_ENABLE_STATS is defined - the snapshots
+// are then all zero.
+//
+// Each thread updates its own cache line padded slot of the counters (picked by thread id, so
+// threads share a slot only past profile_slots of them) with relaxed atomics, and reading
+// sums up the slots: counting never contends on a shared cache line.
+
+#include <spdlog/common.h>
+
+#include <chrono>
+
+#ifdef SPDLOG_ENABLE_STATS
+#    include <spdlog/details/os.h>
+
+#    include <array>
+#    include <atomic>
+#endif
+
+namespace spdlog {
+namespace details {
+
+struct profile_stats
+{
+    size_t messages = 0;        // log calls (logger), or messages logged by the sink
+    size_t filtered = 0;        // of the log calls, those below the logger level (or not sampled) - or skipped by the sink level
+    size_t formatted_bytes = 0; // formatted by the logger (fmt args) or by the sink formatter
+    std::chrono::nanoseconds format_time{0};
+    std::chrono::nanoseconds sink_time{0}; // passing the messages to the sinks (logger), or in sink_it_ (sink)
+    size_t flushes = 0;
+    std::chrono::nanoseconds flush_time{0};
+};
+
+#ifdef SPDLOG_ENABLE_STATS
+
+SPDLOG_CONSTEXPR size_t profile_slots = 16;
+
+// the time taken since construction
+class profile_timer
+{
+public:
+    profile_timer()
+        : start_(std::chrono::steady_clock::now())
+    {}
+
+    std::chrono::nanoseconds elapsed() const
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_);
+    }
+
+private:
+    std::chrono::steady_clock::time_point start_;
+};
+
+class profile_counters
+{
+public:
+    void on_message(bool passed)
+    {
+        auto &slot = local_slot_();
+        add_(slot.messages, 1);
+        if (!passed)
+        {
+            add_(slot.filtered, 1);
+        }
+    }
+
+    void on_filtered()
+    {
+        add_(local_slot_().filtered, 1);
+    }
+
+    void on_formatted(size_t bytes, const profile_timer &timer)
+    {
+        auto &slot = local_slot_();
+        add_(slot.formatted_bytes, bytes);
+        add_(slot.format_ns, static_cast<size_t>(timer.elapsed().count()));
+    }
+
+    void on_sunk(size_t n_msgs, const profile_timer &timer)
+    {
+        auto &slot = local_slot_();
+        add_(slot.messages, n_msgs);
+        add_(slot.sink_ns, static_cast<size_t>(timer.elapsed().count()));
+    }
+
+    // a batch of messages, those below the sink level skipped
+    template<typename Msg>
+    void on_sunk_batch(const Msg *msgs, size_t n_msgs, level::level_enum sink_level, const profile_timer &timer)
+    {
+        size_t n_logged = 0;
+        for (size_t i = 0; i < n_msgs; i++)
+        {
+            n_logged += msgs[i].level >= sink_level ? 1 : 0;
+        }
+        auto &slot = local_slot_();
+        add_(slot.filtered, n_msgs - n_logged);
+        add_(slot.messages, n_logged);
+        add_(slot.sink_ns, static_cast<size_t>(timer.elapsed().count()));
+    }
+
+    // passed by the logger to its sinks (counted by on_message() already)
+    void on_dispatched(const profile_timer &timer)
+    {
+        add_(local_slot_().sink_ns, static_cast<size_t>(timer.elapsed().count()));
+    }
+
+    void on_flushed(const profile_timer &timer)
+    {
+        auto &slot = local_slot_();
+        add_(slot.flushes, 1);
+        add_(slot.flush_ns, static_cast<size_t>(timer.elapsed().count()));
+    }
+
+    profile_stats snapshot() const
+    {
+        profile_stats stats;
+        size_t format_ns = 0, sink_ns = 0, flush_ns = 0;
+        for (auto &slot : slots_)
+        {
+            stats.messages += slot.messages.load(std::memory_order_relaxed);
+            stats.filtered += slot.filtered.load(std::memory_order_relaxed);
+            stats.formatted_bytes += slot.formatted_bytes.load(std::memory_order_relaxed);
+            format_ns += slot.format_ns.load(std::memory_order_relaxed);
+            sink_ns += slot.sink_ns.load(std::memory_order_relaxed);
+            stats.flushes += slot.flushes.load(std::memory_order_relaxed);
+            flush_ns += slot.flush_ns.load(std::memory_order_relaxed);
+        }
+        stats.format_time = std::chrono::nanoseconds(format_ns);
+        stats.sink_time = std::chrono::nanoseconds(sink_ns);
+        stats.flush_time = std::chrono::nanoseconds(flush_ns);
+        return stats;
+    }
+
+private:
+    struct counter_slot
+    {
+        std::atomic<size_t> messages{0};
+        std::atomic<size_t> filtered{0};
+        std::atomic<size_t> formatted_bytes{0};
+        std::atomic<size_t> format_ns{0};
+        std::atomic<size_t> sink_ns{0};
+        std::atomic<size_t> flushes{0};
+        std::atomic<size_t> flush_ns{0};
+        char padding[SPDLOG_CACHE_LINE_SIZE];
+    };
+
+    std::array<counter_slot, profile_slots> slots_;
+
+    counter_slot &local_slot_()
+    {
+        return slots_[os::thread_id() % profile_slots];
+    }
+
+    static void add_(std::atomic<size_t> &counter, size_t n)
+    {
+        counter.fetch_add(n, std::memory_order_relaxed);
+    }
+};
+
+#else
+
+class profile_timer
+{};
+
+class profile_counters
+{
+public:
+    void on_message(bool) {}
+    void on_filtered() {}
+    void on_formatted(size_t, const profile_timer &) {}
+    void on_sunk(size_t, const profile_timer &) {}
+    template<typename Msg>
+    void on_sunk_batch(const Msg *, size_t, level::level_enum, const profile_timer &)
+    {}
+    void on_dispatched(const profile_timer &) {}
+    void on_flushed(const profile_timer &) {}
+
+    profile_stats snapshot() const
+    {
+        return profile_stats{};
+    }
+};
+
+#endif // SPDLOG_ENABLE_STATS
+
+} // namespace details
+} // namespace spdlog
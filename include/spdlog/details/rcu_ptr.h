@@ -0,0 +1,127 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <spdlog/common.h>
+#include <spdlog/details/os.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+namespace spdlog {
+namespace details {
+
+// Pointer to an immutable value, read without locks and replaced by copy (read-copy-update).
+//
+// Readers pin the current value with a read_guard: they only increment a counter of the current epoch.
+// A writer publishes a new value, starts the next epoch and waits for the readers of the previous one
+// before deleting the previous value - the writers pay for the grace period, never the readers.
+// The counters are striped by thread, so that readers of different threads don't share cache lines.
+// Writers must be serialized by the caller, and not run while their thread holds a read_guard.
+template<typename T>
+class rcu_ptr
+{
+    static const size_t stripes = 16;
+
+    struct counter
+    {
+        std::atomic<size_t> value{0};
+        char padding[64 - sizeof(std::atomic<size_t>)];
+    };
+
+public:
+    // the value stays valid while the guard lives, even if replaced meanwhile
+    class read_guard
+    {
+    public:
+        explicit read_guard(const rcu_ptr &ptr)
+            : readers_(&ptr.enter_())
+            , value_(ptr.value_.load())
+        {}
+        read_guard(const read_guard &) = delete;
+        read_guard &operator=(const read_guard &) = delete;
+        read_guard(read_guard &&other) SPDLOG_NOEXCEPT : readers_(other.readers_), value_(other.value_)
+        {
+            other.readers_ = nullptr;
+        }
+        ~read_guard()
+        {
+            if (readers_ != nullptr)
+            {
+                readers_->fetch_sub(1, std::memory_order_release);
+            }
+        }
+
+        const T *get() const
+        {
+            return value_;
+        }
+
+        const T &operator*() const
+        {
+            return *value_;
+        }
+
+        const T *operator->() const
+        {
+            return value_;
+        }
+
+    private:
+        std::atomic<size_t> *readers_;
+        const T *value_;
+    };
+
+    explicit rcu_ptr(std::unique_ptr<T> value)
+        : value_(value.release())
+    {}
+    rcu_ptr(const rcu_ptr &) = delete;
+    rcu_ptr &operator=(const rcu_ptr &) = delete;
+    ~rcu_ptr()
+    {
+        delete value_.load();
+    }
+
+    // replace the value, and delete the previous one once no reader uses it
+    void publish(std::unique_ptr<T> value)
+    {
+        std::unique_ptr<const T> previous(value_.exchange(value.release()));
+        // the readers entering from now on see the new value
+        auto epoch = epoch_.fetch_add(1);
+        for (auto &previous_readers : readers_[epoch & 1])
+        {
+            while (previous_readers.value.load(std::memory_order_acquire) != 0)
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+private:
+    std::atomic<T *> value_;
+    std::atomic<size_t> epoch_{0};
+    mutable counter readers_[2][stripes];
+
+    // count the reader in the current epoch. retry if a writer ended it meanwhile:
+    // it may have missed this reader and be deleting the value.
+    std::atomic<size_t> &enter_() const
+    {
+        auto stripe = os::thread_id() % stripes;
+        for (;;)
+        {
+            auto epoch = epoch_.load();
+            auto &readers = readers_[epoch & 1][stripe].value;
+            readers.fetch_add(1);
+            if (epoch_.load() == epoch)
+            {
+                return readers;
+            }
+            readers.fetch_sub(1, std::memory_order_release);
+        }
+    }
+};
+
+} // namespace details
+} // namespace spdlog
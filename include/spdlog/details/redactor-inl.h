@@ -0,0 +1,243 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/details/redactor.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+
+namespace spdlog {
+namespace details {
+
+namespace redaction {
+const uint64_t ones = 0x0101010101010101ULL;
+
+inline uint64_t broadcast(char c)
+{
+    return static_cast<uint64_t>(static_cast<unsigned char>(c)) * ones;
+}
+
+// non zero if a byte of v is zero (may flag the bytes after it too)
+inline uint64_t zero_bytes(uint64_t v)
+{
+    return (v - ones) & ~v & (ones * 128);
+}
+
+// the high bit of each byte of v > m and < n (m <= 127, n <= 128)
+inline uint64_t bytes_between(uint64_t v, uint64_t m, uint64_t n)
+{
+    auto low = v & (ones * 127);
+    return (ones * (127 + n) - low) & ~v & (low + ones * (127 - m)) & (ones * 128);
+}
+} // namespace redaction
+
+SPDLOG_INLINE redactor::redactor(const redact_options &options)
+    : options_(options)
+{
+    std::memset(classes_, 0, sizeof(classes_));
+    for (int c = 0; c < 256; c++)
+    {
+        bool digit = c >= '0' && c <= '9';
+        bool alnum = digit || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+        unsigned char cls = 0;
+        cls |= digit ? digit_class : 0;
+        cls |= alnum || c == '_' ? word_class : 0;
+        cls |= alnum || std::strchr("-_.+/=", c) != nullptr ? token_class : 0;
+        cls |= alnum || std::strchr("._%+-", c) != nullptr ? email_class : 0;
+        classes_[c] = static_cast<unsigned char>(c == 0 ? 0 : cls);
+    }
+    classes_[static_cast<unsigned char>('@')] |= at_class;
+    for (const auto &prefix : options_.token_prefixes)
+    {
+        if (prefix.empty() || has_class_(prefix.front(), prefix_class))
+        {
+            continue;
+        }
+        classes_[static_cast<unsigned char>(prefix.front())] |= prefix_class;
+        prefix_bytes_.push_back(redaction::broadcast(prefix.front()));
+    }
+}
+
+SPDLOG_INLINE size_t redactor::redact(char *data, size_t size) const
+{
+    size_t masked = 0;
+    size_t pos = 0;
+    while (pos < size)
+    {
+        if (pos + 8 <= size && !block_candidate_(data + pos))
+        {
+            pos += 8;
+            continue;
+        }
+        // the positions of the block one at a time - what is masked may end past it
+        auto block_end = (std::min)(pos + 8, size);
+        while (pos < block_end)
+        {
+            pos = redact_at_(data, size, pos, masked);
+        }
+    }
+    return masked;
+}
+
+SPDLOG_INLINE bool redactor::block_candidate_(const char *p) const
+{
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    uint64_t found = 0;
+    if (options_.cards)
+    {
+        found |= redaction::bytes_between(v, '0' - 1, '9' + 1);
+    }
+    if (options_.emails)
+    {
+        found |= redaction::zero_bytes(v ^ redaction::broadcast('@'));
+    }
+    for (auto bytes : prefix_bytes_)
+    {
+        found |= redaction::zero_bytes(v ^ bytes);
+    }
+    return found != 0;
+}
+
+SPDLOG_INLINE size_t redactor::redact_at_(char *data, size_t size, size_t pos, size_t &masked) const
+{
+    auto c = data[pos];
+    if (has_class_(c, prefix_class))
+    {
+        auto next = redact_token_(data, size, pos, masked);
+        if (next != pos)
+        {
+            return next;
+        }
+    }
+    if (options_.cards && has_class_(c, digit_class))
+    {
+        return redact_digits_(data, size, pos, masked);
+    }
+    if (options_.emails && c == '@')
+    {
+        return redact_email_(data, size, pos, masked);
+    }
+    return pos + 1;
+}
+
+SPDLOG_INLINE size_t redactor::redact_digits_(char *data, size_t size, size_t pos, size_t &masked) const
+{
+    // the whole run, separators included: it is not looked at again
+    size_t n_digits = 0;
+    auto end = pos;
+    while (end < size)
+    {
+        if (has_class_(data[end], digit_class))
+        {
+            n_digits++;
+            end++;
+        }
+        else if ((data[end] == ' ' || data[end] == '-') && end + 1 < size && has_class_(data[end + 1], digit_class))
+        {
+            end++;
+        }
+        else
+        {
+            break;
+        }
+    }
+    bool bounded = (pos == 0 || !has_class_(data[pos - 1], word_class)) && (end == size || !has_class_(data[end], word_class));
+    if (!bounded || n_digits < 13 || n_digits > 19)
+    {
+        return end;
+    }
+    if (options_.luhn_check)
+    {
+        // from the rightmost digit, every second one doubled
+        unsigned sum = 0;
+        size_t i = 0;
+        for (auto p = end; p > pos; p--)
+        {
+            auto c = data[p - 1];
+            if (has_class_(c, digit_class))
+            {
+                auto d = static_cast<unsigned>(c - '0');
+                if (i++ % 2 == 1)
+                {
+                    d = d * 2 > 9 ? d * 2 - 9 : d * 2;
+                }
+                sum += d;
+            }
+        }
+        if (sum % 10 != 0)
+        {
+            return end;
+        }
+    }
+    auto to_mask = n_digits > options_.keep_last_digits ? n_digits - options_.keep_last_digits : 0;
+    for (auto p = pos; p < end && to_mask > 0; p++)
+    {
+        if (has_class_(data[p], digit_class))
+        {
+            data[p] = options_.mask;
+            to_mask--;
+            masked++;
+        }
+    }
+    return end;
+}
+
+SPDLOG_INLINE size_t redactor::redact_email_(char *data, size_t size, size_t pos, size_t &masked) const
+{
+    auto begin = pos;
+    while (begin > 0 && has_class_(data[begin - 1], email_class))
+    {
+        begin--;
+    }
+    auto end = pos + 1;
+    while (end < size && has_class_(data[end], email_class))
+    {
+        end++;
+    }
+    // not the dot ending a sentence
+    while (end > pos + 1 && data[end - 1] == '.')
+    {
+        end--;
+    }
+    auto *dot = end > pos + 2 ? static_cast<const char *>(std::memchr(data + pos + 2, '.', end - pos - 2)) : nullptr;
+    if (begin == pos || dot == nullptr)
+    {
+        return pos + 1;
+    }
+    std::fill(data + begin, data + pos, options_.mask);
+    std::fill(data + pos + 1, data + end, options_.mask);
+    masked += end - begin - 1;
+    return end;
+}
+
+SPDLOG_INLINE size_t redactor::redact_token_(char *data, size_t size, size_t pos, size_t &masked) const
+{
+    for (const auto &prefix : options_.token_prefixes)
+    {
+        if (prefix.empty() || prefix.size() > size - pos || std::memcmp(data + pos, prefix.data(), prefix.size()) != 0)
+        {
+            continue;
+        }
+        auto begin = pos + prefix.size();
+        auto end = begin;
+        while (end < size && has_class_(data[end], token_class))
+        {
+            end++;
+        }
+        if (end > begin)
+        {
+            std::fill(data + begin, data + end, options_.mask);
+            masked += end - begin;
+            return end;
+        }
+    }
+    return pos;
+}
+
+} // namespace details
+} // namespace spdlog
@@ -0,0 +1,81 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Masking of the personal data in log text, in place (see sinks/redact_sink.h): card numbers, email
+// addresses and the secrets following known token prefixes are overwritten with a mask character - the
+// text keeps its size, nothing is allocated.
+//
+// The text is scanned 8 bytes at a time (SWAR, portable - no intrinsics) for the bytes that may start
+// something to mask: digits, '@' and the first bytes of the token prefixes. The blocks without any are
+// skipped; only the positions of the others are looked at one at a time.
+//
+// - card numbers: runs of 13 to 19 digits, optionally grouped by single spaces or dashes, passing the Luhn
+//   check. the last digits are kept (keep_last_digits).
+// - emails: local-part@domain, the domain with a dot. all but the '@' is masked.
+// - tokens: what follows one of the token prefixes (case sensitive, anywhere), up to the next character
+//   neither alphanumeric nor one of "-_.+/=". the prefix is kept.
+
+#include <spdlog/common.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace spdlog {
+namespace details {
+
+struct redact_options
+{
+    bool cards = true;
+    bool luhn_check = true; // digit runs failing the Luhn check are not card numbers
+    size_t keep_last_digits = 4;
+    bool emails = true;
+    std::vector<std::string> token_prefixes = {"Bearer ", "token=", "password=", "api_key=", "sk_live_", "ghp_", "xoxb-"};
+    char mask = '*';
+};
+
+class SPDLOG_API redactor
+{
+public:
+    explicit redactor(const redact_options &options = redact_options());
+
+    // mask the personal data in [data, data + size). return the number of characters masked.
+    size_t redact(char *data, size_t size) const;
+
+private:
+    enum : unsigned char
+    {
+        digit_class = 1,
+        at_class = 2,
+        prefix_class = 4, // the first byte of a token prefix
+        token_class = 8,  // may be in a token
+        email_class = 16, // may be in the local part or the domain of an email
+        word_class = 32   // alphanumeric or '_'
+    };
+
+    redact_options options_;
+    unsigned char classes_[256];
+    std::vector<uint64_t> prefix_bytes_; // the distinct first bytes of the prefixes, in each byte
+
+    // whether the 8 bytes from p may start something to mask
+    bool block_candidate_(const char *p) const;
+    // mask what starts at pos, if anything: the masked characters are added to masked. return the position
+    // to continue from.
+    size_t redact_at_(char *data, size_t size, size_t pos, size_t &masked) const;
+    size_t redact_digits_(char *data, size_t size, size_t pos, size_t &masked) const;
+    size_t redact_email_(char *data, size_t size, size_t pos, size_t &masked) const;
+    size_t redact_token_(char *data, size_t size, size_t pos, size_t &masked) const;
+    bool has_class_(char c, unsigned char cls) const
+    {
+        return (classes_[static_cast<unsigned char>(c)] & cls) != 0;
+    }
+};
+
+} // namespace details
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "redactor-inl.h"
+#endif
@@ -21,17 +21,21 @@
 #    endif
 #endif // SPDLOG_DISABLE_DEFAULT_LOGGER
 
+#include <algorithm>
 #include <chrono>
 #include <functional>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace spdlog {
 namespace details {
 
 SPDLOG_INLINE registry::registry()
-    : formatter_(new pattern_formatter())
+    : loggers_snapshot_(details::make_unique<loggers_snapshot>())
+    , formatter_(new pattern_formatter())
+    , pinned_default_(details::make_unique<std::shared_ptr<logger>>())
 {
 
 #ifndef SPDLOG_DISABLE_DEFAULT_LOGGER
@@ -43,8 +47,9 @@ SPDLOG_INLINE registry::registry()
 #    endif
 
     const char *default_logger_name = "";
-    default_logger_ = std::make_shared<spdlog::logger>(default_logger_name, std::move(color_sink));
+    update_default_(std::make_shared<spdlog::logger>(default_logger_name, std::move(color_sink)));
     loggers_[default_logger_name] = default_logger_;
+    invalidate_snapshot_();
 
 #endif // SPDLOG_DISABLE_DEFAULT_LOGGER
 }
@@ -60,51 +65,65 @@ SPDLOG_INLINE void registry::register_logger(std::shared_ptr<logger> new_logger)
 SPDLOG_INLINE void registry::initialize_logger(std::shared_ptr<logger> new_logger)
 {
     std::lock_guard<std::mutex> lock(logger_map_mutex_);
-    new_logger->set_formatter(formatter_->clone());
-
-    if (err_handler_)
+    initialize_logger_(*new_logger);
+    if (automatic_registration_)
     {
-        new_logger->set_error_handler(err_handler_);
+        register_logger_(std::move(new_logger));
     }
+}
 
-    // set new level according to previously configured level or default level
-    auto it = log_levels_.find(new_logger->name());
-    auto new_level = it != log_levels_.end() ? it->second : global_log_level_;
-    new_logger->set_level(new_level);
-
-    new_logger->flush_on(flush_level_);
+SPDLOG_INLINE void registry::register_loggers(std::vector<std::shared_ptr<logger>> new_loggers)
+{
+    std::lock_guard<std::mutex> lock(logger_map_mutex_);
+    register_loggers_(std::move(new_loggers));
+}
 
-    if (backtrace_n_messages_ > 0)
+SPDLOG_INLINE void registry::initialize_loggers(std::vector<std::shared_ptr<logger>> new_loggers)
+{
+    std::lock_guard<std::mutex> lock(logger_map_mutex_);
+    for (auto &new_logger : new_loggers)
     {
-        new_logger->enable_backtrace(backtrace_n_messages_);
+        initialize_logger_(*new_logger);
     }
-
     if (automatic_registration_)
     {
-        register_logger_(std::move(new_logger));
+        register_loggers_(std::move(new_loggers));
     }
 }
 
-SPDLOG_INLINE std::shared_ptr<logger> registry::get(const std::string &logger_name)
+SPDLOG_INLINE std::shared_ptr<logger> registry::get(string_view_t logger_name)
 {
-    std::lock_guard<std::mutex> lock(logger_map_mutex_);
-    auto found = loggers_.find(logger_name);
-    return found == loggers_.end() ? nullptr : found->second;
+    if (snapshot_stale_.load(std::memory_order_acquire))
+    {
+        std::lock_guard<std::mutex> lock(logger_map_mutex_);
+        publish_snapshot_();
+    }
+    rcu_ptr<loggers_snapshot>::read_guard snapshot(loggers_snapshot_);
+    auto found = std::lower_bound(snapshot->begin(), snapshot->end(), logger_name,
+        [](const loggers_snapshot::value_type &entry, string_view_t name) { return string_view_t(entry.first) < name; });
+    if (found == snapshot->end() || string_view_t(found->first) != logger_name)
+    {
+        return nullptr;
+    }
+    return found->second;
 }
 
 SPDLOG_INLINE std::shared_ptr<logger> registry::default_logger()
 {
-    std::lock_guard<std::mutex> lock(logger_map_mutex_);
-    return default_logger_;
+    rcu_ptr<std::shared_ptr<logger>>::read_guard pinned(pinned_default_);
+    return *pinned;
 }
 
 // Return raw ptr to the default logger.
-// To be used directly by the spdlog default api (e.g. spdlog::info)
-// This make the default API faster, but cannot be used concurrently with set_default_logger().
-// e.g do not call set_default_logger() from one thread while calling spdlog::info() from another.
+// It cannot be used concurrently with set_default_logger(), which may destroy it: use pin_default() then.
 SPDLOG_INLINE logger *registry::get_default_raw()
 {
-    return default_logger_.get();
+    return pin_default().get();
+}
+
+SPDLOG_INLINE pinned_logger registry::pin_default()
+{
+    return pinned_logger(pinned_default_);
 }
 
 // set default logger.
@@ -121,7 +140,10 @@ SPDLOG_INLINE void registry::set_default_logger(std::shared_ptr<logger> new_defa
     {
         loggers_[new_default_logger->name()] = new_default_logger;
     }
-    default_logger_ = std::move(new_default_logger);
+    update_default_(std::move(new_default_logger));
+    invalidate_snapshot_();
+    // not keeping the previous default logger alive until the next get()
+    publish_snapshot_();
 }
 
 SPDLOG_INLINE void registry::set_tp(std::shared_ptr<thread_pool> tp)
@@ -178,6 +200,30 @@ SPDLOG_INLINE void registry::set_level(level::level_enum log_level)
     global_log_level_ = log_level;
 }
 
+SPDLOG_INLINE void registry::set_level(const std::string &logger_name, level::level_enum log_level)
+{
+    if (logger_name.empty())
+    {
+        set_level(log_level);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(logger_map_mutex_);
+    log_levels_[logger_name] = log_level;
+
+    // the subtree is a range of the sorted snapshot: the names starting with logger_name
+    publish_snapshot_();
+    rcu_ptr<loggers_snapshot>::read_guard snapshot(loggers_snapshot_);
+    auto it = std::lower_bound(snapshot->begin(), snapshot->end(), logger_name,
+        [](const loggers_snapshot::value_type &entry, const std::string &name) { return entry.first < name; });
+    for (; it != snapshot->end() && it->first.compare(0, logger_name.size(), logger_name) == 0; ++it)
+    {
+        if (it->first.size() == logger_name.size() || it->first[logger_name.size()] == '.')
+        {
+            it->second->set_level(*find_inherited_(log_levels_, it->first));
+        }
+    }
+}
+
 SPDLOG_INLINE void registry::flush_on(level::level_enum log_level)
 {
     std::lock_guard<std::mutex> lock(logger_map_mutex_);
@@ -188,7 +234,7 @@ SPDLOG_INLINE void registry::flush_on(level::level_enum log_level)
     flush_level_ = log_level;
 }
 
-SPDLOG_INLINE void registry::flush_every(std::chrono::seconds interval)
+SPDLOG_INLINE void registry::flush_every(std::chrono::nanoseconds interval)
 {
     std::lock_guard<std::mutex> lock(flusher_mutex_);
     auto clbk = [this]() { this->flush_all(); };
@@ -215,12 +261,16 @@ SPDLOG_INLINE void registry::apply_all(const std::function<void(const std::share
 }
 
 SPDLOG_INLINE void registry::flush_all()
+{
+    std::vector<std::shared_ptr<logger>> loggers;
+    std::vector<flush_batch> batches;
+    (void)post_flush_all_(loggers, batches);
+}
+
+SPDLOG_INLINE void registry::set_flush_threads(size_t threads)
 {
     std::lock_guard<std::mutex> lock(logger_map_mutex_);
-    for (auto &l : loggers_)
-    {
-        l.second->flush();
-    }
+    flush_threads_ = threads;
 }
 
 SPDLOG_INLINE void registry::drop(const std::string &logger_name)
@@ -229,25 +279,44 @@ SPDLOG_INLINE void registry::drop(const std::string &logger_name)
     loggers_.erase(logger_name);
     if (default_logger_ && default_logger_->name() == logger_name)
     {
-        default_logger_.reset();
+        update_default_(nullptr);
     }
+    erase_from_snapshot_(logger_name);
 }
 
 SPDLOG_INLINE void registry::drop_all()
 {
     std::lock_guard<std::mutex> lock(logger_map_mutex_);
     loggers_.clear();
-    default_logger_.reset();
+    update_default_(nullptr);
+    loggers_snapshot_.publish(details::make_unique<loggers_snapshot>());
+    snapshot_stale_.store(false, std::memory_order_release);
 }
 
 // clean all resources and threads started by the registry
-SPDLOG_INLINE void registry::shutdown()
+SPDLOG_INLINE void registry::shutdown(std::chrono::nanoseconds drain_timeout)
 {
     {
         std::lock_guard<std::mutex> lock(flusher_mutex_);
         periodic_flusher_.reset();
     }
 
+    {
+        // unbounded, the thread pools write their queued messages before being destroyed
+        auto bounded = drain_timeout < std::chrono::nanoseconds::max();
+        auto deadline = std::chrono::steady_clock::now() + (bounded ? drain_timeout : std::chrono::nanoseconds::zero());
+        std::vector<std::shared_ptr<logger>> loggers;
+        std::vector<flush_batch> batches;
+        auto flushed = post_flush_all_(loggers, batches);
+        for (size_t i = 0; bounded && i < flushed.size(); i++)
+        {
+            if (flushed[i].wait_until(deadline) != std::future_status::ready && batches[i].abandon != nullptr)
+            {
+                batches[i].abandon(batches[i]);
+            }
+        }
+    }
+
     drop_all();
 
     {
@@ -276,10 +345,10 @@ SPDLOG_INLINE void registry::set_levels(log_levels levels, level::level_enum *gl
 
     for (auto &logger : loggers_)
     {
-        auto logger_entry = log_levels_.find(logger.first);
-        if (logger_entry != log_levels_.end())
+        auto logger_level = find_inherited_(log_levels_, logger.first);
+        if (logger_level != nullptr)
         {
-            logger.second->set_level(logger_entry->second);
+            logger.second->set_level(*logger_level);
         }
         else if (global_level_requested)
         {
@@ -288,12 +357,58 @@ SPDLOG_INLINE void registry::set_levels(log_levels levels, level::level_enum *gl
     }
 }
 
+SPDLOG_INLINE void registry::set_sample_rates(sample_rates rates, uint32_t *global_rate)
+{
+    std::lock_guard<std::mutex> lock(logger_map_mutex_);
+    sample_rates_ = std::move(rates);
+    auto global_rate_requested = global_rate != nullptr;
+    global_sample_rate_ = global_rate_requested ? *global_rate : global_sample_rate_;
+
+    for (auto &logger : loggers_)
+    {
+        auto logger_rate = find_inherited_(sample_rates_, logger.first);
+        if (logger_rate != nullptr)
+        {
+            logger.second->set_sample_rate(*logger_rate);
+        }
+        else if (global_rate_requested)
+        {
+            logger.second->set_sample_rate(*global_rate);
+        }
+    }
+}
+
 SPDLOG_INLINE registry &registry::instance()
 {
     static registry s_instance;
     return s_instance;
 }
 
+SPDLOG_INLINE std::vector<std::future<void>> registry::post_flush_all_(
+    std::vector<std::shared_ptr<logger>> &loggers, std::vector<flush_batch> &batches)
+{
+    size_t threads;
+    {
+        std::lock_guard<std::mutex> lock(logger_map_mutex_);
+        loggers.reserve(loggers_.size());
+        for (auto &l : loggers_)
+        {
+            loggers.push_back(l.second);
+        }
+        threads = flush_threads_;
+    }
+    for (auto &l : loggers)
+    {
+        l->flush_batched_(batches);
+    }
+    std::vector<std::future<void>> flushed;
+    for (auto &batch : batches)
+    {
+        flushed.push_back(batch.post(batch, threads));
+    }
+    return flushed;
+}
+
 SPDLOG_INLINE void registry::throw_if_exists_(const std::string &logger_name)
 {
     if (loggers_.find(logger_name) != loggers_.end())
@@ -307,6 +422,126 @@ SPDLOG_INLINE void registry::register_logger_(std::shared_ptr<logger> new_logger
     auto logger_name = new_logger->name();
     throw_if_exists_(logger_name);
     loggers_[logger_name] = std::move(new_logger);
+    invalidate_snapshot_();
+}
+
+SPDLOG_INLINE void registry::register_loggers_(std::vector<std::shared_ptr<logger>> new_loggers)
+{
+    std::vector<std::string> names;
+    names.reserve(new_loggers.size());
+    for (auto &new_logger : new_loggers)
+    {
+        throw_if_exists_(new_logger->name());
+        names.push_back(new_logger->name());
+    }
+    std::sort(names.begin(), names.end());
+    auto duplicate = std::adjacent_find(names.begin(), names.end());
+    if (duplicate != names.end())
+    {
+        throw_spdlog_ex("logger with name '" + *duplicate + "' already exists");
+    }
+    for (auto &new_logger : new_loggers)
+    {
+        auto logger_name = new_logger->name();
+        loggers_[logger_name] = std::move(new_logger);
+    }
+    invalidate_snapshot_();
+}
+
+SPDLOG_INLINE void registry::initialize_logger_(logger &new_logger)
+{
+    new_logger.set_formatter(formatter_->clone());
+
+    if (err_handler_)
+    {
+        new_logger.set_error_handler(err_handler_);
+    }
+
+    // set new level according to previously configured level (of the logger or its closest ancestor) or default level
+    auto new_level = find_inherited_(log_levels_, new_logger.name());
+    new_logger.set_level(new_level != nullptr ? *new_level : global_log_level_);
+
+    auto new_rate = find_inherited_(sample_rates_, new_logger.name());
+    new_logger.set_sample_rate(new_rate != nullptr ? *new_rate : global_sample_rate_);
+
+    new_logger.flush_on(flush_level_);
+
+    if (backtrace_n_messages_ > 0)
+    {
+        new_logger.enable_backtrace(backtrace_n_messages_);
+    }
+}
+
+template<typename Map>
+SPDLOG_INLINE const typename Map::mapped_type *registry::find_inherited_(const Map &values, const std::string &logger_name)
+{
+    if (values.empty())
+    {
+        return nullptr;
+    }
+    std::string name = logger_name;
+    for (;;)
+    {
+        auto it = values.find(name);
+        if (it != values.end())
+        {
+            return &it->second;
+        }
+        auto dot = name.rfind('.');
+        if (dot == std::string::npos)
+        {
+            return nullptr;
+        }
+        name.resize(dot);
+    }
+}
+
+// rebuilt on the next lookup: registering n loggers costs one sort, not n
+SPDLOG_INLINE void registry::invalidate_snapshot_()
+{
+    snapshot_stale_.store(true, std::memory_order_release);
+}
+
+SPDLOG_INLINE void registry::publish_snapshot_()
+{
+    if (!snapshot_stale_.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+    auto snapshot = details::make_unique<loggers_snapshot>(loggers_.begin(), loggers_.end());
+    std::sort(snapshot->begin(), snapshot->end(),
+        [](const loggers_snapshot::value_type &a, const loggers_snapshot::value_type &b) { return a.first < b.first; });
+    loggers_snapshot_.publish(std::move(snapshot));
+    snapshot_stale_.store(false, std::memory_order_release);
+}
+
+// a dropped logger is released right away, without sorting again
+SPDLOG_INLINE void registry::erase_from_snapshot_(const std::string &logger_name)
+{
+    if (snapshot_stale_.load(std::memory_order_relaxed))
+    {
+        publish_snapshot_();
+        return;
+    }
+    auto snapshot = details::make_unique<loggers_snapshot>();
+    {
+        rcu_ptr<loggers_snapshot>::read_guard current(loggers_snapshot_);
+        snapshot->reserve(current->size());
+        for (auto &entry : *current)
+        {
+            if (entry.first != logger_name)
+            {
+                snapshot->push_back(entry);
+            }
+        }
+    }
+    loggers_snapshot_.publish(std::move(snapshot));
+}
+
+SPDLOG_INLINE void registry::update_default_(std::shared_ptr<logger> new_default_logger)
+{
+    default_logger_ = std::move(new_default_logger);
+    pinned_default_.publish(details::make_unique<std::shared_ptr<logger>>(default_logger_));
 }
 
 } // namespace details
@@ -6,16 +6,22 @@
 // Loggers registry of unique name->logger pointer
 // An attempt to create a logger with an already existing name will result with spdlog_ex exception.
 // If user requests a non existing logger, nullptr will be returned
-// This class is thread safe
+// This class is thread safe. get() doesn't lock: it reads an immutable snapshot of the loggers (see rcu_ptr.h),
+// rebuilt by the first get() after registrations.
 
 #include <spdlog/common.h>
+#include <spdlog/details/rcu_ptr.h>
 
+#include <atomic>
 #include <chrono>
 #include <functional>
+#include <future>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <mutex>
+#include <utility>
+#include <vector>
 
 namespace spdlog {
 class logger;
@@ -23,27 +29,66 @@ class logger;
 namespace details {
 class thread_pool;
 class periodic_worker;
+struct flush_batch;
+
+// The default logger, pinned while this object lives: set_default_logger() waits for the pinned loggers
+// before releasing the previous one. Returned by registry::pin_default(), to be used as a temporary:
+//    registry::instance().pin_default()->info("..");
+class pinned_logger
+{
+public:
+    explicit pinned_logger(const rcu_ptr<std::shared_ptr<logger>> &default_logger)
+        : guard_(default_logger)
+    {}
+
+    logger *get() const
+    {
+        return guard_->get();
+    }
+
+    logger *operator->() const
+    {
+        return guard_->get();
+    }
+
+    logger &operator*() const
+    {
+        return **guard_;
+    }
+
+private:
+    rcu_ptr<std::shared_ptr<logger>>::read_guard guard_;
+};
 
 class SPDLOG_API registry
 {
 public:
     using log_levels = std::unordered_map<std::string, level::level_enum>;
+    using sample_rates = std::unordered_map<std::string, uint32_t>;
     registry(const registry &) = delete;
     registry &operator=(const registry &) = delete;
 
     void register_logger(std::shared_ptr<logger> new_logger);
     void initialize_logger(std::shared_ptr<logger> new_logger);
-    std::shared_ptr<logger> get(const std::string &logger_name);
+    // like register_logger() / initialize_logger() for each logger, taking the lock and publishing
+    // the loggers to get() once. throws before registering any of them if a name is already taken.
+    void register_loggers(std::vector<std::shared_ptr<logger>> new_loggers);
+    void initialize_loggers(std::vector<std::shared_ptr<logger>> new_loggers);
+    // lock free, and without building a std::string
+    std::shared_ptr<logger> get(string_view_t logger_name);
     std::shared_ptr<logger> default_logger();
 
     // Return raw ptr to the default logger.
-    // To be used directly by the spdlog default api (e.g. spdlog::info)
-    // This make the default API faster, but cannot be used concurrently with set_default_logger().
-    // e.g do not call set_default_logger() from one thread while calling spdlog::info() from another.
+    // It cannot be used concurrently with set_default_logger(), which may destroy it: use pin_default() then.
     logger *get_default_raw();
 
+    // Return the default logger pinned: lock free, and safe while set_default_logger() runs concurrently.
+    // To be used directly by the spdlog default api (e.g. spdlog::info)
+    pinned_logger pin_default();
+
     // set default logger.
     // default logger is stored in default_logger_ (for faster retrieval) and in the loggers_ map.
+    // Wait for the pinned previous default logger (see pin_default()) - don't call it while logging with it.
     void set_default_logger(std::shared_ptr<logger> new_default_logger);
 
     void set_tp(std::shared_ptr<thread_pool> tp);
@@ -59,30 +104,49 @@ public:
 
     void set_level(level::level_enum log_level);
 
+    // set the level of the logger and of its descendants, existing and future: the loggers whose
+    // name starts with logger_name + '.' ("net" -> "net.http", "net.http.client"..), unless they
+    // or a closer ancestor have a level of their own. only the loggers of the subtree are visited.
+    void set_level(const std::string &logger_name, level::level_enum log_level);
+
     void flush_on(level::level_enum log_level);
 
-    void flush_every(std::chrono::seconds interval);
+    void flush_every(std::chrono::nanoseconds interval);
 
     void set_error_handler(err_handler handler);
 
     void apply_all(const std::function<void(const std::shared_ptr<logger>)> &fun);
 
+    // flush the loggers out of the registry lock, each distinct sink once: the sinks of the plain loggers
+    // with up to flush_threads threads (see set_flush_threads()), the ones of the async loggers of a thread
+    // pool by a single message to it (see thread_pool::post_flush_batch()).
     void flush_all();
 
+    // threads flushing the sinks of the plain loggers in parallel in flush_all() (default: 1, the caller)
+    void set_flush_threads(size_t threads);
+
     void drop(const std::string &logger_name);
 
     void drop_all();
 
-    // clean all resources and threads started by the registry
-    void shutdown();
+    // clean all resources and threads started by the registry, after flushing the loggers (see flush_all()).
+    // the thread pools of the async loggers drop their messages not written by drain_timeout (the sink being
+    // written or flushed then is not interrupted).
+    void shutdown(std::chrono::nanoseconds drain_timeout = std::chrono::nanoseconds::max());
 
     std::recursive_mutex &tp_mutex();
 
     void set_automatic_registration(bool automatic_registration);
 
     // set levels for all existing/future loggers. global_level can be null if should not set.
+    // the loggers without a level of their own inherit the level of their closest ancestor
+    // (see set_level(logger_name, log_level)), if any.
     void set_levels(log_levels levels, level::level_enum *global_level);
 
+    // set sample rates (see logger::set_sample_rate) for all existing/future loggers. global_rate can be null if should not set.
+    // inherited like the levels.
+    void set_sample_rates(sample_rates rates, uint32_t *global_rate);
+
     static registry &instance();
 
 private:
@@ -91,11 +155,34 @@ private:
 
     void throw_if_exists_(const std::string &logger_name);
     void register_logger_(std::shared_ptr<logger> new_logger);
+    void register_loggers_(std::vector<std::shared_ptr<logger>> new_loggers);
+    // apply the global settings to the logger. called with logger_map_mutex_ locked.
+    void initialize_logger_(logger &new_logger);
+    // mark the snapshot of loggers_ stale after a change. called with logger_map_mutex_ locked.
+    void invalidate_snapshot_();
+    // publish a snapshot of loggers_ for get(), if stale. called with logger_map_mutex_ locked.
+    void publish_snapshot_();
+    // publish the snapshot without a dropped logger. called with logger_map_mutex_ locked.
+    void erase_from_snapshot_(const std::string &logger_name);
+    // set default_logger_ and publish it for pin_default(). called with logger_map_mutex_ locked.
+    void update_default_(std::shared_ptr<logger> new_default_logger);
     bool set_level_from_cfg_(logger *logger);
+    // flush the loggers (kept in loggers), returning the future of each batch
+    std::vector<std::future<void>> post_flush_all_(std::vector<std::shared_ptr<logger>> &loggers, std::vector<flush_batch> &batches);
+    // the value of the logger name or of its closest ancestor ("a.b" then "a" for "a.b.c"), or null
+    template<typename Map>
+    static const typename Map::mapped_type *find_inherited_(const Map &values, const std::string &logger_name);
     std::mutex logger_map_mutex_, flusher_mutex_;
     std::recursive_mutex tp_mutex_;
     std::unordered_map<std::string, std::shared_ptr<logger>> loggers_;
+    // loggers_ sorted by name
+    using loggers_snapshot = std::vector<std::pair<std::string, std::shared_ptr<logger>>>;
+    rcu_ptr<loggers_snapshot> loggers_snapshot_;
+    // set when loggers_ changed since loggers_snapshot_ was published
+    std::atomic<bool> snapshot_stale_{false};
     log_levels log_levels_;
+    sample_rates sample_rates_;
+    uint32_t global_sample_rate_ = 1;
     std::unique_ptr<formatter> formatter_;
     spdlog::level::level_enum global_log_level_ = level::info;
     level::level_enum flush_level_ = level::off;
@@ -104,8 +191,10 @@ private:
     std::shared_ptr<thread_pool> tp_;
     std::unique_ptr<periodic_worker> periodic_flusher_;
     std::shared_ptr<logger> default_logger_;
+    rcu_ptr<std::shared_ptr<logger>> pinned_default_;
     bool automatic_registration_ = true;
     size_t backtrace_n_messages_ = 0;
+    size_t flush_threads_ = 1;
 };
 
 } // namespace details
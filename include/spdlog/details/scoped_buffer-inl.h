@@ -0,0 +1,51 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/details/scoped_buffer.h>
+#endif
+
+namespace spdlog {
+namespace details {
+
+#if defined(SPDLOG_REUSE_BUFFERS) && !defined(SPDLOG_NO_TLS)
+struct thread_buffers
+{
+    memory_buf_t buffers[SPDLOG_REUSE_BUFFERS_PER_THREAD];
+    size_t in_use{0};
+};
+
+SPDLOG_INLINE thread_buffers &this_thread_buffers()
+{
+    static thread_local thread_buffers buffers;
+    return buffers;
+}
+
+SPDLOG_INLINE scoped_buffer::scoped_buffer()
+    : buf_(&local_)
+{
+    auto &tb = this_thread_buffers();
+    if (tb.in_use < SPDLOG_REUSE_BUFFERS_PER_THREAD)
+    {
+        buf_ = &tb.buffers[tb.in_use++];
+    }
+}
+
+SPDLOG_INLINE scoped_buffer::~scoped_buffer()
+{
+    if (buf_ != &local_)
+    {
+        buf_->clear();
+        if (buf_->capacity() > SPDLOG_REUSE_BUFFERS_MAX_SIZE)
+        {
+            *buf_ = memory_buf_t();
+        }
+        this_thread_buffers().in_use--;
+    }
+}
+#endif
+
+} // namespace details
+} // namespace spdlog
@@ -0,0 +1,58 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Formatting buffer used by the loggers and sinks for each message.
+//
+// With SPDLOG_REUSE_BUFFERS defined (see tweakme.h) it borrows one of a few thread local
+// buffers that keep their capacity between messages, so long messages don't allocate on
+// every call. Buffers that grew beyond SPDLOG_REUSE_BUFFERS_MAX_SIZE are released when returned.
+// Otherwise (and for nested use beyond the thread's buffers, e.g. logging while formatting)
+// it is a plain memory_buf_t on the stack.
+
+#include <spdlog/common.h>
+
+#ifndef SPDLOG_REUSE_BUFFERS_MAX_SIZE
+#    define SPDLOG_REUSE_BUFFERS_MAX_SIZE (64 * 1024)
+#endif
+
+// buffers per thread (the logger's and the sink's, plus nested logging)
+#ifndef SPDLOG_REUSE_BUFFERS_PER_THREAD
+#    define SPDLOG_REUSE_BUFFERS_PER_THREAD 4
+#endif
+
+namespace spdlog {
+namespace details {
+
+class SPDLOG_API scoped_buffer
+{
+public:
+#if defined(SPDLOG_REUSE_BUFFERS) && !defined(SPDLOG_NO_TLS)
+    scoped_buffer();
+    ~scoped_buffer();
+#else
+    scoped_buffer()
+        : buf_(&local_)
+    {}
+#endif
+
+    scoped_buffer(const scoped_buffer &) = delete;
+    scoped_buffer &operator=(const scoped_buffer &) = delete;
+
+    memory_buf_t &get() SPDLOG_NOEXCEPT
+    {
+        return *buf_;
+    }
+
+private:
+    memory_buf_t local_;
+    memory_buf_t *buf_;
+};
+
+} // namespace details
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "scoped_buffer-inl.h"
+#endif
@@ -0,0 +1,288 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/details/shm_ring.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace spdlog {
+namespace details {
+
+namespace shm_ring_layout {
+static const char magic[8] = {'S', 'P', 'D', 'L', 'O', 'G', 'R', 'B'};
+static const size_t header_size = 128; // the records start on a cache line
+} // namespace shm_ring_layout
+
+SPDLOG_INLINE shm_ring::~shm_ring()
+{
+    close();
+}
+
+SPDLOG_INLINE void shm_ring::open(const std::string &name, size_t capacity)
+{
+    close();
+    name_ = name;
+    uint64_t rounded = 4 * alignment;
+    while (rounded < capacity)
+    {
+        rounded <<= 1;
+    }
+
+    fd_ = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ == -1)
+    {
+        throw_error_("Failed opening shared memory ", errno);
+    }
+    struct stat st;
+    if (::fstat(fd_, &st) != 0)
+    {
+        throw_error_("Failed getting the size of shared memory ", errno);
+    }
+    if (static_cast<size_t>(st.st_size) <= shm_ring_layout::header_size)
+    {
+        // new segment
+        if (::ftruncate(fd_, static_cast<off_t>(shm_ring_layout::header_size + rounded)) != 0)
+        {
+            throw_error_("Failed resizing shared memory ", errno);
+        }
+        map_segment_(true);
+        header_->capacity = rounded;
+        header_->reserved.store(0);
+        // published last: the other processes check it
+        std::memcpy(header_->magic, shm_ring_layout::magic, sizeof(header_->magic));
+    }
+    else
+    {
+        map_segment_(true);
+    }
+    check_header_();
+}
+
+SPDLOG_INLINE void shm_ring::open_read_only(const std::string &name)
+{
+    close();
+    name_ = name;
+    fd_ = ::shm_open(name.c_str(), O_RDONLY | O_CLOEXEC, 0);
+    if (fd_ == -1)
+    {
+        throw_error_("Failed opening shared memory ", errno);
+    }
+    map_segment_(false);
+    check_header_();
+}
+
+SPDLOG_INLINE void shm_ring::close()
+{
+    if (map_ != nullptr)
+    {
+        ::munmap(map_, map_size_);
+        map_ = nullptr;
+        header_ = nullptr;
+        records_ = nullptr;
+        capacity_ = 0;
+    }
+    if (fd_ != -1)
+    {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+SPDLOG_INLINE void shm_ring::remove(const std::string &name)
+{
+    ::shm_unlink(name.c_str());
+}
+
+SPDLOG_INLINE void shm_ring::write(string_view_t data) SPDLOG_NOEXCEPT
+{
+    if (header_ == nullptr)
+    {
+        return;
+    }
+    auto size = (std::min)(static_cast<uint64_t>(data.size()), capacity_ / 4 - alignment);
+    auto record_size = alignment + (size + alignment - 1) / alignment * alignment;
+    for (;;)
+    {
+        auto pos = header_->reserved.fetch_add(record_size);
+        auto offset = pos & (capacity_ - 1);
+        if (offset + record_size <= capacity_)
+        {
+            auto *record = record_at_(pos);
+            record->size = static_cast<uint32_t>(size);
+            record->flags = 0;
+            std::memcpy(reinterpret_cast<char *>(record + 1), data.data(), static_cast<size_t>(size));
+            record->tag.store(pos + 1, std::memory_order_release);
+            return;
+        }
+        // would wrap: pad the end of the ring and what was reserved after it, then reserve again
+        auto first_part = capacity_ - offset;
+        write_padding_(pos, first_part);
+        write_padding_(pos + first_part, record_size - first_part);
+    }
+}
+
+SPDLOG_INLINE bool shm_ring::read(uint64_t &pos, memory_buf_t &dest) const
+{
+    if (header_ == nullptr)
+    {
+        return false;
+    }
+    for (;;)
+    {
+        auto reserved = header_->reserved.load(std::memory_order_acquire);
+        if (pos + capacity_ < reserved)
+        {
+            pos = next_record(reserved - capacity_); // lapped
+        }
+        if (pos >= reserved)
+        {
+            return false;
+        }
+        auto *record = record_at_(pos);
+        if (record->tag.load(std::memory_order_acquire) != pos + 1)
+        {
+            return false;
+        }
+        uint64_t size = record->size;
+        auto flags = record->flags;
+        auto record_size = alignment + (size + alignment - 1) / alignment * alignment;
+        if ((pos & (capacity_ - 1)) + record_size > capacity_)
+        {
+            pos = next_record(pos + alignment); // garbage (overwritten while reading the header)
+            continue;
+        }
+        auto old_size = dest.size();
+        if ((flags & padding_flag) == 0)
+        {
+            auto *payload = reinterpret_cast<const char *>(record + 1);
+            dest.append(payload, payload + size);
+        }
+        // the writers reserve before writing: if nothing was reserved over the record meanwhile, it is intact
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (pos + capacity_ < header_->reserved.load(std::memory_order_relaxed))
+        {
+            dest.resize(old_size);
+            continue;
+        }
+        pos += record_size;
+        if ((flags & padding_flag) == 0)
+        {
+            return true;
+        }
+    }
+}
+
+SPDLOG_INLINE uint64_t shm_ring::next_record(uint64_t pos) const
+{
+    if (header_ == nullptr)
+    {
+        return 0;
+    }
+    pos = (pos + alignment - 1) / alignment * alignment;
+    auto reserved = header_->reserved.load(std::memory_order_acquire);
+    if (pos + capacity_ < reserved)
+    {
+        pos = reserved - capacity_;
+    }
+    for (; pos < reserved; pos += alignment)
+    {
+        if (record_at_(pos)->tag.load(std::memory_order_acquire) == pos + 1)
+        {
+            return pos;
+        }
+    }
+    return reserved;
+}
+
+SPDLOG_INLINE uint64_t shm_ring::oldest_position() const
+{
+    auto reserved = write_position();
+    return next_record(reserved > capacity_ ? reserved - capacity_ : 0);
+}
+
+SPDLOG_INLINE uint64_t shm_ring::write_position() const
+{
+    return header_ == nullptr ? 0 : header_->reserved.load(std::memory_order_acquire);
+}
+
+SPDLOG_INLINE size_t shm_ring::capacity() const
+{
+    return static_cast<size_t>(capacity_);
+}
+
+SPDLOG_INLINE const std::string &shm_ring::name() const
+{
+    return name_;
+}
+
+SPDLOG_INLINE void shm_ring::map_segment_(bool writable)
+{
+    struct stat st;
+    if (::fstat(fd_, &st) != 0)
+    {
+        throw_error_("Failed getting the size of shared memory ", errno);
+    }
+    map_size_ = static_cast<size_t>(st.st_size);
+    if (map_size_ <= shm_ring_layout::header_size)
+    {
+        throw_error_("Not a log ring: ", 0);
+    }
+    auto prot = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+    auto *map = ::mmap(nullptr, map_size_, prot, MAP_SHARED, fd_, 0);
+    if (map == MAP_FAILED)
+    {
+        throw_error_("Failed mapping shared memory ", errno);
+    }
+    map_ = static_cast<char *>(map);
+    header_ = reinterpret_cast<segment_header *>(map_);
+}
+
+// the segment was initialized by open()
+SPDLOG_INLINE void shm_ring::check_header_()
+{
+    auto capacity = header_->capacity;
+    if (std::memcmp(header_->magic, shm_ring_layout::magic, sizeof(header_->magic)) != 0 || capacity < 4 * alignment ||
+        (capacity & (capacity - 1)) != 0 || capacity > map_size_ - shm_ring_layout::header_size)
+    {
+        throw_error_("Not a log ring: ", 0);
+    }
+    capacity_ = capacity;
+    records_ = map_ + shm_ring_layout::header_size;
+}
+
+SPDLOG_INLINE shm_ring::record_header *shm_ring::record_at_(uint64_t pos) const
+{
+    return reinterpret_cast<record_header *>(records_ + (pos & (capacity_ - 1)));
+}
+
+SPDLOG_INLINE void shm_ring::write_padding_(uint64_t pos, uint64_t size) SPDLOG_NOEXCEPT
+{
+    auto *record = record_at_(pos);
+    record->size = static_cast<uint32_t>(size - alignment);
+    record->flags = padding_flag;
+    record->tag.store(pos + 1, std::memory_order_release);
+}
+
+SPDLOG_INLINE void shm_ring::throw_error_(const std::string &what, int last_errno)
+{
+    close();
+    if (last_errno != 0)
+    {
+        throw_spdlog_ex(what + name_, last_errno);
+    }
+    throw_spdlog_ex(what + name_);
+}
+
+} // namespace details
+} // namespace spdlog
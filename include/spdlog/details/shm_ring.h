@@ -0,0 +1,103 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Ring of variable length records in a named shared memory segment (posix shm_open).
+//
+// Any number of writers, in any number of processes, reserve their records with a single atomic
+// fetch_add on the write position stored in the segment, copy them, and publish them by storing
+// the record position in its header (release) - no lock and no system call on the write path.
+// The segment outlives the processes: a reader (see tools/spdlog-shm-tail.cpp) can tail it live,
+// or read the last records after the writers crashed.
+//
+// Layout: a header (magic, capacity, write position) then capacity bytes of records, each one a
+// 16 bytes header (tag = position + 1 once committed, size, flags) and its payload padded to 16 bytes.
+// A record never wraps: the space left at the end of the ring goes to padding records.
+// The writers overwrite the oldest records: a reader that was lapped skips to the oldest one left.
+//
+// Throw spdlog_ex exception on errors (open only).
+
+#include <spdlog/common.h>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace spdlog {
+namespace details {
+
+class SPDLOG_API shm_ring
+{
+public:
+    shm_ring() = default;
+    shm_ring(const shm_ring &) = delete;
+    shm_ring &operator=(const shm_ring &) = delete;
+    ~shm_ring();
+
+    // open the segment for writing, creating it if needed (capacity rounded up to a power of two).
+    // an existing segment keeps its capacity.
+    void open(const std::string &name, size_t capacity);
+    // open an existing segment for reading
+    void open_read_only(const std::string &name);
+    void close();
+    // remove the segment name. the processes that opened it keep using it.
+    static void remove(const std::string &name);
+
+    // append a record. longer records than capacity / 4 are truncated.
+    void write(string_view_t data) SPDLOG_NOEXCEPT;
+
+    // read the record at pos (a position returned by a previous read, or oldest_position()) into dest,
+    // and move pos after it. return false if it isn't committed yet (pos == write_position() at the end,
+    // else a writer is writing it - or it crashed doing so: next_record() skips it).
+    // if pos was overwritten meanwhile, start from the oldest record left.
+    bool read(uint64_t &pos, memory_buf_t &dest) const;
+
+    // the first committed record at or after pos (write_position() if none)
+    uint64_t next_record(uint64_t pos) const;
+    // the oldest record left
+    uint64_t oldest_position() const;
+    uint64_t write_position() const;
+    size_t capacity() const;
+    const std::string &name() const;
+
+private:
+    struct segment_header
+    {
+        char magic[8];
+        uint64_t capacity;
+        char padding[48];
+        std::atomic<uint64_t> reserved; // the end of the reserved records (in its own cache line)
+    };
+
+    struct record_header
+    {
+        std::atomic<uint64_t> tag; // position + 1 once committed
+        uint32_t size;             // of the payload
+        uint32_t flags;
+    };
+
+    static const uint32_t padding_flag = 1;
+    static const size_t alignment = sizeof(record_header);
+
+    std::string name_;
+    int fd_{-1};
+    char *map_{nullptr};
+    size_t map_size_{0};
+    segment_header *header_{nullptr};
+    char *records_{nullptr};
+    uint64_t capacity_{0};
+
+    void map_segment_(bool writable);
+    void check_header_();
+    record_header *record_at_(uint64_t pos) const;
+    void write_padding_(uint64_t pos, uint64_t size) SPDLOG_NOEXCEPT;
+    [[noreturn]] void throw_error_(const std::string &what, int last_errno);
+};
+
+} // namespace details
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "shm_ring-inl.h"
+#endif
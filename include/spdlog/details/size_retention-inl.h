@@ -0,0 +1,97 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/details/size_retention.h>
+#endif
+
+#include <spdlog/details/os.h>
+#include <spdlog/details/file_helper.h>
+
+#include <algorithm>
+#include <cerrno>
+
+namespace spdlog {
+namespace details {
+
+SPDLOG_INLINE size_retention::size_retention(size_t max_total_size)
+    : max_total_size_(max_total_size)
+{}
+
+SPDLOG_INLINE void size_retention::add_oldest(size_t size, filename_t filename)
+{
+    files_.emplace_back(std::move(filename), size);
+    total_size_ += size;
+}
+
+SPDLOG_INLINE void size_retention::add_newest(size_t size, filename_t filename)
+{
+    files_.emplace_front(std::move(filename), size);
+    total_size_ += size;
+}
+
+SPDLOG_INLINE void size_retention::remove(const filename_t &filename)
+{
+    auto it = std::find_if(files_.begin(), files_.end(), [&](const std::pair<filename_t, size_t> &file) { return file.first == filename; });
+    if (it != files_.end())
+    {
+        total_size_ -= it->second;
+        files_.erase(it);
+    }
+}
+
+SPDLOG_INLINE void size_retention::keep_newest(size_t count)
+{
+    while (files_.size() > count)
+    {
+        total_size_ -= files_.back().second;
+        files_.pop_back();
+    }
+}
+
+SPDLOG_INLINE size_t size_retention::take_excess(std::vector<filename_t> &excess)
+{
+    size_t first = excess.size();
+    while (files_.size() > 1 && total_size_ > max_total_size_)
+    {
+        total_size_ -= files_.back().second;
+        excess.push_back(std::move(files_.back().first));
+        files_.pop_back();
+    }
+    std::reverse(excess.begin() + static_cast<std::ptrdiff_t>(first), excess.end());
+    return files_.size();
+}
+
+SPDLOG_INLINE void size_retention::remove_excess()
+{
+    std::vector<filename_t> excess;
+    take_excess(excess);
+    for (auto &filename : excess)
+    {
+        file_helper::remove_sidecars(filename);
+        if (os::remove_if_exists(filename) != 0)
+        {
+            throw_spdlog_ex("Failed removing file " + os::filename_to_str(filename), errno);
+        }
+    }
+}
+
+SPDLOG_INLINE size_t size_retention::max_total_size() const
+{
+    return max_total_size_;
+}
+
+SPDLOG_INLINE size_t size_retention::total_size() const
+{
+    return total_size_;
+}
+
+SPDLOG_INLINE size_t size_retention::count() const
+{
+    return files_.size();
+}
+
+} // namespace details
+} // namespace spdlog
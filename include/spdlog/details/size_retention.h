@@ -0,0 +1,55 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Retention of the rotated log files by their total size: the newest files are kept up to max_total_size
+// bytes, the older ones deleted. The sizes are tracked as the files are rotated - the existing files are
+// scanned once, at start - so no file is stat'ed to find the ones to delete.
+//
+// Not thread safe - used by one thread at a time (under the sink lock, or by its background worker).
+
+#include <spdlog/common.h>
+
+#include <deque>
+#include <utility>
+#include <vector>
+
+namespace spdlog {
+namespace details {
+
+class SPDLOG_API size_retention
+{
+public:
+    explicit size_retention(size_t max_total_size);
+
+    // track a file: add_oldest() while scanning the existing files from the newest, add_newest() when rotated
+    void add_oldest(size_t size, filename_t filename = filename_t());
+    void add_newest(size_t size, filename_t filename = filename_t());
+    // stop tracking a file deleted otherwise (e.g. by a max number of files)
+    void remove(const filename_t &filename);
+    // stop tracking the files after the count newest (overwritten)
+    void keep_newest(size_t count);
+
+    // stop tracking the oldest files over the budget - the newest file is always kept - and append their
+    // names to excess, oldest first. return the number of files kept.
+    size_t take_excess(std::vector<filename_t> &excess);
+    // same, deleting them (and their time index). throw spdlog_ex if one couldn't be deleted.
+    void remove_excess();
+
+    size_t max_total_size() const;
+    size_t total_size() const;
+    size_t count() const;
+
+private:
+    size_t max_total_size_;
+    size_t total_size_{0};
+    std::deque<std::pair<filename_t, size_t>> files_; // newest first
+};
+
+} // namespace details
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "size_retention-inl.h"
+#endif
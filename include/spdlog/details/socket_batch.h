@@ -0,0 +1,98 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Datagrams for a local daemon (syslog, journald), one per message, sent batch_size at a time
+// over a unix datagram socket (see unix_socket_client.h). The owner sends the partial batches in time
+// (see send_overdue()), e.g. from a periodic_worker: the calls are serialized by the batch itself, whatever
+// the mutex of the owning sink. The sends don't block (MSG_DONTWAIT), so they can run on the shared timer thread.
+// Fire and forget: if the daemon isn't there the datagrams are dropped (and counted), and the socket
+// connects again on the next batch.
+
+#include <spdlog/common.h>
+#include <spdlog/details/datagram_batch.h>
+#include <spdlog/details/unix_socket_client.h>
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <string>
+
+namespace spdlog {
+namespace details {
+
+class socket_batch
+{
+public:
+    socket_batch(const std::string &socket_path, size_t batch_size, size_t max_datagram_size)
+        : client_(socket_path, SOCK_DGRAM)
+        , batch_(max_datagram_size)
+        , batch_size_((std::max)(batch_size, size_t(1)))
+    {
+        client_.connect();
+    }
+
+    // buffer a datagram, and send the batch once full
+    void add(const char *data, size_t size)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (batch_.empty())
+        {
+            first_added_ = std::chrono::steady_clock::now();
+        }
+        batch_.append_datagram(data, size);
+        if (batch_.size() >= batch_size_)
+        {
+            send_();
+        }
+    }
+
+    // send the batch if its first datagram was added more than delay ago
+    void send_overdue(std::chrono::milliseconds delay)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!batch_.empty() && std::chrono::steady_clock::now() - first_added_ >= delay)
+        {
+            send_();
+        }
+    }
+
+    void send()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        send_();
+    }
+
+    size_t dropped() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return dropped_;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    unix_socket_client client_;
+    datagram_batch batch_;
+    size_t batch_size_;
+    size_t dropped_ = 0;
+    std::chrono::steady_clock::time_point first_added_;
+
+    void send_()
+    {
+        if (batch_.empty())
+        {
+            return;
+        }
+        size_t sent = 0;
+        if (client_.is_connected() || client_.connect())
+        {
+            sent = client_.send(batch_.data(), batch_.ends(), batch_.size());
+        }
+        dropped_ += batch_.size() - sent;
+        batch_.clear();
+    }
+};
+
+} // namespace details
+} // namespace spdlog
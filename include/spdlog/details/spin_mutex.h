@@ -0,0 +1,114 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Mutexes for the sinks with very short critical sections (e.g. an in memory ring, a buffered write), where
+// parking the threads contending for a std::mutex costs more than the critical section itself.
+// Both can be the Mutex of any sink (the *_spin aliases use spin_mutex).
+//
+// spin_mutex: test and test-and-set spin lock. The waiters spin on a plain load (the cache line stays
+// shared until released), with exponential backoff of pause instructions, and yield the cpu after a while -
+// so that a preempted owner gets to run. Never parks: for critical sections that never block.
+//
+// adaptive_mutex: spins on try_lock() of a std::mutex for up to spin_count tries, then parks on it - short
+// waits don't pay for a context switch, long ones don't burn the cpu.
+
+#include <spdlog/details/os.h>
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+namespace spdlog {
+namespace details {
+
+class spin_mutex
+{
+public:
+    spin_mutex() = default;
+    spin_mutex(const spin_mutex &) = delete;
+    spin_mutex &operator=(const spin_mutex &) = delete;
+
+    void lock() SPDLOG_NOEXCEPT
+    {
+        unsigned backoff = 1;
+        unsigned spins = 0;
+        while (locked_.exchange(true, std::memory_order_acquire))
+        {
+            while (locked_.load(std::memory_order_relaxed))
+            {
+                if (spins < max_spins)
+                {
+                    for (unsigned i = 0; i < backoff; i++)
+                    {
+                        os::cpu_relax();
+                    }
+                    spins += backoff;
+                    backoff = backoff < max_backoff ? backoff * 2 : backoff;
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    }
+
+    bool try_lock() SPDLOG_NOEXCEPT
+    {
+        return !locked_.load(std::memory_order_relaxed) && !locked_.exchange(true, std::memory_order_acquire);
+    }
+
+    void unlock() SPDLOG_NOEXCEPT
+    {
+        locked_.store(false, std::memory_order_release);
+    }
+
+private:
+    static const unsigned max_backoff = 64; // pause instructions between two loads
+    static const unsigned max_spins = 4096; // pause instructions before yielding
+
+    std::atomic<bool> locked_{false};
+};
+
+class adaptive_mutex
+{
+public:
+    explicit adaptive_mutex(unsigned spin_count = 100)
+        : spin_count_(spin_count)
+    {}
+
+    adaptive_mutex(const adaptive_mutex &) = delete;
+    adaptive_mutex &operator=(const adaptive_mutex &) = delete;
+
+    void lock()
+    {
+        for (unsigned i = 0; i < spin_count_; i++)
+        {
+            if (mutex_.try_lock())
+            {
+                return;
+            }
+            os::cpu_relax();
+        }
+        mutex_.lock();
+    }
+
+    bool try_lock()
+    {
+        return mutex_.try_lock();
+    }
+
+    void unlock()
+    {
+        mutex_.unlock();
+    }
+
+private:
+    std::mutex mutex_;
+    unsigned spin_count_;
+};
+
+} // namespace details
+} // namespace spdlog
@@ -0,0 +1,536 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// multi producer queue made of per producer thread single-producer/single-consumer lanes.
+// Each producer thread lazily gets its own lane (bounded ring) on its first enqueue, so
+// producers never write to a cache line shared with other producers.
+// Consumers drain all lanes, each time picking the lane whose front item is ordered first
+// according to Compare (e.g. by log time), so items from the same producer keep their exact
+// order and items from different producers are merged roughly in order.
+//
+// enqueue(..) - will block until room found in the thread's lane.
+// enqueue_for(..) - will block until room found in the thread's lane or timeout have passed.
+// enqueue_nowait(..) - will overrun the oldest message of the thread's lane if no room left (the oldest
+// overrunnable one, see async_queue_item).
+// try_enqueue(..) - will return immediately with false if no room left in the thread's lane.
+// dequeue_for(..) - will block until one of the lanes is not empty or timeout have passed.
+// dequeue_bulk_for(..) / try_dequeue_bulk(..) - move out up to max_items items at once
+// (the latter never waits).
+//
+// Each lane holds up to max_items (rounded up to the next power of 2) items.
+// The lane of an exited producer thread is retired, and freed by a consumer once drained (with
+// SPDLOG_NO_TLS the lanes are kept until the queue is destroyed). The consumers scan their own
+// list of the active lanes, updated when lanes are added or freed.
+
+#include <spdlog/common.h>
+#include <spdlog/details/async_queue.h>
+#include <spdlog/details/page_memory.h>
+#include <spdlog/details/os.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace spdlog {
+namespace details {
+
+template<typename T, typename Compare = std::less<T>>
+class spsc_lanes_queue : public async_queue<T>
+{
+public:
+    using item_type = T;
+    explicit spsc_lanes_queue(size_t max_items, Compare comp = Compare(), const page_options &pages = page_options())
+        : lane_capacity_(round_up_pow2_(max_items))
+        , pages_(pages)
+        , comp_(std::move(comp))
+        , id_(next_queue_id_())
+    {}
+
+    spsc_lanes_queue(const spsc_lanes_queue &) = delete;
+    spsc_lanes_queue &operator=(const spsc_lanes_queue &) = delete;
+
+    // try to enqueue and block if no room left in this thread's lane
+    void enqueue(T &&item) override
+    {
+        lane &l = my_lane_();
+        while (!l.try_push(std::move(item)))
+        {
+            std::unique_lock<std::mutex> lock(wait_mutex_);
+            producers_waiting_.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            pop_cv_.wait(lock, [&l] { return !l.full(); });
+            producers_waiting_.fetch_sub(1);
+        }
+        notify_consumers_();
+    }
+
+    // try to enqueue and block up to timeout if no room left in this thread's lane
+    bool enqueue_for(T &&item, std::chrono::nanoseconds timeout) override
+    {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        lane &l = my_lane_();
+        while (!l.try_push(std::move(item)))
+        {
+            std::unique_lock<std::mutex> lock(wait_mutex_);
+            producers_waiting_.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            bool ready = pop_cv_.wait_until(lock, deadline, [&l] { return !l.full(); });
+            producers_waiting_.fetch_sub(1);
+            if (!ready)
+            {
+                return false;
+            }
+        }
+        notify_consumers_();
+        return true;
+    }
+
+    // enqueue immediately. overrun oldest message in this thread's lane if no room left.
+    size_t enqueue_nowait(T &&item) override
+    {
+        lane &l = my_lane_();
+        size_t overrun = 0;
+        while (!l.try_push(std::move(item)))
+        {
+            // become the lane's consumer for a moment to discard its oldest overrunnable item
+            bool overran;
+            {
+                std::lock_guard<std::mutex> lock(consumer_mutex_);
+                overran = l.overrun_oldest();
+            }
+            if (!overran)
+            {
+                // empty by now, or nothing to overrun
+                enqueue(std::move(item));
+                return overrun;
+            }
+            overrun_counter_.fetch_add(1, std::memory_order_relaxed);
+            overrun++;
+        }
+        notify_consumers_();
+        return overrun;
+    }
+
+    // enqueue if there is room in this thread's lane. never blocks.
+    bool try_enqueue(T &&item) override
+    {
+        if (!my_lane_().try_push(std::move(item)))
+        {
+            return false;
+        }
+        notify_consumers_();
+        return true;
+    }
+
+    // try to dequeue the first ordered item among the lanes' fronts.
+    // if no item found. wait upto timeout and try again
+    // Return true, if succeeded dequeue item, false otherwise
+    bool dequeue_for(T &popped_item, std::chrono::milliseconds wait_duration) override
+    {
+        auto deadline = std::chrono::steady_clock::now() + wait_duration;
+        while (!try_dequeue(popped_item))
+        {
+            std::unique_lock<std::mutex> lock(wait_mutex_);
+            consumers_waiting_.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            bool ready = push_cv_.wait_until(lock, deadline, [this] { return this->any_ready_(); });
+            consumers_waiting_.fetch_sub(1);
+            if (!ready)
+            {
+                return false;
+            }
+        }
+        notify_producers_();
+        return true;
+    }
+
+    // try to dequeue up to max_items. waits only for the first item.
+    size_t dequeue_bulk_for(T *popped_items, size_t max_items, std::chrono::milliseconds wait_duration) override
+    {
+        if (max_items == 0 || !dequeue_for(popped_items[0], wait_duration))
+        {
+            return 0;
+        }
+        size_t n_items = 1;
+        while (n_items < max_items && try_dequeue(popped_items[n_items]))
+        {
+            n_items++;
+        }
+        notify_producers_();
+        return n_items;
+    }
+
+    // dequeue up to max_items if available. never waits.
+    size_t try_dequeue_bulk(T *popped_items, size_t max_items) override
+    {
+        size_t n_items = 0;
+        while (n_items < max_items && try_dequeue(popped_items[n_items]))
+        {
+            n_items++;
+        }
+        if (n_items > 0)
+        {
+            notify_producers_();
+        }
+        return n_items;
+    }
+
+    // dequeue if any lane is not empty. never blocks (except on other consumers).
+    bool try_dequeue(T &popped_item)
+    {
+        std::lock_guard<std::mutex> consumer_lock(consumer_mutex_);
+        if (lanes_changed_.load(std::memory_order_acquire))
+        {
+            update_active_lanes_();
+        }
+        lane *best = nullptr;
+        bool drained_retired = false;
+        for (auto *l : active_lanes_)
+        {
+            T *front = l->front();
+            if (front == nullptr)
+            {
+                drained_retired = drained_retired || l->retired();
+            }
+            else if (best == nullptr || comp_(*front, *best->front()))
+            {
+                best = l;
+            }
+        }
+        if (drained_retired)
+        {
+            free_drained_retired_();
+        }
+        if (best == nullptr)
+        {
+            return false;
+        }
+        popped_item = std::move(*best->front());
+        best->pop();
+        return true;
+    }
+
+    size_t overrun_counter() override
+    {
+        return overrun_counter_.load(std::memory_order_relaxed);
+    }
+
+    // approximate number of items in all lanes (exact if no concurrent operations)
+    size_t size() override
+    {
+        std::lock_guard<std::mutex> lock(lanes_mutex_);
+        size_t total = 0;
+        for (auto &l : lanes_)
+        {
+            total += l->size();
+        }
+        return total;
+    }
+
+    // the lane of the calling thread - the one its enqueues wait for
+    double load_factor() override
+    {
+        return static_cast<double>(my_lane_().size()) / static_cast<double>(lane_capacity_);
+    }
+
+    size_t lanes_count()
+    {
+        std::lock_guard<std::mutex> lock(lanes_mutex_);
+        return lanes_.size();
+    }
+
+private:
+    // single-producer/single-consumer bounded ring
+    class lane
+    {
+    public:
+        lane(size_t capacity, const page_options &pages)
+            : mask_(capacity - 1)
+            , slots_(capacity, pages)
+            , retired_flag_(std::make_shared<std::atomic<bool>>(false))
+        {}
+
+        // set by the producer thread on exit (see lane_owner)
+        const std::shared_ptr<std::atomic<bool>> &retired_flag() const
+        {
+            return retired_flag_;
+        }
+
+        // no more items will be pushed
+        bool retired() const
+        {
+            return retired_flag_->load(std::memory_order_acquire);
+        }
+
+        // producer side
+        bool try_push(T &&item)
+        {
+            auto tail = tail_.value.load(std::memory_order_relaxed);
+            if (tail - head_.value.load(std::memory_order_acquire) > mask_)
+            {
+                return false;
+            }
+            slots_[tail & mask_] = std::move(item);
+            tail_.value.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool full() const
+        {
+            return tail_.value.load(std::memory_order_acquire) - head_.value.load(std::memory_order_acquire) > mask_;
+        }
+
+        // consumer side - return nullptr if empty
+        T *front()
+        {
+            auto head = head_.value.load(std::memory_order_relaxed);
+            if (head == tail_.value.load(std::memory_order_acquire))
+            {
+                return nullptr;
+            }
+            return &slots_[head & mask_];
+        }
+
+        void pop()
+        {
+            head_.value.store(head_.value.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        // consumer side: drop the oldest overrunnable item (see async_queue_item), moving the items before it
+        // one place ahead. return false if there is none.
+        bool overrun_oldest()
+        {
+            auto head = head_.value.load(std::memory_order_relaxed);
+            auto tail = tail_.value.load(std::memory_order_acquire);
+            for (auto i = head; i != tail; i++)
+            {
+                if (async_queue_item<T>::overrunnable(slots_[i & mask_]))
+                {
+                    for (auto j = i; j != head; j--)
+                    {
+                        slots_[j & mask_] = std::move(slots_[(j - 1) & mask_]);
+                    }
+                    pop();
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool empty() const
+        {
+            return head_.value.load(std::memory_order_acquire) == tail_.value.load(std::memory_order_acquire);
+        }
+
+        size_t size() const
+        {
+            return tail_.value.load(std::memory_order_acquire) - head_.value.load(std::memory_order_acquire);
+        }
+
+    private:
+        struct padded_pos
+        {
+            std::atomic<size_t> value{0};
+            char padding[SPDLOG_CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)];
+        };
+
+        const size_t mask_;
+        page_array<T> slots_;
+        std::shared_ptr<std::atomic<bool>> retired_flag_;
+        char padding0_[SPDLOG_CACHE_LINE_SIZE];
+        padded_pos head_;
+        padded_pos tail_;
+    };
+
+    const size_t lane_capacity_;
+    const page_options pages_;
+    Compare comp_;
+    const size_t id_;
+    std::mutex lanes_mutex_;
+    std::vector<std::unique_ptr<lane>> lanes_;
+    std::unordered_map<size_t, lane *> lanes_by_thread_;
+    std::atomic<bool> lanes_changed_{false};
+    std::mutex consumer_mutex_;
+    std::vector<lane *> active_lanes_; // copy of lanes_ scanned by the consumers, under consumer_mutex_
+    std::atomic<size_t> overrun_counter_{0};
+    std::atomic<size_t> producers_waiting_{0};
+    std::atomic<size_t> consumers_waiting_{0};
+    std::mutex wait_mutex_;
+    std::condition_variable push_cv_;
+    std::condition_variable pop_cv_;
+
+    static size_t round_up_pow2_(size_t n)
+    {
+        size_t rv = 2;
+        while (rv < n)
+        {
+            rv <<= 1;
+        }
+        return rv;
+    }
+
+    // unique id per queue instance, so a thread's cached lane is never used for another queue
+    // allocated at the same address
+    static size_t next_queue_id_()
+    {
+        static std::atomic<size_t> counter{0};
+        return ++counter;
+    }
+
+    lane &my_lane_()
+    {
+#ifndef SPDLOG_NO_TLS
+        auto &cache = lane_cache_();
+        if (cache.queue_id == id_)
+        {
+            return *cache.cached_lane;
+        }
+#endif
+        std::lock_guard<std::mutex> lock(lanes_mutex_);
+        auto &l = lanes_by_thread_[os::thread_id()];
+        // retired: the lane of an exited thread with the same id not freed yet, or of this thread
+        // logging from a thread local destructor after its lane_owner
+        if (l == nullptr || l->retired())
+        {
+            lanes_.push_back(details::make_unique<lane>(lane_capacity_, pages_));
+            l = lanes_.back().get();
+            lanes_changed_.store(true, std::memory_order_release);
+#ifndef SPDLOG_NO_TLS
+            // past the lane_owner: kept until the queue is destroyed
+            if (!cache.owner_destroyed)
+            {
+                lane_owner_().add(l->retired_flag());
+            }
+#endif
+        }
+#ifndef SPDLOG_NO_TLS
+        cache.queue_id = id_;
+        cache.cached_lane = l;
+#endif
+        return *l;
+    }
+
+#ifndef SPDLOG_NO_TLS
+    // trivially destructible: still valid in the thread local destructors run after the lane_owner
+    struct lane_cache
+    {
+        size_t queue_id;
+        lane *cached_lane;
+        bool owner_destroyed;
+    };
+
+    static lane_cache &lane_cache_()
+    {
+        static thread_local lane_cache cache{0, nullptr, false};
+        return cache;
+    }
+
+    // the lanes of the calling thread, in any queue: retired when the thread exits
+    struct lane_owner
+    {
+        std::vector<std::shared_ptr<std::atomic<bool>>> retired_flags;
+
+        void add(const std::shared_ptr<std::atomic<bool>> &flag)
+        {
+            // forget the lanes freed since (with their queue)
+            retired_flags.erase(std::remove_if(retired_flags.begin(), retired_flags.end(),
+                                    [](const std::shared_ptr<std::atomic<bool>> &f) { return f.use_count() == 1; }),
+                retired_flags.end());
+            retired_flags.push_back(flag);
+        }
+
+        ~lane_owner()
+        {
+            // the retired lanes may be freed at once: not to be used from the cache anymore
+            lane_cache_() = lane_cache{0, nullptr, true};
+            for (auto &flag : retired_flags)
+            {
+                flag->store(true, std::memory_order_release);
+            }
+        }
+    };
+
+    static lane_owner &lane_owner_()
+    {
+        static thread_local lane_owner owner;
+        return owner;
+    }
+#endif
+
+    // copy the lanes to the consumers' list. called with consumer_mutex_ locked.
+    void update_active_lanes_()
+    {
+        std::lock_guard<std::mutex> lock(lanes_mutex_);
+        lanes_changed_.store(false, std::memory_order_relaxed);
+        active_lanes_.clear();
+        for (auto &l : lanes_)
+        {
+            active_lanes_.push_back(l.get());
+        }
+    }
+
+    // free the retired lanes found empty. called with consumer_mutex_ locked.
+    void free_drained_retired_()
+    {
+        {
+            std::lock_guard<std::mutex> lock(lanes_mutex_);
+            for (auto it = lanes_by_thread_.begin(); it != lanes_by_thread_.end();)
+            {
+                if (it->second->retired() && it->second->empty())
+                {
+                    it = lanes_by_thread_.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+            lanes_.erase(std::remove_if(lanes_.begin(), lanes_.end(),
+                             [](const std::unique_ptr<lane> &l) { return l->retired() && l->empty(); }),
+                lanes_.end());
+        }
+        update_active_lanes_();
+    }
+
+    bool any_ready_()
+    {
+        std::lock_guard<std::mutex> lock(lanes_mutex_);
+        for (auto &l : lanes_)
+        {
+            if (!l->empty())
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void notify_consumers_()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (consumers_waiting_.load(std::memory_order_relaxed) > 0)
+        {
+            std::lock_guard<std::mutex> lock(wait_mutex_);
+            push_cv_.notify_one();
+        }
+    }
+
+    void notify_producers_()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (producers_waiting_.load(std::memory_order_relaxed) > 0)
+        {
+            std::lock_guard<std::mutex> lock(wait_mutex_);
+            pop_cv_.notify_all();
+        }
+    }
+};
+} // namespace details
+} // namespace spdlog
@@ -0,0 +1,133 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Multi-pattern substring search of the filter sink (see sinks/filter_sink.h): whether a text contains
+// any of a set of patterns, in a single pass over the text.
+//
+// The text is scanned 8 positions at a time (SWAR, portable - no intrinsics): for each pattern, the 8 bytes
+// at the positions and the 8 bytes at the positions + pattern size - 1 are compared at once with its first
+// and last bytes. Only the positions where both match are compared with the whole pattern.
+
+#include <spdlog/common.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace spdlog {
+namespace details {
+
+class substring_matcher
+{
+public:
+    substring_matcher() = default;
+
+    explicit substring_matcher(const std::vector<std::string> &patterns)
+    {
+        for (const auto &text : patterns)
+        {
+            if (text.empty())
+            {
+                match_all_ = true; // contained in any text
+                continue;
+            }
+            pattern p;
+            p.text = text;
+            p.first = broadcast_(text.front());
+            p.last = broadcast_(text.back());
+            patterns_.push_back(std::move(p));
+            max_size_ = text.size() > max_size_ ? text.size() : max_size_;
+        }
+    }
+
+    bool empty() const
+    {
+        return patterns_.empty() && !match_all_;
+    }
+
+    // whether text contains any of the patterns
+    bool match(string_view_t text) const
+    {
+        if (match_all_)
+        {
+            return true;
+        }
+        const char *s = text.data();
+        auto size = text.size();
+        size_t pos = 0;
+        // blocks of 8 positions, all the patterns at once
+        for (; pos + 8 + max_size_ - 1 <= size; pos += 8)
+        {
+            auto first_bytes = load_(s + pos);
+            for (const auto &p : patterns_)
+            {
+                auto last_bytes = load_(s + pos + p.text.size() - 1);
+                if (zero_bytes_((first_bytes ^ p.first) | (last_bytes ^ p.last)) != 0 && match_block_(s + pos, p.text))
+                {
+                    return true;
+                }
+            }
+        }
+        // the last positions, one at a time
+        for (; pos < size; pos++)
+        {
+            for (const auto &p : patterns_)
+            {
+                if (pos + p.text.size() <= size && s[pos] == p.text.front() && std::memcmp(s + pos, p.text.data(), p.text.size()) == 0)
+                {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+private:
+    struct pattern
+    {
+        std::string text;
+        uint64_t first; // the first byte, in each byte
+        uint64_t last;  // the last byte, in each byte
+    };
+
+    std::vector<pattern> patterns_;
+    size_t max_size_ = 0;
+    bool match_all_ = false;
+
+    static uint64_t broadcast_(char c)
+    {
+        return static_cast<uint64_t>(static_cast<unsigned char>(c)) * 0x0101010101010101ULL;
+    }
+
+    static uint64_t load_(const char *p)
+    {
+        uint64_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    // non zero if a byte of v is zero (may flag the bytes after it too: the candidates are checked)
+    static uint64_t zero_bytes_(uint64_t v)
+    {
+        return (v - 0x0101010101010101ULL) & ~v & 0x8080808080808080ULL;
+    }
+
+    // the 8 positions from s - the byte order of the loads doesn't matter
+    static bool match_block_(const char *s, const std::string &text)
+    {
+        for (size_t i = 0; i < 8; i++)
+        {
+            if (s[i] == text.front() && s[i + text.size() - 1] == text.back() && std::memcmp(s + i, text.data(), text.size()) == 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+} // namespace details
+} // namespace spdlog
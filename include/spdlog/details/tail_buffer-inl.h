@@ -0,0 +1,80 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/details/tail_buffer.h>
+#endif
+
+#include <spdlog/logger.h>
+
+#include <cstring>
+#include <type_traits>
+
+namespace spdlog {
+namespace details {
+
+SPDLOG_INLINE tail_buffer::tail_buffer(size_t max_messages, level::level_enum max_level, level::level_enum trigger_level)
+    : messages_(max_messages)
+    , max_level_(max_level)
+    , trigger_level_(trigger_level)
+{}
+
+SPDLOG_INLINE void tail_buffer::push_back(logger *owner, const log_msg &msg)
+{
+    push_back(owner, msg, nullptr, string_view_t{});
+}
+
+SPDLOG_INLINE void tail_buffer::push_back(logger *owner, const log_msg &msg, deferred_format_fn format_fn, string_view_t format_args)
+{
+    // the logger outlives the scope: its name is not copied
+    messages_.push_back(entry{owner, log_msg_buffer{msg, format_args, true}, format_fn});
+}
+
+SPDLOG_INLINE void tail_buffer::flush()
+{
+    while (!messages_.empty())
+    {
+        auto &kept = messages_.front();
+        if (kept.format_fn == nullptr)
+        {
+            kept.owner->sink_it_(kept.msg);
+        }
+        else
+        {
+            // copy the args to properly aligned storage
+            std::aligned_storage<SPDLOG_DEFERRED_ARGS_SIZE, alignof(std::max_align_t)>::type args;
+            auto format_args = kept.msg.extra();
+            std::memcpy(&args, format_args.data(), format_args.size());
+            memory_buf_t buf;
+            kept.format_fn(buf, kept.msg.payload, &args);
+            log_msg formatted(kept.msg);
+            formatted.payload = string_view_t(buf.data(), buf.size());
+            formatted.payload_id = 0;
+            kept.owner->sink_it_(formatted);
+        }
+        messages_.pop_front();
+    }
+}
+
+SPDLOG_INLINE void tail_buffer::clear()
+{
+    while (!messages_.empty())
+    {
+        messages_.pop_front();
+    }
+}
+
+SPDLOG_INLINE size_t tail_buffer::size() const
+{
+    return messages_.size();
+}
+
+SPDLOG_INLINE size_t tail_buffer::overrun_counter() const
+{
+    return messages_.overrun_counter();
+}
+
+} // namespace details
+} // namespace spdlog
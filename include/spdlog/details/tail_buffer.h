@@ -0,0 +1,120 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// The messages kept by a tail sampling scope (see spdlog/tail_sampling.h): the last ones its thread logged
+// below the level of their loggers, up to the scope level, each with the logger that dropped it.
+// Messages with arithmetic args only are kept unformatted with their captured args (see deferred_format.h),
+// formatted if flushed. Used by its thread only - no locking.
+
+#include <spdlog/common.h>
+#include <spdlog/details/circular_q.h>
+#include <spdlog/details/deferred_format.h>
+#include <spdlog/details/log_msg_buffer.h>
+
+namespace spdlog {
+class logger;
+
+namespace details {
+
+class SPDLOG_API tail_buffer
+{
+public:
+    tail_buffer(size_t max_messages, level::level_enum max_level, level::level_enum trigger_level);
+    tail_buffer(const tail_buffer &) = delete;
+    tail_buffer &operator=(const tail_buffer &) = delete;
+
+    // the messages up to max_level dropped by their loggers are kept
+    bool keeps(level::level_enum lvl) const
+    {
+        return lvl <= max_level_;
+    }
+
+    // a message of the given level was logged: trigger_level and above trigger the scope
+    void on_logged(level::level_enum lvl)
+    {
+        if (lvl >= trigger_level_ && lvl != level::off)
+        {
+            triggered_ = true;
+        }
+    }
+
+    void trigger()
+    {
+        triggered_ = true;
+    }
+
+    bool triggered() const
+    {
+        return triggered_;
+    }
+
+    // keep msg, dropped by owner, evicting the oldest message if full
+    void push_back(logger *owner, const log_msg &msg);
+    // msg's payload is the format string of the captured args format_args, formatted with format_fn if flushed
+    void push_back(logger *owner, const log_msg &msg, deferred_format_fn format_fn, string_view_t format_args);
+
+    // pass the messages to the sinks of their loggers, oldest first, and remove them
+    void flush();
+    void clear();
+
+    size_t size() const;
+    // the messages evicted
+    size_t overrun_counter() const;
+
+    // the enclosing scope of the thread
+    tail_buffer *parent{nullptr};
+
+private:
+    struct entry
+    {
+        entry() = default;
+        entry(logger *the_owner, log_msg_buffer &&the_msg, deferred_format_fn the_format_fn)
+            : owner{the_owner}
+            , msg{std::move(the_msg)}
+            , format_fn{the_format_fn}
+        {}
+
+        logger *owner{nullptr};
+        log_msg_buffer msg;
+        deferred_format_fn format_fn{nullptr};
+    };
+
+    circular_q<entry> messages_;
+    level::level_enum max_level_;
+    level::level_enum trigger_level_;
+    bool triggered_{false};
+};
+
+// the buffer of the innermost tail sampling scope of the calling thread, nullptr if none (always with SPDLOG_NO_TLS)
+#ifndef SPDLOG_NO_TLS
+inline tail_buffer *&thread_tail_buffer_slot() SPDLOG_NOEXCEPT
+{
+    static thread_local tail_buffer *current = nullptr;
+    return current;
+}
+
+inline tail_buffer *thread_tail_buffer() SPDLOG_NOEXCEPT
+{
+    return thread_tail_buffer_slot();
+}
+#else
+inline tail_buffer *thread_tail_buffer() SPDLOG_NOEXCEPT
+{
+    return nullptr;
+}
+#endif
+
+// true if a message of the given level would be kept by a tail sampling scope of the calling thread
+// (logged by the call sites disabled by the logger's level)
+inline bool tail_keeps(level::level_enum lvl) SPDLOG_NOEXCEPT
+{
+    auto *tail = thread_tail_buffer();
+    return tail != nullptr && tail->keeps(lvl);
+}
+
+} // namespace details
+} // namespace spdlog
+
+// header only: tail_buffer-inl.h is included by logger.h, it needs the complete logger
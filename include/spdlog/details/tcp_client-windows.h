@@ -13,6 +13,7 @@
 #include <ws2tcpip.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <algorithm>
 #include <string>
 
 #pragma comment(lib, "Ws2_32.lib")
@@ -24,6 +25,13 @@ namespace details {
 class tcp_client
 {
     SOCKET socket_ = INVALID_SOCKET;
+    // the overlapped sends (see send_async()): their completion port, and the send in flight
+    HANDLE iocp_ = NULL;
+    bool iocp_associated_ = false;
+    WSAOVERLAPPED send_overlapped_{};
+    bool send_pending_ = false;
+    // the largest overlapped send: its pages are locked until it completes
+    static constexpr size_t max_async_send = 256 * 1024;
 
     static bool winsock_initialized_()
     {
@@ -68,6 +76,16 @@ public:
     {
         ::closesocket(socket_);
         socket_ = INVALID_SOCKET;
+        iocp_associated_ = false;
+        if (send_pending_)
+        {
+            // closing the socket cancels the send: wait for its completion, its buffer is the caller's
+            DWORD n_bytes = 0;
+            ULONG_PTR key = 0;
+            LPOVERLAPPED overlapped = nullptr;
+            ::GetQueuedCompletionStatus(iocp_, &n_bytes, &key, &overlapped, INFINITE);
+            send_pending_ = false;
+        }
         WSACleanup();
     }
 
@@ -79,6 +97,10 @@ public:
     ~tcp_client()
     {
         close();
+        if (iocp_ != NULL)
+        {
+            ::CloseHandle(iocp_);
+        }
     }
 
     // try to connect or throw on failure
@@ -170,6 +192,143 @@ public:
             bytes_sent += static_cast<size_t>(write_result);
         }
     }
+
+    // Send the parts, in order.
+    // On error close the connection and throw.
+    void send(const string_view_t *parts, size_t n_parts)
+    {
+        for (size_t i = 0; i < n_parts; i++)
+        {
+            send(parts[i].data(), parts[i].size());
+        }
+    }
+
+    // Send what can be sent of the given data, waiting up to timeout_ms for the socket to be writable.
+    // Return the number of bytes sent (0 on timeout). On error close the connection and throw.
+    size_t send_some(const char *data, size_t n_bytes, int timeout_ms)
+    {
+        fd_set write_fds;
+        FD_ZERO(&write_fds);
+        FD_SET(socket_, &write_fds);
+        timeval timeout{timeout_ms / 1000, (timeout_ms % 1000) * 1000};
+        auto ready = ::select(0, nullptr, &write_fds, nullptr, &timeout);
+        if (ready == SOCKET_ERROR)
+        {
+            int last_error = ::WSAGetLastError();
+            close();
+            throw_winsock_error_("select failed", last_error);
+        }
+        if (ready == 0)
+        {
+            return 0;
+        }
+        auto write_result = ::send(socket_, data, (int)n_bytes, 0);
+        if (write_result == SOCKET_ERROR)
+        {
+            int last_error = ::WSAGetLastError();
+            close();
+            throw_winsock_error_("send failed", last_error);
+        }
+        return static_cast<size_t>(write_result);
+    }
+
+    // Post an overlapped send of the data (up to max_async_send bytes) unless one is in flight, and wait up to
+    // timeout_ms for it to complete on the client's completion port. Return the number of bytes sent (0 on timeout).
+    // On timeout the send stays in flight: call again with the same data, which must stay valid until it completes
+    // or the connection is closed. On error close the connection and throw.
+    size_t send_async(const char *data, size_t n_bytes, int timeout_ms)
+    {
+        if (!send_pending_)
+        {
+            if (iocp_ == NULL)
+            {
+                iocp_ = ::CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, 1);
+                if (iocp_ == NULL)
+                {
+                    int last_error = static_cast<int>(::GetLastError());
+                    close();
+                    throw_winsock_error_("CreateIoCompletionPort failed", last_error);
+                }
+            }
+            if (!iocp_associated_)
+            {
+                if (::CreateIoCompletionPort(reinterpret_cast<HANDLE>(socket_), iocp_, 0, 0) == NULL)
+                {
+                    int last_error = static_cast<int>(::GetLastError());
+                    close();
+                    throw_winsock_error_("CreateIoCompletionPort failed", last_error);
+                }
+                iocp_associated_ = true;
+            }
+            WSABUF buf;
+            buf.buf = const_cast<char *>(data);
+            buf.len = static_cast<ULONG>((std::min)(n_bytes, static_cast<size_t>(max_async_send)));
+            ZeroMemory(&send_overlapped_, sizeof(send_overlapped_));
+            // completes on the port even if it succeeds at once
+            if (::WSASend(socket_, &buf, 1, nullptr, 0, &send_overlapped_, nullptr) == SOCKET_ERROR)
+            {
+                int last_error = ::WSAGetLastError();
+                if (last_error != WSA_IO_PENDING)
+                {
+                    close();
+                    throw_winsock_error_("WSASend failed", last_error);
+                }
+            }
+            send_pending_ = true;
+        }
+
+        DWORD n_sent = 0;
+        ULONG_PTR key = 0;
+        LPOVERLAPPED overlapped = nullptr;
+        if (!::GetQueuedCompletionStatus(iocp_, &n_sent, &key, &overlapped, static_cast<DWORD>(timeout_ms)))
+        {
+            int last_error = static_cast<int>(::GetLastError());
+            if (overlapped == nullptr && last_error == WAIT_TIMEOUT)
+            {
+                return 0;
+            }
+            send_pending_ = overlapped == nullptr;
+            close();
+            throw_winsock_error_("send failed", last_error);
+        }
+        send_pending_ = false;
+        return static_cast<size_t>(n_sent);
+    }
+
+    // Receive what is available, waiting up to timeout_ms for the socket to be readable.
+    // Return the number of bytes received (0 on timeout). On error or if the peer closed the connection,
+    // close it and throw.
+    size_t recv_some(char *data, size_t n_bytes, int timeout_ms)
+    {
+        fd_set read_fds;
+        FD_ZERO(&read_fds);
+        FD_SET(socket_, &read_fds);
+        timeval timeout{timeout_ms / 1000, (timeout_ms % 1000) * 1000};
+        auto ready = ::select(0, &read_fds, nullptr, nullptr, &timeout);
+        if (ready == SOCKET_ERROR)
+        {
+            int last_error = ::WSAGetLastError();
+            close();
+            throw_winsock_error_("select failed", last_error);
+        }
+        if (ready == 0)
+        {
+            return 0;
+        }
+        auto read_result = ::recv(socket_, data, (int)n_bytes, 0);
+        if (read_result == SOCKET_ERROR)
+        {
+            int last_error = ::WSAGetLastError();
+            close();
+            throw_winsock_error_("recv failed", last_error);
+        }
+        if (read_result == 0)
+        {
+            close();
+            throw_spdlog_ex("connection closed by the peer");
+        }
+        return static_cast<size_t>(read_result);
+    }
 };
 } // namespace details
 } // namespace spdlog
@@ -12,10 +12,12 @@
 #include <spdlog/details/os.h>
 
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <arpa/inet.h>
 #include <unistd.h>
 #include <netdb.h>
 #include <netinet/tcp.h>
+#include <poll.h>
 
 #include <string>
 
@@ -141,6 +143,125 @@ public:
             bytes_sent += static_cast<size_t>(write_result);
         }
     }
+
+    // Send the parts, in order, with as few sendmsg(2) calls as possible.
+    // On error close the connection and throw.
+    void send(const string_view_t *parts, size_t n_parts)
+    {
+        constexpr size_t max_iov = 16;
+        iovec iov[max_iov];
+        size_t part = 0;
+        size_t offset = 0; // sent of parts[part]
+        while (part < n_parts)
+        {
+            msghdr header{};
+            size_t n_iov = 0;
+            for (size_t i = part; i < n_parts && n_iov < max_iov; i++)
+            {
+                size_t skip = i == part ? offset : 0;
+                iov[n_iov].iov_base = const_cast<char *>(parts[i].data() + skip);
+                iov[n_iov].iov_len = parts[i].size() - skip;
+                n_iov++;
+            }
+            header.msg_iov = iov;
+            header.msg_iovlen = static_cast<decltype(header.msg_iovlen)>(n_iov);
+#if defined(MSG_NOSIGNAL)
+            const int send_flags = MSG_NOSIGNAL;
+#else
+            const int send_flags = 0;
+#endif
+            auto write_result = ::sendmsg(socket_, &header, send_flags);
+            if (write_result < 0)
+            {
+                close();
+                throw_spdlog_ex("sendmsg(2) failed", errno);
+            }
+            // skip the parts sent, resume in the part sent partially
+            auto left = static_cast<size_t>(write_result);
+            while (part < n_parts && left >= parts[part].size() - offset)
+            {
+                left -= parts[part].size() - offset;
+                offset = 0;
+                part++;
+            }
+            offset += left;
+        }
+    }
+
+    // Send what can be sent of the given data, waiting up to timeout_ms for the socket to be writable.
+    // Return the number of bytes sent (0 on timeout). On error close the connection and throw.
+    size_t send_some(const char *data, size_t n_bytes, int timeout_ms)
+    {
+        pollfd poll_fd{socket_, POLLOUT, 0};
+        auto ready = ::poll(&poll_fd, 1, timeout_ms);
+        if (ready < 0)
+        {
+            if (errno == EINTR)
+            {
+                return 0;
+            }
+            close();
+            throw_spdlog_ex("poll(2) failed", errno);
+        }
+        if (ready == 0)
+        {
+            return 0;
+        }
+#if defined(MSG_NOSIGNAL)
+        const int send_flags = MSG_NOSIGNAL | MSG_DONTWAIT;
+#else
+        const int send_flags = MSG_DONTWAIT;
+#endif
+        auto write_result = ::send(socket_, data, n_bytes, send_flags);
+        if (write_result < 0)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+            {
+                return 0;
+            }
+            close();
+            throw_spdlog_ex("write(2) failed", errno);
+        }
+        return static_cast<size_t>(write_result);
+    }
+
+    // Receive what is available, waiting up to timeout_ms for the socket to be readable.
+    // Return the number of bytes received (0 on timeout). On error or if the peer closed the connection,
+    // close it and throw.
+    size_t recv_some(char *data, size_t n_bytes, int timeout_ms)
+    {
+        pollfd poll_fd{socket_, POLLIN, 0};
+        auto ready = ::poll(&poll_fd, 1, timeout_ms);
+        if (ready < 0)
+        {
+            if (errno == EINTR)
+            {
+                return 0;
+            }
+            close();
+            throw_spdlog_ex("poll(2) failed", errno);
+        }
+        if (ready == 0)
+        {
+            return 0;
+        }
+        auto read_result = ::recv(socket_, data, n_bytes, MSG_DONTWAIT);
+        if (read_result < 0)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+            {
+                return 0;
+            }
+            close();
+            throw_spdlog_ex("read(2) failed", errno);
+        }
+        if (read_result == 0)
+        {
+            close();
+            throw_spdlog_ex("connection closed by the peer");
+        }
+        return static_cast<size_t>(read_result);
+    }
 };
 } // namespace details
 } // namespace spdlog
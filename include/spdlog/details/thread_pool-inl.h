@@ -8,30 +8,137 @@
 #endif
 
 #include <spdlog/common.h>
+#include <algorithm>
 #include <cassert>
+#include <exception>
+#include <iterator>
+
+#ifndef _WIN32
+#    include <pthread.h> // for pthread_atfork
+#endif
 
 namespace spdlog {
 namespace details {
 
-SPDLOG_INLINE thread_pool::thread_pool(size_t q_max_items, size_t threads_n, std::function<void()> on_thread_start)
-    : q_(q_max_items)
+SPDLOG_INLINE thread_pool::thread_pool(size_t q_max_items, size_t threads_n, const thread_pool_options &options)
+    : options_(options)
+    , threads_n_(threads_n)
+    , batch_size_(options.batch_size == 0 ? 1 : options.batch_size)
+    , wait_strategy_(options.wait_strategy)
+    , spin_count_(options.spin_count)
+    , yield_count_(options.yield_count)
+    , pin_loggers_(options.pin_loggers)
+    , collect_stats_(options.collect_stats)
+    , elastic_(options.max_threads > threads_n)
+    , max_threads_(elastic_ ? options.max_threads : threads_n)
+    , scale_up_depth_(options.scale_up_depth == 0 ? q_max_items / 2 : options.scale_up_depth)
 {
     if (threads_n == 0 || threads_n > 1000)
     {
         throw_spdlog_ex("spdlog::thread_pool(): invalid threads_n param (valid "
                         "range is 1-1000)");
     }
+    if (elastic_ && (max_threads_ > 1000 || options.numa_shards))
+    {
+        throw_spdlog_ex("spdlog::thread_pool(): invalid max_threads param (valid range is threads_n-1000, without numa_shards)");
+    }
+    if (elastic_ && options.work_stealing)
+    {
+        throw_spdlog_ex("spdlog::thread_pool(): work_stealing is not supported with max_threads");
+    }
+    if (!options.spill_file.empty() && options.fork_safe)
+    {
+        // the parent and the child would share the mapping
+        throw_spdlog_ex("spdlog::thread_pool(): spill_file is not supported with fork_safe");
+    }
+
+    if (options.numa_shards)
+    {
+        make_numa_shards_(threads_n, q_max_items);
+    }
+    if (shards_.empty())
+    {
+        size_t shards_n = options.shards == 0 ? 1 : options.shards;
+        if (elastic_ && shards_n <= 1)
+        {
+            shards_n = max_threads_;
+        }
+        if (!elastic_ && shards_n > threads_n)
+        {
+            throw_spdlog_ex("spdlog::thread_pool(): invalid shards param (must not exceed threads_n)");
+        }
+        if (elastic_ && shards_n < threads_n)
+        {
+            throw_spdlog_ex("spdlog::thread_pool(): invalid shards param (must not be below threads_n with max_threads)");
+        }
+        shards_.resize(shards_n);
+        for (auto &s : shards_)
+        {
+            make_queue_(s, q_max_items);
+        }
+    }
     for (size_t i = 0; i < threads_n; i++)
     {
-        threads_.emplace_back([this, on_thread_start] {
-            on_thread_start();
-            this->thread_pool::worker_loop_();
-        });
+        shards_[i % shards_.size()].workers++;
+    }
+    if (elastic_)
+    {
+        // one worker at a time per shard
+        for (auto &s : shards_)
+        {
+            s.workers = 1;
+        }
+        shard_workers_.reset(new std::atomic<size_t>[shards_.size()]);
+    }
+    else if (options.ordered_workers)
+    {
+        for (auto &s : shards_)
+        {
+            if (s.workers > 1)
+            {
+                s.order = details::make_unique<shard_order>();
+            }
+        }
+    }
+
+    if (!options.spill_file.empty())
+    {
+        spill_pending_.reset(new std::atomic<size_t>[shards_.size()]);
+        for (size_t k = 0; k < shards_.size(); k++)
+        {
+            auto pages = options.queue_pages;
+            pages.file = shards_.size() == 1 ? options.spill_file : fmt::format(SPDLOG_FILENAME_T("{}.{}"), options.spill_file, k);
+            shards_[k].spill_q = details::make_unique<arena_q_type>((std::min)(options.spill_size, size_t{UINT32_MAX} & ~size_t{0xff}), pages);
+            spill_pending_[k].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    if (options.on_load_threshold && !options.load_thresholds.empty())
+    {
+        load_levels_.reset(new std::atomic<size_t>[shards_.size()]);
+        for (size_t k = 0; k < shards_.size(); k++)
+        {
+            load_levels_[k].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    start_workers_(true);
+    crash_dump_sources::instance().add(this, crash_dump_);
+
+    if (options.fork_safe)
+    {
+        auto &registry = fork_registry_();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.pools.push_back(this);
     }
 }
 
+SPDLOG_INLINE thread_pool::thread_pool(size_t q_max_items, size_t threads_n, std::function<void()> on_thread_start)
+    : thread_pool(q_max_items, threads_n, options_with_callback_(std::move(on_thread_start)))
+{}
+
 SPDLOG_INLINE thread_pool::thread_pool(size_t q_max_items, size_t threads_n)
-    : thread_pool(q_max_items, threads_n, [] {})
+    : thread_pool(q_max_items, threads_n, thread_pool_options{})
 {}
 
 // message all threads to terminate gracefully join them
@@ -39,15 +146,16 @@ SPDLOG_INLINE thread_pool::~thread_pool()
 {
     SPDLOG_TRY
     {
-        for (size_t i = 0; i < threads_.size(); i++)
+        crash_dump_sources::instance().remove(this);
+        if (options_.fork_safe)
         {
-            post_async_msg_(async_msg(async_msg_type::terminate), async_overflow_policy::block);
-        }
-
-        for (auto &t : threads_)
-        {
-            t.join();
+            auto &registry = fork_registry_();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            registry.pools.erase(std::remove(registry.pools.begin(), registry.pools.end(), this), registry.pools.end());
         }
+        stop_workers_();
+        complete_pending_flushes_();
+        wake_room_waiters_(true);
     }
     SPDLOG_CATCH_STD
 }
@@ -97,87 +205,2144 @@ void SPDLOG_INLINE thread_pool::post_log(async_logger_ptr &&worker_ptr, const de
      **/
     // clang-format on
 
+    auto *worker_raw = worker_ptr.get();
+    auto &target = shard_of_(worker_raw);
+    bool reference_name = names_worker_(worker_raw, msg);
+    memory_scope scope(memory_);
+    if (is_priority_(msg))
+    {
+        post_priority_(target, async_msg(std::move(worker_ptr), async_msg_type::log, msg, reference_name));
+        return;
+    }
+    if (target.arena_q != nullptr && !shares_(target, worker_raw))
+    {
+        post_record_(target,
+            async_msg_record{async_msg_type::log, std::move(worker_ptr), worker_raw, msg, nullptr, string_view_t{}, reference_name, nullptr},
+            overflow_policy);
+        return;
+    }
+
     // worker_ptr.use_count() != 0;
-    async_msg async_m(std::move(worker_ptr), async_msg_type::log, msg); // worker_ptr 的所有权发生了转移
+    async_msg async_m(std::move(worker_ptr), async_msg_type::log, msg, reference_name); // worker_ptr 的所有权发生了转移
     // worker_ptr.use_count() == 0;
 
     // async_m.worker_ptr.use_count() != 0;
-    post_async_msg_(std::move(async_m), overflow_policy); // async_m 的所有权发生了转移
+    post_async_msg_(target, std::move(async_m), overflow_policy); // async_m 的所有权发生了转移
     // async_m.worker_ptr.use_count() == 0;
 }
 
 void SPDLOG_INLINE thread_pool::post_flush(async_logger_ptr &&worker_ptr, async_overflow_policy overflow_policy)
 {
+    if (!cpu_shards_.empty())
+    {
+        // the logger's messages may be in any of the numa shards
+        for (auto &s : shards_)
+        {
+            post_async_msg_(s, async_msg(async_logger_ptr(worker_ptr), async_msg_type::flush), overflow_policy);
+        }
+        return;
+    }
     // async_msg(std::move(worker_ptr) 是临时变量，不能作为非 const 的引用参数
     // 如果需要使用左值引用的方式传参，需要单独创建 async_msg(std::move(worker_ptr) 对象
     post_async_msg_(async_msg(std::move(worker_ptr), async_msg_type::flush), overflow_policy);
 }
 
-size_t SPDLOG_INLINE thread_pool::overrun_counter()
+void SPDLOG_INLINE thread_pool::post_log(async_logger *worker, const details::log_msg &msg, async_overflow_policy overflow_policy)
 {
-    return q_.overrun_counter();
+    auto &target = shard_of_(worker);
+    bool reference_name = names_worker_(worker, msg);
+    memory_scope scope(memory_);
+    if (is_priority_(msg))
+    {
+        post_priority_(target, async_msg(worker, async_msg_type::log, msg, reference_name));
+        return;
+    }
+    if (target.arena_q != nullptr && !shares_(target, worker))
+    {
+        post_record_(target,
+            async_msg_record{async_msg_type::log, async_logger_ptr{}, worker, msg, nullptr, string_view_t{}, reference_name, nullptr},
+            overflow_policy);
+        return;
+    }
+    post_async_msg_(target, async_msg(worker, async_msg_type::log, msg, reference_name), overflow_policy);
 }
 
-size_t SPDLOG_INLINE thread_pool::queue_size()
+void SPDLOG_INLINE thread_pool::post_deferred_log(async_logger_ptr &&worker_ptr, async_logger *worker, const details::log_msg &msg,
+    deferred_format_fn format_fn, string_view_t format_args, async_overflow_policy overflow_policy)
 {
-    return q_.size();
+    auto &target = shard_of_(worker);
+    bool reference_name = names_worker_(worker, msg);
+    memory_scope scope(memory_);
+    if (is_priority_(msg))
+    {
+        post_priority_(target, async_msg(std::move(worker_ptr), worker, msg, format_fn, format_args, reference_name));
+        return;
+    }
+    if (target.arena_q != nullptr && !shares_(target, worker))
+    {
+        post_record_(target,
+            async_msg_record{async_msg_type::log, std::move(worker_ptr), worker, msg, format_fn, format_args, reference_name, nullptr},
+            overflow_policy);
+        return;
+    }
+    post_async_msg_(target, async_msg(std::move(worker_ptr), worker, msg, format_fn, format_args, reference_name), overflow_policy);
 }
 
-void SPDLOG_INLINE thread_pool::post_async_msg_(async_msg &&new_msg, async_overflow_policy overflow_policy)
+void SPDLOG_INLINE thread_pool::post_log_batch(async_logger_ptr &&worker_ptr, async_logger *worker, const details::log_msg &msg,
+    string_view_t lines, async_overflow_policy overflow_policy)
 {
-    if (overflow_policy == async_overflow_policy::block)
+    auto &target = shard_of_(worker);
+    bool reference_name = names_worker_(worker, msg);
+    size_t n_lines = lines.size() / sizeof(log_line);
+    if (target.arena_q != nullptr && n_lines > 1 &&
+        async_msg_arena_codec::encoded_size(msg, lines.size(), reference_name) + alignof(std::max_align_t) > target.arena_q->max_record_size())
+    {
+        // larger than a record of the arena: posted in two halves
+        auto half = (n_lines / 2) * sizeof(log_line);
+        size_t text_size = 0;
+        log_line line;
+        for (size_t pos = 0; pos < half; pos += sizeof(log_line))
+        {
+            std::memcpy(&line, lines.data() + pos, sizeof(log_line));
+            text_size += line.size;
+        }
+        log_msg first(msg);
+        first.payload = string_view_t(msg.payload.data(), text_size);
+        log_msg second(msg);
+        second.payload = string_view_t(msg.payload.data() + text_size, msg.payload.size() - text_size);
+        std::memcpy(&line, lines.data() + half, sizeof(log_line));
+        second.time = line.time;
+        post_log_batch(async_logger_ptr(worker_ptr), worker, first, string_view_t(lines.data(), half), overflow_policy);
+        post_log_batch(std::move(worker_ptr), worker, second, string_view_t(lines.data() + half, lines.size() - half), overflow_policy);
+        return;
+    }
+    memory_scope scope(memory_);
+    if (is_priority_(msg))
     {
-        /**
-         * 为什么这里没有加锁？
-         *    因为在 mpmc 中的 enqueue 方法中已经进行了加锁操作
-         */
-        q_.enqueue(std::move(new_msg));
+        post_priority_(target, async_msg(std::move(worker_ptr), worker, msg, lines, reference_name));
+        return;
     }
-    else
+    if (target.arena_q != nullptr && !shares_(target, worker))
+    {
+        post_record_(target,
+            async_msg_record{async_msg_type::log_batch, std::move(worker_ptr), worker, msg, nullptr, lines, reference_name, nullptr},
+            overflow_policy);
+        return;
+    }
+    post_async_msg_(target, async_msg(std::move(worker_ptr), worker, msg, lines, reference_name), overflow_policy);
+}
+
+void SPDLOG_INLINE thread_pool::post_flush(async_logger *worker, async_overflow_policy overflow_policy)
+{
+    if (!cpu_shards_.empty())
     {
-        q_.enqueue_nowait(std::move(new_msg));
+        for (auto &s : shards_)
+        {
+            post_async_msg_(s, async_msg(worker, async_msg_type::flush), overflow_policy);
+        }
+        return;
     }
+    post_async_msg_(async_msg(worker, async_msg_type::flush), overflow_policy);
 }
 
-void SPDLOG_INLINE thread_pool::worker_loop_()
+std::future<void> SPDLOG_INLINE thread_pool::post_flush_async(async_logger_ptr &&worker_ptr, async_logger *worker)
 {
-    while (process_next_msg_()) {}
+    // the logger's messages may be in any of the numa shards
+    auto *completion = new async_flush_completion(cpu_shards_.empty() ? 1 : shards_.size());
+    auto future = completion->promise.get_future();
+    post_flush_completion_(std::move(worker_ptr), worker, completion);
+    return future;
 }
 
-// process next message in the queue
-// return true if this thread should still be active (while no terminate msg
-// was received)
-bool SPDLOG_INLINE thread_pool::process_next_msg_()
+void SPDLOG_INLINE thread_pool::post_flush_async(async_logger_ptr &&worker_ptr, async_logger *worker, std::function<void()> on_flushed)
 {
-    async_msg incoming_async_msg;
-    // 同样的，对于出队操作，已经在队列内部进行了加锁操作，所以外面调用的时候不需要加锁
-    bool dequeued = q_.dequeue_for(incoming_async_msg, std::chrono::seconds(10));
-    if (!dequeued)
+    auto *completion = new async_flush_completion(cpu_shards_.empty() ? 1 : shards_.size(), std::move(on_flushed));
+    post_flush_completion_(std::move(worker_ptr), worker, completion);
+}
+
+void SPDLOG_INLINE thread_pool::post_flush_completion_(async_logger_ptr &&worker_ptr, async_logger *worker, async_flush_completion *completion)
+{
+    if (!cpu_shards_.empty())
     {
-        return true;
+        for (auto &s : shards_)
+        {
+            post_async_msg_(s, async_msg(async_logger_ptr(worker_ptr), worker, completion), async_overflow_policy::block);
+        }
+        return;
     }
+    post_async_msg_(shard_of_(worker), async_msg(std::move(worker_ptr), worker, completion), async_overflow_policy::block);
+}
 
-    switch (incoming_async_msg.msg_type)
+void SPDLOG_INLINE thread_pool::when_queue_has_room(const async_logger &logger, std::function<void(bool)> on_room)
+{
+    auto &s = shards_[shards_.size() == 1 ? 0 : shard_of(logger)];
+    if (load_of_(s) < 1)
     {
-    case async_msg_type::log: {
-        incoming_async_msg.worker_ptr->backend_sink_it_(incoming_async_msg);
-        return true;
+        on_room(true);
+        return;
     }
-    case async_msg_type::flush: {
-        incoming_async_msg.worker_ptr->backend_flush_();
-        return true;
+    {
+        std::lock_guard<std::mutex> lock(room_mutex_);
+        room_waiters_.emplace_back(&s, std::move(on_room));
+        n_room_waiters_.store(room_waiters_.size(), std::memory_order_relaxed);
+    }
+    // a worker may have dequeued before seeing the waiter
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (load_of_(s) < 1)
+    {
+        wake_room_waiters_();
     }
+}
 
-    case async_msg_type::terminate: {
+void SPDLOG_INLINE thread_pool::wake_room_waiters_(bool closing)
+{
+    std::vector<std::function<void(bool)>> ready;
+    {
+        std::lock_guard<std::mutex> lock(room_mutex_);
+        auto it = room_waiters_.begin();
+        while (it != room_waiters_.end())
+        {
+            if (closing || load_of_(*it->first) < 1)
+            {
+                ready.push_back(std::move(it->second));
+                it = room_waiters_.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        n_room_waiters_.store(room_waiters_.size(), std::memory_order_relaxed);
+    }
+    for (auto &on_room : ready)
+    {
+        SPDLOG_TRY
+        {
+            on_room(!closing);
+        }
+        SPDLOG_CATCH_STD
+    }
+}
+
+std::future<void> SPDLOG_INLINE thread_pool::post_flush_batch(const std::vector<async_logger_ptr> &loggers)
+{
+    // the loggers' messages may be in any of the shards
+    auto *batch = new async_flush_batch(shards_.size());
+    auto future = batch->promise.get_future();
+    for (const auto &logger : loggers)
+    {
+        batch->loggers.push_back(logger.get());
+        // attached loggers detach (and wait for the queued messages) before being destroyed
+        if (!logger->attached_)
+        {
+            batch->owned.push_back(logger);
+        }
+    }
+    for (auto &s : shards_)
+    {
+        post_async_msg_(s, async_msg(batch), async_overflow_policy::block);
+    }
+    return future;
+}
+
+void SPDLOG_INLINE thread_pool::discard_queued()
+{
+    discarding_.store(true, std::memory_order_relaxed);
+}
+
+bool SPDLOG_INLINE thread_pool::post_formatted_log(async_logger_ptr &&worker_ptr, async_logger *worker, const details::log_msg &msg,
+    fmt::format_args args, async_overflow_policy overflow_policy, size_t &formatted_size)
+{
+    auto &target = shard_of_(worker);
+    if (target.arena_q == nullptr || overflow_policy == async_overflow_policy::overrun_oldest || overflow_policy == async_overflow_policy::spill ||
+        is_priority_(msg) || shares_(target, worker))
+    {
+        return false;
+    }
+    auto fmt = msg.payload;
+    bool reference_name = names_worker_(worker, msg);
+    auto offset = async_msg_arena_codec::payload_offset(msg, 0, reference_name);
+    auto max_size = target.arena_q->max_record_size();
+    if (offset >= max_size)
+    {
         return false;
     }
+    // room for the format string and some more (within the arena). formatted again with the exact size if short.
+    auto capacity = (std::min)(fmt.size() + 128, max_size - offset);
+    for (;;)
+    {
+        char *data = reserve_record_(target, worker, offset + capacity, overflow_policy);
+        if (data == nullptr)
+        {
+            count_posted_(worker, false);
+            formatted_size = 0;
+            return true;
+        }
+        size_t payload_size;
+#ifndef SPDLOG_NO_EXCEPTIONS
+        try
+        {
+            payload_size = fmt::vformat_to_n(data + offset, capacity, fmt, args).size;
+        }
+        catch (...)
+        {
+            target.arena_q->cancel_record(data);
+            throw;
+        }
+#else
+        payload_size = fmt::vformat_to_n(data + offset, capacity, fmt, args).size;
+#endif
+        if (payload_size > capacity)
+        {
+            target.arena_q->cancel_record(data);
+            if (payload_size > max_size - offset)
+            {
+                // larger than a record of the arena: posted by the caller (on the heap)
+                return false;
+            }
+            capacity = payload_size;
+            continue;
+        }
+        async_msg_arena_codec::encode_formatted(
+            data, async_msg_record{async_msg_type::log, std::move(worker_ptr), worker, msg, nullptr, string_view_t{}, reference_name, nullptr},
+            payload_size);
+        target.arena_q->commit_record(data);
+        count_posted_(worker, true);
+        if (load_levels_)
+        {
+            check_load_(target);
+        }
+        formatted_size = payload_size;
+        return true;
+    }
+}
 
-    default: {
-        assert(false);
+bool SPDLOG_INLINE thread_pool::formats_in_place() const
+{
+    return options_.queue_backend == async_queue_backend::arena;
+}
+
+bool SPDLOG_INLINE thread_pool::pins_loggers() const
+{
+    return pin_loggers_;
+}
+
+void SPDLOG_INLINE thread_pool::attach_logger(async_logger *logger)
+{
+    std::lock_guard<std::mutex> lock(attached_mutex_);
+    attached_loggers_.insert(logger);
+}
+
+// once the barrier is released no message of the detached logger is still in the queue or being processed.
+void SPDLOG_INLINE thread_pool::detach_logger(async_logger *logger)
+{
+    {
+        std::lock_guard<std::mutex> lock(attached_mutex_);
+        if (attached_loggers_.erase(logger) == 0)
+        {
+            return;
+        }
+    }
+    post_barrier_();
+}
+
+void SPDLOG_INLINE thread_pool::wait_processed()
+{
+    post_barrier_();
+}
+
+// a worker reaches the barrier only after processing the messages it dequeued before, so once it
+// is released all the messages posted before it were processed.
+void SPDLOG_INLINE thread_pool::post_barrier_()
+{
+    std::lock_guard<std::mutex> post_lock(barrier_post_mutex_);
+    size_t generation;
+    {
+        std::lock_guard<std::mutex> lock(barrier_mutex_);
+        barrier_pending_ = 0;
+        for (auto &s : shards_)
+        {
+            barrier_pending_ += s.workers;
+        }
+        generation = barrier_generation_;
     }
+    for (auto &s : shards_)
+    {
+        for (size_t i = 0; i < s.workers; i++)
+        {
+            post_async_msg_(s, async_msg(async_msg_type::barrier), async_overflow_policy::block);
+        }
     }
+    std::unique_lock<std::mutex> lock(barrier_mutex_);
+    barrier_cv_.wait(lock, [this, generation] { return this->barrier_generation_ != generation; });
+}
 
-    return true;
+size_t SPDLOG_INLINE thread_pool::attached_loggers()
+{
+    std::lock_guard<std::mutex> lock(attached_mutex_);
+    return attached_loggers_.size();
+}
+
+size_t SPDLOG_INLINE thread_pool::overrun_counter()
+{
+    size_t total = 0;
+    for (auto &s : shards_)
+    {
+        total += s.q->overrun_counter() + (s.priority_q ? s.priority_q->overrun_counter() : 0) +
+                 (s.shared_q ? s.shared_q->overrun_counter() : 0);
+    }
+    return total;
+}
+
+size_t SPDLOG_INLINE thread_pool::memory_used() const
+{
+    return memory_->used();
+}
+
+size_t SPDLOG_INLINE thread_pool::queue_size()
+{
+    size_t total = 0;
+    for (auto &s : shards_)
+    {
+        total += s.q->size() + (s.priority_q ? s.priority_q->size() : 0) + (s.shared_q ? s.shared_q->size() : 0) +
+                 (s.spill_q ? s.spill_q->size() : 0);
+    }
+    return total;
+}
+
+double SPDLOG_INLINE thread_pool::load_factor(const async_logger &logger)
+{
+    return load_of_(shards_[shards_.size() == 1 ? 0 : shard_of(logger)]);
+}
+
+double SPDLOG_INLINE thread_pool::load_factor()
+{
+    double load = 0;
+    for (auto &s : shards_)
+    {
+        load = (std::max)(load, load_of_(s));
+    }
+    return load;
+}
+
+size_t SPDLOG_INLINE thread_pool::shards() const
+{
+    return shards_.size();
+}
+
+size_t SPDLOG_INLINE thread_pool::workers() const
+{
+    if (!elastic_)
+    {
+        return threads_n_;
+    }
+    std::lock_guard<std::mutex> lock(elastic_mutex_);
+    return running_workers_;
+}
+
+size_t SPDLOG_INLINE thread_pool::shard_of(const async_logger &logger) const
+{
+    if (!cpu_shards_.empty())
+    {
+        auto cpu = os::current_cpu();
+        return cpu >= 0 && static_cast<size_t>(cpu) < cpu_shards_.size() ? cpu_shards_[static_cast<size_t>(cpu)] : 0;
+    }
+    return logger.shard_hint_.load(std::memory_order_relaxed) % shards_.size();
+}
+
+async_stats SPDLOG_INLINE thread_pool::stats() const
+{
+    auto snapshot = stats_.snapshot();
+    snapshot.workers = workers();
+    return snapshot;
+}
+
+SPDLOG_INLINE void thread_pool::make_queue_(shard &s, size_t q_max_items) const
+{
+    if (options_.priority_level != level::off)
+    {
+        s.priority_q = details::make_unique<mpmc_blocking_queue<item_type>>(
+            options_.priority_q_max_items > 0 ? options_.priority_q_max_items : q_max_items, options_.queue_pages);
+    }
+    if (options_.work_stealing)
+    {
+        s.shared_q = details::make_unique<mpmc_blocking_queue<item_type>>(q_max_items, options_.queue_pages);
+    }
+    switch (options_.queue_backend)
+    {
+    case async_queue_backend::lock_free:
+        s.q = details::make_unique<mpmc_lockfree_queue<item_type>>(q_max_items, options_.queue_pages);
+        break;
+    case async_queue_backend::per_thread_lanes:
+        s.q = details::make_unique<spsc_lanes_queue<item_type, async_msg_time_order>>(
+            q_max_items, async_msg_time_order(), options_.queue_pages);
+        break;
+    case async_queue_backend::arena: {
+        // the record sizes are 32 bits
+        auto arena_size = (std::min)(options_.arena_size > 0 ? options_.arena_size : q_max_items * 128, size_t{UINT32_MAX} & ~size_t{0xff});
+        auto arena_q = details::make_unique<arena_q_type>(arena_size, options_.queue_pages);
+        s.arena_q = arena_q.get();
+        s.q = std::move(arena_q);
+        break;
+    }
+    default:
+        s.q = details::make_unique<mpmc_blocking_queue<item_type>>(q_max_items, options_.queue_pages);
+        break;
+    }
+}
+
+SPDLOG_INLINE void thread_pool::make_numa_shards_(size_t threads_n, size_t q_max_items)
+{
+    std::vector<shard> numa_shards;
+    size_t max_cpu = 0;
+    for (auto node : os::numa_nodes())
+    {
+        shard s;
+        s.numa_node = node;
+        s.cpus = os::numa_node_cpus(node);
+        if (!s.cpus.empty())
+        {
+            max_cpu = (std::max)(max_cpu, *std::max_element(s.cpus.begin(), s.cpus.end()));
+            numa_shards.push_back(std::move(s));
+        }
+    }
+    if (numa_shards.size() < 2)
+    {
+        return;
+    }
+    if (numa_shards.size() > threads_n)
+    {
+        throw_spdlog_ex(fmt::format("spdlog::thread_pool(): numa_shards needs a thread per numa node ({} nodes)", numa_shards.size()));
+    }
+
+    // the queue is written first (so allocated, as per the default first touch policy) by a thread of its node
+    for (auto &s : numa_shards)
+    {
+#ifdef SPDLOG_NO_EXCEPTIONS
+        std::thread allocator([this, &s, q_max_items] {
+            os::set_thread_affinity(s.cpus);
+            make_queue_(s, q_max_items);
+        });
+        allocator.join();
+#else
+        std::exception_ptr error;
+        std::thread allocator([this, &s, q_max_items, &error] {
+            os::set_thread_affinity(s.cpus);
+            try
+            {
+                make_queue_(s, q_max_items);
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+        });
+        allocator.join();
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+#endif
+    }
+
+    cpu_shards_.assign(max_cpu + 1, 0);
+    for (size_t i = 0; i < numa_shards.size(); i++)
+    {
+        for (auto cpu : numa_shards[i].cpus)
+        {
+            cpu_shards_[cpu] = i;
+        }
+    }
+    shards_ = std::move(numa_shards);
+}
+
+// start the workers of the shards. if fail_on_setup_error, a failed setup of a worker (see setup_worker_())
+// stops all of them and throws - otherwise the workers run as set up.
+SPDLOG_INLINE void thread_pool::start_workers_(bool fail_on_setup_error)
+{
+    // the elastic workers add no worker before all of them started
+    std::lock_guard<std::mutex> elastic_lock(elastic_mutex_);
+    if (elastic_)
+    {
+        for (size_t k = 0; k < shards_.size(); k++)
+        {
+            shard_workers_[k].store(k % threads_n_, std::memory_order_relaxed);
+        }
+        stopping_ = false;
+        next_worker_id_ = threads_n_;
+        running_workers_ = threads_n_;
+    }
+    const auto &options = options_;
+    bool setup_workers = !options.cpu_affinity.empty() || options.numa_node >= 0 || !options.thread_name.empty() ||
+                         options.thread_nice != 0 || !cpu_shards_.empty();
+    if (!setup_workers)
+    {
+        auto on_thread_start = options.on_thread_start;
+        for (size_t i = 0; i < threads_n_; i++)
+        {
+            shard *my_shard = &shards_[i % shards_.size()];
+            threads_.emplace_back([this, on_thread_start, my_shard, i] {
+                on_thread_start();
+                if (elastic_)
+                {
+                    this->thread_pool::elastic_worker_loop_(i);
+                    return;
+                }
+                this->thread_pool::worker_loop_(*my_shard);
+            });
+        }
+        return;
+    }
+
+    std::vector<size_t> numa_cpus;
+    if (options.cpu_affinity.empty() && options.numa_node >= 0)
+    {
+        numa_cpus = os::numa_node_cpus(options.numa_node);
+        if (numa_cpus.empty() && fail_on_setup_error)
+        {
+            throw_spdlog_ex(fmt::format("spdlog::thread_pool(): cpus of numa node {} not found", options.numa_node));
+        }
+    }
+
+    // each worker sets itself up and waits for the others, so a failure can be
+    // reported by the constructor before any message is processed.
+    struct startup_state
+    {
+        std::mutex mutex;
+        std::condition_variable cv;
+        size_t pending;
+        std::string error;
+    };
+    auto startup = std::make_shared<startup_state>();
+    startup->pending = threads_n_;
+    for (size_t i = 0; i < threads_n_; i++)
+    {
+        shard *my_shard = &shards_[i % shards_.size()];
+        // the workers of a numa shard run on its node
+        auto node = my_shard->cpus.empty() ? options.numa_node : my_shard->numa_node;
+        auto cpus = my_shard->cpus.empty() ? numa_cpus : my_shard->cpus;
+        threads_.emplace_back([this, options, node, cpus, startup, my_shard, i, fail_on_setup_error] {
+            auto error = setup_worker_(options, node, cpus, i);
+            {
+                std::unique_lock<std::mutex> lock(startup->mutex);
+                if (!error.empty() && startup->error.empty())
+                {
+                    startup->error = error;
+                }
+                if (--startup->pending == 0)
+                {
+                    startup->cv.notify_all();
+                }
+                startup->cv.wait(lock, [&startup] { return startup->pending == 0; });
+                if (!startup->error.empty() && fail_on_setup_error)
+                {
+                    return;
+                }
+            }
+            options.on_thread_start();
+            if (elastic_)
+            {
+                this->thread_pool::elastic_worker_loop_(i);
+                return;
+            }
+            this->thread_pool::worker_loop_(*my_shard);
+        });
+    }
+
+    std::string error;
+    {
+        std::unique_lock<std::mutex> lock(startup->mutex);
+        startup->cv.wait(lock, [&startup] { return startup->pending == 0; });
+        error = startup->error;
+    }
+    if (!error.empty() && fail_on_setup_error)
+    {
+        for (auto &t : threads_)
+        {
+            t.join();
+        }
+        threads_.clear();
+        throw_spdlog_ex("spdlog::thread_pool(): " + error);
+    }
+}
+
+// terminate the workers once they processed the messages queued before, and join them
+SPDLOG_INLINE void thread_pool::stop_workers_()
+{
+    {
+        std::lock_guard<std::mutex> lock(elastic_mutex_);
+        stopping_ = true;
+    }
+    for (auto &s : shards_)
+    {
+        for (size_t i = 0; i < s.workers; i++)
+        {
+            post_async_msg_(s, async_msg(async_msg_type::terminate), async_overflow_policy::block);
+        }
+    }
+
+    // the elastic workers may add workers until they processed their terminate messages
+    for (;;)
+    {
+        std::vector<std::thread> threads;
+        {
+            std::lock_guard<std::mutex> lock(elastic_mutex_);
+            threads.swap(threads_);
+            std::move(retired_threads_.begin(), retired_threads_.end(), std::back_inserter(threads));
+            retired_threads_.clear();
+        }
+        if (threads.empty())
+        {
+            break;
+        }
+        for (auto &t : threads)
+        {
+            t.join();
+        }
+    }
+}
+
+// posted by other threads while the pool was being destroyed
+SPDLOG_INLINE void thread_pool::complete_pending_flushes_()
+{
+    for (auto &s : shards_)
+    {
+        for (auto *q : {s.q.get(), s.priority_q.get(), s.shared_q.get()})
+        {
+            async_msg msg;
+            while (q != nullptr && q->try_dequeue_bulk(&msg, 1) == 1)
+            {
+                if (msg.msg_type == async_msg_type::flush_sync)
+                {
+                    msg.worker_raw->backend_flush_();
+                    msg.flush_completion()->done();
+                }
+                else if (msg.msg_type == async_msg_type::flush_batch)
+                {
+                    flush_batch_(msg.flush_batch());
+                }
+            }
+        }
+    }
+}
+
+SPDLOG_INLINE thread_pool::fork_registry &thread_pool::fork_registry_()
+{
+    static fork_registry registry;
+#ifndef _WIN32
+    static const int registered = ::pthread_atfork(on_fork_prepare_, on_fork_parent_, on_fork_child_);
+    (void)registered;
+#endif
+    return registry;
+}
+
+#ifndef SPDLOG_NO_TLS
+// the pool whose worker is the calling thread, if any
+SPDLOG_INLINE const thread_pool *&thread_pool::worker_pool_()
+{
+    static thread_local const thread_pool *pool = nullptr;
+    return pool;
+}
+#endif
+
+SPDLOG_INLINE bool thread_pool::is_worker_thread_() const
+{
+#ifndef SPDLOG_NO_TLS
+    return worker_pool_() == this;
+#else
+    std::lock_guard<std::mutex> lock(elastic_mutex_);
+    auto self = std::this_thread::get_id();
+    return std::any_of(threads_.begin(), threads_.end(), [self](const std::thread &t) { return t.get_id() == self; });
+#endif
+}
+
+// before fork(): stop the workers (so none holds a sink or queue lock) and hold the blocking
+// queues' locks, so that no enqueue is in progress in the child.
+// the pool of a forking worker is left alone: it can't wait for itself to stop.
+SPDLOG_INLINE void thread_pool::on_fork_prepare_()
+{
+    auto &registry = fork_registry_();
+    registry.mutex.lock();
+    registry.forking_pool = nullptr;
+    for (auto *pool : registry.pools)
+    {
+        if (pool->is_worker_thread_())
+        {
+            registry.forking_pool = pool;
+            break;
+        }
+    }
+    for (auto *pool : registry.pools)
+    {
+        if (pool == registry.forking_pool)
+        {
+            continue;
+        }
+        SPDLOG_TRY
+        {
+            pool->stop_workers_();
+        }
+        SPDLOG_CATCH_STD
+        for (auto &s : pool->shards_)
+        {
+            s.q->lock_for_fork();
+            if (s.priority_q)
+            {
+                s.priority_q->lock_for_fork();
+            }
+            if (s.shared_q)
+            {
+                s.shared_q->lock_for_fork();
+            }
+        }
+    }
+}
+
+SPDLOG_INLINE void thread_pool::on_fork_parent_()
+{
+    after_fork_(false);
+}
+
+SPDLOG_INLINE void thread_pool::on_fork_child_()
+{
+    after_fork_(true);
+}
+
+// restart the workers, in the parent and in the child (whose only thread is the forking one)
+SPDLOG_INLINE void thread_pool::after_fork_(bool child)
+{
+    auto &registry = fork_registry_();
+    for (auto *pool : registry.pools)
+    {
+        if (pool == registry.forking_pool)
+        {
+            continue;
+        }
+        for (auto &s : pool->shards_)
+        {
+            s.q->unlock_after_fork(child);
+            if (s.priority_q)
+            {
+                s.priority_q->unlock_after_fork(child);
+            }
+            if (s.shared_q)
+            {
+                s.shared_q->unlock_after_fork(child);
+            }
+        }
+        SPDLOG_TRY
+        {
+            pool->start_workers_(false);
+        }
+        SPDLOG_CATCH_STD
+    }
+    registry.mutex.unlock();
+}
+
+SPDLOG_INLINE void thread_pool::crash_dump_(const void *pool, crash_writer &writer)
+{
+    auto *self = static_cast<const thread_pool *>(pool);
+    auto write_log_msg = [](const async_msg &item, void *context) {
+        auto *crash = static_cast<crash_writer *>(context);
+        if (item.msg_type == async_msg_type::log)
+        {
+            crash->write_msg(item);
+        }
+        else if (item.msg_type == async_msg_type::log_batch)
+        {
+            details::foreach_log_line(item, item.extra(), [crash](const log_msg &line_msg) { crash->write_msg(line_msg); });
+        }
+    };
+    for (auto &s : self->shards_)
+    {
+        if (s.priority_q)
+        {
+            s.priority_q->foreach_queued_unsafe(write_log_msg, &writer);
+        }
+        s.q->foreach_queued_unsafe(write_log_msg, &writer);
+        if (s.shared_q)
+        {
+            s.shared_q->foreach_queued_unsafe(write_log_msg, &writer);
+        }
+    }
+}
+
+SPDLOG_INLINE thread_pool_options thread_pool::options_with_callback_(std::function<void()> on_thread_start)
+{
+    thread_pool_options options;
+    options.on_thread_start = std::move(on_thread_start);
+    return options;
+}
+
+SPDLOG_INLINE thread_pool::shard &thread_pool::shard_of_(const async_logger *logger)
+{
+    if (shards_.size() == 1)
+    {
+        return shards_.front();
+    }
+    return shards_[shard_of(*logger)];
+}
+
+SPDLOG_INLINE std::string thread_pool::setup_worker_(
+    const thread_pool_options &options, int numa_node, const std::vector<size_t> &numa_cpus, size_t worker_index)
+{
+    if (!options.thread_name.empty())
+    {
+        os::set_thread_name(fmt::format("{}-{}", options.thread_name, worker_index));
+    }
+    if (!options.cpu_affinity.empty())
+    {
+        auto cpu = options.cpu_affinity[worker_index % options.cpu_affinity.size()];
+        if (!os::set_thread_affinity({cpu}))
+        {
+            return fmt::format("failed to pin worker {} to cpu {}", worker_index, cpu);
+        }
+    }
+    else if (!numa_cpus.empty() && !os::set_thread_affinity(numa_cpus))
+    {
+        return fmt::format("failed to pin worker {} to numa node {}", worker_index, numa_node);
+    }
+    if (options.thread_nice != 0 && !os::set_thread_nice(options.thread_nice))
+    {
+        return fmt::format("failed to set nice value {} of worker {}", options.thread_nice, worker_index);
+    }
+    return std::string{};
+}
+
+// post to the shard of the message's logger
+void SPDLOG_INLINE thread_pool::post_async_msg_(async_msg &&new_msg, async_overflow_policy overflow_policy)
+{
+    auto &target = shard_of_(new_msg.worker_raw);
+    post_async_msg_(target, std::move(new_msg), overflow_policy);
+}
+
+void SPDLOG_INLINE thread_pool::post_async_msg_(shard &target, async_msg &&new_msg, async_overflow_policy overflow_policy)
+{
+    if (spills_(target, new_msg.worker_raw, new_msg.msg_type, overflow_policy))
+    {
+        post_spill_(target, std::move(new_msg));
+    }
+    else if (shares_(target, new_msg.worker_raw))
+    {
+        post_async_msg_(*target.shared_q, std::move(new_msg), overflow_policy);
+    }
+    else
+    {
+        post_async_msg_(*target.q, std::move(new_msg), overflow_policy);
+    }
+    if (load_levels_)
+    {
+        check_load_(target);
+    }
+}
+
+SPDLOG_INLINE bool thread_pool::shares_(const shard &target, const async_logger *logger)
+{
+    return target.shared_q != nullptr && logger != nullptr && logger->order_insensitive_;
+}
+
+void SPDLOG_INLINE thread_pool::post_async_msg_(q_type &q, async_msg &&new_msg, async_overflow_policy overflow_policy)
+{
+    // control messages (terminate/barrier) have no logger and are not counted
+    auto *logger = new_msg.worker_raw;
+    if (overflow_policy == async_overflow_policy::spill)
+    {
+        // no spill queue
+        overflow_policy = async_overflow_policy::block;
+    }
+    else if (overflow_policy != async_overflow_policy::overrun_oldest && !async_queue_item<async_msg>::overrunnable(new_msg))
+    {
+        // the control messages are never discarded (nor overrun, see async_queue_item<async_msg>)
+        overflow_policy = async_overflow_policy::block;
+    }
+#ifdef SPDLOG_USDT
+    probe_posted_(logger, new_msg.msg_type, new_msg);
+#endif
+    if ((overflow_policy == async_overflow_policy::discard_new || overflow_policy == async_overflow_policy::block_for) && logger != nullptr)
+    {
+        bool enqueued = q.try_enqueue(std::move(new_msg));
+        if (!enqueued && overflow_policy == async_overflow_policy::block_for)
+        {
+            auto blocked_since = std::chrono::steady_clock::now();
+            enqueued = q.enqueue_for(std::move(new_msg), logger->block_timeout_);
+            count_timed_block_(logger, blocked_since, enqueued);
+        }
+        if (!enqueued)
+        {
+            // the fields of a message survive its move
+            SPDLOG_USDT_PROBE2(drop, logger->name().c_str(), static_cast<int>(new_msg.level));
+        }
+        count_posted_(logger, enqueued);
+        return;
+    }
+
+    if (!collect_stats_ || logger == nullptr)
+    {
+        if (overflow_policy == async_overflow_policy::block)
+        {
+            /**
+             * 为什么这里没有加锁？
+             *    因为在 mpmc 中的 enqueue 方法中已经进行了加锁操作
+             */
+            q.enqueue(std::move(new_msg));
+        }
+        else
+        {
+            auto overrun = q.enqueue_nowait(std::move(new_msg));
+            if (overrun > 0)
+            {
+                SPDLOG_USDT_PROBE1(overrun, overrun);
+            }
+        }
+        return;
+    }
+
+    size_t overrun = 0;
+    if (overflow_policy == async_overflow_policy::block)
+    {
+        if (!q.try_enqueue(std::move(new_msg)))
+        {
+            auto blocked_since = std::chrono::steady_clock::now();
+            q.enqueue(std::move(new_msg));
+            count_blocked_(logger, blocked_since);
+        }
+    }
+    else
+    {
+        overrun = q.enqueue_nowait(std::move(new_msg));
+        if (overrun > 0)
+        {
+            SPDLOG_USDT_PROBE1(overrun, overrun);
+        }
+    }
+    count_enqueued_(logger, overrun);
+}
+
+SPDLOG_INLINE double thread_pool::load_of_(shard &s)
+{
+    auto load = s.q->load_factor();
+    return s.shared_q ? (std::max)(load, s.shared_q->load_factor()) : load;
+}
+
+void SPDLOG_INLINE thread_pool::on_dequeued_(shard &s)
+{
+    if (load_levels_)
+    {
+        check_load_(s);
+    }
+    // ordered with the registration of the waiters (see when_queue_has_room())
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (n_room_waiters_.load(std::memory_order_relaxed) > 0)
+    {
+        wake_room_waiters_();
+    }
+}
+
+void SPDLOG_INLINE thread_pool::check_load_(shard &s)
+{
+    const auto &thresholds = options_.load_thresholds;
+    auto load = load_of_(s);
+    size_t level = 0;
+    while (level < thresholds.size() && load >= thresholds[level])
+    {
+        level++;
+    }
+    auto index = static_cast<size_t>(&s - shards_.data());
+    auto previous = load_levels_[index].load(std::memory_order_relaxed);
+    // the thread changing the level reports the thresholds crossed
+    do
+    {
+        if (previous == level)
+        {
+            return;
+        }
+    } while (!load_levels_[index].compare_exchange_weak(previous, level, std::memory_order_relaxed));
+    SPDLOG_TRY
+    {
+        for (auto i = previous; i < level; i++)
+        {
+            options_.on_load_threshold(index, thresholds[i], true);
+        }
+        for (auto i = previous; i > level; i--)
+        {
+            options_.on_load_threshold(index, thresholds[i - 1], false);
+        }
+    }
+    SPDLOG_CATCH_STD
+}
+
+SPDLOG_INLINE bool thread_pool::is_priority_(const log_msg &msg) const
+{
+    return options_.priority_level != level::off && msg.level >= options_.priority_level;
+}
+
+void SPDLOG_INLINE thread_pool::post_priority_(shard &target, async_msg &&new_msg)
+{
+    async_logger_ptr flush_ptr;
+    auto *logger = new_msg.worker_raw;
+    if (options_.priority_flush)
+    {
+        flush_ptr = new_msg.worker_ptr;
+    }
+    post_async_msg_(*target.priority_q, std::move(new_msg), options_.priority_overflow_policy);
+    std::future<void> flushed;
+    if (options_.priority_flush)
+    {
+        auto *completion = new async_flush_completion(1);
+        flushed = completion->promise.get_future();
+        post_async_msg_(*target.priority_q, async_msg(std::move(flush_ptr), logger, completion), async_overflow_policy::block);
+    }
+    // a worker parked on the regular queue wakes up. if it is full, the workers are busy and
+    // drain the priority queue before their next dequeue.
+    target.q->try_enqueue(async_msg(async_msg_type::wake));
+    if (flushed.valid())
+    {
+        flushed.wait();
+    }
+}
+
+void SPDLOG_INLINE thread_pool::post_record_(shard &target, async_msg_record &&record, async_overflow_policy overflow_policy)
+{
+    auto max_size = target.arena_q->max_record_size();
+    if (target.spill_q)
+    {
+        max_size = (std::min)(max_size, target.spill_q->max_record_size());
+    }
+    if (async_msg_arena_codec::encoded_size(record) > max_size)
+    {
+        // larger than a record of the arena: kept on the heap
+        async_msg_arena_codec::box(record);
+    }
+    auto *logger = record.worker_raw;
+    if (spills_(target, logger, record.msg_type, overflow_policy))
+    {
+        post_spill_(target, std::move(record));
+        if (load_levels_)
+        {
+            check_load_(target);
+        }
+        return;
+    }
+    if (overflow_policy == async_overflow_policy::spill)
+    {
+        overflow_policy = async_overflow_policy::block;
+    }
+#ifdef SPDLOG_USDT
+    probe_posted_(logger, record.msg_type, record.msg);
+#endif
+    if (overflow_policy == async_overflow_policy::discard_new || overflow_policy == async_overflow_policy::block_for)
+    {
+        bool enqueued = target.arena_q->try_enqueue_record(std::move(record));
+        if (!enqueued && overflow_policy == async_overflow_policy::block_for)
+        {
+            auto blocked_since = std::chrono::steady_clock::now();
+            enqueued = target.arena_q->enqueue_record_for(std::move(record), logger->block_timeout_);
+            count_timed_block_(logger, blocked_since, enqueued);
+        }
+        if (!enqueued)
+        {
+            SPDLOG_USDT_PROBE2(drop, logger->name().c_str(), static_cast<int>(record.msg.level));
+        }
+        count_posted_(logger, enqueued);
+        if (load_levels_)
+        {
+            check_load_(target);
+        }
+        return;
+    }
+
+    if (!collect_stats_)
+    {
+        auto overrun = target.arena_q->enqueue_record(std::move(record), overflow_policy == async_overflow_policy::overrun_oldest);
+        if (overrun > 0)
+        {
+            SPDLOG_USDT_PROBE1(overrun, overrun);
+        }
+        if (load_levels_)
+        {
+            check_load_(target);
+        }
+        return;
+    }
+
+    size_t overrun = 0;
+    if (overflow_policy == async_overflow_policy::block)
+    {
+        if (!target.arena_q->try_enqueue_record(std::move(record)))
+        {
+            auto blocked_since = std::chrono::steady_clock::now();
+            target.arena_q->enqueue_record(std::move(record), false);
+            count_blocked_(logger, blocked_since);
+        }
+    }
+    else
+    {
+        overrun = target.arena_q->enqueue_record(std::move(record), true);
+        if (overrun > 0)
+        {
+            SPDLOG_USDT_PROBE1(overrun, overrun);
+        }
+    }
+    count_enqueued_(logger, overrun);
+    if (load_levels_)
+    {
+        check_load_(target);
+    }
+}
+
+SPDLOG_INLINE bool thread_pool::names_worker_(const async_logger *worker, const log_msg &msg)
+{
+    return worker != nullptr && msg.logger_name.data() == worker->name().data();
+}
+
+SPDLOG_INLINE std::atomic<size_t> &thread_pool::spill_pending_of_(const shard &s)
+{
+    return spill_pending_[static_cast<size_t>(&s - shards_.data())];
+}
+
+SPDLOG_INLINE bool thread_pool::spills_(
+    const shard &target, const async_logger *logger, async_msg_type msg_type, async_overflow_policy overflow_policy)
+{
+    if (target.spill_q == nullptr || shares_(target, logger))
+    {
+        return false;
+    }
+    if (overflow_policy == async_overflow_policy::spill)
+    {
+        return true;
+    }
+    // the flush requests and the pool's messages are processed after the messages spilled before them
+    bool ordered = logger == nullptr || msg_type == async_msg_type::flush_sync;
+    return ordered && msg_type != async_msg_type::wake && spill_pending_of_(target).load(std::memory_order_acquire) > 0;
+}
+
+void SPDLOG_INLINE thread_pool::post_spill_(shard &target, async_msg &&new_msg)
+{
+    auto *logger = new_msg.worker_raw;
+#ifdef SPDLOG_USDT
+    probe_posted_(logger, new_msg.msg_type, new_msg);
+#endif
+    if (spill_pending_of_(target).load(std::memory_order_acquire) == 0 && target.q->try_enqueue(std::move(new_msg)))
+    {
+        if (collect_stats_ && logger != nullptr)
+        {
+            count_enqueued_(logger, 0);
+        }
+        return;
+    }
+    spill_(target, logger, std::move(new_msg));
+}
+
+void SPDLOG_INLINE thread_pool::post_spill_(shard &target, async_msg_record &&record)
+{
+    auto *logger = record.worker_raw;
+#ifdef SPDLOG_USDT
+    probe_posted_(logger, record.msg_type, record.msg);
+#endif
+    if (spill_pending_of_(target).load(std::memory_order_acquire) == 0 && target.arena_q->try_enqueue_record(std::move(record)))
+    {
+        if (collect_stats_)
+        {
+            count_enqueued_(logger, 0);
+        }
+        return;
+    }
+    spill_(target, logger, std::move(record));
+}
+
+// counted before the record is written, so that the later messages go to the spill too and the workers wait for it
+template<typename Src>
+void SPDLOG_INLINE thread_pool::spill_(shard &target, async_logger *logger, Src &&src)
+{
+    spill_pending_of_(target).fetch_add(1, std::memory_order_acq_rel);
+    if (!target.spill_q->try_enqueue_record(std::forward<Src>(src)))
+    {
+        // past the size of the spill file
+        auto blocked_since = std::chrono::steady_clock::now();
+        target.spill_q->enqueue_record(std::forward<Src>(src), false);
+        if (collect_stats_ && logger != nullptr)
+        {
+            count_blocked_(logger, blocked_since);
+        }
+    }
+    stats_.on_spilled();
+    if (collect_stats_ && logger != nullptr)
+    {
+        count_enqueued_(logger, 0);
+    }
+}
+
+SPDLOG_INLINE char *thread_pool::reserve_record_(shard &target, async_logger *logger, size_t size, async_overflow_policy overflow_policy)
+{
+    char *data = target.arena_q->try_reserve_record(size);
+    if (data != nullptr || overflow_policy == async_overflow_policy::discard_new)
+    {
+        return data;
+    }
+    auto blocked_since = std::chrono::steady_clock::now();
+    if (overflow_policy == async_overflow_policy::block_for)
+    {
+        data = target.arena_q->reserve_record_for(size, logger->block_timeout_);
+        count_timed_block_(logger, blocked_since, data != nullptr);
+        return data;
+    }
+    data = target.arena_q->reserve_record(size);
+    if (collect_stats_)
+    {
+        count_blocked_(logger, blocked_since);
+    }
+    return data;
+}
+
+// the posting logger is alive during the post (it is the caller), so its counters can be updated after the enqueue
+void SPDLOG_INLINE thread_pool::count_enqueued_(async_logger *logger, size_t overrun)
+{
+    stats_.on_enqueued(overrun);
+    logger->stats_.on_enqueued(0);
+}
+
+void SPDLOG_INLINE thread_pool::count_blocked_(async_logger *logger, std::chrono::steady_clock::time_point blocked_since)
+{
+    auto waited = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - blocked_since);
+    stats_.on_blocked(waited);
+    logger->stats_.on_blocked(waited);
+}
+
+// count a message posted with the discard_new/block_for policies
+void SPDLOG_INLINE thread_pool::count_posted_(async_logger *logger, bool enqueued)
+{
+    if (!enqueued)
+    {
+        logger->discarded_.fetch_add(1, std::memory_order_relaxed);
+        if (collect_stats_)
+        {
+            stats_.on_discarded();
+            logger->stats_.on_discarded();
+        }
+    }
+    else if (collect_stats_)
+    {
+        count_enqueued_(logger, 0);
+    }
+}
+
+void SPDLOG_INLINE thread_pool::count_timed_block_(async_logger *logger, std::chrono::steady_clock::time_point blocked_since, bool enqueued)
+{
+    if (!collect_stats_)
+    {
+        return;
+    }
+    count_blocked_(logger, blocked_since);
+    if (!enqueued)
+    {
+        stats_.on_timeout();
+        logger->stats_.on_timeout();
+    }
+}
+
+void SPDLOG_INLINE thread_pool::report_discarded_(shard &my_shard, async_logger *logger)
+{
+    if (logger->discarded_.load(std::memory_order_relaxed) == 0 || my_shard.q->size() > 0)
+    {
+        return;
+    }
+    auto n_msgs = logger->discarded_.exchange(0, std::memory_order_relaxed);
+    if (n_msgs > 0)
+    {
+        logger->backend_report_discarded_(n_msgs);
+    }
+}
+
+#ifdef SPDLOG_USDT
+void SPDLOG_INLINE thread_pool::probe_posted_(const async_logger *logger, async_msg_type msg_type, const log_msg &msg)
+{
+    if (logger != nullptr && msg_type == async_msg_type::log)
+    {
+        SPDLOG_USDT_PROBE3(enqueue, logger->name().c_str(), static_cast<int>(msg.level), details::usdt_time(msg.time));
+    }
+}
+
+// as count_dequeued_(), before processing the messages
+void SPDLOG_INLINE thread_pool::probe_dequeued_(const async_msg *msgs, size_t n_msgs)
+{
+    for (size_t i = 0; i < n_msgs; i++)
+    {
+        const auto &msg = msgs[i];
+        if (msg.worker_raw != nullptr && msg.msg_type == async_msg_type::log)
+        {
+            SPDLOG_USDT_PROBE3(dequeue, msg.worker_raw->name().c_str(), static_cast<int>(msg.level), details::usdt_time(msg.time));
+        }
+    }
+}
+#endif
+
+// must be called before processing the messages - their loggers may be released once processed
+void SPDLOG_INLINE thread_pool::count_dequeued_(const async_msg *msgs, size_t n_msgs)
+{
+    auto now = log_clock::now();
+    for (size_t i = 0; i < n_msgs; i++)
+    {
+        auto *logger = msgs[i].worker_raw;
+        if (logger == nullptr)
+        {
+            continue;
+        }
+        stats_.on_dequeued(1);
+        logger->stats_.on_dequeued(1);
+        if (msgs[i].msg_type == async_msg_type::log || msgs[i].msg_type == async_msg_type::log_batch)
+        {
+            stats_.on_sunk(msgs[i].time, now);
+            logger->stats_.on_sunk(msgs[i].time, now);
+        }
+    }
+}
+
+void SPDLOG_INLINE thread_pool::worker_loop_(shard &my_shard)
+{
+#ifndef SPDLOG_NO_TLS
+    worker_pool_() = this;
+#endif
+    if (my_shard.order)
+    {
+        ordered_worker_loop_(my_shard);
+    }
+    else if (batch_size_ > 1)
+    {
+        std::vector<async_msg> batch(batch_size_);
+        std::vector<details::log_msg> batch_views;
+        batch_views.reserve(batch_size_);
+        while (process_next_batch_(my_shard, batch, batch_views)) {}
+    }
+    else
+    {
+        while (process_next_msg_(my_shard)) {}
+    }
+    // the shared messages posted before the terminate message
+    drain_shared_(my_shard);
+}
+
+// a batch is dequeued with the next ticket, made ready while the other workers write theirs, then written once
+// the batches of the previous tickets were. a worker reaching a barrier passes it (see process_batch_()): the
+// messages posted before it were written in the previous turns.
+void SPDLOG_INLINE thread_pool::ordered_worker_loop_(shard &my_shard)
+{
+    auto &order = *my_shard.order;
+    std::vector<async_msg> batch(batch_size_);
+    std::vector<details::log_msg> batch_views;
+    batch_views.reserve(batch_size_);
+    prepared_batch prepared;
+    for (;;)
+    {
+        size_t n_msgs;
+        uint64_t ticket;
+        {
+            std::lock_guard<std::mutex> lock(order.dequeue_mutex);
+            n_msgs = dequeue_(my_shard, batch.data(), batch.size());
+            if (n_msgs == 0)
+            {
+                continue;
+            }
+            ticket = order.next_ticket++;
+        }
+#ifdef SPDLOG_USDT
+        probe_dequeued_(batch.data(), n_msgs);
+#endif
+        if (collect_stats_)
+        {
+            count_dequeued_(batch.data(), n_msgs);
+        }
+        on_dequeued_(my_shard);
+        prepare_batch_(batch.data(), n_msgs, prepared);
+
+        size_t terminate_msgs;
+        {
+            std::unique_lock<std::mutex> lock(order.turn_mutex);
+            order.turn_cv.wait(lock, [&order, ticket] { return order.turn == ticket; });
+        }
+        {
+            // end the turn even if processing throws
+            struct turn_end
+            {
+                shard_order &order;
+                ~turn_end()
+                {
+                    {
+                        std::lock_guard<std::mutex> lock(order.turn_mutex);
+                        order.turn++;
+                    }
+                    order.turn_cv.notify_all();
+                }
+            } end{order};
+            terminate_msgs = process_batch_(my_shard, batch.data(), n_msgs, batch_views, &prepared);
+        }
+
+        // each terminate message is meant for one worker - give back the extra ones
+        for (size_t i = 1; i < terminate_msgs; i++)
+        {
+            my_shard.q->enqueue(async_msg(async_msg_type::terminate));
+        }
+        if (terminate_msgs > 0)
+        {
+            break;
+        }
+    }
+    drain_shared_(my_shard);
+}
+
+void SPDLOG_INLINE thread_pool::prepare_batch_(const async_msg *batch, size_t n_msgs, prepared_batch &prepared)
+{
+    prepared.reset(n_msgs);
+    if (discarding_.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+    for (size_t i = 0; i < n_msgs; i++)
+    {
+        if (batch[i].msg_type == async_msg_type::log)
+        {
+            batch[i].worker_raw->backend_prepare_(batch[i], prepared, i);
+        }
+    }
+}
+
+void SPDLOG_INLINE thread_pool::wait_barrier_()
+{
+    std::unique_lock<std::mutex> lock(barrier_mutex_);
+    if (--barrier_pending_ == 0)
+    {
+        barrier_generation_++;
+        barrier_cv_.notify_all();
+        return;
+    }
+    // wait for the generation to change - barrier_pending_ may be reset by the next detach
+    // before this thread wakes up
+    auto generation = barrier_generation_;
+    barrier_cv_.wait(lock, [this, generation] { return this->barrier_generation_ != generation; });
+}
+
+// the shard of an elastic worker has no other worker: the barrier is passed once reached
+void SPDLOG_INLINE thread_pool::arrive_barrier_()
+{
+    std::lock_guard<std::mutex> lock(barrier_mutex_);
+    if (--barrier_pending_ == 0)
+    {
+        barrier_generation_++;
+        barrier_cv_.notify_all();
+    }
+}
+
+// serve the shards owned by id: those with messages first, then wait on each in turn. a worker
+// owning several shards that stay backlogged hands its deepest one over to a new worker.
+void SPDLOG_INLINE thread_pool::elastic_worker_loop_(size_t id)
+{
+#ifndef SPDLOG_NO_TLS
+    worker_pool_() = this;
+#endif
+    std::vector<async_msg> batch(batch_size_);
+    std::vector<details::log_msg> batch_views;
+    batch_views.reserve(batch_size_);
+    std::vector<size_t> my_shards;
+    auto serve = [&](size_t k, size_t n_msgs) {
+#ifdef SPDLOG_USDT
+        probe_dequeued_(batch.data(), n_msgs);
+#endif
+        if (collect_stats_)
+        {
+            count_dequeued_(batch.data(), n_msgs);
+        }
+        on_dequeued_(shards_[k]);
+        if (process_batch_(shards_[k], batch.data(), n_msgs, batch_views) > 0)
+        {
+            shard_workers_[k].store(no_worker, std::memory_order_release);
+        }
+    };
+
+    size_t next_wait = 0;
+    auto last_busy = std::chrono::steady_clock::now();
+    auto backlogged_since = last_busy;
+    bool backlogged = false;
+    for (;;)
+    {
+        my_shards.clear();
+        for (size_t k = 0; k < shards_.size(); k++)
+        {
+            if (shard_workers_[k].load(std::memory_order_acquire) == id)
+            {
+                my_shards.push_back(k);
+            }
+        }
+        if (my_shards.empty())
+        {
+            std::lock_guard<std::mutex> lock(elastic_mutex_);
+            running_workers_--;
+            return;
+        }
+
+        size_t processed = 0;
+        for (auto k : my_shards)
+        {
+            auto n_msgs = try_dequeue_(shards_[k], batch.data(), batch.size());
+            if (n_msgs > 0)
+            {
+                serve(k, n_msgs);
+                processed += n_msgs;
+            }
+        }
+        auto now = std::chrono::steady_clock::now();
+        if (processed == 0)
+        {
+            backlogged = false;
+            if (id >= threads_n_ && now - last_busy >= options_.idle_timeout && retire_elastic_worker_(my_shards))
+            {
+                return;
+            }
+            // woken up by a wake message if a shard is handed back to it meanwhile
+            auto k = my_shards[next_wait++ % my_shards.size()];
+            auto timeout = my_shards.size() > 1 ? options_.poll_interval
+                           : id < threads_n_     ? std::chrono::milliseconds(10000)
+                                                 : options_.idle_timeout;
+            auto n_msgs = wait_dequeue_(shards_[k], batch.data(), batch.size(), timeout);
+            if (n_msgs > 0)
+            {
+                serve(k, n_msgs);
+                last_busy = std::chrono::steady_clock::now();
+            }
+            continue;
+        }
+        last_busy = now;
+
+        if (my_shards.size() < 2)
+        {
+            continue;
+        }
+        size_t depth = 0;
+        size_t deepest = my_shards.front();
+        size_t deepest_depth = 0;
+        for (auto k : my_shards)
+        {
+            auto shard_depth = shards_[k].q->size();
+            depth += shard_depth;
+            if (shard_depth > deepest_depth)
+            {
+                deepest = k;
+                deepest_depth = shard_depth;
+            }
+        }
+        if (depth <= scale_up_depth_)
+        {
+            backlogged = false;
+        }
+        else if (!backlogged)
+        {
+            backlogged = true;
+            backlogged_since = now;
+        }
+        else if (now - backlogged_since >= options_.scale_up_delay)
+        {
+            add_elastic_worker_(id, deepest);
+            backlogged = false;
+        }
+    }
+}
+
+SPDLOG_INLINE bool thread_pool::add_elastic_worker_(size_t id, size_t shard_index)
+{
+    std::lock_guard<std::mutex> lock(elastic_mutex_);
+    if (stopping_ || running_workers_ >= max_threads_)
+    {
+        return false;
+    }
+    for (auto &t : retired_threads_)
+    {
+        t.join();
+    }
+    retired_threads_.clear();
+
+    auto new_id = next_worker_id_++;
+    shard_workers_[shard_index].store(new_id, std::memory_order_release);
+    bool started = false;
+    SPDLOG_TRY
+    {
+        threads_.emplace_back([this, new_id] {
+            const auto &options = options_;
+            std::vector<size_t> numa_cpus;
+            if (options.cpu_affinity.empty() && options.numa_node >= 0)
+            {
+                numa_cpus = os::numa_node_cpus(options.numa_node);
+            }
+            // the pool is running: a failed setup can't be reported
+            (void)setup_worker_(options, options.numa_node, numa_cpus, new_id);
+            options.on_thread_start();
+            this->thread_pool::elastic_worker_loop_(new_id);
+        });
+        started = true;
+    }
+    SPDLOG_CATCH_STD
+    if (!started)
+    {
+        // the thread could not be started: keep serving the shard
+        shard_workers_[shard_index].store(id, std::memory_order_release);
+        return false;
+    }
+    running_workers_++;
+    stats_.on_worker_added();
+    return true;
+}
+
+SPDLOG_INLINE bool thread_pool::retire_elastic_worker_(const std::vector<size_t> &my_shards)
+{
+    std::lock_guard<std::mutex> lock(elastic_mutex_);
+    if (stopping_)
+    {
+        return false;
+    }
+    for (auto k : my_shards)
+    {
+        auto home = k % threads_n_;
+        shard_workers_[k].store(home, std::memory_order_release);
+        // the initial worker may be waiting on one of its shards
+        for (size_t j = 0; j < shards_.size(); j++)
+        {
+            if (j != k && shard_workers_[j].load(std::memory_order_relaxed) == home)
+            {
+                shards_[j].q->try_enqueue(async_msg(async_msg_type::wake));
+            }
+        }
+    }
+    auto self = std::find_if(threads_.begin(), threads_.end(), [](const std::thread &t) { return t.get_id() == std::this_thread::get_id(); });
+    if (self != threads_.end())
+    {
+        retired_threads_.push_back(std::move(*self));
+        threads_.erase(self);
+    }
+    running_workers_--;
+    stats_.on_worker_retired();
+    return true;
+}
+
+size_t SPDLOG_INLINE thread_pool::dequeue_(shard &my_shard, async_msg *items, size_t max_items)
+{
+    if (options_.work_stealing)
+    {
+        auto n_items = try_dequeue_(my_shard, items, max_items);
+        if (n_items == 0)
+        {
+            n_items = steal_(my_shard, items, max_items);
+        }
+        return n_items > 0 ? n_items : wait_dequeue_(my_shard, items, max_items, options_.poll_interval);
+    }
+
+    if (wait_strategy_ == async_wait_strategy::busy_spin)
+    {
+        size_t n_items;
+        while ((n_items = try_dequeue_(my_shard, items, max_items)) == 0)
+        {
+            os::cpu_relax();
+        }
+        return n_items;
+    }
+
+    if (wait_strategy_ == async_wait_strategy::spin_yield_park)
+    {
+        for (size_t i = 0; i < spin_count_ + yield_count_; i++)
+        {
+            auto n_items = try_dequeue_(my_shard, items, max_items);
+            if (n_items > 0)
+            {
+                return n_items;
+            }
+            if (i < spin_count_)
+            {
+                os::cpu_relax();
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+    if (my_shard.priority_q)
+    {
+        auto n_items = my_shard.priority_q->try_dequeue_bulk(items, max_items);
+        if (n_items > 0)
+        {
+            return n_items;
+        }
+    }
+    // woken up by a wake message if a priority message is posted meanwhile
+    return wait_dequeue_(my_shard, items, max_items, std::chrono::seconds(10));
+}
+
+size_t SPDLOG_INLINE thread_pool::wait_dequeue_(shard &my_shard, async_msg *items, size_t max_items, std::chrono::milliseconds timeout)
+{
+    if (my_shard.spill_q && spill_pending_of_(my_shard).load(std::memory_order_acquire) > 0)
+    {
+        // the posts to the spill queue don't wake up the workers waiting on the regular one
+        auto n_items = my_shard.q->try_dequeue_bulk(items, max_items);
+        return n_items > 0 ? n_items : dequeue_spilled_(my_shard, items, max_items, std::chrono::milliseconds(1));
+    }
+    return my_shard.q->dequeue_bulk_for(items, max_items, timeout);
+}
+
+size_t SPDLOG_INLINE thread_pool::dequeue_spilled_(
+    shard &my_shard, async_msg *items, size_t max_items, std::chrono::milliseconds wait_duration)
+{
+    auto &pending = spill_pending_of_(my_shard);
+    if (pending.load(std::memory_order_acquire) == 0)
+    {
+        return 0;
+    }
+    auto n_items = wait_duration.count() > 0 ? my_shard.spill_q->dequeue_bulk_for(items, max_items, wait_duration)
+                                             : my_shard.spill_q->try_dequeue_bulk(items, max_items);
+    if (n_items > 0)
+    {
+        pending.fetch_sub(n_items, std::memory_order_acq_rel);
+    }
+    return n_items;
+}
+
+size_t SPDLOG_INLINE thread_pool::try_dequeue_(shard &my_shard, async_msg *items, size_t max_items)
+{
+    if (my_shard.priority_q)
+    {
+        auto n_items = my_shard.priority_q->try_dequeue_bulk(items, max_items);
+        if (n_items > 0)
+        {
+            return n_items;
+        }
+    }
+    auto n_items = my_shard.q->try_dequeue_bulk(items, max_items);
+    if (n_items == 0 && my_shard.spill_q)
+    {
+        n_items = dequeue_spilled_(my_shard, items, max_items, std::chrono::milliseconds(0));
+    }
+    if (n_items == 0 && my_shard.shared_q)
+    {
+        n_items = my_shard.shared_q->try_dequeue_bulk(items, max_items);
+    }
+    return n_items;
+}
+
+// from the next shards first, so that the idle workers don't all steal from the same one
+size_t SPDLOG_INLINE thread_pool::steal_(shard &my_shard, async_msg *items, size_t max_items)
+{
+    auto my_index = static_cast<size_t>(&my_shard - shards_.data());
+    for (size_t i = 1; i < shards_.size(); i++)
+    {
+        auto &victim = shards_[(my_index + i) % shards_.size()];
+        auto n_items = victim.shared_q->try_dequeue_bulk(items, max_items);
+        if (n_items > 0)
+        {
+            stats_.on_stolen(n_items);
+            return n_items;
+        }
+    }
+    return 0;
+}
+
+// process the messages left in the priority queue (before a barrier). a message of the detached logger
+// may have been posted there before the barrier, while this worker was already waiting on the regular queue.
+void SPDLOG_INLINE thread_pool::drain_priority_(shard &my_shard)
+{
+    if (!my_shard.priority_q)
+    {
+        return;
+    }
+    async_msg incoming_async_msg;
+    while (my_shard.priority_q->try_dequeue_bulk(&incoming_async_msg, 1) == 1)
+    {
+        if (collect_stats_)
+        {
+            count_dequeued_(&incoming_async_msg, 1);
+        }
+        process_msg_(my_shard, incoming_async_msg);
+        incoming_async_msg.worker_ptr.reset();
+    }
+}
+
+// process the messages left in the shared queue, before a barrier or exiting: the other
+// workers may not steal them before.
+void SPDLOG_INLINE thread_pool::drain_shared_(shard &my_shard)
+{
+    if (!my_shard.shared_q)
+    {
+        return;
+    }
+    async_msg incoming_async_msg;
+    while (my_shard.shared_q->try_dequeue_bulk(&incoming_async_msg, 1) == 1)
+    {
+        if (collect_stats_)
+        {
+            count_dequeued_(&incoming_async_msg, 1);
+        }
+        process_msg_(my_shard, incoming_async_msg);
+        incoming_async_msg.worker_ptr.reset();
+    }
+}
+
+// process next message in the queue
+// return true if this thread should still be active (while no terminate msg
+// was received)
+bool SPDLOG_INLINE thread_pool::process_next_msg_(shard &my_shard)
+{
+    async_msg incoming_async_msg;
+    // 同样的，对于出队操作，已经在队列内部进行了加锁操作，所以外面调用的时候不需要加锁
+    bool dequeued = dequeue_(my_shard, &incoming_async_msg, 1) == 1;
+    if (!dequeued)
+    {
+        return true;
+    }
+#ifdef SPDLOG_USDT
+    probe_dequeued_(&incoming_async_msg, 1);
+#endif
+    if (collect_stats_)
+    {
+        count_dequeued_(&incoming_async_msg, 1);
+    }
+    on_dequeued_(my_shard);
+    return process_msg_(my_shard, incoming_async_msg);
+}
+
+bool SPDLOG_INLINE thread_pool::process_msg_(shard &my_shard, async_msg &incoming_async_msg)
+{
+    switch (incoming_async_msg.msg_type)
+    {
+    case async_msg_type::log: {
+        if (discarding_.load(std::memory_order_relaxed))
+        {
+            return true;
+        }
+        if (incoming_async_msg.format_fn != nullptr)
+        {
+            incoming_async_msg.worker_raw->backend_sink_deferred_(incoming_async_msg);
+        }
+        else
+        {
+            incoming_async_msg.worker_raw->backend_sink_it_(incoming_async_msg);
+        }
+        report_discarded_(my_shard, incoming_async_msg.worker_raw);
+        return true;
+    }
+    case async_msg_type::log_batch: {
+        if (!discarding_.load(std::memory_order_relaxed))
+        {
+            incoming_async_msg.worker_raw->backend_sink_lines_(incoming_async_msg);
+            report_discarded_(my_shard, incoming_async_msg.worker_raw);
+        }
+        return true;
+    }
+    case async_msg_type::flush: {
+        report_discarded_(my_shard, incoming_async_msg.worker_raw);
+        incoming_async_msg.worker_raw->backend_flush_();
+        return true;
+    }
+
+    case async_msg_type::flush_sync: {
+        incoming_async_msg.worker_raw->backend_flush_();
+        incoming_async_msg.flush_completion()->done();
+        return true;
+    }
+
+    case async_msg_type::flush_batch: {
+        flush_batch_(incoming_async_msg.flush_batch());
+        return true;
+    }
+
+    case async_msg_type::barrier: {
+        drain_priority_(my_shard);
+        drain_shared_(my_shard);
+        wait_barrier_();
+        return true;
+    }
+
+    case async_msg_type::wake: {
+        return true;
+    }
+
+    case async_msg_type::terminate: {
+        return false;
+    }
+
+    default: {
+        assert(false);
+    }
+    }
+
+    return true;
+}
+
+void SPDLOG_INLINE thread_pool::flush_batch_(async_flush_batch *batch)
+{
+    if (batch->pending.fetch_sub(1, std::memory_order_acq_rel) != 1)
+    {
+        return;
+    }
+    // the sinks shared by several loggers are flushed once
+    std::vector<const sinks::sink *> flushed;
+    for (auto *logger : batch->loggers)
+    {
+        logger->backend_flush_(&flushed);
+    }
+    batch->promise.set_value();
+    delete batch;
+}
+
+// process up to batch.size() messages in the queue
+// return true if this thread should still be active (while no terminate msg
+// was received)
+bool SPDLOG_INLINE thread_pool::process_next_batch_(shard &my_shard, std::vector<async_msg> &batch, std::vector<details::log_msg> &batch_views)
+{
+    size_t n_msgs = dequeue_(my_shard, batch.data(), batch.size());
+#ifdef SPDLOG_USDT
+    probe_dequeued_(batch.data(), n_msgs);
+#endif
+    if (collect_stats_)
+    {
+        count_dequeued_(batch.data(), n_msgs);
+    }
+    if (n_msgs > 0)
+    {
+        on_dequeued_(my_shard);
+    }
+    auto terminate_msgs = process_batch_(my_shard, batch.data(), n_msgs, batch_views);
+
+    // each terminate message is meant for one worker - give back the extra ones
+    for (size_t i = 1; i < terminate_msgs; i++)
+    {
+        my_shard.q->enqueue(async_msg(async_msg_type::terminate));
+    }
+    return terminate_msgs == 0;
+}
+
+size_t SPDLOG_INLINE thread_pool::process_batch_(
+    shard &my_shard, async_msg *batch, size_t n_msgs, std::vector<details::log_msg> &batch_views, const prepared_batch *prepared)
+{
+    size_t terminate_msgs = 0;
+    bool barrier_reached = false;
+    size_t i = 0;
+    while (i < n_msgs)
+    {
+        auto &incoming_async_msg = batch[i];
+        switch (incoming_async_msg.msg_type)
+        {
+        case async_msg_type::log: {
+            if (discarding_.load(std::memory_order_relaxed))
+            {
+                break;
+            }
+            if (prepared != nullptr && prepared->ready(i))
+            {
+                incoming_async_msg.worker_raw->backend_sink_prepared_(incoming_async_msg, *prepared, i);
+                report_discarded_(my_shard, incoming_async_msg.worker_raw);
+                break;
+            }
+            if (incoming_async_msg.format_fn != nullptr)
+            {
+                incoming_async_msg.worker_raw->backend_sink_deferred_(incoming_async_msg);
+                report_discarded_(my_shard, incoming_async_msg.worker_raw);
+                break;
+            }
+            // pass consecutive (already formatted) messages of the same logger as a single batch
+            auto *logger = incoming_async_msg.worker_raw;
+            batch_views.clear();
+            while (i < n_msgs && batch[i].msg_type == async_msg_type::log && batch[i].worker_raw == logger && batch[i].format_fn == nullptr &&
+                   (prepared == nullptr || !prepared->ready(i)))
+            {
+                batch_views.push_back(batch[i]);
+                i++;
+            }
+            if (batch_views.size() == 1)
+            {
+                logger->backend_sink_it_(batch_views.front());
+            }
+            else
+            {
+                logger->backend_sink_batch_(batch_views.data(), batch_views.size());
+            }
+            report_discarded_(my_shard, logger);
+            continue;
+        }
+        case async_msg_type::log_batch: {
+            if (!discarding_.load(std::memory_order_relaxed))
+            {
+                incoming_async_msg.worker_raw->backend_sink_lines_(incoming_async_msg);
+                report_discarded_(my_shard, incoming_async_msg.worker_raw);
+            }
+            break;
+        }
+        case async_msg_type::flush: {
+            report_discarded_(my_shard, incoming_async_msg.worker_raw);
+            incoming_async_msg.worker_raw->backend_flush_();
+            break;
+        }
+
+        case async_msg_type::flush_sync: {
+            incoming_async_msg.worker_raw->backend_flush_();
+            incoming_async_msg.flush_completion()->done();
+            break;
+        }
+
+        case async_msg_type::flush_batch: {
+            flush_batch_(incoming_async_msg.flush_batch());
+            break;
+        }
+
+        case async_msg_type::wake: {
+            break;
+        }
+
+        case async_msg_type::barrier: {
+            if (elastic_)
+            {
+                drain_priority_(my_shard);
+                arrive_barrier_();
+                break;
+            }
+            if (my_shard.order)
+            {
+                // in turn: the messages posted before were written
+                drain_priority_(my_shard);
+                drain_shared_(my_shard);
+                arrive_barrier_();
+                break;
+            }
+            // each barrier message is meant for one worker - give back the extra ones
+            // before waiting, so the other workers can reach the barrier too.
+            if (!barrier_reached)
+            {
+                barrier_reached = true;
+                for (size_t j = i + 1; j < n_msgs; j++)
+                {
+                    if (batch[j].msg_type == async_msg_type::barrier)
+                    {
+                        my_shard.q->enqueue(async_msg(async_msg_type::barrier));
+                    }
+                }
+                drain_priority_(my_shard);
+                drain_shared_(my_shard);
+                wait_barrier_();
+            }
+            break;
+        }
+
+        case async_msg_type::terminate: {
+            terminate_msgs++;
+            break;
+        }
+
+        default: {
+            assert(false);
+        }
+        }
+        i++;
+    }
+
+    // release the loggers held by the processed messages
+    for (i = 0; i < n_msgs; i++)
+    {
+        batch[i].worker_ptr.reset();
+    }
+    return terminate_msgs;
 }
 
 } // namespace details
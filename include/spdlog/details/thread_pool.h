@@ -3,13 +3,33 @@
 
 #pragma once
 
+#include <spdlog/async_logger.h>
+#include <spdlog/details/async_stats.h>
+#include <spdlog/details/crash_dump.h>
+#include <spdlog/details/deferred_format.h>
+#include <spdlog/details/log_lines.h>
 #include <spdlog/details/log_msg_buffer.h>
+#include <spdlog/details/intern_table.h>
+#include <spdlog/details/mpmc_arena_q.h>
+#include <spdlog/details/prepared_batch.h>
 #include <spdlog/details/mpmc_blocking_q.h>
+#include <spdlog/details/mpmc_lockfree_q.h>
+#include <spdlog/details/spsc_lanes_q.h>
+#include <spdlog/details/usdt.h>
 #include <spdlog/details/os.h>
 
+#include <algorithm>
 #include <chrono>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <future>
 #include <memory>
+#include <mutex>
+#include <new>
+#include <string>
 #include <thread>
+#include <unordered_set>
 #include <vector>
 #include <functional>
 
@@ -24,7 +44,62 @@ enum class async_msg_type
 {
     log,
     flush,
-    terminate
+    terminate,
+    barrier,    // sent to each worker by thread_pool::detach_logger(..)
+    flush_sync, // flush, then complete its async_flush_completion
+    wake,       // no-op, wakes a parked worker up to drain its priority queue
+    flush_batch, // flush the loggers of an async_flush_batch, each of their sinks once
+    log_batch    // the lines of logger::log_lines(): their text as payload, their details::log_line entries in extra()
+};
+
+// Completion of the flush_sync messages of a flush request (one per shard with numa shards).
+// the worker processing the last of them fulfills the promise (or calls on_done if set) and deletes the completion.
+struct async_flush_completion
+{
+    explicit async_flush_completion(size_t n_msgs, std::function<void()> on_flushed = nullptr)
+        : pending{n_msgs}
+        , on_done{std::move(on_flushed)}
+    {}
+
+    std::atomic<size_t> pending;
+    std::promise<void> promise;
+    std::function<void()> on_done;
+
+    void done()
+    {
+        if (pending.fetch_sub(1, std::memory_order_acq_rel) != 1)
+        {
+            return;
+        }
+        if (!on_done)
+        {
+            promise.set_value();
+            delete this;
+            return;
+        }
+        auto fn = std::move(on_done);
+        delete this;
+        SPDLOG_TRY
+        {
+            fn();
+        }
+        SPDLOG_CATCH_STD
+    }
+};
+
+// The loggers flushed by the flush_batch messages of thread_pool::post_flush_batch() (one per shard).
+// the worker processing the last of them flushes the loggers, fulfills the promise and deletes the batch.
+struct async_flush_batch
+{
+    explicit async_flush_batch(size_t n_msgs)
+        : pending{n_msgs}
+    {}
+
+    std::vector<async_logger *> loggers;
+    // keeps the loggers not attached to the pool alive
+    std::vector<async_logger_ptr> owned;
+    std::atomic<size_t> pending;
+    std::promise<void> promise;
 };
 
 // Async msg to move to/from the queue
@@ -33,6 +108,11 @@ struct async_msg : log_msg_buffer
 {
     async_msg_type msg_type{async_msg_type::log};
     async_logger_ptr worker_ptr;
+    // the logger to process the message with. it is kept alive either by worker_ptr or,
+    // for loggers attached to the pool (see thread_pool_options::pin_loggers), by the logger itself.
+    async_logger *worker_raw{nullptr};
+    // set if the payload is the format string of the args kept in extra() (see deferred_format.h)
+    deferred_format_fn format_fn{nullptr};
 
     async_msg() = default;
     ~async_msg() = default;
@@ -46,6 +126,8 @@ struct async_msg : log_msg_buffer
         : log_msg_buffer(std::move(other))
         , msg_type(other.msg_type)
         , worker_ptr(std::move(other.worker_ptr))
+        , worker_raw(other.worker_raw)
+        , format_fn(other.format_fn)
     {}
 
     async_msg &operator=(async_msg &&other)
@@ -53,6 +135,8 @@ struct async_msg : log_msg_buffer
         *static_cast<log_msg_buffer *>(this) = std::move(other);
         msg_type = other.msg_type;
         worker_ptr = std::move(other.worker_ptr);
+        worker_raw = other.worker_raw;
+        format_fn = other.format_fn;
         return *this;
     }
 #else // (_MSC_VER) && _MSC_VER <= 1800
@@ -60,24 +144,592 @@ struct async_msg : log_msg_buffer
     async_msg &operator=(async_msg &&) = default;
 #endif
 
-    // construct from log_msg with given type
-    async_msg(async_logger_ptr &&worker, async_msg_type the_type, const details::log_msg &m)
-        : log_msg_buffer{m}
+    // construct from log_msg with given type.
+    // reference_name: m.logger_name is the worker's name, which outlives the message (not copied)
+    async_msg(async_logger_ptr &&worker, async_msg_type the_type, const details::log_msg &m, bool reference_name = false)
+        : log_msg_buffer{m, string_view_t{}, reference_name}
+        , msg_type{the_type}
+        , worker_ptr{std::move(worker)}
+        , worker_raw{worker_ptr.get()}
+    {}
+
+    // construct from log_msg of an attached logger (no shared ownership)
+    async_msg(async_logger *worker, async_msg_type the_type, const details::log_msg &m, bool reference_name = false)
+        : log_msg_buffer{m, string_view_t{}, reference_name}
         , msg_type{the_type}
+        , worker_raw{worker}
+    {}
+
+    // construct from an unformatted log_msg and its captured format args
+    async_msg(async_logger_ptr &&worker, async_logger *raw_worker, const details::log_msg &m, deferred_format_fn the_format_fn,
+        string_view_t format_args, bool reference_name = false)
+        : log_msg_buffer{m, format_args, reference_name}
+        , msg_type{async_msg_type::log}
+        , worker_ptr{std::move(worker)}
+        , worker_raw{raw_worker}
+        , format_fn{the_format_fn}
+    {}
+
+    // log_batch message - the lines are kept in extra() (see details::foreach_log_line())
+    async_msg(async_logger_ptr &&worker, async_logger *raw_worker, const details::log_msg &m, string_view_t lines, bool reference_name = false)
+        : log_msg_buffer{m, lines, reference_name}
+        , msg_type{async_msg_type::log_batch}
         , worker_ptr{std::move(worker)}
+        , worker_raw{raw_worker}
     {}
 
+    // control messages (flush/terminate) are stamped too, so backends that order
+    // messages by time keep them behind the messages posted before them
     async_msg(async_logger_ptr &&worker, async_msg_type the_type)
         : log_msg_buffer{}
         , msg_type{the_type}
         , worker_ptr{std::move(worker)}
-    {}
+        , worker_raw{worker_ptr.get()}
+    {
+        time = os::now();
+    }
+
+    async_msg(async_logger *worker, async_msg_type the_type)
+        : log_msg_buffer{}
+        , msg_type{the_type}
+        , worker_raw{worker}
+    {
+        time = os::now();
+    }
+
+    // flush_sync message - the address of the completion is kept in extra(). worker_ptr may be empty for attached loggers.
+    async_msg(async_logger_ptr &&worker, async_logger *raw_worker, async_flush_completion *completion)
+        : log_msg_buffer{log_msg{}, string_view_t{reinterpret_cast<const char *>(&completion), sizeof(completion)}}
+        , msg_type{async_msg_type::flush_sync}
+        , worker_ptr{std::move(worker)}
+        , worker_raw{raw_worker}
+    {
+        time = os::now();
+    }
+
+    async_flush_completion *flush_completion() const
+    {
+        async_flush_completion *completion = nullptr;
+        std::memcpy(&completion, extra().data(), sizeof(completion));
+        return completion;
+    }
+
+    // flush_batch message - the address of the batch is kept in extra()
+    explicit async_msg(async_flush_batch *batch)
+        : log_msg_buffer{log_msg{}, string_view_t{reinterpret_cast<const char *>(&batch), sizeof(batch)}}
+        , msg_type{async_msg_type::flush_batch}
+    {
+        time = os::now();
+    }
+
+    async_flush_batch *flush_batch() const
+    {
+        async_flush_batch *batch = nullptr;
+        std::memcpy(&batch, extra().data(), sizeof(batch));
+        return batch;
+    }
 
     explicit async_msg(async_msg_type the_type)
-        : async_msg{nullptr, the_type}
+        : async_msg{async_logger_ptr{}, the_type}
     {}
 };
 
+// the queues never overrun the control messages: their senders wait for them (flush completions, barriers)
+// or the workers need them to stop.
+template<>
+struct async_queue_item<async_msg>
+{
+    static bool overrunnable(const async_msg &item)
+    {
+        return overrunnable(item.msg_type);
+    }
+
+    static bool overrunnable(async_msg_type msg_type)
+    {
+        return msg_type == async_msg_type::log || msg_type == async_msg_type::log_batch || msg_type == async_msg_type::wake;
+    }
+};
+
+// Queue implementation used by the thread pool
+enum class async_queue_backend
+{
+    blocking,        // mutex protected circular queue (mpmc_blocking_queue)
+    lock_free,       // lock-free bounded queue (mpmc_lockfree_queue)
+    per_thread_lanes, // spsc lane per producer thread, merged by log time (spsc_lanes_queue)
+    arena             // variable length records in one contiguous byte arena (mpmc_arena_queue)
+};
+
+// How an idle worker waits for new messages
+enum class async_wait_strategy
+{
+    blocking,        // park on the queue's condition variable right away
+    spin_yield_park, // spin, then yield the cpu, then park (see thread_pool_options spin/yield counts)
+    busy_spin        // never park - for latency critical workers pinned to dedicated cores
+};
+
+// Order in which the per thread lanes are merged
+struct async_msg_time_order
+{
+    bool operator()(const async_msg &lhs, const async_msg &rhs) const
+    {
+        return lhs.time < rhs.time;
+    }
+};
+
+// What gets encoded into an arena record - lets the thread pool write a log_msg
+// directly into the arena without building an async_msg first
+struct async_msg_record
+{
+    async_msg_type msg_type;
+    async_logger_ptr worker_ptr;
+    async_logger *worker_raw;
+    const log_msg &msg;
+    deferred_format_fn format_fn;
+    string_view_t format_args;
+    // msg.logger_name is the worker's name (see async_msg), encoded as a pointer
+    bool reference_name;
+    // the message moved to the heap when too large for a record of the arena (see async_msg_arena_codec::box())
+    std::unique_ptr<async_msg> on_heap;
+};
+
+// Codec of the arena backend: a compact header holding the message fields, followed by the source location and
+// the trace context (if any), the logger name (unless referenced), the key/value and mdc fields and their
+// strings, the format args, and the payload bytes (unless interned) - last, so that a message can be formatted
+// straight into its record (see encode_formatted()). The sizes are 32 bits: the arena is at most 4 GiB.
+// A message too large for the arena is kept on the heap, its record holding the header and a pointer to it.
+struct async_msg_arena_codec
+{
+    enum : uint8_t
+    {
+        has_source = 1,
+        has_trace = 2,
+        on_heap = 4
+    };
+
+    struct header
+    {
+        async_logger_ptr worker_ptr;
+        async_logger *worker_raw;
+        deferred_format_fn format_fn;
+        const char *logger_name_ref; // nullptr if the name is copied
+        log_clock::time_point time;
+        size_t thread_id;
+        uint32_t logger_name_size;
+        uint32_t payload_size;
+        uint32_t payload_id;
+        uint32_t sample_rate;
+        uint32_t n_fields;
+        uint32_t n_mdc_fields;
+        uint32_t fields_text_size;
+        uint32_t format_args_size;
+        uint8_t msg_type;
+        uint8_t level;
+        uint8_t extensions; // has_source | has_trace | on_heap
+    };
+
+    static bool stores_source(const log_msg &msg)
+    {
+        return !msg.source.empty() || msg.source.filename != nullptr || msg.source.funcname != nullptr;
+    }
+
+    static uint8_t extensions(const log_msg &msg)
+    {
+        return static_cast<uint8_t>((stores_source(msg) ? has_source : 0) | (msg.trace.empty() ? 0 : has_trace));
+    }
+
+    static size_t extensions_size(const log_msg &msg)
+    {
+        return (stores_source(msg) ? sizeof(source_loc) : 0) + (msg.trace.empty() ? 0 : sizeof(trace_context));
+    }
+
+    static size_t fields_text_size(const field *fields, size_t n_fields)
+    {
+        size_t size = 0;
+        for (size_t i = 0; i < n_fields; i++)
+        {
+            size += fields[i].key.size() + fields[i].string_value.size();
+        }
+        return size;
+    }
+
+    static size_t fields_text_size(const log_msg &msg)
+    {
+        return fields_text_size(msg.fields, msg.n_fields) + fields_text_size(msg.mdc_fields, msg.n_mdc_fields);
+    }
+
+    // the fields (unaligned, their string views are restored on decode) followed by their strings
+    static char *encode_fields(const field *fields, size_t n_fields, char *data)
+    {
+        if (n_fields > 0)
+        {
+            std::memcpy(data, fields, n_fields * sizeof(field));
+            data += n_fields * sizeof(field);
+            for (size_t i = 0; i < n_fields; i++)
+            {
+                data = std::copy(fields[i].key.begin(), fields[i].key.end(), data);
+                data = std::copy(fields[i].string_value.begin(), fields[i].string_value.end(), data);
+            }
+        }
+        return data;
+    }
+
+    static const char *decode_fields(const char *data, field *fields, size_t n_fields)
+    {
+        if (n_fields > 0)
+        {
+            std::memcpy(static_cast<void *>(fields), data, n_fields * sizeof(field));
+            data += n_fields * sizeof(field);
+            for (size_t i = 0; i < n_fields; i++)
+            {
+                auto &f = fields[i];
+                f.key = string_view_t(data, f.key.size());
+                data += f.key.size();
+                f.string_value = string_view_t(data, f.string_value.size());
+                data += f.string_value.size();
+            }
+        }
+        return data;
+    }
+
+    static size_t buffered_payload_size(const log_msg &msg)
+    {
+        return msg.payload_id == 0 ? msg.payload.size() : 0;
+    }
+
+    static size_t encoded_size(const log_msg &msg, size_t format_args_size, bool reference_name)
+    {
+        return payload_offset(msg, format_args_size, reference_name) + buffered_payload_size(msg);
+    }
+
+    // offset of the payload bytes in the record
+    static size_t payload_offset(const log_msg &msg, size_t format_args_size, bool reference_name)
+    {
+        auto n_fields = msg.n_fields + msg.n_mdc_fields;
+        auto name_size = reference_name ? 0 : msg.logger_name.size();
+        return sizeof(header) + extensions_size(msg) + name_size + n_fields * sizeof(field) + fields_text_size(msg) + format_args_size;
+    }
+
+    static size_t encoded_size(const async_msg_record &rec)
+    {
+        if (rec.on_heap)
+        {
+            return sizeof(header) + sizeof(async_msg *);
+        }
+        return encoded_size(rec.msg, rec.format_args.size(), rec.reference_name);
+    }
+
+    // move the message of rec to the heap, so that its record takes a pointer only
+    static void box(async_msg_record &rec)
+    {
+        if (rec.format_fn != nullptr)
+        {
+            rec.on_heap.reset(
+                new async_msg(std::move(rec.worker_ptr), rec.worker_raw, rec.msg, rec.format_fn, rec.format_args, rec.reference_name));
+        }
+        else if (rec.msg_type == async_msg_type::log_batch)
+        {
+            rec.on_heap.reset(new async_msg(std::move(rec.worker_ptr), rec.worker_raw, rec.msg, rec.format_args, rec.reference_name));
+        }
+        else
+        {
+            rec.on_heap.reset(new async_msg(std::move(rec.worker_ptr), rec.msg_type, rec.msg, rec.reference_name));
+            rec.on_heap->worker_raw = rec.worker_raw;
+        }
+    }
+
+    static size_t encoded_size(const async_msg &msg)
+    {
+        return encoded_size(msg, msg.extra().size(), msg.references_logger_name());
+    }
+
+    static void encode(char *dest, async_msg_record &&rec)
+    {
+        if (rec.on_heap)
+        {
+            new (dest) header{async_logger_ptr{}, rec.worker_raw, nullptr, nullptr, rec.msg.time, rec.msg.thread_id, 0, 0, 0, 0, 0, 0, 0,
+                0, static_cast<uint8_t>(rec.msg_type), static_cast<uint8_t>(rec.msg.level), on_heap};
+            auto *msg = rec.on_heap.release();
+            std::memcpy(dest + sizeof(header), &msg, sizeof(msg));
+            return;
+        }
+        char *payload = encode_formatted(dest, std::move(rec), buffered_payload_size(rec.msg));
+        if (rec.msg.payload_id == 0)
+        {
+            std::copy(rec.msg.payload.begin(), rec.msg.payload.end(), payload);
+        }
+    }
+
+    // encode everything but the payload bytes, of the given size. return where to write them.
+    static char *encode_formatted(char *dest, async_msg_record &&rec, size_t payload_size)
+    {
+        new (dest) header{
+            std::move(rec.worker_ptr),
+            rec.worker_raw,
+            rec.format_fn,
+            rec.reference_name ? rec.msg.logger_name.data() : nullptr,
+            rec.msg.time,
+            rec.msg.thread_id,
+            static_cast<uint32_t>(rec.msg.logger_name.size()),
+            static_cast<uint32_t>(payload_size),
+            rec.msg.payload_id,
+            rec.msg.sample_rate,
+            static_cast<uint32_t>(rec.msg.n_fields),
+            static_cast<uint32_t>(rec.msg.n_mdc_fields),
+            static_cast<uint32_t>(fields_text_size(rec.msg)),
+            static_cast<uint32_t>(rec.format_args.size()),
+            static_cast<uint8_t>(rec.msg_type),
+            static_cast<uint8_t>(rec.msg.level),
+            extensions(rec.msg),
+        };
+        char *data = dest + sizeof(header);
+        if (stores_source(rec.msg))
+        {
+            std::memcpy(data, &rec.msg.source, sizeof(source_loc));
+            data += sizeof(source_loc);
+        }
+        if (!rec.msg.trace.empty())
+        {
+            std::memcpy(data, &rec.msg.trace, sizeof(trace_context));
+            data += sizeof(trace_context);
+        }
+        if (!rec.reference_name)
+        {
+            data = std::copy(rec.msg.logger_name.begin(), rec.msg.logger_name.end(), data);
+        }
+        data = encode_fields(rec.msg.fields, rec.msg.n_fields, data);
+        data = encode_fields(rec.msg.mdc_fields, rec.msg.n_mdc_fields, data);
+        return std::copy(rec.format_args.begin(), rec.format_args.end(), data);
+    }
+
+    static void encode(char *dest, async_msg &&msg)
+    {
+        encode(dest, async_msg_record{msg.msg_type, std::move(msg.worker_ptr), msg.worker_raw, msg, msg.format_fn, msg.extra(),
+                             msg.references_logger_name(), nullptr});
+    }
+
+    static void decode(char *src, async_msg &item)
+    {
+        auto *h = reinterpret_cast<header *>(src);
+        const char *data = src + sizeof(header);
+        if ((h->extensions & on_heap) != 0)
+        {
+            std::unique_ptr<async_msg> msg(heap_msg_(src));
+            item = std::move(*msg);
+            h->~header();
+            return;
+        }
+        source_loc source;
+        if ((h->extensions & has_source) != 0)
+        {
+            std::memcpy(static_cast<void *>(&source), data, sizeof(source_loc));
+            data += sizeof(source_loc);
+        }
+        trace_context trace{};
+        if ((h->extensions & has_trace) != 0)
+        {
+            std::memcpy(&trace, data, sizeof(trace_context));
+            data += sizeof(trace_context);
+        }
+        bool reference_name = h->logger_name_ref != nullptr;
+        string_view_t logger_name(reference_name ? h->logger_name_ref : data, h->logger_name_size);
+        if (!reference_name)
+        {
+            data += h->logger_name_size;
+        }
+        // the fields, then the mdc fields
+        std::vector<field> fields(h->n_fields + h->n_mdc_fields);
+        data = decode_fields(data, fields.data(), h->n_fields);
+        data = decode_fields(data, fields.data() + h->n_fields, h->n_mdc_fields);
+        string_view_t format_args(data, h->format_args_size);
+        data += h->format_args_size;
+        string_view_t payload;
+        if (h->payload_id != 0)
+        {
+            payload = intern_table::instance().fragment(h->payload_id);
+        }
+        else
+        {
+            payload = string_view_t(data, h->payload_size);
+        }
+        log_msg msg(h->time, source, logger_name, static_cast<level::level_enum>(h->level), payload);
+        msg.thread_id = h->thread_id;
+        msg.payload_id = h->payload_id;
+        msg.sample_rate = h->sample_rate;
+        msg.trace = trace;
+        if (h->n_fields > 0)
+        {
+            msg.fields = fields.data();
+            msg.n_fields = h->n_fields;
+        }
+        // not the context of the worker thread
+        msg.mdc_fields = h->n_mdc_fields > 0 ? fields.data() + h->n_fields : nullptr;
+        msg.n_mdc_fields = h->n_mdc_fields;
+
+        if (h->format_fn != nullptr)
+        {
+            item = async_msg(std::move(h->worker_ptr), h->worker_raw, msg, h->format_fn, format_args, reference_name);
+        }
+        else if (h->msg_type == static_cast<uint8_t>(async_msg_type::log_batch))
+        {
+            item = async_msg(std::move(h->worker_ptr), h->worker_raw, msg, format_args, reference_name);
+        }
+        else if (h->msg_type == static_cast<uint8_t>(async_msg_type::flush_sync))
+        {
+            async_flush_completion *completion = nullptr;
+            std::memcpy(&completion, format_args.data(), sizeof(completion));
+            item = async_msg(std::move(h->worker_ptr), h->worker_raw, completion);
+        }
+        else if (h->msg_type == static_cast<uint8_t>(async_msg_type::flush_batch))
+        {
+            async_flush_batch *batch = nullptr;
+            std::memcpy(&batch, format_args.data(), sizeof(batch));
+            item = async_msg(batch);
+        }
+        else
+        {
+            item = async_msg(std::move(h->worker_ptr), static_cast<async_msg_type>(h->msg_type), msg, reference_name);
+            item.worker_raw = h->worker_raw;
+        }
+        h->~header();
+    }
+
+    static void discard(char *src)
+    {
+        auto *h = reinterpret_cast<header *>(src);
+        if ((h->extensions & on_heap) != 0)
+        {
+            delete heap_msg_(src);
+        }
+        h->~header();
+    }
+
+    static bool overrunnable(const char *src)
+    {
+        return async_queue_item<async_msg>::overrunnable(static_cast<async_msg_type>(reinterpret_cast<const header *>(src)->msg_type));
+    }
+
+private:
+    static async_msg *heap_msg_(const char *src)
+    {
+        async_msg *msg = nullptr;
+        std::memcpy(&msg, src + sizeof(header), sizeof(msg));
+        return msg;
+    }
+};
+
+// Construction options of the thread pool
+struct thread_pool_options
+{
+    async_queue_backend queue_backend = async_queue_backend::blocking;
+    std::function<void()> on_thread_start = [] {};
+    // max number of messages a worker drains from the queue at once.
+    // consecutive messages of the same logger are passed to its sinks as one batch (sink::log_batch).
+    size_t batch_size = 1;
+    async_wait_strategy wait_strategy = async_wait_strategy::blocking;
+    // number of empty polls of the spin_yield_park strategy before yielding, and then before parking.
+    size_t spin_count = 1000;
+    size_t yield_count = 100;
+    // async loggers attach to the pool on construction and detach on destruction, so their queued
+    // messages carry a raw logger pointer instead of a shared_ptr (no refcount update per message).
+    // an attached logger also keeps the pool alive, so it posts without locking its weak_ptr to the pool.
+    // the async_logger destructor then waits until its queued messages were processed, so it must
+    // not be destroyed from the pool's own worker threads.
+    bool pin_loggers = false;
+    // size in bytes of the arena backend's storage (0: 128 bytes per q_max_items), at most 4 GiB
+    size_t arena_size = 0;
+    // storage of the queues (see page_memory.h): huge pages, prefaulted and locked in RAM at construction,
+    // so that the first use of each slot takes no page fault.
+    page_options queue_pages;
+    // number of independent queues, each of q_max_items. a logger always posts to the same shard
+    // (by its name hash, or as set by async_logger::set_shard()) and worker i serves shard i % shards,
+    // so a slow logger stalls only its own shard. with one worker per shard (threads_n == shards)
+    // the messages of each logger are processed in order.
+    size_t shards = 1;
+
+    // one shard per NUMA node instead (linux only, ignored with a single node): the queue of each shard is
+    // allocated on its node, its workers (worker i serves shard i % nodes) are pinned to the node's cpus
+    // unless cpu_affinity is given, and the log calls post to the shard of the calling thread's node.
+    // the messages of a logger are then processed in order per node only, and flushes are posted to every
+    // shard. threads_n must be at least the number of nodes.
+    bool numa_shards = false;
+
+    // worker threads setup, applied before on_thread_start. the thread pool constructor throws if it fails.
+    // worker i is pinned to cpu cpu_affinity[i % cpu_affinity.size()] (not pinned if empty).
+    std::vector<size_t> cpu_affinity;
+    // if not negative (and no cpu_affinity given), the workers run only on the cpus of this NUMA node.
+    int numa_node = -1;
+    // if not empty, worker i is named "<thread_name>-<i>" (as shown by top/gdb, truncated to 15 chars on linux).
+    std::string thread_name;
+    // nice value of the workers (0: inherited).
+    int thread_nice = 0;
+
+    // count the messages, blocked enqueues and queueing latency of the pool and of each logger
+    // (see thread_pool::stats() and async_logger::stats()). costs a few relaxed atomic updates per message.
+    bool collect_stats = false;
+
+    // messages of this level and above are posted to a second queue per shard (of priority_q_max_items,
+    // 0: q_max_items), which the workers drain before the regular one, so that errors don't wait behind a
+    // backlog of lower level messages. they are posted with priority_overflow_policy instead of their logger's
+    // policy. the messages of a logger are then no longer processed in order across the two queues.
+    // level::off: no priority queue.
+    level::level_enum priority_level = level::off;
+    size_t priority_q_max_items = 0;
+    async_overflow_policy priority_overflow_policy = async_overflow_policy::block;
+    // the thread posting a priority message then waits until a worker wrote it and flushed its logger.
+    // the pool's loggers must then not log priority messages from its worker threads (e.g. from a sink).
+    bool priority_flush = false;
+
+    // elastic workers: with max_threads above threads_n, the pool starts threads_n workers and adds more (up to
+    // max_threads) while the messages queued in the shards of a worker stay above scale_up_depth (0: q_max_items / 2)
+    // for scale_up_delay, retiring the added ones after idle_timeout without messages.
+    // each shard is then served by one worker at a time, handed over between batches, so the messages of each logger
+    // are still processed in order: the shards (shards option, default max_threads) bound the parallelism, a worker
+    // serving several shards polls them (waiting at most poll_interval on each in turn). the wait_strategy is then
+    // ignored. not with numa_shards.
+    size_t max_threads = 0;
+    size_t scale_up_depth = 0;
+    std::chrono::milliseconds scale_up_delay{100};
+    std::chrono::milliseconds idle_timeout{5000};
+    std::chrono::milliseconds poll_interval{10};
+
+    // work stealing between the shards: the messages of the order insensitive loggers (see
+    // async_logger::set_order_insensitive()) are posted to a second queue per shard (blocking backend), from which
+    // the workers of the other shards steal whole batches once their own queues are empty. a worker then waits
+    // at most poll_interval on its regular queue before looking at the other shards again (the wait_strategy is then
+    // ignored). the messages of these loggers are processed in any order, by several workers at once: their sinks
+    // must be thread safe (the _mt ones). not with max_threads.
+    bool work_stealing = false;
+
+    // load shedding: on_load_threshold(shard, threshold, rising) is called when the load factor of a shard's queue
+    // (see thread_pool::load_factor()) crosses one of load_thresholds (fractions of its capacity, ascending) - rising
+    // from the posting thread, falling from a worker. it must not log to the pool's loggers with the block policy.
+    std::vector<double> load_thresholds;
+    std::function<void(size_t shard, double threshold, bool rising)> on_load_threshold;
+
+    // keep the pool running across fork() (pthread_atfork handlers, not available on windows): before
+    // forking the workers process the queued messages and exit, and they are restarted in the parent
+    // and in the child (calling on_thread_start again). the blocking queue backend is locked during the
+    // fork - with the other backends no thread may post to the pool while another one forks.
+    // a fork from a worker of the pool (e.g. by a sink) leaves the pool running: in the child, only
+    // the forking worker remains (it should exec or exit).
+    bool fork_safe = false;
+
+    // with several workers per shard, keep the order of the messages of each shard: the workers dequeue their batches
+    // in turn (taking a ticket), make them ready in parallel - format the deferred payloads, and the texts of the sinks
+    // formatting ahead (see sinks::sink::format_ahead(), e.g. the file sinks) - then write them in the order of their
+    // tickets. the messages of the loggers with processors, and the priority messages, are not formatted ahead.
+    // ignored with max_threads (a shard is served by one worker at a time).
+    bool ordered_workers = false;
+
+    // spill file of the loggers with the spill overflow policy (not with fork_safe): once the queue of a shard is
+    // full, their messages are encoded (as by the arena backend) into a ring of spill_size bytes mapped from this
+    // file - "<spill_file>.<shard>" with several shards - and the workers replay it once the queue drained. while a
+    // shard spills, these messages and the pool's own ones (flush requests, barriers, terminate) go to the spill so
+    // that they keep their order. the file is removed by the pool's destructor. posix only.
+    filename_t spill_file;
+    size_t spill_size = 64 * 1024 * 1024;
+};
+
 // RAII 手法封装的 thread。marked by jinglong in 2021年9月27日09:49:33
 // 需要单独注意的是，std::thread 的拷贝构造和拷贝赋值被 delete 了，所以不可以用拷贝的方式传递线程对象
 class SPDLOG_API thread_guard
@@ -133,8 +785,9 @@ class SPDLOG_API thread_pool
 {
 public:
     using item_type = async_msg;
-    using q_type = details::mpmc_blocking_queue<item_type>;
+    using q_type = details::async_queue<item_type>;
 
+    thread_pool(size_t q_max_items, size_t threads_n, const thread_pool_options &options);
     thread_pool(size_t q_max_items, size_t threads_n, std::function<void()> on_thread_start);
     thread_pool(size_t q_max_items, size_t threads_n);
 
@@ -146,21 +799,272 @@ public:
 
     void post_log(async_logger_ptr &&worker_ptr, const details::log_msg &msg, async_overflow_policy overflow_policy);
     void post_flush(async_logger_ptr &&worker_ptr, async_overflow_policy overflow_policy);
+    void post_log(async_logger *worker, const details::log_msg &msg, async_overflow_policy overflow_policy);
+    // post a message to be formatted by the worker (see deferred_format.h). worker_ptr may be empty for attached loggers.
+    void post_deferred_log(async_logger_ptr &&worker_ptr, async_logger *worker, const details::log_msg &msg,
+        deferred_format_fn format_fn, string_view_t format_args, async_overflow_policy overflow_policy);
+    void post_flush(async_logger *worker, async_overflow_policy overflow_policy);
+    // post the lines of logger::log_lines() as a single message (see details::foreach_log_line()) - split in
+    // as many as needed to fit in the arena backend. worker_ptr may be empty for attached loggers.
+    void post_log_batch(async_logger_ptr &&worker_ptr, async_logger *worker, const details::log_msg &msg, string_view_t lines,
+        async_overflow_policy overflow_policy);
+    // post a flush request whose future is fulfilled once a worker wrote the logger's messages posted before it
+    // and flushed its sinks. posted with the block policy. worker_ptr may be empty for attached loggers.
+    std::future<void> post_flush_async(async_logger_ptr &&worker_ptr, async_logger *worker);
+    // same, calling on_flushed on the worker instead of fulfilling a future (it must not block the worker).
+    void post_flush_async(async_logger_ptr &&worker_ptr, async_logger *worker, std::function<void()> on_flushed);
+    // call on_room(true) once the queue of the logger's shard has room: right away if it has, else on a worker
+    // after it dequeued messages (it must not block the worker). on_room(false) if the pool is destroyed first.
+    void when_queue_has_room(const async_logger &logger, std::function<void(bool)> on_room);
+    // flush the given loggers of this pool with a single message (per shard): once the messages posted before
+    // it were processed, each distinct sink of the loggers is flushed once. posted with the block policy.
+    // the future is fulfilled once they are flushed.
+    std::future<void> post_flush_batch(const std::vector<async_logger_ptr> &loggers);
+    // from now on the workers drop the log messages instead of writing them, e.g. to stop the pool by a deadline
+    // (see registry::shutdown()). the flush messages are still processed. can't be undone.
+    void discard_queued();
+    // format a message (whose payload is the format string) straight into a record of the arena backend,
+    // out of the queue lock. return false if the caller must format it and post_log() it instead: without
+    // the arena backend, or with the overrun_oldest policy (a record being written can't be overrun).
+    // worker_ptr may be empty for attached loggers.
+    bool post_formatted_log(async_logger_ptr &&worker_ptr, async_logger *worker, const details::log_msg &msg, fmt::format_args args,
+        async_overflow_policy overflow_policy, size_t &formatted_size);
+    // true if the queues are the arena backend (see post_formatted_log())
+    bool formats_in_place() const;
+
+    // loggers attached to a pool with pin_loggers set post their messages by raw pointer
+    bool pins_loggers() const;
+    void attach_logger(async_logger *logger);
+    // block until all the messages posted before the call were processed by the workers
+    void detach_logger(async_logger *logger);
+    // block until the workers processed all the messages posted before the call (the producers are not stopped).
+    // to have them persisted, flush the loggers first (e.g. spdlog::flush_all()). not to be called by a worker.
+    void wait_processed();
+    size_t attached_loggers();
     size_t overrun_counter();
     size_t queue_size();
+    // bytes allocated by the queued messages beyond their slots (see memory_account.h)
+    size_t memory_used() const;
+    // the load factor (0 to 1) of the queue of the logger's shard, or the highest one of the shards - lock free
+    // (see async_queue::load_factor()). priority messages are not counted.
+    double load_factor(const async_logger &logger);
+    double load_factor();
+    size_t shards() const;
+    // the number of running workers (varies with thread_pool_options::max_threads)
+    size_t workers() const;
+    // the shard the given logger posts to (from the calling thread, with numa shards)
+    size_t shard_of(const async_logger &logger) const;
+    // lock-free snapshot of the counters (all zero unless thread_pool_options::collect_stats is set).
+    // flush messages are counted as enqueued/dequeued too, the latency histogram has log messages only.
+    async_stats stats() const;
 
 private:
-    q_type q_;
+    using arena_q_type = details::mpmc_arena_queue<item_type, async_msg_arena_codec>;
+
+    // the turns of the workers of a shard, with thread_pool_options::ordered_workers
+    struct shard_order
+    {
+        // held while dequeuing a batch and taking its ticket
+        std::mutex dequeue_mutex;
+        uint64_t next_ticket = 0;
+        // the ticket of the batch to write next
+        std::mutex turn_mutex;
+        std::condition_variable turn_cv;
+        uint64_t turn = 0;
+    };
+
+    struct shard
+    {
+        std::unique_ptr<q_type> q;
+        // the queue of the priority messages (blocking backend), if thread_pool_options::priority_level is set
+        std::unique_ptr<q_type> priority_q;
+        // set if q is the arena backend - log messages are then encoded into it directly
+        arena_q_type *arena_q = nullptr;
+        // the messages of the order insensitive loggers, if thread_pool_options::work_stealing is set
+        std::unique_ptr<q_type> shared_q;
+        // the spilled messages, if thread_pool_options::spill_file is set
+        std::unique_ptr<arena_q_type> spill_q;
+        // set if its workers keep the order of the messages (thread_pool_options::ordered_workers)
+        std::unique_ptr<shard_order> order;
+        size_t workers = 0;
+        // the node and its cpus of a numa shard
+        int numa_node = -1;
+        std::vector<size_t> cpus;
+    };
+
+    // the fork safe pools, updated by their constructor and destructor
+    struct fork_registry
+    {
+        std::mutex mutex;
+        std::vector<thread_pool *> pools;
+        const thread_pool *forking_pool = nullptr; // whose worker is forking, left alone (set before fork())
+    };
+
+    thread_pool_options options_;
+    size_t threads_n_;
+    std::vector<shard> shards_;
+    // with numa shards, the shard of each cpu
+    std::vector<size_t> cpu_shards_;
+    // the number of load thresholds passed by each shard, if thread_pool_options::on_load_threshold is set
+    std::unique_ptr<std::atomic<size_t>[]> load_levels_;
+    // the messages spilled and not dequeued yet (or being spilled) by each shard, if it has a spill queue
+    std::unique_ptr<std::atomic<size_t>[]> spill_pending_;
+    // the callbacks of when_queue_has_room(), with the shard they wait for
+    std::mutex room_mutex_;
+    std::vector<std::pair<shard *, std::function<void(bool)>>> room_waiters_;
+    std::atomic<size_t> n_room_waiters_{0};
 
     std::vector<std::thread> threads_;
+    size_t batch_size_;
+    async_wait_strategy wait_strategy_;
+    size_t spin_count_;
+    size_t yield_count_;
+    bool pin_loggers_;
+    bool collect_stats_;
+    async_stats_counters stats_;
+    // set by discard_queued()
+    std::atomic<bool> discarding_{false};
+    std::shared_ptr<memory_account> memory_ = std::make_shared<memory_account>();
+
+    // elastic workers (see thread_pool_options::max_threads): the worker id serving each shard, handed over by
+    // its current worker - or no_worker once the shard received its terminate message.
+    static const size_t no_worker = static_cast<size_t>(-1);
+    bool elastic_;
+    size_t max_threads_;
+    size_t scale_up_depth_;
+    std::unique_ptr<std::atomic<size_t>[]> shard_workers_;
+    mutable std::mutex elastic_mutex_; // threads_ and the members below
+    std::vector<std::thread> retired_threads_; // exited or exiting, joined by the next worker added
+    bool stopping_ = false;
+    size_t next_worker_id_ = 0;
+    size_t running_workers_ = 0;
+
+    std::mutex attached_mutex_;
+    std::unordered_set<async_logger *> attached_loggers_;
+
+    // barrier of detach_logger() and wait_processed() - each worker waits in it until all workers reached it
+    std::mutex barrier_post_mutex_;
+    std::mutex barrier_mutex_;
+    std::condition_variable barrier_cv_;
+    size_t barrier_pending_ = 0;
+    size_t barrier_generation_ = 0;
 
+    static thread_pool_options options_with_callback_(std::function<void()> on_thread_start);
+    // write the queued log messages (see crash_dump.h)
+    static void crash_dump_(const void *pool, crash_writer &writer);
+    void start_workers_(bool fail_on_setup_error);
+    void stop_workers_();
+    // complete the flush requests left in the queues once the workers stopped, so that nobody waits for them
+    void complete_pending_flushes_();
+    static fork_registry &fork_registry_();
+#ifndef SPDLOG_NO_TLS
+    static const thread_pool *&worker_pool_();
+#endif
+    // whether the calling thread is one of the workers
+    bool is_worker_thread_() const;
+    static void on_fork_prepare_();
+    static void on_fork_parent_();
+    static void on_fork_child_();
+    static void after_fork_(bool child);
+    // apply the affinity/name/nice options to the calling worker thread. return error message (empty if succeeded)
+    static std::string setup_worker_(
+        const thread_pool_options &options, int numa_node, const std::vector<size_t> &numa_cpus, size_t worker_index);
+    void make_queue_(shard &s, size_t q_max_items) const;
+    // one shard per node with cpus (none if less than 2)
+    void make_numa_shards_(size_t threads_n, size_t q_max_items);
+    shard &shard_of_(const async_logger *logger);
     void post_async_msg_(async_msg &&new_msg, async_overflow_policy overflow_policy);
-    void worker_loop_();
+    void post_async_msg_(shard &target, async_msg &&new_msg, async_overflow_policy overflow_policy);
+    void post_async_msg_(q_type &q, async_msg &&new_msg, async_overflow_policy overflow_policy);
+    // the messages of the logger go to the shared queue of the shard (work stealing)
+    static bool shares_(const shard &target, const async_logger *logger);
+    bool is_priority_(const log_msg &msg) const;
+    // post a message to the priority queue of the shard, wake its workers up and, with
+    // thread_pool_options::priority_flush, wait until the message was written and flushed
+    void post_priority_(shard &target, async_msg &&new_msg);
+    // encode a log message directly into the arena queue of the shard
+    void post_record_(shard &target, async_msg_record &&record, async_overflow_policy overflow_policy);
+    std::atomic<size_t> &spill_pending_of_(const shard &s);
+    // the message goes to the spill queue of the shard: posted with the spill policy, or a message of the pool while
+    // the shard spills
+    bool spills_(const shard &target, const async_logger *logger, async_msg_type msg_type, async_overflow_policy overflow_policy);
+    // post to the queue of the shard if it doesn't spill and has room, else to its spill queue
+    void post_spill_(shard &target, async_msg &&new_msg);
+    void post_spill_(shard &target, async_msg_record &&record);
+    // encode into the spill queue of the shard, blocking while it is full
+    template<typename Src>
+    void spill_(shard &target, async_logger *logger, Src &&src);
+    // move spilled messages to items, waiting up to wait_duration for one being spilled. to be called once the
+    // queue of the shard is empty: the spilled messages were posted after the queued ones.
+    size_t dequeue_spilled_(shard &my_shard, async_msg *items, size_t max_items, std::chrono::milliseconds wait_duration);
+    // wait up to timeout for the next messages of the queue - for at most a millisecond while the shard spills
+    size_t wait_dequeue_(shard &my_shard, async_msg *items, size_t max_items, std::chrono::milliseconds timeout);
+    static double load_of_(shard &s);
+    // call on_load_threshold for the thresholds crossed since the last check of the shard
+    void check_load_(shard &s);
+    void post_flush_completion_(async_logger_ptr &&worker_ptr, async_logger *worker, async_flush_completion *completion);
+    // call the room waiters whose shard has room now (all of them with false if closing)
+    void wake_room_waiters_(bool closing = false);
+    // after dequeuing messages from the shard: the load thresholds and the room waiters
+    void on_dequeued_(shard &s);
+    // msg names its logger with the logger's own string (not e.g. a backtraced copy): referenced
+    // by the queued message instead of copied, the logger outliving its messages
+    static bool names_worker_(const async_logger *worker, const log_msg &msg);
+    // reserve a record of the arena queue of the shard per the overflow policy. nullptr if discarded.
+    char *reserve_record_(shard &target, async_logger *logger, size_t size, async_overflow_policy overflow_policy);
+    void count_enqueued_(async_logger *logger, size_t overrun);
+    void count_blocked_(async_logger *logger, std::chrono::steady_clock::time_point blocked_since);
+    void count_dequeued_(const async_msg *msgs, size_t n_msgs);
+#ifdef SPDLOG_USDT
+    static void probe_posted_(const async_logger *logger, async_msg_type msg_type, const log_msg &msg);
+    static void probe_dequeued_(const async_msg *msgs, size_t n_msgs);
+#endif
+    void count_posted_(async_logger *logger, bool enqueued);
+    void count_timed_block_(async_logger *logger, std::chrono::steady_clock::time_point blocked_since, bool enqueued);
+    // once the shard's queue drained, log the number of messages the logger discarded (discard_new/block_for policies)
+    void report_discarded_(shard &my_shard, async_logger *logger);
+    void worker_loop_(shard &my_shard);
+    // the loop of the workers of an ordered shard
+    void ordered_worker_loop_(shard &my_shard);
+    // make the log messages of the batch ready to be written (see async_logger::backend_prepare_())
+    void prepare_batch_(const async_msg *batch, size_t n_msgs, prepared_batch &prepared);
+    // serve the shards handed to worker id, until it has none (terminated or retired)
+    void elastic_worker_loop_(size_t id);
+    // start a worker serving the given shard, handed over by the calling worker id. false if at max_threads.
+    bool add_elastic_worker_(size_t id, size_t shard_index);
+    // give the shards back to their initial workers. false if the pool is stopping.
+    bool retire_elastic_worker_(const std::vector<size_t> &my_shards);
+    // pass the barrier without waiting for the other workers (elastic workers)
+    void arrive_barrier_();
+    // post a barrier message per worker and wait until all of them reached it
+    void post_barrier_();
+    void wait_barrier_();
+
+    // wait for the next messages according to the wait strategy, the priority messages first.
+    // return the number of messages moved to items (0 if timeout passed).
+    size_t dequeue_(shard &my_shard, async_msg *items, size_t max_items);
+    size_t try_dequeue_(shard &my_shard, async_msg *items, size_t max_items);
+    // move a batch of the shared queue of another shard to items (work stealing). return its size.
+    size_t steal_(shard &my_shard, async_msg *items, size_t max_items);
+    void drain_priority_(shard &my_shard);
+    void drain_shared_(shard &my_shard);
 
     // process next message in the queue
     // return true if this thread should still be active (while no terminate msg
     // was received)
-    bool process_next_msg_();
+    bool process_next_msg_(shard &my_shard);
+    bool process_msg_(shard &my_shard, async_msg &incoming_async_msg);
+    // the last flush_batch message of the batch flushes its loggers
+    static void flush_batch_(async_flush_batch *batch);
+
+    // process up to batch.size() messages in the queue
+    // return true if this thread should still be active (while no terminate msg
+    // was received)
+    bool process_next_batch_(shard &my_shard, std::vector<async_msg> &batch, std::vector<details::log_msg> &batch_views);
+    // process the n_msgs dequeued messages, the ones made ready by prepare_batch_() from the prepared texts.
+    // return the number of terminate messages among them.
+    size_t process_batch_(shard &my_shard, async_msg *batch, size_t n_msgs, std::vector<details::log_msg> &batch_views,
+        const prepared_batch *prepared = nullptr);
 };
 
 } // namespace details
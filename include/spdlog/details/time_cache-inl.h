@@ -0,0 +1,157 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/details/time_cache.h>
+#endif
+
+#include <spdlog/details/os.h>
+
+#include <cstring>
+
+namespace spdlog {
+namespace details {
+
+SPDLOG_INLINE time_cache &time_cache::instance()
+{
+    // leaked: the loggers may log during static destruction
+    static time_cache *s_instance = new time_cache();
+    return *s_instance;
+}
+
+SPDLOG_INLINE std::tm time_cache::get(std::time_t secs, bool local)
+{
+    entry e;
+    bool cached = read_(e);
+    if (!cached || e.secs != secs)
+    {
+        e = convert_(secs, cached ? &e : nullptr);
+        publish_(e);
+    }
+    return local ? e.local : e.utc;
+}
+
+SPDLOG_INLINE int time_cache::utc_minutes_offset(const std::tm &local_tm)
+{
+    entry e;
+    if (read_(e) && e.local.tm_sec == local_tm.tm_sec && e.local.tm_min == local_tm.tm_min &&
+        e.local.tm_hour == local_tm.tm_hour && e.local.tm_yday == local_tm.tm_yday && e.local.tm_year == local_tm.tm_year &&
+        e.local.tm_isdst == local_tm.tm_isdst)
+    {
+        return static_cast<int>(e.zone_offset / 60);
+    }
+    return os::utc_minutes_offset(local_tm);
+}
+
+SPDLOG_INLINE bool time_cache::read_(entry &e) const SPDLOG_NOEXCEPT
+{
+    auto seq = seq_.load(std::memory_order_acquire);
+    if (seq == 0 || (seq & 1) != 0)
+    {
+        return false;
+    }
+    uint64_t buf[words];
+    for (size_t i = 0; i < words; i++)
+    {
+        buf[i] = words_[i].load(std::memory_order_relaxed);
+    }
+    // acquire: the sequence is read again after the words
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (seq_.load(std::memory_order_relaxed) != seq)
+    {
+        return false;
+    }
+    std::memcpy(&e, buf, sizeof(e));
+    return true;
+}
+
+SPDLOG_INLINE void time_cache::publish_(const entry &e) SPDLOG_NOEXCEPT
+{
+    auto seq = seq_.load(std::memory_order_relaxed);
+    // a single writer: the others keep their conversion for themselves
+    if ((seq & 1) != 0 || !seq_.compare_exchange_strong(seq, seq + 1, std::memory_order_acquire, std::memory_order_relaxed))
+    {
+        return;
+    }
+    // release: the readers that see a new word see the odd sequence
+    std::atomic_thread_fence(std::memory_order_release);
+    entry current;
+    uint64_t buf[words];
+    for (size_t i = 0; i < words; i++)
+    {
+        buf[i] = words_[i].load(std::memory_order_relaxed);
+    }
+    std::memcpy(&current, buf, sizeof(current));
+    if (seq == 0 || e.secs > current.secs)
+    {
+        std::memset(buf, 0, sizeof(buf));
+        std::memcpy(buf, &e, sizeof(e));
+        for (size_t i = 0; i < words; i++)
+        {
+            words_[i].store(buf[i], std::memory_order_relaxed);
+        }
+        conversions_.fetch_add(1, std::memory_order_relaxed);
+    }
+    seq_.store(seq + 2, std::memory_order_release);
+}
+
+SPDLOG_INLINE time_cache::entry time_cache::convert_(std::time_t secs, const entry *prev)
+{
+    entry e;
+    std::memset(&e, 0, sizeof(e));
+    if (prev != nullptr && secs >= prev->zone_start && secs < prev->zone_end)
+    {
+        e = *prev;
+    }
+    else
+    {
+        find_zone_(secs, e);
+    }
+    e.secs = secs;
+    e.utc = os::civil_time(secs);
+    e.local = os::civil_time(secs, e.zone_offset);
+    e.local.tm_isdst = e.zone_tm.tm_isdst;
+#if !defined(_WIN32) && !defined(sun) && !defined(__sun) && !defined(_AIX) && (defined(_BSD_SOURCE) || defined(_GNU_SOURCE))
+    e.local.tm_zone = e.zone_tm.tm_zone;
+#endif
+    return e;
+}
+
+SPDLOG_INLINE long time_cache::offset_of_(std::time_t secs, const std::tm &local_tm)
+{
+    return static_cast<long>(os::civil_seconds(local_tm) - secs);
+}
+
+SPDLOG_INLINE void time_cache::find_zone_(std::time_t secs, entry &e)
+{
+    e.zone_tm = os::localtime(secs);
+    e.zone_offset = offset_of_(secs, e.zone_tm);
+    e.zone_start = secs;
+    // the zones change at most once a day
+    std::time_t end = secs + 86400;
+    auto end_tm = os::localtime(end);
+    if (offset_of_(end, end_tm) != e.zone_offset || end_tm.tm_isdst != e.zone_tm.tm_isdst)
+    {
+        // secs is in the zone, end isn't
+        std::time_t in_zone = secs;
+        while (end - in_zone > 1)
+        {
+            auto mid = in_zone + (end - in_zone) / 2;
+            auto mid_tm = os::localtime(mid);
+            if (offset_of_(mid, mid_tm) == e.zone_offset && mid_tm.tm_isdst == e.zone_tm.tm_isdst)
+            {
+                in_zone = mid;
+            }
+            else
+            {
+                end = mid;
+            }
+        }
+    }
+    e.zone_end = end;
+}
+
+} // namespace details
+} // namespace spdlog
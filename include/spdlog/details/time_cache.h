@@ -0,0 +1,90 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Process wide cache of the broken down current second (local and UTC) and of its utc offset.
+//
+// The formatters convert the time of each new second: without the cache every formatter calls
+// localtime_r() (which takes the lock of the time zone) at each second boundary. The first formatter
+// to see a new second converts it and publishes it under a sequence lock, the others copy it.
+// Reads and writes are lock free: a write in progress, or a second other than the cached one
+// (e.g. messages queued for a while), is simply converted by the caller.
+//
+// The seconds are converted in integer arithmetic (see os::civil_time()). The local time is the UTC
+// time shifted by the utc offset of the cached zone window: the offset (and dst flag) of a second
+// found with localtime_r(), valid until the next change of offset, looked up a day ahead (with a
+// binary search of the transition second if the offset changes within the day). So localtime_r() is
+// called about once a day, and a change of the TZ variable is seen within a day.
+
+#include <spdlog/common.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+
+namespace spdlog {
+namespace details {
+
+class SPDLOG_API time_cache
+{
+public:
+    // never destroyed, so that it can be used until the end of the program
+    static time_cache &instance();
+
+    time_cache(const time_cache &) = delete;
+    time_cache &operator=(const time_cache &) = delete;
+
+    // the local (or UTC) time of the given second
+    std::tm get(std::time_t secs, bool local);
+
+    // os::utc_minutes_offset() of the given local time, cached with its second
+    int utc_minutes_offset(const std::tm &local_tm);
+
+    // the number of seconds converted and published by the cache
+    uint64_t conversions() const
+    {
+        return conversions_.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct entry
+    {
+        std::time_t secs;
+        std::tm local;
+        std::tm utc;
+        // the zone window: the seconds of [zone_start, zone_end) have the offset and dst flag of zone_tm
+        std::time_t zone_start;
+        std::time_t zone_end;
+        long zone_offset;
+        std::tm zone_tm;
+    };
+    static const size_t words = (sizeof(entry) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    time_cache() = default;
+    ~time_cache() = default;
+
+    // false if empty or being written
+    bool read_(entry &e) const SPDLOG_NOEXCEPT;
+    // publish e if its second is newer than the cached one (and the cache is not being written)
+    void publish_(const entry &e) SPDLOG_NOEXCEPT;
+    // prev: the cached entry if any, whose zone window is kept if it holds secs
+    static entry convert_(std::time_t secs, const entry *prev);
+    // the utc offset (in seconds) of the given local time of secs
+    static long offset_of_(std::time_t secs, const std::tm &local_tm);
+    // find the zone window from secs
+    static void find_zone_(std::time_t secs, entry &e);
+
+    // odd while written, 0 while empty
+    std::atomic<uint32_t> seq_{0};
+    std::atomic<uint64_t> conversions_{0};
+    std::array<std::atomic<uint64_t>, words> words_{};
+};
+
+} // namespace details
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "time_cache-inl.h"
+#endif
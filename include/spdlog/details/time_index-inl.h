@@ -0,0 +1,136 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/details/time_index.h>
+#endif
+
+#include <spdlog/details/os.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+
+namespace spdlog {
+namespace details {
+
+SPDLOG_INLINE time_index::time_index(std::chrono::seconds interval, size_t bytes_interval)
+    : interval_(interval)
+    , bytes_interval_(bytes_interval)
+{
+    if (interval.count() <= 0 && bytes_interval == 0)
+    {
+        throw_spdlog_ex("time_index: an interval of time or bytes is required");
+    }
+}
+
+SPDLOG_INLINE time_index::~time_index()
+{
+    close();
+}
+
+SPDLOG_INLINE void time_index::open(const filename_t &log_filename, size_t log_size)
+{
+    close();
+    filename_ = index_filename(log_filename);
+    if (os::fopen_s(&fd_, filename_, log_size == 0 ? SPDLOG_FILENAME_T("wb") : SPDLOG_FILENAME_T("ab")))
+    {
+        fd_ = nullptr;
+        throw_spdlog_ex("Failed opening file " + os::filename_to_str(filename_) + " for writing", errno);
+    }
+    offset_ = log_size;
+    has_entry_ = false;
+}
+
+SPDLOG_INLINE void time_index::close()
+{
+    if (fd_ != nullptr)
+    {
+        std::fclose(fd_);
+        fd_ = nullptr;
+    }
+}
+
+SPDLOG_INLINE void time_index::add(log_clock::time_point time, size_t size)
+{
+    auto offset = offset_;
+    offset_ += size;
+    if (fd_ == nullptr)
+    {
+        return;
+    }
+    bool due = !has_entry_ || (interval_.count() > 0 && time >= next_time_) || (bytes_interval_ > 0 && offset >= next_offset_);
+    if (!due)
+    {
+        return;
+    }
+    entry e{static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count()),
+        static_cast<uint64_t>(offset)};
+    // flushed as written: the readers see the entries of the log file being written
+    if (std::fwrite(&e, sizeof(e), 1, fd_) != 1 || std::fflush(fd_) != 0)
+    {
+        throw_spdlog_ex("Failed writing to file " + os::filename_to_str(filename_), errno);
+    }
+    has_entry_ = true;
+    next_time_ = time + std::chrono::duration_cast<log_clock::duration>(interval_);
+    next_offset_ = offset + bytes_interval_;
+}
+
+SPDLOG_INLINE filename_t time_index::index_filename(const filename_t &log_filename)
+{
+    return log_filename + SPDLOG_FILENAME_T(".idx");
+}
+
+SPDLOG_INLINE void time_index::rename(const filename_t &log_filename, const filename_t &new_log_filename) SPDLOG_NOEXCEPT
+{
+    auto target = index_filename(new_log_filename);
+    (void)os::remove_if_exists(target);
+    auto src = index_filename(log_filename);
+    if (os::path_exists(src))
+    {
+        (void)os::rename(src, target);
+    }
+}
+
+SPDLOG_INLINE void time_index::remove(const filename_t &log_filename) SPDLOG_NOEXCEPT
+{
+    (void)os::remove_if_exists(index_filename(log_filename));
+}
+
+SPDLOG_INLINE std::vector<time_index::entry> time_index::read(const filename_t &log_filename)
+{
+    std::vector<entry> entries;
+    std::FILE *fd;
+    if (os::fopen_s(&fd, index_filename(log_filename), SPDLOG_FILENAME_T("rb")))
+    {
+        return entries;
+    }
+    entries.resize(os::filesize(fd) / sizeof(entry));
+    // an entry being written is left out
+    auto n = std::fread(entries.data(), sizeof(entry), entries.size(), fd);
+    std::fclose(fd);
+    entries.resize(n);
+    return entries;
+}
+
+SPDLOG_INLINE std::pair<size_t, size_t> time_index::find_range(
+    const filename_t &log_filename, log_clock::time_point from, log_clock::time_point to)
+{
+    auto entries = read(log_filename);
+    auto ns = [](log_clock::time_point tp) {
+        return static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(tp.time_since_epoch()).count());
+    };
+    auto after = [](int64_t time, const entry &e) { return time < e.time; };
+    // from the last entry at or before from: its interval can hold messages from it on
+    auto first = std::upper_bound(entries.begin(), entries.end(), ns(from), after);
+    size_t begin = first == entries.begin() ? 0 : static_cast<size_t>((first - 1)->offset);
+    // to the first entry after to: its messages and the next ones are later
+    auto last = std::upper_bound(entries.begin(), entries.end(), ns(to), after);
+    size_t end = last == entries.end() ? SIZE_MAX : static_cast<size_t>(last->offset);
+    return std::make_pair(begin, (std::max)(begin, end));
+}
+
+} // namespace details
+} // namespace spdlog
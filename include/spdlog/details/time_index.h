@@ -0,0 +1,79 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Sparse time index of a log file, in the sidecar file "<log file>.idx", to read the messages of a time
+// range without scanning the whole file (see tools/spdlog-time-range.cpp).
+//
+// The index is a sequence of fixed size entries: (time of a message in ns since epoch, offset of its line
+// in the log file), native byte order. An entry is appended - one small write - for the first message
+// after each interval of time or of bytes, so seeking to the entry before a time finds its messages
+// within an interval.
+//
+// The sinks move and remove the index with its log file (rotations, compression). The offsets of a
+// compressed file are those of its uncompressed data.
+//
+// Throw spdlog_ex exception on errors.
+// Not thread safe - the sinks serialize the access to it.
+
+#include <spdlog/common.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+namespace spdlog {
+namespace details {
+
+class SPDLOG_API time_index
+{
+public:
+    struct entry
+    {
+        int64_t time; // ns since epoch
+        uint64_t offset;
+    };
+
+    time_index(std::chrono::seconds interval, size_t bytes_interval);
+    time_index(const time_index &) = delete;
+    time_index &operator=(const time_index &) = delete;
+    ~time_index();
+
+    // index the log file from its current size on. the index of an empty log file is truncated.
+    void open(const filename_t &log_filename, size_t log_size);
+    void close();
+    // before writing a message of size bytes at the end of the log file
+    void add(log_clock::time_point time, size_t size);
+
+    // "logs/mylog.txt" => "logs/mylog.txt.idx"
+    static filename_t index_filename(const filename_t &log_filename);
+    // move / remove the index of a log file, if any
+    static void rename(const filename_t &log_filename, const filename_t &new_log_filename) SPDLOG_NOEXCEPT;
+    static void remove(const filename_t &log_filename) SPDLOG_NOEXCEPT;
+
+    // the entries of the index of the log file (none if it has no index)
+    static std::vector<entry> read(const filename_t &log_filename);
+    // the range of the log file to read for the messages from..to: [first, second), second = SIZE_MAX for the
+    // end of the file. the whole file if it has no index.
+    static std::pair<size_t, size_t> find_range(const filename_t &log_filename, log_clock::time_point from, log_clock::time_point to);
+
+private:
+    std::chrono::nanoseconds interval_;
+    size_t bytes_interval_;
+    std::FILE *fd_{nullptr};
+    filename_t filename_;
+    size_t offset_{0};
+    bool has_entry_{false};
+    log_clock::time_point next_time_;
+    size_t next_offset_{0};
+};
+
+} // namespace details
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "time_index-inl.h"
+#endif
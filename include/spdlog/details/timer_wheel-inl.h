@@ -0,0 +1,192 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/details/timer_wheel.h>
+#endif
+
+#include <algorithm>
+
+namespace spdlog {
+namespace details {
+
+SPDLOG_INLINE timer_wheel::timer_wheel(std::chrono::nanoseconds tick)
+    : tick_(tick > std::chrono::nanoseconds::zero() ? tick : std::chrono::nanoseconds(1))
+    , start_(clock::now())
+    , worker_thread_(&timer_wheel::worker_loop_, this)
+{}
+
+SPDLOG_INLINE timer_wheel::~timer_wheel()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        active_ = false;
+    }
+    cv_.notify_one();
+    worker_thread_.join();
+}
+
+SPDLOG_INLINE std::shared_ptr<timer_wheel> timer_wheel::instance()
+{
+    static std::shared_ptr<timer_wheel> s_instance = std::make_shared<timer_wheel>();
+    return s_instance;
+}
+
+SPDLOG_INLINE timer_wheel::timer_id timer_wheel::schedule_every(std::function<void()> callback, std::chrono::nanoseconds interval)
+{
+    return schedule_(std::move(callback), interval, true);
+}
+
+SPDLOG_INLINE timer_wheel::timer_id timer_wheel::schedule_after(std::function<void()> callback, std::chrono::nanoseconds delay)
+{
+    return schedule_(std::move(callback), delay, false);
+}
+
+SPDLOG_INLINE void timer_wheel::cancel(timer_id id)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = deadlines_.find(id);
+    if (it != deadlines_.end())
+    {
+        auto &slot = slots_[it->second % n_slots];
+        slot.erase(std::find_if(slot.begin(), slot.end(), [id](const timer &t) { return t.id == id; }));
+        deadlines_.erase(it);
+        return;
+    }
+    // due, or running
+    due_.erase(std::remove_if(due_.begin(), due_.end(), [id](const timer &t) { return t.id == id; }), due_.end());
+    if (running_id_ != id)
+    {
+        return;
+    }
+    running_cancelled_ = true;
+    if (worker_thread_.get_id() != std::this_thread::get_id())
+    {
+        done_cv_.wait(lock, [this, id] { return running_id_ != id; });
+    }
+}
+
+SPDLOG_INLINE timer_wheel::timer_id timer_wheel::schedule_(std::function<void()> callback, std::chrono::nanoseconds delay, bool repeat)
+{
+    if (delay <= std::chrono::nanoseconds::zero() && repeat)
+    {
+        return 0;
+    }
+    auto ticks = to_ticks_(delay);
+    timer t{0, 0, repeat ? ticks : 0, std::make_shared<std::function<void()>>(std::move(callback))};
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        t.id = next_id_++;
+        // after the processed slots
+        t.deadline = (std::max)(now_tick_(), current_tick_) + ticks;
+        insert_(t);
+    }
+    cv_.notify_one();
+    return t.id;
+}
+
+// rounded up, at least one tick
+SPDLOG_INLINE uint64_t timer_wheel::to_ticks_(std::chrono::nanoseconds duration) const
+{
+    auto ticks = static_cast<uint64_t>((std::max)(duration.count(), std::chrono::nanoseconds::rep(0)) + tick_.count() - 1) /
+                 static_cast<uint64_t>(tick_.count());
+    return (std::max)(ticks, uint64_t(1));
+}
+
+SPDLOG_INLINE uint64_t timer_wheel::now_tick_() const
+{
+    return static_cast<uint64_t>((clock::now() - start_) / tick_);
+}
+
+SPDLOG_INLINE void timer_wheel::insert_(timer t)
+{
+    deadlines_[t.id] = t.deadline;
+    slots_[t.deadline % n_slots].push_back(std::move(t));
+}
+
+// visit the slots of the ticks since the last call, each slot at most once
+SPDLOG_INLINE void timer_wheel::collect_due_(uint64_t tick)
+{
+    auto last = (std::min)(tick, current_tick_ + n_slots);
+    for (auto t = current_tick_ + 1; t <= last; t++)
+    {
+        auto &slot = slots_[t % n_slots];
+        for (size_t i = 0; i < slot.size();)
+        {
+            if (slot[i].deadline > tick)
+            {
+                i++; // a later round
+                continue;
+            }
+            deadlines_.erase(slot[i].id);
+            due_.push_back(std::move(slot[i]));
+            slot[i] = std::move(slot.back());
+            slot.pop_back();
+        }
+    }
+    current_tick_ = tick;
+    std::sort(due_.begin(), due_.end(),
+        [](const timer &a, const timer &b) { return a.deadline < b.deadline || (a.deadline == b.deadline && a.id < b.id); });
+}
+
+SPDLOG_INLINE void timer_wheel::worker_loop_()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (active_)
+    {
+        if (due_.empty())
+        {
+            if (deadlines_.empty())
+            {
+                cv_.wait(lock);
+                continue;
+            }
+            using deadline_entry = std::pair<const timer_id, uint64_t>;
+            auto next = std::min_element(deadlines_.begin(), deadlines_.end(), [](const deadline_entry &a, const deadline_entry &b) {
+                return a.second < b.second;
+            })->second;
+            auto now = now_tick_();
+            if (next > now)
+            {
+                // woken up earlier by new timers or stop
+                cv_.wait_until(lock, start_ + tick_ * static_cast<std::chrono::nanoseconds::rep>(next));
+                continue;
+            }
+            collect_due_(now);
+            continue;
+        }
+
+        auto due = std::move(due_.front());
+        due_.erase(due_.begin());
+        running_id_ = due.id;
+        lock.unlock();
+        SPDLOG_TRY
+        {
+            (*due.callback)();
+        }
+        SPDLOG_CATCH_STD
+        lock.lock();
+        auto cancelled = running_cancelled_;
+        running_id_ = 0;
+        running_cancelled_ = false;
+        done_cv_.notify_all();
+
+        // unless cancelled meanwhile. the missed runs are skipped.
+        if (due.interval > 0 && !cancelled)
+        {
+            auto now = now_tick_();
+            due.deadline += due.interval;
+            if (due.deadline <= now)
+            {
+                due.deadline = now + due.interval;
+            }
+            due.deadline = (std::max)(due.deadline, current_tick_ + 1);
+            insert_(std::move(due));
+        }
+    }
+}
+
+} // namespace details
+} // namespace spdlog
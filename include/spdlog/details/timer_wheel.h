@@ -0,0 +1,94 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Hashed timer wheel - runs the scheduled callbacks on a single thread, shared by the users of instance()
+// (periodic flush, sinks with timed behavior ..) instead of a thread each.
+//
+// Deadlines are rounded up to ticks (1ms by default) and hashed into a fixed number of slots by tick:
+// scheduling and canceling don't depend on the number of timers, and the thread sleeps until the next deadline.
+// The callbacks run one at a time: a slow one delays the others. They may cancel timers (their own too),
+// but must not destroy the wheel.
+//
+// RAII over the owned thread:
+//    creates the thread on construction.
+//    stops and joins the thread on destruction (if the thread is executing a callback, wait for it to finish first).
+
+#include <spdlog/common.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace spdlog {
+namespace details {
+
+class SPDLOG_API timer_wheel
+{
+public:
+    using clock = std::chrono::steady_clock;
+    using timer_id = uint64_t; // 0 is never a valid id
+
+    explicit timer_wheel(std::chrono::nanoseconds tick = std::chrono::milliseconds(1));
+    timer_wheel(const timer_wheel &) = delete;
+    timer_wheel &operator=(const timer_wheel &) = delete;
+    ~timer_wheel();
+
+    // the wheel shared by spdlog. kept alive by the returned pointers, so that it can be used until they are released.
+    static std::shared_ptr<timer_wheel> instance();
+
+    // run the callback every interval, the first time after interval. returns 0 if interval isn't positive.
+    timer_id schedule_every(std::function<void()> callback, std::chrono::nanoseconds interval);
+    // run the callback once, after delay
+    timer_id schedule_after(std::function<void()> callback, std::chrono::nanoseconds delay);
+    // stop the timer. if its callback is running in another thread, wait for it to return.
+    void cancel(timer_id id);
+
+private:
+    static const size_t n_slots = 512;
+
+    struct timer
+    {
+        timer_id id;
+        uint64_t deadline; // in ticks
+        uint64_t interval; // in ticks, 0 for a single run
+        std::shared_ptr<std::function<void()>> callback;
+    };
+
+    timer_id schedule_(std::function<void()> callback, std::chrono::nanoseconds delay, bool repeat);
+    uint64_t to_ticks_(std::chrono::nanoseconds duration) const;
+    uint64_t now_tick_() const;
+    // move the timers due at the given tick from the slots to due_, and advance current_tick_ to it
+    void collect_due_(uint64_t tick);
+    void insert_(timer t);
+    void worker_loop_();
+
+    std::chrono::nanoseconds tick_;
+    clock::time_point start_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::condition_variable done_cv_;
+    std::vector<std::vector<timer>> slots_{n_slots};
+    std::unordered_map<timer_id, uint64_t> deadlines_; // of the scheduled timers, to find their slot
+    std::vector<timer> due_;
+    uint64_t current_tick_{0}; // the slots up to it were processed
+    timer_id next_id_{1};
+    timer_id running_id_{0};
+    bool running_cancelled_{false};
+    bool active_{true};
+    std::thread worker_thread_;
+};
+
+} // namespace details
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "timer_wheel-inl.h"
+#endif
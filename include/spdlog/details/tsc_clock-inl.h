@@ -0,0 +1,115 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/details/tsc_clock.h>
+#endif
+
+#include <chrono>
+#include <thread>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__i386__) || defined(__x86_64__))
+#    include <cpuid.h>
+#endif
+
+namespace spdlog {
+namespace details {
+
+SPDLOG_INLINE tsc_clock &tsc_clock::instance()
+{
+    // leaked: the loggers may log during static destruction
+    static tsc_clock *s_instance = new tsc_clock();
+    return *s_instance;
+}
+
+SPDLOG_INLINE tsc_clock::tsc_clock()
+{
+    if (!counter_invariant_())
+    {
+        return;
+    }
+    // first rate, measured over a short time. refined by the resyncs.
+    sample_(first_counter_, first_ns_);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    uint64_t counter;
+    int64_t ns;
+    sample_(counter, ns);
+    if (counter <= first_counter_ || ns <= first_ns_)
+    {
+        return;
+    }
+    base_counter_.store(counter);
+    base_ns_.store(ns);
+    ns_per_tick_.store(static_cast<double>(ns - first_ns_) / static_cast<double>(counter - first_counter_));
+    uses_counter_ = true;
+    resync_timer_ = details::make_unique<periodic_worker>([this] { resync(); }, std::chrono::seconds(1));
+}
+
+SPDLOG_INLINE void tsc_clock::resync() SPDLOG_NOEXCEPT
+{
+    uint64_t counter;
+    int64_t ns;
+    sample_(counter, ns);
+    if (counter <= first_counter_ || ns <= first_ns_)
+    {
+        return; // the system clock went back before the first sample: keep the previous calibration
+    }
+    auto ns_per_tick = static_cast<double>(ns - first_ns_) / static_cast<double>(counter - first_counter_);
+
+    // a single writer (the timer thread)
+    auto seq = seq_.load(std::memory_order_relaxed);
+    seq_.store(seq + 1, std::memory_order_relaxed);
+    // release: the readers that see a new value see the odd sequence
+    base_counter_.store(counter, std::memory_order_release);
+    base_ns_.store(ns, std::memory_order_release);
+    ns_per_tick_.store(ns_per_tick, std::memory_order_release);
+    seq_.store(seq + 2, std::memory_order_release);
+}
+
+SPDLOG_INLINE bool tsc_clock::counter_invariant_()
+{
+#if defined(SPDLOG_TSC_SUPPORTED) && defined(__aarch64__)
+    return true; // the generic timer has a constant frequency
+#elif defined(SPDLOG_TSC_SUPPORTED) && defined(_MSC_VER)
+    int regs[4];
+    __cpuid(regs, 0x80000000);
+    if (static_cast<unsigned>(regs[0]) < 0x80000007u)
+    {
+        return false;
+    }
+    __cpuid(regs, 0x80000007);
+    return (regs[3] & (1 << 8)) != 0;
+#elif defined(SPDLOG_TSC_SUPPORTED)
+    unsigned eax, ebx, ecx, edx;
+    if (__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) == 0)
+    {
+        return false;
+    }
+    return (edx & (1u << 8)) != 0;
+#else
+    return false;
+#endif
+}
+
+// the counter read the closest around the clock, out of a few tries (to skip the preempted ones)
+SPDLOG_INLINE void tsc_clock::sample_(uint64_t &counter, int64_t &ns) SPDLOG_NOEXCEPT
+{
+    uint64_t best_window = UINT64_MAX;
+    for (int i = 0; i < 5; i++)
+    {
+        auto before = read_counter();
+        auto time = log_clock::now();
+        auto after = read_counter();
+        if (after - before < best_window)
+        {
+            best_window = after - before;
+            counter = before + (after - before) / 2;
+            ns = std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+        }
+    }
+}
+
+} // namespace details
+} // namespace spdlog
@@ -0,0 +1,123 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Wall clock read from the CPU's time stamp counter (used by os::now() with SPDLOG_CLOCK_TSC).
+//
+// now() reads the counter and converts it with the last calibration against log_clock: no system call,
+// and the full resolution of the counter. The calibration is taken on first use (for a few milliseconds),
+// then resynced every second by the shared timer thread (see timer_wheel.h), so that the clock follows
+// the adjustments of the system clock. Readers get a consistent calibration through a sequence lock.
+//
+// Falls back to log_clock::now() if the counter isn't invariant (or on other CPUs than x86 and aarch64).
+
+#include <spdlog/common.h>
+#include <spdlog/details/periodic_worker.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#    include <intrin.h>
+#    define SPDLOG_TSC_SUPPORTED
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__i386__) || defined(__x86_64__))
+#    include <x86intrin.h>
+#    define SPDLOG_TSC_SUPPORTED
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__aarch64__)
+#    define SPDLOG_TSC_SUPPORTED
+#endif
+
+namespace spdlog {
+namespace details {
+
+class SPDLOG_API tsc_clock
+{
+public:
+    // the clock used by spdlog. never destroyed, so that it can be used until the end of the program
+    static tsc_clock &instance();
+
+    tsc_clock(const tsc_clock &) = delete;
+    tsc_clock &operator=(const tsc_clock &) = delete;
+
+    // true if now() reads the counter
+    bool uses_counter() const
+    {
+        return uses_counter_;
+    }
+
+    log_clock::time_point now() const SPDLOG_NOEXCEPT
+    {
+        if (!uses_counter_)
+        {
+            return log_clock::now();
+        }
+        return to_time_point(read_counter());
+    }
+
+    // convert a counter value read lately (with the current calibration)
+    log_clock::time_point to_time_point(uint64_t counter) const SPDLOG_NOEXCEPT
+    {
+        uint64_t base_counter;
+        int64_t base_ns;
+        double ns_per_tick;
+        for (;;)
+        {
+            auto seq = seq_.load(std::memory_order_acquire);
+            // acquire: the check below is not done before, and sees a write in progress
+            base_counter = base_counter_.load(std::memory_order_acquire);
+            base_ns = base_ns_.load(std::memory_order_acquire);
+            ns_per_tick = ns_per_tick_.load(std::memory_order_acquire);
+            if ((seq & 1) == 0 && seq_.load(std::memory_order_relaxed) == seq)
+            {
+                break;
+            }
+        }
+        // the counter may be read before the calibration, on another core
+        auto ticks = static_cast<double>(static_cast<int64_t>(counter - base_counter));
+        auto ns = base_ns + static_cast<int64_t>(ticks * ns_per_tick);
+        return log_clock::time_point(std::chrono::duration_cast<log_clock::duration>(std::chrono::nanoseconds(ns)));
+    }
+
+    static uint64_t read_counter() SPDLOG_NOEXCEPT
+    {
+#if defined(SPDLOG_TSC_SUPPORTED) && defined(__aarch64__)
+        uint64_t counter;
+        asm volatile("mrs %0, cntvct_el0" : "=r"(counter));
+        return counter;
+#elif defined(SPDLOG_TSC_SUPPORTED)
+        return static_cast<uint64_t>(__rdtsc());
+#else
+        return 0;
+#endif
+    }
+
+    // take a new calibration sample
+    void resync() SPDLOG_NOEXCEPT;
+
+private:
+    tsc_clock();
+    ~tsc_clock() = default;
+
+    static bool counter_invariant_();
+    // a counter value and the matching log_clock time, in ns
+    static void sample_(uint64_t &counter, int64_t &ns) SPDLOG_NOEXCEPT;
+
+    bool uses_counter_{false};
+    // first sample: the rate is measured over the whole time since
+    uint64_t first_counter_{0};
+    int64_t first_ns_{0};
+    std::atomic<uint32_t> seq_{0};
+    std::atomic<uint64_t> base_counter_{0};
+    std::atomic<int64_t> base_ns_{0};
+    std::atomic<double> ns_per_tick_{0};
+    std::unique_ptr<periodic_worker> resync_timer_;
+};
+
+} // namespace details
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "tsc_clock-inl.h"
+#endif
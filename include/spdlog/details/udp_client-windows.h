@@ -0,0 +1,118 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#define WIN32_LEAN_AND_MEAN
+// udp client helper
+#include <spdlog/common.h>
+#include <spdlog/details/os.h>
+
+#include <winsock2.h>
+#include <windows.h>
+#include <ws2tcpip.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string>
+
+#pragma comment(lib, "Ws2_32.lib")
+#pragma comment(lib, "Mswsock.lib")
+#pragma comment(lib, "AdvApi32.lib")
+
+namespace spdlog {
+namespace details {
+class udp_client
+{
+    SOCKET socket_ = INVALID_SOCKET;
+    sockaddr_storage addr_{};
+    int addr_len_ = 0;
+
+    static void throw_winsock_error_(const std::string &msg, int last_error)
+    {
+        char buf[512];
+        ::FormatMessage(FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS, NULL, last_error,
+            MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT), buf, (sizeof(buf) / sizeof(char)), NULL);
+
+        throw_spdlog_ex(fmt::format("udp_sink - {}: {}", msg, buf));
+    }
+
+public:
+    // resolve the host and open the socket, or throw on failure
+    udp_client(const std::string &host, int port)
+    {
+        WSADATA wsaData;
+        auto rv = WSAStartup(MAKEWORD(2, 2), &wsaData);
+        if (rv != 0)
+        {
+            throw_winsock_error_("WSAStartup failed", ::WSAGetLastError());
+        }
+
+        struct addrinfo hints
+        {};
+        ZeroMemory(&hints, sizeof(hints));
+        hints.ai_family = AF_INET;       // IPv4
+        hints.ai_socktype = SOCK_DGRAM;  // UDP
+        hints.ai_flags = AI_NUMERICSERV; // port passed as as numeric value
+        hints.ai_protocol = 0;
+
+        auto port_str = std::to_string(port);
+        struct addrinfo *addrinfo_result;
+        rv = ::getaddrinfo(host.c_str(), port_str.c_str(), &hints, &addrinfo_result);
+        if (rv != 0)
+        {
+            int last_error = ::WSAGetLastError();
+            WSACleanup();
+            throw_winsock_error_("getaddrinfo failed", last_error);
+        }
+
+        socket_ = ::socket(addrinfo_result->ai_family, addrinfo_result->ai_socktype, addrinfo_result->ai_protocol);
+        if (socket_ == INVALID_SOCKET)
+        {
+            int last_error = ::WSAGetLastError();
+            ::freeaddrinfo(addrinfo_result);
+            WSACleanup();
+            throw_winsock_error_("socket failed", last_error);
+        }
+        memcpy(&addr_, addrinfo_result->ai_addr, addrinfo_result->ai_addrlen);
+        addr_len_ = static_cast<int>(addrinfo_result->ai_addrlen);
+        ::freeaddrinfo(addrinfo_result);
+
+        // don't block the loggers when the send buffer is full
+        u_long non_blocking = 1;
+        ::ioctlsocket(socket_, FIONBIO, &non_blocking);
+    }
+
+    udp_client(const udp_client &) = delete;
+    udp_client &operator=(const udp_client &) = delete;
+
+    ~udp_client()
+    {
+        ::closesocket(socket_);
+        WSACleanup();
+    }
+
+    SOCKET fd() const
+    {
+        return socket_;
+    }
+
+    // Send the datagrams stored back to back in data, the i-th one ending at ends[i].
+    // Fire and forget: return the number of datagrams the kernel took, the others are lost.
+    size_t send(const char *data, const size_t *ends, size_t n_datagrams)
+    {
+        size_t sent = 0;
+        for (size_t i = 0; i < n_datagrams; i++)
+        {
+            auto begin = i == 0 ? 0 : ends[i - 1];
+            auto size = static_cast<int>(ends[i] - begin);
+            auto result = ::sendto(socket_, data + begin, size, 0, reinterpret_cast<const sockaddr *>(&addr_), addr_len_);
+            if (result != SOCKET_ERROR)
+            {
+                sent++;
+            }
+        }
+        return sent;
+    }
+};
+} // namespace details
+} // namespace spdlog
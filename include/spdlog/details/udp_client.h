@@ -0,0 +1,129 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifdef _WIN32
+#    error include udp_client-windows.h instead
+#endif
+
+// udp client helper
+#include <spdlog/common.h>
+#include <spdlog/details/os.h>
+
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <netinet/in.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+namespace spdlog {
+namespace details {
+class udp_client
+{
+    int socket_ = -1;
+    sockaddr_storage addr_{};
+    socklen_t addr_len_ = 0;
+
+public:
+    // resolve the host and open the socket, or throw on failure
+    udp_client(const std::string &host, int port)
+    {
+        struct addrinfo hints
+        {};
+        memset(&hints, 0, sizeof(struct addrinfo));
+        hints.ai_family = AF_INET;       // IPv4
+        hints.ai_socktype = SOCK_DGRAM;  // UDP
+        hints.ai_flags = AI_NUMERICSERV; // port passed as as numeric value
+        hints.ai_protocol = 0;
+
+        auto port_str = std::to_string(port);
+        struct addrinfo *addrinfo_result;
+        auto rv = ::getaddrinfo(host.c_str(), port_str.c_str(), &hints, &addrinfo_result);
+        if (rv != 0)
+        {
+            auto msg = fmt::format("::getaddrinfo failed: {}", gai_strerror(rv));
+            throw_spdlog_ex(msg);
+        }
+
+#if defined(SOCK_CLOEXEC)
+        const int flags = SOCK_CLOEXEC;
+#else
+        const int flags = 0;
+#endif
+        socket_ = ::socket(addrinfo_result->ai_family, addrinfo_result->ai_socktype | flags, addrinfo_result->ai_protocol);
+        if (socket_ == -1)
+        {
+            auto last_errno = errno;
+            ::freeaddrinfo(addrinfo_result);
+            throw_spdlog_ex("socket(2) failed", last_errno);
+        }
+        memcpy(&addr_, addrinfo_result->ai_addr, addrinfo_result->ai_addrlen);
+        addr_len_ = static_cast<socklen_t>(addrinfo_result->ai_addrlen);
+        ::freeaddrinfo(addrinfo_result);
+    }
+
+    udp_client(const udp_client &) = delete;
+    udp_client &operator=(const udp_client &) = delete;
+
+    ~udp_client()
+    {
+        ::close(socket_);
+    }
+
+    int fd() const
+    {
+        return socket_;
+    }
+
+    // Send the datagrams stored back to back in data, the i-th one ending at ends[i].
+    // Fire and forget: return the number of datagrams the kernel took, the others are lost.
+    size_t send(const char *data, const size_t *ends, size_t n_datagrams)
+    {
+        size_t sent = 0;
+#if defined(__linux__) && defined(_GNU_SOURCE)
+        // one system call per chunk
+        const size_t chunk = 64;
+        mmsghdr msgs[chunk];
+        iovec iovs[chunk];
+        for (size_t first = 0; first < n_datagrams;)
+        {
+            auto count = (std::min)(chunk, n_datagrams - first);
+            for (size_t i = 0; i < count; i++)
+            {
+                auto begin = first + i == 0 ? 0 : ends[first + i - 1];
+                iovs[i].iov_base = const_cast<char *>(data + begin);
+                iovs[i].iov_len = ends[first + i] - begin;
+                memset(&msgs[i], 0, sizeof(mmsghdr));
+                msgs[i].msg_hdr.msg_name = &addr_;
+                msgs[i].msg_hdr.msg_namelen = addr_len_;
+                msgs[i].msg_hdr.msg_iov = &iovs[i];
+                msgs[i].msg_hdr.msg_iovlen = 1;
+            }
+            auto result = ::sendmmsg(socket_, msgs, static_cast<unsigned int>(count), MSG_DONTWAIT);
+            // on error, skip the datagram that failed
+            auto n_sent = result < 0 ? size_t(0) : static_cast<size_t>(result);
+            sent += n_sent;
+            first += n_sent < count ? n_sent + 1 : n_sent;
+        }
+#else
+        for (size_t i = 0; i < n_datagrams; i++)
+        {
+            auto begin = i == 0 ? 0 : ends[i - 1];
+            auto result =
+                ::sendto(socket_, data + begin, ends[i] - begin, MSG_DONTWAIT, reinterpret_cast<const sockaddr *>(&addr_), addr_len_);
+            if (result >= 0)
+            {
+                sent++;
+            }
+        }
+#endif
+        return sent;
+    }
+};
+} // namespace details
+} // namespace spdlog
@@ -0,0 +1,159 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifdef _WIN32
+#    error unix_socket_client.h is not supported on windows
+#endif
+
+// unix domain socket client helper
+#include <spdlog/common.h>
+#include <spdlog/details/os.h>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+namespace spdlog {
+namespace details {
+class unix_socket_client
+{
+    int socket_ = -1;
+    sockaddr_un addr_{};
+    int type_;
+
+public:
+    // type is SOCK_DGRAM or SOCK_SEQPACKET. throw if the path doesn't fit in a socket address.
+    unix_socket_client(const std::string &path, int type)
+        : type_(type)
+    {
+        if (path.empty() || path.size() >= sizeof(addr_.sun_path))
+        {
+            throw_spdlog_ex(fmt::format("unix_socket_client: invalid socket path \"{}\"", path));
+        }
+        addr_.sun_family = AF_UNIX;
+        memcpy(addr_.sun_path, path.c_str(), path.size());
+    }
+
+    unix_socket_client(const unix_socket_client &) = delete;
+    unix_socket_client &operator=(const unix_socket_client &) = delete;
+
+    ~unix_socket_client()
+    {
+        close();
+    }
+
+    bool is_connected() const
+    {
+        return socket_ != -1;
+    }
+
+    void close()
+    {
+        if (is_connected())
+        {
+            ::close(socket_);
+            socket_ = -1;
+        }
+    }
+
+    int fd() const
+    {
+        return socket_;
+    }
+
+    // try to connect. the reader may not be there yet: return false on failure.
+    bool connect()
+    {
+        close();
+#if defined(SOCK_CLOEXEC)
+        const int flags = SOCK_CLOEXEC;
+#else
+        const int flags = 0;
+#endif
+        socket_ = ::socket(AF_UNIX, type_ | flags, 0);
+        if (socket_ == -1)
+        {
+            return false;
+        }
+        if (::connect(socket_, reinterpret_cast<const sockaddr *>(&addr_), sizeof(addr_)) != 0)
+        {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    // Send the datagrams stored back to back in data, the i-th one ending at ends[i].
+    // Fire and forget: return the number of datagrams the kernel took, the others are lost.
+    // Close the connection if the peer went away.
+    size_t send(const char *data, const size_t *ends, size_t n_datagrams)
+    {
+#if defined(MSG_NOSIGNAL)
+        const int send_flags = MSG_NOSIGNAL | MSG_DONTWAIT;
+#else
+        const int send_flags = MSG_DONTWAIT;
+#endif
+        size_t sent = 0;
+#if defined(__linux__) && defined(_GNU_SOURCE)
+        // one system call per chunk
+        const size_t chunk = 64;
+        mmsghdr msgs[chunk];
+        iovec iovs[chunk];
+        for (size_t first = 0; first < n_datagrams && is_connected();)
+        {
+            auto count = (std::min)(chunk, n_datagrams - first);
+            for (size_t i = 0; i < count; i++)
+            {
+                auto begin = first + i == 0 ? 0 : ends[first + i - 1];
+                iovs[i].iov_base = const_cast<char *>(data + begin);
+                iovs[i].iov_len = ends[first + i] - begin;
+                memset(&msgs[i], 0, sizeof(mmsghdr));
+                msgs[i].msg_hdr.msg_iov = &iovs[i];
+                msgs[i].msg_hdr.msg_iovlen = 1;
+            }
+            auto result = ::sendmmsg(socket_, msgs, static_cast<unsigned int>(count), send_flags);
+            // on error, skip the datagram that failed
+            auto n_sent = result < 0 ? size_t(0) : static_cast<size_t>(result);
+            if (result < 0)
+            {
+                on_error_(errno);
+            }
+            sent += n_sent;
+            first += n_sent < count ? n_sent + 1 : n_sent;
+        }
+#else
+        for (size_t i = 0; i < n_datagrams && is_connected(); i++)
+        {
+            auto begin = i == 0 ? 0 : ends[i - 1];
+            if (::send(socket_, data + begin, ends[i] - begin, send_flags) >= 0)
+            {
+                sent++;
+            }
+            else
+            {
+                on_error_(errno);
+            }
+        }
+#endif
+        return sent;
+    }
+
+private:
+    // the reader closed its socket, or was restarted: connect again on the next send
+    void on_error_(int error)
+    {
+        if (error == ECONNREFUSED || error == ECONNRESET || error == ENOTCONN || error == EPIPE)
+        {
+            close();
+        }
+    }
+};
+} // namespace details
+} // namespace spdlog
@@ -0,0 +1,320 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/details/uring_file_writer.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace spdlog {
+namespace details {
+
+namespace uring {
+// using the system calls directly - no dependency on liburing
+SPDLOG_INLINE int setup(unsigned entries, io_uring_params *params)
+{
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+SPDLOG_INLINE int enter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+    return static_cast<int>(::syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+SPDLOG_INLINE int register_buffers(int ring_fd, const iovec *iovecs, unsigned n)
+{
+    return static_cast<int>(::syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_BUFFERS, iovecs, n));
+}
+
+SPDLOG_INLINE void *map(int ring_fd, size_t size, off_t offset)
+{
+    auto *p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, offset);
+    return p == MAP_FAILED ? nullptr : p;
+}
+
+template<typename T>
+T *at(void *base, unsigned offset)
+{
+    return reinterpret_cast<T *>(static_cast<char *>(base) + offset);
+}
+} // namespace uring
+
+SPDLOG_INLINE std::unique_ptr<uring_file_writer> uring_file_writer::create(size_t buffer_size)
+{
+    std::unique_ptr<uring_file_writer> writer(new uring_file_writer());
+    if (!writer->init_(buffer_size))
+    {
+        return nullptr;
+    }
+    return writer;
+}
+
+SPDLOG_INLINE bool uring_file_writer::init_(size_t buffer_size)
+{
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    ring_fd_ = uring::setup(2, &params);
+    if (ring_fd_ < 0)
+    {
+        return false;
+    }
+#ifdef IORING_FEAT_RW_CUR_POS
+    // IORING_OP_WRITE and writes at the current position need 5.6
+    if ((params.features & IORING_FEAT_RW_CUR_POS) == 0)
+    {
+        return false;
+    }
+#endif
+
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        sq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    }
+    sq_ring_ = uring::map(ring_fd_, sq_ring_size_, IORING_OFF_SQ_RING);
+    if (sq_ring_ == nullptr)
+    {
+        return false;
+    }
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        cq_ring_ = sq_ring_;
+    }
+    else
+    {
+        cq_ring_ = uring::map(ring_fd_, cq_ring_size_, IORING_OFF_CQ_RING);
+        if (cq_ring_ == nullptr)
+        {
+            return false;
+        }
+    }
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = static_cast<io_uring_sqe *>(uring::map(ring_fd_, sqes_size_, IORING_OFF_SQES));
+    if (sqes_ == nullptr)
+    {
+        return false;
+    }
+
+    sq_tail_ = uring::at<unsigned>(sq_ring_, params.sq_off.tail);
+    sq_mask_ = uring::at<unsigned>(sq_ring_, params.sq_off.ring_mask);
+    sq_array_ = uring::at<unsigned>(sq_ring_, params.sq_off.array);
+    cq_head_ = uring::at<unsigned>(cq_ring_, params.cq_off.head);
+    cq_tail_ = uring::at<unsigned>(cq_ring_, params.cq_off.tail);
+    cq_mask_ = uring::at<unsigned>(cq_ring_, params.cq_off.ring_mask);
+    cqes_ = uring::at<io_uring_cqe>(cq_ring_, params.cq_off.cqes);
+
+    iovec iovecs[2];
+    for (size_t i = 0; i < 2; i++)
+    {
+        buffers_[i].resize(buffer_size);
+        iovecs[i].iov_base = buffers_[i].data();
+        iovecs[i].iov_len = buffer_size;
+    }
+    // registered buffers save mapping the pages on each write. not fatal if over the locked memory limit.
+    fixed_buffers_ = uring::register_buffers(ring_fd_, iovecs, 2) == 0;
+    return true;
+}
+
+SPDLOG_INLINE uring_file_writer::~uring_file_writer()
+{
+    wait();
+    if (sqes_ != nullptr)
+    {
+        ::munmap(sqes_, sqes_size_);
+    }
+    if (cq_ring_ != nullptr && cq_ring_ != sq_ring_)
+    {
+        ::munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sq_ring_ != nullptr)
+    {
+        ::munmap(sq_ring_, sq_ring_size_);
+    }
+    if (ring_fd_ >= 0)
+    {
+        ::close(ring_fd_);
+    }
+}
+
+SPDLOG_INLINE void uring_file_writer::set_fd(int fd)
+{
+    fd_ = fd;
+}
+
+SPDLOG_INLINE int uring_file_writer::write(const char *data, size_t size)
+{
+    if (broken_)
+    {
+        // the rest of the buffered data first
+        int err = write_sync_(buffers_[current_].data(), fill_);
+        fill_ = 0;
+        return err != 0 ? err : write_sync_(data, size);
+    }
+    int err = 0;
+    auto capacity = buffers_[0].size();
+    while (size > 0)
+    {
+        auto n = std::min(size, capacity - fill_);
+        std::memcpy(buffers_[current_].data() + fill_, data, n);
+        fill_ += n;
+        data += n;
+        size -= n;
+        if (fill_ == capacity)
+        {
+            auto wait_err = wait();
+            err = err != 0 ? err : wait_err;
+            auto submit_err = submit_current_();
+            err = err != 0 ? err : submit_err;
+        }
+    }
+    return err;
+}
+
+SPDLOG_INLINE int uring_file_writer::flush()
+{
+    int err = wait();
+    if (fill_ > 0)
+    {
+        auto submit_err = submit_current_();
+        auto wait_err = wait();
+        err = err != 0 ? err : (submit_err != 0 ? submit_err : wait_err);
+    }
+    return err;
+}
+
+SPDLOG_INLINE int uring_file_writer::wait()
+{
+    while (in_flight_)
+    {
+        auto head = *cq_head_;
+        if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE))
+        {
+            if (uring::enter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR)
+            {
+                in_flight_ = false;
+                broken_ = true;
+                return errno;
+            }
+            continue;
+        }
+        auto res = cqes_[head & *cq_mask_].res;
+        __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+
+        int err = 0;
+        if (res == -EINTR || res == -EAGAIN)
+        {
+            err = submit_write_();
+        }
+        else if (res < 0)
+        {
+            in_flight_ = false;
+            return -res;
+        }
+        else if (static_cast<size_t>(res) < in_flight_size_)
+        {
+            // short write - write the rest
+            in_flight_data_ += res;
+            in_flight_size_ -= static_cast<size_t>(res);
+            err = submit_write_();
+        }
+        else
+        {
+            in_flight_ = false;
+        }
+        if (err != 0)
+        {
+            return err;
+        }
+    }
+    return 0;
+}
+
+SPDLOG_INLINE size_t uring_file_writer::buffered_size() const
+{
+    return fill_ + (in_flight_ ? in_flight_size_ : 0);
+}
+
+// start writing the current buffer and switch to the other one. no write must be in progress.
+SPDLOG_INLINE int uring_file_writer::submit_current_()
+{
+    in_flight_ = true;
+    in_flight_buffer_ = current_;
+    in_flight_data_ = buffers_[current_].data();
+    in_flight_size_ = fill_;
+    current_ = 1 - current_;
+    fill_ = 0;
+    return submit_write_();
+}
+
+// submit the write in progress (or its rest), write it synchronously if the ring fails
+SPDLOG_INLINE int uring_file_writer::submit_write_()
+{
+    if (broken_)
+    {
+        in_flight_ = false;
+        return write_sync_(in_flight_data_, in_flight_size_);
+    }
+    auto tail = *sq_tail_;
+    auto index = tail & *sq_mask_;
+    auto &sqe = sqes_[index];
+    std::memset(&sqe, 0, sizeof(sqe));
+    sqe.fd = fd_;
+    sqe.off = static_cast<decltype(sqe.off)>(-1); // the current position - the end of the file (appending)
+    sqe.addr = reinterpret_cast<decltype(sqe.addr)>(in_flight_data_);
+    sqe.len = static_cast<unsigned>(in_flight_size_);
+    if (fixed_buffers_)
+    {
+        sqe.opcode = IORING_OP_WRITE_FIXED;
+        sqe.buf_index = static_cast<decltype(sqe.buf_index)>(in_flight_buffer_);
+    }
+    else
+    {
+        sqe.opcode = IORING_OP_WRITE;
+    }
+    sq_array_[index] = index;
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    int ret;
+    while ((ret = uring::enter(ring_fd_, 1, 0, 0)) < 0 && errno == EINTR) {}
+    if (ret != 1)
+    {
+        // the entry is left in the ring, never submitted
+        broken_ = true;
+        in_flight_ = false;
+        return write_sync_(in_flight_data_, in_flight_size_);
+    }
+    return 0;
+}
+
+SPDLOG_INLINE int uring_file_writer::write_sync_(const char *data, size_t size)
+{
+    while (size > 0)
+    {
+        auto n = ::write(fd_, data, size);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return errno;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return 0;
+}
+
+} // namespace details
+} // namespace spdlog
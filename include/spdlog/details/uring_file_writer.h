@@ -0,0 +1,89 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// io_uring backend of the file_helper write buffer (linux, SPDLOG_IO_URING).
+// The data is collected in two buffers registered with the ring: when one fills up, it is
+// written in the background while the other one fills, so the caller only waits for the
+// disk if it falls behind by a whole buffer.
+// Writes are issued one at a time (in order) at the end of the file, opened for appending.
+
+#include <spdlog/common.h>
+
+#include <memory>
+#include <vector>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace spdlog {
+namespace details {
+
+class SPDLOG_API uring_file_writer
+{
+public:
+    // return nullptr if io_uring is not usable (old kernel, blocked by seccomp..)
+    static std::unique_ptr<uring_file_writer> create(size_t buffer_size);
+
+    uring_file_writer(const uring_file_writer &) = delete;
+    uring_file_writer &operator=(const uring_file_writer &) = delete;
+    ~uring_file_writer();
+
+    // start writing to the given file - the previous one must be flushed
+    void set_fd(int fd);
+
+    // the functions below return 0 or the errno of the failed write.
+    // the data is dropped on errors.
+    int write(const char *data, size_t size);
+    // write the buffered data and wait for it
+    int flush();
+    // wait for the write in progress
+    int wait();
+
+    // size of the data not written yet
+    size_t buffered_size() const;
+
+private:
+    uring_file_writer() = default;
+
+    int ring_fd_{-1};
+    void *sq_ring_{nullptr};
+    size_t sq_ring_size_{0};
+    void *cq_ring_{nullptr};
+    size_t cq_ring_size_{0};
+    io_uring_sqe *sqes_{nullptr};
+    size_t sqes_size_{0};
+    unsigned *sq_tail_{nullptr};
+    unsigned *sq_mask_{nullptr};
+    unsigned *sq_array_{nullptr};
+    unsigned *cq_head_{nullptr};
+    unsigned *cq_tail_{nullptr};
+    unsigned *cq_mask_{nullptr};
+    io_uring_cqe *cqes_{nullptr};
+    bool fixed_buffers_{false};
+
+    int fd_{-1};
+    std::vector<char> buffers_[2];
+    size_t current_{0}; // the buffer being filled
+    size_t fill_{0};
+    // the write in progress (in the other buffer)
+    bool in_flight_{false};
+    size_t in_flight_buffer_{0};
+    const char *in_flight_data_{nullptr};
+    size_t in_flight_size_{0};
+    // the ring failed - write(2) from now on
+    bool broken_{false};
+
+    bool init_(size_t buffer_size);
+    int submit_current_();
+    int submit_write_();
+    int write_sync_(const char *data, size_t size);
+};
+
+} // namespace details
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "uring_file_writer-inl.h"
+#endif
@@ -0,0 +1,99 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Static tracepoints (USDT) on the logging path, for bpftrace, perf or systemtap - compiled in with SPDLOG_USDT
+// (needs <sys/sdt.h>, e.g. from systemtap-sdt-dev), else compiled out. A probe is a nop until a tracer attaches.
+//
+// Provider "spdlog", probes and arguments:
+//   log(logger name, level, payload size)             logger::log_it_, a message passed to the sinks
+//   enqueue(logger name, level, msg time)             thread_pool, a message posted to the queue
+//   drop(logger name, level)                          thread_pool, a message discarded (discard_new, block_for)
+//   overrun(count)                                    thread_pool, messages overwritten (overrun_oldest)
+//   dequeue(logger name, level, msg time)             thread_pool worker, a message taken from the queue
+//   sink_log_entry(sink, count) / sink_log_return(sink, count)     base_sink log calls (lock wait included)
+//   sink_flush_entry(sink) / sink_flush_return(sink)               base_sink flush
+// The msg times (nanoseconds since the epoch) identify a message from its enqueue to its dequeue, e.g. the
+// queue latency with bpftrace:
+//
+//     bpftrace -e 'usdt:./app:spdlog:enqueue { @start[arg2] = nsecs; }
+//                  usdt:./app:spdlog:dequeue /@start[arg2]/ { @latency_us = hist((nsecs - @start[arg2]) / 1000);
+//                                                             delete(@start[arg2]); }'
+
+#ifdef SPDLOG_USDT
+#    include <sys/sdt.h>
+
+#    include <chrono>
+#    include <cstdint>
+
+#    define SPDLOG_USDT_PROBE1(name, a) DTRACE_PROBE1(spdlog, name, a)
+#    define SPDLOG_USDT_PROBE2(name, a, b) DTRACE_PROBE2(spdlog, name, a, b)
+#    define SPDLOG_USDT_PROBE3(name, a, b, c) DTRACE_PROBE3(spdlog, name, a, b, c)
+
+namespace spdlog {
+namespace details {
+
+template<typename TimePoint>
+inline int64_t usdt_time(const TimePoint &time)
+{
+    return static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count());
+}
+
+// sink_log_entry/sink_log_return around a scope
+class usdt_sink_log_scope
+{
+public:
+    usdt_sink_log_scope(const void *sink, size_t count)
+        : sink_(sink)
+        , count_(count)
+    {
+        SPDLOG_USDT_PROBE2(sink_log_entry, sink_, count_);
+    }
+
+    usdt_sink_log_scope(const usdt_sink_log_scope &) = delete;
+    usdt_sink_log_scope &operator=(const usdt_sink_log_scope &) = delete;
+
+    ~usdt_sink_log_scope()
+    {
+        SPDLOG_USDT_PROBE2(sink_log_return, sink_, count_);
+    }
+
+private:
+    const void *sink_;
+    size_t count_;
+};
+
+class usdt_sink_flush_scope
+{
+public:
+    explicit usdt_sink_flush_scope(const void *sink)
+        : sink_(sink)
+    {
+        SPDLOG_USDT_PROBE1(sink_flush_entry, sink_);
+    }
+
+    usdt_sink_flush_scope(const usdt_sink_flush_scope &) = delete;
+    usdt_sink_flush_scope &operator=(const usdt_sink_flush_scope &) = delete;
+
+    ~usdt_sink_flush_scope()
+    {
+        SPDLOG_USDT_PROBE1(sink_flush_return, sink_);
+    }
+
+private:
+    const void *sink_;
+};
+
+} // namespace details
+} // namespace spdlog
+
+#    define SPDLOG_USDT_SINK_LOG_SCOPE(sink, count) spdlog::details::usdt_sink_log_scope spdlog_usdt_scope_(sink, count)
+#    define SPDLOG_USDT_SINK_FLUSH_SCOPE(sink) spdlog::details::usdt_sink_flush_scope spdlog_usdt_scope_(sink)
+#else
+#    define SPDLOG_USDT_PROBE1(name, a) (void)0
+#    define SPDLOG_USDT_PROBE2(name, a, b) (void)0
+#    define SPDLOG_USDT_PROBE3(name, a, b, c) (void)0
+#    define SPDLOG_USDT_SINK_LOG_SCOPE(sink, count) (void)0
+#    define SPDLOG_USDT_SINK_FLUSH_SCOPE(sink) (void)0
+#endif
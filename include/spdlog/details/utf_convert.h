@@ -0,0 +1,297 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Conversion between wchar_t strings (UTF-16 on windows, UTF-32 elsewhere) and UTF-8, for the wchar api
+// (see os::wstr_to_utf8buf()/os::utf8_to_wstrbuf()).
+// Runs of ascii are converted 16 at a time with SSE2 or NEON, the rest one code point at a time.
+
+#include <cstddef>
+#include <cstdint>
+#include <cwchar>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    include <emmintrin.h>
+#    define SPDLOG_UTF_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#    include <arm_neon.h>
+#    define SPDLOG_UTF_NEON
+#endif
+
+#if WCHAR_MAX > 0xffff
+#    define SPDLOG_UTF_WCHAR32
+#endif
+
+namespace spdlog {
+namespace details {
+namespace utf {
+
+// max UTF-8 chars of a wchar_t
+#ifdef SPDLOG_UTF_WCHAR32
+static const size_t max_utf8_per_wchar = 4;
+#else
+static const size_t max_utf8_per_wchar = 3;
+#endif
+
+// if the 16 wchars of src are ascii, write them to dest
+inline bool narrow_ascii16_(const wchar_t *src, char *dest)
+{
+#if defined(SPDLOG_UTF_SSE2) && defined(SPDLOG_UTF_WCHAR32)
+    const __m128i *in = reinterpret_cast<const __m128i *>(src);
+    __m128i a = _mm_loadu_si128(in), b = _mm_loadu_si128(in + 1), c = _mm_loadu_si128(in + 2), d = _mm_loadu_si128(in + 3);
+    __m128i high = _mm_and_si128(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d)), _mm_set1_epi32(~0x7f));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi32(high, _mm_setzero_si128())) != 0xffff)
+    {
+        return false;
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dest), _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d)));
+    return true;
+#elif defined(SPDLOG_UTF_SSE2)
+    const __m128i *in = reinterpret_cast<const __m128i *>(src);
+    __m128i a = _mm_loadu_si128(in), b = _mm_loadu_si128(in + 1);
+    __m128i high = _mm_and_si128(_mm_or_si128(a, b), _mm_set1_epi16(~0x7f));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi16(high, _mm_setzero_si128())) != 0xffff)
+    {
+        return false;
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dest), _mm_packus_epi16(a, b));
+    return true;
+#elif defined(SPDLOG_UTF_NEON) && defined(SPDLOG_UTF_WCHAR32)
+    const uint32_t *in = reinterpret_cast<const uint32_t *>(src);
+    uint32x4_t a = vld1q_u32(in), b = vld1q_u32(in + 4), c = vld1q_u32(in + 8), d = vld1q_u32(in + 12);
+    if (vmaxvq_u32(vorrq_u32(vorrq_u32(a, b), vorrq_u32(c, d))) >= 0x80)
+    {
+        return false;
+    }
+    uint16x8_t ab = vcombine_u16(vmovn_u32(a), vmovn_u32(b)), cd = vcombine_u16(vmovn_u32(c), vmovn_u32(d));
+    vst1q_u8(reinterpret_cast<uint8_t *>(dest), vcombine_u8(vmovn_u16(ab), vmovn_u16(cd)));
+    return true;
+#elif defined(SPDLOG_UTF_NEON)
+    const uint16_t *in = reinterpret_cast<const uint16_t *>(src);
+    uint16x8_t a = vld1q_u16(in), b = vld1q_u16(in + 8);
+    if (vmaxvq_u16(vorrq_u16(a, b)) >= 0x80)
+    {
+        return false;
+    }
+    vst1q_u8(reinterpret_cast<uint8_t *>(dest), vcombine_u8(vmovn_u16(a), vmovn_u16(b)));
+    return true;
+#else
+    for (int i = 0; i < 16; i++)
+    {
+        if (static_cast<uint32_t>(src[i]) >= 0x80)
+        {
+            return false;
+        }
+    }
+    for (int i = 0; i < 16; i++)
+    {
+        dest[i] = static_cast<char>(src[i]);
+    }
+    return true;
+#endif
+}
+
+// if the 16 chars of src are ascii, write them to dest
+inline bool widen_ascii16_(const char *src, wchar_t *dest)
+{
+#if defined(SPDLOG_UTF_SSE2)
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+    if (_mm_movemask_epi8(bytes) != 0)
+    {
+        return false;
+    }
+    const __m128i zero = _mm_setzero_si128();
+    __m128i lo = _mm_unpacklo_epi8(bytes, zero), hi = _mm_unpackhi_epi8(bytes, zero);
+    __m128i *out = reinterpret_cast<__m128i *>(dest);
+#    ifdef SPDLOG_UTF_WCHAR32
+    _mm_storeu_si128(out, _mm_unpacklo_epi16(lo, zero));
+    _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(lo, zero));
+    _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(hi, zero));
+    _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(hi, zero));
+#    else
+    _mm_storeu_si128(out, lo);
+    _mm_storeu_si128(out + 1, hi);
+#    endif
+    return true;
+#elif defined(SPDLOG_UTF_NEON)
+    uint8x16_t bytes = vld1q_u8(reinterpret_cast<const uint8_t *>(src));
+    if (vmaxvq_u8(bytes) >= 0x80)
+    {
+        return false;
+    }
+    uint16x8_t lo = vmovl_u8(vget_low_u8(bytes)), hi = vmovl_u8(vget_high_u8(bytes));
+#    ifdef SPDLOG_UTF_WCHAR32
+    uint32_t *out = reinterpret_cast<uint32_t *>(dest);
+    vst1q_u32(out, vmovl_u16(vget_low_u16(lo)));
+    vst1q_u32(out + 4, vmovl_u16(vget_high_u16(lo)));
+    vst1q_u32(out + 8, vmovl_u16(vget_low_u16(hi)));
+    vst1q_u32(out + 12, vmovl_u16(vget_high_u16(hi)));
+#    else
+    uint16_t *out = reinterpret_cast<uint16_t *>(dest);
+    vst1q_u16(out, lo);
+    vst1q_u16(out + 8, hi);
+#    endif
+    return true;
+#else
+    for (int i = 0; i < 16; i++)
+    {
+        if (static_cast<unsigned char>(src[i]) >= 0x80)
+        {
+            return false;
+        }
+    }
+    for (int i = 0; i < 16; i++)
+    {
+        dest[i] = static_cast<wchar_t>(src[i]);
+    }
+    return true;
+#endif
+}
+
+// write the UTF-8 of the n wchars of src to dest, and return its size.
+// dest must have room for max_utf8_per_wchar * n chars.
+// Unpaired surrogates and values beyond U+10FFFF are written as U+FFFD (like WideCharToMultiByte).
+inline size_t wide_to_utf8(const wchar_t *src, size_t n, char *dest)
+{
+    char *out = dest;
+    size_t i = 0;
+    while (i < n)
+    {
+        if (i + 16 <= n && narrow_ascii16_(src + i, out))
+        {
+            i += 16;
+            out += 16;
+            continue;
+        }
+        // not (16 of) ascii: the next 16 wchars one code point at a time
+        size_t end = i + 16 < n ? i + 16 : n;
+        while (i < end)
+        {
+            auto c = static_cast<uint32_t>(src[i++]);
+            if (c < 0x80)
+            {
+                *out++ = static_cast<char>(c);
+                continue;
+            }
+            if (c < 0x800)
+            {
+                *out++ = static_cast<char>(0xc0 | (c >> 6));
+                *out++ = static_cast<char>(0x80 | (c & 0x3f));
+                continue;
+            }
+            if (c >= 0xd800 && c < 0xdc00 && i < n && static_cast<uint32_t>(src[i]) >= 0xdc00 && static_cast<uint32_t>(src[i]) < 0xe000)
+            {
+                c = 0x10000 + ((c - 0xd800) << 10) + (static_cast<uint32_t>(src[i++]) - 0xdc00);
+            }
+            else if ((c >= 0xd800 && c < 0xe000) || c > 0x10ffff)
+            {
+                c = 0xfffd;
+            }
+            if (c < 0x10000)
+            {
+                *out++ = static_cast<char>(0xe0 | (c >> 12));
+                *out++ = static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+                *out++ = static_cast<char>(0x80 | (c & 0x3f));
+            }
+            else
+            {
+                *out++ = static_cast<char>(0xf0 | (c >> 18));
+                *out++ = static_cast<char>(0x80 | ((c >> 12) & 0x3f));
+                *out++ = static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+                *out++ = static_cast<char>(0x80 | (c & 0x3f));
+            }
+        }
+    }
+    return static_cast<size_t>(out - dest);
+}
+
+// write the wchars of the n UTF-8 chars of src to dest (room for n wchars needed), and set dest_size to their count.
+// return false if src is not valid UTF-8 (like MultiByteToWideChar with MB_ERR_INVALID_CHARS).
+inline bool utf8_to_wide(const char *src, size_t n, wchar_t *dest, size_t &dest_size)
+{
+    wchar_t *out = dest;
+    size_t i = 0;
+    while (i < n)
+    {
+        if (i + 16 <= n && widen_ascii16_(src + i, out))
+        {
+            i += 16;
+            out += 16;
+            continue;
+        }
+        size_t end = i + 16 < n ? i + 16 : n;
+        while (i < end)
+        {
+            uint32_t c = static_cast<unsigned char>(src[i++]);
+            if (c < 0x80)
+            {
+                *out++ = static_cast<wchar_t>(c);
+                continue;
+            }
+
+            size_t n_continuation;
+            uint32_t min_code_point;
+            if (c >= 0xc2 && c < 0xe0)
+            {
+                n_continuation = 1;
+                min_code_point = 0x80;
+                c &= 0x1f;
+            }
+            else if (c >= 0xe0 && c < 0xf0)
+            {
+                n_continuation = 2;
+                min_code_point = 0x800;
+                c &= 0x0f;
+            }
+            else if (c >= 0xf0 && c < 0xf5)
+            {
+                n_continuation = 3;
+                min_code_point = 0x10000;
+                c &= 0x07;
+            }
+            else
+            {
+                return false;
+            }
+            if (n - i < n_continuation)
+            {
+                return false;
+            }
+            for (size_t k = 0; k < n_continuation; k++)
+            {
+                auto next = static_cast<unsigned char>(src[i++]);
+                if ((next & 0xc0) != 0x80)
+                {
+                    return false;
+                }
+                c = (c << 6) | (next & 0x3f);
+            }
+            // overlong, surrogate or beyond U+10FFFF
+            if (c < min_code_point || (c >= 0xd800 && c < 0xe000) || c > 0x10ffff)
+            {
+                return false;
+            }
+
+#ifdef SPDLOG_UTF_WCHAR32
+            *out++ = static_cast<wchar_t>(c);
+#else
+            if (c >= 0x10000)
+            {
+                *out++ = static_cast<wchar_t>(0xd800 + ((c - 0x10000) >> 10));
+                *out++ = static_cast<wchar_t>(0xdc00 + ((c - 0x10000) & 0x3ff));
+            }
+            else
+            {
+                *out++ = static_cast<wchar_t>(c);
+            }
+#endif
+        }
+    }
+    dest_size = static_cast<size_t>(out - dest);
+    return true;
+}
+
+} // namespace utf
+} // namespace details
+} // namespace spdlog
@@ -0,0 +1,146 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/flight_recorder.h>
+#endif
+
+#include <spdlog/details/flight_recorder.h>
+
+#include <cstring>
+#include <mutex>
+#include <cerrno>
+#include <thread>
+
+#ifndef _WIN32
+#    include <unistd.h>
+#endif
+
+namespace spdlog {
+namespace details {
+namespace flight_recorder_helpers {
+
+#ifndef _WIN32
+// the signal handler writes a byte to the pipe, read by the dump thread (0 stops it)
+struct signal_state
+{
+    std::mutex mutex;
+    int pipe_fds[2]{-1, -1};
+    std::atomic<int> write_fd{-1};
+    std::thread dump_thread;
+    int signal{0};
+    struct sigaction previous;
+};
+
+inline signal_state &state()
+{
+    static signal_state instance;
+    return instance;
+}
+
+inline void on_signal(int)
+{
+    auto fd = state().write_fd.load();
+    if (fd >= 0)
+    {
+        char wake = 1;
+        auto written = ::write(fd, &wake, 1);
+        (void)written;
+    }
+}
+
+inline void dump_loop(int read_fd)
+{
+    char wake = 0;
+    while (::read(read_fd, &wake, 1) == 1 && wake != 0)
+    {
+        SPDLOG_TRY
+        {
+            flight_recorder::instance().dump();
+        }
+        SPDLOG_CATCH_STD
+    }
+}
+
+// restore the previous handler and stop the dump thread
+inline void stop_signal_dumps(signal_state &s)
+{
+    if (s.signal == 0)
+    {
+        return;
+    }
+    ::sigaction(s.signal, &s.previous, nullptr);
+    s.signal = 0;
+    s.write_fd.store(-1);
+    char stop = 0;
+    auto written = ::write(s.pipe_fds[1], &stop, 1);
+    (void)written;
+    s.dump_thread.join();
+    ::close(s.pipe_fds[0]);
+    ::close(s.pipe_fds[1]);
+    s.pipe_fds[0] = s.pipe_fds[1] = -1;
+}
+#endif
+
+} // namespace flight_recorder_helpers
+} // namespace details
+
+SPDLOG_INLINE void enable_flight_recorder(const filename_t &dump_file, level::level_enum record_level, size_t thread_buffer_size)
+{
+    details::flight_recorder::instance().enable(dump_file, record_level, thread_buffer_size);
+}
+
+SPDLOG_INLINE void disable_flight_recorder()
+{
+#ifndef _WIN32
+    auto &s = details::flight_recorder_helpers::state();
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        details::flight_recorder_helpers::stop_signal_dumps(s);
+    }
+#endif
+    details::flight_recorder::instance().disable();
+}
+
+SPDLOG_INLINE void set_flight_recorder_dump_level(level::level_enum dump_level)
+{
+    details::flight_recorder::instance().set_dump_level(dump_level);
+}
+
+SPDLOG_INLINE size_t dump_flight_recorder()
+{
+    return details::flight_recorder::instance().dump();
+}
+
+SPDLOG_INLINE size_t dump_flight_recorder(const filename_t &filename)
+{
+    return details::flight_recorder::instance().dump(filename);
+}
+
+#ifndef _WIN32
+SPDLOG_INLINE void dump_flight_recorder_on_signal(int signal)
+{
+    using namespace details::flight_recorder_helpers;
+    auto &s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    stop_signal_dumps(s);
+    if (::pipe(s.pipe_fds) != 0)
+    {
+        throw_spdlog_ex("dump_flight_recorder_on_signal: failed creating pipe", errno);
+    }
+    s.write_fd.store(s.pipe_fds[1]);
+    s.dump_thread = std::thread(dump_loop, s.pipe_fds[0]);
+
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = on_signal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    ::sigaction(signal, &action, &s.previous);
+    s.signal = signal;
+}
+#endif
+
+} // namespace spdlog
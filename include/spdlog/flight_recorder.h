@@ -0,0 +1,48 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Process wide flight recorder: the recent messages of all the loggers from a record level up (debug by
+// default), whatever the levels of the loggers, kept in a fixed size ring per thread and dumped to a
+// binary log file (see binary_file_sink, read with spdlog-decode) on demand:
+//
+//   spdlog::enable_flight_recorder("logs/flight.bin");   // record debug and above, 64KB per thread
+//   spdlog::dump_flight_recorder_on_signal(SIGUSR2);    // dump on kill -USR2 <pid>
+//   ...
+//   spdlog::dump_flight_recorder();                      // or on any critical message, or now
+//
+// Each thread writes its ring without locks: a record is a copy of the logger name and the payload
+// (the interned payloads and the source locations by address). The key/value fields are not recorded.
+// A dump snapshots all the rings, merged by time, and overwrites the file.
+// Not available with SPDLOG_NO_TLS.
+
+#include <spdlog/common.h>
+
+#include <csignal>
+
+namespace spdlog {
+
+SPDLOG_API void enable_flight_recorder(
+    const filename_t &dump_file, level::level_enum record_level = level::debug, size_t thread_buffer_size = 64 * 1024);
+
+// stop recording and drop the recorded messages
+SPDLOG_API void disable_flight_recorder();
+
+// dump when a message of dump_level or above is logged (level::critical by default). level::off: never.
+SPDLOG_API void set_flight_recorder_dump_level(level::level_enum dump_level);
+
+// write the recorded messages to the dump file (or to filename). return their count.
+SPDLOG_API size_t dump_flight_recorder();
+SPDLOG_API size_t dump_flight_recorder(const filename_t &filename);
+
+#ifndef _WIN32
+// dump when the process receives the signal, from a thread of the recorder (the handler only wakes it up)
+SPDLOG_API void dump_flight_recorder_on_signal(int signal = SIGUSR2);
+#endif
+
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "flight_recorder-inl.h"
+#endif
@@ -5,8 +5,9 @@
 
 #pragma once
 
-#include <cctype>
+#include <algorithm>
 #include <spdlog/common.h>
+#include <spdlog/details/hex_encode.h>
 
 //
 // Support for logging binary data as hex
@@ -123,95 +124,120 @@ struct formatter<spdlog::details::dump_info<T>>
         return it;
     }
 
-    // format the given bytes range as hex
+    // format the given bytes range as hex: rendered line by line into a buffer (see details/hex_encode.h),
+    // written out at once
     template<typename FormatContext, typename Container>
     auto format(const spdlog::details::dump_info<Container> &the_range, FormatContext &ctx) -> decltype(ctx.out())
     {
-        SPDLOG_CONSTEXPR const char *hex_upper = "0123456789ABCDEF";
-        SPDLOG_CONSTEXPR const char *hex_lower = "0123456789abcdef";
-        const char *hex_chars = use_uppercase ? hex_upper : hex_lower;
-
 #if FMT_VERSION < 60000
         auto inserter = ctx.begin();
 #else
         auto inserter = ctx.out();
 #endif
 
-        int size_per_line = static_cast<int>(the_range.size_per_line());
-        auto start_of_line = the_range.begin();
-        for (auto i = the_range.begin(); i != the_range.end(); i++)
+        auto total = static_cast<size_t>(the_range.end() - the_range.begin());
+        auto size_per_line = the_range.size_per_line();
+        // a line, or chunks of the run without newlines
+        size_t chunk_size = put_newlines ? (std::max)(size_per_line, size_t(1)) : 256;
+        auto n_chunks = (total + chunk_size - 1) / chunk_size;
+        unsigned char bytes_storage[256];
+        fmt::basic_memory_buffer<unsigned char, 1> long_line;
+        unsigned char *bytes = bytes_storage;
+        if (chunk_size > sizeof(bytes_storage))
         {
-            auto ch = static_cast<unsigned char>(*i);
+            long_line.resize(chunk_size);
+            bytes = long_line.data();
+        }
 
-            if (put_newlines && (i == the_range.begin() || i - start_of_line >= size_per_line))
+        // room for the eol, position, hex (and slack of encode_delimited()) and padded ascii of each line
+        fmt::basic_memory_buffer<char, 1024> dest;
+        dest.resize(n_chunks * (4 + 2 * sizeof(size_t) + 3 * chunk_size + (show_ascii ? 2 + 4 * chunk_size : 0)) + 2);
+        char *out = dest.data();
+        auto it = the_range.begin();
+        for (size_t pos = 0; pos < total;)
+        {
+            auto n = (std::min)(chunk_size, total - pos);
+            for (size_t i = 0; i < n; i++, ++it)
             {
-                if (show_ascii && i != the_range.begin())
-                {
-                    *inserter++ = delimiter;
-                    *inserter++ = delimiter;
-                    for (auto j = start_of_line; j < i; j++)
-                    {
-                        auto pc = static_cast<unsigned char>(*j);
-                        *inserter++ = std::isprint(pc) ? static_cast<char>(*j) : '.';
-                    }
-                }
-
-                put_newline(inserter, static_cast<size_t>(i - the_range.begin()));
-
-                // put first byte without delimiter in front of it
-                *inserter++ = hex_chars[(ch >> 4) & 0x0f];
-                *inserter++ = hex_chars[ch & 0x0f];
-                start_of_line = i;
-                continue;
+                bytes[i] = static_cast<unsigned char>(*it);
             }
 
+            if (put_newlines)
+            {
+                out = put_newline(out, pos);
+            }
+            else if (put_delimiters)
+            {
+                // without newlines, the first byte is delimited too
+                *out++ = delimiter;
+            }
             if (put_delimiters)
             {
-                *inserter++ = delimiter;
+                spdlog::details::hex::encode_delimited(bytes, n, out, delimiter, use_uppercase);
+                out += 3 * n - 1;
+            }
+            else
+            {
+                spdlog::details::hex::encode(bytes, n, out, use_uppercase);
+                out += 2 * n;
             }
 
-            *inserter++ = hex_chars[(ch >> 4) & 0x0f];
-            *inserter++ = hex_chars[ch & 0x0f];
-        }
-        if (show_ascii) // add ascii to last line
-        {
-            if (the_range.end() - the_range.begin() > size_per_line)
+            if (show_ascii)
             {
-                auto blank_num = size_per_line - (the_range.end() - start_of_line);
-                while (blank_num-- > 0)
+                // align the ascii of a short last line
+                if (total > size_per_line && n < size_per_line)
                 {
-                    *inserter++ = delimiter;
-                    *inserter++ = delimiter;
-                    if (put_delimiters)
-                    {
-                        *inserter++ = delimiter;
-                    }
+                    auto blanks = (size_per_line - n) * (put_delimiters ? 3 : 2);
+                    std::fill(out, out + blanks, delimiter);
+                    out += blanks;
                 }
+                out = put_ascii(out, bytes, n);
             }
-            *inserter++ = delimiter;
-            *inserter++ = delimiter;
-            for (auto j = start_of_line; j != the_range.end(); j++)
-            {
-                auto pc = static_cast<unsigned char>(*j);
-                *inserter++ = std::isprint(pc) ? static_cast<char>(*j) : '.';
-            }
+            pos += n;
         }
-        return inserter;
+        if (show_ascii && total == 0)
+        {
+            out = put_ascii(out, bytes, 0);
+        }
+        return fmt::format_to(inserter, "{}", fmt::string_view(dest.data(), static_cast<size_t>(out - dest.data())));
     }
 
     // put newline(and position header)
-    template<typename It>
-    void put_newline(It inserter, std::size_t pos)
+    char *put_newline(char *out, std::size_t pos)
     {
 #ifdef _WIN32
-        *inserter++ = '\r';
+        *out++ = '\r';
 #endif
-        *inserter++ = '\n';
+        *out++ = '\n';
 
         if (put_positions)
         {
-            fmt::format_to(inserter, "{:04X}: ", pos);
+            // {:04X}
+            size_t n_digits = 4;
+            while (n_digits < 2 * sizeof(size_t) && (pos >> (4 * n_digits)) != 0)
+            {
+                n_digits++;
+            }
+            for (size_t i = n_digits; i > 0; i--)
+            {
+                *out++ = "0123456789ABCDEF"[(pos >> (4 * (i - 1))) & 0x0f];
+            }
+            *out++ = ':';
+            *out++ = ' ';
+        }
+        return out;
+    }
+
+    char *put_ascii(char *out, const unsigned char *bytes, size_t n)
+    {
+        *out++ = delimiter;
+        *out++ = delimiter;
+        for (size_t i = 0; i < n; i++)
+        {
+            // std::isprint() of the "C" locale
+            *out++ = bytes[i] >= 0x20 && bytes[i] < 0x7f ? static_cast<char>(bytes[i]) : '.';
         }
+        return out;
     }
 };
 } // namespace fmt
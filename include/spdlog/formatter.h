@@ -6,6 +6,10 @@
 #include <spdlog/fmt/fmt.h>
 #include <spdlog/details/log_msg.h>
 
+#include <array>
+#include <memory>
+#include <string>
+
 namespace spdlog {
 
 class formatter
@@ -14,5 +18,39 @@ public:
     virtual ~formatter() = default;
     virtual void format(const details::log_msg &msg, memory_buf_t &dest) = 0;
     virtual std::unique_ptr<formatter> clone() const = 0;
+
+    // format msg without copying its payload, for the sinks writing with scatter-gather i/o: the text is
+    // dest[0, payload_pos), msg.payload, then dest[payload_pos, dest.size()). the color range is in dest.
+    // return false if not supported (dest unchanged), the payload is formatted with format() then.
+    virtual bool format_split(const details::log_msg &msg, memory_buf_t &dest, size_t &payload_pos)
+    {
+        (void)msg;
+        (void)dest;
+        (void)payload_pos;
+        return false;
+    }
+
+    // the details::msg_fields read by format(): the messages may be created without the others
+    virtual unsigned required_fields() const
+    {
+        return details::msg_fields::all;
+    }
+
+    // formatters with the same non zero id (see details::make_format_id()) produce the same
+    // text for any message, so the sinks of a logger can share it. 0 if unknown.
+    virtual size_t format_id() const
+    {
+        return 0;
+    }
+
+    // write the color codes straight into the formatted text: codes[msg.level] where the color range starts
+    // and reset where it ends, the color range being left empty - or stop doing so if codes is null.
+    // return false if not supported (the color sinks splice the codes around the color range then).
+    virtual bool set_color_codes(const std::array<std::string, level::n_levels> *codes, string_view_t reset)
+    {
+        (void)codes;
+        (void)reset;
+        return false;
+    }
 };
 } // namespace spdlog
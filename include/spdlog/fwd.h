@@ -3,12 +3,27 @@
 
 #pragma once
 
+// Declarations of the main spdlog types, for the headers that only hold or pass loggers and sinks
+// around (e.g. a std::shared_ptr<spdlog::logger> member) - without the cost of including
+// spdlog/logger.h and fmt.
+
 namespace spdlog {
 class logger;
+class async_logger;
 class formatter;
+class pattern_formatter;
+struct source_loc;
+
+namespace level {
+enum level_enum : int;
+}
 
 namespace sinks {
 class sink;
 }
 
+namespace details {
+class thread_pool;
+}
+
 } // namespace spdlog
@@ -0,0 +1,336 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/json_formatter.h>
+#endif
+
+#include <spdlog/details/fmt_helper.h>
+#include <spdlog/details/format_id.h>
+#include <spdlog/details/log_msg.h>
+#include <spdlog/details/os.h>
+#include <spdlog/details/time_cache.h>
+#include <spdlog/fmt/fmt.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace spdlog {
+namespace details {
+
+namespace json_escape_helpers {
+
+const uint64_t ones = 0x0101010101010101ULL;
+const uint64_t highs = 0x8080808080808080ULL;
+
+// true if any byte of word is zero
+inline bool has_zero_byte(uint64_t word)
+{
+    return ((word - ones) & ~word & highs) != 0;
+}
+
+// true if any byte of word needs escaping (control char, '"' or '\\') - checks 8 chars at once
+inline bool has_special_byte(uint64_t word)
+{
+    // bytes below 0x20 (bytes with the high bit set are not control chars)
+    bool has_control = ((word - ones * 0x20) & ~word & highs) != 0;
+    return has_control || has_zero_byte(word ^ (ones * '"')) || has_zero_byte(word ^ (ones * '\\'));
+}
+
+inline bool is_special_char(unsigned char c)
+{
+    return c < 0x20 || c == '"' || c == '\\';
+}
+
+inline void append_escaped_char(unsigned char c, memory_buf_t &dest)
+{
+    switch (c)
+    {
+    case '"':
+        fmt_helper::append_string_view("\\\"", dest);
+        break;
+    case '\\':
+        fmt_helper::append_string_view("\\\\", dest);
+        break;
+    case '\b':
+        fmt_helper::append_string_view("\\b", dest);
+        break;
+    case '\f':
+        fmt_helper::append_string_view("\\f", dest);
+        break;
+    case '\n':
+        fmt_helper::append_string_view("\\n", dest);
+        break;
+    case '\r':
+        fmt_helper::append_string_view("\\r", dest);
+        break;
+    case '\t':
+        fmt_helper::append_string_view("\\t", dest);
+        break;
+    default: {
+        static const char hex_digits[] = "0123456789abcdef";
+        const char escaped[] = {'\\', 'u', '0', '0', hex_digits[c >> 4], hex_digits[c & 0xf]};
+        dest.append(escaped, escaped + sizeof(escaped));
+        break;
+    }
+    }
+}
+} // namespace json_escape_helpers
+
+// runs of chars that need no escaping (the common case) are found 8 chars at a time
+// and appended in one go.
+SPDLOG_INLINE void json_escape(string_view_t view, memory_buf_t &dest)
+{
+    using namespace json_escape_helpers;
+    const char *data = view.data();
+    const size_t size = view.size();
+    size_t run_start = 0;
+    size_t i = 0;
+    while (i < size)
+    {
+        if (size - i >= sizeof(uint64_t))
+        {
+            uint64_t word;
+            std::memcpy(&word, data + i, sizeof(word));
+            if (!has_special_byte(word))
+            {
+                i += sizeof(word);
+                continue;
+            }
+        }
+
+        auto c = static_cast<unsigned char>(data[i]);
+        if (is_special_char(c))
+        {
+            dest.append(data + run_start, data + i);
+            append_escaped_char(c, dest);
+            run_start = i + 1;
+        }
+        i++;
+    }
+    dest.append(data + run_start, data + size);
+}
+
+} // namespace details
+
+SPDLOG_INLINE json_formatter::json_formatter(pattern_time_type time_type, std::string eol, fields static_fields)
+    : pattern_time_type_(time_type)
+    , eol_(std::move(eol))
+    , static_fields_(std::move(static_fields))
+    , last_log_secs_(std::chrono::seconds::min())
+{
+    memory_buf_t buf;
+    for (const auto &field : static_fields_)
+    {
+        details::fmt_helper::append_string_view(",\"", buf);
+        details::json_escape(field.first, buf);
+        details::fmt_helper::append_string_view("\":\"", buf);
+        details::json_escape(field.second, buf);
+        buf.push_back('"');
+    }
+    details::fmt_helper::append_string_view(",\"message\":\"", buf);
+    message_prefix_ = fmt::to_string(buf);
+    message_suffix_ = "\"}" + eol_;
+    update_logger_("");
+
+    std::string signature("json");
+    signature += '\0';
+    signature += pattern_time_type_ == pattern_time_type::local ? 'l' : 'u';
+    signature += message_prefix_;
+    signature += message_suffix_;
+    format_id_ = details::make_format_id(signature);
+}
+
+SPDLOG_INLINE std::unique_ptr<formatter> json_formatter::clone() const
+{
+    return details::make_unique<json_formatter>(pattern_time_type_, eol_, static_fields_);
+}
+
+SPDLOG_INLINE size_t json_formatter::format_id() const
+{
+    return format_id_;
+}
+
+// the constant parts are pre-rendered, so a message takes only a few appends:
+// time|millis|zone, level, logger|thread id|source location|trace context|key/value fields|mdc fields|static fields|payload|end
+SPDLOG_INLINE void json_formatter::format(const details::log_msg &msg, memory_buf_t &dest)
+{
+    auto secs = std::chrono::duration_cast<std::chrono::seconds>(msg.time.time_since_epoch());
+    if (secs != last_log_secs_)
+    {
+        update_time_(msg);
+        last_log_secs_ = secs;
+    }
+    if (msg.logger_name != string_view_t(last_logger_name_))
+    {
+        update_logger_(msg.logger_name);
+    }
+
+    details::fmt_helper::append_string_view(time_text_, dest);
+    auto millis = details::fmt_helper::time_fraction<std::chrono::milliseconds>(msg.time);
+    details::fmt_helper::pad3(static_cast<uint32_t>(millis.count()), dest);
+    details::fmt_helper::append_string_view(level_text_[static_cast<size_t>(msg.level)], dest);
+    details::fmt_helper::append_string_view(logger_text_, dest);
+    details::fmt_helper::append_int(msg.thread_id, dest);
+
+    if (!msg.source.empty())
+    {
+        details::fmt_helper::append_string_view(",\"file\":\"", dest);
+        details::json_escape(msg.source.filename_view(), dest);
+        details::fmt_helper::append_string_view("\",\"line\":", dest);
+        details::fmt_helper::append_int(msg.source.line, dest);
+        details::fmt_helper::append_string_view(",\"func\":\"", dest);
+        details::json_escape(msg.source.funcname, dest);
+        dest.push_back('"');
+    }
+
+    if (!msg.trace.empty())
+    {
+        details::fmt_helper::append_string_view(",\"trace_id\":\"", dest);
+        details::fmt_helper::append_hex(msg.trace.trace_id, sizeof(msg.trace.trace_id), dest);
+        details::fmt_helper::append_string_view("\",\"span_id\":\"", dest);
+        details::fmt_helper::append_hex(msg.trace.span_id, sizeof(msg.trace.span_id), dest);
+        dest.push_back('"');
+    }
+
+    if (msg.sample_rate != 1)
+    {
+        details::fmt_helper::append_string_view(",\"sample_rate\":", dest);
+        details::fmt_helper::append_int(msg.sample_rate, dest);
+    }
+
+    for (size_t i = 0; i < msg.n_fields; i++)
+    {
+        dest.push_back(',');
+        append_field_(msg.fields[i], dest);
+    }
+
+    if (msg.n_mdc_fields > 0)
+    {
+        details::fmt_helper::append_string_view(",\"mdc\":{", dest);
+        for (size_t i = 0; i < msg.n_mdc_fields; i++)
+        {
+            if (i > 0)
+            {
+                dest.push_back(',');
+            }
+            append_field_(msg.mdc_fields[i], dest);
+        }
+        dest.push_back('}');
+    }
+
+    details::fmt_helper::append_string_view(message_prefix_, dest);
+    details::json_escape(msg.payload, dest);
+    details::fmt_helper::append_string_view(message_suffix_, dest);
+}
+
+// strings are quoted, numbers and booleans are not. inf and nan (not valid json numbers) are written as null.
+SPDLOG_INLINE void json_formatter::append_field_(const field &f, memory_buf_t &dest)
+{
+    dest.push_back('"');
+    details::json_escape(f.key, dest);
+    details::fmt_helper::append_string_view("\":", dest);
+    switch (f.type)
+    {
+    case field::value_type::string:
+        dest.push_back('"');
+        details::json_escape(f.string_value, dest);
+        dest.push_back('"');
+        break;
+    case field::value_type::floating:
+        if (std::isfinite(f.double_value))
+        {
+            details::fmt_helper::append_field_value(f, dest);
+        }
+        else
+        {
+            details::fmt_helper::append_string_view("null", dest);
+        }
+        break;
+    default:
+        details::fmt_helper::append_field_value(f, dest);
+        break;
+    }
+}
+
+SPDLOG_INLINE void json_formatter::update_time_(const details::log_msg &msg)
+{
+    auto tt = log_clock::to_time_t(msg.time);
+    auto tm_time = details::time_cache::instance().get(tt, pattern_time_type_ == pattern_time_type::local);
+
+    memory_buf_t buf;
+    details::fmt_helper::append_string_view("{\"time\":\"", buf);
+    details::fmt_helper::append_int(tm_time.tm_year + 1900, buf);
+    buf.push_back('-');
+    details::fmt_helper::pad2(tm_time.tm_mon + 1, buf);
+    buf.push_back('-');
+    details::fmt_helper::pad2(tm_time.tm_mday, buf);
+    buf.push_back('T');
+    details::fmt_helper::pad2(tm_time.tm_hour, buf);
+    buf.push_back(':');
+    details::fmt_helper::pad2(tm_time.tm_min, buf);
+    buf.push_back(':');
+    details::fmt_helper::pad2(tm_time.tm_sec, buf);
+    buf.push_back('.');
+    time_text_ = fmt::to_string(buf);
+
+    buf.clear();
+    if (pattern_time_type_ == pattern_time_type::utc)
+    {
+        buf.push_back('Z');
+    }
+    else
+    {
+        auto total_minutes = details::time_cache::instance().utc_minutes_offset(tm_time);
+        if (total_minutes < 0)
+        {
+            total_minutes = -total_minutes;
+            buf.push_back('-');
+        }
+        else
+        {
+            buf.push_back('+');
+        }
+        details::fmt_helper::pad2(total_minutes / 60, buf); // hours
+        buf.push_back(':');
+        details::fmt_helper::pad2(total_minutes % 60, buf); // minutes
+    }
+    // the zone rarely changes, and so the level texts
+    if (time_zone_text_.size() != buf.size() || time_zone_text_.compare(0, buf.size(), buf.data(), buf.size()) != 0)
+    {
+        time_zone_text_ = fmt::to_string(buf);
+        update_levels_();
+    }
+}
+
+SPDLOG_INLINE void json_formatter::update_levels_()
+{
+    memory_buf_t buf;
+    for (size_t i = 0; i < level_text_.size(); i++)
+    {
+        buf.clear();
+        details::fmt_helper::append_string_view(time_zone_text_, buf);
+        details::fmt_helper::append_string_view("\",\"level\":\"", buf);
+        details::json_escape(level::to_string_view(static_cast<level::level_enum>(i)), buf);
+        details::fmt_helper::append_string_view("\",\"logger\":\"", buf);
+        level_text_[i] = fmt::to_string(buf);
+    }
+}
+
+SPDLOG_INLINE void json_formatter::update_logger_(string_view_t logger_name)
+{
+    last_logger_name_.assign(logger_name.data(), logger_name.size());
+    memory_buf_t buf;
+    details::json_escape(logger_name, buf);
+    details::fmt_helper::append_string_view("\",\"thread\":", buf);
+    logger_text_ = fmt::to_string(buf);
+}
+} // namespace spdlog
@@ -0,0 +1,81 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <spdlog/common.h>
+#include <spdlog/details/log_msg.h>
+#include <spdlog/details/os.h>
+#include <spdlog/formatter.h>
+
+#include <array>
+#include <chrono>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace spdlog {
+namespace details {
+
+// append view to dest as the contents of a json string (without the quotes).
+// '"', '\\' and control chars are escaped, anything else (including utf-8) is copied as is.
+SPDLOG_API void json_escape(string_view_t view, memory_buf_t &dest);
+
+} // namespace details
+
+// formats each message as a single line json object, e.g.
+// {"time":"2021-03-01T12:34:56.789+02:00","level":"info","logger":"app","thread":1234,"message":"hello"}
+// "file", "line" and "func" are added if the message has a source location, "trace_id" and "span_id" if it has
+// a trace context (see spdlog::set_trace_context), "sample_rate" if it was sampled,
+// then the message's key/value fields (see spdlog::kv()) with their json types, the mdc fields (see spdlog/mdc.h)
+// as an "mdc" object,
+// and the given static fields (string values only) just before "message".
+// Everything but the time's millis, the thread id, the source location and the
+// message is escaped up front, so only the payload is escaped per message.
+class SPDLOG_API json_formatter final : public formatter
+{
+public:
+    using fields = std::vector<std::pair<std::string, std::string>>;
+
+    explicit json_formatter(
+        pattern_time_type time_type = pattern_time_type::local, std::string eol = spdlog::details::os::default_eol, fields static_fields = fields());
+
+    json_formatter(const json_formatter &other) = delete;
+    json_formatter &operator=(const json_formatter &other) = delete;
+
+    std::unique_ptr<formatter> clone() const override;
+    void format(const details::log_msg &msg, memory_buf_t &dest) override;
+    // shared by json formatters with the same time type, eol and static fields
+    size_t format_id() const override;
+
+private:
+    pattern_time_type pattern_time_type_;
+    std::string eol_;
+    fields static_fields_;
+    // from the end of the time to the logger name, for each level: `+02:00","level":"info","logger":"` (or `Z",...` for utc)
+    std::array<std::string, level::n_levels> level_text_;
+    std::string message_prefix_; // `,"service":"api","message":"` - the static fields, serialized
+    std::string message_suffix_; // `"}` and the eol
+    size_t format_id_;
+
+    // `{"time":"2021-03-01T12:34:56.` of the last second seen
+    std::chrono::seconds last_log_secs_;
+    std::string time_text_;
+    std::string time_zone_text_;
+
+    // `name","thread":` of the last logger seen
+    std::string last_logger_name_;
+    std::string logger_text_;
+
+    static void append_field_(const field &f, memory_buf_t &dest);
+    void update_time_(const details::log_msg &msg);
+    void update_levels_();
+    void update_logger_(string_view_t logger_name);
+};
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "json_formatter-inl.h"
+#endif
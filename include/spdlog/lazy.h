@@ -0,0 +1,62 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <spdlog/fmt/fmt.h>
+
+#include <type_traits>
+#include <utility>
+
+// Lazy evaluation of a log argument: the function is called when the message is formatted, so not at all
+// if the message is not logged (e.g. below the logger level or the sinks levels).
+//
+// Usage:
+//
+// logger->debug("state {}", spdlog::lazy([&] { return expensive_dump(); }));
+// logger->trace("{:>8.3f}", spdlog::lazy([&] { return compute_ratio(); }));  => formatted as the result
+//
+// The function is called on the logging thread (the lazy args are not formatted by the async workers),
+// so it may capture by reference. Its result is formatted with the format spec of the placeholder.
+
+namespace spdlog {
+namespace details {
+
+template<typename F>
+class lazy_arg
+{
+public:
+    using result_type = typename std::decay<decltype(std::declval<const F &>()())>::type;
+
+    explicit lazy_arg(F fn)
+        : fn_(std::move(fn))
+    {}
+
+    result_type operator()() const
+    {
+        return fn_();
+    }
+
+private:
+    F fn_;
+};
+} // namespace details
+
+template<typename F>
+inline details::lazy_arg<typename std::decay<F>::type> lazy(F &&fn)
+{
+    return details::lazy_arg<typename std::decay<F>::type>(std::forward<F>(fn));
+}
+} // namespace spdlog
+
+namespace fmt {
+template<typename F, typename Char>
+struct formatter<spdlog::details::lazy_arg<F>, Char> : formatter<typename spdlog::details::lazy_arg<F>::result_type, Char>
+{
+    template<typename FormatContext>
+    auto format(const spdlog::details::lazy_arg<F> &arg, FormatContext &ctx) -> decltype(ctx.out())
+    {
+        return formatter<typename spdlog::details::lazy_arg<F>::result_type, Char>::format(arg(), ctx);
+    }
+};
+} // namespace fmt
@@ -0,0 +1,119 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Collect lines into one contiguous buffer and log them at once (see logger::log_lines()), e.g. to dump a table:
+//
+// {
+//     spdlog::log_batch batch(*logger, spdlog::level::info);
+//     for (auto &c : connections)
+//     {
+//         batch.add("{:<21} {:>10} {:>10}", c.peer, c.bytes_in, c.bytes_out);
+//     }
+// }                                                 => one message per line, submitted by the destructor
+//
+// Instead of a level check, a clock read and a queue operation per line, the lines take one of each:
+// the sinks take their lock once and an async logger queues them as a single message.
+// The lines are stamped with the time of the submission, or each with the time it was added (per_line_time).
+// A batch of a disabled level formats nothing. Not thread safe: a batch is filled by one thread.
+
+#include <spdlog/common.h>
+#include <spdlog/logger.h>
+#include <spdlog/details/log_lines.h>
+#include <spdlog/details/os.h>
+
+#include <vector>
+
+namespace spdlog {
+
+class log_batch
+{
+public:
+    log_batch(logger &l, level::level_enum lvl, bool per_line_time = false, source_loc loc = source_loc{})
+        : logger_(l)
+        , level_(lvl)
+        , per_line_time_(per_line_time)
+        , loc_(loc)
+        , enabled_(l.should_log(lvl) || l.should_backtrace() || details::thread_tail_buffer() != nullptr ||
+                   details::flight_records(lvl))
+    {}
+
+    log_batch(const log_batch &) = delete;
+    log_batch &operator=(const log_batch &) = delete;
+
+    ~log_batch()
+    {
+        submit();
+    }
+
+    // add a line formatted from the format string and args
+    template<typename... Args>
+    void add(fmt::format_string<Args...> fmt, Args &&...args)
+    {
+        if (enabled_)
+        {
+            add_formatted_(fmt, args...);
+        }
+    }
+
+    // add a line as is
+    void add_line(string_view_t line)
+    {
+        if (enabled_)
+        {
+            text_.append(line.data(), line.data() + line.size());
+            push_line_(line.size());
+        }
+    }
+
+    // the number of lines not submitted yet
+    size_t size() const
+    {
+        return lines_.size();
+    }
+
+    // log the lines added so far. the batch can be filled again.
+    void submit()
+    {
+        if (lines_.empty())
+        {
+            return;
+        }
+        if (!per_line_time_)
+        {
+            auto now = details::os::now();
+            for (auto &line : lines_)
+            {
+                line.time = now;
+            }
+        }
+        logger_.log_lines(loc_, level_, string_view_t(text_.data(), text_.size()), lines_.data(), lines_.size());
+        text_.clear();
+        lines_.clear();
+    }
+
+private:
+    logger &logger_;
+    level::level_enum level_;
+    bool per_line_time_;
+    source_loc loc_;
+    bool enabled_;
+    memory_buf_t text_;
+    std::vector<details::log_line> lines_;
+
+    template<typename... Args>
+    void add_formatted_(string_view_t fmt, Args &...args)
+    {
+        auto size = text_.size();
+        fmt::detail::vformat_to(text_, fmt, fmt::make_format_args(args...));
+        push_line_(text_.size() - size);
+    }
+
+    void push_line_(size_t size)
+    {
+        lines_.push_back(details::log_line{size, per_line_time_ ? details::os::now() : log_clock::time_point{}});
+    }
+};
+
+} // namespace spdlog
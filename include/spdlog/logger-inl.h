@@ -9,9 +9,15 @@
 
 #include <spdlog/sinks/sink.h>
 #include <spdlog/details/backtracer.h>
+#include <spdlog/details/call_site.h>
+#include <spdlog/details/usdt.h>
 #include <spdlog/pattern_formatter.h>
 
+#include <algorithm>
 #include <cstdio>
+#include <thread>
+#include <typeinfo>
+#include <utility>
 
 namespace spdlog {
 
@@ -21,18 +27,47 @@ SPDLOG_INLINE logger::logger(const logger &other)
     , sinks_(other.sinks_)
     , level_(other.level_.load(std::memory_order_relaxed))
     , flush_level_(other.flush_level_.load(std::memory_order_relaxed))
+    , sample_rate_(other.sample_rate_.load(std::memory_order_relaxed))
+    , max_payload_bytes_(other.max_payload_bytes_.load(std::memory_order_relaxed))
     , custom_err_handler_(other.custom_err_handler_)
     , tracer_(other.tracer_)
-{}
+    , deferred_format_(other.deferred_format_.load(std::memory_order_relaxed))
+    , in_place_format_(other.in_place_format_)
+    , required_msg_fields_(other.required_msg_fields_)
+{
+    if (other.flush_controller_)
+    {
+        reset_flush_controller_(other.flush_controller_->policy());
+    }
+}
 
 SPDLOG_INLINE logger::logger(logger &&other) SPDLOG_NOEXCEPT : name_(std::move(other.name_)),
                                                                sinks_(std::move(other.sinks_)),
                                                                level_(other.level_.load(std::memory_order_relaxed)),
                                                                flush_level_(other.flush_level_.load(std::memory_order_relaxed)),
+                                                               sample_rate_(other.sample_rate_.load(std::memory_order_relaxed)),
+                                                               max_payload_bytes_(other.max_payload_bytes_.load(std::memory_order_relaxed)),
                                                                custom_err_handler_(std::move(other.custom_err_handler_)),
-                                                               tracer_(std::move(other.tracer_))
+                                                               tracer_(std::move(other.tracer_)),
+                                                               deferred_format_(other.deferred_format_.load(std::memory_order_relaxed)),
+                                                               in_place_format_(other.in_place_format_),
+                                                               required_msg_fields_(other.required_msg_fields_)
+
+{
+    // its timer flushes this logger from now on
+    flush_controller_ = std::move(other.flush_controller_);
+    if (flush_controller_)
+    {
+        flush_controller_->rebind(this);
+    }
+}
 
-{}
+// a new logger may be created at the same address: the call sites must not keep what they cached for this one
+SPDLOG_INLINE logger::~logger()
+{
+    flush_controller_.reset();
+    details::call_site::invalidate_all();
+}
 
 SPDLOG_INLINE logger &logger::operator=(logger other) SPDLOG_NOEXCEPT
 {
@@ -42,6 +77,15 @@ SPDLOG_INLINE logger &logger::operator=(logger other) SPDLOG_NOEXCEPT
 
 SPDLOG_INLINE void logger::swap(spdlog::logger &other) SPDLOG_NOEXCEPT
 {
+    // the timers flush none of the loggers while swapped, then their new one
+    if (flush_controller_)
+    {
+        flush_controller_->rebind(nullptr);
+    }
+    if (other.flush_controller_)
+    {
+        other.flush_controller_->rebind(nullptr);
+    }
     name_.swap(other.name_);
     sinks_.swap(other.sinks_);
 
@@ -55,8 +99,26 @@ SPDLOG_INLINE void logger::swap(spdlog::logger &other) SPDLOG_NOEXCEPT
     my_level = flush_level_.exchange(other_level);
     other.flush_level_.store(my_level);
 
+    other.sample_rate_.store(sample_rate_.exchange(other.sample_rate_.load()));
+    other.max_payload_bytes_.store(max_payload_bytes_.exchange(other.max_payload_bytes_.load()));
+
+    flush_controller_.swap(other.flush_controller_);
     custom_err_handler_.swap(other.custom_err_handler_);
     std::swap(tracer_, other.tracer_);
+    other.deferred_format_.store(deferred_format_.exchange(other.deferred_format_.load()));
+    std::swap(in_place_format_, other.in_place_format_);
+    std::swap(required_msg_fields_, other.required_msg_fields_);
+    sinks_level_generation_.store(0, std::memory_order_relaxed);
+    other.sinks_level_generation_.store(0, std::memory_order_relaxed);
+    if (flush_controller_)
+    {
+        flush_controller_->rebind(this);
+    }
+    if (other.flush_controller_)
+    {
+        other.flush_controller_->rebind(&other);
+    }
+    details::call_site::invalidate_all();
 }
 
 SPDLOG_INLINE void swap(logger &a, logger &b)
@@ -67,6 +129,7 @@ SPDLOG_INLINE void swap(logger &a, logger &b)
 SPDLOG_INLINE void logger::set_level(level::level_enum log_level)
 {
     level_.store(log_level);
+    details::call_site::invalidate_all();
 }
 
 SPDLOG_INLINE level::level_enum logger::level() const
@@ -74,6 +137,31 @@ SPDLOG_INLINE level::level_enum logger::level() const
     return static_cast<level::level_enum>(level_.load(std::memory_order_relaxed));
 }
 
+SPDLOG_INLINE void logger::set_sample_rate(uint32_t sample_rate)
+{
+    sample_rate_.store(sample_rate);
+}
+
+SPDLOG_INLINE uint32_t logger::sample_rate() const
+{
+    return sample_rate_.load(std::memory_order_relaxed);
+}
+
+SPDLOG_INLINE void logger::set_max_payload_bytes(size_t max_bytes)
+{
+    max_payload_bytes_.store(max_bytes);
+}
+
+SPDLOG_INLINE size_t logger::max_payload_bytes() const
+{
+    return max_payload_bytes_.load(std::memory_order_relaxed);
+}
+
+SPDLOG_INLINE size_t logger::truncated_messages() const
+{
+    return truncated_.load(std::memory_order_relaxed);
+}
+
 SPDLOG_INLINE const std::string &logger::name() const
 {
     return name_;
@@ -105,15 +193,17 @@ SPDLOG_INLINE void logger::set_pattern(std::string pattern, pattern_time_type ti
 }
 
 // create new backtrace sink and move to it all our child sinks
-SPDLOG_INLINE void logger::enable_backtrace(size_t n_messages)
+SPDLOG_INLINE void logger::enable_backtrace(size_t n_messages, bool per_thread)
 {
-    tracer_.enable(n_messages);
+    tracer_.enable(n_messages, per_thread);
+    details::call_site::invalidate_all();
 }
 
 // restore orig sinks and level and delete the backtrace sink
 SPDLOG_INLINE void logger::disable_backtrace()
 {
     tracer_.disable();
+    details::call_site::invalidate_all();
 }
 
 SPDLOG_INLINE void logger::dump_backtrace()
@@ -121,12 +211,106 @@ SPDLOG_INLINE void logger::dump_backtrace()
     dump_backtrace_();
 }
 
+SPDLOG_INLINE void logger::dump_thread_backtrace()
+{
+    dump_backtrace_(true);
+}
+
+SPDLOG_INLINE size_t logger::backtrace_memory_used() const
+{
+    return tracer_.memory_used();
+}
+
 // flush functions
 SPDLOG_INLINE void logger::flush()
 {
     flush_();
 }
 
+SPDLOG_INLINE bool logger::sinks_accept_(level::level_enum msg_level) const
+{
+    auto generation = sinks::sink::level_generation();
+    if (generation != sinks_level_generation_.load(std::memory_order_relaxed) ||
+        sinks_.size() != sinks_level_count_.load(std::memory_order_relaxed))
+    {
+        // without sinks, the messages may still be sunk by a derived logger
+        auto lowest = sinks_.empty() ? level::trace : level::off;
+        for (auto &sink : sinks_)
+        {
+            lowest = (std::min)(lowest, sink->level());
+        }
+        sinks_level_.store(lowest, std::memory_order_relaxed);
+        sinks_level_count_.store(sinks_.size(), std::memory_order_relaxed);
+        sinks_level_generation_.store(generation, std::memory_order_relaxed);
+    }
+    return msg_level >= sinks_level_.load(std::memory_order_relaxed);
+}
+
+SPDLOG_INLINE void logger::flush_batched_(std::vector<details::flush_batch> &batches)
+{
+    if (typeid(*this) != typeid(logger))
+    {
+        flush();
+        return;
+    }
+    auto it = std::find_if(
+        batches.begin(), batches.end(), [](const details::flush_batch &batch) { return batch.post == &logger::post_flush_batch_; });
+    if (it == batches.end())
+    {
+        batches.push_back(details::flush_batch{nullptr, {}, &logger::post_flush_batch_, nullptr});
+        it = batches.end() - 1;
+    }
+    it->loggers.push_back(this);
+}
+
+SPDLOG_INLINE std::future<void> logger::post_flush_batch_(const details::flush_batch &batch, size_t threads)
+{
+    // the distinct sinks, each flushed by the first logger having it (with its error handler)
+    std::vector<std::pair<sinks::sink *, logger *>> sinks;
+    for (auto *l : batch.loggers)
+    {
+        l->on_flush_();
+        for (auto &sink : l->sinks_)
+        {
+            auto same = [&](const std::pair<sinks::sink *, logger *> &s) { return s.first == sink.get(); };
+            if (std::find_if(sinks.begin(), sinks.end(), same) == sinks.end())
+            {
+                sinks.emplace_back(sink.get(), l);
+            }
+        }
+    }
+    auto flush_range = [&sinks](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            sinks[i].second->flush_sink_(*sinks[i].first);
+        }
+    };
+    threads = (std::max)(size_t{1}, (std::min)(threads, sinks.size()));
+    auto per_thread = (sinks.size() + threads - 1) / threads;
+    std::vector<std::thread> flushers;
+    for (size_t t = 1; t < threads; t++)
+    {
+        flushers.emplace_back(flush_range, t * per_thread, (std::min)(sinks.size(), (t + 1) * per_thread));
+    }
+    flush_range(0, (std::min)(sinks.size(), per_thread));
+    for (auto &flusher : flushers)
+    {
+        flusher.join();
+    }
+    std::promise<void> flushed;
+    flushed.set_value();
+    return flushed.get_future();
+}
+
+SPDLOG_INLINE void logger::flush_sink_(sinks::sink &sink)
+{
+    SPDLOG_TRY
+    {
+        sink.flush();
+    }
+    SPDLOG_LOGGER_CATCH()
+}
+
 SPDLOG_INLINE void logger::flush_on(level::level_enum log_level)
 {
     flush_level_.store(log_level);
@@ -137,6 +321,19 @@ SPDLOG_INLINE level::level_enum logger::flush_level() const
     return static_cast<level::level_enum>(flush_level_.load(std::memory_order_relaxed));
 }
 
+SPDLOG_INLINE void logger::set_flush_policy(const flush_policy &policy)
+{
+    flush_level_.store(policy.level);
+    reset_flush_controller_(policy);
+}
+
+SPDLOG_INLINE flush_policy logger::get_flush_policy() const
+{
+    auto policy = flush_controller_ ? flush_controller_->policy() : flush_policy{};
+    policy.level = flush_level();
+    return policy;
+}
+
 // sinks
 SPDLOG_INLINE const std::vector<sink_ptr> &logger::sinks() const
 {
@@ -145,6 +342,8 @@ SPDLOG_INLINE const std::vector<sink_ptr> &logger::sinks() const
 
 SPDLOG_INLINE std::vector<sink_ptr> &logger::sinks()
 {
+    // may be changed by the caller
+    sinks_level_generation_.store(0, std::memory_order_relaxed);
     return sinks_;
 }
 
@@ -162,34 +361,219 @@ SPDLOG_INLINE std::shared_ptr<logger> logger::clone(std::string logger_name)
     return cloned;
 }
 
+SPDLOG_INLINE details::profile_stats logger::profile_stats() const
+{
+    return profile_.snapshot();
+}
+
 // protected methods
-SPDLOG_INLINE void logger::log_it_(const spdlog::details::log_msg &log_msg, bool log_enabled, bool traceback_enabled)
+// per thread xorshift64, seeded from its address.
+// with SPDLOG_NO_TLS, splitmix64 of a shared counter (a relaxed fetch_add per call).
+SPDLOG_INLINE uint64_t logger::next_random_()
+{
+#ifndef SPDLOG_NO_TLS
+    static thread_local uint64_t state = 0;
+    if (state == 0)
+    {
+        state = reinterpret_cast<uintptr_t>(&state) | 1;
+    }
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+#else
+    static std::atomic<uint64_t> counter{0};
+    auto z = counter.fetch_add(0x9e3779b97f4a7c15ULL, std::memory_order_relaxed) + 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+#endif
+}
+
+SPDLOG_INLINE unsigned logger::msg_fields_(bool traceback_enabled) const
+{
+    unsigned fields = required_msg_fields_;
+    if (traceback_enabled || flush_controller_ || fields == details::msg_fields::all)
+    {
+        return details::msg_fields::all;
+    }
+    for (auto &sink : sinks_)
+    {
+        fields |= sink->required_fields();
+    }
+    return fields;
+}
+
+SPDLOG_INLINE void logger::log_lines(
+    source_loc loc, level::level_enum lvl, string_view_t text, const details::log_line *lines, size_t n_lines)
+{
+    bool log_enabled = log_enabled_(lvl);
+    bool traceback_enabled = tracer_.enabled();
+    auto *tail = tail_of_(lvl, log_enabled);
+    bool recorded = details::flight_records(lvl);
+    if (n_lines == 0 || (!log_enabled && !traceback_enabled && tail == nullptr && !recorded))
+    {
+        return;
+    }
+    SPDLOG_TRY
+    {
+        details::log_msg msg(lines[0].time, loc, name_, lvl, text);
+        msg.sample_rate = sample_rate_of_(lvl);
+        auto lines_view = details::log_lines_view(lines, n_lines);
+        if (log_enabled)
+        {
+            SPDLOG_USDT_PROBE3(log, name_.c_str(), static_cast<int>(lvl), text.size());
+            sink_lines_(msg, lines_view);
+        }
+        // kept line by line by the backtrace, the tail sampling scope or the flight recorder
+        if (traceback_enabled || tail != nullptr || recorded)
+        {
+            details::foreach_log_line(
+                msg, lines_view, [&](const details::log_msg &line_msg) { log_it_(line_msg, false, traceback_enabled, tail); });
+        }
+    }
+    SPDLOG_LOGGER_CATCH()
+}
+
+SPDLOG_INLINE void logger::log_it_(
+    const spdlog::details::log_msg &log_msg, bool log_enabled, bool traceback_enabled, details::tail_buffer *tail)
 {
+    auto max_payload = max_payload_bytes_.load(std::memory_order_relaxed);
+    if (max_payload != 0 && log_msg.payload.size() > max_payload)
+    {
+        details::scoped_buffer scoped_buf;
+        auto &buf = scoped_buf.get();
+        details::copy_capped(log_msg.payload, max_payload, buf);
+        truncated_.fetch_add(1, std::memory_order_relaxed);
+        auto capped = log_msg;
+        capped.payload = string_view_t(buf.data(), buf.size());
+        capped.payload_id = 0;
+        log_it_(capped, log_enabled, traceback_enabled, tail);
+        return;
+    }
     if (log_enabled)
     {
-        sink_it_(log_msg);
+#ifdef SPDLOG_CALL_SITE_STATS
+        details::call_site_count::count_payload(log_msg.payload.size());
+#endif
+        SPDLOG_USDT_PROBE3(log, name_.c_str(), static_cast<int>(log_msg.level), log_msg.payload.size());
+        auto rate = sample_rate_of_(log_msg.level);
+        if (rate != 1)
+        {
+            auto sampled_msg = log_msg;
+            sampled_msg.sample_rate = rate;
+            sink_it_(sampled_msg);
+        }
+        else
+        {
+            sink_it_(log_msg);
+        }
     }
     if (traceback_enabled)
     {
         tracer_.push_back(log_msg);
     }
+    if (tail != nullptr && !log_enabled)
+    {
+        tail->push_back(this, log_msg);
+    }
+    if (details::flight_records(log_msg.level))
+    {
+        details::flight_recorder::instance().record(log_msg);
+    }
+}
+
+SPDLOG_INLINE bool logger::sink_deferred_(const details::log_msg &, details::deferred_format_fn, const void *, size_t)
+{
+    return false;
+}
+
+SPDLOG_INLINE bool logger::sink_in_place_(const details::log_msg &, fmt::format_args, size_t &)
+{
+    return false;
+}
+
+SPDLOG_INLINE void logger::log_to_sinks_(const details::log_msg &msg)
+{
+    details::profile_timer timer;
+    if (sinks_.size() == 1)
+    {
+        auto &sink = sinks_.front();
+        if (sink->should_log(msg.level))
+        {
+            SPDLOG_TRY
+            {
+                sink->log(msg);
+            }
+            SPDLOG_LOGGER_CATCH()
+        }
+        else
+        {
+            sink->profile_counters().on_filtered();
+        }
+    }
+    else
+    {
+        // sinks with equivalent formatters share the text formatted by the first of them
+        details::shared_format shared;
+        for (auto &sink : sinks_)
+        {
+            if (sink->should_log(msg.level))
+            {
+                SPDLOG_TRY
+                {
+                    sink->log_shared(msg, shared);
+                }
+                SPDLOG_LOGGER_CATCH()
+            }
+            else
+            {
+                sink->profile_counters().on_filtered();
+            }
+        }
+    }
+    profile_.on_dispatched(timer);
 }
 
 SPDLOG_INLINE void logger::sink_it_(const details::log_msg &msg)
 {
+    log_to_sinks_(msg);
+
+    if (flush_due_(msg))
+    {
+        flush_();
+    }
+}
+
+// one batch per sink, then at most one flush
+SPDLOG_INLINE void logger::sink_lines_(const details::log_msg &msg, string_view_t lines)
+{
+    std::vector<details::log_msg> msgs;
+    details::log_lines_to_msgs(msg, lines, msgs);
+    details::profile_timer timer;
     for (auto &sink : sinks_)
     {
         if (sink->should_log(msg.level))
         {
             SPDLOG_TRY
             {
-                sink->log(msg);
+                sink->log_batch(msgs.data(), msgs.size());
             }
             SPDLOG_LOGGER_CATCH()
         }
+        else
+        {
+            sink->profile_counters().on_filtered();
+        }
     }
+    profile_.on_dispatched(timer);
 
-    if (should_flush_(msg))
+    bool flush = false;
+    for (auto &line_msg : msgs)
+    {
+        flush = flush_due_(line_msg) || flush;
+    }
+    if (flush)
     {
         flush_();
     }
@@ -197,6 +581,8 @@ SPDLOG_INLINE void logger::sink_it_(const details::log_msg &msg)
 
 SPDLOG_INLINE void logger::flush_()
 {
+    details::profile_timer timer;
+    on_flush_();
     for (auto &sink : sinks_)
     {
         SPDLOG_TRY
@@ -205,15 +591,24 @@ SPDLOG_INLINE void logger::flush_()
         }
         SPDLOG_LOGGER_CATCH()
     }
+    profile_.on_flushed(timer);
 }
 
-SPDLOG_INLINE void logger::dump_backtrace_()
+SPDLOG_INLINE void logger::dump_backtrace_(bool thread_only)
 {
     using details::log_msg;
     if (tracer_.enabled())
     {
         sink_it_(log_msg{name(), level::info, "****************** Backtrace Start ******************"});
-        tracer_.foreach_pop([this](const log_msg &msg) { this->sink_it_(msg); });
+        auto sink_msg = [this](const log_msg &msg) { this->sink_it_(msg); };
+        if (thread_only)
+        {
+            tracer_.foreach_pop_thread(sink_msg);
+        }
+        else
+        {
+            tracer_.foreach_pop(sink_msg);
+        }
         sink_it_(log_msg{name(), level::info, "****************** Backtrace End ********************"});
     }
 }
@@ -224,6 +619,36 @@ SPDLOG_INLINE bool logger::should_flush_(const details::log_msg &msg)
     return (msg.level >= flush_level) && (msg.level != level::off);
 }
 
+SPDLOG_INLINE bool logger::flush_due_(const details::log_msg &msg)
+{
+    if (flush_controller_)
+    {
+        return flush_controller_->on_message(msg, should_flush_(msg));
+    }
+    return should_flush_(msg);
+}
+
+SPDLOG_INLINE void logger::on_flush_()
+{
+    if (flush_controller_)
+    {
+        flush_controller_->on_flush();
+    }
+}
+
+SPDLOG_INLINE void logger::reset_flush_controller_(const flush_policy &policy)
+{
+    flush_controller_.reset();
+    if (!details::flush_controller::needed(policy))
+    {
+        return;
+    }
+    flush_controller_ = details::make_unique<details::flush_controller>(
+        policy, [](void *target) { static_cast<logger *>(target)->flush_(); }, nullptr);
+    // bound once stored: its timer may fire meanwhile
+    flush_controller_->rebind(this);
+}
+
 SPDLOG_INLINE void logger::err_handler_(const std::string &msg)
 {
     if (custom_err_handler_)
@@ -3,7 +3,7 @@
 
 #pragma once
 
-// Thread safe logger (except for set_error_handler())
+// Thread safe logger (except for set_error_handler() and set_flush_policy())
 // Has name, log level, vector of std::shared sink pointers and formatter
 // Upon each log write the logger:
 // 1. Checks if its log level is enough to log the message and if yes:
@@ -17,14 +17,23 @@
 #include <spdlog/common.h>
 #include <spdlog/details/log_msg.h>
 #include <spdlog/details/backtracer.h>
+#include <spdlog/details/deferred_format.h>
+#include <spdlog/details/flush_controller.h>
+#include <spdlog/details/intern_table.h>
+#include <spdlog/details/log_lines.h>
+#include <spdlog/details/payload_cap.h>
+#include <spdlog/details/profile_stats.h>
+#include <spdlog/details/scoped_buffer.h>
+#include <spdlog/details/flight_recorder.h>
+#include <spdlog/details/tail_buffer.h>
 
 #ifdef SPDLOG_WCHAR_TO_UTF8_SUPPORT
-#    ifndef _WIN32
-#        error SPDLOG_WCHAR_TO_UTF8_SUPPORT only supported on windows
-#    endif
 #    include <spdlog/details/os.h>
 #endif
 
+#include <algorithm>
+#include <atomic>
+#include <future>
 #include <vector>
 
 // clang-format off
@@ -46,8 +55,32 @@
 
 namespace spdlog {
 
+class logger;
+
+namespace details {
+class registry;
+
+// Loggers flushed at once by registry::flush_all(): the plain loggers, and the async loggers of each
+// thread pool (see logger::flush_batched_()). the functions are set by the loggers that created the batch.
+struct flush_batch
+{
+    std::shared_ptr<void> owner; // the thread pool of the async loggers
+    // kept alive by the caller until posted
+    std::vector<logger *> loggers;
+    // flush the distinct sinks of the loggers once - the plain loggers with up to the given number of
+    // threads. the future is ready once they are flushed.
+    std::future<void> (*post)(const flush_batch &batch, size_t threads);
+    // drop the messages not written yet (e.g. past the shutdown deadline) - null if none can be pending
+    void (*abandon)(const flush_batch &batch);
+};
+} // namespace details
+
 class SPDLOG_API logger
 {
+    // sinks the messages of the tail sampling scopes
+    friend class details::tail_buffer;
+    friend class details::registry;
+
 public:
     // Empty logger
     explicit logger(std::string name)
@@ -72,7 +105,7 @@ public:
         : logger(std::move(name), sinks.begin(), sinks.end())
     {}
 
-    virtual ~logger() = default;
+    virtual ~logger();
 
     logger(const logger &other);
     logger(logger &&other) SPDLOG_NOEXCEPT;
@@ -91,6 +124,21 @@ public:
         log(source_loc{}, lvl, fmt, std::forward<Args>(args)...);
     }
 
+#ifdef SPDLOG_FMT_COMPILE
+    // format strings compiled with FMT_COMPILE (see SPDLOG_FMT_COMPILE in tweakme.h)
+    template<typename S, typename... Args, typename std::enable_if<is_compiled_format_string<S>::value, int>::type = 0>
+    void log(source_loc loc, level::level_enum lvl, const S &fmt, Args &&...args)
+    {
+        log_compiled_(loc, lvl, fmt, std::forward<Args>(args)...);
+    }
+
+    template<typename S, typename... Args, typename std::enable_if<is_compiled_format_string<S>::value, int>::type = 0>
+    void log(level::level_enum lvl, const S &fmt, Args &&...args)
+    {
+        log(source_loc{}, lvl, fmt, std::forward<Args>(args)...);
+    }
+#endif
+
     template<typename T>
     void log(level::level_enum lvl, const T &msg)
     {
@@ -101,7 +149,7 @@ public:
     template<class T, typename std::enable_if<std::is_convertible<const T &, spdlog::string_view_t>::value, int>::type = 0>
     void log(source_loc loc, level::level_enum lvl, const T &msg)
     {
-        log(loc, lvl, string_view_t{msg});
+        log_string_(loc, lvl, string_view_t{msg}, std::is_array<T>{}, std::extent<T>::value);
     }
 
     // T cannot be statically converted to format string (including string_view)
@@ -115,28 +163,30 @@ public:
 
     void log(log_clock::time_point log_time, source_loc loc, level::level_enum lvl, string_view_t msg)
     {
-        bool log_enabled = should_log(lvl);
+        bool log_enabled = log_enabled_(lvl);
         bool traceback_enabled = tracer_.enabled();
-        if (!log_enabled && !traceback_enabled)
+        auto *tail = tail_of_(lvl, log_enabled);
+        if (!log_enabled && !traceback_enabled && tail == nullptr && !details::flight_records(lvl))
         {
             return;
         }
 
         details::log_msg log_msg(log_time, loc, name_, lvl, msg);
-        log_it_(log_msg, log_enabled, traceback_enabled);
+        log_it_(log_msg, log_enabled, traceback_enabled, tail);
     }
 
     void log(source_loc loc, level::level_enum lvl, string_view_t msg)
     {
-        bool log_enabled = should_log(lvl);
+        bool log_enabled = log_enabled_(lvl);
         bool traceback_enabled = tracer_.enabled();
-        if (!log_enabled && !traceback_enabled)
+        auto *tail = tail_of_(lvl, log_enabled);
+        if (!log_enabled && !traceback_enabled && tail == nullptr && !details::flight_records(lvl))
         {
             return;
         }
 
-        details::log_msg log_msg(loc, name_, lvl, msg);
-        log_it_(log_msg, log_enabled, traceback_enabled);
+        details::log_msg log_msg(loc, name_, lvl, msg, msg_fields_(traceback_enabled || tail != nullptr));
+        log_it_(log_msg, log_enabled, traceback_enabled, tail);
     }
 
     void log(level::level_enum lvl, string_view_t msg)
@@ -144,6 +194,40 @@ public:
         log(source_loc{}, lvl, msg);
     }
 
+    // log lines at once, as consecutive messages of the given level (see spdlog/log_batch.h): the level is
+    // checked once, each sink takes its lock once (sink::log_batch) and an async logger queues them as a single
+    // message. text holds the lines back to back, their sizes and times given by lines.
+    void log_lines(source_loc loc, level::level_enum lvl, string_view_t text, const details::log_line *lines, size_t n_lines);
+
+    // structured logging - the message (not a format string) with typed key/value fields,
+    // handed as is to the formatters and sinks, e.g.
+    // logger->log(loc, level::info, "order filled", spdlog::kv("id", id), spdlog::kv("px", px));
+    // (taking the message as const char * too makes it a better match than the format string overloads)
+    template<typename... Fields, typename std::enable_if<details::are_fields<Fields...>::value, int>::type = 0>
+    void log(source_loc loc, level::level_enum lvl, const char *msg, Fields &&...fields)
+    {
+        log(loc, lvl, string_view_t(msg), std::forward<Fields>(fields)...);
+    }
+
+    template<typename... Fields, typename std::enable_if<details::are_fields<Fields...>::value, int>::type = 0>
+    void log(source_loc loc, level::level_enum lvl, string_view_t msg, Fields &&...fields)
+    {
+        const field fields_array[] = {fields...};
+        log_fields_(loc, lvl, msg, fields_array, sizeof...(Fields));
+    }
+
+    template<typename... Fields, typename std::enable_if<details::are_fields<Fields...>::value, int>::type = 0>
+    void log(level::level_enum lvl, const char *msg, Fields &&...fields)
+    {
+        log(source_loc{}, lvl, string_view_t(msg), std::forward<Fields>(fields)...);
+    }
+
+    template<typename... Fields, typename std::enable_if<details::are_fields<Fields...>::value, int>::type = 0>
+    void log(level::level_enum lvl, string_view_t msg, Fields &&...fields)
+    {
+        log(source_loc{}, lvl, msg, std::forward<Fields>(fields)...);
+    }
+
     template<typename... Args>
     void trace(fmt::format_string<Args...> fmt, Args &&...args)
     {
@@ -180,6 +264,44 @@ public:
         log(level::critical, fmt, std::forward<Args>(args)...);
     }
 
+#ifdef SPDLOG_FMT_COMPILE
+    template<typename S, typename... Args, typename std::enable_if<is_compiled_format_string<S>::value, int>::type = 0>
+    void trace(const S &fmt, Args &&...args)
+    {
+        log(level::trace, fmt, std::forward<Args>(args)...);
+    }
+
+    template<typename S, typename... Args, typename std::enable_if<is_compiled_format_string<S>::value, int>::type = 0>
+    void debug(const S &fmt, Args &&...args)
+    {
+        log(level::debug, fmt, std::forward<Args>(args)...);
+    }
+
+    template<typename S, typename... Args, typename std::enable_if<is_compiled_format_string<S>::value, int>::type = 0>
+    void info(const S &fmt, Args &&...args)
+    {
+        log(level::info, fmt, std::forward<Args>(args)...);
+    }
+
+    template<typename S, typename... Args, typename std::enable_if<is_compiled_format_string<S>::value, int>::type = 0>
+    void warn(const S &fmt, Args &&...args)
+    {
+        log(level::warn, fmt, std::forward<Args>(args)...);
+    }
+
+    template<typename S, typename... Args, typename std::enable_if<is_compiled_format_string<S>::value, int>::type = 0>
+    void error(const S &fmt, Args &&...args)
+    {
+        log(level::err, fmt, std::forward<Args>(args)...);
+    }
+
+    template<typename S, typename... Args, typename std::enable_if<is_compiled_format_string<S>::value, int>::type = 0>
+    void critical(const S &fmt, Args &&...args)
+    {
+        log(level::critical, fmt, std::forward<Args>(args)...);
+    }
+#endif
+
 #ifdef SPDLOG_WCHAR_TO_UTF8_SUPPORT
     template<typename... Args>
     void log(level::level_enum lvl, fmt::wformat_string<Args...> fmt, Args &&...args)
@@ -230,6 +352,42 @@ public:
     }
 #endif
 
+    template<typename... Fields, typename std::enable_if<details::are_fields<Fields...>::value, int>::type = 0>
+    void trace(const char *msg, Fields &&...fields)
+    {
+        log(level::trace, msg, std::forward<Fields>(fields)...);
+    }
+
+    template<typename... Fields, typename std::enable_if<details::are_fields<Fields...>::value, int>::type = 0>
+    void debug(const char *msg, Fields &&...fields)
+    {
+        log(level::debug, msg, std::forward<Fields>(fields)...);
+    }
+
+    template<typename... Fields, typename std::enable_if<details::are_fields<Fields...>::value, int>::type = 0>
+    void info(const char *msg, Fields &&...fields)
+    {
+        log(level::info, msg, std::forward<Fields>(fields)...);
+    }
+
+    template<typename... Fields, typename std::enable_if<details::are_fields<Fields...>::value, int>::type = 0>
+    void warn(const char *msg, Fields &&...fields)
+    {
+        log(level::warn, msg, std::forward<Fields>(fields)...);
+    }
+
+    template<typename... Fields, typename std::enable_if<details::are_fields<Fields...>::value, int>::type = 0>
+    void error(const char *msg, Fields &&...fields)
+    {
+        log(level::err, msg, std::forward<Fields>(fields)...);
+    }
+
+    template<typename... Fields, typename std::enable_if<details::are_fields<Fields...>::value, int>::type = 0>
+    void critical(const char *msg, Fields &&...fields)
+    {
+        log(level::critical, msg, std::forward<Fields>(fields)...);
+    }
+
     template<typename T>
     void trace(const T &msg)
     {
@@ -266,10 +424,12 @@ public:
         log(level::critical, msg);
     }
 
-    // return true logging is enabled for the given level.
+    // return true logging is enabled for the given level: by the logger level, and by the level of at least
+    // one of its sinks - the messages none of the sinks would log are not formatted.
     bool should_log(level::level_enum msg_level) const
     {
-        return msg_level >= level_.load(std::memory_order_relaxed);
+        return msg_level >= level_.load(std::memory_order_relaxed) &&
+               (msg_level >= sinks_level_.load(std::memory_order_relaxed) || sinks_accept_(msg_level));
     }
 
     // return true if backtrace logging is enabled.
@@ -282,6 +442,20 @@ public:
 
     level::level_enum level() const;
 
+    // keep 1 in sample_rate of the enabled trace and debug messages, picked at random before they are formatted.
+    // the messages kept carry the rate (log_msg::sample_rate, the %w flag) to scale the counts. 1 (default) keeps all.
+    void set_sample_rate(uint32_t sample_rate);
+
+    uint32_t sample_rate() const;
+
+    // cap the payload of the messages at max_bytes (0, default: no cap). the messages are formatted up to the cap
+    // (the rest is counted, not stored), and the payloads over it are cut and end with SPDLOG_TRUNCATION_MARKER
+    // (see details/payload_cap.h). the lines of log_lines() are not capped.
+    void set_max_payload_bytes(size_t max_bytes);
+    size_t max_payload_bytes() const;
+    // the number of messages truncated to the cap
+    size_t truncated_messages() const;
+
     const std::string &name() const;
 
     // set formatting for the sinks in this logger.
@@ -292,14 +466,23 @@ public:
 
     // backtrace support.
     // efficiently store all debug/trace messages in a circular buffer until needed for debugging.
-    void enable_backtrace(size_t n_messages);
+    // with per_thread, each thread keeps its own last n_messages, merged by time when dumped.
+    void enable_backtrace(size_t n_messages, bool per_thread = false);
     void disable_backtrace();
     void dump_backtrace();
+    // dump only the messages logged by the calling thread
+    void dump_thread_backtrace();
+    // bytes allocated by the backtrace's messages beyond its slots (see details/memory_account.h)
+    size_t backtrace_memory_used() const;
 
     // flush functions
     void flush();
     void flush_on(level::level_enum log_level);
     level::level_enum flush_level() const;
+    // flush by level, coalesced to at most one flush per interval, by pending bytes or on idle (see flush_policy).
+    // replaces the flush level. not thread safe: set it before logging.
+    void set_flush_policy(const flush_policy &policy);
+    flush_policy get_flush_policy() const;
 
     // sinks
     const std::vector<sink_ptr> &sinks() const;
@@ -312,41 +495,302 @@ public:
     // create new logger with same sinks and configuration.
     virtual std::shared_ptr<logger> clone(std::string logger_name);
 
+    // snapshot of the self profiling counters (all zero unless SPDLOG_ENABLE_STATS is defined):
+    // the log calls, formatting of their args, and time passing them to the sinks (see sink::profile_stats()
+    // for each sink)
+    details::profile_stats profile_stats() const;
+
 protected:
     std::string name_;
     std::vector<sink_ptr> sinks_;
     spdlog::level_t level_{level::info};
     spdlog::level_t flush_level_{level::off};
+    std::atomic<uint32_t> sample_rate_{1};
+    // 0: no cap
+    std::atomic<size_t> max_payload_bytes_{0};
+    // not copied with the logger
+    std::atomic<size_t> truncated_{0};
+    // set if the flush policy needs more than flush_level_
+    std::unique_ptr<details::flush_controller> flush_controller_;
     err_handler custom_err_handler_{nullptr};
     details::backtracer tracer_;
+    // hand eligible messages unformatted to sink_deferred_() (see async_logger::set_deferred_formatting())
+    std::atomic<bool> deferred_format_{false};
+    // pass the messages to be formatted to sink_in_place_() (see async_logger)
+    bool in_place_format_{false};
+    // not copied with the logger
+    mutable details::profile_counters profile_;
+    // the details::msg_fields captured whatever the sinks read (see msg_fields_())
+    unsigned required_msg_fields_{details::msg_fields::none};
+    // the lowest level of the sinks, as of the sink level generation and the number of sinks (see sinks_accept_())
+    mutable spdlog::level_t sinks_level_{level::off};
+    mutable std::atomic<uint64_t> sinks_level_generation_{0};
+    mutable std::atomic<size_t> sinks_level_count_{0};
+
+    // refresh sinks_level_ if a sink level or the sinks changed, then check the message level against it
+    bool sinks_accept_(level::level_enum msg_level) const;
+
+    // should_log(), and picked by the sampling if any
+    bool log_enabled_(level::level_enum lvl) const
+    {
+        bool enabled = should_log(lvl) && (lvl > level::debug || sampled_(sample_rate_.load(std::memory_order_relaxed)));
+        profile_.on_message(enabled);
+        return enabled;
+    }
+
+    // the tail sampling scope of the thread keeping the message if the logger drops it (see spdlog/tail_sampling.h),
+    // or nullptr. a logged message may trigger the scope instead.
+    static details::tail_buffer *tail_of_(level::level_enum lvl, bool log_enabled)
+    {
+        auto *tail = details::thread_tail_buffer();
+        if (tail == nullptr)
+        {
+            return nullptr;
+        }
+        if (log_enabled)
+        {
+            tail->on_logged(lvl);
+            return nullptr;
+        }
+        return tail->keeps(lvl) ? tail : nullptr;
+    }
+
+    // pick 1 in sample_rate messages
+    static bool sampled_(uint32_t sample_rate)
+    {
+        return sample_rate <= 1 || next_random_() % sample_rate == 0;
+    }
+
+    static uint64_t next_random_();
 
     // common implementation for after templated public api has been resolved
     template<typename... Args>
     void log_(source_loc loc, level::level_enum lvl, string_view_t fmt, Args &&...args)
     {
-        bool log_enabled = should_log(lvl);
+        bool log_enabled = log_enabled_(lvl);
         bool traceback_enabled = tracer_.enabled();
-        if (!log_enabled && !traceback_enabled)
+        auto *tail = tail_of_(lvl, log_enabled);
+        if (!log_enabled && !traceback_enabled && tail == nullptr && !details::flight_records(lvl))
         {
             return;
         }
         SPDLOG_TRY
         {
-            memory_buf_t buf;
-            fmt::detail::vformat_to(buf, fmt, fmt::make_format_args(args...));
-            details::log_msg log_msg(loc, name_, lvl, string_view_t(buf.data(), buf.size()));
-            log_it_(log_msg, log_enabled, traceback_enabled);
+            // only kept for the backtrace or the tail sampling scope: formatted if dumped
+            bool recorded = details::flight_records(lvl);
+            if (!log_enabled && !recorded && keep_deferred_(std::integral_constant<bool, details::deferred_format<Args...>::eligible>{}, loc, lvl,
+                                    fmt, traceback_enabled, tail, args...))
+            {
+                return;
+            }
+            if (log_enabled && deferred_format_.load(std::memory_order_relaxed) && !traceback_enabled && !recorded &&
+                defer_(std::integral_constant<bool, details::deferred_format<Args...>::eligible>{}, loc, lvl, fmt, args...))
+            {
+                return;
+            }
+            auto max_payload = max_payload_bytes_.load(std::memory_order_relaxed);
+            if (in_place_format_ && log_enabled && !traceback_enabled && !recorded && max_payload == 0 &&
+                format_in_place_(loc, lvl, fmt, args...))
+            {
+                return;
+            }
+            details::scoped_buffer scoped_buf;
+            auto &buf = scoped_buf.get();
+            details::profile_timer timer;
+            if (max_payload == 0)
+            {
+                fmt::detail::vformat_to(buf, fmt, fmt::make_format_args(args...));
+            }
+            else if (details::vformat_capped(buf, fmt, fmt::make_format_args(args...), max_payload))
+            {
+                truncated_.fetch_add(1, std::memory_order_relaxed);
+            }
+            profile_.on_formatted(buf.size(), timer);
+            details::log_msg log_msg(loc, name_, lvl, string_view_t(buf.data(), buf.size()), msg_fields_(traceback_enabled || tail != nullptr));
+            log_it_(log_msg, log_enabled, traceback_enabled, tail);
+        }
+        SPDLOG_LOGGER_CATCH()
+    }
+
+#ifdef SPDLOG_FMT_COMPILE
+    // formatted by the code generated for the format string, straight into the buffer - by the caller:
+    // not deferred to the async workers, nor formatted in place.
+    template<typename S, typename... Args>
+    void log_compiled_(source_loc loc, level::level_enum lvl, const S &fmt, Args &&...args)
+    {
+        bool log_enabled = log_enabled_(lvl);
+        bool traceback_enabled = tracer_.enabled();
+        auto *tail = tail_of_(lvl, log_enabled);
+        if (!log_enabled && !traceback_enabled && tail == nullptr && !details::flight_records(lvl))
+        {
+            return;
+        }
+        SPDLOG_TRY
+        {
+            details::scoped_buffer scoped_buf;
+            auto &buf = scoped_buf.get();
+            details::profile_timer timer;
+            auto max_payload = max_payload_bytes_.load(std::memory_order_relaxed);
+            if (max_payload == 0)
+            {
+                fmt::format_to(fmt::appender(buf), fmt, std::forward<Args>(args)...);
+            }
+            else
+            {
+                buf.resize(max_payload + 1);
+                auto result = fmt::format_to_n(buf.data(), max_payload + 1, fmt, std::forward<Args>(args)...);
+                if (result.size <= max_payload)
+                {
+                    buf.resize(result.size);
+                }
+                else
+                {
+                    details::mark_truncated(buf, max_payload);
+                    truncated_.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            profile_.on_formatted(buf.size(), timer);
+            details::log_msg log_msg(
+                loc, name_, lvl, string_view_t(buf.data(), buf.size()), msg_fields_(traceback_enabled || tail != nullptr));
+            log_it_(log_msg, log_enabled, traceback_enabled, tail);
         }
         SPDLOG_LOGGER_CATCH()
     }
+#endif
+
+    void log_fields_(source_loc loc, level::level_enum lvl, string_view_t msg, const field *fields, size_t n_fields)
+    {
+        bool log_enabled = log_enabled_(lvl);
+        bool traceback_enabled = tracer_.enabled();
+        auto *tail = tail_of_(lvl, log_enabled);
+        if (!log_enabled && !traceback_enabled && tail == nullptr && !details::flight_records(lvl))
+        {
+            return;
+        }
+
+        details::log_msg log_msg(loc, name_, lvl, msg, msg_fields_(traceback_enabled || tail != nullptr));
+        log_msg.fields = fields;
+        log_msg.n_fields = n_fields;
+        log_it_(log_msg, log_enabled, traceback_enabled, tail);
+    }
+
+    // point the payload at the interned copy of the text if possible (see details::intern_table)
+    static void intern_payload_(details::log_msg &msg)
+    {
+#ifndef SPDLOG_NO_INTERNING
+        auto &table = details::intern_table::instance();
+        auto id = table.intern(msg.payload);
+        if (id != 0)
+        {
+            msg.payload = table.fragment(id);
+            msg.payload_id = id;
+        }
+#else
+        (void)msg;
+#endif
+    }
+
+    // point the payload at the interned copy of the format string if it is a literal: it is when checked at
+    // compile time, which needs consteval
+    static void intern_format_string_(details::log_msg &msg)
+    {
+#ifdef FMT_HAS_CONSTEVAL
+        intern_payload_(msg);
+#else
+        (void)msg;
+#endif
+    }
+
+    void log_string_(source_loc loc, level::level_enum lvl, string_view_t msg, std::false_type, size_t)
+    {
+        log(loc, lvl, msg);
+    }
+
+    // a literal fills its char array (a char buffer holding a shorter text is not one) - intern it
+    void log_string_(source_loc loc, level::level_enum lvl, string_view_t msg, std::true_type, size_t array_size)
+    {
+        bool log_enabled = log_enabled_(lvl);
+        bool traceback_enabled = tracer_.enabled();
+        auto *tail = tail_of_(lvl, log_enabled);
+        if (!log_enabled && !traceback_enabled && tail == nullptr && !details::flight_records(lvl))
+        {
+            return;
+        }
+
+        details::log_msg log_msg(loc, name_, lvl, msg, msg_fields_(traceback_enabled || tail != nullptr));
+        if (msg.size() + 1 == array_size)
+        {
+            intern_payload_(log_msg);
+        }
+        log_it_(log_msg, log_enabled, traceback_enabled, tail);
+    }
+
+    // capture the format args and pass the unformatted message to sink_deferred_()
+    template<typename... Args>
+    bool defer_(std::true_type, source_loc loc, level::level_enum lvl, string_view_t fmt, Args &...args)
+    {
+        auto store = fmt::make_format_args(args...);
+        details::log_msg log_msg(loc, name_, lvl, fmt);
+        intern_format_string_(log_msg);
+        log_msg.sample_rate = sample_rate_of_(lvl);
+        return sink_deferred_(log_msg, &details::deferred_format<Args...>::format, &store, sizeof(store));
+    }
+
+    template<typename... Args>
+    bool defer_(std::false_type, source_loc, level::level_enum, string_view_t, Args &...)
+    {
+        return false;
+    }
+
+    // pass the message and its args to sink_in_place_(), to be formatted straight where it is queued
+    template<typename... Args>
+    bool format_in_place_(source_loc loc, level::level_enum lvl, string_view_t fmt, Args &...args)
+    {
+        details::log_msg log_msg(loc, name_, lvl, fmt, msg_fields_(false));
+        log_msg.sample_rate = sample_rate_of_(lvl);
+        details::profile_timer timer;
+        size_t formatted_size = 0;
+        if (!sink_in_place_(log_msg, fmt::make_format_args(args...), formatted_size))
+        {
+            return false;
+        }
+        profile_.on_formatted(formatted_size, timer);
+        return true;
+    }
+
+    template<typename... Args>
+    bool keep_deferred_(std::true_type, source_loc loc, level::level_enum lvl, string_view_t fmt, bool traceback_enabled,
+        details::tail_buffer *tail, Args &...args)
+    {
+        auto store = fmt::make_format_args(args...);
+        details::log_msg log_msg(loc, name_, lvl, fmt);
+        intern_format_string_(log_msg);
+        auto format_args = string_view_t(reinterpret_cast<const char *>(&store), sizeof(store));
+        if (traceback_enabled)
+        {
+            tracer_.push_back(log_msg, &details::deferred_format<Args...>::format, format_args);
+        }
+        if (tail != nullptr)
+        {
+            tail->push_back(this, log_msg, &details::deferred_format<Args...>::format, format_args);
+        }
+        return true;
+    }
+
+    template<typename... Args>
+    bool keep_deferred_(std::false_type, source_loc, level::level_enum, string_view_t, bool, details::tail_buffer *, Args &...)
+    {
+        return false;
+    }
 
 #ifdef SPDLOG_WCHAR_TO_UTF8_SUPPORT
     template<typename... Args>
     void log_(source_loc loc, level::level_enum lvl, wstring_view_t fmt, Args &&...args)
     {
-        bool log_enabled = should_log(lvl);
+        bool log_enabled = log_enabled_(lvl);
         bool traceback_enabled = tracer_.enabled();
-        if (!log_enabled && !traceback_enabled)
+        auto *tail = tail_of_(lvl, log_enabled);
+        if (!log_enabled && !traceback_enabled && tail == nullptr && !details::flight_records(lvl))
         {
             return;
         }
@@ -355,10 +799,11 @@ protected:
             // format to wmemory_buffer and convert to utf8
             fmt::wmemory_buffer wbuf;
             fmt::detail::vformat_to(wbuf, fmt, fmt::make_format_args<fmt::wformat_context>(args...));
-            memory_buf_t buf;
+            details::scoped_buffer scoped_buf;
+            auto &buf = scoped_buf.get();
             details::os::wstr_to_utf8buf(wstring_view_t(wbuf.data(), wbuf.size()), buf);
             details::log_msg log_msg(loc, name_, lvl, string_view_t(buf.data(), buf.size()));
-            log_it_(log_msg, log_enabled, traceback_enabled);
+            log_it_(log_msg, log_enabled, traceback_enabled, tail);
         }
         SPDLOG_LOGGER_CATCH()
     }
@@ -367,31 +812,63 @@ protected:
     template<class T, typename std::enable_if<std::is_convertible<const T &, spdlog::wstring_view_t>::value, int>::type = 0>
     void log_(source_loc loc, level::level_enum lvl, const T &msg)
     {
-        bool log_enabled = should_log(lvl);
+        bool log_enabled = log_enabled_(lvl);
         bool traceback_enabled = tracer_.enabled();
-        if (!log_enabled && !traceback_enabled)
+        auto *tail = tail_of_(lvl, log_enabled);
+        if (!log_enabled && !traceback_enabled && tail == nullptr && !details::flight_records(lvl))
         {
             return;
         }
         SPDLOG_TRY
         {
-            memory_buf_t buf;
+            details::scoped_buffer scoped_buf;
+            auto &buf = scoped_buf.get();
             details::os::wstr_to_utf8buf(msg, buf);
             details::log_msg log_msg(loc, name_, lvl, string_view_t(buf.data(), buf.size()));
-            log_it_(log_msg, log_enabled, traceback_enabled);
+            log_it_(log_msg, log_enabled, traceback_enabled, tail);
         }
         SPDLOG_LOGGER_CATCH()
     }
 
 #endif // SPDLOG_WCHAR_TO_UTF8_SUPPORT
 
+    // the details::msg_fields to capture in the messages: those read by the sinks, unless the messages
+    // may be kept (backtrace) or inspected by the flush policy
+    unsigned msg_fields_(bool traceback_enabled) const;
+
+    uint32_t sample_rate_of_(level::level_enum lvl) const
+    {
+        return lvl > level::debug ? 1 : (std::max)(sample_rate_.load(std::memory_order_relaxed), uint32_t(1));
+    }
+
     // log the given message (if the given log level is high enough),
     // and save backtrace (if backtrace is enabled).
-    void log_it_(const details::log_msg &log_msg, bool log_enabled, bool traceback_enabled);
+    // keep it in the given tail sampling scope if not logged. a payload over the cap is truncated first.
+    void log_it_(const details::log_msg &log_msg, bool log_enabled, bool traceback_enabled, details::tail_buffer *tail = nullptr);
     virtual void sink_it_(const details::log_msg &msg);
+    // pass the message to each sink (that should log it)
+    void log_to_sinks_(const details::log_msg &msg);
+    // sink the lines of log_lines() (see details::foreach_log_line()), msg holding their text
+    virtual void sink_lines_(const details::log_msg &msg, string_view_t lines);
+    // sink a message whose payload is the format string of the given captured args.
+    // return false if the message should be formatted and sunk right away instead.
+    virtual bool sink_deferred_(const details::log_msg &msg, details::deferred_format_fn format_fn, const void *args, size_t args_size);
+    // format the message (whose payload is the format string) with the given args where it is sunk.
+    // return false if it should be formatted by the caller instead.
+    virtual bool sink_in_place_(const details::log_msg &msg, fmt::format_args args, size_t &formatted_size);
     virtual void flush_();
-    void dump_backtrace_();
+    // add the logger to its batch in batches (see registry::flush_all()), or flush it if it is not batched.
+    // the loggers derived from logger are flushed right away, unless they override it.
+    virtual void flush_batched_(std::vector<details::flush_batch> &batches);
+    static std::future<void> post_flush_batch_(const details::flush_batch &batch, size_t threads);
+    void flush_sink_(sinks::sink &sink);
+    void dump_backtrace_(bool thread_only = false);
     bool should_flush_(const details::log_msg &msg);
+    // true if the flush policy asks to flush after the given message, just sunk
+    bool flush_due_(const details::log_msg &msg);
+    // called before flushing the sinks
+    void on_flush_();
+    void reset_flush_controller_(const flush_policy &policy);
 
     // handle errors during logging.
     // default handler prints the error to stderr at max rate of 1 message/sec.
@@ -404,4 +881,6 @@ void swap(logger &a, logger &b);
 
 #ifdef SPDLOG_HEADER_ONLY
 #    include "logger-inl.h"
+#    include "details/tail_buffer-inl.h"
+#    include "details/flight_recorder-inl.h"
 #endif
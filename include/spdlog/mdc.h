@@ -0,0 +1,84 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Mapped diagnostic context: key/values of the calling thread, stamped on each message it logs
+// and rendered by the %& pattern flag ("key=value key=value") and the json formatter ("mdc":{..}).
+//
+// Usage:
+//
+// spdlog::mdc::put("user", user_id);
+// spdlog::info("logged in");       // with pattern "[%&] %v" => "[user=42] logged in"
+// spdlog::mdc::remove("user");
+//
+// {
+//     spdlog::mdc::scoped_put request("request", request_id); // removed at the end of the scope
+//     ...
+// }
+//
+// The keys and values are copied into the context. A message takes them only if logged (a pointer,
+// no copy), and copies them when queued (async, backtrace). Not available with SPDLOG_NO_TLS.
+
+#include <spdlog/common.h>
+#include <spdlog/details/mdc.h>
+
+#include <string>
+
+namespace spdlog {
+namespace mdc {
+
+// add the key/value, or replace the value of the key
+template<typename T>
+inline void put(string_view_t key, const T &value)
+{
+    details::thread_mdc().put(field(key, value));
+}
+
+// return false if the key wasn't in the context
+inline bool remove(string_view_t key)
+{
+    return details::thread_mdc().remove(key);
+}
+
+inline void clear()
+{
+    details::thread_mdc().clear();
+}
+
+// the value of the given key (null if not in the context), valid until the context is updated
+inline const field *get(string_view_t key)
+{
+    return details::thread_mdc().find(key);
+}
+
+inline size_t size()
+{
+    return details::thread_mdc().size();
+}
+
+// put the key/value for the scope, then remove the key
+class scoped_put
+{
+public:
+    template<typename T>
+    scoped_put(string_view_t key, const T &value)
+        : key_(key.data(), key.size())
+    {
+        put(key, value);
+    }
+
+    scoped_put(const scoped_put &) = delete;
+    scoped_put &operator=(const scoped_put &) = delete;
+
+    ~scoped_put()
+    {
+        remove(key_);
+    }
+
+private:
+    std::string key_;
+};
+
+} // namespace mdc
+} // namespace spdlog
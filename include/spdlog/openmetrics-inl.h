@@ -0,0 +1,212 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/openmetrics.h>
+#endif
+
+#include <spdlog/async_logger.h>
+#include <spdlog/details/registry.h>
+#include <spdlog/details/thread_pool.h>
+#include <spdlog/fmt/fmt.h>
+#include <spdlog/logger.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace spdlog {
+namespace details {
+
+SPDLOG_INLINE void openmetrics_escape(string_view_t value, memory_buf_t &dest)
+{
+    for (auto c : value)
+    {
+        switch (c)
+        {
+        case '\\':
+            dest.append(string_view_t("\\\\"));
+            break;
+        case '"':
+            dest.append(string_view_t("\\\""));
+            break;
+        case '\n':
+            dest.append(string_view_t("\\n"));
+            break;
+        default:
+            dest.push_back(c);
+        }
+    }
+}
+
+namespace openmetrics_helpers {
+
+// the counters of a logger, taken while iterating the registry
+struct logger_counters
+{
+    std::string labels; // logger="name"
+    profile_stats stats;
+    bool is_async = false;
+    async_stats async; // of the async loggers
+    std::vector<profile_stats> sinks;
+};
+
+inline logger_counters snapshot_of(const std::shared_ptr<logger> &l)
+{
+    logger_counters counters;
+    memory_buf_t labels;
+    labels.append(string_view_t("logger=\""));
+    openmetrics_escape(l->name(), labels);
+    labels.push_back('"');
+    counters.labels.assign(labels.data(), labels.size());
+    counters.stats = l->profile_stats();
+    if (auto async_l = std::dynamic_pointer_cast<async_logger>(l))
+    {
+        counters.is_async = true;
+        counters.async = async_l->stats();
+    }
+    for (auto &sink : l->sinks())
+    {
+        counters.sinks.push_back(sink->profile_stats());
+    }
+    return counters;
+}
+
+inline double seconds(std::chrono::nanoseconds ns)
+{
+    return std::chrono::duration<double>(ns).count();
+}
+
+inline void write_family(memory_buf_t &dest, string_view_t name, string_view_t type, string_view_t help)
+{
+    fmt::format_to(std::back_inserter(dest), "# TYPE {} {}\n# HELP {} {}\n", name, type, name, help);
+}
+
+// counter samples are named <family>_total
+template<typename T>
+inline void write_sample(memory_buf_t &dest, string_view_t family, bool counter, string_view_t labels, T value)
+{
+    fmt::format_to(std::back_inserter(dest), "{}{}", family, counter ? "_total" : "");
+    if (labels.size() > 0)
+    {
+        fmt::format_to(std::back_inserter(dest), "{{{}}}", labels);
+    }
+    fmt::format_to(std::back_inserter(dest), " {}\n", value);
+}
+
+// a counter family of one value per logger (the async ones only if async_only)
+template<typename Getter>
+inline void write_logger_counter(memory_buf_t &dest, const std::vector<logger_counters> &loggers, string_view_t family,
+    string_view_t help, bool async_only, Getter getter)
+{
+    write_family(dest, family, "counter", help);
+    for (auto &l : loggers)
+    {
+        if (l.is_async || !async_only)
+        {
+            write_sample(dest, family, true, l.labels, getter(l));
+        }
+    }
+}
+
+// a counter family of one value per sink of each logger
+template<typename Getter>
+inline void write_sink_counter(memory_buf_t &dest, const std::vector<logger_counters> &loggers, string_view_t family, string_view_t help,
+    Getter getter)
+{
+    write_family(dest, family, "counter", help);
+    for (auto &l : loggers)
+    {
+        for (size_t i = 0; i < l.sinks.size(); i++)
+        {
+            auto labels = fmt::format("{},sink=\"{}\"", l.labels, i);
+            write_sample(dest, family, true, labels, getter(l.sinks[i]));
+        }
+    }
+}
+
+} // namespace openmetrics_helpers
+} // namespace details
+
+SPDLOG_INLINE void format_openmetrics(memory_buf_t &dest)
+{
+    using namespace details::openmetrics_helpers;
+    using details::profile_stats;
+
+    std::vector<logger_counters> loggers;
+    details::registry::instance().apply_all([&](const std::shared_ptr<logger> l) { loggers.push_back(snapshot_of(l)); });
+    std::sort(loggers.begin(), loggers.end(), [](const logger_counters &a, const logger_counters &b) { return a.labels < b.labels; });
+
+    write_logger_counter(dest, loggers, "spdlog_logger_messages", "Log calls.", false, [](const logger_counters &l) {
+        return l.stats.messages;
+    });
+    write_logger_counter(dest, loggers, "spdlog_logger_filtered", "Log calls below the logger level or not sampled.", false,
+        [](const logger_counters &l) { return l.stats.filtered; });
+    write_logger_counter(dest, loggers, "spdlog_logger_formatted_bytes", "Bytes formatted from the log call arguments.", false,
+        [](const logger_counters &l) { return l.stats.formatted_bytes; });
+
+    write_logger_counter(dest, loggers, "spdlog_async_logger_enqueued", "Messages posted to the thread pool.", true,
+        [](const logger_counters &l) { return l.async.enqueued; });
+    write_logger_counter(dest, loggers, "spdlog_async_logger_discarded", "Messages discarded by the overflow policy.", true,
+        [](const logger_counters &l) { return l.async.discarded; });
+    write_logger_counter(dest, loggers, "spdlog_async_logger_blocked_seconds", "Time spent waiting for room in the queue.", true,
+        [](const logger_counters &l) { return seconds(l.async.blocked_time); });
+
+    write_sink_counter(dest, loggers, "spdlog_sink_messages", "Messages logged by the sink.", [](const profile_stats &s) {
+        return s.messages;
+    });
+    write_sink_counter(dest, loggers, "spdlog_sink_bytes", "Bytes formatted and written by the sink.", [](const profile_stats &s) {
+        return s.formatted_bytes;
+    });
+    write_sink_counter(dest, loggers, "spdlog_sink_write_seconds", "Time spent writing the messages.", [](const profile_stats &s) {
+        return seconds(s.sink_time);
+    });
+    write_sink_counter(dest, loggers, "spdlog_sink_flushes", "Flushes of the sink.", [](const profile_stats &s) { return s.flushes; });
+    write_sink_counter(dest, loggers, "spdlog_sink_flush_seconds", "Time spent flushing.", [](const profile_stats &s) {
+        return seconds(s.flush_time);
+    });
+
+    if (auto tp = details::registry::instance().get_tp())
+    {
+        auto stats = tp->stats();
+        write_family(dest, "spdlog_thread_pool_queue_depth", "gauge", "Messages in the queue.");
+        write_sample(dest, "spdlog_thread_pool_queue_depth", false, "", tp->queue_size());
+        write_family(dest, "spdlog_thread_pool_queue_high_water_mark", "gauge", "Max number of messages in the queue.");
+        write_sample(dest, "spdlog_thread_pool_queue_high_water_mark", false, "", stats.high_water_mark);
+        write_family(dest, "spdlog_thread_pool_dropped", "counter", "Messages overrun by newer ones.");
+        write_sample(dest, "spdlog_thread_pool_dropped", true, "", tp->overrun_counter());
+        write_family(dest, "spdlog_thread_pool_discarded", "counter", "Messages discarded by the overflow policy.");
+        write_sample(dest, "spdlog_thread_pool_discarded", true, "", stats.discarded);
+        write_family(dest, "spdlog_thread_pool_enqueued", "counter", "Messages posted to the queue.");
+        write_sample(dest, "spdlog_thread_pool_enqueued", true, "", stats.enqueued);
+        write_family(dest, "spdlog_thread_pool_dequeued", "counter", "Messages processed by the workers.");
+        write_sample(dest, "spdlog_thread_pool_dequeued", true, "", stats.dequeued);
+        write_family(dest, "spdlog_thread_pool_blocked_seconds", "counter", "Time spent waiting for room in the queue.");
+        write_sample(dest, "spdlog_thread_pool_blocked_seconds", true, "", seconds(stats.blocked_time));
+        write_family(dest, "spdlog_thread_pool_workers", "gauge", "Running worker threads.");
+        write_sample(dest, "spdlog_thread_pool_workers", false, "", stats.workers);
+        write_family(dest, "spdlog_thread_pool_workers_added", "counter", "Workers added by the elastic pool.");
+        write_sample(dest, "spdlog_thread_pool_workers_added", true, "", stats.workers_added);
+        write_family(dest, "spdlog_thread_pool_workers_retired", "counter", "Idle workers retired by the elastic pool.");
+        write_sample(dest, "spdlog_thread_pool_workers_retired", true, "", stats.workers_retired);
+        write_family(dest, "spdlog_thread_pool_stolen", "counter", "Messages processed by the worker of another shard.");
+        write_sample(dest, "spdlog_thread_pool_stolen", true, "", stats.stolen);
+        write_family(dest, "spdlog_thread_pool_spilled", "counter", "Messages written to the spill file of a full queue.");
+        write_sample(dest, "spdlog_thread_pool_spilled", true, "", stats.spilled);
+    }
+    dest.append(string_view_t("# EOF\n"));
+}
+
+SPDLOG_INLINE std::string openmetrics_text()
+{
+    memory_buf_t buf;
+    format_openmetrics(buf);
+    return std::string(buf.data(), buf.size());
+}
+
+} // namespace spdlog
@@ -0,0 +1,39 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Export of the logging counters in OpenMetrics (Prometheus) text format, e.g. to serve them
+// from an existing http /metrics handler:
+//
+//   spdlog::memory_buf_t buf;
+//   spdlog::format_openmetrics(buf);
+//   respond("application/openmetrics-text; version=1.0.0; charset=utf-8", buf.data(), buf.size());
+//
+// Covers the registered loggers (labeled logger="<name>"), their sinks (logger="<name>",sink="<index>")
+// and the default thread pool. The queue depth and the overrun counter of the pool are always
+// exported - the other counters are zero unless they are collected: SPDLOG_ENABLE_STATS for the
+// loggers and sinks, thread_pool_options::collect_stats for the async loggers and the pool.
+
+#include <spdlog/common.h>
+
+#include <string>
+
+namespace spdlog {
+
+// append the counters to dest, ending with the "# EOF" line
+SPDLOG_API void format_openmetrics(memory_buf_t &dest);
+
+SPDLOG_API std::string openmetrics_text();
+
+namespace details {
+
+// append value to dest as the contents of a label value (without the quotes)
+SPDLOG_API void openmetrics_escape(string_view_t value, memory_buf_t &dest);
+
+} // namespace details
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "openmetrics-inl.h"
+#endif
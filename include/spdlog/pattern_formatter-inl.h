@@ -7,9 +7,12 @@
 #    include <spdlog/pattern_formatter.h>
 #endif
 
+#include <spdlog/details/control_escape.h>
 #include <spdlog/details/fmt_helper.h>
+#include <spdlog/details/format_id.h>
 #include <spdlog/details/log_msg.h>
 #include <spdlog/details/os.h>
+#include <spdlog/details/time_cache.h>
 #include <spdlog/fmt/fmt.h>
 #include <spdlog/formatter.h>
 
@@ -603,12 +606,13 @@ public:
     z_formatter(const z_formatter &) = delete;
     z_formatter &operator=(const z_formatter &) = delete;
 
-    void format(const details::log_msg &msg, const std::tm &tm_time, memory_buf_t &dest) override
+    void format(const details::log_msg &, const std::tm &tm_time, memory_buf_t &dest) override
     {
         const size_t field_size = 6;
         ScopedPadder p(field_size, padinfo_, dest);
 
-        auto total_minutes = get_cached_offset(msg, tm_time);
+        // a per second flag: called once per second (see pattern_formatter::compile_pattern_)
+        auto total_minutes = time_cache::instance().utc_minutes_offset(tm_time);
         bool is_negative = total_minutes < 0;
         if (is_negative)
         {
@@ -624,21 +628,6 @@ public:
         dest.push_back(':');
         fmt_helper::pad2(total_minutes % 60, dest); // minutes
     }
-
-private:
-    log_clock::time_point last_update_{std::chrono::seconds(0)};
-    int offset_minutes_{0};
-
-    int get_cached_offset(const log_msg &msg, const std::tm &tm_time)
-    {
-        // refresh every 10 seconds
-        if (msg.time - last_update_ >= std::chrono::seconds(10))
-        {
-            offset_minutes_ = os::utc_minutes_offset(tm_time);
-            last_update_ = msg.time;
-        }
-        return offset_minutes_;
-    }
 };
 
 // Thread id
@@ -669,13 +658,48 @@ public:
 
     void format(const details::log_msg &, const std::tm &, memory_buf_t &dest) override
     {
-        const auto pid = static_cast<uint32_t>(details::os::pid());
+        const auto pid = static_cast<uint32_t>(details::os::cached_pid());
         auto field_size = ScopedPadder::count_digits(pid);
         ScopedPadder p(field_size, padinfo_, dest);
         fmt_helper::append_int(pid, dest);
     }
 };
 
+// name of the thread (see os::thread_name()), its id if unknown. the name of the last thread is kept
+// until another name is recorded.
+template<typename ScopedPadder>
+class thread_name_formatter final : public flag_formatter
+{
+public:
+    explicit thread_name_formatter(padding_info padinfo)
+        : flag_formatter(padinfo)
+    {}
+
+    void format(const details::log_msg &msg, const std::tm &, memory_buf_t &dest) override
+    {
+        auto generation = os::thread_names_generation();
+        if (!cached_ || msg.thread_id != thread_id_ || generation != generation_)
+        {
+            name_ = os::thread_name(msg.thread_id);
+            if (name_.empty())
+            {
+                name_ = std::to_string(msg.thread_id);
+            }
+            thread_id_ = msg.thread_id;
+            generation_ = generation;
+            cached_ = true;
+        }
+        ScopedPadder p(name_.size(), padinfo_, dest);
+        fmt_helper::append_string_view(name_, dest);
+    }
+
+private:
+    bool cached_ = false;
+    size_t thread_id_ = 0;
+    uint32_t generation_ = 0;
+    std::string name_;
+};
+
 template<typename ScopedPadder>
 class v_formatter final : public flag_formatter
 {
@@ -691,6 +715,94 @@ public:
     }
 };
 
+// the message text on one line: control chars escaped (see details/control_escape.h)
+template<typename ScopedPadder>
+class escaped_v_formatter final : public flag_formatter
+{
+public:
+    explicit escaped_v_formatter(padding_info padinfo)
+        : flag_formatter(padinfo)
+    {}
+
+    void format(const details::log_msg &msg, const std::tm &, memory_buf_t &dest) override
+    {
+        if (!padinfo_.enabled())
+        {
+            escape_control_chars(msg.payload, dest);
+            return;
+        }
+        memory_buf_t escaped;
+        escape_control_chars(msg.payload, escaped);
+        ScopedPadder p(escaped.size(), padinfo_, dest);
+        fmt_helper::append_string_view(string_view_t(escaped.data(), escaped.size()), dest);
+    }
+};
+
+// sample rate of the message: 1 in how many messages were logged (1 if not sampled)
+template<typename ScopedPadder>
+class w_formatter final : public flag_formatter
+{
+public:
+    explicit w_formatter(padding_info padinfo)
+        : flag_formatter(padinfo)
+    {}
+
+    void format(const details::log_msg &msg, const std::tm &, memory_buf_t &dest) override
+    {
+        const auto field_size = ScopedPadder::count_digits(msg.sample_rate);
+        ScopedPadder p(field_size, padinfo_, dest);
+        fmt_helper::append_int(msg.sample_rate, dest);
+    }
+};
+
+// trace id (32 hex digits) or span id (16 hex digits) of the message's trace context, empty if none
+template<typename ScopedPadder, bool SpanId>
+class trace_id_formatter final : public flag_formatter
+{
+public:
+    explicit trace_id_formatter(padding_info padinfo)
+        : flag_formatter(padinfo)
+    {}
+
+    void format(const details::log_msg &msg, const std::tm &, memory_buf_t &dest) override
+    {
+        const auto *id = SpanId ? msg.trace.span_id : msg.trace.trace_id;
+        const size_t id_size = SpanId ? sizeof(msg.trace.span_id) : sizeof(msg.trace.trace_id);
+        const bool empty = msg.trace.empty();
+        ScopedPadder p(empty ? 0 : id_size * 2, padinfo_, dest);
+        if (!empty)
+        {
+            fmt_helper::append_hex(id, id_size, dest);
+        }
+    }
+};
+
+// key/value fields of structured log messages (or the mdc fields), as "key=value key=value"
+template<typename ScopedPadder, bool Mdc = false>
+class k_formatter final : public flag_formatter
+{
+public:
+    explicit k_formatter(padding_info padinfo)
+        : flag_formatter(padinfo)
+    {}
+
+    void format(const details::log_msg &msg, const std::tm &, memory_buf_t &dest) override
+    {
+        const auto *fields = Mdc ? msg.mdc_fields : msg.fields;
+        const auto n_fields = Mdc ? msg.n_mdc_fields : msg.n_fields;
+        if (!padinfo_.enabled())
+        {
+            fmt_helper::append_fields(fields, n_fields, dest);
+            return;
+        }
+        // the rendered size is not known up front
+        memory_buf_t buf;
+        fmt_helper::append_fields(fields, n_fields, buf);
+        ScopedPadder p(buf.size(), padinfo_, dest);
+        fmt_helper::append_string_view(fmt_helper::to_string_view(buf), dest);
+    }
+};
+
 class ch_formatter final : public flag_formatter
 {
 public:
@@ -769,11 +881,12 @@ public:
             return;
         }
 
+        auto filename = msg.source.filename_view();
         size_t text_size;
         if (padinfo_.enabled())
         {
             // calc text size for padding based on "filename:line"
-            text_size = std::char_traits<char>::length(msg.source.filename) + ScopedPadder::count_digits(msg.source.line) + 1;
+            text_size = filename.size() + ScopedPadder::count_digits(msg.source.line) + 1;
         }
         else
         {
@@ -781,7 +894,7 @@ public:
         }
 
         ScopedPadder p(text_size, padinfo_, dest);
-        fmt_helper::append_string_view(msg.source.filename, dest);
+        fmt_helper::append_string_view(filename, dest);
         dest.push_back(':');
         fmt_helper::append_int(msg.source.line, dest);
     }
@@ -802,9 +915,10 @@ public:
         {
             return;
         }
-        size_t text_size = padinfo_.enabled() ? std::char_traits<char>::length(msg.source.filename) : 0;
+        auto filename = msg.source.filename_view();
+        size_t text_size = padinfo_.enabled() ? filename.size() : 0;
         ScopedPadder p(text_size, padinfo_, dest);
-        fmt_helper::append_string_view(msg.source.filename, dest);
+        fmt_helper::append_string_view(filename, dest);
     }
 };
 
@@ -842,14 +956,25 @@ public:
 #    pragma warning(pop)
 #endif // _MSC_VER
 
+    // from the sizes of the source if known (see SPDLOG_SOURCE_LOC)
+    static string_view_t basename(const source_loc &source)
+    {
+        if (source.filename_size != 0)
+        {
+            auto size = static_cast<size_t>(source.filename_size - source.basename_offset);
+            return string_view_t(source.filename + source.basename_offset, size);
+        }
+        return string_view_t(basename(source.filename));
+    }
+
     void format(const details::log_msg &msg, const std::tm &, memory_buf_t &dest) override
     {
         if (msg.source.empty())
         {
             return;
         }
-        auto filename = basename(msg.source.filename);
-        size_t text_size = padinfo_.enabled() ? std::char_traits<char>::length(filename) : 0;
+        auto filename = basename(msg.source);
+        size_t text_size = padinfo_.enabled() ? filename.size() : 0;
         ScopedPadder p(text_size, padinfo_, dest);
         fmt_helper::append_string_view(filename, dest);
     }
@@ -925,49 +1050,51 @@ private:
 };
 
 // Full info formatter
-// pattern: [%Y-%m-%d %H:%M:%S.%e] [%n] [%l] [%s:%#] %v
-class full_formatter final : public flag_formatter
+// pattern: [%Y-%m-%d %H:%M:%S.%e] [%n] [%l] [%s:%#] %v %k (the key/value fields, if any)
+// compiled into a cached step for the date/time part (full_datetime_formatter) followed by full_formatter.
+
+// "[%Y-%m-%d %H:%M:%S."
+class full_datetime_formatter final : public flag_formatter
 {
 public:
-    explicit full_formatter(padding_info padinfo)
+    explicit full_datetime_formatter(padding_info padinfo)
         : flag_formatter(padinfo)
     {}
 
-    void format(const details::log_msg &msg, const std::tm &tm_time, memory_buf_t &dest) override
+    void format(const details::log_msg &, const std::tm &tm_time, memory_buf_t &dest) override
     {
-        using std::chrono::duration_cast;
-        using std::chrono::milliseconds;
-        using std::chrono::seconds;
-
-        // cache the date/time part for the next second.
-        auto duration = msg.time.time_since_epoch();
-        auto secs = duration_cast<seconds>(duration);
+        dest.push_back('[');
+        fmt_helper::append_int(tm_time.tm_year + 1900, dest);
+        dest.push_back('-');
 
-        if (cache_timestamp_ != secs || cached_datetime_.size() == 0)
-        {
-            cached_datetime_.clear();
-            cached_datetime_.push_back('[');
-            fmt_helper::append_int(tm_time.tm_year + 1900, cached_datetime_);
-            cached_datetime_.push_back('-');
+        fmt_helper::pad2(tm_time.tm_mon + 1, dest);
+        dest.push_back('-');
 
-            fmt_helper::pad2(tm_time.tm_mon + 1, cached_datetime_);
-            cached_datetime_.push_back('-');
+        fmt_helper::pad2(tm_time.tm_mday, dest);
+        dest.push_back(' ');
 
-            fmt_helper::pad2(tm_time.tm_mday, cached_datetime_);
-            cached_datetime_.push_back(' ');
+        fmt_helper::pad2(tm_time.tm_hour, dest);
+        dest.push_back(':');
 
-            fmt_helper::pad2(tm_time.tm_hour, cached_datetime_);
-            cached_datetime_.push_back(':');
+        fmt_helper::pad2(tm_time.tm_min, dest);
+        dest.push_back(':');
 
-            fmt_helper::pad2(tm_time.tm_min, cached_datetime_);
-            cached_datetime_.push_back(':');
+        fmt_helper::pad2(tm_time.tm_sec, dest);
+        dest.push_back('.');
+    }
+};
 
-            fmt_helper::pad2(tm_time.tm_sec, cached_datetime_);
-            cached_datetime_.push_back('.');
+// the rest, from the milliseconds
+class full_formatter final : public flag_formatter
+{
+public:
+    explicit full_formatter(padding_info padinfo)
+        : flag_formatter(padinfo)
+    {}
 
-            cache_timestamp_ = secs;
-        }
-        dest.append(cached_datetime_.begin(), cached_datetime_.end());
+    void format(const details::log_msg &msg, const std::tm &, memory_buf_t &dest) override
+    {
+        using std::chrono::milliseconds;
 
         auto millis = fmt_helper::time_fraction<milliseconds>(msg.time);
         fmt_helper::pad3(static_cast<uint32_t>(millis.count()), dest);
@@ -996,7 +1123,7 @@ public:
         if (!msg.source.empty())
         {
             dest.push_back('[');
-            const char *filename = details::short_filename_formatter<details::null_scoped_padder>::basename(msg.source.filename);
+            auto filename = details::short_filename_formatter<details::null_scoped_padder>::basename(msg.source);
             fmt_helper::append_string_view(filename, dest);
             dest.push_back(':');
             fmt_helper::append_int(msg.source.line, dest);
@@ -1005,11 +1132,14 @@ public:
         }
         // fmt_helper::append_string_view(msg.msg(), dest);
         fmt_helper::append_string_view(msg.payload, dest);
-    }
 
-private:
-    std::chrono::seconds cache_timestamp_{0};
-    memory_buf_t cached_datetime_;
+        // append the key/value fields if any
+        if (msg.n_fields > 0)
+        {
+            dest.push_back(' ');
+            fmt_helper::append_fields(msg, dest);
+        }
+    }
 };
 
 } // namespace details
@@ -1020,10 +1150,13 @@ SPDLOG_INLINE pattern_formatter::pattern_formatter(
     , eol_(std::move(eol))
     , pattern_time_type_(time_type)
     , last_log_secs_(0)
+    , prev_log_secs_(std::chrono::seconds::min())
     , custom_handlers_(std::move(custom_user_flags))
 {
     std::memset(&cached_tm_, 0, sizeof(cached_tm_));
+    std::memset(&prev_tm_, 0, sizeof(prev_tm_));
     compile_pattern_(pattern_);
+    update_format_id_();
 }
 
 // use by default full formatter for if pattern is not given
@@ -1032,33 +1165,109 @@ SPDLOG_INLINE pattern_formatter::pattern_formatter(pattern_time_type time_type,
     , eol_(std::move(eol))
     , pattern_time_type_(time_type)
     , last_log_secs_(0)
+    , prev_log_secs_(std::chrono::seconds::min())
+{
+    std::memset(&cached_tm_, 0, sizeof(cached_tm_));
+    std::memset(&prev_tm_, 0, sizeof(prev_tm_));
+    compile_pattern_(pattern_);
+    update_format_id_();
+}
+
+SPDLOG_INLINE pattern_formatter::pattern_formatter(
+    const pattern_formatter &other, std::shared_ptr<const std::vector<details::pattern_step>> steps)
+    : pattern_(other.pattern_)
+    , eol_(other.eol_)
+    , pattern_time_type_(other.pattern_time_type_)
+    , last_log_secs_(0)
+    , prev_log_secs_(std::chrono::seconds::min())
+    , required_fields_(other.required_fields_)
+    , format_id_(other.format_id_)
+    , color_codes_enabled_(other.color_codes_enabled_)
+    , color_codes_(other.color_codes_)
+    , color_reset_(other.color_reset_)
 {
     std::memset(&cached_tm_, 0, sizeof(cached_tm_));
-    formatters_.push_back(details::make_unique<details::full_formatter>(details::padding_info{}));
+    std::memset(&prev_tm_, 0, sizeof(prev_tm_));
+    set_steps_(std::move(steps), true);
 }
 
 SPDLOG_INLINE std::unique_ptr<formatter> pattern_formatter::clone() const
 {
+    if (shareable_steps_ && custom_handlers_.empty())
+    {
+        return std::unique_ptr<formatter>(new pattern_formatter(*this, steps_));
+    }
     custom_flags cloned_custom_formatters;
     for (auto &it : custom_handlers_)
     {
         cloned_custom_formatters[it.first] = it.second->clone();
     }
-    return details::make_unique<pattern_formatter>(pattern_, pattern_time_type_, eol_, std::move(cloned_custom_formatters));
+    auto cloned = details::make_unique<pattern_formatter>(pattern_, pattern_time_type_, eol_, std::move(cloned_custom_formatters));
+    if (color_codes_enabled_)
+    {
+        cloned->set_color_codes(&color_codes_, color_reset_);
+    }
+    return cloned;
 }
 
 SPDLOG_INLINE void pattern_formatter::format(const details::log_msg &msg, memory_buf_t &dest)
+{
+    format_(msg, dest, nullptr);
+}
+
+SPDLOG_INLINE bool pattern_formatter::format_split(const details::log_msg &msg, memory_buf_t &dest, size_t &payload_pos)
+{
+    if (payload_step_ == static_cast<size_t>(-1))
+    {
+        return false;
+    }
+    format_(msg, dest, &payload_pos);
+    return true;
+}
+
+SPDLOG_INLINE void pattern_formatter::format_(const details::log_msg &msg, memory_buf_t &dest, size_t *payload_pos)
 {
     auto secs = std::chrono::duration_cast<std::chrono::seconds>(msg.time.time_since_epoch());
     if (secs != last_log_secs_)
     {
-        cached_tm_ = get_time_(msg);
-        last_log_secs_ = secs;
+        swap_cached_seconds_();
+        if (secs != last_log_secs_)
+        {
+            cached_tm_ = get_time_(msg);
+            last_log_secs_ = secs;
+            update_cached_steps_(msg);
+        }
+    }
+    if (color_codes_enabled_)
+    {
+        msg.color_range_start = 0;
+        msg.color_range_end = 0;
     }
 
-    for (auto &f : formatters_)
+    auto &steps = *steps_;
+    for (size_t i = 0; i < steps.size(); i++)
     {
-        f->format(msg, cached_tm_, dest);
+        auto &step = steps[i];
+        switch (step.step_kind)
+        {
+        case details::pattern_step::kind::cached:
+            details::fmt_helper::append_string_view(cached_text_[i][cached_slot_], dest);
+            break;
+        case details::pattern_step::kind::flag:
+            if (payload_pos != nullptr && i == payload_step_)
+            {
+                *payload_pos = dest.size();
+                break;
+            }
+            format_inline_flag_(step.flag, msg, dest);
+            break;
+        default:
+            for (auto &f : step.formatters)
+            {
+                f->format(msg, cached_tm_, dest);
+            }
+            break;
+        }
     }
     // write eol
     details::fmt_helper::append_string_view(eol_, dest);
@@ -1068,19 +1277,66 @@ SPDLOG_INLINE void pattern_formatter::set_pattern(std::string pattern)
 {
     pattern_ = std::move(pattern);
     compile_pattern_(pattern_);
+    update_format_id_();
 }
 
-SPDLOG_INLINE std::tm pattern_formatter::get_time_(const details::log_msg &msg)
+SPDLOG_INLINE size_t pattern_formatter::format_id() const
+{
+    return format_id_;
+}
+
+SPDLOG_INLINE unsigned pattern_formatter::required_fields() const
+{
+    return required_fields_;
+}
+
+SPDLOG_INLINE bool pattern_formatter::set_color_codes(const std::array<std::string, level::n_levels> *codes, string_view_t reset)
 {
-    if (pattern_time_type_ == pattern_time_type::local)
+    color_codes_enabled_ = codes != nullptr;
+    if (color_codes_enabled_)
     {
-        return details::os::localtime(log_clock::to_time_t(msg.time));
+        color_codes_ = *codes;
+        color_reset_.assign(reset.data(), reset.size());
     }
-    return details::os::gmtime(log_clock::to_time_t(msg.time));
+    update_format_id_();
+    return true;
+}
+
+// the output of custom flags is unknown, so formatters using them get no id
+SPDLOG_INLINE void pattern_formatter::update_format_id_()
+{
+    if (!custom_handlers_.empty())
+    {
+        format_id_ = 0;
+        return;
+    }
+    std::string signature("pattern");
+    signature += '\0';
+    signature += pattern_time_type_ == pattern_time_type::local ? 'l' : 'u';
+    signature += eol_;
+    signature += '\0';
+    signature += pattern_;
+    if (color_codes_enabled_)
+    {
+        for (auto &code : color_codes_)
+        {
+            signature += '\0';
+            signature += code;
+        }
+        signature += '\0';
+        signature += color_reset_;
+    }
+    format_id_ = details::make_format_id(signature);
+}
+
+SPDLOG_INLINE std::tm pattern_formatter::get_time_(const details::log_msg &msg)
+{
+    return details::time_cache::instance().get(log_clock::to_time_t(msg.time), pattern_time_type_ == pattern_time_type::local);
 }
 
 template<typename Padder>
-SPDLOG_INLINE void pattern_formatter::handle_flag_(char flag, details::padding_info padding)
+SPDLOG_INLINE void pattern_formatter::handle_flag_(
+    char flag, details::padding_info padding, std::vector<std::unique_ptr<details::flag_formatter>> &formatters)
 {
     // process custom flags
     auto it = custom_handlers_.find(flag);
@@ -1088,182 +1344,206 @@ SPDLOG_INLINE void pattern_formatter::handle_flag_(char flag, details::padding_i
     {
         auto custom_handler = it->second->clone();
         custom_handler->set_padding_info(padding);
-        formatters_.push_back(std::move(custom_handler));
+        formatters.push_back(std::move(custom_handler));
         return;
     }
 
     // process built-in flags
     switch (flag)
     {
-    case ('+'): // default formatter
-        formatters_.push_back(details::make_unique<details::full_formatter>(padding));
-        break;
-
     case 'n': // logger name
-        formatters_.push_back(details::make_unique<details::name_formatter<Padder>>(padding));
+        formatters.push_back(details::make_unique<details::name_formatter<Padder>>(padding));
         break;
 
     case 'l': // level
-        formatters_.push_back(details::make_unique<details::level_formatter<Padder>>(padding));
+        formatters.push_back(details::make_unique<details::level_formatter<Padder>>(padding));
         break;
 
     case 'L': // short level
-        formatters_.push_back(details::make_unique<details::short_level_formatter<Padder>>(padding));
+        formatters.push_back(details::make_unique<details::short_level_formatter<Padder>>(padding));
         break;
 
     case ('t'): // thread id
-        formatters_.push_back(details::make_unique<details::t_formatter<Padder>>(padding));
+        formatters.push_back(details::make_unique<details::t_formatter<Padder>>(padding));
+        break;
+
+    case ('N'): // thread name
+        formatters.push_back(details::make_unique<details::thread_name_formatter<Padder>>(padding));
         break;
 
     case ('v'): // the message text
-        formatters_.push_back(details::make_unique<details::v_formatter<Padder>>(padding));
+        formatters.push_back(details::make_unique<details::v_formatter<Padder>>(padding));
+        break;
+
+    case ('V'): // the message text, control chars escaped
+        formatters.push_back(details::make_unique<details::escaped_v_formatter<Padder>>(padding));
+        break;
+
+    case ('k'): // the key/value fields
+        formatters.push_back(details::make_unique<details::k_formatter<Padder>>(padding));
+        break;
+
+    case ('&'): // the mdc fields
+        formatters.push_back(details::make_unique<details::k_formatter<Padder, true>>(padding));
+        break;
+
+    case ('w'): // the sample rate
+        formatters.push_back(details::make_unique<details::w_formatter<Padder>>(padding));
+        break;
+
+    case ('Q'): // trace id
+        formatters.push_back(details::make_unique<details::trace_id_formatter<Padder, false>>(padding));
+        break;
+
+    case ('q'): // span id
+        formatters.push_back(details::make_unique<details::trace_id_formatter<Padder, true>>(padding));
         break;
 
     case ('a'): // weekday
-        formatters_.push_back(details::make_unique<details::a_formatter<Padder>>(padding));
+        formatters.push_back(details::make_unique<details::a_formatter<Padder>>(padding));
         break;
 
     case ('A'): // short weekday
-        formatters_.push_back(details::make_unique<details::A_formatter<Padder>>(padding));
+        formatters.push_back(details::make_unique<details::A_formatter<Padder>>(padding));
         break;
 
     case ('b'):
     case ('h'): // month
-        formatters_.push_back(details::make_unique<details::b_formatter<Padder>>(padding));
+        formatters.push_back(details::make_unique<details::b_formatter<Padder>>(padding));
         break;
 
     case ('B'): // short month
-        formatters_.push_back(details::make_unique<details::B_formatter<Padder>>(padding));
+        formatters.push_back(details::make_unique<details::B_formatter<Padder>>(padding));
         break;
 
     case ('c'): // datetime
-        formatters_.push_back(details::make_unique<details::c_formatter<Padder>>(padding));
+        formatters.push_back(details::make_unique<details::c_formatter<Padder>>(padding));
         break;
 
     case ('C'): // year 2 digits
-        formatters_.push_back(details::make_unique<details::C_formatter<Padder>>(padding));
+        formatters.push_back(details::make_unique<details::C_formatter<Padder>>(padding));
         break;
 
     case ('Y'): // year 4 digits
-        formatters_.push_back(details::make_unique<details::Y_formatter<Padder>>(padding));
+        formatters.push_back(details::make_unique<details::Y_formatter<Padder>>(padding));
         break;
 
     case ('D'):
     case ('x'): // datetime MM/DD/YY
-        formatters_.push_back(details::make_unique<details::D_formatter<Padder>>(padding));
+        formatters.push_back(details::make_unique<details::D_formatter<Padder>>(padding));
         break;
 
     case ('m'): // month 1-12
-        formatters_.push_back(details::make_unique<details::m_formatter<Padder>>(padding));
+        formatters.push_back(details::make_unique<details::m_formatter<Padder>>(padding));
         break;
 
     case ('d'): // day of month 1-31
-        formatters_.push_back(details::make_unique<details::d_formatter<Padder>>(padding));
+        formatters.push_back(details::make_unique<details::d_formatter<Padder>>(padding));
         break;
 
     case ('H'): // hours 24
-        formatters_.push_back(details::make_unique<details::H_formatter<Padder>>(padding));
+        formatters.push_back(details::make_unique<details::H_formatter<Padder>>(padding));
         break;
 
     case ('I'): // hours 12
-        formatters_.push_back(details::make_unique<details::I_formatter<Padder>>(padding));
+        formatters.push_back(details::make_unique<details::I_formatter<Padder>>(padding));
         break;
 
     case ('M'): // minutes
-        formatters_.push_back(details::make_unique<details::M_formatter<Padder>>(padding));
+        formatters.push_back(details::make_unique<details::M_formatter<Padder>>(padding));
         break;
 
     case ('S'): // seconds
-        formatters_.push_back(details::make_unique<details::S_formatter<Padder>>(padding));
+        formatters.push_back(details::make_unique<details::S_formatter<Padder>>(padding));
         break;
 
     case ('e'): // milliseconds
-        formatters_.push_back(details::make_unique<details::e_formatter<Padder>>(padding));
+        formatters.push_back(details::make_unique<details::e_formatter<Padder>>(padding));
         break;
 
     case ('f'): // microseconds
-        formatters_.push_back(details::make_unique<details::f_formatter<Padder>>(padding));
+        formatters.push_back(details::make_unique<details::f_formatter<Padder>>(padding));
         break;
 
     case ('F'): // nanoseconds
-        formatters_.push_back(details::make_unique<details::F_formatter<Padder>>(padding));
+        formatters.push_back(details::make_unique<details::F_formatter<Padder>>(padding));
         break;
 
     case ('E'): // seconds since epoch
-        formatters_.push_back(details::make_unique<details::E_formatter<Padder>>(padding));
+        formatters.push_back(details::make_unique<details::E_formatter<Padder>>(padding));
         break;
 
     case ('p'): // am/pm
-        formatters_.push_back(details::make_unique<details::p_formatter<Padder>>(padding));
+        formatters.push_back(details::make_unique<details::p_formatter<Padder>>(padding));
         break;
 
     case ('r'): // 12 hour clock 02:55:02 pm
-        formatters_.push_back(details::make_unique<details::r_formatter<Padder>>(padding));
+        formatters.push_back(details::make_unique<details::r_formatter<Padder>>(padding));
         break;
 
     case ('R'): // 24-hour HH:MM time
-        formatters_.push_back(details::make_unique<details::R_formatter<Padder>>(padding));
+        formatters.push_back(details::make_unique<details::R_formatter<Padder>>(padding));
         break;
 
     case ('T'):
     case ('X'): // ISO 8601 time format (HH:MM:SS)
-        formatters_.push_back(details::make_unique<details::T_formatter<Padder>>(padding));
+        formatters.push_back(details::make_unique<details::T_formatter<Padder>>(padding));
         break;
 
     case ('z'): // timezone
-        formatters_.push_back(details::make_unique<details::z_formatter<Padder>>(padding));
+        formatters.push_back(details::make_unique<details::z_formatter<Padder>>(padding));
         break;
 
     case ('P'): // pid
-        formatters_.push_back(details::make_unique<details::pid_formatter<Padder>>(padding));
+        formatters.push_back(details::make_unique<details::pid_formatter<Padder>>(padding));
         break;
 
     case ('^'): // color range start
-        formatters_.push_back(details::make_unique<details::color_start_formatter>(padding));
+        formatters.push_back(details::make_unique<details::color_start_formatter>(padding));
         break;
 
     case ('$'): // color range end
-        formatters_.push_back(details::make_unique<details::color_stop_formatter>(padding));
+        formatters.push_back(details::make_unique<details::color_stop_formatter>(padding));
         break;
 
     case ('@'): // source location (filename:filenumber)
-        formatters_.push_back(details::make_unique<details::source_location_formatter<Padder>>(padding));
+        formatters.push_back(details::make_unique<details::source_location_formatter<Padder>>(padding));
         break;
 
     case ('s'): // short source filename - without directory name
-        formatters_.push_back(details::make_unique<details::short_filename_formatter<Padder>>(padding));
+        formatters.push_back(details::make_unique<details::short_filename_formatter<Padder>>(padding));
         break;
 
     case ('g'): // full source filename
-        formatters_.push_back(details::make_unique<details::source_filename_formatter<Padder>>(padding));
+        formatters.push_back(details::make_unique<details::source_filename_formatter<Padder>>(padding));
         break;
 
     case ('#'): // source line number
-        formatters_.push_back(details::make_unique<details::source_linenum_formatter<Padder>>(padding));
+        formatters.push_back(details::make_unique<details::source_linenum_formatter<Padder>>(padding));
         break;
 
     case ('!'): // source funcname
-        formatters_.push_back(details::make_unique<details::source_funcname_formatter<Padder>>(padding));
+        formatters.push_back(details::make_unique<details::source_funcname_formatter<Padder>>(padding));
         break;
 
     case ('%'): // % char
-        formatters_.push_back(details::make_unique<details::ch_formatter>('%'));
+        formatters.push_back(details::make_unique<details::ch_formatter>('%'));
         break;
 
     case ('u'): // elapsed time since last log message in nanos
-        formatters_.push_back(details::make_unique<details::elapsed_formatter<Padder, std::chrono::nanoseconds>>(padding));
+        formatters.push_back(details::make_unique<details::elapsed_formatter<Padder, std::chrono::nanoseconds>>(padding));
         break;
 
     case ('i'): // elapsed time since last log message in micros
-        formatters_.push_back(details::make_unique<details::elapsed_formatter<Padder, std::chrono::microseconds>>(padding));
+        formatters.push_back(details::make_unique<details::elapsed_formatter<Padder, std::chrono::microseconds>>(padding));
         break;
 
     case ('o'): // elapsed time since last log message in millis
-        formatters_.push_back(details::make_unique<details::elapsed_formatter<Padder, std::chrono::milliseconds>>(padding));
+        formatters.push_back(details::make_unique<details::elapsed_formatter<Padder, std::chrono::milliseconds>>(padding));
         break;
 
     case ('O'): // elapsed time since last log message in seconds
-        formatters_.push_back(details::make_unique<details::elapsed_formatter<Padder, std::chrono::seconds>>(padding));
+        formatters.push_back(details::make_unique<details::elapsed_formatter<Padder, std::chrono::seconds>>(padding));
         break;
 
     default: // Unknown flag appears as is
@@ -1273,7 +1553,7 @@ SPDLOG_INLINE void pattern_formatter::handle_flag_(char flag, details::padding_i
         {
             unknown_flag->add_ch('%');
             unknown_flag->add_ch(flag);
-            formatters_.push_back((std::move(unknown_flag)));
+            formatters.push_back((std::move(unknown_flag)));
         }
         // fix issue #1617 (prev char was '!' and should have been treated as funcname flag instead of truncating flag)
         // spdlog::set_pattern("[%10!] %v") => "[      main] some message"
@@ -1281,9 +1561,9 @@ SPDLOG_INLINE void pattern_formatter::handle_flag_(char flag, details::padding_i
         else
         {
             padding.truncate_ = false;
-            formatters_.push_back(details::make_unique<details::source_funcname_formatter<Padder>>(padding));
+            formatters.push_back(details::make_unique<details::source_funcname_formatter<Padder>>(padding));
             unknown_flag->add_ch(flag);
-            formatters_.push_back((std::move(unknown_flag)));
+            formatters.push_back((std::move(unknown_flag)));
         }
 
         break;
@@ -1346,50 +1626,291 @@ SPDLOG_INLINE details::padding_info pattern_formatter::handle_padspec_(std::stri
     return details::padding_info{std::min<size_t>(width, max_width), side, truncate};
 }
 
+// compile the pattern into steps: literal chars and flags that depend only on the
+// second of the message time are merged into cached steps, rendered once per second.
+// unpadded flags of the message itself are formatted inline, the rest by their flag formatters.
 SPDLOG_INLINE void pattern_formatter::compile_pattern_(const std::string &pattern)
 {
+    using details::pattern_step;
     auto end = pattern.end();
-    std::unique_ptr<details::aggregate_formatter> user_chars;
-    formatters_.clear();
+    details::aggregate_formatter *user_chars = nullptr;
+    std::vector<pattern_step> steps;
+    bool shareable = true;
+    required_fields_ = details::msg_fields::none;
     for (auto it = pattern.begin(); it != end; ++it)
     {
         if (*it == '%')
         {
-            if (user_chars) // append user chars found so far
-            {
-                formatters_.push_back(std::move(user_chars));
-            }
-
+            user_chars = nullptr;
             auto padding = handle_padspec_(++it, end);
 
-            if (it != end)
+            if (it == end)
             {
-                if (padding.enabled())
-                {
-                    handle_flag_<details::scoped_padder>(*it, padding);
-                }
-                else
-                {
-                    handle_flag_<details::null_scoped_padder>(*it, padding);
-                }
+                break;
+            }
+            auto flag = *it;
+            bool custom = custom_handlers_.find(flag) != custom_handlers_.end();
+            shareable = shareable && !custom && !is_stateful_flag_(flag);
+            required_fields_ |= custom ? details::msg_fields::all : flag_fields_(flag);
+            // the color range marks take no room: their padding is ignored
+            if (!custom && (!padding.enabled() || flag == '^' || flag == '$') && is_inline_flag_(flag))
+            {
+                steps.emplace_back(pattern_step::kind::flag, flag);
+                continue;
+            }
+            // the default format: its date/time part is rendered once per second
+            if (!custom && flag == '+')
+            {
+                auto datetime = details::make_unique<details::full_datetime_formatter>(padding);
+                step_formatters_(steps, pattern_step::kind::cached).push_back(std::move(datetime));
+                step_formatters_(steps, pattern_step::kind::formatters).push_back(details::make_unique<details::full_formatter>(padding));
+                continue;
+            }
+            auto &formatters =
+                step_formatters_(steps, !custom && is_per_second_flag_(flag) ? pattern_step::kind::cached : pattern_step::kind::formatters);
+            if (padding.enabled())
+            {
+                handle_flag_<details::scoped_padder>(flag, padding, formatters);
             }
             else
             {
-                break;
+                handle_flag_<details::null_scoped_padder>(flag, padding, formatters);
             }
         }
         else // chars not following the % sign should be displayed as is
         {
-            if (!user_chars)
+            if (user_chars == nullptr)
             {
-                user_chars = details::make_unique<details::aggregate_formatter>();
+                auto chars = details::make_unique<details::aggregate_formatter>();
+                user_chars = chars.get();
+                step_formatters_(steps, pattern_step::kind::cached).push_back(std::move(chars));
             }
             user_chars->add_ch(*it);
         }
     }
-    if (user_chars) // append raw chars found so far
+    set_steps_(std::make_shared<std::vector<pattern_step>>(std::move(steps)), shareable);
+}
+
+// use the steps and render their cached text
+SPDLOG_INLINE void pattern_formatter::set_steps_(std::shared_ptr<const std::vector<details::pattern_step>> steps, bool shareable)
+{
+    steps_ = std::move(steps);
+    shareable_steps_ = shareable;
+    payload_step_ = static_cast<size_t>(-1);
+    for (size_t i = 0; i < steps_->size(); i++)
+    {
+        if ((*steps_)[i].step_kind == details::pattern_step::kind::flag && (*steps_)[i].flag == 'v')
+        {
+            payload_step_ = i;
+            break;
+        }
+    }
+    cached_text_.assign(steps_->size(), std::array<std::string, 2>());
+
+    details::log_msg msg;
+    msg.time = log_clock::time_point(std::chrono::duration_cast<log_clock::duration>(last_log_secs_));
+    update_cached_steps_(msg);
+    prev_log_secs_ = std::chrono::seconds::min();
+}
+
+SPDLOG_INLINE std::vector<std::unique_ptr<details::flag_formatter>> &pattern_formatter::step_formatters_(
+    std::vector<details::pattern_step> &steps, details::pattern_step::kind step_kind)
+{
+    if (steps.empty() || steps.back().step_kind != step_kind)
+    {
+        steps.emplace_back(step_kind);
+    }
+    return steps.back().formatters;
+}
+
+SPDLOG_INLINE void pattern_formatter::update_cached_steps_(const details::log_msg &msg)
+{
+    memory_buf_t buf;
+    auto &steps = *steps_;
+    for (size_t i = 0; i < steps.size(); i++)
+    {
+        if (steps[i].step_kind != details::pattern_step::kind::cached)
+        {
+            continue;
+        }
+        buf.clear();
+        for (auto &f : steps[i].formatters)
+        {
+            f->format(msg, cached_tm_, buf);
+        }
+        cached_text_[i][cached_slot_].assign(buf.data(), buf.size());
+    }
+}
+
+// make the previous second the current one (and vice versa)
+SPDLOG_INLINE void pattern_formatter::swap_cached_seconds_()
+{
+    std::swap(cached_tm_, prev_tm_);
+    std::swap(last_log_secs_, prev_log_secs_);
+    cached_slot_ ^= 1;
+}
+
+SPDLOG_INLINE bool pattern_formatter::is_inline_flag_(char flag)
+{
+    switch (flag)
+    {
+    case 'n':
+    case 'l':
+    case 'L':
+    case 't':
+    case 'v':
+    case 'V':
+    case 'e':
+    case 'f':
+    case 'F':
+    case 'P':
+    case '^':
+    case '$':
+        return true;
+    default:
+        return false;
+    }
+}
+
+// flags whose output depends only on the second of the message time
+SPDLOG_INLINE bool pattern_formatter::is_per_second_flag_(char flag)
+{
+    switch (flag)
+    {
+    case 'a':
+    case 'A':
+    case 'b':
+    case 'h':
+    case 'B':
+    case 'c':
+    case 'C':
+    case 'Y':
+    case 'D':
+    case 'x':
+    case 'm':
+    case 'd':
+    case 'H':
+    case 'I':
+    case 'M':
+    case 'S':
+    case 'E':
+    case 'p':
+    case 'r':
+    case 'R':
+    case 'T':
+    case 'X':
+    case 'z':
+    case '%':
+        return true;
+    default:
+        return false;
+    }
+}
+
+SPDLOG_INLINE bool pattern_formatter::is_stateful_flag_(char flag)
+{
+    switch (flag)
+    {
+    case 'u': // the elapsed time flags keep the time of the previous message
+    case 'i':
+    case 'o':
+    case 'O':
+    case 'N': // the thread name flag keeps the last name
+        return true;
+    default:
+        return false;
+    }
+}
+
+SPDLOG_INLINE unsigned pattern_formatter::flag_fields_(char flag)
+{
+    switch (flag)
     {
-        formatters_.push_back(std::move(user_chars));
+    case 'n':
+    case 'l':
+    case 'L':
+    case 'v':
+    case 'V':
+    case 'k':
+    case 'w':
+    case 'P':
+    case '^':
+    case '$':
+    case '@':
+    case 's':
+    case 'g':
+    case '#':
+    case '!':
+    case '%':
+        return details::msg_fields::none;
+    case 't':
+    case 'N':
+        return details::msg_fields::thread_id;
+    case '&':
+    case 'Q':
+    case 'q':
+        return details::msg_fields::context;
+    default: // the time flags (and the unknown ones)
+        return details::msg_fields::time;
+    }
+}
+
+// same output as the flag formatters of the inline flags (without padding)
+SPDLOG_INLINE void pattern_formatter::format_inline_flag_(char flag, const details::log_msg &msg, memory_buf_t &dest) const
+{
+    using details::fmt_helper::append_int;
+    using details::fmt_helper::append_string_view;
+    switch (flag)
+    {
+    case 'n':
+        append_string_view(msg.logger_name, dest);
+        break;
+    case 'l':
+        append_string_view(level::to_string_view(msg.level), dest);
+        break;
+    case 'L':
+        append_string_view(level::to_short_c_str(msg.level), dest);
+        break;
+    case 't':
+        append_int(msg.thread_id, dest);
+        break;
+    case 'v':
+        append_string_view(msg.payload, dest);
+        break;
+    case 'V':
+        details::escape_control_chars(msg.payload, dest);
+        break;
+    case 'e':
+        details::fmt_helper::pad3(
+            static_cast<uint32_t>(details::fmt_helper::time_fraction<std::chrono::milliseconds>(msg.time).count()), dest);
+        break;
+    case 'f':
+        details::fmt_helper::pad6(static_cast<size_t>(details::fmt_helper::time_fraction<std::chrono::microseconds>(msg.time).count()), dest);
+        break;
+    case 'F':
+        details::fmt_helper::pad9(static_cast<size_t>(details::fmt_helper::time_fraction<std::chrono::nanoseconds>(msg.time).count()), dest);
+        break;
+    case 'P':
+        append_int(static_cast<uint32_t>(details::os::cached_pid()), dest);
+        break;
+    case '^':
+        if (color_codes_enabled_)
+        {
+            append_string_view(color_codes_[static_cast<size_t>(msg.level)], dest);
+            break;
+        }
+        msg.color_range_start = dest.size();
+        break;
+    case '$':
+        if (color_codes_enabled_)
+        {
+            append_string_view(color_reset_, dest);
+            break;
+        }
+        msg.color_range_end = dest.size();
+        break;
+    default:
+        break;
     }
 }
 } // namespace spdlog
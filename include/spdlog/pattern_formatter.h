@@ -8,6 +8,7 @@
 #include <spdlog/details/os.h>
 #include <spdlog/formatter.h>
 
+#include <array>
 #include <chrono>
 #include <ctime>
 #include <memory>
@@ -61,6 +62,26 @@ protected:
     padding_info padinfo_;
 };
 
+// a piece of a compiled pattern (see pattern_formatter::compile_pattern_)
+struct pattern_step
+{
+    enum class kind
+    {
+        cached,    // literal chars and flags that change at most once per second - rendered once per second
+        flag,      // flag without padding, formatted inline (no virtual call)
+        formatters // anything else - formatted by the flag formatters
+    };
+
+    explicit pattern_step(kind step_kind, char step_flag = '\0')
+        : step_kind(step_kind)
+        , flag(step_flag)
+    {}
+
+    kind step_kind;
+    char flag;
+    std::vector<std::unique_ptr<flag_formatter>> formatters;
+};
+
 } // namespace details
 
 class SPDLOG_API custom_flag_formatter : public details::flag_formatter
@@ -88,8 +109,18 @@ public:
     pattern_formatter(const pattern_formatter &other) = delete;
     pattern_formatter &operator=(const pattern_formatter &other) = delete;
 
+    // the clones share the compiled pattern (each renders the cached steps on its own), unless it has
+    // custom flags or the elapsed time flags, whose formatters keep state between messages
     std::unique_ptr<formatter> clone() const override;
     void format(const details::log_msg &msg, memory_buf_t &dest) override;
+    // if the pattern has an unpadded %v (the first one is left out)
+    bool format_split(const details::log_msg &msg, memory_buf_t &dest, size_t &payload_pos) override;
+    // shared by pattern formatters with the same pattern, time type, eol and color codes, and no custom flags
+    size_t format_id() const override;
+    // of the flags of the pattern (all if it has custom flags)
+    unsigned required_fields() const override;
+    // written at %^ and %$
+    bool set_color_codes(const std::array<std::string, level::n_levels> *codes, string_view_t reset) override;
 
     template<typename T, typename... Args>
     pattern_formatter &add_flag(char flag, Args &&...args)
@@ -105,12 +136,47 @@ private:
     pattern_time_type pattern_time_type_;
     std::tm cached_tm_;
     std::chrono::seconds last_log_secs_;
-    std::vector<std::unique_ptr<details::flag_formatter>> formatters_;
+    // the previous second is kept too, so messages alternating between two seconds
+    // (e.g. from several threads around a second boundary) don't render the cached steps each time
+    std::tm prev_tm_;
+    std::chrono::seconds prev_log_secs_;
+    size_t cached_slot_ = 0; // index of the current second's text in cached_text_
+    // shared by the clones if none of its formatters keeps state (see clone())
+    std::shared_ptr<const std::vector<details::pattern_step>> steps_;
+    bool shareable_steps_ = false;
+    // the first step of an unpadded %v, npos if none
+    size_t payload_step_ = static_cast<size_t>(-1);
+    unsigned required_fields_ = details::msg_fields::all;
+    // the text of each cached step, rendered for the current and the previous second
+    std::vector<std::array<std::string, 2>> cached_text_;
     custom_flags custom_handlers_;
+    size_t format_id_ = 0;
+    bool color_codes_enabled_ = false;
+    std::array<std::string, level::n_levels> color_codes_;
+    std::string color_reset_;
+
+    // a clone sharing the compiled steps of other
+    pattern_formatter(const pattern_formatter &other, std::shared_ptr<const std::vector<details::pattern_step>> steps);
 
     std::tm get_time_(const details::log_msg &msg);
+    // format msg into dest - without the payload step if payload_pos is set, storing where it goes
+    void format_(const details::log_msg &msg, memory_buf_t &dest, size_t *payload_pos);
     template<typename Padder>
-    void handle_flag_(char flag, details::padding_info padding);
+    void handle_flag_(char flag, details::padding_info padding, std::vector<std::unique_ptr<details::flag_formatter>> &formatters);
+
+    // the formatters of the last step if it is of the given kind, or of a new step otherwise
+    static std::vector<std::unique_ptr<details::flag_formatter>> &step_formatters_(
+        std::vector<details::pattern_step> &steps, details::pattern_step::kind step_kind);
+    // flags whose formatters keep state between messages (the steps using them are not shared)
+    static bool is_stateful_flag_(char flag);
+    // the details::msg_fields read by the formatter of the flag
+    static unsigned flag_fields_(char flag);
+    // render the cached steps with the current cached_tm_
+    void update_cached_steps_(const details::log_msg &msg);
+    void swap_cached_seconds_();
+    static bool is_inline_flag_(char flag);
+    static bool is_per_second_flag_(char flag);
+    void format_inline_flag_(char flag, const details::log_msg &msg, memory_buf_t &dest) const;
 
     // Extract given pad spec (e.g. %8X)
     // Advance the given it pass the end of the padding spec found (if any)
@@ -118,6 +184,8 @@ private:
     static details::padding_info handle_padspec_(std::string::const_iterator &it, std::string::const_iterator end);
 
     void compile_pattern_(const std::string &pattern);
+    void set_steps_(std::shared_ptr<const std::vector<details::pattern_step>> steps, bool shareable);
+    void update_format_id_();
 };
 } // namespace spdlog
 
@@ -0,0 +1,58 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Processing stages of the messages of an async logger (see async_logger::set_processors()).
+//
+// The stages run on the thread pool workers, in order, before the messages are passed to the sinks - the
+// logging threads don't pay for them, and no sink lock is held. They get the messages of a logger by batches
+// (the consecutive messages of the logger dequeued together) and change the batch in place:
+//
+// - filter: move the messages kept to the front, return their number
+// - transform / enrich: replace the messages - the strings they point to must stay valid until the stage is
+//   called again (e.g. in buffers of the stage)
+// - route: pass messages to other sinks and drop them from the batch
+//
+// The messages a stage drops are not passed to the next stages. If a stage throws, the batch is dropped and
+// the error reported to the logger's error handler.
+// A stage is called by one worker at a time, but by several workers concurrently if it is shared by loggers
+// of different shards, or if its logger is order insensitive (see async_logger::set_order_insensitive()).
+//
+// Example - drop the messages of the health checks:
+//
+//     class health_check_filter : public spdlog::processor
+//     {
+//     public:
+//         size_t process(spdlog::details::log_msg *msgs, size_t n_msgs) override
+//         {
+//             auto end = std::remove_if(msgs, msgs + n_msgs, [](const spdlog::details::log_msg &msg) {
+//                 return msg.payload.size() >= 6 && std::memcmp(msg.payload.data(), "health", 6) == 0;
+//             });
+//             return static_cast<size_t>(end - msgs);
+//         }
+//     };
+//
+//     async_logger->set_processors({std::make_shared<health_check_filter>()});
+
+#include <spdlog/common.h>
+#include <spdlog/details/log_msg.h>
+
+namespace spdlog {
+
+class processor
+{
+public:
+    virtual ~processor() = default;
+
+    // process the batch of messages in place. return the number of messages left, at the front of msgs.
+    virtual size_t process(details::log_msg *msgs, size_t n_msgs) = 0;
+
+    // the details::msg_fields the stage reads: captured when the messages are created
+    virtual unsigned required_fields() const
+    {
+        return details::msg_fields::all;
+    }
+};
+
+} // namespace spdlog
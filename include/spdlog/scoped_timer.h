@@ -0,0 +1,81 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Log the time taken by a scope, timed with spdlog::tsc_stopwatch.
+//
+// Usage:
+//
+// void handle_request()
+// {
+//     SPDLOG_SCOPE_TIMER(logger, spdlog::level::debug, "handle_request");
+//     ...
+// }                                                 => "handle_request took 1.234ms" (if the logger logs debug)
+//
+// SPDLOG_SCOPE_TIMER_OVER(logger, spdlog::level::warn, "handle_request", std::chrono::milliseconds(100));
+//                                                   => logged only if the scope took 100ms or more
+//
+// The logger's level is checked on entry: a disabled timer reads no clock and formats nothing.
+
+#include <spdlog/common.h>
+#include <spdlog/logger.h>
+#include <spdlog/stopwatch.h>
+
+#include <chrono>
+
+namespace spdlog {
+
+class scoped_timer
+{
+public:
+    scoped_timer(logger *l, level::level_enum lvl, string_view_t name,
+        std::chrono::nanoseconds threshold = std::chrono::nanoseconds::zero(), source_loc loc = source_loc{})
+        : logger_(l != nullptr && l->should_log(lvl) ? l : nullptr)
+        , level_(lvl)
+        , name_(name)
+        , threshold_(threshold)
+        , loc_(loc)
+    {
+        if (logger_ != nullptr)
+        {
+            sw_.reset();
+        }
+    }
+
+    scoped_timer(const scoped_timer &) = delete;
+    scoped_timer &operator=(const scoped_timer &) = delete;
+
+    ~scoped_timer()
+    {
+        if (logger_ == nullptr)
+        {
+            return;
+        }
+        auto elapsed = sw_.elapsed();
+        if (elapsed >= threshold_)
+        {
+            logger_->log(loc_, level_, "{} took {:.3f}ms", name_, elapsed.count() * 1000);
+        }
+    }
+
+private:
+    // null if the level is disabled
+    logger *logger_;
+    level::level_enum level_;
+    string_view_t name_;
+    std::chrono::nanoseconds threshold_;
+    source_loc loc_;
+    tsc_stopwatch sw_{false};
+};
+
+} // namespace spdlog
+
+#define SPDLOG_SCOPE_TIMER_CONCAT_(a, b) a##b
+#define SPDLOG_SCOPE_TIMER_NAME_(line) SPDLOG_SCOPE_TIMER_CONCAT_(spdlog_scope_timer_, line)
+
+// logger is a pointer (or a shared_ptr), name a string that outlives the scope
+#define SPDLOG_SCOPE_TIMER_OVER(logger, level, name, threshold)                                                                            \
+    spdlog::scoped_timer SPDLOG_SCOPE_TIMER_NAME_(__LINE__)(&*(logger), level, name, threshold, SPDLOG_SOURCE_LOC)
+
+#define SPDLOG_SCOPE_TIMER(logger, level, name) SPDLOG_SCOPE_TIMER_OVER(logger, level, name, std::chrono::nanoseconds::zero())
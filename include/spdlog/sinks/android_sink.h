@@ -10,22 +10,34 @@
 #    include <spdlog/details/os.h>
 #    include <spdlog/sinks/base_sink.h>
 #    include <spdlog/details/synchronous_factory.h>
+#    include <spdlog/details/scoped_buffer.h>
 
 #    include <android/log.h>
+#    include <atomic>
 #    include <chrono>
+#    include <condition_variable>
+#    include <deque>
 #    include <mutex>
 #    include <string>
 #    include <thread>
 
+// retries of a message refused by logd (EAGAIN), 5ms apart, by the background retry thread
 #    if !defined(SPDLOG_ANDROID_RETRIES)
 #        define SPDLOG_ANDROID_RETRIES 2
 #    endif
 
+// max messages waiting for a retry. the newer ones are dropped (see android_sink::dropped_count())
+#    if !defined(SPDLOG_ANDROID_RETRY_QUEUE_SIZE)
+#        define SPDLOG_ANDROID_RETRY_QUEUE_SIZE 1024
+#    endif
+
 namespace spdlog {
 namespace sinks {
 
 /*
  * Android sink (logging using __android_log_write)
+ * The messages refused by logd (EAGAIN) are not retried by the logging thread: they are queued, with the
+ * messages logged after them, to a background thread that retries them - several at once, in a single write.
  */
 template<typename Mutex>
 class android_sink final : public base_sink<Mutex>
@@ -36,30 +48,59 @@ public:
         , use_raw_msg_(use_raw_msg)
     {}
 
+    android_sink(const android_sink &) = delete;
+    android_sink &operator=(const android_sink &) = delete;
+
+    // retry the queued messages once more and stop the retry thread
+    ~android_sink() override
+    {
+        {
+            std::lock_guard<std::mutex> lock(retry_mutex_);
+            stopping_ = true;
+        }
+        retry_cv_.notify_one();
+        if (retry_thread_.joinable())
+        {
+            retry_thread_.join();
+        }
+    }
+
+    // the messages dropped: retry queue full, or still refused after SPDLOG_ANDROID_RETRIES retries
+    size_t dropped_count() const
+    {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
 protected:
     void sink_it_(const details::log_msg &msg) override
     {
         const android_LogPriority priority = convert_to_android_(msg.level);
-        memory_buf_t formatted;
+        details::scoped_buffer formatted_buffer;
+        auto &formatted = formatted_buffer.get();
         if (use_raw_msg_)
         {
             details::fmt_helper::append_string_view(msg.payload, formatted);
         }
         else
         {
-            base_sink<Mutex>::formatter_->format(msg, formatted);
+            base_sink<Mutex>::format_(msg, formatted);
+        }
+        // after the messages waiting for a retry
+        if (pending_.load(std::memory_order_acquire) > 0)
+        {
+            queue_retry_(priority, formatted);
+            return;
         }
         formatted.push_back('\0');
         const char *msg_output = formatted.data();
 
         // See system/core/liblog/logger_write.c for explanation of return value
         int ret = __android_log_write(priority, tag_.c_str(), msg_output);
-        int retry_count = 0;
-        while ((ret == -11 /*EAGAIN*/) && (retry_count < SPDLOG_ANDROID_RETRIES))
+        if (ret == -11 /*EAGAIN*/)
         {
-            details::os::sleep_for_millis(5);
-            ret = __android_log_write(priority, tag_.c_str(), msg_output);
-            retry_count++;
+            formatted.resize(formatted.size() - 1);
+            queue_retry_(priority, formatted);
+            return;
         }
 
         if (ret < 0)
@@ -71,6 +112,87 @@ protected:
     void flush_() override {}
 
 private:
+    struct pending_msg
+    {
+        android_LogPriority priority;
+        std::string text;
+    };
+
+    // longest write of several messages at once (logd payloads are up to 4068 bytes with the tag)
+    static const size_t max_batch_size = 4000;
+
+    std::mutex retry_mutex_;
+    std::condition_variable retry_cv_;
+    std::deque<pending_msg> retry_q_;
+    std::atomic<size_t> pending_{0}; // queued or being retried
+    std::atomic<size_t> dropped_{0};
+    bool stopping_{false};
+    std::thread retry_thread_;
+
+    void queue_retry_(android_LogPriority priority, const memory_buf_t &formatted)
+    {
+        {
+            std::lock_guard<std::mutex> lock(retry_mutex_);
+            if (retry_q_.size() >= SPDLOG_ANDROID_RETRY_QUEUE_SIZE)
+            {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            retry_q_.push_back(pending_msg{priority, std::string(formatted.data(), formatted.size())});
+            pending_.fetch_add(1, std::memory_order_release);
+            if (!retry_thread_.joinable())
+            {
+                retry_thread_ = std::thread([this] { retry_loop_(); });
+            }
+        }
+        retry_cv_.notify_one();
+    }
+
+    // write the queued messages in order, those of the same priority together
+    void retry_loop_()
+    {
+        for (;;)
+        {
+            pending_msg batch;
+            size_t n = 1;
+            bool stopping;
+            {
+                std::unique_lock<std::mutex> lock(retry_mutex_);
+                retry_cv_.wait(lock, [this] { return stopping_ || !retry_q_.empty(); });
+                if (retry_q_.empty())
+                {
+                    return;
+                }
+                batch = std::move(retry_q_.front());
+                retry_q_.pop_front();
+                while (!retry_q_.empty() && retry_q_.front().priority == batch.priority &&
+                       batch.text.size() + 1 + retry_q_.front().text.size() <= max_batch_size)
+                {
+                    if (batch.text.empty() || batch.text.back() != '\n')
+                    {
+                        batch.text.push_back('\n');
+                    }
+                    batch.text += retry_q_.front().text;
+                    retry_q_.pop_front();
+                    n++;
+                }
+                stopping = stopping_;
+            }
+
+            int ret = __android_log_write(batch.priority, tag_.c_str(), batch.text.c_str());
+            for (int retry_count = 0; ret == -11 /*EAGAIN*/ && retry_count < SPDLOG_ANDROID_RETRIES && !stopping; retry_count++)
+            {
+                details::os::sleep_for_millis(5);
+                ret = __android_log_write(batch.priority, tag_.c_str(), batch.text.c_str());
+            }
+            if (ret < 0)
+            {
+                dropped_.fetch_add(n, std::memory_order_relaxed);
+            }
+            pending_.fetch_sub(n, std::memory_order_release);
+        }
+    }
+
     static android_LogPriority convert_to_android_(spdlog::level::level_enum level)
     {
         switch (level)
@@ -9,6 +9,8 @@
 
 #include <spdlog/pattern_formatter.h>
 #include <spdlog/details/os.h>
+#include <spdlog/details/fmt_helper.h>
+#include <spdlog/details/scoped_buffer.h>
 
 namespace spdlog {
 namespace sinks {
@@ -28,6 +30,17 @@ SPDLOG_INLINE ansicolor_sink<ConsoleMutex>::ansicolor_sink(FILE *target_file, co
     colors_[level::err] = to_string_(red_bold);
     colors_[level::critical] = to_string_(bold_on_red);
     colors_[level::off] = to_string_(reset);
+    update_formatter_colors_();
+}
+
+template<typename ConsoleMutex>
+SPDLOG_INLINE ansicolor_sink<ConsoleMutex>::~ansicolor_sink()
+{
+    flush_timer_.reset();
+    flusher_.reset();
+    std::lock_guard<mutex_t> lock(mutex_);
+    std::lock_guard<std::mutex> buffer_lock(buffer_mutex_);
+    flush_buffer_();
 }
 
 template<typename ConsoleMutex>
@@ -35,6 +48,7 @@ SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::set_color(level::level_enum col
 {
     std::lock_guard<mutex_t> lock(mutex_);
     colors_[color_level] = to_string_(color);
+    update_formatter_colors_();
 }
 
 template<typename ConsoleMutex>
@@ -43,33 +57,111 @@ SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::log(const details::log_msg &msg
     // Wrap the originally formatted message in color codes.
     // If color is not supported in the terminal, log as is instead.
     std::lock_guard<mutex_t> lock(mutex_);
+    details::profile_timer timer;
+    format_and_print_(msg);
+    profile_.on_sunk(1, timer);
+}
+
+template<typename ConsoleMutex>
+SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::log_shared(const details::log_msg &msg, details::shared_format &shared)
+{
+    std::lock_guard<mutex_t> lock(mutex_);
+    details::profile_timer timer;
+    auto format_id = formatter_->format_id();
+    if (format_id == 0)
+    {
+        format_and_print_(msg);
+    }
+    else
+    {
+        print_formatted_(msg, details::fmt_helper::to_string_view(shared.format(*formatter_, format_id, msg, profile_)));
+    }
+    profile_.on_sunk(1, timer);
+}
+
+template<typename ConsoleMutex>
+SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::log_formatted(const details::log_msg &msg, string_view_t formatted)
+{
+    std::lock_guard<mutex_t> lock(mutex_);
+    details::profile_timer timer;
+    print_formatted_(msg, formatted);
+    profile_.on_sunk(1, timer);
+}
+
+template<typename ConsoleMutex>
+SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::format_and_print_(const details::log_msg &msg)
+{
     msg.color_range_start = 0;
     msg.color_range_end = 0;
-    memory_buf_t formatted;
-    formatter_->format(msg, formatted);
-    if (should_do_colors_ && msg.color_range_end > msg.color_range_start)
+    details::scoped_buffer formatted_buffer;
+    auto &formatted = formatted_buffer.get();
+    format_with_(*formatter_, msg, formatted);
+    print_formatted_(msg, details::fmt_helper::to_string_view(formatted));
+}
+
+template<typename ConsoleMutex>
+SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::print_formatted_(const details::log_msg &msg, string_view_t formatted)
+{
+    bool colored = should_do_colors_ && msg.color_range_end > msg.color_range_start && msg.color_range_end <= formatted.size();
+    if (!buffered_)
+    {
+        if (!colored)
+        {
+            write_out_(formatted);
+            return;
+        }
+        details::scoped_buffer colored_buffer;
+        auto &line = colored_buffer.get();
+        append_colored_(msg, formatted, line);
+        write_out_(details::fmt_helper::to_string_view(line));
+        return;
+    }
+    auto size = colored ? formatted.size() + colors_[msg.level].size() + reset.size() : formatted.size();
+    std::lock_guard<std::mutex> buffer_lock(buffer_mutex_);
+    if (buffer_.size() + size > max_buffer_size_)
     {
-        // before color range
-        print_range_(formatted, 0, msg.color_range_start);
-        // in color range
-        print_ccode_(colors_[msg.level]);
-        print_range_(formatted, msg.color_range_start, msg.color_range_end);
-        print_ccode_(reset);
-        // after color range
-        print_range_(formatted, msg.color_range_end, formatted.size());
+        flush_buffer_();
     }
-    else // no color
+    if (colored)
     {
-        print_range_(formatted, 0, formatted.size());
+        append_colored_(msg, formatted, buffer_);
     }
-    fflush(target_file_);
+    else
+    {
+        buffer_.append(formatted.data(), formatted.data() + formatted.size());
+    }
+    if (buffer_.size() >= max_buffer_size_)
+    {
+        flush_buffer_();
+    }
+}
+
+// the formatted text with the color range wrapped in the color codes of the level
+template<typename ConsoleMutex>
+SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::append_colored_(const details::log_msg &msg, string_view_t formatted, memory_buf_t &dest)
+{
+    using details::fmt_helper::append_string_view;
+    // before color range
+    append_string_view(string_view_t(formatted.data(), msg.color_range_start), dest);
+    // in color range
+    append_string_view(colors_[msg.level], dest);
+    append_string_view(string_view_t(formatted.data() + msg.color_range_start, msg.color_range_end - msg.color_range_start), dest);
+    append_string_view(reset, dest);
+    // after color range
+    append_string_view(string_view_t(formatted.data() + msg.color_range_end, formatted.size() - msg.color_range_end), dest);
 }
 
 template<typename ConsoleMutex>
 SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::flush()
 {
     std::lock_guard<mutex_t> lock(mutex_);
+    details::profile_timer timer;
+    {
+        std::lock_guard<std::mutex> buffer_lock(buffer_mutex_);
+        flush_buffer_();
+    }
     fflush(target_file_);
+    profile_.on_flushed(timer);
 }
 
 template<typename ConsoleMutex>
@@ -77,6 +169,7 @@ SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::set_pattern(const std::string &
 {
     std::lock_guard<mutex_t> lock(mutex_);
     formatter_ = std::unique_ptr<spdlog::formatter>(new pattern_formatter(pattern));
+    update_formatter_colors_();
 }
 
 template<typename ConsoleMutex>
@@ -84,6 +177,7 @@ SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::set_formatter(std::unique_ptr<s
 {
     std::lock_guard<mutex_t> lock(mutex_);
     formatter_ = std::move(sink_formatter);
+    update_formatter_colors_();
 }
 
 template<typename ConsoleMutex>
@@ -99,28 +193,78 @@ SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::set_color_mode(color_mode mode)
     {
     case color_mode::always:
         should_do_colors_ = true;
-        return;
+        break;
     case color_mode::automatic:
         should_do_colors_ = details::os::in_terminal(target_file_) && details::os::is_color_terminal();
-        return;
+        break;
     case color_mode::never:
         should_do_colors_ = false;
-        return;
+        break;
     default:
         should_do_colors_ = false;
     }
+    update_formatter_colors_();
 }
 
 template<typename ConsoleMutex>
-SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::print_ccode_(const string_view_t &color_code)
+SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::update_formatter_colors_()
 {
-    fwrite(color_code.data(), sizeof(char), color_code.size(), target_file_);
+    // before the constructor sets the colors
+    if (colors_[level::off].empty())
+    {
+        return;
+    }
+    formatter_->set_color_codes(should_do_colors_ ? &colors_ : nullptr, reset);
 }
 
 template<typename ConsoleMutex>
-SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::print_range_(const memory_buf_t &formatted, size_t start, size_t end)
+SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::set_buffering(console_buffering mode, size_t max_size, std::chrono::milliseconds interval)
 {
-    fwrite(formatted.data() + start, sizeof(char), end - start, target_file_);
+    // stopped unlocked: the posted writes take the lock
+    flush_timer_.reset();
+    flusher_.reset();
+    std::lock_guard<mutex_t> lock(mutex_);
+    {
+        std::lock_guard<std::mutex> buffer_lock(buffer_mutex_);
+        flush_buffer_();
+    }
+    buffered_ = mode == console_buffering::always || (mode == console_buffering::automatic && !details::os::in_terminal(target_file_));
+    max_buffer_size_ = max_size;
+    if (buffered_ && interval > std::chrono::milliseconds::zero())
+    {
+        // the shared timer thread only posts the write, done by the sink's own thread: the console may block
+        flusher_ = details::make_unique<details::background_worker>();
+        flush_timer_ = details::make_unique<details::periodic_worker>(
+            [this] {
+                if (flush_posted_.exchange(true))
+                {
+                    return; // the previous one is still pending
+                }
+                flusher_->post([this] {
+                    flush_posted_ = false;
+                    std::lock_guard<std::mutex> buffer_lock(buffer_mutex_);
+                    flush_buffer_();
+                });
+            },
+            interval);
+    }
+}
+
+template<typename ConsoleMutex>
+SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::write_out_(string_view_t data)
+{
+    fwrite(data.data(), sizeof(char), data.size(), target_file_);
+    fflush(target_file_);
+}
+
+template<typename ConsoleMutex>
+SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::flush_buffer_()
+{
+    if (buffer_.size() > 0)
+    {
+        write_out_(details::fmt_helper::to_string_view(buffer_));
+        buffer_.clear();
+    }
 }
 
 template<typename ConsoleMutex>
@@ -3,9 +3,13 @@
 
 #pragma once
 
+#include <spdlog/details/background_worker.h>
 #include <spdlog/details/console_globals.h>
 #include <spdlog/details/null_mutex.h>
+#include <spdlog/details/periodic_worker.h>
 #include <spdlog/sinks/sink.h>
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -19,6 +23,8 @@ namespace sinks {
  * depending on the severity
  * of the message.
  * If no color terminal detected, omit the escape codes.
+ * Formatters supporting it (pattern_formatter) write the color codes straight into the formatted text,
+ * otherwise the sink splices them around the color range: either way the line is written with a single call.
  */
 
 template<typename ConsoleMutex>
@@ -27,7 +33,7 @@ class ansicolor_sink : public sink
 public:
     using mutex_t = typename ConsoleMutex::mutex_t;
     ansicolor_sink(FILE *target_file, color_mode mode);
-    ~ansicolor_sink() override = default;
+    ~ansicolor_sink() override;
 
     ansicolor_sink(const ansicolor_sink &other) = delete;
     ansicolor_sink(ansicolor_sink &&other) = delete;
@@ -39,7 +45,14 @@ public:
     void set_color_mode(color_mode mode);
     bool should_color();
 
+    // by default each message is written and flushed on its own. when buffered, the messages are written
+    // together once max_size bytes are pending, every interval, on flush() and on destruction.
+    void set_buffering(
+        console_buffering mode, size_t max_size = 64 * 1024, std::chrono::milliseconds interval = std::chrono::milliseconds(100));
+
     void log(const details::log_msg &msg) override;
+    void log_shared(const details::log_msg &msg, details::shared_format &shared) override;
+    void log_formatted(const details::log_msg &msg, string_view_t formatted) override;
     void flush() override;
     void set_pattern(const std::string &pattern) final;
     void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override;
@@ -85,8 +98,22 @@ private:
     bool should_do_colors_;
     std::unique_ptr<spdlog::formatter> formatter_;
     std::array<std::string, level::n_levels> colors_;
-    void print_ccode_(const string_view_t &color_code);
-    void print_range_(const memory_buf_t &formatted, size_t start, size_t end);
+    bool buffered_{false};
+    size_t max_buffer_size_{0};
+    // buffer_ is written by flusher_ too: locked whatever the console mutex (a null mutex for the _st sinks)
+    std::mutex buffer_mutex_;
+    memory_buf_t buffer_;
+    std::unique_ptr<details::background_worker> flusher_;
+    std::atomic<bool> flush_posted_{false};
+    std::unique_ptr<details::periodic_worker> flush_timer_; // last: stopped first
+    void format_and_print_(const details::log_msg &msg);
+    void print_formatted_(const details::log_msg &msg, string_view_t formatted);
+    void append_colored_(const details::log_msg &msg, string_view_t formatted, memory_buf_t &dest);
+    // hand the color codes to the formatter (if colors are on)
+    void update_formatter_colors_();
+    void write_out_(string_view_t data);
+    // called with buffer_mutex_ locked
+    void flush_buffer_();
     static std::string to_string_(const string_view_t &sv);
 };
 
@@ -110,6 +137,16 @@ using ansicolor_stdout_sink_st = ansicolor_stdout_sink<details::console_nullmute
 using ansicolor_stderr_sink_mt = ansicolor_stderr_sink<details::console_mutex>;
 using ansicolor_stderr_sink_st = ansicolor_stderr_sink<details::console_nullmutex>;
 
+#ifdef SPDLOG_COMPILED_LIB
+// instantiated in src/color_sinks.cpp
+extern template class SPDLOG_API ansicolor_sink<details::console_mutex>;
+extern template class SPDLOG_API ansicolor_sink<details::console_nullmutex>;
+extern template class SPDLOG_API ansicolor_stdout_sink<details::console_mutex>;
+extern template class SPDLOG_API ansicolor_stdout_sink<details::console_nullmutex>;
+extern template class SPDLOG_API ansicolor_stderr_sink<details::console_mutex>;
+extern template class SPDLOG_API ansicolor_stderr_sink<details::console_nullmutex>;
+#endif
+
 } // namespace sinks
 } // namespace spdlog
 
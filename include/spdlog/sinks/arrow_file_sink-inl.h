@@ -0,0 +1,163 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/sinks/arrow_file_sink.h>
+#endif
+
+#include <spdlog/common.h>
+#include <spdlog/details/os.h>
+#include <spdlog/sinks/rotating_file_sink.h>
+
+#include <cerrno>
+#include <utility>
+
+namespace spdlog {
+namespace sinks {
+
+template<typename Mutex>
+SPDLOG_INLINE arrow_file_sink<Mutex>::arrow_file_sink(filename_t base_filename, size_t max_size, size_t max_files, size_t batch_rows)
+    : base_filename_(std::move(base_filename))
+    , max_size_(max_size)
+    , max_files_(max_files)
+    , batch_rows_(batch_rows > 0 ? batch_rows : 1)
+{
+    if (details::os::path_exists(base_filename_))
+    {
+        shift_files_();
+    }
+    writer_.open(base_filename_);
+}
+
+template<typename Mutex>
+SPDLOG_INLINE arrow_file_sink<Mutex>::~arrow_file_sink()
+{
+    SPDLOG_TRY
+    {
+        post_batch_();
+        worker_.post([this] { complete_file_(); });
+    }
+    SPDLOG_CATCH_STD
+}
+
+template<typename Mutex>
+SPDLOG_INLINE const filename_t &arrow_file_sink<Mutex>::filename() const
+{
+    return base_filename_;
+}
+
+template<typename Mutex>
+SPDLOG_INLINE void arrow_file_sink<Mutex>::sink_it_(const details::log_msg &msg)
+{
+    columns_.append(msg, logger_index_(msg.logger_name));
+    if (columns_.size() >= batch_rows_)
+    {
+        post_batch_();
+    }
+}
+
+template<typename Mutex>
+SPDLOG_INLINE void arrow_file_sink<Mutex>::flush_()
+{
+    post_batch_();
+    worker_.post([this] { writer_.flush(); });
+    auto error = worker_.take_error();
+    if (!error.empty())
+    {
+        throw_spdlog_ex(error);
+    }
+}
+
+template<typename Mutex>
+SPDLOG_INLINE int32_t arrow_file_sink<Mutex>::logger_index_(string_view_t logger_name)
+{
+    if (last_logger_index_ >= 0 && string_view_t(last_logger_name_) == logger_name)
+    {
+        return last_logger_index_;
+    }
+    std::lock_guard<std::mutex> lock(logger_names_mutex_);
+    size_t index = 0;
+    while (index < logger_names_.size() && string_view_t(logger_names_[index]) != logger_name)
+    {
+        index++;
+    }
+    if (index == logger_names_.size())
+    {
+        logger_names_.emplace_back(logger_name.data(), logger_name.size());
+    }
+    last_logger_name_ = logger_names_[index];
+    last_logger_index_ = static_cast<int32_t>(index);
+    return last_logger_index_;
+}
+
+template<typename Mutex>
+SPDLOG_INLINE void arrow_file_sink<Mutex>::post_batch_()
+{
+    if (columns_.size() == 0)
+    {
+        return;
+    }
+    auto batch = std::make_shared<details::arrow_ipc::log_columns>(std::move(columns_));
+    columns_ = details::arrow_ipc::log_columns();
+    worker_.post([this, batch] { write_batch_(*batch); });
+}
+
+template<typename Mutex>
+SPDLOG_INLINE void arrow_file_sink<Mutex>::write_batch_(const details::arrow_ipc::log_columns &columns)
+{
+    if (!writer_.is_open())
+    {
+        // a previous rotation failed
+        writer_.open(base_filename_);
+    }
+    writer_.write_batch(columns);
+    if (writer_.size() >= max_size_)
+    {
+        complete_file_();
+        shift_files_();
+        writer_.open(base_filename_);
+    }
+}
+
+template<typename Mutex>
+SPDLOG_INLINE void arrow_file_sink<Mutex>::complete_file_()
+{
+    std::vector<std::string> logger_names;
+    {
+        std::lock_guard<std::mutex> lock(logger_names_mutex_);
+        logger_names = logger_names_;
+    }
+    writer_.close(logger_names);
+}
+
+template<typename Mutex>
+SPDLOG_INLINE void arrow_file_sink<Mutex>::shift_files_()
+{
+    using details::os::filename_to_str;
+    using details::os::path_exists;
+    using rotating_sink = rotating_file_sink<details::null_mutex>;
+    if (max_files_ == 0)
+    {
+        (void)details::os::remove(base_filename_);
+        return;
+    }
+    for (auto i = max_files_; i > 0; --i)
+    {
+        auto src = rotating_sink::calc_filename(base_filename_, i - 1);
+        if (!path_exists(src))
+        {
+            continue;
+        }
+        auto target = rotating_sink::calc_filename(base_filename_, i);
+        (void)details::os::remove(target);
+        if (details::os::rename(src, target) != 0)
+        {
+            throw_spdlog_ex("arrow_file_sink: failed renaming " + filename_to_str(src) + " to " + filename_to_str(target), errno);
+        }
+    }
+}
+
+} // namespace sinks
+} // namespace spdlog
@@ -0,0 +1,102 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <spdlog/details/arrow_ipc.h>
+#include <spdlog/details/background_worker.h>
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/sinks/base_sink.h>
+#include <spdlog/details/synchronous_factory.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace spdlog {
+namespace sinks {
+/*
+ * File sink writing the messages in columns, as Arrow IPC files (see details/arrow_ipc.h), to be loaded by
+ * analytics tools (pyarrow, DuckDB, Spark..). The formatter of the sink is not used.
+ *
+ * The logging threads only append the fields of the messages to the columns of the current batch. Full batches
+ * (batch_rows messages) are written by a background thread, as are the partial ones on flush.
+ * The files rotate by size as with rotating_file_sink: once the current one is over max_size bytes, it is
+ * completed (an Arrow file is readable once its footer is written) and renamed log.1.arrow, log.1.arrow to
+ * log.2.arrow.. up to max_files. An existing log.arrow is rotated on open - Arrow files can't be appended to.
+ * The logger dictionary of each file holds the names of all the loggers seen by the sink so far.
+ * The errors of the background thread are reported on the next flush.
+ */
+template<typename Mutex>
+class arrow_file_sink final : public base_sink<Mutex>
+{
+public:
+    arrow_file_sink(filename_t base_filename, size_t max_size, size_t max_files, size_t batch_rows = 16 * 1024);
+    // write the messages left and complete the current file
+    ~arrow_file_sink() override;
+    const filename_t &filename() const;
+
+protected:
+    void sink_it_(const details::log_msg &msg) override;
+    void flush_() override;
+
+private:
+    filename_t base_filename_;
+    size_t max_size_;
+    size_t max_files_;
+    size_t batch_rows_;
+    details::arrow_ipc::log_columns columns_;
+    std::string last_logger_name_;
+    int32_t last_logger_index_{-1};
+    std::mutex logger_names_mutex_;
+    std::vector<std::string> logger_names_; // index in the logger dictionary
+    // used by the background thread (or the constructor) only
+    details::arrow_ipc::file_writer writer_;
+    // last - runs the writes left before the members they use are destroyed
+    details::background_worker worker_;
+
+    int32_t logger_index_(string_view_t logger_name);
+    // hand the current batch to the background thread
+    void post_batch_();
+    void write_batch_(const details::arrow_ipc::log_columns &columns);
+    void complete_file_();
+    // log.arrow -> log.1.arrow, log.1.arrow -> log.2.arrow.. up to max_files. throw on failure.
+    void shift_files_();
+};
+
+using arrow_file_sink_mt = arrow_file_sink<std::mutex>;
+using arrow_file_sink_st = arrow_file_sink<details::null_mutex>;
+
+#ifdef SPDLOG_COMPILED_LIB
+// instantiated in src/file_sinks.cpp
+extern template class SPDLOG_API arrow_file_sink<std::mutex>;
+extern template class SPDLOG_API arrow_file_sink<details::null_mutex>;
+extern template class SPDLOG_API arrow_file_sink<details::spin_mutex>;
+extern template class SPDLOG_API arrow_file_sink<details::adaptive_mutex>;
+#endif
+
+} // namespace sinks
+
+//
+// factory functions
+//
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> arrow_logger_mt(
+    const std::string &logger_name, const filename_t &filename, size_t max_size, size_t max_files, size_t batch_rows = 16 * 1024)
+{
+    return Factory::template create<sinks::arrow_file_sink_mt>(logger_name, filename, max_size, max_files, batch_rows);
+}
+
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> arrow_logger_st(
+    const std::string &logger_name, const filename_t &filename, size_t max_size, size_t max_files, size_t batch_rows = 16 * 1024)
+{
+    return Factory::template create<sinks::arrow_file_sink_st>(logger_name, filename, max_size, max_files, batch_rows);
+}
+
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "arrow_file_sink-inl.h"
+#endif
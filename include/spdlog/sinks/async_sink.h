@@ -0,0 +1,245 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include "sink.h"
+#include <spdlog/async_logger.h>
+#include <spdlog/details/log_msg_buffer.h>
+#include <spdlog/details/mpmc_blocking_q.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Asynchronous sink decorator.
+// Gives the wrapped sink its own bounded queue and worker thread, so that a slow sink (e.g. a tcp_sink) doesn't
+// delay the other sinks of its logger - which may then be a regular (synchronous) logger. The overflow policy
+// applies to this sink only. Messages below the level of the wrapped sink are not queued.
+//
+// The errors of the wrapped sink are kept (the first one) and thrown by the next log() or flush() call, to be
+// reported by the logger's error handler. flush() doesn't wait: the worker flushes the wrapped sink once it
+// logged the messages queued before. The destructor logs the messages left and joins the worker.
+//
+// Example:
+//
+//     #include <spdlog/sinks/async_sink.h>
+//
+//     int main() {
+//         auto tcp = std::make_shared<spdlog::sinks::async_sink>(std::make_shared<tcp_sink_mt>(config), 8192,
+//             async_overflow_policy::overrun_oldest);
+//         spdlog::logger l("logger", {std::make_shared<basic_file_sink_mt>("log.txt"), tcp});
+//         l.info("Hello");
+//     }
+
+namespace spdlog {
+namespace sinks {
+
+class async_sink final : public sink
+{
+public:
+    explicit async_sink(sink_ptr wrapped_sink, size_t queue_size = 8192, async_overflow_policy overflow_policy = async_overflow_policy::block)
+        : sink_(std::move(wrapped_sink))
+        , overflow_policy_(overflow_policy)
+        , q_(queue_size)
+    {
+        worker_ = std::thread([this] { worker_loop_(); });
+    }
+
+    async_sink(const async_sink &) = delete;
+    async_sink &operator=(const async_sink &) = delete;
+
+    ~async_sink() override
+    {
+        q_.enqueue(item{item_type::terminate, details::log_msg_buffer{}});
+        worker_.join();
+    }
+
+    void log(const details::log_msg &msg) override
+    {
+        rethrow_error_();
+        if (!sink_->should_log(msg.level))
+        {
+            return;
+        }
+        post_(item{item_type::log, details::log_msg_buffer{msg}}, overflow_policy_);
+    }
+
+    void flush() override
+    {
+        rethrow_error_();
+        post_(item{item_type::flush, details::log_msg_buffer{}}, async_overflow_policy::block);
+    }
+
+    void set_pattern(const std::string &pattern) override
+    {
+        sink_->set_pattern(pattern);
+    }
+
+    void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override
+    {
+        sink_->set_formatter(std::move(sink_formatter));
+    }
+
+    unsigned required_fields() const override
+    {
+        return sink_->required_fields();
+    }
+
+    // max time to wait for room in the queue with the block_for overflow policy (default: 50us)
+    void set_block_timeout(std::chrono::nanoseconds timeout)
+    {
+        block_timeout_ = timeout;
+    }
+
+    const sink_ptr &wrapped_sink() const
+    {
+        return sink_;
+    }
+
+    // messages overrun by the overrun_oldest policy
+    size_t overrun_counter()
+    {
+        return q_.overrun_counter();
+    }
+
+    // messages discarded by the discard_new/block_for policies
+    size_t discarded_counter() const
+    {
+        return discarded_.load(std::memory_order_relaxed);
+    }
+
+private:
+    enum class item_type
+    {
+        log,
+        flush,
+        terminate
+    };
+
+    struct item
+    {
+        item() = default;
+        item(item_type the_type, details::log_msg_buffer &&the_msg)
+            : type{the_type}
+            , msg{std::move(the_msg)}
+        {}
+
+        item_type type{item_type::log};
+        details::log_msg_buffer msg;
+    };
+
+    sink_ptr sink_;
+    async_overflow_policy overflow_policy_;
+    std::chrono::nanoseconds block_timeout_{std::chrono::microseconds(50)};
+    details::mpmc_blocking_queue<item> q_;
+    std::atomic<size_t> discarded_{0};
+    // set while error_ is not empty - the log calls don't take the mutex otherwise
+    std::atomic<bool> failed_{false};
+    std::mutex error_mutex_;
+    std::string error_;
+    std::thread worker_;
+
+    void post_(item &&new_item, async_overflow_policy overflow_policy)
+    {
+        switch (overflow_policy)
+        {
+        case async_overflow_policy::overrun_oldest:
+            q_.enqueue_nowait(std::move(new_item));
+            break;
+        case async_overflow_policy::discard_new:
+            if (!q_.try_enqueue(std::move(new_item)))
+            {
+                discarded_.fetch_add(1, std::memory_order_relaxed);
+            }
+            break;
+        case async_overflow_policy::block_for:
+            if (!q_.try_enqueue(std::move(new_item)) && !q_.enqueue_for(std::move(new_item), block_timeout_))
+            {
+                discarded_.fetch_add(1, std::memory_order_relaxed);
+            }
+            break;
+        default:
+            q_.enqueue(std::move(new_item));
+            break;
+        }
+    }
+
+    void worker_loop_()
+    {
+        item incoming;
+        for (;;)
+        {
+            if (!q_.dequeue_for(incoming, std::chrono::seconds(10)))
+            {
+                continue;
+            }
+            if (incoming.type == item_type::terminate)
+            {
+                return;
+            }
+#ifdef SPDLOG_NO_EXCEPTIONS
+            process_(incoming);
+#else
+            try
+            {
+                process_(incoming);
+            }
+            catch (const std::exception &ex)
+            {
+                keep_error_(ex.what());
+            }
+            catch (...)
+            {
+                keep_error_("Unknown exception in async_sink");
+            }
+#endif
+        }
+    }
+
+    void process_(const item &incoming)
+    {
+        if (incoming.type == item_type::log)
+        {
+            sink_->log(incoming.msg);
+        }
+        else
+        {
+            sink_->flush();
+        }
+    }
+
+    void keep_error_(const char *error)
+    {
+        std::lock_guard<std::mutex> lock(error_mutex_);
+        if (error_.empty())
+        {
+            error_ = error;
+            failed_.store(true, std::memory_order_release);
+        }
+    }
+
+    void rethrow_error_()
+    {
+        if (!failed_.load(std::memory_order_acquire))
+        {
+            return;
+        }
+        std::string error;
+        {
+            std::lock_guard<std::mutex> lock(error_mutex_);
+            error.swap(error_);
+            failed_.store(false, std::memory_order_relaxed);
+        }
+        if (!error.empty())
+        {
+            throw_spdlog_ex(error);
+        }
+    }
+};
+
+} // namespace sinks
+} // namespace spdlog
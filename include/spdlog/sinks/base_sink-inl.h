@@ -8,6 +8,10 @@
 #endif
 
 #include <spdlog/common.h>
+#include <spdlog/details/fmt_helper.h>
+#include <spdlog/details/formatter_clones.h>
+#include <spdlog/details/scoped_buffer.h>
+#include <spdlog/details/usdt.h>
 #include <spdlog/pattern_formatter.h>
 
 #include <memory>
@@ -15,25 +19,129 @@
 template<typename Mutex>
 SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::base_sink()
     : formatter_{details::make_unique<spdlog::pattern_formatter>()}
+    , formatter_fields_{formatter_->required_fields()}
+    , formatter_generation_{details::formatter_clones::new_generation()}
 {}
 
 template<typename Mutex>
 SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::base_sink(std::unique_ptr<spdlog::formatter> formatter)
     : formatter_{std::move(formatter)}
+    , formatter_fields_{formatter_ ? formatter_->required_fields() : details::msg_fields::all}
+    , formatter_generation_{details::formatter_clones::new_generation()}
 {}
 
 template<typename Mutex>
 void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::log(const details::log_msg &msg)
 {
+    SPDLOG_USDT_SINK_LOG_SCOPE(this, 1);
+    if (parallel_format_.load(std::memory_order_relaxed) && accepts_formatted_())
+    {
+        auto *formatter = thread_formatter_();
+        if (formatter != nullptr)
+        {
+            details::scoped_buffer formatted_buffer;
+            auto &formatted = formatted_buffer.get();
+            format_with_(*formatter, msg, formatted);
+            std::lock_guard<Mutex> lock(mutex_);
+            details::profile_timer timer;
+            sink_formatted_(msg, details::fmt_helper::to_string_view(formatted));
+            profile_.on_sunk(1, timer);
+            return;
+        }
+    }
     std::lock_guard<Mutex> lock(mutex_); // 为什么需要在这里加锁？？？因为 sink_it_ 内部会对 msg 进行更改
+    details::profile_timer timer;
     sink_it_(msg);
+    profile_.on_sunk(1, timer);
 }
 
 template<typename Mutex>
-void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::flush()
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::log_batch(const details::log_msg *msgs, size_t n_msgs)
+{
+    SPDLOG_USDT_SINK_LOG_SCOPE(this, n_msgs);
+    std::lock_guard<Mutex> lock(mutex_);
+    details::profile_timer timer;
+    sink_batch_(msgs, n_msgs);
+    profile_.on_sunk_batch(msgs, n_msgs, level(), timer);
+}
+
+template<typename Mutex>
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::log_shared(const details::log_msg &msg, details::shared_format &shared)
+{
+    SPDLOG_USDT_SINK_LOG_SCOPE(this, 1);
+    if (parallel_format_.load(std::memory_order_relaxed) && accepts_formatted_())
+    {
+        auto *formatter = thread_formatter_();
+        if (formatter != nullptr && formatter->format_id() != 0)
+        {
+            auto &formatted = shared.format(*formatter, formatter->format_id(), msg, profile_);
+            std::lock_guard<Mutex> lock(mutex_);
+            details::profile_timer timer;
+            sink_formatted_(msg, details::fmt_helper::to_string_view(formatted));
+            profile_.on_sunk(1, timer);
+            return;
+        }
+    }
+    std::lock_guard<Mutex> lock(mutex_);
+    details::profile_timer timer;
+    auto format_id = formatter_->format_id();
+    if (format_id == 0 || !accepts_formatted_())
+    {
+        sink_it_(msg);
+    }
+    else
+    {
+        sink_formatted_(msg, details::fmt_helper::to_string_view(shared.format(*formatter_, format_id, msg, profile_)));
+    }
+    profile_.on_sunk(1, timer);
+}
+
+template<typename Mutex>
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::log_formatted(const details::log_msg &msg, string_view_t formatted)
 {
+    SPDLOG_USDT_SINK_LOG_SCOPE(this, 1);
     std::lock_guard<Mutex> lock(mutex_);
-    flush_();
+    details::profile_timer timer;
+    if (!accepts_formatted_())
+    {
+        sink_it_(msg);
+    }
+    else
+    {
+        sink_formatted_(msg, formatted);
+    }
+    profile_.on_sunk(1, timer);
+}
+
+template<typename Mutex>
+bool SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::format_ahead(const details::log_msg &msg, memory_buf_t &dest)
+{
+    if (!accepts_formatted_())
+    {
+        return false;
+    }
+    auto *formatter = thread_formatter_();
+    if (formatter == nullptr)
+    {
+        return false;
+    }
+    msg.color_range_start = 0;
+    msg.color_range_end = 0;
+    format_with_(*formatter, msg, dest);
+    return true;
+}
+
+template<typename Mutex>
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::flush()
+{
+    SPDLOG_USDT_SINK_FLUSH_SCOPE(this);
+    {
+        std::lock_guard<Mutex> lock(mutex_);
+        details::profile_timer timer;
+        flush_();
+        profile_.on_flushed(timer);
+    }
+    after_flush_();
 }
 
 template<typename Mutex>
@@ -41,6 +149,7 @@ void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::set_pattern(const std::strin
 {
     std::lock_guard<Mutex> lock(mutex_);
     set_pattern_(pattern);
+    on_formatter_changed_();
 }
 
 template<typename Mutex>
@@ -48,8 +157,66 @@ void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::set_formatter(std::unique_pt
 {
     std::lock_guard<Mutex> lock(mutex_);
     set_formatter_(std::move(sink_formatter));
+    on_formatter_changed_();
+}
+
+template<typename Mutex>
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::set_parallel_format(bool parallel)
+{
+    parallel_format_.store(parallel, std::memory_order_relaxed);
+}
+
+template<typename Mutex>
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::sink_batch_(const details::log_msg *msgs, size_t n_msgs)
+{
+    for (size_t i = 0; i < n_msgs; i++)
+    {
+        if (this->should_log(msgs[i].level))
+        {
+            sink_it_(msgs[i]);
+        }
+    }
 }
 
+template<typename Mutex>
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::format_(const details::log_msg &msg, memory_buf_t &dest)
+{
+    format_with_(*formatter_, msg, dest);
+}
+
+template<typename Mutex>
+bool SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::format_split_(const details::log_msg &msg, memory_buf_t &dest, size_t &payload_pos)
+{
+    if (msg.payload.size() < split_payload_size)
+    {
+        return false;
+    }
+    details::profile_timer timer;
+    auto old_size = dest.size();
+    if (!formatter_->format_split(msg, dest, payload_pos))
+    {
+        return false;
+    }
+    profile_.on_formatted(dest.size() - old_size + msg.payload.size(), timer);
+    return true;
+}
+
+template<typename Mutex>
+bool SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::accepts_formatted_() const
+{
+    return false;
+}
+
+template<typename Mutex>
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::sink_formatted_(const details::log_msg &msg, string_view_t)
+{
+    sink_it_(msg);
+}
+
+template<typename Mutex>
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::after_flush_()
+{}
+
 template<typename Mutex>
 void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::set_pattern_(const std::string &pattern)
 {
@@ -61,3 +228,33 @@ void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::set_formatter_(std::unique_p
 {
     formatter_ = std::move(sink_formatter);
 }
+
+template<typename Mutex>
+SPDLOG_INLINE spdlog::formatter *spdlog::sinks::base_sink<Mutex>::thread_formatter_()
+{
+    auto generation = formatter_generation_.load(std::memory_order_acquire);
+    auto *formatter = details::formatter_clones::find(this, generation);
+    if (formatter != nullptr)
+    {
+        return formatter;
+    }
+    std::unique_ptr<spdlog::formatter> clone;
+    {
+        std::lock_guard<Mutex> lock(mutex_);
+        if (!formatter_)
+        {
+            return nullptr;
+        }
+        clone = formatter_->clone();
+        generation = formatter_generation_.load(std::memory_order_relaxed);
+    }
+    return details::formatter_clones::add(this, generation, std::move(clone));
+}
+
+// under the lock
+template<typename Mutex>
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::on_formatter_changed_()
+{
+    formatter_fields_.store(formatter_ ? formatter_->required_fields() : details::msg_fields::all, std::memory_order_relaxed);
+    formatter_generation_.store(details::formatter_clones::new_generation(), std::memory_order_release);
+}
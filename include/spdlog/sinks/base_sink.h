@@ -7,12 +7,20 @@
 // concrete implementation should override the sink_it_() and flush_()  methods.
 // locking is taken care of in this class - no locking needed by the
 // implementers..
+// implementers can also override sink_batch_() to handle a whole batch of
+// messages at once (e.g. with a single write).
+// with set_parallel_format(), the sinks taking the formatted text (accepts_formatted_()) get
+// the messages formatted before the lock, by a clone of the formatter per thread.
 //
 
 #include <spdlog/common.h>
 #include <spdlog/details/log_msg.h>
+#include <spdlog/details/spin_mutex.h>
 #include <spdlog/sinks/sink.h>
 
+#include <atomic>
+#include <mutex>
+
 namespace spdlog {
 namespace sinks {
 template<typename Mutex>
@@ -30,20 +38,66 @@ public:
     base_sink &operator=(base_sink &&) = delete;
 
     void log(const details::log_msg &msg) final;
+    void log_batch(const details::log_msg *msgs, size_t n_msgs) final;
+    void log_shared(const details::log_msg &msg, details::shared_format &shared) final;
+    void log_formatted(const details::log_msg &msg, string_view_t formatted) final;
+    // for the sinks writing the formatted text as is
+    bool format_ahead(const details::log_msg &msg, memory_buf_t &dest) final;
     void flush() final;
     void set_pattern(const std::string &pattern) final;
     void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) final;
+    // format the messages before taking the lock, with a clone of the formatter per thread (see
+    // details/formatter_clones.h), so that the threads logging concurrently only serialize the write.
+    // for the sinks writing the formatted text as is - the others still format under the lock. off by default.
+    void set_parallel_format(bool parallel);
 
 protected:
     // sink formatter
     std::unique_ptr<spdlog::formatter> formatter_;
     mutable Mutex mutex_;
+    // formatter_->required_fields(), for the required_fields() of the sinks reading nothing else
+    std::atomic<unsigned> formatter_fields_;
+    std::atomic<bool> parallel_format_{false};
+    // new at each change of the formatter: the clones of the previous ones are not reused
+    std::atomic<uint64_t> formatter_generation_;
 
     virtual void sink_it_(const details::log_msg &msg) = 0;
+    // format msg into dest with the sink formatter (counted in the profile counters)
+    void format_(const details::log_msg &msg, memory_buf_t &dest);
+    // payloads from this size are written from the message by the sinks with scatter-gather writes (see format_split_())
+    static constexpr size_t split_payload_size = 4 * 1024;
+    // format msg without its payload (see formatter::format_split()) if it is from split_payload_size and the
+    // formatter supports it: the text is dest[0, payload_pos), msg.payload, dest[payload_pos, dest.size()).
+    // return false otherwise, dest unchanged.
+    bool format_split_(const details::log_msg &msg, memory_buf_t &dest, size_t &payload_pos);
+    // called under the lock with the whole batch. must skip messages below the sink level.
+    virtual void sink_batch_(const details::log_msg *msgs, size_t n_msgs);
+    // sinks writing the formatted text as is can take it already formatted (by another sink
+    // of the logger with an equivalent formatter, or upstream - see log_formatted()): they return
+    // true from accepts_formatted_() and implement sink_formatted_(), typically called by their sink_it_() too.
+    virtual bool accepts_formatted_() const;
+    virtual void sink_formatted_(const details::log_msg &msg, string_view_t formatted);
     virtual void flush_() = 0;
+    // called by flush() after flush_(), without the lock: e.g. to wait for the data flushed to be on disk
+    // together with the other threads flushing (see file_durability::group_commit)
+    virtual void after_flush_();
     virtual void set_pattern_(const std::string &pattern);
     virtual void set_formatter_(std::unique_ptr<spdlog::formatter> sink_formatter);
+
+private:
+    // the clone of the formatter for the calling thread, nullptr to format under the lock
+    spdlog::formatter *thread_formatter_();
+    void on_formatter_changed_();
 };
+
+#ifdef SPDLOG_COMPILED_LIB
+// instantiated in src/spdlog.cpp
+extern template class SPDLOG_API base_sink<std::mutex>;
+extern template class SPDLOG_API base_sink<details::null_mutex>;
+extern template class SPDLOG_API base_sink<details::spin_mutex>;
+extern template class SPDLOG_API base_sink<details::adaptive_mutex>;
+#endif
+
 } // namespace sinks
 } // namespace spdlog
 
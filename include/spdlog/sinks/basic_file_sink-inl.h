@@ -9,12 +9,16 @@
 
 #include <spdlog/common.h>
 #include <spdlog/details/os.h>
+#include <spdlog/details/fmt_helper.h>
+#include <spdlog/details/scoped_buffer.h>
 
 namespace spdlog {
 namespace sinks {
 
 template<typename Mutex>
-SPDLOG_INLINE basic_file_sink<Mutex>::basic_file_sink(const filename_t &filename, bool truncate)
+SPDLOG_INLINE basic_file_sink<Mutex>::basic_file_sink(
+    const filename_t &filename, bool truncate, size_t write_buffer_size, bool drop_page_cache)
+    : file_helper_(write_buffer_size, drop_page_cache)
 {
     file_helper_.open(filename, truncate);
 }
@@ -30,8 +34,60 @@ SPDLOG_INLINE void basic_file_sink<Mutex>::sink_it_(const details::log_msg &msg)
 {
     // 不可以在 write 接口里面进行加锁：因为在这里将 message 进行了格式化
     // 为什么这里不需要加锁：因为在外层的 base_sink 的接口中已经进行了加锁
-    memory_buf_t formatted;
-    base_sink<Mutex>::formatter_->format(msg, formatted);
+    details::scoped_buffer formatted_buffer;
+    auto &formatted = formatted_buffer.get();
+    size_t payload_pos;
+    if (base_sink<Mutex>::format_split_(msg, formatted, payload_pos))
+    {
+        // the large payload is written from the message, not copied into formatted
+        string_view_t parts[] = {string_view_t(formatted.data(), payload_pos), msg.payload,
+            string_view_t(formatted.data() + payload_pos, formatted.size() - payload_pos)};
+        file_helper_.write(parts, 3);
+        return;
+    }
+    base_sink<Mutex>::format_(msg, formatted);
+    sink_formatted_(msg, details::fmt_helper::to_string_view(formatted));
+}
+
+template<typename Mutex>
+SPDLOG_INLINE void basic_file_sink<Mutex>::set_durability(file_durability durability, std::chrono::milliseconds group_commit_interval)
+{
+    std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+    syncer_ = durability == file_durability::group_commit ? std::make_shared<details::file_syncer>(group_commit_interval) : nullptr;
+    file_helper_.set_durability(durability, syncer_);
+}
+
+template<typename Mutex>
+SPDLOG_INLINE unsigned basic_file_sink<Mutex>::required_fields() const
+{
+    return this->formatter_fields_.load(std::memory_order_relaxed);
+}
+
+template<typename Mutex>
+SPDLOG_INLINE bool basic_file_sink<Mutex>::accepts_formatted_() const
+{
+    return true;
+}
+
+template<typename Mutex>
+SPDLOG_INLINE void basic_file_sink<Mutex>::sink_formatted_(const details::log_msg &, string_view_t formatted)
+{
+    file_helper_.write(formatted);
+}
+
+// format the whole batch into one buffer and write it at once
+template<typename Mutex>
+SPDLOG_INLINE void basic_file_sink<Mutex>::sink_batch_(const details::log_msg *msgs, size_t n_msgs)
+{
+    details::scoped_buffer formatted_buffer;
+    auto &formatted = formatted_buffer.get();
+    for (size_t i = 0; i < n_msgs; i++)
+    {
+        if (this->should_log(msgs[i].level))
+        {
+            base_sink<Mutex>::format_(msgs[i], formatted);
+        }
+    }
     file_helper_.write(formatted);
 }
 
@@ -41,5 +97,14 @@ SPDLOG_INLINE void basic_file_sink<Mutex>::flush_()
     file_helper_.flush();
 }
 
+template<typename Mutex>
+SPDLOG_INLINE void basic_file_sink<Mutex>::after_flush_()
+{
+    if (syncer_)
+    {
+        syncer_->wait();
+    }
+}
+
 } // namespace sinks
 } // namespace spdlog
@@ -4,35 +4,60 @@
 #pragma once
 
 #include <spdlog/details/file_helper.h>
+#include <spdlog/details/file_syncer.h>
 #include <spdlog/details/null_mutex.h>
 #include <spdlog/sinks/base_sink.h>
 #include <spdlog/details/synchronous_factory.h>
 
+#include <chrono>
+#include <memory>
 #include <mutex>
 #include <string>
 
 namespace spdlog {
 namespace sinks {
 /*
- * Trivial file sink with single file as target
+ * Trivial file sink with single file as target.
+ * With a write buffer size (e.g. 1MB), the messages are written to the file when the buffer
+ * fills up and on flush (see flush_on() and flush_every()) instead of one by one.
+ * With drop_page_cache, the file is kept out of the page cache (see details/file_helper.h).
  */
 template<typename Mutex>
 class basic_file_sink final : public base_sink<Mutex>
 {
 public:
-    explicit basic_file_sink(const filename_t &filename, bool truncate = false);
+    explicit basic_file_sink(const filename_t &filename, bool truncate = false, size_t write_buffer_size = 0, bool drop_page_cache = false);
     const filename_t &filename() const;
+    // what flush() guarantees (see file_durability) - set it before logging. with group_commit, the concurrent
+    // flushes wait for one sync of the file per group_commit_interval.
+    void set_durability(file_durability durability, std::chrono::milliseconds group_commit_interval = std::chrono::milliseconds(10));
+    // the fields read by the formatter
+    unsigned required_fields() const override;
 
 protected:
     void sink_it_(const details::log_msg &msg) override;
+    void sink_batch_(const details::log_msg *msgs, size_t n_msgs) override;
+    bool accepts_formatted_() const override;
+    void sink_formatted_(const details::log_msg &msg, string_view_t formatted) override;
     void flush_() override;
+    void after_flush_() override;
 
 private:
     details::file_helper file_helper_;
+    std::shared_ptr<details::file_syncer> syncer_;
 };
 
 using basic_file_sink_mt = basic_file_sink<std::mutex>;
 using basic_file_sink_st = basic_file_sink<details::null_mutex>;
+using basic_file_sink_spin = basic_file_sink<details::spin_mutex>;
+
+#ifdef SPDLOG_COMPILED_LIB
+// instantiated in src/file_sinks.cpp
+extern template class SPDLOG_API basic_file_sink<std::mutex>;
+extern template class SPDLOG_API basic_file_sink<details::null_mutex>;
+extern template class SPDLOG_API basic_file_sink<details::spin_mutex>;
+extern template class SPDLOG_API basic_file_sink<details::adaptive_mutex>;
+#endif
 
 } // namespace sinks
 
@@ -40,15 +65,17 @@ using basic_file_sink_st = basic_file_sink<details::null_mutex>;
 // factory functions
 //
 template<typename Factory = spdlog::synchronous_factory>
-inline std::shared_ptr<logger> basic_logger_mt(const std::string &logger_name, const filename_t &filename, bool truncate = false)
+inline std::shared_ptr<logger> basic_logger_mt(const std::string &logger_name, const filename_t &filename, bool truncate = false,
+    size_t write_buffer_size = 0, bool drop_page_cache = false)
 {
-    return Factory::template create<sinks::basic_file_sink_mt>(logger_name, filename, truncate);
+    return Factory::template create<sinks::basic_file_sink_mt>(logger_name, filename, truncate, write_buffer_size, drop_page_cache);
 }
 
 template<typename Factory = spdlog::synchronous_factory>
-inline std::shared_ptr<logger> basic_logger_st(const std::string &logger_name, const filename_t &filename, bool truncate = false)
+inline std::shared_ptr<logger> basic_logger_st(const std::string &logger_name, const filename_t &filename, bool truncate = false,
+    size_t write_buffer_size = 0, bool drop_page_cache = false)
 {
-    return Factory::template create<sinks::basic_file_sink_st>(logger_name, filename, truncate);
+    return Factory::template create<sinks::basic_file_sink_st>(logger_name, filename, truncate, write_buffer_size, drop_page_cache);
 }
 
 } // namespace spdlog
@@ -0,0 +1,67 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/sinks/binary_file_sink.h>
+#endif
+
+#include <spdlog/common.h>
+#include <spdlog/details/scoped_buffer.h>
+
+namespace spdlog {
+namespace sinks {
+
+template<typename Mutex>
+SPDLOG_INLINE binary_file_sink<Mutex>::binary_file_sink(const filename_t &filename, bool truncate)
+{
+    file_helper_.open(filename, truncate);
+    memory_buf_t header;
+    if (file_helper_.size() == 0)
+    {
+        details::binary_log_writer::start_file(header);
+    }
+    writer_.start_session(header);
+    file_helper_.write(header);
+}
+
+template<typename Mutex>
+SPDLOG_INLINE const filename_t &binary_file_sink<Mutex>::filename() const
+{
+    return file_helper_.filename();
+}
+
+template<typename Mutex>
+SPDLOG_INLINE void binary_file_sink<Mutex>::sink_it_(const details::log_msg &msg)
+{
+    details::scoped_buffer encoded_buffer;
+    auto &encoded = encoded_buffer.get();
+    writer_.encode(msg, encoded);
+    file_helper_.write(encoded);
+}
+
+// encode the whole batch into one buffer and write it at once
+template<typename Mutex>
+SPDLOG_INLINE void binary_file_sink<Mutex>::sink_batch_(const details::log_msg *msgs, size_t n_msgs)
+{
+    details::scoped_buffer encoded_buffer;
+    auto &encoded = encoded_buffer.get();
+    for (size_t i = 0; i < n_msgs; i++)
+    {
+        if (this->should_log(msgs[i].level))
+        {
+            writer_.encode(msgs[i], encoded);
+        }
+    }
+    file_helper_.write(encoded);
+}
+
+template<typename Mutex>
+SPDLOG_INLINE void binary_file_sink<Mutex>::flush_()
+{
+    file_helper_.flush();
+}
+
+} // namespace sinks
+} // namespace spdlog
@@ -0,0 +1,72 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <spdlog/details/binary_log_writer.h>
+#include <spdlog/details/file_helper.h>
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/sinks/base_sink.h>
+#include <spdlog/details/synchronous_factory.h>
+
+#include <mutex>
+
+namespace spdlog {
+namespace sinks {
+/*
+ * File sink writing compact binary records instead of formatted text (see details/binary_log.h,
+ * encoded by details::binary_log_writer).
+ * Logger names, source locations, field keys and the text of constant (interned) messages
+ * are written once per file, key/value fields keep their types. The formatter of the sink is not used -
+ * the file is rendered later with any pattern by details::binary_log_reader (or spdlog-decode).
+ */
+template<typename Mutex>
+class binary_file_sink final : public base_sink<Mutex>
+{
+public:
+    explicit binary_file_sink(const filename_t &filename, bool truncate = false);
+    const filename_t &filename() const;
+
+protected:
+    void sink_it_(const details::log_msg &msg) override;
+    void sink_batch_(const details::log_msg *msgs, size_t n_msgs) override;
+    void flush_() override;
+
+private:
+    details::file_helper file_helper_;
+    details::binary_log_writer writer_;
+};
+
+using binary_file_sink_mt = binary_file_sink<std::mutex>;
+using binary_file_sink_st = binary_file_sink<details::null_mutex>;
+
+#ifdef SPDLOG_COMPILED_LIB
+// instantiated in src/file_sinks.cpp
+extern template class SPDLOG_API binary_file_sink<std::mutex>;
+extern template class SPDLOG_API binary_file_sink<details::null_mutex>;
+extern template class SPDLOG_API binary_file_sink<details::spin_mutex>;
+extern template class SPDLOG_API binary_file_sink<details::adaptive_mutex>;
+#endif
+
+} // namespace sinks
+
+//
+// factory functions
+//
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> binary_logger_mt(const std::string &logger_name, const filename_t &filename, bool truncate = false)
+{
+    return Factory::template create<sinks::binary_file_sink_mt>(logger_name, filename, truncate);
+}
+
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> binary_logger_st(const std::string &logger_name, const filename_t &filename, bool truncate = false)
+{
+    return Factory::template create<sinks::binary_file_sink_st>(logger_name, filename, truncate);
+}
+
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "binary_file_sink-inl.h"
+#endif
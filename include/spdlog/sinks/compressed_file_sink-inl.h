@@ -0,0 +1,86 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/sinks/compressed_file_sink.h>
+#endif
+
+#include <spdlog/common.h>
+#include <spdlog/details/fmt_helper.h>
+#include <spdlog/details/scoped_buffer.h>
+
+namespace spdlog {
+namespace sinks {
+
+template<typename Mutex>
+SPDLOG_INLINE compressed_file_sink<Mutex>::compressed_file_sink(
+    const filename_t &filename, bool truncate, size_t frame_size, size_t write_buffer_size)
+    : file_helper_(write_buffer_size)
+{
+    if (frame_size == 0)
+    {
+        throw_spdlog_ex("compressed_file_sink: frame size must be > 0");
+    }
+    file_helper_.set_compression(frame_size);
+    file_helper_.open(filename, truncate);
+}
+
+template<typename Mutex>
+SPDLOG_INLINE const filename_t &compressed_file_sink<Mutex>::filename() const
+{
+    return file_helper_.filename();
+}
+
+template<typename Mutex>
+SPDLOG_INLINE unsigned compressed_file_sink<Mutex>::required_fields() const
+{
+    return this->formatter_fields_.load(std::memory_order_relaxed);
+}
+
+template<typename Mutex>
+SPDLOG_INLINE void compressed_file_sink<Mutex>::sink_it_(const details::log_msg &msg)
+{
+    details::scoped_buffer formatted_buffer;
+    auto &formatted = formatted_buffer.get();
+    base_sink<Mutex>::format_(msg, formatted);
+    sink_formatted_(msg, details::fmt_helper::to_string_view(formatted));
+}
+
+// format the whole batch into one buffer and compress it at once
+template<typename Mutex>
+SPDLOG_INLINE void compressed_file_sink<Mutex>::sink_batch_(const details::log_msg *msgs, size_t n_msgs)
+{
+    details::scoped_buffer formatted_buffer;
+    auto &formatted = formatted_buffer.get();
+    for (size_t i = 0; i < n_msgs; i++)
+    {
+        if (this->should_log(msgs[i].level))
+        {
+            base_sink<Mutex>::format_(msgs[i], formatted);
+        }
+    }
+    file_helper_.write(formatted);
+}
+
+template<typename Mutex>
+SPDLOG_INLINE bool compressed_file_sink<Mutex>::accepts_formatted_() const
+{
+    return true;
+}
+
+template<typename Mutex>
+SPDLOG_INLINE void compressed_file_sink<Mutex>::sink_formatted_(const details::log_msg &, string_view_t formatted)
+{
+    file_helper_.write(formatted);
+}
+
+template<typename Mutex>
+SPDLOG_INLINE void compressed_file_sink<Mutex>::flush_()
+{
+    file_helper_.flush();
+}
+
+} // namespace sinks
+} // namespace spdlog
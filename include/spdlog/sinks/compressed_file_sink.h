@@ -0,0 +1,80 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <spdlog/details/file_helper.h>
+#include <spdlog/details/frame_compressor.h>
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/sinks/base_sink.h>
+#include <spdlog/details/synchronous_factory.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace spdlog {
+namespace sinks {
+/*
+ * File sink compressing the log as it is written (SPDLOG_ZLIB): the file is a sequence of gzip members of
+ * frame_size bytes of log each (see details/frame_compressor.h), readable by zcat while it is written - up to
+ * the last frame completed or flushed. frame_compressor::read_range() decompresses only the frames of a range.
+ * Each flush completes a frame: flushing often compresses less.
+ * The rotating, daily and hourly sinks compress their files the same way with set_compression().
+ */
+template<typename Mutex>
+class compressed_file_sink final : public base_sink<Mutex>
+{
+public:
+    explicit compressed_file_sink(const filename_t &filename, bool truncate = false,
+        size_t frame_size = details::frame_compressor::default_frame_size, size_t write_buffer_size = 0);
+    const filename_t &filename() const;
+    // the fields read by the formatter
+    unsigned required_fields() const override;
+
+protected:
+    void sink_it_(const details::log_msg &msg) override;
+    void sink_batch_(const details::log_msg *msgs, size_t n_msgs) override;
+    bool accepts_formatted_() const override;
+    void sink_formatted_(const details::log_msg &msg, string_view_t formatted) override;
+    void flush_() override;
+
+private:
+    details::file_helper file_helper_;
+};
+
+using compressed_file_sink_mt = compressed_file_sink<std::mutex>;
+using compressed_file_sink_st = compressed_file_sink<details::null_mutex>;
+
+#ifdef SPDLOG_COMPILED_LIB
+// instantiated in src/file_sinks.cpp
+extern template class SPDLOG_API compressed_file_sink<std::mutex>;
+extern template class SPDLOG_API compressed_file_sink<details::null_mutex>;
+extern template class SPDLOG_API compressed_file_sink<details::spin_mutex>;
+extern template class SPDLOG_API compressed_file_sink<details::adaptive_mutex>;
+#endif
+
+} // namespace sinks
+
+//
+// factory functions
+//
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> compressed_logger_mt(const std::string &logger_name, const filename_t &filename, bool truncate = false,
+    size_t frame_size = details::frame_compressor::default_frame_size, size_t write_buffer_size = 0)
+{
+    return Factory::template create<sinks::compressed_file_sink_mt>(logger_name, filename, truncate, frame_size, write_buffer_size);
+}
+
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> compressed_logger_st(const std::string &logger_name, const filename_t &filename, bool truncate = false,
+    size_t frame_size = details::frame_compressor::default_frame_size, size_t write_buffer_size = 0)
+{
+    return Factory::template create<sinks::compressed_file_sink_st>(logger_name, filename, truncate, frame_size, write_buffer_size);
+}
+
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "compressed_file_sink-inl.h"
+#endif
@@ -4,7 +4,13 @@
 #pragma once
 
 #include <spdlog/common.h>
+#include <spdlog/details/file_compression.h>
 #include <spdlog/details/file_helper.h>
+#include <spdlog/details/file_syncer.h>
+#include <spdlog/details/size_retention.h>
+#include <spdlog/details/frame_compressor.h>
+#include <spdlog/details/time_index.h>
+#include <spdlog/details/file_rotation_worker.h>
 #include <spdlog/details/null_mutex.h>
 #include <spdlog/fmt/fmt.h>
 #include <spdlog/fmt/chrono.h>
@@ -12,10 +18,13 @@
 #include <spdlog/details/os.h>
 #include <spdlog/details/circular_q.h>
 #include <spdlog/details/synchronous_factory.h>
+#include <spdlog/details/fmt_helper.h>
+#include <spdlog/details/scoped_buffer.h>
 
 #include <chrono>
 #include <cstdio>
 #include <ctime>
+#include <memory>
 #include <mutex>
 #include <string>
 
@@ -62,29 +71,49 @@ struct daily_filename_format_calculator
  * Rotating file sink based on date.
  * If truncate != false , the created file will be truncated.
  * If max_files > 0, retain only the last max_files and delete previous.
+ * With compress (SPDLOG_ZLIB), the previous files are gzipped (and deleted) by a background thread.
+ * With background_rotation, the file of the next period is created ahead of time by a background thread,
+ * and the previous files are closed and deleted by it: rotating only swaps the files (or, if it wasn't
+ * prepared, opens it in the background - see file_helper::open_in_background()).
  */
 template<typename Mutex, typename FileNameCalc = daily_filename_calculator>
 class daily_file_sink final : public base_sink<Mutex>
 {
 public:
     // create daily file sink which rotates on given time
-    daily_file_sink(filename_t base_filename, int rotation_hour, int rotation_minute, bool truncate = false, uint16_t max_files = 0)
+    daily_file_sink(filename_t base_filename, int rotation_hour, int rotation_minute, bool truncate = false, uint16_t max_files = 0,
+        size_t write_buffer_size = 0, bool drop_page_cache = false, bool compress = false, bool background_rotation = false)
         : base_filename_(std::move(base_filename))
         , rotation_h_(rotation_hour)
         , rotation_m_(rotation_minute)
+        , file_helper_(write_buffer_size, drop_page_cache)
         , truncate_(truncate)
         , max_files_(max_files)
         , filenames_q_()
+        , prepare_next_(background_rotation)
+        , compress_(compress)
     {
         if (rotation_hour < 0 || rotation_hour > 23 || rotation_minute < 0 || rotation_minute > 59)
         {
             throw_spdlog_ex("daily_file_sink: Invalid rotation time in ctor");
         }
+        if (compress)
+        {
+            if (!details::file_compression::supported())
+            {
+                throw_spdlog_ex("daily_file_sink: compression requires spdlog built with SPDLOG_ZLIB");
+            }
+        }
+        if (compress || background_rotation)
+        {
+            rotation_worker_ = details::make_unique<details::file_rotation_worker>(compress);
+        }
 
         auto now = log_clock::now();
         auto filename = FileNameCalc::calc_filename(base_filename_, now_tm(now));
         file_helper_.open(filename, truncate_);
-        rotation_tp_ = next_rotation_tp_();
+        rotation_tp_ = next_rotation_tp_(now);
+        prepare_next_file_(now);
 
         if (max_files_ > 0)
         {
@@ -98,19 +127,123 @@ public:
         return file_helper_.filename();
     }
 
+    // what flush() guarantees (see file_durability) - set it before logging. with group_commit, the concurrent
+    // flushes wait for one sync of the file per group_commit_interval.
+    void set_durability(file_durability durability, std::chrono::milliseconds group_commit_interval = std::chrono::milliseconds(10))
+    {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        durability_ = durability;
+        syncer_ = durability == file_durability::group_commit ? std::make_shared<details::file_syncer>(group_commit_interval) : nullptr;
+        file_helper_.set_durability(durability, syncer_);
+    }
+
+    // write a time index of the files (see details/time_index.h): an entry per interval and per bytes_interval
+    void enable_time_index(std::chrono::seconds interval, size_t bytes_interval = 1024 * 1024)
+    {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        time_index_ = details::make_unique<details::time_index>(interval, bytes_interval);
+        open_time_index_();
+    }
+
+    // compress the files as they are written, in independent frames of frame_size bytes (see
+    // details/frame_compressor.h), 0 to stop. exclusive with compress.
+    void set_compression(size_t frame_size = details::frame_compressor::default_frame_size)
+    {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        if (compress_ && frame_size > 0)
+        {
+            throw_spdlog_ex("daily_file_sink: the files are compressed on rotation already");
+        }
+        file_helper_.set_compression(frame_size);
+    }
+
+    // delete the oldest files once they total more than max_total_size bytes (on disk - compressed), besides
+    // max_files. the existing files are scanned now - back to the first period without a file - the sizes of
+    // the next ones are tracked.
+    void set_max_total_size(size_t max_total_size)
+    {
+        using details::os::path_exists;
+        using details::os::path_size;
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        auto retention = details::make_unique<details::size_retention>(max_total_size);
+        auto current = file_helper_.filename();
+        for (auto time = log_clock::now() - std::chrono::hours(24);; time -= std::chrono::hours(24))
+        {
+            auto filename = FileNameCalc::calc_filename(base_filename_, now_tm(time));
+            if (filename == current)
+            {
+                continue;
+            }
+            auto compressed = details::file_compression::compressed_filename(filename);
+            if (path_exists(compressed))
+            {
+                retention->add_oldest(path_size(compressed), compressed);
+            }
+            else if (path_exists(filename))
+            {
+                retention->add_oldest(path_size(filename), filename);
+            }
+            else
+            {
+                break;
+            }
+        }
+        if (rotation_worker_)
+        {
+            rotation_worker_->set_retention(std::move(retention));
+            return;
+        }
+        retention_ = std::move(retention);
+        retention_->remove_excess();
+    }
+
 protected:
     void sink_it_(const details::log_msg &msg) override
+    {
+        details::scoped_buffer formatted_buffer;
+        auto &formatted = formatted_buffer.get();
+        base_sink<Mutex>::format_(msg, formatted);
+        sink_formatted_(msg, details::fmt_helper::to_string_view(formatted));
+    }
+
+    bool accepts_formatted_() const override
+    {
+        return true;
+    }
+
+    void sink_formatted_(const details::log_msg &msg, string_view_t formatted) override
     {
         auto time = msg.time;
         bool should_rotate = time >= rotation_tp_;
         if (should_rotate)
         {
             auto filename = FileNameCalc::calc_filename(base_filename_, now_tm(time));
-            file_helper_.open(filename, truncate_);
-            rotation_tp_ = next_rotation_tp_();
+            if (rotation_worker_ && filename != file_helper_.filename())
+            {
+                swap_files_(filename);
+            }
+            else
+            {
+                auto previous = file_helper_.filename();
+                size_t previous_size = retention_ ? file_helper_.size() : 0;
+                file_helper_.open(filename, truncate_);
+                if (retention_ && filename != previous)
+                {
+                    retention_->add_newest(previous_size, previous);
+                    retention_->remove_excess();
+                }
+            }
+            rotation_tp_ = next_rotation_tp_(time);
+            prepare_next_file_(time);
+            if (time_index_)
+            {
+                open_time_index_();
+            }
+        }
+        if (time_index_)
+        {
+            time_index_->add(time, formatted.size());
         }
-        memory_buf_t formatted;
-        base_sink<Mutex>::formatter_->format(msg, formatted);
         file_helper_.write(formatted);
 
         // Do the cleaning only at the end because it might throw on failure.
@@ -123,9 +256,27 @@ protected:
     void flush_() override
     {
         file_helper_.flush();
+        if (rotation_worker_)
+        {
+            rotation_worker_->throw_error();
+        }
+    }
+
+    void after_flush_() override
+    {
+        if (syncer_)
+        {
+            syncer_->wait();
+        }
     }
 
 private:
+    // the size of a file opened in the background is waited for
+    void open_time_index_()
+    {
+        time_index_->open(file_helper_.filename(), file_helper_.data_size());
+    }
+
     void init_filenames_q_()
     {
         using details::os::path_exists;
@@ -136,7 +287,7 @@ private:
         while (filenames.size() < max_files_)
         {
             auto filename = FileNameCalc::calc_filename(base_filename_, now_tm(now));
-            if (!path_exists(filename))
+            if (!path_exists(filename) && !path_exists(details::file_compression::compressed_filename(filename)))
             {
                 break;
             }
@@ -155,9 +306,9 @@ private:
         return spdlog::details::os::localtime(tnow);
     }
 
-    log_clock::time_point next_rotation_tp_()
+    // the first rotation time after the given one (the time of the message rotating the file, not the system's)
+    log_clock::time_point next_rotation_tp_(log_clock::time_point now)
     {
-        auto now = log_clock::now();
         tm date = now_tm(now);
         date.tm_hour = rotation_h_;
         date.tm_min = rotation_m_;
@@ -182,6 +333,19 @@ private:
         {
             auto old_filename = std::move(filenames_q_.front());
             filenames_q_.pop_front();
+            if (rotation_worker_)
+            {
+                // after its compression, in the background
+                rotation_worker_->remove(old_filename);
+                filenames_q_.push_back(std::move(current_file));
+                rotation_worker_->throw_error();
+                return;
+            }
+            details::file_helper::remove_sidecars(old_filename);
+            if (retention_)
+            {
+                retention_->remove(old_filename);
+            }
             bool ok = remove_if_exists(old_filename) == 0;
             if (!ok)
             {
@@ -192,18 +356,61 @@ private:
         filenames_q_.push_back(std::move(current_file));
     }
 
+    // rotate to the prepared file if ready, the previous one is closed (and compressed) in the background
+    void swap_files_(const filename_t &filename)
+    {
+        auto compression_frame_size = file_helper_.compression_frame_size();
+        auto previous = details::make_unique<details::file_helper>(file_helper_.write_buffer_size(), file_helper_.drop_page_cache());
+        previous->swap(file_helper_);
+        auto next = rotation_worker_->take_prepared(filename);
+        if (next)
+        {
+            file_helper_.swap(*next);
+        }
+        else
+        {
+            file_helper_.open_in_background(filename, truncate_);
+        }
+        file_helper_.set_durability(durability_, syncer_);
+        file_helper_.set_compression(compression_frame_size);
+        rotation_worker_->retire(std::move(previous));
+    }
+
+    // the file of the period starting at the next rotation - unless the messages are already past it (clock changes..)
+    void prepare_next_file_(log_clock::time_point time)
+    {
+        if (!prepare_next_ || rotation_tp_ <= time)
+        {
+            return;
+        }
+        auto filename = FileNameCalc::calc_filename(base_filename_, now_tm(rotation_tp_));
+        if (filename != file_helper_.filename())
+        {
+            rotation_worker_->prepare(filename, truncate_, file_helper_);
+        }
+    }
+
     filename_t base_filename_;
     int rotation_h_;
     int rotation_m_;
     log_clock::time_point rotation_tp_;
     details::file_helper file_helper_;
+    file_durability durability_{file_durability::page_cache};
+    std::shared_ptr<details::file_syncer> syncer_;
+    std::unique_ptr<details::time_index> time_index_;
+    // without a rotation worker (it keeps it otherwise)
+    std::unique_ptr<details::size_retention> retention_;
     bool truncate_;
     uint16_t max_files_;
     details::circular_q<filename_t> filenames_q_;
+    bool prepare_next_;
+    bool compress_;
+    std::unique_ptr<details::file_rotation_worker> rotation_worker_;
 };
 
 using daily_file_sink_mt = daily_file_sink<std::mutex>;
 using daily_file_sink_st = daily_file_sink<details::null_mutex>;
+using daily_file_sink_spin = daily_file_sink<details::spin_mutex>;
 using daily_file_format_sink_mt = daily_file_sink<std::mutex, daily_filename_format_calculator>;
 using daily_file_format_sink_st = daily_file_sink<details::null_mutex, daily_filename_format_calculator>;
 
@@ -214,29 +421,37 @@ using daily_file_format_sink_st = daily_file_sink<details::null_mutex, daily_fil
 //
 template<typename Factory = spdlog::synchronous_factory>
 inline std::shared_ptr<logger> daily_logger_mt(
-    const std::string &logger_name, const filename_t &filename, int hour = 0, int minute = 0, bool truncate = false, uint16_t max_files = 0)
+    const std::string &logger_name, const filename_t &filename, int hour = 0, int minute = 0, bool truncate = false, uint16_t max_files = 0,
+    size_t write_buffer_size = 0, bool drop_page_cache = false, bool compress = false, bool background_rotation = false)
 {
-    return Factory::template create<sinks::daily_file_sink_mt>(logger_name, filename, hour, minute, truncate, max_files);
+    return Factory::template create<sinks::daily_file_sink_mt>(
+        logger_name, filename, hour, minute, truncate, max_files, write_buffer_size, drop_page_cache, compress, background_rotation);
 }
 
 template<typename Factory = spdlog::synchronous_factory>
 inline std::shared_ptr<logger> daily_logger_format_mt(
-    const std::string &logger_name, const filename_t &filename, int hour = 0, int minute = 0, bool truncate = false, uint16_t max_files = 0)
+    const std::string &logger_name, const filename_t &filename, int hour = 0, int minute = 0, bool truncate = false, uint16_t max_files = 0,
+    size_t write_buffer_size = 0, bool drop_page_cache = false, bool compress = false, bool background_rotation = false)
 {
-    return Factory::template create<sinks::daily_file_format_sink_mt>(logger_name, filename, hour, minute, truncate, max_files);
+    return Factory::template create<sinks::daily_file_format_sink_mt>(
+        logger_name, filename, hour, minute, truncate, max_files, write_buffer_size, drop_page_cache, compress, background_rotation);
 }
 
 template<typename Factory = spdlog::synchronous_factory>
 inline std::shared_ptr<logger> daily_logger_st(
-    const std::string &logger_name, const filename_t &filename, int hour = 0, int minute = 0, bool truncate = false, uint16_t max_files = 0)
+    const std::string &logger_name, const filename_t &filename, int hour = 0, int minute = 0, bool truncate = false, uint16_t max_files = 0,
+    size_t write_buffer_size = 0, bool drop_page_cache = false, bool compress = false, bool background_rotation = false)
 {
-    return Factory::template create<sinks::daily_file_sink_st>(logger_name, filename, hour, minute, truncate, max_files);
+    return Factory::template create<sinks::daily_file_sink_st>(
+        logger_name, filename, hour, minute, truncate, max_files, write_buffer_size, drop_page_cache, compress, background_rotation);
 }
 
 template<typename Factory = spdlog::synchronous_factory>
 inline std::shared_ptr<logger> daily_logger_format_st(
-    const std::string &logger_name, const filename_t &filename, int hour = 0, int minute = 0, bool truncate = false, uint16_t max_files = 0)
+    const std::string &logger_name, const filename_t &filename, int hour = 0, int minute = 0, bool truncate = false, uint16_t max_files = 0,
+    size_t write_buffer_size = 0, bool drop_page_cache = false, bool compress = false, bool background_rotation = false)
 {
-    return Factory::template create<sinks::daily_file_format_sink_st>(logger_name, filename, hour, minute, truncate, max_files);
+    return Factory::template create<sinks::daily_file_format_sink_st>(
+        logger_name, filename, hour, minute, truncate, max_files, write_buffer_size, drop_page_cache, compress, background_rotation);
 }
 } // namespace spdlog
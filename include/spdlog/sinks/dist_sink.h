@@ -6,6 +6,7 @@
 #include "base_sink.h"
 #include <spdlog/details/log_msg.h>
 #include <spdlog/details/null_mutex.h>
+#include <spdlog/details/rcu_ptr.h>
 #include <spdlog/pattern_formatter.h>
 
 #include <algorithm>
@@ -15,6 +16,11 @@
 
 // Distribution sink (mux). Stores a vector of sinks which get called when log
 // is called
+//
+// The vector is copied on write and published with an rcu_ptr: logging reads the current one without locking it,
+// and adding or removing a sink doesn't wait for the messages being logged. dist_sink_mt still logs one message
+// at a time (the subclasses filtering the messages need it), while a dist_sink_parallel (no lock at all) lets the
+// messages of different threads run through its sinks in parallel - they must be thread safe themselves (_mt).
 
 namespace spdlog {
 namespace sinks {
@@ -23,9 +29,12 @@ template<typename Mutex>
 class dist_sink : public base_sink<Mutex>
 {
 public:
-    dist_sink() = default;
+    dist_sink()
+        : sinks_(details::make_unique<sink_list>())
+    {}
+
     explicit dist_sink(std::vector<std::shared_ptr<sink>> sinks)
-        : sinks_(sinks)
+        : sinks_(details::make_unique<sink_list>(std::move(sinks)))
     {}
 
     dist_sink(const dist_sink &) = delete;
@@ -33,42 +42,56 @@ public:
 
     void add_sink(std::shared_ptr<sink> sink)
     {
-        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
-        sinks_.push_back(sink);
+        std::lock_guard<std::mutex> lock(sinks_write_mutex_);
+        auto sinks = copy_sinks_();
+        sinks->push_back(std::move(sink));
+        sinks_.publish(std::move(sinks));
     }
 
     void remove_sink(std::shared_ptr<sink> sink)
     {
-        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
-        sinks_.erase(std::remove(sinks_.begin(), sinks_.end(), sink), sinks_.end());
+        std::lock_guard<std::mutex> lock(sinks_write_mutex_);
+        auto sinks = copy_sinks_();
+        sinks->erase(std::remove(sinks->begin(), sinks->end(), sink), sinks->end());
+        sinks_.publish(std::move(sinks));
     }
 
     void set_sinks(std::vector<std::shared_ptr<sink>> sinks)
     {
-        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
-        sinks_ = std::move(sinks);
+        std::lock_guard<std::mutex> lock(sinks_write_mutex_);
+        sinks_.publish(details::make_unique<sink_list>(std::move(sinks)));
     }
 
-    std::vector<std::shared_ptr<sink>> &sinks()
+    // a snapshot of the current sinks, const so that it isn't mistaken for the list itself
+    // (use add_sink()/remove_sink()/set_sinks() to change them)
+    const std::vector<std::shared_ptr<sink>> sinks() const
     {
-        return sinks_;
+        sink_list_guard sinks(sinks_);
+        return *sinks;
     }
 
 protected:
+    using sink_list = std::vector<std::shared_ptr<sink>>;
+    using sink_list_guard = typename details::rcu_ptr<sink_list>::read_guard;
+
     void sink_it_(const details::log_msg &msg) override
     {
-        for (auto &sink : sinks_)
+        // like the logger, sub sinks with equivalent formatters share the formatted text
+        details::shared_format shared;
+        sink_list_guard sinks(sinks_);
+        for (auto &sink : *sinks)
         {
             if (sink->should_log(msg.level))
             {
-                sink->log(msg);
+                sink->log_shared(msg, shared);
             }
         }
     }
 
     void flush_() override
     {
-        for (auto &sink : sinks_)
+        sink_list_guard sinks(sinks_);
+        for (auto &sink : *sinks)
         {
             sink->flush();
         }
@@ -82,16 +105,35 @@ protected:
     void set_formatter_(std::unique_ptr<spdlog::formatter> sink_formatter) override
     {
         base_sink<Mutex>::formatter_ = std::move(sink_formatter);
-        for (auto &sink : sinks_)
+        sink_list_guard sinks(sinks_);
+        for (auto &sink : *sinks)
         {
             sink->set_formatter(base_sink<Mutex>::formatter_->clone());
         }
     }
-    std::vector<std::shared_ptr<sink>> sinks_;
+
+    // called with sinks_write_mutex_ locked
+    std::unique_ptr<sink_list> copy_sinks_() const
+    {
+        sink_list_guard sinks(sinks_);
+        return details::make_unique<sink_list>(*sinks);
+    }
+
+    details::rcu_ptr<sink_list> sinks_;
+    // serializes the writers of sinks_
+    std::mutex sinks_write_mutex_;
 };
 
 using dist_sink_mt = dist_sink<std::mutex>;
 using dist_sink_st = dist_sink<details::null_mutex>;
+using dist_sink_spin = dist_sink<details::spin_mutex>;
+
+// thread safe, without lock (see above). a type of its own, not to be taken for dist_sink_st.
+class dist_sink_parallel final : public dist_sink<details::null_mutex>
+{
+public:
+    using dist_sink<details::null_mutex>::dist_sink;
+};
 
 } // namespace sinks
 } // namespace spdlog
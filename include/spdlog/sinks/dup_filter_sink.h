@@ -6,11 +6,17 @@
 #include "dist_sink.h"
 #include <spdlog/details/null_mutex.h>
 #include <spdlog/details/log_msg.h>
+#include <spdlog/details/intern_table.h>
+#include <spdlog/details/fmt_helper.h>
 
+#include <algorithm>
+#include <cstdint>
 #include <cstdio>
+#include <cstring>
 #include <mutex>
 #include <string>
 #include <chrono>
+#include <vector>
 
 // Duplicate message removal sink.
 // Skip the message if previous one is identical and less than "max_skip_duration" have passed
@@ -49,6 +55,7 @@ protected:
     std::chrono::microseconds max_skip_duration_;
     log_clock::time_point last_msg_time_;
     std::string last_msg_payload_;
+    uint32_t last_msg_payload_id_ = 0; // interned payloads are compared by id and not copied
     size_t skip_counter_ = 0;
 
     void sink_it_(const details::log_msg &msg) override
@@ -76,19 +83,200 @@ protected:
         dist_sink<Mutex>::sink_it_(msg);
         last_msg_time_ = msg.time;
         skip_counter_ = 0;
-        last_msg_payload_.assign(msg.payload.data(), msg.payload.data() + msg.payload.size());
+        last_msg_payload_id_ = msg.payload_id;
+        if (msg.payload_id == 0)
+        {
+            last_msg_payload_.assign(msg.payload.data(), msg.payload.data() + msg.payload.size());
+        }
     }
 
     // return whether the log msg should be displayed (true) or skipped (false)
     bool filter_(const details::log_msg &msg)
     {
         auto filter_duration = msg.time - last_msg_time_;
-        return (filter_duration > max_skip_duration_) || (msg.payload != last_msg_payload_);
+        return (filter_duration > max_skip_duration_) || !same_payload_(msg);
+    }
+
+    bool same_payload_(const details::log_msg &msg) const
+    {
+        if (last_msg_payload_id_ != 0)
+        {
+            return msg.payload_id == last_msg_payload_id_ || msg.payload == details::intern_table::instance().fragment(last_msg_payload_id_);
+        }
+        return msg.payload == last_msg_payload_;
     }
 };
 
 using dup_filter_sink_mt = dup_filter_sink<std::mutex>;
 using dup_filter_sink_st = dup_filter_sink<details::null_mutex>;
 
+// Duplicate message removal across a window of distinct messages.
+// Skip the message if an identical one, among the last "window" distinct messages, was logged less than
+// "max_skip_duration" ago - so that interleaved repeated messages (A B A B ..) are filtered too.
+// The messages are identified by a 64 bits hash of their payload (or by the id of interned payloads),
+// looked up in a fixed size table: no allocation once constructed.
+// The number of skipped duplicates is reported per message, when it is logged again or leaves the window:
+//       [2019-06-25 17:50:56.512] [logger] [info] Skipped 3 duplicates of "Hello"
+template<typename Mutex>
+class dup_window_filter_sink : public dist_sink<Mutex>
+{
+public:
+    template<class Rep, class Period>
+    explicit dup_window_filter_sink(std::chrono::duration<Rep, Period> max_skip_duration, size_t window = 16)
+        : max_skip_duration_{max_skip_duration}
+        , window_{(std::max)(window, size_t(1))}
+        , order_(window_)
+    {
+        size_t capacity = 2;
+        while (capacity < 2 * window_)
+        {
+            capacity <<= 1;
+        }
+        slots_.resize(capacity);
+        mask_ = capacity - 1;
+    }
+
+protected:
+    // the payload start shown in the skip summaries
+    static const size_t summary_text_size = 48;
+
+    struct entry
+    {
+        bool used = false;
+        uint64_t hash = 0;
+        log_clock::time_point last_shown;
+        size_t skipped = 0;
+        size_t text_size = 0;
+        bool truncated = false;
+        char text[summary_text_size];
+    };
+
+    std::chrono::microseconds max_skip_duration_;
+    size_t window_;
+    std::vector<entry> slots_; // open addressing, linear probing
+    size_t mask_ = 0;
+    std::vector<uint64_t> order_; // the hashes in the window, oldest first from next_
+    size_t next_ = 0;
+    size_t count_ = 0;
+
+    void sink_it_(const details::log_msg &msg) override
+    {
+        auto hash = hash_(msg);
+        auto index = find_(hash);
+        if (index != slots_.size())
+        {
+            auto &e = slots_[index];
+            if (msg.time - e.last_shown <= max_skip_duration_)
+            {
+                e.skipped++;
+                return;
+            }
+            log_summary_(msg.logger_name, e);
+            e.last_shown = msg.time;
+        }
+        else
+        {
+            insert_(hash, msg);
+        }
+        dist_sink<Mutex>::sink_it_(msg);
+    }
+
+    static uint64_t hash_(const details::log_msg &msg)
+    {
+        if (msg.payload_id != 0)
+        {
+            // odd: never equal to the hashes of the payloads below, which are even
+            return (static_cast<uint64_t>(msg.payload_id) * 0x9e3779b97f4a7c15ULL) | 1;
+        }
+        // FNV-1a
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (auto c : msg.payload)
+        {
+            hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3ULL;
+        }
+        return hash & ~uint64_t(1);
+    }
+
+    // the index of the hash in slots_, or slots_.size()
+    size_t find_(uint64_t hash) const
+    {
+        for (auto i = static_cast<size_t>(hash) & mask_; slots_[i].used; i = (i + 1) & mask_)
+        {
+            if (slots_[i].hash == hash)
+            {
+                return i;
+            }
+        }
+        return slots_.size();
+    }
+
+    void insert_(uint64_t hash, const details::log_msg &msg)
+    {
+        if (count_ == window_)
+        {
+            // the oldest leaves the window
+            auto oldest = find_(order_[next_]);
+            log_summary_(msg.logger_name, slots_[oldest]);
+            erase_(oldest);
+        }
+        else
+        {
+            count_++;
+        }
+        order_[next_] = hash;
+        next_ = (next_ + 1) % window_;
+
+        auto i = static_cast<size_t>(hash) & mask_;
+        while (slots_[i].used)
+        {
+            i = (i + 1) & mask_;
+        }
+        auto &e = slots_[i];
+        e.used = true;
+        e.hash = hash;
+        e.last_shown = msg.time;
+        e.skipped = 0;
+        e.text_size = (std::min)(msg.payload.size(), size_t(summary_text_size));
+        e.truncated = msg.payload.size() > summary_text_size;
+        std::memcpy(e.text, msg.payload.data(), e.text_size);
+    }
+
+    // backward shift deletion: move up the next entries of the probe sequence that may not be found anymore
+    void erase_(size_t i)
+    {
+        for (auto j = (i + 1) & mask_; slots_[j].used; j = (j + 1) & mask_)
+        {
+            auto home = static_cast<size_t>(slots_[j].hash) & mask_;
+            bool reachable = i <= j ? (i < home && home <= j) : (i < home || home <= j);
+            if (!reachable)
+            {
+                slots_[i] = slots_[j];
+                i = j;
+            }
+        }
+        slots_[i].used = false;
+    }
+
+    void log_summary_(string_view_t logger_name, entry &e)
+    {
+        if (e.skipped == 0)
+        {
+            return;
+        }
+        memory_buf_t summary;
+        details::fmt_helper::append_string_view("Skipped ", summary);
+        details::fmt_helper::append_int(e.skipped, summary);
+        details::fmt_helper::append_string_view(" duplicates of \"", summary);
+        details::fmt_helper::append_string_view(string_view_t(e.text, e.text_size), summary);
+        details::fmt_helper::append_string_view(e.truncated ? "..\"" : "\"", summary);
+        details::log_msg skipped_msg{logger_name, level::info, string_view_t{summary.data(), summary.size()}};
+        dist_sink<Mutex>::sink_it_(skipped_msg);
+        e.skipped = 0;
+    }
+};
+
+using dup_window_filter_sink_mt = dup_window_filter_sink<std::mutex>;
+using dup_window_filter_sink_st = dup_window_filter_sink<details::null_mutex>;
+
 } // namespace sinks
 } // namespace spdlog
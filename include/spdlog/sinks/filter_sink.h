@@ -0,0 +1,151 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include "dist_sink.h"
+#include <spdlog/details/log_msg.h>
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/details/substring_matcher.h>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <regex>
+#include <string>
+#include <vector>
+
+// Filtering sink.
+// Forward to its sinks only the messages passing all the predicates of its filter_sink_config: level, logger
+// name, substrings of the payload and a regex searched in the payload. The predicates run on the raw message,
+// cheapest first, before the sub sinks format it: the messages filtered out cost no formatting nor write.
+// The substrings are searched in a single pass over the payload, for all of them at once (see
+// details/substring_matcher.h).
+//
+// Example:
+//
+//     #include <spdlog/sinks/filter_sink.h>
+//
+//     int main() {
+//         spdlog::sinks::filter_sink_config config;
+//         config.min_level = spdlog::level::info;
+//         config.excluded_loggers = {"http"};
+//         config.excludes = {"heartbeat", "health check"};
+//         auto filter = std::make_shared<filter_sink_mt>(config);
+//         filter->add_sink(std::make_shared<stdout_color_sink_mt>());
+//         spdlog::logger l("logger", filter);
+//         l.info("health check ok"); // filtered out
+//         l.info("Hello");
+//     }
+
+namespace spdlog {
+namespace sinks {
+
+struct filter_sink_config
+{
+    level::level_enum min_level = level::trace;
+    std::vector<std::string> loggers;          // only the messages of these loggers (all if empty)
+    std::vector<std::string> excluded_loggers; // not the messages of these loggers
+    std::vector<std::string> contains;         // only the payloads containing one of these (all if empty)
+    std::vector<std::string> excludes;         // not the payloads containing one of these
+    std::string regex;                         // only the payloads where it is found (ECMAScript, all if empty)
+};
+
+template<typename Mutex>
+class filter_sink : public dist_sink<Mutex>
+{
+public:
+    // throw spdlog_ex if the regex is invalid
+    explicit filter_sink(const filter_sink_config &config)
+        : min_level_{config.min_level}
+        , loggers_{config.loggers}
+        , excluded_loggers_{config.excluded_loggers}
+        , contains_{config.contains}
+        , excludes_{config.excludes}
+        , has_regex_{!config.regex.empty()}
+        , regex_{compile_regex_(config.regex)}
+    {}
+
+    // number of messages filtered out so far
+    size_t filtered_messages() const
+    {
+        return filtered_.load(std::memory_order_relaxed);
+    }
+
+protected:
+    level::level_enum min_level_;
+    std::vector<std::string> loggers_;
+    std::vector<std::string> excluded_loggers_;
+    details::substring_matcher contains_;
+    details::substring_matcher excludes_;
+    bool has_regex_;
+    std::regex regex_;
+    std::atomic<size_t> filtered_{0};
+
+    void sink_it_(const details::log_msg &msg) override
+    {
+        if (!accept_(msg))
+        {
+            filtered_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        dist_sink<Mutex>::sink_it_(msg);
+    }
+
+    // the config is not changed once constructed: safe without the lock too (dist_sink_parallel)
+    bool accept_(const details::log_msg &msg) const
+    {
+        if (msg.level < min_level_)
+        {
+            return false;
+        }
+        if (!loggers_.empty() && !has_logger_(loggers_, msg.logger_name))
+        {
+            return false;
+        }
+        if (has_logger_(excluded_loggers_, msg.logger_name))
+        {
+            return false;
+        }
+        if (!contains_.empty() && !contains_.match(msg.payload))
+        {
+            return false;
+        }
+        if (!excludes_.empty() && excludes_.match(msg.payload))
+        {
+            return false;
+        }
+        return !has_regex_ || std::regex_search(msg.payload.begin(), msg.payload.end(), regex_);
+    }
+
+    static bool has_logger_(const std::vector<std::string> &names, string_view_t logger_name)
+    {
+        return std::any_of(names.begin(), names.end(), [&](const std::string &name) { return logger_name == string_view_t(name); });
+    }
+
+    static std::regex compile_regex_(const std::string &pattern)
+    {
+        if (pattern.empty())
+        {
+            return std::regex();
+        }
+#ifdef SPDLOG_NO_EXCEPTIONS
+        return std::regex(pattern, std::regex::ECMAScript | std::regex::optimize);
+#else
+        try
+        {
+            return std::regex(pattern, std::regex::ECMAScript | std::regex::optimize);
+        }
+        catch (const std::regex_error &ex)
+        {
+            throw_spdlog_ex("filter_sink: invalid regex \"" + pattern + "\": " + ex.what());
+        }
+#endif
+    }
+};
+
+using filter_sink_mt = filter_sink<std::mutex>;
+using filter_sink_st = filter_sink<details::null_mutex>;
+
+} // namespace sinks
+} // namespace spdlog
@@ -0,0 +1,369 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <spdlog/common.h>
+#include <spdlog/json_formatter.h>
+#include <spdlog/sinks/base_sink.h>
+#include <spdlog/details/file_compression.h>
+#include <spdlog/details/fmt_helper.h>
+#include <spdlog/details/http_client.h>
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/details/scoped_buffer.h>
+#include <spdlog/details/synchronous_factory.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Bulk http sink: the formatted lines are posted in batches, as NDJSON (e.g. to the Elasticsearch _bulk api) or
+// as a Loki push request (POST /loki/api/v1/push), optionally gzipped (SPDLOG_ZLIB).
+// The lines are json by default (json_formatter, utc, one line per message), any formatter works.
+//
+// sink_it_ only appends the line to the pending batch: a background thread posts it over a kept-alive connection
+// once batch_bytes are pending, linger after the first line of the batch, or on flush. As with the otlp sink, the
+// loggers never wait for the server: past max_buffer_size bytes waiting to be sent the messages are dropped, and a
+// request failing to connect or answered with 429, 502, 503 or 504 is retried up to max_retries times, with an
+// exponential backoff, then its messages are dropped. The drops are counted by dropped_messages(), never thrown.
+// Plain http only (no TLS).
+
+namespace spdlog {
+namespace sinks {
+
+enum class http_bulk_format
+{
+    ndjson, // a line per message, Content-Type: application/x-ndjson
+    loki    // {"streams":[{"stream":{labels},"values":[["<unix nanos>","<line>"],...]}]}
+};
+
+struct http_bulk_sink_config
+{
+    std::string host = "localhost";
+    int port = 9200;
+    std::string path = "/_bulk";
+    http_bulk_format format = http_bulk_format::ndjson;
+    // ndjson: written before each line, e.g. {"index":{"_index":"logs"}} for the Elasticsearch _bulk api
+    std::string action_line;
+    // loki: the labels of the stream, e.g. {"job", "checkout"}
+    std::vector<std::pair<std::string, std::string>> labels;
+    // extra http headers, e.g. {"Authorization", "Bearer ..."}
+    std::vector<std::pair<std::string, std::string>> headers;
+    bool gzip = false; // Content-Encoding: gzip, requires SPDLOG_ZLIB
+
+    size_t batch_bytes = 1024 * 1024;
+    std::chrono::milliseconds linger{1000};
+    size_t max_buffer_size = 8 * 1024 * 1024;
+    size_t max_retries = 5;
+    std::chrono::milliseconds retry_delay{200}; // doubled on each retry up to max_retry_delay
+    std::chrono::milliseconds max_retry_delay{5000};
+    std::chrono::milliseconds timeout{10000}; // to send a request and read its response
+
+    http_bulk_sink_config() = default;
+    http_bulk_sink_config(std::string server_host, int server_port, std::string server_path,
+        http_bulk_format bulk_format = http_bulk_format::ndjson)
+        : host{std::move(server_host)}
+        , port{server_port}
+        , path{std::move(server_path)}
+        , format{bulk_format}
+    {}
+};
+
+template<typename Mutex>
+class http_bulk_sink : public spdlog::sinks::base_sink<Mutex>
+{
+public:
+    explicit http_bulk_sink(http_bulk_sink_config sink_config)
+        : base_sink<Mutex>(details::make_unique<spdlog::json_formatter>(pattern_time_type::utc, "\n"))
+        , config_{std::move(sink_config)}
+        , client_{config_.host, config_.port}
+    {
+        if (config_.gzip && !details::file_compression::supported())
+        {
+            throw_spdlog_ex("http_bulk_sink: gzip requires spdlog built with SPDLOG_ZLIB");
+        }
+        if (config_.format == http_bulk_format::loki)
+        {
+            memory_buf_t prefix;
+            details::fmt_helper::append_string_view(R"({"streams":[{"stream":{)", prefix);
+            for (size_t i = 0; i < config_.labels.size(); i++)
+            {
+                details::fmt_helper::append_string_view(i == 0 ? "\"" : ",\"", prefix);
+                details::json_escape(config_.labels[i].first, prefix);
+                details::fmt_helper::append_string_view("\":\"", prefix);
+                details::json_escape(config_.labels[i].second, prefix);
+                details::fmt_helper::append_string_view("\"", prefix);
+            }
+            details::fmt_helper::append_string_view(R"(},"values":[)", prefix);
+            loki_prefix_ = fmt::to_string(prefix);
+        }
+        sender_thread_ = std::thread([this] { sender_loop_(); });
+    }
+
+    ~http_bulk_sink() override
+    {
+        {
+            std::lock_guard<std::mutex> lock(buffer_mutex_);
+            stop_ = true;
+        }
+        buffer_cv_.notify_one();
+        sender_thread_.join();
+    }
+
+    // messages accepted by the server
+    size_t sent_messages() const
+    {
+        return sent_.load(std::memory_order_relaxed);
+    }
+
+    // messages dropped: the buffer was full, or their request failed
+    size_t dropped_messages() const
+    {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+    // requests sent again after a failure
+    size_t retries() const
+    {
+        return retries_.load(std::memory_order_relaxed);
+    }
+
+protected:
+    void sink_it_(const spdlog::details::log_msg &msg) override
+    {
+        spdlog::details::scoped_buffer formatted;
+        this->format_(msg, formatted.get());
+        sink_formatted_(msg, details::fmt_helper::to_string_view(formatted.get()));
+    }
+
+    bool accepts_formatted_() const override
+    {
+        return true;
+    }
+
+    void sink_formatted_(const spdlog::details::log_msg &msg, string_view_t formatted) override
+    {
+        // the eol is ours to write
+        auto size = formatted.size();
+        while (size > 0 && (formatted.data()[size - 1] == '\n' || formatted.data()[size - 1] == '\r'))
+        {
+            size--;
+        }
+        buffer_(msg, string_view_t(formatted.data(), size));
+    }
+
+    // the pending messages are posted by the background thread, flush_() doesn't wait for them
+    void flush_() override
+    {
+        {
+            std::lock_guard<std::mutex> lock(buffer_mutex_);
+            flush_requested_ = true;
+        }
+        buffer_cv_.notify_one();
+    }
+
+    http_bulk_sink_config config_;
+
+private:
+    struct batch
+    {
+        memory_buf_t entries; // the lines (ndjson) or the entries of the values array (loki)
+        size_t count = 0;
+        std::chrono::steady_clock::time_point first_time;
+
+        void clear()
+        {
+            entries.clear();
+            count = 0;
+        }
+    };
+
+    void buffer_(const spdlog::details::log_msg &msg, string_view_t line)
+    {
+        bool full_batch;
+        {
+            std::lock_guard<std::mutex> lock(buffer_mutex_);
+            auto &out = pending_.entries;
+            auto size_before = out.size();
+            if (config_.format == http_bulk_format::ndjson)
+            {
+                if (!config_.action_line.empty())
+                {
+                    details::fmt_helper::append_string_view(config_.action_line, out);
+                    out.push_back('\n');
+                }
+                details::fmt_helper::append_string_view(line, out);
+                out.push_back('\n');
+            }
+            else
+            {
+                auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(msg.time.time_since_epoch()).count();
+                details::fmt_helper::append_string_view(pending_.count == 0 ? "[\"" : ",[\"", out);
+                details::fmt_helper::append_int(nanos, out);
+                details::fmt_helper::append_string_view("\",\"", out);
+                details::json_escape(line, out);
+                details::fmt_helper::append_string_view("\"]", out);
+            }
+            if (out.size() + sending_size_ > config_.max_buffer_size)
+            {
+                out.resize(size_before);
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            if (pending_.count == 0)
+            {
+                pending_.first_time = std::chrono::steady_clock::now();
+            }
+            pending_.count++;
+            full_batch = pending_.entries.size() >= config_.batch_bytes;
+        }
+        if (full_batch)
+        {
+            buffer_cv_.notify_one();
+        }
+    }
+
+    void sender_loop_()
+    {
+        std::unique_lock<std::mutex> lock(buffer_mutex_);
+        for (;;)
+        {
+            auto ready = [this] {
+                return stop_ || flush_requested_ || pending_.entries.size() >= config_.batch_bytes ||
+                       (pending_.count > 0 && std::chrono::steady_clock::now() - pending_.first_time >= config_.linger);
+            };
+            if (pending_.count > 0)
+            {
+                buffer_cv_.wait_until(lock, pending_.first_time + config_.linger, ready);
+            }
+            else
+            {
+                buffer_cv_.wait_for(lock, config_.linger, ready);
+            }
+            bool stopping = stop_;
+            bool send = ready();
+            flush_requested_ = false;
+            if (pending_.count == 0)
+            {
+                if (stopping)
+                {
+                    return;
+                }
+                continue;
+            }
+            if (!send)
+            {
+                continue; // woken before the linger of the batch
+            }
+            std::swap(sending_, pending_);
+            pending_.clear();
+            sending_size_ = sending_.entries.size();
+            lock.unlock();
+            post_batch_(stopping);
+            lock.lock();
+            sending_size_ = 0;
+        }
+    }
+
+    // post sending_, with the retries. when stopping, a single attempt.
+    void post_batch_(bool stopping)
+    {
+        build_body_();
+        auto content_type = config_.format == http_bulk_format::ndjson ? "application/x-ndjson" : "application/json";
+        auto delay = config_.retry_delay;
+        for (size_t attempt = 0;; attempt++)
+        {
+            auto status = client_.post(
+                config_.path, content_type, config_.gzip ? "gzip" : "", config_.headers, config_.gzip ? compressed_ : body_, config_.timeout);
+            if (status >= 200 && status < 300)
+            {
+                sent_.fetch_add(sending_.count, std::memory_order_relaxed);
+                return;
+            }
+            bool retryable = status == 0 || status == 429 || status == 502 || status == 503 || status == 504;
+            if (!retryable || attempt >= config_.max_retries || stopping)
+            {
+                dropped_.fetch_add(sending_.count, std::memory_order_relaxed);
+                return;
+            }
+            retries_.fetch_add(1, std::memory_order_relaxed);
+            {
+                std::unique_lock<std::mutex> lock(buffer_mutex_);
+                stopping = buffer_cv_.wait_for(lock, delay, [this] { return stop_; });
+            }
+            delay = (std::min)(delay * 2, config_.max_retry_delay);
+        }
+    }
+
+    void build_body_()
+    {
+        auto &entries = sending_.entries;
+        body_.clear();
+        if (config_.format == http_bulk_format::loki)
+        {
+            details::fmt_helper::append_string_view(loki_prefix_, body_);
+            body_.append(entries.data(), entries.data() + entries.size());
+            details::fmt_helper::append_string_view("]}]}", body_);
+        }
+        else if (!config_.gzip)
+        {
+            // sent as is
+            std::swap(body_, entries);
+            return;
+        }
+        else
+        {
+            body_.append(entries.data(), entries.data() + entries.size());
+        }
+        if (config_.gzip)
+        {
+            compressed_.clear();
+            details::file_compression::compress_buffer(string_view_t(body_.data(), body_.size()), compressed_);
+        }
+    }
+
+    std::string loki_prefix_; // the body up to the values
+    std::mutex buffer_mutex_;
+    std::condition_variable buffer_cv_;
+    batch pending_;
+    size_t sending_size_{0}; // of the batch being sent by the background thread
+    bool flush_requested_{false};
+    bool stop_{false};
+    std::atomic<size_t> sent_{0};
+    std::atomic<size_t> dropped_{0};
+    std::atomic<size_t> retries_{0};
+    // used by the background thread only
+    batch sending_;
+    memory_buf_t body_;
+    memory_buf_t compressed_;
+    details::http_client client_;
+    std::thread sender_thread_;
+};
+
+using http_bulk_sink_mt = http_bulk_sink<std::mutex>;
+using http_bulk_sink_st = http_bulk_sink<spdlog::details::null_mutex>;
+
+} // namespace sinks
+
+//
+// factory functions
+//
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> http_bulk_logger_mt(const std::string &logger_name, const sinks::http_bulk_sink_config &config)
+{
+    return Factory::template create<sinks::http_bulk_sink_mt>(logger_name, config);
+}
+
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> http_bulk_logger_st(const std::string &logger_name, const sinks::http_bulk_sink_config &config)
+{
+    return Factory::template create<sinks::http_bulk_sink_st>(logger_name, config);
+}
+
+} // namespace spdlog
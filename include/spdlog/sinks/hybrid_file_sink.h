@@ -0,0 +1,323 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <spdlog/common.h>
+#include <spdlog/details/file_helper.h>
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/fmt/fmt.h>
+#include <spdlog/sinks/base_sink.h>
+#include <spdlog/sinks/daily_file_sink.h>
+#include <spdlog/details/os.h>
+#include <spdlog/details/synchronous_factory.h>
+#include <spdlog/details/fmt_helper.h>
+#include <spdlog/details/scoped_buffer.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace spdlog {
+namespace sinks {
+
+/*
+ * Generator of log file names in format basename_YYYY-MM-DD.ext, basename_YYYY-MM-DD.1.ext, basename_YYYY-MM-DD.2.ext ..
+ * (the index-th file of the day).
+ */
+struct hybrid_filename_calculator
+{
+    static filename_t calc_filename(const filename_t &filename, const tm &now_tm, std::size_t index)
+    {
+        auto daily_filename = daily_filename_calculator::calc_filename(filename, now_tm);
+        if (index == 0u)
+        {
+            return daily_filename;
+        }
+        filename_t basename, ext;
+        std::tie(basename, ext) = details::file_helper::split_by_extension(daily_filename);
+        return fmt::format(SPDLOG_FILENAME_T("{}.{}{}"), basename, index, ext);
+    }
+};
+
+/*
+ * Rotating file sink based on both size and date: a new file is opened every day at the rotation time,
+ * or when the current one would exceed max_size - whichever happens first.
+ * The files of a day are numbered by FileNameCalc (see hybrid_filename_calculator), so rotating never renames files.
+ * The size is tracked as the messages are written - the file system is asked only when a file is opened.
+ * If max_files > 0, retain only the last max_files (the current one included) and delete previous.
+ * If max_total_size > 0, delete the oldest files while all of them take more than max_total_size bytes.
+ * If truncate != false , the opened file will be truncated.
+ */
+template<typename Mutex, typename FileNameCalc = hybrid_filename_calculator>
+class hybrid_file_sink final : public base_sink<Mutex>
+{
+public:
+    hybrid_file_sink(filename_t base_filename, std::size_t max_size, int rotation_hour, int rotation_minute, std::size_t max_files = 0,
+        std::size_t max_total_size = 0, bool truncate = false, std::size_t write_buffer_size = 0, bool drop_page_cache = false)
+        : base_filename_(std::move(base_filename))
+        , max_size_(max_size)
+        , rotation_h_(rotation_hour)
+        , rotation_m_(rotation_minute)
+        , max_files_(max_files)
+        , max_total_size_(max_total_size)
+        , truncate_(truncate)
+        , file_helper_(write_buffer_size, drop_page_cache)
+    {
+        if (max_size == 0)
+        {
+            throw_spdlog_ex("hybrid_file_sink: max_size arg cannot be zero");
+        }
+        if (rotation_hour < 0 || rotation_hour > 23 || rotation_minute < 0 || rotation_minute > 59)
+        {
+            throw_spdlog_ex("hybrid_file_sink: Invalid rotation time in ctor");
+        }
+
+        auto now = log_clock::now();
+        period_tm_ = now_tm(now);
+        init_retained_files_(now);
+        file_helper_.open(FileNameCalc::calc_filename(base_filename_, period_tm_, index_), truncate_);
+        current_size_ = file_helper_.size(); // expensive. called only when opening a file
+        rotation_tp_ = next_rotation_tp_(now);
+    }
+
+    filename_t filename()
+    {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        return file_helper_.filename();
+    }
+
+protected:
+    void sink_it_(const details::log_msg &msg) override
+    {
+        details::scoped_buffer formatted_buffer;
+        auto &formatted = formatted_buffer.get();
+        base_sink<Mutex>::format_(msg, formatted);
+        sink_formatted_(msg, details::fmt_helper::to_string_view(formatted));
+    }
+
+    bool accepts_formatted_() const override
+    {
+        return true;
+    }
+
+    void sink_formatted_(const details::log_msg &msg, string_view_t formatted) override
+    {
+        auto time = msg.time;
+        bool should_rotate = false;
+        if (time >= rotation_tp_)
+        {
+            rotate_(now_tm(time), 0);
+            rotation_tp_ = next_rotation_tp_(time);
+            should_rotate = true;
+        }
+        // an empty file is kept even if the message alone exceeds max_size
+        else if (current_size_ > 0 && current_size_ + formatted.size() > max_size_)
+        {
+            rotate_(period_tm_, index_ + 1);
+            should_rotate = true;
+        }
+        file_helper_.write(formatted);
+        current_size_ += formatted.size();
+
+        // Do the cleaning only at the end because it might throw on failure.
+        if (should_rotate)
+        {
+            delete_old_();
+        }
+    }
+
+    void flush_() override
+    {
+        file_helper_.flush();
+    }
+
+private:
+    struct retained_file
+    {
+        filename_t filename;
+        std::size_t size;
+    };
+
+    // Find the files of the previous days, and of today before the last one (which is reopened).
+    // The files of a day are looked up from index 0: a day partly deleted because of max_total_size is not found again.
+    void init_retained_files_(log_clock::time_point now)
+    {
+        std::vector<std::vector<filename_t>> days;
+        auto today = find_files_(period_tm_);
+        filename_t later_first = today.empty() ? filename_t{} : today.front();
+        for (auto tp = now - std::chrono::hours(24); max_files_ == 0 || days.size() < max_files_; tp -= std::chrono::hours(24))
+        {
+            auto files = find_files_(now_tm(tp));
+            // stop on a gap, or if FileNameCalc ignores the date
+            if (files.empty() || files.front() == later_first)
+            {
+                break;
+            }
+            later_first = files.front();
+            days.push_back(std::move(files));
+        }
+        for (auto day = days.rbegin(); day != days.rend(); ++day)
+        {
+            for (auto &filename : *day)
+            {
+                auto size = file_size_(filename);
+                retain_(std::move(filename), size);
+            }
+        }
+        if (!today.empty())
+        {
+            index_ = today.size() - 1;
+            today.pop_back();
+        }
+        for (auto &filename : today)
+        {
+            auto size = file_size_(filename);
+            retain_(std::move(filename), size);
+        }
+    }
+
+    // the existing files of the given day, from index 0 until the first missing one
+    std::vector<filename_t> find_files_(const tm &day_tm)
+    {
+        std::vector<filename_t> files;
+        for (std::size_t index = 0;; index++)
+        {
+            auto filename = FileNameCalc::calc_filename(base_filename_, day_tm, index);
+            // stop if FileNameCalc ignores the index
+            if (!details::os::path_exists(filename) || (!files.empty() && filename == files.back()))
+            {
+                break;
+            }
+            files.push_back(std::move(filename));
+        }
+        return files;
+    }
+
+    static std::size_t file_size_(const filename_t &filename)
+    {
+        std::FILE *fd = nullptr;
+        if (details::os::fopen_s(&fd, filename, SPDLOG_FILENAME_T("rb")))
+        {
+            return 0;
+        }
+        std::size_t size = 0;
+        SPDLOG_TRY
+        {
+            size = details::os::filesize(fd);
+        }
+        SPDLOG_CATCH_STD
+        std::fclose(fd);
+        return size;
+    }
+
+    // close the current file and open the index-th file of the given day
+    void rotate_(const tm &day_tm, std::size_t index)
+    {
+        auto filename = FileNameCalc::calc_filename(base_filename_, day_tm, index);
+        period_tm_ = day_tm;
+        index_ = index;
+        if (filename == file_helper_.filename())
+        {
+            return;
+        }
+        retain_(file_helper_.filename(), current_size_);
+        file_helper_.open(filename, truncate_);
+        current_size_ = file_helper_.size(); // the file may exist already (restart, clock change..)
+    }
+
+    void retain_(filename_t filename, std::size_t size)
+    {
+        retained_size_ += size;
+        retained_.push_back(retained_file{std::move(filename), size});
+    }
+
+    // Delete the oldest files beyond max_files or max_total_size.
+    // Throw spdlog_ex on failure to delete an old file.
+    void delete_old_()
+    {
+        using details::os::filename_to_str;
+        using details::os::remove_if_exists;
+
+        while (!retained_.empty() && ((max_files_ > 0 && retained_.size() + 1 > max_files_) ||
+                                         (max_total_size_ > 0 && retained_size_ + current_size_ > max_total_size_)))
+        {
+            auto old_file = std::move(retained_.front());
+            retained_.pop_front();
+            retained_size_ -= old_file.size;
+            if (remove_if_exists(old_file.filename) != 0)
+            {
+                throw_spdlog_ex("Failed removing hybrid file " + filename_to_str(old_file.filename), errno);
+            }
+        }
+    }
+
+    tm now_tm(log_clock::time_point tp)
+    {
+        time_t tnow = log_clock::to_time_t(tp);
+        return spdlog::details::os::localtime(tnow);
+    }
+
+    // the first rotation time after the given one
+    log_clock::time_point next_rotation_tp_(log_clock::time_point tp)
+    {
+        tm date = now_tm(tp);
+        date.tm_hour = rotation_h_;
+        date.tm_min = rotation_m_;
+        date.tm_sec = 0;
+        auto rotation_time = log_clock::from_time_t(std::mktime(&date));
+        if (rotation_time > tp)
+        {
+            return rotation_time;
+        }
+        return {rotation_time + std::chrono::hours(24)};
+    }
+
+    filename_t base_filename_;
+    std::size_t max_size_;
+    int rotation_h_;
+    int rotation_m_;
+    std::size_t max_files_;
+    std::size_t max_total_size_;
+    bool truncate_;
+    log_clock::time_point rotation_tp_;
+    tm period_tm_{};
+    std::size_t index_{0};
+    details::file_helper file_helper_;
+    std::size_t current_size_{0};
+    std::deque<retained_file> retained_; // the previous files, oldest first
+    std::size_t retained_size_{0};
+};
+
+using hybrid_file_sink_mt = hybrid_file_sink<std::mutex>;
+using hybrid_file_sink_st = hybrid_file_sink<details::null_mutex>;
+
+} // namespace sinks
+
+//
+// factory functions
+//
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> hybrid_logger_mt(const std::string &logger_name, const filename_t &filename, size_t max_file_size,
+    int hour = 0, int minute = 0, size_t max_files = 0, size_t max_total_size = 0, bool truncate = false, size_t write_buffer_size = 0,
+    bool drop_page_cache = false)
+{
+    return Factory::template create<sinks::hybrid_file_sink_mt>(
+        logger_name, filename, max_file_size, hour, minute, max_files, max_total_size, truncate, write_buffer_size, drop_page_cache);
+}
+
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> hybrid_logger_st(const std::string &logger_name, const filename_t &filename, size_t max_file_size,
+    int hour = 0, int minute = 0, size_t max_files = 0, size_t max_total_size = 0, bool truncate = false, size_t write_buffer_size = 0,
+    bool drop_page_cache = false)
+{
+    return Factory::template create<sinks::hybrid_file_sink_st>(
+        logger_name, filename, max_file_size, hour, minute, max_files, max_total_size, truncate, write_buffer_size, drop_page_cache);
+}
+} // namespace spdlog
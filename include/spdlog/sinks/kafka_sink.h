@@ -0,0 +1,183 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+//
+// Custom sink for kafka
+// Building and using requires librdkafka (https://github.com/confluentinc/librdkafka)
+//
+// The formatted messages are produced to the topic keyed by the logger name, so the messages of a logger
+// land in the same partition, in order. librdkafka batches and compresses them (linger, batch size,
+// compression codec of kafka_sink_config) and delivers them from its own threads: logging doesn't wait for
+// the brokers. The messages waiting for delivery are bounded (max_in_flight_*): past them the messages
+// are dropped. Neither the drops nor the failed deliveries throw - they are counted (dropped_count(),
+// failed_count()).
+//
+
+#include "spdlog/common.h"
+#include "spdlog/details/log_msg.h"
+#include "spdlog/details/null_mutex.h"
+#include "spdlog/sinks/base_sink.h"
+#include <spdlog/details/synchronous_factory.h>
+
+#include <librdkafka/rdkafka.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace spdlog {
+namespace sinks {
+
+struct kafka_sink_config
+{
+    std::string brokers = "localhost:9092"; // bootstrap.servers
+    std::string topic;
+    std::chrono::milliseconds linger{5};    // linger.ms: how long a batch waits for more messages
+    size_t batch_messages = 10000;          // batch.num.messages
+    std::string compression = "lz4";        // compression.codec: none, gzip, snappy, lz4, zstd
+    size_t max_in_flight_messages = 100000; // queue.buffering.max.messages
+    size_t max_in_flight_kbytes = 65536;    // queue.buffering.max.kbytes
+    // how long flush() and the destructor wait for the deliveries
+    std::chrono::milliseconds flush_timeout{5000};
+    // other librdkafka properties (https://github.com/confluentinc/librdkafka/blob/master/CONFIGURATION.md)
+    std::vector<std::pair<std::string, std::string>> properties;
+};
+
+template<typename Mutex>
+class kafka_sink : public base_sink<Mutex>
+{
+public:
+    explicit kafka_sink(const kafka_sink_config &config)
+        : flush_timeout_(config.flush_timeout)
+    {
+        char errstr[512];
+        auto *conf = rd_kafka_conf_new();
+        auto set = [&](const std::string &name, const std::string &value) {
+            if (rd_kafka_conf_set(conf, name.c_str(), value.c_str(), errstr, sizeof(errstr)) != RD_KAFKA_CONF_OK)
+            {
+                rd_kafka_conf_destroy(conf);
+                throw_spdlog_ex("kafka_sink: " + name + ": " + errstr);
+            }
+        };
+        set("bootstrap.servers", config.brokers);
+        set("linger.ms", std::to_string(config.linger.count()));
+        set("batch.num.messages", std::to_string(config.batch_messages));
+        set("compression.codec", config.compression);
+        set("queue.buffering.max.messages", std::to_string(config.max_in_flight_messages));
+        set("queue.buffering.max.kbytes", std::to_string(config.max_in_flight_kbytes));
+        for (const auto &property : config.properties)
+        {
+            set(property.first, property.second);
+        }
+        rd_kafka_conf_set_dr_msg_cb(conf, &kafka_sink::on_delivery_);
+        rd_kafka_conf_set_opaque(conf, this);
+
+        // owns conf from now on
+        producer_ = rd_kafka_new(RD_KAFKA_PRODUCER, conf, errstr, sizeof(errstr));
+        if (producer_ == nullptr)
+        {
+            rd_kafka_conf_destroy(conf);
+            throw_spdlog_ex(std::string("kafka_sink: failed creating the producer: ") + errstr);
+        }
+        topic_ = rd_kafka_topic_new(producer_, config.topic.c_str(), nullptr);
+        if (topic_ == nullptr)
+        {
+            auto err = rd_kafka_last_error();
+            rd_kafka_destroy(producer_);
+            throw_spdlog_ex("kafka_sink: failed creating topic " + config.topic + ": " + rd_kafka_err2str(err));
+        }
+        // serves the delivery reports
+        poller_ = std::thread([this] {
+            while (!stop_.load(std::memory_order_relaxed))
+            {
+                rd_kafka_poll(producer_, 100);
+            }
+        });
+    }
+
+    kafka_sink(const kafka_sink &) = delete;
+    kafka_sink &operator=(const kafka_sink &) = delete;
+
+    ~kafka_sink()
+    {
+        (void)rd_kafka_flush(producer_, static_cast<int>(flush_timeout_.count()));
+        stop_.store(true, std::memory_order_relaxed);
+        poller_.join();
+        rd_kafka_topic_destroy(topic_);
+        rd_kafka_destroy(producer_);
+    }
+
+    // the messages dropped because too many were waiting for delivery (or refused by the producer)
+    size_t dropped_count() const
+    {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+    // the messages the brokers failed to take (after librdkafka's retries)
+    size_t failed_count() const
+    {
+        return failed_.load(std::memory_order_relaxed);
+    }
+
+protected:
+    void sink_it_(const details::log_msg &msg) override
+    {
+        memory_buf_t formatted;
+        base_sink<Mutex>::format_(msg, formatted);
+        // copied by librdkafka: the buffers are not kept
+        auto ret = rd_kafka_produce(topic_, RD_KAFKA_PARTITION_UA, RD_KAFKA_MSG_F_COPY, formatted.data(), formatted.size(),
+            msg.logger_name.data(), msg.logger_name.size(), nullptr);
+        if (ret != 0)
+        {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // wait for the deliveries, up to flush_timeout. the late ones are still counted if they fail
+    void flush_() override
+    {
+        (void)rd_kafka_flush(producer_, static_cast<int>(flush_timeout_.count()));
+    }
+
+private:
+    static void on_delivery_(rd_kafka_t *, const rd_kafka_message_t *message, void *opaque)
+    {
+        if (message->err != RD_KAFKA_RESP_ERR_NO_ERROR)
+        {
+            static_cast<kafka_sink *>(opaque)->failed_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    std::chrono::milliseconds flush_timeout_;
+    rd_kafka_t *producer_ = nullptr;
+    rd_kafka_topic_t *topic_ = nullptr;
+    std::atomic<size_t> dropped_{0};
+    std::atomic<size_t> failed_{0};
+    std::atomic<bool> stop_{false};
+    std::thread poller_;
+};
+
+using kafka_sink_mt = kafka_sink<std::mutex>;
+using kafka_sink_st = kafka_sink<spdlog::details::null_mutex>;
+
+} // namespace sinks
+
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> kafka_logger_mt(const std::string &logger_name, const sinks::kafka_sink_config &config)
+{
+    return Factory::template create<sinks::kafka_sink_mt>(logger_name, config);
+}
+
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> kafka_logger_st(const std::string &logger_name, const sinks::kafka_sink_config &config)
+{
+    return Factory::template create<sinks::kafka_sink_st>(logger_name, config);
+}
+
+} // namespace spdlog
@@ -0,0 +1,179 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <spdlog/details/rcu_ptr.h>
+#include <spdlog/sinks/sink.h>
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace spdlog {
+namespace sinks {
+/*
+ * Level routing sink: each message goes only to the sinks routed from its level, looked up in a table
+ * indexed by level - the other sinks are not visited. E.g. the errors to their own file:
+ *
+ *     auto router = std::make_shared<spdlog::sinks::level_router_sink>();
+ *     router->add_route(spdlog::level::trace, spdlog::level::warn, main_file_sink);
+ *     router->add_route(spdlog::level::err, spdlog::level::critical, errors_file_sink);
+ *     spdlog::logger logger("app", router);
+ *
+ * The table is copied on change and published with an rcu_ptr (like dist_sink): logging reads it without
+ * any lock, the routed sinks are called concurrently by the logging threads - they must be thread safe (_mt).
+ * The routed sinks with equivalent formatters share the formatted text, as the sinks of a logger.
+ */
+class level_router_sink final : public sink
+{
+public:
+    level_router_sink()
+        : table_(details::make_unique<route_table>())
+    {}
+
+    level_router_sink(const level_router_sink &) = delete;
+    level_router_sink &operator=(const level_router_sink &) = delete;
+
+    // route the messages from min_level to max_level (included) to routed_sink - in addition to its
+    // existing routes, if any. its own level still applies.
+    void add_route(level::level_enum min_level, level::level_enum max_level, std::shared_ptr<sink> routed_sink)
+    {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        auto table = copy_table_();
+        for (int lvl = min_level; lvl <= max_level && lvl < level::off; lvl++)
+        {
+            auto &route = table->routes[static_cast<size_t>(lvl)];
+            if (std::find(route.begin(), route.end(), routed_sink) == route.end())
+            {
+                route.push_back(routed_sink);
+            }
+        }
+        if (std::find(table->sinks.begin(), table->sinks.end(), routed_sink) == table->sinks.end())
+        {
+            table->sinks.push_back(std::move(routed_sink));
+        }
+        table_.publish(std::move(table));
+    }
+
+    // remove all the routes of routed_sink
+    void remove_sink(const std::shared_ptr<sink> &routed_sink)
+    {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        auto table = copy_table_();
+        for (auto &route : table->routes)
+        {
+            route.erase(std::remove(route.begin(), route.end(), routed_sink), route.end());
+        }
+        table->sinks.erase(std::remove(table->sinks.begin(), table->sinks.end(), routed_sink), table->sinks.end());
+        table_.publish(std::move(table));
+    }
+
+    // a copy of the sinks routed from lvl
+    std::vector<std::shared_ptr<sink>> sinks_of(level::level_enum lvl) const
+    {
+        table_guard table(table_);
+        return lvl < level::off ? table->routes[static_cast<size_t>(lvl)] : std::vector<std::shared_ptr<sink>>();
+    }
+
+    void log(const details::log_msg &msg) override
+    {
+        details::shared_format shared;
+        log_shared(msg, shared);
+    }
+
+    void log_shared(const details::log_msg &msg, details::shared_format &shared) override
+    {
+        if (msg.level >= level::off)
+        {
+            return;
+        }
+        table_guard table(table_);
+        for (auto &routed_sink : table->routes[static_cast<size_t>(msg.level)])
+        {
+            if (routed_sink->should_log(msg.level))
+            {
+                routed_sink->log_shared(msg, shared);
+            }
+        }
+    }
+
+    void log_formatted(const details::log_msg &msg, string_view_t formatted) override
+    {
+        if (msg.level >= level::off)
+        {
+            return;
+        }
+        table_guard table(table_);
+        for (auto &routed_sink : table->routes[static_cast<size_t>(msg.level)])
+        {
+            if (routed_sink->should_log(msg.level))
+            {
+                routed_sink->log_formatted(msg, formatted);
+            }
+        }
+    }
+
+    void flush() override
+    {
+        table_guard table(table_);
+        for (auto &routed_sink : table->sinks)
+        {
+            routed_sink->flush();
+        }
+    }
+
+    void set_pattern(const std::string &pattern) override
+    {
+        table_guard table(table_);
+        for (auto &routed_sink : table->sinks)
+        {
+            routed_sink->set_pattern(pattern);
+        }
+    }
+
+    void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override
+    {
+        table_guard table(table_);
+        for (auto &routed_sink : table->sinks)
+        {
+            routed_sink->set_formatter(sink_formatter->clone());
+        }
+    }
+
+    unsigned required_fields() const override
+    {
+        unsigned fields = details::msg_fields::none;
+        table_guard table(table_);
+        for (auto &routed_sink : table->sinks)
+        {
+            fields |= routed_sink->required_fields();
+        }
+        return fields;
+    }
+
+private:
+    struct route_table
+    {
+        std::array<std::vector<std::shared_ptr<sink>>, level::off> routes; // by level
+        std::vector<std::shared_ptr<sink>> sinks;                          // the distinct routed sinks
+    };
+    using table_guard = details::rcu_ptr<route_table>::read_guard;
+
+    details::rcu_ptr<route_table> table_;
+    // serializes the writers of table_
+    std::mutex write_mutex_;
+
+    // called with write_mutex_ locked
+    std::unique_ptr<route_table> copy_table_() const
+    {
+        table_guard table(table_);
+        return details::make_unique<route_table>(*table);
+    }
+};
+
+} // namespace sinks
+} // namespace spdlog
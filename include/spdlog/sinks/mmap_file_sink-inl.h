@@ -0,0 +1,129 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/sinks/mmap_file_sink.h>
+#endif
+
+#include <spdlog/common.h>
+#include <spdlog/details/os.h>
+#include <spdlog/details/fmt_helper.h>
+#include <spdlog/details/scoped_buffer.h>
+#include <spdlog/sinks/rotating_file_sink.h>
+
+#include <cerrno>
+
+namespace spdlog {
+namespace sinks {
+
+template<typename Mutex>
+SPDLOG_INLINE mmap_file_sink<Mutex>::mmap_file_sink(
+    filename_t base_filename, bool truncate, std::size_t chunk_size, std::size_t max_size, std::size_t max_files)
+    : base_filename_(std::move(base_filename))
+    , max_size_(max_size)
+    , max_files_(max_files)
+    , file_(chunk_size)
+{
+    file_.open(base_filename_, truncate);
+}
+
+template<typename Mutex>
+SPDLOG_INLINE filename_t mmap_file_sink<Mutex>::filename()
+{
+    std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+    return file_.filename();
+}
+
+template<typename Mutex>
+SPDLOG_INLINE void mmap_file_sink<Mutex>::sink_it_(const details::log_msg &msg)
+{
+    details::scoped_buffer formatted_buffer;
+    auto &formatted = formatted_buffer.get();
+    base_sink<Mutex>::format_(msg, formatted);
+    write_(details::fmt_helper::to_string_view(formatted));
+}
+
+// one copy per message - the batch is not collected in a buffer first, unlike in basic_file_sink
+template<typename Mutex>
+SPDLOG_INLINE void mmap_file_sink<Mutex>::sink_batch_(const details::log_msg *msgs, size_t n_msgs)
+{
+    details::scoped_buffer formatted_buffer;
+    auto &formatted = formatted_buffer.get();
+    for (size_t i = 0; i < n_msgs; i++)
+    {
+        if (this->should_log(msgs[i].level))
+        {
+            formatted.clear();
+            base_sink<Mutex>::format_(msgs[i], formatted);
+            write_(details::fmt_helper::to_string_view(formatted));
+        }
+    }
+}
+
+template<typename Mutex>
+SPDLOG_INLINE unsigned mmap_file_sink<Mutex>::required_fields() const
+{
+    return this->formatter_fields_.load(std::memory_order_relaxed);
+}
+
+template<typename Mutex>
+SPDLOG_INLINE bool mmap_file_sink<Mutex>::accepts_formatted_() const
+{
+    return true;
+}
+
+template<typename Mutex>
+SPDLOG_INLINE void mmap_file_sink<Mutex>::sink_formatted_(const details::log_msg &, string_view_t formatted)
+{
+    write_(formatted);
+}
+
+template<typename Mutex>
+SPDLOG_INLINE void mmap_file_sink<Mutex>::flush_()
+{
+    file_.flush();
+}
+
+template<typename Mutex>
+SPDLOG_INLINE void mmap_file_sink<Mutex>::write_(string_view_t data)
+{
+    if (max_size_ > 0 && file_.size() > 0 && file_.size() + data.size() > max_size_)
+    {
+        rotate_();
+    }
+    file_.write(data);
+}
+
+// Rotate files like rotating_file_sink:
+// log.txt -> log.1.txt
+// log.1.txt -> log.2.txt
+// log.2.txt -> delete
+template<typename Mutex>
+SPDLOG_INLINE void mmap_file_sink<Mutex>::rotate_()
+{
+    using details::os::filename_to_str;
+    using calc = rotating_file_sink<details::null_mutex>;
+    // truncated to the data written before renaming
+    file_.close();
+    for (auto i = max_files_; i > 0; --i)
+    {
+        filename_t src = calc::calc_filename(base_filename_, i - 1);
+        if (!details::os::path_exists(src))
+        {
+            continue;
+        }
+        filename_t target = calc::calc_filename(base_filename_, i);
+        (void)details::os::remove(target);
+        if (details::os::rename(src, target) != 0)
+        {
+            file_.reopen(true); // truncate the log file anyway to prevent it to grow beyond its limit!
+            throw_spdlog_ex("mmap_file_sink: failed renaming " + filename_to_str(src) + " to " + filename_to_str(target), errno);
+        }
+    }
+    file_.reopen(true);
+}
+
+} // namespace sinks
+} // namespace spdlog
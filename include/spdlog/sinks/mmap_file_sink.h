@@ -0,0 +1,84 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <spdlog/details/mmap_file.h>
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/sinks/base_sink.h>
+#include <spdlog/details/synchronous_factory.h>
+
+#include <mutex>
+#include <string>
+
+namespace spdlog {
+namespace sinks {
+/*
+ * File sink writing through a memory mapping of the file (posix, see details/mmap_file.h).
+ * The file grows by chunk_size at a time - logging a message is a copy into the mapping, and the
+ * messages logged survive a crash of the process without flushing.
+ * With a max size, the files are rotated like in rotating_file_sink (log.txt -> log.1.txt ..).
+ */
+template<typename Mutex>
+class mmap_file_sink final : public base_sink<Mutex>
+{
+public:
+    explicit mmap_file_sink(filename_t base_filename, bool truncate = false,
+        std::size_t chunk_size = details::mmap_file::default_chunk_size, std::size_t max_size = 0, std::size_t max_files = 0);
+    filename_t filename();
+    // the fields read by the formatter
+    unsigned required_fields() const override;
+
+protected:
+    void sink_it_(const details::log_msg &msg) override;
+    void sink_batch_(const details::log_msg *msgs, size_t n_msgs) override;
+    bool accepts_formatted_() const override;
+    void sink_formatted_(const details::log_msg &msg, string_view_t formatted) override;
+    void flush_() override;
+
+private:
+    void write_(string_view_t data);
+    void rotate_();
+
+    filename_t base_filename_;
+    std::size_t max_size_;
+    std::size_t max_files_;
+    details::mmap_file file_;
+};
+
+using mmap_file_sink_mt = mmap_file_sink<std::mutex>;
+using mmap_file_sink_st = mmap_file_sink<details::null_mutex>;
+using mmap_file_sink_spin = mmap_file_sink<details::spin_mutex>;
+
+#ifdef SPDLOG_COMPILED_LIB
+// instantiated in src/file_sinks.cpp
+extern template class SPDLOG_API mmap_file_sink<std::mutex>;
+extern template class SPDLOG_API mmap_file_sink<details::null_mutex>;
+extern template class SPDLOG_API mmap_file_sink<details::spin_mutex>;
+extern template class SPDLOG_API mmap_file_sink<details::adaptive_mutex>;
+#endif
+
+} // namespace sinks
+
+//
+// factory functions
+//
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> mmap_logger_mt(const std::string &logger_name, const filename_t &filename, bool truncate = false,
+    size_t chunk_size = details::mmap_file::default_chunk_size, size_t max_size = 0, size_t max_files = 0)
+{
+    return Factory::template create<sinks::mmap_file_sink_mt>(logger_name, filename, truncate, chunk_size, max_size, max_files);
+}
+
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> mmap_logger_st(const std::string &logger_name, const filename_t &filename, bool truncate = false,
+    size_t chunk_size = details::mmap_file::default_chunk_size, size_t max_size = 0, size_t max_files = 0)
+{
+    return Factory::template create<sinks::mmap_file_sink_st>(logger_name, filename, truncate, chunk_size, max_size, max_files);
+}
+
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "mmap_file_sink-inl.h"
+#endif
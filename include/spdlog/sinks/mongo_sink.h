@@ -11,41 +11,90 @@
 //
 
 #include "spdlog/common.h"
+#include "spdlog/details/background_worker.h"
 #include "spdlog/details/log_msg.h"
+#include "spdlog/details/periodic_worker.h"
 #include "spdlog/sinks/base_sink.h"
 #include <spdlog/details/synchronous_factory.h>
 
 #include <bsoncxx/builder/stream/document.hpp>
+#include <bsoncxx/document/value.hpp>
+#include <bsoncxx/stdx/string_view.hpp>
 #include <bsoncxx/types.hpp>
 #include <bsoncxx/view_or_value.hpp>
 
 #include <mongocxx/client.hpp>
+#include <mongocxx/collection.hpp>
 #include <mongocxx/instance.hpp>
+#include <mongocxx/options/insert.hpp>
 #include <mongocxx/uri.hpp>
 
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
 namespace spdlog {
 namespace sinks {
+
+// The documents are inserted in batches (insert_many, unordered), once max_documents are buffered,
+// or max_bytes of bson, or max_delay after the first one, and on flush.
+// The default batch of one document inserts each message right away.
+// With a max_delay, the batches are inserted by a thread of the sink (see details::background_worker), so that
+// neither the logging threads nor the shared timer thread wait for the server.
+struct mongo_sink_batch
+{
+    size_t max_documents = 1;
+    size_t max_bytes = 1024 * 1024;
+    std::chrono::milliseconds max_delay{1000};
+};
+
 template<typename Mutex>
 class mongo_sink : public base_sink<Mutex>
 {
 public:
-    mongo_sink(const std::string &db_name, const std::string &collection_name, const std::string &uri = "mongodb://localhost:27017")
+    mongo_sink(const std::string &db_name, const std::string &collection_name, const std::string &uri = "mongodb://localhost:27017",
+        mongo_sink_batch batch = mongo_sink_batch())
+        : batch_(batch)
     {
         try
         {
             client_ = spdlog::details::make_unique<mongocxx::client>(mongocxx::uri{uri});
             db_name_ = db_name;
             coll_name_ = collection_name;
+            collection_ = (*client_)[db_name_][coll_name_];
         }
         catch (const std::exception)
         {
             throw spdlog_ex("Error opening database");
         }
+        insert_options_.ordered(false);
+        documents_.reserve(batch_.max_documents);
+        if (batch_.max_documents > 1 && batch_.max_delay > std::chrono::milliseconds::zero())
+        {
+            inserter_ = spdlog::details::make_unique<details::background_worker>();
+            // insert the messages of a partial batch in time. not under the sink's mutex (a null_mutex for
+            // mongo_sink_st): the batch has its own.
+            flush_timer_ = spdlog::details::make_unique<details::periodic_worker>(
+                [this] {
+                    std::lock_guard<std::mutex> lock(batch_mutex_);
+                    if (!documents_.empty() && std::chrono::steady_clock::now() - first_buffered_ >= batch_.max_delay)
+                    {
+                        insert_batch_();
+                    }
+                },
+                batch_.max_delay);
+        }
     }
 
     ~mongo_sink()
     {
-        flush_();
+        flush_timer_.reset();
+        SPDLOG_TRY
+        {
+            flush_();
+        }
+        SPDLOG_CATCH_STD
     }
 
 protected:
@@ -56,21 +105,120 @@ protected:
 
         if (client_ != nullptr)
         {
-            auto doc = document{} << "timestamp" << bsoncxx::types::b_date(msg.time) << "level" << level::to_string_view(msg.level).data()
-                                  << "message" << std::string(msg.payload.begin(), msg.payload.end()) << "logger_name"
-                                  << std::string(msg.logger_name.begin(), msg.logger_name.end()) << "thread_id"
-                                  << static_cast<int>(msg.thread_id) << finalize;
-            client_->database(db_name_).collection(coll_name_).insert_one(doc.view());
+            auto level_name = level::to_string_view(msg.level);
+            document builder{};
+            builder << "timestamp" << bsoncxx::types::b_date(msg.time) << "level" << to_bson_(level_name) << "message"
+                    << to_bson_(msg.payload) << "logger_name" << to_bson_(msg.logger_name) << "thread_id"
+                    << static_cast<int>(msg.thread_id);
+            // key/value fields are stored with their own bson types
+            for (size_t i = 0; i < msg.n_fields; i++)
+            {
+                append_field_(builder, msg.fields[i]);
+            }
+            std::lock_guard<std::mutex> lock(batch_mutex_);
+            if (documents_.empty())
+            {
+                first_buffered_ = std::chrono::steady_clock::now();
+            }
+            documents_.push_back(builder << finalize);
+            buffered_bytes_ += documents_.back().view().length();
+            if (documents_.size() >= batch_.max_documents || buffered_bytes_ >= batch_.max_bytes ||
+                std::chrono::steady_clock::now() - first_buffered_ >= batch_.max_delay)
+            {
+                insert_batch_();
+            }
+        }
+        throw_if_insert_failed_();
+    }
+
+    static bsoncxx::types::b_utf8 to_bson_(string_view_t str)
+    {
+        return bsoncxx::types::b_utf8{bsoncxx::stdx::string_view(str.data(), str.size())};
+    }
+
+    static void append_field_(bsoncxx::builder::stream::document &builder, const field &f)
+    {
+        bsoncxx::stdx::string_view key(f.key.data(), f.key.size());
+        switch (f.type)
+        {
+        case field::value_type::string:
+            builder << key << to_bson_(f.string_value);
+            break;
+        case field::value_type::signed_int:
+            builder << key << static_cast<int64_t>(f.int_value);
+            break;
+        case field::value_type::unsigned_int: // bson has no unsigned 64 bit type
+            builder << key << static_cast<int64_t>(f.uint_value);
+            break;
+        case field::value_type::floating:
+            builder << key << f.double_value;
+            break;
+        case field::value_type::boolean:
+            builder << key << f.bool_value;
+            break;
         }
     }
 
-    void flush_() override {}
+    void flush_() override
+    {
+        {
+            std::lock_guard<std::mutex> lock(batch_mutex_);
+            insert_batch_();
+        }
+        if (inserter_)
+        {
+            inserter_->wait_idle();
+        }
+        throw_if_insert_failed_();
+    }
+
+    // the batch is cleared even if the insert fails, so that a failing server doesn't grow it.
+    // called with batch_mutex_ locked.
+    void insert_batch_()
+    {
+        if (documents_.empty())
+        {
+            return;
+        }
+        auto documents = std::make_shared<std::vector<bsoncxx::document::value>>();
+        documents->reserve(batch_.max_documents);
+        documents->swap(documents_);
+        buffered_bytes_ = 0;
+        if (!inserter_)
+        {
+            collection_.insert_many(*documents, insert_options_);
+            return;
+        }
+        inserter_->post([this, documents] { collection_.insert_many(*documents, insert_options_); });
+    }
+
+    // report the failures of the batches inserted by inserter_
+    void throw_if_insert_failed_()
+    {
+        if (inserter_)
+        {
+            auto error = inserter_->take_error();
+            if (!error.empty())
+            {
+                throw_spdlog_ex(error);
+            }
+        }
+    }
 
 private:
     static mongocxx::instance instance_;
     std::string db_name_;
     std::string coll_name_;
     std::unique_ptr<mongocxx::client> client_ = nullptr;
+    mongocxx::collection collection_;
+    mongocxx::options::insert insert_options_;
+    mongo_sink_batch batch_;
+    std::mutex batch_mutex_; // documents_, buffered_bytes_ and first_buffered_ are used by flush_timer_ too
+    std::vector<bsoncxx::document::value> documents_;
+    size_t buffered_bytes_ = 0;
+    std::chrono::steady_clock::time_point first_buffered_;
+    std::unique_ptr<details::background_worker> inserter_; // inserts the batches, if flush_timer_ is set
+    std::unique_ptr<details::periodic_worker> flush_timer_; // last: stopped first
 };
 mongocxx::instance mongo_sink<std::mutex>::instance_{};
 
@@ -83,16 +231,18 @@ using mongo_sink_st = mongo_sink<spdlog::details::null_mutex>;
 
 template<typename Factory = spdlog::synchronous_factory>
 inline std::shared_ptr<logger> mongo_logger_mt(const std::string &logger_name, const std::string &db_name,
-    const std::string &collection_name, const std::string &uri = "mongodb://localhost:27017")
+    const std::string &collection_name, const std::string &uri = "mongodb://localhost:27017",
+    sinks::mongo_sink_batch batch = sinks::mongo_sink_batch())
 {
-    return Factory::template create<sinks::mongo_sink_mt>(logger_name, db_name, collection_name, uri);
+    return Factory::template create<sinks::mongo_sink_mt>(logger_name, db_name, collection_name, uri, batch);
 }
 
 template<typename Factory = spdlog::synchronous_factory>
 inline std::shared_ptr<logger> mongo_logger_st(const std::string &logger_name, const std::string &db_name,
-    const std::string &collection_name, const std::string &uri = "mongodb://localhost:27017")
+    const std::string &collection_name, const std::string &uri = "mongodb://localhost:27017",
+    sinks::mongo_sink_batch batch = sinks::mongo_sink_batch())
 {
-    return Factory::template create<sinks::mongo_sink_st>(logger_name, db_name, collection_name, uri);
+    return Factory::template create<sinks::mongo_sink_st>(logger_name, db_name, collection_name, uri, batch);
 }
 
 } // namespace spdlog
@@ -7,6 +7,7 @@
 
 #    include <spdlog/details/null_mutex.h>
 #    include <spdlog/sinks/base_sink.h>
+#    include <spdlog/details/scoped_buffer.h>
 
 #    include <mutex>
 #    include <string>
@@ -28,9 +29,30 @@ public:
 protected:
     void sink_it_(const details::log_msg &msg) override
     {
-        memory_buf_t formatted;
-        base_sink<Mutex>::formatter_->format(msg, formatted);
-        OutputDebugStringA(fmt::to_string(formatted).c_str());
+        details::scoped_buffer formatted_buffer;
+        auto &formatted = formatted_buffer.get();
+        base_sink<Mutex>::format_(msg, formatted);
+        formatted.push_back('\0');
+        OutputDebugStringA(formatted.data());
+    }
+
+    // the whole batch in one call
+    void sink_batch_(const details::log_msg *msgs, size_t n_msgs) override
+    {
+        details::scoped_buffer formatted_buffer;
+        auto &formatted = formatted_buffer.get();
+        for (size_t i = 0; i < n_msgs; i++)
+        {
+            if (this->should_log(msgs[i].level))
+            {
+                base_sink<Mutex>::format_(msgs[i], formatted);
+            }
+        }
+        if (formatted.size() > 0)
+        {
+            formatted.push_back('\0');
+            OutputDebugStringA(formatted.data());
+        }
     }
 
     void flush_() override {}
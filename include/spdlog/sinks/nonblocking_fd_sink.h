@@ -0,0 +1,235 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifdef _WIN32
+#    error nonblocking_fd_sink.h is not supported on windows
+#endif
+
+#include <spdlog/common.h>
+#include <spdlog/sinks/base_sink.h>
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/details/scoped_buffer.h>
+#include <spdlog/details/synchronous_factory.h>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <functional>
+#include <mutex>
+#include <string>
+
+// Non blocking file descriptor sink (socket, pipe, stdout...), for the threads of an event loop (epoll, asio...)
+// which must never block on a slow reader.
+// The fd is set to non blocking: the formatted messages are written as long as the fd takes them, the rest are
+// kept in an outbox, up to max_outbox_size bytes (the next messages are dropped, counted by dropped_messages()).
+// When the outbox is not empty the sink calls the wait_writable hook once, and the event loop calls
+// on_writable() when the fd becomes writable (POLLOUT): the outbox is written, and the hook called again if
+// the fd still doesn't take it all. E.g. with asio:
+//
+//     asio::posix::stream_descriptor out(io_context, ::dup(STDOUT_FILENO));
+//     std::shared_ptr<spdlog::sinks::nonblocking_fd_sink_mt> sink;
+//     spdlog::sinks::nonblocking_fd_sink_config config(out.native_handle(), [&](int) {
+//         out.async_wait(asio::posix::stream_descriptor::wait_write, [&](asio::error_code) { sink->on_writable(); });
+//     });
+//     sink = std::make_shared<spdlog::sinks::nonblocking_fd_sink_mt>(config);
+//
+// The hook is called with the sink locked: it must only register the wait, not call on_writable() itself.
+// flush() writes what the fd takes, without waiting. Sockets are written with MSG_NOSIGNAL where available;
+// writing to a pipe closed by its reader raises SIGPIPE, which servers usually ignore.
+
+namespace spdlog {
+namespace sinks {
+
+struct nonblocking_fd_sink_config
+{
+    int fd;
+    std::function<void(int fd)> wait_writable;
+    size_t max_outbox_size = 4 * 1024 * 1024;
+    bool close_fd = false; // close the fd when the sink is destroyed
+
+    nonblocking_fd_sink_config(int output_fd, std::function<void(int fd)> wait_writable_hook)
+        : fd{output_fd}
+        , wait_writable{std::move(wait_writable_hook)}
+    {}
+};
+
+template<typename Mutex>
+class nonblocking_fd_sink : public spdlog::sinks::base_sink<Mutex>
+{
+public:
+    // set the fd to non blocking or throw
+    explicit nonblocking_fd_sink(nonblocking_fd_sink_config sink_config)
+        : config_{std::move(sink_config)}
+    {
+        int flags = ::fcntl(config_.fd, F_GETFL);
+        if (flags == -1 || ::fcntl(config_.fd, F_SETFL, flags | O_NONBLOCK) == -1)
+        {
+            throw_spdlog_ex("nonblocking_fd_sink: failed setting the fd to non blocking", errno);
+        }
+        int type;
+        socklen_t type_len = sizeof(type);
+        is_socket_ = ::getsockopt(config_.fd, SOL_SOCKET, SO_TYPE, &type, &type_len) == 0;
+    }
+
+    ~nonblocking_fd_sink() override
+    {
+        SPDLOG_TRY
+        {
+            write_outbox_();
+        }
+        SPDLOG_CATCH_STD
+        if (config_.close_fd)
+        {
+            ::close(config_.fd);
+        }
+    }
+
+    // to be called by the event loop once the fd is writable, after a call to the wait_writable hook.
+    // return whether the outbox is empty now (otherwise the hook was called again).
+    bool on_writable()
+    {
+        std::lock_guard<Mutex> lock(this->mutex_);
+        waiting_ = false;
+        write_outbox_();
+        wait_if_pending_();
+        return outbox_.size() == head_;
+    }
+
+    // bytes waiting for the fd
+    size_t pending_bytes() const
+    {
+        std::lock_guard<Mutex> lock(this->mutex_);
+        return outbox_.size() - head_;
+    }
+
+    size_t dropped_messages() const
+    {
+        std::lock_guard<Mutex> lock(this->mutex_);
+        return dropped_;
+    }
+
+protected:
+    void sink_it_(const spdlog::details::log_msg &msg) override
+    {
+        spdlog::details::scoped_buffer formatted_buffer;
+        auto &formatted = formatted_buffer.get();
+        spdlog::sinks::base_sink<Mutex>::format_(msg, formatted);
+        size_t written = 0;
+        if (outbox_.size() == head_)
+        {
+            written = write_some_(formatted.data(), formatted.size());
+        }
+        if (written < formatted.size())
+        {
+            // all or nothing: a message is never cut, unless partly written already
+            if (written == 0 && outbox_.size() - head_ + formatted.size() > config_.max_outbox_size)
+            {
+                dropped_++;
+                return;
+            }
+            outbox_.append(formatted.data() + written, formatted.size() - written);
+            wait_if_pending_();
+        }
+    }
+
+    void flush_() override
+    {
+        write_outbox_();
+        wait_if_pending_();
+    }
+
+    nonblocking_fd_sink_config config_;
+
+private:
+    std::string outbox_;
+    size_t head_ = 0; // written so far from outbox_
+    size_t dropped_ = 0;
+    bool waiting_ = false; // the hook was called, on_writable() is due
+    bool is_socket_ = false;
+
+    // write what the fd takes. throw on errors (the outbox is discarded then)
+    size_t write_some_(const char *data, size_t size)
+    {
+        size_t written = 0;
+        while (written < size)
+        {
+#ifdef MSG_NOSIGNAL
+            auto n = is_socket_ ? ::send(config_.fd, data + written, size - written, MSG_NOSIGNAL)
+                                : ::write(config_.fd, data + written, size - written);
+#else
+            auto n = ::write(config_.fd, data + written, size - written);
+#endif
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
+                {
+                    break;
+                }
+                int last_errno = errno;
+                outbox_.clear();
+                head_ = 0;
+                throw_spdlog_ex("nonblocking_fd_sink: write failed", last_errno);
+            }
+            written += static_cast<size_t>(n);
+        }
+        return written;
+    }
+
+    void write_outbox_()
+    {
+        if (outbox_.size() == head_)
+        {
+            return;
+        }
+        head_ += write_some_(outbox_.data() + head_, outbox_.size() - head_);
+        if (head_ == outbox_.size())
+        {
+            outbox_.clear();
+            head_ = 0;
+        }
+        else if (head_ > outbox_.size() / 2)
+        {
+            outbox_.erase(0, head_);
+            head_ = 0;
+        }
+    }
+
+    void wait_if_pending_()
+    {
+        if (outbox_.size() != head_ && !waiting_ && config_.wait_writable)
+        {
+            waiting_ = true;
+            config_.wait_writable(config_.fd);
+        }
+    }
+};
+
+using nonblocking_fd_sink_mt = nonblocking_fd_sink<std::mutex>;
+using nonblocking_fd_sink_st = nonblocking_fd_sink<spdlog::details::null_mutex>;
+
+} // namespace sinks
+
+//
+// factory functions
+//
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> nonblocking_fd_logger_mt(const std::string &logger_name, const sinks::nonblocking_fd_sink_config &config)
+{
+    return Factory::template create<sinks::nonblocking_fd_sink_mt>(logger_name, config);
+}
+
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> nonblocking_fd_logger_st(const std::string &logger_name, const sinks::nonblocking_fd_sink_config &config)
+{
+    return Factory::template create<sinks::nonblocking_fd_sink_st>(logger_name, config);
+}
+
+} // namespace spdlog
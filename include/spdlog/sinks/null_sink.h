@@ -15,6 +15,12 @@ namespace sinks {
 template<typename Mutex>
 class null_sink : public base_sink<Mutex>
 {
+public:
+    unsigned required_fields() const override
+    {
+        return details::msg_fields::none;
+    }
+
 protected:
     void sink_it_(const details::log_msg &) override {}
     void flush_() override {}
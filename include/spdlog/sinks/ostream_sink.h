@@ -5,6 +5,8 @@
 
 #include <spdlog/details/null_mutex.h>
 #include <spdlog/sinks/base_sink.h>
+#include <spdlog/details/fmt_helper.h>
+#include <spdlog/details/scoped_buffer.h>
 
 #include <mutex>
 #include <ostream>
@@ -22,11 +24,28 @@ public:
     ostream_sink(const ostream_sink &) = delete;
     ostream_sink &operator=(const ostream_sink &) = delete;
 
+    // the fields read by the formatter
+    unsigned required_fields() const override
+    {
+        return this->formatter_fields_.load(std::memory_order_relaxed);
+    }
+
 protected:
     void sink_it_(const details::log_msg &msg) override
     {
-        memory_buf_t formatted;
-        base_sink<Mutex>::formatter_->format(msg, formatted);
+        details::scoped_buffer formatted_buffer;
+        auto &formatted = formatted_buffer.get();
+        base_sink<Mutex>::format_(msg, formatted);
+        sink_formatted_(msg, details::fmt_helper::to_string_view(formatted));
+    }
+
+    bool accepts_formatted_() const override
+    {
+        return true;
+    }
+
+    void sink_formatted_(const details::log_msg &, string_view_t formatted) override
+    {
         ostream_.write(formatted.data(), static_cast<std::streamsize>(formatted.size()));
         if (force_flush_)
         {
@@ -45,6 +64,7 @@ protected:
 
 using ostream_sink_mt = ostream_sink<std::mutex>;
 using ostream_sink_st = ostream_sink<details::null_mutex>;
+using ostream_sink_spin = ostream_sink<details::spin_mutex>;
 
 } // namespace sinks
 } // namespace spdlog
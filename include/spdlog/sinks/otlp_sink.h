@@ -0,0 +1,331 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <spdlog/common.h>
+#include <spdlog/sinks/base_sink.h>
+#include <spdlog/details/file_compression.h>
+#include <spdlog/details/http_client.h>
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/details/otlp_encoder.h>
+#include <spdlog/details/scoped_buffer.h>
+#include <spdlog/details/synchronous_factory.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// OpenTelemetry logs exporter: the messages are sent to an OTLP collector as LogRecords (see details/otlp_encoder.h
+// for the mapping), over OTLP/HTTP with protobuf (POST /v1/logs), optionally gzipped (SPDLOG_ZLIB).
+//
+// sink_it_ only encodes the record into the pending batch, grouped by logger (the instrumentation scope): a
+// background thread posts the batch once batch_size bytes are pending, every batch_interval, or on flush. The
+// loggers never wait for the collector: past max_buffer_size bytes waiting to be sent the messages are dropped.
+// A request failing to connect or answered with 429, 502, 503 or 504 is retried up to max_retries times, with an
+// exponential backoff - then its messages are dropped, as those of a request rejected otherwise. The drops are
+// counted by dropped_messages(), never thrown.
+// Plain http only (no TLS, no gRPC): meant for a collector on the host or a sidecar.
+
+namespace spdlog {
+namespace sinks {
+
+struct otlp_sink_config
+{
+    std::string host = "localhost";
+    int port = 4318;
+    std::string path = "/v1/logs";
+    // attributes of the resource, e.g. {"service.name", "checkout"}
+    std::vector<std::pair<std::string, std::string>> resource_attributes;
+    // extra http headers, e.g. {"Authorization", "Bearer ..."}
+    std::vector<std::pair<std::string, std::string>> headers;
+    bool gzip = false; // Content-Encoding: gzip, requires SPDLOG_ZLIB
+
+    size_t batch_size = 256 * 1024; // encoded bytes
+    std::chrono::milliseconds batch_interval{1000};
+    size_t max_buffer_size = 8 * 1024 * 1024;
+    size_t max_retries = 5;
+    std::chrono::milliseconds retry_delay{200}; // doubled on each retry up to max_retry_delay
+    std::chrono::milliseconds max_retry_delay{5000};
+    std::chrono::milliseconds timeout{10000}; // to send a request and read its response
+
+    otlp_sink_config() = default;
+    otlp_sink_config(std::string collector_host, int collector_port)
+        : host{std::move(collector_host)}
+        , port{collector_port}
+    {}
+};
+
+template<typename Mutex>
+class otlp_sink : public spdlog::sinks::base_sink<Mutex>
+{
+public:
+    explicit otlp_sink(otlp_sink_config sink_config)
+        : config_{std::move(sink_config)}
+        , client_{config_.host, config_.port}
+    {
+        if (config_.gzip && !details::file_compression::supported())
+        {
+            throw_spdlog_ex("otlp_sink: gzip requires spdlog built with SPDLOG_ZLIB");
+        }
+        sender_thread_ = std::thread([this] { sender_loop_(); });
+    }
+
+    ~otlp_sink() override
+    {
+        {
+            std::lock_guard<std::mutex> lock(buffer_mutex_);
+            stop_ = true;
+        }
+        buffer_cv_.notify_one();
+        sender_thread_.join();
+    }
+
+    // messages accepted by the collector
+    size_t sent_messages() const
+    {
+        return sent_.load(std::memory_order_relaxed);
+    }
+
+    // messages dropped: the buffer was full, or their request failed
+    size_t dropped_messages() const
+    {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+    // requests sent again after a failure
+    size_t retries() const
+    {
+        return retries_.load(std::memory_order_relaxed);
+    }
+
+protected:
+    void sink_it_(const spdlog::details::log_msg &msg) override
+    {
+        spdlog::details::scoped_buffer record_buffer;
+        auto &record = record_buffer.get();
+        details::otlp::encode_log_record(msg, log_clock::now(), record);
+        buffer_(msg.logger_name, record);
+    }
+
+    // the pending messages are posted by the background thread, flush_() doesn't wait for them
+    void flush_() override
+    {
+        {
+            std::lock_guard<std::mutex> lock(buffer_mutex_);
+            flush_requested_ = true;
+        }
+        buffer_cv_.notify_one();
+    }
+
+    otlp_sink_config config_;
+
+private:
+    // the encoded LogRecords (with their tags) of a logger
+    struct scope_records
+    {
+        std::string name;
+        memory_buf_t records;
+        size_t count = 0;
+    };
+
+    struct batch
+    {
+        std::vector<scope_records> scopes; // kept when cleared: their buffers are reused
+        size_t size = 0;
+        size_t count = 0;
+
+        void clear()
+        {
+            for (auto &scope : scopes)
+            {
+                scope.records.clear();
+                scope.count = 0;
+            }
+            size = 0;
+            count = 0;
+        }
+    };
+
+    void buffer_(string_view_t logger_name, const memory_buf_t &record)
+    {
+        auto size = details::otlp::field_size(record.size());
+        bool full_batch;
+        {
+            std::lock_guard<std::mutex> lock(buffer_mutex_);
+            if (pending_.size + sending_size_ + size > config_.max_buffer_size)
+            {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            auto &scope = scope_of_(pending_, logger_name);
+            details::otlp::put_length(scope.records, 2, record.size());
+            scope.records.append(record.data(), record.data() + record.size());
+            scope.count++;
+            pending_.size += size;
+            pending_.count++;
+            full_batch = pending_.size >= config_.batch_size;
+        }
+        if (full_batch)
+        {
+            buffer_cv_.notify_one();
+        }
+    }
+
+    static scope_records &scope_of_(batch &b, string_view_t logger_name)
+    {
+        for (auto &scope : b.scopes)
+        {
+            if (string_view_t(scope.name) == logger_name)
+            {
+                return scope;
+            }
+        }
+        b.scopes.emplace_back();
+        b.scopes.back().name.assign(logger_name.data(), logger_name.size());
+        return b.scopes.back();
+    }
+
+    void sender_loop_()
+    {
+        std::unique_lock<std::mutex> lock(buffer_mutex_);
+        for (;;)
+        {
+            buffer_cv_.wait_for(
+                lock, config_.batch_interval, [this] { return stop_ || flush_requested_ || pending_.size >= config_.batch_size; });
+            bool stopping = stop_;
+            flush_requested_ = false;
+            if (pending_.count == 0)
+            {
+                if (stopping)
+                {
+                    return;
+                }
+                continue;
+            }
+            std::swap(sending_, pending_);
+            pending_.clear();
+            sending_size_ = sending_.size;
+            lock.unlock();
+            post_batch_(stopping);
+            lock.lock();
+            sending_size_ = 0;
+        }
+    }
+
+    // post sending_, with the retries. when stopping, a single attempt.
+    void post_batch_(bool stopping)
+    {
+        build_body_();
+        auto delay = config_.retry_delay;
+        for (size_t attempt = 0;; attempt++)
+        {
+            auto status = client_.post(config_.path, "application/x-protobuf", config_.gzip ? "gzip" : "", config_.headers,
+                config_.gzip ? compressed_ : body_, config_.timeout);
+            if (status >= 200 && status < 300)
+            {
+                sent_.fetch_add(sending_.count, std::memory_order_relaxed);
+                return;
+            }
+            bool retryable = status == 0 || status == 429 || status == 502 || status == 503 || status == 504;
+            if (!retryable || attempt >= config_.max_retries || stopping)
+            {
+                dropped_.fetch_add(sending_.count, std::memory_order_relaxed);
+                return;
+            }
+            retries_.fetch_add(1, std::memory_order_relaxed);
+            {
+                std::unique_lock<std::mutex> lock(buffer_mutex_);
+                stopping = buffer_cv_.wait_for(lock, delay, [this] { return stop_; });
+            }
+            delay = (std::min)(delay * 2, config_.max_retry_delay);
+        }
+    }
+
+    // ExportLogsServiceRequest: resource_logs (1) {resource (1) {attributes (1)},
+    //                                              scope_logs (2) {scope (1) {name (1)}, log_records (2)}}
+    void build_body_()
+    {
+        using namespace details::otlp;
+        size_t resource_size = 0;
+        for (auto &attribute : config_.resource_attributes)
+        {
+            resource_size += field_size(key_value_size(field(attribute.first, attribute.second)));
+        }
+        size_t resource_logs_size = field_size(resource_size);
+        for (auto &scope : sending_.scopes)
+        {
+            if (scope.count > 0)
+            {
+                resource_logs_size += field_size(field_size(field_size(scope.name.size())) + scope.records.size());
+            }
+        }
+
+        body_.clear();
+        put_length(body_, 1, resource_logs_size);
+        put_length(body_, 1, resource_size);
+        for (auto &attribute : config_.resource_attributes)
+        {
+            put_attribute(body_, 1, field(attribute.first, attribute.second));
+        }
+        for (auto &scope : sending_.scopes)
+        {
+            if (scope.count > 0)
+            {
+                put_length(body_, 2, field_size(field_size(scope.name.size())) + scope.records.size());
+                put_length(body_, 1, field_size(scope.name.size()));
+                put_string(body_, 1, scope.name);
+                body_.append(scope.records.data(), scope.records.data() + scope.records.size());
+            }
+        }
+        if (config_.gzip)
+        {
+            compressed_.clear();
+            details::file_compression::compress_buffer(string_view_t(body_.data(), body_.size()), compressed_);
+        }
+    }
+
+    std::mutex buffer_mutex_;
+    std::condition_variable buffer_cv_;
+    batch pending_;
+    size_t sending_size_{0}; // of the batch being sent by the background thread
+    bool flush_requested_{false};
+    bool stop_{false};
+    std::atomic<size_t> sent_{0};
+    std::atomic<size_t> dropped_{0};
+    std::atomic<size_t> retries_{0};
+    // used by the background thread only
+    batch sending_;
+    memory_buf_t body_;
+    memory_buf_t compressed_;
+    details::http_client client_;
+    std::thread sender_thread_;
+};
+
+using otlp_sink_mt = otlp_sink<std::mutex>;
+using otlp_sink_st = otlp_sink<spdlog::details::null_mutex>;
+
+} // namespace sinks
+
+//
+// factory functions
+//
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> otlp_logger_mt(const std::string &logger_name, const sinks::otlp_sink_config &config)
+{
+    return Factory::template create<sinks::otlp_sink_mt>(logger_name, config);
+}
+
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> otlp_logger_st(const std::string &logger_name, const sinks::otlp_sink_config &config)
+{
+    return Factory::template create<sinks::otlp_sink_st>(logger_name, config);
+}
+
+} // namespace spdlog
@@ -7,14 +7,29 @@
 // Custom sink for QPlainTextEdit or QTextEdit and its childs(QTextBrowser...
 // etc) Building and using requires Qt library.
 //
+// By default the lines are batched: the sink posts a single queued call to the Qt object's
+// thread for the lines logged meanwhile, invoking meta_method once with the lines joined by
+// '\n' - at most once per batch_interval (a frame), so that bursts of messages don't flood the
+// event queue. Past max_lines pending lines the oldest are dropped (and their count reported).
+// A batch_interval of zero invokes meta_method once per message instead.
+// Batching requires Qt >= 5.10.
+//
 
 #include "spdlog/common.h"
 #include "spdlog/details/log_msg.h"
+#include "spdlog/details/scoped_buffer.h"
 #include "spdlog/details/synchronous_factory.h"
 #include "spdlog/sinks/base_sink.h"
 
 #include <QTextEdit>
 #include <QPlainTextEdit>
+#include <QPointer>
+#include <QStringList>
+#include <QTimer>
+
+#include <chrono>
+#include <memory>
+#include <mutex>
 
 //
 // qt_sink class
@@ -23,27 +38,139 @@ namespace spdlog {
 namespace sinks {
 template <typename Mutex> class qt_sink : public base_sink<Mutex> {
 public:
-  qt_sink(QObject *qt_object = nullptr, const std::string &meta_method = "") {
+  qt_sink(QObject *qt_object = nullptr, const std::string &meta_method = "",
+          std::chrono::milliseconds batch_interval = std::chrono::milliseconds(16), size_t max_lines = 10000) {
       qt_object_ = qt_object;
       meta_method_ = meta_method;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
+      if (batch_interval > std::chrono::milliseconds::zero()) {
+        batch_ = std::make_shared<batch_state>();
+        batch_->qt_object = qt_object;
+        batch_->meta_method = meta_method;
+        batch_->interval = batch_interval;
+        batch_->max_lines = max_lines > 0 ? max_lines : 1;
+      }
+#else
+      (void)batch_interval;
+      (void)max_lines;
+#endif
   }
 
   ~qt_sink() { flush_(); }
 
 protected:
   void sink_it_(const details::log_msg &msg) override {
-    memory_buf_t formatted;
-    base_sink<Mutex>::formatter_->format(msg, formatted);
+    details::scoped_buffer formatted_buffer;
+    auto &formatted = formatted_buffer.get();
+    base_sink<Mutex>::format_(msg, formatted);
     string_view_t str = string_view_t(formatted.data(), formatted.size());
-    QMetaObject::invokeMethod(qt_object_, meta_method_.c_str(), Qt::AutoConnection,
-     Q_ARG(QString, QString::fromUtf8(str.data(), static_cast<int>(str.size())).trimmed()));
+    auto line = QString::fromUtf8(str.data(), static_cast<int>(str.size())).trimmed();
+    if (batch_) {
+      batch_->add(std::move(line));
+      return;
+    }
+    QMetaObject::invokeMethod(qt_object_, meta_method_.c_str(), Qt::AutoConnection, Q_ARG(QString, line));
   }
 
-  void flush_() override {}
+  // deliver the pending lines without waiting for the end of the batch interval
+  void flush_() override {
+    if (batch_) {
+      batch_->post(true);
+    }
+  }
 
 private:
+  // the pending lines, shared with the calls posted to the Qt object's thread (which may run
+  // after the sink is destroyed)
+  struct batch_state : std::enable_shared_from_this<batch_state> {
+    using clock = std::chrono::steady_clock;
+
+    std::mutex mutex;
+    QStringList lines;
+    size_t dropped = 0;
+    bool posted = false;
+    bool flush_requested = false;
+    clock::time_point last_delivery;
+    QPointer<QObject> qt_object;
+    std::string meta_method;
+    std::chrono::milliseconds interval{0};
+    size_t max_lines = 0;
+
+    void add(QString line) {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (static_cast<size_t>(lines.size()) >= max_lines) {
+          lines.removeFirst();
+          dropped++;
+        }
+        lines.append(std::move(line));
+        if (posted) {
+          return;
+        }
+        posted = true;
+      }
+      post_delivery_();
+    }
+
+    void post(bool flush) {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        flush_requested = flush_requested || flush;
+        if (posted || lines.isEmpty()) {
+          return;
+        }
+        posted = true;
+      }
+      post_delivery_();
+    }
+
+    void post_delivery_() {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
+      QObject *target = qt_object;
+      if (target == nullptr) {
+        return;
+      }
+      auto self = this->shared_from_this();
+      QMetaObject::invokeMethod(target, [self] { self->deliver_(); }, Qt::QueuedConnection);
+#endif
+    }
+
+    // in the Qt object's thread: invoke meta_method for the pending lines, or wait for the end
+    // of the batch interval
+    void deliver_() {
+      QObject *target = qt_object;
+      if (target == nullptr) {
+        return;
+      }
+      QStringList batch;
+      size_t batch_dropped = 0;
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto now = clock::now();
+        auto next_delivery = last_delivery + interval;
+        if (!flush_requested && now < next_delivery) {
+          auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(next_delivery - now) + std::chrono::milliseconds(1);
+          auto self = this->shared_from_this();
+          QTimer::singleShot(static_cast<int>(remaining.count()), target, [self] { self->deliver_(); });
+          return;
+        }
+        batch.swap(lines);
+        batch_dropped = dropped;
+        dropped = 0;
+        posted = false;
+        flush_requested = false;
+        last_delivery = now;
+      }
+      if (batch_dropped > 0) {
+        batch.prepend(QString("[%1 lines dropped]").arg(static_cast<qulonglong>(batch_dropped)));
+      }
+      QMetaObject::invokeMethod(target, meta_method.c_str(), Qt::DirectConnection, Q_ARG(QString, batch.join('\n')));
+    }
+  };
+
   QObject *qt_object_ = nullptr;
   std::string meta_method_;
+  std::shared_ptr<batch_state> batch_;
 };
 
 #include "spdlog/details/null_mutex.h"
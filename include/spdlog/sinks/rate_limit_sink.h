@@ -0,0 +1,144 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include "dist_sink.h"
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/details/log_msg.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <unordered_map>
+
+// Rate limiting sink.
+// Forward the messages to its sinks while the token bucket of their logger, level or call site (see rate_limit_key)
+// has tokens: each bucket holds up to "burst" tokens, refilled at "rate" tokens per second, and a message takes one.
+// The other messages are dropped before being formatted by the sub sinks, and counted: the next message let
+// through the same bucket is preceded by a "Dropped N messages.." message.
+//
+// To drop a message before it is formatted at all (or its arguments are evaluated), throttle the call site instead:
+// SPDLOG_INFO_EVERY_N(n, ..) / SPDLOG_INFO_EVERY_MS(ms, ..).
+//
+// Example:
+//
+//     #include <spdlog/sinks/rate_limit_sink.h>
+//
+//     int main() {
+//         // 10 messages per second per call site, bursts of 100
+//         auto rate_limit = std::make_shared<rate_limit_sink_mt>(10.0, 100, rate_limit_key::source);
+//         rate_limit->add_sink(std::make_shared<stdout_color_sink_mt>());
+//         spdlog::logger l("logger", rate_limit);
+//         for (;;) {
+//             SPDLOG_LOGGER_INFO(&l, "Hello");
+//         }
+//     }
+
+namespace spdlog {
+namespace sinks {
+
+enum class rate_limit_key
+{
+    logger, // one bucket per logger name
+    level,  // one bucket per level
+    source  // one bucket per call site (source file and line, all the messages without one share a bucket)
+};
+
+template<typename Mutex>
+class rate_limit_sink : public dist_sink<Mutex>
+{
+public:
+    rate_limit_sink(double rate, size_t burst, rate_limit_key key = rate_limit_key::logger)
+        : rate_{rate}
+        , burst_{static_cast<double>((std::max)(burst, size_t(1)))}
+        , key_{key}
+    {}
+
+    // number of messages dropped so far
+    size_t dropped_messages()
+    {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        return dropped_total_;
+    }
+
+protected:
+    struct bucket
+    {
+        double tokens;
+        log_clock::time_point last_refill;
+        size_t dropped;
+    };
+
+    double rate_;
+    double burst_;
+    rate_limit_key key_;
+    std::unordered_map<uint64_t, bucket> buckets_;
+    size_t dropped_total_ = 0;
+
+    void sink_it_(const details::log_msg &msg) override
+    {
+        auto inserted = buckets_.emplace(key_of_(msg), bucket{burst_, msg.time, 0});
+        auto &b = inserted.first->second;
+        if (!inserted.second && msg.time > b.last_refill)
+        {
+            auto elapsed = std::chrono::duration<double>(msg.time - b.last_refill).count();
+            b.tokens = (std::min)(burst_, b.tokens + elapsed * rate_);
+            b.last_refill = msg.time;
+        }
+        if (b.tokens < 1.0)
+        {
+            b.dropped++;
+            dropped_total_++;
+            return;
+        }
+        b.tokens -= 1.0;
+
+        // log the "dropped.." message
+        if (b.dropped > 0)
+        {
+            char buf[64];
+            auto msg_size = ::snprintf(buf, sizeof(buf), "Dropped %u messages..", static_cast<unsigned>(b.dropped));
+            if (msg_size > 0 && static_cast<size_t>(msg_size) < sizeof(buf))
+            {
+                details::log_msg dropped_msg{msg.source, msg.logger_name, msg.level, string_view_t{buf, static_cast<size_t>(msg_size)}};
+                dropped_msg.time = msg.time;
+                dist_sink<Mutex>::sink_it_(dropped_msg);
+            }
+            b.dropped = 0;
+        }
+        dist_sink<Mutex>::sink_it_(msg);
+    }
+
+    uint64_t key_of_(const details::log_msg &msg) const
+    {
+        switch (key_)
+        {
+        case rate_limit_key::level:
+            return static_cast<uint64_t>(msg.level);
+        case rate_limit_key::source:
+            return msg.source.empty() ? 0 : hash_(msg.source.filename, static_cast<uint64_t>(msg.source.line));
+        default:
+            return hash_(msg.logger_name, 0);
+        }
+    }
+
+    // 64 bits FNV-1a of text then seed
+    static uint64_t hash_(string_view_t text, uint64_t seed)
+    {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (auto c : text)
+        {
+            hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3ULL;
+        }
+        return (hash ^ seed) * 0x100000001b3ULL;
+    }
+};
+
+using rate_limit_sink_mt = rate_limit_sink<std::mutex>;
+using rate_limit_sink_st = rate_limit_sink<details::null_mutex>;
+
+} // namespace sinks
+} // namespace spdlog
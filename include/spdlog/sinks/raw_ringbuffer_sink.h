@@ -0,0 +1,121 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <spdlog/details/msg_ring.h>
+#include <spdlog/details/scoped_buffer.h>
+#include <spdlog/details/synchronous_factory.h>
+#include <spdlog/pattern_formatter.h>
+#include <spdlog/sinks/sink.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace spdlog {
+namespace sinks {
+/*
+ * Ring buffer of the last raw messages, e.g. for an in process debug endpoint (see details/msg_ring.h).
+ * The messages are kept unformatted, as compact records in a byte ring of the given capacity, and
+ * written without a lock from any number of threads. They are formatted only when read, one at a time
+ * into the caller's buffer:
+ *
+ *     spdlog::memory_buf_t line;
+ *     sink->for_each_formatted(line, [&](const spdlog::details::log_msg &, spdlog::string_view_t text) {
+ *         response.append(text.data(), text.size());
+ *     });
+ */
+class raw_ringbuffer_sink final : public sink
+{
+public:
+    explicit raw_ringbuffer_sink(size_t capacity, const details::page_options &pages = details::page_options())
+        : ring_(capacity, pages)
+        , formatter_(details::make_unique<pattern_formatter>())
+    {}
+
+    void log(const details::log_msg &msg) override
+    {
+        ring_.write(msg);
+    }
+
+    void flush() override {}
+
+    void set_pattern(const std::string &pattern) override
+    {
+        set_formatter(details::make_unique<pattern_formatter>(pattern));
+    }
+
+    void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override
+    {
+        std::lock_guard<std::mutex> lock(formatter_mutex_);
+        formatter_ = std::move(sink_formatter);
+    }
+
+    // call visitor(const details::log_msg &) with the kept messages, oldest first. the messages logged
+    // meanwhile are not visited. their strings are valid during the call only. return the number visited.
+    template<typename Visitor>
+    size_t for_each(Visitor &&visitor) const
+    {
+        details::scoped_buffer scoped_storage;
+        auto &storage = scoped_storage.get();
+        auto end = ring_.write_position();
+        size_t n = 0;
+        details::log_msg msg;
+        for (auto pos = ring_.oldest_position(); ring_.read(pos, end, storage, msg); n++)
+        {
+            visitor(static_cast<const details::log_msg &>(msg));
+        }
+        return n;
+    }
+
+    // same, calling visitor(const details::log_msg &, string_view_t formatted) with each message
+    // formatted into dest (cleared first)
+    template<typename Visitor>
+    size_t for_each_formatted(memory_buf_t &dest, Visitor &&visitor)
+    {
+        std::lock_guard<std::mutex> lock(formatter_mutex_);
+        return for_each([&](const details::log_msg &msg) {
+            dest.clear();
+            format_with_(*formatter_, msg, dest);
+            visitor(msg, string_view_t(dest.data(), dest.size()));
+        });
+    }
+
+    // the last lim formatted messages (all if 0) - allocates a string per message
+    std::vector<std::string> last_formatted(size_t lim = 0)
+    {
+        std::vector<std::string> ret;
+        memory_buf_t formatted;
+        for_each_formatted(formatted, [&](const details::log_msg &, string_view_t text) { ret.emplace_back(text.data(), text.size()); });
+        if (lim > 0 && ret.size() > lim)
+        {
+            ret.erase(ret.begin(), ret.end() - static_cast<std::ptrdiff_t>(lim));
+        }
+        return ret;
+    }
+
+    const details::msg_ring &ring() const
+    {
+        return ring_;
+    }
+
+private:
+    details::msg_ring ring_;
+    std::mutex formatter_mutex_; // the readers only
+    std::unique_ptr<spdlog::formatter> formatter_;
+};
+
+} // namespace sinks
+
+//
+// factory functions
+//
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> raw_ringbuffer_logger(const std::string &logger_name, size_t capacity)
+{
+    return Factory::template create<sinks::raw_ringbuffer_sink>(logger_name, capacity);
+}
+
+} // namespace spdlog
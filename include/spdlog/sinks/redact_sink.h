@@ -0,0 +1,153 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include "dist_sink.h"
+#include <spdlog/details/log_msg.h>
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/details/redactor.h>
+
+#include <mutex>
+#include <vector>
+
+// Redaction sink.
+// Mask the personal data (card numbers, emails, tokens - see details/redactor.h) of the messages before
+// forwarding them to its sinks: the payload and the string values of the structured and mdc fields are
+// copied to buffers kept by the sink and masked there, in place. The sub sinks format the masked text -
+// whatever their formatter. The messages with nothing to mask are forwarded as they are.
+//
+// Behind an async logger (or async_sink) the redaction runs on the worker threads, not the logging ones.
+//
+// Example:
+//
+//     #include <spdlog/sinks/redact_sink.h>
+//
+//     int main() {
+//         auto redact = std::make_shared<redact_sink_mt>();
+//         redact->add_sink(std::make_shared<stdout_color_sink_mt>());
+//         spdlog::logger l("logger", redact);
+//         l.info("paid with 4111 1111 1111 1111 by john@example.com");
+//     }
+//
+// Will produce:
+//       [2019-06-25 17:50:56.511] [logger] [info] paid with **** **** **** 1111 by ****@***********
+
+namespace spdlog {
+namespace sinks {
+
+template<typename Mutex>
+class redact_sink : public dist_sink<Mutex>
+{
+public:
+    explicit redact_sink(const details::redact_options &options = details::redact_options())
+        : redactor_(options)
+    {}
+
+    explicit redact_sink(std::vector<std::shared_ptr<sink>> sinks, const details::redact_options &options = details::redact_options())
+        : dist_sink<Mutex>(std::move(sinks))
+        , redactor_(options)
+    {}
+
+    // number of messages masked so far
+    size_t redacted_messages()
+    {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        return redacted_;
+    }
+
+protected:
+    details::redactor redactor_;
+    size_t redacted_ = 0;
+    // reused from a message to the next (under the lock)
+    memory_buf_t payload_;
+    memory_buf_t values_;
+    std::vector<field> fields_;
+    std::vector<field> mdc_fields_;
+
+    void sink_it_(const details::log_msg &msg) override
+    {
+        payload_.clear();
+        payload_.append(msg.payload.begin(), msg.payload.end());
+        bool payload_masked = redactor_.redact(payload_.data(), payload_.size()) > 0;
+
+        // the field values first: values_ doesn't grow once the masked fields point into it
+        values_.clear();
+        bool fields_masked = redact_values_(msg.fields, msg.n_fields);
+        bool mdc_masked = redact_values_(msg.mdc_fields, msg.n_mdc_fields);
+        if (!payload_masked && !fields_masked && !mdc_masked)
+        {
+            dist_sink<Mutex>::sink_it_(msg);
+            return;
+        }
+
+        auto redacted = msg;
+        if (payload_masked)
+        {
+            redacted.payload = string_view_t(payload_.data(), payload_.size());
+            redacted.payload_id = 0;
+        }
+        size_t offset = 0;
+        if (fields_masked)
+        {
+            redacted.fields = masked_fields_(msg.fields, msg.n_fields, fields_, offset);
+        }
+        else
+        {
+            offset += values_size_(msg.fields, msg.n_fields);
+        }
+        if (mdc_masked)
+        {
+            redacted.mdc_fields = masked_fields_(msg.mdc_fields, msg.n_mdc_fields, mdc_fields_, offset);
+        }
+        redacted_++;
+        dist_sink<Mutex>::sink_it_(redacted);
+    }
+
+    // append the string values to values_ and mask them. return whether any was masked
+    bool redact_values_(const field *fields, size_t n_fields)
+    {
+        bool masked = false;
+        for (size_t i = 0; i < n_fields; i++)
+        {
+            if (fields[i].type == field::value_type::string)
+            {
+                auto start = values_.size();
+                values_.append(fields[i].string_value.begin(), fields[i].string_value.end());
+                masked |= redactor_.redact(values_.data() + start, fields[i].string_value.size()) > 0;
+            }
+        }
+        return masked;
+    }
+
+    static size_t values_size_(const field *fields, size_t n_fields)
+    {
+        size_t size = 0;
+        for (size_t i = 0; i < n_fields; i++)
+        {
+            size += fields[i].type == field::value_type::string ? fields[i].string_value.size() : 0;
+        }
+        return size;
+    }
+
+    // copies of the fields, their string values pointing into values_ from offset
+    const field *masked_fields_(const field *fields, size_t n_fields, std::vector<field> &dest, size_t &offset)
+    {
+        dest.assign(fields, fields + n_fields);
+        for (auto &f : dest)
+        {
+            if (f.type == field::value_type::string)
+            {
+                f.string_value = string_view_t(values_.data() + offset, f.string_value.size());
+                offset += f.string_value.size();
+            }
+        }
+        return dest.data();
+    }
+};
+
+using redact_sink_mt = redact_sink<std::mutex>;
+using redact_sink_st = redact_sink<details::null_mutex>;
+
+} // namespace sinks
+} // namespace spdlog
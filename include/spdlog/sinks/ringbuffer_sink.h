@@ -6,6 +6,7 @@
 #include "spdlog/sinks/base_sink.h"
 #include "spdlog/details/circular_q.h"
 #include "spdlog/details/log_msg_buffer.h"
+#include "spdlog/details/memory_account.h"
 #include "spdlog/details/null_mutex.h"
 
 #include <mutex>
@@ -16,13 +17,15 @@ namespace spdlog {
 namespace sinks {
 /*
  * Ring buffer sink
+ * (see raw_ringbuffer_sink.h for a lock free one, formatting its messages when read)
  */
 template<typename Mutex>
 class ringbuffer_sink final : public base_sink<Mutex>
 {
 public:
-    explicit ringbuffer_sink(size_t n_items)
-        : q_{n_items}
+    // pages: the storage of the ring (see details/page_memory.h)
+    explicit ringbuffer_sink(size_t n_items, const details::page_options &pages = details::page_options())
+        : q_{n_items, pages}
     {}
 
     std::vector<details::log_msg_buffer> last_raw(size_t lim = 0)
@@ -39,6 +42,12 @@ public:
         return ret;
     }
 
+    // bytes allocated by the stored messages beyond their slots (see details/memory_account.h)
+    size_t memory_used() const
+    {
+        return memory_->used();
+    }
+
     std::vector<std::string> last_formatted(size_t lim = 0)
     {
         std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
@@ -49,7 +58,7 @@ public:
         for (size_t i = (items_available - n_items); i < items_available; i++)
         {
             memory_buf_t formatted;
-            base_sink<Mutex>::formatter_->format(q_.at(i), formatted);
+            base_sink<Mutex>::format_(q_.at(i), formatted);
             ret.push_back(fmt::to_string(formatted));
         }
         return ret;
@@ -58,16 +67,19 @@ public:
 protected:
     void sink_it_(const details::log_msg &msg) override
     {
+        details::memory_scope scope(memory_);
         q_.push_back(details::log_msg_buffer{msg});
     }
     void flush_() override {}
 
 private:
+    std::shared_ptr<details::memory_account> memory_ = std::make_shared<details::memory_account>();
     details::circular_q<details::log_msg_buffer> q_;
 };
 
 using ringbuffer_sink_mt = ringbuffer_sink<std::mutex>;
 using ringbuffer_sink_st = ringbuffer_sink<details::null_mutex>;
+using ringbuffer_sink_spin = ringbuffer_sink<details::spin_mutex>;
 
 } // namespace sinks
 
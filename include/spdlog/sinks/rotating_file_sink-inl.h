@@ -9,9 +9,12 @@
 
 #include <spdlog/common.h>
 
+#include <spdlog/details/file_compression.h>
 #include <spdlog/details/file_helper.h>
 #include <spdlog/details/null_mutex.h>
 #include <spdlog/fmt/fmt.h>
+#include <spdlog/details/fmt_helper.h>
+#include <spdlog/details/scoped_buffer.h>
 
 #include <cerrno>
 #include <chrono>
@@ -19,22 +22,36 @@
 #include <mutex>
 #include <string>
 #include <tuple>
+#include <vector>
 
 namespace spdlog {
 namespace sinks {
 
 template<typename Mutex>
 SPDLOG_INLINE rotating_file_sink<Mutex>::rotating_file_sink(
-    filename_t base_filename, std::size_t max_size, std::size_t max_files, bool rotate_on_open)
+    filename_t base_filename, std::size_t max_size, std::size_t max_files, bool rotate_on_open, std::size_t write_buffer_size,
+    bool drop_page_cache, bool background_rotation, bool compress)
     : base_filename_(std::move(base_filename))
     , max_size_(max_size)
     , max_files_(max_files)
+    , file_helper_(write_buffer_size, drop_page_cache)
+    , compress_(compress)
 {
+    if (compress_ && !details::file_compression::supported())
+    {
+        throw_spdlog_ex("rotating_file_sink: compression requires spdlog built with SPDLOG_ZLIB");
+    }
+    // compression never runs on the logging threads
+    if (background_rotation || compress_)
+    {
+        background_worker_ = details::make_unique<details::background_worker>();
+    }
     file_helper_.open(calc_filename(base_filename_, 0));
     current_size_ = file_helper_.size(); // expensive. called only once
     if (rotate_on_open && current_size_ > 0)
     {
         rotate_();
+        current_size_ = 0;
     }
 }
 
@@ -63,21 +80,116 @@ SPDLOG_INLINE filename_t rotating_file_sink<Mutex>::filename()
 template<typename Mutex>
 SPDLOG_INLINE void rotating_file_sink<Mutex>::sink_it_(const details::log_msg &msg)
 {
-    memory_buf_t formatted;
-    base_sink<Mutex>::formatter_->format(msg, formatted);
-    current_size_ += formatted.size();
-    if (current_size_ > max_size_)
+    details::scoped_buffer formatted_buffer;
+    auto &formatted = formatted_buffer.get();
+    size_t payload_pos;
+    if (base_sink<Mutex>::format_split_(msg, formatted, payload_pos))
     {
-        rotate_();
-        current_size_ = formatted.size();
+        // the large payload is written from the message, not copied into formatted
+        string_view_t parts[] = {string_view_t(formatted.data(), payload_pos), msg.payload,
+            string_view_t(formatted.data() + payload_pos, formatted.size() - payload_pos)};
+        before_write_(msg, formatted.size() + msg.payload.size());
+        file_helper_.write(parts, 3);
+        return;
+    }
+    base_sink<Mutex>::format_(msg, formatted);
+    sink_formatted_(msg, details::fmt_helper::to_string_view(formatted));
+}
+
+template<typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::set_durability(file_durability durability, std::chrono::milliseconds group_commit_interval)
+{
+    std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+    syncer_ = durability == file_durability::group_commit ? std::make_shared<details::file_syncer>(group_commit_interval) : nullptr;
+    file_helper_.set_durability(durability, syncer_);
+}
+
+template<typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::enable_time_index(std::chrono::seconds interval, size_t bytes_interval)
+{
+    std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+    time_index_ = details::make_unique<details::time_index>(interval, bytes_interval);
+    time_index_->open(base_filename_, current_size_);
+}
+
+template<typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::set_compression(size_t frame_size)
+{
+    std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+    if (compress_ && frame_size > 0)
+    {
+        throw_spdlog_ex("rotating_file_sink: the files are compressed on rotation already");
+    }
+    file_helper_.set_compression(frame_size);
+}
+
+template<typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::set_max_total_size(size_t max_total_size)
+{
+    std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+    if (background_worker_)
+    {
+        background_worker_->wait_idle();
     }
+    retention_ = details::make_unique<details::size_retention>(max_total_size);
+    for (std::size_t i = 1; i <= max_files_; i++)
+    {
+        auto filename = rotated_filename_(i);
+        if (!details::os::path_exists(filename))
+        {
+            break;
+        }
+        retention_->add_oldest(details::os::path_size(filename));
+    }
+    remove_excess_();
+}
+
+template<typename Mutex>
+SPDLOG_INLINE unsigned rotating_file_sink<Mutex>::required_fields() const
+{
+    return this->formatter_fields_.load(std::memory_order_relaxed);
+}
+
+template<typename Mutex>
+SPDLOG_INLINE bool rotating_file_sink<Mutex>::accepts_formatted_() const
+{
+    return true;
+}
+
+template<typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::sink_formatted_(const details::log_msg &msg, string_view_t formatted)
+{
+    before_write_(msg, formatted.size());
     file_helper_.write(formatted);
 }
 
+template<typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::before_write_(const details::log_msg &msg, size_t size)
+{
+    if (current_size_ + size > max_size_)
+    {
+        rotate_();
+        current_size_ = 0;
+    }
+    current_size_ += size;
+    if (time_index_)
+    {
+        time_index_->add(msg.time, size);
+    }
+}
+
 template<typename Mutex>
 SPDLOG_INLINE void rotating_file_sink<Mutex>::flush_()
 {
     file_helper_.flush();
+    if (background_worker_)
+    {
+        auto error = background_worker_->take_error();
+        if (!error.empty())
+        {
+            throw_spdlog_ex(error);
+        }
+    }
 }
 
 // Rotate files:
@@ -85,20 +197,112 @@ SPDLOG_INLINE void rotating_file_sink<Mutex>::flush_()
 // log.1.txt -> log.2.txt
 // log.2.txt -> log.3.txt
 // log.3.txt -> delete
+template<typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::after_flush_()
+{
+    if (syncer_)
+    {
+        syncer_->wait();
+    }
+}
+
 template<typename Mutex>
 SPDLOG_INLINE void rotating_file_sink<Mutex>::rotate_()
 {
     using details::os::filename_to_str;
-    using details::os::path_exists;
+    auto rotated_size = current_size_;
     file_helper_.close();
+    if (file_helper_.compression_frame_size() > 0)
+    {
+        rotated_size = details::os::path_size(base_filename_); // on disk
+    }
+    if (time_index_)
+    {
+        // moved with the file, reopened for the new one
+        time_index_->close();
+    }
+    auto reopen_time_index = [this] {
+        if (time_index_)
+        {
+            time_index_->open(base_filename_, 0);
+        }
+    };
+    if (!background_worker_)
+    {
+        filename_t failed_src, failed_target;
+        if (!shift_files_(base_filename_, failed_src, failed_target))
+        {
+            file_helper_.reopen(true); // truncate the log file anyway to prevent it to grow beyond its limit!
+            current_size_ = 0;
+            reopen_time_index();
+            throw_spdlog_ex(
+                "rotating_file_sink: failed renaming " + filename_to_str(failed_src) + " to " + filename_to_str(failed_target), errno);
+        }
+        file_helper_.reopen(true);
+        reopen_time_index();
+        retain_rotated_(rotated_size);
+        return;
+    }
+
+    // log.txt -> log.rotating-N.txt here, the rest in the background
+    filename_t basename, ext;
+    std::tie(basename, ext) = details::file_helper::split_by_extension(base_filename_);
+    auto rotated = fmt::format(SPDLOG_FILENAME_T("{}.rotating-{}{}"), basename, ++rotation_seq_, ext);
+    bool renamed = rename_file_(base_filename_, rotated);
+    file_helper_.reopen_in_background(true); // truncated anyway if it couldn't be renamed
+    reopen_time_index();
+    if (!renamed)
+    {
+        throw_spdlog_ex(
+            "rotating_file_sink: failed renaming " + filename_to_str(base_filename_) + " to " + filename_to_str(rotated), errno);
+    }
+    background_worker_->post([this, rotated, rotated_size] {
+        auto first_filename = rotated;
+        if (compress_)
+        {
+            if (max_files_ == 0)
+            {
+                (void)details::os::remove(rotated);
+                details::file_helper::remove_sidecars(rotated);
+                return;
+            }
+            details::file_compression::compress_file(rotated);
+            first_filename = details::file_compression::compressed_filename(rotated);
+            details::file_helper::rename_sidecars(rotated, first_filename);
+        }
+        filename_t failed_src, failed_target;
+        if (!shift_files_(first_filename, failed_src, failed_target))
+        {
+            auto last_errno = errno;
+            (void)details::os::remove(first_filename);
+            details::file_helper::remove_sidecars(first_filename);
+            throw_spdlog_ex(
+                "rotating_file_sink: failed renaming " + filename_to_str(failed_src) + " to " + filename_to_str(failed_target), last_errno);
+        }
+        retain_rotated_(compress_ ? details::os::path_size(rotated_filename_(1)) : rotated_size);
+    });
+
+    // report the failures of the previous rotations
+    auto error = background_worker_->take_error();
+    if (!error.empty())
+    {
+        throw_spdlog_ex(error);
+    }
+}
+
+template<typename Mutex>
+SPDLOG_INLINE bool rotating_file_sink<Mutex>::shift_files_(
+    const filename_t &first_filename, filename_t &failed_src, filename_t &failed_target)
+{
+    using details::os::path_exists;
     for (auto i = max_files_; i > 0; --i)
     {
-        filename_t src = calc_filename(base_filename_, i - 1);
+        filename_t src = i == 1 ? first_filename : rotated_filename_(i - 1);
         if (!path_exists(src))
         {
             continue;
         }
-        filename_t target = calc_filename(base_filename_, i);
+        filename_t target = rotated_filename_(i);
 
         if (!rename_file_(src, target))
         {
@@ -108,13 +312,55 @@ SPDLOG_INLINE void rotating_file_sink<Mutex>::rotate_()
             details::os::sleep_for_millis(100);
             if (!rename_file_(src, target))
             {
-                file_helper_.reopen(true); // truncate the log file anyway to prevent it to grow beyond its limit!
-                current_size_ = 0;
-                throw_spdlog_ex("rotating_file_sink: failed renaming " + filename_to_str(src) + " to " + filename_to_str(target), errno);
+                failed_src = std::move(src);
+                failed_target = std::move(target);
+                return false;
             }
         }
     }
-    file_helper_.reopen(true);
+    if (max_files_ == 0 && first_filename != base_filename_)
+    {
+        // no rotated files are kept
+        (void)details::os::remove(first_filename);
+        details::file_helper::remove_sidecars(first_filename);
+    }
+    return true;
+}
+
+template<typename Mutex>
+SPDLOG_INLINE filename_t rotating_file_sink<Mutex>::rotated_filename_(std::size_t index) const
+{
+    auto filename = calc_filename(base_filename_, index);
+    return compress_ ? details::file_compression::compressed_filename(filename) : filename;
+}
+
+template<typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::retain_rotated_(size_t size)
+{
+    if (!retention_ || max_files_ == 0)
+    {
+        return;
+    }
+    retention_->add_newest(size);
+    retention_->keep_newest(max_files_);
+    remove_excess_();
+}
+
+// the rotated files are tracked by index: the oldest ones are the last
+template<typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::remove_excess_()
+{
+    std::vector<filename_t> excess;
+    auto kept = retention_->take_excess(excess);
+    for (std::size_t i = kept + 1; i <= kept + excess.size(); i++)
+    {
+        auto filename = rotated_filename_(i);
+        details::file_helper::remove_sidecars(filename);
+        if (details::os::remove_if_exists(filename) != 0)
+        {
+            throw_spdlog_ex("rotating_file_sink: failed removing " + details::os::filename_to_str(filename), errno);
+        }
+    }
 }
 
 // delete the target if exists, and rename the src file  to target
@@ -124,7 +370,12 @@ SPDLOG_INLINE bool rotating_file_sink<Mutex>::rename_file_(const filename_t &src
 {
     // try to delete the target file in case it already exists.
     (void)details::os::remove(target_filename);
-    return details::os::rename(src_filename, target_filename) == 0;
+    if (details::os::rename(src_filename, target_filename) != 0)
+    {
+        return false;
+    }
+    details::file_helper::rename_sidecars(src_filename, target_filename);
+    return true;
 }
 
 } // namespace sinks
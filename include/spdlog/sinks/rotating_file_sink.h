@@ -4,11 +4,17 @@
 #pragma once
 
 #include <spdlog/sinks/base_sink.h>
+#include <spdlog/details/background_worker.h>
 #include <spdlog/details/file_helper.h>
+#include <spdlog/details/file_syncer.h>
+#include <spdlog/details/size_retention.h>
+#include <spdlog/details/frame_compressor.h>
+#include <spdlog/details/time_index.h>
 #include <spdlog/details/null_mutex.h>
 #include <spdlog/details/synchronous_factory.h>
 
 #include <chrono>
+#include <memory>
 #include <mutex>
 #include <string>
 
@@ -18,17 +24,42 @@ namespace sinks {
 //
 // Rotating file sink based on size
 //
+// With background_rotation, rotating only renames the current file to a temporary name
+// (log.rotating-N.txt): the new file is opened, and the renaming of the rotated files (below) is done,
+// by background threads, so the logging threads don't wait for them (see file_helper::open_in_background()).
+// Their errors are reported on the next rotation or flush.
+// With compress (SPDLOG_ZLIB), the rotated files are gzipped by the background thread too
+// (log.1.txt.gz, log.2.txt.gz ..).
+//
 template<typename Mutex>
 class rotating_file_sink final : public base_sink<Mutex>
 {
 public:
-    rotating_file_sink(filename_t base_filename, std::size_t max_size, std::size_t max_files, bool rotate_on_open = false);
+    rotating_file_sink(
+        filename_t base_filename, std::size_t max_size, std::size_t max_files, bool rotate_on_open = false,
+        std::size_t write_buffer_size = 0, bool drop_page_cache = false, bool background_rotation = false, bool compress = false);
     static filename_t calc_filename(const filename_t &filename, std::size_t index);
     filename_t filename();
+    // what flush() guarantees (see file_durability) - set it before logging. with group_commit, the concurrent
+    // flushes wait for one sync of the file per group_commit_interval.
+    void set_durability(file_durability durability, std::chrono::milliseconds group_commit_interval = std::chrono::milliseconds(10));
+    // write a time index of the files (see details/time_index.h): an entry per interval and per bytes_interval
+    void enable_time_index(std::chrono::seconds interval, size_t bytes_interval = 1024 * 1024);
+    // delete the oldest rotated files once they total more than max_total_size bytes (on disk - compressed),
+    // besides max_files. the existing files are scanned now, the sizes of the next ones are tracked.
+    void set_max_total_size(size_t max_total_size);
+    // compress the files as they are written, in independent frames of frame_size bytes (see
+    // details/frame_compressor.h), 0 to stop. max_size counts the uncompressed data. exclusive with compress.
+    void set_compression(size_t frame_size = details::frame_compressor::default_frame_size);
+    // the fields read by the formatter
+    unsigned required_fields() const override;
 
 protected:
     void sink_it_(const details::log_msg &msg) override;
+    bool accepts_formatted_() const override;
+    void sink_formatted_(const details::log_msg &msg, string_view_t formatted) override;
     void flush_() override;
+    void after_flush_() override;
 
 private:
     // Rotate files:
@@ -38,19 +69,50 @@ private:
     // log.3.txt -> delete
     void rotate_();
 
+    // rotate if size more bytes don't fit in the file, and count them
+    void before_write_(const details::log_msg &msg, size_t size);
+
+    // rename log.(i - 1) -> log.i for i = max_files..1, with first_filename as log.0.
+    // return true on success, false otherwise (with the names that failed).
+    bool shift_files_(const filename_t &first_filename, filename_t &failed_src, filename_t &failed_target);
+
+    // calc_filename(), compressed if compress_
+    filename_t rotated_filename_(std::size_t index) const;
+
     // delete the target if exists, and rename the src file  to target
     // return true on success, false otherwise.
     bool rename_file_(const filename_t &src_filename, const filename_t &target_filename);
 
+    // track the file rotated to index 1 and delete the files over the retention budget
+    void retain_rotated_(size_t size);
+    void remove_excess_();
+
     filename_t base_filename_;
     std::size_t max_size_;
     std::size_t max_files_;
     std::size_t current_size_;
     details::file_helper file_helper_;
+    std::shared_ptr<details::file_syncer> syncer_;
+    std::unique_ptr<details::time_index> time_index_;
+    // by the rotating thread: the sink one, or the background worker if any
+    std::unique_ptr<details::size_retention> retention_;
+    bool compress_;
+    std::size_t rotation_seq_{0};
+    // last - runs the rotations left before the members they use are destroyed
+    std::unique_ptr<details::background_worker> background_worker_;
 };
 
 using rotating_file_sink_mt = rotating_file_sink<std::mutex>;
 using rotating_file_sink_st = rotating_file_sink<details::null_mutex>;
+using rotating_file_sink_spin = rotating_file_sink<details::spin_mutex>;
+
+#ifdef SPDLOG_COMPILED_LIB
+// instantiated in src/file_sinks.cpp
+extern template class SPDLOG_API rotating_file_sink<std::mutex>;
+extern template class SPDLOG_API rotating_file_sink<details::null_mutex>;
+extern template class SPDLOG_API rotating_file_sink<details::spin_mutex>;
+extern template class SPDLOG_API rotating_file_sink<details::adaptive_mutex>;
+#endif
 
 } // namespace sinks
 
@@ -60,16 +122,20 @@ using rotating_file_sink_st = rotating_file_sink<details::null_mutex>;
 
 template<typename Factory = spdlog::synchronous_factory>
 inline std::shared_ptr<logger> rotating_logger_mt(
-    const std::string &logger_name, const filename_t &filename, size_t max_file_size, size_t max_files, bool rotate_on_open = false)
+    const std::string &logger_name, const filename_t &filename, size_t max_file_size, size_t max_files, bool rotate_on_open = false,
+    size_t write_buffer_size = 0, bool drop_page_cache = false, bool background_rotation = false, bool compress = false)
 {
-    return Factory::template create<sinks::rotating_file_sink_mt>(logger_name, filename, max_file_size, max_files, rotate_on_open);
+    return Factory::template create<sinks::rotating_file_sink_mt>(
+        logger_name, filename, max_file_size, max_files, rotate_on_open, write_buffer_size, drop_page_cache, background_rotation, compress);
 }
 
 template<typename Factory = spdlog::synchronous_factory>
 inline std::shared_ptr<logger> rotating_logger_st(
-    const std::string &logger_name, const filename_t &filename, size_t max_file_size, size_t max_files, bool rotate_on_open = false)
+    const std::string &logger_name, const filename_t &filename, size_t max_file_size, size_t max_files, bool rotate_on_open = false,
+    size_t write_buffer_size = 0, bool drop_page_cache = false, bool background_rotation = false, bool compress = false)
 {
-    return Factory::template create<sinks::rotating_file_sink_st>(logger_name, filename, max_file_size, max_files, rotate_on_open);
+    return Factory::template create<sinks::rotating_file_sink_st>(
+        logger_name, filename, max_file_size, max_files, rotate_on_open, write_buffer_size, drop_page_cache, background_rotation, compress);
 }
 } // namespace spdlog
 
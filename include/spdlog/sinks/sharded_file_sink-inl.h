@@ -0,0 +1,237 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#    include <spdlog/sinks/sharded_file_sink.h>
+#endif
+
+#include <spdlog/common.h>
+#include <spdlog/pattern_formatter.h>
+#include <spdlog/details/os.h>
+#include <spdlog/details/fmt_helper.h>
+#include <spdlog/details/scoped_buffer.h>
+
+#include <cstdio>
+#include <cstring>
+#include <tuple>
+
+namespace spdlog {
+namespace details {
+// a shard read by sharded_file_sink::merge(), a message ahead
+struct shard_reader
+{
+    std::FILE *fd = nullptr;
+    char first_char = 0;   // the first char of the file: starts each message
+    std::string entry;     // the next message to merge (its lines), empty at the end of the file
+    std::string next_line; // read ahead: the first line of the message after entry
+    bool has_next = false;
+
+    shard_reader() = default;
+    shard_reader(const shard_reader &) = delete;
+    shard_reader &operator=(const shard_reader &) = delete;
+
+    ~shard_reader()
+    {
+        if (fd != nullptr)
+        {
+            std::fclose(fd);
+        }
+    }
+
+    void open(const filename_t &filename)
+    {
+        if (os::fopen_s(&fd, filename, SPDLOG_FILENAME_T("rb")))
+        {
+            throw_spdlog_ex("sharded_file_sink: failed opening " + os::filename_to_str(filename), errno);
+        }
+        has_next = read_line_(fd, next_line);
+        first_char = has_next ? next_line[0] : '\0';
+        advance();
+    }
+
+    void advance()
+    {
+        entry.clear();
+        if (!has_next)
+        {
+            return;
+        }
+        entry.swap(next_line);
+        while ((has_next = read_line_(fd, next_line)) && next_line[0] != first_char)
+        {
+            entry += next_line;
+        }
+    }
+
+    // read a line, with its '\n' if any. return false at the end of the file
+    static bool read_line_(std::FILE *fd, std::string &line)
+    {
+        line.clear();
+        char chunk[4096];
+        while (std::fgets(chunk, sizeof(chunk), fd) != nullptr)
+        {
+            auto len = std::strlen(chunk);
+            line.append(chunk, len);
+            if (len > 0 && chunk[len - 1] == '\n')
+            {
+                break;
+            }
+        }
+        return !line.empty();
+    }
+};
+} // namespace details
+
+namespace sinks {
+
+SPDLOG_INLINE sharded_file_sink::sharded_file_sink(filename_t base_filename, bool truncate, size_t write_buffer_size)
+    : base_filename_(std::move(base_filename))
+    , truncate_(truncate)
+    , write_buffer_size_(write_buffer_size)
+    , id_(next_sink_id_())
+    , formatter_(details::make_unique<spdlog::pattern_formatter>())
+{
+    formatter_fields_.store(formatter_->required_fields(), std::memory_order_relaxed);
+}
+
+SPDLOG_INLINE void sharded_file_sink::log(const details::log_msg &msg)
+{
+    auto &s = thread_shard_();
+    details::scoped_buffer formatted_buffer;
+    auto &formatted = formatted_buffer.get();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    format_with_(*s.formatter, msg, formatted);
+    s.file.write(formatted);
+}
+
+SPDLOG_INLINE void sharded_file_sink::flush()
+{
+    std::lock_guard<std::mutex> lock(shards_mutex_);
+    for (auto &s : shards_)
+    {
+        std::lock_guard<std::mutex> shard_lock(s->mutex);
+        s->file.flush();
+    }
+}
+
+SPDLOG_INLINE void sharded_file_sink::set_pattern(const std::string &pattern)
+{
+    set_formatter(details::make_unique<spdlog::pattern_formatter>(pattern));
+}
+
+SPDLOG_INLINE void sharded_file_sink::set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter)
+{
+    std::lock_guard<std::mutex> lock(shards_mutex_);
+    formatter_ = std::move(sink_formatter);
+    formatter_fields_.store(formatter_->required_fields(), std::memory_order_relaxed);
+    for (auto &s : shards_)
+    {
+        std::lock_guard<std::mutex> shard_lock(s->mutex);
+        s->formatter = formatter_->clone();
+    }
+}
+
+SPDLOG_INLINE unsigned sharded_file_sink::required_fields() const
+{
+    return formatter_fields_.load(std::memory_order_relaxed);
+}
+
+SPDLOG_INLINE const filename_t &sharded_file_sink::base_filename() const
+{
+    return base_filename_;
+}
+
+SPDLOG_INLINE std::vector<filename_t> sharded_file_sink::shard_filenames() const
+{
+    std::lock_guard<std::mutex> lock(shards_mutex_);
+    std::vector<filename_t> filenames;
+    filenames.reserve(shards_.size());
+    for (auto &s : shards_)
+    {
+        filenames.push_back(s->file.filename());
+    }
+    return filenames;
+}
+
+SPDLOG_INLINE filename_t sharded_file_sink::shard_filename(const filename_t &base_filename, size_t thread_id)
+{
+    filename_t basename, ext;
+    std::tie(basename, ext) = details::file_helper::split_by_extension(base_filename);
+    return fmt::format(SPDLOG_FILENAME_T("{}.{}{}"), basename, thread_id, ext);
+}
+
+SPDLOG_INLINE void sharded_file_sink::merge(const std::vector<filename_t> &shards, const filename_t &dest)
+{
+    std::vector<std::unique_ptr<details::shard_reader>> inputs;
+    inputs.reserve(shards.size());
+    for (auto &shard_filename : shards)
+    {
+        inputs.push_back(details::make_unique<details::shard_reader>());
+        inputs.back()->open(shard_filename);
+    }
+
+    details::file_helper out;
+    out.open(dest, true);
+    for (;;)
+    {
+        // a few shards (one per thread): a linear scan for the smallest beats a heap
+        details::shard_reader *next = nullptr;
+        for (auto &input : inputs)
+        {
+            if (!input->entry.empty() && (next == nullptr || input->entry < next->entry))
+            {
+                next = input.get();
+            }
+        }
+        if (next == nullptr)
+        {
+            break;
+        }
+        out.write(string_view_t(next->entry));
+        next->advance();
+    }
+    out.flush();
+}
+
+SPDLOG_INLINE sharded_file_sink::shard &sharded_file_sink::thread_shard_()
+{
+#ifndef SPDLOG_NO_TLS
+    struct shard_cache
+    {
+        size_t sink_id;
+        shard *cached_shard;
+    };
+    static thread_local shard_cache cache{0, nullptr};
+    if (cache.sink_id == id_)
+    {
+        return *cache.cached_shard;
+    }
+#endif
+    std::lock_guard<std::mutex> lock(shards_mutex_);
+    auto thread_id = details::os::thread_id();
+    auto &s = shards_by_thread_[thread_id];
+    if (s == nullptr)
+    {
+        auto new_shard = details::make_unique<shard>(write_buffer_size_);
+        new_shard->file.open(shard_filename(base_filename_, thread_id), truncate_);
+        new_shard->formatter = formatter_->clone();
+        shards_.push_back(std::move(new_shard));
+        s = shards_.back().get();
+    }
+#ifndef SPDLOG_NO_TLS
+    cache.sink_id = id_;
+    cache.cached_shard = s;
+#endif
+    return *s;
+}
+
+SPDLOG_INLINE size_t sharded_file_sink::next_sink_id_()
+{
+    static std::atomic<size_t> counter{0};
+    return ++counter;
+}
+
+} // namespace sinks
+} // namespace spdlog
@@ -0,0 +1,98 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <spdlog/details/file_helper.h>
+#include <spdlog/details/synchronous_factory.h>
+#include <spdlog/sinks/sink.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace spdlog {
+namespace sinks {
+/*
+ * File sink with a file per logging thread: "logs/app.log" => "logs/app.<thread id>.log", opened by the first
+ * message of the thread. Each thread formats its messages with its own clone of the formatter and writes them
+ * to its own file: the threads share no lock, the throughput grows with the number of threads logging.
+ * A thread finds its shard through a thread local cache (as the lanes of spsc_lanes_q); the mutex of the shard is
+ * only taken by another thread to flush it or change its formatter.
+ *
+ * merge() (or the spdlog-merge tool) interleaves the shards into a single log, by the text of their lines: the
+ * pattern must start with a timestamp sorting as text, e.g. the default "[%Y-%m-%d %H:%M:%S.%e] ...".
+ */
+class SPDLOG_API sharded_file_sink final : public sink
+{
+public:
+    explicit sharded_file_sink(filename_t base_filename, bool truncate = false, size_t write_buffer_size = 0);
+    sharded_file_sink(const sharded_file_sink &) = delete;
+    sharded_file_sink &operator=(const sharded_file_sink &) = delete;
+
+    void log(const details::log_msg &msg) override;
+    void flush() override;
+    void set_pattern(const std::string &pattern) override;
+    void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override;
+    unsigned required_fields() const override;
+
+    const filename_t &base_filename() const;
+    // the files of the shards opened so far
+    std::vector<filename_t> shard_filenames() const;
+
+    // "logs/app.log", 1234 => "logs/app.1234.log"
+    static filename_t shard_filename(const filename_t &base_filename, size_t thread_id);
+
+    // write the messages of the shard files to dest (truncated), ordered by the text of their first line.
+    // the lines that don't start like the first line of their file (e.g. the rest of multi-line messages)
+    // stay with the message before them. throw spdlog_ex on errors.
+    static void merge(const std::vector<filename_t> &shards, const filename_t &dest);
+
+private:
+    struct shard
+    {
+        explicit shard(size_t write_buffer_size)
+            : file(write_buffer_size)
+        {}
+
+        std::mutex mutex;
+        details::file_helper file;
+        std::unique_ptr<spdlog::formatter> formatter;
+    };
+
+    filename_t base_filename_;
+    bool truncate_;
+    size_t write_buffer_size_;
+    size_t id_; // never reused: the thread caches of a destroyed sink don't match another one
+    std::atomic<unsigned> formatter_fields_;
+
+    // the shards and the formatter they are cloned from
+    mutable std::mutex shards_mutex_;
+    std::unique_ptr<spdlog::formatter> formatter_;
+    std::unordered_map<size_t, shard *> shards_by_thread_;
+    std::vector<std::unique_ptr<shard>> shards_;
+
+    shard &thread_shard_();
+    static size_t next_sink_id_();
+};
+
+} // namespace sinks
+
+//
+// factory functions
+//
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> sharded_file_logger(
+    const std::string &logger_name, const filename_t &base_filename, bool truncate = false, size_t write_buffer_size = 0)
+{
+    return Factory::template create<sinks::sharded_file_sink>(logger_name, base_filename, truncate, write_buffer_size);
+}
+
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "sharded_file_sink-inl.h"
+#endif
@@ -0,0 +1,91 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <spdlog/details/append_file.h>
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/sinks/base_sink.h>
+#include <spdlog/details/synchronous_factory.h>
+
+#include <chrono>
+#include <mutex>
+#include <string>
+
+namespace spdlog {
+namespace sinks {
+/*
+ * File sink for a log file shared by several processes (posix, see details/append_file.h).
+ * Each message - or each batch of an async logger - is appended with a single write(2) to the file
+ * opened with O_APPEND, so the lines of the processes don't interleave. Nothing is buffered: flush() has
+ * nothing to do.
+ *
+ * With a max size, the files are rotated like in rotating_file_sink (log.txt -> log.1.txt ..) by the first
+ * process finding the file full, under the lock of "<filename>.lock". The others notice it as their file is
+ * full too, and open the new one. A message written while the rotation happens can end up in log.1.txt.
+ * The file renamed by other programs (logrotate..) is reopened within a second.
+ */
+template<typename Mutex>
+class shared_file_sink final : public base_sink<Mutex>
+{
+public:
+    explicit shared_file_sink(filename_t base_filename, bool truncate = false, std::size_t max_size = 0, std::size_t max_files = 0);
+    filename_t filename();
+    // the fields read by the formatter
+    unsigned required_fields() const override;
+
+protected:
+    void sink_it_(const details::log_msg &msg) override;
+    void sink_batch_(const details::log_msg *msgs, size_t n_msgs) override;
+    bool accepts_formatted_() const override;
+    void sink_formatted_(const details::log_msg &msg, string_view_t formatted) override;
+    void flush_() override;
+
+private:
+    void write_(string_view_t data);
+    // rotate the files, unless another process did: open its new file then
+    void rotate_(size_t size);
+
+    filename_t base_filename_;
+    std::size_t max_size_;
+    std::size_t max_files_;
+    details::append_file file_;
+    const std::chrono::milliseconds reopen_check_interval_{1000};
+    std::chrono::steady_clock::time_point next_reopen_check_;
+};
+
+using shared_file_sink_mt = shared_file_sink<std::mutex>;
+using shared_file_sink_st = shared_file_sink<details::null_mutex>;
+
+#ifdef SPDLOG_COMPILED_LIB
+// instantiated in src/file_sinks.cpp
+extern template class SPDLOG_API shared_file_sink<std::mutex>;
+extern template class SPDLOG_API shared_file_sink<details::null_mutex>;
+extern template class SPDLOG_API shared_file_sink<details::spin_mutex>;
+extern template class SPDLOG_API shared_file_sink<details::adaptive_mutex>;
+#endif
+
+} // namespace sinks
+
+//
+// factory functions
+//
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> shared_file_logger_mt(
+    const std::string &logger_name, const filename_t &filename, bool truncate = false, size_t max_size = 0, size_t max_files = 0)
+{
+    return Factory::template create<sinks::shared_file_sink_mt>(logger_name, filename, truncate, max_size, max_files);
+}
+
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> shared_file_logger_st(
+    const std::string &logger_name, const filename_t &filename, bool truncate = false, size_t max_size = 0, size_t max_files = 0)
+{
+    return Factory::template create<sinks::shared_file_sink_st>(logger_name, filename, truncate, max_size, max_files);
+}
+
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#    include "shared_file_sink-inl.h"
+#endif
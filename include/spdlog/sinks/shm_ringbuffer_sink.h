@@ -0,0 +1,78 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifdef _WIN32
+#    error shm_ringbuffer_sink.h is not supported on windows
+#endif
+
+#include <spdlog/sinks/base_sink.h>
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/details/scoped_buffer.h>
+#include <spdlog/details/shm_ring.h>
+#include <spdlog/details/synchronous_factory.h>
+
+#include <mutex>
+#include <string>
+
+namespace spdlog {
+namespace sinks {
+/*
+ * Ring buffer sink in a named shared memory segment (see details/shm_ring.h).
+ * The last formatted messages can be read by another process, live or after a crash, e.g. with
+ * tools/spdlog-shm-tail. Several sinks, in several processes, can write to the same segment.
+ * The segment is kept when the sink is destroyed: remove it with details::shm_ring::remove().
+ */
+template<typename Mutex>
+class shm_ringbuffer_sink final : public base_sink<Mutex>
+{
+public:
+    // open or create the named segment (e.g "/myapp-log") or throw if failed
+    shm_ringbuffer_sink(const std::string &name, size_t capacity)
+    {
+        ring_.open(name, capacity);
+    }
+
+    const details::shm_ring &ring() const
+    {
+        return ring_;
+    }
+
+protected:
+    void sink_it_(const details::log_msg &msg) override
+    {
+        details::scoped_buffer formatted_buffer;
+        auto &formatted = formatted_buffer.get();
+        base_sink<Mutex>::format_(msg, formatted);
+        ring_.write(string_view_t(formatted.data(), formatted.size()));
+    }
+
+    // the records are visible to the readers once written
+    void flush_() override {}
+
+private:
+    details::shm_ring ring_;
+};
+
+using shm_ringbuffer_sink_mt = shm_ringbuffer_sink<std::mutex>;
+using shm_ringbuffer_sink_st = shm_ringbuffer_sink<details::null_mutex>;
+
+} // namespace sinks
+
+//
+// factory functions
+//
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> shm_ringbuffer_logger_mt(const std::string &logger_name, const std::string &shm_name, size_t capacity)
+{
+    return Factory::template create<sinks::shm_ringbuffer_sink_mt>(logger_name, shm_name, capacity);
+}
+
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> shm_ringbuffer_logger_st(const std::string &logger_name, const std::string &shm_name, size_t capacity)
+{
+    return Factory::template create<sinks::shm_ringbuffer_sink_st>(logger_name, shm_name, capacity);
+}
+
+} // namespace spdlog
@@ -8,6 +8,7 @@
 #endif
 
 #include <spdlog/common.h>
+#include <spdlog/details/call_site.h>
 
 SPDLOG_INLINE bool spdlog::sinks::sink::should_log(spdlog::level::level_enum msg_level) const
 {
@@ -17,9 +18,73 @@ SPDLOG_INLINE bool spdlog::sinks::sink::should_log(spdlog::level::level_enum msg
 SPDLOG_INLINE void spdlog::sinks::sink::set_level(level::level_enum log_level)
 {
     level_.store(log_level, std::memory_order_relaxed);
+    level_generation_counter_().fetch_add(1, std::memory_order_release);
+    // the call sites cache whether the sinks of their logger take the level
+    details::call_site::invalidate_all();
 }
 
 SPDLOG_INLINE spdlog::level::level_enum spdlog::sinks::sink::level() const
 {
     return static_cast<spdlog::level::level_enum>(level_.load(std::memory_order_relaxed));
 }
+
+SPDLOG_INLINE uint64_t spdlog::sinks::sink::level_generation()
+{
+    return level_generation_counter_().load(std::memory_order_acquire);
+}
+
+SPDLOG_INLINE std::atomic<uint64_t> &spdlog::sinks::sink::level_generation_counter_()
+{
+    // 0 is never current (see logger::sinks_accept_())
+    static std::atomic<uint64_t> generation{1};
+    return generation;
+}
+
+SPDLOG_INLINE unsigned spdlog::sinks::sink::required_fields() const
+{
+    return details::msg_fields::all;
+}
+
+SPDLOG_INLINE void spdlog::sinks::sink::log_batch(const details::log_msg *msgs, size_t n_msgs)
+{
+    for (size_t i = 0; i < n_msgs; i++)
+    {
+        if (should_log(msgs[i].level))
+        {
+            log(msgs[i]);
+        }
+    }
+}
+
+SPDLOG_INLINE void spdlog::sinks::sink::log_shared(const details::log_msg &msg, details::shared_format &)
+{
+    log(msg);
+}
+
+SPDLOG_INLINE void spdlog::sinks::sink::log_formatted(const details::log_msg &msg, string_view_t)
+{
+    log(msg);
+}
+
+SPDLOG_INLINE bool spdlog::sinks::sink::format_ahead(const details::log_msg &, memory_buf_t &)
+{
+    return false;
+}
+
+SPDLOG_INLINE spdlog::details::profile_stats spdlog::sinks::sink::profile_stats() const
+{
+    return profile_.snapshot();
+}
+
+SPDLOG_INLINE spdlog::details::profile_counters &spdlog::sinks::sink::profile_counters()
+{
+    return profile_;
+}
+
+SPDLOG_INLINE void spdlog::sinks::sink::format_with_(formatter &f, const details::log_msg &msg, memory_buf_t &dest)
+{
+    details::profile_timer timer;
+    auto old_size = dest.size();
+    f.format(msg, dest);
+    profile_.on_formatted(dest.size() - old_size, timer);
+}
@@ -4,16 +4,82 @@
 #pragma once
 
 #include <spdlog/details/log_msg.h>
+#include <spdlog/details/profile_stats.h>
+#include <spdlog/details/scoped_buffer.h>
 #include <spdlog/formatter.h>
 
+#include <atomic>
+#include <cstdint>
+
 namespace spdlog {
 
+namespace details {
+// The formatted text of a message, passed along the sinks of a logger: the first sink
+// whose formatter has an id formats the message, the next ones with the same id reuse the text.
+struct shared_format
+{
+    size_t format_id{0}; // id of the formatter that produced the text, 0 if none yet
+    scoped_buffer formatted;
+    size_t color_range_start{0};
+    size_t color_range_end{0};
+
+    // return the text of msg formatted by the given formatter, whose format_id() is id, formatting
+    // it unless the text of an equivalent formatter is kept already. msg gets the color range of the text.
+    // the formatting is counted in the given profile counters.
+    const memory_buf_t &format(formatter &f, size_t id, const log_msg &msg, profile_counters &profile)
+    {
+        auto &buf = formatted.get();
+        if (format_id != id)
+        {
+            format_id = 0;
+            buf.clear();
+            msg.color_range_start = 0;
+            msg.color_range_end = 0;
+            profile_timer timer;
+            f.format(msg, buf);
+            profile.on_formatted(buf.size(), timer);
+            color_range_start = msg.color_range_start;
+            color_range_end = msg.color_range_end;
+            format_id = id;
+        }
+        else
+        {
+            msg.color_range_start = color_range_start;
+            msg.color_range_end = color_range_end;
+        }
+        return buf;
+    }
+};
+} // namespace details
+
 namespace sinks {
 class SPDLOG_API sink
 {
 public:
     virtual ~sink() = default;
     virtual void log(const details::log_msg &msg) = 0;
+
+    // log a batch of messages (e.g. drained at once by the async thread pool).
+    // messages below the sink level are skipped.
+    // the default implementation logs them one by one.
+    virtual void log_batch(const details::log_msg *msgs, size_t n_msgs);
+
+    // log the message, reusing the text formatted by a previous sink of the logger if
+    // the formatters are equivalent (see formatter::format_id()).
+    // the default implementation formats the message as usual.
+    virtual void log_shared(const details::log_msg &msg, details::shared_format &shared);
+
+    // log the message already formatted upstream (e.g. once for many sinks): formatted is the
+    // complete text of msg, msg.color_range_start/end point into it.
+    // sinks writing their formatted text as is write it in place of their own formatting,
+    // the default implementation ignores it and formats the message as usual.
+    virtual void log_formatted(const details::log_msg &msg, string_view_t formatted);
+
+    // format msg into dest as the sink would write it, out of its lock (with a clone of its formatter per
+    // thread), to pass to log_formatted() later - msg gets the color range of the text. e.g. to format on
+    // several threads and write in order. false if the sink formats under its lock only (the default).
+    virtual bool format_ahead(const details::log_msg &msg, memory_buf_t &dest);
+
     virtual void flush() = 0;
     virtual void set_pattern(const std::string &pattern) = 0;
     virtual void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) = 0;
@@ -21,10 +87,29 @@ public:
     void set_level(level::level_enum log_level);
     level::level_enum level() const;
     bool should_log(level::level_enum msg_level) const;
+    // incremented by set_level() of any sink: the loggers then refresh the lowest level of their sinks
+    // (see logger::should_log())
+    static uint64_t level_generation();
+
+    // the details::msg_fields read by the sink (and its formatter): the loggers create their messages
+    // with the fields read by their sinks only. all by default.
+    virtual unsigned required_fields() const;
+
+    // snapshot of the self profiling counters (all zero unless SPDLOG_ENABLE_STATS is defined)
+    details::profile_stats profile_stats() const;
+    // the counters, for the loggers and the sinks dispatching to this one
+    details::profile_counters &profile_counters();
 
 protected:
     // sink log level - default is all
     level_t level_{level::trace};
+    details::profile_counters profile_;
+
+    // format msg into dest with f, counting it
+    void format_with_(formatter &f, const details::log_msg &msg, memory_buf_t &dest);
+
+private:
+    static std::atomic<uint64_t> &level_generation_counter_();
 };
 
 } // namespace sinks
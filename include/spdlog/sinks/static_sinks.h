@@ -0,0 +1,134 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Sinks of the static loggers (see static_logger.h): plain classes, written with the text formatted
+// by the logger under its lock, by direct calls.
+
+#include <spdlog/common.h>
+#include <spdlog/details/file_helper.h>
+#include <spdlog/details/log_msg.h>
+#include <spdlog/sinks/sink.h>
+
+#include <ostream>
+
+namespace spdlog {
+namespace static_sinks {
+
+// write to a file (see sinks::basic_file_sink)
+class file_sink
+{
+public:
+    explicit file_sink(const filename_t &filename, bool truncate = false)
+    {
+        file_helper_.open(filename, truncate);
+    }
+
+    void write(const details::log_msg &, string_view_t formatted)
+    {
+        file_helper_.write(formatted);
+    }
+
+    void flush()
+    {
+        file_helper_.flush();
+    }
+
+    unsigned required_fields() const
+    {
+        return details::msg_fields::none;
+    }
+
+    const filename_t &filename() const
+    {
+        return file_helper_.filename();
+    }
+
+private:
+    details::file_helper file_helper_;
+};
+
+// write to a std::ostream
+class ostream_sink
+{
+public:
+    explicit ostream_sink(std::ostream &os, bool force_flush = false)
+        : ostream_(os)
+        , force_flush_(force_flush)
+    {}
+
+    void write(const details::log_msg &, string_view_t formatted)
+    {
+        ostream_.write(formatted.data(), static_cast<std::streamsize>(formatted.size()));
+        if (force_flush_)
+        {
+            ostream_.flush();
+        }
+    }
+
+    void flush()
+    {
+        ostream_.flush();
+    }
+
+    unsigned required_fields() const
+    {
+        return details::msg_fields::none;
+    }
+
+private:
+    std::ostream &ostream_;
+    bool force_flush_;
+};
+
+class null_sink
+{
+public:
+    void write(const details::log_msg &, string_view_t) {}
+    void flush() {}
+
+    unsigned required_fields() const
+    {
+        return details::msg_fields::none;
+    }
+};
+
+// any regular sink, passed the formatted text (see sinks::sink::log_formatted()) - by a virtual call
+class dynamic_sink
+{
+public:
+    explicit dynamic_sink(sink_ptr sink)
+        : sink_(std::move(sink))
+    {}
+
+    void write(const details::log_msg &msg, string_view_t formatted)
+    {
+        if (sink_->should_log(msg.level))
+        {
+            sink_->log_formatted(msg, formatted);
+        }
+    }
+
+    void flush()
+    {
+        sink_->flush();
+    }
+
+    // sinks not taking the formatted text format the message again
+    unsigned required_fields() const
+    {
+        return sink_->required_fields();
+    }
+
+    const sink_ptr &wrapped_sink() const
+    {
+        return sink_;
+    }
+
+private:
+    sink_ptr sink_;
+};
+
+} // namespace static_sinks
+} // namespace spdlog
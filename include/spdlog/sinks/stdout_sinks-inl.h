@@ -8,6 +8,9 @@
 #endif
 
 #include <spdlog/details/console_globals.h>
+#include <spdlog/details/fmt_helper.h>
+#include <spdlog/details/os.h>
+#include <spdlog/details/scoped_buffer.h>
 #include <spdlog/pattern_formatter.h>
 #include <memory>
 
@@ -49,6 +52,20 @@ SPDLOG_INLINE stdout_sink_base<ConsoleMutex>::stdout_sink_base(FILE *file)
 #endif // WIN32
 }
 
+template<typename ConsoleMutex>
+SPDLOG_INLINE stdout_sink_base<ConsoleMutex>::~stdout_sink_base()
+{
+    flush_timer_.reset();
+    flusher_.reset();
+    std::lock_guard<mutex_t> lock(mutex_);
+    std::lock_guard<std::mutex> buffer_lock(buffer_mutex_);
+    SPDLOG_TRY
+    {
+        flush_buffer_();
+    }
+    SPDLOG_CATCH_STD
+}
+
 template<typename ConsoleMutex>
 SPDLOG_INLINE void stdout_sink_base<ConsoleMutex>::log(const details::log_msg &msg)
 {
@@ -57,23 +74,103 @@ SPDLOG_INLINE void stdout_sink_base<ConsoleMutex>::log(const details::log_msg &m
     {
         return;
     }
+#endif // WIN32
     std::lock_guard<mutex_t> lock(mutex_);
-    memory_buf_t formatted;
-    formatter_->format(msg, formatted);
+    details::profile_timer timer;
+    details::scoped_buffer formatted_buffer;
+    auto &formatted = formatted_buffer.get();
+    format_with_(*formatter_, msg, formatted);
+    write_(details::fmt_helper::to_string_view(formatted));
+    profile_.on_sunk(1, timer);
+}
+
+template<typename ConsoleMutex>
+SPDLOG_INLINE void stdout_sink_base<ConsoleMutex>::log_shared(const details::log_msg &msg, details::shared_format &shared)
+{
+#ifdef _WIN32
+    if (handle_ == INVALID_HANDLE_VALUE)
+    {
+        return;
+    }
+#endif // WIN32
+    std::lock_guard<mutex_t> lock(mutex_);
+    details::profile_timer timer;
+    auto format_id = formatter_->format_id();
+    if (format_id == 0)
+    {
+        details::scoped_buffer formatted_buffer;
+        auto &formatted = formatted_buffer.get();
+        format_with_(*formatter_, msg, formatted);
+        write_(details::fmt_helper::to_string_view(formatted));
+    }
+    else
+    {
+        write_(details::fmt_helper::to_string_view(shared.format(*formatter_, format_id, msg, profile_)));
+    }
+    profile_.on_sunk(1, timer);
+}
+
+template<typename ConsoleMutex>
+SPDLOG_INLINE void stdout_sink_base<ConsoleMutex>::log_formatted(const details::log_msg &, string_view_t formatted)
+{
+#ifdef _WIN32
+    if (handle_ == INVALID_HANDLE_VALUE)
+    {
+        return;
+    }
+#endif // WIN32
+    std::lock_guard<mutex_t> lock(mutex_);
+    details::profile_timer timer;
+    write_(formatted);
+    profile_.on_sunk(1, timer);
+}
+
+template<typename ConsoleMutex>
+SPDLOG_INLINE void stdout_sink_base<ConsoleMutex>::write_(string_view_t formatted)
+{
+    if (!buffered_)
+    {
+        write_out_(formatted);
+        return;
+    }
+    std::lock_guard<std::mutex> buffer_lock(buffer_mutex_);
+    if (buffer_.size() + formatted.size() > max_buffer_size_)
+    {
+        flush_buffer_();
+    }
+    if (formatted.size() >= max_buffer_size_)
+    {
+        write_out_(formatted);
+        return;
+    }
+    buffer_.append(formatted.data(), formatted.data() + formatted.size());
+}
+
+template<typename ConsoleMutex>
+SPDLOG_INLINE void stdout_sink_base<ConsoleMutex>::flush_buffer_()
+{
+    if (buffer_.size() > 0)
+    {
+        write_out_(string_view_t(buffer_.data(), buffer_.size()));
+        buffer_.clear();
+    }
+}
+
+template<typename ConsoleMutex>
+SPDLOG_INLINE void stdout_sink_base<ConsoleMutex>::write_out_(string_view_t data)
+{
+#ifdef _WIN32
     ::fflush(file_); // flush in case there is somthing in this file_ already
-    auto size = static_cast<DWORD>(formatted.size());
+    auto size = static_cast<DWORD>(data.size());
     DWORD bytes_written = 0;
-    bool ok = ::WriteFile(handle_, formatted.data(), size, &bytes_written, nullptr) != 0;
+    bool ok = ::WriteFile(handle_, data.data(), size, &bytes_written, nullptr) != 0;
     if (!ok)
     {
         throw_spdlog_ex("stdout_sink_base: WriteFile() failed. GetLastError(): " + std::to_string(::GetLastError()));
     }
 #else
-    std::lock_guard<mutex_t> lock(mutex_);
-    memory_buf_t formatted;
-    formatter_->format(msg, formatted);
-    ::fwrite(formatted.data(), sizeof(char), formatted.size(), file_);
-    ::fflush(file_); // flush every line to terminal
+    ::fwrite(data.data(), sizeof(char), data.size(), file_);
+    ::fflush(file_); // flush every line (or buffer) to terminal
 #endif // WIN32
 }
 
@@ -81,7 +178,13 @@ template<typename ConsoleMutex>
 SPDLOG_INLINE void stdout_sink_base<ConsoleMutex>::flush()
 {
     std::lock_guard<mutex_t> lock(mutex_);
+    details::profile_timer timer;
+    {
+        std::lock_guard<std::mutex> buffer_lock(buffer_mutex_);
+        flush_buffer_();
+    }
     fflush(file_);
+    profile_.on_flushed(timer);
 }
 
 template<typename ConsoleMutex>
@@ -98,6 +201,40 @@ SPDLOG_INLINE void stdout_sink_base<ConsoleMutex>::set_formatter(std::unique_ptr
     formatter_ = std::move(sink_formatter);
 }
 
+template<typename ConsoleMutex>
+SPDLOG_INLINE void stdout_sink_base<ConsoleMutex>::set_buffering(
+    console_buffering mode, size_t max_size, std::chrono::milliseconds interval)
+{
+    // stopped unlocked: the posted writes take the lock
+    flush_timer_.reset();
+    flusher_.reset();
+    std::lock_guard<mutex_t> lock(mutex_);
+    {
+        std::lock_guard<std::mutex> buffer_lock(buffer_mutex_);
+        flush_buffer_();
+    }
+    buffered_ = mode == console_buffering::always || (mode == console_buffering::automatic && !details::os::in_terminal(file_));
+    max_buffer_size_ = max_size;
+    if (buffered_ && interval > std::chrono::milliseconds::zero())
+    {
+        // the shared timer thread only posts the write, done by the sink's own thread: the console may block
+        flusher_ = details::make_unique<details::background_worker>();
+        flush_timer_ = details::make_unique<details::periodic_worker>(
+            [this] {
+                if (flush_posted_.exchange(true))
+                {
+                    return; // the previous one is still pending
+                }
+                flusher_->post([this] {
+                    flush_posted_ = false;
+                    std::lock_guard<std::mutex> buffer_lock(buffer_mutex_);
+                    flush_buffer_();
+                });
+            },
+            interval);
+    }
+}
+
 // stdout sink
 template<typename ConsoleMutex>
 SPDLOG_INLINE stdout_sink<ConsoleMutex>::stdout_sink()
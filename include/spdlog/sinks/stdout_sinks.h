@@ -3,10 +3,16 @@
 
 #pragma once
 
+#include <spdlog/details/background_worker.h>
 #include <spdlog/details/console_globals.h>
+#include <spdlog/details/periodic_worker.h>
 #include <spdlog/details/synchronous_factory.h>
 #include <spdlog/sinks/sink.h>
+#include <atomic>
+#include <chrono>
 #include <cstdio>
+#include <memory>
+#include <mutex>
 
 #ifdef _WIN32
 #    include <spdlog/details/windows_include.h>
@@ -22,7 +28,7 @@ class stdout_sink_base : public sink
 public:
     using mutex_t = typename ConsoleMutex::mutex_t;
     explicit stdout_sink_base(FILE *file);
-    ~stdout_sink_base() override = default;
+    ~stdout_sink_base() override;
 
     stdout_sink_base(const stdout_sink_base &other) = delete;
     stdout_sink_base(stdout_sink_base &&other) = delete;
@@ -31,11 +37,18 @@ public:
     stdout_sink_base &operator=(stdout_sink_base &&other) = delete;
 
     void log(const details::log_msg &msg) override;
+    void log_shared(const details::log_msg &msg, details::shared_format &shared) override;
+    void log_formatted(const details::log_msg &msg, string_view_t formatted) override;
     void flush() override;
     void set_pattern(const std::string &pattern) override;
 
     void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override;
 
+    // by default each message is written and flushed on its own. when buffered, the messages are written
+    // together once max_size bytes are pending, every interval, on flush() and on destruction.
+    void set_buffering(
+        console_buffering mode, size_t max_size = 64 * 1024, std::chrono::milliseconds interval = std::chrono::milliseconds(100));
+
 protected:
     mutex_t &mutex_;
     FILE *file_;
@@ -43,6 +56,19 @@ protected:
 #ifdef _WIN32
     HANDLE handle_;
 #endif // WIN32
+    bool buffered_{false};
+    size_t max_buffer_size_{0};
+    // buffer_ is written by flusher_ too: locked whatever the console mutex (a null mutex for the _st sinks)
+    std::mutex buffer_mutex_;
+    memory_buf_t buffer_;
+    std::unique_ptr<details::background_worker> flusher_;
+    std::atomic<bool> flush_posted_{false};
+    std::unique_ptr<details::periodic_worker> flush_timer_; // last: stopped first
+
+    void write_(string_view_t formatted);
+    void write_out_(string_view_t data);
+    // called with buffer_mutex_ locked
+    void flush_buffer_();
 };
 
 template<typename ConsoleMutex>
@@ -65,6 +91,16 @@ using stdout_sink_st = stdout_sink<details::console_nullmutex>;
 using stderr_sink_mt = stderr_sink<details::console_mutex>;
 using stderr_sink_st = stderr_sink<details::console_nullmutex>;
 
+#ifdef SPDLOG_COMPILED_LIB
+// instantiated in src/stdout_sinks.cpp
+extern template class SPDLOG_API stdout_sink_base<details::console_mutex>;
+extern template class SPDLOG_API stdout_sink_base<details::console_nullmutex>;
+extern template class SPDLOG_API stdout_sink<details::console_mutex>;
+extern template class SPDLOG_API stdout_sink<details::console_nullmutex>;
+extern template class SPDLOG_API stderr_sink<details::console_mutex>;
+extern template class SPDLOG_API stderr_sink<details::console_nullmutex>;
+#endif
+
 } // namespace sinks
 
 // factory methods
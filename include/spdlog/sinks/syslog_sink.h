@@ -6,15 +6,39 @@
 #include <spdlog/sinks/base_sink.h>
 #include <spdlog/details/null_mutex.h>
 #include <spdlog/details/synchronous_factory.h>
+#include <spdlog/details/scoped_buffer.h>
+#include <spdlog/details/fmt_helper.h>
+#include <spdlog/details/periodic_worker.h>
+#include <spdlog/details/socket_batch.h>
 
 #include <array>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
 #include <string>
 #include <syslog.h>
+#include <unistd.h>
 
 namespace spdlog {
 namespace sinks {
+
+// Write to the syslog socket directly instead of through the libc (which takes a global lock and may
+// reconnect on each message): the messages are sent batch_size at a time, and max_delay after the
+// first one of a partial batch, one datagram each. The syslog_option flags other than LOG_PID are ignored.
+struct syslog_socket_config
+{
+#ifdef __APPLE__
+    std::string socket_path = "/var/run/syslog";
+#else
+    std::string socket_path = "/dev/log";
+#endif
+    size_t batch_size = 64;
+    std::chrono::milliseconds max_delay{100};
+};
+
 /**
- * Sink that write to syslog using the `syscall()` library call.
+ * Sink that write to syslog using the `syscall()` library call,
+ * or directly to the syslog socket (see syslog_socket_config).
  */
 template<typename Mutex>
 class syslog_sink : public base_sink<Mutex>
@@ -36,11 +60,47 @@ public:
         ::openlog(ident_.empty() ? nullptr : ident_.c_str(), syslog_option, syslog_facility);
     }
 
+    // write to the syslog socket (see syslog_socket_config)
+    syslog_sink(std::string ident, int syslog_option, int syslog_facility, bool enable_formatting, syslog_socket_config socket_config)
+        : enable_formatting_{enable_formatting}
+        , syslog_levels_{{/* spdlog::level::trace      */ LOG_DEBUG,
+              /* spdlog::level::debug      */ LOG_DEBUG,
+              /* spdlog::level::info       */ LOG_INFO,
+              /* spdlog::level::warn       */ LOG_WARNING,
+              /* spdlog::level::err        */ LOG_ERR,
+              /* spdlog::level::critical   */ LOG_CRIT,
+              /* spdlog::level::off        */ LOG_INFO}}
+        , ident_{ident.empty() ? program_name_() : std::move(ident)}
+        , facility_{syslog_facility}
+        , pid_{(syslog_option & LOG_PID) != 0 ? static_cast<int>(::getpid()) : 0}
+        , socket_batch_{details::make_unique<details::socket_batch>(socket_config.socket_path, socket_config.batch_size, size_t(8192))}
+    {
+        if (socket_config.batch_size > 1 && socket_config.max_delay > std::chrono::milliseconds::zero())
+        {
+            auto max_delay = socket_config.max_delay;
+            flush_timer_ = details::make_unique<details::periodic_worker>(
+                [this, max_delay] { socket_batch_->send_overdue(max_delay); },
+                max_delay);
+        }
+    }
+
     ~syslog_sink() override
     {
+        if (socket_batch_)
+        {
+            flush_timer_.reset();
+            socket_batch_->send();
+            return;
+        }
         ::closelog();
     }
 
+    // number of messages lost when writing to the syslog socket
+    size_t dropped_messages() const
+    {
+        return socket_batch_ ? socket_batch_->dropped() : 0;
+    }
+
     syslog_sink(const syslog_sink &) = delete;
     syslog_sink &operator=(const syslog_sink &) = delete;
 
@@ -48,10 +108,11 @@ protected:
     void sink_it_(const details::log_msg &msg) override
     {
         string_view_t payload;
-        memory_buf_t formatted;
+        details::scoped_buffer formatted_buffer;
+        auto &formatted = formatted_buffer.get();
         if (enable_formatting_)
         {
-            base_sink<Mutex>::formatter_->format(msg, formatted);
+            base_sink<Mutex>::format_(msg, formatted);
             payload = string_view_t(formatted.data(), formatted.size());
         }
         else
@@ -59,6 +120,12 @@ protected:
             payload = msg.payload;
         }
 
+        if (socket_batch_)
+        {
+            write_to_socket_(msg, payload);
+            return;
+        }
+
         size_t length = payload.size();
         // limit to max int
         if (length > static_cast<size_t>(std::numeric_limits<int>::max()))
@@ -69,7 +136,14 @@ protected:
         ::syslog(syslog_prio_from_level(msg), "%.*s", static_cast<int>(length), payload.data());
     }
 
-    void flush_() override {}
+    void flush_() override
+    {
+        if (socket_batch_)
+        {
+            socket_batch_->send();
+        }
+    }
+
     bool enable_formatting_ = false;
 
 private:
@@ -78,6 +152,11 @@ private:
     // must store the ident because the man says openlog might use the pointer as
     // is and not a string copy
     const std::string ident_;
+    // when writing to the syslog socket
+    int facility_ = LOG_USER;
+    int pid_ = 0;
+    std::unique_ptr<details::socket_batch> socket_batch_;
+    std::unique_ptr<details::periodic_worker> flush_timer_; // last: stopped first
 
     //
     // Simply maps spdlog's log level to syslog priority level.
@@ -86,6 +165,53 @@ private:
     {
         return syslog_levels_.at(static_cast<levels_array::size_type>(msg.level));
     }
+
+    // the format of the libc: "<priority>Mmm dd hh:mm:ss ident[pid]: message"
+    void write_to_socket_(const details::log_msg &msg, string_view_t payload)
+    {
+        static const char *const months[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+        auto tm_time = details::os::localtime(log_clock::to_time_t(msg.time));
+        details::scoped_buffer datagram_buffer;
+        auto &datagram = datagram_buffer.get();
+        datagram.push_back('<');
+        details::fmt_helper::append_int(facility_ | syslog_prio_from_level(msg), datagram);
+        datagram.push_back('>');
+        details::fmt_helper::append_string_view(months[tm_time.tm_mon], datagram);
+        datagram.push_back(' ');
+        if (tm_time.tm_mday < 10)
+        {
+            datagram.push_back(' ');
+        }
+        details::fmt_helper::append_int(tm_time.tm_mday, datagram);
+        datagram.push_back(' ');
+        details::fmt_helper::pad2(tm_time.tm_hour, datagram);
+        datagram.push_back(':');
+        details::fmt_helper::pad2(tm_time.tm_min, datagram);
+        datagram.push_back(':');
+        details::fmt_helper::pad2(tm_time.tm_sec, datagram);
+        datagram.push_back(' ');
+        details::fmt_helper::append_string_view(ident_, datagram);
+        if (pid_ != 0)
+        {
+            datagram.push_back('[');
+            details::fmt_helper::append_int(pid_, datagram);
+            datagram.push_back(']');
+        }
+        details::fmt_helper::append_string_view(": ", datagram);
+        details::fmt_helper::append_string_view(payload, datagram);
+        socket_batch_->add(datagram.data(), datagram.size());
+    }
+
+    static std::string program_name_()
+    {
+#if defined(__GLIBC__)
+        return program_invocation_short_name;
+#elif defined(__APPLE__) || defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__)
+        return getprogname();
+#else
+        return "spdlog";
+#endif
+    }
 };
 
 using syslog_sink_mt = syslog_sink<std::mutex>;
@@ -106,4 +232,14 @@ inline std::shared_ptr<logger> syslog_logger_st(const std::string &logger_name,
 {
     return Factory::template create<sinks::syslog_sink_st>(logger_name, syslog_ident, syslog_option, syslog_facility, enable_formatting);
 }
+
+// Create and register a logger writing to the syslog socket (see syslog_socket_config)
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> syslog_socket_logger_mt(const std::string &logger_name, const std::string &syslog_ident = "",
+    int syslog_option = 0, int syslog_facility = LOG_USER, bool enable_formatting = false,
+    sinks::syslog_socket_config socket_config = sinks::syslog_socket_config())
+{
+    return Factory::template create<sinks::syslog_sink_mt>(
+        logger_name, syslog_ident, syslog_option, syslog_facility, enable_formatting, std::move(socket_config));
+}
 } // namespace spdlog
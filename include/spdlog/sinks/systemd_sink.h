@@ -6,8 +6,18 @@
 #include <spdlog/sinks/base_sink.h>
 #include <spdlog/details/null_mutex.h>
 #include <spdlog/details/synchronous_factory.h>
+#include <spdlog/details/fmt_helper.h>
+#include <spdlog/details/periodic_worker.h>
+#include <spdlog/details/scoped_buffer.h>
+#include <spdlog/details/socket_batch.h>
 
 #include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <sys/uio.h>
 #ifndef SD_JOURNAL_SUPPRESS_LOCATION
 #    define SD_JOURNAL_SUPPRESS_LOCATION
 #endif
@@ -16,10 +26,21 @@
 namespace spdlog {
 namespace sinks {
 
+// Write to the journal socket directly, with the native protocol of journald: the entries are sent
+// batch_size at a time, and max_delay after the first one of a partial batch, one datagram each.
+// Entries larger than a datagram are sent with sd_journal_sendv().
+struct journal_socket_config
+{
+    std::string socket_path = "/run/systemd/journal/socket";
+    size_t batch_size = 64;
+    std::chrono::milliseconds max_delay{100};
+};
+
 /**
- * Sink that write to systemd journal using the `sd_journal_send()` library call.
+ * Sink that write to systemd journal using the `sd_journal_sendv()` library call,
+ * or directly to the journal socket (see journal_socket_config).
  *
- * Locking is not needed, as `sd_journal_send()` itself is thread-safe.
+ * Locking is not needed, as `sd_journal_sendv()` itself is thread-safe.
  */
 template<typename Mutex>
 class systemd_sink : public base_sink<Mutex>
@@ -36,19 +57,51 @@ public:
               /* spdlog::level::off        */ LOG_INFO}}
     {}
 
-    ~systemd_sink() override {}
+    // write to the journal socket (see journal_socket_config)
+    explicit systemd_sink(journal_socket_config socket_config)
+        : systemd_sink()
+    {
+        socket_batch_ =
+            details::make_unique<details::socket_batch>(socket_config.socket_path, socket_config.batch_size, max_datagram_size_());
+        if (socket_config.batch_size > 1 && socket_config.max_delay > std::chrono::milliseconds::zero())
+        {
+            auto max_delay = socket_config.max_delay;
+            flush_timer_ = details::make_unique<details::periodic_worker>(
+                [this, max_delay] { socket_batch_->send_overdue(max_delay); },
+                max_delay);
+        }
+    }
+
+    ~systemd_sink() override
+    {
+        if (socket_batch_)
+        {
+            flush_timer_.reset();
+            socket_batch_->send();
+        }
+    }
 
     systemd_sink(const systemd_sink &) = delete;
     systemd_sink &operator=(const systemd_sink &) = delete;
 
+    // number of entries lost when writing to the journal socket
+    size_t dropped_messages() const
+    {
+        return socket_batch_ ? socket_batch_->dropped() : 0;
+    }
+
 protected:
     using levels_array = std::array<int, 7>;
     levels_array syslog_levels_;
 
-    void sink_it_(const details::log_msg &msg) override
+    struct journal_field
     {
-        int err;
+        string_view_t name;
+        string_view_t value;
+    };
 
+    void sink_it_(const details::log_msg &msg) override
+    {
         size_t length = msg.payload.size();
         // limit to max int
         if (length > static_cast<size_t>(std::numeric_limits<int>::max()))
@@ -56,32 +109,109 @@ protected:
             length = static_cast<size_t>(std::numeric_limits<int>::max());
         }
 
+        char priority = static_cast<char>('0' + syslog_level(msg.level));
+        memory_buf_t line;
+        journal_field fields[6];
+        size_t n_fields = 0;
+        fields[n_fields++] = {"MESSAGE", string_view_t(msg.payload.data(), length)};
+        fields[n_fields++] = {"PRIORITY", string_view_t(&priority, 1)};
+        fields[n_fields++] = {"SYSLOG_IDENTIFIER", msg.logger_name};
         // Do not send source location if not available
-        if (msg.source.empty())
+        if (!msg.source.empty())
         {
-            // Note: function call inside '()' to avoid macro expansion
-            err = (sd_journal_send)("MESSAGE=%.*s", static_cast<int>(length), msg.payload.data(), "PRIORITY=%d", syslog_level(msg.level),
-                "SYSLOG_IDENTIFIER=%.*s", static_cast<int>(msg.logger_name.size()), msg.logger_name.data(), nullptr);
+            details::fmt_helper::append_int(msg.source.line, line);
+            fields[n_fields++] = {"CODE_FILE", msg.source.filename};
+            fields[n_fields++] = {"CODE_LINE", string_view_t(line.data(), line.size())};
+            fields[n_fields++] = {"CODE_FUNC", msg.source.funcname};
         }
-        else
+
+        if (socket_batch_)
         {
-            err = (sd_journal_send)("MESSAGE=%.*s", static_cast<int>(length), msg.payload.data(), "PRIORITY=%d", syslog_level(msg.level),
-                "SYSLOG_IDENTIFIER=%.*s", static_cast<int>(msg.logger_name.size()), msg.logger_name.data(), "CODE_FILE=%s",
-                msg.source.filename, "CODE_LINE=%d", msg.source.line, "CODE_FUNC=%s", msg.source.funcname, nullptr);
+            details::scoped_buffer entry_buffer;
+            auto &entry = entry_buffer.get();
+            serialize_entry_(fields, n_fields, entry);
+            if (entry.size() <= max_datagram_size_())
+            {
+                socket_batch_->add(entry.data(), entry.size());
+                return;
+            }
         }
+        send_entry_(fields, n_fields);
+    }
 
+    // "NAME=value" per field
+    void send_entry_(const journal_field *fields, size_t n_fields)
+    {
+        details::scoped_buffer entry_buffer;
+        auto &entry = entry_buffer.get();
+        size_t ends[6];
+        for (size_t i = 0; i < n_fields; i++)
+        {
+            details::fmt_helper::append_string_view(fields[i].name, entry);
+            entry.push_back('=');
+            details::fmt_helper::append_string_view(fields[i].value, entry);
+            ends[i] = entry.size();
+        }
+        struct iovec iov[6];
+        for (size_t i = 0; i < n_fields; i++)
+        {
+            auto begin = i == 0 ? 0 : ends[i - 1];
+            iov[i].iov_base = entry.data() + begin;
+            iov[i].iov_len = ends[i] - begin;
+        }
+        int err = (sd_journal_sendv)(iov, static_cast<int>(n_fields));
         if (err)
         {
             throw_spdlog_ex("Failed writing to systemd", errno);
         }
     }
 
+    // the native protocol: "NAME=value\n", or "NAME\n" + 64 bits little endian size + value + "\n" if the value
+    // has line breaks
+    static void serialize_entry_(const journal_field *fields, size_t n_fields, memory_buf_t &dest)
+    {
+        for (size_t i = 0; i < n_fields; i++)
+        {
+            const auto &value = fields[i].value;
+            details::fmt_helper::append_string_view(fields[i].name, dest);
+            if (std::memchr(value.data(), '\n', value.size()) == nullptr)
+            {
+                dest.push_back('=');
+            }
+            else
+            {
+                dest.push_back('\n');
+                auto size = static_cast<uint64_t>(value.size());
+                for (int byte = 0; byte < 8; byte++)
+                {
+                    dest.push_back(static_cast<char>((size >> (8 * byte)) & 0xff));
+                }
+            }
+            details::fmt_helper::append_string_view(value, dest);
+            dest.push_back('\n');
+        }
+    }
+
+    static size_t max_datagram_size_()
+    {
+        return 64 * 1024;
+    }
+
     int syslog_level(level::level_enum l)
     {
         return syslog_levels_.at(static_cast<levels_array::size_type>(l));
     }
 
-    void flush_() override {}
+    void flush_() override
+    {
+        if (socket_batch_)
+        {
+            socket_batch_->send();
+        }
+    }
+
+    std::unique_ptr<details::socket_batch> socket_batch_;
+    std::unique_ptr<details::periodic_worker> flush_timer_; // last: stopped first
 };
 
 using systemd_sink_mt = systemd_sink<std::mutex>;
@@ -100,4 +230,12 @@ inline std::shared_ptr<logger> systemd_logger_st(const std::string &logger_name)
 {
     return Factory::template create<sinks::systemd_sink_st>(logger_name);
 }
+
+// Create and register a logger writing to the journal socket (see journal_socket_config)
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> systemd_socket_logger_mt(
+    const std::string &logger_name, sinks::journal_socket_config socket_config = sinks::journal_socket_config())
+{
+    return Factory::template create<sinks::systemd_sink_mt>(logger_name, std::move(socket_config));
+}
 } // namespace spdlog
@@ -6,16 +6,22 @@
 #include <spdlog/common.h>
 #include <spdlog/sinks/base_sink.h>
 #include <spdlog/details/null_mutex.h>
+#include <spdlog/details/scoped_buffer.h>
 #ifdef _WIN32
 #    include <spdlog/details/tcp_client-windows.h>
 #else
 #    include <spdlog/details/tcp_client.h>
 #endif
 
-#include <mutex>
-#include <string>
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 
 #pragma once
 
@@ -23,6 +29,13 @@
 // Connects to remote address and send the formatted log.
 // Will attempt to reconnect if connection drops.
 // If more complicated behaviour is needed (i.e get responses), you can inherit it and override the sink_it_ method.
+//
+// With background = true, sink_it_ only appends the formatted messages to a send buffer: a background thread sends
+// them in batches (once batch_size bytes are buffered, every batch_interval, or on flush), and (re)connects with an
+// exponential backoff. The loggers never wait for the network: while the server is slow or unreachable the messages
+// are kept up to max_buffer_size bytes, and the next ones are dropped (counted by dropped_messages()).
+// On Windows the background thread posts overlapped sends of the batches and waits for their completion on an
+// I/O completion port (see details::tcp_client::send_async()).
 
 namespace spdlog {
 namespace sinks {
@@ -33,6 +46,14 @@ struct tcp_sink_config
     int server_port;
     bool lazy_connect = false; // if true connect on first log call instead of on construction
 
+    // send from a background thread (see above). the connection is always lazy then.
+    bool background = false;
+    size_t batch_size = 64 * 1024;
+    std::chrono::milliseconds batch_interval{100};
+    size_t max_buffer_size = 4 * 1024 * 1024;
+    std::chrono::milliseconds reconnect_delay{100}; // after a failure, doubled on each failure up to max_reconnect_delay
+    std::chrono::milliseconds max_reconnect_delay{10000};
+
     tcp_sink_config(std::string host, int port)
         : server_host{std::move(host)}
         , server_port{port}
@@ -48,20 +69,61 @@ public:
 
     explicit tcp_sink(tcp_sink_config sink_config)
         : config_{std::move(sink_config)}
+        , reconnect_delay_{config_.reconnect_delay}
     {
-        if (!config_.lazy_connect)
+        if (config_.background)
+        {
+            sender_thread_ = std::thread([this] { sender_loop_(); });
+        }
+        else if (!config_.lazy_connect)
         {
             this->client_.connect(config_.server_host, config_.server_port);
         }
     }
 
-    ~tcp_sink() override = default;
+    ~tcp_sink() override
+    {
+        if (sender_thread_.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(buffer_mutex_);
+                stop_ = true;
+            }
+            buffer_cv_.notify_one();
+            sender_thread_.join();
+        }
+    }
+
+    // number of messages dropped because the send buffer was full (background mode)
+    size_t dropped_messages() const
+    {
+        return dropped_.load(std::memory_order_relaxed);
+    }
 
 protected:
     void sink_it_(const spdlog::details::log_msg &msg) override
     {
-        spdlog::memory_buf_t formatted;
-        spdlog::sinks::base_sink<Mutex>::formatter_->format(msg, formatted);
+        spdlog::details::scoped_buffer formatted_buffer;
+        auto &formatted = formatted_buffer.get();
+        size_t payload_pos;
+        if (!config_.background && spdlog::sinks::base_sink<Mutex>::format_split_(msg, formatted, payload_pos))
+        {
+            // the large payload is sent from the message, not copied into formatted
+            if (!client_.is_connected())
+            {
+                client_.connect(config_.server_host, config_.server_port);
+            }
+            string_view_t parts[] = {string_view_t(formatted.data(), payload_pos), msg.payload,
+                string_view_t(formatted.data() + payload_pos, formatted.size() - payload_pos)};
+            client_.send(parts, 3);
+            return;
+        }
+        spdlog::sinks::base_sink<Mutex>::format_(msg, formatted);
+        if (config_.background)
+        {
+            buffer_(formatted);
+            return;
+        }
         if (!client_.is_connected())
         {
             client_.connect(config_.server_host, config_.server_port);
@@ -69,9 +131,149 @@ protected:
         client_.send(formatted.data(), formatted.size());
     }
 
-    void flush_() override {}
+    void flush_() override
+    {
+        if (config_.background)
+        {
+            {
+                std::lock_guard<std::mutex> lock(buffer_mutex_);
+                flush_requested_ = true;
+            }
+            buffer_cv_.notify_one();
+        }
+    }
+
     tcp_sink_config config_;
     details::tcp_client client_;
+
+private:
+    // the messages sent by the background thread, and where they end (to skip the rest of a message
+    // partly sent on a lost connection)
+    struct batch
+    {
+        std::string data;
+        std::vector<size_t> ends;
+    };
+
+    void buffer_(const memory_buf_t &formatted)
+    {
+        bool full_batch;
+        {
+            std::lock_guard<std::mutex> lock(buffer_mutex_);
+            if (pending_.data.size() + sending_size_ + formatted.size() > config_.max_buffer_size)
+            {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            pending_.data.append(formatted.data(), formatted.size());
+            pending_.ends.push_back(pending_.data.size());
+            full_batch = pending_.data.size() >= config_.batch_size;
+        }
+        if (full_batch)
+        {
+            buffer_cv_.notify_one();
+        }
+    }
+
+    void sender_loop_()
+    {
+        batch sending;
+        size_t sent = 0;
+        std::unique_lock<std::mutex> lock(buffer_mutex_);
+        for (;;)
+        {
+            buffer_cv_.wait_for(
+                lock, config_.batch_interval, [this] { return stop_ || flush_requested_ || pending_.data.size() >= config_.batch_size; });
+            bool stopping = stop_;
+            flush_requested_ = false;
+            if (sent == sending.data.size())
+            {
+                sending.data.clear();
+                sending.ends.clear();
+                std::swap(sending, pending_);
+                sent = 0;
+            }
+            sending_size_ = sending.data.size() - sent;
+            lock.unlock();
+            send_batch_(sending, sent, stopping);
+            lock.lock();
+            sending_size_ = sending.data.size() - sent;
+            // when stopping, once more for the messages buffered meanwhile
+            if (stopping && (sent < sending.data.size() || pending_.data.empty()))
+            {
+                if (sent < sending.data.size())
+                {
+                    client_.close(); // ends a send in flight (overlapped on Windows) before the batch goes away
+                }
+                return;
+            }
+        }
+    }
+
+    // send what can be sent of the batch from the given offset, connecting first if needed.
+    // when stopping, try to send the rest for a second at most.
+    void send_batch_(const batch &sending, size_t &sent, bool stopping)
+    {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        while (sent < sending.data.size())
+        {
+            if (!client_.is_connected() && !connect_(stopping, sending, sent))
+            {
+                return;
+            }
+            SPDLOG_TRY
+            {
+#ifdef _WIN32
+                auto n_sent = client_.send_async(sending.data.data() + sent, sending.data.size() - sent, 100);
+#else
+                auto n_sent = client_.send_some(sending.data.data() + sent, sending.data.size() - sent, 100);
+#endif
+                sent += n_sent;
+                if (n_sent == 0 && (!stopping || std::chrono::steady_clock::now() >= deadline))
+                {
+                    return; // the server is slow: come back with a larger batch
+                }
+            }
+            SPDLOG_CATCH_STD
+        }
+    }
+
+    // connect unless waiting for the backoff delay. on a new connection, skip the rest of a message partly sent.
+    bool connect_(bool stopping, const batch &sending, size_t &sent)
+    {
+        auto now = std::chrono::steady_clock::now();
+        if (!stopping && now < next_connect_)
+        {
+            return false;
+        }
+        SPDLOG_TRY
+        {
+            client_.connect(config_.server_host, config_.server_port);
+            reconnect_delay_ = config_.reconnect_delay;
+            auto end = std::lower_bound(sending.ends.begin(), sending.ends.end(), sent);
+            if (sent > 0 && end != sending.ends.end() && *end != sent)
+            {
+                sent = *end;
+            }
+            return true;
+        }
+        SPDLOG_CATCH_STD
+        next_connect_ = now + reconnect_delay_;
+        reconnect_delay_ = (std::min)(reconnect_delay_ * 2, config_.max_reconnect_delay);
+        return false;
+    }
+
+    std::mutex buffer_mutex_;
+    std::condition_variable buffer_cv_;
+    batch pending_;
+    size_t sending_size_{0}; // not sent yet of the batch taken by the background thread
+    bool flush_requested_{false};
+    bool stop_{false};
+    std::atomic<size_t> dropped_{0};
+    // used by the background thread only
+    std::chrono::milliseconds reconnect_delay_;
+    std::chrono::steady_clock::time_point next_connect_{};
+    std::thread sender_thread_;
 };
 
 using tcp_sink_mt = tcp_sink<std::mutex>;
@@ -0,0 +1,120 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <spdlog/common.h>
+#include <spdlog/sinks/base_sink.h>
+#include <spdlog/details/datagram_batch.h>
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/details/scoped_buffer.h>
+#include <spdlog/details/synchronous_factory.h>
+#ifdef _WIN32
+#    include <spdlog/details/udp_client-windows.h>
+#else
+#    include <spdlog/details/udp_client.h>
+#endif
+
+#include <mutex>
+#include <string>
+
+// Simple udp client sink
+// Sends the formatted messages to a remote address, fire and forget.
+// The messages are packed into datagrams of up to max_datagram_size bytes (longer messages are truncated),
+// and the datagrams are sent batch_size at a time, with a single system call where available (sendmmsg),
+// and on flush. The datagrams the kernel didn't take (full send buffer ..) are counted by dropped_datagrams().
+
+namespace spdlog {
+namespace sinks {
+
+struct udp_sink_config
+{
+    std::string server_host;
+    int server_port;
+    size_t max_datagram_size = 1472; // an ethernet frame, without the ip and udp headers
+    size_t batch_size = 64;          // datagrams
+
+    udp_sink_config(std::string host, int port)
+        : server_host{std::move(host)}
+        , server_port{port}
+    {}
+};
+
+template<typename Mutex>
+class udp_sink : public spdlog::sinks::base_sink<Mutex>
+{
+public:
+    // resolve the host and open the socket or throw if failed
+    explicit udp_sink(udp_sink_config sink_config)
+        : config_{std::move(sink_config)}
+        , client_{config_.server_host, config_.server_port}
+        , batch_{config_.max_datagram_size}
+    {}
+
+    ~udp_sink() override
+    {
+        send_batch_();
+    }
+
+    size_t dropped_datagrams() const
+    {
+        std::lock_guard<Mutex> lock(this->mutex_);
+        return dropped_;
+    }
+
+protected:
+    void sink_it_(const spdlog::details::log_msg &msg) override
+    {
+        spdlog::details::scoped_buffer formatted_buffer;
+        auto &formatted = formatted_buffer.get();
+        spdlog::sinks::base_sink<Mutex>::format_(msg, formatted);
+        if (batch_.size() >= config_.batch_size && batch_.needs_new_datagram(formatted.size()))
+        {
+            send_batch_();
+        }
+        batch_.append(formatted.data(), formatted.size());
+    }
+
+    void flush_() override
+    {
+        send_batch_();
+    }
+
+    void send_batch_()
+    {
+        if (batch_.empty())
+        {
+            return;
+        }
+        auto sent = client_.send(batch_.data(), batch_.ends(), batch_.size());
+        dropped_ += batch_.size() - sent;
+        batch_.clear();
+    }
+
+    udp_sink_config config_;
+    details::udp_client client_;
+    details::datagram_batch batch_;
+    size_t dropped_ = 0;
+};
+
+using udp_sink_mt = udp_sink<std::mutex>;
+using udp_sink_st = udp_sink<spdlog::details::null_mutex>;
+
+} // namespace sinks
+
+//
+// factory functions
+//
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> udp_logger_mt(const std::string &logger_name, const std::string &host, int port)
+{
+    return Factory::template create<sinks::udp_sink_mt>(logger_name, sinks::udp_sink_config(host, port));
+}
+
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> udp_logger_st(const std::string &logger_name, const std::string &host, int port)
+{
+    return Factory::template create<sinks::udp_sink_st>(logger_name, sinks::udp_sink_config(host, port));
+}
+
+} // namespace spdlog
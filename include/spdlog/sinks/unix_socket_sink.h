@@ -0,0 +1,131 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <spdlog/common.h>
+#include <spdlog/sinks/base_sink.h>
+#include <spdlog/details/datagram_batch.h>
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/details/scoped_buffer.h>
+#include <spdlog/details/synchronous_factory.h>
+#include <spdlog/details/unix_socket_client.h>
+
+#include <mutex>
+#include <string>
+
+// Unix domain socket sink, for a log agent running on the same host (SOCK_DGRAM or SOCK_SEQPACKET).
+// Sends the formatted messages without going through the network stack, fire and forget, batched as in udp_sink:
+// the messages are packed into datagrams of up to max_datagram_size bytes (longer messages are truncated),
+// and the datagrams are sent batch_size at a time (with a single system call where available) and on flush.
+// If the agent isn't there, the datagrams are dropped (counted by dropped_datagrams()), and the sink connects
+// again on the next batch.
+
+namespace spdlog {
+namespace sinks {
+
+enum class unix_socket_type
+{
+    datagram,
+    seqpacket
+};
+
+struct unix_socket_sink_config
+{
+    std::string socket_path;
+    unix_socket_type type = unix_socket_type::datagram;
+    size_t max_datagram_size = 64 * 1024;
+    size_t batch_size = 64; // datagrams
+
+    explicit unix_socket_sink_config(std::string path, unix_socket_type socket_type = unix_socket_type::datagram)
+        : socket_path{std::move(path)}
+        , type{socket_type}
+    {}
+};
+
+template<typename Mutex>
+class unix_socket_sink : public spdlog::sinks::base_sink<Mutex>
+{
+public:
+    // connect if the agent is there. throw if the path is invalid.
+    explicit unix_socket_sink(unix_socket_sink_config sink_config)
+        : config_{std::move(sink_config)}
+        , client_{config_.socket_path, config_.type == unix_socket_type::seqpacket ? SOCK_SEQPACKET : SOCK_DGRAM}
+        , batch_{config_.max_datagram_size}
+    {
+        client_.connect();
+    }
+
+    ~unix_socket_sink() override
+    {
+        send_batch_();
+    }
+
+    size_t dropped_datagrams() const
+    {
+        std::lock_guard<Mutex> lock(this->mutex_);
+        return dropped_;
+    }
+
+protected:
+    void sink_it_(const spdlog::details::log_msg &msg) override
+    {
+        spdlog::details::scoped_buffer formatted_buffer;
+        auto &formatted = formatted_buffer.get();
+        spdlog::sinks::base_sink<Mutex>::format_(msg, formatted);
+        if (batch_.size() >= config_.batch_size && batch_.needs_new_datagram(formatted.size()))
+        {
+            send_batch_();
+        }
+        batch_.append(formatted.data(), formatted.size());
+    }
+
+    void flush_() override
+    {
+        send_batch_();
+    }
+
+    void send_batch_()
+    {
+        if (batch_.empty())
+        {
+            return;
+        }
+        size_t sent = 0;
+        if (client_.is_connected() || client_.connect())
+        {
+            sent = client_.send(batch_.data(), batch_.ends(), batch_.size());
+        }
+        dropped_ += batch_.size() - sent;
+        batch_.clear();
+    }
+
+    unix_socket_sink_config config_;
+    details::unix_socket_client client_;
+    details::datagram_batch batch_;
+    size_t dropped_ = 0;
+};
+
+using unix_socket_sink_mt = unix_socket_sink<std::mutex>;
+using unix_socket_sink_st = unix_socket_sink<spdlog::details::null_mutex>;
+
+} // namespace sinks
+
+//
+// factory functions
+//
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> unix_socket_logger_mt(
+    const std::string &logger_name, const std::string &socket_path, sinks::unix_socket_type type = sinks::unix_socket_type::datagram)
+{
+    return Factory::template create<sinks::unix_socket_sink_mt>(logger_name, sinks::unix_socket_sink_config(socket_path, type));
+}
+
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> unix_socket_logger_st(
+    const std::string &logger_name, const std::string &socket_path, sinks::unix_socket_type type = sinks::unix_socket_type::datagram)
+{
+    return Factory::template create<sinks::unix_socket_sink_st>(logger_name, sinks::unix_socket_sink_config(socket_path, type));
+}
+
+} // namespace spdlog
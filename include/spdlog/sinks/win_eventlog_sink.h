@@ -30,12 +30,15 @@ Windows Registry Editor Version 5.00
 
 #pragma once
 
+#include <spdlog/details/background_worker.h>
 #include <spdlog/details/null_mutex.h>
 #include <spdlog/sinks/base_sink.h>
+#include <spdlog/details/scoped_buffer.h>
 
 #include <spdlog/details/windows_include.h>
 #include <winbase.h>
 
+#include <memory>
 #include <mutex>
 #include <string>
 #include <vector>
@@ -189,6 +192,8 @@ struct eventlog
 
 /*
  * Windows Event Log sink
+ * In background mode the events are reported by a background thread (see details::background_worker):
+ * only the formatting is left on the logging threads. Its failures are thrown by the next log or flush.
  */
 template<typename Mutex>
 class win_eventlog_sink : public base_sink<Mutex>
@@ -198,6 +203,7 @@ private:
     internal::sid_t current_user_sid_;
     std::string source_;
     WORD event_id_;
+    std::unique_ptr<details::background_worker> background_worker_;
 
     HANDLE event_log_handle()
     {
@@ -218,37 +224,73 @@ protected:
     {
         using namespace internal;
 
-        bool succeeded;
-        memory_buf_t formatted;
-        base_sink<Mutex>::formatter_->format(msg, formatted);
+        details::scoped_buffer formatted_buffer;
+        auto &formatted = formatted_buffer.get();
+        base_sink<Mutex>::format_(msg, formatted);
         formatted.push_back('\0');
 
+        auto type = eventlog::get_event_type(msg);
+        auto category = eventlog::get_event_category(msg);
+        if (background_worker_)
+        {
+            throw_background_error_();
+            std::string text(formatted.data(), formatted.size());
+            background_worker_->post([this, type, category, text] { report_(type, category, text.data(), text.size()); });
+            return;
+        }
+        report_(type, category, formatted.data(), formatted.size());
+    }
+
+    void flush_() override
+    {
+        if (background_worker_)
+        {
+            background_worker_->wait_idle();
+            throw_background_error_();
+        }
+    }
+
+    // report the null terminated text (size includes the terminator)
+    void report_(WORD type, WORD category, const char *text, size_t size)
+    {
+        bool succeeded;
 #ifdef SPDLOG_WCHAR_TO_UTF8_SUPPORT
         wmemory_buf_t buf;
-        details::os::utf8_to_wstrbuf(string_view_t(formatted.data(), formatted.size()), buf);
+        details::os::utf8_to_wstrbuf(string_view_t(text, size), buf);
 
         LPCWSTR lp_wstr = buf.data();
-        succeeded = ::ReportEventW(event_log_handle(), eventlog::get_event_type(msg), eventlog::get_event_category(msg), event_id_,
-            current_user_sid_.as_sid(), 1, 0, &lp_wstr, nullptr);
+        succeeded =
+            ::ReportEventW(event_log_handle(), type, category, event_id_, current_user_sid_.as_sid(), 1, 0, &lp_wstr, nullptr);
 #else
-        LPCSTR lp_str = formatted.data();
-        succeeded = ::ReportEventA(event_log_handle(), eventlog::get_event_type(msg), eventlog::get_event_category(msg), event_id_,
-            current_user_sid_.as_sid(), 1, 0, &lp_str, nullptr);
+        (void)size;
+        LPCSTR lp_str = text;
+        succeeded = ::ReportEventA(event_log_handle(), type, category, event_id_, current_user_sid_.as_sid(), 1, 0, &lp_str, nullptr);
 #endif
 
         if (!succeeded)
         {
-            SPDLOG_THROW(win32_error("ReportEvent"));
+            SPDLOG_THROW(internal::win32_error("ReportEvent"));
         }
     }
 
-    void flush_() override {}
+    void throw_background_error_()
+    {
+        auto error = background_worker_->take_error();
+        if (!error.empty())
+        {
+            throw_spdlog_ex(error);
+        }
+    }
 
 public:
-    win_eventlog_sink(std::string const &source, WORD event_id = 1000 /* according to mscoree.dll */)
+    win_eventlog_sink(std::string const &source, WORD event_id = 1000 /* according to mscoree.dll */, bool background = false)
         : source_(source)
         , event_id_(event_id)
     {
+        if (background)
+        {
+            background_worker_ = details::make_unique<details::background_worker>();
+        }
         try
         {
             current_user_sid_ = internal::sid_t::get_current_user_sid();
@@ -262,6 +304,8 @@ public:
 
     ~win_eventlog_sink()
     {
+        // report the events left first
+        background_worker_.reset();
         if (hEventLog_)
             DeregisterEventSource(hEventLog_);
     }
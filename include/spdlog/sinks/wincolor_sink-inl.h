@@ -12,6 +12,12 @@
 
 #include <spdlog/common.h>
 #include <spdlog/pattern_formatter.h>
+#include <spdlog/details/fmt_helper.h>
+#include <spdlog/details/scoped_buffer.h>
+
+#ifndef ENABLE_VIRTUAL_TERMINAL_PROCESSING
+#    define ENABLE_VIRTUAL_TERMINAL_PROCESSING 0x0004
+#endif
 
 namespace spdlog {
 namespace sinks {
@@ -57,10 +63,19 @@ void SPDLOG_INLINE wincolor_sink<ConsoleMutex>::log(const details::log_msg &msg)
     }
 
     std::lock_guard<mutex_t> lock(mutex_);
+    details::profile_timer timer;
+    details::scoped_buffer formatted_buffer;
+    auto &formatted = formatted_buffer.get();
+    if (should_do_colors_ && virtual_terminal_)
+    {
+        format_colored_(msg, formatted);
+        write_console_(formatted);
+        profile_.on_sunk(1, timer);
+        return;
+    }
     msg.color_range_start = 0;
     msg.color_range_end = 0;
-    memory_buf_t formatted;
-    formatter_->format(msg, formatted);
+    format_with_(*formatter_, msg, formatted);
     if (should_do_colors_ && msg.color_range_end > msg.color_range_start)
     {
         // before color range
@@ -76,6 +91,37 @@ void SPDLOG_INLINE wincolor_sink<ConsoleMutex>::log(const details::log_msg &msg)
     {
         write_to_file_(formatted);
     }
+    profile_.on_sunk(1, timer);
+}
+
+template<typename ConsoleMutex>
+void SPDLOG_INLINE wincolor_sink<ConsoleMutex>::log_batch(const details::log_msg *msgs, size_t n_msgs)
+{
+    if (out_handle_ == nullptr || out_handle_ == INVALID_HANDLE_VALUE)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<mutex_t> lock(mutex_);
+        if (should_do_colors_ && virtual_terminal_)
+        {
+            details::profile_timer timer;
+            details::scoped_buffer formatted_buffer;
+            auto &formatted = formatted_buffer.get();
+            for (size_t i = 0; i < n_msgs; i++)
+            {
+                if (should_log(msgs[i].level))
+                {
+                    format_colored_(msgs[i], formatted);
+                }
+            }
+            write_console_(formatted);
+            profile_.on_sunk_batch(msgs, n_msgs, level(), timer);
+            return;
+        }
+    }
+    sink::log_batch(msgs, n_msgs);
 }
 
 template<typename ConsoleMutex>
@@ -119,6 +165,15 @@ void SPDLOG_INLINE wincolor_sink<ConsoleMutex>::set_color_mode_impl(color_mode m
     {
         should_do_colors_ = mode == color_mode::always ? true : false;
     }
+
+    // escape sequences instead of console attributes, if supported
+    DWORD console_mode;
+    virtual_terminal_ = false;
+    if (should_do_colors_ && ::GetConsoleMode(static_cast<HANDLE>(out_handle_), &console_mode))
+    {
+        virtual_terminal_ = (console_mode & ENABLE_VIRTUAL_TERMINAL_PROCESSING) != 0 ||
+                            ::SetConsoleMode(static_cast<HANDLE>(out_handle_), console_mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING) != 0;
+    }
 }
 
 // set foreground color and return the orig console attributes (for resetting later)
@@ -160,6 +215,63 @@ void SPDLOG_INLINE wincolor_sink<ConsoleMutex>::write_to_file_(const memory_buf_
     (void)(ignored);
 }
 
+template<typename ConsoleMutex>
+void SPDLOG_INLINE wincolor_sink<ConsoleMutex>::format_colored_(const details::log_msg &msg, memory_buf_t &dest)
+{
+    msg.color_range_start = 0;
+    msg.color_range_end = 0;
+    details::scoped_buffer formatted_buffer;
+    auto &formatted = formatted_buffer.get();
+    format_with_(*formatter_, msg, formatted);
+    if (msg.color_range_end <= msg.color_range_start)
+    {
+        dest.append(formatted.data(), formatted.data() + formatted.size());
+        return;
+    }
+
+    // the console attributes as SGR parameters: foreground 30-37 (90-97 intense), background 40-47 (100-107)
+    auto attribs = colors_[msg.level];
+    auto rgb = [](bool red, bool green, bool blue) { return (red ? 1 : 0) | (green ? 2 : 0) | (blue ? 4 : 0); };
+    dest.append(formatted.data(), formatted.data() + msg.color_range_start);
+    dest.push_back('\x1b');
+    dest.push_back('[');
+    details::fmt_helper::append_int((attribs & FOREGROUND_INTENSITY ? 90 : 30) +
+                                        rgb(attribs & FOREGROUND_RED, attribs & FOREGROUND_GREEN, attribs & FOREGROUND_BLUE),
+        dest);
+    if (attribs & 0xf0)
+    {
+        dest.push_back(';');
+        details::fmt_helper::append_int((attribs & BACKGROUND_INTENSITY ? 100 : 40) +
+                                            rgb(attribs & BACKGROUND_RED, attribs & BACKGROUND_GREEN, attribs & BACKGROUND_BLUE),
+            dest);
+    }
+    dest.push_back('m');
+    dest.append(formatted.data() + msg.color_range_start, formatted.data() + msg.color_range_end);
+    static const char reset[] = "\x1b[0m";
+    dest.append(reset, reset + sizeof(reset) - 1);
+    dest.append(formatted.data() + msg.color_range_end, formatted.data() + formatted.size());
+}
+
+template<typename ConsoleMutex>
+void SPDLOG_INLINE wincolor_sink<ConsoleMutex>::write_console_(const memory_buf_t &text)
+{
+    if (text.size() == 0)
+    {
+        return;
+    }
+    auto size = static_cast<int>(text.size());
+    auto wide_size = ::MultiByteToWideChar(CP_UTF8, 0, text.data(), size, nullptr, 0);
+    if (wide_size <= 0)
+    {
+        return;
+    }
+    wmemory_buf_t wide;
+    wide.resize(static_cast<size_t>(wide_size));
+    ::MultiByteToWideChar(CP_UTF8, 0, text.data(), size, wide.data(), wide_size);
+    auto ignored = ::WriteConsoleW(static_cast<HANDLE>(out_handle_), wide.data(), static_cast<DWORD>(wide_size), nullptr, nullptr);
+    (void)(ignored);
+}
+
 // wincolor_stdout_sink
 template<typename ConsoleMutex>
 SPDLOG_INLINE wincolor_stdout_sink<ConsoleMutex>::wincolor_stdout_sink(color_mode mode)
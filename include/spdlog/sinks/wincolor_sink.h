@@ -18,7 +18,9 @@ namespace spdlog {
 namespace sinks {
 /*
  * Windows color console sink. Uses WriteConsoleA to write to the console with
- * colors
+ * colors.
+ * If the console processes virtual terminal sequences (windows 10 and later), the colors are escape
+ * sequences instead: each message, or batch of messages, is then written with a single WriteConsoleW.
  */
 template<typename ConsoleMutex>
 class wincolor_sink : public sink
@@ -33,6 +35,7 @@ public:
     // change the color for the given level
     void set_color(level::level_enum level, std::uint16_t color);
     void log(const details::log_msg &msg) final override;
+    void log_batch(const details::log_msg *msgs, size_t n_msgs) final override;
     void flush() final override;
     void set_pattern(const std::string &pattern) override final;
     void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override final;
@@ -43,6 +46,7 @@ protected:
     void *out_handle_;
     mutex_t &mutex_;
     bool should_do_colors_;
+    bool virtual_terminal_{false};
     std::unique_ptr<spdlog::formatter> formatter_;
     std::array<std::uint16_t, level::n_levels> colors_;
 
@@ -55,6 +59,11 @@ protected:
     // in case we are redirected to file (not in console mode)
     void write_to_file_(const memory_buf_t &formatted);
 
+    // virtual terminal mode: append msg formatted, its color range within escape sequences
+    void format_colored_(const details::log_msg &msg, memory_buf_t &dest);
+    // virtual terminal mode: write the utf-8 text in one call
+    void write_console_(const memory_buf_t &text);
+
     void set_color_mode_impl(color_mode mode);
 };
 
@@ -77,6 +86,17 @@ using wincolor_stdout_sink_st = wincolor_stdout_sink<details::console_nullmutex>
 
 using wincolor_stderr_sink_mt = wincolor_stderr_sink<details::console_mutex>;
 using wincolor_stderr_sink_st = wincolor_stderr_sink<details::console_nullmutex>;
+
+#ifdef SPDLOG_COMPILED_LIB
+// instantiated in src/color_sinks.cpp
+extern template class SPDLOG_API wincolor_sink<details::console_mutex>;
+extern template class SPDLOG_API wincolor_sink<details::console_nullmutex>;
+extern template class SPDLOG_API wincolor_stdout_sink<details::console_mutex>;
+extern template class SPDLOG_API wincolor_stdout_sink<details::console_nullmutex>;
+extern template class SPDLOG_API wincolor_stderr_sink<details::console_mutex>;
+extern template class SPDLOG_API wincolor_stderr_sink<details::console_nullmutex>;
+#endif
+
 } // namespace sinks
 } // namespace spdlog
 
@@ -17,7 +17,12 @@ SPDLOG_INLINE void initialize_logger(std::shared_ptr<logger> logger)
     details::registry::instance().initialize_logger(std::move(logger));
 }
 
-SPDLOG_INLINE std::shared_ptr<logger> get(const std::string &name)
+SPDLOG_INLINE void initialize_loggers(std::vector<std::shared_ptr<logger>> loggers)
+{
+    details::registry::instance().initialize_loggers(std::move(loggers));
+}
+
+SPDLOG_INLINE std::shared_ptr<logger> get(string_view_t name)
 {
     return details::registry::instance().get(name);
 }
@@ -44,17 +49,17 @@ SPDLOG_INLINE void disable_backtrace()
 
 SPDLOG_INLINE void dump_backtrace()
 {
-    default_logger_raw()->dump_backtrace();
+    pinned_default_logger()->dump_backtrace();
 }
 
 SPDLOG_INLINE level::level_enum get_level()
 {
-    return default_logger_raw()->level();
+    return pinned_default_logger()->level();
 }
 
 SPDLOG_INLINE bool should_log(level::level_enum log_level)
 {
-    return default_logger_raw()->should_log(log_level);
+    return pinned_default_logger()->should_log(log_level);
 }
 
 SPDLOG_INLINE void set_level(level::level_enum log_level)
@@ -62,16 +67,31 @@ SPDLOG_INLINE void set_level(level::level_enum log_level)
     details::registry::instance().set_level(log_level);
 }
 
+SPDLOG_INLINE void set_level(const std::string &logger_name, level::level_enum log_level)
+{
+    details::registry::instance().set_level(logger_name, log_level);
+}
+
 SPDLOG_INLINE void flush_on(level::level_enum log_level)
 {
     details::registry::instance().flush_on(log_level);
 }
 
-SPDLOG_INLINE void flush_every(std::chrono::seconds interval)
+SPDLOG_INLINE void flush_every(std::chrono::nanoseconds interval)
 {
     details::registry::instance().flush_every(interval);
 }
 
+SPDLOG_INLINE void flush_all()
+{
+    details::registry::instance().flush_all();
+}
+
+SPDLOG_INLINE void set_flush_threads(size_t threads)
+{
+    details::registry::instance().set_flush_threads(threads);
+}
+
 SPDLOG_INLINE void set_error_handler(void (*handler)(const std::string &msg))
 {
     details::registry::instance().set_error_handler(handler);
@@ -82,6 +102,11 @@ SPDLOG_INLINE void register_logger(std::shared_ptr<logger> logger)
     details::registry::instance().register_logger(std::move(logger));
 }
 
+SPDLOG_INLINE void register_loggers(std::vector<std::shared_ptr<logger>> loggers)
+{
+    details::registry::instance().register_loggers(std::move(loggers));
+}
+
 SPDLOG_INLINE void apply_all(const std::function<void(std::shared_ptr<logger>)> &fun)
 {
     details::registry::instance().apply_all(fun);
@@ -102,11 +127,31 @@ SPDLOG_INLINE void shutdown()
     details::registry::instance().shutdown();
 }
 
+SPDLOG_INLINE void shutdown(std::chrono::nanoseconds drain_timeout)
+{
+    details::registry::instance().shutdown(drain_timeout);
+}
+
 SPDLOG_INLINE void set_automatic_registration(bool automatic_registration)
 {
     details::registry::instance().set_automatic_registration(automatic_registration);
 }
 
+SPDLOG_INLINE void set_trace_context(const trace_context &context)
+{
+    details::thread_trace_context() = context;
+}
+
+SPDLOG_INLINE trace_context get_trace_context()
+{
+    return details::thread_trace_context();
+}
+
+SPDLOG_INLINE void clear_trace_context()
+{
+    details::thread_trace_context() = trace_context{};
+}
+
 SPDLOG_INLINE std::shared_ptr<spdlog::logger> default_logger()
 {
     return details::registry::instance().default_logger();
@@ -117,6 +162,48 @@ SPDLOG_INLINE spdlog::logger *default_logger_raw()
     return details::registry::instance().get_default_raw();
 }
 
+SPDLOG_INLINE details::pinned_logger pinned_default_logger()
+{
+    return details::registry::instance().pin_default();
+}
+
+SPDLOG_INLINE void set_call_site_enabled(const std::string &filename, int line, bool enabled)
+{
+    details::call_site::set_enabled(filename, line, enabled);
+}
+
+SPDLOG_INLINE void set_logger_call_sites_enabled(const std::string &logger_name, bool enabled)
+{
+    details::call_site::set_logger_enabled(logger_name, enabled);
+}
+
+#ifdef SPDLOG_CALL_SITE_STATS
+SPDLOG_INLINE std::vector<call_site_stats> top_call_sites(size_t n)
+{
+    return details::call_site::top(n);
+}
+#endif
+
+SPDLOG_INLINE void set_memory_budget(size_t bytes)
+{
+    details::memory_account::set_budget(bytes);
+}
+
+SPDLOG_INLINE size_t memory_used()
+{
+    return details::memory_account::global().used();
+}
+
+SPDLOG_INLINE size_t memory_peak()
+{
+    return details::memory_account::global().peak();
+}
+
+SPDLOG_INLINE size_t memory_truncated_messages()
+{
+    return details::memory_account::truncated_messages();
+}
+
 SPDLOG_INLINE void set_default_logger(std::shared_ptr<spdlog::logger> default_logger)
 {
     details::registry::instance().set_default_logger(std::move(default_logger));
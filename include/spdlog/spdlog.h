@@ -10,6 +10,8 @@
 #pragma once
 
 #include <spdlog/common.h>
+#include <spdlog/details/call_site.h>
+#include <spdlog/details/call_throttle.h>
 #include <spdlog/details/registry.h>
 #include <spdlog/logger.h>
 #include <spdlog/version.h>
@@ -19,6 +21,7 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace spdlog {
 
@@ -46,10 +49,14 @@ inline std::shared_ptr<spdlog::logger> create(std::string logger_name, SinkArgs
 //   spdlog::initialize_logger(mylogger);
 SPDLOG_API void initialize_logger(std::shared_ptr<logger> logger);
 
+// Initialize and register the loggers at once (faster than one by one when creating many loggers).
+// Throws before registering any of them if a name is already taken.
+SPDLOG_API void initialize_loggers(std::vector<std::shared_ptr<logger>> loggers);
+
 // Return an existing logger or nullptr if a logger with such name doesn't
 // exist.
 // example: spdlog::get("my_logger")->info("hello {}", "world");
-SPDLOG_API std::shared_ptr<logger> get(const std::string &name);
+SPDLOG_API std::shared_ptr<logger> get(string_view_t name);
 
 // Set global formatter. Each sink in each logger will get a clone of this object
 SPDLOG_API void set_formatter(std::unique_ptr<spdlog::formatter> formatter);
@@ -73,15 +80,27 @@ SPDLOG_API level::level_enum get_level();
 // Set global logging level
 SPDLOG_API void set_level(level::level_enum log_level);
 
+// Set the level of the given logger and of its descendants, existing and future: the loggers
+// named logger_name + '.' + ... (e.g. "net" for "net.http" and "net.http.client"), unless they
+// or a closer ancestor have their own level. See also cfg::load_env_levels().
+SPDLOG_API void set_level(const std::string &logger_name, level::level_enum log_level);
+
 // Determine whether the default logger should log messages with a certain level
 SPDLOG_API bool should_log(level::level_enum lvl);
 
 // Set global flush level
 SPDLOG_API void flush_on(level::level_enum log_level);
 
-// Start/Restart a periodic flusher thread
+// Start/Restart a periodic flusher (on the shared timer thread, see details/timer_wheel.h).
+// Sub-second intervals are supported, e.g. flush_every(std::chrono::milliseconds(100)). Non positive intervals stop it.
 // Warning: Use only if all your loggers are thread safe!
-SPDLOG_API void flush_every(std::chrono::seconds interval);
+SPDLOG_API void flush_every(std::chrono::nanoseconds interval);
+
+// Flush the registered loggers, each of their distinct sinks once (see registry::flush_all())
+SPDLOG_API void flush_all();
+
+// Flush the sinks of the (sync) registered loggers with up to the given number of threads in flush_all()
+SPDLOG_API void set_flush_threads(size_t threads);
 
 // Set global error handler
 SPDLOG_API void set_error_handler(void (*handler)(const std::string &msg));
@@ -89,6 +108,9 @@ SPDLOG_API void set_error_handler(void (*handler)(const std::string &msg));
 // Register the given logger with the given name
 SPDLOG_API void register_logger(std::shared_ptr<logger> logger);
 
+// Register the given loggers at once
+SPDLOG_API void register_loggers(std::vector<std::shared_ptr<logger>> loggers);
+
 // Apply a user defined function on all registered loggers
 // Example:
 // spdlog::apply_all([&](std::shared_ptr<spdlog::logger> l) {l->flush();});
@@ -100,12 +122,47 @@ SPDLOG_API void drop(const std::string &name);
 // Drop all references from the registry
 SPDLOG_API void drop_all();
 
-// stop any running threads started by spdlog and clean registry loggers
+// stop any running threads started by spdlog and clean registry loggers, after flushing them
 SPDLOG_API void shutdown();
 
+// same, the thread pools dropping the messages not written by drain_timeout, e.g. shutdown(std::chrono::seconds(2))
+SPDLOG_API void shutdown(std::chrono::nanoseconds drain_timeout);
+
 // Automatic registration of loggers when using spdlog::create() or spdlog::create_async
 SPDLOG_API void set_automatic_registration(bool automatic_registration);
 
+// Set the trace context stamped on the messages logged by the calling thread (from then on, until cleared),
+// rendered by the %Q (trace id) and %q (span id) pattern flags, and by the json and binary formatters.
+// Example, around a request handler:
+// spdlog::scoped_trace_context trace(request_trace_context);
+SPDLOG_API void set_trace_context(const trace_context &context);
+
+SPDLOG_API trace_context get_trace_context();
+
+SPDLOG_API void clear_trace_context();
+
+// Set the trace context of the calling thread for the scope, then restore the previous one
+class scoped_trace_context
+{
+public:
+    explicit scoped_trace_context(const trace_context &context)
+        : previous_(get_trace_context())
+    {
+        set_trace_context(context);
+    }
+
+    scoped_trace_context(const scoped_trace_context &) = delete;
+    scoped_trace_context &operator=(const scoped_trace_context &) = delete;
+
+    ~scoped_trace_context()
+    {
+        set_trace_context(previous_);
+    }
+
+private:
+    trace_context previous_;
+};
+
 // API for using default logger (stdout_color_mt),
 // e.g: spdlog::info("Message {}", 1);
 //
@@ -116,161 +173,237 @@ SPDLOG_API void set_automatic_registration(bool automatic_registration);
 // The default logger can replaced using spdlog::set_default_logger(new_logger).
 // For example, to replace it with a file logger.
 //
+// The default API is thread safe (for _mt loggers), and set_default_logger() can be used concurrently with it:
+// each call pins the default logger (without locking), and set_default_logger() waits for the calls using the
+// previous one before releasing it.
 // IMPORTANT:
-// The default API is thread safe (for _mt loggers), but:
-// set_default_logger() *should not* be used concurrently with the default API.
-// e.g do not call set_default_logger() from one thread while calling spdlog::info() from another.
+// The pointer returned by default_logger_raw() is not pinned: do not keep it while set_default_logger() may run.
 
 SPDLOG_API std::shared_ptr<spdlog::logger> default_logger();
 
 SPDLOG_API spdlog::logger *default_logger_raw();
 
+// The default logger, pinned until the end of the full expression, e.g. pinned_default_logger()->info("..").
+SPDLOG_API details::pinned_logger pinned_default_logger();
+
+// Enable/disable at runtime the SPDLOG_LOGGER_CALL macros (SPDLOG_INFO(..), SPDLOG_LOGGER_WARN(..) ..)
+// of the given source file, matched against the end of __FILE__ (e.g. "net/server.cpp"),
+// at the given line or at all its lines if line is 0. The call sites not reached yet are affected too.
+SPDLOG_API void set_call_site_enabled(const std::string &filename, int line, bool enabled);
+
+// Enable/disable at runtime the SPDLOG_LOGGER_CALL macros called with the given logger.
+// It applies after the previous set_call_site_enabled()/set_logger_call_sites_enabled() calls: the last matching one wins.
+SPDLOG_API void set_logger_call_sites_enabled(const std::string &logger_name, bool enabled);
+
+#ifdef SPDLOG_CALL_SITE_STATS
+// The n SPDLOG_LOGGER_CALL macros which logged the most so far, by payload bytes then messages, e.g. to find
+// the source of a spike of log volume. Only counted with SPDLOG_CALL_SITE_STATS (see details/call_site.h).
+SPDLOG_API std::vector<call_site_stats> top_call_sites(size_t n);
+#endif
+
+// Memory of the stored messages (async queues, backtraces, ringbuffer sinks) beyond their fixed slots, see
+// details/memory_account.h. Past the budget (in bytes, 0: unlimited) the long messages are cut to fit their slot.
+SPDLOG_API void set_memory_budget(size_t bytes);
+SPDLOG_API size_t memory_used();
+SPDLOG_API size_t memory_peak();
+// the messages cut to fit the memory budget so far
+SPDLOG_API size_t memory_truncated_messages();
+
 SPDLOG_API void set_default_logger(std::shared_ptr<spdlog::logger> default_logger);
 
 template<typename... Args>
 inline void log(source_loc source, level::level_enum lvl, fmt::format_string<Args...> fmt, Args &&...args)
 {
-    default_logger_raw()->log(source, lvl, fmt, std::forward<Args>(args)...);
+    pinned_default_logger()->log(source, lvl, fmt, std::forward<Args>(args)...);
 }
 
 template<typename... Args>
 inline void log(level::level_enum lvl, fmt::format_string<Args...> fmt, Args &&...args)
 {
-    default_logger_raw()->log(source_loc{}, lvl, fmt, std::forward<Args>(args)...);
+    pinned_default_logger()->log(source_loc{}, lvl, fmt, std::forward<Args>(args)...);
 }
 
 template<typename... Args>
 inline void trace(fmt::format_string<Args...> fmt, Args &&...args)
 {
-    default_logger_raw()->trace(fmt, std::forward<Args>(args)...);
+    pinned_default_logger()->trace(fmt, std::forward<Args>(args)...);
 }
 
 template<typename... Args>
 inline void debug(fmt::format_string<Args...> fmt, Args &&...args)
 {
-    default_logger_raw()->debug(fmt, std::forward<Args>(args)...);
+    pinned_default_logger()->debug(fmt, std::forward<Args>(args)...);
 }
 
 template<typename... Args>
 inline void info(fmt::format_string<Args...> fmt, Args &&...args)
 {
-    default_logger_raw()->info(fmt, std::forward<Args>(args)...);
+    pinned_default_logger()->info(fmt, std::forward<Args>(args)...);
 }
 
 template<typename... Args>
 inline void warn(fmt::format_string<Args...> fmt, Args &&...args)
 {
-    default_logger_raw()->warn(fmt, std::forward<Args>(args)...);
+    pinned_default_logger()->warn(fmt, std::forward<Args>(args)...);
 }
 
 template<typename... Args>
 inline void error(fmt::format_string<Args...> fmt, Args &&...args)
 {
-    default_logger_raw()->error(fmt, std::forward<Args>(args)...);
+    pinned_default_logger()->error(fmt, std::forward<Args>(args)...);
 }
 
 template<typename... Args>
 inline void critical(fmt::format_string<Args...> fmt, Args &&...args)
 {
-    default_logger_raw()->critical(fmt, std::forward<Args>(args)...);
+    pinned_default_logger()->critical(fmt, std::forward<Args>(args)...);
+}
+
+// structured logging (see logger::log(loc, lvl, msg, fields..))
+template<typename... Fields, typename std::enable_if<details::are_fields<Fields...>::value, int>::type = 0>
+inline void log(source_loc source, level::level_enum lvl, const char *msg, Fields &&...fields)
+{
+    pinned_default_logger()->log(source, lvl, msg, std::forward<Fields>(fields)...);
+}
+
+template<typename... Fields, typename std::enable_if<details::are_fields<Fields...>::value, int>::type = 0>
+inline void log(level::level_enum lvl, const char *msg, Fields &&...fields)
+{
+    pinned_default_logger()->log(source_loc{}, lvl, msg, std::forward<Fields>(fields)...);
+}
+
+template<typename... Fields, typename std::enable_if<details::are_fields<Fields...>::value, int>::type = 0>
+inline void trace(const char *msg, Fields &&...fields)
+{
+    pinned_default_logger()->trace(msg, std::forward<Fields>(fields)...);
+}
+
+template<typename... Fields, typename std::enable_if<details::are_fields<Fields...>::value, int>::type = 0>
+inline void debug(const char *msg, Fields &&...fields)
+{
+    pinned_default_logger()->debug(msg, std::forward<Fields>(fields)...);
+}
+
+template<typename... Fields, typename std::enable_if<details::are_fields<Fields...>::value, int>::type = 0>
+inline void info(const char *msg, Fields &&...fields)
+{
+    pinned_default_logger()->info(msg, std::forward<Fields>(fields)...);
+}
+
+template<typename... Fields, typename std::enable_if<details::are_fields<Fields...>::value, int>::type = 0>
+inline void warn(const char *msg, Fields &&...fields)
+{
+    pinned_default_logger()->warn(msg, std::forward<Fields>(fields)...);
+}
+
+template<typename... Fields, typename std::enable_if<details::are_fields<Fields...>::value, int>::type = 0>
+inline void error(const char *msg, Fields &&...fields)
+{
+    pinned_default_logger()->error(msg, std::forward<Fields>(fields)...);
+}
+
+template<typename... Fields, typename std::enable_if<details::are_fields<Fields...>::value, int>::type = 0>
+inline void critical(const char *msg, Fields &&...fields)
+{
+    pinned_default_logger()->critical(msg, std::forward<Fields>(fields)...);
 }
 
 template<typename T>
 inline void log(source_loc source, level::level_enum lvl, const T &msg)
 {
-    default_logger_raw()->log(source, lvl, msg);
+    pinned_default_logger()->log(source, lvl, msg);
 }
 
 template<typename T>
 inline void log(level::level_enum lvl, const T &msg)
 {
-    default_logger_raw()->log(lvl, msg);
+    pinned_default_logger()->log(lvl, msg);
 }
 
 #ifdef SPDLOG_WCHAR_TO_UTF8_SUPPORT
 template<typename... Args>
 inline void log(source_loc source, level::level_enum lvl, fmt::wformat_string<Args...> fmt, Args &&...args)
 {
-    default_logger_raw()->log(source, lvl, fmt, std::forward<Args>(args)...);
+    pinned_default_logger()->log(source, lvl, fmt, std::forward<Args>(args)...);
 }
 
 template<typename... Args>
 inline void log(level::level_enum lvl, fmt::wformat_string<Args...> fmt, Args &&...args)
 {
-    default_logger_raw()->log(source_loc{}, lvl, fmt, std::forward<Args>(args)...);
+    pinned_default_logger()->log(source_loc{}, lvl, fmt, std::forward<Args>(args)...);
 }
 
 template<typename... Args>
 inline void trace(fmt::wformat_string<Args...> fmt, Args &&...args)
 {
-    default_logger_raw()->trace(fmt, std::forward<Args>(args)...);
+    pinned_default_logger()->trace(fmt, std::forward<Args>(args)...);
 }
 
 template<typename... Args>
 inline void debug(fmt::wformat_string<Args...> fmt, Args &&...args)
 {
-    default_logger_raw()->debug(fmt, std::forward<Args>(args)...);
+    pinned_default_logger()->debug(fmt, std::forward<Args>(args)...);
 }
 
 template<typename... Args>
 inline void info(fmt::wformat_string<Args...> fmt, Args &&...args)
 {
-    default_logger_raw()->info(fmt, std::forward<Args>(args)...);
+    pinned_default_logger()->info(fmt, std::forward<Args>(args)...);
 }
 
 template<typename... Args>
 inline void warn(fmt::wformat_string<Args...> fmt, Args &&...args)
 {
-    default_logger_raw()->warn(fmt, std::forward<Args>(args)...);
+    pinned_default_logger()->warn(fmt, std::forward<Args>(args)...);
 }
 
 template<typename... Args>
 inline void error(fmt::wformat_string<Args...> fmt, Args &&...args)
 {
-    default_logger_raw()->error(fmt, std::forward<Args>(args)...);
+    pinned_default_logger()->error(fmt, std::forward<Args>(args)...);
 }
 
 template<typename... Args>
 inline void critical(fmt::wformat_string<Args...> fmt, Args &&...args)
 {
-    default_logger_raw()->critical(fmt, std::forward<Args>(args)...);
+    pinned_default_logger()->critical(fmt, std::forward<Args>(args)...);
 }
 #endif
 
 template<typename T>
 inline void trace(const T &msg)
 {
-    default_logger_raw()->trace(msg);
+    pinned_default_logger()->trace(msg);
 }
 
 template<typename T>
 inline void debug(const T &msg)
 {
-    default_logger_raw()->debug(msg);
+    pinned_default_logger()->debug(msg);
 }
 
 template<typename T>
 inline void info(const T &msg)
 {
-    default_logger_raw()->info(msg);
+    pinned_default_logger()->info(msg);
 }
 
 template<typename T>
 inline void warn(const T &msg)
 {
-    default_logger_raw()->warn(msg);
+    pinned_default_logger()->warn(msg);
 }
 
 template<typename T>
 inline void error(const T &msg)
 {
-    default_logger_raw()->error(msg);
+    pinned_default_logger()->error(msg);
 }
 
 template<typename T>
 inline void critical(const T &msg)
 {
-    default_logger_raw()->critical(msg);
+    pinned_default_logger()->critical(msg);
 }
 
 } // namespace spdlog
@@ -288,54 +421,193 @@ inline void critical(const T &msg)
 // SPDLOG_LEVEL_OFF
 //
 
-#define SPDLOG_LOGGER_CALL(logger, level, ...) (logger)->log(spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION}, level, __VA_ARGS__)
+// The compile time threshold of the SPDLOG_LOGGER_CALL macros, checked where each is expanded: a module (a source
+// file, or the part of a file after it is redefined) can compile out its calls below a level, e.g.
+//
+//     #include <spdlog/spdlog.h>
+//     #undef SPDLOG_MODULE_LEVEL
+//     #define SPDLOG_MODULE_LEVEL SPDLOG_LEVEL_WARN // the hot loop of this file: no trace to info calls
+//
+// Also a constant per category, e.g. "#define SPDLOG_MODULE_LEVEL net_log_level" in the header of a component.
+// It can only add to SPDLOG_ACTIVE_LEVEL: the SPDLOG_TRACE(..) .. macros below that are compiled out regardless.
+#ifndef SPDLOG_MODULE_LEVEL
+#    define SPDLOG_MODULE_LEVEL SPDLOG_LEVEL_TRACE
+#endif
+
+// Each call site checks its cached level first (see details/call_site.h): the arguments are not evaluated if disabled
+// (and not kept by a tail sampling scope of the thread, see tail_sampling.h, nor by the flight recorder).
+#define SPDLOG_LOGGER_CALL(logger, level, ...)                                                                                             \
+    do                                                                                                                                     \
+    {                                                                                                                                      \
+        if (spdlog::details::module_allows(level, SPDLOG_MODULE_LEVEL))                                                                    \
+        {                                                                                                                                  \
+            static spdlog::details::call_site spdlog_call_site_(__FILE__, __LINE__);                                                       \
+            SPDLOG_CALL_SITE_LOG_(spdlog_call_site_, logger, level, __VA_ARGS__);                                                          \
+        }                                                                                                                                  \
+    } while (0)
+
+// Off until enabled with spdlog::set_call_site_enabled() or spdlog::set_logger_call_sites_enabled(),
+// and then checked as SPDLOG_LOGGER_CALL. A disabled one costs a load and a predicted branch.
+#define SPDLOG_LOGGER_CALL_OPT_IN(logger, level, ...)                                                                                      \
+    do                                                                                                                                     \
+    {                                                                                                                                      \
+        if (spdlog::details::module_allows(level, SPDLOG_MODULE_LEVEL))                                                                    \
+        {                                                                                                                                  \
+            static spdlog::details::call_site spdlog_call_site_(__FILE__, __LINE__, true);                                                 \
+            if (spdlog_call_site_.key())                                                                                                   \
+            {                                                                                                                              \
+                SPDLOG_CALL_SITE_LOG_(spdlog_call_site_, logger, level, __VA_ARGS__);                                                      \
+            }                                                                                                                              \
+        }                                                                                                                                  \
+    } while (0)
+
+#define SPDLOG_CALL_SITE_LOG_(site, logger, level, ...)                                                                                    \
+    SPDLOG_CALL_SITE_CACHE(spdlog_call_site_cache_);                                                                                       \
+    auto &&spdlog_call_site_logger_ = (logger);                                                                                            \
+    if (site.enabled(spdlog::details::call_site_logger(spdlog_call_site_logger_), level, spdlog_call_site_cache_) ||                       \
+        spdlog::details::tail_keeps(level) || spdlog::details::flight_records(level))                                                      \
+    {                                                                                                                                      \
+        SPDLOG_CALL_SITE_COUNT(site, spdlog_call_site_cache_);                                                                             \
+        spdlog_call_site_logger_->log(SPDLOG_SOURCE_LOC, level, __VA_ARGS__);                                                              \
+    }
+
+// Log the 1st call, then one out of n (counting the calls enabled by the logger's level).
+// The throttled calls are dropped before the message is formatted.
+#define SPDLOG_LOGGER_CALL_EVERY_N(logger, level, n, ...)                                                                                  \
+    do                                                                                                                                     \
+    {                                                                                                                                      \
+        if (spdlog::details::module_allows(level, SPDLOG_MODULE_LEVEL))                                                                    \
+        {                                                                                                                                  \
+            static spdlog::details::call_site spdlog_call_site_(__FILE__, __LINE__);                                                       \
+            static spdlog::details::every_n_throttle spdlog_throttle_;                                                                     \
+            SPDLOG_CALL_SITE_THROTTLED_LOG_(spdlog_call_site_, logger, level, spdlog_throttle_.allow(n), __VA_ARGS__);                     \
+        }                                                                                                                                  \
+    } while (0)
+
+// Log the 1st call, then at most one per ms milliseconds. The throttled calls are dropped before the message is formatted.
+#define SPDLOG_LOGGER_CALL_EVERY_MS(logger, level, ms, ...)                                                                                \
+    do                                                                                                                                     \
+    {                                                                                                                                      \
+        if (spdlog::details::module_allows(level, SPDLOG_MODULE_LEVEL))                                                                    \
+        {                                                                                                                                  \
+            static spdlog::details::call_site spdlog_call_site_(__FILE__, __LINE__);                                                       \
+            static spdlog::details::every_interval_throttle spdlog_throttle_;                                                              \
+            SPDLOG_CALL_SITE_THROTTLED_LOG_(                                                                                               \
+                spdlog_call_site_, logger, level, spdlog_throttle_.allow(std::chrono::milliseconds(ms)), __VA_ARGS__);                     \
+        }                                                                                                                                  \
+    } while (0)
+
+#define SPDLOG_CALL_SITE_THROTTLED_LOG_(site, logger, level, allowed, ...)                                                                 \
+    SPDLOG_CALL_SITE_CACHE(spdlog_call_site_cache_);                                                                                       \
+    auto &&spdlog_call_site_logger_ = (logger);                                                                                            \
+    if (site.enabled(spdlog::details::call_site_logger(spdlog_call_site_logger_), level, spdlog_call_site_cache_)                          \
+            ? (allowed)                                                                                                                    \
+            : spdlog::details::tail_keeps(level) || spdlog::details::flight_records(level))                                                \
+    {                                                                                                                                      \
+        SPDLOG_CALL_SITE_COUNT(site, spdlog_call_site_cache_);                                                                             \
+        spdlog_call_site_logger_->log(SPDLOG_SOURCE_LOC, level, __VA_ARGS__);                                                              \
+    }
+
+#ifdef SPDLOG_OPT_IN_DEBUG_SITES
+#    define SPDLOG_LOGGER_DEBUG_CALL_(logger, level, ...) SPDLOG_LOGGER_CALL_OPT_IN(logger, level, __VA_ARGS__)
+#else
+#    define SPDLOG_LOGGER_DEBUG_CALL_(logger, level, ...) SPDLOG_LOGGER_CALL(logger, level, __VA_ARGS__)
+#endif
 
 #if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_TRACE
-#    define SPDLOG_LOGGER_TRACE(logger, ...) SPDLOG_LOGGER_CALL(logger, spdlog::level::trace, __VA_ARGS__)
-#    define SPDLOG_TRACE(...) SPDLOG_LOGGER_TRACE(spdlog::default_logger_raw(), __VA_ARGS__)
+#    define SPDLOG_LOGGER_TRACE(logger, ...) SPDLOG_LOGGER_DEBUG_CALL_(logger, spdlog::level::trace, __VA_ARGS__)
+#    define SPDLOG_TRACE(...) SPDLOG_LOGGER_TRACE(spdlog::pinned_default_logger(), __VA_ARGS__)
+#    define SPDLOG_LOGGER_TRACE_EVERY_N(logger, n, ...) SPDLOG_LOGGER_CALL_EVERY_N(logger, spdlog::level::trace, n, __VA_ARGS__)
+#    define SPDLOG_TRACE_EVERY_N(n, ...) SPDLOG_LOGGER_TRACE_EVERY_N(spdlog::pinned_default_logger(), n, __VA_ARGS__)
+#    define SPDLOG_LOGGER_TRACE_EVERY_MS(logger, ms, ...) SPDLOG_LOGGER_CALL_EVERY_MS(logger, spdlog::level::trace, ms, __VA_ARGS__)
+#    define SPDLOG_TRACE_EVERY_MS(ms, ...) SPDLOG_LOGGER_TRACE_EVERY_MS(spdlog::pinned_default_logger(), ms, __VA_ARGS__)
 #else
 #    define SPDLOG_LOGGER_TRACE(logger, ...) (void)0
 #    define SPDLOG_TRACE(...) (void)0
+#    define SPDLOG_LOGGER_TRACE_EVERY_N(logger, n, ...) (void)0
+#    define SPDLOG_TRACE_EVERY_N(n, ...) (void)0
+#    define SPDLOG_LOGGER_TRACE_EVERY_MS(logger, ms, ...) (void)0
+#    define SPDLOG_TRACE_EVERY_MS(ms, ...) (void)0
 #endif
 
 #if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_DEBUG
-#    define SPDLOG_LOGGER_DEBUG(logger, ...) SPDLOG_LOGGER_CALL(logger, spdlog::level::debug, __VA_ARGS__)
-#    define SPDLOG_DEBUG(...) SPDLOG_LOGGER_DEBUG(spdlog::default_logger_raw(), __VA_ARGS__)
+#    define SPDLOG_LOGGER_DEBUG(logger, ...) SPDLOG_LOGGER_DEBUG_CALL_(logger, spdlog::level::debug, __VA_ARGS__)
+#    define SPDLOG_DEBUG(...) SPDLOG_LOGGER_DEBUG(spdlog::pinned_default_logger(), __VA_ARGS__)
+#    define SPDLOG_LOGGER_DEBUG_EVERY_N(logger, n, ...) SPDLOG_LOGGER_CALL_EVERY_N(logger, spdlog::level::debug, n, __VA_ARGS__)
+#    define SPDLOG_DEBUG_EVERY_N(n, ...) SPDLOG_LOGGER_DEBUG_EVERY_N(spdlog::pinned_default_logger(), n, __VA_ARGS__)
+#    define SPDLOG_LOGGER_DEBUG_EVERY_MS(logger, ms, ...) SPDLOG_LOGGER_CALL_EVERY_MS(logger, spdlog::level::debug, ms, __VA_ARGS__)
+#    define SPDLOG_DEBUG_EVERY_MS(ms, ...) SPDLOG_LOGGER_DEBUG_EVERY_MS(spdlog::pinned_default_logger(), ms, __VA_ARGS__)
 #else
 #    define SPDLOG_LOGGER_DEBUG(logger, ...) (void)0
 #    define SPDLOG_DEBUG(...) (void)0
+#    define SPDLOG_LOGGER_DEBUG_EVERY_N(logger, n, ...) (void)0
+#    define SPDLOG_DEBUG_EVERY_N(n, ...) (void)0
+#    define SPDLOG_LOGGER_DEBUG_EVERY_MS(logger, ms, ...) (void)0
+#    define SPDLOG_DEBUG_EVERY_MS(ms, ...) (void)0
 #endif
 
 #if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_INFO
 #    define SPDLOG_LOGGER_INFO(logger, ...) SPDLOG_LOGGER_CALL(logger, spdlog::level::info, __VA_ARGS__)
-#    define SPDLOG_INFO(...) SPDLOG_LOGGER_INFO(spdlog::default_logger_raw(), __VA_ARGS__)
+#    define SPDLOG_INFO(...) SPDLOG_LOGGER_INFO(spdlog::pinned_default_logger(), __VA_ARGS__)
+#    define SPDLOG_LOGGER_INFO_EVERY_N(logger, n, ...) SPDLOG_LOGGER_CALL_EVERY_N(logger, spdlog::level::info, n, __VA_ARGS__)
+#    define SPDLOG_INFO_EVERY_N(n, ...) SPDLOG_LOGGER_INFO_EVERY_N(spdlog::pinned_default_logger(), n, __VA_ARGS__)
+#    define SPDLOG_LOGGER_INFO_EVERY_MS(logger, ms, ...) SPDLOG_LOGGER_CALL_EVERY_MS(logger, spdlog::level::info, ms, __VA_ARGS__)
+#    define SPDLOG_INFO_EVERY_MS(ms, ...) SPDLOG_LOGGER_INFO_EVERY_MS(spdlog::pinned_default_logger(), ms, __VA_ARGS__)
 #else
 #    define SPDLOG_LOGGER_INFO(logger, ...) (void)0
 #    define SPDLOG_INFO(...) (void)0
+#    define SPDLOG_LOGGER_INFO_EVERY_N(logger, n, ...) (void)0
+#    define SPDLOG_INFO_EVERY_N(n, ...) (void)0
+#    define SPDLOG_LOGGER_INFO_EVERY_MS(logger, ms, ...) (void)0
+#    define SPDLOG_INFO_EVERY_MS(ms, ...) (void)0
 #endif
 
 #if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_WARN
 #    define SPDLOG_LOGGER_WARN(logger, ...) SPDLOG_LOGGER_CALL(logger, spdlog::level::warn, __VA_ARGS__)
-#    define SPDLOG_WARN(...) SPDLOG_LOGGER_WARN(spdlog::default_logger_raw(), __VA_ARGS__)
+#    define SPDLOG_WARN(...) SPDLOG_LOGGER_WARN(spdlog::pinned_default_logger(), __VA_ARGS__)
+#    define SPDLOG_LOGGER_WARN_EVERY_N(logger, n, ...) SPDLOG_LOGGER_CALL_EVERY_N(logger, spdlog::level::warn, n, __VA_ARGS__)
+#    define SPDLOG_WARN_EVERY_N(n, ...) SPDLOG_LOGGER_WARN_EVERY_N(spdlog::pinned_default_logger(), n, __VA_ARGS__)
+#    define SPDLOG_LOGGER_WARN_EVERY_MS(logger, ms, ...) SPDLOG_LOGGER_CALL_EVERY_MS(logger, spdlog::level::warn, ms, __VA_ARGS__)
+#    define SPDLOG_WARN_EVERY_MS(ms, ...) SPDLOG_LOGGER_WARN_EVERY_MS(spdlog::pinned_default_logger(), ms, __VA_ARGS__)
 #else
 #    define SPDLOG_LOGGER_WARN(logger, ...) (void)0
 #    define SPDLOG_WARN(...) (void)0
+#    define SPDLOG_LOGGER_WARN_EVERY_N(logger, n, ...) (void)0
+#    define SPDLOG_WARN_EVERY_N(n, ...) (void)0
+#    define SPDLOG_LOGGER_WARN_EVERY_MS(logger, ms, ...) (void)0
+#    define SPDLOG_WARN_EVERY_MS(ms, ...) (void)0
 #endif
 
 #if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_ERROR
 #    define SPDLOG_LOGGER_ERROR(logger, ...) SPDLOG_LOGGER_CALL(logger, spdlog::level::err, __VA_ARGS__)
-#    define SPDLOG_ERROR(...) SPDLOG_LOGGER_ERROR(spdlog::default_logger_raw(), __VA_ARGS__)
+#    define SPDLOG_ERROR(...) SPDLOG_LOGGER_ERROR(spdlog::pinned_default_logger(), __VA_ARGS__)
+#    define SPDLOG_LOGGER_ERROR_EVERY_N(logger, n, ...) SPDLOG_LOGGER_CALL_EVERY_N(logger, spdlog::level::err, n, __VA_ARGS__)
+#    define SPDLOG_ERROR_EVERY_N(n, ...) SPDLOG_LOGGER_ERROR_EVERY_N(spdlog::pinned_default_logger(), n, __VA_ARGS__)
+#    define SPDLOG_LOGGER_ERROR_EVERY_MS(logger, ms, ...) SPDLOG_LOGGER_CALL_EVERY_MS(logger, spdlog::level::err, ms, __VA_ARGS__)
+#    define SPDLOG_ERROR_EVERY_MS(ms, ...) SPDLOG_LOGGER_ERROR_EVERY_MS(spdlog::pinned_default_logger(), ms, __VA_ARGS__)
 #else
 #    define SPDLOG_LOGGER_ERROR(logger, ...) (void)0
 #    define SPDLOG_ERROR(...) (void)0
+#    define SPDLOG_LOGGER_ERROR_EVERY_N(logger, n, ...) (void)0
+#    define SPDLOG_ERROR_EVERY_N(n, ...) (void)0
+#    define SPDLOG_LOGGER_ERROR_EVERY_MS(logger, ms, ...) (void)0
+#    define SPDLOG_ERROR_EVERY_MS(ms, ...) (void)0
 #endif
 
 #if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_CRITICAL
 #    define SPDLOG_LOGGER_CRITICAL(logger, ...) SPDLOG_LOGGER_CALL(logger, spdlog::level::critical, __VA_ARGS__)
-#    define SPDLOG_CRITICAL(...) SPDLOG_LOGGER_CRITICAL(spdlog::default_logger_raw(), __VA_ARGS__)
+#    define SPDLOG_CRITICAL(...) SPDLOG_LOGGER_CRITICAL(spdlog::pinned_default_logger(), __VA_ARGS__)
+#    define SPDLOG_LOGGER_CRITICAL_EVERY_N(logger, n, ...) SPDLOG_LOGGER_CALL_EVERY_N(logger, spdlog::level::critical, n, __VA_ARGS__)
+#    define SPDLOG_CRITICAL_EVERY_N(n, ...) SPDLOG_LOGGER_CRITICAL_EVERY_N(spdlog::pinned_default_logger(), n, __VA_ARGS__)
+#    define SPDLOG_LOGGER_CRITICAL_EVERY_MS(logger, ms, ...) SPDLOG_LOGGER_CALL_EVERY_MS(logger, spdlog::level::critical, ms, __VA_ARGS__)
+#    define SPDLOG_CRITICAL_EVERY_MS(ms, ...) SPDLOG_LOGGER_CRITICAL_EVERY_MS(spdlog::pinned_default_logger(), ms, __VA_ARGS__)
 #else
 #    define SPDLOG_LOGGER_CRITICAL(logger, ...) (void)0
 #    define SPDLOG_CRITICAL(...) (void)0
+#    define SPDLOG_LOGGER_CRITICAL_EVERY_N(logger, n, ...) (void)0
+#    define SPDLOG_CRITICAL_EVERY_N(n, ...) (void)0
+#    define SPDLOG_LOGGER_CRITICAL_EVERY_MS(logger, ms, ...) (void)0
+#    define SPDLOG_CRITICAL_EVERY_MS(ms, ...) (void)0
 #endif
 
 #ifdef SPDLOG_HEADER_ONLY
@@ -0,0 +1,347 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Logger whose formatter and sinks are known at compile time, for the tightest loops.
+// A message is formatted once by the Formatter and written to each of the Sinks by direct calls:
+// no virtual call to the sinks or to the formatter (declare it final, like pattern_formatter), all
+// of it inlined in the log call.
+//
+// The Sinks are static sinks (see sinks/static_sinks.h): any class with
+//     void write(const details::log_msg &msg, string_view_t formatted);
+//     void flush();
+//     unsigned required_fields() const; // the details::msg_fields read, besides those of the formatter
+// called under the logger lock - they need no lock of their own.
+//
+// The logger is managed through handle(), a regular spdlog::logger (registered by make_static_logger()):
+// its level, flush level/policy, backtrace and error handler are those of the static logger, and so are
+// the registry levels, flush_every() and flush_all(). Logging through the handle (e.g. spdlog::get(name))
+// writes to the static sinks too, at the cost of one virtual call.
+// The formatter and the sinks are fixed: set_pattern()/set_formatter() of the handle (or of the registry) don't
+// apply to them.
+//
+// Example:
+//
+//     #include <spdlog/static_logger.h>
+//     #include <spdlog/sinks/static_sinks.h>
+//
+//     auto fast = spdlog::make_static_logger("fast", spdlog::details::make_unique<spdlog::pattern_formatter>("%T.%e %v"),
+//         std::make_shared<spdlog::static_sinks::file_sink>("logs/fast.txt"));
+//     fast.info("order {} filled", id);
+//     spdlog::get("fast")->set_level(spdlog::level::warn);
+
+#include <spdlog/common.h>
+#include <spdlog/logger.h>
+#include <spdlog/pattern_formatter.h>
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/details/synchronous_factory.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <type_traits>
+
+namespace spdlog {
+namespace details {
+
+// the registered spdlog::logger of a static logger, holding its formatter and sinks
+template<typename Mutex, typename Formatter, typename... Sinks>
+class static_logger_core final : public logger
+{
+public:
+    static_logger_core(std::string name, std::unique_ptr<Formatter> formatter, std::shared_ptr<Sinks>... sinks)
+        : logger(std::move(name))
+        , formatter_(std::move(formatter))
+        , sinks_(std::move(sinks)...)
+    {
+        required_msg_fields_ = formatter_->required_fields() | sinks_fields_(std::integral_constant<std::size_t, 0>{});
+    }
+
+    template<typename... Args>
+    void log_static(source_loc loc, level::level_enum lvl, string_view_t fmt, Args &&...args)
+    {
+        bool log_enabled = log_enabled_(lvl);
+        bool traceback_enabled = tracer_.enabled();
+        auto *tail = tail_of_(lvl, log_enabled);
+        if (!log_enabled && !traceback_enabled && tail == nullptr && !details::flight_records(lvl))
+        {
+            return;
+        }
+        SPDLOG_TRY
+        {
+            scoped_buffer scoped_buf;
+            auto &buf = scoped_buf.get();
+            profile_timer timer;
+            fmt::detail::vformat_to(buf, fmt, fmt::make_format_args(args...));
+            profile_.on_formatted(buf.size(), timer);
+            log_static_msg_(loc, lvl, string_view_t(buf.data(), buf.size()), log_enabled, traceback_enabled, tail);
+        }
+        SPDLOG_LOGGER_CATCH()
+    }
+
+    void log_static(source_loc loc, level::level_enum lvl, string_view_t msg)
+    {
+        bool log_enabled = log_enabled_(lvl);
+        bool traceback_enabled = tracer_.enabled();
+        auto *tail = tail_of_(lvl, log_enabled);
+        if (!log_enabled && !traceback_enabled && tail == nullptr && !details::flight_records(lvl))
+        {
+            return;
+        }
+        SPDLOG_TRY
+        {
+            log_static_msg_(loc, lvl, msg, log_enabled, traceback_enabled, tail);
+        }
+        SPDLOG_LOGGER_CATCH()
+    }
+
+    template<std::size_t I>
+    const std::shared_ptr<typename std::tuple_element<I, std::tuple<Sinks...>>::type> &sink() const
+    {
+        return std::get<I>(sinks_);
+    }
+
+    // its formatter and sinks cannot be copied to another logger
+    std::shared_ptr<logger> clone(std::string) override
+    {
+        throw_spdlog_ex("static loggers cannot be cloned");
+    }
+
+protected:
+    // the messages logged through the handle, and the backtrace
+    void sink_it_(const log_msg &msg) override
+    {
+        write_(msg);
+    }
+
+    void flush_() override
+    {
+        std::lock_guard<Mutex> lock(mutex_);
+        profile_timer timer;
+        on_flush_();
+        flush_sinks_(std::integral_constant<std::size_t, 0>{});
+        profile_.on_flushed(timer);
+    }
+
+private:
+    std::unique_ptr<Formatter> formatter_;
+    std::tuple<std::shared_ptr<Sinks>...> sinks_;
+    Mutex mutex_;
+
+    void log_static_msg_(
+        source_loc loc, level::level_enum lvl, string_view_t payload, bool log_enabled, bool traceback_enabled, tail_buffer *tail)
+    {
+        log_msg msg(loc, name_, lvl, payload, traceback_enabled || tail != nullptr || flush_controller_ ? msg_fields::all : required_msg_fields_);
+        if (log_enabled)
+        {
+            msg.sample_rate = sample_rate_of_(lvl);
+            write_(msg);
+        }
+        if (traceback_enabled)
+        {
+            msg.sample_rate = 1;
+            tracer_.push_back(msg);
+        }
+        if (tail != nullptr && !log_enabled)
+        {
+            tail->push_back(this, msg);
+        }
+        if (flight_records(lvl))
+        {
+            flight_recorder::instance().record(msg);
+        }
+    }
+
+    void write_(const log_msg &msg)
+    {
+        {
+            std::lock_guard<Mutex> lock(mutex_);
+            scoped_buffer scoped_buf;
+            auto &buf = scoped_buf.get();
+            profile_timer timer;
+            formatter_->format(msg, buf);
+            profile_.on_formatted(buf.size(), timer);
+            write_sinks_(msg, string_view_t(buf.data(), buf.size()), std::integral_constant<std::size_t, 0>{});
+        }
+        bool flush = flush_controller_ ? flush_due_(msg)
+                                       : msg.level >= flush_level_.load(std::memory_order_relaxed) && msg.level != level::off;
+        if (flush)
+        {
+            flush_();
+        }
+    }
+
+    template<std::size_t I>
+    void write_sinks_(const log_msg &msg, string_view_t formatted, std::integral_constant<std::size_t, I>)
+    {
+        std::get<I>(sinks_)->write(msg, formatted);
+        write_sinks_(msg, formatted, std::integral_constant<std::size_t, I + 1>{});
+    }
+
+    void write_sinks_(const log_msg &, string_view_t, std::integral_constant<std::size_t, sizeof...(Sinks)>) {}
+
+    template<std::size_t I>
+    void flush_sinks_(std::integral_constant<std::size_t, I>)
+    {
+        SPDLOG_TRY
+        {
+            std::get<I>(sinks_)->flush();
+        }
+        SPDLOG_LOGGER_CATCH()
+        flush_sinks_(std::integral_constant<std::size_t, I + 1>{});
+    }
+
+    void flush_sinks_(std::integral_constant<std::size_t, sizeof...(Sinks)>) {}
+
+    template<std::size_t I>
+    unsigned sinks_fields_(std::integral_constant<std::size_t, I>) const
+    {
+        return std::get<I>(sinks_)->required_fields() | sinks_fields_(std::integral_constant<std::size_t, I + 1>{});
+    }
+
+    unsigned sinks_fields_(std::integral_constant<std::size_t, sizeof...(Sinks)>) const
+    {
+        return msg_fields::none;
+    }
+};
+
+} // namespace details
+
+template<typename Mutex, typename Formatter, typename... Sinks>
+class basic_static_logger
+{
+public:
+    using core_type = details::static_logger_core<Mutex, Formatter, Sinks...>;
+
+    basic_static_logger(std::string name, std::unique_ptr<Formatter> formatter, std::shared_ptr<Sinks>... sinks)
+        : core_(std::make_shared<core_type>(std::move(name), std::move(formatter), std::move(sinks)...))
+    {}
+
+    template<typename... Args>
+    void log(source_loc loc, level::level_enum lvl, fmt::format_string<Args...> fmt, Args &&...args)
+    {
+        core_->log_static(loc, lvl, fmt, std::forward<Args>(args)...);
+    }
+
+    template<typename... Args>
+    void log(level::level_enum lvl, fmt::format_string<Args...> fmt, Args &&...args)
+    {
+        core_->log_static(source_loc{}, lvl, fmt, std::forward<Args>(args)...);
+    }
+
+    void log(source_loc loc, level::level_enum lvl, string_view_t msg)
+    {
+        core_->log_static(loc, lvl, msg);
+    }
+
+    void log(level::level_enum lvl, string_view_t msg)
+    {
+        core_->log_static(source_loc{}, lvl, msg);
+    }
+
+    template<typename... Args>
+    void trace(fmt::format_string<Args...> fmt, Args &&...args)
+    {
+        log(level::trace, fmt, std::forward<Args>(args)...);
+    }
+
+    template<typename... Args>
+    void debug(fmt::format_string<Args...> fmt, Args &&...args)
+    {
+        log(level::debug, fmt, std::forward<Args>(args)...);
+    }
+
+    template<typename... Args>
+    void info(fmt::format_string<Args...> fmt, Args &&...args)
+    {
+        log(level::info, fmt, std::forward<Args>(args)...);
+    }
+
+    template<typename... Args>
+    void warn(fmt::format_string<Args...> fmt, Args &&...args)
+    {
+        log(level::warn, fmt, std::forward<Args>(args)...);
+    }
+
+    template<typename... Args>
+    void error(fmt::format_string<Args...> fmt, Args &&...args)
+    {
+        log(level::err, fmt, std::forward<Args>(args)...);
+    }
+
+    template<typename... Args>
+    void critical(fmt::format_string<Args...> fmt, Args &&...args)
+    {
+        log(level::critical, fmt, std::forward<Args>(args)...);
+    }
+
+    bool should_log(level::level_enum msg_level) const
+    {
+        return core_->should_log(msg_level);
+    }
+
+    void set_level(level::level_enum log_level)
+    {
+        core_->set_level(log_level);
+    }
+
+    level::level_enum level() const
+    {
+        return core_->level();
+    }
+
+    const std::string &name() const
+    {
+        return core_->name();
+    }
+
+    void flush()
+    {
+        core_->flush();
+    }
+
+    // the I-th sink
+    template<std::size_t I>
+    const std::shared_ptr<typename std::tuple_element<I, std::tuple<Sinks...>>::type> &sink() const
+    {
+        return core_->template sink<I>();
+    }
+
+    // the spdlog::logger of this logger, for its management and the registry
+    std::shared_ptr<logger> handle() const
+    {
+        return core_;
+    }
+
+private:
+    std::shared_ptr<core_type> core_;
+};
+
+template<typename Formatter, typename... Sinks>
+using static_logger = basic_static_logger<std::mutex, Formatter, Sinks...>;
+
+template<typename Formatter, typename... Sinks>
+using static_logger_st = basic_static_logger<details::null_mutex, Formatter, Sinks...>;
+
+// create a static logger and initialize/register its handle like the other loggers (see synchronous_factory)
+template<typename Formatter, typename... Sinks>
+inline static_logger<Formatter, Sinks...> make_static_logger(
+    std::string logger_name, std::unique_ptr<Formatter> formatter, std::shared_ptr<Sinks>... sinks)
+{
+    static_logger<Formatter, Sinks...> new_logger(std::move(logger_name), std::move(formatter), std::move(sinks)...);
+    details::registry::instance().initialize_logger(new_logger.handle());
+    return new_logger;
+}
+
+template<typename Formatter, typename... Sinks>
+inline static_logger_st<Formatter, Sinks...> make_static_logger_st(
+    std::string logger_name, std::unique_ptr<Formatter> formatter, std::shared_ptr<Sinks>... sinks)
+{
+    static_logger_st<Formatter, Sinks...> new_logger(std::move(logger_name), std::move(formatter), std::move(sinks)...);
+    details::registry::instance().initialize_logger(new_logger.handle());
+    return new_logger;
+}
+
+} // namespace spdlog
@@ -3,8 +3,12 @@
 
 #pragma once
 
+#include <spdlog/details/tsc_clock.h>
 #include <spdlog/fmt/fmt.h>
 
+#include <chrono>
+#include <cstdint>
+
 // Stopwatch support for spdlog  (using std::chrono::steady_clock).
 // Displays elapsed seconds since construction as double.
 //
@@ -23,6 +27,10 @@
 // using std::chrono::duration_cast;
 // using std::chrono::milliseconds;
 // spdlog::info("Elapsed {}", duration_cast<milliseconds>(sw.elapsed())); => "Elapsed 5ms"
+//
+// spdlog::tsc_stopwatch has the same interface, but reads the CPU's time stamp counter (see details/tsc_clock.h):
+// a few cycles instead of a clock call, for timing short scopes. Falls back to steady_clock if the counter isn't
+// invariant. The first use of the counter calibrates it (for a few millis).
 
 namespace spdlog {
 class stopwatch
@@ -45,6 +53,51 @@ public:
         start_tp_ = clock ::now();
     }
 };
+
+class tsc_stopwatch
+{
+    using clock = std::chrono::steady_clock;
+    uint64_t start_counter_{0};
+    std::chrono::time_point<clock> start_tp_; // if the counter isn't used
+
+public:
+    tsc_stopwatch()
+    {
+        reset();
+    }
+
+    // not started until reset() if start is false
+    explicit tsc_stopwatch(bool start)
+    {
+        if (start)
+        {
+            reset();
+        }
+    }
+
+    std::chrono::duration<double> elapsed() const
+    {
+        auto &tsc = details::tsc_clock::instance();
+        if (tsc.uses_counter())
+        {
+            auto end_counter = details::tsc_clock::read_counter();
+            return std::chrono::duration<double>(tsc.to_time_point(end_counter) - tsc.to_time_point(start_counter_));
+        }
+        return std::chrono::duration<double>(clock::now() - start_tp_);
+    }
+
+    void reset()
+    {
+        if (details::tsc_clock::instance().uses_counter())
+        {
+            start_counter_ = details::tsc_clock::read_counter();
+        }
+        else
+        {
+            start_tp_ = clock::now();
+        }
+    }
+};
 } // namespace spdlog
 
 // Support for fmt formatting  (e.g. "{:012.9}" or just "{}")
@@ -58,4 +111,14 @@ struct formatter<spdlog::stopwatch> : formatter<double>
         return formatter<double>::format(sw.elapsed().count(), ctx);
     }
 };
+
+template<>
+struct formatter<spdlog::tsc_stopwatch> : formatter<double>
+{
+    template<typename FormatContext>
+    auto format(const spdlog::tsc_stopwatch &sw, FormatContext &ctx) -> decltype(ctx.out())
+    {
+        return formatter<double>::format(sw.elapsed().count(), ctx);
+    }
+};
 } // namespace fmt
@@ -0,0 +1,116 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Request scoped tail sampling: the debug details of the bad requests only.
+//
+// While a scope is open, the messages its thread logs below the level of their loggers (up to debug by
+// default) are kept in the scope - copied, with their arithmetic args captured unformatted - instead of
+// being dropped. When the scope ends they are discarded, unless the request went wrong: a message at or above
+// the trigger level (err by default) was logged meanwhile, trigger() was called, or the scope lasted longer
+// than its latency threshold. Then they are passed to the sinks of their loggers, oldest first, whatever the
+// level of the loggers (the sink levels still apply).
+//
+// Usage:
+//
+// void handle(const request &req)
+// {
+//     spdlog::tail_sampling_scope scope(256, std::chrono::milliseconds(100));
+//     SPDLOG_DEBUG("parsing {} bytes", req.size()); // kept - logged only if the request fails or is slow
+//     ...
+//     if (!ok)
+//     {
+//         spdlog::error("request failed");          // logged, and the kept messages are logged at the end of the scope
+//     }
+// }
+//
+// The scopes of a thread nest: the messages go to the innermost one. The loggers must outlive the scopes
+// they logged to. The kept messages can't be longer than the last max_messages ones (the older are dropped).
+// Not available with SPDLOG_NO_TLS (the scopes keep nothing).
+
+#include <spdlog/common.h>
+#include <spdlog/details/tail_buffer.h>
+
+#include <chrono>
+
+namespace spdlog {
+
+class tail_sampling_scope
+{
+public:
+    explicit tail_sampling_scope(size_t max_messages = 256, std::chrono::nanoseconds latency_threshold = std::chrono::nanoseconds::zero(),
+        level::level_enum max_level = level::debug, level::level_enum trigger_level = level::err)
+        : buffer_(max_messages, max_level, trigger_level)
+        , latency_threshold_(latency_threshold)
+        , start_(std::chrono::steady_clock::now())
+    {
+#ifndef SPDLOG_NO_TLS
+        auto &current = details::thread_tail_buffer_slot();
+        buffer_.parent = current;
+        current = &buffer_;
+#endif
+    }
+
+    tail_sampling_scope(const tail_sampling_scope &) = delete;
+    tail_sampling_scope &operator=(const tail_sampling_scope &) = delete;
+
+    // log the kept messages if triggered or slow, discard them otherwise
+    ~tail_sampling_scope()
+    {
+#ifndef SPDLOG_NO_TLS
+        details::thread_tail_buffer_slot() = buffer_.parent;
+#endif
+        if (triggered() ||
+            (latency_threshold_ > std::chrono::nanoseconds::zero() && std::chrono::steady_clock::now() - start_ >= latency_threshold_))
+        {
+            flush();
+        }
+    }
+
+    // log the kept messages at the end of the scope
+    void trigger()
+    {
+        buffer_.trigger();
+    }
+
+    bool triggered() const
+    {
+        return buffer_.triggered();
+    }
+
+    // log the messages kept so far, now
+    void flush()
+    {
+        SPDLOG_TRY
+        {
+            buffer_.flush();
+        }
+        SPDLOG_CATCH_STD
+    }
+
+    // drop the messages kept so far
+    void discard()
+    {
+        buffer_.clear();
+    }
+
+    // the messages kept
+    size_t size() const
+    {
+        return buffer_.size();
+    }
+
+    // the messages dropped to keep the last max_messages ones
+    size_t overrun_counter() const
+    {
+        return buffer_.overrun_counter();
+    }
+
+private:
+    details::tail_buffer buffer_;
+    std::chrono::nanoseconds latency_threshold_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace spdlog
@@ -19,6 +19,16 @@
 // #define SPDLOG_CLOCK_COARSE
 ///////////////////////////////////////////////////////////////////////////////
 
+///////////////////////////////////////////////////////////////////////////////
+// Uncomment to read the time from the CPU's time stamp counter (x86 invariant TSC,
+// or the aarch64 generic timer) instead of the regular clock: no system call and
+// full resolution. It is calibrated against the regular clock on first use (for a
+// few millis) then every second by a background thread (see details/tsc_clock.h).
+// Falls back to the regular clock if the counter isn't usable.
+//
+// #define SPDLOG_CLOCK_TSC
+///////////////////////////////////////////////////////////////////////////////
+
 ///////////////////////////////////////////////////////////////////////////////
 // Uncomment if thread id logging is not needed (i.e. no %t in the log pattern).
 // This will prevent spdlog from querying the thread id on each log call.
@@ -32,8 +42,9 @@
 ///////////////////////////////////////////////////////////////////////////////
 // Uncomment to prevent spdlog from using thread local storage.
 //
-// WARNING: if your program forks, UNCOMMENT this flag to prevent undefined
-// thread ids in the children logs.
+// The cached thread id is refreshed in forked children (pthread_atfork), so
+// forking programs need not define it - see also thread_pool_options::fork_safe
+// to keep an async thread pool running in the children.
 //
 // #define SPDLOG_NO_TLS
 ///////////////////////////////////////////////////////////////////////////////
@@ -46,6 +57,63 @@
 // #define SPDLOG_NO_ATOMIC_LEVELS
 ///////////////////////////////////////////////////////////////////////////////
 
+///////////////////////////////////////////////////////////////////////////////
+// Uncomment to prevent spdlog from interning format strings (see
+// details/intern_table.h). Constant messages are then formatted, and queued
+// messages (async, backtrace) carry a copy of their text.
+//
+// #define SPDLOG_NO_INTERNING
+///////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+// Uncomment to reuse thread local formatting buffers in the loggers and sinks,
+// instead of allocating messages longer than the inline buffer (250 bytes) on
+// each call. Buffers larger than the max size are released after use.
+// Ignored if SPDLOG_NO_TLS is defined.
+//
+// #define SPDLOG_REUSE_BUFFERS
+// #define SPDLOG_REUSE_BUFFERS_MAX_SIZE (64 * 1024)
+///////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+// Uncomment to change the inline buffer size of the stored messages (async
+// queue slots, backtracer, ringbuffer sink), 250 bytes by default. Smaller
+// slots for short lines, or larger ones to not allocate long messages.
+// Independent of the formatting buffers.
+//
+// #define SPDLOG_MSG_BUFFER_SIZE 128
+///////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+// Uncomment to change the marker ending the payloads cut to the cap of their
+// logger (see logger::set_max_payload_bytes()), "...[truncated]" by default.
+//
+// #define SPDLOG_TRUNCATION_MARKER " <cut>"
+///////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+// Uncomment to write the file sinks with a write buffer size through io_uring
+// (linux 5.6 and later), so that the logging thread doesn't wait for the disk.
+// Falls back to regular writes if the kernel doesn't support it.
+//
+// #define SPDLOG_IO_URING
+///////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+// Uncomment to support the compression of the rotated log files (the compress
+// option of the rotating, daily and hourly file sinks). Requires zlib.
+//
+// #define SPDLOG_ZLIB
+///////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+// Uncomment to count the messages, formatting, sink and flush times of each
+// logger and sink (see logger::profile_stats() and sink::profile_stats()).
+// Costs a few clock reads and relaxed atomic updates per message.
+//
+// #define SPDLOG_ENABLE_STATS
+///////////////////////////////////////////////////////////////////////////////
+
 ///////////////////////////////////////////////////////////////////////////////
 // Uncomment to enable usage of wchar_t for file names on Windows.
 //
@@ -114,6 +182,46 @@
 // #define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_INFO
 ///////////////////////////////////////////////////////////////////////////////
 
+///////////////////////////////////////////////////////////////////////////////
+// Define in a source file (or redefine after including spdlog.h) to compile out its SPDLOG_LOGGER_CALL
+// macros (SPDLOG_INFO(..), SPDLOG_LOGGER_DEBUG(..) ..) below a level, on top of SPDLOG_ACTIVE_LEVEL.
+// Checked where each macro is expanded - see spdlog.h.
+//
+// #define SPDLOG_MODULE_LEVEL SPDLOG_LEVEL_WARN
+///////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+// Uncomment to make the SPDLOG_TRACE(..), SPDLOG_DEBUG(..) macros (and their SPDLOG_LOGGER_ versions)
+// off until enabled at runtime, with spdlog::set_call_site_enabled("file.cpp", line, true) or
+// spdlog::set_logger_call_sites_enabled("logger name", true). A disabled one costs a load and a predicted branch.
+//
+// #define SPDLOG_OPT_IN_DEBUG_SITES
+///////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+// Uncomment to count the messages and payload bytes logged by each SPDLOG_LOGGER_CALL macro (SPDLOG_INFO(..),
+// SPDLOG_LOGGER_WARN(..) ..), for spdlog::top_call_sites(n). A count is a per thread relaxed increment.
+// Must be the same for the compiled library and its users.
+//
+// #define SPDLOG_CALL_SITE_STATS
+///////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+// Uncomment to compile in static tracepoints (USDT, needs <sys/sdt.h>) on the logging path: the log calls,
+// the async queue (enqueue, dequeue, drops) and the sinks' log and flush calls - see details/usdt.h.
+// A probe is a nop until bpftrace/perf attaches to it.
+//
+// #define SPDLOG_USDT
+///////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+// Uncomment to accept the format strings compiled with FMT_COMPILE (see fmt/compile.h) in the logging
+// functions and macros, e.g. SPDLOG_INFO(FMT_COMPILE("{} items"), n): formatted by code generated for the
+// call site, without parsing the format string at runtime. Requires C++17 - else FMT_COMPILE is FMT_STRING.
+//
+// #define SPDLOG_FMT_COMPILE
+///////////////////////////////////////////////////////////////////////////////
+
 ///////////////////////////////////////////////////////////////////////////////
 // Uncomment (and change if desired) macro to use for function names.
 // This is compiler dependent.
@@ -8,6 +8,11 @@
 #include <spdlog/async.h>
 #include <spdlog/async_logger-inl.h>
 #include <spdlog/details/periodic_worker-inl.h>
+#include <spdlog/details/timer_wheel-inl.h>
 #include <spdlog/details/thread_pool-inl.h>
+#include <spdlog/openmetrics-inl.h>
 
 template class SPDLOG_API spdlog::details::mpmc_blocking_queue<spdlog::details::async_msg>;
+template class SPDLOG_API spdlog::details::mpmc_lockfree_queue<spdlog::details::async_msg>;
+template class SPDLOG_API spdlog::details::spsc_lanes_queue<spdlog::details::async_msg, spdlog::details::async_msg_time_order>;
+template class SPDLOG_API spdlog::details::mpmc_arena_queue<spdlog::details::async_msg, spdlog::details::async_msg_arena_codec>;
@@ -6,3 +6,4 @@
 #endif
 
 #include <spdlog/cfg/helpers-inl.h>
+#include <spdlog/cfg/file-inl.h>
@@ -6,7 +6,11 @@
 #endif
 
 #include <spdlog/details/null_mutex.h>
+#include <spdlog/details/spin_mutex.h>
 #include <spdlog/details/file_helper-inl.h>
+#ifdef SPDLOG_IO_URING
+#    include <spdlog/details/uring_file_writer-inl.h>
+#endif
 #include <spdlog/sinks/basic_file_sink-inl.h>
 #include <spdlog/sinks/base_sink-inl.h>
 
@@ -14,7 +18,61 @@
 
 template class SPDLOG_API spdlog::sinks::basic_file_sink<std::mutex>;
 template class SPDLOG_API spdlog::sinks::basic_file_sink<spdlog::details::null_mutex>;
+template class SPDLOG_API spdlog::sinks::basic_file_sink<spdlog::details::spin_mutex>;
+template class SPDLOG_API spdlog::sinks::basic_file_sink<spdlog::details::adaptive_mutex>;
 
+#include <spdlog/details/background_worker-inl.h>
+#include <spdlog/details/file_compression-inl.h>
+#include <spdlog/details/file_rotation_worker-inl.h>
+#include <spdlog/details/file_syncer-inl.h>
+#include <spdlog/details/time_index-inl.h>
+#include <spdlog/details/size_retention-inl.h>
+#include <spdlog/details/frame_compressor-inl.h>
 #include <spdlog/sinks/rotating_file_sink-inl.h>
 template class SPDLOG_API spdlog::sinks::rotating_file_sink<std::mutex>;
 template class SPDLOG_API spdlog::sinks::rotating_file_sink<spdlog::details::null_mutex>;
+template class SPDLOG_API spdlog::sinks::rotating_file_sink<spdlog::details::spin_mutex>;
+template class SPDLOG_API spdlog::sinks::rotating_file_sink<spdlog::details::adaptive_mutex>;
+
+#include <spdlog/sinks/compressed_file_sink-inl.h>
+template class SPDLOG_API spdlog::sinks::compressed_file_sink<std::mutex>;
+template class SPDLOG_API spdlog::sinks::compressed_file_sink<spdlog::details::null_mutex>;
+template class SPDLOG_API spdlog::sinks::compressed_file_sink<spdlog::details::spin_mutex>;
+template class SPDLOG_API spdlog::sinks::compressed_file_sink<spdlog::details::adaptive_mutex>;
+
+#include <spdlog/details/binary_log_reader-inl.h>
+#include <spdlog/details/binary_log_writer-inl.h>
+#include <spdlog/sinks/binary_file_sink-inl.h>
+template class SPDLOG_API spdlog::sinks::binary_file_sink<std::mutex>;
+template class SPDLOG_API spdlog::sinks::binary_file_sink<spdlog::details::null_mutex>;
+template class SPDLOG_API spdlog::sinks::binary_file_sink<spdlog::details::spin_mutex>;
+template class SPDLOG_API spdlog::sinks::binary_file_sink<spdlog::details::adaptive_mutex>;
+
+#include <spdlog/details/arrow_ipc-inl.h>
+#include <spdlog/sinks/arrow_file_sink-inl.h>
+template class SPDLOG_API spdlog::sinks::arrow_file_sink<std::mutex>;
+template class SPDLOG_API spdlog::sinks::arrow_file_sink<spdlog::details::null_mutex>;
+template class SPDLOG_API spdlog::sinks::arrow_file_sink<spdlog::details::spin_mutex>;
+template class SPDLOG_API spdlog::sinks::arrow_file_sink<spdlog::details::adaptive_mutex>;
+
+#include <spdlog/details/flight_recorder-inl.h>
+#include <spdlog/flight_recorder-inl.h>
+
+#ifndef _WIN32
+#    include <spdlog/details/mmap_file-inl.h>
+#    include <spdlog/sinks/mmap_file_sink-inl.h>
+#    include <spdlog/details/shm_ring-inl.h>
+template class SPDLOG_API spdlog::sinks::mmap_file_sink<std::mutex>;
+template class SPDLOG_API spdlog::sinks::mmap_file_sink<spdlog::details::null_mutex>;
+template class SPDLOG_API spdlog::sinks::mmap_file_sink<spdlog::details::spin_mutex>;
+template class SPDLOG_API spdlog::sinks::mmap_file_sink<spdlog::details::adaptive_mutex>;
+
+#    include <spdlog/details/append_file-inl.h>
+#    include <spdlog/sinks/shared_file_sink-inl.h>
+template class SPDLOG_API spdlog::sinks::shared_file_sink<std::mutex>;
+template class SPDLOG_API spdlog::sinks::shared_file_sink<spdlog::details::null_mutex>;
+template class SPDLOG_API spdlog::sinks::shared_file_sink<spdlog::details::spin_mutex>;
+template class SPDLOG_API spdlog::sinks::shared_file_sink<spdlog::details::adaptive_mutex>;
+#endif
+
+#include <spdlog/sinks/sharded_file_sink-inl.h>
@@ -7,16 +7,34 @@
 
 #include <spdlog/spdlog-inl.h>
 #include <spdlog/common-inl.h>
+#include <spdlog/crash_dump-inl.h>
 #include <spdlog/details/backtracer-inl.h>
+#include <spdlog/details/call_site-inl.h>
+#include <spdlog/details/crash_dump-inl.h>
+#include <spdlog/details/flush_controller-inl.h>
 #include <spdlog/details/registry-inl.h>
+#include <spdlog/details/intern_table-inl.h>
 #include <spdlog/details/os-inl.h>
+#include <spdlog/details/page_memory-inl.h>
+#include <spdlog/details/time_cache-inl.h>
+#include <spdlog/details/tsc_clock-inl.h>
 #include <spdlog/pattern_formatter-inl.h>
+#include <spdlog/json_formatter-inl.h>
 #include <spdlog/details/log_msg-inl.h>
+#include <spdlog/details/mdc-inl.h>
+#include <spdlog/details/msg_ring-inl.h>
+#include <spdlog/details/redactor-inl.h>
+#include <spdlog/details/tail_buffer-inl.h>
 #include <spdlog/details/log_msg_buffer-inl.h>
+#include <spdlog/details/memory_account-inl.h>
+#include <spdlog/details/scoped_buffer-inl.h>
+#include <spdlog/details/format_id-inl.h>
+#include <spdlog/details/formatter_clones-inl.h>
 #include <spdlog/logger-inl.h>
 #include <spdlog/sinks/sink-inl.h>
 #include <spdlog/sinks/base_sink-inl.h>
 #include <spdlog/details/null_mutex.h>
+#include <spdlog/details/spin_mutex.h>
 
 #include <mutex>
 
@@ -24,3 +42,5 @@
 template SPDLOG_API spdlog::logger::logger(std::string name, sinks_init_list::iterator begin, sinks_init_list::iterator end);
 template class SPDLOG_API spdlog::sinks::base_sink<std::mutex>;
 template class SPDLOG_API spdlog::sinks::base_sink<spdlog::details::null_mutex>;
+template class SPDLOG_API spdlog::sinks::base_sink<spdlog::details::spin_mutex>;
+template class SPDLOG_API spdlog::sinks::base_sink<spdlog::details::adaptive_mutex>;
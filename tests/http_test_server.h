@@ -0,0 +1,126 @@
+#pragma once
+
+// POSIX only
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+template<typename Pred>
+static bool eventually(Pred pred)
+{
+    for (int i = 0; i < 500 && !pred(); i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return pred();
+}
+
+// a local http server on an ephemeral port, answering the requests with the given statuses (200 once used up)
+struct http_test_server
+{
+    int fd;
+    int port;
+    std::vector<int> statuses;
+    std::mutex mutex;
+    std::vector<std::string> headers;
+    std::vector<std::string> bodies;
+    std::atomic<bool> stop{false};
+    std::thread thread;
+
+    explicit http_test_server(std::vector<int> the_statuses = {})
+        : statuses(std::move(the_statuses))
+    {
+        fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        ::bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+        ::listen(fd, 4);
+        socklen_t len = sizeof(addr);
+        ::getsockname(fd, reinterpret_cast<sockaddr *>(&addr), &len);
+        port = ntohs(addr.sin_port);
+        thread = std::thread([this] { serve(); });
+    }
+
+    ~http_test_server()
+    {
+        stop = true;
+        thread.join();
+        ::close(fd);
+    }
+
+    void serve()
+    {
+        size_t requests = 0;
+        while (!stop)
+        {
+            pollfd poll_fd{fd, POLLIN, 0};
+            if (::poll(&poll_fd, 1, 20) <= 0)
+            {
+                continue;
+            }
+            int conn = ::accept(fd, nullptr, nullptr);
+            std::string data;
+            char buf[4096];
+            for (;;)
+            {
+                // a request: the headers, then content-length bytes
+                auto headers_end = data.find("\r\n\r\n");
+                if (headers_end != std::string::npos)
+                {
+                    auto length_pos = data.find("Content-Length: ");
+                    auto length = static_cast<size_t>(std::atoi(data.c_str() + length_pos + 16));
+                    if (data.size() >= headers_end + 4 + length)
+                    {
+                        {
+                            std::lock_guard<std::mutex> lock(mutex);
+                            headers.push_back(data.substr(0, headers_end));
+                            bodies.push_back(data.substr(headers_end + 4, length));
+                        }
+                        data.erase(0, headers_end + 4 + length);
+                        int status = requests < statuses.size() ? statuses[requests] : 200;
+                        requests++;
+                        auto response = "HTTP/1.1 " + std::to_string(status) + " X\r\nContent-Length: 2\r\n\r\n{}";
+                        ::send(conn, response.data(), response.size(), MSG_NOSIGNAL);
+                        continue;
+                    }
+                }
+                pollfd conn_fd{conn, POLLIN, 0};
+                if (stop || ::poll(&conn_fd, 1, 20) < 0)
+                {
+                    break;
+                }
+                if (conn_fd.revents == 0)
+                {
+                    continue;
+                }
+                auto n = ::recv(conn, buf, sizeof(buf), 0);
+                if (n <= 0)
+                {
+                    break;
+                }
+                data.append(buf, static_cast<size_t>(n));
+            }
+            ::close(conn);
+        }
+    }
+
+    size_t received()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return bodies.size();
+    }
+
+    bool wait_for(size_t n_requests)
+    {
+        return eventually([&] { return received() >= n_requests; });
+    }
+};
@@ -18,9 +18,19 @@
 #include "spdlog/spdlog.h"
 #include "spdlog/async.h"
 #include "spdlog/sinks/basic_file_sink.h"
+#include "spdlog/sinks/binary_file_sink.h"
+#include "spdlog/sinks/compressed_file_sink.h"
+#include "spdlog/details/binary_log_reader.h"
 #include "spdlog/sinks/daily_file_sink.h"
+#include "spdlog/sinks/hybrid_file_sink.h"
+#ifndef _WIN32
+#    include "spdlog/sinks/mmap_file_sink.h"
+#    include "spdlog/sinks/shared_file_sink.h"
+#endif
 #include "spdlog/sinks/null_sink.h"
 #include "spdlog/sinks/ostream_sink.h"
 #include "spdlog/sinks/rotating_file_sink.h"
 #include "spdlog/sinks/stdout_color_sinks.h"
-#include "spdlog/pattern_formatter.h"
\ No newline at end of file
+#include "spdlog/pattern_formatter.h"
+#include "spdlog/json_formatter.h"
+#include "spdlog/lazy.h"
\ No newline at end of file
@@ -0,0 +1,129 @@
+#include "includes.h"
+
+#include <atomic>
+#include <new>
+
+// count the heap allocations of the process, and of each thread
+static std::atomic<size_t> total_allocations{0};
+static thread_local size_t thread_allocations = 0;
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+// gcc sees free() called on what the replaced operator new returned
+#    pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void *operator new(size_t size)
+{
+    total_allocations.fetch_add(1, std::memory_order_relaxed);
+    thread_allocations++;
+    if (void *ptr = std::malloc(size == 0 ? 1 : size))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+namespace {
+const int warmup_messages = 100;
+const int measured_messages = 1000;
+
+// counts what the async workers pass to it
+class counting_sink : public spdlog::sinks::base_sink<spdlog::details::null_mutex>
+{
+public:
+    size_t count() const
+    {
+        return count_.load();
+    }
+
+protected:
+    void sink_it_(const spdlog::details::log_msg &) override
+    {
+        count_++;
+    }
+    void flush_() override {}
+
+private:
+    std::atomic<size_t> count_{0};
+};
+
+// allocations of this thread while logging short messages, once the logger's buffers are warm
+size_t steady_state_allocations(spdlog::logger &logger)
+{
+    for (int i = 0; i < warmup_messages; i++)
+    {
+        logger.info("Hello {}", i);
+    }
+    auto before = thread_allocations;
+    for (int i = 0; i < measured_messages; i++)
+    {
+        logger.info("Hello {}", i);
+    }
+    return thread_allocations - before;
+}
+
+// allocations of the whole process (the worker included) while logging short messages to an async logger
+size_t async_steady_state_allocations(std::shared_ptr<spdlog::details::thread_pool> tp)
+{
+    auto sink = std::make_shared<counting_sink>();
+    auto logger = std::make_shared<spdlog::async_logger>("allocations", sink, tp, spdlog::async_overflow_policy::block);
+    auto wait_for = [&](size_t expected) {
+        while (sink->count() < expected)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    };
+
+    for (int i = 0; i < warmup_messages; i++)
+    {
+        logger->info("Hello {}", i);
+    }
+    wait_for(warmup_messages);
+    auto before = total_allocations.load();
+    for (int i = 0; i < measured_messages; i++)
+    {
+        logger->info("Hello {}", i);
+    }
+    wait_for(warmup_messages + measured_messages);
+    return total_allocations.load() - before;
+}
+} // namespace
+
+TEST_CASE("null_sink_st", "[allocations]")
+{
+    spdlog::logger logger("allocations", std::make_shared<spdlog::sinks::null_sink_st>());
+    REQUIRE(steady_state_allocations(logger) == 0);
+
+    // the hooks do count: a message longer than the inline buffer is formatted on the heap
+    std::string long_payload(1000, 'x');
+    auto before = thread_allocations;
+    logger.info("{}", long_payload);
+    REQUIRE(thread_allocations > before);
+}
+
+TEST_CASE("basic_file_sink_st", "[allocations]")
+{
+    prepare_logdir();
+    auto sink = std::make_shared<spdlog::sinks::basic_file_sink_st>(SPDLOG_FILENAME_T("test_logs/allocations.txt"));
+    spdlog::logger logger("allocations", sink);
+    REQUIRE(steady_state_allocations(logger) == 0);
+}
+
+TEST_CASE("async", "[allocations]")
+{
+    REQUIRE(async_steady_state_allocations(std::make_shared<spdlog::details::thread_pool>(1024, 1)) == 0);
+
+    spdlog::details::thread_pool_options options;
+    options.queue_backend = spdlog::details::async_queue_backend::arena;
+    REQUIRE(async_steady_state_allocations(std::make_shared<spdlog::details::thread_pool>(1024, 1, options)) == 0);
+}
@@ -0,0 +1,180 @@
+#include "includes.h"
+#include "spdlog/sinks/arrow_file_sink.h"
+
+#include <cstring>
+
+#define ARROW_LOG "test_logs/arrow_log.arrow"
+
+// a reader of the flatbuffers of an arrow file, enough to check it
+struct flatbuffer_reader
+{
+    const std::string &data;
+
+    uint32_t u32(size_t pos) const
+    {
+        uint32_t value;
+        std::memcpy(&value, data.data() + pos, sizeof(value));
+        return value;
+    }
+
+    int64_t i64(size_t pos) const
+    {
+        int64_t value;
+        std::memcpy(&value, data.data() + pos, sizeof(value));
+        return value;
+    }
+
+    size_t root(size_t buffer_pos) const
+    {
+        return buffer_pos + u32(buffer_pos);
+    }
+
+    // the position of the field of the table, 0 if absent
+    size_t field(size_t table, int id) const
+    {
+        auto vtable = table - static_cast<int32_t>(u32(table));
+        uint16_t vtable_size, offset;
+        std::memcpy(&vtable_size, data.data() + vtable, 2);
+        if (4 + 2 * static_cast<size_t>(id) >= vtable_size)
+        {
+            return 0;
+        }
+        std::memcpy(&offset, data.data() + vtable + 4 + 2 * id, 2);
+        return offset == 0 ? 0 : table + offset;
+    }
+
+    size_t object(size_t table, int id) const
+    {
+        auto pos = field(table, id);
+        return pos + u32(pos);
+    }
+
+    std::string string(size_t table, int id) const
+    {
+        auto pos = object(table, id);
+        return data.substr(pos + 4, u32(pos));
+    }
+};
+
+// the utf8 values of a column in a record batch (its buffers validity, offsets, data from the first_buffer)
+static std::vector<std::string> utf8_column(const flatbuffer_reader &reader, size_t record_batch, size_t body, int first_buffer)
+{
+    auto buffers = reader.object(record_batch, 2) + 4;
+    auto offsets = body + static_cast<size_t>(reader.i64(buffers + 16 * (first_buffer + 1)));
+    auto values = body + static_cast<size_t>(reader.i64(buffers + 16 * (first_buffer + 2)));
+    std::vector<std::string> column;
+    auto length = reader.i64(reader.field(record_batch, 0));
+    for (int64_t i = 0; i < length; i++)
+    {
+        auto begin = reader.u32(offsets + 4 * i);
+        auto end = reader.u32(offsets + 4 * (i + 1));
+        column.push_back(reader.data.substr(values + begin, end - begin));
+    }
+    return column;
+}
+
+struct arrow_message
+{
+    uint8_t header_type;
+    size_t header; // the table
+    size_t body;
+};
+
+static arrow_message read_message(const flatbuffer_reader &reader, size_t offset)
+{
+    REQUIRE(reader.u32(offset) == 0xffffffff);
+    auto message = reader.root(offset + 8);
+    auto body = offset + 8 + reader.u32(offset + 4);
+    return {static_cast<uint8_t>(reader.data[reader.field(message, 1)]), reader.object(message, 2), body};
+}
+
+TEST_CASE("arrow_file_sink", "[arrow_file_sink]")
+{
+    prepare_logdir();
+    {
+        auto sink = std::make_shared<spdlog::sinks::arrow_file_sink_mt>(SPDLOG_FILENAME_T(ARROW_LOG), 1024 * 1024, 2, 2);
+        spdlog::logger app("app", sink);
+        spdlog::logger db("db", sink);
+        app.info("first");
+        db.warn("second");
+        app.error("third");
+    }
+
+    auto data = file_contents(ARROW_LOG);
+    flatbuffer_reader reader{data};
+    REQUIRE(data.substr(0, 8) == std::string("ARROW1\0\0", 8));
+    REQUIRE(data.substr(data.size() - 6) == "ARROW1");
+    auto footer = reader.root(data.size() - 10 - reader.u32(data.size() - 10));
+
+    // the schema
+    auto fields = reader.object(reader.object(footer, 1), 1);
+    REQUIRE(reader.u32(fields) == 5);
+    std::vector<std::string> names;
+    for (size_t i = 0; i < 5; i++)
+    {
+        auto field_pos = fields + 4 + 4 * i;
+        names.push_back(reader.string(field_pos + reader.u32(field_pos), 0));
+    }
+    REQUIRE(names == std::vector<std::string>{"time", "level", "logger", "thread", "message"});
+
+    // 2 record batches: 2 messages, then the one left, written on close
+    auto record_batches = reader.object(footer, 3);
+    REQUIRE(reader.u32(record_batches) == 2);
+    std::vector<std::string> messages;
+    std::vector<int32_t> loggers;
+    std::vector<int8_t> levels;
+    for (size_t i = 0; i < 2; i++)
+    {
+        auto message = read_message(reader, static_cast<size_t>(reader.i64(record_batches + 4 + 24 * i)));
+        REQUIRE(message.header_type == 3);
+        auto batch_messages = utf8_column(reader, message.header, message.body, 8);
+        messages.insert(messages.end(), batch_messages.begin(), batch_messages.end());
+        auto buffers = reader.object(message.header, 2) + 4;
+        for (size_t row = 0; row < batch_messages.size(); row++)
+        {
+            levels.push_back(static_cast<int8_t>(data[message.body + static_cast<size_t>(reader.i64(buffers + 16 * 3)) + row]));
+            loggers.push_back(static_cast<int32_t>(reader.u32(message.body + static_cast<size_t>(reader.i64(buffers + 16 * 5)) + 4 * row)));
+        }
+    }
+    REQUIRE(messages == std::vector<std::string>{"first", "second", "third"});
+    REQUIRE(levels == std::vector<int8_t>{spdlog::level::info, spdlog::level::warn, spdlog::level::err});
+    REQUIRE(loggers == std::vector<int32_t>{0, 1, 0});
+
+    // the dictionaries: the level names, the logger names
+    auto dictionaries = reader.object(footer, 2);
+    REQUIRE(reader.u32(dictionaries) == 2);
+    auto logger_dictionary = read_message(reader, static_cast<size_t>(reader.i64(dictionaries + 4 + 24)));
+    REQUIRE(logger_dictionary.header_type == 2);
+    REQUIRE(reader.i64(reader.field(logger_dictionary.header, 0)) == 1);
+    REQUIRE(utf8_column(reader, reader.object(logger_dictionary.header, 1), logger_dictionary.body, 0) == std::vector<std::string>{"app", "db"});
+    auto level_dictionary = read_message(reader, static_cast<size_t>(reader.i64(dictionaries + 4)));
+    REQUIRE(utf8_column(reader, reader.object(level_dictionary.header, 1), level_dictionary.body, 0)[2] == "info");
+}
+
+TEST_CASE("arrow_file_sink rotation", "[arrow_file_sink]")
+{
+    prepare_logdir();
+    {
+        auto sink = std::make_shared<spdlog::sinks::arrow_file_sink_st>(SPDLOG_FILENAME_T(ARROW_LOG), 1, 2, 1);
+        spdlog::logger logger("logger", sink);
+        for (int i = 0; i < 5; i++)
+        {
+            logger.info("message {}", i);
+        }
+    }
+    // a file per batch, the last 3 kept: log.arrow is empty (created after the last rotation)
+    REQUIRE(count_files("test_logs") == 3);
+    for (auto filename : {"test_logs/arrow_log.arrow", "test_logs/arrow_log.1.arrow", "test_logs/arrow_log.2.arrow"})
+    {
+        auto data = file_contents(filename);
+        REQUIRE(data.substr(data.size() - 6) == "ARROW1");
+    }
+    auto data = file_contents("test_logs/arrow_log.1.arrow");
+    REQUIRE(data.find("message 4") != std::string::npos);
+
+    // an existing file is rotated on open
+    {
+        spdlog::sinks::arrow_file_sink_st sink(SPDLOG_FILENAME_T(ARROW_LOG), 1024, 2);
+    }
+    REQUIRE(file_contents("test_logs/arrow_log.2.arrow").find("message 4") != std::string::npos);
+}
@@ -1,8 +1,18 @@
 #include "includes.h"
 #include "spdlog/async.h"
 #include "spdlog/sinks/basic_file_sink.h"
+#include "spdlog/openmetrics.h"
+#include "spdlog/crash_dump.h"
 #include "test_sink.h"
 
+#include <deque>
+
+#ifndef _WIN32
+#    include <fcntl.h>
+#    include <sys/wait.h>
+#    include <unistd.h>
+#endif
+
 #define TEST_FILENAME "test_logs/async_test.log"
 
 TEST_CASE("basic async test ", "[async]")
@@ -82,6 +92,166 @@ TEST_CASE("flush", "[async]")
     REQUIRE(test_sink->flush_counter() == 1);
 }
 
+TEST_CASE("flush future", "[async]")
+{
+    using spdlog::details::async_queue_backend;
+    for (auto backend :
+        {async_queue_backend::blocking, async_queue_backend::lock_free, async_queue_backend::per_thread_lanes, async_queue_backend::arena})
+    {
+        spdlog::details::thread_pool_options options;
+        options.queue_backend = backend;
+        auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+        test_sink->set_delay(std::chrono::milliseconds(1));
+        size_t messages = 20;
+        auto tp = std::make_shared<spdlog::details::thread_pool>(64, 1, options);
+        auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp);
+        for (size_t i = 0; i < messages; i++)
+        {
+            logger->info("Hello message #{}", i);
+        }
+        auto flushed = logger->flush_async();
+        REQUIRE(flushed.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+        REQUIRE(test_sink->msg_counter() == messages);
+        REQUIRE(test_sink->flush_counter() == 1);
+    }
+}
+
+TEST_CASE("overrun keeps the control messages", "[async]")
+{
+    using spdlog::details::async_queue_backend;
+    for (auto backend :
+        {async_queue_backend::blocking, async_queue_backend::lock_free, async_queue_backend::per_thread_lanes, async_queue_backend::arena})
+    {
+        spdlog::details::thread_pool_options options;
+        options.queue_backend = backend;
+        options.pin_loggers = true;
+        auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+        test_sink->set_delay(std::chrono::milliseconds(1));
+        auto tp = std::make_shared<spdlog::details::thread_pool>(16, 1, options);
+        {
+            auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp, spdlog::async_overflow_policy::overrun_oldest);
+            logger->info("Hello message");
+            // queued behind a slow message, then the messages overrun each other
+            auto flushed = logger->flush_async();
+            for (size_t i = 0; i < 200; i++)
+            {
+                logger->info("Hello message #{}", i);
+            }
+            REQUIRE(flushed.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+            tp->wait_processed();
+        }
+        REQUIRE(tp->overrun_counter() > 0);
+        REQUIRE(test_sink->flush_counter() == 1);
+    }
+}
+
+TEST_CASE("flush and room callbacks", "[async]")
+{
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    test_sink->set_delay(std::chrono::milliseconds(5));
+    size_t messages = 9;
+    auto tp = std::make_shared<spdlog::details::thread_pool>(8, 1);
+    auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp);
+    for (size_t i = 0; i < messages; i++)
+    {
+        logger->info("Hello message #{}", i);
+    }
+
+    // called on the worker once it dequeued (or right away if there is room)
+    std::promise<bool> room;
+    logger->when_queue_has_room([&room](bool has_room) { room.set_value(has_room); });
+    auto room_future = room.get_future();
+    REQUIRE(room_future.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+    REQUIRE(room_future.get());
+    REQUIRE(tp->load_factor() < 1);
+
+    std::promise<size_t> flushed;
+    logger->flush_async([&] { flushed.set_value(test_sink->msg_counter()); });
+    auto flushed_future = flushed.get_future();
+    REQUIRE(flushed_future.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+    REQUIRE(flushed_future.get() == messages);
+    REQUIRE(test_sink->flush_counter() == 1);
+}
+
+#ifdef SPDLOG_COROUTINES
+namespace {
+// runs until its first suspension on the calling thread, then on the thread resuming it
+struct detached_task
+{
+    struct promise_type
+    {
+        detached_task get_return_object()
+        {
+            return {};
+        }
+        std::suspend_never initial_suspend() noexcept
+        {
+            return {};
+        }
+        std::suspend_never final_suspend() noexcept
+        {
+            return {};
+        }
+        void return_void() {}
+        void unhandled_exception()
+        {
+            std::terminate();
+        }
+    };
+};
+
+detached_task log_and_flush(std::shared_ptr<spdlog::async_logger> logger, size_t messages, std::promise<void> &done)
+{
+    for (size_t i = 0; i < messages; i++)
+    {
+        if (!co_await logger->queue_room())
+        {
+            co_return;
+        }
+        logger->info("Hello message #{}", i);
+    }
+    // resumed on the worker: the flush request must not block it
+    if (co_await logger->queue_room())
+    {
+        co_await logger->flush_awaitable();
+    }
+    done.set_value();
+}
+} // namespace
+
+TEST_CASE("coroutines", "[async]")
+{
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    test_sink->set_delay(std::chrono::milliseconds(1));
+    size_t messages = 50;
+    auto tp = std::make_shared<spdlog::details::thread_pool>(8, 1);
+    auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp);
+    std::promise<void> done;
+    log_and_flush(logger, messages, done);
+    auto done_future = done.get_future();
+    REQUIRE(done_future.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+    REQUIRE(test_sink->msg_counter() == messages);
+    REQUIRE(test_sink->flush_counter() == 1);
+}
+#endif
+
+TEST_CASE("wait processed", "[async]")
+{
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    test_sink->set_delay(std::chrono::milliseconds(1));
+    size_t messages = 40;
+    auto tp = std::make_shared<spdlog::details::thread_pool>(messages, 2);
+    auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp);
+    for (size_t i = 0; i < messages; i++)
+    {
+        logger->info("Hello message #{}", i);
+    }
+    logger->flush();
+    tp->wait_processed();
+    REQUIRE(test_sink->msg_counter() == messages);
+    REQUIRE(test_sink->flush_counter() == 1);
+}
+
 TEST_CASE("async periodic flush", "[async]")
 {
 
@@ -95,6 +265,34 @@ TEST_CASE("async periodic flush", "[async]")
     spdlog::drop_all();
 }
 
+TEST_CASE("flush all - batched", "[async]")
+{
+    spdlog::details::thread_pool_options options;
+    options.shards = 2;
+    auto tp = std::make_shared<spdlog::details::thread_pool>(64, 2, options);
+    auto shared_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    auto other_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    auto logger1 = std::make_shared<spdlog::async_logger>("as1", shared_sink, tp);
+    auto logger2 = std::make_shared<spdlog::async_logger>("as2", spdlog::sinks_init_list{shared_sink, other_sink}, tp);
+    logger1->set_shard(0);
+    logger2->set_shard(1);
+    auto sync_logger = std::make_shared<spdlog::logger>("sync", other_sink);
+    spdlog::register_logger(logger1);
+    spdlog::register_logger(logger2);
+    spdlog::register_logger(sync_logger);
+    logger1->info("Hello message");
+    logger2->info("Hello message");
+
+    // a single message per shard, the sinks of both loggers are flushed once
+    spdlog::details::registry::instance().flush_all();
+    tp->wait_processed();
+    REQUIRE(shared_sink->msg_counter() == 2);
+    REQUIRE(shared_sink->flush_counter() == 1);
+    // by the async loggers, and by the sync logger
+    REQUIRE(other_sink->flush_counter() == 2);
+    spdlog::drop_all();
+}
+
 TEST_CASE("tp->wait_empty() ", "[async]")
 {
     auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
@@ -188,3 +386,1387 @@ TEST_CASE("to_file multi-workers", "[async]")
 
     require_message_count(TEST_FILENAME, messages);
 }
+
+TEST_CASE("lock-free queue backend", "[async]")
+{
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    size_t queue_size = 64;
+    size_t messages = 256;
+    size_t n_threads = 8;
+    {
+        spdlog::details::thread_pool_options options;
+        options.queue_backend = spdlog::details::async_queue_backend::lock_free;
+        auto tp = std::make_shared<spdlog::details::thread_pool>(queue_size, 2, options);
+        auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp, spdlog::async_overflow_policy::block);
+
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < n_threads; i++)
+        {
+            threads.emplace_back([logger, messages] {
+                for (size_t j = 0; j < messages; j++)
+                {
+                    logger->info("Hello message #{}", j);
+                }
+            });
+        }
+
+        for (auto &t : threads)
+        {
+            t.join();
+        }
+        logger->flush();
+        REQUIRE(tp->overrun_counter() == 0);
+    }
+
+    REQUIRE(test_sink->msg_counter() == messages * n_threads);
+    REQUIRE(test_sink->flush_counter() == 1);
+}
+
+TEST_CASE("lock-free queue backend overrun", "[async]")
+{
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    test_sink->set_delay(std::chrono::milliseconds(1));
+    size_t messages = 1024;
+
+    spdlog::details::thread_pool_options options;
+    options.queue_backend = spdlog::details::async_queue_backend::lock_free;
+    auto tp = std::make_shared<spdlog::details::thread_pool>(4, 1, options);
+    auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp, spdlog::async_overflow_policy::overrun_oldest);
+    for (size_t i = 0; i < messages; i++)
+    {
+        logger->info("Hello message");
+    }
+    REQUIRE(test_sink->msg_counter() < messages);
+    REQUIRE(tp->overrun_counter() > 0);
+}
+
+TEST_CASE("per thread lanes backend", "[async]")
+{
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    size_t queue_size = 32;
+    size_t messages = 256;
+    size_t n_threads = 8;
+    {
+        spdlog::details::thread_pool_options options;
+        options.queue_backend = spdlog::details::async_queue_backend::per_thread_lanes;
+        auto tp = std::make_shared<spdlog::details::thread_pool>(queue_size, 1, options);
+        auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp, spdlog::async_overflow_policy::block);
+
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < n_threads; i++)
+        {
+            threads.emplace_back([logger, messages] {
+                for (size_t j = 0; j < messages; j++)
+                {
+                    logger->info("Hello message #{}", j);
+                }
+            });
+        }
+
+        for (auto &t : threads)
+        {
+            t.join();
+        }
+        logger->flush();
+    }
+
+    REQUIRE(test_sink->msg_counter() == messages * n_threads);
+    REQUIRE(test_sink->flush_counter() == 1);
+}
+
+TEST_CASE("batch dequeue", "[async]")
+{
+    prepare_logdir();
+    size_t messages = 1024;
+    spdlog::filename_t filename = SPDLOG_FILENAME_T(TEST_FILENAME);
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    {
+        spdlog::details::thread_pool_options options;
+        options.batch_size = 64;
+        auto file_sink = std::make_shared<spdlog::sinks::basic_file_sink_mt>(filename, true);
+        auto tp = std::make_shared<spdlog::details::thread_pool>(messages, 2, options);
+        auto logger = std::make_shared<spdlog::async_logger>("as", spdlog::sinks_init_list{file_sink, test_sink}, tp);
+        for (size_t j = 0; j < messages; j++)
+        {
+            logger->info("Hello message #{}", j);
+        }
+        logger->flush();
+    }
+    REQUIRE(test_sink->msg_counter() == messages);
+    REQUIRE(test_sink->flush_counter() == 1);
+    require_message_count(TEST_FILENAME, messages);
+}
+
+TEST_CASE("batch dequeue - sink level", "[async]")
+{
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    test_sink->set_level(spdlog::level::warn);
+    {
+        spdlog::details::thread_pool_options options;
+        options.batch_size = 16;
+        auto tp = std::make_shared<spdlog::details::thread_pool>(128, 1, options);
+        auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp);
+        for (int j = 0; j < 100; j++)
+        {
+            logger->info("Hello message #{}", j);
+            logger->warn("Hello message #{}", j);
+        }
+    }
+    REQUIRE(test_sink->msg_counter() == 100);
+}
+
+TEST_CASE("wait strategies", "[async]")
+{
+    using spdlog::details::async_queue_backend;
+    using spdlog::details::async_wait_strategy;
+    size_t messages = 256;
+    size_t n_threads = 4;
+    for (auto backend : {async_queue_backend::blocking, async_queue_backend::lock_free, async_queue_backend::per_thread_lanes})
+    {
+        for (auto strategy : {async_wait_strategy::spin_yield_park, async_wait_strategy::busy_spin})
+        {
+            auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+            {
+                spdlog::details::thread_pool_options options;
+                options.queue_backend = backend;
+                options.wait_strategy = strategy;
+                options.spin_count = 10;
+                options.yield_count = 10;
+                auto tp = std::make_shared<spdlog::details::thread_pool>(64, 2, options);
+                auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp, spdlog::async_overflow_policy::block);
+
+                std::vector<std::thread> threads;
+                for (size_t i = 0; i < n_threads; i++)
+                {
+                    threads.emplace_back([logger, messages] {
+                        for (size_t j = 0; j < messages; j++)
+                        {
+                            logger->info("Hello message #{}", j);
+                        }
+                    });
+                }
+                for (auto &t : threads)
+                {
+                    t.join();
+                }
+                logger->flush();
+            }
+            REQUIRE(test_sink->msg_counter() == messages * n_threads);
+            REQUIRE(test_sink->flush_counter() == 1);
+        }
+    }
+}
+
+TEST_CASE("pinned loggers", "[async]")
+{
+    size_t messages = 512;
+    for (size_t batch_size : {1, 16})
+    {
+        auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+        spdlog::details::thread_pool_options options;
+        options.pin_loggers = true;
+        options.batch_size = batch_size;
+        auto tp = std::make_shared<spdlog::details::thread_pool>(64, 3, options);
+        {
+            auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp);
+            auto cloned = logger->clone("as-clone");
+            REQUIRE(tp->attached_loggers() == 2);
+            for (size_t j = 0; j < messages; j++)
+            {
+                logger->info("Hello message #{}", j);
+                cloned->info("Hello message #{}", j);
+            }
+            logger->flush();
+        }
+        // the loggers' destructors waited for their queued messages
+        REQUIRE(tp->attached_loggers() == 0);
+        REQUIRE(test_sink->msg_counter() == messages * 2);
+        REQUIRE(test_sink->flush_counter() == 1);
+    }
+
+    // an attached logger keeps its pool alive
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    spdlog::details::thread_pool_options options;
+    options.pin_loggers = true;
+    auto tp = std::make_shared<spdlog::details::thread_pool>(64, 1, options);
+    std::weak_ptr<spdlog::details::thread_pool> weak_tp = tp;
+    auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp);
+    tp.reset();
+    REQUIRE_FALSE(weak_tp.expired());
+    logger->info("Hello message");
+    logger->flush_async().get();
+    REQUIRE(test_sink->msg_counter() == 1);
+    logger.reset();
+    REQUIRE(weak_tp.expired());
+}
+
+TEST_CASE("arena queue backend", "[async]")
+{
+    size_t messages = 256;
+    size_t n_threads = 4;
+    std::string long_payload(1000, 'x');
+    for (bool pin_loggers : {false, true})
+    {
+        auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+        test_sink->set_pattern("%v");
+        {
+            spdlog::details::thread_pool_options options;
+            options.queue_backend = spdlog::details::async_queue_backend::arena;
+            options.arena_size = 16 * 1024;
+            options.pin_loggers = pin_loggers;
+            auto tp = std::make_shared<spdlog::details::thread_pool>(64, 2, options);
+            auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp, spdlog::async_overflow_policy::block);
+
+            std::vector<std::thread> threads;
+            for (size_t i = 0; i < n_threads; i++)
+            {
+                threads.emplace_back([logger, messages, &long_payload] {
+                    for (size_t j = 0; j < messages; j++)
+                    {
+                        logger->info("{}", j % 2 ? long_payload : std::string("short"));
+                    }
+                });
+            }
+            for (auto &t : threads)
+            {
+                t.join();
+            }
+            logger->flush();
+            REQUIRE(tp->overrun_counter() == 0);
+        }
+        REQUIRE(test_sink->msg_counter() == messages * n_threads);
+        REQUIRE(test_sink->flush_counter() == 1);
+        for (auto &line : test_sink->lines())
+        {
+            REQUIRE((line == "short" || line == long_payload));
+        }
+    }
+}
+
+TEST_CASE("arena oversized records", "[async]")
+{
+    // larger than the arena: the messages are kept on the heap, in order with the others
+    std::string huge_payload(8000, 'h');
+    for (auto policy : {spdlog::async_overflow_policy::block, spdlog::async_overflow_policy::overrun_oldest})
+    {
+        auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+        test_sink->set_pattern("%v");
+        {
+            spdlog::details::thread_pool_options options;
+            options.queue_backend = spdlog::details::async_queue_backend::arena;
+            options.arena_size = 4096;
+            auto tp = std::make_shared<spdlog::details::thread_pool>(64, 1, options);
+            auto logger = std::make_shared<spdlog::async_logger>("oversized", test_sink, tp, policy);
+            logger->info("first");
+            logger->info("{}", huge_payload);
+            logger->info(huge_payload);
+            logger->info("last");
+            logger->flush();
+            REQUIRE(tp->overrun_counter() == 0);
+        }
+        auto lines = test_sink->lines();
+        REQUIRE(lines.size() == 4);
+        REQUIRE(lines[0] == "first");
+        REQUIRE(lines[1] == huge_payload);
+        REQUIRE(lines[2] == huge_payload);
+        REQUIRE(lines[3] == "last");
+    }
+}
+
+TEST_CASE("arena in place formatting", "[async]")
+{
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    test_sink->set_pattern("[%l] %v");
+    {
+        spdlog::details::thread_pool_options options;
+        options.queue_backend = spdlog::details::async_queue_backend::arena;
+        options.collect_stats = true;
+        auto tp = std::make_shared<spdlog::details::thread_pool>(64, 1, options);
+        REQUIRE(tp->formats_in_place());
+        auto logger = std::make_shared<spdlog::async_logger>("in_place", test_sink, tp);
+        std::string errors;
+        logger->set_error_handler([&errors](const std::string &msg) { errors = msg; });
+        logger->info("hello {} {}", 1, std::string("world"));
+        // longer than the reserved room: formatted again
+        logger->warn("{}", std::string(1000, 'y'));
+        // the record of a failed format is dropped
+        logger->info(SPDLOG_FMT_RUNTIME("{} {}"), 1);
+        logger->error("{:>5}", "end");
+        logger->flush();
+        REQUIRE(errors == "argument not found");
+        REQUIRE(tp->stats().enqueued == 4); // 3 messages and the flush
+    }
+    auto lines = test_sink->lines();
+    REQUIRE(lines.size() == 3);
+    REQUIRE(lines[0] == "[info] hello 1 world");
+    REQUIRE(lines[1] == "[warning] " + std::string(1000, 'y'));
+    REQUIRE(lines[2] == "[error]   end");
+}
+
+TEST_CASE("referenced logger name", "[async]")
+{
+    using spdlog::details::async_msg;
+    using spdlog::details::async_msg_arena_codec;
+    using spdlog::details::async_msg_type;
+    std::string name("referenced");
+    spdlog::details::log_msg msg(name, spdlog::level::info, "literal");
+    async_msg queued(nullptr, async_msg_type::log, msg, true);
+    REQUIRE(queued.references_logger_name());
+    REQUIRE(queued.logger_name.data() == name.data());
+    REQUIRE(queued.payload == "literal");
+    REQUIRE(queued.extra().size() == 0);
+    async_msg moved(std::move(queued));
+    REQUIRE(moved.logger_name.data() == name.data());
+    REQUIRE(moved.payload == "literal");
+
+    // the arena records hold a pointer to the name instead of its bytes
+    async_msg copied(nullptr, async_msg_type::log, msg);
+    REQUIRE(copied.logger_name.data() != name.data());
+    REQUIRE(async_msg_arena_codec::encoded_size(copied) == async_msg_arena_codec::encoded_size(moved) + name.size());
+    std::vector<char> record(async_msg_arena_codec::encoded_size(moved) + alignof(std::max_align_t));
+    auto *dest = record.data() + (alignof(std::max_align_t) - reinterpret_cast<uintptr_t>(record.data()) % alignof(std::max_align_t));
+    async_msg_arena_codec::encode(dest, std::move(moved));
+    async_msg decoded;
+    async_msg_arena_codec::decode(dest, decoded);
+    REQUIRE(decoded.references_logger_name());
+    REQUIRE(decoded.logger_name.data() == name.data());
+    REQUIRE(decoded.payload == "literal");
+
+    // the names of the backtraced messages are copies: copied again
+    using spdlog::details::async_queue_backend;
+    for (auto backend : {async_queue_backend::blocking, async_queue_backend::arena})
+    {
+        auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+        test_sink->set_pattern("%n %v");
+        {
+            spdlog::details::thread_pool_options options;
+            options.queue_backend = backend;
+            auto tp = std::make_shared<spdlog::details::thread_pool>(128, 1, options);
+            auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp);
+            logger->enable_backtrace(4);
+            logger->debug("traced");
+            logger->info("literal");
+            logger->dump_backtrace();
+            logger->flush();
+        }
+        auto lines = test_sink->lines();
+        REQUIRE(lines.size() == 5);
+        REQUIRE(lines[0] == "as literal");
+        REQUIRE(lines[2] == "as traced");
+        REQUIRE(lines[3] == "as literal");
+    }
+}
+
+TEST_CASE("arena record layout", "[async]")
+{
+    using spdlog::details::async_msg;
+    using spdlog::details::async_msg_arena_codec;
+    using spdlog::details::async_msg_type;
+    auto roundtrip = [](const spdlog::details::log_msg &msg) {
+        async_msg queued(nullptr, async_msg_type::log, msg);
+        std::vector<char> record(async_msg_arena_codec::encoded_size(queued) + alignof(std::max_align_t));
+        auto *dest = record.data() + (alignof(std::max_align_t) - reinterpret_cast<uintptr_t>(record.data()) % alignof(std::max_align_t));
+        async_msg_arena_codec::encode(dest, std::move(queued));
+        async_msg decoded;
+        async_msg_arena_codec::decode(dest, decoded);
+        return decoded;
+    };
+
+    // a plain message: the header and its strings only
+    spdlog::details::log_msg plain("name", spdlog::level::warn, "payload");
+    plain.thread_id = 1234;
+    REQUIRE(async_msg_arena_codec::encoded_size(plain, 0, false) == sizeof(async_msg_arena_codec::header) + 4 + 7);
+    auto decoded = roundtrip(plain);
+    REQUIRE(decoded.logger_name == "name");
+    REQUIRE(decoded.payload == "payload");
+    REQUIRE(decoded.level == spdlog::level::warn);
+    REQUIRE(decoded.thread_id == 1234);
+    REQUIRE(decoded.source.empty());
+    REQUIRE(decoded.trace.empty());
+
+    // the source location and trace context follow the header if set
+    spdlog::field fields[] = {{"key", "value"}};
+    spdlog::details::log_msg full(spdlog::source_loc{"file.cpp", 42, "func"}, "name", spdlog::level::err, "payload");
+    full.trace.trace_id[0] = 7;
+    full.trace.span_id[7] = 9;
+    full.fields = fields;
+    full.n_fields = 1;
+    REQUIRE(async_msg_arena_codec::encoded_size(full, 0, false) == async_msg_arena_codec::encoded_size(plain, 0, false) +
+                                                                       sizeof(spdlog::source_loc) + sizeof(spdlog::trace_context) +
+                                                                       sizeof(spdlog::field) + 3 + 5);
+    decoded = roundtrip(full);
+    REQUIRE(decoded.source.line == 42);
+    REQUIRE(std::string(decoded.source.filename) == "file.cpp");
+    REQUIRE(std::string(decoded.source.funcname) == "func");
+    REQUIRE(decoded.trace.trace_id[0] == 7);
+    REQUIRE(decoded.trace.span_id[7] == 9);
+    REQUIRE(decoded.n_fields == 1);
+    REQUIRE(decoded.fields[0].key == "key");
+    REQUIRE(decoded.fields[0].string_value == "value");
+    REQUIRE(decoded.payload == "payload");
+}
+
+TEST_CASE("deferred formatting", "[async]")
+{
+    REQUIRE(spdlog::details::deferred_format<int &, double, char, bool>::eligible);
+    REQUIRE_FALSE(spdlog::details::deferred_format<std::string &>::eligible);
+    REQUIRE_FALSE(spdlog::details::deferred_format<const char *>::eligible);
+
+    using spdlog::details::async_queue_backend;
+    for (auto backend : {async_queue_backend::blocking, async_queue_backend::arena})
+    {
+        auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+        test_sink->set_pattern("%v");
+        {
+            spdlog::details::thread_pool_options options;
+            options.queue_backend = backend;
+            auto tp = std::make_shared<spdlog::details::thread_pool>(128, 1, options);
+            auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp);
+            logger->set_deferred_formatting(true);
+            int i = 42;
+            logger->info("int {} double {:.2f} char {} bool {}", i, 1.5, 'x', true);
+            // not arithmetic - formatted eagerly
+            std::string s("str");
+            logger->info("string {}", s);
+            logger->info("no args");
+            logger->flush();
+        }
+        REQUIRE(test_sink->lines().size() == 3);
+        REQUIRE(test_sink->lines()[0] == "int 42 double 1.50 char x bool true");
+        REQUIRE(test_sink->lines()[1] == "string str");
+        REQUIRE(test_sink->lines()[2] == "no args");
+    }
+}
+
+TEST_CASE("sharded thread pool", "[async]")
+{
+    size_t messages = 100; // test_sink keeps up to 100 lines
+    spdlog::details::thread_pool_options options;
+    options.shards = 3;
+    REQUIRE_THROWS_AS(spdlog::details::thread_pool(16, 2, options), spdlog::spdlog_ex);
+
+    auto slow_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    test_sink->set_pattern("%v");
+    {
+        auto tp = std::make_shared<spdlog::details::thread_pool>(messages, 3, options);
+        REQUIRE(tp->shards() == 3);
+        auto slow_logger = std::make_shared<spdlog::async_logger>("slow", slow_sink, tp);
+        auto logger = std::make_shared<spdlog::async_logger>("fast", test_sink, tp);
+        slow_logger->set_shard(0);
+        logger->set_shard(1);
+        REQUIRE(tp->shard_of(*slow_logger) == 0);
+        REQUIRE(tp->shard_of(*logger) == 1);
+
+        // a stalled shard doesn't hold back the other shards
+        slow_sink->set_delay(std::chrono::milliseconds(1000));
+        auto start = std::chrono::steady_clock::now();
+        slow_logger->info("slow message");
+        for (size_t j = 0; j < messages; j++)
+        {
+            logger->info("{}", j);
+        }
+        logger->flush();
+        while (test_sink->flush_counter() == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(1000));
+    }
+    REQUIRE(slow_sink->msg_counter() == 1);
+    // one worker per shard - the messages of a logger keep their order
+    auto lines = test_sink->lines();
+    REQUIRE(lines.size() == messages);
+    for (size_t j = 0; j < messages; j++)
+    {
+        REQUIRE(lines[j] == std::to_string(j));
+    }
+}
+
+TEST_CASE("elastic thread pool", "[async]")
+{
+    size_t messages = 99; // test_sink keeps up to 100 lines
+    spdlog::details::thread_pool_options options;
+    options.max_threads = 3;
+    options.scale_up_depth = 10;
+    options.scale_up_delay = std::chrono::milliseconds(10);
+    options.idle_timeout = std::chrono::milliseconds(100);
+    options.poll_interval = std::chrono::milliseconds(1);
+    options.collect_stats = true;
+
+    std::vector<std::shared_ptr<spdlog::sinks::test_sink_mt>> sinks;
+    {
+        auto tp = std::make_shared<spdlog::details::thread_pool>(1000, 1, options);
+        REQUIRE(tp->shards() == 3);
+        REQUIRE(tp->workers() == 1);
+        std::vector<std::shared_ptr<spdlog::async_logger>> loggers;
+        for (size_t i = 0; i < 3; i++)
+        {
+            sinks.push_back(std::make_shared<spdlog::sinks::test_sink_mt>());
+            sinks.back()->set_pattern("%v");
+            sinks.back()->set_delay(std::chrono::milliseconds(1));
+            loggers.push_back(std::make_shared<spdlog::async_logger>("elastic" + std::to_string(i), sinks.back(), tp));
+            loggers.back()->set_shard(i);
+        }
+
+        // a backlog in the shards of the single worker adds workers
+        for (size_t j = 0; j < messages; j++)
+        {
+            for (auto &logger : loggers)
+            {
+                logger->info("{}", j);
+            }
+        }
+        tp->wait_processed();
+        for (auto &sink : sinks)
+        {
+            REQUIRE(sink->msg_counter() == messages);
+        }
+        REQUIRE(tp->stats().workers_added > 0);
+
+        // and the added workers retire once idle
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (tp->workers() > 1 && std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        auto stats = tp->stats();
+        REQUIRE(stats.workers == 1);
+        REQUIRE(stats.workers_retired == stats.workers_added);
+
+        // the initial worker serves their shards again
+        for (auto &logger : loggers)
+        {
+            logger->info("after");
+        }
+        tp->wait_processed();
+        for (auto &sink : sinks)
+        {
+            REQUIRE(sink->msg_counter() == messages + 1);
+        }
+    }
+
+    // one worker at a time per shard - the messages of a logger keep their order
+    for (auto &sink : sinks)
+    {
+        auto lines = sink->lines();
+        REQUIRE(lines.size() == messages + 1);
+        REQUIRE(lines.back() == "after");
+        for (size_t j = 0; j < messages; j++)
+        {
+            REQUIRE(lines[j] == std::to_string(j));
+        }
+    }
+}
+
+TEST_CASE("work stealing", "[async]")
+{
+    size_t messages = 100; // test_sink keeps up to 100 lines
+    spdlog::details::thread_pool_options options;
+    options.shards = 2;
+    options.work_stealing = true;
+    options.poll_interval = std::chrono::milliseconds(1);
+    options.max_threads = 3;
+    REQUIRE_THROWS_AS(spdlog::details::thread_pool(16, 2, options), spdlog::spdlog_ex);
+    options.max_threads = 0;
+
+    auto hot_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    auto ordered_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    ordered_sink->set_pattern("%v");
+    {
+        auto tp = std::make_shared<spdlog::details::thread_pool>(1000, 2, options);
+        auto hot_logger = std::make_shared<spdlog::async_logger>("hot", hot_sink, tp);
+        auto ordered_logger = std::make_shared<spdlog::async_logger>("ordered", ordered_sink, tp);
+        hot_logger->set_shard(0);
+        hot_logger->set_order_insensitive(true);
+        ordered_logger->set_shard(0);
+
+        // the idle worker of shard 1 takes its share of the hot logger's messages
+        hot_sink->set_delay(std::chrono::milliseconds(1));
+        for (size_t j = 0; j < messages; j++)
+        {
+            hot_logger->info("{}", j);
+            ordered_logger->info("{}", j);
+        }
+        while (hot_sink->msg_counter() < messages)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        REQUIRE(tp->stats().stolen > 0);
+        tp->wait_processed();
+        REQUIRE(ordered_sink->msg_counter() == messages);
+        REQUIRE(tp->queue_size() == 0);
+
+        hot_logger->info("last");
+    }
+    // processed before the workers exit
+    REQUIRE(hot_sink->msg_counter() == messages + 1);
+    // the messages of the other loggers keep their order
+    auto lines = ordered_sink->lines();
+    REQUIRE(lines.size() == messages);
+    for (size_t j = 0; j < messages; j++)
+    {
+        REQUIRE(lines[j] == std::to_string(j));
+    }
+}
+
+TEST_CASE("load thresholds", "[async]")
+{
+    size_t queue_size = 100;
+    std::mutex events_mutex;
+    std::vector<std::pair<double, bool>> events; // threshold, rising
+    spdlog::details::thread_pool_options options;
+    options.load_thresholds = {0.5, 0.9};
+    options.on_load_threshold = [&](size_t, double threshold, bool rising) {
+        std::lock_guard<std::mutex> lock(events_mutex);
+        events.emplace_back(threshold, rising);
+    };
+
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    {
+        auto tp = std::make_shared<spdlog::details::thread_pool>(queue_size, 1, options);
+        auto logger = std::make_shared<spdlog::async_logger>("load", test_sink, tp);
+        REQUIRE(logger->load_factor() == 0);
+
+        // the worker is held by the first message while the queue fills up
+        test_sink->set_delay(std::chrono::milliseconds(200));
+        logger->info("first");
+        while (test_sink->msg_counter() == 0 && tp->queue_size() > 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        test_sink->set_delay(std::chrono::milliseconds::zero());
+        for (int i = 0; i < 60; i++)
+        {
+            logger->info("message #{}", i);
+        }
+        REQUIRE(logger->load_factor() >= 0.5);
+        REQUIRE(tp->load_factor() >= 0.5);
+        {
+            std::lock_guard<std::mutex> lock(events_mutex);
+            REQUIRE(events.size() == 1);
+            REQUIRE(events[0] == std::make_pair(0.5, true));
+        }
+
+        tp->wait_processed();
+        REQUIRE(logger->load_factor() == 0);
+    }
+    REQUIRE(test_sink->msg_counter() == 61);
+    REQUIRE(events.size() == 2);
+    REQUIRE(events[1] == std::make_pair(0.5, false));
+}
+
+TEST_CASE("worker threads setup", "[async]")
+{
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    spdlog::details::thread_pool_options options;
+    options.thread_name = "spdlog-worker";
+    options.thread_nice = 1;
+#ifdef __linux__
+    options.cpu_affinity = {0};
+    std::mutex names_mutex;
+    std::vector<std::string> names;
+    options.on_thread_start = [&] {
+        char name[16] = {};
+        pthread_getname_np(pthread_self(), name, sizeof(name));
+        std::lock_guard<std::mutex> lock(names_mutex);
+        names.emplace_back(name);
+    };
+#endif
+    {
+        auto tp = std::make_shared<spdlog::details::thread_pool>(16, 2, options);
+        auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp);
+        logger->info("Hello message");
+    }
+    REQUIRE(test_sink->msg_counter() == 1);
+#ifdef __linux__
+    std::sort(names.begin(), names.end());
+    REQUIRE(names == std::vector<std::string>{"spdlog-worker-0", "spdlog-worker-1"});
+
+    options.cpu_affinity = {100000};
+    REQUIRE_THROWS_AS(spdlog::details::thread_pool(16, 2, options), spdlog::spdlog_ex);
+#endif
+}
+
+TEST_CASE("queue stats", "[async]")
+{
+    using spdlog::details::async_queue_backend;
+    using spdlog::details::async_stats;
+    auto histogram_total = [](const async_stats &stats) {
+        size_t total = 0;
+        for (auto n : stats.latency_histogram)
+        {
+            total += n;
+        }
+        return total;
+    };
+
+    {
+        auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+        auto tp = std::make_shared<spdlog::details::thread_pool>(4, 1);
+        auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp);
+        logger->info("Hello message");
+        logger->flush();
+        REQUIRE(tp->stats().enqueued == 0);
+        REQUIRE(logger->stats().enqueued == 0);
+    }
+
+    for (auto backend : {async_queue_backend::blocking, async_queue_backend::lock_free, async_queue_backend::per_thread_lanes,
+             async_queue_backend::arena})
+    {
+        size_t messages = 20;
+        spdlog::details::thread_pool_options options;
+        options.queue_backend = backend;
+        options.collect_stats = true;
+        auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+        test_sink->set_delay(std::chrono::milliseconds(2));
+        auto tp = std::make_shared<spdlog::details::thread_pool>(4, 1, options);
+        auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp, spdlog::async_overflow_policy::block);
+        auto overrun_logger = std::make_shared<spdlog::async_logger>("overrun", test_sink, tp, spdlog::async_overflow_policy::overrun_oldest);
+        for (size_t i = 0; i < messages; i++)
+        {
+            logger->info("Hello message #{}", i);
+        }
+        logger->flush();
+        while (test_sink->flush_counter() == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        for (size_t i = 0; i < messages; i++)
+        {
+            overrun_logger->info("Hello message #{}", i);
+        }
+
+        async_stats stats;
+        do
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            stats = tp->stats();
+        } while (stats.dequeued + stats.dropped < stats.enqueued);
+
+        REQUIRE(stats.enqueued == 2 * messages + 1);
+        REQUIRE(stats.dropped > 0);
+        REQUIRE(stats.dequeued + stats.dropped == stats.enqueued);
+        REQUIRE(stats.blocked > 0);
+        REQUIRE(stats.blocked_time.count() > 0);
+        REQUIRE(stats.high_water_mark >= 2);
+        REQUIRE(stats.high_water_mark <= 5);
+        REQUIRE(histogram_total(stats) == stats.dequeued - 1);
+        REQUIRE(stats.latency_histogram[0] < stats.dequeued - 1); // the sink delay shows up in the queueing latency
+
+        auto logger_stats = logger->stats();
+        REQUIRE(logger_stats.enqueued == messages + 1);
+        REQUIRE(logger_stats.dequeued == messages + 1);
+        REQUIRE(logger_stats.dropped == 0);
+        REQUIRE(logger_stats.blocked == stats.blocked);
+        REQUIRE(histogram_total(logger_stats) == messages);
+
+        auto overrun_stats = overrun_logger->stats();
+        REQUIRE(overrun_stats.enqueued == messages);
+        REQUIRE(overrun_stats.blocked == 0);
+        REQUIRE(overrun_stats.dequeued + stats.dropped == messages);
+    }
+}
+
+TEST_CASE("discard new policy", "[async]")
+{
+    using spdlog::details::async_queue_backend;
+    for (auto backend : {async_queue_backend::blocking, async_queue_backend::lock_free, async_queue_backend::arena})
+    {
+        size_t messages = 30;
+        spdlog::details::thread_pool_options options;
+        options.queue_backend = backend;
+        options.collect_stats = true;
+        auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+        test_sink->set_pattern("%v");
+        test_sink->set_delay(std::chrono::milliseconds(5));
+        auto tp = std::make_shared<spdlog::details::thread_pool>(4, 1, options);
+        auto logger = std::make_shared<spdlog::async_logger>("discard", test_sink, tp, spdlog::async_overflow_policy::discard_new);
+        for (size_t i = 0; i < messages; i++)
+        {
+            logger->info("Hello message #{}", i);
+        }
+
+        auto stats = tp->stats();
+        REQUIRE(stats.discarded > 0);
+        REQUIRE(stats.dropped == 0);
+        REQUIRE(stats.enqueued + stats.discarded == messages);
+        REQUIRE(logger->stats().discarded == stats.discarded);
+
+        // the number of discarded messages is logged once the queue drained
+        auto summary = fmt::format("{} messages dropped from logger discard", stats.discarded);
+        while (test_sink->msg_counter() < stats.enqueued + 1)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        auto lines = test_sink->lines();
+        REQUIRE(lines.size() == stats.enqueued + 1);
+        REQUIRE(lines.front() == "Hello message #0");
+        REQUIRE(lines.back() == summary);
+    }
+}
+
+TEST_CASE("block for policy", "[async]")
+{
+    using spdlog::details::async_queue_backend;
+    for (auto backend : {async_queue_backend::blocking, async_queue_backend::lock_free, async_queue_backend::per_thread_lanes,
+             async_queue_backend::arena})
+    {
+        size_t messages = 10;
+        spdlog::details::thread_pool_options options;
+        options.queue_backend = backend;
+        options.collect_stats = true;
+        auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+        test_sink->set_delay(std::chrono::milliseconds(50));
+        auto tp = std::make_shared<spdlog::details::thread_pool>(2, 1, options);
+        auto logger = std::make_shared<spdlog::async_logger>("block_for", test_sink, tp, spdlog::async_overflow_policy::block_for);
+        logger->set_block_timeout(std::chrono::milliseconds(1));
+
+        // the callers wait up to the timeout only, and not for the slow sink
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < messages; i++)
+        {
+            logger->info("Hello message #{}", i);
+        }
+        REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(50 * messages / 2));
+
+        auto stats = tp->stats();
+        REQUIRE(stats.timeouts > 0);
+        REQUIRE(stats.discarded == stats.timeouts);
+        REQUIRE(stats.blocked >= stats.timeouts);
+        REQUIRE(stats.enqueued + stats.discarded == messages);
+        REQUIRE(logger->stats().timeouts == stats.timeouts);
+    }
+
+    // long enough timeout - nothing is discarded
+    {
+        size_t messages = 10;
+        spdlog::details::thread_pool_options options;
+        options.collect_stats = true;
+        auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+        test_sink->set_delay(std::chrono::milliseconds(2));
+        auto tp = std::make_shared<spdlog::details::thread_pool>(2, 1, options);
+        auto logger = std::make_shared<spdlog::async_logger>("block_for", test_sink, tp, spdlog::async_overflow_policy::block_for);
+        logger->set_block_timeout(std::chrono::seconds(10));
+        for (size_t i = 0; i < messages; i++)
+        {
+            logger->info("Hello message #{}", i);
+        }
+        auto stats = tp->stats();
+        REQUIRE(stats.blocked > 0);
+        REQUIRE(stats.timeouts == 0);
+        REQUIRE(stats.discarded == 0);
+        REQUIRE(stats.enqueued == messages);
+    }
+}
+
+#ifndef _WIN32
+TEST_CASE("spill policy", "[async]")
+{
+    using spdlog::details::async_queue_backend;
+    prepare_logdir();
+    for (auto backend : {async_queue_backend::blocking, async_queue_backend::lock_free, async_queue_backend::arena})
+    {
+        size_t messages = 50;
+        spdlog::filename_t spill_file = SPDLOG_FILENAME_T("test_logs/spill");
+        spdlog::details::thread_pool_options options;
+        options.queue_backend = backend;
+        options.collect_stats = true;
+        options.spill_file = spill_file;
+        options.spill_size = 64 * 1024;
+        auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+        test_sink->set_pattern("%v");
+        test_sink->set_delay(std::chrono::milliseconds(1));
+        auto tp = std::make_shared<spdlog::details::thread_pool>(4, 1, options);
+        REQUIRE(spdlog::details::os::path_exists(spill_file));
+        auto logger = std::make_shared<spdlog::async_logger>("spill", test_sink, tp, spdlog::async_overflow_policy::spill);
+        for (size_t i = 0; i < messages; i++)
+        {
+            logger->info("Hello message #{}", i);
+        }
+        auto stats = tp->stats();
+        REQUIRE(stats.spilled > 0);
+        REQUIRE(stats.blocked == 0);
+        REQUIRE(stats.enqueued == messages);
+
+        // nothing lost, in order, the flush request after the spilled messages
+        logger->flush_async().get();
+        auto lines = test_sink->lines();
+        REQUIRE(lines.size() == messages);
+        for (size_t i = 0; i < messages; i++)
+        {
+            REQUIRE(lines[i] == fmt::format("Hello message #{}", i));
+        }
+        REQUIRE(tp->queue_size() == 0);
+
+        // back to the queue once replayed
+        auto spilled = tp->stats().spilled;
+        logger->info("after");
+        logger->flush_async().get();
+        REQUIRE(test_sink->lines().back() == "after");
+        REQUIRE(tp->stats().spilled == spilled);
+
+        tp.reset();
+        logger.reset();
+        REQUIRE_FALSE(spdlog::details::os::path_exists(spill_file));
+    }
+}
+#endif
+
+TEST_CASE("ordered workers", "[async]")
+{
+    using spdlog::details::async_queue_backend;
+    prepare_logdir();
+    for (auto backend : {async_queue_backend::blocking, async_queue_backend::arena})
+    {
+        size_t messages = 1000;
+        spdlog::filename_t filename = SPDLOG_FILENAME_T(TEST_FILENAME);
+        auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+        test_sink->set_pattern("%v");
+        auto file_sink = std::make_shared<spdlog::sinks::basic_file_sink_mt>(filename, true);
+        file_sink->set_pattern("%v");
+        file_sink->set_parallel_format(true);
+        {
+            spdlog::details::thread_pool_options options;
+            options.queue_backend = backend;
+            options.batch_size = 4;
+            options.ordered_workers = true;
+            auto tp = std::make_shared<spdlog::details::thread_pool>(messages, 4, options);
+            auto logger = std::make_shared<spdlog::async_logger>("ordered", spdlog::sinks_init_list{test_sink, file_sink}, tp);
+            logger->set_deferred_formatting(true);
+            for (size_t i = 0; i < messages; i++)
+            {
+                logger->info("Hello message #{}", i);
+            }
+            logger->flush_async().get();
+            // the barrier passed in turn
+            tp->wait_processed();
+        }
+
+        // test_sink keeps the first 100 lines
+        auto lines = test_sink->lines();
+        REQUIRE(lines.size() == 100);
+        for (size_t i = 0; i < lines.size(); i++)
+        {
+            REQUIRE(lines[i] == fmt::format("Hello message #{}", i));
+        }
+        using spdlog::details::os::default_eol;
+        auto contents = file_contents(TEST_FILENAME);
+        std::string expected;
+        for (size_t i = 0; i < messages; i++)
+        {
+            expected += fmt::format("Hello message #{}{}", i, default_eol);
+        }
+        REQUIRE(contents == expected);
+    }
+}
+
+TEST_CASE("priority queue", "[async]")
+{
+    using spdlog::details::async_queue_backend;
+    for (auto backend : {async_queue_backend::blocking, async_queue_backend::arena})
+    {
+        // the error overtakes the backlog, and is written and flushed when error() returns
+        spdlog::details::thread_pool_options options;
+        options.queue_backend = backend;
+        options.priority_level = spdlog::level::err;
+        options.priority_flush = true;
+        auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+        test_sink->set_pattern("%v");
+        test_sink->set_delay(std::chrono::milliseconds(2));
+        auto tp = std::make_shared<spdlog::details::thread_pool>(64, 1, options);
+        auto logger = std::make_shared<spdlog::async_logger>("priority", test_sink, tp);
+        for (int i = 0; i < 20; i++)
+        {
+            logger->info("Hello message #{}", i);
+        }
+        logger->error("Error message #{}", 0);
+        auto lines = test_sink->lines();
+        REQUIRE(test_sink->flush_counter() == 1);
+        REQUIRE(std::find(lines.begin(), lines.end(), "Error message #0") != lines.end());
+        REQUIRE(lines.size() < 21);
+        logger->flush();
+        while (test_sink->flush_counter() < 2)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        REQUIRE(test_sink->msg_counter() == 21);
+        REQUIRE(test_sink->lines().back() == "Hello message #19");
+    }
+
+    // the regular messages overrun each other, the priority ones block
+    {
+        spdlog::details::thread_pool_options options;
+        options.priority_level = spdlog::level::err;
+        options.priority_q_max_items = 2;
+        auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+        test_sink->set_pattern("%v");
+        test_sink->set_delay(std::chrono::milliseconds(1));
+        {
+            auto tp = std::make_shared<spdlog::details::thread_pool>(4, 1, options);
+            auto logger = std::make_shared<spdlog::async_logger>("priority", test_sink, tp, spdlog::async_overflow_policy::overrun_oldest);
+            for (int i = 0; i < 90; i++)
+            {
+                logger->info("Hello message #{}", i);
+                if (i % 9 == 0)
+                {
+                    logger->error("Error message #{}", i / 9);
+                }
+            }
+            REQUIRE(tp->overrun_counter() > 0);
+        }
+        auto lines = test_sink->lines();
+        REQUIRE(test_sink->msg_counter() < 100);
+        REQUIRE(std::count_if(lines.begin(), lines.end(), [](const std::string &line) { return line.find("Error") == 0; }) == 10);
+    }
+}
+
+TEST_CASE("structured logging - async", "[async]")
+{
+    using spdlog::details::async_queue_backend;
+    for (auto backend : {async_queue_backend::blocking, async_queue_backend::lock_free, async_queue_backend::arena})
+    {
+        auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+        test_sink->set_pattern("%v|%k");
+        {
+            spdlog::details::thread_pool_options options;
+            options.queue_backend = backend;
+            auto tp = std::make_shared<spdlog::details::thread_pool>(128, 1, options);
+            auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp);
+            for (int i = 0; i < 10; i++)
+            {
+                // the strings are gone by the time the worker formats the message
+                std::string key = "key" + std::to_string(i);
+                std::string value = "value" + std::to_string(i);
+                logger->info("fields", spdlog::kv(key, value), spdlog::kv("i", i), spdlog::kv("d", 0.5));
+            }
+            logger->flush();
+        }
+        auto lines = test_sink->lines();
+        REQUIRE(lines.size() == 10);
+        for (int i = 0; i < 10; i++)
+        {
+            REQUIRE(lines[i] == fmt::format("fields|key{0}=value{0} i={0} d=0.5", i));
+        }
+    }
+}
+
+#ifndef _WIN32
+// wait up to a few seconds for the sink to count n messages
+static bool wait_for_messages(spdlog::sinks::test_sink_mt &sink, size_t n)
+{
+    for (int i = 0; i < 500 && sink.msg_counter() < n; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return sink.msg_counter() == n;
+}
+
+TEST_CASE("fork safe thread pool", "[async]")
+{
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    spdlog::details::thread_pool_options options;
+    options.fork_safe = true;
+    auto tp = std::make_shared<spdlog::details::thread_pool>(128, 2, options);
+    auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp, spdlog::async_overflow_policy::block);
+    for (int i = 0; i < 10; i++)
+    {
+        logger->info("before fork #{}", i);
+    }
+    auto parent_tid = spdlog::details::os::thread_id();
+
+    auto pid = ::fork();
+    REQUIRE(pid >= 0);
+    if (pid == 0)
+    {
+        // the messages queued before the fork were processed by the parent's workers
+        int rc = test_sink->msg_counter() == 10 ? 0 : 1;
+        if (rc == 0 && spdlog::details::os::thread_id() == parent_tid)
+        {
+            rc = 2;
+        }
+        if (rc == 0 && spdlog::details::os::cached_pid() != static_cast<int>(::getpid()))
+        {
+            rc = 4;
+        }
+        for (int i = 0; rc == 0 && i < 10; i++)
+        {
+            logger->info("child #{}", i);
+        }
+        if (rc == 0 && !wait_for_messages(*test_sink, 20))
+        {
+            rc = 3;
+        }
+        ::_exit(rc);
+    }
+
+    int status = 0;
+    REQUIRE(::waitpid(pid, &status, 0) == pid);
+    REQUIRE(WIFEXITED(status));
+    REQUIRE(WEXITSTATUS(status) == 0);
+    REQUIRE(spdlog::details::os::thread_id() == parent_tid);
+
+    for (int i = 0; i < 10; i++)
+    {
+        logger->info("parent #{}", i);
+    }
+    REQUIRE(wait_for_messages(*test_sink, 20));
+}
+
+// forks a child exiting at once for each message, from the worker of the pool
+class forking_sink : public spdlog::sinks::base_sink<std::mutex>
+{
+public:
+    std::atomic<int> children_ok{0};
+
+protected:
+    void sink_it_(const spdlog::details::log_msg &) override
+    {
+        auto pid = ::fork();
+        if (pid == 0)
+        {
+            ::_exit(0);
+        }
+        int status = 0;
+        if (pid > 0 && ::waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0)
+        {
+            children_ok++;
+        }
+    }
+    void flush_() override {}
+};
+
+TEST_CASE("fork from a pool worker", "[async]")
+{
+    spdlog::details::thread_pool_options options;
+    options.fork_safe = true;
+    auto forking = std::make_shared<forking_sink>();
+    auto tp = std::make_shared<spdlog::details::thread_pool>(128, 2, options);
+    auto logger = std::make_shared<spdlog::async_logger>("forking", forking, tp, spdlog::async_overflow_policy::block);
+    // the other pools are stopped and restarted as for any fork
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    auto other_tp = std::make_shared<spdlog::details::thread_pool>(128, 1, options);
+    auto other = std::make_shared<spdlog::async_logger>("other", test_sink, other_tp, spdlog::async_overflow_policy::block);
+    for (int i = 0; i < 5; i++)
+    {
+        logger->info("fork #{}", i);
+        other->info("other #{}", i);
+    }
+    for (int i = 0; i < 500 && forking->children_ok < 5; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    REQUIRE(forking->children_ok == 5);
+    REQUIRE(wait_for_messages(*test_sink, 5));
+    other->info("after");
+    REQUIRE(wait_for_messages(*test_sink, 6));
+}
+#endif
+
+#ifndef _WIN32
+TEST_CASE("crash dump", "[async]")
+{
+    prepare_logdir();
+    const char *filename = "test_logs/crash_dump.txt";
+    spdlog::details::os::create_dir(SPDLOG_FILENAME_T("test_logs"));
+
+    // the worker is stuck in the sink while the next messages wait in the queue
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    test_sink->set_delay(std::chrono::milliseconds(200));
+    spdlog::details::thread_pool_options options;
+    options.queue_backend = spdlog::details::async_queue_backend::lock_free;
+    auto tp = std::make_shared<spdlog::details::thread_pool>(16, 1, options);
+    auto logger = std::make_shared<spdlog::async_logger>("crash", test_sink, tp, spdlog::async_overflow_policy::block);
+    auto tracer = std::make_shared<spdlog::logger>("tracer", std::make_shared<spdlog::sinks::test_sink_mt>());
+    tracer->enable_backtrace(4);
+    tracer->debug("traced #1");
+    tracer->debug("traced #2");
+    logger->info("first");
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    logger->info("queued #1");
+    logger->warn("queued #2");
+
+    auto fd = ::open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    REQUIRE(fd >= 0);
+    spdlog::write_crash_dump(fd);
+    ::close(fd);
+    auto dump = file_contents(filename);
+    REQUIRE(dump.find("spdlog crash dump\n") == 0);
+    REQUIRE(dump.find("[crash] [info] queued #1\n") != std::string::npos);
+    REQUIRE(dump.find("[crash] [warning] queued #2\n") != std::string::npos);
+    REQUIRE(dump.find("first") == std::string::npos);
+    REQUIRE(dump.find("[tracer] [debug] traced #1\n") != std::string::npos);
+    REQUIRE(dump.find("[tracer] [debug] traced #2\n") != std::string::npos);
+
+    // on a crash: dumped by the handler, then the signal's default action
+    logger->info("queued #3");
+    auto pid = ::fork();
+    REQUIRE(pid >= 0);
+    if (pid == 0)
+    {
+        auto child_fd = ::open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        spdlog::enable_crash_dump(child_fd);
+        std::abort();
+    }
+    int status = 0;
+    REQUIRE(::waitpid(pid, &status, 0) == pid);
+    REQUIRE(WIFSIGNALED(status));
+    REQUIRE(WTERMSIG(status) == SIGABRT);
+    dump = file_contents(filename);
+    REQUIRE(dump.find("[crash] [info] queued #3\n") != std::string::npos);
+    REQUIRE(dump.find("[tracer] [debug] traced #2\n") != std::string::npos);
+}
+#endif
+
+TEST_CASE("numa shards", "[async]")
+{
+    size_t nodes = 0;
+    for (auto node : spdlog::details::os::numa_nodes())
+    {
+        nodes += spdlog::details::os::numa_node_cpus(node).empty() ? 0 : 1;
+    }
+#ifdef __linux__
+    REQUIRE(spdlog::details::os::current_cpu() >= 0);
+#endif
+    size_t expected_shards = nodes >= 2 ? nodes : 1;
+
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    {
+        spdlog::details::thread_pool_options options;
+        options.numa_shards = true;
+        auto tp = std::make_shared<spdlog::details::thread_pool>(64, expected_shards * 2, options);
+        REQUIRE(tp->shards() == expected_shards);
+        auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp, spdlog::async_overflow_policy::block);
+        REQUIRE(tp->shard_of(*logger) < expected_shards);
+        for (int i = 0; i < 100; i++)
+        {
+            logger->info("Hello message #{}", i);
+        }
+        logger->flush();
+    }
+    REQUIRE(test_sink->msg_counter() == 100);
+    // a flush per shard
+    REQUIRE(test_sink->flush_counter() == expected_shards);
+}
+
+TEST_CASE("openmetrics export", "[async]")
+{
+    spdlog::drop_all();
+    spdlog::details::thread_pool_options options;
+    options.collect_stats = true;
+    spdlog::init_thread_pool(128, 1, options);
+    auto logger = spdlog::create_async<spdlog::sinks::test_sink_mt>("om \"async\"");
+    for (int i = 0; i < 3; i++)
+    {
+        logger->info("Hello message #{}", i);
+    }
+    logger->flush();
+
+    auto text = spdlog::openmetrics_text();
+    REQUIRE(text.find("# TYPE spdlog_async_logger_enqueued counter\n") != std::string::npos);
+    // the messages and the flush
+    REQUIRE(text.find("spdlog_async_logger_enqueued_total{logger=\"om \\\"async\\\"\"} 4\n") != std::string::npos);
+    REQUIRE(text.find("spdlog_async_logger_discarded_total{logger=\"om \\\"async\\\"\"} 0\n") != std::string::npos);
+    REQUIRE(text.find("# TYPE spdlog_sink_bytes counter\n") != std::string::npos);
+    REQUIRE(text.find("spdlog_sink_bytes_total{logger=\"om \\\"async\\\"\",sink=\"0\"} ") != std::string::npos);
+    REQUIRE(text.find("# TYPE spdlog_thread_pool_queue_depth gauge\n") != std::string::npos);
+    REQUIRE(text.find("spdlog_thread_pool_enqueued_total 4\n") != std::string::npos);
+    REQUIRE(text.find("spdlog_thread_pool_dropped_total 0\n") != std::string::npos);
+    REQUIRE(text.size() >= 6);
+    REQUIRE(text.substr(text.size() - 6) == "# EOF\n");
+
+    spdlog::drop_all();
+    logger.reset();
+    spdlog::init_thread_pool(spdlog::details::default_async_q_size, 1);
+}
+
+class drop_odd_processor : public spdlog::processor
+{
+public:
+    size_t process(spdlog::details::log_msg *msgs, size_t n_msgs) override
+    {
+        thread_id = std::this_thread::get_id();
+        auto end = std::remove_if(msgs, msgs + n_msgs, [](const spdlog::details::log_msg &msg) {
+            return (msg.payload.data()[msg.payload.size() - 1] - '0') % 2 == 1;
+        });
+        return static_cast<size_t>(end - msgs);
+    }
+
+    unsigned required_fields() const override
+    {
+        return spdlog::details::msg_fields::none;
+    }
+
+    std::thread::id thread_id;
+};
+
+class tag_processor : public spdlog::processor
+{
+public:
+    size_t process(spdlog::details::log_msg *msgs, size_t n_msgs) override
+    {
+        // valid until the next call
+        payloads_.clear();
+        for (size_t i = 0; i < n_msgs; i++)
+        {
+            payloads_.emplace_back("[tagged] " + std::string(msgs[i].payload.data(), msgs[i].payload.size()));
+            msgs[i].payload = payloads_.back();
+            msgs[i].payload_id = 0;
+        }
+        return n_msgs;
+    }
+
+private:
+    std::deque<std::string> payloads_;
+};
+
+TEST_CASE("processors", "[async]")
+{
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    test_sink->set_pattern("%v");
+    auto drop_odd = std::make_shared<drop_odd_processor>();
+    {
+        auto tp = std::make_shared<spdlog::details::thread_pool>(128, 1);
+        auto logger = std::make_shared<spdlog::async_logger>("processors", test_sink, tp);
+        logger->set_processors({drop_odd, std::make_shared<tag_processor>()});
+        for (int i = 0; i < 10; i++)
+        {
+            logger->info("msg {}", i);
+        }
+        logger->flush();
+    }
+    REQUIRE(test_sink->lines() ==
+            std::vector<std::string>{"[tagged] msg 0", "[tagged] msg 2", "[tagged] msg 4", "[tagged] msg 6", "[tagged] msg 8"});
+    REQUIRE(drop_odd->thread_id != std::this_thread::get_id());
+}
+
+class throwing_processor : public spdlog::processor
+{
+public:
+    size_t process(spdlog::details::log_msg *, size_t) override
+    {
+        throw std::runtime_error("processor failed");
+    }
+};
+
+TEST_CASE("processors errors", "[async]")
+{
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    std::atomic<int> errors{0};
+    {
+        auto tp = std::make_shared<spdlog::details::thread_pool>(128, 1);
+        auto logger = std::make_shared<spdlog::async_logger>("processors", test_sink, tp);
+        logger->set_error_handler([&](const std::string &msg) {
+            if (msg == "processor failed")
+            {
+                errors++;
+            }
+        });
+        logger->set_processors({std::make_shared<throwing_processor>()});
+        logger->info("dropped");
+        logger->flush();
+    }
+    REQUIRE(test_sink->msg_counter() == 0);
+    REQUIRE(errors > 0);
+}
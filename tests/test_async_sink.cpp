@@ -0,0 +1,99 @@
+#include "includes.h"
+#include "spdlog/sinks/async_sink.h"
+#include "test_sink.h"
+
+using spdlog::sinks::async_sink;
+using spdlog::sinks::test_sink_mt;
+
+TEST_CASE("async_sink", "[async_sink]")
+{
+    auto slow_sink = std::make_shared<test_sink_mt>();
+    slow_sink->set_delay(std::chrono::milliseconds(5));
+    auto fast_sink = std::make_shared<test_sink_mt>();
+    size_t messages = 20;
+    {
+        auto decorated = std::make_shared<async_sink>(slow_sink);
+        spdlog::logger logger("async_sink", {fast_sink, decorated});
+        logger.set_pattern("%v");
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < messages; i++)
+        {
+            logger.info("Hello message #{}", i);
+        }
+        logger.flush();
+        // the fast sink doesn't wait for the slow one
+        REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(5) * messages);
+        REQUIRE(fast_sink->msg_counter() == messages);
+    }
+    REQUIRE(slow_sink->msg_counter() == messages);
+    REQUIRE(slow_sink->flush_counter() == 1);
+    REQUIRE(slow_sink->lines().back() == "Hello message #19");
+}
+
+TEST_CASE("async_sink overflow policies", "[async_sink]")
+{
+    auto slow_sink = std::make_shared<test_sink_mt>();
+    slow_sink->set_delay(std::chrono::milliseconds(1));
+    slow_sink->set_level(spdlog::level::info);
+    size_t messages = 50;
+    size_t discarded = 0;
+    {
+        auto decorated = std::make_shared<async_sink>(slow_sink, 4, spdlog::async_overflow_policy::discard_new);
+        spdlog::logger logger("async_sink", decorated);
+        logger.set_level(spdlog::level::trace);
+        for (size_t i = 0; i < messages; i++)
+        {
+            logger.info("Hello message #{}", i);
+            // below the level of the wrapped sink: not queued
+            logger.debug("Debug message #{}", i);
+        }
+        discarded = decorated->discarded_counter();
+    }
+    REQUIRE(discarded > 0);
+    REQUIRE(slow_sink->msg_counter() + discarded == messages);
+
+    slow_sink = std::make_shared<test_sink_mt>();
+    slow_sink->set_delay(std::chrono::milliseconds(1));
+    size_t overrun = 0;
+    {
+        auto decorated = std::make_shared<async_sink>(slow_sink, 4, spdlog::async_overflow_policy::overrun_oldest);
+        spdlog::logger logger("async_sink", decorated);
+        for (size_t i = 0; i < messages; i++)
+        {
+            logger.info("Hello message #{}", i);
+        }
+        overrun = decorated->overrun_counter();
+    }
+    REQUIRE(overrun > 0);
+    REQUIRE(slow_sink->msg_counter() + overrun == messages);
+}
+
+#ifndef SPDLOG_NO_EXCEPTIONS
+namespace {
+class failing_sink : public spdlog::sinks::base_sink<std::mutex>
+{
+protected:
+    void sink_it_(const spdlog::details::log_msg &) override
+    {
+        throw std::runtime_error("sink failure");
+    }
+    void flush_() override {}
+};
+} // namespace
+
+TEST_CASE("async_sink errors", "[async_sink]")
+{
+    auto decorated = std::make_shared<async_sink>(std::make_shared<failing_sink>());
+    spdlog::logger logger("async_sink", decorated);
+    std::string error;
+    logger.set_error_handler([&error](const std::string &msg) { error = msg; });
+    logger.info("Hello");
+    // reported by a later call, once the worker failed
+    for (int i = 0; i < 1000 && error.empty(); i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        logger.flush();
+    }
+    REQUIRE(error == "sink failure");
+}
+#endif
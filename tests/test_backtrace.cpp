@@ -63,3 +63,161 @@ TEST_CASE("bactrace-async", "[bactrace]")
     REQUIRE(test_sink->lines()[6] == "debug message 99");
     REQUIRE(test_sink->lines()[7] == "****************** Backtrace End ********************");
 }
+
+TEST_CASE("bactrace-multi-threaded", "[bactrace]")
+{
+    using spdlog::sinks::test_sink_mt;
+    auto test_sink = std::make_shared<test_sink_mt>();
+    size_t backtrace_size = 32;
+
+    spdlog::logger logger("test-backtrace-mt", test_sink);
+    logger.set_pattern("%v");
+    logger.enable_backtrace(backtrace_size);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++)
+    {
+        threads.emplace_back([&logger, t] {
+            for (int i = 0; i < 1000; i++)
+            {
+                logger.debug("thread {} message {}", t, i);
+            }
+        });
+    }
+    // dumps while logging keep the ring consistent
+    logger.dump_backtrace();
+    for (auto &t : threads)
+    {
+        t.join();
+    }
+    auto n_lines = test_sink->lines().size();
+    logger.dump_backtrace();
+    REQUIRE(test_sink->lines().size() == n_lines + backtrace_size + 2);
+
+    // re-enabling drops the messages
+    logger.debug("before enable");
+    logger.enable_backtrace(backtrace_size);
+    logger.debug("after enable");
+    n_lines = test_sink->lines().size();
+    logger.dump_backtrace();
+    REQUIRE(test_sink->lines().size() == n_lines + 3);
+    REQUIRE(test_sink->lines()[n_lines + 1] == "after enable");
+
+    // a copy keeps the messages
+    logger.debug("copied");
+    spdlog::logger copy(logger);
+    n_lines = test_sink->lines().size();
+    copy.dump_backtrace();
+    REQUIRE(test_sink->lines().size() == n_lines + 3);
+    REQUIRE(test_sink->lines()[n_lines + 1] == "copied");
+}
+
+TEST_CASE("bactrace-lazy-format", "[bactrace]")
+{
+    using spdlog::sinks::test_sink_st;
+    auto test_sink = std::make_shared<test_sink_st>();
+
+    spdlog::logger logger("test-backtrace", test_sink);
+    logger.set_pattern("%v");
+    logger.enable_backtrace(4);
+
+    {
+        // the format string of a message stored unformatted is copied
+        std::string fmt_str = "runtime {} {:.1f} {}";
+        logger.debug(SPDLOG_FMT_RUNTIME(fmt_str), 1, 2.5, 'c');
+        fmt_str.assign(fmt_str.size(), 'x');
+    }
+    logger.debug("int {}", 42);
+    logger.debug("string {}", std::string("arg")); // not eligible, formatted now
+    logger.info("info {}", 7);
+
+    logger.dump_backtrace();
+    REQUIRE(test_sink->lines().size() == 7);
+    REQUIRE(test_sink->lines()[2] == "runtime 1 2.5 c");
+    REQUIRE(test_sink->lines()[3] == "int 42");
+    REQUIRE(test_sink->lines()[4] == "string arg");
+    REQUIRE(test_sink->lines()[5] == "info 7");
+}
+
+TEST_CASE("bactrace-per-thread", "[bactrace]")
+{
+    using spdlog::sinks::test_sink_mt;
+    auto test_sink = std::make_shared<test_sink_mt>();
+
+    spdlog::logger logger("test-backtrace", test_sink);
+    logger.set_pattern("%v");
+    logger.enable_backtrace(2, true);
+
+    // the noisy thread doesn't evict the messages of the quiet one
+    logger.debug("quiet 1");
+    std::thread noisy([&logger] {
+        for (int i = 0; i < 100; i++)
+            logger.debug("noisy {}", i);
+    });
+    noisy.join();
+    logger.debug("quiet 2");
+
+    logger.dump_backtrace();
+    REQUIRE(test_sink->lines().size() == 6);
+    REQUIRE(test_sink->lines()[1] == "quiet 1");
+    REQUIRE(test_sink->lines()[2] == "noisy 98");
+    REQUIRE(test_sink->lines()[3] == "noisy 99");
+    REQUIRE(test_sink->lines()[4] == "quiet 2");
+
+    // only the messages of the calling thread
+    logger.debug("quiet 3");
+    std::thread([&logger] { logger.debug("noisy 100"); }).join();
+    logger.dump_thread_backtrace();
+    REQUIRE(test_sink->lines().size() == 9);
+    REQUIRE(test_sink->lines()[7] == "quiet 3");
+    logger.dump_backtrace();
+    REQUIRE(test_sink->lines().size() == 12);
+    REQUIRE(test_sink->lines()[10] == "noisy 100");
+}
+
+TEST_CASE("bactrace-thread-only", "[bactrace]")
+{
+    using spdlog::sinks::test_sink_mt;
+    auto test_sink = std::make_shared<test_sink_mt>();
+
+    spdlog::logger logger("test-backtrace", test_sink);
+    logger.set_pattern("%v");
+    logger.enable_backtrace(4);
+
+    logger.debug("mine 1");
+    std::thread([&logger] { logger.debug("other"); }).join();
+    logger.debug("mine 2");
+
+    logger.dump_thread_backtrace();
+    REQUIRE(test_sink->lines().size() == 4);
+    REQUIRE(test_sink->lines()[1] == "mine 1");
+    REQUIRE(test_sink->lines()[2] == "mine 2");
+    logger.dump_backtrace();
+    REQUIRE(test_sink->lines().size() == 7);
+    REQUIRE(test_sink->lines()[5] == "other");
+}
+
+#ifndef SPDLOG_NO_TLS
+TEST_CASE("bactrace-per-thread-exited", "[bactrace]")
+{
+    using spdlog::sinks::test_sink_mt;
+    auto test_sink = std::make_shared<test_sink_mt>();
+
+    spdlog::logger logger("test-backtrace", test_sink);
+    logger.set_pattern("%v");
+    logger.enable_backtrace(4, true);
+
+    // the rings of the exited threads are reclaimed by the next one, keeping their last messages
+    logger.debug("main");
+    for (int i = 0; i < 10; i++)
+    {
+        std::thread([&logger, i] { logger.debug("exited {}", i); }).join();
+    }
+
+    logger.dump_backtrace();
+    REQUIRE(test_sink->lines().size() == 8);
+    REQUIRE(test_sink->lines()[1] == "main");
+    REQUIRE(test_sink->lines()[2] == "exited 5");
+    REQUIRE(test_sink->lines()[6] == "exited 9");
+}
+#endif
@@ -0,0 +1,145 @@
+#include "includes.h"
+#include "test_sink.h"
+
+// a single opt-in call site
+static const int opt_in_line = __LINE__ + 4;
+
+static void log_opt_in(const std::shared_ptr<spdlog::logger> &logger, int &evaluated)
+{
+    SPDLOG_LOGGER_CALL_OPT_IN(logger, spdlog::level::debug, "Test message {}", ++evaluated);
+}
+
+TEST_CASE("opt-in call site", "[call_sites]")
+{
+    auto sink = std::make_shared<spdlog::sinks::test_sink_st>();
+    auto logger = std::make_shared<spdlog::logger>("opt-in", sink);
+    logger->set_level(spdlog::level::trace);
+    int evaluated = 0;
+    log_opt_in(logger, evaluated);
+    REQUIRE(evaluated == 0);
+
+    // other lines of the file
+    spdlog::set_call_site_enabled("test_call_sites.cpp", __LINE__, true);
+    log_opt_in(logger, evaluated);
+    REQUIRE(evaluated == 0);
+
+    spdlog::set_call_site_enabled("test_call_sites.cpp", opt_in_line, true);
+    log_opt_in(logger, evaluated);
+    REQUIRE(evaluated == 1);
+
+    // enabled, and still subject to the logger's level
+    logger->set_level(spdlog::level::info);
+    log_opt_in(logger, evaluated);
+    REQUIRE(evaluated == 1);
+    logger->set_level(spdlog::level::trace);
+
+    spdlog::set_call_site_enabled("test_call_sites.cpp", 0, false);
+    log_opt_in(logger, evaluated);
+    REQUIRE(evaluated == 1);
+    REQUIRE(sink->msg_counter() == 1);
+}
+
+TEST_CASE("opt-in call site by logger", "[call_sites]")
+{
+    auto sink = std::make_shared<spdlog::sinks::test_sink_st>();
+    auto logger = std::make_shared<spdlog::logger>("opt-in-enabled", sink);
+    auto other = std::make_shared<spdlog::logger>("opt-in-other", sink);
+    logger->set_level(spdlog::level::trace);
+    other->set_level(spdlog::level::trace);
+    spdlog::set_call_site_enabled("test_call_sites.cpp", 0, false);
+    spdlog::set_logger_call_sites_enabled("opt-in-enabled", true);
+    int evaluated = 0;
+    log_opt_in(logger, evaluated);
+    log_opt_in(other, evaluated);
+    REQUIRE(evaluated == 1);
+    REQUIRE(sink->msg_counter() == 1);
+
+    // the last matching rule wins
+    spdlog::set_call_site_enabled("test_call_sites.cpp", opt_in_line, false);
+    log_opt_in(logger, evaluated);
+    REQUIRE(evaluated == 1);
+    spdlog::set_call_site_enabled("test_call_sites.cpp", opt_in_line, true);
+    log_opt_in(other, evaluated);
+    REQUIRE(evaluated == 2);
+
+    spdlog::set_logger_call_sites_enabled("opt-in-other", false);
+    log_opt_in(other, evaluated);
+    log_opt_in(logger, evaluated);
+    REQUIRE(evaluated == 3);
+    REQUIRE(sink->msg_counter() == 3);
+}
+
+static void log_debug(const std::shared_ptr<spdlog::logger> &logger)
+{
+    SPDLOG_LOGGER_CALL(logger, spdlog::level::debug, "Test message");
+}
+
+TEST_CASE("call site sink level", "[call_sites]")
+{
+    spdlog::set_call_site_enabled("test_call_sites.cpp", 0, true);
+    auto sink = std::make_shared<spdlog::sinks::test_sink_st>();
+    sink->set_level(spdlog::level::warn);
+    auto logger = std::make_shared<spdlog::logger>("sink-level", sink);
+    logger->set_level(spdlog::level::trace);
+    log_debug(logger);
+    REQUIRE(sink->msg_counter() == 0);
+
+    // the call site cached that the logger's sinks drop debug messages
+    sink->set_level(spdlog::level::trace);
+    log_debug(logger);
+    REQUIRE(sink->msg_counter() == 1);
+}
+
+#ifdef SPDLOG_CALL_SITE_STATS
+static const int volume_line = __LINE__ + 5;
+static void log_volume(spdlog::logger *logger, int n)
+{
+    for (int i = 0; i < n; i++)
+    {
+        SPDLOG_LOGGER_INFO(logger, "message {:010}", i);
+    }
+    SPDLOG_LOGGER_INFO(logger, "short");
+}
+
+static spdlog::call_site_stats find_stats(const std::vector<spdlog::call_site_stats> &top, int line)
+{
+    for (auto &stats : top)
+    {
+        if (stats.line == line && std::strstr(stats.filename, "test_call_sites.cpp") != nullptr)
+        {
+            return stats;
+        }
+    }
+    return spdlog::call_site_stats{nullptr, line, 0, 0};
+}
+
+TEST_CASE("call site stats", "[call_sites]")
+{
+    spdlog::set_call_site_enabled("test_call_sites.cpp", 0, true);
+    auto sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    spdlog::logger logger("call-site-stats", sink);
+
+    // the counts of an exited thread are kept
+    std::thread thread([&logger] { log_volume(&logger, 10); });
+    thread.join();
+    log_volume(&logger, 10);
+
+    auto top = spdlog::top_call_sites(1000);
+    auto stats = find_stats(top, volume_line);
+    auto short_stats = find_stats(top, volume_line + 2);
+    REQUIRE(stats.messages == 20);
+    REQUIRE(short_stats.messages == 2);
+#    ifndef SPDLOG_NO_TLS
+    REQUIRE(stats.bytes == 20 * std::strlen("message 0000000000"));
+    REQUIRE(short_stats.bytes == 10);
+#    endif
+    REQUIRE(std::find_if(top.begin(), top.end(), [](const spdlog::call_site_stats &s) { return s.line == volume_line; }) <
+            std::find_if(top.begin(), top.end(), [](const spdlog::call_site_stats &s) { return s.line == volume_line + 2; }));
+
+    // the disabled calls don't count
+    logger.set_level(spdlog::level::warn);
+    log_volume(&logger, 10);
+    REQUIRE(find_stats(spdlog::top_call_sites(1000), volume_line).messages == 20);
+    REQUIRE(spdlog::top_call_sites(1).size() == 1);
+}
+#endif
@@ -4,6 +4,10 @@
 
 #include <spdlog/cfg/env.h>
 #include <spdlog/cfg/argv.h>
+#include <spdlog/cfg/file.h>
+
+#include <csignal>
+#include <thread>
 
 using spdlog::cfg::load_argv_levels;
 using spdlog::cfg::load_env_levels;
@@ -181,3 +185,116 @@ TEST_CASE("restore-to-default", "[cfg]")
     load_argv_levels(2, argv);
     REQUIRE(spdlog::default_logger()->level() == spdlog::level::info);
 }
+
+TEST_CASE("sample-rates", "[cfg]")
+{
+    spdlog::drop("l1");
+    spdlog::drop("l2");
+    const char *argv[] = {"ignore", "SPDLOG_LEVEL=info,l1=debug/100,l2=trace/x"};
+    load_argv_levels(2, argv);
+    auto l1 = spdlog::create<test_sink_st>("l1");
+    auto l2 = spdlog::create<test_sink_st>("l2");
+    REQUIRE(l1->level() == spdlog::level::debug);
+    REQUIRE(l1->sample_rate() == 100);
+    // invalid rates are ignored
+    REQUIRE(l2->level() == spdlog::level::trace);
+    REQUIRE(l2->sample_rate() == 1);
+
+    // applied to the existing loggers too
+    const char *argv2[] = {"ignore", "SPDLOG_LEVEL=debug/10"};
+    load_argv_levels(2, argv2);
+    REQUIRE(l1->sample_rate() == 10);
+    REQUIRE(l2->sample_rate() == 10);
+
+    const char *argv3[] = {"ignore", "SPDLOG_LEVEL=info"};
+    load_argv_levels(2, argv3);
+    REQUIRE(l1->sample_rate() == 1);
+    REQUIRE(spdlog::default_logger()->sample_rate() == 1);
+    spdlog::drop("l1");
+    spdlog::drop("l2");
+}
+
+TEST_CASE("inherited-levels", "[cfg]")
+{
+    auto net = spdlog::create<test_sink_st>("net");
+    auto http = spdlog::create<test_sink_st>("net.http");
+    auto client = spdlog::create<test_sink_st>("net.http.client");
+    auto network = spdlog::create<test_sink_st>("network");
+    const char *argv[] = {"ignore", "SPDLOG_LEVEL=info,net=debug/10,net.http.client=warn"};
+    load_argv_levels(2, argv);
+    REQUIRE(net->level() == spdlog::level::debug);
+    REQUIRE(http->level() == spdlog::level::debug);
+    REQUIRE(http->sample_rate() == 10);
+    REQUIRE(client->level() == spdlog::level::warn);
+    REQUIRE(network->level() == spdlog::level::info);
+    // and by the loggers created later
+    auto server = spdlog::create<test_sink_st>("net.http.server");
+    REQUIRE(server->level() == spdlog::level::debug);
+
+    // a subtree at once, but not the descendants with a level of their own
+    spdlog::set_level("net.http", spdlog::level::err);
+    REQUIRE(net->level() == spdlog::level::debug);
+    REQUIRE(http->level() == spdlog::level::err);
+    REQUIRE(server->level() == spdlog::level::err);
+    REQUIRE(client->level() == spdlog::level::warn);
+    REQUIRE(network->level() == spdlog::level::info);
+
+    const char *argv2[] = {"ignore", "SPDLOG_LEVEL=info"};
+    load_argv_levels(2, argv2);
+    REQUIRE(client->level() == spdlog::level::info);
+    spdlog::drop("net");
+    spdlog::drop("net.http");
+    spdlog::drop("net.http.client");
+    spdlog::drop("net.http.server");
+    spdlog::drop("network");
+}
+
+static void write_levels_file(const std::string &content)
+{
+    std::ofstream file("test_logs/levels.cfg", std::ios::binary | std::ios::trunc);
+    file << content;
+}
+
+// wait for the watcher to load the levels reloads times
+static bool wait_for_reloads(const spdlog::cfg::file_levels_watcher &watcher, size_t reloads)
+{
+    for (int i = 0; i < 500 && watcher.reloads() < reloads; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return watcher.reloads() >= reloads;
+}
+
+TEST_CASE("file-levels", "[cfg]")
+{
+    using spdlog::cfg::helpers::file_levels_string;
+    auto levels = file_levels_string("# levels\ninfo\r\n  net=debug  # the network\n\nnet.http=warn,db=err");
+    REQUIRE(levels == "info,net=debug,net.http=warn,db=err");
+    REQUIRE(file_levels_string("").empty());
+    REQUIRE_FALSE(spdlog::cfg::load_file_levels(SPDLOG_FILENAME_T("test_logs/no-such-file.cfg")));
+
+    prepare_logdir();
+    spdlog::details::os::create_dir(SPDLOG_FILENAME_T("test_logs"));
+    auto l1 = spdlog::create<test_sink_st>("file_l1");
+    write_levels_file("info\nfile_l1=debug\n");
+    REQUIRE(spdlog::cfg::load_file_levels(SPDLOG_FILENAME_T("test_logs/levels.cfg")));
+    REQUIRE(l1->level() == spdlog::level::debug);
+
+    spdlog::cfg::file_levels_watcher watcher(SPDLOG_FILENAME_T("test_logs/levels.cfg"), std::chrono::milliseconds(10), true);
+    REQUIRE(watcher.reloads() == 1);
+    write_levels_file("info\nfile_l1=warn # changed\n");
+    REQUIRE(wait_for_reloads(watcher, 2));
+    REQUIRE(l1->level() == spdlog::level::warn);
+
+    // unchanged: not reloaded, unless forced
+    watcher.reload();
+    REQUIRE(watcher.reloads() == 2);
+    watcher.reload(true);
+    REQUIRE(watcher.reloads() == 3);
+#ifndef _WIN32
+    ::raise(SIGHUP);
+    REQUIRE(wait_for_reloads(watcher, 4));
+#endif
+    spdlog::set_level(spdlog::level::info);
+    spdlog::drop("file_l1");
+}
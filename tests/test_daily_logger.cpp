@@ -2,6 +2,7 @@
  * This content is released under the MIT License as specified in https://raw.githubusercontent.com/gabime/spdlog/master/LICENSE
  */
 #include "includes.h"
+#include "spdlog/sinks/hourly_file_sink.h"
 
 using filename_memory_buf_t = fmt::basic_memory_buffer<spdlog::filename_t::value_type, 250>;
 
@@ -165,4 +166,177 @@ TEST_CASE("daily_logger rotate", "[daily_file_sink]")
     test_rotate(days_to_run, 10, 10);
     test_rotate(days_to_run, 11, 10);
     test_rotate(days_to_run, 20, 10);
-}
\ No newline at end of file
+}
+#ifdef SPDLOG_ZLIB
+TEST_CASE("daily_logger rotate compressed", "[daily_file_sink]")
+{
+    using spdlog::sinks::daily_file_sink_st;
+    prepare_logdir();
+    spdlog::filename_t basename = SPDLOG_FILENAME_T("test_logs/daily_rotate.txt");
+    {
+        daily_file_sink_st sink{basename, 2, 30, true, 3, 0, false, true};
+        for (int i = 0; i < 10; i++)
+        {
+            sink.log(create_msg(std::chrono::seconds{24 * 3600 * i}));
+        }
+    }
+    // the current file and the 2 previous ones, compressed
+    REQUIRE(count_files("test_logs") == 3);
+    auto last_filename = spdlog::sinks::daily_filename_calculator::calc_filename(
+        basename, spdlog::details::os::localtime(spdlog::log_clock::to_time_t(spdlog::log_clock::now() + std::chrono::hours(24 * 8))));
+    REQUIRE(spdlog::details::os::path_exists(spdlog::details::file_compression::compressed_filename(last_filename)));
+}
+#else
+TEST_CASE("daily_logger compression unsupported", "[daily_file_sink]")
+{
+    prepare_logdir();
+    spdlog::filename_t basename = SPDLOG_FILENAME_T("test_logs/daily_rotate.txt");
+    REQUIRE_THROWS_AS(spdlog::sinks::daily_file_sink_st(basename, 2, 30, true, 3, 0, false, true), spdlog::spdlog_ex);
+}
+#endif
+
+static void test_background_rotate(int days_to_run, uint16_t max_days, uint16_t expected_n_files)
+{
+    using spdlog::sinks::daily_file_sink_st;
+    prepare_logdir();
+    spdlog::filename_t basename = SPDLOG_FILENAME_T("test_logs/daily_rotate.txt");
+    {
+        daily_file_sink_st sink{basename, 2, 30, true, max_days, 0, false, false, true};
+        sink.set_pattern("%v");
+        for (int i = 0; i < days_to_run; i++)
+        {
+            sink.log(create_msg(std::chrono::seconds{24 * 3600 * i}));
+        }
+    }
+    // the file prepared for the next day was removed as unused
+    REQUIRE(count_files("test_logs") == static_cast<size_t>(expected_n_files));
+    auto last_time = spdlog::log_clock::to_time_t(spdlog::log_clock::now() + std::chrono::hours(24 * (days_to_run - 1)));
+    auto last_filename = spdlog::sinks::daily_filename_calculator::calc_filename(basename, spdlog::details::os::localtime(last_time));
+    using spdlog::details::os::default_eol;
+    REQUIRE(file_contents(spdlog::details::os::filename_to_str(last_filename)) == fmt::format("Hello Message{}", default_eol));
+}
+
+TEST_CASE("daily_logger background rotate", "[daily_file_sink]")
+{
+    test_background_rotate(1, 0, 1);
+    test_background_rotate(10, 0, 10);
+    test_background_rotate(10, 3, 3);
+}
+
+// the messages stamped past the next rotation time rotate the file once, not on each message
+template<typename Sink, typename Calculator>
+static void test_rotation_boundary(Sink &sink, const spdlog::filename_t &basename, std::chrono::hours period)
+{
+    sink.set_pattern("%v");
+    for (int n = 2; n < 4; n++)
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            sink.log(create_msg(std::chrono::duration_cast<std::chrono::seconds>(period * n)));
+        }
+    }
+    sink.flush();
+    using spdlog::details::os::default_eol;
+    for (int n = 2; n < 4; n++)
+    {
+        auto time = spdlog::log_clock::to_time_t(spdlog::log_clock::now() + period * n);
+        auto filename = Calculator::calc_filename(basename, spdlog::details::os::localtime(time));
+        REQUIRE(file_contents(spdlog::details::os::filename_to_str(filename)) ==
+                fmt::format("Hello Message{0}Hello Message{0}Hello Message{0}", default_eol));
+    }
+}
+
+TEST_CASE("daily_logger rotation boundary", "[daily_file_sink]")
+{
+    prepare_logdir();
+    spdlog::filename_t basename = SPDLOG_FILENAME_T("test_logs/daily_boundary.txt");
+    // truncating: a file reopened for each message would keep the last one only
+    spdlog::sinks::daily_file_sink_st sink{basename, 0, 0, true};
+    test_rotation_boundary<spdlog::sinks::daily_file_sink_st, spdlog::sinks::daily_filename_calculator>(
+        sink, basename, std::chrono::hours(24));
+}
+
+TEST_CASE("hourly_logger rotation boundary", "[hourly_file_sink]")
+{
+    prepare_logdir();
+    spdlog::filename_t basename = SPDLOG_FILENAME_T("test_logs/hourly_boundary.txt");
+    spdlog::sinks::hourly_file_sink_st sink{basename, true};
+    test_rotation_boundary<spdlog::sinks::hourly_file_sink_st, spdlog::sinks::hourly_filename_calculator>(
+        sink, basename, std::chrono::hours(1));
+}
+
+TEST_CASE("hybrid_file_sink::hybrid_filename_calculator", "[hybrid_file_sink]")
+{
+    using spdlog::sinks::hybrid_filename_calculator;
+    auto now_tm = spdlog::details::os::localtime();
+    auto daily_filename = spdlog::sinks::daily_filename_calculator::calc_filename(SPDLOG_FILENAME_T("hybrid.txt"), now_tm);
+    REQUIRE(hybrid_filename_calculator::calc_filename(SPDLOG_FILENAME_T("hybrid.txt"), now_tm, 0) == daily_filename);
+    auto filename = hybrid_filename_calculator::calc_filename(SPDLOG_FILENAME_T("hybrid.txt"), now_tm, 2);
+    REQUIRE(filename == daily_filename.substr(0, daily_filename.size() - 4) + SPDLOG_FILENAME_T(".2.txt"));
+}
+
+// "Hello Message" + eol per message, 2 messages per file
+static void test_hybrid_rotate(int days_to_run, int messages_per_day, size_t max_files, size_t max_total_size, size_t expected_n_files)
+{
+    using spdlog::sinks::hybrid_file_sink_st;
+    prepare_logdir();
+    spdlog::filename_t basename = SPDLOG_FILENAME_T("test_logs/hybrid_rotate.txt");
+    auto max_size = 2 * (13 + std::strlen(spdlog::details::os::default_eol));
+    hybrid_file_sink_st sink{basename, max_size, 2, 30, max_files, max_total_size, true};
+    sink.set_pattern("%v");
+    for (int i = 0; i < days_to_run; i++)
+    {
+        for (int j = 0; j < messages_per_day; j++)
+        {
+            sink.log(create_msg(std::chrono::seconds{24 * 3600 * i}));
+        }
+    }
+    REQUIRE(count_files("test_logs") == expected_n_files);
+}
+
+TEST_CASE("hybrid_file_sink rotate", "[hybrid_file_sink]")
+{
+    // on size
+    test_hybrid_rotate(1, 1, 0, 0, 1);
+    test_hybrid_rotate(1, 2, 0, 0, 1);
+    test_hybrid_rotate(1, 10, 0, 0, 5);
+    test_hybrid_rotate(1, 10, 3, 0, 3);
+    // the current file and one full file fit in 3 messages
+    auto message_size = 13 + std::strlen(spdlog::details::os::default_eol);
+    test_hybrid_rotate(1, 10, 0, 3 * message_size, 2);
+    // on time
+    test_hybrid_rotate(10, 1, 0, 0, 10);
+    test_hybrid_rotate(10, 1, 3, 0, 3);
+    // both
+    test_hybrid_rotate(3, 3, 0, 0, 6);
+    test_hybrid_rotate(3, 3, 4, 0, 4);
+}
+
+TEST_CASE("hybrid_file_sink reopen", "[hybrid_file_sink]")
+{
+    using spdlog::sinks::hybrid_file_sink_st;
+    prepare_logdir();
+    spdlog::filename_t basename = SPDLOG_FILENAME_T("test_logs/hybrid_rotate.txt");
+    auto max_size = 2 * (13 + std::strlen(spdlog::details::os::default_eol));
+    {
+        hybrid_file_sink_st sink{basename, max_size, 2, 30};
+        sink.set_pattern("%v");
+        for (int i = 0; i < 3; i++)
+        {
+            sink.log(create_msg(std::chrono::seconds{0}));
+        }
+    }
+    REQUIRE(count_files("test_logs") == 2);
+
+    // the last file is continued, and the previous one counts for the retention
+    hybrid_file_sink_st sink{basename, max_size, 2, 30, 2};
+    sink.set_pattern("%v");
+    sink.log(create_msg(std::chrono::seconds{0}));
+    auto second_filename = sink.filename();
+    REQUIRE(count_files("test_logs") == 2);
+    sink.log(create_msg(std::chrono::seconds{0}));
+    REQUIRE(sink.filename() != second_filename);
+    REQUIRE(count_files("test_logs") == 2);
+    REQUIRE_FALSE(spdlog::details::os::path_exists(
+        spdlog::sinks::hybrid_filename_calculator::calc_filename(basename, spdlog::details::os::localtime(), 0)));
+}
@@ -88,3 +88,90 @@ TEST_CASE("dup_filter_test5", "[dup_filter_sink]")
     REQUIRE(test_sink->msg_counter() == 3); // skip 2 messages but log the "skipped.." message before message2
     REQUIRE(test_sink->lines()[1] == "Skipped 2 duplicate messages..");
 }
+
+TEST_CASE("dup_window_filter interleaved", "[dup_filter_sink]")
+{
+    using spdlog::sinks::dup_window_filter_sink_st;
+    using spdlog::sinks::test_sink_mt;
+
+    dup_window_filter_sink_st dup_sink{std::chrono::seconds{5}, 4};
+    auto test_sink = std::make_shared<test_sink_mt>();
+    test_sink->set_pattern("%v");
+    dup_sink.add_sink(test_sink);
+
+    for (int i = 0; i < 3; i++)
+    {
+        dup_sink.log(spdlog::details::log_msg{"test", spdlog::level::info, "message A"});
+        dup_sink.log(spdlog::details::log_msg{"test", spdlog::level::info, "message B"});
+    }
+    REQUIRE(test_sink->lines() == std::vector<std::string>{"message A", "message B"});
+}
+
+TEST_CASE("dup_window_filter summaries", "[dup_filter_sink]")
+{
+    using spdlog::sinks::dup_window_filter_sink_st;
+    using spdlog::sinks::test_sink_mt;
+
+    dup_window_filter_sink_st dup_sink{std::chrono::milliseconds{0}, 2};
+    auto test_sink = std::make_shared<test_sink_mt>();
+    test_sink->set_pattern("%v");
+    dup_sink.add_sink(test_sink);
+
+    spdlog::details::log_msg msg_a{"test", spdlog::level::info, "message A"};
+    spdlog::details::log_msg msg_b{"test", spdlog::level::info, "message B"};
+    spdlog::details::log_msg msg_c{"test", spdlog::level::info, "message C"};
+    dup_sink.log(msg_a);
+    dup_sink.log(msg_a);
+    dup_sink.log(msg_b);
+    dup_sink.log(msg_b);
+    // after the skip duration: the summary then the message
+    msg_b.time += std::chrono::milliseconds(1);
+    dup_sink.log(msg_b);
+    // the oldest (A) leaves the window
+    dup_sink.log(msg_c);
+
+    REQUIRE(test_sink->lines() == std::vector<std::string>{"message A", "message B", "Skipped 1 duplicates of \"message B\"", "message B",
+                                      "Skipped 1 duplicates of \"message A\"", "message C"});
+}
+
+TEST_CASE("dup_window_filter window", "[dup_filter_sink]")
+{
+    using spdlog::sinks::dup_window_filter_sink_st;
+    using spdlog::sinks::test_sink_mt;
+
+    dup_window_filter_sink_st dup_sink{std::chrono::seconds{5}, 8};
+    auto test_sink = std::make_shared<test_sink_mt>();
+    test_sink->set_pattern("%v");
+    dup_sink.add_sink(test_sink);
+
+    // many distinct messages go through the table (insertions and deletions)
+    std::vector<std::string> payloads;
+    for (int i = 0; i < 20; i++)
+    {
+        payloads.push_back(fmt::format("message {}", i));
+    }
+    for (int round = 0; round < 2; round++)
+    {
+        for (auto &payload : payloads)
+        {
+            dup_sink.log(spdlog::details::log_msg{"test", spdlog::level::info, payload});
+            // the last 8 distinct are filtered
+            dup_sink.log(spdlog::details::log_msg{"test", spdlog::level::info, payload});
+        }
+    }
+    std::vector<std::string> expected;
+    for (int round = 0; round < 2; round++)
+    {
+        expected.insert(expected.end(), payloads.begin(), payloads.end());
+    }
+    std::vector<std::string> shown;
+    for (auto &line : test_sink->lines())
+    {
+        if (line.compare(0, 8, "Skipped ") != 0)
+        {
+            shown.push_back(line);
+        }
+    }
+    REQUIRE(shown == expected);
+    REQUIRE(test_sink->msg_counter() == 40 + 32); // and a summary for each message leaving the window
+}
@@ -64,6 +64,35 @@ TEST_CASE("file_helper_reopen2", "[file_helper::reopen(false)]]")
     REQUIRE(helper.size() == expected_size);
 }
 
+TEST_CASE("file_helper_open_in_background", "[file_helper::open_in_background()]]")
+{
+    prepare_logdir();
+    spdlog::filename_t first_filename = SPDLOG_FILENAME_T(TEST_FILENAME);
+    spdlog::filename_t second_filename = SPDLOG_FILENAME_T("test_logs/file_helper_test2.txt");
+    {
+        file_helper helper;
+        helper.open(first_filename);
+        write_with_helper(helper, 10);
+        helper.open_in_background(second_filename, true, 8);
+        REQUIRE(helper.filename() == second_filename);
+        // kept until the file is open, up to 8 bytes
+        helper.write(spdlog::string_view_t("1234"));
+        helper.write(spdlog::string_view_t("5678"));
+        helper.write(spdlog::string_view_t("9"));
+        (void)helper.size(); // waits for the open
+        helper.flush();
+        REQUIRE(helper.size() >= 8);
+    }
+    REQUIRE(get_filesize(TEST_FILENAME) == 10);
+    auto contents = file_contents("test_logs/file_helper_test2.txt");
+    REQUIRE(contents.compare(0, 8, "12345678") == 0);
+
+    // failed opens are thrown by the next write
+    file_helper helper;
+    helper.open_in_background(SPDLOG_FILENAME_T("test_logs"), false); // a directory
+    REQUIRE_THROWS_AS(helper.size(), spdlog::spdlog_ex);
+}
+
 static void test_split_ext(const spdlog::filename_t::value_type *fname, const spdlog::filename_t::value_type *expect_base,
     const spdlog::filename_t::value_type *expect_ext)
 {
@@ -23,6 +23,32 @@ TEST_CASE("simple_file_logger", "[simple_logger]]")
     REQUIRE(file_contents(SIMPLE_LOG) == fmt::format("Test message 1{}Test message 2{}", default_eol, default_eol));
 }
 
+TEST_CASE("spin_file_logger", "[simple_logger]]")
+{
+    prepare_logdir();
+    spdlog::filename_t filename = SPDLOG_FILENAME_T(SIMPLE_LOG);
+
+    auto logger = spdlog::create<spdlog::sinks::basic_file_sink_spin>("logger", filename);
+    logger->set_pattern("%v");
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++)
+    {
+        threads.emplace_back([&logger] {
+            for (int i = 0; i < 100; i++)
+            {
+                logger->info("Test message {}", i);
+            }
+        });
+    }
+    for (auto &t : threads)
+    {
+        t.join();
+    }
+    logger->flush();
+    require_message_count(SIMPLE_LOG, 400);
+}
+
 TEST_CASE("flush_on", "[flush_on]]")
 {
     prepare_logdir();
@@ -98,3 +124,727 @@ TEST_CASE("rotating_file_logger2", "[rotating_logger]]")
     REQUIRE(get_filesize(ROTATING_LOG) <= max_size);
     REQUIRE(get_filesize(ROTATING_LOG ".1") <= max_size);
 }
+
+#define BINARY_LOG "test_logs/binary_log"
+
+static std::vector<std::string> read_binary_log(const std::string &pattern)
+{
+    spdlog::details::binary_log_reader reader(SPDLOG_FILENAME_T(BINARY_LOG));
+    spdlog::pattern_formatter formatter(pattern, spdlog::pattern_time_type::local, "");
+    std::vector<std::string> lines;
+    spdlog::details::log_msg msg;
+    while (reader.read(msg))
+    {
+        spdlog::memory_buf_t formatted;
+        formatter.format(msg, formatted);
+        lines.emplace_back(formatted.data(), formatted.size());
+    }
+    return lines;
+}
+
+TEST_CASE("binary_file_logger", "[binary_logger]")
+{
+    prepare_logdir();
+    spdlog::filename_t filename = SPDLOG_FILENAME_T(BINARY_LOG);
+    auto logger = spdlog::binary_logger_mt("logger", filename);
+    logger->set_level(spdlog::level::trace);
+
+    logger->info("Test message {}", 1);
+    logger->log(spdlog::source_loc{"some/file.cpp", 42, "func"}, spdlog::level::warn, "order filled", spdlog::kv("id", 7),
+        spdlog::kv("px", 1.5), spdlog::kv("sym", "AB"), spdlog::kv("ok", true), spdlog::kv("n", 18446744073709551615ULL));
+    logger->log(spdlog::source_loc{"some/file.cpp", 42, "func"}, spdlog::level::warn, "order filled", spdlog::kv("id", -8),
+        spdlog::kv("px", 2.5), spdlog::kv("sym", "CD"), spdlog::kv("ok", false), spdlog::kv("n", 0u));
+    std::thread([logger] { logger->trace("from another thread"); }).join();
+    logger->error(std::string(1000, 'x'));
+    logger->flush();
+
+    auto lines = read_binary_log("%n|%l|%s:%#:%!|%v|%k");
+    REQUIRE(lines.size() == 5);
+    REQUIRE(lines[0] == "logger|info|::|Test message 1|");
+    REQUIRE(lines[1] == "logger|warning|file.cpp:42:func|order filled|id=7 px=1.5 sym=AB ok=true n=18446744073709551615");
+    REQUIRE(lines[2] == "logger|warning|file.cpp:42:func|order filled|id=-8 px=2.5 sym=CD ok=false n=0");
+    REQUIRE(lines[3] == "logger|trace|::|from another thread|");
+    REQUIRE(lines[4] == "logger|error|::|" + std::string(1000, 'x') + "|");
+    spdlog::drop_all();
+
+    // the logged time and thread ids are kept too
+    auto thread_lines = read_binary_log("%t");
+    REQUIRE(thread_lines[0] == std::to_string(spdlog::details::os::thread_id()));
+    REQUIRE(thread_lines[0] != thread_lines[3]);
+    REQUIRE(thread_lines[0] == thread_lines[4]);
+}
+
+TEST_CASE("binary_file_logger runtime payloads", "[binary_logger]")
+{
+    // the runtime texts of structured messages are written inline, not added to the string table
+    spdlog::details::binary_log_writer writer;
+    spdlog::memory_buf_t start;
+    writer.start_session(start);
+    std::string text = "dynamic text " + std::to_string(42);
+    auto f = spdlog::kv("id", 7);
+    spdlog::details::log_msg msg("logger", spdlog::level::info, text);
+    msg.fields = &f;
+    msg.n_fields = 1;
+    for (int i = 0; i < 2; i++)
+    {
+        spdlog::memory_buf_t dest;
+        writer.encode(msg, dest);
+        REQUIRE(std::string(dest.data(), dest.size()).find(text) != std::string::npos);
+    }
+}
+
+TEST_CASE("binary_file_logger trace context", "[binary_logger]")
+{
+    prepare_logdir();
+    auto logger = spdlog::binary_logger_st("logger", SPDLOG_FILENAME_T(BINARY_LOG));
+    spdlog::trace_context context{};
+    context.trace_id[0] = 0xab;
+    context.trace_id[15] = 0x01;
+    context.span_id[7] = 0xff;
+    {
+        spdlog::scoped_trace_context trace(context);
+        logger->info("traced {}", 1);
+    }
+    logger->info("untraced");
+    logger->flush();
+    spdlog::drop_all();
+
+    auto lines = read_binary_log("%Q|%q|%v");
+    REQUIRE(lines.size() == 2);
+    REQUIRE(lines[0] == "ab000000000000000000000000000001|00000000000000ff|traced 1");
+    REQUIRE(lines[1] == "||untraced");
+}
+
+TEST_CASE("binary_file_logger timestamps", "[binary_logger]")
+{
+    prepare_logdir();
+    auto sink = std::make_shared<spdlog::sinks::binary_file_sink_st>(SPDLOG_FILENAME_T(BINARY_LOG));
+    spdlog::logger logger("logger", sink);
+    auto now = spdlog::log_clock::now();
+    // out of order times (e.g. from several async workers) are fine
+    for (auto offset : {0, 5000, -3000, 1})
+    {
+        logger.log(now + std::chrono::milliseconds(offset), spdlog::source_loc{}, spdlog::level::info, "msg");
+    }
+    logger.flush();
+
+    spdlog::details::binary_log_reader reader(SPDLOG_FILENAME_T(BINARY_LOG));
+    spdlog::details::log_msg msg;
+    for (auto offset : {0, 5000, -3000, 1})
+    {
+        REQUIRE(reader.read(msg));
+        REQUIRE(msg.time == now + std::chrono::milliseconds(offset));
+    }
+    REQUIRE_FALSE(reader.read(msg));
+}
+
+TEST_CASE("binary_file_logger append", "[binary_logger]")
+{
+    prepare_logdir();
+    for (int session = 0; session < 3; session++)
+    {
+        auto logger = spdlog::binary_logger_st("logger" + std::to_string(session), SPDLOG_FILENAME_T(BINARY_LOG));
+        logger->info("session", spdlog::kv("n", session));
+        logger->info("plain {}", session);
+        spdlog::drop_all();
+    }
+
+    auto lines = read_binary_log("%n %v %k");
+    REQUIRE(lines.size() == 6);
+    for (int session = 0; session < 3; session++)
+    {
+        REQUIRE(lines[session * 2] == fmt::format("logger{0} session n={0}", session));
+        REQUIRE(lines[session * 2 + 1] == fmt::format("logger{0} plain {0} ", session));
+    }
+}
+
+TEST_CASE("binary_file_logger truncated", "[binary_logger]")
+{
+    prepare_logdir();
+    {
+        auto logger = spdlog::binary_logger_st("logger", SPDLOG_FILENAME_T(BINARY_LOG));
+        logger->info("first");
+        logger->info("second message");
+        spdlog::drop_all();
+    }
+    // cut the last record short, as if the writer died while writing it
+    auto contents = file_contents(BINARY_LOG);
+    {
+        std::ofstream out(BINARY_LOG, std::ios::binary | std::ios::trunc);
+        out.write(contents.data(), static_cast<std::streamsize>(contents.size() - 3));
+    }
+    REQUIRE(read_binary_log("%v") == std::vector<std::string>{"first"});
+
+    // not a binary log
+    {
+        std::ofstream out(BINARY_LOG, std::ios::binary | std::ios::trunc);
+        out << "some text log";
+    }
+    REQUIRE_THROWS_AS(read_binary_log("%v"), spdlog::spdlog_ex);
+}
+
+TEST_CASE("file sinks log_formatted", "[log_formatted]")
+{
+    prepare_logdir();
+    spdlog::details::log_msg msg("test", spdlog::level::info, "message");
+    spdlog::string_view_t formatted("formatted upstream\n");
+
+    auto file_sink = std::make_shared<spdlog::sinks::basic_file_sink_st>(SPDLOG_FILENAME_T(SIMPLE_LOG));
+    file_sink->log_formatted(msg, formatted);
+    file_sink->log_formatted(msg, formatted);
+    file_sink->flush();
+    REQUIRE(file_contents(SIMPLE_LOG) == "formatted upstream\nformatted upstream\n");
+
+    // the rotating sink counts the given bytes
+    auto rotating_sink = std::make_shared<spdlog::sinks::rotating_file_sink_st>(SPDLOG_FILENAME_T(ROTATING_LOG), 30, 1);
+    rotating_sink->log_formatted(msg, formatted);
+    rotating_sink->log_formatted(msg, formatted);
+    rotating_sink->flush();
+    REQUIRE(file_contents(ROTATING_LOG) == "formatted upstream\n");
+    REQUIRE(file_contents(std::string(ROTATING_LOG) + ".1") == "formatted upstream\n");
+}
+
+TEST_CASE("file sink write buffer", "[simple_logger]")
+{
+    prepare_logdir();
+    spdlog::filename_t filename = SPDLOG_FILENAME_T(SIMPLE_LOG);
+    {
+        auto logger = spdlog::basic_logger_st("logger", filename, false, 64);
+        logger->set_pattern("%v");
+
+        logger->info("Test message {}", 1);
+        logger->info("Test message {}", 2);
+        REQUIRE(get_filesize(SIMPLE_LOG) == 0);
+        logger->flush();
+        require_message_count(SIMPLE_LOG, 2);
+
+        for (int i = 0; i < 10; i++)
+        {
+            logger->info("Test message {}", i);
+        }
+        logger->info(std::string(100, 'x'));
+#ifndef SPDLOG_IO_URING // written in the background
+        // written when the buffer fills up, larger messages as they come (after the buffered ones)
+        REQUIRE(count_lines(SIMPLE_LOG) == 13);
+#endif
+        logger->info("last message");
+        spdlog::drop("logger");
+    }
+    // and on close
+    require_message_count(SIMPLE_LOG, 14);
+    using spdlog::details::os::default_eol;
+    auto contents = file_contents(SIMPLE_LOG);
+    REQUIRE(contents.substr(contents.size() - 12 - strlen(default_eol)) == fmt::format("last message{}", default_eol));
+}
+
+TEST_CASE("file sink write buffer order", "[simple_logger]")
+{
+    prepare_logdir();
+    spdlog::filename_t filename = SPDLOG_FILENAME_T(SIMPLE_LOG);
+    auto logger = spdlog::basic_logger_st("logger", filename, false, 256);
+    logger->set_pattern("%v");
+    const int n_messages = 10000;
+    for (int i = 0; i < n_messages; i++)
+    {
+        logger->info("Test message {}", i);
+    }
+    logger->flush();
+    spdlog::drop("logger");
+
+    std::ifstream ifs(SIMPLE_LOG);
+    std::string line;
+    int i = 0;
+    while (std::getline(ifs, line))
+    {
+        REQUIRE(line == fmt::format("Test message {}", i++));
+    }
+    REQUIRE(i == n_messages);
+}
+
+TEST_CASE("file sink large payloads", "[simple_logger]")
+{
+    // written with the payload from the message (scatter-gather), in order with the buffered messages
+    using spdlog::details::os::default_eol;
+    for (size_t write_buffer_size : {size_t(0), size_t(256), size_t(64 * 1024)})
+    {
+        prepare_logdir();
+        spdlog::filename_t filename = SPDLOG_FILENAME_T(SIMPLE_LOG);
+        auto logger = spdlog::basic_logger_st("logger", filename, false, write_buffer_size);
+        logger->set_pattern("[%l] %v!");
+        std::string expected;
+        for (size_t i = 0; i < 20; i++)
+        {
+            auto payload = i % 3 == 0 ? std::string(5000 + i * 1000, static_cast<char>('a' + i)) : fmt::format("small {}", i);
+            logger->info(payload);
+            expected += fmt::format("[info] {}!{}", payload, default_eol);
+        }
+        logger->flush();
+        spdlog::drop("logger");
+        REQUIRE(file_contents(SIMPLE_LOG) == expected);
+    }
+
+    // counted by the rotating sink
+    prepare_logdir();
+    spdlog::filename_t basename = SPDLOG_FILENAME_T(ROTATING_LOG);
+    auto logger = spdlog::rotating_logger_st("logger", basename, 10 * 1024, 2);
+    logger->set_pattern("%v");
+    for (char c : {'a', 'b', 'c'})
+    {
+        logger->info(std::string(8 * 1024, c));
+    }
+    logger->flush();
+    spdlog::drop("logger");
+    REQUIRE(file_contents(ROTATING_LOG) == std::string(8 * 1024, 'c') + default_eol);
+    REQUIRE(file_contents(std::string(ROTATING_LOG) + ".1") == std::string(8 * 1024, 'b') + default_eol);
+}
+
+TEST_CASE("rotating_file_logger write buffer", "[rotating_logger]")
+{
+    prepare_logdir();
+    size_t max_size = 1024 * 10;
+    spdlog::filename_t basename = SPDLOG_FILENAME_T(ROTATING_LOG);
+    auto logger = spdlog::rotating_logger_mt("logger", basename, max_size, 2, false, 1024);
+
+    for (int i = 0; i < 1000; i++)
+    {
+        logger->info("Test message {}", i);
+    }
+    // the buffered data was written to the rotated files
+    logger->flush();
+    REQUIRE(get_filesize(ROTATING_LOG) <= max_size);
+    REQUIRE(get_filesize(ROTATING_LOG) > 0);
+    REQUIRE(get_filesize(std::string(ROTATING_LOG) + ".1") <= max_size);
+    REQUIRE(get_filesize(std::string(ROTATING_LOG) + ".1") > max_size - 100);
+}
+
+TEST_CASE("rotating_file_logger background rotation", "[rotating_logger]")
+{
+    prepare_logdir();
+    size_t max_size = 1024;
+    spdlog::filename_t basename = SPDLOG_FILENAME_T(ROTATING_LOG);
+    {
+        auto logger = spdlog::rotating_logger_st("logger", basename, max_size, 2, false, 0, false, true);
+        logger->set_pattern("%v");
+        for (int i = 0; i < 1000; i++)
+        {
+            logger->info("Test message {}", i);
+        }
+        spdlog::drop("logger");
+    }
+    // the rotations left were completed on close
+    using spdlog::details::os::path_exists;
+    REQUIRE(get_filesize(ROTATING_LOG) <= max_size);
+    REQUIRE(get_filesize(std::string(ROTATING_LOG) + ".1") > max_size - 100);
+    REQUIRE(get_filesize(std::string(ROTATING_LOG) + ".2") > max_size - 100);
+    REQUIRE_FALSE(path_exists(std::string(ROTATING_LOG) + ".3"));
+    REQUIRE_FALSE(path_exists(std::string(ROTATING_LOG) + ".rotating-1"));
+
+    // in order: log.2 is the oldest
+    std::ifstream older(std::string(ROTATING_LOG) + ".2");
+    std::ifstream newer(std::string(ROTATING_LOG) + ".1");
+    std::string older_line, newer_line, line;
+    while (std::getline(older, line))
+    {
+        older_line = line;
+    }
+    std::getline(newer, newer_line);
+    REQUIRE(std::stoi(older_line.substr(13)) + 1 == std::stoi(newer_line.substr(13)));
+}
+
+TEST_CASE("rotating_file_logger time index", "[rotating_logger]")
+{
+    prepare_logdir();
+    spdlog::filename_t basename = SPDLOG_FILENAME_T(ROTATING_LOG);
+    using spdlog::details::time_index;
+    auto t0 = spdlog::log_clock::now();
+    {
+        auto sink = std::make_shared<spdlog::sinks::rotating_file_sink_st>(basename, 2048, 2);
+        sink->enable_time_index(std::chrono::seconds(1), 0);
+        spdlog::logger logger("logger", sink);
+        logger.set_pattern("%v");
+        // 10 messages per second, 2 files
+        for (int i = 0; i < 200; i++)
+        {
+            logger.log(t0 + std::chrono::milliseconds(100 * i), spdlog::source_loc{}, spdlog::level::info, fmt::format("Test message {:03}", i));
+        }
+    }
+    auto rotated = spdlog::sinks::rotating_file_sink_st::calc_filename(basename, 1);
+    REQUIRE(spdlog::details::os::path_exists(time_index::index_filename(rotated)));
+    auto entries = time_index::read(basename);
+    REQUIRE(entries.size() >= 2);
+    REQUIRE(entries.front().offset == 0);
+
+    // the messages of the range, and at most an interval before and after it
+    auto second = std::chrono::duration_cast<spdlog::log_clock::duration>(std::chrono::nanoseconds(entries[1].time)) - t0.time_since_epoch();
+    auto from = t0 + second + std::chrono::milliseconds(350);
+    auto range = time_index::find_range(basename, from, from + std::chrono::milliseconds(200));
+    auto contents = file_contents(ROTATING_LOG);
+    REQUIRE(range.second != SIZE_MAX);
+    auto part = contents.substr(range.first, range.second - range.first);
+    auto first_message = std::chrono::duration_cast<std::chrono::milliseconds>(second).count() / 100;
+    REQUIRE(part.find(fmt::format("Test message {:03}", first_message + 4)) != std::string::npos);
+    REQUIRE(part.find(fmt::format("Test message {:03}", first_message + 5)) != std::string::npos);
+    REQUIRE(part.size() <= 21 * 17);
+}
+
+TEST_CASE("rotating_file_logger max total size", "[rotating_logger]")
+{
+    prepare_logdir();
+    spdlog::filename_t basename = SPDLOG_FILENAME_T(ROTATING_LOG);
+    auto file_exists = [&](size_t index) {
+        return spdlog::details::os::path_exists(spdlog::sinks::rotating_file_sink_st::calc_filename(basename, index));
+    };
+    {
+        auto sink = std::make_shared<spdlog::sinks::rotating_file_sink_st>(basename, 1024, 10);
+        sink->set_max_total_size(2500);
+        spdlog::logger logger("logger", sink);
+        logger.set_pattern("%v");
+        for (int i = 0; i < 400; i++)
+        {
+            logger.info("Test message {:03}", i);
+        }
+    }
+    // the two newest files fit
+    REQUIRE(file_exists(1));
+    REQUIRE(file_exists(2));
+    REQUIRE_FALSE(file_exists(3));
+
+    // the existing files are scanned
+    auto sink = std::make_shared<spdlog::sinks::rotating_file_sink_st>(basename, 1024, 10);
+    sink->set_max_total_size(1500);
+    REQUIRE(file_exists(1));
+    REQUIRE_FALSE(file_exists(2));
+}
+
+#ifdef SPDLOG_ZLIB
+#    include <zlib.h>
+
+static std::string gunzip_file(const std::string &filename)
+{
+    std::string contents;
+    auto *gz = gzopen(filename.c_str(), "rb");
+    REQUIRE(gz != nullptr);
+    char buf[4096];
+    int n;
+    while ((n = gzread(gz, buf, sizeof(buf))) > 0)
+    {
+        contents.append(buf, static_cast<size_t>(n));
+    }
+    gzclose(gz);
+    return contents;
+}
+
+TEST_CASE("rotating_file_logger compression", "[rotating_logger]")
+{
+    prepare_logdir();
+    size_t max_size = 1024;
+    spdlog::filename_t basename = SPDLOG_FILENAME_T(ROTATING_LOG);
+    {
+        auto logger = spdlog::rotating_logger_st("logger", basename, max_size, 2, false, 0, false, false, true);
+        logger->set_pattern("%v");
+        for (int i = 0; i < 1000; i++)
+        {
+            logger->info("Test message {}", i);
+        }
+        spdlog::drop("logger");
+    }
+    using spdlog::details::os::path_exists;
+    REQUIRE_FALSE(path_exists(std::string(ROTATING_LOG) + ".1"));
+    REQUIRE_FALSE(path_exists(std::string(ROTATING_LOG) + ".3.gz"));
+    auto newer = gunzip_file(std::string(ROTATING_LOG) + ".1.gz");
+    auto older = gunzip_file(std::string(ROTATING_LOG) + ".2.gz");
+    REQUIRE(newer.size() > max_size - 100);
+    REQUIRE(older.size() > max_size - 100);
+    // and in order
+    auto last_older = older.substr(older.rfind("Test message"));
+    auto first_newer = newer.substr(0, newer.find('\n'));
+    REQUIRE(std::stoi(last_older.substr(13)) + 1 == std::stoi(first_newer.substr(13)));
+}
+
+TEST_CASE("compressed_file_logger", "[compressed_logger]")
+{
+    using spdlog::details::frame_compressor;
+    using spdlog::details::os::default_eol;
+    prepare_logdir();
+    spdlog::filename_t filename = SPDLOG_FILENAME_T(SIMPLE_LOG);
+    std::string expected;
+    {
+        auto logger = spdlog::compressed_logger_st("logger", filename, false, 1024);
+        logger->set_pattern("%v");
+        for (int i = 0; i < 1000; i++)
+        {
+            logger->info("Test message {}", i);
+            expected += fmt::format("Test message {}{}", i, default_eol);
+        }
+        logger->flush();
+        // readable while written
+        REQUIRE(gunzip_file(SIMPLE_LOG) == expected);
+        REQUIRE(frame_compressor::read_frames(filename).size() > 10);
+        spdlog::memory_buf_t range;
+        frame_compressor::read_range(filename, 5000, 5100, range);
+        REQUIRE(std::string(range.data(), range.size()) == expected.substr(5000, 100));
+        logger->info("Test message {}", 1000);
+        expected += fmt::format("Test message {}{}", 1000, default_eol);
+        spdlog::drop("logger");
+    }
+    REQUIRE(gunzip_file(SIMPLE_LOG) == expected);
+    REQUIRE(get_filesize(SIMPLE_LOG) < expected.size() / 2);
+
+    // appended to
+    {
+        auto logger = spdlog::compressed_logger_st("logger", filename, false, 1024);
+        logger->set_pattern("%v");
+        logger->info("Test message {}", 1001);
+        expected += fmt::format("Test message {}{}", 1001, default_eol);
+        spdlog::drop("logger");
+    }
+    REQUIRE(gunzip_file(SIMPLE_LOG) == expected);
+    spdlog::memory_buf_t all;
+    frame_compressor::read_range(filename, 0, SIZE_MAX, all);
+    REQUIRE(std::string(all.data(), all.size()) == expected);
+}
+
+TEST_CASE("rotating_file_logger streaming compression", "[rotating_logger]")
+{
+    using spdlog::details::frame_compressor;
+    prepare_logdir();
+    spdlog::filename_t basename = SPDLOG_FILENAME_T(ROTATING_LOG);
+    {
+        auto sink = std::make_shared<spdlog::sinks::rotating_file_sink_st>(basename, 4096, 2);
+        sink->set_compression(1024);
+        spdlog::logger logger("logger", sink);
+        logger.set_pattern("%v");
+        for (int i = 0; i < 1000; i++)
+        {
+            logger.info("Test message {}", i);
+        }
+    }
+    // the frame table follows its file
+    auto rotated = std::string(ROTATING_LOG) + ".1";
+    auto contents = gunzip_file(rotated);
+    REQUIRE(contents.size() > 4096 - 100);
+    REQUIRE(contents.size() <= 4096);
+    spdlog::memory_buf_t all;
+    frame_compressor::read_range(rotated, 0, SIZE_MAX, all);
+    REQUIRE(std::string(all.data(), all.size()) == contents);
+
+    auto compressing = std::make_shared<spdlog::sinks::rotating_file_sink_st>(basename, 4096, 2, false, 0, false, false, true);
+    REQUIRE_THROWS_AS(compressing->set_compression(1024), spdlog::spdlog_ex);
+}
+#else
+TEST_CASE("rotating_file_logger compression unsupported", "[rotating_logger]")
+{
+    prepare_logdir();
+    spdlog::filename_t basename = SPDLOG_FILENAME_T(ROTATING_LOG);
+    REQUIRE_THROWS_AS(spdlog::sinks::rotating_file_sink_st(basename, 1024, 2, false, 0, false, false, true), spdlog::spdlog_ex);
+}
+
+TEST_CASE("compressed_file_logger unsupported", "[compressed_logger]")
+{
+    prepare_logdir();
+    spdlog::filename_t filename = SPDLOG_FILENAME_T(SIMPLE_LOG);
+    REQUIRE_THROWS_AS(spdlog::sinks::compressed_file_sink_st(filename), spdlog::spdlog_ex);
+}
+#endif
+
+TEST_CASE("file sink drop page cache", "[simple_logger]")
+{
+    prepare_logdir();
+    spdlog::filename_t filename = SPDLOG_FILENAME_T(SIMPLE_LOG);
+    auto logger = spdlog::basic_logger_st("logger", filename, false, 4096, true);
+    logger->set_pattern("%v");
+    // more than a page cache drop interval - the data written is unchanged
+    auto n_messages = 2 * spdlog::details::file_helper::page_cache_drop_interval / 16;
+    for (size_t i = 0; i < n_messages; i++)
+    {
+        logger->info("Test message {}", i % 10);
+    }
+    logger->flush();
+    spdlog::drop("logger");
+    using spdlog::details::os::default_eol;
+    REQUIRE(get_filesize(SIMPLE_LOG) == n_messages * (14 + strlen(default_eol)));
+    require_message_count(SIMPLE_LOG, n_messages);
+}
+
+TEST_CASE("file sink durability", "[simple_logger]")
+{
+    prepare_logdir();
+    spdlog::filename_t filename = SPDLOG_FILENAME_T(SIMPLE_LOG);
+    using spdlog::file_durability;
+    {
+        auto sink = std::make_shared<spdlog::sinks::basic_file_sink_mt>(filename);
+        spdlog::logger logger("logger", sink);
+        logger.set_pattern("%v");
+        sink->set_durability(file_durability::sync);
+        logger.info("Test message {}", 1);
+        logger.flush();
+        require_message_count(SIMPLE_LOG, 1);
+
+        // the concurrent flushes are served by the same syncs
+        sink->set_durability(file_durability::group_commit, std::chrono::milliseconds(5));
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; t++)
+        {
+            threads.emplace_back([&logger] {
+                for (int i = 0; i < 10; i++)
+                {
+                    logger.info("Test message {}", i);
+                    logger.flush();
+                }
+            });
+        }
+        for (auto &t : threads)
+        {
+            t.join();
+        }
+        require_message_count(SIMPLE_LOG, 41);
+
+        // written on close only
+        auto buffered_sink = std::make_shared<spdlog::sinks::basic_file_sink_st>(SPDLOG_FILENAME_T("test_logs/simple_log2"), true, 1024);
+        buffered_sink->set_durability(file_durability::none);
+        spdlog::logger buffered_logger("logger2", buffered_sink);
+        buffered_logger.info("Test message");
+        buffered_logger.flush();
+        REQUIRE(get_filesize("test_logs/simple_log2") == 0);
+    }
+    REQUIRE(count_lines("test_logs/simple_log2") == 1);
+}
+
+#ifndef _WIN32
+#    define MMAP_LOG "test_logs/mmap_log"
+
+TEST_CASE("mmap_file_logger", "[mmap_logger]")
+{
+    prepare_logdir();
+    spdlog::filename_t filename = SPDLOG_FILENAME_T(MMAP_LOG);
+    const size_t chunk_size = 64 * 1024;
+    {
+        auto logger = spdlog::mmap_logger_st("logger", filename, false, chunk_size);
+        logger->set_pattern("%v");
+
+        logger->info("Test message {}", 1);
+        logger->info("Test message {}", 2);
+        // readable without flushing, the file is preallocated
+        REQUIRE(file_contents(MMAP_LOG).substr(0, 30) == "Test message 1\nTest message 2\n");
+        REQUIRE(get_filesize(MMAP_LOG) == chunk_size);
+        // messages larger than a chunk
+        logger->info(std::string(chunk_size * 2, 'x'));
+        spdlog::drop("logger");
+    }
+    // truncated to the data written on close
+    using spdlog::details::os::default_eol;
+    auto eol_size = strlen(default_eol);
+    REQUIRE(get_filesize(MMAP_LOG) == 2 * (14 + eol_size) + chunk_size * 2 + eol_size);
+    {
+        // appended to
+        auto logger = spdlog::mmap_logger_st("logger", filename, false, chunk_size);
+        logger->set_pattern("%v");
+        logger->info("Test message {}", 3);
+        spdlog::drop("logger");
+    }
+    require_message_count(MMAP_LOG, 4);
+    auto contents = file_contents(MMAP_LOG);
+    REQUIRE(contents.substr(contents.size() - 14 - eol_size) == fmt::format("Test message 3{}", default_eol));
+}
+
+TEST_CASE("mmap_file_logger after crash", "[mmap_logger]")
+{
+    prepare_logdir();
+    {
+        // the zero filled tail of the last chunk is left if the process crashed
+        spdlog::details::os::create_dir(SPDLOG_FILENAME_T("test_logs"));
+        std::ofstream ofs(MMAP_LOG, std::ios::binary);
+        ofs << "Test message 1\n" << std::string(1000, '\0');
+    }
+    {
+        auto logger = spdlog::mmap_logger_st("logger", SPDLOG_FILENAME_T(MMAP_LOG), false, 4096);
+        logger->set_pattern("%v");
+        logger->info("Test message 2");
+        spdlog::drop("logger");
+    }
+    using spdlog::details::os::default_eol;
+    REQUIRE(file_contents(MMAP_LOG) == fmt::format("Test message 1\nTest message 2{}", default_eol));
+}
+
+TEST_CASE("mmap_file_logger rotation", "[mmap_logger]")
+{
+    prepare_logdir();
+    size_t max_size = 1024 * 10;
+    auto sink = std::make_shared<spdlog::sinks::mmap_file_sink_st>(SPDLOG_FILENAME_T(MMAP_LOG), false, 4096, max_size, 2);
+    spdlog::logger logger("logger", sink);
+    for (int i = 0; i < 1000; i++)
+    {
+        logger.info("Test message {}", i);
+    }
+    auto rotated = spdlog::sinks::rotating_file_sink_st::calc_filename(SPDLOG_FILENAME_T(MMAP_LOG), 1);
+    REQUIRE(get_filesize(rotated) <= max_size);
+    REQUIRE(get_filesize(rotated) > max_size - 100);
+    REQUIRE(sink->filename() == SPDLOG_FILENAME_T(MMAP_LOG));
+}
+
+#    define SHARED_LOG "test_logs/shared_log"
+
+// the writers are separate sinks - as in separate processes
+static void log_to_shared_file(size_t n_writers, size_t n_messages, size_t max_size, size_t max_files)
+{
+    std::vector<std::thread> threads;
+    for (size_t w = 0; w < n_writers; w++)
+    {
+        threads.emplace_back([=] {
+            auto sink = std::make_shared<spdlog::sinks::shared_file_sink_st>(SPDLOG_FILENAME_T(SHARED_LOG), false, max_size, max_files);
+            spdlog::logger logger("logger", sink);
+            logger.set_pattern("%v");
+            for (size_t i = 0; i < n_messages; i++)
+            {
+                logger.info("Test message {} of writer {}", i, w);
+            }
+        });
+    }
+    for (auto &t : threads)
+    {
+        t.join();
+    }
+}
+
+// the number of lines, all complete
+static size_t count_shared_file_lines(const std::string &filename)
+{
+    std::istringstream contents(file_contents(filename));
+    std::string line;
+    size_t n = 0;
+    while (std::getline(contents, line))
+    {
+        REQUIRE(line.compare(0, 13, "Test message ") == 0);
+        REQUIRE(line.find(" of writer ") != std::string::npos);
+        REQUIRE(line.find("Test message ", 1) == std::string::npos);
+        n++;
+    }
+    return n;
+}
+
+TEST_CASE("shared_file_logger", "[shared_logger]")
+{
+    prepare_logdir();
+    log_to_shared_file(4, 500, 0, 0);
+    REQUIRE(count_shared_file_lines(SHARED_LOG) == 2000);
+}
+
+TEST_CASE("shared_file_logger rotation", "[shared_logger]")
+{
+    prepare_logdir();
+    size_t max_size = 16 * 1024;
+    log_to_shared_file(4, 500, max_size, 10);
+    // rotated by one of the writers at a time, nothing lost
+    size_t n_lines = count_shared_file_lines(SHARED_LOG);
+    for (size_t i = 1; i <= 10; i++)
+    {
+        auto rotated = spdlog::sinks::rotating_file_sink_st::calc_filename(SPDLOG_FILENAME_T(SHARED_LOG), i);
+        if (spdlog::details::os::path_exists(rotated))
+        {
+            n_lines += count_shared_file_lines(rotated);
+        }
+    }
+    REQUIRE(n_lines == 2000);
+    REQUIRE(spdlog::details::os::path_exists(spdlog::sinks::rotating_file_sink_st::calc_filename(SPDLOG_FILENAME_T(SHARED_LOG), 2)));
+}
+#endif
@@ -0,0 +1,89 @@
+#include "includes.h"
+#include "spdlog/sinks/filter_sink.h"
+#include "test_sink.h"
+
+using spdlog::details::substring_matcher;
+using spdlog::sinks::filter_sink_config;
+using spdlog::sinks::filter_sink_st;
+using spdlog::sinks::test_sink_st;
+
+TEST_CASE("substring_matcher", "[filter_sink]")
+{
+    substring_matcher none;
+    REQUIRE(none.empty());
+    REQUIRE_FALSE(none.match("anything"));
+
+    substring_matcher matcher({"needle", "x", "0123456789abcdef"});
+    REQUIRE_FALSE(matcher.empty());
+    REQUIRE_FALSE(matcher.match(""));
+    REQUIRE_FALSE(matcher.match("haystack"));
+    REQUIRE_FALSE(matcher.match("needl"));
+    REQUIRE(matcher.match("needle"));
+    REQUIRE(matcher.match("x"));
+
+    // at every position of a text longer than the blocks, including the last ones
+    std::string hay(100, '.');
+    for (size_t pos = 0; pos + 6 <= hay.size(); pos++)
+    {
+        auto text = hay;
+        text.replace(pos, 6, "needle");
+        REQUIRE(matcher.match(text));
+        text.replace(pos, 6, "needla");
+        REQUIRE_FALSE(matcher.match(text));
+    }
+    REQUIRE(matcher.match(hay + "0123456789abcdef" + hay));
+    REQUIRE_FALSE(matcher.match(hay + "0123456789abcdeX" + hay));
+
+    REQUIRE(substring_matcher({""}).match("anything"));
+}
+
+TEST_CASE("filter_sink predicates", "[filter_sink]")
+{
+    auto test_sink = std::make_shared<test_sink_st>();
+    test_sink->set_pattern("%n %v");
+    filter_sink_config config;
+    config.min_level = spdlog::level::info;
+    config.excluded_loggers = {"noisy"};
+    config.contains = {"order", "payment"};
+    config.excludes = {"heartbeat"};
+    config.regex = "id=[0-9]+";
+    filter_sink_st sink(config);
+    sink.add_sink(test_sink);
+
+    auto log = [&](const char *logger_name, spdlog::level::level_enum lvl, const char *text) {
+        sink.log(spdlog::details::log_msg{logger_name, lvl, text});
+    };
+    log("app", spdlog::level::info, "order id=1");
+    log("app", spdlog::level::debug, "order id=2");       // level
+    log("noisy", spdlog::level::info, "order id=3");      // excluded logger
+    log("app", spdlog::level::info, "shipment id=4");     // no substring
+    log("app", spdlog::level::warn, "payment heartbeat"); // excluded substring
+    log("app", spdlog::level::info, "payment id=none");   // regex
+    log("app", spdlog::level::err, "payment id=7 failed");
+
+    REQUIRE(test_sink->lines() == std::vector<std::string>{"app order id=1", "app payment id=7 failed"});
+    REQUIRE(sink.filtered_messages() == 5);
+}
+
+TEST_CASE("filter_sink loggers", "[filter_sink]")
+{
+    auto test_sink = std::make_shared<test_sink_st>();
+    test_sink->set_pattern("%n");
+    filter_sink_config config;
+    config.loggers = {"db", "net"};
+    filter_sink_st sink(config);
+    sink.add_sink(test_sink);
+
+    for (auto *logger_name : {"db", "app", "net", "dbx"})
+    {
+        sink.log(spdlog::details::log_msg{logger_name, spdlog::level::info, "msg"});
+    }
+    REQUIRE(test_sink->lines() == std::vector<std::string>{"db", "net"});
+}
+
+TEST_CASE("filter_sink invalid regex", "[filter_sink]")
+{
+    filter_sink_config config;
+    config.regex = "(unclosed";
+    REQUIRE_THROWS_AS(filter_sink_st(config), spdlog::spdlog_ex);
+}
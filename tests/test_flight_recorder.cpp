@@ -0,0 +1,112 @@
+#include "includes.h"
+#include "test_sink.h"
+#include "spdlog/flight_recorder.h"
+#include "spdlog/details/binary_log_reader.h"
+
+#define FLIGHT_LOG "test_logs/flight_log"
+
+static std::vector<std::string> read_flight_log(const spdlog::filename_t &filename)
+{
+    spdlog::details::binary_log_reader reader(filename);
+    spdlog::pattern_formatter formatter("%n|%l|%v", spdlog::pattern_time_type::local, "");
+    std::vector<std::string> lines;
+    spdlog::details::log_msg msg;
+    while (reader.read(msg))
+    {
+        spdlog::memory_buf_t formatted;
+        formatter.format(msg, formatted);
+        lines.emplace_back(formatted.data(), formatted.size());
+    }
+    return lines;
+}
+
+TEST_CASE("flight_recorder_dump", "[flight_recorder]")
+{
+    prepare_logdir();
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_st>();
+    spdlog::logger logger("flight", test_sink);
+    logger.set_pattern("%v");
+    spdlog::enable_flight_recorder(SPDLOG_FILENAME_T(FLIGHT_LOG));
+
+    logger.trace("not recorded");
+    logger.debug("debug {}", 1);
+    logger.debug("constant");
+    logger.info("info {}", "message");
+    std::thread([&logger] { logger.debug("from another thread"); }).join();
+
+    REQUIRE(test_sink->lines().size() == 1);
+    REQUIRE(spdlog::dump_flight_recorder() == 4);
+    auto lines = read_flight_log(SPDLOG_FILENAME_T(FLIGHT_LOG));
+    REQUIRE(lines.size() == 4);
+    REQUIRE(lines[0] == "flight|debug|debug 1");
+    REQUIRE(lines[1] == "flight|debug|constant");
+    REQUIRE(lines[2] == "flight|info|info message");
+    REQUIRE(lines[3] == "flight|debug|from another thread");
+
+    // dumped on critical messages
+    prepare_logdir();
+    logger.critical("failed");
+    lines = read_flight_log(SPDLOG_FILENAME_T(FLIGHT_LOG));
+    REQUIRE(lines.size() == 5);
+    REQUIRE(lines[4] == "flight|critical|failed");
+
+    spdlog::disable_flight_recorder();
+    logger.debug("after disable");
+    REQUIRE(spdlog::dump_flight_recorder(SPDLOG_FILENAME_T(FLIGHT_LOG)) == 0);
+}
+
+TEST_CASE("flight_recorder_overrun", "[flight_recorder]")
+{
+    prepare_logdir();
+    spdlog::logger logger("flight", std::make_shared<spdlog::sinks::null_sink_st>());
+    spdlog::enable_flight_recorder(SPDLOG_FILENAME_T(FLIGHT_LOG), spdlog::level::trace, 4096);
+    spdlog::set_flight_recorder_dump_level(spdlog::level::off);
+    for (int i = 0; i < 1000; i++)
+    {
+        logger.trace("message {}", i);
+    }
+    logger.critical(std::string(10000, 'x'));
+
+    auto n_messages = spdlog::dump_flight_recorder();
+    REQUIRE(n_messages > 10);
+    REQUIRE(n_messages < 1000);
+    auto lines = read_flight_log(SPDLOG_FILENAME_T(FLIGHT_LOG));
+    REQUIRE(lines.size() == n_messages);
+    // the oldest records were evicted, the long payload truncated to a quarter of the ring
+    REQUIRE(lines[lines.size() - 2] == "flight|trace|message 999");
+    REQUIRE(lines.back() == "flight|critical|" + std::string(1024, 'x'));
+
+    spdlog::set_flight_recorder_dump_level(spdlog::level::critical);
+    spdlog::disable_flight_recorder();
+}
+
+#ifndef _WIN32
+TEST_CASE("flight_recorder_signal", "[flight_recorder]")
+{
+    prepare_logdir();
+    auto logger = std::make_shared<spdlog::logger>("flight", std::make_shared<spdlog::sinks::null_sink_st>());
+    spdlog::enable_flight_recorder(SPDLOG_FILENAME_T(FLIGHT_LOG));
+    spdlog::dump_flight_recorder_on_signal(SIGUSR2);
+    SPDLOG_LOGGER_DEBUG(logger, "before the signal");
+
+    std::raise(SIGUSR2);
+    // dumped by the thread of the recorder
+    std::vector<std::string> lines;
+    for (int i = 0; i < 200 && lines.empty(); i++)
+    {
+        spdlog::details::os::sleep_for_millis(10);
+        try
+        {
+            lines = read_flight_log(SPDLOG_FILENAME_T(FLIGHT_LOG));
+        }
+        catch (const spdlog::spdlog_ex &)
+        {
+            // not written yet
+        }
+    }
+    spdlog::disable_flight_recorder();
+
+    REQUIRE(lines.size() == 1);
+    REQUIRE(lines[0] == "flight|debug|before the signal");
+}
+#endif
@@ -68,6 +68,8 @@ TEST_CASE("pad6", "[fmt_helper]")
     test_pad6(1234, "001234");
     test_pad6(12345, "012345");
     test_pad6(123456, "123456");
+    test_pad6(999999, "999999");
+    test_pad6(1234567, "1234567");
 }
 
 TEST_CASE("pad9", "[fmt_helper]")
@@ -83,4 +85,16 @@ TEST_CASE("pad9", "[fmt_helper]")
     test_pad9(12345678, "012345678");
     test_pad9(123456789, "123456789");
     test_pad9(1234567891, "1234567891");
+    test_pad9(999999999, "999999999");
+    test_pad9(100000000, "100000000");
+}
+
+TEST_CASE("append_fixed_digits", "[fmt_helper]")
+{
+    memory_buf_t buf;
+    spdlog::details::fmt_helper::append_fixed_digits<1>(7u, buf);
+    spdlog::details::fmt_helper::append_fixed_digits<2>(5u, buf);
+    spdlog::details::fmt_helper::append_fixed_digits<4>(901u, buf);
+    spdlog::details::fmt_helper::append_fixed_digits<5>(uint64_t(12345), buf);
+    REQUIRE(fmt::to_string(buf) == "705090112345");
 }
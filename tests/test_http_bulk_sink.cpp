@@ -0,0 +1,152 @@
+#include "includes.h"
+
+#ifndef _WIN32
+#    include "spdlog/sinks/http_bulk_sink.h"
+#    include "http_test_server.h"
+
+TEST_CASE("http_bulk_sink ndjson", "[http_bulk_sink]")
+{
+    http_test_server server;
+    spdlog::sinks::http_bulk_sink_config config("127.0.0.1", server.port, "/_bulk");
+    config.action_line = R"({"index":{}})";
+    config.headers = {{"X-Test", "1"}};
+    config.linger = std::chrono::milliseconds(10000);
+    auto sink = std::make_shared<spdlog::sinks::http_bulk_sink_mt>(config);
+    sink->set_pattern("%l %v");
+    spdlog::logger logger("bulk", sink);
+
+    logger.info("first");
+    logger.warn("second");
+    logger.flush();
+    REQUIRE(server.wait_for(1));
+    REQUIRE(eventually([&] { return sink->sent_messages() == 2; }));
+
+    REQUIRE(server.headers[0].find("POST /_bulk HTTP/1.1") == 0);
+    REQUIRE(server.headers[0].find("Content-Type: application/x-ndjson") != std::string::npos);
+    REQUIRE(server.headers[0].find("X-Test: 1") != std::string::npos);
+    REQUIRE(server.bodies[0] == "{\"index\":{}}\ninfo first\n{\"index\":{}}\nwarning second\n");
+}
+
+TEST_CASE("http_bulk_sink json lines by default", "[http_bulk_sink]")
+{
+    http_test_server server;
+    auto sink = std::make_shared<spdlog::sinks::http_bulk_sink_st>(spdlog::sinks::http_bulk_sink_config("127.0.0.1", server.port, "/_bulk"));
+    spdlog::logger logger("bulk", sink);
+    logger.info("hello");
+    logger.flush();
+    REQUIRE(server.wait_for(1));
+    auto &body = server.bodies[0];
+    REQUIRE(body.front() == '{');
+    REQUIRE(body.find("\"message\":\"hello\"}\n") != std::string::npos);
+    REQUIRE(std::count(body.begin(), body.end(), '\n') == 1);
+}
+
+TEST_CASE("http_bulk_sink loki", "[http_bulk_sink]")
+{
+    http_test_server server;
+    spdlog::sinks::http_bulk_sink_config config("127.0.0.1", server.port, "/loki/api/v1/push", spdlog::sinks::http_bulk_format::loki);
+    config.labels = {{"job", "test"}, {"env", "ci"}};
+    config.linger = std::chrono::milliseconds(10000);
+    auto sink = std::make_shared<spdlog::sinks::http_bulk_sink_mt>(config);
+    sink->set_pattern("%v");
+    spdlog::logger logger("bulk", sink);
+
+    auto time = spdlog::log_clock::time_point(std::chrono::nanoseconds(1600000000123456789));
+    logger.log(time, spdlog::source_loc{}, spdlog::level::info, "a \"quoted\" line");
+    logger.log(time, spdlog::source_loc{}, spdlog::level::info, "second");
+    logger.flush();
+    REQUIRE(server.wait_for(1));
+
+    REQUIRE(server.headers[0].find("Content-Type: application/json") != std::string::npos);
+    REQUIRE(server.bodies[0] == R"({"streams":[{"stream":{"job":"test","env":"ci"},"values":[)"
+                                R"(["1600000000123456789","a \"quoted\" line"],["1600000000123456789","second"]]}]})");
+}
+
+TEST_CASE("http_bulk_sink batches by size and linger", "[http_bulk_sink]")
+{
+    http_test_server server;
+    spdlog::sinks::http_bulk_sink_config config("127.0.0.1", server.port, "/_bulk");
+    config.batch_bytes = 20;
+    config.linger = std::chrono::milliseconds(10000);
+    auto sink = std::make_shared<spdlog::sinks::http_bulk_sink_mt>(config);
+    sink->set_pattern("%v");
+    spdlog::logger logger("bulk", sink);
+
+    // sent once 20 bytes are pending, without a flush
+    logger.info("0123456789");
+    logger.info("0123456789");
+    REQUIRE(server.wait_for(1));
+    REQUIRE(server.bodies[0] == "0123456789\n0123456789\n");
+
+    // a partial batch is sent after the linger
+    http_test_server linger_server;
+    config.port = linger_server.port;
+    config.batch_bytes = 1024;
+    config.linger = std::chrono::milliseconds(50);
+    auto linger_sink = std::make_shared<spdlog::sinks::http_bulk_sink_mt>(config);
+    linger_sink->set_pattern("%v");
+    spdlog::logger linger_logger("linger", linger_sink);
+    linger_logger.info("lingering");
+    REQUIRE(linger_server.wait_for(1));
+    REQUIRE(linger_server.bodies[0] == "lingering\n");
+}
+
+TEST_CASE("http_bulk_sink retries and drops", "[http_bulk_sink]")
+{
+    http_test_server server({503, 400});
+    spdlog::sinks::http_bulk_sink_config config("127.0.0.1", server.port, "/_bulk");
+    config.retry_delay = std::chrono::milliseconds(1);
+    config.max_buffer_size = 100;
+    config.linger = std::chrono::milliseconds(10000);
+    auto sink = std::make_shared<spdlog::sinks::http_bulk_sink_mt>(config);
+    sink->set_pattern("%v");
+    spdlog::logger logger("bulk", sink);
+
+    for (int i = 0; i < 10; i++)
+    {
+        logger.info("a message of some length {}", i);
+    }
+    auto dropped = sink->dropped_messages();
+    REQUIRE(dropped > 0);
+    logger.flush();
+    REQUIRE(server.wait_for(2));
+    REQUIRE(eventually([&] { return sink->dropped_messages() == 10; }));
+    REQUIRE(sink->retries() == 1);
+    REQUIRE(sink->sent_messages() == 0);
+
+    logger.info("message");
+    logger.flush();
+    REQUIRE(server.wait_for(3));
+    REQUIRE(eventually([&] { return sink->sent_messages() == 1; }));
+}
+
+#    ifdef SPDLOG_ZLIB
+#        include <zlib.h>
+
+TEST_CASE("http_bulk_sink gzip", "[http_bulk_sink]")
+{
+    http_test_server server;
+    spdlog::sinks::http_bulk_sink_config config("127.0.0.1", server.port, "/_bulk");
+    config.gzip = true;
+    auto sink = std::make_shared<spdlog::sinks::http_bulk_sink_st>(config);
+    sink->set_pattern("%v");
+    spdlog::logger logger("bulk", sink);
+    logger.info("compressed line");
+    logger.flush();
+    REQUIRE(server.wait_for(1));
+    REQUIRE(server.headers[0].find("Content-Encoding: gzip") != std::string::npos);
+
+    z_stream stream{};
+    REQUIRE(inflateInit2(&stream, 15 + 16) == Z_OK);
+    std::string body(4096, '\0');
+    stream.next_in = reinterpret_cast<Bytef *>(&server.bodies[0][0]);
+    stream.avail_in = static_cast<uInt>(server.bodies[0].size());
+    stream.next_out = reinterpret_cast<Bytef *>(&body[0]);
+    stream.avail_out = static_cast<uInt>(body.size());
+    REQUIRE(inflate(&stream, Z_FINISH) == Z_STREAM_END);
+    body.resize(stream.total_out);
+    inflateEnd(&stream);
+    REQUIRE(body == "compressed line\n");
+}
+#    endif
+#endif
@@ -0,0 +1,208 @@
+#include "includes.h"
+#include "spdlog/details/intern_table.h"
+#include "spdlog/sinks/dup_filter_sink.h"
+#include "test_sink.h"
+
+#include <algorithm>
+#include <thread>
+
+using spdlog::details::intern_table;
+
+namespace {
+// keeps the payload ids of the logged messages
+class payload_id_sink : public spdlog::sinks::base_sink<spdlog::details::null_mutex>
+{
+public:
+    std::vector<uint32_t> ids;
+    std::vector<std::string> payloads;
+
+protected:
+    void sink_it_(const spdlog::details::log_msg &msg) override
+    {
+        ids.push_back(msg.payload_id);
+        payloads.emplace_back(msg.payload.data(), msg.payload.size());
+    }
+    void flush_() override {}
+};
+} // namespace
+
+TEST_CASE("intern", "[intern_table]")
+{
+    static const char text[] = "interned text";
+    auto &table = intern_table::instance();
+    auto id = table.intern(text);
+    REQUIRE(id != 0);
+    REQUIRE(table.intern(text) == id);
+    REQUIRE(table.fragment(id) == spdlog::string_view_t(text));
+    // the table keeps its own copy
+    REQUIRE(table.fragment(id).data() != text);
+
+    static const char other[] = "interned text";
+    auto other_id = table.intern(other);
+    REQUIRE(other_id != 0);
+    REQUIRE(other_id != id);
+}
+
+TEST_CASE("intern reused address", "[intern_table]")
+{
+    auto &table = intern_table::instance();
+    char buf[16] = "first";
+    spdlog::string_view_t text(buf, 5);
+    auto id = table.intern(text);
+    REQUIRE(id != 0);
+
+    // the same address with other text is not interned
+    std::memcpy(buf, "other", 5);
+    REQUIRE(table.intern(text) == 0);
+    REQUIRE(table.intern(spdlog::string_view_t(buf, 3)) == 0);
+    REQUIRE(table.fragment(id) == "first");
+}
+
+TEST_CASE("intern full table", "[intern_table]")
+{
+    // lookups end after max_probes slots, interned or not
+    std::unique_ptr<intern_table> table(new intern_table());
+    size_t capacity = intern_table::capacity;
+    std::vector<char> texts(2 * capacity, 'x');
+    std::vector<uint32_t> ids;
+    for (size_t i = 0; i < texts.size(); i++)
+    {
+        ids.push_back(table->intern(spdlog::string_view_t(&texts[i], 1)));
+    }
+    REQUIRE(table->size() <= capacity);
+    REQUIRE(table->size() > capacity / 2);
+    for (size_t i = 0; i < texts.size(); i++)
+    {
+        REQUIRE(table->intern(spdlog::string_view_t(&texts[i], 1)) == ids[i]);
+    }
+}
+
+TEST_CASE("intern concurrently", "[intern_table]")
+{
+    std::unique_ptr<intern_table> table(new intern_table());
+    static const char text[] = "raced";
+    std::vector<uint32_t> ids(8);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+        threads.emplace_back([&, i] { ids[i] = table->intern(text); });
+    }
+    for (auto &t : threads)
+    {
+        t.join();
+    }
+    REQUIRE(ids[0] != 0);
+    REQUIRE(std::count(ids.begin(), ids.end(), ids[0]) == static_cast<long>(ids.size()));
+    REQUIRE(table->size() == 1);
+}
+
+TEST_CASE("intern too long", "[intern_table]")
+{
+    std::string text(intern_table::max_fragment_size + 1, 'x');
+    REQUIRE(intern_table::instance().intern(text) == 0);
+}
+
+#ifndef SPDLOG_NO_INTERNING
+TEST_CASE("constant messages are interned", "[intern_table]")
+{
+    auto sink = std::make_shared<payload_id_sink>();
+    spdlog::logger logger("test", sink);
+    logger.info("constant message");
+    logger.info("formatted {}", 42);
+    std::string str("std::string");
+    logger.info(str);
+    logger.info(fmt::runtime("runtime {{braces}}"));
+    logger.info(fmt::runtime("runtime"));
+    char buf[32] = "char buffer";
+    logger.info(buf);
+
+    REQUIRE(sink->payloads.size() == 6);
+    REQUIRE(sink->ids[0] != 0);
+    REQUIRE(sink->payloads[0] == "constant message");
+    REQUIRE(sink->ids[1] == 0);
+    REQUIRE(sink->payloads[1] == "formatted 42");
+    REQUIRE(sink->ids[2] == 0);
+    REQUIRE(sink->payloads[2] == "std::string");
+    // runtime format strings are not literals
+    REQUIRE(sink->ids[3] == 0);
+    REQUIRE(sink->payloads[3] == "runtime {braces}");
+    REQUIRE(sink->ids[4] == 0);
+    REQUIRE(sink->payloads[4] == "runtime");
+    // nor are the char arrays they don't fill
+    REQUIRE(sink->ids[5] == 0);
+    REQUIRE(sink->payloads[5] == "char buffer");
+}
+
+TEST_CASE("interned messages are not copied", "[intern_table]")
+{
+    spdlog::details::log_msg msg("test", spdlog::level::info, "will be replaced");
+    auto id = intern_table::instance().intern("copied?");
+    REQUIRE(id != 0);
+    msg.payload = intern_table::instance().fragment(id);
+    msg.payload_id = id;
+
+    spdlog::details::log_msg_buffer buffer(msg);
+    REQUIRE(buffer.payload.data() == msg.payload.data());
+    spdlog::details::log_msg_buffer copy(buffer);
+    REQUIRE(copy.payload.data() == msg.payload.data());
+    REQUIRE(copy.logger_name == "test");
+}
+#endif
+
+TEST_CASE("interned messages - async", "[intern_table]")
+{
+    using spdlog::details::async_queue_backend;
+    for (auto backend : {async_queue_backend::blocking, async_queue_backend::arena})
+    {
+        for (auto deferred : {false, true})
+        {
+            auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+            test_sink->set_pattern("%v");
+            {
+                spdlog::details::thread_pool_options options;
+                options.queue_backend = backend;
+                auto tp = std::make_shared<spdlog::details::thread_pool>(128, 1, options);
+                auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp);
+                logger->set_deferred_formatting(deferred);
+                logger->info("constant");
+                logger->info("deferred {}", 1);
+                logger->info("field", spdlog::kv("k", "v"));
+                logger->flush();
+            }
+            REQUIRE(test_sink->lines().size() == 3);
+            REQUIRE(test_sink->lines()[0] == "constant");
+            REQUIRE(test_sink->lines()[1] == "deferred 1");
+            REQUIRE(test_sink->lines()[2] == "field");
+        }
+    }
+}
+
+TEST_CASE("interned messages - backtrace", "[intern_table]")
+{
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_st>();
+    test_sink->set_pattern("%v");
+    spdlog::logger logger("test-backtrace", test_sink);
+    logger.enable_backtrace(4);
+    logger.debug("constant");
+    logger.debug("formatted {}", 1);
+    logger.dump_backtrace();
+    REQUIRE(test_sink->lines().size() == 4);
+    REQUIRE(test_sink->lines()[1] == "constant");
+    REQUIRE(test_sink->lines()[2] == "formatted 1");
+}
+
+TEST_CASE("interned messages - dup_filter", "[intern_table]")
+{
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    auto dup_sink = std::make_shared<spdlog::sinks::dup_filter_sink_st>(std::chrono::seconds{5});
+    dup_sink->add_sink(test_sink);
+    spdlog::logger logger("test", dup_sink);
+    for (int i = 0; i < 3; i++)
+    {
+        logger.info("message");
+    }
+    // the same text, not interned
+    logger.info("{}", "message");
+    logger.info("other message");
+    REQUIRE(test_sink->msg_counter() == 3); // message, skipped 3 .., other message
+}
@@ -0,0 +1,130 @@
+#include "includes.h"
+
+using spdlog::memory_buf_t;
+
+static std::string format_json(spdlog::json_formatter &formatter, const spdlog::details::log_msg &msg)
+{
+    memory_buf_t formatted;
+    formatter.format(msg, formatted);
+    return fmt::to_string(formatted);
+}
+
+// the message without the time and thread fields
+static std::string strip_time_and_thread(const std::string &json)
+{
+    auto level_pos = json.find("\"level\"");
+    auto thread_pos = json.find("\"thread\":");
+    auto thread_end = json.find(',', thread_pos);
+    return json.substr(level_pos, thread_pos - level_pos) + json.substr(thread_end + 1);
+}
+
+TEST_CASE("json_escape", "[json_formatter]")
+{
+    auto escape = [](spdlog::string_view_t view) {
+        memory_buf_t buf;
+        spdlog::details::json_escape(view, buf);
+        return fmt::to_string(buf);
+    };
+    REQUIRE(escape("").empty());
+    REQUIRE(escape("hello") == "hello");
+    REQUIRE(escape("a long message without anything to escape") == "a long message without anything to escape");
+    REQUIRE(escape("\"quoted\"") == "\\\"quoted\\\"");
+    REQUIRE(escape("back\\slash") == "back\\\\slash");
+    REQUIRE(escape("line1\nline2\r\n\ttabbed") == "line1\\nline2\\r\\n\\ttabbed");
+    REQUIRE(escape(spdlog::string_view_t("\x01\b\f\x1f\0", 5)) == "\\u0001\\b\\f\\u001f\\u0000");
+    REQUIRE(escape("utf8 \xc3\xa9t\xc3\xa9 \x7f") == "utf8 \xc3\xa9t\xc3\xa9 \x7f");
+    // special chars at every position of the 8 chars blocks
+    for (size_t i = 0; i < 17; i++)
+    {
+        std::string text(17, 'x');
+        text[i] = '"';
+        std::string expected(17, 'x');
+        expected.replace(i, 1, "\\\"");
+        REQUIRE(escape(text) == expected);
+    }
+}
+
+TEST_CASE("json fields", "[json_formatter]")
+{
+    spdlog::json_formatter formatter(spdlog::pattern_time_type::utc, "\n");
+    spdlog::details::log_msg msg("my_logger", spdlog::level::warn, "some \"quoted\" message");
+    msg.thread_id = 1234;
+    msg.time = spdlog::log_clock::time_point(std::chrono::seconds(1614602096) + std::chrono::milliseconds(7));
+
+    REQUIRE(format_json(formatter, msg) == "{\"time\":\"2021-03-01T12:34:56.007Z\",\"level\":\"warning\",\"logger\":\"my_logger\","
+                                           "\"thread\":1234,\"message\":\"some \\\"quoted\\\" message\"}\n");
+}
+
+TEST_CASE("json source location", "[json_formatter]")
+{
+    spdlog::json_formatter formatter(spdlog::pattern_time_type::utc, "");
+    spdlog::source_loc source{"some/dir/file.cpp", 42, "func"};
+    spdlog::details::log_msg msg(source, "logger", spdlog::level::info, "msg");
+
+    REQUIRE(strip_time_and_thread(format_json(formatter, msg)) ==
+            "\"level\":\"info\",\"logger\":\"logger\",\"file\":\"some/dir/file.cpp\",\"line\":42,\"func\":\"func\",\"message\":\"msg\"}");
+}
+
+TEST_CASE("json static fields", "[json_formatter]")
+{
+    spdlog::json_formatter formatter(
+        spdlog::pattern_time_type::utc, "", spdlog::json_formatter::fields{{"service", "api"}, {"host\"", "a\\b"}});
+    spdlog::details::log_msg msg("logger", spdlog::level::err, "msg");
+
+    auto expected = "\"level\":\"error\",\"logger\":\"logger\",\"service\":\"api\",\"host\\\"\":\"a\\\\b\",\"message\":\"msg\"}";
+    REQUIRE(strip_time_and_thread(format_json(formatter, msg)) == expected);
+    // clones keep the static fields
+    auto cloned = formatter.clone();
+    memory_buf_t formatted;
+    cloned->format(msg, formatted);
+    REQUIRE(strip_time_and_thread(fmt::to_string(formatted)) == expected);
+}
+
+TEST_CASE("json logger name changes", "[json_formatter]")
+{
+    spdlog::json_formatter formatter(spdlog::pattern_time_type::utc, "");
+    spdlog::details::log_msg msg1("logger1", spdlog::level::info, "msg");
+    spdlog::details::log_msg msg2("logger\"2", spdlog::level::info, "msg");
+
+    REQUIRE(format_json(formatter, msg1).find("\"logger\":\"logger1\",") != std::string::npos);
+    REQUIRE(format_json(formatter, msg2).find("\"logger\":\"logger\\\"2\",") != std::string::npos);
+    REQUIRE(format_json(formatter, msg1).find("\"logger\":\"logger1\",") != std::string::npos);
+}
+
+TEST_CASE("json local time", "[json_formatter]")
+{
+    spdlog::json_formatter formatter(spdlog::pattern_time_type::local, "");
+    spdlog::details::log_msg msg("logger", spdlog::level::info, "msg");
+    auto json = format_json(formatter, msg);
+
+    // {"time":"YYYY-MM-DDTHH:MM:SS.mmm+hh:mm",
+    REQUIRE(json.substr(0, 9) == "{\"time\":\"");
+    REQUIRE(json[19] == 'T');
+    REQUIRE((json[32] == '+' || json[32] == '-'));
+    REQUIRE(json.substr(38, 2) == "\",");
+}
+
+TEST_CASE("json with logger", "[json_formatter]")
+{
+    std::ostringstream oss;
+    auto oss_sink = std::make_shared<spdlog::sinks::ostream_sink_mt>(oss);
+    spdlog::logger oss_logger("json_tester", oss_sink);
+    oss_logger.set_formatter(spdlog::details::make_unique<spdlog::json_formatter>(spdlog::pattern_time_type::utc, "\n"));
+    oss_logger.info("Hello {}", "\"world\"");
+
+    REQUIRE(strip_time_and_thread(oss.str()) == "\"level\":\"info\",\"logger\":\"json_tester\",\"message\":\"Hello \\\"world\\\"\"}\n");
+}
+
+TEST_CASE("json key/value fields", "[json_formatter]")
+{
+    std::ostringstream oss;
+    auto oss_sink = std::make_shared<spdlog::sinks::ostream_sink_mt>(oss);
+    spdlog::logger oss_logger("json_tester", oss_sink);
+    oss_logger.set_formatter(spdlog::details::make_unique<spdlog::json_formatter>(
+        spdlog::pattern_time_type::utc, "\n", spdlog::json_formatter::fields{{"service", "api"}}));
+    oss_logger.info("order filled", spdlog::kv("id", 7u), spdlog::kv("px", 1.5), spdlog::kv("qty", -2), spdlog::kv("sym", "A\"B"),
+        spdlog::kv("ok", false), spdlog::kv("bad", std::numeric_limits<double>::infinity()));
+
+    REQUIRE(strip_time_and_thread(oss.str()) == "\"level\":\"info\",\"logger\":\"json_tester\",\"id\":7,\"px\":1.5,\"qty\":-2,"
+                                                "\"sym\":\"A\\\"B\",\"ok\":false,\"bad\":null,\"service\":\"api\",\"message\":\"order filled\"}\n");
+}
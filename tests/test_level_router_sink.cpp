@@ -0,0 +1,56 @@
+#include "includes.h"
+#include "spdlog/sinks/level_router_sink.h"
+#include "test_sink.h"
+
+using spdlog::sinks::level_router_sink;
+using spdlog::sinks::test_sink_mt;
+
+TEST_CASE("level_router_sink routes", "[level_router_sink]")
+{
+    auto main_sink = std::make_shared<test_sink_mt>();
+    auto errors_sink = std::make_shared<test_sink_mt>();
+    auto router = std::make_shared<level_router_sink>();
+    router->add_route(spdlog::level::trace, spdlog::level::warn, main_sink);
+    router->add_route(spdlog::level::err, spdlog::level::critical, errors_sink);
+    router->set_pattern("%v");
+
+    spdlog::logger logger("router", router);
+    logger.set_level(spdlog::level::trace);
+    logger.debug("debug");
+    logger.warn("warn");
+    logger.error("error");
+    logger.critical("critical");
+
+    REQUIRE(main_sink->lines() == std::vector<std::string>{"debug", "warn"});
+    REQUIRE(errors_sink->lines() == std::vector<std::string>{"error", "critical"});
+    REQUIRE(router->sinks_of(spdlog::level::info).size() == 1);
+    REQUIRE(router->sinks_of(spdlog::level::off).empty());
+
+    logger.flush();
+    REQUIRE(main_sink->flush_counter() == 1);
+    REQUIRE(errors_sink->flush_counter() == 1);
+}
+
+TEST_CASE("level_router_sink overlapping routes", "[level_router_sink]")
+{
+    auto all_sink = std::make_shared<test_sink_mt>();
+    auto errors_sink = std::make_shared<test_sink_mt>();
+    level_router_sink router;
+    router.add_route(spdlog::level::trace, spdlog::level::critical, all_sink);
+    router.add_route(spdlog::level::err, spdlog::level::critical, errors_sink);
+    // already routed: not twice
+    router.add_route(spdlog::level::warn, spdlog::level::err, all_sink);
+    errors_sink->set_level(spdlog::level::critical);
+
+    router.log(spdlog::details::log_msg{"router", spdlog::level::info, "info"});
+    router.log(spdlog::details::log_msg{"router", spdlog::level::err, "err"});
+    router.log(spdlog::details::log_msg{"router", spdlog::level::critical, "critical"});
+    REQUIRE(all_sink->msg_counter() == 3);
+    REQUIRE(errors_sink->msg_counter() == 1);
+
+    router.remove_sink(all_sink);
+    router.log(spdlog::details::log_msg{"router", spdlog::level::critical, "critical"});
+    REQUIRE(all_sink->msg_counter() == 3);
+    REQUIRE(errors_sink->msg_counter() == 2);
+    REQUIRE(router.sinks_of(spdlog::level::info).empty());
+}
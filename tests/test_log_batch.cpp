@@ -0,0 +1,153 @@
+#include "includes.h"
+#include "test_sink.h"
+#include "spdlog/async.h"
+#include "spdlog/log_batch.h"
+
+// records the batches it is given
+class batch_recording_sink : public spdlog::sinks::sink
+{
+public:
+    std::mutex mutex;
+    std::vector<size_t> batches;
+    std::vector<std::string> payloads;
+    std::vector<spdlog::log_clock::time_point> times;
+
+    void log(const spdlog::details::log_msg &msg) override
+    {
+        log_batch(&msg, 1);
+    }
+
+    void log_batch(const spdlog::details::log_msg *msgs, size_t n_msgs) override
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        batches.push_back(n_msgs);
+        for (size_t i = 0; i < n_msgs; i++)
+        {
+            payloads.emplace_back(msgs[i].payload.data(), msgs[i].payload.size());
+            times.push_back(msgs[i].time);
+        }
+    }
+
+    void flush() override {}
+    void set_pattern(const std::string &) override {}
+    void set_formatter(std::unique_ptr<spdlog::formatter>) override {}
+};
+
+TEST_CASE("log_batch sync", "[log_batch]")
+{
+    auto sink = std::make_shared<batch_recording_sink>();
+    spdlog::logger logger("batch", sink);
+    {
+        spdlog::log_batch batch(logger, spdlog::level::info);
+        for (int i = 0; i < 3; i++)
+        {
+            batch.add("row {} {}", i, i * 10);
+        }
+        batch.add_line("total");
+        REQUIRE(batch.size() == 4);
+        REQUIRE(sink->batches.empty());
+    }
+    REQUIRE(sink->batches == std::vector<size_t>{4});
+    REQUIRE(sink->payloads == std::vector<std::string>{"row 0 0", "row 1 10", "row 2 20", "total"});
+    // stamped on submission
+    REQUIRE(sink->times[0] == sink->times[3]);
+
+    // a disabled level logs nothing
+    {
+        spdlog::log_batch batch(logger, spdlog::level::debug);
+        batch.add("hidden {}", 1);
+        REQUIRE(batch.size() == 0);
+    }
+    REQUIRE(sink->batches.size() == 1);
+}
+
+TEST_CASE("log_batch per line time", "[log_batch]")
+{
+    auto sink = std::make_shared<batch_recording_sink>();
+    spdlog::logger logger("batch", sink);
+    spdlog::log_batch batch(logger, spdlog::level::info, true);
+    batch.add_line("first");
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    batch.add_line("second");
+    batch.submit();
+    REQUIRE(sink->payloads == std::vector<std::string>{"first", "second"});
+    REQUIRE(sink->times[1] > sink->times[0]);
+
+    // refilled after a submission
+    batch.add_line("third");
+    batch.submit();
+    REQUIRE(sink->batches == std::vector<size_t>{2, 1});
+}
+
+TEST_CASE("log_batch backtrace", "[log_batch]")
+{
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_st>();
+    test_sink->set_pattern("%v");
+    spdlog::logger logger("batch", test_sink);
+    logger.enable_backtrace(10);
+    {
+        spdlog::log_batch batch(logger, spdlog::level::debug);
+        batch.add("debug {}", 1);
+        batch.add("debug {}", 2);
+    }
+    REQUIRE(test_sink->msg_counter() == 0);
+    logger.dump_backtrace();
+    auto lines = test_sink->lines();
+    REQUIRE(lines.size() == 4);
+    REQUIRE(lines[1] == "debug 1");
+    REQUIRE(lines[2] == "debug 2");
+}
+
+TEST_CASE("log_batch async", "[log_batch]")
+{
+    for (auto backend : {spdlog::details::async_queue_backend::blocking, spdlog::details::async_queue_backend::arena})
+    {
+        for (bool pin_loggers : {false, true})
+        {
+            auto sink = std::make_shared<batch_recording_sink>();
+            spdlog::details::thread_pool_options options;
+            options.queue_backend = backend;
+            options.pin_loggers = pin_loggers;
+            options.arena_size = 64 * 1024;
+            options.collect_stats = true;
+            auto tp = std::make_shared<spdlog::details::thread_pool>(16, 1, options);
+            auto logger = std::make_shared<spdlog::async_logger>("batch", sink, tp);
+            {
+                spdlog::log_batch batch(*logger, spdlog::level::info);
+                for (int i = 0; i < 100; i++)
+                {
+                    batch.add("line {}", i);
+                }
+            }
+            // queued as a single message
+            REQUIRE(logger->stats().enqueued == 1);
+            logger->flush_async().get();
+            REQUIRE(sink->batches == std::vector<size_t>{100});
+            REQUIRE(sink->payloads.front() == "line 0");
+            REQUIRE(sink->payloads.back() == "line 99");
+        }
+    }
+}
+
+TEST_CASE("log_batch larger than the arena", "[log_batch]")
+{
+    auto sink = std::make_shared<batch_recording_sink>();
+    spdlog::details::thread_pool_options options;
+    options.queue_backend = spdlog::details::async_queue_backend::arena;
+    options.arena_size = 2048;
+    auto tp = std::make_shared<spdlog::details::thread_pool>(16, 1, options);
+    auto logger = std::make_shared<spdlog::async_logger>("batch", sink, tp);
+    {
+        spdlog::log_batch batch(*logger, spdlog::level::info);
+        for (int i = 0; i < 100; i++)
+        {
+            batch.add("line {}", i);
+        }
+    }
+    logger->flush_async().get();
+    // posted in parts, in order
+    REQUIRE(sink->batches.size() > 1);
+    REQUIRE(sink->payloads.size() == 100);
+    REQUIRE(sink->payloads[50] == "line 50");
+    REQUIRE(sink->payloads.back() == "line 99");
+}
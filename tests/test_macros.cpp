@@ -3,6 +3,7 @@
  */
 
 #include "includes.h"
+#include "test_sink.h"
 
 #if SPDLOG_ACTIVE_LEVEL != SPDLOG_LEVEL_DEBUG
 #    error "Invalid SPDLOG_ACTIVE_LEVEL in test. Should be SPDLOG_LEVEL_DEBUG"
@@ -52,11 +53,113 @@ TEST_CASE("pass logger pointer", "[macros]")
 }
 
 // ensure that even if right macro level is on- don't evaluate if the logger's level is not high enough
-// TEST_CASE("disable param evaluation2", "[macros]")
-//{
-//    auto logger = std::make_shared<spdlog::logger>("test-macro");
-//    logger->set_level(spdlog::level::off);
-//    int x = 0;
-//    SPDLOG_LOGGER_DEBUG(logger, "Test message {}", ++x);
-//    REQUIRE(x == 0);
-//}
+TEST_CASE("disable param evaluation2", "[macros]")
+{
+    auto logger = std::make_shared<spdlog::logger>("test-macro");
+    logger->set_level(spdlog::level::off);
+    int x = 0;
+    SPDLOG_LOGGER_DEBUG(logger, "Test message {}", ++x);
+    REQUIRE(x == 0);
+}
+
+// a single call site, so that its cached level is reused
+static void log_debug(const std::shared_ptr<spdlog::logger> &logger, int &evaluated)
+{
+    SPDLOG_LOGGER_DEBUG(logger, "Test message {}", ++evaluated);
+}
+
+TEST_CASE("call site level cache", "[macros]")
+{
+    auto sink = std::make_shared<spdlog::sinks::test_sink_st>();
+    auto logger = std::make_shared<spdlog::logger>("test-macro", sink);
+    int evaluated = 0;
+    log_debug(logger, evaluated);
+    REQUIRE(evaluated == 0);
+
+    logger->set_level(spdlog::level::debug);
+    log_debug(logger, evaluated);
+    log_debug(logger, evaluated);
+    REQUIRE(evaluated == 2);
+
+    logger->set_level(spdlog::level::info);
+    log_debug(logger, evaluated);
+    REQUIRE(evaluated == 2);
+
+    // the backtrace takes the debug messages
+    logger->enable_backtrace(4);
+    log_debug(logger, evaluated);
+    REQUIRE(evaluated == 3);
+    logger->disable_backtrace();
+
+    // another logger at the same call site
+    auto other = std::make_shared<spdlog::logger>("test-macro2", sink);
+    other->set_level(spdlog::level::debug);
+    log_debug(other, evaluated);
+    log_debug(logger, evaluated);
+    REQUIRE(evaluated == 4);
+    REQUIRE(sink->msg_counter() == 3);
+}
+
+TEST_CASE("call site enable/disable", "[macros]")
+{
+    auto sink = std::make_shared<spdlog::sinks::test_sink_st>();
+    auto logger = std::make_shared<spdlog::logger>("test-macro", sink);
+    logger->set_level(spdlog::level::debug);
+    int evaluated = 0;
+    log_debug(logger, evaluated);
+    REQUIRE(evaluated == 1);
+
+    spdlog::set_call_site_enabled("test_macros.cpp", 0, false);
+    log_debug(logger, evaluated);
+    SPDLOG_LOGGER_INFO(logger, "Test message {}", ++evaluated);
+    REQUIRE(evaluated == 1);
+
+    // only the given line
+    spdlog::set_call_site_enabled("test_macros.cpp", __LINE__ + 1, true);
+    SPDLOG_LOGGER_INFO(logger, "Test message {}", ++evaluated);
+    log_debug(logger, evaluated);
+    REQUIRE(evaluated == 2);
+
+    // not a file name suffix
+    spdlog::set_call_site_enabled("macros.cpp", 0, true);
+    log_debug(logger, evaluated);
+    REQUIRE(evaluated == 2);
+
+    spdlog::set_call_site_enabled("test_macros.cpp", 0, true);
+    log_debug(logger, evaluated);
+    REQUIRE(evaluated == 3);
+    REQUIRE(sink->msg_counter() == 3);
+}
+
+// the rest of this file is a module logging warnings and above
+#undef SPDLOG_MODULE_LEVEL
+#define SPDLOG_MODULE_LEVEL SPDLOG_LEVEL_WARN
+
+TEST_CASE("module level", "[macros]")
+{
+    static_assert(!spdlog::details::module_allows(spdlog::level::info, SPDLOG_MODULE_LEVEL), "a constant");
+    auto sink = std::make_shared<spdlog::sinks::test_sink_st>();
+    sink->set_pattern("%v");
+    spdlog::logger logger("module_level", sink);
+    logger.set_level(spdlog::level::trace);
+
+    int evaluated = 0;
+    SPDLOG_LOGGER_DEBUG(&logger, "Test message {}", ++evaluated);
+    SPDLOG_LOGGER_INFO(&logger, "Test message {}", ++evaluated);
+    SPDLOG_LOGGER_INFO_EVERY_N(&logger, 1, "Test message {}", ++evaluated);
+    SPDLOG_LOGGER_WARN(&logger, "Test message {}", ++evaluated);
+    SPDLOG_LOGGER_ERROR(&logger, "Test message {}", ++evaluated);
+    REQUIRE(evaluated == 2);
+    REQUIRE(sink->lines() == std::vector<std::string>{"Test message 1", "Test message 2"});
+
+    // runtime levels are checked too
+    auto lvl = spdlog::level::info;
+    SPDLOG_LOGGER_CALL(&logger, lvl, "Test message {}", ++evaluated);
+    lvl = spdlog::level::critical;
+    SPDLOG_LOGGER_CALL(&logger, lvl, "Test message {}", ++evaluated);
+    REQUIRE(evaluated == 3);
+
+    // not the logger's own methods
+    logger.info("direct");
+    REQUIRE(sink->msg_counter() == 4);
+}
@@ -1,6 +1,12 @@
 #include "includes.h"
 #include "test_sink.h"
+#include "spdlog/mdc.h"
 #include "spdlog/fmt/bin_to_hex.h"
+#include "spdlog/sinks/dist_sink.h"
+#include "spdlog/sinks/ringbuffer_sink.h"
+#include "spdlog/details/format_id.h"
+#include "spdlog/details/utf_convert.h"
+#include "spdlog/fwd.h"
 
 template<class T>
 std::string log_info(const T &what, spdlog::level::level_enum logger_level = spdlog::level::info)
@@ -44,6 +50,122 @@ TEST_CASE("log_levels", "[log_levels]")
     REQUIRE(log_info("Hello", spdlog::level::trace) == "Hello");
 }
 
+TEST_CASE("sinks level", "[log_levels]")
+{
+    auto sink = std::make_shared<spdlog::sinks::test_sink_st>();
+    sink->set_level(spdlog::level::info);
+    spdlog::logger logger("sinks_level", sink);
+    logger.set_level(spdlog::level::trace);
+    // none of the sinks would log it
+    REQUIRE_FALSE(logger.should_log(spdlog::level::debug));
+    REQUIRE(logger.should_log(spdlog::level::info));
+    logger.debug("debug");
+    REQUIRE(sink->msg_counter() == 0);
+
+    sink->set_level(spdlog::level::debug);
+    REQUIRE(logger.should_log(spdlog::level::debug));
+    REQUIRE_FALSE(logger.should_log(spdlog::level::trace));
+
+    auto trace_sink = std::make_shared<spdlog::sinks::test_sink_st>();
+    logger.sinks().push_back(trace_sink);
+    REQUIRE(logger.should_log(spdlog::level::trace));
+    logger.trace("trace");
+    REQUIRE(trace_sink->msg_counter() == 1);
+    REQUIRE(sink->msg_counter() == 0);
+
+    logger.sinks().clear();
+    REQUIRE(logger.should_log(spdlog::level::trace));
+    // the logger level first
+    logger.set_level(spdlog::level::warn);
+    REQUIRE_FALSE(logger.should_log(spdlog::level::info));
+
+    auto tp = std::make_shared<spdlog::details::thread_pool>(16, 1);
+    auto async_logger = std::make_shared<spdlog::async_logger>("sinks_level_async", sink, tp);
+    async_logger->set_level(spdlog::level::trace);
+    REQUIRE_FALSE(async_logger->should_log(spdlog::level::trace));
+    REQUIRE(async_logger->should_log(spdlog::level::debug));
+}
+
+TEST_CASE("lazy args", "[lazy]")
+{
+    auto sink = std::make_shared<spdlog::sinks::test_sink_st>();
+    sink->set_pattern("%v");
+    spdlog::logger logger("lazy", sink);
+    int calls = 0;
+    auto dump = [&calls] {
+        calls++;
+        return std::string("state");
+    };
+
+    logger.debug("dump {}", spdlog::lazy(dump));
+    REQUIRE(calls == 0);
+    REQUIRE(sink->msg_counter() == 0);
+
+    logger.info("dump {}", spdlog::lazy(dump));
+    REQUIRE(calls == 1);
+    REQUIRE(sink->lines()[0] == "dump state");
+
+    // formatted as the result
+    logger.info("{:>6.2f}", spdlog::lazy([] { return 3.14159; }));
+    REQUIRE(sink->lines()[1] == "  3.14");
+}
+
+#ifdef SPDLOG_FMT_COMPILE
+TEST_CASE("compiled format strings", "[fmt_compile]")
+{
+    auto sink = std::make_shared<spdlog::sinks::test_sink_st>();
+    sink->set_pattern("%v");
+    spdlog::logger logger("compiled", sink);
+
+    logger.info(FMT_COMPILE("{} items {:>4}"), 3, 7);
+    logger.log(spdlog::level::warn, FMT_COMPILE("no args"));
+    logger.debug(FMT_COMPILE("{}"), 1);
+    SPDLOG_LOGGER_CRITICAL(&logger, FMT_COMPILE("macro {}"), 2);
+    REQUIRE(sink->lines() == std::vector<std::string>{"3 items    7", "no args", "macro 2"});
+}
+#endif
+
+template<typename Mutex>
+static void require_mutual_exclusion()
+{
+    Mutex mutex;
+    size_t counter = 0;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++)
+    {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 10000; i++)
+            {
+                std::lock_guard<Mutex> lock(mutex);
+                counter++;
+            }
+        });
+    }
+    for (auto &t : threads)
+    {
+        t.join();
+    }
+    REQUIRE(counter == 40000);
+    REQUIRE(mutex.try_lock());
+    mutex.unlock();
+}
+
+TEST_CASE("spin mutexes", "[spin_mutex]")
+{
+    require_mutual_exclusion<spdlog::details::spin_mutex>();
+    require_mutual_exclusion<spdlog::details::adaptive_mutex>();
+
+    spdlog::details::spin_mutex mutex;
+    mutex.lock();
+    REQUIRE_FALSE(mutex.try_lock());
+    mutex.unlock();
+
+    auto sink = std::make_shared<spdlog::sinks::test_sink<spdlog::details::adaptive_mutex>>();
+    spdlog::logger logger("adaptive", sink);
+    logger.info("Hello");
+    REQUIRE(sink->msg_counter() == 1);
+}
+
 TEST_CASE("level_to_string_view", "[convert_to_string_view")
 {
     REQUIRE(spdlog::level::to_string_view(spdlog::level::trace) == "trace");
@@ -92,6 +214,102 @@ TEST_CASE("periodic flush", "[periodic_flush]")
     spdlog::drop_all();
 }
 
+TEST_CASE("flush policy coalesced", "[flush_policy]")
+{
+    using spdlog::sinks::test_sink_mt;
+    auto test_sink = std::make_shared<test_sink_mt>();
+    spdlog::logger logger("flush_policy", test_sink);
+
+    spdlog::flush_policy policy;
+    policy.level = spdlog::level::err;
+    policy.min_interval = std::chrono::milliseconds(200);
+    logger.set_flush_policy(policy);
+    REQUIRE(logger.flush_level() == spdlog::level::err);
+    REQUIRE(logger.get_flush_policy().min_interval == std::chrono::milliseconds(200));
+
+    // the first one flushes, the others are coalesced into one at the end of the interval
+    for (int i = 0; i < 100; i++)
+    {
+        logger.error("error {}", i);
+    }
+    REQUIRE(test_sink->flush_counter() == 1);
+    for (int i = 0; i < 100 && test_sink->flush_counter() < 2; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    REQUIRE(test_sink->flush_counter() == 2);
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    REQUIRE(test_sink->flush_counter() == 2);
+}
+
+TEST_CASE("flush policy pending bytes", "[flush_policy]")
+{
+    using spdlog::sinks::test_sink_st;
+    auto test_sink = std::make_shared<test_sink_st>();
+    spdlog::logger logger("flush_policy", test_sink);
+
+    spdlog::flush_policy policy;
+    policy.max_pending_bytes = 10;
+    logger.set_flush_policy(policy);
+    logger.info("12345");
+    REQUIRE(test_sink->flush_counter() == 0);
+    logger.info("67890");
+    REQUIRE(test_sink->flush_counter() == 1);
+    logger.info("12345");
+    REQUIRE(test_sink->flush_counter() == 1);
+
+    // an explicit flush resets the count
+    logger.flush();
+    logger.info("67890");
+    REQUIRE(test_sink->flush_counter() == 2);
+}
+
+TEST_CASE("flush policy idle", "[flush_policy]")
+{
+    using spdlog::sinks::test_sink_mt;
+    auto test_sink = std::make_shared<test_sink_mt>();
+    spdlog::logger logger("flush_policy", test_sink);
+
+    spdlog::flush_policy policy;
+    policy.idle = std::chrono::milliseconds(20);
+    logger.set_flush_policy(policy);
+    logger.info("message");
+    for (int i = 0; i < 100 && test_sink->flush_counter() < 1; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    REQUIRE(test_sink->flush_counter() == 1);
+    // nothing pending
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    REQUIRE(test_sink->flush_counter() == 1);
+
+    // the copy flushes by the same policy
+    spdlog::logger copy(logger);
+    REQUIRE(copy.get_flush_policy().idle == std::chrono::milliseconds(20));
+
+    // the timer of a moved logger flushes the new one
+    spdlog::logger moved(std::move(copy));
+    REQUIRE(moved.get_flush_policy().idle == std::chrono::milliseconds(20));
+    moved.info("moved");
+    for (int i = 0; i < 100 && test_sink->flush_counter() < 2; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    REQUIRE(test_sink->flush_counter() == 2);
+
+    // and of swapped loggers their new one
+    spdlog::logger other("other", test_sink);
+    moved.swap(other);
+    REQUIRE(other.get_flush_policy().idle == std::chrono::milliseconds(20));
+    REQUIRE(moved.get_flush_policy().idle == std::chrono::milliseconds::zero());
+    other.info("swapped");
+    for (int i = 0; i < 100 && test_sink->flush_counter() < 3; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    REQUIRE(test_sink->flush_counter() == 3);
+}
+
 TEST_CASE("clone-logger", "[clone]")
 {
     using spdlog::sinks::test_sink_mt;
@@ -230,6 +448,36 @@ TEST_CASE("to_hex_no_ascii", "[to_hex]")
     REQUIRE(ends_with(oss.str(), "090A0B410C4BFFFF" + std::string(spdlog::details::os::default_eol)));
 }
 
+TEST_CASE("to_hex_long_lines", "[to_hex]")
+{
+    std::ostringstream oss;
+    auto oss_sink = std::make_shared<spdlog::sinks::ostream_sink_mt>(oss);
+    spdlog::logger oss_logger("oss", oss_sink);
+    oss_logger.set_pattern("%v");
+
+    std::vector<unsigned char> v;
+    std::string lower, upper;
+    for (int i = 0; i < 40; i++)
+    {
+        v.push_back(static_cast<unsigned char>(i * 7 + 0x3a));
+        lower += fmt::format("{:02x}", v.back());
+        upper += fmt::format("{:02X}", v.back());
+    }
+    auto eol = std::string(spdlog::details::os::default_eol);
+
+    oss_logger.info("{:sn}", spdlog::to_hex(v));
+    REQUIRE(oss.str() == lower + eol);
+
+    oss.str("");
+    oss_logger.info("{:Xs}", spdlog::to_hex(v, 32));
+    REQUIRE(oss.str() == eol + "0000: " + upper.substr(0, 64) + eol + "0020: " + upper.substr(64) + eol);
+
+    oss.str("");
+    std::vector<unsigned char> text(v.begin() + 30, v.begin() + 40);
+    oss_logger.info("{:a}", spdlog::to_hex(text, 8));
+    REQUIRE(oss.str() == eol + "0000: 0c 13 1a 21 28 2f 36 3d  ...!(/6=" + eol + "0008: 44 4b                    DK" + eol);
+}
+
 TEST_CASE("default logger API", "[default logger]")
 {
     std::ostringstream oss;
@@ -269,3 +517,705 @@ TEST_CASE("default logger API", "[default logger]")
     spdlog::drop_all();
     spdlog::set_pattern("%v");
 }
+
+TEST_CASE("structured logging", "[fields]")
+{
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_st>();
+    spdlog::logger logger("fields", test_sink);
+    logger.set_pattern("%v|%k");
+
+    std::string sym("AAPL");
+    int qty = -5;
+    unsigned long long id = 18446744073709551615ULL;
+    logger.info("order filled", spdlog::kv("id", id), spdlog::kv("px", 1.25), spdlog::kv("qty", qty), spdlog::kv("sym", sym),
+        spdlog::kv("side", "buy"), spdlog::kv("ok", true));
+    auto f = spdlog::kv("lvalue", 1);
+    logger.warn("lvalue field", f);
+    logger.log(spdlog::level::err, spdlog::string_view_t("string_view msg"), spdlog::kv("a", 'x'));
+    SPDLOG_LOGGER_INFO(&logger, "from macro", spdlog::kv("b", 2));
+    // format strings still work as before
+    logger.info("no fields {}", 1);
+    logger.debug("filtered", spdlog::kv("c", 3));
+
+    auto lines = test_sink->lines();
+    REQUIRE(lines.size() == 5);
+    REQUIRE(lines[0] == "order filled|id=18446744073709551615 px=1.25 qty=-5 sym=AAPL side=buy ok=true");
+    REQUIRE(lines[1] == "lvalue field|lvalue=1");
+    REQUIRE(lines[2] == "string_view msg|a=120");
+    REQUIRE(lines[3] == "from macro|b=2");
+    REQUIRE(lines[4] == "no fields 1|");
+}
+
+TEST_CASE("structured logging default pattern", "[fields]")
+{
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_st>();
+    spdlog::logger logger("fields", test_sink);
+    logger.info("with fields", spdlog::kv("id", 7), spdlog::kv("name", "x"));
+    logger.info("without fields");
+
+    auto lines = test_sink->lines();
+    REQUIRE(lines.size() == 2);
+    REQUIRE(ends_with(lines[0], "] with fields id=7 name=x"));
+    REQUIRE(ends_with(lines[1], "] without fields"));
+}
+
+TEST_CASE("structured logging copies", "[fields]")
+{
+    spdlog::details::log_msg_buffer copy;
+    {
+        std::string key("key");
+        std::string value("value");
+        spdlog::field fields[] = {spdlog::kv(key, value), spdlog::kv(spdlog::string_view_t("n"), 42)};
+        spdlog::details::log_msg msg("logger", spdlog::level::info, "msg");
+        msg.fields = fields;
+        msg.n_fields = 2;
+        spdlog::details::log_msg_buffer buffered(msg);
+        key.assign("xxx");
+        value.assign("xxxxx");
+        copy = std::move(spdlog::details::log_msg_buffer(buffered));
+    }
+    REQUIRE(copy.n_fields == 2);
+    REQUIRE(std::string(copy.fields[0].key.data(), copy.fields[0].key.size()) == "key");
+    REQUIRE(std::string(copy.fields[0].string_value.data(), copy.fields[0].string_value.size()) == "value");
+    REQUIRE(copy.fields[1].type == spdlog::field::value_type::signed_int);
+    REQUIRE(copy.fields[1].int_value == 42);
+    REQUIRE(std::string(copy.payload.data(), copy.payload.size()) == "msg");
+}
+
+TEST_CASE("stored messages beyond the inline buffer", "[fields]")
+{
+    std::string text(SPDLOG_MSG_BUFFER_SIZE + 10, 'x');
+    spdlog::details::log_msg msg("logger", spdlog::level::info, text);
+    spdlog::details::log_msg_buffer buffered(msg);
+    spdlog::details::log_msg_buffer moved(std::move(buffered));
+    REQUIRE(std::string(moved.payload.data(), moved.payload.size()) == text);
+    REQUIRE(std::string(moved.logger_name.data(), moved.logger_name.size()) == "logger");
+}
+
+TEST_CASE("scoped buffers", "[scoped_buffer]")
+{
+    using spdlog::details::scoped_buffer;
+    // nested buffers (more than reused per thread) are distinct
+    scoped_buffer b1, b2, b3, b4, b5, b6;
+    scoped_buffer *buffers[] = {&b1, &b2, &b3, &b4, &b5, &b6};
+    for (size_t i = 0; i < 6; i++)
+    {
+        REQUIRE(buffers[i]->get().size() == 0);
+        fmt::format_to(std::back_inserter(buffers[i]->get()), "{}", i);
+    }
+    for (size_t i = 0; i < 6; i++)
+    {
+        REQUIRE(std::string(buffers[i]->get().data(), buffers[i]->get().size()) == std::to_string(i));
+    }
+}
+
+#if defined(SPDLOG_REUSE_BUFFERS) && !defined(SPDLOG_NO_TLS)
+TEST_CASE("scoped buffers reuse", "[scoped_buffer]")
+{
+    using spdlog::details::scoped_buffer;
+    const char *data = nullptr;
+    {
+        scoped_buffer b;
+        b.get().resize(2000);
+        data = b.get().data();
+    }
+    {
+        scoped_buffer b;
+        REQUIRE(b.get().size() == 0);
+        REQUIRE(b.get().capacity() >= 2000);
+        REQUIRE(b.get().data() == data);
+    }
+
+    // larger than the max size - released
+    {
+        scoped_buffer b;
+        b.get().resize(SPDLOG_REUSE_BUFFERS_MAX_SIZE + 1);
+    }
+    {
+        scoped_buffer b;
+        REQUIRE(b.get().capacity() <= SPDLOG_REUSE_BUFFERS_MAX_SIZE);
+    }
+}
+#endif
+
+TEST_CASE("long messages", "[scoped_buffer]")
+{
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_st>();
+    test_sink->set_pattern("%v");
+    spdlog::logger logger("test", test_sink);
+    std::string long_text(3000, 'x');
+    logger.info("{}", long_text);
+    logger.info("{} {}", "short", 1);
+    logger.info("{}", long_text + "y");
+    REQUIRE(test_sink->lines().size() == 3);
+    REQUIRE(test_sink->lines()[0] == long_text);
+    REQUIRE(test_sink->lines()[1] == "short 1");
+    REQUIRE(test_sink->lines()[2] == long_text + "y");
+}
+
+namespace {
+// counts its format calls. formatters of the same name share a format id.
+class counting_formatter : public spdlog::formatter
+{
+public:
+    counting_formatter(std::string name, std::shared_ptr<size_t> n_formats)
+        : name_(std::move(name))
+        , n_formats_(std::move(n_formats))
+        , format_id_(spdlog::details::make_format_id("counting " + name_))
+    {}
+
+    void format(const spdlog::details::log_msg &msg, spdlog::memory_buf_t &dest) override
+    {
+        ++*n_formats_;
+        dest.append(name_.data(), name_.data() + name_.size());
+        dest.push_back(' ');
+        dest.append(msg.payload.begin(), msg.payload.end());
+        dest.push_back('\n');
+    }
+
+    std::unique_ptr<spdlog::formatter> clone() const override
+    {
+        return spdlog::details::make_unique<counting_formatter>(name_, n_formats_);
+    }
+
+    size_t format_id() const override
+    {
+        return format_id_;
+    }
+
+private:
+    std::string name_;
+    std::shared_ptr<size_t> n_formats_;
+    size_t format_id_;
+};
+} // namespace
+
+TEST_CASE("sinks share the formatted text", "[shared_format]")
+{
+    auto n_formats = std::make_shared<size_t>(0);
+    std::ostringstream oss1, oss2, oss3;
+    auto sink1 = std::make_shared<spdlog::sinks::ostream_sink_st>(oss1);
+    auto sink2 = std::make_shared<spdlog::sinks::ostream_sink_st>(oss2);
+    auto sink3 = std::make_shared<spdlog::sinks::ostream_sink_st>(oss3);
+    sink1->set_formatter(spdlog::details::make_unique<counting_formatter>("a", n_formats));
+    sink2->set_formatter(spdlog::details::make_unique<counting_formatter>("b", n_formats));
+    sink3->set_formatter(spdlog::details::make_unique<counting_formatter>("a", n_formats));
+
+    spdlog::logger logger("test", {sink1, sink3, sink2});
+    logger.info("message {}", 1);
+    // formatted once for sink1 and sink3, once for sink2
+    REQUIRE(*n_formats == 2);
+    REQUIRE(oss1.str() == "a message 1\n");
+    REQUIRE(oss2.str() == "b message 1\n");
+    REQUIRE(oss3.str() == "a message 1\n");
+
+    // sinks below the message level are skipped
+    sink1->set_level(spdlog::level::err);
+    logger.info("message {}", 2);
+    REQUIRE(*n_formats == 4);
+    REQUIRE(oss1.str() == "a message 1\n");
+    REQUIRE(oss3.str() == "a message 1\na message 2\n");
+
+    // only the text of the previous sink is kept
+    sink1->set_level(spdlog::level::trace);
+    logger.sinks() = {sink1, sink2, sink3};
+    logger.info("message {}", 3);
+    REQUIRE(*n_formats == 7);
+    REQUIRE(oss3.str() == "a message 1\na message 2\na message 3\n");
+}
+
+TEST_CASE("sinks share the formatted text - patterns", "[shared_format]")
+{
+    std::ostringstream oss1, oss2, oss3;
+    auto sink1 = std::make_shared<spdlog::sinks::ostream_sink_mt>(oss1);
+    auto sink2 = std::make_shared<spdlog::sinks::ostream_sink_mt>(oss2);
+    auto dist = std::make_shared<spdlog::sinks::dist_sink_mt>();
+    auto sink3 = std::make_shared<spdlog::sinks::ostream_sink_mt>(oss3);
+    dist->add_sink(sink3);
+
+    spdlog::logger logger("test", {sink1, sink2, dist});
+    logger.set_pattern("[%n] [%l] %v");
+    sink2->set_pattern("%v");
+    logger.info("message");
+    logger.warn("with {}", "args");
+    REQUIRE(oss1.str() == fmt::format("[test] [info] message{0}[test] [warning] with args{0}", spdlog::details::os::default_eol));
+    REQUIRE(oss2.str() == fmt::format("message{0}with args{0}", spdlog::details::os::default_eol));
+    REQUIRE(oss3.str() == oss1.str());
+}
+
+#ifndef _WIN32
+TEST_CASE("dist_sink parallel", "[dist_sink]")
+{
+    auto dist = std::make_shared<spdlog::sinks::dist_sink_parallel>();
+    auto sink1 = std::make_shared<spdlog::sinks::test_sink_mt>();
+    auto sink2 = std::make_shared<spdlog::sinks::test_sink_mt>();
+    dist->add_sink(sink1);
+    spdlog::logger logger("dist", dist);
+
+    // the sinks change while the threads log
+    const size_t n_threads = 4, n_messages = 2000;
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < n_threads; t++)
+    {
+        threads.emplace_back([&logger] {
+            for (size_t i = 0; i < n_messages; i++)
+            {
+                logger.info("message {}", i);
+            }
+        });
+    }
+    for (int i = 0; i < 100; i++)
+    {
+        dist->add_sink(sink2);
+        dist->remove_sink(sink2);
+    }
+    for (auto &t : threads)
+    {
+        t.join();
+    }
+    REQUIRE(sink1->msg_counter() == n_threads * n_messages);
+    REQUIRE(sink2->msg_counter() <= n_threads * n_messages);
+    REQUIRE(dist->sinks().size() == 1);
+
+    dist->set_sinks({sink2});
+    logger.info("last");
+    REQUIRE(sink1->msg_counter() == n_threads * n_messages);
+    REQUIRE(dist->sinks() == std::vector<spdlog::sink_ptr>{sink2});
+    REQUIRE_FALSE(std::is_same<spdlog::sinks::dist_sink_parallel, spdlog::sinks::dist_sink_st>::value);
+}
+
+TEST_CASE("sinks share the formatted text - color range", "[shared_format]")
+{
+    // the shared text keeps its color range, whatever other sinks formatted in between
+    std::ostringstream oss1, oss2;
+    auto colored = std::make_shared<spdlog::sinks::ostream_sink_st>(oss1);
+    auto plain = std::make_shared<spdlog::sinks::ostream_sink_st>(oss2);
+    FILE *file = std::tmpfile();
+    REQUIRE(file != nullptr);
+    auto color_sink = std::make_shared<spdlog::sinks::ansicolor_sink<spdlog::details::console_nullmutex>>(file, spdlog::color_mode::always);
+
+    colored->set_pattern("[%^%l%$] %v");
+    plain->set_pattern("%v");
+    color_sink->set_pattern("%v");
+    spdlog::logger logger("test", {plain, colored, color_sink});
+    logger.info("message");
+
+    std::fflush(file);
+    std::rewind(file);
+    char buf[64] = {0};
+    auto n = std::fread(buf, 1, sizeof(buf) - 1, file);
+    std::fclose(file);
+    REQUIRE(std::string(buf, n) == fmt::format("message{}", spdlog::details::os::default_eol));
+    REQUIRE(oss1.str() == fmt::format("[info] message{}", spdlog::details::os::default_eol));
+}
+#endif
+
+TEST_CASE("log_formatted", "[log_formatted]")
+{
+    spdlog::details::log_msg msg("test", spdlog::level::info, "message");
+    spdlog::string_view_t formatted("formatted upstream\n");
+
+    // sinks writing the text as is write the given bytes
+    std::ostringstream oss;
+    auto oss_sink = std::make_shared<spdlog::sinks::ostream_sink_st>(oss);
+    oss_sink->set_pattern("%v");
+    oss_sink->log_formatted(msg, formatted);
+    REQUIRE(oss.str() == "formatted upstream\n");
+
+    // others format the message themselves
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_st>();
+    test_sink->set_pattern("%v");
+    test_sink->log_formatted(msg, formatted);
+    REQUIRE(test_sink->lines() == std::vector<std::string>{"message"});
+}
+
+TEST_CASE("parallel format", "[parallel_format]")
+{
+    std::ostringstream oss;
+    auto sink = std::make_shared<spdlog::sinks::ostream_sink_mt>(oss);
+    sink->set_pattern("%v");
+    sink->set_parallel_format(true);
+    spdlog::logger logger("test", sink);
+
+    const size_t n_threads = 4, n_messages = 1000;
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < n_threads; t++)
+    {
+        threads.emplace_back([&logger, t] {
+            for (size_t i = 0; i < n_messages; i++)
+            {
+                logger.info("message {} {}", t, i);
+            }
+        });
+    }
+    for (auto &t : threads)
+    {
+        t.join();
+    }
+    std::istringstream lines(oss.str());
+    std::string line;
+    size_t n_lines = 0;
+    while (std::getline(lines, line))
+    {
+        REQUIRE(line.compare(0, 8, "message ") == 0);
+        n_lines++;
+    }
+    REQUIRE(n_lines == n_threads * n_messages);
+
+    // the clones follow the formatter changes
+    oss.str("");
+    sink->set_pattern("[%n] %v");
+    logger.info("changed");
+    sink->set_parallel_format(false);
+    logger.info("locked");
+    REQUIRE(oss.str() == fmt::format("[test] changed{0}[test] locked{0}", spdlog::details::os::default_eol));
+}
+
+static spdlog::trace_context test_trace_context()
+{
+    spdlog::trace_context context{};
+    for (size_t i = 0; i < sizeof(context.trace_id); i++)
+    {
+        context.trace_id[i] = static_cast<uint8_t>(i + 1);
+    }
+    for (size_t i = 0; i < sizeof(context.span_id); i++)
+    {
+        context.span_id[i] = static_cast<uint8_t>(0xa0 + i);
+    }
+    return context;
+}
+
+TEST_CASE("trace context", "[trace_context]")
+{
+    const std::string trace_id = "0102030405060708090a0b0c0d0e0f10";
+    const std::string span_id = "a0a1a2a3a4a5a6a7";
+    auto sink = std::make_shared<spdlog::sinks::test_sink_st>();
+    spdlog::logger logger("trace", sink);
+    logger.set_pattern("%Q|%q|%v");
+
+    REQUIRE(spdlog::get_trace_context().empty());
+    logger.info("before");
+    {
+        spdlog::scoped_trace_context trace(test_trace_context());
+        REQUIRE_FALSE(spdlog::get_trace_context().empty());
+        logger.info("traced");
+        // other threads have their own context
+        std::thread([&logger] { logger.info("other thread"); }).join();
+        {
+            spdlog::trace_context nested{};
+            nested.span_id[7] = 1;
+            spdlog::scoped_trace_context nested_trace(nested);
+            logger.info("nested");
+        }
+        logger.info("restored");
+    }
+    logger.info("after");
+
+    logger.set_pattern("[%40Q]");
+    spdlog::set_trace_context(test_trace_context());
+    logger.info("padded");
+    spdlog::clear_trace_context();
+    logger.info("padded");
+
+    REQUIRE(sink->lines() == std::vector<std::string>{"||before", trace_id + "|" + span_id + "|traced", "||other thread",
+                                 "00000000000000000000000000000000|0000000000000001|nested", trace_id + "|" + span_id + "|restored",
+                                 "||after", "[        " + trace_id + "]", "[                                        ]"});
+}
+
+TEST_CASE("trace context json and async", "[trace_context]")
+{
+    auto sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    sink->set_formatter(spdlog::details::make_unique<spdlog::json_formatter>());
+    spdlog::details::thread_pool_options options;
+    options.queue_backend = spdlog::details::async_queue_backend::arena;
+    auto tp = std::make_shared<spdlog::details::thread_pool>(128, 1, options);
+    auto logger = std::make_shared<spdlog::async_logger>("trace", sink, tp);
+    {
+        spdlog::scoped_trace_context trace(test_trace_context());
+        logger->info("traced");
+    }
+    logger->info("untraced");
+    logger.reset();
+    tp.reset();
+
+    auto lines = sink->lines();
+    REQUIRE(lines.size() == 2);
+    REQUIRE(lines[0].find(R"(,"trace_id":"0102030405060708090a0b0c0d0e0f10","span_id":"a0a1a2a3a4a5a6a7","message":"traced"})") !=
+            std::string::npos);
+    REQUIRE(lines[1].find("trace_id") == std::string::npos);
+}
+
+TEST_CASE("mdc", "[mdc]")
+{
+    auto sink = std::make_shared<spdlog::sinks::test_sink_st>();
+    spdlog::logger logger("mdc", sink);
+    logger.set_pattern("[%&] %v");
+
+    logger.info("empty");
+    spdlog::mdc::put("user", 42);
+    spdlog::mdc::put("name", std::string("bob"));
+    logger.info("two");
+    // replaced in place
+    spdlog::mdc::put("user", "alice");
+    REQUIRE(spdlog::mdc::size() == 2);
+    REQUIRE(spdlog::mdc::get("user")->string_value == "alice");
+    REQUIRE(spdlog::mdc::get("missing") == nullptr);
+    {
+        spdlog::mdc::scoped_put request("request", 1.5);
+        logger.info("scoped");
+        // other threads have their own context
+        std::thread([&logger] { logger.info("other thread"); }).join();
+    }
+    REQUIRE(spdlog::mdc::remove("name"));
+    REQUIRE_FALSE(spdlog::mdc::remove("name"));
+    logger.info("removed");
+    logger.set_pattern("[%-12&]");
+    logger.info("padded");
+    spdlog::mdc::clear();
+    logger.info("cleared");
+
+    REQUIRE(sink->lines() == std::vector<std::string>{"[] empty", "[user=42 name=bob] two", "[user=alice name=bob request=1.5] scoped",
+                                 "[] other thread", "[user=alice] removed", "[user=alice  ]", "[            ]"});
+}
+
+TEST_CASE("mdc json and async", "[mdc]")
+{
+    using spdlog::details::async_queue_backend;
+    for (auto backend : {async_queue_backend::blocking, async_queue_backend::arena})
+    {
+        auto sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+        sink->set_formatter(spdlog::details::make_unique<spdlog::json_formatter>());
+        spdlog::details::thread_pool_options options;
+        options.queue_backend = backend;
+        auto tp = std::make_shared<spdlog::details::thread_pool>(128, 1, options);
+        auto logger = std::make_shared<spdlog::async_logger>("mdc", sink, tp);
+        {
+            spdlog::mdc::scoped_put user("user", std::string(100, 'u'));
+            spdlog::mdc::scoped_put id("id", 7);
+            logger->info("with context", spdlog::kv("k", "v"));
+        }
+        logger->info("without context");
+        logger.reset();
+        tp.reset();
+
+        auto lines = sink->lines();
+        REQUIRE(lines.size() == 2);
+        auto expected = R"(,"k":"v","mdc":{"user":")" + std::string(100, 'u') + R"(","id":7},"message":"with context"})";
+        REQUIRE(lines[0].find(expected) != std::string::npos);
+        REQUIRE(lines[1].find("\"mdc\":") == std::string::npos);
+    }
+}
+
+TEST_CASE("sampling", "[sampling]")
+{
+    auto sink = std::make_shared<spdlog::sinks::test_sink_st>();
+    spdlog::logger logger("sampling", sink);
+    logger.set_pattern("%w %v");
+    logger.set_level(spdlog::level::trace);
+    logger.set_sample_rate(10);
+    REQUIRE(logger.sample_rate() == 10);
+
+    for (int i = 0; i < 10000; i++)
+    {
+        logger.debug("debug {}", i);
+    }
+    auto n_sampled = sink->msg_counter();
+    REQUIRE(n_sampled > 700);
+    REQUIRE(n_sampled < 1300);
+    REQUIRE(sink->lines()[0].substr(0, 9) == "10 debug ");
+
+    // info and above are not sampled
+    logger.info("info");
+    logger.warn("warn");
+    REQUIRE(sink->msg_counter() == n_sampled + 2);
+
+    logger.set_sample_rate(1);
+    logger.trace("trace");
+    REQUIRE(sink->msg_counter() == n_sampled + 3);
+}
+
+TEST_CASE("max payload bytes", "[payload_cap]")
+{
+    auto sink = std::make_shared<spdlog::sinks::test_sink_st>();
+    spdlog::logger logger("capped", sink);
+    logger.set_pattern("%v");
+    logger.set_max_payload_bytes(20);
+    REQUIRE(logger.max_payload_bytes() == 20);
+
+    std::string big(100000, 'x');
+    logger.info("value: {}", big);
+    logger.info(big);
+    logger.info("short {}", 1);
+    // cut at a character boundary
+    std::string accents;
+    for (int i = 0; i < 10; i++)
+    {
+        accents += "\xc3\xa9";
+    }
+    logger.info("{}", std::string(5, 'a') + accents);
+    auto lines = sink->lines();
+    REQUIRE(lines[0] == "value:...[truncated]");
+    REQUIRE(lines[1] == "xxxxxx...[truncated]");
+    REQUIRE(lines[2] == "short 1");
+    REQUIRE(lines[3] == "aaaaa...[truncated]");
+    REQUIRE(logger.truncated_messages() == 3);
+
+    // deferred to the worker of an async logger
+    auto async_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    async_sink->set_pattern("%v");
+    auto tp = std::make_shared<spdlog::details::thread_pool>(16, 1);
+    auto async_logger = std::make_shared<spdlog::async_logger>("capped", async_sink, tp);
+    async_logger->set_deferred_formatting(true);
+    async_logger->set_max_payload_bytes(16);
+    async_logger->info("{:>30}", 1);
+    async_logger->flush_async().get();
+    REQUIRE(async_sink->lines()[0] == "  ...[truncated]");
+    REQUIRE(async_logger->truncated_messages() == 1);
+
+    // the buffer grows with the output, not to the cap
+    spdlog::memory_buf_t buf;
+    int one = 1;
+    REQUIRE_FALSE(spdlog::details::vformat_capped(buf, "short {}", fmt::make_format_args(one), 64 * 1024));
+    REQUIRE(std::string(buf.data(), buf.size()) == "short 1");
+    REQUIRE(buf.capacity() < 1024);
+    REQUIRE(spdlog::details::vformat_capped(buf, "value: {}", fmt::make_format_args(big), 20));
+    REQUIRE(std::string(buf.data(), buf.size()) == "value:...[truncated]");
+}
+
+TEST_CASE("profile stats", "[profile_stats]")
+{
+    auto sink = std::make_shared<spdlog::sinks::test_sink_st>();
+    auto err_sink = std::make_shared<spdlog::sinks::test_sink_st>();
+    err_sink->set_level(spdlog::level::err);
+    spdlog::logger logger("profile", {sink, err_sink});
+    logger.set_pattern("%v");
+
+    for (int i = 0; i < 10; i++)
+    {
+        logger.info("message {}", i);
+    }
+    logger.debug("filtered");
+    logger.error("error");
+    logger.flush();
+
+    auto stats = logger.profile_stats();
+    auto sink_stats = sink->profile_stats();
+    auto err_sink_stats = err_sink->profile_stats();
+#ifdef SPDLOG_ENABLE_STATS
+    REQUIRE(stats.messages == 12);
+    REQUIRE(stats.filtered == 1);
+    REQUIRE(stats.formatted_bytes == 10 * std::string("message 0").size());
+    REQUIRE(stats.flushes == 1);
+    REQUIRE(sink_stats.messages == 11);
+    REQUIRE(sink_stats.filtered == 0);
+    REQUIRE(sink_stats.formatted_bytes == 10 * std::string("message 0\n").size() + std::string("error\n").size());
+    REQUIRE(sink_stats.flushes == 1);
+    REQUIRE(err_sink_stats.messages == 1);
+    REQUIRE(err_sink_stats.filtered == 10);
+    REQUIRE(err_sink_stats.formatted_bytes == std::string("error\n").size());
+#else
+    REQUIRE(stats.messages == 0);
+    REQUIRE(sink_stats.messages == 0);
+    REQUIRE(sink_stats.sink_time.count() == 0);
+    REQUIRE(err_sink_stats.filtered == 0);
+#endif
+}
+
+TEST_CASE("memory accounting", "[memory_account]")
+{
+    auto used_before = spdlog::memory_used();
+    std::string long_payload(1000, 'x');
+    {
+        auto sink = std::make_shared<spdlog::sinks::ringbuffer_sink_st>(4);
+        spdlog::logger logger("memory", sink);
+        logger.enable_backtrace(4);
+        logger.info(long_payload);
+        logger.debug(long_payload);
+#ifndef SPDLOG_NO_TLS
+        REQUIRE(sink->memory_used() >= 1000);
+        REQUIRE(logger.backtrace_memory_used() >= 1000);
+#endif
+        REQUIRE(spdlog::memory_used() >= used_before + 2000);
+        REQUIRE(spdlog::memory_peak() >= spdlog::memory_used());
+
+        // overwritten by short messages
+        for (int i = 0; i < 4; i++)
+        {
+            logger.info("short");
+        }
+        REQUIRE(sink->memory_used() == 0);
+    }
+    REQUIRE(spdlog::memory_used() == used_before);
+
+    // over the budget the payload is cut to fit the inline buffer
+    auto sink = std::make_shared<spdlog::sinks::ringbuffer_sink_st>(4);
+    spdlog::logger logger("memory", sink);
+    auto truncated_before = spdlog::memory_truncated_messages();
+    spdlog::set_memory_budget(spdlog::memory_used() + 500);
+    logger.info(long_payload);
+    logger.info(std::string(200, 'y'));
+    spdlog::set_memory_budget(0);
+    logger.info(long_payload);
+
+    auto stored = sink->last_raw();
+    REQUIRE(stored.size() == 3);
+    REQUIRE(stored[0].payload.size() == SPDLOG_MSG_BUFFER_SIZE - std::string("memory").size());
+    REQUIRE(stored[1].payload.size() == 200);
+    REQUIRE(stored[2].payload.size() == 1000);
+    REQUIRE(spdlog::memory_truncated_messages() == truncated_before + 1);
+}
+
+// spdlog/fwd.h redeclares the types after their definitions here, which only compiles if the declarations match
+static spdlog::level::level_enum level_of(const spdlog::logger &logger)
+{
+    return logger.level();
+}
+
+TEST_CASE("fwd declarations", "[misc]")
+{
+    static_assert(std::is_same<std::underlying_type<spdlog::level::level_enum>::type, int>::value, "level_enum is declared with int");
+    spdlog::logger logger("fwd");
+    logger.set_level(spdlog::level::warn);
+    REQUIRE(level_of(logger) == spdlog::level::warn);
+}
+
+static std::string to_utf8(const std::wstring &wstr)
+{
+    std::string utf8(wstr.size() * spdlog::details::utf::max_utf8_per_wchar, '\0');
+    utf8.resize(spdlog::details::utf::wide_to_utf8(wstr.data(), wstr.size(), &utf8[0]));
+    return utf8;
+}
+
+static bool from_utf8(const std::string &utf8, std::wstring &wstr)
+{
+    wstr.resize(utf8.size());
+    size_t size = 0;
+    bool ok = spdlog::details::utf::utf8_to_wide(utf8.data(), utf8.size(), &wstr[0], size);
+    wstr.resize(size);
+    return ok;
+}
+
+TEST_CASE("utf8 conversion", "[misc]")
+{
+    // ascii runs, 2, 3 and 4 bytes (surrogate pair on windows) code points
+    std::wstring ascii(40, L'a');
+    std::wstring wstr = ascii + L"été 中文 \U0001F600" + ascii + L"!";
+    std::string utf8 = std::string(40, 'a') + "\xc3\xa9t\xc3\xa9 \xe4\xb8\xad\xe6\x96\x87 \xf0\x9f\x98\x80" + std::string(40, 'a') + "!";
+    REQUIRE(to_utf8(wstr) == utf8);
+    REQUIRE(to_utf8(std::wstring()).empty());
+
+    std::wstring back;
+    REQUIRE(from_utf8(utf8, back));
+    REQUIRE(back == wstr);
+
+    // unpaired surrogate
+    std::wstring lone(20, L'x');
+    lone[17] = static_cast<wchar_t>(0xd800);
+    REQUIRE(to_utf8(lone) == std::string(17, 'x') + "\xef\xbf\xbd" + "xx");
+
+    // truncated, overlong, surrogate and invalid lead bytes
+    for (auto invalid : {"\xe4\xb8", "\xc0\xaf", "\xed\xa0\x80", "\xff", "\xf4\x90\x80\x80"})
+    {
+        REQUIRE_FALSE(from_utf8(std::string(20, 'a') + invalid, back));
+    }
+}
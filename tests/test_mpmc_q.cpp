@@ -54,7 +54,7 @@ TEST_CASE("enqueue_nowait", "[mpmc_blocking_q]")
     REQUIRE(q.overrun_counter() == 0);
 
     auto start = test_clock::now();
-    q.enqueue_nowait(2);
+    REQUIRE(q.enqueue_nowait(2) == 1);
     auto delta_ms = millis_from(start);
 
     INFO("Delta " << delta_ms.count() << " millis");
@@ -62,6 +62,35 @@ TEST_CASE("enqueue_nowait", "[mpmc_blocking_q]")
     REQUIRE(q.overrun_counter() == 1);
 }
 
+TEST_CASE("try_enqueue", "[mpmc_blocking_q]")
+{
+    spdlog::details::mpmc_blocking_queue<int> q(1);
+    REQUIRE(q.try_enqueue(1));
+    REQUIRE_FALSE(q.try_enqueue(2));
+    REQUIRE(q.overrun_counter() == 0);
+    int i = 0;
+    REQUIRE(q.dequeue_for(i, milliseconds(0)));
+    REQUIRE(i == 1);
+    REQUIRE(q.enqueue_nowait(3) == 0);
+}
+
+TEST_CASE("enqueue_for", "[mpmc_blocking_q]")
+{
+    spdlog::details::mpmc_blocking_queue<int> q(1);
+    milliseconds wait_ms(50);
+    milliseconds tolerance_wait(250);
+    REQUIRE(q.enqueue_for(1, wait_ms));
+
+    auto start = test_clock::now();
+    REQUIRE_FALSE(q.enqueue_for(2, wait_ms));
+    auto delta_ms = millis_from(start);
+    INFO("Delta " << delta_ms.count() << " millis");
+    REQUIRE(delta_ms >= wait_ms - milliseconds(1));
+    REQUIRE(delta_ms <= wait_ms + tolerance_wait);
+    REQUIRE(q.overrun_counter() == 0);
+    REQUIRE(q.size() == 1);
+}
+
 TEST_CASE("bad_queue", "[mpmc_blocking_q]")
 {
     size_t q_size = 0;
@@ -104,3 +133,540 @@ TEST_CASE("full_queue", "[mpmc_blocking_q]")
     q.dequeue_for(item, milliseconds(0));
     REQUIRE(item == 123456);
 }
+
+TEST_CASE("load_factor", "[mpmc_blocking_q]")
+{
+    spdlog::details::mpmc_blocking_queue<int> q(100);
+    spdlog::details::mpmc_lockfree_queue<int> lockfree_q(128);
+    spdlog::details::spsc_lanes_queue<int> lanes_q(128);
+    std::vector<spdlog::details::async_queue<int> *> queues{&q, &lockfree_q, &lanes_q};
+    for (auto *queue : queues)
+    {
+        REQUIRE(queue->load_factor() == 0);
+        for (int i = 0; i < 64; i++)
+        {
+            queue->enqueue(i + 0);
+        }
+        REQUIRE(queue->load_factor() >= 0.5);
+        REQUIRE(queue->load_factor() < 0.7);
+        int items[64];
+        REQUIRE(queue->try_dequeue_bulk(items, 64) == 64);
+        REQUIRE(queue->load_factor() == 0);
+    }
+}
+
+TEST_CASE("lockfree_full_queue", "[mpmc_lockfree_q]")
+{
+    size_t q_size = 128; // power of 2 - capacity is exact
+    spdlog::details::mpmc_lockfree_queue<int> q(q_size);
+    REQUIRE(q.capacity() == q_size);
+    for (int i = 0; i < static_cast<int>(q_size); i++)
+    {
+        q.enqueue(i + 0);
+    }
+    REQUIRE(q.size() == q_size);
+    REQUIRE_FALSE(q.try_enqueue(-1));
+
+    q.enqueue_nowait(123456);
+    REQUIRE(q.overrun_counter() == 1);
+
+    for (int i = 1; i < static_cast<int>(q_size); i++)
+    {
+        int item = -1;
+        REQUIRE(q.dequeue_for(item, milliseconds(0)));
+        REQUIRE(item == i);
+    }
+
+    // last item pushed has overridden the oldest.
+    int item = -1;
+    REQUIRE(q.dequeue_for(item, milliseconds(0)));
+    REQUIRE(item == 123456);
+    REQUIRE(q.dequeue_for(item, milliseconds(10)) == false);
+}
+
+TEST_CASE("lockfree_multi_producers", "[mpmc_lockfree_q]")
+{
+    size_t q_size = 16;
+    int n_producers = 4;
+    int per_producer = 10000;
+    spdlog::details::mpmc_lockfree_queue<int> q(q_size);
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < n_producers; p++)
+    {
+        producers.emplace_back([&q, per_producer] {
+            for (int i = 1; i <= per_producer; i++)
+            {
+                q.enqueue(i + 0); // blocks while full
+            }
+        });
+    }
+
+    long long sum = 0;
+    int popped = 0;
+    while (popped < n_producers * per_producer)
+    {
+        int item = 0;
+        if (q.dequeue_for(item, milliseconds(1000)))
+        {
+            sum += item;
+            popped++;
+        }
+    }
+
+    for (auto &t : producers)
+    {
+        t.join();
+    }
+    REQUIRE(sum == static_cast<long long>(n_producers) * per_producer * (per_producer + 1) / 2);
+    REQUIRE(q.size() == 0);
+    REQUIRE(q.overrun_counter() == 0);
+}
+
+TEST_CASE("lanes_per_thread_order", "[spsc_lanes_q]")
+{
+    size_t q_size = 1024;
+    int n_producers = 4;
+    int per_producer = 1000;
+    // items are encoded as producer * per_producer + seq, ordered by seq when merged
+    struct by_seq
+    {
+        int per_producer;
+        bool operator()(int lhs, int rhs) const
+        {
+            return lhs % per_producer < rhs % per_producer;
+        }
+    };
+    spdlog::details::spsc_lanes_queue<int, by_seq> q(q_size, by_seq{per_producer});
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < n_producers; p++)
+    {
+        producers.emplace_back([&q, p, per_producer] {
+            for (int i = 0; i < per_producer; i++)
+            {
+                q.enqueue(p * per_producer + i);
+            }
+        });
+    }
+    for (auto &t : producers)
+    {
+        t.join();
+    }
+    REQUIRE(q.lanes_count() == static_cast<size_t>(n_producers));
+    REQUIRE(q.size() == static_cast<size_t>(n_producers * per_producer));
+
+    std::vector<int> last_seq(static_cast<size_t>(n_producers), -1);
+    int prev_seq = -1;
+    for (int i = 0; i < n_producers * per_producer; i++)
+    {
+        int item = -1;
+        REQUIRE(q.dequeue_for(item, milliseconds(0)));
+        int producer = item / per_producer;
+        int seq = item % per_producer;
+        // each lane is fifo, and the lanes are merged by the given order
+        REQUIRE(seq == last_seq[static_cast<size_t>(producer)] + 1);
+        REQUIRE(seq >= prev_seq);
+        last_seq[static_cast<size_t>(producer)] = seq;
+        prev_seq = seq;
+    }
+    int item = -1;
+    REQUIRE(q.dequeue_for(item, milliseconds(10)) == false);
+}
+
+#ifndef SPDLOG_NO_TLS
+TEST_CASE("lanes_retired", "[spsc_lanes_q]")
+{
+    spdlog::details::spsc_lanes_queue<int> q(16);
+    for (int round = 0; round < 3; round++)
+    {
+        std::vector<std::thread> producers;
+        for (int p = 0; p < 4; p++)
+        {
+            producers.emplace_back([&q, p] { q.enqueue(p + 0); });
+        }
+        for (auto &t : producers)
+        {
+            t.join();
+        }
+        REQUIRE(q.lanes_count() == 4);
+        // the lanes of the exited threads are freed once drained
+        int item = -1;
+        for (int i = 0; i < 4; i++)
+        {
+            REQUIRE(q.dequeue_for(item, milliseconds(0)));
+        }
+        REQUIRE(q.dequeue_for(item, milliseconds(0)) == false);
+        REQUIRE(q.lanes_count() == 0);
+    }
+    // a live producer keeps its lane
+    q.enqueue(1);
+    int item = -1;
+    REQUIRE(q.dequeue_for(item, milliseconds(0)));
+    REQUIRE(q.dequeue_for(item, milliseconds(0)) == false);
+    REQUIRE(q.lanes_count() == 1);
+    q.enqueue(2);
+    REQUIRE(q.dequeue_for(item, milliseconds(0)));
+    REQUIRE(item == 2);
+}
+
+// enqueues from a thread local destructor run after the lanes were retired
+static spdlog::details::spsc_lanes_queue<int> *exit_queue = nullptr;
+struct enqueue_on_exit
+{
+    ~enqueue_on_exit()
+    {
+        exit_queue->enqueue(2);
+    }
+};
+
+TEST_CASE("lanes_enqueue_at_thread_exit", "[spsc_lanes_q]")
+{
+    spdlog::details::spsc_lanes_queue<int> q(16);
+    exit_queue = &q;
+    std::thread([&q] {
+        // constructed before the lane owner of the thread: destroyed after it
+        thread_local enqueue_on_exit on_exit;
+        (void)on_exit;
+        q.enqueue(1);
+    }).join();
+    // the retired lane isn't used anymore: a lane of its own, kept
+    REQUIRE(q.lanes_count() == 2);
+    int item = -1;
+    REQUIRE(q.dequeue_for(item, milliseconds(0)));
+    REQUIRE(item == 1);
+    REQUIRE(q.dequeue_for(item, milliseconds(0)));
+    REQUIRE(item == 2);
+    REQUIRE(q.dequeue_for(item, milliseconds(0)) == false);
+    REQUIRE(q.lanes_count() == 1);
+    exit_queue = nullptr;
+}
+#endif
+
+TEST_CASE("lanes_overrun", "[spsc_lanes_q]")
+{
+    spdlog::details::spsc_lanes_queue<int> q(4);
+    for (int i = 0; i < 10; i++)
+    {
+        q.enqueue_nowait(i + 0);
+    }
+    REQUIRE(q.overrun_counter() == 6);
+    int item = -1;
+    REQUIRE(q.dequeue_for(item, milliseconds(0)));
+    REQUIRE(item == 6);
+}
+
+TEST_CASE("try_dequeue_bulk", "[mpmc_blocking_q]")
+{
+    spdlog::details::mpmc_blocking_queue<int> q(10);
+    int items[4];
+    REQUIRE(q.try_dequeue_bulk(items, 4) == 0);
+    for (int i = 0; i < 6; i++)
+    {
+        q.enqueue(std::move(i));
+    }
+    REQUIRE(q.try_dequeue_bulk(items, 4) == 4);
+    REQUIRE(items[0] == 0);
+    REQUIRE(items[3] == 3);
+    REQUIRE(q.try_dequeue_bulk(items, 4) == 2);
+    REQUIRE(items[1] == 5);
+    REQUIRE(q.try_dequeue_bulk(items, 4) == 0);
+}
+
+struct string_arena_codec
+{
+    static size_t encoded_size(const std::string &s)
+    {
+        return sizeof(size_t) + s.size();
+    }
+    static void encode(char *dest, std::string &&s)
+    {
+        size_t n = s.size();
+        std::memcpy(dest, &n, sizeof(n));
+        std::memcpy(dest + sizeof(n), s.data(), n);
+    }
+    static void decode(char *src, std::string &s)
+    {
+        size_t n;
+        std::memcpy(&n, src, sizeof(n));
+        s.assign(src + sizeof(n), n);
+    }
+    static void discard(char *) {}
+    static bool overrunnable(const char *)
+    {
+        return true;
+    }
+};
+
+TEST_CASE("arena_variable_records", "[mpmc_arena_q]")
+{
+    spdlog::details::mpmc_arena_queue<std::string, string_arena_codec> q(1024);
+    REQUIRE(q.used_bytes() == 0);
+    q.enqueue(std::string("short"));
+    q.enqueue(std::string(500, 'x'));
+    REQUIRE(q.size() == 2);
+    // each record takes about its own size, not a fixed slot
+    REQUIRE(q.used_bytes() < 600);
+    REQUIRE(q.load_factor() == static_cast<double>(q.used_bytes()) / 1024);
+
+    std::string item;
+    REQUIRE(q.dequeue_for(item, milliseconds(0)));
+    REQUIRE(item == "short");
+    REQUIRE(q.dequeue_for(item, milliseconds(0)));
+    REQUIRE(item == std::string(500, 'x'));
+    REQUIRE_FALSE(q.dequeue_for(item, milliseconds(0)));
+
+    REQUIRE_THROWS_AS(q.enqueue(std::string(2000, 'x')), spdlog::spdlog_ex);
+}
+
+TEST_CASE("arena_wrap_around", "[mpmc_arena_q]")
+{
+    spdlog::details::mpmc_arena_queue<std::string, string_arena_codec> q(256);
+    std::string item;
+    for (int i = 0; i < 100; i++)
+    {
+        q.enqueue(std::to_string(i) + std::string(static_cast<size_t>(i % 40), '-'));
+        q.enqueue(std::to_string(i + 1000));
+        REQUIRE(q.dequeue_for(item, milliseconds(0)));
+        REQUIRE(item == std::to_string(i) + std::string(static_cast<size_t>(i % 40), '-'));
+        REQUIRE(q.dequeue_for(item, milliseconds(0)));
+        REQUIRE(item == std::to_string(i + 1000));
+    }
+    REQUIRE(q.size() == 0);
+    REQUIRE(q.overrun_counter() == 0);
+}
+
+TEST_CASE("arena_reserve_commit", "[mpmc_arena_q]")
+{
+    spdlog::details::mpmc_arena_queue<std::string, string_arena_codec> q(256);
+    std::string item;
+    char *first = q.reserve_record(64);
+    q.enqueue(std::string("second"));
+    // the consumers wait for the oldest record to be committed
+    REQUIRE_FALSE(q.dequeue_for(item, milliseconds(0)));
+    // and the overruns wait for it too
+    std::thread overrun([&q] {
+        for (int i = 0; i < 10; i++)
+        {
+            q.enqueue_nowait(std::string("x"));
+        }
+    });
+    std::this_thread::sleep_for(milliseconds(10));
+    string_arena_codec::encode(first, std::string("first"));
+    q.commit_record(first);
+    overrun.join();
+    REQUIRE(q.overrun_counter() > 0);
+
+    std::vector<std::string> items(20);
+    size_t n = q.try_dequeue_bulk(items.data(), items.size());
+    REQUIRE(n + q.overrun_counter() == 12);
+    REQUIRE(items[n - 1] == "x");
+    char *cancelled = q.try_reserve_record(16);
+    REQUIRE(cancelled != nullptr);
+    q.enqueue(std::string("after"));
+    q.cancel_record(cancelled);
+    REQUIRE(q.dequeue_for(item, milliseconds(0)));
+    REQUIRE(item == "after");
+    REQUIRE(q.size() == 0);
+
+    REQUIRE(q.max_record_size() < 256);
+    REQUIRE_THROWS_AS(q.reserve_record(256), spdlog::spdlog_ex);
+    REQUIRE(q.reserve_record_for(q.max_record_size(), milliseconds(1)) != nullptr);
+    REQUIRE(q.try_reserve_record(16) == nullptr);
+    REQUIRE(q.reserve_record_for(16, milliseconds(1)) == nullptr);
+}
+
+TEST_CASE("arena_overrun", "[mpmc_arena_q]")
+{
+    spdlog::details::mpmc_arena_queue<std::string, string_arena_codec> q(256);
+    for (int i = 0; i < 100; i++)
+    {
+        q.enqueue_nowait(std::to_string(i));
+    }
+    REQUIRE(q.overrun_counter() > 0);
+    REQUIRE(q.size() + q.overrun_counter() == 100);
+    std::string item;
+    std::vector<std::string> items(200);
+    size_t n = q.try_dequeue_bulk(items.data(), items.size());
+    REQUIRE(n == 100 - q.overrun_counter());
+    REQUIRE(items[n - 1] == "99");
+}
+
+// an item the queues must not overrun if control is set
+struct control_item
+{
+    int value;
+    bool control;
+};
+
+namespace spdlog {
+namespace details {
+template<>
+struct async_queue_item<control_item>
+{
+    static bool overrunnable(const control_item &item)
+    {
+        return !item.control;
+    }
+};
+} // namespace details
+} // namespace spdlog
+
+struct control_item_order
+{
+    bool operator()(const control_item &lhs, const control_item &rhs) const
+    {
+        return lhs.value < rhs.value;
+    }
+};
+
+struct control_item_codec
+{
+    static size_t encoded_size(const control_item &)
+    {
+        return sizeof(control_item);
+    }
+    static void encode(char *dest, control_item &&item)
+    {
+        std::memcpy(dest, &item, sizeof(item));
+    }
+    static void decode(char *src, control_item &item)
+    {
+        std::memcpy(&item, src, sizeof(item));
+    }
+    static void discard(char *) {}
+    static bool overrunnable(const char *src)
+    {
+        control_item item;
+        std::memcpy(&item, src, sizeof(item));
+        return !item.control;
+    }
+};
+
+static std::vector<int> dequeue_values(spdlog::details::async_queue<control_item> &q)
+{
+    std::vector<control_item> items(16);
+    auto n = q.try_dequeue_bulk(items.data(), items.size());
+    std::vector<int> values;
+    for (size_t i = 0; i < n; i++)
+    {
+        values.push_back(items[i].control ? -items[i].value : items[i].value);
+    }
+    return values;
+}
+
+TEST_CASE("overrun_keeps_control_items", "[mpmc_blocking_q]")
+{
+    spdlog::details::mpmc_blocking_queue<control_item> q(3);
+    q.enqueue(control_item{1, false});
+    q.enqueue(control_item{2, true});
+    q.enqueue(control_item{3, false});
+    REQUIRE(q.enqueue_nowait(control_item{4, false}) == 1);
+    REQUIRE(q.enqueue_nowait(control_item{5, false}) == 1);
+    REQUIRE(q.overrun_counter() == 2);
+    REQUIRE(dequeue_values(q) == std::vector<int>{-2, 4, 5});
+}
+
+TEST_CASE("lockfree_overrun_keeps_control_items", "[mpmc_lockfree_q]")
+{
+    spdlog::details::mpmc_lockfree_queue<control_item> q(4);
+    q.enqueue(control_item{1, true});
+    q.enqueue(control_item{2, false});
+    q.enqueue(control_item{3, false});
+    q.enqueue(control_item{4, false});
+    // the control item is queued again, behind the newer ones
+    REQUIRE(q.enqueue_nowait(control_item{5, false}) == 1);
+    REQUIRE(dequeue_values(q) == std::vector<int>{3, 4, -1, 5});
+}
+
+TEST_CASE("lanes_overrun_keeps_control_items", "[spsc_lanes_q]")
+{
+    spdlog::details::spsc_lanes_queue<control_item, control_item_order> q(4);
+    q.enqueue(control_item{1, true});
+    q.enqueue(control_item{2, false});
+    q.enqueue(control_item{3, false});
+    q.enqueue(control_item{4, false});
+    REQUIRE(q.enqueue_nowait(control_item{5, false}) == 1);
+    REQUIRE(dequeue_values(q) == std::vector<int>{-1, 3, 4, 5});
+}
+
+TEST_CASE("arena_overrun_keeps_control_items", "[mpmc_arena_q]")
+{
+    spdlog::details::mpmc_arena_queue<control_item, control_item_codec> q(256);
+    q.enqueue(control_item{0, true});
+    // waits for the control item to be dequeued, then overruns the others
+    std::thread producer([&q] {
+        for (int i = 1; i <= 100; i++)
+        {
+            q.enqueue_nowait(control_item{i, false});
+        }
+    });
+    control_item item{};
+    REQUIRE(q.dequeue_for(item, milliseconds(10000)));
+    REQUIRE(item.control);
+    producer.join();
+    REQUIRE(q.overrun_counter() > 0);
+    auto values = dequeue_values(q);
+    REQUIRE(values.back() == 100);
+}
+
+TEST_CASE("circular_q_capacity", "[circular_q]")
+{
+    // not a power of two: still holds exactly 3 items
+    spdlog::details::circular_q<int> q(3);
+    REQUIRE(q.empty());
+    for (int i = 0; i < 1000; i++)
+    {
+        q.push_back(i + 0);
+        REQUIRE(q.size() == static_cast<size_t>(std::min(i + 1, 3)));
+    }
+    REQUIRE(q.full());
+    REQUIRE(q.overrun_counter() == 997);
+    REQUIRE(q.at(0) == 997);
+    REQUIRE(q.at(2) == 999);
+
+    q.pop_front();
+    REQUIRE_FALSE(q.full());
+    REQUIRE(q.front() == 998);
+
+    spdlog::details::circular_q<int> moved(std::move(q));
+    REQUIRE(moved.size() == 2);
+    REQUIRE(q.size() == 0);
+    q.push_back(1); // disabled
+    REQUIRE(q.empty());
+}
+
+TEST_CASE("page_backed_queues", "[page_memory]")
+{
+    spdlog::details::page_options pages;
+    pages.huge_pages = true; // transparent huge pages, or plain pages, if no huge page is reserved
+    pages.prefault = true;
+    pages.lock = true;
+
+    spdlog::details::mpmc_blocking_queue<int> blocking_q(1000, pages);
+    spdlog::details::mpmc_lockfree_queue<int> lockfree_q(1000, pages);
+    spdlog::details::mpmc_arena_queue<std::string, string_arena_codec> arena_q(4096, pages);
+    for (int i = 0; i < 1500; i++)
+    {
+        blocking_q.enqueue_nowait(i + 0);
+        lockfree_q.enqueue_nowait(i + 0);
+    }
+    arena_q.enqueue(std::string("hello"));
+    REQUIRE(blocking_q.size() == 1000);
+    REQUIRE(blocking_q.overrun_counter() == 500);
+    int item = 0;
+    REQUIRE(blocking_q.dequeue_for(item, milliseconds::zero()));
+    REQUIRE(item == 500);
+    REQUIRE(lockfree_q.size() == 1024);
+    REQUIRE(lockfree_q.dequeue_for(item, milliseconds::zero()));
+    std::string s;
+    REQUIRE(arena_q.dequeue_for(s, milliseconds::zero()));
+    REQUIRE(s == "hello");
+
+    // moved with its pages
+    spdlog::details::circular_q<std::string> q(3, pages);
+    q.push_back("a");
+    spdlog::details::circular_q<std::string> moved;
+    moved = std::move(q);
+    REQUIRE(moved.front() == "a");
+}
@@ -0,0 +1,117 @@
+#include "includes.h"
+
+#ifndef _WIN32
+#    include "spdlog/sinks/nonblocking_fd_sink.h"
+
+#    include <fcntl.h>
+#    include <unistd.h>
+
+using spdlog::sinks::nonblocking_fd_sink_config;
+using spdlog::sinks::nonblocking_fd_sink_mt;
+
+struct test_pipe
+{
+    int fds[2];
+
+    test_pipe()
+    {
+        REQUIRE(::pipe(fds) == 0);
+        int flags = ::fcntl(fds[0], F_GETFL);
+        REQUIRE(::fcntl(fds[0], F_SETFL, flags | O_NONBLOCK) == 0);
+    }
+
+    ~test_pipe()
+    {
+        ::close(fds[0]);
+        ::close(fds[1]);
+    }
+
+    // read what is in the pipe
+    std::string drain()
+    {
+        std::string data;
+        char buf[4096];
+        ssize_t n;
+        while ((n = ::read(fds[0], buf, sizeof(buf))) > 0)
+        {
+            data.append(buf, static_cast<size_t>(n));
+        }
+        return data;
+    }
+};
+
+TEST_CASE("nonblocking_fd_sink writes", "[nonblocking_fd_sink]")
+{
+    test_pipe p;
+    int waits = 0;
+    auto sink = std::make_shared<nonblocking_fd_sink_mt>(nonblocking_fd_sink_config(p.fds[1], [&waits](int) { waits++; }));
+    sink->set_pattern("%v");
+    spdlog::logger logger("nonblocking", sink);
+
+    logger.info("hello");
+    logger.info("world");
+    REQUIRE(p.drain() == fmt::format("hello{}world{}", spdlog::details::os::default_eol, spdlog::details::os::default_eol));
+    REQUIRE(sink->pending_bytes() == 0);
+    REQUIRE(waits == 0);
+}
+
+TEST_CASE("nonblocking_fd_sink outbox", "[nonblocking_fd_sink]")
+{
+    test_pipe p;
+    int waits = 0;
+    auto sink = std::make_shared<nonblocking_fd_sink_mt>(nonblocking_fd_sink_config(p.fds[1], [&waits](int) { waits++; }));
+    sink->set_pattern("%v");
+    spdlog::logger logger("nonblocking", sink);
+
+    // more than the pipe takes: the rest waits in the outbox, logging never blocks
+    const int n_msgs = 10000;
+    std::string expected;
+    for (int i = 0; i < n_msgs; i++)
+    {
+        logger.info("message {:060}", i);
+        expected += fmt::format("message {:060}{}", i, spdlog::details::os::default_eol);
+    }
+    logger.flush();
+    REQUIRE(sink->pending_bytes() > 0);
+    REQUIRE(waits == 1);
+
+    // the event loop: read, then writable again
+    std::string received;
+    while (true)
+    {
+        received += p.drain();
+        if (sink->on_writable())
+        {
+            break;
+        }
+    }
+    received += p.drain();
+    REQUIRE(received == expected);
+    REQUIRE(sink->pending_bytes() == 0);
+    REQUIRE(sink->dropped_messages() == 0);
+    REQUIRE(waits > 1);
+}
+
+TEST_CASE("nonblocking_fd_sink full outbox", "[nonblocking_fd_sink]")
+{
+    test_pipe p;
+    nonblocking_fd_sink_config config(p.fds[1], [](int) {});
+    config.max_outbox_size = 1000;
+    auto sink = std::make_shared<nonblocking_fd_sink_mt>(config);
+    sink->set_pattern("%v");
+    spdlog::logger logger("nonblocking", sink);
+
+    for (int i = 0; i < 10000; i++)
+    {
+        logger.info("message {:060}", i);
+    }
+    REQUIRE(sink->pending_bytes() <= 1000);
+    REQUIRE(sink->dropped_messages() > 0);
+}
+
+TEST_CASE("nonblocking_fd_sink errors", "[nonblocking_fd_sink]")
+{
+    REQUIRE_THROWS_AS(nonblocking_fd_sink_mt(nonblocking_fd_sink_config(-1, nullptr)), spdlog::spdlog_ex);
+}
+
+#endif
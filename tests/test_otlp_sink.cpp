@@ -0,0 +1,244 @@
+#include "includes.h"
+
+#ifndef _WIN32
+#    include "spdlog/sinks/otlp_sink.h"
+#    include "http_test_server.h"
+
+#    include <map>
+
+// the fields of a protobuf message: field number => values (the bytes of the length delimited ones, the varints
+// and fixed64 as their decimal value)
+static std::multimap<int, std::string> parse_message(const std::string &data)
+{
+    std::multimap<int, std::string> fields;
+    size_t pos = 0;
+    auto varint = [&] {
+        uint64_t value = 0;
+        for (int shift = 0; pos < data.size(); shift += 7)
+        {
+            auto byte = static_cast<uint8_t>(data[pos++]);
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0)
+            {
+                break;
+            }
+        }
+        return value;
+    };
+    while (pos < data.size())
+    {
+        auto tag = varint();
+        auto field_number = static_cast<int>(tag >> 3);
+        switch (tag & 7)
+        {
+        case 0:
+            fields.emplace(field_number, std::to_string(varint()));
+            break;
+        case 1: {
+            uint64_t value = 0;
+            for (int i = 0; i < 8; i++)
+            {
+                value |= static_cast<uint64_t>(static_cast<uint8_t>(data[pos + i])) << (8 * i);
+            }
+            pos += 8;
+            fields.emplace(field_number, std::to_string(value));
+            break;
+        }
+        case 2: {
+            auto size = static_cast<size_t>(varint());
+            fields.emplace(field_number, data.substr(pos, size));
+            pos += size;
+            break;
+        }
+        default:
+            REQUIRE(false);
+        }
+    }
+    return fields;
+}
+
+static std::string field_of(const std::multimap<int, std::string> &fields, int field_number)
+{
+    auto it = fields.find(field_number);
+    return it != fields.end() ? it->second : std::string();
+}
+
+// the attributes of a LogRecord or Resource: key => the AnyValue
+static std::map<std::string, std::multimap<int, std::string>> attributes_of(const std::multimap<int, std::string> &fields, int field_number)
+{
+    std::map<std::string, std::multimap<int, std::string>> attributes;
+    auto range = fields.equal_range(field_number);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        auto key_value = parse_message(it->second);
+        attributes[field_of(key_value, 1)] = parse_message(field_of(key_value, 2));
+    }
+    return attributes;
+}
+
+TEST_CASE("otlp_sink exports log records", "[otlp_sink]")
+{
+    http_test_server collector;
+    spdlog::sinks::otlp_sink_config config("127.0.0.1", collector.port);
+    config.resource_attributes = {{"service.name", "test"}};
+    config.headers = {{"X-Test", "1"}};
+    config.batch_interval = std::chrono::milliseconds(10000);
+    auto sink = std::make_shared<spdlog::sinks::otlp_sink_mt>(config);
+    spdlog::logger logger("otlp", sink);
+    spdlog::logger other("other", sink);
+
+    logger.log(spdlog::source_loc{"app.cpp", 42, "run"}, spdlog::level::warn, "message {}", 1);
+    logger.info("order filled", spdlog::kv("id", 7), spdlog::kv("side", "buy"));
+    other.error("other message");
+    logger.flush();
+    REQUIRE(collector.wait_for(1));
+    REQUIRE(eventually([&] { return sink->sent_messages() == 3; }));
+
+    REQUIRE(collector.headers[0].find("POST /v1/logs HTTP/1.1") == 0);
+    REQUIRE(collector.headers[0].find("Content-Type: application/x-protobuf") != std::string::npos);
+    REQUIRE(collector.headers[0].find("X-Test: 1") != std::string::npos);
+
+    auto request = parse_message(collector.bodies[0]);
+    REQUIRE(request.count(1) == 1);
+    auto resource_logs = parse_message(field_of(request, 1));
+    auto resource = parse_message(field_of(resource_logs, 1));
+    REQUIRE(field_of(attributes_of(resource, 1)["service.name"], 1) == "test");
+
+    REQUIRE(resource_logs.count(2) == 2);
+    std::map<std::string, std::vector<std::multimap<int, std::string>>> records_by_scope;
+    auto scopes = resource_logs.equal_range(2);
+    for (auto it = scopes.first; it != scopes.second; ++it)
+    {
+        auto scope_logs = parse_message(it->second);
+        auto scope_name = field_of(parse_message(field_of(scope_logs, 1)), 1);
+        auto records = scope_logs.equal_range(2);
+        for (auto record = records.first; record != records.second; ++record)
+        {
+            records_by_scope[scope_name].push_back(parse_message(record->second));
+        }
+    }
+    REQUIRE(records_by_scope["otlp"].size() == 2);
+    REQUIRE(records_by_scope["other"].size() == 1);
+
+    auto &warn = records_by_scope["otlp"][0];
+    REQUIRE(field_of(warn, 2) == "13");
+    REQUIRE(field_of(warn, 3) == "warning");
+    REQUIRE(field_of(parse_message(field_of(warn, 5)), 1) == "message 1");
+    REQUIRE(std::stoull(field_of(warn, 1)) > 0);
+    auto warn_attributes = attributes_of(warn, 6);
+    REQUIRE(field_of(warn_attributes["code.filepath"], 1) == "app.cpp");
+    REQUIRE(field_of(warn_attributes["code.lineno"], 3) == "42");
+    REQUIRE(field_of(warn_attributes["code.function"], 1) == "run");
+    REQUIRE(field_of(warn_attributes["thread.id"], 3) == std::to_string(spdlog::details::os::thread_id()));
+
+    auto &info = records_by_scope["otlp"][1];
+    REQUIRE(field_of(info, 2) == "9");
+    auto info_attributes = attributes_of(info, 6);
+    REQUIRE(field_of(info_attributes["id"], 3) == "7");
+    REQUIRE(field_of(info_attributes["side"], 1) == "buy");
+    REQUIRE(info_attributes.count("code.filepath") == 0);
+
+    REQUIRE(field_of(records_by_scope["other"][0], 2) == "17");
+}
+
+TEST_CASE("otlp_sink exports the trace context", "[otlp_sink]")
+{
+    http_test_server collector;
+    auto sink = std::make_shared<spdlog::sinks::otlp_sink_st>(spdlog::sinks::otlp_sink_config("127.0.0.1", collector.port));
+    spdlog::logger logger("otlp", sink);
+
+    spdlog::details::log_msg msg(spdlog::source_loc{}, "otlp", spdlog::level::info, "traced");
+    for (uint8_t i = 0; i < 16; i++)
+    {
+        msg.trace.trace_id[i] = i + 1;
+    }
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        msg.trace.span_id[i] = i + 100;
+    }
+    sink->log(msg);
+    sink->flush();
+    REQUIRE(collector.wait_for(1));
+
+    auto scope_logs = parse_message(field_of(parse_message(field_of(parse_message(collector.bodies[0]), 1)), 2));
+    auto record = parse_message(field_of(scope_logs, 2));
+    REQUIRE(field_of(record, 9) == std::string(reinterpret_cast<const char *>(msg.trace.trace_id), 16));
+    REQUIRE(field_of(record, 10) == std::string(reinterpret_cast<const char *>(msg.trace.span_id), 8));
+}
+
+TEST_CASE("otlp_sink retries and drops", "[otlp_sink]")
+{
+    // retried on 503, then dropped on 400
+    http_test_server collector({503, 503, 400});
+    spdlog::sinks::otlp_sink_config config("127.0.0.1", collector.port);
+    config.retry_delay = std::chrono::milliseconds(1);
+    auto sink = std::make_shared<spdlog::sinks::otlp_sink_mt>(config);
+    spdlog::logger logger("otlp", sink);
+
+    logger.info("message");
+    logger.flush();
+    REQUIRE(collector.wait_for(3));
+    REQUIRE(eventually([&] { return sink->dropped_messages() == 1; }));
+    REQUIRE(sink->retries() == 2);
+    REQUIRE(sink->dropped_messages() == 1);
+    REQUIRE(sink->sent_messages() == 0);
+
+    // the next batch goes through
+    logger.info("message");
+    logger.flush();
+    REQUIRE(collector.wait_for(4));
+    REQUIRE(eventually([&] { return sink->sent_messages() == 1; }));
+}
+
+TEST_CASE("otlp_sink drops past max_buffer_size", "[otlp_sink]")
+{
+    http_test_server collector;
+    spdlog::sinks::otlp_sink_config config("127.0.0.1", collector.port);
+    config.max_buffer_size = 200;
+    config.batch_interval = std::chrono::milliseconds(10000);
+    auto sink = std::make_shared<spdlog::sinks::otlp_sink_mt>(config);
+    spdlog::logger logger("otlp", sink);
+
+    for (int i = 0; i < 10; i++)
+    {
+        logger.info("a message of some length {}", i);
+    }
+    REQUIRE(sink->dropped_messages() > 0);
+    auto dropped = sink->dropped_messages();
+    logger.flush();
+    REQUIRE(collector.wait_for(1));
+    REQUIRE(eventually([&] { return sink->sent_messages() == 10 - dropped; }));
+}
+
+#    ifdef SPDLOG_ZLIB
+#        include <zlib.h>
+
+TEST_CASE("otlp_sink gzip", "[otlp_sink]")
+{
+    http_test_server collector;
+    spdlog::sinks::otlp_sink_config config("127.0.0.1", collector.port);
+    config.gzip = true;
+    auto sink = std::make_shared<spdlog::sinks::otlp_sink_st>(config);
+    spdlog::logger logger("otlp", sink);
+    logger.info("compressed message");
+    logger.flush();
+    REQUIRE(collector.wait_for(1));
+    REQUIRE(collector.headers[0].find("Content-Encoding: gzip") != std::string::npos);
+
+    z_stream stream{};
+    REQUIRE(inflateInit2(&stream, 15 + 16) == Z_OK);
+    std::string body(4096, '\0');
+    stream.next_in = reinterpret_cast<Bytef *>(&collector.bodies[0][0]);
+    stream.avail_in = static_cast<uInt>(collector.bodies[0].size());
+    stream.next_out = reinterpret_cast<Bytef *>(&body[0]);
+    stream.avail_out = static_cast<uInt>(body.size());
+    REQUIRE(inflate(&stream, Z_FINISH) == Z_STREAM_END);
+    body.resize(stream.total_out);
+    inflateEnd(&stream);
+
+    auto scope_logs = parse_message(field_of(parse_message(field_of(parse_message(body), 1)), 2));
+    auto record = parse_message(field_of(scope_logs, 2));
+    REQUIRE(field_of(parse_message(field_of(record, 5)), 1) == "compressed message");
+}
+#    endif
+#endif
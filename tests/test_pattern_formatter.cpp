@@ -110,6 +110,39 @@ TEST_CASE("color range test4", "[pattern_formatter]")
     REQUIRE(log_to_str("ignored", "XX%^YYY%$", spdlog::pattern_time_type::local, "\n") == "XXYYY\n");
 }
 
+TEST_CASE("color codes", "[pattern_formatter]")
+{
+    spdlog::pattern_formatter formatter("XX%^%l%$ %v", spdlog::pattern_time_type::local, "\n");
+    auto plain_id = formatter.format_id();
+    std::array<std::string, spdlog::level::n_levels> codes{{"<t>", "<d>", "<i>", "<w>", "<e>", "<c>", "<o>"}};
+    REQUIRE(formatter.set_color_codes(&codes, "</>"));
+    REQUIRE(formatter.format_id() != plain_id);
+
+    std::string logger_name = "test";
+    spdlog::details::log_msg msg(logger_name, spdlog::level::warn, "msg");
+    msg.color_range_start = 1;
+    msg.color_range_end = 2;
+    memory_buf_t formatted;
+    formatter.format(msg, formatted);
+    REQUIRE(fmt::to_string(formatted) == "XX<w>warning</> msg\n");
+    // written already: no range left to color
+    REQUIRE(msg.color_range_start == 0);
+    REQUIRE(msg.color_range_end == 0);
+
+    // kept by clones
+    formatted.clear();
+    formatter.clone()->format(msg, formatted);
+    REQUIRE(fmt::to_string(formatted) == "XX<w>warning</> msg\n");
+
+    formatter.set_color_codes(nullptr, "");
+    REQUIRE(formatter.format_id() == plain_id);
+    formatted.clear();
+    formatter.format(msg, formatted);
+    REQUIRE(fmt::to_string(formatted) == "XXwarning msg\n");
+    REQUIRE(msg.color_range_start == 2);
+    REQUIRE(msg.color_range_end == 9);
+}
+
 TEST_CASE("color range test5", "[pattern_formatter]")
 {
     auto formatter = std::make_shared<spdlog::pattern_formatter>("**%^");
@@ -320,6 +353,47 @@ TEST_CASE("clone-formatter-2", "[pattern_formatter]")
     REQUIRE(fmt::to_string(formatted_1) == fmt::to_string(formatted_2));
 }
 
+TEST_CASE("clone-formatter-shared-steps", "[pattern_formatter]")
+{
+    using spdlog::pattern_time_type;
+    // the clones share the compiled pattern but render its cached steps on their own
+    auto formatter_1 = std::make_shared<spdlog::pattern_formatter>("[%Y-%m-%d %H:%M:%S] [%n] %5v", pattern_time_type::utc, "\n");
+    auto formatter_2 = formatter_1->clone();
+    auto formatter_3 = formatter_2->clone();
+    std::string logger_name = "test";
+    spdlog::details::log_msg msg_1(logger_name, spdlog::level::info, "a");
+    msg_1.time = spdlog::log_clock::time_point(std::chrono::seconds(1000));
+    spdlog::details::log_msg msg_2(logger_name, spdlog::level::info, "b");
+    msg_2.time = spdlog::log_clock::time_point(std::chrono::seconds(2000));
+
+    memory_buf_t formatted;
+    formatter_1->format(msg_1, formatted);
+    formatter_2->format(msg_2, formatted);
+    formatter_3->format(msg_1, formatted);
+    formatter_1->format(msg_2, formatted);
+    REQUIRE(fmt::to_string(formatted) == "[1970-01-01 00:16:40] [test]     a\n[1970-01-01 00:33:20] [test]     b\n"
+                                         "[1970-01-01 00:16:40] [test]     a\n[1970-01-01 00:33:20] [test]     b\n");
+
+    // the default pattern too
+    auto full_1 = std::make_shared<spdlog::pattern_formatter>(pattern_time_type::utc, "\n");
+    auto full_2 = full_1->clone();
+    formatted.clear();
+    full_1->format(msg_1, formatted);
+    full_2->format(msg_2, formatted);
+    full_1->format(msg_2, formatted);
+    REQUIRE(fmt::to_string(formatted) == "[1970-01-01 00:16:40.000] [test] [info] a\n[1970-01-01 00:33:20.000] [test] [info] b\n"
+                                         "[1970-01-01 00:33:20.000] [test] [info] b\n");
+
+    // formatters keeping state are not shared
+    auto elapsed_1 = std::make_shared<spdlog::pattern_formatter>("%o %v", pattern_time_type::utc, "\n");
+    auto elapsed_2 = elapsed_1->clone();
+    formatted.clear();
+    elapsed_1->format(msg_1, formatted);
+    elapsed_1->format(msg_2, formatted);
+    elapsed_2->format(msg_2, formatted);
+    REQUIRE(fmt::to_string(formatted) == "0 a\n1000000 b\n0 b\n");
+}
+
 class custom_test_flag : public spdlog::custom_flag_formatter
 {
 public:
@@ -367,6 +441,32 @@ TEST_CASE("clone-custom_formatter", "[pattern_formatter]")
     REQUIRE(fmt::to_string(formatted_2) == expected);
 }
 
+TEST_CASE("format ids", "[pattern_formatter]")
+{
+    using spdlog::pattern_formatter;
+    using spdlog::pattern_time_type;
+    pattern_formatter f1("[%n] %v");
+    pattern_formatter f2("[%n] %v");
+    REQUIRE(f1.format_id() != 0);
+    REQUIRE(f1.format_id() == f2.format_id());
+    REQUIRE(f1.clone()->format_id() == f1.format_id());
+
+    REQUIRE(pattern_formatter("[%n] %v ").format_id() != f1.format_id());
+    REQUIRE(pattern_formatter("[%n] %v", pattern_time_type::utc).format_id() != f1.format_id());
+    REQUIRE(pattern_formatter("[%n] %v", pattern_time_type::local, "\r\n").format_id() != f1.format_id());
+    REQUIRE(pattern_formatter().format_id() == pattern_formatter("%+").format_id());
+
+    // set_pattern() moves to the id of the new pattern
+    f2.set_pattern("%v");
+    REQUIRE(f2.format_id() == pattern_formatter("%v").format_id());
+
+    // the output of custom flags is unknown - no id
+    pattern_formatter custom;
+    custom.add_flag<custom_test_flag>('t', "custom_output").set_pattern("[%n] [%t] %v");
+    REQUIRE(custom.format_id() == 0);
+    REQUIRE(custom.clone()->format_id() == 0);
+}
+
 //
 // Test source location formatting
 //
@@ -421,6 +521,38 @@ TEST_CASE("full filename formatter", "[pattern_formatter]")
     REQUIRE(fmt::to_string(formatted) == test_path);
 }
 
+#if !defined(_MSC_VER) || (_MSC_VER >= 1900)
+static_assert(spdlog::details::basename_offset("a/b//myfile.cpp", 0, 15) == 5, "basename offset");
+static_assert(spdlog::details::basename_offset("myfile.cpp", 0, 10) == 0, "basename offset");
+static_assert(spdlog::details::basename_offset("a/", 0, 2) == 2, "basename offset");
+#endif
+
+TEST_CASE("compile time source location", "[pattern_formatter]")
+{
+    auto source = SPDLOG_SOURCE_LOC;
+    REQUIRE(source.filename_size == std::char_traits<char>::length(__FILE__));
+    REQUIRE(std::string(source.filename + source.basename_offset) == "test_pattern_formatter.cpp");
+
+    spdlog::source_loc sized{test_path, 123, "some_func()", std::char_traits<char>::length(test_path),
+        spdlog::details::basename_offset(test_path, 0, std::char_traits<char>::length(test_path))};
+    REQUIRE(sized.basename_offset == std::string(test_path).size() - std::string("myfile.cpp").size());
+    spdlog::details::log_msg msg(sized, "logger-name", spdlog::level::info, "Hello");
+    spdlog::pattern_formatter formatter("%s|%g|%@|%10s|", spdlog::pattern_time_type::local, "");
+    memory_buf_t formatted;
+    formatter.format(msg, formatted);
+    REQUIRE(fmt::to_string(formatted) == fmt::format("myfile.cpp|{}|{}:123|myfile.cpp|", test_path, test_path));
+
+    // a path too long for the sizes falls back to strlen
+    std::string long_path(70000, 'a');
+    long_path += "/b.cpp";
+    spdlog::source_loc unsized{long_path.c_str(), 1, "f", long_path.size(), long_path.size() - 5};
+    REQUIRE(unsized.filename_size == 0);
+    spdlog::details::log_msg long_msg(unsized, "logger-name", spdlog::level::info, "Hello");
+    formatted.clear();
+    formatter.format(long_msg, formatted);
+    REQUIRE(fmt::to_string(formatted) == fmt::format("b.cpp|{}|{}:1|     b.cpp|", long_path, long_path));
+}
+
 TEST_CASE("custom flags", "[pattern_formatter]")
 {
     auto formatter = std::make_shared<spdlog::pattern_formatter>();
@@ -456,3 +588,209 @@ TEST_CASE("custom flags-exception", "[pattern_formatter]")
     spdlog::details::log_msg msg(spdlog::source_loc{}, "logger-name", spdlog::level::info, "some message");
     CHECK_THROWS_AS(formatter->format(msg, formatted), spdlog::spdlog_ex);
 }
+
+TEST_CASE("cached time fields", "[pattern_formatter]")
+{
+    spdlog::pattern_formatter formatter("[%Y-%m-%d %H:%M:%S.%e] [%n] [%l] [%5l] %E %v", spdlog::pattern_time_type::utc, "");
+    spdlog::details::log_msg msg(spdlog::source_loc{}, "logger-name", spdlog::level::info, "some message");
+
+    msg.time = spdlog::log_clock::time_point(std::chrono::seconds(1600000000) + std::chrono::milliseconds(123));
+    memory_buf_t formatted;
+    formatter.format(msg, formatted);
+    REQUIRE(fmt::to_string(formatted) == "[2020-09-13 12:26:40.123] [logger-name] [info] [ info] 1600000000 some message");
+
+    // same second - only the sub second fields change
+    msg.time += std::chrono::milliseconds(500);
+    formatted.clear();
+    formatter.format(msg, formatted);
+    REQUIRE(fmt::to_string(formatted) == "[2020-09-13 12:26:40.623] [logger-name] [info] [ info] 1600000000 some message");
+
+    msg.time += std::chrono::seconds(80);
+    formatted.clear();
+    formatter.format(msg, formatted);
+    REQUIRE(fmt::to_string(formatted) == "[2020-09-13 12:28:00.623] [logger-name] [info] [ info] 1600000080 some message");
+
+    // the cached fields are rendered again after the pattern changed
+    formatter.set_pattern("%H:%M %%%v%%");
+    formatted.clear();
+    formatter.format(msg, formatted);
+    REQUIRE(fmt::to_string(formatted) == "12:28 %some message%");
+}
+
+TEST_CASE("cached time fields - alternating seconds", "[pattern_formatter]")
+{
+    spdlog::pattern_formatter formatter("%H:%M:%S.%e %v", spdlog::pattern_time_type::utc, "");
+    spdlog::details::log_msg msg(spdlog::source_loc{}, "logger-name", spdlog::level::info, "msg");
+    auto second = spdlog::log_clock::time_point(std::chrono::seconds(1600000000));
+
+    std::vector<std::string> expected = {"12:26:40.999 msg", "12:26:41.001 msg", "12:26:40.999 msg", "12:26:42.000 msg",
+        "12:26:41.002 msg", "12:26:41.003 msg", "12:26:40.999 msg"};
+    std::vector<spdlog::log_clock::duration> offsets = {std::chrono::milliseconds(999), std::chrono::milliseconds(1001),
+        std::chrono::milliseconds(999), std::chrono::milliseconds(2000), std::chrono::milliseconds(1002), std::chrono::milliseconds(1003),
+        std::chrono::milliseconds(999)};
+    for (size_t i = 0; i < offsets.size(); i++)
+    {
+        msg.time = second + offsets[i];
+        memory_buf_t formatted;
+        formatter.format(msg, formatted);
+        REQUIRE(fmt::to_string(formatted) == expected[i]);
+    }
+}
+
+TEST_CASE("key/value fields flag", "[pattern_formatter]")
+{
+    spdlog::field fields[] = {spdlog::kv("a", 1), spdlog::kv("b", "x")};
+    spdlog::details::log_msg msg("logger", spdlog::level::info, "msg");
+    msg.fields = fields;
+    msg.n_fields = 2;
+
+    auto format = [&msg](std::string pattern) {
+        spdlog::pattern_formatter formatter(std::move(pattern), spdlog::pattern_time_type::local, "");
+        memory_buf_t formatted;
+        formatter.format(msg, formatted);
+        return fmt::to_string(formatted);
+    };
+    REQUIRE(format("%v [%k]") == "msg [a=1 b=x]");
+    REQUIRE(format("[%-9k]") == "[a=1 b=x  ]");
+    REQUIRE(format("[%5!k]") == "[a=1 b]");
+    msg.n_fields = 0;
+    REQUIRE(format("%v [%k]") == "msg []");
+}
+
+namespace {
+// records the time and thread id of the messages it gets
+class fields_sink : public spdlog::sinks::base_sink<spdlog::details::null_mutex>
+{
+public:
+    unsigned required_fields() const override
+    {
+        return formatter_fields_.load(std::memory_order_relaxed);
+    }
+
+    spdlog::log_clock::time_point last_time;
+    size_t last_thread_id = 0;
+    std::string last_line;
+
+protected:
+    void sink_it_(const spdlog::details::log_msg &msg) override
+    {
+        last_time = msg.time;
+        last_thread_id = msg.thread_id;
+        memory_buf_t formatted;
+        format_(msg, formatted);
+        last_line = fmt::to_string(formatted);
+    }
+    void flush_() override {}
+};
+} // namespace
+
+TEST_CASE("required fields", "[pattern_formatter]")
+{
+    using namespace spdlog::details;
+    REQUIRE(spdlog::pattern_formatter("%v", spdlog::pattern_time_type::local, "").required_fields() == msg_fields::none);
+    REQUIRE(spdlog::pattern_formatter("[%n] [%l] %v", spdlog::pattern_time_type::local, "").required_fields() == msg_fields::none);
+    REQUIRE(spdlog::pattern_formatter("%t %v", spdlog::pattern_time_type::local, "").required_fields() == msg_fields::thread_id);
+    REQUIRE(spdlog::pattern_formatter("%Y %v", spdlog::pattern_time_type::local, "").required_fields() == msg_fields::time);
+    REQUIRE(spdlog::pattern_formatter("%&", spdlog::pattern_time_type::local, "").required_fields() == msg_fields::context);
+    REQUIRE((spdlog::pattern_formatter().required_fields() & msg_fields::time) != 0);
+    spdlog::pattern_formatter custom("%v", spdlog::pattern_time_type::local, "");
+    custom.add_flag<custom_test_flag>('*', "custom").set_pattern("%*");
+    REQUIRE(custom.required_fields() == msg_fields::all);
+    REQUIRE(custom.clone()->required_fields() == msg_fields::all);
+
+    auto sink = std::make_shared<fields_sink>();
+    spdlog::logger logger("fields", sink);
+    sink->set_pattern("[%n] %v");
+    logger.info("no time {}", 1);
+    REQUIRE(sink->last_time == spdlog::log_clock::time_point{});
+    REQUIRE(sink->last_thread_id == 0);
+    REQUIRE(sink->last_line == std::string("[fields] no time 1") + spdlog::details::os::default_eol);
+
+    sink->set_pattern("%t");
+    logger.info("thread id");
+    REQUIRE(sink->last_time == spdlog::log_clock::time_point{});
+    REQUIRE(sink->last_thread_id == spdlog::details::os::thread_id());
+
+    // a sink reading all the fields gets them all
+    sink->set_pattern("%v");
+    logger.sinks().push_back(std::make_shared<spdlog::sinks::test_sink_st>());
+    logger.info("time");
+    REQUIRE(sink->last_time != spdlog::log_clock::time_point{});
+}
+
+TEST_CASE("format split", "[pattern_formatter]")
+{
+    spdlog::details::log_msg msg(spdlog::source_loc{}, "logger", spdlog::level::info, "payload");
+    memory_buf_t formatted;
+    size_t payload_pos = 0;
+    spdlog::pattern_formatter formatter("[%n] %v %v!", spdlog::pattern_time_type::local, "\n");
+    REQUIRE(formatter.format_split(msg, formatted, payload_pos));
+    auto text = std::string(formatted.data(), formatted.size());
+    REQUIRE(text.substr(0, payload_pos) + "payload" + text.substr(payload_pos) == "[logger] payload payload!\n");
+    REQUIRE(payload_pos == 9);
+
+    // through a clone
+    formatted.clear();
+    REQUIRE(formatter.clone()->format_split(msg, formatted, payload_pos));
+    REQUIRE(payload_pos == 9);
+
+    // not without an unpadded %v
+    formatted.clear();
+    REQUIRE_FALSE(spdlog::pattern_formatter("[%n] %10v").format_split(msg, formatted, payload_pos));
+    REQUIRE_FALSE(spdlog::pattern_formatter("%+").format_split(msg, formatted, payload_pos));
+    REQUIRE(formatted.size() == 0);
+}
+
+TEST_CASE("escaped payload", "[pattern_formatter]")
+{
+    using spdlog::pattern_time_type;
+    REQUIRE(log_to_str("clean payload", "%V", pattern_time_type::local, "\n") == "clean payload\n");
+    REQUIRE(log_to_str("line 1\nline 2\r\n\tend", "%V", pattern_time_type::local, "\n") == "line 1\\nline 2\\r\\n\\tend\n");
+    REQUIRE(log_to_str(std::string("nul\0 bell\a del\x7f", 15), "[%V]", pattern_time_type::local, "") == "[nul\\x00 bell\\x07 del\\x7f]");
+    // utf-8 is kept
+    REQUIRE(log_to_str("caf\xc3\xa9\n", "%V", pattern_time_type::local, "") == "caf\xc3\xa9\\n");
+    // padded
+    REQUIRE(log_to_str("a\nb", "[%6V]", pattern_time_type::local, "") == "[  a\\nb]");
+
+    // control chars at each position of long payloads (the vector and word scans, and the tail)
+    for (size_t size : {size_t(7), size_t(16), size_t(40), size_t(100)})
+    {
+        for (size_t pos = 0; pos < size; pos++)
+        {
+            std::string payload(size, 'x');
+            payload[pos] = '\n';
+            std::string expected(size - 1, 'x');
+            expected.insert(pos, "\\n");
+            REQUIRE(log_to_str(payload, "%V", pattern_time_type::local, "") == expected);
+        }
+    }
+}
+
+TEST_CASE("thread name", "[pattern_formatter]")
+{
+    using spdlog::details::os::thread_name;
+    REQUIRE(log_to_str("x", "%P", spdlog::pattern_time_type::local, "") == std::to_string(spdlog::details::os::pid()));
+
+    std::ostringstream oss;
+    auto oss_sink = std::make_shared<spdlog::sinks::ostream_sink_mt>(oss);
+    oss_sink->set_pattern("[%N] %v");
+    spdlog::logger logger("thread name", oss_sink);
+    size_t tid = 0;
+    std::thread([&] {
+        tid = spdlog::details::os::thread_id();
+        spdlog::details::os::set_thread_name("named");
+        logger.info("first");
+        // the cached name is refreshed
+        spdlog::details::os::set_thread_name("renamed");
+        logger.info("second");
+    }).join();
+    REQUIRE(oss.str() == fmt::format("[named] first{0}[renamed] second{0}", spdlog::details::os::default_eol));
+
+    // unrecorded when the thread exited
+    REQUIRE(thread_name(tid).empty());
+    oss.str("");
+    spdlog::details::log_msg msg(spdlog::source_loc{}, "logger", spdlog::level::info, "unknown");
+    msg.thread_id = tid;
+    oss_sink->log(msg);
+    REQUIRE(oss.str() == fmt::format("[{}] unknown{}", tid, spdlog::details::os::default_eol));
+}
@@ -0,0 +1,119 @@
+#include "includes.h"
+#include "spdlog/sinks/rate_limit_sink.h"
+#include "test_sink.h"
+
+using spdlog::sinks::rate_limit_key;
+using spdlog::sinks::rate_limit_sink_st;
+using spdlog::sinks::test_sink_st;
+
+static spdlog::details::log_msg make_msg(spdlog::log_clock::time_point time, spdlog::source_loc loc, const char *logger_name,
+    spdlog::level::level_enum lvl, const char *text)
+{
+    return spdlog::details::log_msg{time, loc, logger_name, lvl, text};
+}
+
+TEST_CASE("rate_limit_sink burst", "[rate_limit_sink]")
+{
+    auto test_sink = std::make_shared<test_sink_st>();
+    test_sink->set_pattern("%v");
+    rate_limit_sink_st sink(1.0, 3);
+    sink.add_sink(test_sink);
+
+    auto now = spdlog::log_clock::now();
+    for (int i = 0; i < 10; i++)
+    {
+        sink.log(make_msg(now, {}, "logger", spdlog::level::info, "Hello"));
+    }
+    REQUIRE(test_sink->msg_counter() == 3);
+    REQUIRE(sink.dropped_messages() == 7);
+
+    // 2 tokens back after 2 seconds: the drop count, then the message
+    sink.log(make_msg(now + std::chrono::seconds(2), {}, "logger", spdlog::level::info, "Again"));
+    sink.log(make_msg(now + std::chrono::seconds(2), {}, "logger", spdlog::level::info, "Again"));
+    sink.log(make_msg(now + std::chrono::seconds(2), {}, "logger", spdlog::level::info, "Again"));
+    auto lines = test_sink->lines();
+    REQUIRE(lines.size() == 6);
+    REQUIRE(lines[3] == "Dropped 7 messages..");
+    REQUIRE(lines[4] == "Again");
+    REQUIRE(lines[5] == "Again");
+    REQUIRE(sink.dropped_messages() == 8);
+}
+
+TEST_CASE("rate_limit_sink buckets", "[rate_limit_sink]")
+{
+    auto test_sink = std::make_shared<test_sink_st>();
+    auto now = spdlog::log_clock::now();
+    spdlog::source_loc site1{"file.cpp", 10, "f"};
+    spdlog::source_loc site2{"file.cpp", 20, "f"};
+
+    SECTION("logger")
+    {
+        rate_limit_sink_st sink(0.0, 1, rate_limit_key::logger);
+        sink.add_sink(test_sink);
+        sink.log(make_msg(now, site1, "a", spdlog::level::info, "1"));
+        sink.log(make_msg(now, site2, "a", spdlog::level::err, "2"));
+        sink.log(make_msg(now, site1, "b", spdlog::level::info, "3"));
+        REQUIRE(test_sink->msg_counter() == 2);
+    }
+    SECTION("level")
+    {
+        rate_limit_sink_st sink(0.0, 1, rate_limit_key::level);
+        sink.add_sink(test_sink);
+        sink.log(make_msg(now, site1, "a", spdlog::level::info, "1"));
+        sink.log(make_msg(now, site2, "b", spdlog::level::info, "2"));
+        sink.log(make_msg(now, site1, "a", spdlog::level::err, "3"));
+        REQUIRE(test_sink->msg_counter() == 2);
+    }
+    SECTION("source")
+    {
+        rate_limit_sink_st sink(0.0, 1, rate_limit_key::source);
+        sink.add_sink(test_sink);
+        sink.log(make_msg(now, site1, "a", spdlog::level::info, "1"));
+        sink.log(make_msg(now, site1, "b", spdlog::level::err, "2"));
+        sink.log(make_msg(now, site2, "a", spdlog::level::info, "3"));
+        REQUIRE(test_sink->msg_counter() == 2);
+    }
+}
+
+TEST_CASE("every n call site", "[rate_limit_sink]")
+{
+    auto sink = std::make_shared<spdlog::sinks::test_sink_st>();
+    auto logger = std::make_shared<spdlog::logger>("every-n", sink);
+    logger->set_pattern("%v");
+    logger->set_level(spdlog::level::trace);
+    int evaluated = 0;
+    for (int i = 0; i < 10; i++)
+    {
+        SPDLOG_LOGGER_CALL_EVERY_N(logger, spdlog::level::info, 4, "{}", ++evaluated);
+    }
+    // the throttled calls don't evaluate their arguments
+    REQUIRE(evaluated == 3);
+    REQUIRE(sink->lines() == std::vector<std::string>{"1", "2", "3"});
+
+    // the calls disabled by the level are not counted
+    logger->set_level(spdlog::level::warn);
+    for (int i = 0; i < 2; i++)
+    {
+        SPDLOG_LOGGER_CALL_EVERY_N(logger, spdlog::level::info, 2, "{}", ++evaluated);
+        SPDLOG_LOGGER_CALL_EVERY_N(logger, spdlog::level::err, 2, "{}", ++evaluated);
+    }
+    REQUIRE(evaluated == 4);
+}
+
+TEST_CASE("every ms call site", "[rate_limit_sink]")
+{
+    auto sink = std::make_shared<spdlog::sinks::test_sink_st>();
+    auto logger = std::make_shared<spdlog::logger>("every-ms", sink);
+    logger->set_level(spdlog::level::trace);
+    int evaluated = 0;
+    for (int i = 0; i < 2; i++)
+    {
+        for (int j = 0; j < 5; j++)
+        {
+            SPDLOG_LOGGER_CALL_EVERY_MS(logger, spdlog::level::info, 50, "{}", ++evaluated);
+        }
+        REQUIRE(evaluated == i + 1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    }
+    REQUIRE(sink->msg_counter() == 2);
+}
@@ -0,0 +1,85 @@
+#include "includes.h"
+#include "spdlog/sinks/raw_ringbuffer_sink.h"
+
+#include <thread>
+
+using spdlog::sinks::raw_ringbuffer_sink;
+
+TEST_CASE("raw_ringbuffer_sink", "[raw_ringbuffer_sink]")
+{
+    auto sink = std::make_shared<raw_ringbuffer_sink>(4096);
+    spdlog::logger logger("raw", sink);
+    logger.info("message {}", 1);
+    logger.warn("message {}", 2);
+
+    std::vector<std::string> payloads;
+    auto n = sink->for_each([&](const spdlog::details::log_msg &msg) {
+        REQUIRE(msg.logger_name == "raw");
+        payloads.emplace_back(msg.payload.data(), msg.payload.size());
+    });
+    REQUIRE(n == 2);
+    REQUIRE(payloads == std::vector<std::string>{"message 1", "message 2"});
+
+    // formatted when read
+    sink->set_pattern("%l %v");
+    spdlog::memory_buf_t line;
+    std::vector<std::string> lines;
+    sink->for_each_formatted(line, [&](const spdlog::details::log_msg &, spdlog::string_view_t text) {
+        lines.emplace_back(text.data(), text.size());
+    });
+    REQUIRE(lines.size() == 2);
+    REQUIRE(lines[1] == "warning message 2" + std::string(spdlog::details::os::default_eol));
+    REQUIRE(sink->last_formatted(1) == std::vector<std::string>{lines[1]});
+}
+
+TEST_CASE("raw_ringbuffer_sink keeps the last messages", "[raw_ringbuffer_sink]")
+{
+    auto sink = std::make_shared<raw_ringbuffer_sink>(4096);
+    spdlog::logger logger("raw", sink);
+    for (int i = 0; i < 1000; i++)
+    {
+        logger.info("message {}", i);
+    }
+    std::vector<int> ids;
+    sink->for_each([&](const spdlog::details::log_msg &msg) {
+        ids.push_back(std::stoi(std::string(msg.payload.data() + 8, msg.payload.size() - 8)));
+    });
+    REQUIRE(!ids.empty());
+    REQUIRE(ids.size() < 1000);
+    REQUIRE(ids.back() == 999);
+    for (size_t i = 1; i < ids.size(); i++)
+    {
+        REQUIRE(ids[i] == ids[i - 1] + 1);
+    }
+
+    // too long payloads are truncated
+    logger.info(std::string(10000, 'x'));
+    size_t longest = 0;
+    sink->for_each([&](const spdlog::details::log_msg &msg) { longest = (std::max)(longest, msg.payload.size()); });
+    REQUIRE(longest > 0);
+    REQUIRE(longest < 1024);
+}
+
+TEST_CASE("raw_ringbuffer_sink multi writers", "[raw_ringbuffer_sink]")
+{
+    auto sink = std::make_shared<raw_ringbuffer_sink>(1024 * 1024);
+    auto logger = std::make_shared<spdlog::logger>("raw", sink);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++)
+    {
+        threads.emplace_back([logger, t] {
+            for (int i = 0; i < 1000; i++)
+            {
+                logger->info("thread {} message {}", t, i);
+            }
+        });
+    }
+    for (auto &t : threads)
+    {
+        t.join();
+    }
+    size_t n = sink->for_each([](const spdlog::details::log_msg &msg) {
+        REQUIRE(std::string(msg.payload.data(), msg.payload.size()).compare(0, 7, "thread ") == 0);
+    });
+    REQUIRE(n == 4000);
+}
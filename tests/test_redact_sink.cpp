@@ -0,0 +1,88 @@
+#include "includes.h"
+#include "spdlog/sinks/redact_sink.h"
+#include "test_sink.h"
+
+using spdlog::details::redact_options;
+using spdlog::details::redactor;
+using spdlog::sinks::redact_sink_st;
+using spdlog::sinks::test_sink_st;
+
+static std::string redacted(const std::string &text, const redact_options &options = redact_options())
+{
+    auto copy = text;
+    redactor(options).redact(&copy[0], copy.size());
+    return copy;
+}
+
+TEST_CASE("redactor cards", "[redact_sink]")
+{
+    REQUIRE(redacted("card 4111111111111111 ok") == "card ************1111 ok");
+    REQUIRE(redacted("card 4111 1111 1111 1111.") == "card **** **** **** 1111.");
+    REQUIRE(redacted("card 4111-1111-1111-1111") == "card ****-****-****-1111");
+    // not Luhn, too short, too long, part of a word
+    REQUIRE(redacted("id 4111111111111112") == "id 4111111111111112");
+    REQUIRE(redacted("id 411111111111") == "id 411111111111");
+    REQUIRE(redacted("id 41111111111111110000") == "id 41111111111111110000");
+    REQUIRE(redacted("x4111111111111111") == "x4111111111111111");
+    REQUIRE(redacted("2026-10-14 12:30:45.123") == "2026-10-14 12:30:45.123");
+
+    redact_options options;
+    options.luhn_check = false;
+    options.keep_last_digits = 0;
+    REQUIRE(redacted("1234567890123", options) == "*************");
+}
+
+TEST_CASE("redactor emails and tokens", "[redact_sink]")
+{
+    REQUIRE(redacted("mail john.doe+x@example.com.") == "mail **********@***********.");
+    REQUIRE(redacted("user@localhost @ a@b") == "user@localhost @ a@b");
+    REQUIRE(redacted("Authorization: Bearer abc.DEF-123 end") == "Authorization: Bearer *********** end");
+    REQUIRE(redacted("url?access_token=s3cr3t&x=1") == "url?access_token=******&x=1");
+    REQUIRE(redacted("Bearer ") == "Bearer ");
+
+    redact_options options;
+    options.emails = false;
+    options.token_prefixes = {"key:"};
+    options.mask = '#';
+    REQUIRE(redacted("a@b.com key:abc Bearer xyz", options) == "a@b.com key:### Bearer xyz");
+}
+
+TEST_CASE("redactor long text", "[redact_sink]")
+{
+    // the candidates at every position of the blocks
+    std::string filler(40, 'z');
+    for (size_t pos = 0; pos < 16; pos++)
+    {
+        auto text = filler.substr(0, pos) + " 4111111111111111 " + filler;
+        auto expected = filler.substr(0, pos) + " ************1111 " + filler;
+        REQUIRE(redacted(text) == expected);
+    }
+    REQUIRE(redacted(filler + filler) == filler + filler);
+}
+
+TEST_CASE("redact_sink", "[redact_sink]")
+{
+    auto test_sink = std::make_shared<test_sink_st>();
+    test_sink->set_pattern("%v%k");
+    redact_sink_st sink;
+    sink.add_sink(test_sink);
+
+    sink.log(spdlog::details::log_msg{"logger", spdlog::level::info, "nothing here"});
+    sink.log(spdlog::details::log_msg{"logger", spdlog::level::info, "from john@example.com"});
+    spdlog::field fields[] = {spdlog::kv("card", "4111111111111111"), spdlog::kv("n", 3), spdlog::kv("who", "a@b.io")};
+    spdlog::details::log_msg with_fields{"logger", spdlog::level::info, "paid"};
+    with_fields.fields = fields;
+    with_fields.n_fields = 3;
+    sink.log(with_fields);
+
+    auto lines = test_sink->lines();
+    REQUIRE(lines.size() == 3);
+    REQUIRE(lines[0] == "nothing here");
+    REQUIRE(lines[1] == "from ****@***********");
+    REQUIRE(lines[2].find("4111111111111111") == std::string::npos);
+    REQUIRE(lines[2].find("************1111") != std::string::npos);
+    REQUIRE(lines[2].find("*@****") != std::string::npos);
+    REQUIRE(sink.redacted_messages() == 2);
+    // the caller's fields are left as they are
+    REQUIRE(fields[0].string_value == "4111111111111111");
+}
@@ -1,4 +1,5 @@
 #include "includes.h"
+#include "test_sink.h"
 
 static const char *const tested_logger_name = "null_logger";
 static const char *const tested_logger_name2 = "null_logger2";
@@ -90,6 +91,44 @@ TEST_CASE("default logger", "[registry]")
     spdlog::drop_all();
 }
 
+TEST_CASE("set_default_logger while logging", "[registry]")
+{
+    using spdlog::sinks::test_sink_mt;
+    std::vector<std::shared_ptr<test_sink_mt>> sinks{std::make_shared<test_sink_mt>()};
+    spdlog::set_default_logger(std::make_shared<spdlog::logger>(tested_logger_name, sinks.back()));
+    std::atomic<bool> done{false};
+    std::atomic<size_t> messages{0};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; i++)
+    {
+        threads.emplace_back([&] {
+            while (!done)
+            {
+                spdlog::info("Hello {}", 1);
+                SPDLOG_INFO("Hello {}", 2);
+                messages += 2;
+            }
+        });
+    }
+    for (int i = 0; i < 200; i++)
+    {
+        sinks.push_back(std::make_shared<test_sink_mt>());
+        spdlog::set_default_logger(std::make_shared<spdlog::logger>(tested_logger_name, sinks.back()));
+    }
+    done = true;
+    for (auto &t : threads)
+    {
+        t.join();
+    }
+    size_t sunk = 0;
+    for (auto &sink : sinks)
+    {
+        sunk += sink->msg_counter();
+    }
+    REQUIRE(sunk == messages);
+    spdlog::drop_all();
+}
+
 TEST_CASE("set_default_logger(nullptr)", "[registry]")
 {
     spdlog::set_default_logger(nullptr);
@@ -114,3 +153,134 @@ TEST_CASE("disable automatic registration", "[registry]")
     spdlog::set_level(spdlog::level::info);
     spdlog::set_automatic_registration(true);
 }
+
+TEST_CASE("get by string_view", "[registry]")
+{
+    spdlog::drop_all();
+    spdlog::create<spdlog::sinks::null_sink_mt>(tested_logger_name);
+    spdlog::create<spdlog::sinks::null_sink_mt>(tested_logger_name2);
+    std::string names = std::string(tested_logger_name2) + "_suffix";
+    REQUIRE(spdlog::get(spdlog::string_view_t(names.data(), std::strlen(tested_logger_name2)))->name() == tested_logger_name2);
+    REQUIRE(spdlog::get(spdlog::string_view_t(names.data(), std::strlen(tested_logger_name)))->name() == tested_logger_name);
+    REQUIRE_FALSE(spdlog::get(spdlog::string_view_t(names)));
+    spdlog::drop_all();
+}
+
+TEST_CASE("get while registering", "[registry]")
+{
+    spdlog::drop_all();
+    spdlog::create<spdlog::sinks::null_sink_mt>(tested_logger_name);
+    std::atomic<bool> done{false};
+    std::atomic<size_t> misses{0};
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; i++)
+    {
+        readers.emplace_back([&] {
+            while (!done)
+            {
+                auto logger = spdlog::get(tested_logger_name);
+                if (!logger || logger->name() != tested_logger_name)
+                {
+                    misses++;
+                }
+                (void)spdlog::get(tested_logger_name2);
+            }
+        });
+    }
+    for (int i = 0; i < 1000; i++)
+    {
+        spdlog::create<spdlog::sinks::null_sink_mt>(tested_logger_name2);
+        spdlog::drop(tested_logger_name2);
+    }
+    done = true;
+    for (auto &t : readers)
+    {
+        t.join();
+    }
+    REQUIRE(misses == 0);
+    spdlog::drop_all();
+}
+
+TEST_CASE("initialize loggers", "[registry]")
+{
+    spdlog::drop_all();
+    spdlog::set_level(spdlog::level::warn);
+    std::vector<std::shared_ptr<spdlog::logger>> loggers;
+    for (int i = 0; i < 100; i++)
+    {
+        loggers.push_back(std::make_shared<spdlog::logger>("bulk" + std::to_string(i), std::make_shared<spdlog::sinks::null_sink_mt>()));
+    }
+    spdlog::initialize_loggers(loggers);
+    for (auto &l : loggers)
+    {
+        REQUIRE(spdlog::get(l->name()) == l);
+        REQUIRE(l->level() == spdlog::level::warn);
+    }
+    spdlog::set_level(spdlog::level::info);
+
+    // none is registered if a name is taken
+    std::vector<std::shared_ptr<spdlog::logger>> more{std::make_shared<spdlog::logger>("bulk_new"), loggers[5]};
+    REQUIRE_THROWS_AS(spdlog::register_loggers(more), spdlog::spdlog_ex);
+    REQUIRE_FALSE(spdlog::get("bulk_new"));
+    std::vector<std::shared_ptr<spdlog::logger>> twice{
+        std::make_shared<spdlog::logger>("bulk_twice"), std::make_shared<spdlog::logger>("bulk_twice")};
+    REQUIRE_THROWS_AS(spdlog::register_loggers(twice), spdlog::spdlog_ex);
+    REQUIRE_FALSE(spdlog::get("bulk_twice"));
+    spdlog::drop_all();
+}
+
+TEST_CASE("flush_all distinct sinks", "[registry]")
+{
+    spdlog::drop_all();
+    auto shared_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    std::vector<std::shared_ptr<spdlog::sinks::test_sink_mt>> own_sinks;
+    for (int i = 0; i < 10; i++)
+    {
+        own_sinks.push_back(std::make_shared<spdlog::sinks::test_sink_mt>());
+        auto sinks = spdlog::sinks_init_list{shared_sink, own_sinks.back()};
+        spdlog::register_logger(std::make_shared<spdlog::logger>("flushed" + std::to_string(i), sinks));
+    }
+
+    spdlog::flush_all();
+    REQUIRE(shared_sink->flush_counter() == 1);
+    for (auto &sink : own_sinks)
+    {
+        REQUIRE(sink->flush_counter() == 1);
+    }
+
+    // in parallel
+    spdlog::set_flush_threads(4);
+    spdlog::flush_all();
+    spdlog::set_flush_threads(1);
+    REQUIRE(shared_sink->flush_counter() == 2);
+    for (auto &sink : own_sinks)
+    {
+        REQUIRE(sink->flush_counter() == 2);
+    }
+    spdlog::drop_all();
+}
+
+TEST_CASE("shutdown drain deadline", "[registry]")
+{
+    auto default_logger = spdlog::default_logger();
+    spdlog::drop_all();
+    size_t messages = 100;
+    auto slow_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    slow_sink->set_delay(std::chrono::milliseconds(20));
+    auto tp = std::make_shared<spdlog::details::thread_pool>(messages, 1);
+    auto logger = std::make_shared<spdlog::async_logger>("slow", slow_sink, tp);
+    spdlog::register_logger(logger);
+    for (size_t i = 0; i < messages; i++)
+    {
+        logger->info("Hello message #{}", i);
+    }
+    logger.reset();
+
+    // 2 seconds to drain unbounded
+    auto start = std::chrono::steady_clock::now();
+    spdlog::shutdown(std::chrono::milliseconds(100));
+    tp.reset();
+    REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(1000));
+    REQUIRE(slow_sink->msg_counter() < messages);
+    spdlog::set_default_logger(default_logger);
+}
@@ -0,0 +1,91 @@
+#include "includes.h"
+#include "spdlog/sinks/sharded_file_sink.h"
+
+#include <algorithm>
+#include <atomic>
+
+#define SHARDED_LOG "test_logs/sharded_log.txt"
+#define MERGED_LOG "test_logs/merged_log.txt"
+
+using spdlog::sinks::sharded_file_sink;
+
+TEST_CASE("sharded_file_sink shard per thread", "[sharded_file_sink]")
+{
+    prepare_logdir();
+    auto sink = std::make_shared<sharded_file_sink>(SPDLOG_FILENAME_T(SHARDED_LOG), true);
+    sink->set_pattern("%v");
+    spdlog::logger logger("sharded", sink);
+
+    // the sequence numbers increase within each shard: the merged log has them all, in order
+    const int n_threads = 4, n_msgs = 500;
+    std::atomic<int> seq{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < n_threads; t++)
+    {
+        threads.emplace_back([&] {
+            for (int i = 0; i < n_msgs; i++)
+            {
+                logger.info("{:06}", seq++);
+            }
+        });
+    }
+    for (auto &t : threads)
+    {
+        t.join();
+    }
+    logger.flush();
+
+    auto shards = sink->shard_filenames();
+    REQUIRE(shards.size() == static_cast<size_t>(n_threads));
+    size_t total = 0;
+    for (auto &shard : shards)
+    {
+        REQUIRE(shard.find(SPDLOG_FILENAME_T("test_logs/sharded_log.")) == 0);
+        REQUIRE(shard.substr(shard.size() - 4) == SPDLOG_FILENAME_T(".txt"));
+        total += count_lines(spdlog::details::os::filename_to_str(shard));
+    }
+    REQUIRE(total == static_cast<size_t>(n_threads * n_msgs));
+
+    sharded_file_sink::merge(shards, SPDLOG_FILENAME_T(MERGED_LOG));
+    REQUIRE(count_lines(MERGED_LOG) == static_cast<size_t>(n_threads * n_msgs));
+    std::string expected;
+    for (int i = 0; i < n_threads * n_msgs; i++)
+    {
+        expected += fmt::format("{:06}{}", i, spdlog::details::os::default_eol);
+    }
+    REQUIRE(file_contents(MERGED_LOG) == expected);
+}
+
+TEST_CASE("sharded_file_sink filenames", "[sharded_file_sink]")
+{
+    REQUIRE(sharded_file_sink::shard_filename(SPDLOG_FILENAME_T("logs/app.log"), 1234) == SPDLOG_FILENAME_T("logs/app.1234.log"));
+    REQUIRE(sharded_file_sink::shard_filename(SPDLOG_FILENAME_T("logs/app"), 7) == SPDLOG_FILENAME_T("logs/app.7"));
+
+    prepare_logdir();
+    auto sink = std::make_shared<sharded_file_sink>(SPDLOG_FILENAME_T(SHARDED_LOG));
+    spdlog::logger logger("sharded", sink);
+    REQUIRE(sink->shard_filenames().empty());
+    logger.info("opened by the first message");
+    auto expected = sharded_file_sink::shard_filename(SPDLOG_FILENAME_T(SHARDED_LOG), spdlog::details::os::thread_id());
+    REQUIRE(sink->shard_filenames() == std::vector<spdlog::filename_t>{expected});
+}
+
+TEST_CASE("sharded_file_sink merge multi-line messages", "[sharded_file_sink]")
+{
+    prepare_logdir();
+    auto write_file = [](const spdlog::filename_t &filename, const char *text) {
+        spdlog::details::file_helper helper;
+        helper.open(filename, true);
+        helper.write(spdlog::string_view_t(text));
+        helper.close();
+    };
+    write_file(SPDLOG_FILENAME_T("test_logs/shard.1.txt"), "[10:00:01] a\n  a continued\n[10:00:03] c\n");
+    write_file(SPDLOG_FILENAME_T("test_logs/shard.2.txt"), "[10:00:02] b\n[10:00:04] d\n  d continued");
+
+    sharded_file_sink::merge({SPDLOG_FILENAME_T("test_logs/shard.1.txt"), SPDLOG_FILENAME_T("test_logs/shard.2.txt")},
+        SPDLOG_FILENAME_T(MERGED_LOG));
+    REQUIRE(file_contents(MERGED_LOG) == "[10:00:01] a\n  a continued\n[10:00:02] b\n[10:00:03] c\n[10:00:04] d\n  d continued");
+
+    REQUIRE_THROWS_AS(sharded_file_sink::merge({SPDLOG_FILENAME_T("test_logs/no_such_shard.txt")}, SPDLOG_FILENAME_T(MERGED_LOG)),
+        spdlog::spdlog_ex);
+}
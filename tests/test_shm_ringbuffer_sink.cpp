@@ -0,0 +1,109 @@
+#include "includes.h"
+
+#ifndef _WIN32
+#    include "spdlog/sinks/shm_ringbuffer_sink.h"
+
+using spdlog::details::shm_ring;
+
+static const char *const shm_name = "/spdlog-utests-shm-ring";
+
+static std::vector<std::string> read_all(const shm_ring &ring)
+{
+    std::vector<std::string> records;
+    auto pos = ring.oldest_position();
+    spdlog::memory_buf_t record;
+    while (ring.read(pos, record))
+    {
+        records.push_back(fmt::to_string(record));
+        record.clear();
+    }
+    return records;
+}
+
+TEST_CASE("shm_ringbuffer_sink", "[shm_ringbuffer_sink]")
+{
+    shm_ring::remove(shm_name);
+    {
+        auto sink = std::make_shared<spdlog::sinks::shm_ringbuffer_sink_st>(shm_name, 4096);
+        spdlog::logger logger("shm", sink);
+        logger.set_pattern("%v");
+        logger.info("message 1");
+        logger.info("message 2");
+    }
+
+    // the segment outlives the writer
+    shm_ring reader;
+    reader.open_read_only(shm_name);
+    auto records = read_all(reader);
+    REQUIRE(records.size() == 2);
+    REQUIRE(records[1] == "message 2" + std::string(spdlog::details::os::default_eol));
+    shm_ring::remove(shm_name);
+}
+
+TEST_CASE("shm_ring keeps the last records", "[shm_ringbuffer_sink]")
+{
+    shm_ring::remove(shm_name);
+    shm_ring writer;
+    writer.open(shm_name, 1024);
+    REQUIRE(writer.capacity() == 1024);
+    shm_ring reader;
+    reader.open_read_only(shm_name);
+
+    uint64_t live_pos = 0;
+    spdlog::memory_buf_t record;
+    for (int i = 0; i < 1000; i++)
+    {
+        writer.write(fmt::format("record {}", i));
+        if (i == 10)
+        {
+            REQUIRE(reader.read(live_pos, record));
+            REQUIRE(fmt::to_string(record) == "record 0");
+        }
+    }
+    // lapped: continues with the oldest left
+    record.clear();
+    REQUIRE(reader.read(live_pos, record));
+    REQUIRE(live_pos + reader.capacity() >= reader.write_position());
+
+    auto records = read_all(reader);
+    REQUIRE(!records.empty());
+    REQUIRE(records.size() < 1000);
+    REQUIRE(records.back() == "record 999");
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        REQUIRE(records[i] == fmt::format("record {}", 1000 - records.size() + i));
+    }
+    shm_ring::remove(shm_name);
+}
+
+TEST_CASE("shm_ring multi writers", "[shm_ringbuffer_sink]")
+{
+    shm_ring::remove(shm_name);
+    shm_ring ring;
+    ring.open(shm_name, 1024 * 1024);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++)
+    {
+        threads.emplace_back([&ring, t] {
+            for (int i = 0; i < 1000; i++)
+            {
+                ring.write(fmt::format("thread {} record {}", t, i));
+            }
+        });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    auto records = read_all(ring);
+    REQUIRE(records.size() == 4000);
+    std::vector<int> next(4, 0);
+    for (auto &r : records)
+    {
+        int t = r[7] - '0';
+        REQUIRE(r == fmt::format("thread {} record {}", t, next[t]++));
+    }
+    shm_ring::remove(shm_name);
+}
+
+#endif
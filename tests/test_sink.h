@@ -50,7 +50,7 @@ protected:
     void sink_it_(const details::log_msg &msg) override
     {
         memory_buf_t formatted;
-        base_sink<Mutex>::formatter_->format(msg, formatted);
+        base_sink<Mutex>::format_(msg, formatted);
         // save the line without the eol
         auto eol_len = strlen(details::os::default_eol);
         if (lines_.size() < lines_to_save)
@@ -0,0 +1,83 @@
+#include "includes.h"
+#include "spdlog/static_logger.h"
+#include "spdlog/sinks/static_sinks.h"
+#include "test_sink.h"
+
+#define TEST_FILENAME "test_logs/static_logger_test.txt"
+
+using spdlog::details::make_unique;
+
+TEST_CASE("static_logger", "[static_logger]")
+{
+    std::ostringstream first, second;
+    spdlog::static_logger<spdlog::pattern_formatter, spdlog::static_sinks::ostream_sink, spdlog::static_sinks::ostream_sink> logger(
+        "static", make_unique<spdlog::pattern_formatter>("[%l] %v", spdlog::pattern_time_type::local, "\n"),
+        std::make_shared<spdlog::static_sinks::ostream_sink>(first), std::make_shared<spdlog::static_sinks::ostream_sink>(second));
+
+    logger.info("Hello {}", 42);
+    logger.debug("not logged");
+    logger.warn("as is");
+    REQUIRE(first.str() == "[info] Hello 42\n[warning] as is\n");
+    REQUIRE(second.str() == first.str());
+
+    logger.set_level(spdlog::level::debug);
+    REQUIRE(logger.handle()->level() == spdlog::level::debug);
+    logger.debug("now logged");
+    REQUIRE(ends_with(first.str(), "[debug] now logged\n"));
+
+    // logged through the handle
+    logger.handle()->error("from handle {}", 1);
+    REQUIRE(ends_with(second.str(), "[error] from handle 1\n"));
+}
+
+TEST_CASE("static_logger registry", "[static_logger]")
+{
+    spdlog::drop_all();
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    test_sink->set_pattern("%v");
+    auto logger = spdlog::make_static_logger("static_registered", make_unique<spdlog::pattern_formatter>("%v"),
+        std::make_shared<spdlog::static_sinks::dynamic_sink>(test_sink), std::make_shared<spdlog::static_sinks::null_sink>());
+
+    auto handle = spdlog::get("static_registered");
+    REQUIRE(handle == logger.handle());
+
+    spdlog::set_level(spdlog::level::warn);
+    logger.info("filtered");
+    logger.warn("kept");
+    REQUIRE(test_sink->msg_counter() == 1);
+    REQUIRE(test_sink->lines()[0] == "kept");
+
+    handle->flush_on(spdlog::level::err);
+    logger.error("flushed");
+    REQUIRE(test_sink->flush_counter() == 1);
+    spdlog::apply_all([](std::shared_ptr<spdlog::logger> l) { l->flush(); });
+    REQUIRE(test_sink->flush_counter() == 2);
+
+    // the backtrace of the handle
+    handle->enable_backtrace(4);
+    logger.debug("traced {}", 1);
+    REQUIRE(test_sink->msg_counter() == 2);
+    handle->dump_backtrace();
+    REQUIRE(test_sink->msg_counter() == 5);
+    REQUIRE(test_sink->lines()[3] == "traced 1");
+
+    REQUIRE_THROWS_AS(handle->clone("other"), spdlog::spdlog_ex);
+    spdlog::drop_all();
+    spdlog::set_level(spdlog::level::info);
+}
+
+TEST_CASE("static_logger file", "[static_logger]")
+{
+    prepare_logdir();
+    spdlog::filename_t filename = SPDLOG_FILENAME_T(TEST_FILENAME);
+    {
+        spdlog::static_logger_st<spdlog::pattern_formatter, spdlog::static_sinks::file_sink> logger(
+            "static_file", make_unique<spdlog::pattern_formatter>("%v"), std::make_shared<spdlog::static_sinks::file_sink>(filename));
+        for (int i = 0; i < 10; i++)
+        {
+            logger.info("Test message {}", i);
+        }
+        logger.flush();
+    }
+    require_message_count(TEST_FILENAME, 10);
+}
@@ -79,6 +79,111 @@ TEST_CASE("stderr_color_mt", "[stderr]")
     spdlog::drop_all();
 }
 
+// the contents written to f so far
+static std::string file_contents(FILE *f)
+{
+    std::fflush(f);
+    auto size = std::ftell(f);
+    std::string contents(static_cast<size_t>(size), '\0');
+    std::rewind(f);
+    auto n_read = std::fread(&contents[0], 1, contents.size(), f);
+    std::fseek(f, 0, SEEK_END);
+    contents.resize(n_read);
+    return contents;
+}
+
+TEST_CASE("stdout_sink buffering", "[stdout]")
+{
+    auto *f = std::tmpfile();
+    REQUIRE(f != nullptr);
+    {
+        auto sink = std::make_shared<spdlog::sinks::stdout_sink_base<spdlog::details::console_nullmutex>>(f);
+        sink->set_pattern("%v");
+        sink->set_buffering(spdlog::console_buffering::always, 16, std::chrono::milliseconds(0));
+        spdlog::logger logger("buffered", sink);
+        logger.info("one");
+        logger.info("two");
+        REQUIRE(file_contents(f).empty());
+        // over max_size: the pending messages are written first
+        logger.info("three and more");
+        REQUIRE(file_contents(f) == fmt::format("one{0}two{0}", spdlog::details::os::default_eol));
+        logger.flush();
+        REQUIRE(file_contents(f) == fmt::format("one{0}two{0}three and more{0}", spdlog::details::os::default_eol));
+        logger.info("last");
+    }
+    // on destruction
+    REQUIRE(file_contents(f) == fmt::format("one{0}two{0}three and more{0}last{0}", spdlog::details::os::default_eol));
+    std::fclose(f);
+}
+
+TEST_CASE("stdout_sink buffering interval", "[stdout]")
+{
+    auto *f = std::tmpfile();
+    REQUIRE(f != nullptr);
+    std::string expected;
+    {
+        // the buffer is written by the sink's thread while logging, even without a console mutex
+        auto sink = std::make_shared<spdlog::sinks::stdout_sink_base<spdlog::details::console_nullmutex>>(f);
+        sink->set_pattern("%v");
+        sink->set_buffering(spdlog::console_buffering::always, 1024, std::chrono::milliseconds(1));
+        spdlog::logger logger("buffered", sink);
+        for (int i = 0; i < 1000; i++)
+        {
+            logger.info("message {}", i);
+            expected += fmt::format("message {}{}", i, spdlog::details::os::default_eol);
+            if (i % 100 == 0)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            }
+        }
+    }
+    REQUIRE(file_contents(f) == expected);
+    std::fclose(f);
+}
+
+#ifndef _WIN32
+TEST_CASE("ansicolor_sink buffering", "[stdout]")
+{
+    auto *f = std::tmpfile();
+    REQUIRE(f != nullptr);
+    {
+        auto sink = std::make_shared<spdlog::sinks::ansicolor_sink<spdlog::details::console_nullmutex>>(f, spdlog::color_mode::always);
+        sink->set_pattern("[%^%l%$] %v");
+        // a file is not a terminal
+        sink->set_buffering(spdlog::console_buffering::automatic, 1024, std::chrono::milliseconds(0));
+        spdlog::logger logger("buffered", sink);
+        logger.info("colored");
+        REQUIRE(file_contents(f).empty());
+        logger.flush();
+        REQUIRE(file_contents(f) == fmt::format("[\033[32minfo\033[m] colored{}", spdlog::details::os::default_eol));
+
+        // written right away
+        sink->set_buffering(spdlog::console_buffering::line);
+        logger.warn("line");
+        REQUIRE(file_contents(f).size() > 40);
+    }
+    std::fclose(f);
+}
+
+TEST_CASE("ansicolor_sink buffering interval", "[stdout]")
+{
+    auto *f = std::tmpfile();
+    REQUIRE(f != nullptr);
+    auto sink = std::make_shared<spdlog::sinks::ansicolor_sink<spdlog::details::console_mutex>>(f, spdlog::color_mode::never);
+    sink->set_pattern("%v");
+    sink->set_buffering(spdlog::console_buffering::always, 1024, std::chrono::milliseconds(10));
+    spdlog::logger logger("buffered", sink);
+    logger.info("timed");
+    for (int i = 0; i < 200 && file_contents(f).empty(); i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    REQUIRE(file_contents(f) == fmt::format("timed{}", spdlog::details::os::default_eol));
+    sink.reset();
+    std::fclose(f);
+}
+#endif
+
 #ifdef SPDLOG_WCHAR_TO_UTF8_SUPPORT
 
 TEST_CASE("wchar_api", "[stdout]")
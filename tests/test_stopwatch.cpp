@@ -1,6 +1,7 @@
 #include "includes.h"
 #include "test_sink.h"
 #include "spdlog/stopwatch.h"
+#include "spdlog/scoped_timer.h"
 
 TEST_CASE("stopwatch1", "[stopwatch]")
 {
@@ -33,3 +34,56 @@ TEST_CASE("stopwatch2", "[stopwatch]")
     REQUIRE(val >= wait_duration.count());
     REQUIRE(val <= (wait_duration + tolerance_duration).count());
 }
+
+TEST_CASE("tsc_stopwatch", "[stopwatch]")
+{
+    using std::chrono::milliseconds;
+    milliseconds wait_ms(250);
+    milliseconds tolerance_ms(250);
+
+    spdlog::tsc_stopwatch sw;
+    std::this_thread::sleep_for(wait_ms);
+    REQUIRE(sw.elapsed() >= wait_ms - milliseconds(1));
+    REQUIRE(sw.elapsed() <= wait_ms + tolerance_ms);
+    sw.reset();
+    REQUIRE(sw.elapsed() < tolerance_ms);
+}
+
+TEST_CASE("scope timer", "[stopwatch]")
+{
+    using spdlog::sinks::test_sink_st;
+    using std::chrono::milliseconds;
+
+    auto test_sink = std::make_shared<test_sink_st>();
+    auto logger = std::make_shared<spdlog::logger>("test-scope-timer", test_sink);
+    logger->set_pattern("%v");
+
+    {
+        SPDLOG_SCOPE_TIMER(logger, spdlog::level::info, "scope");
+        std::this_thread::sleep_for(milliseconds(10));
+    }
+    REQUIRE(test_sink->msg_counter() == 1);
+    auto line = test_sink->lines()[0];
+    REQUIRE(line.find("scope took ") == 0);
+    REQUIRE(line.substr(line.size() - 2) == "ms");
+    REQUIRE(std::stod(line.substr(std::string("scope took ").size())) >= 9.0);
+
+    // disabled level
+    {
+        SPDLOG_SCOPE_TIMER(logger, spdlog::level::debug, "debug scope");
+    }
+    REQUIRE(test_sink->msg_counter() == 1);
+
+    // below the threshold
+    {
+        SPDLOG_SCOPE_TIMER_OVER(logger, spdlog::level::info, "fast scope", std::chrono::seconds(10));
+    }
+    REQUIRE(test_sink->msg_counter() == 1);
+
+    {
+        SPDLOG_SCOPE_TIMER_OVER(logger.get(), spdlog::level::warn, "slow scope", milliseconds(1));
+        std::this_thread::sleep_for(milliseconds(5));
+    }
+    REQUIRE(test_sink->msg_counter() == 2);
+    REQUIRE(test_sink->lines()[1].find("slow scope took ") == 0);
+}
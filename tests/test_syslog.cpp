@@ -0,0 +1,90 @@
+#include "includes.h"
+#include "spdlog/sinks/syslog_sink.h"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+
+TEST_CASE("syslog socket", "[syslog]")
+{
+    const char *socket_path = "syslog_test.sock";
+    ::unlink(socket_path);
+    int fd = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, socket_path);
+    REQUIRE(::bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0);
+
+    spdlog::sinks::syslog_socket_config config;
+    config.socket_path = socket_path;
+    config.batch_size = 2;
+    config.max_delay = std::chrono::seconds(60);
+    auto sink = std::make_shared<spdlog::sinks::syslog_sink_st>("spdlog-test", LOG_PID, LOG_LOCAL0, false, config);
+    spdlog::logger logger("syslog", sink);
+    logger.warn("message 1");
+    logger.info("message 2"); // full batch
+    logger.error("message 3");
+
+    std::vector<std::string> datagrams;
+    char buf[1024];
+    pollfd poll_fd{fd, POLLIN, 0};
+    while (::poll(&poll_fd, 1, 200) > 0)
+    {
+        datagrams.emplace_back(buf, static_cast<size_t>(::recv(fd, buf, sizeof(buf), 0)));
+    }
+    REQUIRE(datagrams.size() == 2);
+    // <priority>Mmm dd hh:mm:ss ident[pid]: message
+    auto expected_end = fmt::format(" spdlog-test[{}]: message 1", ::getpid());
+    REQUIRE(datagrams[0].compare(0, 5, fmt::format("<{}>", LOG_LOCAL0 | LOG_WARNING)) == 0);
+    REQUIRE(datagrams[0].size() == 5 + 15 + expected_end.size());
+    REQUIRE(datagrams[0].compare(20, std::string::npos, expected_end) == 0);
+
+    logger.flush();
+    REQUIRE(::poll(&poll_fd, 1, 200) == 1);
+    REQUIRE(sink->dropped_messages() == 0);
+    ::close(fd);
+    ::unlink(socket_path);
+}
+
+TEST_CASE("syslog socket timer", "[syslog]")
+{
+    const char *socket_path = "syslog_timer_test.sock";
+    ::unlink(socket_path);
+    int fd = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, socket_path);
+    REQUIRE(::bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0);
+
+    // the partial batches are sent by the timer thread while logging: the batch is locked even by the _st sink
+    spdlog::sinks::syslog_socket_config config;
+    config.socket_path = socket_path;
+    config.batch_size = 1000;
+    config.max_delay = std::chrono::milliseconds(1);
+    auto sink = std::make_shared<spdlog::sinks::syslog_sink_st>("spdlog-test", 0, LOG_LOCAL0, false, config);
+    spdlog::logger logger("syslog", sink);
+    const size_t messages = 200;
+    for (size_t i = 0; i < messages; i++)
+    {
+        logger.info("message {}", i);
+        if (i % 20 == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+
+    // sent without flushing
+    size_t received = 0;
+    char buf[1024];
+    pollfd poll_fd{fd, POLLIN, 0};
+    while (received + sink->dropped_messages() < messages && ::poll(&poll_fd, 1, 1000) > 0)
+    {
+        REQUIRE(::recv(fd, buf, sizeof(buf), 0) > 0);
+        received++;
+    }
+    REQUIRE(received > 0);
+    REQUIRE(received + sink->dropped_messages() == messages);
+    ::close(fd);
+    ::unlink(socket_path);
+}
@@ -0,0 +1,104 @@
+#include "includes.h"
+#include "test_sink.h"
+#include "spdlog/tail_sampling.h"
+
+using spdlog::sinks::test_sink_st;
+
+TEST_CASE("tail_sampling_discard", "[tail_sampling]")
+{
+    auto test_sink = std::make_shared<test_sink_st>();
+    spdlog::logger logger("test-tail", test_sink);
+    logger.set_pattern("%v");
+    {
+        spdlog::tail_sampling_scope scope(10);
+        logger.debug("debug message {}", 1);
+        logger.trace("trace message");
+        logger.info("info message");
+        REQUIRE(scope.size() == 2);
+        REQUIRE_FALSE(scope.triggered());
+    }
+    REQUIRE(test_sink->lines().size() == 1);
+    REQUIRE(test_sink->lines()[0] == "info message");
+}
+
+TEST_CASE("tail_sampling_trigger", "[tail_sampling]")
+{
+    auto test_sink = std::make_shared<test_sink_st>();
+    spdlog::logger logger("test-tail", test_sink);
+    logger.set_pattern("%l %v");
+    {
+        spdlog::tail_sampling_scope scope(10);
+        logger.debug("pi {}", 3.5);
+        logger.trace("id {} {}", 42, std::string("str"));
+        logger.debug("constant");
+        logger.info("info message");
+        REQUIRE_FALSE(scope.triggered());
+        logger.error("failed");
+        REQUIRE(scope.triggered());
+    }
+    REQUIRE(test_sink->lines().size() == 5);
+    REQUIRE(test_sink->lines()[0] == "info info message");
+    REQUIRE(test_sink->lines()[1] == "error failed");
+    REQUIRE(test_sink->lines()[2] == "debug pi 3.5");
+    REQUIRE(test_sink->lines()[3] == "trace id 42 str");
+    REQUIRE(test_sink->lines()[4] == "debug constant");
+
+    // explicit trigger, sink level still applied
+    test_sink->set_level(spdlog::level::debug);
+    {
+        spdlog::tail_sampling_scope scope(10);
+        logger.trace("dropped by the sink");
+        logger.debug("kept");
+        scope.trigger();
+    }
+    REQUIRE(test_sink->lines().size() == 6);
+    REQUIRE(test_sink->lines()[5] == "debug kept");
+}
+
+TEST_CASE("tail_sampling_latency", "[tail_sampling]")
+{
+    auto test_sink = std::make_shared<test_sink_st>();
+    spdlog::logger logger("test-tail", test_sink);
+    logger.set_pattern("%v");
+    {
+        spdlog::tail_sampling_scope scope(10, std::chrono::milliseconds(1));
+        logger.debug("slow request");
+        spdlog::details::os::sleep_for_millis(5);
+    }
+    REQUIRE(test_sink->lines().size() == 1);
+    REQUIRE(test_sink->lines()[0] == "slow request");
+
+    {
+        spdlog::tail_sampling_scope scope(10, std::chrono::hours(1));
+        logger.debug("fast request");
+    }
+    REQUIRE(test_sink->lines().size() == 1);
+}
+
+TEST_CASE("tail_sampling_nested_overrun", "[tail_sampling]")
+{
+    auto test_sink = std::make_shared<test_sink_st>();
+    auto logger = std::make_shared<spdlog::logger>("test-tail", test_sink);
+    logger->set_pattern("%v");
+    {
+        spdlog::tail_sampling_scope outer(2);
+        SPDLOG_LOGGER_DEBUG(logger, "outer {}", 1);
+        {
+            spdlog::tail_sampling_scope inner(2);
+            for (int i = 0; i < 5; i++)
+                SPDLOG_LOGGER_DEBUG(logger, "inner {}", i);
+            REQUIRE(inner.size() == 2);
+            REQUIRE(inner.overrun_counter() == 3);
+            inner.discard();
+            REQUIRE(inner.size() == 0);
+        }
+        SPDLOG_LOGGER_DEBUG(logger, "outer {}", 2);
+        REQUIRE(outer.size() == 2);
+        logger->critical("failed");
+    }
+    REQUIRE(test_sink->lines().size() == 3);
+    REQUIRE(test_sink->lines()[0] == "failed");
+    REQUIRE(test_sink->lines()[1] == "outer 1");
+    REQUIRE(test_sink->lines()[2] == "outer 2");
+    REQUIRE(spdlog::details::thread_tail_buffer() == nullptr);
+}
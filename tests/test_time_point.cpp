@@ -1,6 +1,10 @@
 #include "includes.h"
 #include "test_sink.h"
 #include "spdlog/async.h"
+#include "spdlog/details/time_cache.h"
+#include "spdlog/details/tsc_clock.h"
+
+#include <cstdlib>
 
 TEST_CASE("time_point1", "[time_point log_msg]")
 {
@@ -34,3 +38,94 @@ TEST_CASE("time_point1", "[time_point log_msg]")
     REQUIRE(lines[8] != lines[9]);
     spdlog::drop_all();
 }
+
+TEST_CASE("tsc clock", "[time_point]")
+{
+    auto &clock = spdlog::details::tsc_clock::instance();
+    auto diff = [&clock] {
+        auto system_now = spdlog::log_clock::now();
+        auto tsc_now = clock.now();
+        return std::chrono::duration_cast<std::chrono::microseconds>(tsc_now - system_now);
+    };
+    REQUIRE(std::abs(diff().count()) < 1000);
+    clock.resync();
+    REQUIRE(std::abs(diff().count()) < 1000);
+
+    // increasing, with a resolution better than the coarse clock
+    auto first = clock.now();
+    auto later = clock.now();
+    while (later == first)
+    {
+        later = clock.now();
+    }
+    REQUIRE(later - first < std::chrono::milliseconds(1));
+}
+
+static bool same_time(const std::tm &a, const std::tm &b)
+{
+    return a.tm_sec == b.tm_sec && a.tm_min == b.tm_min && a.tm_hour == b.tm_hour && a.tm_mday == b.tm_mday && a.tm_mon == b.tm_mon &&
+           a.tm_year == b.tm_year && a.tm_yday == b.tm_yday && a.tm_isdst == b.tm_isdst;
+}
+
+TEST_CASE("time cache", "[time_point]")
+{
+    using spdlog::details::os::gmtime;
+    using spdlog::details::os::localtime;
+    auto &cache = spdlog::details::time_cache::instance();
+    auto now = std::time(nullptr);
+
+    // an older second is converted, not cached
+    REQUIRE(same_time(cache.get(now - 100, true), localtime(now - 100)));
+    REQUIRE(same_time(cache.get(now - 100, false), gmtime(now - 100)));
+
+    auto conversions = cache.conversions();
+    REQUIRE(same_time(cache.get(now, true), localtime(now)));
+    REQUIRE(same_time(cache.get(now, false), gmtime(now)));
+    REQUIRE(same_time(cache.get(now, true), localtime(now)));
+    REQUIRE(cache.conversions() - conversions <= 1);
+    REQUIRE(same_time(cache.get(now - 100, true), localtime(now - 100)));
+    REQUIRE(cache.utc_minutes_offset(localtime(now)) == spdlog::details::os::utc_minutes_offset(localtime(now)));
+
+    std::atomic<int> mismatches{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++)
+    {
+        threads.emplace_back([&cache, &mismatches, now, t] {
+            for (int i = 0; i < 1000; i++)
+            {
+                auto secs = now + (i + t) % 3;
+                if (!same_time(cache.get(secs, true), localtime(secs)))
+                {
+                    mismatches++;
+                }
+            }
+        });
+    }
+    for (auto &t : threads)
+    {
+        t.join();
+    }
+    REQUIRE(mismatches == 0);
+}
+
+TEST_CASE("civil time", "[time_point]")
+{
+    using spdlog::details::os::civil_seconds;
+    using spdlog::details::os::civil_time;
+    std::vector<std::time_t> times = {0, -1, 86399, 86400, 951782400, 951868799, 951868800, 1709164800, 4102444800, -2208988800};
+    for (std::time_t t = -2208988800LL; t < 10413792000LL; t += 86400LL * 13 + 3671)
+    {
+        times.push_back(t);
+    }
+    for (auto t : times)
+    {
+        auto expected = spdlog::details::os::gmtime(t);
+        auto tm = civil_time(t);
+        REQUIRE(same_time(tm, expected));
+        REQUIRE(tm.tm_wday == expected.tm_wday);
+        REQUIRE(civil_seconds(tm) == t);
+    }
+    // shifted by the offset
+    REQUIRE(same_time(civil_time(0, 3600 + 1800), spdlog::details::os::gmtime(3600 + 1800)));
+    REQUIRE(same_time(civil_time(0, -60), spdlog::details::os::gmtime(-60)));
+}
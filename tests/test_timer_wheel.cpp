@@ -0,0 +1,77 @@
+#include "includes.h"
+#include "test_sink.h"
+#include "spdlog/details/timer_wheel.h"
+
+#include <atomic>
+
+using spdlog::details::timer_wheel;
+
+static void wait_for(const std::function<bool()> &done)
+{
+    for (int i = 0; i < 500 && !done(); i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
+TEST_CASE("timer every", "[timer_wheel]")
+{
+    timer_wheel wheel;
+    std::atomic<int> fast{0}, slow{0};
+    auto fast_id = wheel.schedule_every([&fast] { fast++; }, std::chrono::milliseconds(5));
+    wheel.schedule_every([&slow] { slow++; }, std::chrono::milliseconds(50));
+    wait_for([&slow] { return slow >= 2; });
+    REQUIRE(slow >= 2);
+    REQUIRE(fast > slow);
+
+    // not run anymore once cancelled
+    wheel.cancel(fast_id);
+    auto cancelled_runs = fast.load();
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    REQUIRE(fast == cancelled_runs);
+    REQUIRE(wheel.schedule_every([] {}, std::chrono::seconds(0)) == 0);
+}
+
+TEST_CASE("timer once", "[timer_wheel]")
+{
+    timer_wheel wheel;
+    std::atomic<int> runs{0};
+    wheel.schedule_after([&runs] { runs++; }, std::chrono::milliseconds(1));
+    // beyond a round of the wheel
+    auto later = wheel.schedule_after([&runs] { runs += 10; }, std::chrono::seconds(2));
+    wait_for([&runs] { return runs > 0; });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    REQUIRE(runs == 1);
+    wheel.cancel(later);
+}
+
+TEST_CASE("timer cancel from callback", "[timer_wheel]")
+{
+    timer_wheel wheel;
+    std::atomic<int> runs{0};
+    std::atomic<timer_wheel::timer_id> id{0};
+    id = wheel.schedule_every(
+        [&] {
+            if (++runs == 3)
+            {
+                wheel.cancel(id);
+            }
+        },
+        std::chrono::milliseconds(2));
+    wait_for([&runs] { return runs >= 3; });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    REQUIRE(runs == 3);
+}
+
+TEST_CASE("flush every sub-second", "[timer_wheel]")
+{
+    using spdlog::sinks::test_sink_mt;
+    auto logger = spdlog::create<test_sink_mt>("periodic_flush_ms");
+    auto test_sink = std::static_pointer_cast<test_sink_mt>(logger->sinks()[0]);
+
+    spdlog::flush_every(std::chrono::milliseconds(20));
+    wait_for([&test_sink] { return test_sink->flush_counter() >= 2; });
+    REQUIRE(test_sink->flush_counter() >= 2);
+    spdlog::flush_every(std::chrono::seconds(0));
+    spdlog::drop_all();
+}
@@ -0,0 +1,92 @@
+#include "includes.h"
+
+#ifndef _WIN32
+#    include "spdlog/sinks/udp_sink.h"
+
+#    include <sys/socket.h>
+#    include <netinet/in.h>
+#    include <poll.h>
+#    include <unistd.h>
+
+// a local udp server on an ephemeral port
+struct udp_server
+{
+    int fd;
+    int port;
+
+    udp_server()
+    {
+        fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        ::bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+        socklen_t len = sizeof(addr);
+        ::getsockname(fd, reinterpret_cast<sockaddr *>(&addr), &len);
+        port = ntohs(addr.sin_port);
+    }
+
+    ~udp_server()
+    {
+        ::close(fd);
+    }
+
+    // the datagrams received until none comes for timeout_ms
+    std::vector<std::string> receive_all(int timeout_ms = 200)
+    {
+        std::vector<std::string> datagrams;
+        char buf[65536];
+        pollfd poll_fd{fd, POLLIN, 0};
+        while (::poll(&poll_fd, 1, timeout_ms) > 0)
+        {
+            auto n = ::recv(fd, buf, sizeof(buf), 0);
+            datagrams.emplace_back(buf, static_cast<size_t>(n));
+        }
+        return datagrams;
+    }
+};
+
+TEST_CASE("udp_sink packs messages into datagrams", "[udp_sink]")
+{
+    udp_server server;
+    spdlog::sinks::udp_sink_config config("127.0.0.1", server.port);
+    config.max_datagram_size = 20;
+    auto sink = std::make_shared<spdlog::sinks::udp_sink_st>(config);
+    spdlog::logger logger("udp", sink);
+    logger.set_pattern("%v");
+
+    logger.info("message 1"); // 10 bytes with the eol
+    logger.info("message 2");
+    logger.info("message 3");
+    logger.info("a message longer than a datagram");
+    REQUIRE(server.receive_all().empty()); // until flush or a full batch
+    logger.flush();
+
+    auto datagrams = server.receive_all();
+    REQUIRE(datagrams.size() == 3);
+    REQUIRE(datagrams[0] == "message 1" + std::string(spdlog::details::os::default_eol) + "message 2" + spdlog::details::os::default_eol);
+    REQUIRE(datagrams[1] == "message 3" + std::string(spdlog::details::os::default_eol));
+    REQUIRE(datagrams[2] == "a message longer tha");
+    REQUIRE(sink->dropped_datagrams() == 0);
+}
+
+TEST_CASE("udp_sink sends full batches", "[udp_sink]")
+{
+    udp_server server;
+    spdlog::sinks::udp_sink_config config("127.0.0.1", server.port);
+    config.max_datagram_size = 10;
+    config.batch_size = 4;
+    auto sink = std::make_shared<spdlog::sinks::udp_sink_st>(config);
+    spdlog::logger logger("udp", sink);
+    logger.set_pattern("%v");
+
+    for (int i = 0; i < 10; i++)
+    {
+        logger.info("message {}", i);
+    }
+    REQUIRE(server.receive_all().size() == 8);
+    logger.flush();
+    REQUIRE(server.receive_all().size() == 2);
+}
+
+#endif
@@ -0,0 +1,115 @@
+#include "includes.h"
+
+#ifndef _WIN32
+#    include "spdlog/sinks/unix_socket_sink.h"
+
+#    include <sys/socket.h>
+#    include <sys/un.h>
+#    include <poll.h>
+#    include <unistd.h>
+
+static const char *const socket_path = "unix_socket_sink_test.sock";
+
+// a local agent bound to socket_path
+struct unix_socket_server
+{
+    int fd;
+
+    explicit unix_socket_server(int type)
+    {
+        ::unlink(socket_path);
+        fd = ::socket(AF_UNIX, type, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        strcpy(addr.sun_path, socket_path);
+        ::bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+        if (type == SOCK_SEQPACKET)
+        {
+            ::listen(fd, 1);
+        }
+    }
+
+    ~unix_socket_server()
+    {
+        ::close(fd);
+        ::unlink(socket_path);
+    }
+
+    // the datagrams received until none comes for timeout_ms
+    static std::vector<std::string> receive_all(int from_fd, int timeout_ms = 200)
+    {
+        std::vector<std::string> datagrams;
+        char buf[65536];
+        pollfd poll_fd{from_fd, POLLIN, 0};
+        while (::poll(&poll_fd, 1, timeout_ms) > 0)
+        {
+            auto n = ::recv(from_fd, buf, sizeof(buf), 0);
+            if (n <= 0)
+            {
+                break;
+            }
+            datagrams.emplace_back(buf, static_cast<size_t>(n));
+        }
+        return datagrams;
+    }
+};
+
+TEST_CASE("unix_socket_sink datagram", "[unix_socket_sink]")
+{
+    unix_socket_server server(SOCK_DGRAM);
+    spdlog::sinks::unix_socket_sink_config config(socket_path);
+    config.max_datagram_size = 20;
+    auto sink = std::make_shared<spdlog::sinks::unix_socket_sink_st>(config);
+    spdlog::logger logger("unix_socket", sink);
+    logger.set_pattern("%v");
+
+    logger.info("message 1");
+    logger.info("message 2");
+    logger.info("message 3");
+    logger.flush();
+
+    auto datagrams = unix_socket_server::receive_all(server.fd);
+    REQUIRE(datagrams.size() == 2);
+    REQUIRE(datagrams[1] == "message 3" + std::string(spdlog::details::os::default_eol));
+    REQUIRE(sink->dropped_datagrams() == 0);
+}
+
+TEST_CASE("unix_socket_sink seqpacket", "[unix_socket_sink]")
+{
+    unix_socket_server server(SOCK_SEQPACKET);
+    auto sink = std::make_shared<spdlog::sinks::unix_socket_sink_st>(
+        spdlog::sinks::unix_socket_sink_config(socket_path, spdlog::sinks::unix_socket_type::seqpacket));
+    spdlog::logger logger("unix_socket", sink);
+    logger.set_pattern("%v");
+    int connection = ::accept(server.fd, nullptr, nullptr);
+    REQUIRE(connection != -1);
+
+    logger.info("message 1");
+    logger.info("message 2");
+    logger.flush();
+    auto datagrams = unix_socket_server::receive_all(connection);
+    ::close(connection);
+    REQUIRE(datagrams.size() == 1);
+    REQUIRE(datagrams[0] == "message 1" + std::string(spdlog::details::os::default_eol) + "message 2" + spdlog::details::os::default_eol);
+}
+
+TEST_CASE("unix_socket_sink without agent", "[unix_socket_sink]")
+{
+    ::unlink(socket_path);
+    auto sink = std::make_shared<spdlog::sinks::unix_socket_sink_st>(spdlog::sinks::unix_socket_sink_config(socket_path));
+    spdlog::logger logger("unix_socket", sink);
+    logger.set_pattern("%v");
+    logger.info("lost");
+    logger.flush();
+    REQUIRE(sink->dropped_datagrams() == 1);
+
+    // connects once the agent is there
+    unix_socket_server server(SOCK_DGRAM);
+    logger.info("received");
+    logger.flush();
+    auto datagrams = unix_socket_server::receive_all(server.fd);
+    REQUIRE(datagrams.size() == 1);
+    REQUIRE(sink->dropped_datagrams() == 1);
+}
+
+#endif
@@ -0,0 +1,45 @@
+//
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+// Render the binary log files written by binary_file_sink with a pattern, e.g.
+// spdlog-decode logs/app.bin "[%Y-%m-%d %H:%M:%S.%e] [%n] [%l] %v %k"
+
+#include "spdlog/spdlog.h"
+#include "spdlog/details/binary_log_reader.h"
+#include "spdlog/pattern_formatter.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2 || argc > 4)
+    {
+        std::fprintf(stderr, "Usage: %s <binary log file> [pattern] [--utc]\n", argv[0]);
+        return 1;
+    }
+
+    std::string pattern = argc > 2 && std::strcmp(argv[2], "--utc") != 0 ? argv[2] : "%+";
+    bool utc = std::strcmp(argv[argc - 1], "--utc") == 0;
+    try
+    {
+        spdlog::details::binary_log_reader reader(argv[1]);
+        spdlog::pattern_formatter formatter(pattern, utc ? spdlog::pattern_time_type::utc : spdlog::pattern_time_type::local);
+        spdlog::details::log_msg msg;
+        spdlog::memory_buf_t formatted;
+        while (reader.read(msg))
+        {
+            formatted.clear();
+            formatter.format(msg, formatted);
+            std::fwrite(formatted.data(), 1, formatted.size(), stdout);
+        }
+    }
+    catch (const spdlog::spdlog_ex &ex)
+    {
+        std::fprintf(stderr, "%s\n", ex.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,34 @@
+//
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+// Merge the per thread files written by sharded_file_sink (see sinks/sharded_file_sink.h) into a single log,
+// their messages interleaved by timestamp, e.g.
+// spdlog-merge logs/app.log logs/app.*.log
+
+#include "spdlog/spdlog.h"
+#include "spdlog/sinks/sharded_file_sink.h"
+
+#include <cstdio>
+#include <vector>
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3)
+    {
+        std::fprintf(stderr, "Usage: %s <output file> <shard file>...\n", argv[0]);
+        return 1;
+    }
+
+    try
+    {
+        std::vector<spdlog::filename_t> shards(argv + 2, argv + argc);
+        spdlog::sinks::sharded_file_sink::merge(shards, argv[1]);
+    }
+    catch (const spdlog::spdlog_ex &ex)
+    {
+        std::fprintf(stderr, "%s\n", ex.what());
+        return 1;
+    }
+    return 0;
+}
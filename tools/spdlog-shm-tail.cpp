@@ -0,0 +1,59 @@
+//
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+// Print the messages left in a shared memory ring written by shm_ringbuffer_sink, oldest first, e.g.
+// spdlog-shm-tail /myapp-log        (after a crash)
+// spdlog-shm-tail /myapp-log -f     (and keep printing the new ones)
+
+#include "spdlog/spdlog.h"
+#include "spdlog/details/shm_ring.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2 || argc > 3 || (argc == 3 && std::strcmp(argv[2], "-f") != 0))
+    {
+        std::fprintf(stderr, "Usage: %s <shared memory name> [-f]\n", argv[0]);
+        return 1;
+    }
+
+    bool follow = argc == 3;
+    try
+    {
+        spdlog::details::shm_ring ring;
+        ring.open_read_only(argv[1]);
+        auto pos = ring.oldest_position();
+        spdlog::memory_buf_t record;
+        for (;;)
+        {
+            record.clear();
+            if (ring.read(pos, record))
+            {
+                std::fwrite(record.data(), 1, record.size(), stdout);
+                continue;
+            }
+            if (pos < ring.write_position() && !follow)
+            {
+                pos = ring.next_record(pos + 1); // left incomplete by a writer that crashed
+                continue;
+            }
+            if (!follow)
+            {
+                break;
+            }
+            std::fflush(stdout);
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+    }
+    catch (const spdlog::spdlog_ex &ex)
+    {
+        std::fprintf(stderr, "%s\n", ex.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,97 @@
+//
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+// Print the part of a log file with the messages of a time range, found in its time index (see
+// details/time_index.h) instead of scanning the file, e.g.
+// spdlog-time-range logs/daily_2026-10-14.txt "2026-10-14 13:05:00" "2026-10-14 13:10:00"
+// spdlog-time-range logs/rotating.1.txt 1791983100          (epoch seconds, to the end of the file)
+// The range is rounded to the index intervals: up to an interval of messages before and after it is printed.
+// The files compressed as written (see details/frame_compressor.h) are decompressed, only the frames of the range.
+
+#include "spdlog/spdlog.h"
+#include "spdlog/details/frame_compressor.h"
+#include "spdlog/details/os.h"
+#include "spdlog/details/time_index.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <vector>
+
+// local time "YYYY-mm-dd HH:MM:SS", or seconds since epoch
+static bool parse_time(const char *text, spdlog::log_clock::time_point &tp)
+{
+    char *end;
+    auto seconds = std::strtoll(text, &end, 10);
+    if (*end == '\0' && end != text)
+    {
+        tp = spdlog::log_clock::from_time_t(static_cast<std::time_t>(seconds));
+        return true;
+    }
+    std::tm tm{};
+    if (std::sscanf(text, "%d-%d-%d %d:%d:%d", &tm.tm_year, &tm.tm_mon, &tm.tm_mday, &tm.tm_hour, &tm.tm_min, &tm.tm_sec) != 6)
+    {
+        return false;
+    }
+    tm.tm_year -= 1900;
+    tm.tm_mon -= 1;
+    tm.tm_isdst = -1;
+    tp = spdlog::log_clock::from_time_t(std::mktime(&tm));
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    spdlog::log_clock::time_point from, to = spdlog::log_clock::time_point::max();
+    if (argc < 3 || argc > 4 || !parse_time(argv[2], from) || (argc == 4 && !parse_time(argv[3], to)))
+    {
+        std::fprintf(stderr, "Usage: %s <log file> <from> [<to>]   (times as \"YYYY-mm-dd HH:MM:SS\" or epoch seconds)\n", argv[0]);
+        return 1;
+    }
+
+    try
+    {
+        spdlog::filename_t filename = argv[1];
+        auto range = spdlog::details::time_index::find_range(filename, from, to);
+        if (spdlog::details::os::path_exists(spdlog::details::frame_compressor::frames_filename(filename)))
+        {
+            spdlog::memory_buf_t data;
+            spdlog::details::frame_compressor::read_range(filename, range.first, range.second, data);
+            std::fwrite(data.data(), 1, data.size(), stdout);
+            return 0;
+        }
+        std::FILE *fd;
+        if (spdlog::details::os::fopen_s(&fd, filename, SPDLOG_FILENAME_T("rb")))
+        {
+            std::fprintf(stderr, "Failed opening %s\n", argv[1]);
+            return 1;
+        }
+        if (range.first > 0 && std::fseek(fd, static_cast<long>(range.first), SEEK_SET) != 0)
+        {
+            std::fclose(fd);
+            std::fprintf(stderr, "Failed seeking in %s\n", argv[1]);
+            return 1;
+        }
+        std::vector<char> buffer(64 * 1024);
+        auto left = range.second - range.first;
+        while (left > 0)
+        {
+            auto n = std::fread(buffer.data(), 1, left < buffer.size() ? left : buffer.size(), fd);
+            if (n == 0)
+            {
+                break;
+            }
+            std::fwrite(buffer.data(), 1, n, stdout);
+            left -= n;
+        }
+        std::fclose(fd);
+    }
+    catch (const spdlog::spdlog_ex &ex)
+    {
+        std::fprintf(stderr, "%s\n", ex.what());
+        return 1;
+    }
+    return 0;
+}